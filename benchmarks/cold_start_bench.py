@@ -0,0 +1,133 @@
+import argparse
+import json
+import subprocess
+import sys
+import tempfile
+import time
+
+_STAGES = ['import', 'runtime_init', 'trace', 'compile', 'first_result']
+
+
+def make_model(name):
+  import torch
+  if name == 'mlp':
+    model = torch.nn.Sequential(
+        torch.nn.Linear(1024, 4096), torch.nn.GELU(),
+        torch.nn.Linear(4096, 4096), torch.nn.GELU(),
+        torch.nn.Linear(4096, 1024))
+    return model, (torch.randn(32, 1024),)
+  if name == 'convnet':
+    model = torch.nn.Sequential(
+        torch.nn.Conv2d(3, 64, 3, padding=1), torch.nn.ReLU(),
+        torch.nn.Conv2d(64, 128, 3, stride=2, padding=1), torch.nn.ReLU(),
+        torch.nn.Conv2d(128, 256, 3, stride=2, padding=1), torch.nn.ReLU(),
+        torch.nn.AdaptiveAvgPool2d(1), torch.nn.Flatten(),
+        torch.nn.Linear(256, 1000))
+    return model, (torch.randn(8, 3, 224, 224),)
+  layer = torch.nn.TransformerDecoderLayer(
+      d_model=512, nhead=8, dim_feedforward=2048, batch_first=True)
+  model = torch.nn.TransformerDecoder(layer, num_layers=6)
+  return model, (torch.randn(4, 128, 512), torch.randn(4, 128, 512))
+
+
+def run_child(args):
+  """Runs the first inference step of a fresh process, printing the seconds
+  since its launch at the end of each stage as JSON.
+  """
+  stages = {}
+
+  def stage_done(name):
+    stages[name] = time.time() - args.launch_time
+
+  import torch
+  import torch_xla
+  import torch_xla.core.xla_model as xm
+  import torch_xla.debug.metrics as met
+  import torch_xla.runtime as xr
+  stage_done('import')
+
+  if args.cache_dir:
+    xr.initialize_cache(args.cache_dir, prefetch=args.prefetch)
+  # Creates the computation client.
+  xr.global_runtime_device_count()
+  stage_done('runtime_init')
+
+  device = xm.xla_device()
+  model, inputs = make_model(args.model)
+  model = model.to(device).eval()
+  with torch.no_grad():
+    output = model(*[x.to(device) for x in inputs])
+  stage_done('trace')
+
+  # Compiles the graph, or loads it from the persistent cache, without running
+  # it.
+  torch_xla._XLAC._xla_warm_up_cache([output], [])
+  stage_done('compile')
+
+  output.cpu()
+  stage_done('first_result')
+  stages['persistent_cache_hits'] = met.counter_value('PersistentCacheHit') or 0
+  print(json.dumps(stages))
+
+
+def launch(model, cache_dir, prefetch):
+  command = [
+      sys.executable, __file__, '--child', f'--model={model}',
+      f'--launch-time={time.time()}'
+  ]
+  if cache_dir:
+    command.append(f'--cache-dir={cache_dir}')
+  if prefetch:
+    command.append('--prefetch')
+  result = subprocess.run(
+      command, check=True, capture_output=True, text=True)
+  return json.loads(result.stdout.strip().splitlines()[-1])
+
+
+def main():
+  """Measures the time to the first result of fresh inference processes.
+
+  Each run is a new process timing, from its launch, the import of torch_xla,
+  the creation of the runtime client, the trace of the first step, its
+  compilation (or its load from the persistent cache) and its first result.
+  The runs go without persistent cache, with a cold one (a new directory), and
+  with the warm cache it left, optionally prefetched, and are printed as CSV
+  of the seconds since the launch at the end of each stage.
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument(
+      '--models',
+      nargs='+',
+      choices=['mlp', 'convnet', 'decoder'],
+      default=['mlp', 'convnet', 'decoder'])
+  parser.add_argument(
+      '--prefetch',
+      action='store_true',
+      help='Also runs with the warm cache prefetched at initialization.')
+  parser.add_argument('--repeat', type=int, default=3)
+  parser.add_argument('--child', action='store_true', help=argparse.SUPPRESS)
+  parser.add_argument('--model', help=argparse.SUPPRESS)
+  parser.add_argument('--launch-time', type=float, help=argparse.SUPPRESS)
+  parser.add_argument('--cache-dir', help=argparse.SUPPRESS)
+  args = parser.parse_args()
+
+  if args.child:
+    run_child(args)
+    return
+
+  print('model,cache,' + ','.join(_STAGES) + ',persistent_cache_hits')
+  for model in args.models:
+    for _ in range(args.repeat):
+      with tempfile.TemporaryDirectory() as cache_dir:
+        runs = [('none', None, False), ('cold', cache_dir, False),
+                ('warm', cache_dir, False)]
+        if args.prefetch:
+          runs.append(('warm_prefetch', cache_dir, True))
+        for cache, path, prefetch in runs:
+          stages = launch(model, path, prefetch)
+          times = ','.join(f'{stages[stage]:.3f}' for stage in _STAGES)
+          print(f'{model},{cache},{times},{stages["persistent_cache_hits"]}')
+
+
+if __name__ == '__main__':
+  main()
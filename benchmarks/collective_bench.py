@@ -0,0 +1,142 @@
+import argparse
+import time
+
+import torch
+
+import torch_xla.core.xla_model as xm
+import torch_xla.distributed.xla_multiprocessing as xmp
+import torch_xla.runtime as xr
+
+_DTYPES = {
+    'float32': torch.float32,
+    'bfloat16': torch.bfloat16,
+    'int32': torch.int32,
+}
+
+# The bus bandwidth factors of the ops over n replicas, as in nccl-tests: the
+# fraction of the message each link carries with an optimal algorithm.
+_BUS_FACTORS = {
+    'all_reduce': lambda n: 2 * (n - 1) / n,
+    'all_gather': lambda n: (n - 1) / n,
+    'reduce_scatter': lambda n: (n - 1) / n,
+    'all_to_all': lambda n: (n - 1) / n,
+}
+
+
+def make_groups(kind, world_size):
+  if kind == 'all':
+    return None, world_size
+  # Pairs of neighbouring replicas.
+  return [[i, i + 1] for i in range(0, world_size, 2)], 2
+
+
+def run_op(op, inputs, group_size, groups):
+  """Runs `op` on the list of inputs, coalesced if more than one. Each input
+  is the full message of the op: the gathered output of all_gather and the
+  scattered input of reduce_scatter.
+  """
+  value = inputs[0] if len(inputs) == 1 else inputs
+  if op == 'all_reduce':
+    return xm.all_reduce(xm.REDUCE_SUM, value, groups=groups)
+  if op == 'all_gather':
+    shards = [t.narrow(0, 0, t.size(0) // group_size) for t in inputs]
+    return xm.all_gather(
+        shards[0] if len(shards) == 1 else shards,
+        groups=groups,
+        pin_layout=len(shards) == 1)
+  if op == 'reduce_scatter':
+    return xm.reduce_scatter(
+        xm.REDUCE_SUM,
+        value,
+        1.0,
+        0,
+        group_size,
+        groups=groups,
+        pin_layout=len(inputs) == 1)
+  return xm.all_to_all(value, 0, 0, group_size, groups=groups)
+
+
+def measure(op, dtype, size, coalesced, groups, group_size, args, device):
+  element_size = torch.tensor([], dtype=dtype).element_size()
+  # The messages are split in whole rows of the group size.
+  numel = max(size // element_size // (args.coalesce if coalesced else 1),
+              group_size) // group_size * group_size
+  inputs = [
+      torch.ones(numel, dtype=dtype, device=device)
+      for _ in range(args.coalesce if coalesced else 1)
+  ]
+  xm.mark_step()
+
+  def step():
+    outputs = [
+        run_op(op, inputs, group_size, groups) for _ in range(args.ops_per_step)
+    ]
+    xm.mark_step()
+    return outputs
+
+  for _ in range(args.warmup):
+    step()
+  xm.wait_device_ops()
+  start = time.perf_counter()
+  for _ in range(args.steps):
+    step()
+  xm.wait_device_ops()
+  seconds = (time.perf_counter() - start) / (args.steps * args.ops_per_step)
+  message_bytes = numel * element_size * len(inputs)
+  return seconds, message_bytes
+
+
+def _mp_fn(index, args):
+  device = xm.xla_device()
+  world_size = xr.world_size()
+  if xm.is_master_ordinal():
+    print('op,mode,dtype,bytes,group_size,time_us,algbw_gbps,busbw_gbps',
+          flush=True)
+  for op in args.ops.split(','):
+    for group_kind in args.groups.split(','):
+      if group_kind == 'pairs' and (world_size < 4 or world_size % 2 != 0):
+        continue
+      groups, group_size = make_groups(group_kind, world_size)
+      for dtype_name in args.dtypes.split(','):
+        for size in args.sizes:
+          for coalesced in (False, True):
+            seconds, message_bytes = measure(op, _DTYPES[dtype_name], size,
+                                             coalesced, groups, group_size,
+                                             args, device)
+            algbw = message_bytes / seconds / 1e9
+            busbw = algbw * _BUS_FACTORS[op](group_size)
+            if xm.is_master_ordinal():
+              mode = 'coalesced' if coalesced else 'single'
+              print(
+                  f'{op},{mode},{dtype_name},{message_bytes},{group_size},'
+                  f'{seconds * 1e6:.1f},{algbw:.3f},{busbw:.3f}',
+                  flush=True)
+
+
+def main():
+  """Sweeps the collectives over message sizes, dtypes, replica groups, and
+  single or coalesced tensors (`--coalesce` tensors sharing the message, as
+  lowered by BuildAllGatherCoalesced and BuildReduceScatterCoalesced), and
+  prints as CSV the time per op with the algorithm bandwidth (message bytes
+  over time) and the bus bandwidth (scaled by the link traffic of an optimal
+  algorithm, as in nccl-tests, to compare with the fabric peak).
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument(
+      '--ops', default='all_reduce,all_gather,reduce_scatter,all_to_all')
+  parser.add_argument('--dtypes', default='float32,bfloat16')
+  parser.add_argument('--groups', default='all,pairs')
+  parser.add_argument(
+      '--sizes',
+      type=lambda s: [int(x) for x in s.split(',')],
+      default=[2**i for i in range(10, 31, 4)])
+  parser.add_argument('--coalesce', type=int, default=8)
+  parser.add_argument('--ops-per-step', type=int, default=10)
+  parser.add_argument('--warmup', type=int, default=2)
+  parser.add_argument('--steps', type=int, default=5)
+  args = parser.parse_args()
+  xmp.spawn(_mp_fn, args=(args,))
+
+
+if __name__ == '__main__':
+  main()
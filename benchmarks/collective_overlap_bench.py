@@ -0,0 +1,94 @@
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+import torch
+
+import torch_xla.core.xla_model as xm
+import torch_xla.distributed.xla_multiprocessing as xmp
+
+from microbench import MicrobenchResults
+
+
+def get_model(width, depth, device):
+  layers = []
+  for _ in range(depth):
+    layers += [torch.nn.Linear(width, width), torch.nn.ReLU()]
+  return torch.nn.Sequential(*layers).to(device)
+
+
+def train_step(model, optimizer, batch):
+  optimizer.zero_grad()
+  model(batch).sum().backward()
+  # One all-reduce per gradient, sequenced by the collective token, as the
+  # backward pass produces them.
+  for param in model.parameters():
+    param.grad = xm.all_reduce(xm.REDUCE_SUM, param.grad)
+  optimizer.step()
+  xm.mark_step()
+
+
+def _mp_fn(index, args):
+  device = xm.xla_device()
+  model = get_model(args.width, args.depth, device)
+  optimizer = torch.optim.SGD(model.parameters(), lr=1e-3)
+  batch = torch.randn(args.batch, args.width, device=device)
+  for _ in range(args.warmup):
+    train_step(model, optimizer, batch)
+  xm.wait_device_ops()
+  start = time.perf_counter()
+  for _ in range(args.steps):
+    train_step(model, optimizer, batch)
+  xm.wait_device_ops()
+  step_ms = (time.perf_counter() - start) * 1000 / args.steps
+  if xm.is_master_ordinal():
+    print(f'step_ms={step_ms}', flush=True)
+
+
+def run_child(args, use_barriers):
+  # The token mode is read once per process.
+  env = dict(os.environ, XLA_CC_TOKEN_BARRIER=str(int(use_barriers)))
+  cmd = [sys.executable, __file__, '--child'] + [
+      f'--{name}={getattr(args, name)}'
+      for name in ('width', 'depth', 'batch', 'warmup', 'steps')
+  ]
+  output = subprocess.run(
+      cmd, env=env, check=True, capture_output=True, text=True).stdout
+  for line in output.splitlines():
+    if line.startswith('step_ms='):
+      return float(line[len('step_ms='):])
+  raise RuntimeError(f'No step time in the benchmark output:\n{output}')
+
+
+def main():
+  """Benchmarks the training steps of an MLP all-reducing its gradients, with
+  the collectives sequenced by numeric tokens (baseline) and by optimization
+  barriers (testing). The barriers leave the reductions free to overlap with
+  the backward pass.
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--child', action='store_true')
+  parser.add_argument('--width', type=int, default=4096)
+  parser.add_argument('--depth', type=int, default=16)
+  parser.add_argument('--batch', type=int, default=128)
+  parser.add_argument('--warmup', type=int, default=5)
+  parser.add_argument('--steps', type=int, default=20)
+  args = parser.parse_args()
+  if args.child:
+    xmp.spawn(_mp_fn, args=(args,))
+    return
+
+  baseline_ms = run_child(args, use_barriers=False)
+  testing_ms = run_child(args, use_barriers=True)
+  print(
+      MicrobenchResults(
+          test_name=f'collective-overlap-w{args.width}-d{args.depth}',
+          testing_speedup=baseline_ms / testing_ms,
+          baseline_wall_ms=baseline_ms,
+          testing_wall_ms=testing_ms))
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,187 @@
+import argparse
+from collections import OrderedDict
+import glob
+import json
+import os
+import time
+
+import torch
+
+import torch_xla
+import torch_xla.core.xla_model as xm
+
+
+class Decoder(torch.nn.Module):
+  """A small causal LLM: embeddings, encoder layers with a causal mask."""
+
+  def __init__(self, vocab=8192, hidden=512, layers=4):
+    super().__init__()
+    self.embed = torch.nn.Embedding(vocab, hidden)
+    layer = torch.nn.TransformerEncoderLayer(
+        hidden, nhead=8, dim_feedforward=4 * hidden, batch_first=True)
+    self.layers = torch.nn.TransformerEncoder(layer, layers)
+    self.head = torch.nn.Linear(hidden, vocab, bias=False)
+
+  def forward(self, tokens):
+    mask = torch.nn.Transformer.generate_square_subsequent_mask(
+        tokens.size(1), device=tokens.device)
+    return self.head(self.layers(self.embed(tokens), mask=mask, is_causal=True))
+
+
+class ConvNet(torch.nn.Module):
+  """A small residual vision model."""
+
+  def __init__(self, channels=64, blocks=4, classes=1000):
+    super().__init__()
+    self.stem = torch.nn.Conv2d(3, channels, 7, stride=2, padding=3)
+    self.blocks = torch.nn.ModuleList([
+        torch.nn.Sequential(
+            torch.nn.Conv2d(channels, channels, 3, padding=1),
+            torch.nn.BatchNorm2d(channels), torch.nn.ReLU(),
+            torch.nn.Conv2d(channels, channels, 3, padding=1),
+            torch.nn.BatchNorm2d(channels)) for _ in range(blocks)
+    ])
+    self.head = torch.nn.Linear(channels, classes)
+
+  def forward(self, images):
+    x = self.stem(images)
+    for block in self.blocks:
+      x = torch.relu(x + block(x))
+    return self.head(x.mean(dim=(2, 3)))
+
+
+class RecSys(torch.nn.Module):
+  """A DLRM-like model: embedding bags, pairwise interactions and an MLP."""
+
+  def __init__(self, tables=8, rows=100000, dim=64):
+    super().__init__()
+    self.bags = torch.nn.ModuleList(
+        [torch.nn.EmbeddingBag(rows, dim, mode='sum') for _ in range(tables)])
+    self.dense = torch.nn.Linear(13, dim)
+    features = tables + 1
+    self.top = torch.nn.Sequential(
+        torch.nn.Linear(features * (features - 1) // 2 + dim, 512),
+        torch.nn.ReLU(), torch.nn.Linear(512, 1))
+
+  def forward(self, dense, sparse):
+    x = self.dense(dense)
+    embedded = torch.stack(
+        [x] + [bag(sparse[:, i]) for i, bag in enumerate(self.bags)], dim=1)
+    interactions = embedded @ embedded.transpose(1, 2)
+    rows, cols = torch.triu_indices(
+        embedded.size(1), embedded.size(1), offset=1, device=x.device)
+    return self.top(torch.cat([x, interactions[:, rows, cols]], dim=1))
+
+
+def corpus_models(device):
+  # (suite, name, model, inputs)
+  return [
+      ('llm', 'decoder', Decoder(),
+       (torch.randint(0, 8192, (4, 256), device=device),)),
+      ('vision', 'convnet', ConvNet(), (torch.randn(
+          8, 3, 224, 224, device=device),)),
+      ('recsys', 'dlrm', RecSys(),
+       (torch.randn(64, 13, device=device),
+        torch.randint(0, 100000, (64, 8, 4), device=device))),
+  ]
+
+
+def lower_step(model, inputs):
+  """Traces a training step of `model` and returns its HLO module proto with
+  the time spent lowering it.
+  """
+  loss = model(*inputs).float().square().mean()
+  loss.backward()
+  tensors = [loss] + [p.grad for p in model.parameters() if p.grad is not None]
+  start = time.perf_counter()
+  proto = torch_xla._XLAC._get_xla_tensors_hlo_proto(tensors)
+  return proto, time.perf_counter() - start
+
+
+def generate(args):
+  device = xm.xla_device()
+  os.makedirs(args.corpus_dir, exist_ok=True)
+  for suite, name, model, inputs in corpus_models(device):
+    proto, seconds = lower_step(model.to(device), inputs)
+    path = os.path.join(args.corpus_dir, f'{suite}.{name}.hlo.pb')
+    with open(path, 'wb') as f:
+      f.write(proto)
+    print(f'{path}: bytes={len(proto)} lowering_s={seconds:.3f}')
+    xm.mark_step()
+
+
+def experiment_config():
+  device_type = xm.xla_device_hw(xm.xla_device())
+  d = OrderedDict()
+  d['accelerator'] = device_type.lower()
+  d['accelerator_model'] = device_type
+  d['xla'] = 'PJRT'
+  d['xla_flags'] = os.environ.get('XLA_FLAGS')
+  d['dynamo'] = None
+  d['torch_xla2'] = None
+  d['keep_model_data_on_cuda'] = False
+  d['test'] = 'compile'
+  d['batch_size'] = None
+  return d
+
+
+def run(args):
+  """Compiles each module of the corpus `--repeat` times and appends one line
+  per module to `--output`, in the format of experiment_runner.py which
+  result_analyzer.py aggregates, the compile times being the total times.
+  """
+  device = str(xm.xla_device())
+  paths = sorted(glob.glob(os.path.join(args.corpus_dir, '*.hlo.pb')))
+  if not paths:
+    raise ValueError(f'No *.hlo.pb module in {args.corpus_dir}, run generate')
+  with open(args.output, 'a', encoding='utf-8') as out:
+    for path in paths:
+      suite, name = os.path.basename(path).split('.')[:2]
+      with open(path, 'rb') as f:
+        proto = f.read()
+      computation = torch_xla._XLAC._xla_op_computation_from_module_proto(
+          name, proto)
+      compile_times = []
+      for _ in range(args.repeat):
+        start = time.perf_counter()
+        torch_xla._XLAC._xla_compile_computation(computation, device)
+        compile_times.append(time.perf_counter() - start)
+      results = OrderedDict()
+      results['model'] = OrderedDict(suite_name=suite, model_name=name)
+      results['experiment'] = experiment_config()
+      results['repeat'] = args.repeat
+      results['iterations_per_run'] = 1
+      results['metrics'] = {
+          'total_time': compile_times,
+          'per_iter_time': compile_times,
+          'hlo_bytes': [len(proto)],
+      }
+      results['timestamp'] = args.timestamp or time.time()
+      json.dump(results, out, ensure_ascii=False)
+      out.write('\n')
+      print(f'{suite}.{name}: median_compile_s='
+            f'{sorted(compile_times)[len(compile_times) // 2]:.3f}')
+
+
+def main():
+  """Tracks the lowering and compile times of representative graphs. The
+  `generate` command traces the training steps of the LLM, vision and RecSys
+  models of the corpus and writes their HLO module protos, which can be
+  checked in to compare the compiler across releases on fixed inputs. The
+  `run` command compiles the modules of a corpus.
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument('command', choices=['generate', 'run'])
+  parser.add_argument('--corpus-dir', default='hlo_corpus')
+  parser.add_argument('--output', default='compile_corpus.jsonl')
+  parser.add_argument('--repeat', type=int, default=3)
+  parser.add_argument('--timestamp', type=int, default=None)
+  args = parser.parse_args()
+  if args.command == 'generate':
+    generate(args)
+  else:
+    run(args)
+
+
+if __name__ == '__main__':
+  main()
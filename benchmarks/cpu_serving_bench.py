@@ -0,0 +1,87 @@
+import argparse
+import os
+import time
+
+os.environ.setdefault('PJRT_DEVICE', 'CPU')
+
+import torch
+
+import torch_xla
+import torch_xla.core.xla_model as xm
+
+
+def make_model(hidden, layers):
+  blocks = []
+  for _ in range(layers):
+    blocks += [
+        torch.nn.Linear(hidden, 4 * hidden),
+        torch.nn.GELU(),
+        torch.nn.Linear(4 * hidden, hidden),
+        torch.nn.LayerNorm(hidden),
+    ]
+  return torch.nn.Sequential(*blocks).eval()
+
+
+def percentile(latencies, p):
+  ordered = sorted(latencies)
+  return ordered[min(len(ordered) - 1, int(len(ordered) * p / 100))]
+
+
+def serve(name, run, requests, warmup):
+  for request in requests[:warmup]:
+    run(request)
+  latencies = []
+  start = time.perf_counter()
+  for request in requests[warmup:]:
+    request_start = time.perf_counter()
+    run(request)
+    latencies.append((time.perf_counter() - request_start) * 1000)
+  seconds = time.perf_counter() - start
+  print(f'{name}: p50_ms={percentile(latencies, 50):.3f} '
+        f'p99_ms={percentile(latencies, 99):.3f} '
+        f'requests_per_s={len(latencies) / seconds:.1f}')
+
+
+def main():
+  """Serves the same requests on the host with native PyTorch and with the XLA
+  CPU client, each request transferring its input, running the compiled graph
+  and reading back its output, and reports their latency and throughput.
+  Run one process per NUMA node with XLA_CPU_NUMA_NODE to bind the XLA
+  executions, along with numactl for the native ones.
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--batch', type=int, default=8)
+  parser.add_argument('--hidden', type=int, default=512)
+  parser.add_argument('--layers', type=int, default=4)
+  parser.add_argument('--threads', type=int, default=0)
+  parser.add_argument('--warmup', type=int, default=10)
+  parser.add_argument('--requests', type=int, default=200)
+  args = parser.parse_args()
+
+  model = make_model(args.hidden, args.layers)
+  requests = [
+      torch.randn(args.batch, args.hidden)
+      for _ in range(args.warmup + args.requests)
+  ]
+  if args.threads > 0:
+    torch.set_num_threads(args.threads)
+    # The executables compiled for the graphs synced by this thread.
+    torch_xla._XLAC._xla_set_intra_op_threads(args.threads)
+
+  with torch.no_grad():
+    serve('native', model, requests, args.warmup)
+
+    device = xm.xla_device()
+    xla_model = make_model(args.hidden, args.layers).to(device)
+    xla_model.load_state_dict(model.state_dict())
+
+    def run_xla(request):
+      output = xla_model(request.to(device))
+      xm.mark_step()
+      return output.cpu()
+
+    serve('xla_cpu', run_xla, requests, args.warmup)
+
+
+if __name__ == '__main__':
+  main()
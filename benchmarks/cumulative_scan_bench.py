@@ -0,0 +1,71 @@
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+import torch
+
+import torch_xla.core.xla_model as xm
+
+from microbench import MicrobenchResults
+
+
+def run(args):
+  device = xm.xla_device()
+  input = torch.randn(args.batch, args.length, device=device)
+  for _ in range(args.warmup):
+    torch.cumsum(input, -1)
+    xm.mark_step()
+  xm.wait_device_ops()
+  start = time.perf_counter()
+  for _ in range(args.steps):
+    torch.cumsum(input, -1)
+    xm.mark_step()
+  xm.wait_device_ops()
+  step_ms = (time.perf_counter() - start) * 1000 / args.steps
+  print(f'step_ms={step_ms}', flush=True)
+
+
+def run_child(args, threshold):
+  # The scan threshold is read once per process.
+  env = dict(os.environ, XLA_CUMULATIVE_SCAN_THRESHOLD=str(threshold))
+  cmd = [sys.executable, __file__, '--child'] + [
+      f'--{name}={getattr(args, name)}'
+      for name in ('batch', 'length', 'warmup', 'steps')
+  ]
+  output = subprocess.run(
+      cmd, env=env, check=True, capture_output=True, text=True).stdout
+  for line in output.splitlines():
+    if line.startswith('step_ms='):
+      return float(line[len('step_ms='):])
+  raise RuntimeError(f'No step time in the benchmark output:\n{output}')
+
+
+def main():
+  """Benchmarks a cumsum over a long dimension, lowered as a reduce window
+  spanning the whole dimension (baseline) and as a log-step scan (testing).
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--child', action='store_true')
+  parser.add_argument('--batch', type=int, default=64)
+  parser.add_argument('--length', type=int, default=32768)
+  parser.add_argument('--warmup', type=int, default=3)
+  parser.add_argument('--steps', type=int, default=20)
+  args = parser.parse_args()
+  if args.child:
+    run(args)
+    return
+
+  baseline_ms = run_child(args, args.length + 1)
+  testing_ms = run_child(args, 1)
+  print(
+      MicrobenchResults(
+          test_name=f'cumulative-scan-b{args.batch}-l{args.length}',
+          testing_speedup=baseline_ms / testing_ms,
+          baseline_wall_ms=baseline_ms,
+          testing_wall_ms=testing_ms))
+
+
+if __name__ == '__main__':
+  main()
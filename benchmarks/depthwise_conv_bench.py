@@ -0,0 +1,89 @@
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+os.environ.setdefault('PJRT_DEVICE', 'CPU')
+
+import torch
+import torch.nn.functional as F
+
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+
+# (batch, channels, size, kernel, stride, multiplier) of MobileNet and
+# EfficientNet style depthwise layers.
+SHAPES = [
+    (32, 32, 112, 3, 1, 1),
+    (32, 96, 112, 3, 2, 1),
+    (32, 144, 56, 3, 1, 1),
+    (32, 240, 28, 5, 2, 1),
+    (32, 480, 14, 3, 1, 1),
+    (32, 672, 14, 5, 1, 1),
+    (32, 1152, 7, 5, 1, 1),
+    (32, 64, 28, 3, 1, 2),
+]
+
+
+def run(args):
+  device = xm.xla_device()
+  for batch, channels, size, kernel, stride, multiplier in SHAPES:
+    input = torch.randn(
+        batch, channels, size, size, device=device, requires_grad=True)
+    weight = torch.randn(
+        channels * multiplier, 1, kernel, kernel, device=device,
+        requires_grad=True)
+
+    def step():
+      output = F.conv2d(
+          input, weight, stride=stride, padding=kernel // 2, groups=channels)
+      if args.backward:
+        output.sum().backward()
+      xm.mark_step()
+
+    met.clear_all()
+    for _ in range(args.warmup):
+      step()
+    xm.wait_device_ops()
+    start = time.perf_counter()
+    for _ in range(args.steps):
+      step()
+    xm.wait_device_ops()
+    step_us = (time.perf_counter() - start) / args.steps * 1e6
+    taps = int('DepthwiseConvTaps' in met.counter_names())
+    print(f'{batch},{channels},{size},{kernel},{stride},{multiplier},'
+          f'{int(args.backward)},{taps},{step_us:.1f}')
+    sys.stdout.flush()
+
+
+def main():
+  """Compares the depthwise convolutions lowered by taps or as grouped ones.
+
+  Times the steps of the depthwise layers of SHAPES, with their backward if
+  `--backward`, once in a process lowering them as sums of shifted products
+  (XLA_DEPTHWISE_CONV_MAX_TAPS=25) and once in one lowering them as grouped
+  convolutions (XLA_DEPTHWISE_CONV_MAX_TAPS=0). Prints one CSV line per shape
+  and lowering.
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--backward', action='store_true')
+  parser.add_argument('--warmup', type=int, default=3)
+  parser.add_argument('--steps', type=int, default=20)
+  parser.add_argument('--child', action='store_true', help=argparse.SUPPRESS)
+  args = parser.parse_args()
+  if args.child:
+    run(args)
+    return
+  print('batch,channels,size,kernel,stride,multiplier,backward,taps,step_us')
+  sys.stdout.flush()
+  for max_taps in ('25', '0'):
+    env = dict(os.environ, XLA_DEPTHWISE_CONV_MAX_TAPS=max_taps)
+    subprocess.run([sys.executable, __file__, '--child'] + sys.argv[1:],
+                   env=env,
+                   check=True)
+
+
+if __name__ == '__main__':
+  main()
@@ -140,6 +140,12 @@ class ExperimentRunner:
                              benchmark_model.to_dict(), {"error": str(e)})
           continue
 
+        # Keep the host time breakdown of every sync of a run.
+        if self._args.breakdown_time:
+          process_env.setdefault(
+              "XLA_STEP_TIMELINE_SIZE",
+              str(max(1024, 4 * self._args.iterations_per_run)))
+
         # Setup HLO dumps.
         if self._args.dump_hlo:
           hlo_path = self._get_results_dir_path(experiment_cfg, model_cfg,
@@ -291,6 +297,9 @@ class ExperimentRunner:
       self._mark_step(benchmark_experiment)
     self._synchronize(benchmark_experiment)
     met.clear_all()
+    if benchmark_experiment.xla and not benchmark_experiment.torch_xla2:
+      met.clear_graph_stats()
+      met.clear_step_timeline()
     dynamo_utils.counters.clear()
     metrics = OrderedDict()
 
@@ -397,6 +406,11 @@ class ExperimentRunner:
         # Time is measured in nano-seconds
         metrics[f"xla_{m}_time_s"] = ns_to_s(total_time)
         metrics[f"xla_{m}_number"] = number
+      if self._args.breakdown_time and not benchmark_experiment.torch_xla2:
+        self._collect_time_breakdown(t_trace, metrics)
+      if not benchmark_experiment.torch_xla2:
+        self._collect_memory_metrics(experiment_config, model_config,
+                                     repeat_iteration, metrics)
 
     # Additional experiment metrics can be added here.
 
@@ -409,6 +423,65 @@ class ExperimentRunner:
 
     return metrics, output
 
+  def _collect_time_breakdown(self, trace_time, metrics):
+    # Splits the iterations between the host and the device: the tracing, the
+    # compilations, the host side of the syncs (besides compiling), the graph
+    # executions from dispatch to outputs ready, and the data transfers.
+    graph_stats = met.graph_stats().values()
+    compile_time = ns_to_s(sum(s["compile_ns"] for s in graph_stats))
+    execute_time = ns_to_s(sum(s["execute_ns"] for s in graph_stats))
+    records = met.step_timeline()
+    sync_host_ns = sum(r["host_ns"] for r in records)
+    sync_compile_ns = sum(r["stages_ns"].get("Compile", 0) for r in records)
+    transfer_time = 0
+    for m in ("TransferToDeviceTime", "TransferFromDeviceTime"):
+      data = met.metric_data(m)
+      if data is not None:
+        transfer_time += ns_to_s(data[1])
+    breakdown = OrderedDict(
+        trace=trace_time,
+        compile=compile_time,
+        host_dispatch=ns_to_s(max(sync_host_ns - sync_compile_ns, 0)),
+        device_execute=execute_time,
+        transfer=transfer_time)
+    for name, total_time in breakdown.items():
+      metrics[f"breakdown_{name}_per_iter_time"] = (
+          total_time / self._args.iterations_per_run)
+
+  def _collect_memory_metrics(self, experiment_config, model_config,
+                              repeat_iteration, metrics):
+    # The peak is the highest device memory usage since the device client was
+    # created, each configuration running in its own process.
+    try:
+      memory_info = xm.get_memory_info(xm.xla_device())
+      metrics["xla_peak_bytes_used"] = memory_info["peak_bytes_used"]
+    except RuntimeError:
+      # Not all the device allocators report their usage.
+      memory_info = None
+    # The compiler estimates of the graphs compiled so far. A graph losing the
+    # donation of its arguments shows as alias bytes turning into output
+    # bytes, and one making extra copies as more temporary bytes.
+    graph_stats = met.compiled_memory_stats()
+    if graph_stats:
+      stats = graph_stats.values()
+      metrics["xla_max_execution_bytes"] = max(
+          s["execution_bytes"] for s in stats)
+      for key in ("temp_bytes", "alias_bytes", "output_bytes"):
+        metrics[f"xla_total_{key}"] = sum(s[key] for s in stats)
+    if self._args.dump_memory_stats:
+      text = json.dumps(
+          {
+              "memory_info": memory_info,
+              "compiled_memory_stats": graph_stats
+          }, indent=2)
+      self._save_results_file(
+          text,
+          experiment_config,
+          model_config,
+          "memory-stats",
+          ext="json",
+          sub_dirname=str(repeat_iteration))
+
   def _prepare_inputs(self, example_inputs, should_randomize_input):
     inputs_list = []
     for i in range(self._args.iterations_per_run):
@@ -853,6 +926,21 @@ def parse_args(args=None):
       compile time and various counters. See also
       https://github.com/pytorch/xla/blob/master/TROUBLESHOOTING.md#get-a-metrics-report""",
   )
+  parser.add_argument(
+      "--breakdown-time",
+      action="store_true",
+      help="""Split the time of the XLA iterations between tracing,
+        compiling, host dispatch, device execution and data transfers, from
+        the per graph statistics and the step timeline, into the
+        `breakdown_*_per_iter_time` metrics.""",
+  )
+  parser.add_argument(
+      "--dump-memory-stats",
+      action="store_true",
+      help="""Dump the device memory usage and the compiled memory stats of
+        every XLA graph in the output directory. The peak usage and the
+        totals over the graphs are always part of the regular metrics.""",
+  )
   parser.add_argument(
       "--profile-cuda-cpu",
       action="store_true",
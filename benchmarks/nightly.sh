@@ -156,7 +156,7 @@ python xla/benchmarks/experiment_runner.py \
        --dynamo=None --dynamo=openxla --dynamo=openxla_eval \
        --suite-name=torchbench --accelerator=cuda \
        --output-dirname=${WORKSPACE_RESULTS_DIR:?} \
-       --repeat=${REPEAT:?} --print-subprocess \
+       --repeat=${REPEAT:?} --print-subprocess --breakdown-time \
        --timestamp=${TIMESTAMP:?} ${PROFILING_FLAGS?}
 # Inference + Training: Inductor Dynamo.
 python xla/benchmarks/experiment_runner.py \
@@ -0,0 +1,120 @@
+import argparse
+import time
+
+import torch
+
+import torch_xla.core.xla_model as xm
+import torch_xla.distributed.xla_multiprocessing as xmp
+
+from microbench import MicrobenchResults
+
+_FORWARD, _BACKWARD = 0, 1
+
+
+def channel_id(kind, boundary, microbatch, num_stages):
+  # One channel per direction, stage boundary and microbatch, so that the
+  # transfers of the microbatches are independent. Zero is not a valid channel.
+  return 1 + 2 * (microbatch * num_stages + boundary) + kind
+
+
+def one_f_one_b(num_stages, stage, num_microbatches):
+  """The schedule of a 1F1B pipeline stage, as (kind, microbatch) pairs."""
+  warmup = min(num_stages - stage - 1, num_microbatches)
+  schedule = [(_FORWARD, m) for m in range(warmup)]
+  for m in range(num_microbatches - warmup):
+    schedule += [(_FORWARD, warmup + m), (_BACKWARD, m)]
+  schedule += [(_BACKWARD, m)
+               for m in range(num_microbatches - warmup, num_microbatches)]
+  return schedule
+
+
+def train_step(stage_model, microbatches, token_per_channel):
+  num_stages, stage = xm.xrt_world_size(), xm.get_ordinal()
+  first, last = stage == 0, stage == num_stages - 1
+  inputs, outputs = {}, {}
+  for kind, m in one_f_one_b(num_stages, stage, len(microbatches)):
+    if kind == _FORWARD:
+      if first:
+        x = microbatches[m]
+      else:
+        x = xm.recv(
+            torch.empty_like(microbatches[m]),
+            channel_id(_FORWARD, stage - 1, m, num_stages),
+            token_per_channel=token_per_channel).requires_grad_()
+      inputs[m], outputs[m] = x, stage_model(x)
+      if not last:
+        xm.send(
+            outputs[m].detach(),
+            channel_id(_FORWARD, stage, m, num_stages),
+            token_per_channel=token_per_channel)
+    else:
+      if last:
+        outputs[m].sum().backward()
+      else:
+        grad = xm.recv(
+            torch.empty_like(outputs[m]),
+            channel_id(_BACKWARD, stage, m, num_stages),
+            token_per_channel=token_per_channel)
+        outputs[m].backward(grad)
+      if not first:
+        xm.send(
+            inputs[m].grad,
+            channel_id(_BACKWARD, stage - 1, m, num_stages),
+            token_per_channel=token_per_channel)
+  xm.mark_step()
+
+
+def time_steps(stage_model, microbatches, args, token_per_channel):
+  for _ in range(args.warmup):
+    train_step(stage_model, microbatches, token_per_channel)
+  xm.wait_device_ops()
+  start = time.perf_counter()
+  for _ in range(args.steps):
+    train_step(stage_model, microbatches, token_per_channel)
+  xm.wait_device_ops()
+  return (time.perf_counter() - start) * 1000 / args.steps
+
+
+def _mp_fn(index, args):
+  device = xm.xla_device()
+  layers = []
+  for _ in range(args.depth):
+    layers += [torch.nn.Linear(args.width, args.width), torch.nn.ReLU()]
+  stage_model = torch.nn.Sequential(*layers).to(device)
+  microbatches = [
+      torch.randn(args.batch, args.width, device=device)
+      for _ in range(args.microbatches)
+  ]
+  baseline_ms = time_steps(
+      stage_model, microbatches, args, token_per_channel=False)
+  testing_ms = time_steps(
+      stage_model, microbatches, args, token_per_channel=True)
+  if xm.is_master_ordinal():
+    print(
+        MicrobenchResults(
+            test_name=f'pipeline-1f1b-w{args.width}-mb{args.microbatches}',
+            testing_speedup=baseline_ms / testing_ms,
+            baseline_wall_ms=baseline_ms,
+            testing_wall_ms=testing_ms))
+
+
+def main():
+  """Benchmarks the training steps of a 1F1B pipeline with one stage per
+  replica, with the sends and receives between the stages sequenced by the
+  token of the collectives (baseline) and by a token per channel (testing).
+  With a token per channel, the transfers of different microbatches can be in
+  flight together.
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--width', type=int, default=4096)
+  parser.add_argument('--depth', type=int, default=4)
+  parser.add_argument('--batch', type=int, default=32)
+  parser.add_argument('--microbatches', type=int, default=8)
+  parser.add_argument('--warmup', type=int, default=3)
+  parser.add_argument('--steps', type=int, default=10)
+  args = parser.parse_args()
+  xmp.spawn(_mp_fn, args=(args,))
+
+
+if __name__ == '__main__':
+  main()
@@ -67,6 +67,15 @@ class ResultAnalyzer:
         "xla_median_trace_per_iter_time": pd.Series(dtype="float"),
         "xla_compile_time": pd.Series(dtype="float"),
         "dynamo_compile_time": pd.Series(dtype="float"),
+        "median_breakdown_trace_per_iter_time": pd.Series(dtype="float"),
+        "median_breakdown_compile_per_iter_time": pd.Series(dtype="float"),
+        "median_breakdown_host_dispatch_per_iter_time": pd.Series(
+            dtype="float"),
+        "median_breakdown_device_execute_per_iter_time": pd.Series(
+            dtype="float"),
+        "median_breakdown_transfer_per_iter_time": pd.Series(dtype="float"),
+        "median_xla_peak_bytes_used": pd.Series(dtype="float"),
+        "median_xla_max_execution_bytes": pd.Series(dtype="float"),
         "outputs_file": pd.Series(dtype="str"),
     })
     for file in jsonl_files:
@@ -0,0 +1,83 @@
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+import torch
+
+import torch_xla.core.xla_model as xm
+
+from microbench import MicrobenchResults
+
+
+def step(base, rows, values):
+  # An embedding gradient like update, with many duplicate rows.
+  result = base.index_put((rows,), values, accumulate=True)
+  xm.mark_step()
+  return result
+
+
+def run(args):
+  device = xm.xla_device()
+  base = torch.zeros(args.rows, args.width, device=device)
+  rows = torch.randint(0, args.distinct, (args.updates,), device=device)
+  values = torch.randn(args.updates, args.width, device=device)
+  for _ in range(args.warmup):
+    step(base, rows, values)
+  xm.wait_device_ops()
+  start = time.perf_counter()
+  for _ in range(args.steps):
+    step(base, rows, values)
+  xm.wait_device_ops()
+  step_ms = (time.perf_counter() - start) * 1000 / args.steps
+  print(f'step_ms={step_ms}', flush=True)
+
+
+def run_child(args, mode):
+  # The scatter indices mode is read once per process.
+  env = dict(os.environ, XLA_SCATTER_INDICES_MODE=mode)
+  cmd = [sys.executable, __file__, '--child'] + [
+      f'--{name}={getattr(args, name)}'
+      for name in ('rows', 'width', 'updates', 'distinct', 'warmup', 'steps')
+  ]
+  output = subprocess.run(
+      cmd, env=env, check=True, capture_output=True, text=True).stdout
+  for line in output.splitlines():
+    if line.startswith('step_ms='):
+      return float(line[len('step_ms='):])
+  raise RuntimeError(f'No step time in the benchmark output:\n{output}')
+
+
+def main():
+  """Benchmarks an accumulating index_put with many duplicate indices, with
+  the indices in program order (baseline) and with the sorted and the segment
+  reduced lowerings (testing).
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--child', action='store_true')
+  parser.add_argument('--rows', type=int, default=32768)
+  parser.add_argument('--width', type=int, default=256)
+  parser.add_argument('--updates', type=int, default=65536)
+  parser.add_argument('--distinct', type=int, default=512)
+  parser.add_argument('--warmup', type=int, default=3)
+  parser.add_argument('--steps', type=int, default=20)
+  args = parser.parse_args()
+  if args.child:
+    run(args)
+    return
+
+  baseline_ms = run_child(args, 'unsorted')
+  for mode in ('sorted', 'segment_reduce'):
+    testing_ms = run_child(args, mode)
+    print(
+        MicrobenchResults(
+            test_name=f'scatter-indices-{mode}-u{args.updates}'
+            f'-d{args.distinct}',
+            testing_speedup=baseline_ms / testing_ms,
+            baseline_wall_ms=baseline_ms,
+            testing_wall_ms=testing_ms))
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,159 @@
+import argparse
+import itertools
+import time
+
+import numpy as np
+import torch
+
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import torch_xla.distributed.spmd as xs
+import torch_xla.runtime as xr
+
+_STRATEGIES = ['dp', 'fsdp', 'tp', 'dp_tp']
+
+
+def mesh_shapes(num_devices):
+  """The (data, model) meshes spanning all the devices."""
+  return [(d, num_devices // d)
+          for d in range(1, num_devices + 1)
+          if num_devices % d == 0]
+
+
+def make_model(args, device):
+  torch.manual_seed(42)
+  layers = []
+  for _ in range(args.depth):
+    layers += [torch.nn.Linear(args.width, args.width), torch.nn.ReLU()]
+  return torch.nn.Sequential(*layers).to(device)
+
+
+def shard_model(model, strategy, mesh):
+  """Annotates the weights of the linear layers with the shardings of
+  `strategy`, the data parallel strategy keeping them replicated.
+  """
+  linears = [m for m in model if isinstance(m, torch.nn.Linear)]
+  for i, linear in enumerate(linears):
+    if strategy == 'fsdp':
+      xs.mark_sharding(linear.weight, mesh, (('data', 'model'), None))
+    elif strategy in ('tp', 'dp_tp'):
+      # Megatron style: the column parallel layers are followed by row
+      # parallel ones, which reduce their partial results.
+      spec = ('model', None) if i % 2 == 0 else (None, 'model')
+      xs.mark_sharding(linear.weight, mesh, spec)
+      if i % 2 == 0:
+        xs.mark_sharding(linear.bias, mesh, ('model',))
+
+
+def input_spec(strategy):
+  if strategy == 'tp':
+    return (None, None)
+  if strategy == 'fsdp':
+    return (('data', 'model'), None)
+  return ('data', None)
+
+
+class Config:
+
+  def __init__(self, args, mesh_shape, strategy, device):
+    self.mesh_shape = mesh_shape
+    self.strategy = strategy
+    num_devices = xr.global_runtime_device_count()
+    self.mesh = xs.Mesh(
+        np.arange(num_devices), mesh_shape, axis_names=('data', 'model'))
+    self.model = make_model(args, device)
+    shard_model(self.model, strategy, self.mesh)
+    self.optimizer = torch.optim.SGD(self.model.parameters(), lr=0.01)
+    self.batch = torch.randn(args.batch, args.width, device=device)
+    xs.mark_sharding(self.batch, self.mesh, input_spec(strategy))
+    self.loss = None
+
+  @property
+  def name(self):
+    return f'{self.mesh_shape[0]}x{self.mesh_shape[1]}-{self.strategy}'
+
+  def trace_step(self):
+    self.optimizer.zero_grad()
+    self.loss = self.model(self.batch).square().mean()
+    self.loss.backward()
+    self.optimizer.step()
+
+  def tensors(self):
+    return list(self.model.parameters()) + [self.loss]
+
+  def sync(self):
+    torch_xla._XLAC._xla_sync_multi(self.tensors(), devices=[], wait=True)
+
+
+def main():
+  """Sweeps the mesh shapes and sharding strategies of an SPMD training step.
+
+  Each configuration shards an MLP over a (data, model) mesh of all the
+  devices: data parallel (dp), weights sharded over all the devices (fsdp),
+  Megatron style tensor parallel (tp), or both (dp_tp). The steps of all the
+  configurations are traced first and compiled in a single batch, so that
+  they are built concurrently. Each one then runs on its own, and a CSV line
+  reports its step time, the execution memory estimated by the compiler,
+  and the bytes of its collectives.
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--width', type=int, default=4096)
+  parser.add_argument('--depth', type=int, default=4)
+  parser.add_argument('--batch', type=int, default=128)
+  parser.add_argument(
+      '--strategies', nargs='+', choices=_STRATEGIES, default=_STRATEGIES)
+  parser.add_argument(
+      '--meshes',
+      nargs='+',
+      default=None,
+      help='The DATAxMODEL mesh shapes, all by default.')
+  parser.add_argument('--warmup', type=int, default=2)
+  parser.add_argument('--steps', type=int, default=10)
+  args = parser.parse_args()
+
+  xr.use_spmd()
+  device = xm.xla_device()
+  num_devices = xr.global_runtime_device_count()
+  if args.meshes is None:
+    shapes = mesh_shapes(num_devices)
+  else:
+    shapes = [tuple(int(d) for d in mesh.split('x')) for mesh in args.meshes]
+  configs = [
+      Config(args, shape, strategy, device)
+      for shape, strategy in itertools.product(shapes, args.strategies)
+  ]
+
+  for config in configs:
+    config.trace_step()
+  start = time.perf_counter()
+  torch_xla._XLAC._xla_warm_up_cache_batch(
+      [config.tensors() for config in configs], [])
+  compile_seconds = time.perf_counter() - start
+  print(f'# compiled {len(configs)} configurations in '
+        f'{compile_seconds:.3f} s')
+
+  print('config,step_ms,execution_bytes,argument_bytes,collective_bytes,'
+        'collective_bus_bytes')
+  for config in configs:
+    config.sync()
+    graph_hash = xm.last_execution_future().graph_hash
+    for _ in range(args.warmup):
+      config.trace_step()
+      config.sync()
+    xm.wait_device_ops()
+    start = time.perf_counter()
+    for _ in range(args.steps):
+      config.trace_step()
+      config.sync()
+    xm.wait_device_ops()
+    step_ms = (time.perf_counter() - start) * 1000 / args.steps
+    stats = met.graph_stats().get(graph_hash, {})
+    print(f'{config.name},{step_ms:.3f},{stats.get("execution_bytes", -1)},'
+          f'{stats.get("argument_bytes", -1)},'
+          f'{stats.get("collective_bytes", -1)},'
+          f'{stats.get("collective_bus_bytes", -1):.0f}')
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,75 @@
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+os.environ.setdefault('PJRT_DEVICE', 'CPU')
+
+import torch
+
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+
+OPS = {
+    'inverse':
+        lambda a, b: torch.linalg.inv(a),
+    'triangular_solve':
+        lambda a, b: torch.triangular_solve(b, a, upper=True).solution,
+}
+
+
+def run(args):
+  device = xm.xla_device()
+  for size in args.sizes:
+    # Well conditioned matrices, close to the identity.
+    a = (torch.eye(size) + 0.1 * torch.randn(args.batch, size, size)).to(device)
+    b = torch.randn(args.batch, size, 4, device=device)
+    for name in args.ops:
+      met.clear_all()
+      for _ in range(args.warmup):
+        OPS[name](a, b)
+        xm.mark_step()
+      xm.wait_device_ops()
+      start = time.perf_counter()
+      for _ in range(args.steps):
+        OPS[name](a, b)
+        xm.mark_step()
+      xm.wait_device_ops()
+      step_us = (time.perf_counter() - start) / args.steps * 1e6
+      unrolled = (met.counter_value('SmallMatrixLowerings') or 0) > 0
+      print(f'{name},{size},{args.batch},{int(unrolled)},{step_us:.1f}')
+      sys.stdout.flush()
+
+
+def main():
+  """Compares the unrolled small matrix lowerings with the generic ones.
+
+  Times the steps of the inverse and the triangular solve of `--batch`
+  matrices of each of the `--sizes`, once in a process using the unrolled
+  lowerings and once in one with XLA_SMALL_MATRIX_MAX_SIZE=0, which uses the
+  generic XLA routines. Prints one CSV line per op, size and lowering.
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--sizes', type=int, nargs='+', default=[2, 3, 4])
+  parser.add_argument('--batch', type=int, default=65536)
+  parser.add_argument('--ops', nargs='+', default=list(OPS), choices=OPS)
+  parser.add_argument('--warmup', type=int, default=3)
+  parser.add_argument('--steps', type=int, default=20)
+  parser.add_argument('--child', action='store_true', help=argparse.SUPPRESS)
+  args = parser.parse_args()
+  if args.child:
+    run(args)
+    return
+  print('op,size,batch,unrolled,step_us')
+  sys.stdout.flush()
+  for max_size in ('4', '0'):
+    env = dict(os.environ, XLA_SMALL_MATRIX_MAX_SIZE=max_size)
+    subprocess.run([sys.executable, __file__, '--child'] + sys.argv[1:],
+                   env=env,
+                   check=True)
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,94 @@
+import argparse
+import json
+import math
+import os
+import time
+
+os.environ.setdefault('PJRT_DEVICE', 'CPU')
+os.environ.setdefault('XLA_STEP_TIMELINE_SIZE', '1024')
+
+import torch
+
+import torch_xla
+import torch_xla.core.xla_model as xm
+
+
+def make_model(kind, params, layers):
+  # The hidden size giving about `params` parameters, a layer holding about
+  # 8 (MLP) or 12 (transformer) squared hidden sizes.
+  if kind == 'mlp':
+    hidden = max(8, int(math.sqrt(params / (8 * layers))))
+    blocks = []
+    for _ in range(layers):
+      blocks += [
+          torch.nn.Linear(hidden, 4 * hidden),
+          torch.nn.GELU(),
+          torch.nn.Linear(4 * hidden, hidden),
+      ]
+    return torch.nn.Sequential(*blocks), (hidden,)
+  hidden = max(64, int(math.sqrt(params / (12 * layers))) // 8 * 8)
+  layer = torch.nn.TransformerEncoderLayer(
+      hidden, nhead=8, dim_feedforward=4 * hidden, batch_first=True)
+  return torch.nn.TransformerEncoder(layer, layers), (16, hidden)
+
+
+def main():
+  """Runs training steps of a synthetic model on the XLA CPU client once its
+  graph is compiled, and reports the host time per step of each stage of the
+  sync from the step timeline, along with the time spent tracing, which
+  includes the hashing of the IR nodes. The device time only shows in the
+  Execute stage, so the other stages track the host overheads independently of
+  the hardware.
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--model', choices=['mlp', 'transformer'], default='mlp')
+  parser.add_argument('--params', type=int, default=10_000_000)
+  parser.add_argument('--layers', type=int, default=8)
+  parser.add_argument('--batch', type=int, default=8)
+  parser.add_argument('--warmup', type=int, default=3)
+  parser.add_argument('--steps', type=int, default=20)
+  args = parser.parse_args()
+
+  device = xm.xla_device()
+  model, input_shape = make_model(args.model, args.params, args.layers)
+  model = model.to(device)
+  optimizer = torch.optim.SGD(model.parameters(), lr=1e-3)
+  data = torch.randn(args.batch, *input_shape, device=device)
+  num_params = sum(p.numel() for p in model.parameters())
+
+  def step():
+    optimizer.zero_grad()
+    loss = model(data).square().mean()
+    loss.backward()
+    optimizer.step()
+
+  for _ in range(args.warmup):
+    step()
+    xm.mark_step()
+  xm.wait_device_ops()
+  torch_xla._XLAC._clear_xla_step_timeline()
+
+  trace_seconds = 0.0
+  start = time.perf_counter()
+  for _ in range(args.steps):
+    trace_start = time.perf_counter()
+    step()
+    trace_seconds += time.perf_counter() - trace_start
+    xm.mark_step()
+  xm.wait_device_ops()
+  step_ms = (time.perf_counter() - start) * 1000 / args.steps
+
+  records = json.loads(torch_xla._XLAC._xla_step_timeline_json())
+  stages_ms = {'Trace': trace_seconds * 1000 / args.steps}
+  for record in records:
+    for stage, ns in record['stages_ns'].items():
+      stages_ms[stage] = stages_ms.get(stage, 0.0) + ns / 1e6 / args.steps
+  hits = sum(record['cache_hit'] for record in records)
+  print(f'{args.model}: params={num_params} step_ms={step_ms:.3f} '
+        f'cache_hits={hits}/{len(records)}')
+  for stage, ms in stages_ms.items():
+    print(f'  {stage}: {ms:.3f} ms/step')
+
+
+if __name__ == '__main__':
+  main()
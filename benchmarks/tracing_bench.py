@@ -0,0 +1,61 @@
+import argparse
+import time
+
+import torch
+
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+
+
+def trace_step(x, w, layers):
+  # The elementwise, view and matmul ops which dominate the traced graphs.
+  for _ in range(layers):
+    h = torch.mm(x, w.t())
+    h = torch.nn.functional.gelu(h + 1.0) * 0.5
+    x = h.view(h.shape[0], -1, 64).transpose(0, 1).reshape(x.shape)
+  return x
+
+
+def traced_op_count():
+  # The ops dispatched to XLA, each counted under its xla:: name.
+  return sum(
+      met.counter_value(name) or 0
+      for name in met.counter_names()
+      if name.startswith('xla::'))
+
+
+def main():
+  """Measures the host latency of the dispatch and tracing of the ops, the
+  device graph being cached after the warmup steps.
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--layers', type=int, default=200)
+  parser.add_argument('--warmup', type=int, default=3)
+  parser.add_argument('--steps', type=int, default=20)
+  args = parser.parse_args()
+
+  device = xm.xla_device()
+  x = torch.randn(64, 256, device=device)
+  w = torch.randn(256, 256, device=device)
+  for _ in range(args.warmup):
+    trace_step(x, w, args.layers)
+    xm.mark_step()
+  xm.wait_device_ops()
+
+  traced_ops = 0
+  trace_seconds = 0.0
+  for _ in range(args.steps):
+    start_ops = traced_op_count()
+    start = time.perf_counter()
+    trace_step(x, w, args.layers)
+    trace_seconds += time.perf_counter() - start
+    traced_ops += traced_op_count() - start_ops
+    xm.mark_step()
+  xm.wait_device_ops()
+  op_us = trace_seconds * 1e6 / traced_ops
+  step_ms = trace_seconds * 1000 / args.steps
+  print(f'tracing: ops={traced_ops} op_us={op_us:.3f} step_ms={step_ms:.3f}')
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,143 @@
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+import torch
+
+# The stages of the transfers, timed by the metrics of the same name.
+_STAGES = [
+    'TensorToData',
+    'AtenSourceConversion',
+    'ShardTensorToSources',
+    'TransferToDeviceTime',
+    'XlaDataToTensors',
+    'TransferFromDeviceTime',
+]
+
+# The environment and source dtype of each cast.
+_CASTS = {
+    'none': ({}, torch.float32),
+    'f32_to_bf16': ({
+        'XLA_USE_BF16': '1'
+    }, torch.float32),
+    'i64_to_i32': ({
+        'XLA_USE_32BIT_LONG': '1'
+    }, torch.int64),
+}
+
+
+def make_source(args, dtype):
+  rows = max(args.bytes // 4 // 1024, 1)
+  # Twice the columns for the strided source, which takes every other one.
+  cols = 2048 if args.layout == 'strided' else 1024
+  source = torch.ones(rows, cols, dtype=dtype)
+  return source[:, ::2] if args.layout == 'strided' else source
+
+
+def stage_ms(met, name):
+  data = met.metric_data(name)
+  return data[1] / 1e6 if data is not None else 0.0
+
+
+def run_child_benchmark(args):
+  import torch_xla
+  import torch_xla.core.xla_model as xm
+  import torch_xla.debug.metrics as met
+  import torch_xla.runtime as xr
+  import torch_xla.distributed.spmd as xs
+
+  if args.mode != 'device':
+    xr.use_spmd()
+  device = xm.xla_device()
+  mesh = None
+  if args.mode == 'sharded':
+    num_devices = xr.global_runtime_device_count()
+    mesh = xs.Mesh(list(range(num_devices)), (num_devices, 1))
+  source = make_source(args, _CASTS[args.cast][1])
+  source_bytes = source.numel() * source.element_size()
+
+  def upload():
+    tensor = source.to(device)
+    if mesh is not None:
+      xs.mark_sharding(tensor, mesh, (0, 1))
+    else:
+      # The virtual device defers the transfer to the first use.
+      torch_xla._XLAC._xla_sync_multi([tensor], devices=[], wait=True)
+    return tensor
+
+  for _ in range(args.warmup):
+    upload().cpu()
+  met.clear_all()
+  start = time.perf_counter()
+  for _ in range(args.iterations):
+    tensor = upload()
+  xm.wait_device_ops()
+  upload_s = (time.perf_counter() - start) / args.iterations
+  upload_stages = {name: stage_ms(met, name) for name in _STAGES}
+  met.clear_all()
+  start = time.perf_counter()
+  for _ in range(args.iterations):
+    tensor.cpu()
+  download_s = (time.perf_counter() - start) / args.iterations
+  download_stages = {name: stage_ms(met, name) for name in _STAGES}
+
+  label = f'{args.mode},{args.cast},{args.layout},{source_bytes}'
+  for direction, seconds, stages in (('upload', upload_s, upload_stages),
+                                     ('download', download_s,
+                                      download_stages)):
+    per_iter = ','.join(f'{stages[name] / args.iterations:.3f}'
+                        for name in _STAGES)
+    print(f'{label},{direction},{source_bytes / seconds / 1e9:.3f},{per_iter}')
+
+
+def main():
+  """Benchmarks the host data path of the transfers: the uploads of CPU
+  tensors to a device, replicated on the SPMD virtual device or sharded along
+  their rows over all the devices, with or without a dtype cast, from
+  contiguous or strided sources, and their downloads. Prints as CSV the
+  bandwidth of each case and the time per transfer of each of its stages in
+  milliseconds, each case running in its own process as the SPMD and cast
+  modes are process wide.
+  """
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--child', action='store_true')
+  parser.add_argument('--modes', default='device,replicated,sharded')
+  parser.add_argument('--casts', default=','.join(_CASTS))
+  parser.add_argument('--layouts', default='contiguous,strided')
+  parser.add_argument(
+      '--sizes',
+      type=lambda s: [int(x) for x in s.split(',')],
+      default=[1 << 20, 1 << 24, 1 << 28])
+  parser.add_argument('--warmup', type=int, default=2)
+  parser.add_argument('--iterations', type=int, default=10)
+  # The case of a child.
+  parser.add_argument('--mode', default='device')
+  parser.add_argument('--cast', default='none')
+  parser.add_argument('--layout', default='contiguous')
+  parser.add_argument('--bytes', type=int, default=1 << 20)
+  args = parser.parse_args()
+  if args.child:
+    run_child_benchmark(args)
+    return
+
+  print('mode,cast,layout,bytes,direction,gbps,' +
+        ','.join(f'{name}_ms' for name in _STAGES))
+  for mode in args.modes.split(','):
+    for cast in args.casts.split(','):
+      for layout in args.layouts.split(','):
+        for size in args.sizes:
+          env = dict(os.environ, **_CASTS[cast][0])
+          cmd = [
+              sys.executable, __file__, '--child', f'--mode={mode}',
+              f'--cast={cast}', f'--layout={layout}', f'--bytes={size}',
+              f'--warmup={args.warmup}', f'--iterations={args.iterations}'
+          ]
+          output = subprocess.run(
+              cmd, env=env, check=True, capture_output=True, text=True).stdout
+          print(output, end='', flush=True)
+
+
+if __name__ == '__main__':
+  main()
@@ -25,6 +25,10 @@
 #   XLA_CPU_USE_ACL=0
 #     whether to use ACL
 #
+#   XLA_RELEASE_HOT_PATH=0
+#     strip the verbose logging and the per-argument checks of the execution
+#     hot paths
+#
 #   BUNDLE_LIBTPU=0
 #     include libtpu in final wheel
 
@@ -0,0 +1,142 @@
+// Benchmarks of the host cost of tracing: the dispatch of the ATen ops down to
+// the creation of their IR nodes, then the hashing, post order and lowering of
+// the traced graphs, over transformer layers of several depths.
+//
+//   bazel run //test/cpp:bench_tracing -- --benchmark_filter=Trace
+
+#include <ATen/ATen.h>
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "test/cpp/cpp_test_util.h"
+#include "torch_xla/csrc/aten_xla_bridge.h"
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/tensor.h"
+#include "torch_xla/csrc/xla_backend_impl.h"
+#include "torch_xla/csrc/xla_graph_executor.h"
+
+namespace torch_xla {
+namespace cpp_test {
+namespace {
+
+constexpr int64_t kSequence = 128;
+constexpr int64_t kHidden = 256;
+constexpr int64_t kHeads = 4;
+
+static bool xla_backend_inited = InitXlaBackend();
+
+struct LayerWeights {
+  at::Tensor ln_weight;
+  at::Tensor ln_bias;
+  at::Tensor wq;
+  at::Tensor wk;
+  at::Tensor wv;
+  at::Tensor wo;
+  at::Tensor w1;
+  at::Tensor w2;
+};
+
+const LayerWeights& GetWeights() {
+  static const LayerWeights* weights = [] {
+    c10::Device device = bridge::AtenDefaultDevice();
+    auto param = [&](std::vector<int64_t> sizes) {
+      return CopyToDevice(at::rand(sizes), device);
+    };
+    return new LayerWeights{param({kHidden}),
+                            param({kHidden}),
+                            param({kHidden, kHidden}),
+                            param({kHidden, kHidden}),
+                            param({kHidden, kHidden}),
+                            param({kHidden, kHidden}),
+                            param({kHidden, 4 * kHidden}),
+                            param({4 * kHidden, kHidden})};
+  }();
+  return *weights;
+}
+
+at::Tensor LayerNorm(const at::Tensor& x, const LayerWeights& w) {
+  at::Tensor centered = x - x.mean(/*dim=*/-1, /*keepdim=*/true);
+  at::Tensor variance =
+      (centered * centered).mean(/*dim=*/-1, /*keepdim=*/true);
+  return centered * at::rsqrt(variance + 1e-5) * w.ln_weight + w.ln_bias;
+}
+
+at::Tensor Heads(const at::Tensor& x) {
+  return x.view({kSequence, kHeads, kHidden / kHeads}).transpose(0, 1);
+}
+
+// Traces `layers` pre-norm transformer layers over `x`, sharing the weights.
+at::Tensor TraceLayers(at::Tensor x, int64_t layers) {
+  const LayerWeights& w = GetWeights();
+  for (int64_t i = 0; i < layers; ++i) {
+    at::Tensor h = LayerNorm(x, w);
+    at::Tensor q = Heads(at::matmul(h, w.wq));
+    at::Tensor k = Heads(at::matmul(h, w.wk));
+    at::Tensor v = Heads(at::matmul(h, w.wv));
+    at::Tensor scores =
+        at::softmax(at::matmul(q, k.transpose(1, 2)) * 0.125, /*dim=*/-1);
+    at::Tensor attention =
+        at::matmul(scores, v).transpose(0, 1).reshape({kSequence, kHidden});
+    x = x + at::matmul(attention, w.wo);
+    h = LayerNorm(x, w);
+    x = x + at::matmul(at::gelu(at::matmul(h, w.w1)), w.w2);
+  }
+  return x;
+}
+
+at::Tensor GetInput() {
+  static const at::Tensor* input = new at::Tensor(CopyToDevice(
+      at::rand({kSequence, kHidden}), bridge::AtenDefaultDevice()));
+  return *input;
+}
+
+void BM_TraceLayers(benchmark::State& state) {
+  at::Tensor input = GetInput();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(TraceLayers(input, state.range(0)));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_GraphHash(benchmark::State& state) {
+  std::vector<XLATensorPtr> tensors = {
+      bridge::GetXlaTensor(TraceLayers(GetInput(), state.range(0)))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(XLAGraphExecutor::Get()->GetGraphHash(tensors));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_PostOrder(benchmark::State& state) {
+  at::Tensor output = TraceLayers(GetInput(), state.range(0));
+  torch::lazy::Value root = bridge::GetXlaTensor(output)->GetIrValue();
+  std::vector<const torch::lazy::Node*> roots = {root.node.get()};
+  for (auto _ : state) {
+    torch::lazy::Util::EmissionMap emission_map;
+    benchmark::DoNotOptimize(
+        torch::lazy::Util::ComputePostOrder(roots, &emission_map));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_Lower(benchmark::State& state) {
+  at::Tensor output = TraceLayers(GetInput(), state.range(0));
+  XLATensorPtr xla_output = bridge::GetXlaTensor(output);
+  torch::lazy::Value root = xla_output->GetIrValue();
+  for (auto _ : state) {
+    LoweringContext lowering_ctx("BenchLower", xla_output->GetDevice());
+    lowering_ctx.AddResult(torch::lazy::Output(root.node.get(), root.index));
+    benchmark::DoNotOptimize(lowering_ctx.BuildXla());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_TraceLayers)->Arg(1)->Arg(8)->Arg(32);
+BENCHMARK(BM_GraphHash)->Arg(1)->Arg(8)->Arg(32);
+BENCHMARK(BM_PostOrder)->Arg(1)->Arg(8)->Arg(32);
+BENCHMARK(BM_Lower)->Arg(1)->Arg(8)->Arg(32);
+
+}  // namespace
+}  // namespace cpp_test
+}  // namespace torch_xla
@@ -1,5 +1,7 @@
 #include "test/cpp/metrics_snapshot.h"
 
+#include <algorithm>
+#include <limits>
 #include <regex>
 
 #include "torch/csrc/lazy/core/metrics.h"
@@ -29,6 +31,15 @@ MetricsSnapshot::MetricsSnapshot() {
     auto* counter = torch::lazy::GetCounter(name);
     counters_map_.emplace(name, counter->Value());
   }
+  for (auto& name : torch::lazy::GetMetricNames()) {
+    torch::lazy::MetricData* metric = torch::lazy::GetMetric(name);
+    MetricSamples msamples;
+    for (auto& sample :
+         metric->Samples(&msamples.accumulator, &msamples.total_samples)) {
+      msamples.samples.emplace_back(sample.timestamp_ns, sample.value);
+    }
+    metrics_map_.emplace(name, std::move(msamples));
+  }
 }
 
 std::vector<MetricsSnapshot::ChangedCounter> MetricsSnapshot::CounterChanged(
@@ -81,6 +92,48 @@ std::string MetricsSnapshot::DumpDifferences(
   return ss.str();
 }
 
+int64_t MetricsSnapshot::CounterDelta(const std::string& name,
+                                      const MetricsSnapshot& after) const {
+  return torch_xla::runtime::util::FindOr(after.counters_map_, name, 0) -
+         torch_xla::runtime::util::FindOr(counters_map_, name, 0);
+}
+
+size_t MetricsSnapshot::MetricSamplesDelta(const std::string& name,
+                                           const MetricsSnapshot& after) const {
+  auto after_it = after.metrics_map_.find(name);
+  if (after_it == after.metrics_map_.end()) {
+    return 0;
+  }
+  auto it = metrics_map_.find(name);
+  size_t start_samples =
+      it != metrics_map_.end() ? it->second.total_samples : 0;
+  return after_it->second.total_samples - start_samples;
+}
+
+double MetricsSnapshot::MaxMetricValue(const std::string& name,
+                                       const MetricsSnapshot& after) const {
+  auto after_it = after.metrics_map_.find(name);
+  if (after_it == after.metrics_map_.end()) {
+    return 0;
+  }
+  // The samples are retained in a ring buffer, the new ones being the ones
+  // taken after the last sample of this snapshot.
+  int64_t start_ns = std::numeric_limits<int64_t>::min();
+  auto it = metrics_map_.find(name);
+  if (it != metrics_map_.end() && !it->second.samples.empty()) {
+    for (auto& sample : it->second.samples) {
+      start_ns = std::max(start_ns, sample.timestamp_ns);
+    }
+  }
+  double max_value = 0;
+  for (auto& sample : after_it->second.samples) {
+    if (sample.timestamp_ns > start_ns) {
+      max_value = std::max(max_value, sample.value);
+    }
+  }
+  return max_value;
+}
+
 void MetricsSnapshot::DumpMetricDifference(const std::string& name,
                                            const MetricSamples& before,
                                            const MetricSamples& after,
@@ -90,5 +143,56 @@ void MetricsSnapshot::DumpMetricDifference(const std::string& name,
       << (after.total_samples - before.total_samples) << " samples\n";
 }
 
+PerfContract& PerfContract::MaxCounterDelta(const std::string& name,
+                                            int64_t max) {
+  max_counter_deltas_.emplace_back(name, max);
+  return *this;
+}
+
+PerfContract& PerfContract::MaxMetricSamples(const std::string& name,
+                                             size_t max) {
+  max_metric_samples_.emplace_back(name, max);
+  return *this;
+}
+
+PerfContract& PerfContract::MaxMetricValue(const std::string& name,
+                                           double max) {
+  max_metric_values_.emplace_back(name, max);
+  return *this;
+}
+
+std::vector<std::string> PerfContract::Violations(
+    const MetricsSnapshot& before, const MetricsSnapshot& after) const {
+  std::vector<std::string> violations;
+  for (auto& name_max : max_counter_deltas_) {
+    int64_t delta = before.CounterDelta(name_max.first, after);
+    if (delta > name_max.second) {
+      std::stringstream ss;
+      ss << "Counter '" << name_max.first << "' increased by " << delta
+         << ", more than " << name_max.second;
+      violations.push_back(ss.str());
+    }
+  }
+  for (auto& name_max : max_metric_samples_) {
+    size_t delta = before.MetricSamplesDelta(name_max.first, after);
+    if (delta > name_max.second) {
+      std::stringstream ss;
+      ss << "Metric '" << name_max.first << "' collected " << delta
+         << " samples, more than " << name_max.second;
+      violations.push_back(ss.str());
+    }
+  }
+  for (auto& name_max : max_metric_values_) {
+    double value = before.MaxMetricValue(name_max.first, after);
+    if (value > name_max.second) {
+      std::stringstream ss;
+      ss << "Metric '" << name_max.first << "' sampled " << value
+         << ", more than " << name_max.second;
+      violations.push_back(ss.str());
+    }
+  }
+  return violations;
+}
+
 }  // namespace cpp_test
 }  // namespace torch_xla
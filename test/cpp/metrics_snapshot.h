@@ -5,6 +5,7 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "torch_xla/csrc/runtime/metrics.h"
@@ -31,6 +32,20 @@ class MetricsSnapshot {
       const MetricsSnapshot& after,
       const std::unordered_set<std::string>* ignore_set) const;
 
+  // The increment of the counter `name` from this snapshot to `after`.
+  int64_t CounterDelta(const std::string& name,
+                       const MetricsSnapshot& after) const;
+
+  // The number of samples the metric `name` collected from this snapshot to
+  // `after`.
+  size_t MetricSamplesDelta(const std::string& name,
+                            const MetricsSnapshot& after) const;
+
+  // The largest value of the samples the metric `name` collected from this
+  // snapshot to `after`, among the ones the metric still retains, or 0.
+  double MaxMetricValue(const std::string& name,
+                        const MetricsSnapshot& after) const;
+
  private:
   struct MetricSamples {
     std::vector<torch_xla::runtime::metrics::Sample> samples;
@@ -47,6 +62,31 @@ class MetricsSnapshot {
   std::unordered_map<std::string, int64_t> counters_map_;
 };
 
+// The upper bounds a workload must stay within between two snapshots, as the
+// counters of compilations or executions a step is expected to pay, so that
+// the performance regressions fail the tests rather than showing up in the
+// benchmarks only.
+class PerfContract {
+ public:
+  // At most `max` increments of the counter `name`, like UncachedCompile.
+  PerfContract& MaxCounterDelta(const std::string& name, int64_t max);
+
+  // At most `max` new samples of the metric `name`, like ExecuteTime.
+  PerfContract& MaxMetricSamples(const std::string& name, size_t max);
+
+  // No new sample of the metric `name` above `max`, like TensorsGraphSize.
+  PerfContract& MaxMetricValue(const std::string& name, double max);
+
+  // The descriptions of the bounds exceeded from `before` to `after`.
+  std::vector<std::string> Violations(const MetricsSnapshot& before,
+                                      const MetricsSnapshot& after) const;
+
+ private:
+  std::vector<std::pair<std::string, int64_t>> max_counter_deltas_;
+  std::vector<std::pair<std::string, size_t>> max_metric_samples_;
+  std::vector<std::pair<std::string, double>> max_metric_values_;
+};
+
 }  // namespace cpp_test
 }  // namespace torch_xla
 
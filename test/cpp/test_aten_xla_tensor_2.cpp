@@ -1974,6 +1974,19 @@ TEST_F(AtenXlaTensorTest, TestCumSum) {
   }
 }
 
+TEST_F(AtenXlaTensorTest, TestCumSumLongDim) {
+  torch::Tensor input =
+      torch::rand({2, 3000}, torch::TensorOptions(torch::kFloat));
+  torch::Tensor result = torch::cumsum(input, 1);
+  ForEachDevice([&](const torch::Device& device) {
+    torch::Tensor xla_input = CopyToDevice(input, device);
+    torch::Tensor xla_result = torch::cumsum(xla_input, 1);
+    AllClose(result, xla_result, /*rtol=*/1e-4, /*atol=*/1e-2);
+  });
+  ExpectCounterNotChanged("aten::.*", cpp_test::GetIgnoredCounters());
+  ExpectCounterChanged("xla::cumsum", cpp_test::GetIgnoredCounters());
+}
+
 TEST_F(AtenXlaTensorTest, TestCumSumCast) {
   torch::Tensor input =
       torch::rand({4, 3, 4}, torch::TensorOptions(torch::kFloat));
@@ -2032,6 +2045,19 @@ TEST_F(AtenXlaTensorTest, TestCumProd) {
   }
 }
 
+TEST_F(AtenXlaTensorTest, TestCumProdLongDim) {
+  torch::Tensor input = torch::add(
+      torch::mul(torch::rand({3, 2048}, torch::TensorOptions(torch::kFloat)),
+                 1e-3),
+      1.0);
+  torch::Tensor result = torch::cumprod(input, -1);
+  ForEachDevice([&](const torch::Device& device) {
+    torch::Tensor xla_input = CopyToDevice(input, device);
+    torch::Tensor xla_result = torch::cumprod(xla_input, -1);
+    AllClose(result, xla_result, /*rtol=*/1e-4, /*atol=*/1e-4);
+  });
+}
+
 TEST_F(AtenXlaTensorTest, TestCumProdCast) {
   torch::Tensor input = torch::mul(
       torch::rand({4, 3, 4}, torch::TensorOptions(torch::kFloat)), 10);
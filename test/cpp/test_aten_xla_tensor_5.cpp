@@ -288,6 +288,37 @@ TEST_F(AtenXlaTensorTest, TestEmbeddingBag) {
   });
 }
 
+TEST_F(AtenXlaTensorTest, TestEmbeddingBagModes) {
+  torch::Tensor weight =
+      torch::randn({32, 4}, torch::TensorOptions(torch::kFloat));
+  torch::Tensor indices =
+      torch::randint(0, 31, {10}, torch::TensorOptions(torch::kLong));
+  // The second bag is empty.
+  torch::Tensor offsets =
+      torch::tensor({0, 3, 3, 7, 9}, torch::TensorOptions(torch::kLong));
+  for (int64_t mode : {0, 1, 2}) {
+    for (bool include_last_offset : {false, true}) {
+      auto out = torch::embedding_bag(
+          weight, indices, offsets, /*scale_grad_by_freq=*/false, mode,
+          /*sparse=*/false, /*per_sample_weights=*/{}, include_last_offset);
+      torch::Tensor result = std::get<0>(out);
+      ForEachDevice([&](const torch::Device& device) {
+        torch::Tensor xla_weight = CopyToDevice(weight, device);
+        torch::Tensor xla_indices = CopyToDevice(indices, device);
+        torch::Tensor xla_offsets = CopyToDevice(offsets, device);
+        auto xla_out = torch::embedding_bag(
+            xla_weight, xla_indices, xla_offsets,
+            /*scale_grad_by_freq=*/false, mode, /*sparse=*/false,
+            /*per_sample_weights=*/{}, include_last_offset);
+        AllClose(result, std::get<0>(xla_out));
+      });
+    }
+  }
+  ExpectCounterNotChanged("aten::.*", cpp_test::GetIgnoredCounters());
+  ExpectCounterChanged("xla::_embedding_bag_forward_only",
+                       cpp_test::GetIgnoredCounters());
+}
+
 TEST_F(AtenXlaTensorTest, TestOneHot) {
   int num_classes = 5;
   torch::Tensor input =
@@ -4,17 +4,28 @@
 
 #include "test/cpp/cpp_test_util.h"
 #include "test/cpp/torch_xla_test.h"
+#include "torch_xla/csrc/all_reduce_buckets.h"
+#include "torch_xla/csrc/cross_replica_reduces.h"
+#include "torch_xla/csrc/elementwise.h"
+#include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/ir.h"
+#include "torch_xla/csrc/ir_arena.h"
 #include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/node_deduplicator.h"
+#include "torch_xla/csrc/ops/all_reduce.h"
 #include "torch_xla/csrc/ops/arithmetic_ir_ops.h"
 #include "torch_xla/csrc/ops/dynamic_ir.h"
 #include "torch_xla/csrc/ops/expand.h"
 #include "torch_xla/csrc/ops/nonzero.h"
 #include "torch_xla/csrc/ops/ops.h"
+#include "torch_xla/csrc/ops/ops_xla_shape_fn.h"
 #include "torch_xla/csrc/ops/scalar.h"
 #include "torch_xla/csrc/ops/select.h"
 #include "torch_xla/csrc/ops/unselect.h"
 #include "torch_xla/csrc/ops/update_slice.h"
+#include "torch_xla/csrc/parallel_lowering.h"
+#include "torch_xla/csrc/reduction.h"
+#include "torch_xla/csrc/view.h"
 
 namespace torch_xla {
 namespace cpp_test {
@@ -26,6 +37,69 @@ TEST_F(IrTest, TestScalarCreate) {
   ASSERT_TRUE(scalar != nullptr);
 }
 
+TEST_F(IrTest, TestNodeArenaReuse) {
+  if (!ir_arena::Enabled()) {
+    GTEST_SKIP() << "XLA_IR_NODE_ARENA is disabled";
+  }
+  const void* freed = nullptr;
+  {
+    torch::lazy::NodePtr scalar = ScalarOp(1.0, xla::F32);
+    freed = scalar.get();
+  }
+  // The block of the freed node is the first one reused in its size class.
+  torch::lazy::NodePtr scalar = ScalarOp(2.0, xla::F32);
+  EXPECT_EQ(scalar.get(), freed);
+}
+
+TEST_F(IrTest, TestNodeArenaChain) {
+  torch::lazy::Value value(ScalarOp(1.0, xla::F32), 0);
+  torch::lazy::hash_t hash = value->hash();
+  for (int i = 0; i < 10000; ++i) {
+    value = value + torch::lazy::Value(ScalarOp(1.0, xla::F32), 0);
+  }
+  size_t slab_bytes = ir_arena::SlabBytes();
+  value = torch::lazy::Value(ScalarOp(1.0, xla::F32), 0);
+  EXPECT_EQ(value->hash(), hash);
+  // Tracing the same graph again reuses the freed blocks.
+  for (int i = 0; i < 10000; ++i) {
+    value = value + torch::lazy::Value(ScalarOp(1.0, xla::F32), 0);
+  }
+  EXPECT_EQ(ir_arena::SlabBytes(), slab_bytes);
+}
+
+TEST_F(IrTest, TestClosedFormShapes) {
+  // The closed form shapes match the ones inferred from the lowerings.
+  torch::lazy::Value lhs(
+      ScalarOp(1.0, xla::ShapeUtil::MakeShape(xla::F32, {4, 1, 3})), 0);
+  torch::lazy::Value rhs(
+      ScalarOp(1, xla::ShapeUtil::MakeShape(xla::S32, {5, 1})), 0);
+  auto comparison_fn =
+      [](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
+    return BuildComparisonOp(at::aten::lt, operands[0], operands[1]);
+  };
+  EXPECT_EQ(
+      LtScalarOutputShape(lhs, rhs),
+      InferOutputShape({GetXlaShape(lhs), GetXlaShape(rhs)}, comparison_fn));
+  EXPECT_EQ(MaximumOutputShape(lhs, rhs),
+            XlaHelpers::GetPromotedBinaryOpShape(GetXlaShape(lhs),
+                                                 GetXlaShape(rhs)));
+  for (bool keepdim : {false, true}) {
+    auto amax_fn = [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
+      return BuildMaxInDims(operands[0], {-1, 0}, keepdim);
+    };
+    EXPECT_EQ(AmaxOutputShape(lhs, {-1, 0}, keepdim),
+              InferOutputShape({GetXlaShape(lhs)}, amax_fn));
+    for (c10::optional<int64_t> dim : {c10::optional<int64_t>(), {1}}) {
+      auto argmax_fn =
+          [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
+        return BuildArgMax(operands[0], dim ? *dim : -1, keepdim);
+      };
+      EXPECT_EQ(ArgmaxOutputShape(lhs, dim, keepdim),
+                InferOutputShape({GetXlaShape(lhs)}, argmax_fn));
+    }
+  }
+}
+
 TEST_F(IrTest, TestHash) {
   torch::lazy::NodePtr scalar1 = ScalarOp(1.0, xla::F32);
   torch::lazy::NodePtr scalar2 = ScalarOp(2.0, xla::F32);
@@ -361,5 +435,199 @@ TEST_F(IrTest, TestSizeDivNodeDynamicByZero) {
   EXPECT_THROW(dim_node_div->getDynamicValue(), std::runtime_error);
 }
 
+TEST_F(IrTest, TestAllReduceBuckets) {
+  ForEachDevice([&](const torch::lazy::BackendDevice& device) {
+    at::Tensor a = at::rand({4, 3}, at::TensorOptions(at::kFloat));
+    at::Tensor b = at::rand({5}, at::TensorOptions(at::kFloat));
+    std::vector<std::vector<int64_t>> groups;
+    // Two all-reduces chained by their token, as issued for two gradients.
+    torch::lazy::NodePtr reduce_a = torch::lazy::MakeNode<AllReduce>(
+        AllReduceType::kSum,
+        std::vector<torch::lazy::Value>{GetTensorIrValue(a, device)},
+        GetAllReduceToken(device), /*scale=*/1.0, groups,
+        /*pin_layout=*/false);
+    torch::lazy::NodePtr reduce_b = torch::lazy::MakeNode<AllReduce>(
+        AllReduceType::kSum,
+        std::vector<torch::lazy::Value>{GetTensorIrValue(b, device)},
+        torch::lazy::Value(reduce_a, 1), /*scale=*/1.0, groups,
+        /*pin_layout=*/false);
+    std::vector<torch::lazy::Value> roots = {torch::lazy::Value(reduce_a, 0),
+                                             torch::lazy::Value(reduce_b, 0),
+                                             torch::lazy::Value(reduce_b, 1)};
+    std::vector<const torch::lazy::Node*> root_nodes = {reduce_a.get(),
+                                                        reduce_b.get()};
+    torch::lazy::Util::EmissionMap emission_map;
+    std::vector<const torch::lazy::Node*> post_order =
+        torch::lazy::Util::ComputePostOrder(root_nodes, &emission_map);
+
+    EXPECT_EQ(AllReduceBuckets(post_order, /*max_bucket_bytes=*/0).size(), 0);
+    EXPECT_EQ(AllReduceBuckets(post_order, /*max_bucket_bytes=*/16).size(), 0);
+    AllReduceBuckets buckets(post_order, /*max_bucket_bytes=*/1 << 20);
+    EXPECT_EQ(buckets.size(), 1);
+
+    LoweringContext lowering_ctx("AllReduceBuckets", device, {},
+                                 std::move(emission_map));
+    for (const torch::lazy::Node* node : post_order) {
+      buckets.LowerNode(node, &lowering_ctx);
+    }
+    for (const torch::lazy::Value& root : roots) {
+      lowering_ctx.AddResult(lowering_ctx.GetOutputOp(
+          torch::lazy::Output(root.node.get(), root.index)));
+    }
+    xla::XlaComputation computation = ConsumeValue(lowering_ctx.BuildXla());
+    int64_t all_reduces = 0;
+    for (const auto& hlo_computation : computation.proto().computations()) {
+      for (const auto& instruction : hlo_computation.instructions()) {
+        all_reduces += instruction.opcode() == "all-reduce";
+      }
+    }
+    EXPECT_EQ(all_reduces, 1);
+    xla::ProgramShape program_shape =
+        ConsumeValue(computation.GetProgramShape());
+    EXPECT_TRUE(xla::ShapeUtil::Compatible(
+        program_shape.result().tuple_shapes(0),
+        xla::ShapeUtil::MakeShape(xla::F32, {4, 3})));
+    EXPECT_TRUE(
+        xla::ShapeUtil::Compatible(program_shape.result().tuple_shapes(1),
+                                   xla::ShapeUtil::MakeShape(xla::F32, {5})));
+  });
+}
+
+TEST_F(IrTest, TestHierarchicalReduceGroups) {
+  using Groups = std::vector<std::vector<int64_t>>;
+  std::optional<HierarchicalReduceGroups> hierarchy =
+      GetHierarchicalReduceGroups({}, /*num_replicas=*/8, /*host_size=*/4);
+  ASSERT_TRUE(hierarchy.has_value());
+  EXPECT_EQ(hierarchy->intra_host, Groups({{0, 1, 2, 3}, {4, 5, 6, 7}}));
+  EXPECT_EQ(hierarchy->inter_host, Groups({{0, 4}, {1, 5}, {2, 6}, {3, 7}}));
+
+  hierarchy = GetHierarchicalReduceGroups({{0, 1, 4, 5}, {2, 3, 6, 7}},
+                                          /*num_replicas=*/8, /*host_size=*/4);
+  ASSERT_TRUE(hierarchy.has_value());
+  EXPECT_EQ(hierarchy->intra_host, Groups({{0, 1}, {4, 5}, {2, 3}, {6, 7}}));
+  EXPECT_EQ(hierarchy->inter_host, Groups({{0, 4}, {1, 5}, {2, 6}, {3, 7}}));
+
+  // A single host, uneven hosts and a single replica per host.
+  EXPECT_FALSE(GetHierarchicalReduceGroups({}, 8, 8).has_value());
+  EXPECT_FALSE(GetHierarchicalReduceGroups({{0, 1, 2, 4}, {3, 5, 6, 7}}, 8, 4)
+                   .has_value());
+  EXPECT_FALSE(
+      GetHierarchicalReduceGroups({{0, 4}, {1, 5}, {2, 6}, {3, 7}}, 8, 4)
+          .has_value());
+  EXPECT_FALSE(GetHierarchicalReduceGroups({}, 8, 1).has_value());
+}
+
+TEST_F(IrTest, TestNodeDeduplicator) {
+  ForEachDevice([&](const torch::lazy::BackendDevice& device) {
+    at::Tensor a = at::rand({4, 3}, at::TensorOptions(at::kFloat));
+    at::Tensor b = at::rand({4, 3}, at::TensorOptions(at::kFloat));
+    torch::lazy::Value input_a = GetTensorIrValue(a, device);
+    torch::lazy::Value input_b = GetTensorIrValue(b, device);
+    // The same expression traced twice over a, and once over b which hashes
+    // alike.
+    torch::lazy::Value sum1(
+        input_a + torch::lazy::Value(ScalarOp(2.0, xla::F32), 0), 0);
+    torch::lazy::Value sum2(
+        input_a + torch::lazy::Value(ScalarOp(2.0, xla::F32), 0), 0);
+    torch::lazy::Value sum3(
+        input_b + torch::lazy::Value(ScalarOp(2.0, xla::F32), 0), 0);
+    std::vector<const torch::lazy::Node*> root_nodes = {
+        sum1.node.get(), sum2.node.get(), sum3.node.get()};
+    torch::lazy::Util::EmissionMap emission_map;
+    std::vector<const torch::lazy::Node*> post_order =
+        torch::lazy::Util::ComputePostOrder(root_nodes, &emission_map);
+
+    LoweringContext lowering_ctx("NodeDeduplicator", device, {},
+                                 std::move(emission_map));
+    NodeDeduplicator deduplicator;
+    for (const torch::lazy::Node* node : post_order) {
+      if (!deduplicator.TryReuse(node, &lowering_ctx)) {
+        lowering_ctx.LowerNode(node);
+      }
+    }
+    // The two extra scalars and the second sum over a.
+    EXPECT_EQ(deduplicator.removed_nodes(), 3);
+    auto output_op = [&](const torch::lazy::Value& value) {
+      return lowering_ctx.GetOutputOp(
+          torch::lazy::Output(value.node.get(), value.index));
+    };
+    EXPECT_TRUE(output_op(sum1).IsIdenticalTo(output_op(sum2)));
+    EXPECT_FALSE(output_op(sum1).IsIdenticalTo(output_op(sum3)));
+  });
+}
+
+TEST_F(IrTest, TestLowerInParallel) {
+  ForEachDevice([&](const torch::lazy::BackendDevice& device) {
+    at::Tensor a = at::rand({4, 3}, at::TensorOptions(at::kFloat));
+    torch::lazy::Value input = GetTensorIrValue(a, device);
+    torch::lazy::Value value = input;
+    std::vector<torch::lazy::Value> roots;
+    for (int i = 0; i < 8; ++i) {
+      value = torch::lazy::Value(value * input, 0);
+      roots.push_back(value);
+    }
+    std::vector<const torch::lazy::Node*> root_nodes;
+    for (const torch::lazy::Value& root : roots) {
+      root_nodes.push_back(root.node.get());
+    }
+    torch::lazy::Util::EmissionMap emission_map;
+    std::vector<const torch::lazy::Node*> post_order =
+        torch::lazy::Util::ComputePostOrder(root_nodes, &emission_map);
+
+    LoweringContext lowering_ctx("LowerInParallel", device, {},
+                                 std::move(emission_map));
+    LowerInParallel(post_order, roots, /*segment_nodes=*/2, &lowering_ctx);
+    for (const torch::lazy::Value& root : roots) {
+      lowering_ctx.AddResult(lowering_ctx.GetOutputOp(
+          torch::lazy::Output(root.node.get(), root.index)));
+    }
+    xla::XlaComputation computation = ConsumeValue(lowering_ctx.BuildXla());
+    int64_t calls = 0;
+    for (const auto& hlo_computation : computation.proto().computations()) {
+      for (const auto& instruction : hlo_computation.instructions()) {
+        calls += instruction.opcode() == "call";
+      }
+    }
+    // The segments of 4 nodes, without op name prefixes to cut at.
+    EXPECT_EQ(calls, 3);
+    xla::ProgramShape program_shape =
+        ConsumeValue(computation.GetProgramShape());
+    EXPECT_EQ(program_shape.parameters_size(), 1);
+    EXPECT_EQ(program_shape.result().tuple_shapes_size(), roots.size());
+  });
+}
+
+TEST_F(IrTest, TestViewUpdateCoalescing) {
+  ForEachDevice([&](const torch::lazy::BackendDevice& device) {
+    xla::Shape alias_shape = xla::ShapeUtil::MakeShape(xla::F32, {8, 4});
+    Alias alias(GetTensorIrValue(at::rand({8, 4}), device));
+    auto narrow = [&](int64_t start, int64_t length) {
+      ViewInfo view_info(ViewInfo::Type::kNarrow,
+                         xla::ShapeUtil::MakeShape(xla::F32, {length, 4}),
+                         alias_shape);
+      view_info.indices[0] = start;
+      return std::vector<ViewInfo>{view_info};
+    };
+    // The rows written one after the other merge in a single update.
+    for (int64_t row = 0; row < 4; ++row) {
+      alias.Update(GetTensorIrValue(at::rand({1, 4}), device),
+                   narrow(row, 1));
+    }
+    ASSERT_EQ(alias.updates().size(), 1);
+    EXPECT_EQ(alias.updates()[0].view_infos[0].shape.dimensions(0), 4);
+    // A write of a disjoint region stacks, one of the whole alias overwrites
+    // them both.
+    alias.Update(GetTensorIrValue(at::rand({2, 4}), device), narrow(6, 2));
+    EXPECT_EQ(alias.updates().size(), 2);
+    alias.Update(GetTensorIrValue(at::rand({8, 4}), device), narrow(0, 8));
+    EXPECT_EQ(alias.updates().size(), 1);
+    EXPECT_EQ(alias.generation(), 6);
+
+    torch::lazy::Value value = alias.SyncUpdateOperations();
+    EXPECT_TRUE(alias.updates().empty());
+    EXPECT_TRUE(xla::ShapeUtil::Compatible(GetXlaShape(value), alias_shape));
+  });
+}
+
 }  // namespace cpp_test
 }  // namespace torch_xla
@@ -1,6 +1,7 @@
 #include <ATen/ATen.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <limits>
 #include <vector>
 
@@ -11,6 +12,7 @@
 #include "torch_xla/csrc/tensor.h"
 #include "torch_xla/csrc/tensor_methods.h"
 #include "torch_xla/csrc/tensor_util.h"
+#include "torch_xla/csrc/thread_pool.h"
 
 namespace torch_xla {
 namespace cpp_test {
@@ -73,6 +75,47 @@ TEST_F(TensorTest, TestConversions) {
   }
 }
 
+TEST_F(TensorTest, TestLargeConversions) {
+  // Large enough to go through the ATen copy kernels.
+  {
+    at::Tensor a = at::rand({256, 300}, at::TensorOptions(at::kFloat))
+                       .to(at::kBFloat16)
+                       .to(at::kFloat);
+    EXPECT_TRUE(CheckBidirectionalConversion(a, at::ScalarType::Float,
+                                             xla::PrimitiveType::BF16));
+    EXPECT_TRUE(CheckBidirectionalConversion(a, at::ScalarType::BFloat16));
+  }
+  {
+    at::Tensor a = at::rand({256, 300}, at::TensorOptions(at::kFloat))
+                       .to(at::kHalf)
+                       .to(at::kFloat);
+    EXPECT_TRUE(CheckBidirectionalConversion(a, at::ScalarType::Float,
+                                             xla::PrimitiveType::F16));
+  }
+  {
+    at::Tensor a = at::randint(std::numeric_limits<int32_t>::min(),
+                               std::numeric_limits<int32_t>::max(), {256, 300},
+                               at::TensorOptions(at::kLong));
+    EXPECT_TRUE(CheckBidirectionalConversion(a, at::ScalarType::Long,
+                                             xla::PrimitiveType::S32));
+  }
+  {
+    at::Tensor a = at::randint(0, 2, {256, 300}, at::TensorOptions(at::kByte));
+    EXPECT_TRUE(CheckBidirectionalConversion(a, at::ScalarType::Byte,
+                                             xla::PrimitiveType::PRED));
+  }
+  {
+    // Transposing copy, converting the element type on the way.
+    at::Tensor a = at::rand({256, 300}, at::TensorOptions(at::kFloat));
+    xla::Shape shape = xla::ShapeUtil::MakeShapeWithDenseLayout(
+        xla::PrimitiveType::F32, {256, 300}, {0, 1});
+    xla::Literal literal = GetTensorLiteral(a, &shape, /*device=*/nullptr);
+    at::Tensor converted =
+        MakeTensorFromXlaLiteral(literal, at::ScalarType::Double);
+    EXPECT_TRUE(EqualValuesNoElementTypeCheck(converted, a));
+  }
+}
+
 TEST_F(TensorTest, TestAdd) {
   at::Tensor a = at::rand({2, 2}, at::TensorOptions(at::kFloat));
   at::Tensor b = at::rand({2, 2}, at::TensorOptions(at::kFloat));
@@ -416,6 +459,44 @@ TEST_F(TensorTest, TestBatchNorm1D) {
   }
 }
 
+TEST_F(TensorTest, TestParallelFor) {
+  for (int64_t n : {0, 1, 7, 1000, 100003}) {
+    for (int64_t grain : {0, 1, 16, 200000}) {
+      std::vector<std::atomic<int>> visits(n);
+      std::atomic<int64_t> min_range(n);
+      thread::ParallelFor(n, grain, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          visits[i] += 1;
+        }
+        // Only the last range may be smaller than the grain.
+        int64_t size = end - begin;
+        int64_t current = min_range.load();
+        while (end < n && size < current &&
+               !min_range.compare_exchange_weak(current, size)) {
+        }
+      });
+      for (int64_t i = 0; i < n; ++i) {
+        EXPECT_EQ(visits[i].load(), 1);
+      }
+      EXPECT_GE(min_range.load(), std::min(grain, n));
+    }
+  }
+}
+
+TEST_F(TensorTest, TestTensorHashStrided) {
+  // Above the size hashed in a single chunk.
+  at::Tensor tensor = at::rand({1024, 1024}, at::TensorOptions(at::kFloat));
+  at::Tensor transposed = tensor.t();
+  at::Tensor sliced = tensor.slice(/*dim=*/1, /*start=*/0, /*end=*/1024,
+                                   /*step=*/2);
+  EXPECT_EQ(TensorHash(transposed), TensorHash(transposed.contiguous()));
+  EXPECT_EQ(TensorHash(sliced), TensorHash(sliced.contiguous()));
+  EXPECT_NE(TensorHash(tensor), TensorHash(transposed.contiguous()));
+  at::Tensor changed = tensor.clone();
+  changed[1023][1023] = changed[1023][1023].item<float>() + 1;
+  EXPECT_NE(TensorHash(tensor), TensorHash(changed));
+}
+
 TEST_F(TensorTest, TestConv2D) {
   if (UsingTpu()) {
     GTEST_SKIP();
@@ -630,6 +711,33 @@ TEST_F(TensorTest, TestConv3D) {
   }
 }
 
+TEST_F(TensorTest, TestRepeatedStepPerfContract) {
+  int num_steps = 3;
+  ForEachDevice([&](const torch::lazy::BackendDevice& device) {
+    for (int step = 0; step < num_steps; ++step) {
+      at::Tensor input = at::rand({8, 16}, at::TensorOptions(at::kFloat));
+      at::Tensor weight = at::rand({16, 4}, at::TensorOptions(at::kFloat));
+      at::Tensor bias = at::rand({4}, at::TensorOptions(at::kFloat));
+      at::Tensor output = at::sigmoid(input.mm(weight).add(bias, 1.0));
+
+      XLATensorPtr dev_input = XLATensor::Create(input, device);
+      XLATensorPtr dev_weight = XLATensor::Create(weight, device);
+      XLATensorPtr dev_bias = XLATensor::Create(bias, device);
+      XLATensorPtr dev_output = tensor_methods::sigmoid(tensor_methods::add(
+          tensor_methods::mm(dev_input, dev_weight), dev_bias, 1.0));
+      AllClose(output, dev_output);
+    }
+  });
+  // The steps trace the same graph, which is compiled once and executed once
+  // per step, with one transfer per input.
+  ExpectPerfContract(
+      PerfContract()
+          .MaxCounterDelta("UncachedCompile", 1)
+          .MaxMetricSamples("ExecuteTime", num_steps)
+          .MaxMetricSamples("TransferToDeviceTime", 3 * num_steps)
+          .MaxMetricValue("TensorsGraphSize", 10));
+}
+
 // TODO @wonjoo FIXME https://github.com/pytorch/xla/issues/3316
 // TEST_F(TensorTest, TestConv3DNonSquare) {
 //   int in_channels = 9;
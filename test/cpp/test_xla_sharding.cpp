@@ -6,17 +6,20 @@
 
 #include <iostream>
 
+#include "absl/strings/str_cat.h"
 #include "test/cpp/cpp_test_util.h"
 #include "test/cpp/torch_xla_test.h"
 #include "torch_xla/csrc/aten_xla_bridge.h"
 #include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/env_vars.h"
+#include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/runtime.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/tensor.h"
 #include "torch_xla/csrc/tensor_methods.h"
 #include "torch_xla/csrc/tensor_util.h"
+#include "torch_xla/csrc/unwrap_data.h"
 #include "torch_xla/csrc/xla_sharding_util.h"
 #include "xla/protobuf_util.h"
 #include "xla/xla_data.pb.h"
@@ -287,6 +290,92 @@ TEST_F(XLAShardingTest, ShardTensorMiniBatch) {
   EXPECT_EQ(shards[3].sizes(), c10::ArrayRef<long>({2, 7, 4}));
 }
 
+TEST_F(XLAShardingTest, GetShardRegionsForDevices) {
+  std::vector<std::string> devices;
+  for (int i = 0; i < 16; ++i) {
+    devices.push_back(absl::StrCat("TPU:", i));
+  }
+  // A 3D tensor tiled over a 2x2x2 mesh, replicated over the last dimension
+  // of the tile assignment. The second dimension is uneven.
+  std::vector<int64_t> tensor_shape = {8, 7, 4};
+  xla::Array<int64_t> tile_devices(std::vector<int64_t>{2, 2, 2, 2});
+  tile_devices.FillIota(0);
+  std::vector<xla::OpSharding> shardings = {
+      // Explicit tile assignment devices.
+      xla::HloSharding::PartialTile(xla::TileAssignment(
+                                        std::make_shared<xla::Array<int64_t>>(
+                                            tile_devices)))
+          .ToProto(),
+      // Iota tile assignment.
+      xla::HloSharding::PartialTile(xla::TileAssignment({2, 2, 2, 2}))
+          .ToProto()};
+  for (const xla::OpSharding& sharding : shardings) {
+    xla::Shape shape = xla::ShapeUtil::MakeShape(xla::F32, tensor_shape);
+    auto sharding_spec =
+        std::make_shared<XLATensor::ShardingSpec>(sharding, shape);
+    std::vector<int64_t> shard_shape =
+        ShardingUtil::GetShardShape(sharding_spec);
+    EXPECT_EQ(shard_shape, std::vector<int64_t>({4, 4, 2}));
+    std::vector<ShardingUtil::ShardRegion> regions =
+        ShardingUtil::GetShardRegionsForDevices(shard_shape, tensor_shape,
+                                                sharding, devices);
+    ASSERT_EQ(regions.size(), devices.size());
+    for (int i = 0; i < devices.size(); ++i) {
+      // Device `i` is at tile (i / 8, i / 4 % 2, i / 2 % 2), replica i % 2.
+      const ShardingUtil::ShardRegion& region = regions[i];
+      EXPECT_EQ(region.replica_id, i % 2);
+      ASSERT_EQ(region.starts.size(), 3);
+      EXPECT_EQ(region.starts[0], i / 8 * 4);
+      EXPECT_EQ(region.starts[1], i / 4 % 2 * 4);
+      EXPECT_EQ(region.starts[2], i / 2 % 2 * 2);
+      EXPECT_EQ(region.sizes[0], 4);
+      EXPECT_EQ(region.sizes[1], i / 4 % 2 == 0 ? 4 : 3);
+      EXPECT_EQ(region.sizes[2], 2);
+    }
+  }
+}
+
+TEST_F(XLAShardingTest, ShardTensorToSources) {
+  std::vector<std::string> devices = {"TPU:0", "TPU:1", "TPU:2", "TPU:3",
+                                      "TPU:4", "TPU:5", "TPU:6", "TPU:7"};
+  // The first dim is halved and the second split in four, unevenly.
+  at::Tensor tensor = at::rand({8, 7, 4}, at::TensorOptions(at::kFloat));
+  xla::Shape tensor_shape =
+      CreateComputationShapeFromTensor(tensor, bridge::GetDefaultDevice());
+  xla::Array2D<int64_t> mesh({
+      {0, 1, 2, 3},
+      {4, 5, 6, 7},
+  });
+  auto sharding_spec = std::make_shared<XLATensor::ShardingSpec>(
+      xla::HloSharding::Tile(mesh).ToProto(), tensor_shape);
+  std::vector<at::Tensor> shards = ShardingUtil::ShardTensor(
+      tensor, sharding_spec, devices, /*padded=*/true);
+  std::vector<std::shared_ptr<const runtime::TensorSource>> sources =
+      ShardingUtil::ShardTensorToSources(tensor, sharding_spec, devices);
+  ASSERT_EQ(sources.size(), shards.size());
+  for (size_t i = 0; i < sources.size(); ++i) {
+    EXPECT_EQ(sources[i]->device(), devices[i]);
+    std::vector<int64_t> strides = sources[i]->byte_strides();
+    for (int64_t& stride : strides) {
+      stride /= tensor.itemsize();
+    }
+    at::Tensor source_tensor =
+        at::from_blob(const_cast<void*>(sources[i]->data()),
+                      sources[i]->dimensions(), strides, tensor.options());
+    EXPECT_EQ(source_tensor.sizes(), shards[i].sizes());
+    EXPECT_TRUE(source_tensor.equal(shards[i]));
+  }
+
+  // The replicas share the data of the tensor.
+  sharding_spec->sharding = xla::HloSharding::Replicate().ToProto();
+  sources = ShardingUtil::ShardTensorToSources(tensor, sharding_spec, devices);
+  ASSERT_EQ(sources.size(), devices.size());
+  for (size_t i = 0; i < sources.size(); ++i) {
+    EXPECT_EQ(sources[i]->data(), sources[0]->data());
+    EXPECT_EQ(sources[i]->dimensions(), std::vector<int64_t>({8, 7, 4}));
+  }
+}
+
 TEST_F(XLAShardingTest, EqualShardingSpecs) {
   auto tensor = at::ones({8, 7}, at::TensorOptions(at::kFloat));
   xla::Shape tensor_shape =
@@ -369,6 +458,45 @@ TEST_F(XLAShardingTest, CreateTensorsData) {
   }
 }
 
+TEST_F(XLAShardingTest, ReshardDataCache) {
+  if (torch_xla::runtime::sys_util::GetEnvString(
+          torch_xla::runtime::env::kEnvPjRtDevice, "") == "") {
+    GTEST_SKIP() << "`PJRT_DEVICE` is not set.";
+  }
+  auto counter = [](const std::string& name) {
+    torch_xla::runtime::metrics::CounterData* data =
+        torch_xla::runtime::metrics::GetCounter(name);
+    return data != nullptr ? data->Value() : 0;
+  };
+
+  auto tensor = at::rand({8, 8}, at::TensorOptions(at::kFloat));
+  xla::Shape tensor_shape =
+      CreateComputationShapeFromTensor(tensor, bridge::GetDefaultDevice());
+  std::vector<XLATensor::ShardingSpecPtr> shardings = {
+      std::make_shared<XLATensor::ShardingSpec>(
+          xla::HloSharding::Replicate().ToProto(), tensor_shape)};
+  int64_t n_devices =
+      torch_xla::runtime::GetComputationClient()->GetLocalDevices().size();
+  xla::OpSharding target =
+      xla::HloSharding::Tile1D(tensor_shape, n_devices).ToProto();
+
+  int64_t misses = counter("ReshardCacheMiss");
+  int64_t hits = counter("ReshardCacheHit");
+  for (int i = 0; i < 2; ++i) {
+    std::vector<torch::lazy::BackendDataPtr> tensors_data = CreateTensorsData(
+        {tensor}, shardings, {bridge::GetDefaultDevice()->toString()});
+    std::vector<torch_xla::runtime::ComputationClient::DataPtr> resharded =
+        torch_xla::runtime::GetComputationClient()->ReshardData(
+            UnwrapXlaData(tensors_data), {target});
+    ASSERT_EQ(resharded.size(), 1);
+    EXPECT_EQ(resharded[0]->GetSharding().type(), xla::OpSharding::OTHER);
+    EXPECT_TRUE(XlaDataValuesEqual(tensors_data[0], resharded[0], at::kFloat));
+  }
+  // The second resharding reuses the program compiled by the first one.
+  EXPECT_EQ(counter("ReshardCacheMiss"), misses + 1);
+  EXPECT_EQ(counter("ReshardCacheHit"), hits + 1);
+}
+
 TEST_F(XLAShardingTest, PrepareOutputShardingPropagation) {
   xla::Shape shape = xla::ShapeUtil::MakeShape(xla::PrimitiveType::F32, {4, 4});
   int64_t n_devices =
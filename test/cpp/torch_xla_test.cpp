@@ -89,6 +89,16 @@ void XlaTest::ExpectCounterChanged(
   EXPECT_TRUE(changed.empty() != changed_symint.empty());
 }
 
+void XlaTest::ExpectPerfContract(const PerfContract& contract) {
+  MakeEndSnapshot();
+  std::vector<std::string> violations =
+      contract.Violations(*start_msnap_, *end_msnap_);
+  for (auto& violation : violations) {
+    TF_LOG(INFO) << violation;
+  }
+  EXPECT_TRUE(violations.empty());
+}
+
 void XlaTest::ResetCounters() {
   start_msnap_ = std::move(end_msnap_);
   end_msnap_ = nullptr;
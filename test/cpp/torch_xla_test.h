@@ -25,6 +25,10 @@ class XlaTest : public ::testing::Test {
   void ExpectCounterChanged(const std::string& counter_regex,
                             const std::unordered_set<std::string>* ignore_set);
 
+  // Expects the metrics to have stayed within `contract` since the start of
+  // the test, or the last ResetCounters().
+  void ExpectPerfContract(const PerfContract& contract);
+
   void ResetCounters();
 
  private:
@@ -107,6 +107,29 @@ class TestDynamicShapes(test_utils.XlaTestCase):
     t4 = t3.expand(dyn_size)
     self.assertEqual(t4.size(0), 3)
 
+  def test_speculative_size_guard(self):
+    from torch_xla.experimental import speculative_guards
+
+    def step(t):
+      if torch.nonzero(t).shape[0] > 1:
+        return t + 1
+      return t - 1
+
+    t1 = torch.zeros([5, 2], device=dev)
+    t1[3][0] = 1
+    t1[3][1] = 1
+    # The first guard of the site is evaluated.
+    speculative_guards.run_step(step, t1)
+    met.clear_all()
+    out = speculative_guards.run_step(step, t1)
+    self.assertEqual(met.counter_value('SpeculatedSizeGuards'), 1)
+    self.assertEqual(out.cpu()[3].tolist(), [2.0, 2.0])
+    # A misprediction traces the step again.
+    t2 = torch.zeros([5, 2], device=dev)
+    t2[0][0] = 1
+    out = speculative_guards.run_step(step, t2)
+    self.assertEqual(out.cpu()[0].tolist(), [0.0, -1.0])
+
   def test_sizeSub(self):
     size1 = 5
     size2 = 2
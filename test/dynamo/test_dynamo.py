@@ -150,6 +150,20 @@ class DynamoInferenceBasicTest(unittest.TestCase):
     # Dynamo has to sync the input since they are intermedate IR(xla_xy and xla_y3)
     self.assertEqual(met.counter_value('DynamoSyncInputExecuteTime'), 1)
 
+  def test_call_plan_created_once(self):
+    device = xm.xla_device()
+    xla_x = torch.randn(4, device=device)
+    xla_y = torch.randn(4, device=device)
+    fn_simple_dynamo = torch.compile(self.fn_simple, backend="openxla")
+    fn_simple_dynamo(xla_x, xla_y)
+    met.clear_counters()
+    for _ in range(3):
+      res_xla_dynamo = fn_simple_dynamo(xla_x, xla_y)
+    self.assertEqual(met.counter_value('CreateCallPlan'), None)
+    self.assertTrue(
+        torch.allclose(
+            self.fn_simple(xla_x.cpu(), xla_y.cpu()), res_xla_dynamo.cpu()))
+
   # Tests that the dynamo bridge automatically moves tensors to XLA device,
   # then back to the original device.
   @unittest.skipIf(xr.device_type() != "CUDA" or not torch.cuda.is_available(),
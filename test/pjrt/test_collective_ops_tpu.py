@@ -2,7 +2,9 @@ import numpy as np
 import torch
 import torch.nn as nn
 from absl.testing import absltest, parameterized
+import torch_xla.core.functions as xf
 import torch_xla.core.xla_model as xm
+from torch_xla import runtime as xr
 from torch_xla._internal import pjrt, tpu
 
 
@@ -54,6 +56,55 @@ class TestCollectiveOpsTpu(parameterized.TestCase):
     for v in results.values():
       np.testing.assert_array_equal(v, expected)
 
+  @staticmethod
+  def _all_reduce_bf16_wire():
+    device = xm.xla_device()
+    value = torch.tensor([xm.get_ordinal() + 1 / 3], dtype=torch.float32)
+    tensor = value.to(device)
+    residual = torch.zeros_like(tensor)
+    out = xm.all_reduce(
+        xm.REDUCE_SUM,
+        tensor,
+        wire_dtype=torch.bfloat16,
+        residuals=[residual])
+    xm.mark_step()
+
+    assert out.dtype == torch.float32
+    expected_residual = value - value.to(torch.bfloat16).to(torch.float32)
+    np.testing.assert_array_equal(residual.cpu().numpy(),
+                                  expected_residual.numpy())
+    return out.cpu().numpy()
+
+  def test_all_reduce_bf16_wire(self):
+    results = pjrt.run_multiprocess(self._all_reduce_bf16_wire)
+
+    world_size = tpu.num_expected_global_devices()
+    expected = sum(range(world_size)) + world_size / 3
+    for v in results.values():
+      np.testing.assert_allclose(v, [expected], rtol=1e-2)
+
+  @staticmethod
+  def _host_all_reduce():
+    index = xr.process_index()
+    payloads = xm.host_all_gather('test_host_all_gather', bytes([index]))
+    assert payloads == [bytes([i]) for i in range(xr.process_count())]
+    value = torch.tensor([index + 1.0], device=xm.xla_device())
+    total = xm.host_all_reduce('test_host_all_reduce', value)
+    largest = xm.host_all_reduce(
+        'test_host_all_reduce', index, reduce_type=xm.REDUCE_MAX)
+    return total.numpy(), largest.item()
+
+  # The host collectives run per process, with a single device per process.
+  @absltest.skipUnless(tpu.num_tpu_workers() == 1 and tpu.version() >= 4,
+                       "Only implemented for single host, one device each.")
+  def test_host_all_reduce(self):
+    results = pjrt.run_multiprocess(self._host_all_reduce)
+
+    num_processes = len(results)
+    for total, largest in results.values():
+      np.testing.assert_array_equal(total, [sum(range(1, num_processes + 1))])
+      self.assertEqual(largest, num_processes - 1)
+
   @staticmethod
   def _all_gather(pin_layout):
     device = xm.xla_device()
@@ -71,6 +122,30 @@ class TestCollectiveOpsTpu(parameterized.TestCase):
     for v in results.values():
       np.testing.assert_array_equal(v, expected)
 
+  @staticmethod
+  def _async_collectives():
+    device = xm.xla_device()
+    ordinal = torch.tensor([xm.get_ordinal()], device=device)
+    gather = xm.all_gather_start(ordinal, pin_layout=False)
+    reduce = xm.all_reduce_start(
+        xm.REDUCE_SUM, ordinal.float(), scale=2.0, pin_layout=False)
+    # Computation issued while the collectives are in flight.
+    square = ordinal * ordinal
+    gathered = gather.wait()
+    reduced = reduce.wait()
+    xm.mark_step()
+
+    return gathered.cpu().numpy(), reduced.cpu().numpy(), square.cpu().numpy()
+
+  def test_async_collectives(self):
+    results = pjrt.run_multiprocess(self._async_collectives)
+
+    world_size = tpu.num_expected_global_devices()
+    for ordinal, (gathered, reduced, square) in results.items():
+      np.testing.assert_array_equal(gathered, list(range(world_size)))
+      np.testing.assert_array_equal(reduced, [2.0 * sum(range(world_size))])
+      np.testing.assert_array_equal(square, [ordinal * ordinal])
+
   @staticmethod
   def _reduce_scatter(pin_layout):
     device = xm.xla_device()
@@ -130,5 +205,107 @@ class TestCollectiveOpsTpu(parameterized.TestCase):
                                              list(range(world_size))]])
 
 
+  @staticmethod
+  def _coalesced_all_to_all_and_permute():
+    device = xm.xla_device()
+    world_size = xm.xrt_world_size()
+    ordinal = xm.get_ordinal()
+    tokens = torch.arange(
+        world_size * 6, dtype=torch.float32).view(world_size * 2, 3) + ordinal
+    indices = torch.arange(world_size * 2, dtype=torch.int32) * (ordinal + 1)
+    inputs = [tokens.to(device), indices.to(device)]
+    xm.mark_step()
+
+    coalesced = xm.all_to_all(
+        inputs, split_dimension=0, concat_dimension=0, split_count=world_size)
+    expected = [
+        xm.all_to_all(
+            t, split_dimension=0, concat_dimension=0, split_count=world_size)
+        for t in inputs
+    ]
+    pairs = [[i, (i + 1) % world_size] for i in range(world_size)]
+    permuted = xm.collective_permute(inputs, pairs)
+    expected += [xm.collective_permute(t, pairs) for t in inputs]
+    return [t.cpu().numpy() for t in coalesced + permuted + expected]
+
+  def test_coalesced_all_to_all_and_permute(self):
+    results = pjrt.run_multiprocess(self._coalesced_all_to_all_and_permute)
+    for values in results.values():
+      coalesced, expected = values[:4], values[4:]
+      for value, expected_value in zip(coalesced, expected):
+        np.testing.assert_array_equal(value, expected_value)
+
+
+  @staticmethod
+  def _ring_attention(causal):
+    device = xm.xla_device()
+    world_size = xm.xrt_world_size()
+    ordinal = xm.get_ordinal()
+    torch.manual_seed(0)
+    query, key, value = (
+        torch.randn(2, world_size * 4, 8, requires_grad=True) for _ in range(3))
+    scores = query @ key.transpose(-1, -2) / 8**0.5
+    if causal:
+      scores = scores.masked_fill(
+          torch.ones_like(scores, dtype=torch.bool).triu(1), float('-inf'))
+    expected = torch.softmax(scores, dim=-1).matmul(value)
+    expected.sum().backward()
+
+    def block(t):
+      return t.detach()[:, ordinal * 4:(ordinal + 1) * 4]
+
+    blocks = [block(t).to(device).requires_grad_() for t in (query, key, value)]
+    output = xf.ring_attention(*blocks, causal=causal)
+    output.sum().backward()
+    results = [output.cpu().numpy(), block(expected).numpy()]
+    for b, t in zip(blocks, (query, key, value)):
+      results += [b.grad.cpu().numpy(), block(t.grad).numpy()]
+    return results
+
+  @parameterized.named_parameters(('causal', True), ('full', False))
+  def test_ring_attention(self, causal):
+    results = pjrt.run_multiprocess(self._ring_attention, causal)
+    for values in results.values():
+      for value, expected_value in zip(values[0::2], values[1::2]):
+        np.testing.assert_allclose(value, expected_value, rtol=1e-2, atol=1e-2)
+
+  @staticmethod
+  def _sharded_embedding_bag(mode):
+    device = xm.xla_device()
+    world_size = xm.xrt_world_size()
+    ordinal = xm.get_ordinal()
+    rows_per_shard = 8
+    torch.manual_seed(0)
+    weight = torch.randn(world_size * rows_per_shard, 4, requires_grad=True)
+    indices = torch.randint(0, weight.size(0), (world_size, 12))
+    offsets = torch.tensor([0, 3, 3, 7])
+    expected = [
+        nn.functional.embedding_bag(indices[i], weight, offsets, mode=mode)
+        for i in range(world_size)
+    ]
+    if mode != 'max':
+      torch.stack(expected).sum().backward()
+
+    shard = slice(ordinal * rows_per_shard, (ordinal + 1) * rows_per_shard)
+    local_weight = weight.detach()[shard].to(device).requires_grad_()
+    output = xf.sharded_embedding_bag(local_weight, indices[ordinal].to(device),
+                                      offsets.to(device), mode=mode)
+    results = [
+        output.detach().cpu().numpy(), expected[ordinal].detach().numpy()
+    ]
+    if mode != 'max':
+      output.sum().backward()
+      results += [local_weight.grad.cpu().numpy(), weight.grad[shard].numpy()]
+    return results
+
+  @parameterized.named_parameters(('sum', 'sum'), ('mean', 'mean'),
+                                  ('max', 'max'))
+  def test_sharded_embedding_bag(self, mode):
+    results = pjrt.run_multiprocess(self._sharded_embedding_bag, mode)
+    for values in results.values():
+      for value, expected_value in zip(values[0::2], values[1::2]):
+        np.testing.assert_allclose(value, expected_value, rtol=1e-4, atol=1e-4)
+
+
 if __name__ == '__main__':
   absltest.main()
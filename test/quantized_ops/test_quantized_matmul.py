@@ -6,6 +6,7 @@ import torch_xla
 import torch_xla.core.xla_model as xm
 import torch_xla.experimental.xla_quantized_matmul
 from torch_xla.experimental.xla_quantized_matmul import XlaQuantizedLinear
+from torch_xla.experimental.xla_quantized_matmul import pack_int4
 from torch.ao.quantization.utils import determine_qparams
 
 torch.manual_seed(123456)
@@ -101,5 +102,52 @@ class QuantizedTest(unittest.TestCase):
       self.assertTrue(re.search(r'bf16.*dot.*bf16.*s8', hlo) is not None)
 
 
+  def _test_q_linear_weight_only(self, blocksize, int4_weight):
+    with torch.no_grad():
+      input_dim, output_dim = 16, 8
+      int_max = 7 if int4_weight else 127
+      w_int = torch.randint(
+          -int_max - 1, int_max + 1, (output_dim, input_dim), dtype=torch.int8)
+      if blocksize == -1:
+        scaler = torch.rand(output_dim)
+        w_fp = w_int.float() * scaler.unsqueeze(-1)
+      else:
+        scaler = torch.rand(output_dim, input_dim // blocksize)
+        w_fp = w_int.float() * scaler.repeat_interleave(blocksize, dim=1)
+      x = torch.randn(3, input_dim)
+
+      q_linear = XlaQuantizedLinear(
+          input_dim, output_dim, blocksize=blocksize, int4_weight=int4_weight)
+      q_linear.load_quantized_weight(
+          pack_int4(w_int) if int4_weight else w_int, scaler)
+      out_quant = q_linear(x)
+      out_quant_xla = q_linear.to(device)(x.to(device))
+      self.assertTrue(torch.allclose(out_quant, x @ w_fp.t(), atol=1e-4))
+      self.assertTrue(
+          torch.allclose(out_quant_xla.cpu(), out_quant, atol=1e-4))
+
+  def test_q_linear_int4_per_channel(self):
+    self._test_q_linear_weight_only(blocksize=-1, int4_weight=True)
+
+  def test_q_linear_int8_blockwise(self):
+    self._test_q_linear_weight_only(blocksize=4, int4_weight=False)
+
+  def test_q_linear_int4_blockwise(self):
+    self._test_q_linear_weight_only(blocksize=8, int4_weight=True)
+
+  def test_q_linear_int4_hlo(self):
+    with torch.no_grad():
+      x = torch.randn((3, 16), dtype=torch.bfloat16).to(device)
+      w_int = torch.randint(-8, 8, (8, 16), dtype=torch.int8)
+      w_packed = pack_int4(w_int).to(device)
+      scaler = torch.randn((8,), dtype=torch.bfloat16).to(device)
+
+      output = torch.ops.xla.quantized_matmul(
+          x, w_packed, scaler, int4_weight=True)
+      hlo = torch_xla._XLAC._get_xla_tensors_hlo([output])
+      self.assertIn('s8[8,8]', hlo)
+      self.assertTrue(re.search(r'bf16.*dot.*bf16.*s8', hlo) is not None)
+
+
 if __name__ == '__main__':
   unittest.main()
@@ -205,6 +205,7 @@ function run_xla_op_tests2 {
   run_downcast_bf16 "$CDIR/test_data_type.py"
   run_test "$CDIR/pjrt/test_dtypes.py"
   run_test "$CDIR/test_fori_loop_with_while_loop_simple_add_dispatch_in_torch.py"
+  run_test "$CDIR/test_fp8_autocast.py"
   run_test "$CDIR/test_autocast.py"  # TODO(yeounoh) this is expensive on GPU
 }
 
@@ -221,6 +222,7 @@ function run_xla_op_tests3 {
   run_xla_hlo_debug "$CDIR/stablehlo/test_stablehlo_inference.py"
   run_test "$CDIR/stablehlo/test_stablehlo_compile.py"
   run_test "$CDIR/stablehlo/test_unbounded_dynamism.py"
+  run_test "$CDIR/stablehlo/test_export_optimize.py"
   run_test "$CDIR/quantized_ops/test_quantized_matmul.py"
   run_test "$CDIR/spmd/test_xla_sharding.py"
   run_test "$CDIR/spmd/test_xla_sharding_hlo.py"
@@ -237,7 +239,58 @@ function run_xla_op_tests3 {
   run_test "$CDIR/test_torch_distributed_xla_backend.py"
   run_torchrun "$CDIR/pjrt/test_torchrun.py"
   run_test "$CDIR/test_persistent_cache.py"
+  run_test "$CDIR/test_async_compile.py"
+  run_test "$CDIR/test_tiered_compile.py"
+  run_test "$CDIR/test_warm_up_cache_batch.py"
+  run_test "$CDIR/test_dedup_executables.py"
+  run_test "$CDIR/test_reusable_scope.py"
+  run_test "$CDIR/test_zero_copy_transfer.py"
+  run_test "$CDIR/test_host_buffer_pool.py"
+  run_test "$CDIR/test_graph_replay.py"
+  run_test "$CDIR/test_step_timeline.py"
+  run_test "$CDIR/test_step_pipeline.py"
+  run_test "$CDIR/test_sync_roots.py"
+  run_test "$CDIR/test_shape_bucketing.py"
+  run_test "$CDIR/test_recompile_analysis.py"
+  run_test "$CDIR/test_scalar_hoisting.py"
+  run_test "$CDIR/test_constant_data_cache.py"
+  run_test "$CDIR/test_multi_device_sync.py"
+  run_test "$CDIR/test_execution_lane.py"
+  run_test "$CDIR/test_compile_options.py"
+  run_test "$CDIR/test_graph_sequence.py"
+  run_test "$CDIR/test_scan_layers.py"
+  run_test "$CDIR/test_checkpoint_plan.py"
+  run_test "$CDIR/test_kernel_autotune.py"
+  run_test "$CDIR/test_padded_ops.py"
+  run_test "$CDIR/test_inflight_operations.py"
+  run_test "$CDIR/test_execution_future.py"
+  run_test "$CDIR/test_memory_kind.py"
+  run_test "$CDIR/test_compiled_memory_stats.py"
+  run_test "$CDIR/test_graph_stats.py"
+  run_test "$CDIR/test_graph_dump.py"
   run_test "$CDIR/test_devices.py"
+  run_test "$CDIR/test_flash_attention.py"
+  run_test "$CDIR/test_grouped_matmul.py"
+  XLA_SCATTER_INDICES_MODE=sorted run_test "$CDIR/test_scatter_indices.py"
+  XLA_SCATTER_INDICES_MODE=segment_reduce run_test "$CDIR/test_scatter_indices.py"
+  XLA_RNG_COUNTER_SEEDS=1 run_test "$CDIR/test_rng_counter_seeds.py"
+  XLA_RESIZE_WITH_MATMUL=1 run_test "$CDIR/test_resize_matmul.py"
+  XLA_PARAMETER_WRAPPING_THREADSHOLD=8 run_test "$CDIR/test_tupled_parameters.py"
+  XLA_DEVICE_DATA_CACHE_MB=64 XLA_DEVICE_DATA_CACHE_SAMPLE_KB=64 run_test "$CDIR/test_device_data_cache.py"
+  XLA_ASYNC_TENSOR_UPLOADS=1 run_test "$CDIR/test_async_tensor_uploads.py"
+  XLA_REUSE_OUTPUT_BUFFERS=1 run_test "$CDIR/test_reuse_output_buffers.py"
+  XLA_GRAPH_SPLIT_MEMORY_FRACTION=1e-9 run_test "$CDIR/test_graph_split.py"
+  XLA_AUTO_PARAMETER_LAYOUTS=1 run_test "$CDIR/test_auto_parameter_layouts.py"
+  XLA_WELFORD_VARIANCE=1 run_test "$CDIR/test_welford_variance.py"
+  XLA_NARROW_INDICES=checked run_test "$CDIR/test_narrow_indices.py"
+  run_test "$CDIR/test_cdist.py"
+  run_test "$CDIR/test_cat_lowering.py"
+  run_test "$CDIR/test_multi_device_fetch.py"
+  run_test "$CDIR/test_small_linalg.py"
+  run_test "$CDIR/test_depthwise_conv.py"
+  run_test "$CDIR/test_xla_builder_batch.py"
+  run_test "$CDIR/test_continuous_batching.py"
+  run_test "$CDIR/test_device_metrics.py"
   run_device_detection_test "$CDIR/test_gpu_device_detection.py"
   # NOTE: this line below is testing export and don't care about GPU
   PJRT_DEVICE=CPU CPU_NUM_DEVICES=1 run_coverage "$CDIR/test_core_aten_ops.py"
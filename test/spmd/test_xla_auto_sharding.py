@@ -88,6 +88,57 @@ class XlaAutoShardingTest(test_xla_sharding_base.XlaShardingTest):
     cnt = met.counter_value("CompileWithAutoSharding")
     self.assertTrue((cnt is not None) and (cnt <= 3))
 
+  @unittest.skipUnless(xr.device_type() in ["TPU", "CPU"],
+                       "Auto-sharding currently supports TPU & CPU backends.")
+  def test_in_place_update_donates_buffers(self):
+    met.clear_all()
+    xw = torch.randn(64, 64).to(xm.xla_device())
+    xg = torch.randn(64, 64).to(xm.xla_device())
+    xm.mark_step()
+    expected = xw.cpu() - 0.1 * xg.cpu()
+    xw -= 0.1 * xg
+    xm.mark_step()
+    self.assertTrue(torch.allclose(expected, xw.cpu(), atol=1e-5))
+    # The updated weight aliases its input shard after partitioning.
+    _, aliased, _ = met.metric_data("AutoShardingAliasCount")
+    self.assertGreaterEqual(aliased, 1)
+
+  @unittest.skipUnless(xr.device_type() in ["TPU", "CPU"],
+                       "Auto-sharding currently supports TPU & CPU backends.")
+  @patch.dict(os.environ, {'XLA_AUTO_SPMD_MESH_EXPLORE': '1'})
+  def test_mesh_exploration(self):
+    if self.n_devices < 4:
+      self.skipTest("Needs several 2D meshes to explore.")
+    met.clear_counters()
+    t1 = torch.randn(32, 64)
+    t2 = torch.randn(64, 16)
+    expected = t1 @ t2
+
+    for _ in range(2):
+      xt1 = t1.to(xm.xla_device())
+      xt2 = t2.to(xm.xla_device())
+      xt3 = xt1 @ xt2
+      xm.mark_step()
+      self.assertTrue(torch.allclose(expected, xt3.cpu(), atol=1e-5))
+    # Every 2D mesh was compiled once, for the first step only.
+    self.assertGreaterEqual(met.counter_value("AutoShardingMeshExplored"), 2)
+    self.assertEqual(met.counter_value("CompileWithAutoSharding"), 1)
+
+  def test_replicated_data_uploaded_once(self):
+    if self.n_devices < 2:
+      self.skipTest("Needs several devices to copy the replicas to.")
+    met.clear_counters()
+    t = torch.randn(128, 64)
+    xt = t.to(xm.xla_device())
+    # The implicitly replicated data goes through the host once, and is then
+    # copied between the devices.
+    shard_bytes = t.numel() * t.element_size()
+    self.assertEqual(met.counter_value("TransferShardsHostBytes"), shard_bytes)
+    self.assertEqual(
+        met.counter_value("TransferShardsDeviceCopyBytes"),
+        (self.n_devices - 1) * shard_bytes)
+    self.assertTrue(torch.allclose(t, xt.cpu()))
+
 
 if __name__ == '__main__':
   test = unittest.main()
@@ -14,6 +14,7 @@ import torch.distributed.checkpoint as dist_cp
 import torch_xla
 import torch_xla.core.xla_model as xm
 import torch_xla.runtime as xr
+import torch_xla.debug.metrics as met
 import torch_xla.distributed.spmd as xs
 
 from torch.distributed.checkpoint._fsspec_filesystem import *
@@ -23,7 +24,7 @@ from torch.distributed.checkpoint.default_planner import (
     create_default_local_save_plan,
     create_default_global_save_plan,
 )
-from torch_xla.experimental.distributed_checkpoint import SPMDLoadPlanner, SPMDSavePlanner, CheckpointManager, prime_optimizer
+from torch_xla.experimental.distributed_checkpoint import SPMDLoadPlanner, SPMDSavePlanner, CheckpointManager, prime_optimizer, save_local_shards, load_local_shards
 from torch_xla.experimental.distributed_checkpoint._helpers import (
     _sharded_cpu_state_dict, _CpuShards, _is_sharded_tensor)
 
@@ -197,6 +198,38 @@ class EndToEndCheckpointTest(DistributedCheckpointTestBase):
     dist.destroy_process_group()
 
 
+class LocalShardsCheckpointTest(DistributedCheckpointTestBase):
+
+  @run_with_tmpdir
+  def test_save_and_load(self, tmpdir):
+    met.clear_counters()
+    model_in = self._get_sharded_model()
+    model_out = self._get_sharded_model()
+    # A small buffer bound, so that the shards go through one at a time.
+    save_local_shards(model_in.state_dict(), tmpdir, max_buffered_bytes=1)
+    for p1, p2 in zip(model_in.parameters(), model_out.parameters()):
+      self.assertFalse(torch.allclose(p1.cpu(), p2.cpu()))
+
+    load_local_shards(model_out.state_dict(), tmpdir, max_buffered_bytes=1)
+    for p1, p2 in zip(model_in.parameters(), model_out.parameters()):
+      self.assertTrue(torch.allclose(p1.cpu(), p2.cpu()))
+    self.assertEqual(
+        torch_xla._XLAC._get_xla_sharding_spec(model_in.fc1.weight),
+        torch_xla._XLAC._get_xla_sharding_spec(model_out.fc1.weight))
+    self.assertGreater(met.counter_value('CheckpointShardWritten'), 0)
+    self.assertGreater(met.counter_value('CheckpointShardRead'), 0)
+
+  @run_with_tmpdir
+  def test_load_with_other_sharding_fails(self, tmpdir):
+    if self.n_devices < 2:
+      self.skipTest('Needs an uneven sharding of several devices')
+    model_in = self._get_sharded_model(mesh_shape=(1, self.n_devices))
+    model_out = self._get_sharded_model(mesh_shape=(self.n_devices, 1))
+    save_local_shards(model_in.state_dict(), tmpdir)
+    with self.assertRaises(RuntimeError):
+      load_local_shards(model_out.state_dict(), tmpdir)
+
+
 class SPMDLoadPlannerTest(DistributedCheckpointTestBase):
 
   def _get_load_planner(self, model):
@@ -575,6 +608,35 @@ class CheckpointManagerTest(DistributedCheckpointTestBase):
       # Scope the PreemptionSyncManager to the lifespan of the test.
       torch_xla._XLAC._deactivate_preemption_sync_manager()
 
+  def test_preemption_snapshot(self):
+    try:
+      torch_xla._XLAC._activate_preemption_sync_manager()
+      device = xm.xla_device()
+      param = torch.zeros(4, 4, device=device)
+      torch_xla._XLAC._xla_set_preemption_snapshot_tensors([param])
+      for _ in range(3):
+        param += 1
+        xm.mark_step()
+      self.assertIsNone(torch_xla._XLAC._xla_preemption_snapshot_step())
+
+      os.kill(os.getpid(), signal.SIGTERM)
+      # The step markers take the snapshot once the SIGTERM is propagated.
+      for attempt in range(10):
+        param += 1
+        xm.mark_step()
+        step = torch_xla._XLAC._xla_preemption_snapshot_step()
+        if step is not None:
+          break
+        time.sleep(1)
+      self.assertIsNotNone(step, "No snapshot was taken after SIGTERM")
+      expected = param.cpu()
+      snapshot = torch_xla._XLAC._xla_wait_preemption_snapshot()
+      self.assertEqual(len(snapshot), 1)
+      self.assertTrue(torch.allclose(snapshot[0], expected))
+    finally:
+      torch_xla._XLAC._xla_set_preemption_snapshot_tensors([])
+      torch_xla._XLAC._deactivate_preemption_sync_manager()
+
   @unittest.skipIf(xr.device_type() != 'TPU',
                    'TPU required for worker IP discovery')
   @run_with_tmpdir
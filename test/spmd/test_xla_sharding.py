@@ -1015,6 +1015,41 @@ class BasicXlaShardingTest(test_xla_sharding_base.XlaShardingTest):
       expected = torch.arange(2).reshape(1, 2)
       self.assertTrue(torch.allclose(global_tensor.cpu(), expected))
 
+  def test_global_tensor_from_local_shards(self):
+    mesh = self._get_mesh((self.n_devices, 1))
+    shards = [
+        torch.arange(8).reshape(2, 4) + 8 * i for i in range(self.n_devices)
+    ]
+
+    global_tensor = xs.global_tensor_from_local_shards(shards, mesh, (0, 1))
+    self.assertEqual(global_tensor.shape, (2 * self.n_devices, 4))
+    self.assertTrue(
+        torch.allclose(global_tensor.cpu(),
+                       torch.arange(8 * self.n_devices).reshape(-1, 4)))
+    self.assertIn(f'devices=[{self.n_devices},1]',
+                  torch_xla._XLAC._get_xla_sharding_spec(global_tensor))
+
+  def test_parallel_loader_local_shards(self):
+    import torch_xla.distributed.parallel_loader as pl
+    mesh = self._get_mesh((self.n_devices, 1))
+    steps = 3
+    batches = [
+        (xs.LocalShards(
+            [torch.full((2, 4), step * self.n_devices + i)
+             for i in range(self.n_devices)],
+            mesh, (0, None)), torch.tensor(step)) for step in range(steps)
+    ]
+
+    loader = pl.MpDeviceLoader(batches, xm.xla_device())
+    for step, (data, label) in enumerate(loader):
+      self.assertEqual(data.shape, (2 * self.n_devices, 4))
+      expected = torch.arange(self.n_devices).repeat_interleave(2) + (
+          step * self.n_devices)
+      self.assertTrue(
+          torch.allclose(data.cpu(), expected.unsqueeze(1).expand(-1, 4)))
+      self.assertEqual(label.item(), step)
+    self.assertEqual(step, steps - 1)
+
   def test_from_cpu_shards_global_shape(self):
     from_cpu_shards = torch_xla._XLAC._global_tensor_from_cpu_shards
 
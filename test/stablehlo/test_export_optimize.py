@@ -0,0 +1,34 @@
+import os
+import sys
+import unittest
+
+os.environ['XLA_STABLEHLO_EXPORT_OPTIMIZE'] = '1'
+
+import torch
+import torch_xla.debug.metrics as met
+from torch_xla.stablehlo import exported_program_to_stablehlo
+
+
+class RoundTripConvert(torch.nn.Module):
+
+  def forward(self, x):
+    return x.to(torch.float64).to(torch.float32) * 2 + torch.ones(4, 4)
+
+
+class ExportOptimizeTest(unittest.TestCase):
+
+  def test_round_trip_convert(self):
+    args = (torch.randn(4, 4),)
+    exported = torch.export.export(RoundTripConvert(), args)
+    met.clear_all()
+    shlo = exported_program_to_stablehlo(exported)
+    text = shlo.get_stablehlo_text()
+    self.assertNotIn('f64', text)
+    self.assertGreater(met.metric_data('StableHloExportOpsRemoved')[1], 0)
+    self.assertTrue(
+        torch.allclose(shlo(*args), RoundTripConvert()(*args), atol=1e-6))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -7,6 +7,7 @@ import torch_xla
 import torch_xla.core.xla_model as xm
 import torch_xla.debug.metrics as met
 import torch_xla.debug.metrics_compare_utils as mcu
+from torch_xla.stablehlo import exported_program_to_stablehlo
 import torchvision
 
 os.environ['XLA_STABLEHLO_COMPILE'] = '1'
@@ -36,6 +37,24 @@ class StableHloCompileTest(unittest.TestCase):
         torch.allclose(cpu_output, xla_output.cpu(), rtol=1e-05, atol=1e-05))
     self.assertEqual(met.counter_value('StableHloCompile'), 1)
 
+  def test_stablehlo_program_compiles_without_conversion(self):
+
+    class AddMul(torch.nn.Module):
+
+      def forward(self, x, y):
+        return (x + y) * y
+
+    args = (torch.randn(8, 8), torch.randn(8, 8))
+    exported = torch.export.export(AddMul(), args)
+    shlo = exported_program_to_stablehlo(exported)
+    met.clear_all()
+    output = shlo(*args)
+    self.assertTrue(torch.allclose(AddMul()(*args), output.cpu()))
+    # The program is compiled from its bytecode, without converting the HLO
+    # back to StableHLO.
+    self.assertEqual(met.counter_value('StableHloCompileWithoutConversion'), 1)
+    self.assertIn('StableHloToHloTime', met.metric_names())
+
 
 if __name__ == '__main__':
   test = unittest.main()
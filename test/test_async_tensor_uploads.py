@@ -0,0 +1,43 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+# Run with XLA_ASYNC_TENSOR_UPLOADS=1.
+
+
+class AsyncTensorUploadsTest(unittest.TestCase):
+
+  def test_model_to_device(self):
+    model = torch.nn.Sequential(*[torch.nn.Linear(256, 256) for _ in range(4)])
+    x = torch.randn(8, 256)
+    expected = model(x)
+    met.clear_all()
+    xla_model = model.to(xm.xla_device())
+    out = xla_model(x.to(xm.xla_device()))
+    self.assertGreater(met.counter_value('AsyncTensorUploads'), 0)
+    self.assertEqual(met.counter_value('AsyncTensorUploadTensors'), 9)
+    self.assertTrue(torch.allclose(out.cpu(), expected, atol=1e-4))
+
+  def test_read_back_before_execution(self):
+    host = torch.randn(128, 128)
+    t = host.to(xm.xla_device())
+    self.assertTrue(torch.equal(t.cpu(), host))
+
+  def test_compile_then_execute(self):
+    weight = torch.randn(512, 512)
+    xla_weight = weight.to(xm.xla_device())
+    out = (xla_weight @ xla_weight).sum()
+    # The sync of a graph using the placeholder waits for its upload.
+    torch_xla._XLAC._xla_warm_up_cache([out], [])
+    xm.mark_step()
+    self.assertTrue(
+        torch.allclose(out.cpu(), (weight @ weight).sum(), rtol=1e-3))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,46 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+# Run with XLA_AUTO_PARAMETER_LAYOUTS=1.
+
+
+class AutoParameterLayoutsTest(unittest.TestCase):
+
+  def test_training_steps(self):
+    device = xm.xla_device()
+    torch.manual_seed(0)
+    model = torch.nn.Sequential(
+        torch.nn.Linear(64, 128), torch.nn.ReLU(), torch.nn.Linear(128, 8))
+    cpu_model = torch.nn.Sequential(
+        torch.nn.Linear(64, 128), torch.nn.ReLU(), torch.nn.Linear(128, 8))
+    cpu_model.load_state_dict(model.state_dict())
+    model = model.to(device)
+    optimizer = torch.optim.SGD(model.parameters(), lr=0.1)
+    cpu_optimizer = torch.optim.SGD(cpu_model.parameters(), lr=0.1)
+    x = torch.randn(16, 64)
+    xla_x = x.to(device)
+    met.clear_all()
+    relayouts = []
+    for _ in range(4):
+      for m, opt, inputs in ((model, optimizer, xla_x),
+                             (cpu_model, cpu_optimizer, x)):
+        opt.zero_grad()
+        m(inputs).square().mean().backward()
+        opt.step()
+      xm.mark_step()
+      relayouts.append(met.counter_value('AutoLayoutRelayouts') or 0)
+    self.assertGreater(met.counter_value('CompileWithAutoParameterLayouts'), 0)
+    # The parameters keep the layouts they were moved to.
+    self.assertEqual(relayouts[-1], relayouts[1])
+    for xla_p, cpu_p in zip(model.parameters(), cpu_model.parameters()):
+      self.assertTrue(torch.allclose(xla_p.cpu(), cpu_p, rtol=1e-4, atol=1e-5))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
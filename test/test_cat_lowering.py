@@ -0,0 +1,73 @@
+import os
+import sys
+
+# Small enough for the concatenations of the tests to be lowered as trees.
+os.environ['XLA_CONCAT_MAX_OPERANDS'] = '4'
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class CatLoweringTest(unittest.TestCase):
+
+  def test_many_operands(self):
+    device = xm.xla_device()
+    inputs = [torch.randn(2, 3) for _ in range(37)]
+    met.clear_all()
+    xla_inputs = [t.to(device) for t in inputs]
+    cat = torch.cat(xla_inputs, dim=1)
+    stack = torch.stack(xla_inputs, dim=0)
+    torch.testing.assert_close(cat.cpu(), torch.cat(inputs, dim=1))
+    torch.testing.assert_close(stack.cpu(), torch.stack(inputs, dim=0))
+    self.assertGreater(met.counter_value('ConcatTreeLevels'), 0)
+
+  def test_split_of_cat(self):
+    device = xm.xla_device()
+    inputs = [torch.randn(4, n) for n in (3, 5, 2)]
+    xla_inputs = [t.to(device) for t in inputs]
+    met.clear_all()
+    splits = torch.split(torch.cat(xla_inputs, dim=1), [3, 5, 2], dim=1)
+    hlo = torch_xla._XLAC._get_xla_tensors_hlo(list(splits))
+    self.assertNotIn('concatenate(', hlo)
+    self.assertEqual(met.counter_value('CatSlicesElided'), 3)
+    for split, input in zip(splits, inputs):
+      torch.testing.assert_close(split.cpu(), input)
+
+  def test_slice_of_cat(self):
+    device = xm.xla_device()
+    inputs = [torch.randn(n, 4) for n in (3, 5, 2)]
+    xla_cat = torch.cat([t.to(device) for t in inputs])
+    met.clear_all()
+    middle = xla_cat[3:8]
+    tail = xla_cat[3:]
+    self.assertNotIn('concatenate(',
+                     torch_xla._XLAC._get_xla_tensors_hlo([middle]))
+    torch.testing.assert_close(middle.cpu(), inputs[1])
+    torch.testing.assert_close(tail.cpu(), torch.cat(inputs[1:]))
+    self.assertEqual(met.counter_value('CatSlicesElided'), 2)
+
+  def test_unaligned_slice_of_cat(self):
+    device = xm.xla_device()
+    inputs = [torch.randn(n, 4) for n in (3, 5, 2)]
+    met.clear_all()
+    xla_slice = torch.cat([t.to(device) for t in inputs])[2:6]
+    torch.testing.assert_close(xla_slice.cpu(), torch.cat(inputs)[2:6])
+    self.assertIsNone(met.counter_value('CatSlicesElided'))
+
+  def test_unbind_of_stack(self):
+    device = xm.xla_device()
+    inputs = [torch.randn(2, 3) for _ in range(4)]
+    met.clear_all()
+    slices = torch.stack([t.to(device) for t in inputs], dim=1).unbind(1)
+    self.assertNotIn('concatenate(',
+                     torch_xla._XLAC._get_xla_tensors_hlo(list(slices)))
+    for xla_slice, input in zip(slices, inputs):
+      torch.testing.assert_close(xla_slice.cpu(), input)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,48 @@
+import os
+import sys
+
+# Small enough for the features of the tests to be reduced in chunks.
+os.environ['XLA_CDIST_CHUNK_ELEMENTS'] = '2048'
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class CdistTest(unittest.TestCase):
+
+  def test_chunked_features(self):
+    device = xm.xla_device()
+    x1 = torch.randn(2, 16, 37)
+    x2 = torch.randn(2, 12, 37)
+    for p in [0.0, 1.0, 3.0, float('inf')]:
+      met.clear_all()
+      expected = torch.cdist(x1, x2, p)
+      actual = torch.cdist(x1.to(device), x2.to(device), p)
+      torch.testing.assert_close(actual.cpu(), expected, rtol=1e-4, atol=1e-4)
+      self.assertEqual(met.counter_value('CdistChunkedFeatures'), 1)
+
+  def test_euclidean_uses_matmul(self):
+    device = xm.xla_device()
+    x1 = torch.randn(40, 8)
+    x2 = torch.randn(30, 8)
+    expected = torch._cdist_forward(x1, x2, 2.0, None)
+    actual = torch._cdist_forward(x1.to(device), x2.to(device), 2.0, None)
+    self.assertIn('dot(', torch_xla._XLAC._get_xla_tensors_hlo([actual]))
+    torch.testing.assert_close(actual.cpu(), expected, rtol=1e-4, atol=1e-4)
+
+  def test_euclidean_without_matmul(self):
+    device = xm.xla_device()
+    x1 = torch.randn(40, 8)
+    x2 = torch.randn(30, 8)
+    expected = torch._cdist_forward(x1, x2, 2.0, 2)
+    actual = torch._cdist_forward(x1.to(device), x2.to(device), 2.0, 2)
+    self.assertNotIn('dot(', torch_xla._XLAC._get_xla_tensors_hlo([actual]))
+    torch.testing.assert_close(actual.cpu(), expected, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
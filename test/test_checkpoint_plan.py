@@ -0,0 +1,69 @@
+import sys
+
+import torch
+import torch.nn as nn
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.utils.checkpoint as checkpoint
+import unittest
+
+
+class Block(nn.Module):
+
+  def __init__(self, elementwise):
+    super().__init__()
+    self.linear = nn.Linear(64, 64)
+    self.elementwise = elementwise
+
+  def forward(self, x):
+    x = self.linear(x)
+    for _ in range(self.elementwise):
+      x = torch.sigmoid(x) * x
+    return x
+
+
+class CheckpointPlanTest(unittest.TestCase):
+
+  def _model(self, device):
+    return nn.Sequential(Block(1), Block(6), Block(1)).to(device)
+
+  def test_plan_prefers_cheap_activations(self):
+    device = xm.xla_device()
+    model = self._model(device)
+    x = torch.randn(32, 64, device=device)
+    plan = checkpoint.plan_checkpointing(
+        model, (x,), candidates=['0', '1', '2'], budget_bytes=0)
+    self.assertEqual(plan.modules[0], '1')
+    self.assertEqual(sorted(plan.modules), ['0', '1', '2'])
+    self.assertGreater(plan.activation_bytes['1'], plan.activation_bytes['0'])
+    self.assertEqual(plan.saved_bytes, sum(plan.activation_bytes.values()))
+
+    plan = checkpoint.plan_checkpointing(
+        model, (x,),
+        candidates=['0', '1', '2'],
+        budget_bytes=sum(plan.activation_bytes.values()) -
+        plan.activation_bytes['1'])
+    self.assertEqual(plan.modules, ['1'])
+    self.assertLess(plan.recompute_fraction, 0.5)
+    xm.mark_step()
+
+  def test_apply_plan(self):
+    device = xm.xla_device()
+    torch.manual_seed(0)
+    model = self._model(device)
+    x = torch.randn(32, 64, device=device, requires_grad=True)
+    model(x).sum().backward()
+    expected = [p.grad.cpu() for p in model.parameters()]
+    model.zero_grad()
+
+    plan = checkpoint.plan_checkpointing(
+        model, (x,), candidates=['0', '1', '2'], budget_bytes=0)
+    checkpoint.apply_checkpoint_plan(model, plan)
+    model(x).sum().backward()
+    for param, grad in zip(model.parameters(), expected):
+      self.assertTrue(torch.allclose(param.grad.cpu(), grad, atol=1e-4))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
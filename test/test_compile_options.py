@@ -0,0 +1,44 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+from torch_xla.experimental import compile_options
+import unittest
+
+
+class CompileOptionsTest(unittest.TestCase):
+
+  def test_scoped_options(self):
+    self.assertEqual(compile_options.get_compile_options(), {})
+    with compile_options.compile_options(xla_backend_optimization_level=0):
+      with compile_options.compile_options(xla_cpu_enable_fast_math=False):
+        self.assertEqual(
+            compile_options.get_compile_options(), {
+                'xla_backend_optimization_level': 0,
+                'xla_cpu_enable_fast_math': False
+            })
+      self.assertEqual(compile_options.get_compile_options(),
+                       {'xla_backend_optimization_level': 0})
+    self.assertEqual(compile_options.get_compile_options(), {})
+
+  def test_options_are_part_of_the_hash(self):
+    device = xm.xla_device()
+    x = torch.randn(16, 16, device=device)
+    xm.mark_step()
+    met.clear_all()
+    expected = (x.cpu() @ x.cpu()).sum()
+    torch.testing.assert_close((x @ x).sum().cpu(), expected)
+    with compile_options.compile_options(xla_backend_optimization_level=0):
+      torch.testing.assert_close((x @ x).sum().cpu(), expected)
+    self.assertEqual(met.metric_data('CompileTime')[0], 2)
+    self.assertEqual(met.counter_value('CompileWithOptionOverrides'), 1)
+    # Both executables are cached as they were compiled.
+    torch.testing.assert_close((x @ x).sum().cpu(), expected)
+    self.assertEqual(met.metric_data('CompileTime')[0], 2)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
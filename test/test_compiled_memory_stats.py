@@ -0,0 +1,47 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import torch_xla.runtime as xr
+import unittest
+
+
+class CompiledMemoryStatsTest(unittest.TestCase):
+
+  def test_compiled_memory_stats(self):
+    device = xm.xla_device()
+    x = torch.randn(64, 64, device=device)
+    y = x @ x + 1
+    xm.mark_step()
+    future = xm.last_execution_future()
+    self.assertIsNotNone(future)
+    future.wait()
+
+    memory_stats = met.compiled_memory_stats()
+    if not memory_stats:
+      self.skipTest('The runtime does not report compiled memory stats')
+    self.assertIn(future.graph_hash, memory_stats)
+    graph_stats = memory_stats[future.graph_hash]
+    self.assertGreaterEqual(graph_stats['output_bytes'], y.numel() * 4)
+    self.assertEqual(
+        graph_stats['execution_bytes'],
+        graph_stats['output_bytes'] - graph_stats['alias_bytes'] +
+        graph_stats['temp_bytes'] + graph_stats['generated_code_bytes'])
+
+  @unittest.skipIf(xr.device_type() == 'CPU',
+                   'The CPU allocator does not report its stats')
+  def test_memory_info(self):
+    device = xm.xla_device()
+    x = torch.randn(256, 256, device=device)
+    xm.mark_step()
+    info = xm.get_memory_info(device)
+    self.assertGreaterEqual(info['peak_bytes_used'], info['bytes_used'])
+    self.assertGreaterEqual(info['fragmentation'], 0.0)
+    self.assertLessEqual(info['fragmentation'], 1.0)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
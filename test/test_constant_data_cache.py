@@ -0,0 +1,45 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class ConstantDataCacheTest(unittest.TestCase):
+
+  def test_repeated_constant_uploaded_once(self):
+    device = xm.xla_device()
+    t = torch.rand(2, device=device)
+    xm.mark_step()
+    met.clear_counters()
+    for _ in range(3):
+      c = torch.tensor([0.5, 0.25], device=device)
+      t = t * c
+      xm.mark_step()
+    self.assertEqual(met.counter_value('ConstantDataCacheMiss'), 1)
+    self.assertEqual(met.counter_value('ConstantDataCacheHit'), 2)
+
+  def test_distinct_constants(self):
+    device = xm.xla_device()
+    met.clear_counters()
+    a = torch.tensor([3, 4], dtype=torch.int32, device=device)
+    b = torch.tensor([3, 4], dtype=torch.int64, device=device)
+    c = torch.tensor([3, 5], dtype=torch.int32, device=device)
+    result = (a + b + c).cpu()
+    self.assertEqual(result.tolist(), [9, 13])
+    self.assertEqual(met.counter_value('ConstantDataCacheMiss'), 3)
+    self.assertFalse(met.counter_value('ConstantDataCacheHit'))
+
+  def test_large_tensor_not_cached(self):
+    device = xm.xla_device()
+    met.clear_counters()
+    t = torch.zeros(1024, device=device) + 1
+    xm.mark_step()
+    self.assertFalse(met.counter_value('ConstantDataCacheMiss'))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,95 @@
+import sys
+import unittest
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+from torch_xla.experimental.continuous_batching import SlotBatch
+
+
+def decode(state, active, positions):
+  # Each active slot adds its position and writes it into its cache.
+  state['sums'].add_(active * positions)
+  index = positions.clamp(max=state['cache'].size(1) - 1).long().unsqueeze(1)
+  state['cache'].scatter_(1, index, positions.unsqueeze(1).float())
+  return state['sums'] * active
+
+
+class ContinuousBatchingTest(unittest.TestCase):
+
+  def _batch(self, num_slots=4):
+    device = xm.xla_device()
+    return SlotBatch(
+        decode,
+        num_slots=num_slots,
+        state={
+            'sums': torch.zeros(num_slots, dtype=torch.int32, device=device),
+            'cache': torch.zeros(num_slots, 8, device=device),
+        })
+
+  def test_slots(self):
+    batch = self._batch(num_slots=2)
+    self.assertEqual(batch.insert('a'), 0)
+    self.assertEqual(batch.insert('b'), 1)
+    self.assertEqual(batch.num_free_slots, 0)
+    with self.assertRaises(AssertionError):
+      batch.insert('c')
+    self.assertEqual(batch.evict('a'), 0)
+    self.assertEqual(batch.insert('c'), 0)
+    self.assertEqual(batch.requests, {'b': 1, 'c': 0})
+    self.assertIsNone(batch.slot_of('a'))
+
+  def test_decode(self):
+    batch = self._batch()
+    zero = torch.tensor(0, dtype=torch.int32)
+    batch.insert('a', position=2, sums=zero)
+    batch.insert('b', position=5, sums=zero, cache=torch.ones(3))
+    outputs = batch.step()
+    self.assertEqual(outputs.cpu().tolist(), [2, 5, 0, 0])
+    outputs = batch.step()
+    self.assertEqual(outputs.cpu().tolist(), [5, 11, 0, 0])
+    self.assertEqual(batch.positions.cpu().tolist(), [4, 7, 0, 0])
+    cache = batch.state['cache'].cpu()
+    self.assertEqual(cache[0].tolist(), [0, 0, 2, 3, 0, 0, 0, 0])
+    self.assertEqual(cache[1].tolist(), [1, 1, 1, 0, 0, 5, 6, 0])
+
+  def test_load_levels_share_graphs(self):
+    batch = self._batch()
+    zero = torch.tensor(0, dtype=torch.int32)
+    # Compiles the insertion, the eviction and the step.
+    batch.insert('warmup', sums=zero)
+    for _ in range(3):
+      batch.step()
+    batch.evict('warmup')
+    xm.wait_device_ops()
+    met.clear_all()
+
+    expected = [0] * 4
+    positions = [0] * 4
+    active = set()
+    for step, (inserts, evicts) in enumerate([(1, 0), (2, 0), (0, 1), (1, 2),
+                                              (3, 0), (0, 3)]):
+      for i in range(evicts):
+        request = sorted(active)[0]
+        active.remove(request)
+        batch.evict(request)
+      for i in range(inserts):
+        request = f'{step}-{i}'
+        slot = batch.insert(request, position=step, sums=zero)
+        expected[slot] = 0
+        positions[slot] = step
+        active.add(request)
+      outputs = batch.step().cpu().tolist()
+      for request in active:
+        slot = batch.slot_of(request)
+        expected[slot] += positions[slot]
+        positions[slot] += 1
+        self.assertEqual(outputs[slot], expected[slot])
+    self.assertIsNone(met.metric_data('CompileTime'))
+    self.assertEqual(met.counter_value('GraphReplay'), 6)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
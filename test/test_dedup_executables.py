@@ -0,0 +1,41 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class DedupExecutablesTest(unittest.TestCase):
+
+  def test_same_hlo_reuses_executable(self):
+    met.clear_all()
+    device = xm.xla_device()
+    xt = torch.randn(4, 4).to(device)
+    # The integer and floating point special scalars hash differently in the
+    # IR, and both lower to the same F32 constant.
+    a = xt - 1
+    b = xt - 1.0
+    self.assertNotEqual(
+        torch_xla._XLAC._get_graph_hash([a]),
+        torch_xla._XLAC._get_graph_hash([b]))
+    expected = xt.cpu() - 1
+    torch.testing.assert_close(a.cpu(), expected)
+    torch.testing.assert_close(b.cpu(), expected)
+    self.assertEqual(met.counter_value('UncachedCompile'), 2)
+    self.assertEqual(met.counter_value('DeduplicatedExecutables'), 1)
+    self.assertEqual(met.metric_data('CompileTime')[0], 1)
+
+  def test_different_hlo_compiles(self):
+    met.clear_all()
+    device = xm.xla_device()
+    xt = torch.randn(4, 4).to(device)
+    (xt * 5).cpu()
+    (xt + 5).cpu()
+    self.assertIsNone(met.counter_value('DeduplicatedExecutables'))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
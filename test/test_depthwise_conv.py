@@ -0,0 +1,77 @@
+import os
+import sys
+
+# Lower the depthwise convolutions by taps on every device.
+os.environ['XLA_DEPTHWISE_CONV_MAX_TAPS'] = '27'
+
+import torch
+import torch.nn.functional as F
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class DepthwiseConvTest(unittest.TestCase):
+
+  def _test_conv(self, conv_fn, input_size, weight_size, groups, **kwargs):
+    device = xm.xla_device()
+    input = torch.randn(*input_size, requires_grad=True)
+    weight = torch.randn(*weight_size, requires_grad=True)
+    bias = torch.randn(weight_size[0], requires_grad=True)
+    expected = conv_fn(input, weight, bias, groups=groups, **kwargs)
+    expected.pow(2).sum().backward()
+
+    xla_inputs = [
+        t.detach().to(device).requires_grad_() for t in (input, weight, bias)
+    ]
+    met.clear_all()
+    output = conv_fn(*xla_inputs, groups=groups, **kwargs)
+    output.pow(2).sum().backward()
+    xm.mark_step()
+
+    torch.testing.assert_close(output.cpu(), expected, rtol=1e-4, atol=1e-4)
+    for xla_input, input in zip(xla_inputs, (input, weight, bias)):
+      torch.testing.assert_close(
+          xla_input.grad.cpu(), input.grad, rtol=1e-4, atol=1e-3)
+    self.assertIn('DepthwiseConvTaps', met.counter_names())
+
+  def test_depthwise(self):
+    self._test_conv(F.conv2d, (2, 8, 9, 9), (8, 1, 3, 3), groups=8, padding=1)
+
+  def test_depthwise_strided(self):
+    self._test_conv(
+        F.conv2d, (2, 6, 11, 10), (6, 1, 5, 5), groups=6, stride=2, padding=2)
+
+  def test_depthwise_dilated(self):
+    self._test_conv(
+        F.conv2d, (1, 4, 12, 12), (4, 1, 3, 3),
+        groups=4,
+        dilation=2,
+        padding=1)
+
+  def test_depthwise_multiplier(self):
+    self._test_conv(
+        F.conv2d, (2, 4, 8, 7), (12, 1, 3, 2), groups=4, stride=(1, 2))
+
+  def test_depthwise_3d(self):
+    self._test_conv(
+        F.conv3d, (1, 3, 5, 6, 6), (3, 1, 3, 3, 3), groups=3, padding=1)
+
+  def test_grouped_is_not_depthwise(self):
+    device = xm.xla_device()
+    input = torch.randn(2, 8, 9, 9)
+    weight = torch.randn(8, 2, 3, 3)
+    met.clear_all()
+    output = F.conv2d(input.to(device), weight.to(device), groups=4)
+    torch.testing.assert_close(
+        output.cpu(), F.conv2d(input, weight, groups=4), rtol=1e-4, atol=1e-4)
+    self.assertIsNone(met.counter_value('DepthwiseConvTaps'))
+
+
+if __name__ == '__main__':
+  torch.manual_seed(42)
+  torch_xla._XLAC._xla_set_use_full_mat_mul_precision(
+      use_full_mat_mul_precision=True)
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
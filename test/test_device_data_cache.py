@@ -0,0 +1,73 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+# The cache is set up once per process, run with XLA_DEVICE_DATA_CACHE_MB=64
+# and XLA_DEVICE_DATA_CACHE_SAMPLE_KB=64.
+
+
+class DeviceDataCacheTest(unittest.TestCase):
+
+  def _step(self, host, weight):
+    out = (weight + host.to(xm.xla_device())).sum()
+    xm.mark_step()
+    return out.cpu()
+
+  def test_identical_tensors_reuse_device_data(self):
+    weight = torch.randn(64, 64, device=xm.xla_device())
+    mask = torch.tril(torch.ones(64, 64))
+    expected = (weight.cpu() + mask).sum()
+    met.clear_all()
+    for _ in range(3):
+      out = self._step(torch.tril(torch.ones(64, 64)), weight)
+      self.assertTrue(torch.allclose(out, expected, rtol=1e-4))
+    self.assertEqual(met.counter_value('DeviceDataCacheMiss'), 1)
+    self.assertEqual(met.counter_value('DeviceDataCacheHit'), 2)
+    self.assertEqual(
+        met.counter_value('DeviceDataCacheBytesSaved'), 2 * mask.nbytes)
+
+  def test_different_tensors_miss(self):
+    weight = torch.zeros(64, 64, device=xm.xla_device())
+    met.clear_all()
+    for i in range(3):
+      host = torch.full((64, 64), float(i))
+      out = self._step(host, weight)
+      self.assertEqual(out.item(), 64 * 64 * i)
+    self.assertIsNone(met.counter_value('DeviceDataCacheHit'))
+
+  def test_sampled_tensors(self):
+    # Above the sampling size, with a difference the samples may not see.
+    weight = torch.zeros(256, 256, device=xm.xla_device())
+    base = torch.arange(256 * 256, dtype=torch.float32).view(256, 256)
+    met.clear_all()
+    for _ in range(3):
+      out = self._step(base.clone(), weight)
+      self.assertEqual(out.item(), base.sum().item())
+    # Cached from its second upload, hit on the third.
+    self.assertEqual(met.counter_value('DeviceDataCacheHit'), 1)
+    changed = base.clone()
+    changed[3, 5] += 1
+    out = self._step(changed, weight)
+    self.assertEqual(out.item(), changed.sum().item())
+    self.assertEqual(met.counter_value('DeviceDataCacheHit'), 1)
+
+  def test_in_place_update_keeps_cached_data(self):
+    host = torch.randn(32, 32)
+    met.clear_all()
+    t = host.to(xm.xla_device())
+    t.add_(1)
+    xm.mark_step()
+    # The shared device data was not donated to the update of `t`.
+    other = host.to(xm.xla_device())
+    self.assertTrue(torch.allclose((other * 2).cpu(), host * 2))
+    self.assertTrue(torch.allclose(t.cpu(), host + 1))
+    self.assertEqual(met.counter_value('DeviceDataCacheHit'), 1)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
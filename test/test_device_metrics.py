@@ -0,0 +1,76 @@
+import sys
+import unittest
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+from torch_xla.experimental.device_metrics import DeviceMetrics
+
+
+class DeviceMetricsTest(unittest.TestCase):
+
+  def test_kinds(self):
+    device = xm.xla_device()
+    metrics = DeviceMetrics()
+    values = [torch.randn(3, 4) for _ in range(3)]
+    for value in values:
+      xla_value = value.to(device)
+      for kind in ('sum', 'mean', 'max', 'min'):
+        metrics.update(kind, xla_value, kind=kind)
+    xm.mark_step()
+    metrics.step()
+    result = metrics.values(wait=True)
+    expected = torch.stack(values)
+    self.assertAlmostEqual(result['sum'], expected.sum().item(), places=4)
+    self.assertAlmostEqual(result['mean'], expected.mean().item(), places=5)
+    self.assertAlmostEqual(result['max'], expected.max().item(), places=5)
+    self.assertAlmostEqual(result['min'], expected.min().item(), places=5)
+
+  def test_weights(self):
+    device = xm.xla_device()
+    metrics = DeviceMetrics()
+    value = torch.tensor([1.0, 2.0, 3.0])
+    weight = torch.tensor([1.0, 0.0, 3.0])
+    metrics.update('weighted', value.to(device), weight=weight.to(device))
+    metrics.update('scaled', value.to(device), weight=2.0, kind='sum')
+    xm.mark_step()
+    metrics.fetch()
+    result = metrics.values(wait=True)
+    self.assertAlmostEqual(result['weighted'], 10.0 / 4.0, places=6)
+    self.assertAlmostEqual(result['scaled'], 12.0, places=6)
+
+  def test_fetch_interval(self):
+    device = xm.xla_device()
+    metrics = DeviceMetrics(fetch_interval=4)
+    weight = torch.randn(4, 4)
+    xla_weight = weight.to(device)
+    losses = []
+    met.clear_all()
+    for step in range(8):
+      x = torch.randn(2, 4)
+      loss = (x.to(device) @ xla_weight).pow(2).mean()
+      losses.append((x @ weight).pow(2).mean().item())
+      metrics.update('loss', loss)
+      xm.mark_step()
+      metrics.step()
+      if step < 3:
+        # The values are only fetched every 4 steps.
+        self.assertEqual(metrics.values(), {})
+    result = metrics.values(wait=True)
+    self.assertAlmostEqual(result['loss'], sum(losses[4:]) / 4, places=4)
+    self.assertEqual(met.counter_value('DeviceMetricsFetches'), 2)
+    self.assertEqual(met.metric_data('CompileTime')[0], 1)
+
+  def test_empty_metric(self):
+    metrics = DeviceMetrics()
+    metrics.update('loss', torch.ones(2, device=xm.xla_device()))
+    xm.mark_step()
+    metrics.fetch()
+    metrics.fetch()
+    self.assertIsNone(metrics.values(wait=True)['loss'])
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
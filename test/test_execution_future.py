@@ -0,0 +1,74 @@
+import sys
+import threading
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import unittest
+
+
+class ExecutionFutureTest(unittest.TestCase):
+
+  def test_mark_step_future(self):
+    device = xm.xla_device()
+    t = torch.randn(64, 64, device=device)
+    t = t @ t + 1
+    xm.mark_step()
+    future = xm.last_execution_future()
+    self.assertIsNotNone(future)
+    self.assertTrue(future.graph_hash)
+    future.wait()
+    self.assertTrue(future.done())
+    self.assertIsNone(future.error())
+
+  def test_mark_step_without_execution(self):
+    xm.mark_step()
+    xm.mark_step()
+    self.assertIsNone(xm.last_execution_future())
+
+  def test_done_callback(self):
+    device = xm.xla_device()
+    t = torch.ones(32, 32, device=device) * 2
+    xm.mark_step()
+    future = xm.last_execution_future()
+    called = threading.Event()
+    done_futures = []
+
+    def callback(done_future):
+      done_futures.append(done_future)
+      called.set()
+
+    future.add_done_callback(callback)
+    self.assertTrue(called.wait(timeout=60))
+    self.assertEqual(done_futures[0].graph_hash, future.graph_hash)
+    self.assertTrue(done_futures[0].done())
+    self.assertEqual(t.cpu().sum().item(), 2 * 32 * 32)
+
+  def test_fetch_async(self):
+    device = xm.xla_device()
+    w = torch.randn(16, 16)
+    xw = w.to(device)
+    futures = []
+    losses = []
+    for _ in range(3):
+      loss = (w @ w).sum()
+      xloss = (xw @ xw).sum()
+      futures.append(xm.fetch_async(xloss))
+      losses.append(loss)
+      # The fetched value does not change with the in-place updates.
+      w.mul_(0.5)
+      xw.mul_(0.5)
+      xm.mark_step()
+    for future, loss in zip(futures, losses):
+      self.assertTrue(torch.allclose(future.result(), loss, rtol=1e-4))
+      self.assertTrue(future.done())
+
+  def test_fetch_async_host_data(self):
+    t = torch.arange(8, device=xm.xla_device())
+    t.cpu()
+    self.assertTrue(torch.equal(xm.fetch_async(t).result(), torch.arange(8)))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
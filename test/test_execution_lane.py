@@ -0,0 +1,51 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+from torch_xla.experimental import execution_lane
+import unittest
+
+
+class ExecutionLaneTest(unittest.TestCase):
+
+  def _sample_count(self, name):
+    data = met.metric_data(name)
+    return data[0] if data is not None else 0
+
+  def test_lanes(self):
+    device = xm.xla_device()
+    self.assertEqual(execution_lane.get_execution_lane(), 'default')
+    default_samples = self._sample_count('ExecutionLaneDefaultQueueDepth')
+    high_priority_samples = self._sample_count(
+        'ExecutionLaneHighPriorityQueueDepth')
+
+    t = torch.ones(4, 4, device=device) * 2
+    xm.mark_step()
+    with execution_lane.high_priority():
+      self.assertEqual(execution_lane.get_execution_lane(), 'high_priority')
+      e = t + 1
+      xm.mark_step()
+    self.assertEqual(execution_lane.get_execution_lane(), 'default')
+    t = t * 3
+    xm.mark_step()
+
+    self.assertTrue(torch.allclose(e.cpu(), torch.full((4, 4), 3.0)))
+    self.assertTrue(torch.allclose(t.cpu(), torch.full((4, 4), 6.0)))
+    self.assertEqual(
+        self._sample_count('ExecutionLaneHighPriorityQueueDepth'),
+        high_priority_samples + 1)
+    self.assertGreaterEqual(
+        self._sample_count('ExecutionLaneDefaultQueueDepth'),
+        default_samples + 2)
+    self.assertIsNotNone(met.metric_data('ExecutionLaneDefaultWaitTime'))
+
+  def test_invalid_lane(self):
+    with self.assertRaises(RuntimeError):
+      execution_lane.set_execution_lane('bulk')
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,59 @@
+import sys
+import unittest
+
+import torch
+import torch.nn.functional as F
+import torch_xla
+import torch_xla.core.functions as xf
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+
+
+class FlashAttentionTest(unittest.TestCase):
+
+  def _test_attention(self, query_length, key_length, causal, block_size):
+    device = xm.xla_device()
+    query = torch.randn(2, 3, query_length, 16, requires_grad=True)
+    key = torch.randn(2, 3, key_length, 16, requires_grad=True)
+    value = torch.randn(2, 3, key_length, 8, requires_grad=True)
+    expected = F.scaled_dot_product_attention(
+        query, key, value, is_causal=causal)
+    expected.sum().backward()
+
+    xla_inputs = [
+        t.detach().to(device).requires_grad_() for t in (query, key, value)
+    ]
+    met.clear_all()
+    output = xf.scaled_dot_product_attention(
+        *xla_inputs, is_causal=causal, block_size=block_size)
+    output.sum().backward()
+    xm.mark_step()
+
+    self.assertTrue(torch.allclose(output.cpu(), expected, atol=1e-5))
+    for xla_input, input in zip(xla_inputs, (query, key, value)):
+      self.assertTrue(
+          torch.allclose(xla_input.grad.cpu(), input.grad, atol=1e-4))
+    self.assertNotIn('aten::', met.short_metrics_report())
+
+  def test_attention(self):
+    self._test_attention(64, 64, causal=False, block_size=16)
+
+  def test_attention_causal(self):
+    self._test_attention(64, 64, causal=True, block_size=16)
+
+  def test_attention_padded_block(self):
+    self._test_attention(24, 40, causal=False, block_size=16)
+
+  def test_attention_padded_block_causal(self):
+    self._test_attention(40, 40, causal=True, block_size=16)
+
+  def test_attention_single_block(self):
+    self._test_attention(32, 20, causal=True, block_size=512)
+
+
+if __name__ == '__main__':
+  torch.manual_seed(42)
+  torch_xla._XLAC._xla_set_use_full_mat_mul_precision(
+      use_full_mat_mul_precision=True)
+  test = unittest.main(exit=False)
+  sys.exit(0 if test.result.wasSuccessful() else 1)
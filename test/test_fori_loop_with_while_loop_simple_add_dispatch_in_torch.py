@@ -1,4 +1,5 @@
 import os
+import sys
 import unittest
 from typing import Callable, Dict, List
 
@@ -82,6 +83,31 @@ class WhileLoopTest(unittest.TestCase):
     expected = _fake_while_loop(cond_fn, body_fn, (init, limit_value))
     self.assertEqual(expected, res)
 
+  def test_while_loop_captured_invariant(self):
+
+    xm.mark_step()
+    device = xm.xla_device()
+    weight = torch.randn(8, 8, device=device)
+    xm.mark_step()
+
+    def cond_fn(i, x):
+      return i[0] < 5
+
+    def body_fn(i, x):
+      one_value = torch.ones(1, dtype=torch.int32, device=device)
+      return (torch.add(i, one_value), torch.tanh(x @ weight))
+
+    i = torch.tensor([0], dtype=torch.int32, device=device)
+    x = torch.randn(2, 8, device=device)
+    res_i, res_x = while_loop(cond_fn, body_fn, (i, x))
+    expected = x.cpu()
+    for _ in range(5):
+      expected = torch.tanh(expected @ weight.cpu())
+    self.assertEqual(res_i.cpu().item(), 5)
+    self.assertTrue(torch.allclose(res_x.cpu(), expected, atol=1e-4))
+    self.assertIn('xla::while_loop',
+                  torch_xla._XLAC._get_xla_tensors_text([res_x]))
+
   def test_fori_loop_tpu_addition(self):
 
     xm.mark_step()
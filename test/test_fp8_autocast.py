@@ -0,0 +1,65 @@
+import sys
+import unittest
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+from torch_xla.amp.fp8 import DelayedScaling, fp8_autocast
+
+
+class Fp8AutocastTest(unittest.TestCase):
+
+  def _run(self, recipe, model, data):
+    with fp8_autocast(recipe):
+      output = model(data)
+    output.sum().backward()
+    xm.mark_step()
+    return output
+
+  def test_linear_matches_reference(self):
+    device = xm.xla_device()
+    torch.manual_seed(0)
+    model = torch.nn.Linear(64, 32).to(device)
+    data = torch.randn(8, 4, 64, device=device)
+    ref_output = model(data)
+    ref_output.sum().backward()
+    ref_grads = [p.grad.cpu() for p in model.parameters()]
+    model.zero_grad()
+
+    recipe = DelayedScaling(amax_history_len=4)
+    # The first step is scaled by one, the next ones by the amax history.
+    for _ in range(2):
+      model.zero_grad()
+      output = self._run(recipe, model, data)
+    self.assertEqual(output.shape, ref_output.shape)
+    torch.testing.assert_close(
+        output.cpu(), ref_output.cpu(), rtol=0.1, atol=0.1)
+    for p, ref_grad in zip(model.parameters(), ref_grads):
+      torch.testing.assert_close(p.grad.cpu(), ref_grad, rtol=0.2, atol=0.2)
+
+  def test_delayed_scaling_state(self):
+    device = xm.xla_device()
+    model = torch.nn.Linear(16, 16, bias=False).to(device)
+    data = torch.randn(4, 16, device=device) * 10
+    recipe = DelayedScaling(amax_history_len=2)
+    self._run(recipe, model, data)
+    input_state, weight_state, grad_state = recipe.states(model.weight)
+    amax = data.abs().max().cpu()
+    torch.testing.assert_close(input_state.amax_history[0].cpu(), amax)
+    torch.testing.assert_close(input_state.scale.cpu(), 448.0 / amax)
+    self.assertGreater(weight_state.scale.item(), 0)
+    self.assertGreater(grad_state.scale.item(), 0)
+
+  def test_hlo_has_fp8_dots(self):
+    device = xm.xla_device()
+    model = torch.nn.Linear(16, 16).to(device)
+    data = torch.randn(4, 16, device=device)
+    with fp8_autocast(DelayedScaling()):
+      output = model(data)
+    hlo = torch_xla._XLAC._get_xla_tensors_hlo([output])
+    self.assertIn('f8e4m3fn', hlo)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
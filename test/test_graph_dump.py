@@ -0,0 +1,51 @@
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+import torch_xla.debug.graph_dump as graph_dump
+
+
+class GraphDumpTest(unittest.TestCase):
+
+  def test_binary_dump(self):
+    save_file = os.path.join(tempfile.mkdtemp(), 'graphs')
+    # The dump file and format are read once per process.
+    env = dict(
+        os.environ,
+        XLA_SAVE_TENSORS_FILE=save_file,
+        XLA_SAVE_TENSORS_FMT='binary')
+    script = '\n'.join([
+        'import torch', 'import torch_xla.core.xla_model as xm',
+        'x = torch.ones(8, device=xm.xla_device())', 'for _ in range(2):',
+        '  x = x * 2 + 1', '  xm.mark_step()'
+    ])
+    subprocess.run([sys.executable, '-c', script], env=env, check=True)
+
+    graphs = list(graph_dump.read_graphs(save_file + '.0'))
+    self.assertEqual(len(graphs), 2)
+    graph = graphs[0]
+    self.assertEqual(graph.name, 'ScheduleSyncTensorsGraph')
+    self.assertIsNotNone(graph.hash)
+    self.assertNotEqual(graph.hash, 0)
+    ops = [node.op for node in graph.nodes]
+    self.assertIn('aten::mul', ops)
+    self.assertIn('aten::add', ops)
+    self.assertEqual(len(graph.roots), 1)
+    root = graph.nodes[graph.roots[0]]
+    self.assertEqual(root.op, 'aten::add')
+    self.assertEqual(root.shape, 'f32[8]')
+    for node_index, _ in root.operands:
+      self.assertLess(node_index, graph.roots[0])
+
+  def test_truncated_dump(self):
+    with tempfile.NamedTemporaryFile() as fd:
+      fd.write(b'PTXLAIR\0\x01\0\0\0\0\0\0\0' + b'PXIR')
+      fd.flush()
+      self.assertEqual(list(graph_dump.read_graphs(fd.name)), [])
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
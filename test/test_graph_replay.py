@@ -0,0 +1,71 @@
+import sys
+import unittest
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+from torch_xla.experimental.graph_replay import replayable
+
+
+def sgd_step(weight, bias, x, y, lr):
+  loss = ((x @ weight + bias - y)**2).mean()
+  grad_w = 2 * x.t() @ (x @ weight + bias - y) / y.numel()
+  grad_b = 2 * (x @ weight + bias - y).sum(0) / y.numel()
+  weight.sub_(lr * grad_w)
+  bias.sub_(lr * grad_b)
+  return loss
+
+
+class GraphReplayTest(unittest.TestCase):
+
+  def _run(self, step, steps=5):
+    torch.manual_seed(42)
+    device = xm.xla_device()
+    weight = torch.randn(4, 2, device=device)
+    bias = torch.zeros(2, device=device)
+    losses = []
+    for i in range(steps):
+      x = torch.randn(8, 4).to(device)
+      y = torch.randn(8, 2).to(device)
+      losses.append(step(weight, bias, x, y, 0.1))
+      xm.mark_step()
+    return [loss.cpu() for loss in losses], weight.cpu(), bias.cpu()
+
+  def test_replay_matches_tracing(self):
+    expected = self._run(sgd_step)
+    met.clear_all()
+    actual = self._run(replayable(sgd_step, warmup_steps=1))
+    # The first call is traced, the second captures and all run the replay.
+    self.assertEqual(met.counter_value('GraphReplayCapture'), 1)
+    self.assertEqual(met.counter_value('GraphReplay'), 4)
+    for e, a in zip(expected[0], actual[0]):
+      self.assertTrue(torch.allclose(e, a))
+    self.assertTrue(torch.allclose(expected[1], actual[1]))
+    self.assertTrue(torch.allclose(expected[2], actual[2]))
+
+  def test_guards_recapture_on_new_shapes(self):
+    device = xm.xla_device()
+    step = replayable(lambda a, b: a + b, warmup_steps=0)
+    met.clear_all()
+    for n in (2, 2, 3, 3):
+      a = torch.ones(n, device=device)
+      out = step(a, a)
+      self.assertTrue(torch.allclose(out.cpu(), torch.full((n,), 2.0)))
+    self.assertEqual(met.counter_value('GraphReplayCapture'), 2)
+    self.assertEqual(met.counter_value('GraphReplay'), 4)
+
+  def test_periodic_check(self):
+    device = xm.xla_device()
+    step = replayable(lambda a: a * 2, warmup_steps=0, check_interval=2)
+    met.clear_all()
+    for _ in range(4):
+      out = step(torch.ones(2, device=device))
+      self.assertTrue(torch.allclose(out.cpu(), torch.full((2,), 2.0)))
+    self.assertEqual(met.counter_value('GraphReplayCapture'), 3)
+    self.assertIsNone(met.counter_value('GraphReplayDivergence'))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
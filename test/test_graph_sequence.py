@@ -0,0 +1,55 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+from torch_xla.experimental import graph_sequence
+import unittest
+
+
+def _scale(x):
+  return x * 2 + 1
+
+
+def _combine(a, b):
+  return a @ b + a
+
+
+class GraphSequenceTest(unittest.TestCase):
+
+  def test_capture_and_replay(self):
+    device = xm.xla_device()
+    scale = torch.compile(_scale, backend='openxla')
+    combine = torch.compile(_combine, backend='openxla')
+    x = torch.randn(4, 4, device=device)
+    w = torch.randn(4, 4, device=device)
+    xm.mark_step()
+    # Traces and compiles the graphs.
+    combine(scale(x), w)
+
+    with graph_sequence.capture() as seq:
+      y = combine(scale(x), w)
+    self.assertEqual(seq.num_graphs, 2)
+    self.assertTrue(
+        torch.allclose(y.cpu(), _combine(_scale(x.cpu()), w.cpu()), atol=1e-5))
+
+    met.clear_counters()
+    x_cpu = torch.randn(4, 4)
+    x.copy_(x_cpu.to(device))
+    xm.mark_step()
+    seq.replay()
+    self.assertEqual(met.counter_value('ReplayCallSequence'), 1)
+    self.assertTrue(
+        torch.allclose(y.cpu(), _combine(_scale(x_cpu), w.cpu()), atol=1e-5))
+
+  def test_nested_capture(self):
+    with graph_sequence.capture():
+      with self.assertRaises(RuntimeError):
+        with graph_sequence.capture():
+          pass
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,61 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import torch_xla.runtime as xr
+import unittest
+
+# Run with XLA_GRAPH_SPLIT_MEMORY_FRACTION set low enough for every graph to be
+# found too large.
+
+
+def step(x, weight):
+  for _ in range(4):
+    x = torch.tanh(x @ weight) + x
+  return x.sum(), x
+
+
+@unittest.skipIf(xr.device_type() == 'CPU',
+                 'The CPU allocator does not report its stats')
+class GraphSplitTest(unittest.TestCase):
+
+  def test_split_graph_results(self):
+    device = xm.xla_device()
+    weight = torch.randn(128, 128) / 16
+    x = torch.randn(16, 128)
+    expected_loss, expected_out = step(x, weight)
+    xla_weight = weight.to(device)
+    xla_x = x.to(device)
+    xm.mark_step()
+    met.clear_all()
+    for i in range(3):
+      loss, out = step(xla_x, xla_weight)
+      xm.mark_step()
+      self.assertTrue(torch.allclose(loss.cpu(), expected_loss, rtol=1e-3))
+      self.assertTrue(
+          torch.allclose(out.cpu(), expected_out, rtol=1e-3, atol=1e-4))
+    self.assertGreater(met.counter_value('GraphSplits'), 0)
+    # The split is only decided once per graph.
+    splits = met.counter_value('GraphSplits')
+    loss, out = step(xla_x, xla_weight)
+    xm.mark_step()
+    self.assertEqual(met.counter_value('GraphSplits'), splits)
+    self.assertGreater(met.counter_value('GraphSplitSyncs'), splits)
+
+  def test_split_graph_updates_inputs(self):
+    device = xm.xla_device()
+    a = torch.randn(64, 64, device=device)
+    expected = a.cpu()
+    xm.mark_step()
+    for _ in range(3):
+      a.mul_(2).add_(1).tanh_()
+      expected = torch.tanh(expected * 2 + 1)
+      xm.mark_step()
+    self.assertTrue(torch.allclose(a.cpu(), expected, rtol=1e-4))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,43 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class GraphStatsTest(unittest.TestCase):
+
+  def test_graph_stats(self):
+    met.clear_graph_stats()
+    device = xm.xla_device()
+    x = torch.randn(64, 64, device=device)
+    xm.mark_step()
+    for _ in range(3):
+      x = x @ x + 1
+      xm.mark_step()
+    future = xm.last_execution_future()
+    self.assertIsNotNone(future)
+    future.wait()
+
+    stats = met.graph_stats()
+    self.assertIn(future.graph_hash, stats)
+    graph_stats = stats[future.graph_hash]
+    self.assertEqual(graph_stats['compiles'], 1)
+    self.assertGreater(graph_stats['compile_ns'], 0)
+    self.assertEqual(graph_stats['executions'], 3)
+    self.assertEqual(graph_stats['failed_executions'], 0)
+    self.assertGreaterEqual(graph_stats['max_execute_ns'],
+                            graph_stats['avg_execute_ns'])
+    self.assertEqual(graph_stats['argument_bytes'], x.numel() * 4)
+    self.assertEqual(graph_stats['output_bytes'], x.numel() * 4)
+    self.assertEqual(graph_stats['collective_bytes'], 0)
+
+    met.clear_graph_stats()
+    self.assertEqual(met.graph_stats(), {})
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,64 @@
+import sys
+import unittest
+
+import torch
+import torch_xla
+import torch_xla.core.functions as xf
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+
+
+def _reference_grouped_matmul(lhs, rhs, group_sizes):
+  output = torch.zeros(lhs.size(0), rhs.size(2))
+  start = 0
+  for group, size in enumerate(group_sizes.tolist()):
+    output[start:start + size] = lhs[start:start + size] @ rhs[group]
+    start += size
+  return output
+
+
+class GroupedMatmulTest(unittest.TestCase):
+
+  def _test_grouped_matmul(self, rows, sizes, tile_rows):
+    device = xm.xla_device()
+    group_sizes = torch.tensor(sizes, dtype=torch.int32)
+    lhs = torch.randn(rows, 16, requires_grad=True)
+    rhs = torch.randn(len(sizes), 16, 8, requires_grad=True)
+    expected = _reference_grouped_matmul(lhs, rhs, group_sizes)
+    expected.sum().backward()
+
+    xla_lhs = lhs.detach().to(device).requires_grad_()
+    xla_rhs = rhs.detach().to(device).requires_grad_()
+    met.clear_all()
+    output = xf.grouped_matmul(
+        xla_lhs, xla_rhs, group_sizes.to(device), tile_rows=tile_rows)
+    output.sum().backward()
+    xm.mark_step()
+
+    self.assertTrue(torch.allclose(output.cpu(), expected, atol=1e-5))
+    self.assertTrue(torch.allclose(xla_lhs.grad.cpu(), lhs.grad, atol=1e-4))
+    self.assertTrue(torch.allclose(xla_rhs.grad.cpu(), rhs.grad, atol=1e-4))
+    self.assertNotIn('aten::', met.short_metrics_report())
+
+  def test_grouped_matmul(self):
+    self._test_grouped_matmul(32, [8, 8, 16], tile_rows=8)
+
+  def test_grouped_matmul_groups_across_tiles(self):
+    self._test_grouped_matmul(40, [5, 13, 3, 19], tile_rows=8)
+
+  def test_grouped_matmul_empty_groups(self):
+    self._test_grouped_matmul(24, [0, 10, 0, 14, 0], tile_rows=8)
+
+  def test_grouped_matmul_padded_tile(self):
+    self._test_grouped_matmul(21, [7, 14], tile_rows=16)
+
+  def test_grouped_matmul_unassigned_rows(self):
+    self._test_grouped_matmul(32, [6, 10], tile_rows=8)
+
+
+if __name__ == '__main__':
+  torch.manual_seed(42)
+  torch_xla._XLAC._xla_set_use_full_mat_mul_precision(
+      use_full_mat_mul_precision=True)
+  test = unittest.main(exit=False)
+  sys.exit(0 if test.result.wasSuccessful() else 1)
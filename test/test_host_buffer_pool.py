@@ -0,0 +1,49 @@
+import os
+import sys
+
+# The staging pool is created with the runtime client, so configure it before
+# importing torch_xla.
+os.environ['XLA_HOST_BUFFER_POOL_BYTES'] = str(64 * 1024 * 1024)
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class HostBufferPoolTest(unittest.TestCase):
+
+  def test_transfers_reuse_staging_buffers(self):
+    device = xm.xla_device()
+    t = torch.randn(64, 64)
+    # Warm up the pool with a round trip in each direction.
+    xt = t.to(device)
+    self.assertTrue(torch.allclose(xt.cpu(), t))
+
+    met.clear_all()
+    for _ in range(3):
+      xt = t.to(device)
+      self.assertTrue(torch.allclose(xt.cpu(), t))
+    self.assertEqual(met.counter_value('AtenSourceStaged'), 3)
+    # Fetching the results goes straight into the output tensors, so only the
+    # uploads are staged.
+    self.assertGreaterEqual(met.counter_value('HostBufferPoolHit'), 3)
+    self.assertIsNone(met.counter_value('HostBufferPoolFallbackAllocation'))
+
+  def test_non_contiguous_tensor(self):
+    t = torch.randn(32, 16).t()
+    xt = t.to(xm.xla_device())
+    self.assertTrue(torch.allclose(xt.cpu(), t))
+
+
+  def test_channels_last_tensor(self):
+    met.clear_all()
+    t = torch.randn(2, 3, 4, 5, 6).to(memory_format=torch.channels_last_3d)
+    xt = t.to(xm.xla_device())
+    self.assertEqual(met.counter_value('AtenSourceChannelsLast'), 1)
+    self.assertTrue(torch.allclose(xt.cpu(), t))
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,34 @@
+import os
+import sys
+
+# The bound is read when the runtime client is created, so configure it before
+# importing torch_xla.
+os.environ['XLA_MAX_INFLIGHT_DEVICE_OPERATIONS'] = '2'
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import unittest
+
+
+class InflightOperationsTest(unittest.TestCase):
+
+  def test_operations_are_bounded(self):
+    device = xm.xla_device()
+    tensors = [torch.randn(128, 128) for _ in range(16)]
+    xtensors = [t.to(device) for t in tensors]
+    total = sum(xtensors)
+    xm.mark_step()
+    self.assertTrue(torch.allclose(total.cpu(), sum(tensors), atol=1e-4))
+    xm.wait_device_ops()
+
+    stats = xm.get_operation_stats(device)
+    self.assertEqual(stats['inflight'], 0)
+    self.assertGreaterEqual(stats['high_water_mark'], 1)
+    self.assertLessEqual(stats['high_water_mark'], 2)
+    self.assertEqual(stats['rejected'], 0)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
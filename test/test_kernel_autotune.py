@@ -0,0 +1,72 @@
+import json
+import os
+import sys
+import tempfile
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+from torch_xla.experimental import kernel_autotune
+import unittest
+
+
+def _matmul_chain(x, repeats):
+  for _ in range(repeats):
+    x = x @ x
+    x = x / x.norm()
+  return x
+
+
+class KernelAutotuneTest(unittest.TestCase):
+
+  def test_tune_and_persist(self):
+    device = xm.xla_device()
+    x = torch.randn(256, 256, device=device)
+    configs = [64, 1]
+    calls = []
+
+    def run(config):
+      calls.append(config)
+      return _matmul_chain(x, config)
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+      path = os.path.join(tmpdir, 'autotune.json')
+      tuner = kernel_autotune.KernelAutotuner(path)
+      key = kernel_autotune.shape_key(x)
+      self.assertEqual(tuner.tune('chain', key, configs, run, iterations=2), 1)
+      self.assertEqual(len(calls), 6)
+      with open(path) as f:
+        self.assertEqual(json.load(f), {'chain': {key: 1}})
+
+      reloaded = kernel_autotune.KernelAutotuner(path)
+      self.assertEqual(reloaded.get('chain', key), 1)
+      self.assertEqual(reloaded.tune('chain', key, configs, run), 1)
+      self.assertEqual(len(calls), 6)
+
+  def test_autotune_decorator(self):
+    device = xm.xla_device()
+
+    configs = [32, 2]
+
+    @kernel_autotune.autotune('decorated_chain', configs=configs)
+    def chain(x, config):
+      return _matmul_chain(x, config)
+
+    x = torch.randn(128, 128, device=device)
+    output = chain(x)
+    tuner = kernel_autotune.get_autotuner()
+    index = tuner.get('decorated_chain', kernel_autotune.shape_key(x))
+    self.assertIsNotNone(index)
+    expected = _matmul_chain(x.cpu(), configs[index])
+    self.assertTrue(torch.allclose(output.cpu(), expected, atol=1e-3))
+
+  def test_shape_key(self):
+    x = torch.zeros(2, 3, dtype=torch.bfloat16)
+    self.assertEqual(
+        kernel_autotune.shape_key(x, 4, causal=True),
+        'torch.bfloat16[2, 3],4,causal=True')
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
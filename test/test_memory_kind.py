@@ -0,0 +1,43 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class MemoryKindTest(unittest.TestCase):
+
+  def test_set_memory_kind(self):
+    device = xm.xla_device()
+    state = torch.randn(128, 128)
+    xstate = state.to(device)
+    xm.mark_step()
+    self.assertEqual(xm.get_memory_kind(xstate), 'device')
+
+    xm.set_memory_kind([xstate], 'pinned_host')
+    kind = xm.get_memory_kind(xstate)
+    self.assertIn(kind, ('device', 'pinned_host'))
+    if kind == 'device':
+      self.assertGreater(met.counter_value('MemoryKindFallback'), 0)
+
+    # The graphs using the state read it from where it is placed.
+    result = xstate * 2
+    xm.mark_step()
+    self.assertTrue(torch.allclose(result.cpu(), state * 2))
+
+    xm.set_memory_kind([xstate], 'device')
+    self.assertEqual(xm.get_memory_kind(xstate), 'device')
+    self.assertTrue(torch.allclose(xstate.cpu(), state))
+
+  def test_invalid_memory_kind(self):
+    xstate = torch.zeros(4, device=xm.xla_device())
+    xm.mark_step()
+    with self.assertRaises(RuntimeError):
+      xm.set_memory_kind([xstate], 'disk')
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
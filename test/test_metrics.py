@@ -7,6 +7,7 @@ import torch_xla.runtime as xr
 import torch_xla.core.xla_model as xm
 import torch_xla.debug.metrics as met
 import unittest
+import urllib.request
 
 
 def XLAExperimentalContains(feat):
@@ -163,6 +164,8 @@ class MetricsTest(unittest.TestCase):
     self.assertNotEqual(met.metric_data("WrapXlaData"), None)
     self.assertIn("DeviceLockWait", metric_names)
     self.assertNotEqual(met.metric_data("DeviceLockWait"), None)
+    self.assertIn("CollectSyncTensorsTime", metric_names)
+    self.assertNotEqual(met.metric_data("CollectSyncTensorsTime"), None)
 
     met.clear_metrics()
     self.assertNotIn("InputOutputAliasCount", met.metric_names())
@@ -198,6 +201,24 @@ class MetricsTest(unittest.TestCase):
     # of `ExecuteComputation`, but the actual async time.
     self.assertGreater(execute_time_ns, .5 * wall_time_ns)
 
+  def test_open_metrics_server(self):
+    met.clear_all()
+    xla_device = xm.xla_device()
+    t1 = torch.tensor(100, device=xla_device)
+    t2 = t1 * 2
+    xm.mark_step()
+    server = met.start_server(9013)
+    with urllib.request.urlopen('http://localhost:9013/metrics') as response:
+      self.assertIn('application/openmetrics-text',
+                    response.headers['Content-Type'])
+      report = response.read().decode()
+    self.assertTrue(report.endswith('# EOF\n'))
+    self.assertIn('# TYPE ptxla_CreateXlaTensor counter', report)
+    self.assertIn('# TYPE ptxla_ExecuteTime histogram', report)
+    self.assertRegex(report, r'ptxla_ExecuteTime_bucket\{le="\+Inf"\} [1-9]')
+    self.assertIn('# TYPE ptxla_ExecuteTime_recent summary', report)
+    del server
+
   def test_pybind_increment_counter(self):
     met.clear_all()
     xla_device = xm.xla_device()
@@ -259,6 +280,17 @@ class MetricsTest(unittest.TestCase):
       self.assertEqual(
           set(ops), {"aten::nonzero", "aten::median", "torchvision::nms"})
 
+  def test_fallback_cost(self):
+    met.clear_all()
+    x = torch.rand(10, device=xm.xla_device())
+    # The item() of pending IR executes it, then copies the scalar to the CPU.
+    (x + 1)[0].item()
+    op = 'aten::_local_scalar_dense'
+    self.assertEqual(met.metric_data(f'CpuFallbackTime.{op}')[0], 1)
+    self.assertEqual(met.metric_data(f'CpuFallbackToHostBytes.{op}')[1], 4)
+    self.assertEqual(met.metric_data(f'CpuFallbackToDeviceBytes.{op}')[1], 0)
+    self.assertEqual(met.counter_value(f'CpuFallbackGraphBreaks.{op}'), 1)
+
 
 if __name__ == '__main__':
   test = unittest.main()
@@ -139,6 +139,18 @@ class TestMpSyncBatchNorm(parameterized.TestCase):
     xm.rendezvous('sync_bn3d_test')
     xm.master_print('sync_bn3d_test ok')
 
+  @staticmethod
+  def _sync_bn_single_all_reduce(rank):
+    device = xm.xla_device()
+    sbn_xla = xf.SyncBatchNorm(16).to(device)
+    result = sbn_xla(torch.rand((8, 16, 4, 4), device=device))
+    ir = torch_xla._XLAC._get_xla_tensors_text([result])
+    # The statistics of a layer are reduced across the replicas at once.
+    assert ir.count('xla::cross_replica_sum') == 1, ir
+
+    xm.rendezvous('sync_bn_single_all_reduce_test')
+    xm.master_print('sync_bn_single_all_reduce_test ok')
+
   def test_sync_bn1d_no_channel(self):
     xmp.spawn(self._sync_bn1d_no_channel, args=())
 
@@ -151,6 +163,9 @@ class TestMpSyncBatchNorm(parameterized.TestCase):
   def test_sync_bn3d(self):
     xmp.spawn(self._sync_bn3d, args=())
 
+  def test_sync_bn_single_all_reduce(self):
+    xmp.spawn(self._sync_bn_single_all_reduce, args=())
+
 
 if __name__ == '__main__':
   absltest.main()
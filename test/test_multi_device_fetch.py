@@ -0,0 +1,43 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import unittest
+
+
+class MultiDeviceFetchTest(unittest.TestCase):
+
+  def setUp(self):
+    self.devices = xm.get_xla_supported_devices()
+    if len(self.devices) < 2:
+      self.skipTest('Needs several local devices')
+
+  def test_fetch_across_devices(self):
+    expected = []
+    xla_tensors = []
+    for i, device in enumerate(self.devices):
+      for dtype in (torch.float32, torch.bfloat16, torch.int64):
+        tensor = (torch.arange(64, dtype=torch.float32) * (i + 1)).to(dtype)
+        expected.append(tensor + 1)
+        xla_tensors.append(tensor.to(device) + 1)
+    xm.mark_step()
+    cpu_tensors = torch_xla._XLAC._xla_get_cpu_tensors(xla_tensors)
+    self.assertEqual(len(cpu_tensors), len(expected))
+    for cpu_tensor, tensor in zip(cpu_tensors, expected):
+      torch.testing.assert_close(cpu_tensor, tensor)
+
+  def test_fetch_pending_across_devices(self):
+    # The tensors are fetched while their computations still run.
+    xla_tensors = [
+        torch.full((128, 128), float(i), device=device) @ torch.ones(
+            128, 128, device=device) for i, device in enumerate(self.devices)
+    ]
+    cpu_tensors = torch_xla._XLAC._xla_get_cpu_tensors(xla_tensors)
+    for i, cpu_tensor in enumerate(cpu_tensors):
+      torch.testing.assert_close(cpu_tensor, torch.full((128, 128), i * 128.0))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
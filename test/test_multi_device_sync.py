@@ -0,0 +1,44 @@
+import os
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import torch_xla.runtime as xr
+import unittest
+
+
+class MultiDeviceSyncTest(unittest.TestCase):
+
+  @classmethod
+  def setUpClass(cls):
+    xr.set_device_type('CPU')
+    os.environ['CPU_NUM_DEVICES'] = '2'
+
+  def test_sync_across_devices(self):
+    dev0, dev1 = xm.xla_device(0), xm.xla_device(1)
+    a = torch.arange(4, dtype=torch.float32, device=dev0) * 2
+    b = torch.arange(4, dtype=torch.float32, device=dev1) + 3
+    met.clear_counters()
+    torch_xla._XLAC._xla_sync_multi([a, b], devices=[])
+    self.assertEqual(met.counter_value('MultiDeviceSyncTensorsGraph'), 1)
+    self.assertEqual(a.cpu().tolist(), [0, 2, 4, 6])
+    self.assertEqual(b.cpu().tolist(), [3, 4, 5, 6])
+
+  def test_fetch_across_devices(self):
+    dev0, dev1 = xm.xla_device(0), xm.xla_device(1)
+    a = torch.ones(3, device=dev0) * 5
+    b = torch.ones(3, device=dev1) - 4
+    c = a + 1
+    met.clear_counters()
+    cpu_a, cpu_b, cpu_c = torch_xla._XLAC._xla_get_cpu_tensors([a, b, c])
+    self.assertEqual(met.counter_value('MultiDeviceSyncTensorsGraph'), 1)
+    self.assertEqual(cpu_a.tolist(), [5, 5, 5])
+    self.assertEqual(cpu_b.tolist(), [-3, -3, -3])
+    self.assertEqual(cpu_c.tolist(), [6, 6, 6])
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,66 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+# Run with XLA_NARROW_INDICES=checked.
+
+
+class NarrowIndicesTest(unittest.TestCase):
+
+  def _check(self, fn, *inputs):
+    device = xm.xla_device()
+    expected = fn(*inputs)
+    result = fn(*[x.to(device) for x in inputs])
+    self.assertEqual(result.dtype, expected.dtype)
+    torch.testing.assert_close(result.cpu(), expected)
+
+  def test_index_select_hlo(self):
+    device = xm.xla_device()
+    x = torch.randn(16, 8, device=device)
+    index = torch.tensor([3, 1, 15], device=device)
+    result = torch.index_select(x, 0, index)
+    hlo = torch_xla._XLAC._get_xla_tensors_hlo([result])
+    self.assertIn('s32[3]', hlo)
+
+  def test_gathers(self):
+    x = torch.randn(10, 12)
+    index = torch.randint(0, 10, (5, 12))
+    self._check(lambda t, i: torch.gather(t, 0, i), x, index)
+    self._check(lambda t, i: torch.index_select(t, 1, i[0]), x, index)
+    self._check(lambda t, i: t[i[:, 0]], x, index)
+
+  def test_scatters(self):
+    x = torch.zeros(10, 12)
+    index = torch.randint(0, 10, (5, 12))
+    src = torch.randn(5, 12)
+    self._check(lambda t, i, s: t.scatter_add(0, i, s), x, index, src)
+    self._check(lambda t, i, s: t.index_put((i[:, 0],), s, accumulate=True),
+                x, index, src)
+
+  def test_embedding(self):
+    weight = torch.randn(100, 16)
+    index = torch.randint(0, 100, (4, 7))
+    self._check(torch.nn.functional.embedding, index, weight)
+
+  def test_argmax(self):
+    x = torch.randn(6, 50)
+    self._check(lambda t: torch.argmax(t, dim=1), x)
+    self._check(lambda t: torch.argmin(t, dim=0, keepdim=True), x)
+    self._check(lambda t: torch.argmax(t), x)
+
+  def test_counter(self):
+    met.clear_all()
+    device = xm.xla_device()
+    x = torch.randn(8, 4, device=device)
+    index = torch.tensor([0, 7], device=device)
+    torch.index_select(x, 0, index).cpu()
+    self.assertGreater(met.counter_value('NarrowedIndices'), 0)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -230,6 +230,22 @@ class TestParallelLoader(test_utils.XlaTestCase):
         self.assertEqual(data.device, device)
         self.assertEqual(target.device, device)
 
+  def test_native_transfer(self):
+    device = xm.xla_device()
+    A = 3.11
+    B = 4.09
+    gen = xu.FnDataGenerator(
+        lambda x: x * A + B, 128, _gen_tensor, dims=[8], count=10)
+    para_loader = pl.ParallelLoader(
+        gen, [device], device_prefetch_size=2, native_transfer=True)
+    batches = 0
+    for data, target in para_loader.per_device_loader(device):
+      self.assertEqual(data.device, device)
+      self.assertEqual(target.device, device)
+      self.assertEqual(target.cpu(), data.cpu() * A + B)
+      batches += 1
+    self.assertEqual(batches, 10)
+
 
 class TestAtenTensorTo(test_utils.XlaTestCase):
 
@@ -438,6 +454,28 @@ class TestDynamicShape(test_utils.XlaTestCase):
     t2 = torch.nonzero(t1.int()).float()
     xm.mark_step()
 
+  def test_nonzero_static(self):
+    x = torch.tensor([[0, 1, 2], [0, 3, 0]])
+    expected = torch.nonzero_static(x, size=4)
+    xla_x = x.to(xm.xla_device())
+    met.clear_all()
+    indices = torch.nonzero_static(xla_x, size=4)
+    self.assertEqual(indices.cpu(), expected)
+    self.assertNotIn('aten::', met.short_metrics_report())
+    indices, count = xm.nonzero_static(xla_x, size=2, fill_value=7)
+    self.assertEqual(indices.cpu(), torch.tensor([[0, 1], [0, 2]]))
+    self.assertEqual(count.item(), 3)
+
+  def test_masked_select_static(self):
+    x = torch.tensor((0., 1., 2., 0., 3., 4.), device=xm.xla_device())
+    values, count = xm.masked_select_static(x, x.ge(2), fill_value=-1)
+    self.assertEqual(values.cpu(),
+                     torch.tensor((2., 3., 4., -1., -1., -1.)))
+    self.assertEqual(count.item(), 3)
+    values, count = xm.masked_select_static(x, x.ge(2), size=2)
+    self.assertEqual(values.cpu(), torch.tensor((2., 3.)))
+    self.assertEqual(count.item(), 3)
+
 
 class TestOptimizationBarrier(test_utils.XlaTestCase):
 
@@ -1010,6 +1048,19 @@ class TestAtenXlaTensor(test_utils.XlaTestCase):
     b = torch.ones([2, 2])
     self.runAtenTest((a, b), func)
 
+  def test_batched_tensor_uploads(self):
+    model = torch.nn.Sequential(*[torch.nn.Linear(300, 300) for _ in range(4)])
+    x = torch.randn(8, 300)
+    expected = model(x)
+    met.clear_all()
+    xla_model = model.to(xm.xla_device())
+    xla_x = x.to(xm.xla_device())
+    # The first use uploads the parameters and the input together.
+    out = xla_model(xla_x)
+    self.assertEqual(met.counter_value('BatchedTensorUploads'), 1)
+    self.assertEqual(met.counter_value('BatchedTensorUploadTensors'), 9)
+    self.assertEqual(out.cpu(), expected, prec=1e-4)
+
   # TODO - upstream behavior has changed and results in expected DestroyXlaTensor
   # counter as of 11/13/2023. Re-enable after reviewing the change.
   # @skipIfFunctionalizationDisabled("metrics differ")
@@ -2258,6 +2309,54 @@ class TestWaitDeviceOps(test_utils.XlaTestCase):
                     "ExecuteChainedTime" in met.metric_names())
 
 
+class TestCpuServing(test_utils.XlaTestCase):
+
+  @unittest.skipIf(xr.device_type() != 'CPU', 'PJRT_DEVICE=CPU required')
+  def test_cpu_zero_copy_transfer(self):
+    met.clear_all()
+    cpu_tensor = torch.randn(64, 64)
+    xla_tensor = cpu_tensor.to(xm.xla_device())
+    # The device buffer aliases the private copy of the source, so updating
+    # the host tensor leaves it unchanged.
+    cpu_tensor.add_(1)
+    self.assertGreater(met.counter_value('CpuZeroCopyTransfers'), 0)
+    self.assertTrue(torch.allclose(xla_tensor.cpu() + 1, cpu_tensor))
+
+  @unittest.skipIf(xr.device_type() != 'CPU', 'PJRT_DEVICE=CPU required')
+  def test_cpu_intra_op_threads(self):
+    device = xm.xla_device()
+    x = torch.randn(32, 32, device=device)
+    xm.mark_step()
+    try:
+      met.clear_all()
+      for threads in [0, 2, 0]:
+        torch_xla._XLAC._xla_set_intra_op_threads(threads)
+        _ = (x @ x).sum().cpu()
+      # The thread count is part of the graph hash.
+      self.assertEqual(met.metric_data('CompileTime')[0], 2)
+    finally:
+      torch_xla._XLAC._xla_set_intra_op_threads(0)
+
+
+class TestTenants(test_utils.XlaTestCase):
+
+  def test_tenant_memory_budget(self):
+    device = xm.xla_device()
+    xr.set_tenant_memory_budget('budgeted', bytes=64 * 1024)
+    try:
+      with xr.tenant('budgeted'):
+        t = torch.ones(1024).to(device)
+        self.assertGreaterEqual(
+            xr.tenant_memory_usage()['budgeted']['bytes_used'], 4096)
+        with self.assertRaises(RuntimeError):
+          torch.ones(64 * 1024).to(device)
+      self.assertGreater(met.counter_value('TenantBudgetExceeded_budgeted'), 0)
+      # Untracked outside of the context.
+      _ = torch.ones(64 * 1024).to(device)
+    finally:
+      xr.set_tenant_memory_budget('budgeted', bytes=None)
+
+
 class TestDebuggingUtil(test_utils.XlaTestCase):
 
   def test_get_xla_tensor_debug_info(self):
@@ -2782,6 +2881,18 @@ class TestDLPack(parameterized.TestCase):
     cuda_t1[0] = cuda_t1[0] + 20
     self.assertTrue(torch.allclose(xla_t1.cpu(), cuda_t1.cpu()))
 
+  @onlyIfTorchSupportsCUDA
+  @onlyIfPJRTDeviceIsCUDA
+  def test_dlpack_xla_to_pytorch_cuda_stream_ordered(self):
+    met.clear_all()
+    xla_t1 = torch.arange(5).to(xm.xla_device()) * 2
+    xm.mark_step()
+    # The consumer passes its current stream to __dlpack__.
+    cuda_t1 = torch.utils.dlpack.from_dlpack(xdlpack.DLPackExporter(xla_t1))
+    self.assertEqual(cuda_t1.device.type, 'cuda')
+    self.assertEqual(met.counter_value('DLPackStreamOrderedExport'), 1)
+    self.assertTrue(torch.allclose(xla_t1.cpu(), cuda_t1.cpu()))
+
   @onlyIfTorchSupportsCUDA
   @onlyIfPJRTDeviceIsCUDA
   def test_dlpack_non_default_layout(self):
@@ -2957,6 +3068,331 @@ class TestNMS(test_utils.XlaTestCase):
     self.runAtenTest((boxes, scores), fn)
 
 
+class TestBatchedNMS(test_utils.XlaTestCase):
+
+  def _create_boxes(self, *sizes):
+    boxes = torch.rand(*sizes, 4) * 100
+    boxes[..., 2:] += boxes[..., :2]
+    return boxes, torch.rand(*sizes)
+
+  def test_batched_nms(self):
+    import torchvision
+    boxes, scores = self._create_boxes(2, 3, 50)
+    device = xm.xla_device()
+    met.clear_all()
+    indices, counts = xm.batched_nms(
+        boxes.to(device), scores.to(device), 0.3, max_output_size=40)
+    self.assertEqual(indices.shape, (2, 3, 40))
+    indices, counts = indices.cpu(), counts.cpu()
+    self.assertNotIn('aten::', met.short_metrics_report())
+    for i in range(2):
+      for j in range(3):
+        keep = torchvision.ops.nms(boxes[i, j], scores[i, j], 0.3)[:40]
+        self.assertEqual(counts[i, j].item(), keep.numel())
+        self.assertEqual(indices[i, j, :keep.numel()], keep)
+        self.assertTrue(torch.all(indices[i, j, keep.numel():] == -1))
+
+  def test_batched_nms_score_threshold(self):
+    import torchvision
+    boxes, scores = self._create_boxes(4, 30)
+    device = xm.xla_device()
+    indices, counts = xm.batched_nms(
+        boxes.to(device), scores.to(device), 0.5, score_threshold=0.5)
+    self.assertEqual(indices.shape, (4, 30))
+    for i in range(4):
+      selected = torch.nonzero(scores[i] > 0.5).flatten()
+      keep = selected[torchvision.ops.nms(boxes[i][selected],
+                                          scores[i][selected], 0.5)]
+      self.assertEqual(counts[i].item(), keep.numel())
+      self.assertEqual(indices[i, :keep.numel()].cpu(), keep)
+
+
+class TestChunkedCrossEntropy(test_utils.XlaTestCase):
+
+  def _test_cross_entropy(self, reduction, num_classes=1000, chunk_size=256):
+    logits = torch.randn(3, 7, num_classes)
+    target = torch.randint(0, num_classes, (3, 7))
+    target[0, 2] = target[2, 5] = -100
+    device = xm.xla_device()
+    xla_logits = logits.to(device).requires_grad_()
+    loss = xf.cross_entropy(
+        xla_logits,
+        target.to(device),
+        reduction=reduction,
+        chunk_size=chunk_size)
+    loss.sum().backward()
+    logits.requires_grad_()
+    expected = F.cross_entropy(
+        logits.view(-1, num_classes), target.view(-1),
+        reduction=reduction).view(loss.shape)
+    expected.sum().backward()
+    self.assertEqual(loss, expected, prec=1e-4)
+    self.assertEqual(xla_logits.grad, logits.grad, prec=1e-5)
+
+  def test_cross_entropy_mean(self):
+    self._test_cross_entropy('mean')
+
+  def test_cross_entropy_sum(self):
+    self._test_cross_entropy('sum')
+
+  def test_cross_entropy_none(self):
+    self._test_cross_entropy('none')
+
+  def test_cross_entropy_single_chunk(self):
+    self._test_cross_entropy('mean', num_classes=100, chunk_size=8192)
+
+
+class TestDropoutAddLayerNorm(test_utils.XlaTestCase):
+
+  def _make_inputs(self, device):
+    input = (torch.rand(4, 6, 32) + 0.5).to(device).requires_grad_()
+    residual = torch.randn(4, 6, 32).to(device).requires_grad_()
+    weight = torch.randn(32).to(device).requires_grad_()
+    bias = torch.randn(32).to(device).requires_grad_()
+    return input, residual, weight, bias
+
+  def test_no_dropout_matches_layer_norm(self):
+    device = xm.xla_device()
+    inputs = self._make_inputs(device)
+    output, sum = xf.dropout_add_layer_norm(*inputs, p=0.0)
+    (output * output).sum().backward()
+    grads = [t.grad for t in inputs]
+    cpu_inputs = [t.detach().cpu().requires_grad_() for t in inputs]
+    input, residual, weight, bias = cpu_inputs
+    expected = F.layer_norm(input + residual, (32,), weight, bias)
+    (expected * expected).sum().backward()
+    self.assertEqual(output, expected, prec=1e-4)
+    self.assertEqual(sum, input + residual, prec=1e-5)
+    for grad, t in zip(grads, cpu_inputs):
+      self.assertEqual(grad, t.grad, prec=1e-3)
+
+  def _test_dropout_mask(self, recompute_mask):
+    device = xm.xla_device()
+    input, residual, weight, bias = self._make_inputs(device)
+    output, sum = xf.dropout_add_layer_norm(
+        input, residual, weight, bias, p=0.5, recompute_mask=recompute_mask)
+    (output.sum() + sum.sum()).backward()
+    # The forward mask, scaled by 1 / (1 - p), recovered from the sum.
+    mask = ((sum - residual) / input).detach()
+    self.assertTrue(torch.all((mask == 0) | (torch.abs(mask - 2) < 1e-4)))
+    self.assertEqual(input.grad, residual.grad * mask, prec=1e-5)
+
+  def test_recomputed_mask(self):
+    self._test_dropout_mask(recompute_mask=True)
+
+  def test_saved_mask(self):
+    self._test_dropout_mask(recompute_mask=False)
+
+
+class TestMaskedScaledSoftmax(test_utils.XlaTestCase):
+
+  def _test_softmax(self, mask, is_causal):
+    device = xm.xla_device()
+    scale = 0.125
+    input = torch.randn(2, 3, 8, 8, requires_grad=True)
+    xinput = input.detach().to(device).requires_grad_()
+    xmask = mask.to(device) if mask is not None else None
+    output = xf.masked_scaled_softmax(
+        xinput, mask=xmask, scale=scale, is_causal=is_causal)
+    scores = input * scale
+    if mask is not None:
+      scores = scores.masked_fill(
+          ~mask, float('-inf')) if mask.dtype == torch.bool else scores + mask
+    if is_causal:
+      causal_mask = torch.ones(8, 8, dtype=torch.bool).tril()
+      scores = scores.masked_fill(~causal_mask, float('-inf'))
+    expected = F.softmax(scores, dim=-1)
+    grad = torch.randn_like(expected)
+    expected.backward(grad)
+    output.backward(grad.to(device))
+    self.assertEqual(output, expected, prec=1e-5)
+    self.assertEqual(xinput.grad, input.grad, prec=1e-5)
+
+  def test_scaled(self):
+    self._test_softmax(None, is_causal=False)
+
+  def test_boolean_mask(self):
+    mask = torch.rand(3, 1, 8) > 0.3
+    mask[..., 0] = True
+    self._test_softmax(mask, is_causal=False)
+
+  def test_additive_mask(self):
+    self._test_softmax(torch.randn(8, 8), is_causal=False)
+
+  def test_causal(self):
+    self._test_softmax(None, is_causal=True)
+
+  def test_causal_with_additive_mask(self):
+    self._test_softmax(torch.randn(2, 1, 1, 8), is_causal=True)
+
+
+class TestApproxTopK(test_utils.XlaTestCase):
+
+  def _test_exact(self, shape, k, dim, largest):
+    x = torch.randn(*shape)
+    values, indices = xf.approx_topk(
+        x.to(xm.xla_device()), k, dim=dim, largest=largest, recall_target=1.0)
+    expected_values, _ = torch.topk(x, k, dim=dim, largest=largest)
+    self.assertEqual(values, expected_values)
+    self.assertEqual(torch.gather(x, dim, indices.cpu()), expected_values)
+
+  def test_exact_chunked(self):
+    self._test_exact((4, 20000), 8, -1, largest=True)
+
+  def test_exact_chunked_smallest(self):
+    self._test_exact((5000, 3), 4, 0, largest=False)
+
+  def test_exact_small_dimension(self):
+    self._test_exact((4, 100), 5, 1, largest=True)
+
+  def test_exact_ties(self):
+    x = torch.zeros(2, 10000)
+    x[:, 5000:] = 1
+    values, indices = xf.approx_topk(
+        x.to(xm.xla_device()), 3, recall_target=1.0)
+    self.assertEqual(values.cpu(), torch.ones(2, 3))
+    self.assertEqual(indices.cpu(), torch.tensor([[5000, 5001, 5002]] * 2))
+
+  def test_approximate(self):
+    x = torch.randn(4, 20000)
+    values, indices = xf.approx_topk(
+        x.to(xm.xla_device()), 16, recall_target=0.9)
+    values, indices = values.cpu(), indices.cpu()
+    self.assertEqual(values.shape, (4, 16))
+    self.assertEqual(torch.gather(x, 1, indices), values)
+    _, expected_indices = torch.topk(x, 16)
+    for row, expected_row in zip(indices.tolist(), expected_indices.tolist()):
+      self.assertGreaterEqual(len(set(row) & set(expected_row)), 8)
+
+
+class TestSampleTokens(test_utils.XlaTestCase):
+
+  def test_greedy(self):
+    logits = torch.randn(4, 1000)
+    tokens = xf.sample_tokens(logits.to(xm.xla_device()), temperature=0.0)
+    self.assertEqual(tokens.cpu(), torch.argmax(logits, dim=-1))
+
+  def test_per_row_temperature(self):
+    logits = torch.randn(4, 1000)
+    temperature = torch.tensor([0.0, 1.0, 0.0, 1.0])
+    tokens = xf.sample_tokens(
+        logits.to(xm.xla_device()), temperature=temperature).cpu()
+    expected = torch.argmax(logits, dim=-1)
+    self.assertEqual(tokens[0], expected[0])
+    self.assertEqual(tokens[2], expected[2])
+
+  def test_top_k(self):
+    device = xm.xla_device()
+    logits = torch.randn(8, 5000)
+    allowed = torch.topk(logits, 5, dim=-1).indices
+    for _ in range(4):
+      tokens = xf.sample_tokens(logits.to(device), top_k=5).cpu()
+      self.assertTrue(torch.all((allowed == tokens.unsqueeze(-1)).any(-1)))
+
+  def test_top_p(self):
+    device = xm.xla_device()
+    # Two tokens hold almost all of the probability of each row.
+    logits = torch.full((8, 3000), -20.0)
+    logits[:, 7] = 5.0
+    logits[:, 11] = 4.0
+    for top_k in (0, 16):
+      tokens = xf.sample_tokens(logits.to(device), top_k=top_k, top_p=0.9)
+      tokens = tokens.cpu()
+      self.assertTrue(torch.all((tokens == 7) | (tokens == 11)))
+
+  def test_distribution(self):
+    logits = torch.log(torch.tensor([0.5, 0.3, 0.2]))
+    tokens = xf.sample_tokens(
+        logits.expand(20000, 3).contiguous().to(xm.xla_device())).cpu()
+    frequencies = torch.bincount(tokens, minlength=3).float() / tokens.numel()
+    self.assertTrue(
+        torch.allclose(frequencies, torch.tensor([0.5, 0.3, 0.2]), atol=0.02))
+
+
+class TestKvCacheUpdate(test_utils.XlaTestCase):
+
+  def test_update(self):
+    device = xm.xla_device()
+    cache = torch.zeros(2, 3, 8, 4)
+    xla_cache = cache.to(device)
+    for position in range(0, 8, 2):
+      update = torch.randn(2, 3, 2, 4)
+      cache[:, :, position:position + 2] = update
+      xf.kv_cache_update_(xla_cache, update.to(device), position, dim=2)
+    self.assertEqual(xla_cache.cpu(), cache)
+
+  def test_position_does_not_recompile(self):
+    device = xm.xla_device()
+    xla_cache = torch.zeros(4, 16, 8).to(device)
+    updates = [torch.full((4, 1, 8), float(p)).to(device) for p in range(4)]
+    met.clear_all()
+    for position in range(4):
+      xf.kv_cache_update_(
+          xla_cache, updates[position], torch.tensor(position).to(device),
+          dim=-2)
+      xm.mark_step()
+    self.assertEqual(met.metric_data('CompileTime')[0], 1)
+    expected = torch.zeros(4, 16, 8)
+    for position in range(4):
+      expected[:, position] = position
+    self.assertEqual(xla_cache.cpu(), expected)
+
+
+class TestSpeculativeDecoding(test_utils.XlaTestCase):
+
+  def test_rollback(self):
+    device = xm.xla_device()
+    cache = torch.randn(2, 10, 4)
+    xla_cache = cache.to(device)
+    xf.kv_cache_rollback_(xla_cache, 3, 1, window=4, dim=1)
+    cache[:, 4:7] = 0
+    self.assertEqual(xla_cache.cpu(), cache)
+
+  def test_accept_does_not_recompile(self):
+    device = xm.xla_device()
+    window = 4
+    caches = [torch.zeros(2, 16, 8).to(device) for _ in range(2)]
+    position = torch.tensor(0, dtype=torch.int32).to(device)
+    expected = torch.zeros(2, 16, 8)
+    expected_position = 0
+    met.clear_all()
+    for step, accepted in enumerate([4, 0, 2, 3]):
+      draft = torch.arange(window, dtype=torch.int32)
+      target = draft.clone()
+      target[accepted:] = -1
+      update = torch.full((2, window, 8), float(step + 1)).to(device)
+      for cache in caches:
+        xf.kv_cache_update_(cache, update, position, dim=1)
+      accepted_xla, position = xf.speculative_accept_(
+          draft.to(device), target.to(device), caches, position, dim=1)
+      xm.mark_step()
+      self.assertEqual(accepted_xla.item(), accepted)
+      expected[:, expected_position:expected_position + accepted] = step + 1
+      expected_position += accepted
+    self.assertEqual(met.metric_data('CompileTime')[0], 1)
+    self.assertEqual(position.item(), expected_position)
+    for cache in caches:
+      self.assertEqual(cache.cpu(), expected)
+
+
+@unittest.skipIf(not _is_on_eager_debug_mode(), 'only on eager debug mode')
+class TestEagerOpCache(test_utils.XlaTestCase):
+
+  def test_cached_op(self):
+    device = xm.xla_device()
+    a = torch.randn(4, 8)
+    b = torch.randn(4, 8)
+    xla_a = a.to(device)
+    xla_b = b.to(device)
+    self.assertEqual((xla_a * xla_b).cpu(), a * b)
+    hits = met.counter_value('EagerOpCacheHit') or 0
+    # The same op over other data of the same shapes reuses the executable.
+    c = torch.randn(4, 8)
+    self.assertEqual((xla_a * c.to(device)).cpu(), a * c)
+    self.assertEqual((xla_b * xla_b).cpu(), b * b)
+    self.assertEqual(met.counter_value('EagerOpCacheHit') - hits, 2)
+
+
 class TestHelperFunction(test_utils.XlaTestCase):
 
   def test_repeat_truncated(self):
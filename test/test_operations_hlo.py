@@ -67,6 +67,14 @@ class TestOperationsHlo(unittest.TestCase):
     hlo_text = torch_xla._XLAC._get_xla_tensors_hlo([b])
     assert 'u8' in hlo_text
 
+  def test_all_reduce_token_barrier(self):
+    a = torch.rand(8, 8).to(xm.xla_device())
+    b = torch_xla._XLAC._xla_all_reduce(xm.REDUCE_SUM, a, 1.0, [], False)
+    hlo_text = torch_xla._XLAC._get_xla_tensors_hlo([b])
+    assert 'opt-barrier' in hlo_text
+    # The token is a constant, not a parameter of the computation.
+    assert 'f32[] parameter' not in hlo_text
+
 
 if __name__ == '__main__':
   torch.set_default_dtype(torch.float32)
@@ -0,0 +1,66 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+from torch_xla.experimental import padded_ops
+import unittest
+
+
+class PaddedOpsTest(unittest.TestCase):
+
+  def _select(self, x, threshold):
+    device = xm.xla_device()
+    xla_x = x.to(device)
+    mask = xla_x.gt(threshold)
+    indices, count = xm.nonzero_static(mask.any(dim=1), size=x.size(0))
+    return xla_x, indices.squeeze(1), count, x[x.gt(threshold).any(dim=1)]
+
+  def test_reductions(self):
+    x = torch.randn(8, 4)
+    xla_x, indices, count, expected = self._select(x, 0.5)
+    rows = padded_ops.padded_index_select(xla_x, indices, count)
+    met.clear_all()
+    total = padded_ops.masked_sum(rows, count)
+    mean = padded_ops.masked_mean(rows, count)
+    largest = padded_ops.masked_max(rows, count)
+    xm.mark_step()
+    # The padded consumers do not read the count on the host.
+    self.assertIsNone(met.metric_data('TransferFromDeviceTime'))
+    self.assertTrue(torch.allclose(total.cpu(), expected.sum(dim=0), atol=1e-5))
+    if expected.size(0) > 0:
+      self.assertTrue(
+          torch.allclose(mean.cpu(), expected.mean(dim=0), atol=1e-5))
+      self.assertTrue(torch.allclose(largest.cpu(), expected.amax(dim=0)))
+
+  def test_softmax_and_matmul(self):
+    x = torch.randn(8, 4)
+    other = torch.randn(4, 3)
+    xla_x, indices, count, expected = self._select(x, 0.0)
+    rows = padded_ops.padded_index_select(xla_x, indices, count)
+    valid = expected.size(0)
+    softmax = padded_ops.masked_softmax(rows, count).cpu()
+    self.assertTrue(
+        torch.allclose(softmax[:valid], torch.softmax(expected, dim=0),
+                       atol=1e-5))
+    self.assertEqual(softmax[valid:].abs().sum().item(), 0)
+    product = padded_ops.padded_matmul(rows, count, other.to(xla_x.device))
+    product = product.cpu()
+    self.assertTrue(torch.allclose(product[:valid], expected @ other,
+                                   atol=1e-5))
+    self.assertEqual(product[valid:].abs().sum().item(), 0)
+
+  def test_valid_mask(self):
+    device = xm.xla_device()
+    padded = torch.zeros(5, 2, device=device)
+    mask = padded_ops.valid_mask(padded, torch.tensor(3, device=device))
+    self.assertEqual(mask.cpu().tolist(), [True, True, True, False, False])
+    # A count past the bound, for dropped rows, makes all the rows valid.
+    mask = padded_ops.valid_mask(padded, torch.tensor(7, device=device))
+    self.assertTrue(mask.cpu().all())
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -153,6 +153,32 @@ class PallasTest(unittest.TestCase):
     # the most important fields are present.
     self.assertIn("custom_call_config", payload)
 
+  @unittest.skipIf(xr.device_type() != 'TPU', "This test only works on TPU.")
+  def test_tpu_custom_call_pallas_kernel_id_cached(self):
+
+    def add_vectors_kernel(x_ref, y_ref, o_ref):
+      x, y = x_ref[...], y_ref[...]
+      o_ref[...] = x + y
+
+    @jax.jit
+    def add_vectors(x: jax.Array, y: jax.Array) -> jax.Array:
+      return pl.pallas_call(
+          add_vectors_kernel, out_shape=jax.ShapeDtypeStruct(x.shape,
+                                                             x.dtype))(x, y)
+
+    from torch_xla.experimental.custom_kernel import trace_pallas_kernel
+    x = torch.randn(8, 8).to("xla")
+    y = torch.randn(8, 8).to("xla")
+    kernel_id, tensor_args = trace_pallas_kernel(add_vectors, x, y)
+    self.assertEqual(len(tensor_args), 2)
+    self.assertEqual(trace_pallas_kernel(add_vectors, y, x)[0], kernel_id)
+    self.assertNotEqual(
+        trace_pallas_kernel(add_vectors, x[:4], y[:4])[0], kernel_id)
+
+    output = torch_xla._XLAC._xla_tpu_custom_call([x, y], kernel_id,
+                                                  [x.shape], [x.dtype])[0]
+    self.assertTrue(torch.allclose(output.cpu(), (x + y).cpu()))
+
   @unittest.skipIf(xr.device_type() != 'TPU', "This test only works on TPU.")
   def test_tpu_custom_call_pallas_wrap_add_payload(self):
 
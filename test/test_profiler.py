@@ -3,6 +3,7 @@ import glob
 import logging
 import multiprocessing
 import os
+import subprocess
 import sys
 import tempfile
 import time
@@ -74,6 +75,8 @@ class ProfilerTest(unittest.TestCase):
                     f'Expected "train_mnist" trace in: {path}')
     self.assertTrue('build_graph' in proto_str,
                     f'Expected "build_graph" trace in: {path}')
+    self.assertTrue('graph_hash' in proto_str,
+                    f'Expected execution traces with a graph hash in: {path}')
 
   def test_trace_and_metrics(self):
     # Create a new context for forking processes with the spawn method.
@@ -100,6 +103,27 @@ class ProfilerTest(unittest.TestCase):
     self._check_trace_namespace_exists(path)
     self._check_metrics_warnings_exist(self.fname)
 
+  def test_sampled_traces(self):
+    logdir = tempfile.mkdtemp()
+    # The sampler is configured once per process.
+    env = dict(
+        os.environ,
+        XLA_SAMPLED_TRACE_DIR=logdir,
+        XLA_SAMPLED_TRACE_EVERY_N_STEPS='3',
+        XLA_SAMPLED_TRACE_MAX_TRACES='2')
+    script = '\n'.join([
+        'import torch', 'import torch_xla.core.xla_model as xm',
+        'x = torch.ones(8, device=xm.xla_device())', 'for _ in range(10):',
+        '  x = x + 1', '  xm.mark_step()'
+    ])
+    subprocess.run([sys.executable, '-c', script], env=env, check=True)
+    # Steps 3, 6 and 9 are traced, and the oldest trace deleted.
+    runs = sorted(os.listdir(os.path.join(logdir, 'plugins', 'profile')))
+    self.assertEqual(runs, ['step_6', 'step_9'])
+    paths = glob.glob(
+        os.path.join(logdir, 'plugins', 'profile', 'step_9', '*.xplane.pb'))
+    self.assertEqual(1, len(paths))
+
 
 if __name__ == '__main__':
   logging.getLogger().setLevel(logging.INFO)
@@ -0,0 +1,62 @@
+import os
+import sys
+
+os.environ['XLA_ANALYZE_RECOMPILES'] = '1'
+os.environ['XLA_IR_DEBUG'] = '1'
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class RecompileAnalysisTest(unittest.TestCase):
+
+  def _reports_of_second_run(self, fn, args):
+    # The first run compiles against the graphs of the earlier tests.
+    fn(args[0])
+    met.clear_recompile_reports()
+    fn(args[1])
+    return met.recompile_reports()
+
+  def test_shape_difference(self):
+    device = xm.xla_device()
+
+    def fn(size):
+      t = torch.ones(size, device=device)
+      (t * 3 + 2).sum().item()
+
+    reports = self._reports_of_second_run(fn, (10, 12))
+    self.assertEqual(len(reports), 1)
+    self.assertIn('in its shape', reports[0])
+    self.assertIn('f32[10]', reports[0])
+    self.assertIn('f32[12]', reports[0])
+    self.assertIn('test_recompile_analysis.py', reports[0])
+
+  def test_scalar_difference(self):
+    device = xm.xla_device()
+    t = torch.ones(6, device=device)
+    xm.mark_step()
+
+    # Zero and one are special scalars, which are baked into the graph.
+    def fn(value):
+      (t.fill_(value) * 2).sum().item()
+
+    reports = self._reports_of_second_run(fn, (0.0, 1.0))
+    self.assertEqual(len(reports), 1)
+    self.assertIn('in its scalar constant', reports[0])
+
+  def test_cached_graph_no_report(self):
+    device = xm.xla_device()
+
+    def fn(_):
+      t = torch.ones(7, device=device)
+      (t - 5).sum().item()
+
+    self.assertEqual(self._reports_of_second_run(fn, (None, None)), [])
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
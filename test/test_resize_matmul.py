@@ -0,0 +1,48 @@
+import sys
+
+import torch
+import torch.nn.functional as F
+import torch_xla
+import torch_xla.core.xla_model as xm
+import unittest
+
+# The resize lowering is read once per process, run with
+# XLA_RESIZE_WITH_MATMUL=1.
+
+
+class ResizeMatmulTest(unittest.TestCase):
+
+  def _test_resize(self, input_size, output_size, mode, align_corners=None):
+    device = xm.xla_device()
+    x = torch.randn(2, 3, *input_size, requires_grad=True)
+    xx = x.detach().to(device).requires_grad_()
+    y = F.interpolate(
+        x, size=output_size, mode=mode, align_corners=align_corners)
+    xy = F.interpolate(
+        xx, size=output_size, mode=mode, align_corners=align_corners)
+    grad = torch.randn_like(y)
+    y.backward(grad)
+    xy.backward(grad.to(device))
+    self.assertTrue(torch.allclose(xy.cpu(), y, rtol=1e-4, atol=1e-5))
+    self.assertTrue(
+        torch.allclose(xx.grad.cpu(), x.grad, rtol=1e-4, atol=1e-5))
+
+  def test_bilinear_upsample(self):
+    self._test_resize((7, 9), (16, 20), 'bilinear', align_corners=False)
+
+  def test_bilinear_upsample_align_corners(self):
+    self._test_resize((7, 9), (16, 20), 'bilinear', align_corners=True)
+
+  def test_bilinear_downsample(self):
+    self._test_resize((16, 20), (5, 7), 'bilinear', align_corners=False)
+
+  def test_nearest_upsample(self):
+    self._test_resize((5, 6), (15, 14), 'nearest')
+
+  def test_nearest_downsample(self):
+    self._test_resize((12, 13), (4, 5), 'nearest')
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
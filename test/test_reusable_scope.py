@@ -0,0 +1,57 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+from torch_xla.experimental import reusable_scope
+import unittest
+
+
+def run_layers(weights, x, mark):
+  hidden = x
+  for weight in weights:
+    output = torch.relu(hidden @ weight) + 1.0
+    if mark:
+      reusable_scope.mark_reusable_scope(
+          output, inputs=hidden, name='layer/')
+    hidden = output
+  return hidden
+
+
+class ReusableScopeTest(unittest.TestCase):
+
+  def test_identical_layers_share_computation(self):
+    device = xm.xla_device()
+    weights = [torch.randn(8, 8) for _ in range(4)]
+    x = torch.randn(2, 8)
+    expected = run_layers(weights, x, mark=False)
+    met.clear_all()
+    output = run_layers([w.to(device) for w in weights], x.to(device),
+                        mark=True)
+    torch.testing.assert_close(output.cpu(), expected, rtol=1e-4, atol=1e-4)
+    self.assertEqual(met.counter_value('ReusableScopeComputations'), 1)
+    self.assertEqual(met.counter_value('ReusedScopeLowerings'), 3)
+
+  def test_different_shapes_do_not_share(self):
+    device = xm.xla_device()
+    weights = [torch.randn(8, 16), torch.randn(16, 8)]
+    x = torch.randn(2, 8)
+    expected = run_layers(weights, x, mark=False)
+    met.clear_all()
+    output = run_layers([w.to(device) for w in weights], x.to(device),
+                        mark=True)
+    torch.testing.assert_close(output.cpu(), expected, rtol=1e-4, atol=1e-4)
+    self.assertEqual(met.counter_value('ReusableScopeComputations'), 2)
+    self.assertIsNone(met.counter_value('ReusedScopeLowerings'))
+
+  def test_unmarked_graph(self):
+    device = xm.xla_device()
+    met.clear_all()
+    (torch.randn(4, 4, device=device) * 2).cpu()
+    self.assertIsNone(met.counter_value('ReusableScopeComputations'))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
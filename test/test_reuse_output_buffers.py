@@ -0,0 +1,46 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+# Run with XLA_REUSE_OUTPUT_BUFFERS=1.
+
+
+class ReuseOutputBuffersTest(unittest.TestCase):
+
+  def test_released_outputs_are_reused(self):
+    device = xm.xla_device()
+    weight = torch.randn(64, 64, device=device)
+    x = torch.randn(8, 64, device=device)
+    xm.mark_step()
+    met.clear_all()
+    expected = (x.cpu() @ weight.cpu()).sum()
+    for _ in range(4):
+      loss = (x @ weight).sum()
+      xm.mark_step()
+      self.assertTrue(torch.allclose(loss.cpu(), expected, rtol=1e-4))
+      del loss
+    self.assertGreater(met.metric_data('RecycledOutputParameters')[0], 0)
+    self.assertEqual(met.counter_value('RecycledOutputAllocations'), 1)
+    self.assertEqual(met.counter_value('RecycledOutputBuffers'), 3)
+
+  def test_live_outputs_are_not_reused(self):
+    device = xm.xla_device()
+    a = torch.randn(32, 32, device=device)
+    xm.mark_step()
+    met.clear_all()
+    outputs = []
+    for i in range(3):
+      outputs.append(a * 2)
+      xm.mark_step()
+    for out in outputs:
+      self.assertTrue(torch.allclose(out.cpu(), a.cpu() * 2))
+    self.assertIsNone(met.counter_value('RecycledOutputBuffers'))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,54 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import unittest
+
+# The seed mode is read once per process, run with XLA_RNG_COUNTER_SEEDS=1.
+
+
+class RngCounterSeedsTest(unittest.TestCase):
+
+  def test_random_ops_differ(self):
+    device = xm.xla_device()
+    xm.set_rng_state(123, device=device)
+    samples = [torch.rand(1024, device=device) for _ in range(4)]
+    xm.mark_step()
+    for i in range(len(samples)):
+      for j in range(i + 1, len(samples)):
+        self.assertFalse(torch.equal(samples[i].cpu(), samples[j].cpu()))
+
+  def test_reproducible(self):
+    device = xm.xla_device()
+    results = []
+    for _ in range(2):
+      xm.set_rng_state(7, device=device)
+      x = torch.ones(256, 256, device=device)
+      y = torch.nn.functional.dropout(x, p=0.5, training=True)
+      y = torch.nn.functional.dropout(y, p=0.5, training=True)
+      xm.mark_step()
+      results.append(y.cpu())
+    torch.testing.assert_close(results[0], results[1])
+
+  def test_running_seed_counts_ops(self):
+    device = xm.xla_device()
+    xm.set_rng_state(1000, device=device)
+    for _ in range(3):
+      torch.rand(8, device=device)
+    self.assertEqual(xm.get_rng_state(device=device), 1003)
+
+  def test_graph_hash_stable(self):
+    device = xm.xla_device()
+    hashes = []
+    for seed in (1, 2):
+      xm.set_rng_state(seed, device=device)
+      x = torch.rand(16, device=device) + torch.rand(16, device=device)
+      hashes.append(torch_xla._XLAC._get_graph_hash([x]))
+      xm.mark_step()
+    self.assertEqual(hashes[0], hashes[1])
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
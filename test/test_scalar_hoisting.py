@@ -0,0 +1,47 @@
+import os
+import sys
+
+os.environ['XLA_HOIST_SCALARS'] = '1'
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class ScalarHoistingTest(unittest.TestCase):
+
+  def test_pow_exponent_hoisted(self):
+    device = xm.xla_device()
+    t = torch.rand(4, device=device) + 1
+    xm.mark_step()
+    met.clear_all()
+    for exponent in (2.5, 3.5, 4.5):
+      result = t**exponent
+      self.assertTrue(
+          torch.allclose(result.cpu(), t.cpu()**exponent, rtol=1e-4))
+    self.assertEqual(met.metric_data('CompileTime')[0], 1)
+    self.assertGreaterEqual(met.counter_value('HoistedScalar'), 3)
+    self.assertFalse(met.counter_value('BakedScalar'))
+
+  def test_special_scalar_baked(self):
+    device = xm.xla_device()
+    t = torch.rand(4, device=device)
+    met.clear_counters()
+    t = t * 1
+    self.assertEqual(met.counter_value('BakedScalar'), 1)
+    self.assertFalse(met.counter_value('HoistedScalar'))
+
+  def test_identical_values_uploaded_once(self):
+    device = xm.xla_device()
+    t = torch.rand(4, device=device)
+    met.clear_counters()
+    for _ in range(3):
+      t = t * 0.7
+    self.assertEqual(met.counter_value('DeviceDataCacheMiss'), 1)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
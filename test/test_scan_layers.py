@@ -0,0 +1,48 @@
+import sys
+
+import torch
+import torch.nn as nn
+import torch_xla
+import torch_xla.core.xla_model as xm
+from torch_xla.experimental.scan_layers import scan_layers
+import unittest
+
+
+class Layer(nn.Module):
+
+  def __init__(self):
+    super().__init__()
+    self.linear = nn.Linear(16, 16)
+
+  def forward(self, x):
+    return torch.tanh(self.linear(x))
+
+
+class ScanLayersTest(unittest.TestCase):
+
+  def test_scan_layers(self):
+    device = xm.xla_device()
+    layers = nn.ModuleList([Layer() for _ in range(6)]).to(device)
+    x = torch.randn(4, 16, device=device)
+    xm.mark_step()
+
+    output = scan_layers(layers, x)
+    hlo = torch_xla._XLAC._get_xla_tensors_hlo([output])
+    self.assertIn('while', hlo)
+    self.assertEqual(hlo.count(' tanh('), 1)
+
+    expected = x
+    for layer in layers:
+      expected = layer(expected)
+    self.assertTrue(torch.allclose(output.cpu(), expected.cpu(), atol=1e-4))
+
+  def test_mismatched_layers(self):
+    device = xm.xla_device()
+    layers = [nn.Linear(8, 8), nn.Linear(8, 4)]
+    with self.assertRaises(ValueError):
+      scan_layers(layers, torch.randn(2, 8, device=device))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,76 @@
+import os
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import unittest
+
+# The mode is read once per process, run with XLA_SCATTER_INDICES_MODE set.
+_MODE = os.environ.get('XLA_SCATTER_INDICES_MODE', 'unsorted')
+
+
+class ScatterIndicesTest(unittest.TestCase):
+
+  def _check_hints(self, tensor):
+    hlo = torch_xla._XLAC._get_xla_tensors_hlo([tensor])
+    self.assertEqual('indices_are_sorted=true' in hlo, _MODE == 'sorted')
+    self.assertEqual('unique_indices=true' in hlo, _MODE == 'segment_reduce')
+
+  def test_index_put_accumulate(self):
+    device = xm.xla_device()
+    base = torch.randn(16, 8)
+    # Many duplicates, in no particular order.
+    rows = torch.randint(0, 16, (200,))
+    values = torch.randn(200, 8)
+    expected = base.index_put((rows,), values, accumulate=True)
+    result = base.to(device).index_put((rows.to(device),), values.to(device),
+                                       accumulate=True)
+    self._check_hints(result)
+    torch.testing.assert_close(result.cpu(), expected)
+
+  def test_index_put_accumulate_multi_index(self):
+    device = xm.xla_device()
+    base = torch.zeros(4, 6, 3, dtype=torch.int64)
+    rows = torch.randint(0, 4, (5, 7))
+    cols = torch.randint(0, 6, (5, 7))
+    values = torch.randint(0, 100, (5, 7, 3))
+    expected = base.index_put((rows, cols), values, accumulate=True)
+    result = base.to(device).index_put((rows.to(device), cols.to(device)),
+                                       values.to(device),
+                                       accumulate=True)
+    torch.testing.assert_close(result.cpu(), expected)
+
+  def test_index_put_unique(self):
+    device = xm.xla_device()
+    base = torch.randn(32, 4)
+    rows = torch.randperm(32)[:20]
+    values = torch.randn(20, 4)
+    expected = base.index_put((rows,), values)
+    result = base.to(device).index_put((rows.to(device),), values.to(device))
+    torch.testing.assert_close(result.cpu(), expected)
+
+  def test_scatter_reduce(self):
+    device = xm.xla_device()
+    base = torch.randn(8, 5)
+    index = torch.randint(0, 8, (30, 5))
+    src = torch.randn(30, 5)
+    for reduce in ('sum', 'prod', 'amax', 'amin'):
+      expected = base.scatter_reduce(0, index, src, reduce)
+      result = base.to(device).scatter_reduce(0, index.to(device),
+                                              src.to(device), reduce)
+      torch.testing.assert_close(result.cpu(), expected)
+
+  def test_scatter_add(self):
+    device = xm.xla_device()
+    base = torch.randn(6, 40)
+    index = torch.randint(0, 40, (6, 100))
+    src = torch.randn(6, 100)
+    expected = base.scatter_add(1, index, src)
+    result = base.to(device).scatter_add(1, index.to(device), src.to(device))
+    torch.testing.assert_close(result.cpu(), expected)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
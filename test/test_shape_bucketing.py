@@ -0,0 +1,59 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+from torch_xla.experimental import shape_bucketing
+import unittest
+
+
+class ShapeBucketingTest(unittest.TestCase):
+
+  def test_bucket_size(self):
+    self.assertEqual(shape_bucketing.bucket_size(5), 8)
+    self.assertEqual(shape_bucketing.bucket_size(8), 8)
+    self.assertEqual(shape_bucketing.bucket_size(9, buckets=[16, 48]), 16)
+    self.assertEqual(shape_bucketing.bucket_size(17, buckets=[16, 48]), 48)
+    met.clear_counters()
+    self.assertEqual(shape_bucketing.bucket_size(50, buckets=[16, 48]), 64)
+    self.assertEqual(met.counter_value('ShapeBucketOverflow'), 1)
+
+  def test_pad_to_bucket(self):
+    device = xm.xla_device()
+    t = torch.randn(3, 5)
+    padded, lengths = shape_bucketing.pad_to_bucket(t, -1, device=device)
+    self.assertEqual(padded.shape, (3, 8))
+    self.assertEqual(lengths.cpu().tolist(), [5])
+    self.assertTrue(torch.allclose(padded.cpu()[:, :5], t))
+    self.assertEqual(padded.cpu()[:, 5:].abs().sum().item(), 0)
+    mask = shape_bucketing.length_mask(lengths[0], padded.shape[-1])
+    self.assertTrue(
+        torch.allclose((padded * mask).sum().cpu(), t.sum(), atol=1e-5))
+
+  def test_bucketing_avoids_recompiles(self):
+    device = xm.xla_device()
+    met.clear_all()
+    for length in (3, 5, 6, 7):
+      t = torch.arange(length, dtype=torch.float32)
+      padded, lengths = shape_bucketing.pad_to_bucket(t, 0, device=device)
+      mask = shape_bucketing.length_mask(lengths[0], padded.shape[0])
+      total = (padded * mask).sum()
+      self.assertEqual(total.item(), sum(range(length)))
+    # Buckets of 4 and 8.
+    self.assertEqual(met.metric_data('CompileTime')[0], 2)
+
+  def test_shape_recompile_histogram(self):
+    device = xm.xla_device()
+    met.clear_counters()
+    for length in (11, 13):
+      t = torch.ones(length, device=device)
+      (t * 7 - 2).sum().item()
+    self.assertGreaterEqual(met.counter_value('ShapeInducedRecompile'), 1)
+    self.assertTrue(
+        any(count >= 2 for count in met.shape_recompile_histogram().values()))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
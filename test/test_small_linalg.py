@@ -0,0 +1,60 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+def _well_conditioned(*sizes):
+  return torch.eye(sizes[-1]) + 0.1 * torch.randn(*sizes)
+
+
+class SmallLinalgTest(unittest.TestCase):
+
+  def test_inverse(self):
+    device = xm.xla_device()
+    for size in (1, 2, 3, 4):
+      a = _well_conditioned(5, 7, size, size)
+      met.clear_all()
+      actual = torch.linalg.inv(a.to(device))
+      torch.testing.assert_close(
+          actual.cpu(), torch.linalg.inv(a), rtol=1e-4, atol=1e-4)
+      self.assertEqual(met.counter_value('SmallMatrixLowerings'), 1)
+
+  def test_inverse_generic(self):
+    device = xm.xla_device()
+    a = _well_conditioned(3, 6, 6)
+    met.clear_all()
+    actual = torch.linalg.inv(a.to(device))
+    torch.testing.assert_close(
+        actual.cpu(), torch.linalg.inv(a), rtol=1e-4, atol=1e-4)
+    self.assertIsNone(met.counter_value('SmallMatrixLowerings'))
+
+  def test_triangular_solve(self):
+    device = xm.xla_device()
+    a = _well_conditioned(6, 3, 3)
+    b = torch.randn(6, 3, 2)
+    for upper in (True, False):
+      for transpose in (True, False):
+        for unitriangular in (True, False):
+          met.clear_all()
+          expected = torch.triangular_solve(
+              b, a, upper=upper, transpose=transpose,
+              unitriangular=unitriangular).solution
+          actual = torch.triangular_solve(
+              b.to(device),
+              a.to(device),
+              upper=upper,
+              transpose=transpose,
+              unitriangular=unitriangular).solution
+          torch.testing.assert_close(
+              actual.cpu(), expected, rtol=1e-4, atol=1e-4)
+          self.assertEqual(met.counter_value('SmallMatrixLowerings'), 1)
+
+
+if __name__ == '__main__':
+  torch.manual_seed(42)
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,59 @@
+import os
+import sys
+
+# The pipeline depth is read on first use, so configure it before importing
+# torch_xla.
+os.environ['XLA_MAX_INFLIGHT_STEPS'] = '2'
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class StepPipelineTest(unittest.TestCase):
+
+  def test_inflight_steps_are_bounded(self):
+    device = xm.xla_device()
+    a = torch.randn(256, 256)
+    xa = a.to(device)
+    expected = a
+    for _ in range(8):
+      xa = xa @ xa / 256
+      expected = expected @ expected / 256
+      xm.mark_step()
+      self.assertLessEqual(torch_xla._XLAC._xla_inflight_steps(), 2)
+    xm.wait_device_ops()
+    self.assertEqual(torch_xla._XLAC._xla_inflight_steps(), 0)
+    self.assertTrue(torch.allclose(xa.cpu(), expected, rtol=1e-3, atol=1e-4))
+
+  def test_fetch_does_not_drain(self):
+    device = xm.xla_device()
+    x = torch.ones(64, 64, device=device)
+    xm.mark_step()
+    xm.wait_device_ops()
+    met.clear_counters()
+    losses = []
+    for _ in range(4):
+      x = x * 2
+      loss = x.sum()
+      xm.mark_step()
+      # Reading the loss waits for its own step only.
+      losses.append(loss.item())
+    self.assertEqual(losses, [64 * 64 * 2.0**i for i in range(1, 5)])
+    self.assertFalse(met.counter_value('StepPipelineDrainSyncWait'))
+    self.assertFalse(met.counter_value('StepPipelineDrainWaitDeviceOps'))
+
+  def test_sync_wait_drains(self):
+    device = xm.xla_device()
+    x = torch.ones(8, 8, device=device)
+    x = x + 1
+    xm.mark_step(wait=True)
+    self.assertEqual(torch_xla._XLAC._xla_inflight_steps(), 0)
+    self.assertTrue(torch.allclose(x.cpu(), torch.full((8, 8), 2.0)))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,73 @@
+import os
+import sys
+
+# The timeline size is read on first use, so configure it before importing
+# torch_xla.
+os.environ['XLA_STEP_TIMELINE_SIZE'] = '4'
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class StepTimelineTest(unittest.TestCase):
+
+  def _run_steps(self, count):
+    device = xm.xla_device()
+    t = torch.ones(8, 8, device=device)
+    for _ in range(count):
+      t = t * 2 + 1
+      xm.mark_step()
+    xm.wait_device_ops()
+
+  def test_records_stage_breakdown(self):
+    met.clear_step_timeline()
+    # The first step also materializes the initial tensor, so only the later
+    # ones run the same graph.
+    self._run_steps(3)
+    records = met.step_timeline()
+    self.assertEqual(len(records), 3)
+    first, second = records[1:]
+    self.assertLess(first['id'], second['id'])
+    self.assertEqual(first['graph_hash'], second['graph_hash'])
+    self.assertTrue(second['cache_hit'])
+    self.assertEqual(second['num_tensors'], 1)
+    stages = second['stages_ns']
+    for stage in ('CollectSyncTensors', 'RunPostOrder', 'LookupCachedCompile',
+                  'SetTensorData', 'QueueWait', 'Execute'):
+      self.assertIn(stage, stages)
+    self.assertGreater(stages['RunPostOrder'], 0)
+    self.assertGreater(stages['Execute'], 0)
+    self.assertGreaterEqual(second['host_ns'], stages['RunPostOrder'])
+
+  def test_keeps_last_syncs(self):
+    met.clear_step_timeline()
+    self._run_steps(6)
+    records = met.step_timeline()
+    self.assertEqual(len(records), 4)
+    ids = [record['id'] for record in records]
+    self.assertEqual(ids, sorted(ids))
+    met.clear_step_timeline()
+    self.assertEqual(met.step_timeline(), [])
+
+  def test_fetch_records_gather(self):
+    met.clear_step_timeline()
+    device = xm.xla_device()
+    t = torch.ones(8, 8, device=device) * 3
+    self.assertTrue(torch.allclose(t.cpu(), torch.full((8, 8), 3.0)))
+    records = met.step_timeline()
+    self.assertEqual(len(records), 1)
+    self.assertIn('GatherTensorsXlaData', records[0]['stages_ns'])
+
+  def test_empty_syncs_are_not_recorded(self):
+    met.clear_step_timeline()
+    xm.mark_step()
+    xm.mark_step()
+    self.assertEqual(met.step_timeline(), [])
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,55 @@
+import os
+import sys
+
+# Both settings are read on first use, so configure them before importing
+# torch_xla.
+os.environ['XLA_SYNC_ROOTS_ONLY'] = '1'
+os.environ['XLA_SYNC_MAX_GRAPH_SIZE'] = '16'
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class SyncRootsTest(unittest.TestCase):
+
+  def test_prunes_non_root_tensors(self):
+    device = xm.xla_device()
+    w = torch.ones(4, 4, device=device)
+    xm.mark_step()
+    xm.mark_step_roots([w])
+    self.assertTrue(torch_xla._XLAC._xla_is_step_root(w))
+
+    w += 1
+    stale = w * 3
+    met.clear_counters()
+    xm.mark_step()
+    self.assertEqual(met.counter_value('PrunedLiveTensors'), 1)
+    # In-place updates keep the tensor a root.
+    self.assertTrue(torch_xla._XLAC._xla_is_step_root(w))
+    self.assertIn('aten::mul', torch_xla._XLAC._get_xla_tensors_text([stale]))
+    self.assertNotIn('aten::add', torch_xla._XLAC._get_xla_tensors_text([w]))
+    # The pruned tensor still reads the buffer w had before the step.
+    self.assertTrue(torch.allclose(stale.cpu(), torch.full((4, 4), 6.0)))
+    self.assertTrue(torch.allclose(w.cpu(), torch.full((4, 4), 2.0)))
+
+    xm.mark_step_roots([w], is_root=False)
+    self.assertFalse(torch_xla._XLAC._xla_is_step_root(w))
+
+  def test_splits_large_graphs(self):
+    device = xm.xla_device()
+    base = torch.ones(4, 4, device=device)
+    xm.mark_step()
+    outputs = [base * i + i for i in range(8)]
+    met.clear_counters()
+    xm.mark_step()
+    self.assertGreater(met.counter_value('SplitTensorsGraph'), 0)
+    for i, output in enumerate(outputs):
+      self.assertTrue(torch.allclose(output.cpu(), torch.full((4, 4), 2.0 * i)))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -9,6 +9,7 @@ sys.argv = [sys.argv[0]] + leftovers
 import torch
 import torch.nn as nn
 import torch.nn.functional as F
+import torch_xla.core.functions as xf
 import torch_xla.core.xla_model as xm
 import unittest
 import numpy as np
@@ -107,6 +108,149 @@ class TestSyncFreeOptimizerBase(unittest.TestCase):
           atol=1e-1)
 
 
+class TestSyncFreeSparseGrads(unittest.TestCase):
+
+  def _test_optimizer(self, syncfree_optim_cls, optim_kwargs):
+    device = xm.xla_device()
+    torch.manual_seed(0)
+    init = torch.randn(64, 8)
+    # Repeated rows, and rows touched at every step, for which the row-sparse
+    # updates match the dense ones.
+    indices = torch.tensor([[3, 7, 3, 11], [60, 7, 0, 3]], device=device)
+    targets = [torch.randn(2, 4, 8, device=device) for _ in range(3)]
+    weights = []
+    for sparse in (True, False):
+      weight = init.clone().to(device).requires_grad_()
+      optimizer = syncfree_optim_cls([weight], **optim_kwargs)
+      for target in targets:
+        optimizer.zero_grad()
+        if sparse:
+          output = xf.sparse_embedding(weight, indices)
+        else:
+          output = F.embedding(indices, weight)
+        ((output - target)**2).sum().backward()
+        if sparse:
+          self.assertIsNone(weight.grad)
+        optimizer.step(found_inf=torch.tensor(0.0, device=device))
+        xm.mark_step()
+      weights.append(weight.detach().cpu().numpy())
+    np.testing.assert_allclose(weights[0], weights[1], rtol=1e-5, atol=1e-5)
+
+  def test_sgd(self):
+    self._test_optimizer(syncfree.SGD, {"lr": 1e-2, "momentum": 0.5})
+
+  def test_adam(self):
+    self._test_optimizer(syncfree.Adam, {"lr": 1e-2, "amsgrad": True})
+
+
+class TestSyncFreeForeach(unittest.TestCase):
+
+  def _test_optimizer(self, syncfree_optim_cls, optim_kwargs):
+    device = xm.xla_device()
+    loss_fn = nn.NLLLoss()
+    data = torch.rand(32, 1, 28, 28).to(device)
+    target = torch.zeros(32, dtype=torch.long).to(device)
+    params = []
+    for foreach in (True, False):
+      torch.manual_seed(0)
+      model = MNIST().train().to(device)
+      optimizer = syncfree_optim_cls(
+          model.parameters(), foreach=foreach, **optim_kwargs)
+      for i in range(3):
+        optimizer.zero_grad()
+        loss_fn(model(data), target).backward()
+        optimizer.step(found_inf=torch.tensor(float(i == 1), device=device))
+        xm.mark_step()
+      params.append([p.detach().cpu().numpy() for p in model.parameters()])
+    for p, p_ref in zip(*params):
+      np.testing.assert_allclose(p, p_ref, rtol=1e-5, atol=1e-5)
+
+  def test_sgd(self):
+    self._test_optimizer(syncfree.SGD, {
+        "lr": 1e-2,
+        "momentum": 0.5,
+        "weight_decay": 0.1,
+        "nesterov": True,
+    })
+
+  def test_adam(self):
+    self._test_optimizer(syncfree.Adam, {
+        "lr": 1e-3,
+        "weight_decay": 1e-4,
+        "amsgrad": True,
+    })
+
+  def test_adamw(self):
+    self._test_optimizer(syncfree.AdamW, {"lr": 1e-3})
+
+
+class TestSyncFreeUnscaleAndClip(unittest.TestCase):
+
+  def _test_optimizer(self, syncfree_optim_cls, ref_optim_cls, optim_kwargs):
+    device = xm.xla_device()
+    loss_fn = nn.NLLLoss()
+    data = torch.rand(32, 1, 28, 28).to(device)
+    target = torch.zeros(32, dtype=torch.long).to(device)
+    inv_scale = torch.tensor(0.25, device=device)
+    max_norm = 0.1
+    params = []
+    for syncfree_optim in (True, False):
+      torch.manual_seed(0)
+      model = MNIST().train().to(device)
+      if syncfree_optim:
+        optimizer = syncfree_optim_cls(
+            model.parameters(), foreach=True, **optim_kwargs)
+      else:
+        optimizer = ref_optim_cls(model.parameters(), **optim_kwargs)
+      for _ in range(3):
+        optimizer.zero_grad()
+        (loss_fn(model(data), target) / inv_scale).backward()
+        if syncfree_optim:
+          found_inf = torch.zeros((), device=device)
+          optimizer.step(
+              found_inf=found_inf, inv_scale=inv_scale, max_norm=max_norm)
+          self.assertEqual(found_inf.item(), 0)
+        else:
+          for p in model.parameters():
+            p.grad.mul_(inv_scale)
+          torch.nn.utils.clip_grad_norm_(model.parameters(), max_norm)
+          optimizer.step()
+        xm.mark_step()
+      params.append([p.detach().cpu().numpy() for p in model.parameters()])
+    for p, p_ref in zip(*params):
+      np.testing.assert_allclose(p, p_ref, rtol=1e-4, atol=1e-5)
+
+  def test_sgd(self):
+    self._test_optimizer(syncfree.SGD, torch.optim.SGD, {
+        "lr": 1e-2,
+        "momentum": 0.5,
+    })
+
+  def test_adam(self):
+    self._test_optimizer(syncfree.Adam, torch.optim.Adam, {"lr": 1e-3})
+
+  def test_adamw(self):
+    self._test_optimizer(syncfree.AdamW, torch.optim.AdamW, {"lr": 1e-3})
+
+  def test_non_finite_grad_skips_step(self):
+    device = xm.xla_device()
+    torch.manual_seed(0)
+    model = MNIST().train().to(device)
+    optimizer = syncfree.SGD(model.parameters(), lr=1e-2, foreach=True)
+    ref_params = [p.detach().cpu().numpy() for p in model.parameters()]
+    model(torch.rand(4, 1, 28, 28).to(device)).sum().backward()
+    next(model.parameters()).grad[0] = float('inf')
+    found_inf = torch.zeros((), device=device)
+    optimizer.step(
+        found_inf=found_inf,
+        inv_scale=torch.tensor(0.5, device=device),
+        max_norm=1.0)
+    xm.mark_step()
+    self.assertEqual(found_inf.item(), 1)
+    for p, p_ref in zip(model.parameters(), ref_params):
+      np.testing.assert_allclose(p.detach().cpu().numpy(), p_ref)
+
+
 class TestSyncFreeSGD(TestSyncFreeOptimizerBase):
 
   def test_optimizer(self):
@@ -0,0 +1,49 @@
+import os
+import sys
+
+# Async compilation is configured at startup, so set it before importing
+# torch_xla.
+os.environ['XLA_ASYNC_COMPILE'] = '1'
+os.environ['XLA_ASYNC_COMPILE_HOT_EXECUTIONS'] = '3'
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class TieredCompileTest(unittest.TestCase):
+
+  def _run_step(self, t, xt):
+    s = xt * 2 + 1
+    xm.mark_step()
+    self.assertTrue(torch.allclose(s.cpu(), t * 2 + 1))
+
+  def test_optimized_compile_once_hot(self):
+    met.clear_all()
+    t = torch.randn(4, 4)
+    xt = t.to(xm.xla_device())
+
+    # The fallback runs twice without scheduling the optimized compilation.
+    self._run_step(t, xt)
+    self._run_step(t, xt)
+    self.assertEqual(met.counter_value('AsyncCompileFallback'), 1)
+    self.assertEqual(met.counter_value('AsyncCompileDeferred'), 1)
+    self.assertIsNone(met.counter_value('AsyncCompileScheduled'))
+
+    # The third execution makes the graph hot.
+    self._run_step(t, xt)
+    self.assertEqual(met.counter_value('AsyncCompileScheduled'), 1)
+    torch_xla._XLAC._xla_wait_async_compilations()
+    self.assertEqual(met.counter_value('AsyncCompileCompleted'), 1)
+
+    for _ in range(3):
+      self._run_step(t, xt)
+    self.assertEqual(met.counter_value('AsyncCompileScheduled'), 1)
+    self.assertEqual(met.counter_value('UncachedCompile'), 1)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,48 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+# The wrapping threshold is read once per process, run with
+# XLA_PARAMETER_WRAPPING_THREADSHOLD=8.
+
+
+class TupledParametersTest(unittest.TestCase):
+
+  def test_many_parameters(self):
+    device = xm.xla_device()
+    tensors = [torch.randn(4, 4) for _ in range(12)]
+    xtensors = [t.to(device) for t in tensors]
+    xm.mark_step()
+    met.clear_all()
+    for _ in range(2):
+      for t in tensors:
+        t.mul_(2).add_(1)
+      for xt in xtensors:
+        xt.mul_(2).add_(1)
+      total = sum(tensors)
+      xtotal = sum(xtensors)
+      xm.mark_step()
+      self.assertTrue(torch.allclose(xtotal.cpu(), total))
+    for t, xt in zip(tensors, xtensors):
+      self.assertTrue(torch.allclose(xt.cpu(), t))
+    self.assertEqual(met.counter_value('TupledParametersGraph'), 1)
+
+  def test_few_parameters(self):
+    device = xm.xla_device()
+    a = torch.randn(4, 4, device=device)
+    b = torch.randn(4, 4, device=device)
+    xm.mark_step()
+    met.clear_all()
+    c = a @ b
+    xm.mark_step()
+    self.assertEqual(c.cpu().shape, (4, 4))
+    self.assertIsNone(met.counter_value('TupledParametersGraph'))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
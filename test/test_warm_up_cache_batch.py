@@ -0,0 +1,35 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class WarmUpCacheBatchTest(unittest.TestCase):
+
+  def test_batch_warm_up(self):
+    met.clear_all()
+    device = xm.xla_device()
+    xt = torch.randn(4, 4).to(device)
+    a = xt * 2
+    b = xt + 3
+    # Duplicated graphs are only compiled once.
+    c = xt + 3
+    torch_xla._XLAC._xla_warm_up_cache_batch([[a], [b], [c]], [])
+    self.assertEqual(met.counter_value('WarmUpCacheBatchGraphs'), 2)
+    self.assertEqual(met.counter_value('UncachedCompile'), 2)
+
+    # The graphs are now cached, so nothing gets compiled.
+    torch_xla._XLAC._xla_warm_up_cache_batch([[a], [b]], [])
+    self.assertEqual(met.counter_value('WarmUpCacheBatchGraphs'), 2)
+    self.assertEqual(met.counter_value('CachedCompile'), 2)
+
+    # The tensors still hold their pending IR and can be executed.
+    self.assertTrue(torch.allclose(a.cpu(), xt.cpu() * 2))
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
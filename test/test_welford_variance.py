@@ -0,0 +1,65 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import unittest
+
+# Run with XLA_WELFORD_VARIANCE=1.
+
+
+class WelfordVarianceTest(unittest.TestCase):
+
+  def _check(self, fn, *inputs, rtol=1e-4, atol=1e-5):
+    device = xm.xla_device()
+    expected = fn(*inputs)
+    result = fn(*[x.to(device) for x in inputs])
+    if isinstance(expected, tuple):
+      for r, e in zip(result, expected):
+        torch.testing.assert_close(r.cpu(), e, rtol=rtol, atol=atol)
+    else:
+      torch.testing.assert_close(result.cpu(), expected, rtol=rtol, atol=atol)
+
+  def test_single_reduction(self):
+    device = xm.xla_device()
+    x = torch.randn(32, 64, device=device)
+    hlo = torch_xla._XLAC._get_xla_tensors_hlo([torch.var(x, dim=1)])
+    self.assertIn('WelfordComputation', hlo)
+
+  def test_var_std(self):
+    x = torch.randn(16, 33, 7) * 3 + 100
+    self._check(lambda t: torch.var(t, dim=1), x)
+    self._check(lambda t: torch.var(t, dim=(0, 2), keepdim=True), x)
+    self._check(lambda t: torch.var(t, correction=0), x)
+    self._check(lambda t: torch.std(t, dim=-1, correction=2), x)
+
+  def test_var_mean(self):
+    x = torch.randn(8, 128) + 10
+    self._check(lambda t: torch.var_mean(t, dim=1), x)
+    self._check(lambda t: torch.var_mean(t, dim=0, keepdim=True), x)
+
+  def test_bfloat16_offset(self):
+    # A large offset makes the two pass variance lose the small spread in
+    # BF16, while the statistics accumulate in F32.
+    x = (torch.randn(4, 1024) + 64).to(torch.bfloat16)
+    device = xm.xla_device()
+    result = torch.var(x.to(device), dim=1).float().cpu()
+    expected = torch.var(x.float(), dim=1)
+    torch.testing.assert_close(result, expected, rtol=2e-2, atol=2e-2)
+
+  def test_single_element(self):
+    x = torch.randn(5, 1)
+    self._check(lambda t: torch.var(t, dim=1, correction=0), x)
+
+  def test_batch_norm_training(self):
+    x = torch.randn(8, 4, 5, 5)
+    weight = torch.randn(4)
+    bias = torch.randn(4)
+    self._check(
+        lambda t, w, b: torch.native_batch_norm(t, w, b, None, None, True, 0.1,
+                                                1e-5), x, weight, bias)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -0,0 +1,68 @@
+import sys
+
+import torch
+import torch_xla
+import torch_xla.core.xla_builder as xb
+import torch_xla.core.xla_model as xm
+import torch_xla.core.xla_op_registry as xor
+import unittest
+
+
+class XlaBuilderBatchTest(unittest.TestCase):
+
+  def test_op_codes(self):
+    codes = torch_xla._XLAC._xla_op_codes()
+    self.assertEqual(xb.op_code('Add'), codes['Add'])
+    self.assertEqual(len(set(codes.values())), len(codes))
+    with self.assertRaises(ValueError):
+      xb.op_code('NotAnOp')
+
+  def test_batch_matches_ops(self):
+
+    def op_fn(a, b):
+      return (a + b) * (a - b)
+
+    def batch_fn(a, b):
+      batch = xb.OpBatch(a.builder(), inputs=[a, b])
+      a, b = batch.input(0), batch.input(1)
+      s = batch.add('Add', (a, b))
+      d = batch.add('Sub', (a, b))
+      p = batch.add('Mul', (s, d))
+      return batch.create()[p]
+
+    device = xm.xla_device()
+    a = torch.randn(4, 5, device=device)
+    b = torch.randn(4, 5, device=device)
+    expected = xor.register('test_batch_ops', op_fn)(a, b)
+    result = xor.register('test_batch_batch', batch_fn)(a, b)
+    self.assertTrue(torch.allclose(result.cpu(), expected.cpu()))
+
+  def test_batch_attributes(self):
+
+    def batch_fn(a):
+      batch = xb.OpBatch(a.builder(), inputs=[a])
+      t = batch.add('Transpose', (batch.input(0),), permutation=(1, 0))
+      r = batch.add('Reshape', (t,), sizes=(20,))
+      return batch.create()[r]
+
+    device = xm.xla_device()
+    a = torch.randn(4, 5, device=device)
+    result = xor.register('test_batch_attributes', batch_fn)(a)
+    self.assertTrue(torch.allclose(result.cpu(), a.cpu().t().reshape(20)))
+
+  def test_batch_bad_operand(self):
+
+    def batch_fn(a):
+      batch = xb.OpBatch(a.builder(), inputs=[a])
+      batch.add('Add', (batch.input(0), 5))
+      return batch.create()[0]
+
+    device = xm.xla_device()
+    a = torch.randn(4, device=device)
+    with self.assertRaises(RuntimeError):
+      xor.register('test_batch_bad_operand', batch_fn)(a)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
@@ -59,6 +59,37 @@ class XlaZeRO1Test(TestCase):
     opt1.step()
     opt2.step()
 
+  @unittest.skipIf(xr.device_type() == 'TPU', "Crash on TPU")
+  @unittest.skipIf(xr.device_type() == 'CUDA', "Crash on CUDA")
+  def test_zero1_flatten_parameters(self):
+    device = xm.xla_device()
+
+    model1 = nn.Sequential(nn.Linear(8, 16), nn.ReLU(), nn.Linear(16, 4))
+    model2 = deepcopy(model1)
+    model1 = model1.to(device)
+    model2 = model2.to(device)
+    x = torch.ones((8, 8)).to(device)
+
+    opt1 = torch.optim.SGD(model1.parameters(), lr=0.01, momentum=0.9)
+    opt2 = ZeroRedundancyOptimizer(
+        model2.parameters(),
+        torch.optim.SGD,
+        lr=0.01,
+        momentum=0.9,
+        grad_clipping=False,
+        flatten_parameters=True)
+    # The four parameters are stepped as a single flat one.
+    self.assertEqual(len(opt2.base_optimizer.param_groups[0]['params']), 1)
+
+    for _ in range(3):
+      for model, opt in ((model1, opt1), (model2, opt2)):
+        opt.zero_grad()
+        model(x).sum().backward()
+        opt.step()
+      xm.mark_step()
+    for p1, p2 in zip(model1.parameters(), model2.parameters()):
+      self.assertEqual(p1.cpu(), p2.cpu())
+
 
 if __name__ == '__main__':
   test = unittest.main()
@@ -0,0 +1,48 @@
+import os
+import sys
+
+# The transfer mode is read once, so set it before importing torch_xla.
+os.environ['XLA_ZERO_COPY_HOST_TO_DEVICE'] = '1'
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+import torch_xla.debug.metrics as met
+import unittest
+
+
+class ZeroCopyTransferTest(unittest.TestCase):
+
+  def test_contiguous_tensor_is_not_copied(self):
+    met.clear_all()
+    t = torch.randn(8, 8)
+    xt = t.to(xm.xla_device())
+    self.assertEqual(met.counter_value('AtenSourceZeroCopy'), 1)
+    self.assertTrue(torch.allclose(xt.cpu(), t))
+
+  def test_non_contiguous_tensor_is_copied(self):
+    met.clear_all()
+    t = torch.randn(8, 8).t()
+    xt = t.to(xm.xla_device())
+    self.assertIsNone(met.counter_value('AtenSourceZeroCopy'))
+    self.assertTrue(torch.allclose(xt.cpu(), t))
+
+  def test_channels_last_tensor_is_not_copied(self):
+    met.clear_all()
+    t = torch.randn(2, 3, 4, 5).to(memory_format=torch.channels_last)
+    xt = t.to(xm.xla_device())
+    self.assertEqual(met.counter_value('AtenSourceChannelsLast'), 1)
+    self.assertEqual(met.counter_value('AtenSourceZeroCopy'), 1)
+    self.assertTrue(torch.allclose(xt.cpu(), t))
+
+  def test_fetch_writes_into_output_tensor(self):
+    t = torch.randn(16, 4)
+    xt = t.to(xm.xla_device())
+    met.clear_all()
+    self.assertTrue(torch.allclose(xt.cpu(), t))
+    self.assertEqual(met.counter_value('DirectTransferToTensor'), 1)
+
+
+if __name__ == '__main__':
+  test = unittest.main()
+  sys.exit(0 if test.result.wasSuccessful() else 1)
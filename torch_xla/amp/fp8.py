@@ -0,0 +1,169 @@
+"""FP8 linear layers with per-tensor delayed scaling.
+
+Within `fp8_autocast(recipe)`, the `torch.nn.functional.linear` calls on XLA
+tensors, which include the ones of `torch.nn.Linear`, run their forward and
+backward matmuls as scaled FP8 dots. The activations and the weights use the
+forward format (e4m3 by default) and the gradients the backward one (e5m2).
+
+Every tensor is scaled by the history of its absolute maxima over the previous
+steps (delayed scaling), kept on the device with the recipe, so that the scales
+are updated without synchronizing with the host.
+"""
+
+import contextlib
+
+import torch
+import torch_xla
+from torch.overrides import TorchFunctionMode
+from torch.utils.weak import WeakTensorKeyDictionary
+
+E4M3 = 'e4m3'
+E5M2 = 'e5m2'
+_FP8_MAX = {E4M3: 448.0, E5M2: 57344.0}
+
+
+class DelayedScaling(object):
+  """The recipe of the FP8 delayed scaling, which also holds the scaling state
+  of the linear layers run within `fp8_autocast(recipe)`. Reuse the same recipe
+  across the steps for the amax history to carry over.
+
+  Args:
+    margin (int): The scales leave a headroom of 2^margin below the largest
+      FP8 value (default: 0).
+    amax_history_len (int): The number of steps of absolute maxima the scales
+      are computed from (default: 16).
+    fwd_format (string): The FP8 format of the activations and the weights,
+      'e4m3' or 'e5m2' (default: 'e4m3').
+    bwd_format (string): The FP8 format of the output gradients (default:
+      'e5m2').
+  """
+
+  def __init__(self,
+               margin=0,
+               amax_history_len=16,
+               fwd_format=E4M3,
+               bwd_format=E5M2):
+    assert fwd_format in _FP8_MAX and bwd_format in _FP8_MAX
+    self.margin = margin
+    self.amax_history_len = amax_history_len
+    self.fwd_format = fwd_format
+    self.bwd_format = bwd_format
+    self._states = WeakTensorKeyDictionary()
+
+  def states(self, weight):
+    """Returns the input, weight and output gradient scaling states of the
+    linear layer of `weight`."""
+    states = self._states.get(weight, None)
+    if states is None:
+      states = (ScalingState(self, self.fwd_format, weight.device),
+                ScalingState(self, self.fwd_format, weight.device),
+                ScalingState(self, self.bwd_format, weight.device))
+      self._states[weight] = states
+    return states
+
+
+class ScalingState(object):
+  """The amax history and the scale of one tensor, on the device."""
+
+  def __init__(self, recipe, fp8_format, device):
+    self.fp8_format = fp8_format
+    self.margin = recipe.margin
+    self.amax_history = torch.zeros(recipe.amax_history_len, device=device)
+    self.scale = torch.ones((), device=device)
+
+  def record(self, amax):
+    """Pushes the `amax` of the latest step in the history, and derives from
+    the history the scale of the next step."""
+    self.amax_history = torch.cat(
+        [amax.reshape(1).float(), self.amax_history[:-1]])
+    history_max = torch.max(self.amax_history)
+    scale = _FP8_MAX[self.fp8_format] / history_max / (2**self.margin)
+    self.scale = torch.where((history_max > 0) & torch.isfinite(history_max),
+                             scale, self.scale)
+
+
+class _Fp8Linear(torch.autograd.Function):
+
+  @staticmethod
+  def forward(ctx, input, weight, input_state, weight_state, grad_state):
+    x = input.reshape(-1, input.shape[-1])
+    output, x_amax, w_amax = torch_xla._XLAC._xla_fp8_scaled_mm(
+        x, weight.t(), input_state.scale, weight_state.scale,
+        input_state.fp8_format, weight_state.fp8_format)
+    # The backward quantizes with the scales of this forward.
+    ctx.save_for_backward(x, weight, input_state.scale, weight_state.scale)
+    ctx.input_shape = input.shape
+    ctx.formats = (input_state.fp8_format, weight_state.fp8_format)
+    ctx.grad_state = grad_state
+    input_state.record(x_amax)
+    weight_state.record(w_amax)
+    return output.reshape(*input.shape[:-1], weight.shape[0])
+
+  @staticmethod
+  def backward(ctx, grad_output):
+    x, weight, x_scale, w_scale = ctx.saved_tensors
+    x_format, w_format = ctx.formats
+    grad_state = ctx.grad_state
+    g = grad_output.reshape(-1, grad_output.shape[-1]).to(x.dtype)
+    grad_input, g_amax, _ = torch_xla._XLAC._xla_fp8_scaled_mm(
+        g, weight, grad_state.scale, w_scale, grad_state.fp8_format, w_format)
+    grad_weight, _, _ = torch_xla._XLAC._xla_fp8_scaled_mm(
+        g.t(), x, grad_state.scale, x_scale, grad_state.fp8_format, x_format)
+    grad_state.record(g_amax)
+    return grad_input.reshape(ctx.input_shape), grad_weight, None, None, None
+
+
+def fp8_linear(input, weight, bias=None, states=None):
+  """The `torch.nn.functional.linear` of `input`, with FP8 matmuls scaled by
+  the (input, weight, output gradient) `states` of `DelayedScaling.states()`.
+  """
+  input_state, weight_state, grad_state = states
+  output = _Fp8Linear.apply(input, weight.to(input.dtype), input_state,
+                            weight_state, grad_state)
+  if bias is not None:
+    output = output + bias.to(output.dtype)
+  return output
+
+
+class _Fp8AutocastMode(TorchFunctionMode):
+
+  def __init__(self, recipe):
+    super().__init__()
+    self._recipe = recipe
+
+  def __torch_function__(self, func, types, args=(), kwargs=None):
+    kwargs = kwargs or {}
+    if func is torch.nn.functional.linear:
+      input, weight = args[0], args[1]
+      bias = args[2] if len(args) > 2 else kwargs.get('bias', None)
+      if (input.device.type == 'xla' and input.is_floating_point() and
+          input.dim() >= 1):
+        return fp8_linear(input, weight, bias, self._recipe.states(weight))
+    return func(*args, **kwargs)
+
+
+@contextlib.contextmanager
+def fp8_autocast(recipe=None, enabled=True):
+  """Runs the linear layers on XLA tensors with FP8 matmuls within the context.
+
+  The FP8 dots are lowered to the scaled FP8 matmuls of the hardware which
+  supports them, and are emulated otherwise. Combine with
+  `torch_xla.amp.autocast` for the other ops to run in bfloat16.
+
+  Args:
+    recipe (DelayedScaling): The scaling recipe and state, to be reused across
+      the steps (default: a new `DelayedScaling()`).
+    enabled (bool): Whether the FP8 linear layers are enabled (default: True).
+
+  Example:
+    >>> recipe = DelayedScaling()
+    >>> for data, target in loader:
+    ...   with fp8_autocast(recipe):
+    ...     loss = loss_fn(model(data), target)
+    ...   loss.backward()
+  """
+  if not enabled:
+    yield
+    return
+  with _Fp8AutocastMode(recipe if recipe is not None else DelayedScaling()):
+    yield
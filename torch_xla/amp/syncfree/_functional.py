@@ -1,45 +1,166 @@
+import collections
 import torch
 from torch import Tensor
 import torch_xla
-from typing import List, Optional
+from typing import List, Optional, Tuple
+
+
+def sparse_grad(param: Tensor) -> Optional[Tuple[Tensor, Tensor]]:
+  r"""Returns the row-sparse gradient of `param`, as the (rows, values) left by
+  the `sparse=True` lookups of `torch_xla.core.functions`, or None.
+  """
+  return getattr(param, 'sparse_grad', None)
+
+
+def has_sparse_grads(param_groups) -> bool:
+  return any(
+      sparse_grad(p) is not None
+      for group in param_groups
+      for p in group['params'])
+
+
+def unscale_and_clip_grads(
+    found_inf: Tensor,
+    param_groups,
+    inv_scale: Optional[Tensor] = None,
+    max_norm: Optional[float] = None
+) -> Tuple[Optional[Tensor], Optional[Tensor]]:
+  r"""Prepares the AMP unscale and the global norm clipping of the gradients of
+  `param_groups`, to be folded into the optimizer updates.
+
+  A single pass over the gradients checks them for non-finite values, setting
+  `found_inf` in place, and computes their global norm once multiplied by
+  `inv_scale`. The gradients are not written back: the returned scale is
+  applied to them within the updates, which `found_inf` gates on the device.
+  Returns the scale of the gradients and their norm, or (None, None) if
+  neither `inv_scale` nor `max_norm` is given. The norm of a row-sparse
+  gradient is the norm of its values, with the duplicate rows not coalesced.
+  """
+  if inv_scale is None and max_norm is None:
+    return None, None
+  grads = []
+  for group in param_groups:
+    for p in group['params']:
+      grad = p.grad if p.grad is not None else sparse_grad(p)
+      if grad is not None:
+        grads.append(grad[1] if isinstance(grad, tuple) else grad)
+  if not grads:
+    return None, None
+  if inv_scale is None:
+    inv_scale = torch.ones((), device=found_inf.device)
+  norm = torch_xla._XLAC._xla_foreach_grad_norm_(found_inf, inv_scale, grads)
+  grad_scale = inv_scale.float()
+  if max_norm is not None:
+    grad_scale = grad_scale * torch.clamp(max_norm / (norm + 1e-6), max=1.0)
+  return grad_scale, norm
+
+
+def _scaled(grad: Tensor, grad_scale: Optional[Tensor]) -> Tensor:
+  if grad_scale is None:
+    return grad
+  return grad * grad_scale.to(grad.dtype)
+
+
+def _group_by_dtype(params: List[Tensor], indices: List[int]):
+  groups = collections.defaultdict(list)
+  for i in indices:
+    groups[params[i].dtype].append(i)
+  return groups.values()
 
 
 def adam_step(found_inf: Tensor, state_steps: List[Tensor],
               params: List[Tensor], grads: List[Tensor], exp_avgs: List[Tensor],
               exp_avg_sqs: List[Tensor], max_exp_avg_sqs: List[Tensor], *,
               amsgrad: bool, beta1: float, beta2: float, lr: float,
-              weight_decay: float, eps: float, maximize: bool, use_adamw: bool):
+              weight_decay: float, eps: float, maximize: bool, use_adamw: bool,
+              foreach: bool = False, grad_scale: Optional[Tensor] = None):
   r"""Functional API that performs PT-XLA sync-free Adam/AdamW algorithm computation
+
+  With `foreach`, the params of each dtype with a dense gradient are updated
+  together, as a single flattened buffer. The gradients are multiplied by the
+  scalar `grad_scale`, as returned by unscale_and_clip_grads(), if given.
    """
 
+  foreach_indices = []
   for i, param in enumerate(params):
     grad = grads[i]
     exp_avg = exp_avgs[i]
     exp_avg_sq = exp_avg_sqs[i]
     step = state_steps[i]
     max_exp_avg_sq = max_exp_avg_sqs[i]
-    torch_xla._XLAC._xla_adam_optimizer_step_(found_inf, step, param, grad,
+    if isinstance(grad, tuple):
+      rows, values = grad
+      torch_xla._XLAC._xla_sparse_adam_optimizer_step_(
+          found_inf, step, param, rows, _scaled(values, grad_scale), exp_avg,
+          exp_avg_sq,
+          max_exp_avg_sq, beta1, beta2, lr, weight_decay, eps, amsgrad,
+          maximize, use_adamw)
+      param.sparse_grad = None
+      continue
+    if foreach:
+      foreach_indices.append(i)
+      continue
+    torch_xla._XLAC._xla_adam_optimizer_step_(found_inf, step, param,
+                                              _scaled(grad, grad_scale),
                                               exp_avg, exp_avg_sq,
                                               max_exp_avg_sq, beta1, beta2, lr,
                                               weight_decay, eps, amsgrad,
                                               maximize, use_adamw)
+  if grad_scale is None:
+    grad_scale = torch.ones_like(found_inf)
+  for indices in _group_by_dtype(params, foreach_indices):
+    torch_xla._XLAC._xla_foreach_adam_optimizer_step_(
+        found_inf, grad_scale, [state_steps[i] for i in indices],
+        [params[i] for i in indices], [grads[i] for i in indices],
+        [exp_avgs[i] for i in indices], [exp_avg_sqs[i] for i in indices],
+        [max_exp_avg_sqs[i] for i in indices], beta1, beta2, lr, weight_decay,
+        eps, amsgrad, maximize, use_adamw)
 
 
 def sgd_step(found_inf: Tensor, state_steps: List[Tensor], params: List[Tensor],
              d_p_list: List[Tensor],
              momentum_buffer_list: List[Optional[Tensor]], *,
              weight_decay: float, momentum: float, lr: float, dampening: float,
-             nesterov: bool, maximize: bool):
+             nesterov: bool, maximize: bool, foreach: bool = False,
+             grad_scale: Optional[Tensor] = None):
   r"""Functional API that performs PT-XLA sync-free SGD algorithm computation.
+
+  With `foreach`, the params of each dtype with a dense gradient are updated
+  together, as a single flattened buffer. The gradients are multiplied by the
+  scalar `grad_scale`, as returned by unscale_and_clip_grads(), if given.
         """
 
+  foreach_indices = []
   for i, param in enumerate(params):
     d_p = d_p_list[i]
     buf = momentum_buffer_list[i]
     step = state_steps[i]
+    if isinstance(d_p, tuple):
+      if buf is None:
+        buf = torch.zeros_like(param)
+        momentum_buffer_list[i] = buf
+      rows, values = d_p
+      torch_xla._XLAC._xla_sparse_sgd_optimizer_step_(
+          found_inf, step, param, buf, rows, _scaled(values, grad_scale),
+          weight_decay, momentum, lr, dampening, nesterov, maximize)
+      param.sparse_grad = None
+      continue
     if buf is None:
-      buf = torch.clone(d_p).detach()
+      buf = torch.clone(_scaled(d_p, grad_scale)).detach()
       momentum_buffer_list[i] = buf
-    torch_xla._XLAC._xla_sgd_optimizer_step_(found_inf, step, param, buf, d_p,
+    if foreach:
+      foreach_indices.append(i)
+      continue
+    torch_xla._XLAC._xla_sgd_optimizer_step_(found_inf, step, param, buf,
+                                             _scaled(d_p, grad_scale),
                                              weight_decay, momentum, lr,
                                              dampening, nesterov, maximize)
+  if grad_scale is None:
+    grad_scale = torch.ones_like(found_inf)
+  for indices in _group_by_dtype(params, foreach_indices):
+    torch_xla._XLAC._xla_foreach_sgd_optimizer_step_(
+        found_inf, grad_scale, [state_steps[i] for i in indices],
+        [params[i] for i in indices],
+        [momentum_buffer_list[i] for i in indices],
+        [d_p_list[i] for i in indices], weight_decay, momentum, lr, dampening,
+        nesterov, maximize)
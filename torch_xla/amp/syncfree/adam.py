@@ -28,6 +28,9 @@ class Adam(torch.optim.Adam):
             (default: False)
         maximize (bool, optional): maximize the params based on the objective, instead of
             minimizing (default: False)
+        foreach (bool, optional): update the params of each dtype with a single
+            fused step over their flattened concatenation, for smaller graphs
+            (default: None)
 
     .. _Adam\: A Method for Stochastic Optimization:
         https://arxiv.org/abs/1412.6980
@@ -38,7 +41,11 @@ class Adam(torch.optim.Adam):
     """
 
   @torch.no_grad()
-  def step(self, closure=None, found_inf: Tensor = None):
+  def step(self,
+           closure=None,
+           found_inf: Tensor = None,
+           inv_scale: Tensor = None,
+           max_norm: float = None):
     """Performs a single optimization step.
 
         Args:
@@ -47,9 +54,18 @@ class Adam(torch.optim.Adam):
             found_inf (torch.Tensor, optional): A scalar tensor indicates if
                 the optimizer.step should be performed (found_inf is 0 or None) or
                 skipped (found_inf == 1).
+            inv_scale (torch.Tensor, optional): A scalar tensor the gradients
+                are multiplied by within the step, the inverse of the AMP loss
+                scale. Non-finite unscaled gradients set `found_inf`, in place.
+            max_norm (float, optional): Clips the global norm of the unscaled
+                gradients of all the param groups to `max_norm`, within the
+                step. The gradients themselves are left untouched.
         """
     if found_inf is None:
-      return super(Adam, self).step(closure=closure)
+      if (inv_scale is None and max_norm is None and
+          not F.has_sparse_grads(self.param_groups)):
+        return super(Adam, self).step(closure=closure)
+      found_inf = torch.zeros((), device=xm.xla_device())
 
     if found_inf.shape:
       raise ValueError("The found_inf tensor has to be scalar type")
@@ -58,6 +74,8 @@ class Adam(torch.optim.Adam):
     if closure is not None:
       with torch.enable_grad():
         loss = closure()
+    grad_scale, _ = F.unscale_and_clip_grads(found_inf, self.param_groups,
+                                             inv_scale, max_norm)
     for group in self.param_groups:
       params_with_grad = []
       grads = []
@@ -68,13 +86,14 @@ class Adam(torch.optim.Adam):
       beta1, beta2 = group['betas']
 
       for p in group['params']:
-        if p.grad is not None:
+        grad = p.grad if p.grad is not None else F.sparse_grad(p)
+        if grad is not None:
           params_with_grad.append(p)
-          if p.grad.is_sparse:
+          if p.grad is not None and p.grad.is_sparse:
             raise RuntimeError(
                 'Adam does not support sparse gradients, please consider SparseAdam instead'
             )
-          grads.append(p.grad)
+          grads.append(grad)
 
           state = self.state[p]
 
@@ -117,6 +136,8 @@ class Adam(torch.optim.Adam):
           weight_decay=group['weight_decay'],
           eps=group['eps'],
           maximize=group['maximize'],
-          use_adamw=False)
+          use_adamw=False,
+          foreach=bool(group.get('foreach')),
+          grad_scale=grad_scale)
 
     return loss
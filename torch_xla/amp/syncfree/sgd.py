@@ -1,5 +1,6 @@
 import torch
 from torch import Tensor
+import torch_xla.core.xla_model as xm
 from . import _functional as F
 
 
@@ -24,6 +25,9 @@ class SGD(torch.optim.SGD):
         nesterov (bool, optional): enables Nesterov momentum (default: False)
         maximize (bool, optional): maximize the params based on the objective, instead of
             minimizing (default: False)
+        foreach (bool, optional): update the params of each dtype with a single
+            fused step over their flattened concatenation, for smaller graphs
+            (default: None)
 
     Example:
         >>> optimizer = torch.optim.SGD(model.parameters(), lr=0.1, momentum=0.9)
@@ -35,7 +39,11 @@ class SGD(torch.optim.SGD):
     """
 
   @torch.no_grad()
-  def step(self, closure=None, found_inf: Tensor = None):
+  def step(self,
+           closure=None,
+           found_inf: Tensor = None,
+           inv_scale: Tensor = None,
+           max_norm: float = None):
     """Performs a single optimization step.
 
         Args:
@@ -44,9 +52,18 @@ class SGD(torch.optim.SGD):
             found_inf (torch.Tensor, optional): A scalar tensor indicates if
                 the optimizer.step should be performed (found_inf is 0 or None) or
                 skipped (found_inf != 0).
+            inv_scale (torch.Tensor, optional): A scalar tensor the gradients
+                are multiplied by within the step, the inverse of the AMP loss
+                scale. Non-finite unscaled gradients set `found_inf`, in place.
+            max_norm (float, optional): Clips the global norm of the unscaled
+                gradients of all the param groups to `max_norm`, within the
+                step. The gradients themselves are left untouched.
         """
     if found_inf is None:
-      return super(SGD, self).step(closure=closure)
+      if (inv_scale is None and max_norm is None and
+          not F.has_sparse_grads(self.param_groups)):
+        return super(SGD, self).step(closure=closure)
+      found_inf = torch.zeros((), device=xm.xla_device())
 
     if found_inf.shape:
       raise ValueError("The found_inf tensor has to be scalar type")
@@ -55,6 +72,8 @@ class SGD(torch.optim.SGD):
     if closure is not None:
       with torch.enable_grad():
         loss = closure()
+    grad_scale, _ = F.unscale_and_clip_grads(found_inf, self.param_groups,
+                                             inv_scale, max_norm)
     for group in self.param_groups:
       params_with_grad = []
       d_p_list = []
@@ -68,9 +87,10 @@ class SGD(torch.optim.SGD):
       lr = group['lr']
 
       for p in group['params']:
-        if p.grad is not None:
+        grad = p.grad if p.grad is not None else F.sparse_grad(p)
+        if grad is not None:
           params_with_grad.append(p)
-          d_p_list.append(p.grad)
+          d_p_list.append(grad)
 
           state = self.state[p]
           if 'step' not in state:
@@ -94,6 +114,8 @@ class SGD(torch.optim.SGD):
           dampening=dampening,
           nesterov=nesterov,
           maximize=maximize,
+          foreach=bool(group.get('foreach')),
+          grad_scale=grad_scale,
       )
 
       # update momentum_buffers in state
@@ -428,6 +428,8 @@ def extract_internal(xla_model: torch.fx.GraphModule):
    dumb_return_handler, xla_args_need_update) = extract_graph_helper(xla_model)
   skip_checking_input_sharding_threashold = xu.getenv_as(
       'XLA_DYNAMO_INPUT_SHARDING_CHECK_THRESHOLD', int, 5)
+  # Resolves the cached computation and its outputs once for all the calls.
+  call_plan = None
 
   def optimized_mod(*args: tuple):
     nonlocal xla_model
@@ -440,6 +442,7 @@ def extract_internal(xla_model: torch.fx.GraphModule):
     nonlocal dumb_return_handler
     nonlocal xla_args_need_update
     nonlocal skip_checking_input_sharding_threashold
+    nonlocal call_plan
 
     original_device: torch.device = _get_input_arg_device(args)
     is_cuda_args: bool = False
@@ -476,6 +479,7 @@ def extract_internal(xla_model: torch.fx.GraphModule):
            arg_index_to_need_update_index, none_remover, graph_input_matcher,
            dumb_return_handler,
            xla_args_need_update) = extract_graph_helper(xla_model)
+          call_plan = None
           skip_checking_input_sharding_threashold = xu.getenv_as(
               'XLA_DYNAMO_INPUT_SHARDING_CHECK_THRESHOLD', int, 5)
         else:
@@ -487,7 +491,9 @@ def extract_internal(xla_model: torch.fx.GraphModule):
 
     graph_input = graph_input_matcher(args)
     start_ts = time.time()
-    res = torch_xla._XLAC._run_cached_graph(graph_hash, graph_input)
+    if call_plan is None:
+      call_plan = torch_xla._XLAC._xla_create_call_plan(graph_hash)
+    res = call_plan(graph_input)
     res = dumb_return_handler.addDumbReturn(args, res)
 
     assert len(res) == len(args_and_out), f"{len(res)} v.s. {len(args_and_out)}"
@@ -508,6 +514,7 @@ def extract_internal(xla_model: torch.fx.GraphModule):
     else:
       return result
 
+  optimized_mod.get_graph_hash = lambda: graph_hash
   if dynamo_debug:
     print(
         '=================== OpenXLA Dynamo Compile Debug End =====================\n'
@@ -1,6 +1,10 @@
+import importlib.util
+import math
+
 import torch
 import torch_xla
 import torch_xla.core.xla_model as xm
+import torch_xla.runtime as xr
 
 
 class AllReduce(torch.autograd.Function):
@@ -84,6 +88,671 @@ def all_gather(value, dim=0):
   return AllGather.apply(value, dim)
 
 
+class RingAttention(torch.autograd.Function):
+
+  @staticmethod
+  def forward(ctx, query, key, value, scale, causal, groups):
+    ctx.scale, ctx.causal, ctx.groups = scale, causal, groups
+    token, devctx = xm._get_all_reduce_token()
+    output, logsumexp, token = torch_xla._XLAC._xla_ring_attention(
+        query, key, value, token, scale, causal, groups)
+    torch_xla._XLAC._set_all_reduce_token(devctx.device, token)
+    ctx.save_for_backward(query, key, value, output, logsumexp)
+    return output
+
+  @staticmethod
+  def backward(ctx, grad_output):
+    query, key, value, output, logsumexp = ctx.saved_tensors
+    token, devctx = xm._get_all_reduce_token()
+    grad_query, grad_key, grad_value, token = (
+        torch_xla._XLAC._xla_ring_attention_backward(query, key, value, output,
+                                                     logsumexp, grad_output,
+                                                     token, ctx.scale,
+                                                     ctx.causal, ctx.groups))
+    torch_xla._XLAC._set_all_reduce_token(devctx.device, token)
+    return grad_query, grad_key, grad_value, None, None, None
+
+
+def ring_attention(query, key, value, groups=None, causal=False, scale=None):
+  """Computes the attention over a sequence split in blocks across replicas.
+
+  The i-th replica of a ring holds the i-th blocks of the queries, keys and
+  values of the sequence. The key and value blocks travel around the ring with
+  XLA `CollectivePermute()` operations, each one overlapping the attention of
+  the blocks at hand, and the softmax is accumulated blockwise, so no replica
+  ever holds the whole sequence. Supports autograd differentiation.
+
+  Args:
+    query (torch.Tensor): The `[..., block_length, head_dim]` query block.
+    key (torch.Tensor): The `[..., block_length, head_dim]` key block.
+    value (torch.Tensor): The `[..., block_length, value_dim]` value block.
+    groups (list, optional): A list of list, representing the rings of
+      replicas, all of the same size, in the order of their blocks. If `None`
+      there will be only one ring with all the replicas in it.
+    causal (bool): Whether each query only attends to the keys up to its own
+      position in the sequence.
+      Default: False
+    scale (float, optional): The scale of the attention scores. If `None`, it is
+      `1 / sqrt(head_dim)`.
+  Returns:
+    The `[..., block_length, value_dim]` attention output block.
+  """
+  if groups is None:
+    groups = [list(range(xm.xrt_world_size()))]
+  if scale is None:
+    scale = 1.0 / math.sqrt(query.size(-1))
+  return RingAttention.apply(query, key, value, scale, causal, groups)
+
+
+
+class FlashAttention(torch.autograd.Function):
+
+  @staticmethod
+  def forward(ctx, query, key, value, scale, causal, block_size):
+    ctx.scale, ctx.causal, ctx.block_size = scale, causal, block_size
+    output, logsumexp = torch_xla._XLAC._xla_flash_attention(
+        query, key, value, scale, causal, block_size)
+    ctx.save_for_backward(query, key, value, output, logsumexp)
+    return output
+
+  @staticmethod
+  def backward(ctx, grad_output):
+    query, key, value, output, logsumexp = ctx.saved_tensors
+    grad_query, grad_key, grad_value = (
+        torch_xla._XLAC._xla_flash_attention_backward(
+            query, key, value, output, logsumexp, grad_output, ctx.scale,
+            ctx.causal, ctx.block_size))
+    return grad_query, grad_key, grad_value, None, None, None
+
+
+def _use_pallas_flash_attention(query, key, value, causal):
+  # The Pallas kernel takes [batch, heads, length, head_dim] inputs with
+  # lengths multiple of its minimum block, and masks the causal scores of
+  # equal query and key lengths only.
+  if xr.device_type() != 'TPU' or importlib.util.find_spec('jax') is None:
+    return False
+  if query.dim() != 4 or query.size(-1) != value.size(-1):
+    return False
+  if causal and query.size(-2) != key.size(-2):
+    return False
+  return query.size(-2) % 128 == 0 and key.size(-2) % 128 == 0
+
+
+def scaled_dot_product_attention(query,
+                                 key,
+                                 value,
+                                 is_causal=False,
+                                 scale=None,
+                                 block_size=512):
+  """Computes the attention without materializing the attention matrix.
+
+  The keys and values are visited in blocks of `block_size` rows and the
+  softmax is accumulated blockwise, so the memory of the scores grows linearly
+  with the sequence length. The backward recomputes the scores of every block
+  from the saved log-sum-exp of the rows. On TPU, the inputs supported by the
+  Pallas flash attention kernel are dispatched to it. Supports autograd
+  differentiation.
+
+  Args:
+    query (torch.Tensor): The `[..., query_length, head_dim]` queries.
+    key (torch.Tensor): The `[..., key_length, head_dim]` keys.
+    value (torch.Tensor): The `[..., key_length, value_dim]` values.
+    is_causal (bool): Whether the i-th query only attends to the keys up to
+      the i-th, as in `torch.nn.functional.scaled_dot_product_attention()`.
+      Default: False
+    scale (float, optional): The scale of the attention scores. If `None`, it is
+      `1 / sqrt(head_dim)`.
+    block_size (int): The number of key rows attended to at a time.
+      Default: 512
+  Returns:
+    The `[..., query_length, value_dim]` attention output.
+  """
+  if scale is None:
+    scale = 1.0 / math.sqrt(query.size(-1))
+  if _use_pallas_flash_attention(query, key, value, is_causal):
+    from torch_xla.experimental.custom_kernel import flash_attention
+    return flash_attention(query, key, value, causal=is_causal, sm_scale=scale)
+  return FlashAttention.apply(query, key, value, scale, is_causal, block_size)
+
+
+class GroupedMatmul(torch.autograd.Function):
+
+  @staticmethod
+  def forward(ctx, lhs, rhs, group_sizes, tile_rows):
+    ctx.tile_rows = tile_rows
+    ctx.save_for_backward(lhs, rhs, group_sizes)
+    return torch_xla._XLAC._xla_grouped_matmul(lhs, rhs, group_sizes, False,
+                                               tile_rows)
+
+  @staticmethod
+  def backward(ctx, grad_output):
+    lhs, rhs, group_sizes = ctx.saved_tensors
+    grad_lhs = grad_rhs = None
+    if ctx.needs_input_grad[0]:
+      grad_lhs = torch_xla._XLAC._xla_grouped_matmul(grad_output, rhs,
+                                                     group_sizes, True,
+                                                     ctx.tile_rows)
+    if ctx.needs_input_grad[1]:
+      grad_rhs = torch_xla._XLAC._xla_transposed_grouped_matmul(
+          lhs, grad_output, group_sizes, ctx.tile_rows)
+    return grad_lhs, grad_rhs, None, None
+
+
+def _use_pallas_gmm(lhs, rhs):
+  # The megablox kernel tiles the m, k and n dimensions by multiples of 128.
+  if xr.device_type() != 'TPU' or importlib.util.find_spec('jax') is None:
+    return False
+  return all(size % 128 == 0 for size in (lhs.size(0), lhs.size(1),
+                                          rhs.size(2)))
+
+
+def grouped_matmul(lhs, rhs, group_sizes, tile_rows=128):
+  """Multiplies the rows of each group with the matrix of the group.
+
+  The rows of `lhs` are sorted by group, like the tokens routed to the experts
+  of a mixture of experts layer, and the i-th group holds the `group_sizes[i]`
+  rows following the ones of the previous groups. The rows are visited in tiles
+  of `tile_rows` rows, each multiplied with the matrices of the groups of its
+  rows only, so the groups are neither padded to a common capacity nor
+  multiplied with the rows of the other groups. The rows beyond the sum of the
+  group sizes are zeros. On TPU, the inputs supported by the Pallas megablox
+  kernel are dispatched to it. Supports autograd differentiation.
+
+  Args:
+    lhs (torch.Tensor): The `[m, k]` rows, sorted by group.
+    rhs (torch.Tensor): The `[groups, k, n]` matrices of the groups.
+    group_sizes (torch.Tensor): The `[groups]` integer number of rows of each
+      group.
+    tile_rows (int): The number of rows multiplied at a time.
+      Default: 128
+  Returns:
+    The `[m, n]` products of the rows with the matrices of their groups.
+  """
+  if _use_pallas_gmm(lhs, rhs):
+    from torch_xla.experimental.custom_kernel import GMM
+    return GMM.apply(lhs, rhs, group_sizes.to(torch.int32))
+  return GroupedMatmul.apply(lhs, rhs, group_sizes, tile_rows)
+
+
+_REDUCTIONS = {'none': 0, 'mean': 1, 'sum': 2}
+
+
+class ChunkedCrossEntropy(torch.autograd.Function):
+
+  @staticmethod
+  def forward(ctx, input, target, reduction, ignore_index, chunk_size):
+    ctx.reduction, ctx.ignore_index = reduction, ignore_index
+    ctx.chunk_size = chunk_size
+    loss, logsumexp = torch_xla._XLAC._xla_chunked_cross_entropy(
+        input, target, reduction, ignore_index, chunk_size)
+    ctx.save_for_backward(input, target, logsumexp)
+    return loss
+
+  @staticmethod
+  def backward(ctx, grad_output):
+    input, target, logsumexp = ctx.saved_tensors
+    grad_input = torch_xla._XLAC._xla_chunked_cross_entropy_backward(
+        grad_output, input, target, logsumexp, ctx.reduction,
+        ctx.ignore_index, ctx.chunk_size)
+    return grad_input, None, None, None, None
+
+
+def cross_entropy(input,
+                  target,
+                  ignore_index=-100,
+                  reduction='mean',
+                  chunk_size=8192):
+  """Computes the cross entropy loss of the logits `input` for the class
+  indices `target`, like `torch.nn.functional.cross_entropy()`.
+
+  The log-softmax is fused with the loss and the classes are visited in chunks
+  of `chunk_size`, so the `[..., num_classes]` log-probabilities are never
+  materialized, neither in the forward nor in the backward, which is where the
+  memory of the losses over large vocabularies goes. Supports autograd
+  differentiation.
+
+  Args:
+    input (torch.Tensor): The `[..., num_classes]` logits.
+    target (torch.Tensor): The `[...]` class indices.
+    ignore_index (int): The target value whose rows do not contribute to the
+      loss nor to the mean. Default: -100
+    reduction (string): One of 'none', 'mean' or 'sum'. Default: 'mean'
+    chunk_size (int): The number of classes processed at a time.
+      Default: 8192
+  Returns:
+    The loss, of the `target` shape if `reduction` is 'none', else a scalar.
+  """
+  loss = ChunkedCrossEntropy.apply(
+      input.reshape(-1, input.size(-1)), target.reshape(-1),
+      _REDUCTIONS[reduction], ignore_index, chunk_size)
+  return loss.view(target.shape) if reduction == 'none' else loss
+
+
+class DropoutAddLayerNorm(torch.autograd.Function):
+
+  @staticmethod
+  def forward(ctx, input, residual, weight, bias, p, eps, recompute_mask):
+    ctx.p = p
+    results = torch_xla._XLAC._xla_dropout_add_layer_norm(
+        input, residual, weight, bias, p, eps, not recompute_mask)
+    output, sum, mean, rstd, seed = results[:5]
+    mask = None if recompute_mask else results[5]
+    ctx.save_for_backward(sum, weight, mean, rstd, seed, mask)
+    return output, sum
+
+  @staticmethod
+  def backward(ctx, grad_output, grad_sum):
+    sum, weight, mean, rstd, seed, mask = ctx.saved_tensors
+    grad_input, grad_residual, grad_weight, grad_bias = (
+        torch_xla._XLAC._xla_dropout_add_layer_norm_backward(
+            grad_output, grad_sum, sum, weight, mean, rstd, seed, mask,
+            ctx.p))
+    return grad_input, grad_residual, grad_weight, grad_bias, None, None, None
+
+
+def dropout_add_layer_norm(input,
+                           residual,
+                           weight,
+                           bias,
+                           p=0.1,
+                           eps=1e-5,
+                           training=True,
+                           recompute_mask=True):
+  """Computes `layer_norm(dropout(input, p) + residual)` over the last
+  dimension, as one fused op, the pre-norm pattern of the transformer blocks.
+
+  The dropout, the addition and the layer norm run in a single pass over the
+  activations, and with `recompute_mask` the backward draws the dropout mask
+  again from the seed of the forward instead of keeping it alive, which saves
+  the memory of one activation. Supports autograd differentiation.
+
+  Args:
+    input (torch.Tensor): The `[..., features]` input of the dropout.
+    residual (torch.Tensor): The residual added to the dropout output, of the
+      `input` shape.
+    weight (torch.Tensor): The `[features]` layer norm weight.
+    bias (torch.Tensor): The `[features]` layer norm bias.
+    p (float): The dropout probability. Default: 0.1
+    eps (float): The layer norm epsilon. Default: 1e-5
+    training (bool): Whether the dropout is applied. Default: True
+    recompute_mask (bool): Whether the backward draws the dropout mask again
+      rather than saving it. Default: True
+  Returns:
+    The layer norm output and the `dropout(input) + residual` sum, the residual
+    of the next block.
+  """
+  return DropoutAddLayerNorm.apply(input, residual, weight, bias,
+                                   p if training else 0.0, eps,
+                                   recompute_mask)
+
+
+class MaskedScaledSoftmax(torch.autograd.Function):
+
+  @staticmethod
+  def forward(ctx, input, mask, scale, is_causal):
+    output = torch_xla._XLAC._xla_masked_scaled_softmax(input, mask, scale,
+                                                        is_causal)
+    ctx.scale = scale
+    ctx.save_for_backward(output)
+    return output
+
+  @staticmethod
+  def backward(ctx, grad_output):
+    output, = ctx.saved_tensors
+    grad_input = torch_xla._XLAC._xla_masked_scaled_softmax_backward(
+        grad_output, output, ctx.scale)
+    return grad_input, None, None, None
+
+
+def masked_scaled_softmax(input, mask=None, scale=1.0, is_causal=False):
+  """Computes `softmax(input * scale + mask, dim=-1)` as one fused op, the
+  attention probabilities of the scores `input`.
+
+  The scaling, the masking and the softmax run in a single pass, and the causal
+  mask is computed within the op, so that no `[S, S]` mask tensor is kept in
+  the device memory. The positions which are all masked get NaN probabilities.
+  Supports autograd differentiation, with respect to `input`.
+
+  Args:
+    input (torch.Tensor): The `[..., L, S]` attention scores.
+    mask (torch.Tensor, optional): A boolean mask, True for the positions which
+      take part in the attention, or a floating point one added to the scaled
+      scores. It broadcasts to `input` by its trailing dimensions.
+      Default: None
+    scale (float): The scale of the scores. Default: 1.0
+    is_causal (bool): Whether the positions past the diagonal of the last two
+      dimensions are masked. Default: False
+  Returns:
+    The probabilities, of the `input` shape.
+  """
+  return MaskedScaledSoftmax.apply(input, mask, scale, is_causal)
+
+
+def approx_topk(input, k, dim=-1, largest=True, recall_target=0.95):
+  """Returns the sorted top `k` values of `input` along `dim`, and their
+  indices, faster than `torch.topk` for a small `k` over a large dimension,
+  like the sampling over the vocabulary logits of a language model.
+
+  With a `recall_target` below 1, this is the XLA approximate top-k. It
+  returns `k` values, but on TPU some of the true top-k can be replaced by
+  smaller ones, the expected fraction of the true top-k it returns being at
+  least `recall_target`. On the other devices it is exact. With a
+  `recall_target` of 1 it is exact everywhere, and sorts chunks of the
+  dimension rather than all of it. The exact results break ties by the lower
+  index. The results are not differentiable.
+
+  Args:
+    input (torch.Tensor): The input tensor.
+    k (int): The number of values to return.
+    dim (int): The dimension to select the values along. Default: -1
+    largest (bool): Whether the largest values are selected, rather than the
+      smallest ones. Default: True
+    recall_target (float): The expected recall, in (0, 1]. Default: 0.95
+  Returns:
+    The values and their Long indices, with `k` elements along `dim`.
+  """
+  return torch_xla._XLAC._xla_approx_topk(input, k, dim, largest,
+                                          recall_target)
+
+
+def _sampling_param(value, logits):
+  if isinstance(value, torch.Tensor):
+    return value.to(device=logits.device, dtype=torch.float32)
+  return torch.tensor(value, dtype=torch.float32, device=logits.device)
+
+
+def sample_tokens(logits, temperature=1.0, top_k=0, top_p=None):
+  """Samples a token id from each row of `logits` with the temperature, top-k
+  and top-p (nucleus) sampling, as one op.
+
+  The sample is the argmax of the logits perturbed by Gumbel noise, rather than
+  a multinomial draw over the cumulative distribution, so that a decoding step
+  builds no vocabulary sized intermediate beyond the noise. With `top_k` only
+  the `top_k` largest logits are candidates, found without sorting the whole
+  vocabulary. With `top_p` the candidates are cut to the fewest of the most
+  likely ones whose probability sums to `top_p`; without `top_k` this sorts the
+  vocabulary. The `temperature` and `top_p` are tensor operands, so changing
+  their values does not recompile the graph for the next step.
+
+  Args:
+    logits (torch.Tensor): The `[..., V]` logits.
+    temperature (float or torch.Tensor): The sampling temperature, a scalar or
+      one per row of shape `[...]`. A temperature of 0 picks the most likely
+      token. Default: 1.0
+    top_k (int): The number of largest logits to sample from, 0 for all of
+      them. Default: 0
+    top_p (float or torch.Tensor, optional): The cumulative probability of the
+      candidates, a scalar or one per row. Default: None
+  Returns:
+    The Long `[...]` token ids.
+  """
+  if top_p is not None:
+    top_p = _sampling_param(top_p, logits)
+  return torch_xla._XLAC._xla_sample_tokens(
+      logits, _sampling_param(temperature, logits), top_k, top_p)
+
+
+def _as_position(position, device):
+  if not isinstance(position, torch.Tensor):
+    position = torch.tensor(position, dtype=torch.int32, device=device)
+  return position
+
+
+def kv_cache_update_(cache, update, position, dim):
+  """Writes `update` into `cache` in place, from `position` along `dim`.
+
+  The write is a dynamic update slice of the cache, with the position as a
+  tensor operand, so that the graph of a decoding step is the same whatever
+  position it writes. As the cache is updated in place, its buffer is donated
+  to the updated cache at the step barrier, and a step costs the size of the
+  update rather than a copy of the whole cache.
+
+  Args:
+    cache (torch.Tensor): The cache, on the XLA device.
+    update (torch.Tensor): The values to write, of the shape of the cache but
+      along `dim`.
+    position (int or torch.Tensor): The index along `dim` of the first value
+      written, an integer scalar. A position which would not fit the update is
+      clamped to the last one which does.
+    dim (int): The dimension along which to write.
+  Returns:
+    The `cache`.
+  """
+  torch_xla._XLAC._xla_kv_cache_update_(cache, update,
+                                        _as_position(position, cache.device),
+                                        dim)
+  return cache
+
+
+def kv_cache_rollback_(cache, position, accepted, window, dim):
+  """Rolls back the rejected tail of a window written into `cache` in place.
+
+  A speculative decoding step writes the `window` entries of the draft tokens
+  from `position` along `dim` with `kv_cache_update_()`, scores them with the
+  target model, and keeps the `accepted` first ones. The rollback zeroes the
+  entries [position + accepted, position + window), slicing and writing back
+  the window only, so that the rejected tokens cost neither a copy of the cache
+  nor a new graph: the position and the accepted count are device scalars, and
+  the graph is keyed by the window size alone.
+
+  Args:
+    cache (torch.Tensor): The cache, on the XLA device.
+    position (int or torch.Tensor): The index along `dim` of the first entry of
+      the window, an integer scalar.
+    accepted (int or torch.Tensor): The number of entries of the window to keep,
+      an integer scalar.
+    window (int): The number of entries of the window.
+    dim (int): The dimension of the cache entries.
+  Returns:
+    The `cache`.
+  """
+  torch_xla._XLAC._xla_kv_cache_rollback_(
+      cache, _as_position(position, cache.device),
+      _as_position(accepted, cache.device), window, dim)
+  return cache
+
+
+def speculative_accept_(draft_tokens, target_tokens, caches, position, dim):
+  """Verifies the draft tokens of a speculative decoding step.
+
+  The draft tokens are accepted up to the first one which differs from the
+  token the target model predicts at its position, and the cache entries of
+  the rejected ones are rolled back with `kv_cache_rollback_()`. Everything is
+  computed on the device from tensors of static shapes, so that the steps of a
+  window of k draft tokens share one graph whatever their acceptance. A draft
+  shorter than k can be padded with tokens which never match, like -1.
+
+  Args:
+    draft_tokens (torch.Tensor): The k draft tokens, of shape [k].
+    target_tokens (torch.Tensor): The tokens the target model predicts at the
+      positions of the draft tokens, of shape [k].
+    caches (list of torch.Tensor): The caches the step wrote the k entries of
+      the draft tokens into, from `position` along `dim`.
+    position (int or torch.Tensor): The index of the first entry of the step,
+      an integer scalar.
+    dim (int): The dimension of the cache entries.
+  Returns:
+    The number of accepted tokens and the position following them, as integer
+    scalars on the device.
+  """
+  assert draft_tokens.dim() == 1 and draft_tokens.shape == target_tokens.shape
+  window = draft_tokens.size(0)
+  matches = (draft_tokens == target_tokens).to(torch.int32)
+  accepted = torch.cumprod(matches, dim=0).sum(dtype=torch.int32)
+  position = _as_position(position, draft_tokens.device)
+  for cache in caches:
+    kv_cache_rollback_(cache, position, accepted, window, dim)
+  return accepted, position + accepted
+
+
+_EMBEDDING_BAG_MODES = {'sum': 0, 'mean': 1, 'max': 2}
+
+
+def _add_sparse_grad(weight, rows, values):
+  sparse_grad = getattr(weight, 'sparse_grad', None)
+  if sparse_grad is not None:
+    rows = torch.cat([sparse_grad[0], rows])
+    values = torch.cat([sparse_grad[1], values])
+  weight.sparse_grad = (rows, values)
+
+
+class ShardedEmbeddingBag(torch.autograd.Function):
+
+  @staticmethod
+  def forward(ctx, weight, indices, offsets, per_sample_weights, mode,
+              include_last_offset, groups, pin_layout, sparse):
+    ctx.mode, ctx.include_last_offset = mode, include_last_offset
+    ctx.groups, ctx.pin_layout, ctx.sparse = groups, pin_layout, sparse
+    ctx.weight = weight if sparse else None
+    token, devctx = xm._get_all_reduce_token()
+    result, token = torch_xla._XLAC._xla_sharded_embedding_bag(
+        weight, indices, offsets, per_sample_weights, token, mode,
+        include_last_offset, groups, pin_layout)
+    torch_xla._XLAC._set_all_reduce_token(devctx.device, token)
+    ctx.num_rows = weight.size(0)
+    ctx.save_for_backward(indices, offsets, per_sample_weights)
+    return result
+
+  @staticmethod
+  def backward(ctx, grad_output):
+    indices, offsets, per_sample_weights = ctx.saved_tensors
+    token, devctx = xm._get_all_reduce_token()
+    rows, values, token = torch_xla._XLAC._xla_sharded_embedding_bag_backward(
+        grad_output, indices, offsets, per_sample_weights, token, ctx.mode,
+        ctx.include_last_offset, ctx.num_rows, ctx.groups, ctx.pin_layout)
+    torch_xla._XLAC._set_all_reduce_token(devctx.device, token)
+    if ctx.sparse:
+      _add_sparse_grad(ctx.weight, rows, values)
+      grad_weight = None
+    else:
+      grad_weight = torch.zeros(
+          ctx.num_rows,
+          values.size(1),
+          dtype=values.dtype,
+          device=values.device).index_add_(0, rows, values)
+    return grad_weight, None, None, None, None, None, None, None, None
+
+
+def sharded_embedding_bag(weight,
+                          indices,
+                          offsets,
+                          mode='sum',
+                          per_sample_weights=None,
+                          include_last_offset=False,
+                          groups=None,
+                          pin_layout=True,
+                          sparse=False):
+  """Computes the bags of an embedding table sharded by rows across replicas.
+
+  The i-th replica of a group holds the i-th block of rows of the table. The
+  indices of the bags of all the replicas are all-gathered, each replica sums
+  (or maxes) the rows of its block into partial bags, and an XLA `AllToAll()`
+  sends the partial bags back to the replicas which own them, so the table is
+  never gathered. Supports autograd differentiation of the `weight` in the
+  'sum' and 'mean' modes.
+
+  Args:
+    weight (torch.Tensor): The `[num_rows, dim]` block of rows of the table.
+    indices (torch.Tensor): The 1D global row indices of the local bags, of
+      the same size on all the replicas.
+    offsets (torch.Tensor): The 1D starting offsets of the local bags within
+      `indices`, as for `torch.nn.functional.embedding_bag()`.
+    mode (string): 'sum', 'mean' or 'max'.
+      Default: 'sum'
+    per_sample_weights (torch.Tensor, optional): The weights of the indices,
+      only supported in the 'sum' mode.
+    include_last_offset (bool): Whether `offsets` has one more element than
+      there are bags, the end of the last bag.
+      Default: False
+    groups (list, optional): A list of list, representing the replica groups
+      holding the blocks of the table, in the order of their blocks. If `None`
+      there will be only one group with all the replicas in it.
+    pin_layout (bool, optional): Whether to pin the layout of the collectives.
+      Default: True
+    sparse (bool): Whether the gradient of `weight` is left in
+      `weight.sparse_grad` as the `(rows, values)` of the looked up rows instead
+      of being accumulated densely in `weight.grad`. It is applied by the
+      `torch_xla.amp.syncfree` optimizers, or by
+      `apply_sparse_embedding_grad()`.
+      Default: False
+  Returns:
+    The `[num_bags, dim]` local bags.
+  """
+  assert mode in _EMBEDDING_BAG_MODES, f'Unsupported mode: {mode}'
+  assert per_sample_weights is None or mode == 'sum', (
+      'per_sample_weights are only supported in the sum mode')
+  if groups is None:
+    groups = [list(range(xm.xrt_world_size()))]
+  if per_sample_weights is None:
+    per_sample_weights = torch.ones(
+        indices.size(0), dtype=weight.dtype, device=weight.device)
+  return ShardedEmbeddingBag.apply(weight, indices, offsets,
+                                   per_sample_weights,
+                                   _EMBEDDING_BAG_MODES[mode],
+                                   include_last_offset, groups, pin_layout,
+                                   sparse)
+
+
+class SparseEmbedding(torch.autograd.Function):
+
+  @staticmethod
+  def forward(ctx, weight, indices, padding_idx):
+    ctx.weight, ctx.padding_idx = weight, padding_idx
+    ctx.save_for_backward(indices)
+    return torch.nn.functional.embedding(indices, weight, padding_idx)
+
+  @staticmethod
+  def backward(ctx, grad_output):
+    indices, = ctx.saved_tensors
+    rows = indices.flatten()
+    if ctx.padding_idx is not None:
+      # Out of bounds rows are dropped by the sparse updates.
+      rows = torch.where(rows == ctx.padding_idx, ctx.weight.size(0), rows)
+    _add_sparse_grad(ctx.weight, rows,
+                     grad_output.reshape(-1, ctx.weight.size(1)))
+    return None, None, None
+
+
+def sparse_embedding(weight, indices, padding_idx=None):
+  """Looks up the rows of an embedding table, with a row-sparse gradient.
+
+  Like `torch.nn.functional.embedding()`, but the gradient of `weight` is left
+  in `weight.sparse_grad` as the `(rows, values)` of the looked up rows, instead
+  of a dense `weight.grad` of the size of the table. The
+  `torch_xla.amp.syncfree` optimizers then only read and write those rows of the
+  weight and of its optimizer states, the repeated rows being coalesced.
+
+  Args:
+    weight (torch.Tensor): The `[num_rows, dim]` table.
+    indices (torch.Tensor): The indices of the rows to look up.
+    padding_idx (int, optional): The row whose gradient is dropped.
+  Returns:
+    The `[*indices.shape, dim]` rows.
+  """
+  if padding_idx is not None and padding_idx < 0:
+    padding_idx += weight.size(0)
+  return SparseEmbedding.apply(weight, indices, padding_idx)
+
+
+def apply_sparse_embedding_grad(weight, lr):
+  """Applies the SGD update of the sparse gradient of a sharded embedding table.
+
+  Only the rows looked up by `sharded_embedding_bag(..., sparse=True)` are
+  updated, and the gradient is cleared.
+
+  Args:
+    weight (torch.Tensor): The block of rows of the table.
+    lr (float): The learning rate.
+  """
+  sparse_grad = getattr(weight, 'sparse_grad', None)
+  if sparse_grad is None:
+    return
+  rows, values = sparse_grad
+  with torch.no_grad():
+    weight.index_add_(0, rows, values, alpha=-lr)
+  weight.sparse_grad = None
+
+
 def distributed_mm(w, x, split=1):
   """Performs a matrix multiplication with sharded weight.
 
@@ -152,13 +821,20 @@ class SyncBatchNorm(torch.nn.Module):
     reduce_dims.pop(1)  # channel dim
 
     if self.training:
-      local_mean = torch.mean(batch, dim=reduce_dims)
-      local_sqr_mean = torch.mean(batch * batch, dim=reduce_dims)
-
-      scale = 1.0 / xm.xrt_world_size()
-      mean = AllReduceSumLayer.apply(local_mean) * scale
-      sqr_mean = AllReduceSumLayer.apply(local_sqr_mean) * scale
-      var = sqr_mean - mean.pow(2)
+      # The sums, the sums of squares and the element count of the replicas go
+      # in a single all-reduce, which also weighs the replicas by their batch
+      # sizes.
+      count = batch.numel() // self.num_features
+      local_stats = torch.cat([
+          torch.sum(batch, dim=reduce_dims),
+          torch.sum(batch * batch, dim=reduce_dims),
+          batch.new_full((1,), count),
+      ])
+      stats = AllReduceSumLayer.apply(local_stats)
+      sums, sqr_sums, total = torch.split(
+          stats, [self.num_features, self.num_features, 1])
+      mean = sums / total
+      var = sqr_sums / total - mean.pow(2)
 
       self.running_mean = (
           1 - self.momentum) * self.running_mean + self.momentum * mean
@@ -168,17 +844,11 @@ class SyncBatchNorm(torch.nn.Module):
       mean = self.running_mean
       var = self.running_var
 
-    res = torch.empty_like(batch)
-    for c in range(self.num_features):
-      if batch.ndim == 2:
-        res = ((batch - mean) /
-               torch.sqrt(var + self.eps)) * self.weight + self.bias
-      else:
-        res[:, c, ...] = (
-            (batch[:, c, ...] - mean[c]) /
-            torch.sqrt(var[c] + self.eps)) * self.weight[c] + self.bias[c]
-
-    return res
+    # Broadcasts the per channel values over the other dimensions.
+    shape = [1, self.num_features] + [1] * (batch.ndim - 2)
+    normalized = (batch - mean.view(shape)) / torch.sqrt(
+        var.view(shape) + self.eps)
+    return normalized * self.weight.view(shape) + self.bias.view(shape)
 
   def extra_repr(self) -> str:
     return f'{self.num_features}, eps={self.eps}'
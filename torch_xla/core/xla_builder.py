@@ -758,16 +758,69 @@ def mkshape(dtype, sizes, dynamic_dimensions=None):
   return Shape.create(dtype, sizes, dynamic_dimensions=dynamic_dimensions)
 
 
+_OP_CODES = None
+
+
+def op_code(name):
+  """Returns the interned code of the op `name`, which creates it faster."""
+  global _OP_CODES
+  if _OP_CODES is None:
+    _OP_CODES = torch_xla._XLAC._xla_op_codes()
+  code = _OP_CODES.get(name, None)
+  if code is None:
+    raise ValueError(f'Unknown XLA op name: {name}')
+  return code
+
+
 def mkop(name, ops, **kwargs):
   builder = kwargs.get('builder', None)
   if builder is None:
     assert ops
     builder = torch_xla._XLAC._xla_op_builder(ops[0])
-  return Op(torch_xla._XLAC._xla_op_create(builder, name, ops, kwargs))
+  return Op(
+      torch_xla._XLAC._xla_op_create(builder, op_code(name), ops, kwargs))
 
 
 def mkleaf(name, builder, **kwargs):
-  return Op(torch_xla._XLAC._xla_op_create(builder, name, (), kwargs))
+  return Op(torch_xla._XLAC._xla_op_create(builder, op_code(name), (), kwargs))
+
+
+class OpBatch(object):
+  """Records ops to create them all with a single call into the builder.
+
+  Creating an op with `mkop()` costs a call from Python, which dominates the
+  construction of the large computations, like the bodies of the loops. The
+  ops added to a batch are only descriptors, referring to their operands by
+  the integer handles returned by `input()` and `add()`, until `create()`
+  creates them in order and returns the ops of all the handles.
+
+  Example::
+
+    batch = xb.OpBatch(builder, inputs=[x, y])
+    x, y = batch.input(0), batch.input(1)
+    s = batch.add('Add', (x, y))
+    p = batch.add('Mul', (s, s))
+    ops = batch.create()
+    result = ops[p]
+  """
+
+  def __init__(self, builder, inputs=()):
+    self._builder = builder
+    self._inputs = [op.op for op in inputs]
+    self._descriptors = []
+
+  def input(self, index):
+    assert 0 <= index < len(self._inputs)
+    return index
+
+  def add(self, name, operands=(), **kwargs):
+    self._descriptors.append((op_code(name), tuple(operands), kwargs))
+    return len(self._inputs) + len(self._descriptors) - 1
+
+  def create(self):
+    ops = torch_xla._XLAC._xla_op_create_batch(self._builder, self._inputs,
+                                               self._descriptors)
+    return [Op(op) for op in self._inputs] + [Op(op) for op in ops]
 
 
 def mkparam(builder, param_no, shape):
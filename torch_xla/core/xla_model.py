@@ -448,7 +448,33 @@ def _get_all_reduce_token():
   return token, devctx
 
 
-def all_reduce(reduce_type, inputs, scale=1.0, groups=None, pin_layout=True):
+def _to_wire_dtype(tensors, wire_dtype, residuals):
+  """Casts `tensors` to `wire_dtype`, for a compressed collective.
+
+  With `residuals`, the error of the previous cast of each tensor is added to it
+  before the cast, and replaced in place by the new error (error feedback).
+  """
+  if residuals is not None and len(residuals) != len(tensors):
+    raise ValueError("`residuals` length doesn't match the inputs length: "
+                     f"{len(residuals)} vs {len(tensors)}.")
+  wire_tensors = []
+  for i, tensor in enumerate(tensors):
+    if residuals is not None:
+      tensor = tensor + residuals[i]
+    wire_tensor = tensor.to(wire_dtype)
+    if residuals is not None:
+      residuals[i].copy_(tensor - wire_tensor.to(tensor.dtype))
+    wire_tensors.append(wire_tensor)
+  return wire_tensors
+
+
+def all_reduce(reduce_type,
+               inputs,
+               scale=1.0,
+               groups=None,
+               pin_layout=True,
+               wire_dtype=None,
+               residuals=None):
   """Performs an inplace reduce operation on the input tensor(s).
 
   Args:
@@ -469,6 +495,12 @@ def all_reduce(reduce_type, inputs, scale=1.0, groups=None, pin_layout=True):
       participate in the communication has slightly different program, but it might
       cause some xla compilation to fail. Unpin the layout when you see error message
       like "HloModule has a mix of layout constrained".
+    wire_dtype (torch.dtype, optional): If set (eg. `torch.bfloat16`), the inputs
+      are cast to it for the reduction, and the results cast back, reducing the
+      communicated bytes. The reduction runs in `wire_dtype`.
+    residuals (list, optional): Tensors shaped like the inputs, zero initially,
+      keeping the error of the cast of the inputs to `wire_dtype`. It is added
+      back to the inputs of the next reduction (error feedback).
 
   Returns:
     If a single `torch.Tensor` is passed, the return value is a `torch.Tensor`
@@ -486,6 +518,17 @@ def all_reduce(reduce_type, inputs, scale=1.0, groups=None, pin_layout=True):
     else:
       return inputs
 
+  if wire_dtype is not None:
+    tensors = [inputs] if isinstance(inputs, torch.Tensor) else inputs
+    wire_tensors = _to_wire_dtype(tensors, wire_dtype, residuals)
+    torch_xla._XLAC._xla_all_reduce_inplace(reduce_type, wire_tensors, scale,
+                                            groups, pin_layout)
+    if isinstance(inputs, torch.Tensor):
+      return wire_tensors[0].to(inputs.dtype)
+    for tensor, wire_tensor in zip(inputs, wire_tensors):
+      tensor.copy_(wire_tensor)
+    return inputs
+
   if isinstance(inputs, torch.Tensor):
     result = None
     if scale == 1.0 and groups == [] and pin_layout:
@@ -748,7 +791,9 @@ def all_to_all(value,
   See: https://www.tensorflow.org/xla/operation_semantics#alltoall
 
   Args:
-    value (torch.Tensor): The input tensor.
+    value (torch.Tensor or a list of torch.Tensor): The input. If it's a list,
+      all the tensors are exchanged by a single coalesced operation per dtype,
+      each split and concatenated along the same dimensions.
     split_dimension (int): The dimension upon which the split should happen.
     concat_dimension (int): The dimension upon which the concat should happen.
     split_count (int): The split count.
@@ -764,9 +809,18 @@ def all_to_all(value,
       like "HloModule has a mix of layout constrained".
 
   Returns:
-    The result `torch.Tensor` of the `all_to_all()` operation.
+    The result `torch.Tensor` of the `all_to_all()` operation, or a list of
+    them if `value` is a list.
   """
   token, devctx = _get_all_reduce_token()
+  if isinstance(value, list):
+    result = torch_xla._XLAC._xla_all_to_all_coalesced(value, token,
+                                                       split_dimension,
+                                                       concat_dimension,
+                                                       split_count, groups or
+                                                       [], pin_layout)
+    torch_xla._XLAC._set_all_reduce_token(devctx.device, result[-1])
+    return result[:-1]
   result = torch_xla._XLAC._xla_all_to_all(value, token, split_dimension,
                                            concat_dimension, split_count,
                                            groups or [], pin_layout)
@@ -783,7 +837,8 @@ def collective_permute(value, pairs):
   See: https://www.tensorflow.org/xla/operation_semantics#collectivepermute
 
   Args:
-    value (torch.Tensor): The input tensor.
+    value (torch.Tensor or a list of torch.Tensor): The input. If it's a list,
+      all the tensors are permuted by a single coalesced operation per dtype.
     pairs (list): A list of (source_replica_id, target_replica_id) pairs,
       representing the sender and receiver for the `collective_permute()`
       operation. Example: `[[0, 1], [1, 2], [2, 0]]` defines three pairs. The
@@ -791,9 +846,15 @@ def collective_permute(value, pairs):
         and replica 2 to replica 0.
 
   Returns:
-    The result `torch.Tensor` of the `collective_permute()` operation.
+    The result `torch.Tensor` of the `collective_permute()` operation, or a
+    list of them if `value` is a list.
   """
   token, devctx = _get_all_reduce_token()
+  if isinstance(value, list):
+    result = torch_xla._XLAC._xla_collective_permute_coalesced(
+        value, token, pairs)
+    torch_xla._XLAC._set_all_reduce_token(devctx.device, result[-1])
+    return result[:-1]
   result = torch_xla._XLAC._xla_collective_permute(value, token, pairs)
   torch_xla._XLAC._set_all_reduce_token(devctx.device, result[1])
   return result[0]
@@ -832,7 +893,22 @@ def collective_broadcast(tensors: List[torch.Tensor],
   all_reduce(REDUCE_SUM, tensors, groups=groups, pin_layout=pin_layout)
 
 
-def send(value, channel_id):
+def _get_send_recv_token(channel_id, token_per_channel):
+  if not token_per_channel:
+    return _get_all_reduce_token()
+  devctx = _get_device_context()
+  token = torch_xla._XLAC._get_channel_token(devctx.device, channel_id)
+  return token, devctx
+
+
+def _set_send_recv_token(devctx, channel_id, token_per_channel, token):
+  if token_per_channel:
+    torch_xla._XLAC._set_channel_token(devctx.device, channel_id, token)
+  else:
+    torch_xla._XLAC._set_all_reduce_token(devctx.device, token)
+
+
+def send(value, channel_id, token_per_channel=False):
   """Performs a XLA `Send()` operation on the input tensor.
 
   See: https://www.tensorflow.org/xla/operation_semantics#send
@@ -840,16 +916,20 @@ def send(value, channel_id):
   Args:
     value (torch.Tensor): The input tensor.
     channel_id (int64): opaque id identifying the destination of the send op.
+    token_per_channel (bool, optional): whether to order the op only after the
+      earlier sends and receives of `channel_id`, rather than after all the
+      earlier collectives. The transfers of different channels can then be in
+      flight together, eg. those of several microbatches of a pipeline.
   """
-  token, devctx = _get_all_reduce_token()
+  token, devctx = _get_send_recv_token(channel_id, token_per_channel)
   # The input will be returned as result.
   input_as_result, new_token = torch_xla._XLAC._xla_send(
       value, token, channel_id)
-  torch_xla._XLAC._set_all_reduce_token(devctx.device, new_token)
+  _set_send_recv_token(devctx, channel_id, token_per_channel, new_token)
   return input_as_result
 
 
-def recv(output, channel_id):
+def recv(output, channel_id, token_per_channel=False):
   """Performs a XLA `Send()` operation on the input tensor.
 
   See: https://www.tensorflow.org/xla/operation_semantics#recv
@@ -857,10 +937,13 @@ def recv(output, channel_id):
   Args:
     output (torch.Tensor): The output tensor.
     channel_id (int64): opaque id identifying the source of the recv op.
+    token_per_channel (bool, optional): whether to order the op only after the
+      earlier sends and receives of `channel_id`, rather than after all the
+      earlier collectives. See `send()`.
   """
-  token, devctx = _get_all_reduce_token()
+  token, devctx = _get_send_recv_token(channel_id, token_per_channel)
   result, new_token = torch_xla._XLAC._xla_recv(output, token, channel_id)
-  torch_xla._XLAC._set_all_reduce_token(devctx.device, new_token)
+  _set_send_recv_token(devctx, channel_id, token_per_channel, new_token)
   return result
 
 
@@ -871,7 +954,9 @@ def reduce_scatter(reduce_type,
                    shard_count,
                    groups=None,
                    output=None,
-                   pin_layout=True):
+                   pin_layout=True,
+                   wire_dtype=None,
+                   residuals=None):
   """Performs a XLA `ReduceScatter()` operation on the input tensor.
 
   See: https://www.tensorflow.org/xla/operation_semantics#reducescatter
@@ -897,12 +982,39 @@ def reduce_scatter(reduce_type,
       participate in the communication has slightly different program, but it might
       cause some xla compilation to fail. Unpin the layout when you see error message
       like "HloModule has a mix of layout constrained".
+    wire_dtype (torch.dtype, optional): If set (eg. `torch.bfloat16`), the input
+      is cast to it for the reduction, and the result cast back, reducing the
+      communicated bytes. The reduction runs in `wire_dtype`.
+    residuals (list, optional): Tensors shaped like the input tensors, zero
+      initially, keeping the error of the cast of the input to `wire_dtype`. It
+      is added back to the input of the next reduction (error feedback).
 
   Returns:
     A `torch.Tensor` with all the values reduced across replicas. Each process
     gets a shard split along the `scatter_dim`. All other dimensions are
     the same as the input.
   """
+  if wire_dtype is not None:
+    inputs = [input] if isinstance(input, torch.Tensor) else input
+    wire_inputs = _to_wire_dtype(inputs, wire_dtype, residuals)
+    results = reduce_scatter(
+        reduce_type,
+        wire_inputs[0] if isinstance(input, torch.Tensor) else wire_inputs,
+        scale,
+        scatter_dim,
+        shard_count,
+        groups=groups,
+        pin_layout=pin_layout)
+    if isinstance(input, torch.Tensor):
+      results = [results]
+    results = [r.to(i.dtype) for r, i in zip(results, inputs)]
+    if output is not None:
+      outputs = [output] if isinstance(output, torch.Tensor) else output
+      for out, result in zip(outputs, results):
+        out.copy_(result)
+      return output
+    return results[0] if isinstance(input, torch.Tensor) else results
+
   token, devctx = _get_all_reduce_token()
 
   if isinstance(input, torch.Tensor):
@@ -950,6 +1062,86 @@ def reduce_scatter(reduce_type,
                     f"given {type(input)}.")
 
 
+class AsyncCollective(object):
+  """A collective started by `all_gather_start()` or `all_reduce_start()`.
+
+  The collective runs asynchronously (as an XLA start/done pair), overlapping
+  with the computations issued between its start and `wait()`. A collective
+  which is never waited for is not part of the graph.
+  """
+
+  def __init__(self, input, start, scale=1.0):
+    self._input = input
+    self._start = start
+    self._scale = scale
+    self._result = None
+
+  def wait(self):
+    """Returns the result of the collective."""
+    if self._result is None:
+      token, devctx = _get_all_reduce_token()
+      result, new_token = torch_xla._XLAC._xla_async_collective_done(
+          self._input, self._start, token)
+      torch_xla._XLAC._set_all_reduce_token(devctx.device, new_token)
+      self._result = result * self._scale if self._scale != 1.0 else result
+    return self._result
+
+
+def all_gather_start(value, dim=0, groups=None, pin_layout=True):
+  """Starts an asynchronous all-gather of `value`, like `all_gather()`.
+
+  Args:
+    value (torch.Tensor): The input tensor.
+    dim (int): The gather dimension.
+      Default: 0
+    groups (list, optional): The replica groups, as for `all_gather()`.
+    pin_layout (bool, optional): Whether to pin the layout for this
+      communication op, as for `all_gather()`.
+
+  Returns:
+    An `AsyncCollective`, whose `wait()` returns the gathered tensor.
+  """
+  if dim < 0:
+    dim = value.dim() + dim
+  if groups:
+    shard_count = len(groups[0])
+    assert all(len(group) == shard_count for group in groups), \
+      "Replica groups must have the same number of replicas/shards."
+  else:
+    shard_count = xrt_world_size()
+  token, _ = _get_all_reduce_token()
+  start = torch_xla._XLAC._xla_all_gather_start(value, token, dim, shard_count,
+                                                groups or [], pin_layout)
+  return AsyncCollective(value, start)
+
+
+def all_reduce_start(reduce_type,
+                     value,
+                     scale=1.0,
+                     groups=None,
+                     pin_layout=True):
+  """Starts an asynchronous all-reduce of `value`, like `all_reduce()`.
+
+  Args:
+    reduce_type (string): One of ``xm.REDUCE_SUM``, ``xm.REDUCE_MUL``,
+      ``xm.REDUCE_AND``, ``xm.REDUCE_OR``, ``xm.REDUCE_MIN`` and
+      ``xm.REDUCE_MAX``.
+    value (torch.Tensor): The input tensor.
+    scale (float): A scaling value applied to the result.
+      Default: 1.0
+    groups (list, optional): The replica groups, as for `all_reduce()`.
+    pin_layout (bool, optional): Whether to pin the layout for this
+      communication op, as for `all_reduce()`.
+
+  Returns:
+    An `AsyncCollective`, whose `wait()` returns the reduced tensor.
+  """
+  token, _ = _get_all_reduce_token()
+  start = torch_xla._XLAC._xla_all_reduce_start(reduce_type, value, token,
+                                                groups or [], pin_layout)
+  return AsyncCollective(value, start, scale=scale)
+
+
 def reduce_scatter_bucketized(reduce_type,
                               input_list,
                               scale,
@@ -1064,6 +1256,26 @@ def mark_step(wait=False, reset_scope=True):
   torch_xla._XLAC._set_all_reduce_token(devctx.device, None)
 
 
+def mark_step_roots(tensors, is_root=True):
+  """Marks the tensors whose pending computations the step syncs materialize.
+
+  With XLA_SYNC_ROOTS_ONLY set, once some live tensors are marked, `mark_step`
+  only materializes those, leaving the pending computations of the other live
+  tensors (counter PrunedLiveTensors) to be run when they are read. Roots
+  typically are the model parameters, the optimizer state and the outputs
+  read after the step. In-place updates keep a tensor a root.
+
+  Args:
+    tensors: The tensors to mark, possibly nested within lists, tuples or
+      dicts, like the optimizer state.
+    is_root (bool, optional): Whether the tensors are roots or not.
+      Default: True
+  """
+  leaves = torch.utils._pytree.tree_leaves(tensors)
+  torch_xla._XLAC._xla_set_step_roots(
+      [t for t in leaves if isinstance(t, torch.Tensor)], is_root)
+
+
 def get_stablehlo(tensors=None) -> str:
   """Get StableHLO for the computation graph in string format.
 
@@ -1384,6 +1596,77 @@ def mesh_reduce(tag, data, reduce_fn):
   return reduce_fn(xldata) if xldata else cpu_data
 
 
+_HOST_REDUCE_FNS = {
+    REDUCE_SUM: lambda x: torch.sum(x, dim=0),
+    REDUCE_MUL: lambda x: torch.prod(x, dim=0),
+    REDUCE_AND: lambda x: torch.all(x, dim=0),
+    REDUCE_OR: lambda x: torch.any(x, dim=0),
+    REDUCE_MIN: lambda x: torch.amin(x, dim=0),
+    REDUCE_MAX: lambda x: torch.amax(x, dim=0),
+}
+
+
+def _ensure_host_coordinator():
+  if runtime.device_type() == 'TPU':
+    master_ip = runtime.get_master_ip()
+  else:
+    master_ip = xu.getenv_as('MASTER_ADDR', str, 'localhost')
+  torch_xla._XLAC._ensure_xla_coordinator_initialized(
+      runtime.process_index(), runtime.process_count(), master_ip)
+
+
+def host_all_gather(tag, payload, timeout=600.0):
+  """Exchanges `payload` between the processes, on the host.
+
+  The payloads go through the key-value store of the XLA distributed runtime,
+  so no graph is compiled or executed. This is meant for small control-plane
+  data; `mesh_reduce()` is the one to use with several devices per process.
+
+  Args:
+    tag (string): The name of the exchange. All the processes must make the
+      exchanges with the same tag in the same order.
+    payload (bytes): The payload of this process.
+    timeout (float, optional): Seconds to wait for the other processes.
+      Default: 600.0
+
+  Returns:
+    The payloads of all the processes, by process index.
+  """
+  if not isinstance(payload, bytes):
+    raise TypeError('`payload` must be bytes, not {}'.format(type(payload)))
+  _ensure_host_coordinator()
+  return torch_xla._XLAC._xla_host_all_gather(tag, payload, timeout)
+
+
+def host_all_reduce(tag, data, reduce_type=REDUCE_SUM, timeout=600.0):
+  """Reduces a small tensor or number across the processes, on the host.
+
+  See `host_all_gather()`, which exchanges the data.
+
+  Args:
+    tag (string): The name of the reduction.
+    data (torch.Tensor or number): The data to be reduced. XLA tensors are
+      copied to the host.
+    reduce_type (string): One of ``xm.REDUCE_SUM``, ``xm.REDUCE_MUL``,
+      ``xm.REDUCE_AND``, ``xm.REDUCE_OR``, ``xm.REDUCE_MIN`` and
+      ``xm.REDUCE_MAX``.
+      Default: ``xm.REDUCE_SUM``
+    timeout (float, optional): Seconds to wait for the other processes.
+      Default: 600.0
+
+  Returns:
+    The reduced value, as a CPU tensor.
+  """
+  tensor = torch.as_tensor(data).cpu()
+  bio = io.BytesIO()
+  torch.save(tensor, bio)
+  tensors = [
+      torch.load(io.BytesIO(payload))
+      for payload in host_all_gather(tag, bio.getvalue(), timeout=timeout)
+  ]
+  return _HOST_REDUCE_FNS[reduce_type](torch.stack(tensors))
+
+
 def set_rng_state(seed, device=None):
   """Sets the random number generator state.
 
@@ -1437,6 +1720,10 @@ def fork_rng(device=None, enabled=True):
 class MemoryInfo(TypedDict):
   bytes_used: str
   bytes_limit: int
+  pinned_host_bytes_used: int
+  peak_bytes_used: int
+  largest_free_block_bytes: int
+  fragmentation: float
 
 
 def get_memory_info(device: torch.device) -> MemoryInfo:
@@ -1446,11 +1733,111 @@ def get_memory_info(device: torch.device) -> MemoryInfo:
     device: The device whose memory information are requested.
 
   Returns:
-    MemoryInfo dict with memory usage for the given device.
+    MemoryInfo dict with memory usage for the given device. The bytes of the
+    buffers placed in pinned host memory (see `set_memory_kind`) are reported
+    apart, in `pinned_host_bytes_used`. `peak_bytes_used` is the highest
+    `bytes_used` so far, `largest_free_block_bytes` the largest allocation
+    which can currently succeed, and `fragmentation` the fraction of the free
+    memory outside of that block. The latter two are zero when the device
+    allocator does not report them.
   """
   return torch_xla._XLAC._xla_memory_info(str(device))
 
 
+def set_memory_kind(tensors: List[torch.Tensor], kind: str):
+  """Moves the data of XLA tensors to the given memory of their device.
+
+  Large state which is only used once per step, like the optimizer state, can
+  be placed in pinned host memory to free the device memory. The graphs using
+  it are then compiled to read it from the host memory. Devices without such
+  memory keep the data in device memory (counter MemoryKindFallback).
+
+  Args:
+    tensors (List[torch.Tensor]): The XLA tensors to move, which must be
+      backed by device data (eg. after a `mark_step`).
+    kind (str): 'device' or 'pinned_host'.
+  """
+  torch_xla._XLAC._xla_set_memory_kind(tensors, kind)
+
+
+def get_memory_kind(tensor: torch.Tensor) -> str:
+  """Returns the memory the data of an XLA tensor is placed in.
+
+  Returns:
+    'device' or 'pinned_host'. Tensors not backed by device data report
+    'device'.
+  """
+  return torch_xla._XLAC._xla_get_memory_kind(tensor)
+
+
+class OperationStats(TypedDict):
+  inflight: int
+  high_water_mark: int
+  blocked_ns: int
+  rejected: int
+
+
+def get_operation_stats(device: torch.device) -> OperationStats:
+  """Retrieves the statistics of the inflight operations of a device.
+
+  The inflight operations are the host to device transfers whose host buffer
+  is not released yet, and the executions which did not complete yet. Their
+  number is bounded by XLA_MAX_INFLIGHT_DEVICE_OPERATIONS when set, in which
+  case `blocked_ns` is the time spent waiting for the bound.
+
+  Args:
+    device: The device whose operation statistics are requested.
+
+  Returns:
+    OperationStats dict with the current and the highest number of inflight
+    operations, the time blocked and the number of refused operations.
+  """
+  return torch_xla._XLAC._xla_operation_stats(str(device))
+
+
+def last_execution_future():
+  """Retrieves the completion future of the last graph execution.
+
+  `mark_step` leaves the future of its own execution, or None when it had
+  nothing to execute. The future is done once the execution completed on the
+  device, without the need to wait for all the devices:
+    - `done()` polls it.
+    - `wait()` blocks until it is done, raising a RuntimeError with the graph
+      hash if the execution failed.
+    - `error()` returns the error of a failed execution, None otherwise.
+    - `add_done_callback(fn)` calls `fn(future)` once it is done, from the
+      thread completing the execution.
+
+  Returns:
+    The ExecutionFuture of the last execution scheduled by the calling thread,
+    or None.
+  """
+  return torch_xla._XLAC._xla_last_execution_future()
+
+
+def fetch_async(tensor):
+  """Fetches the value of an XLA tensor to the host without waiting for it.
+
+  The pending computations of the tensor are scheduled, as `mark_step` would
+  do for it alone, and its value is copied to the host in the background once
+  available, so that logging code can enqueue the copy of a loss at one step
+  and read it a few steps later without stalling the calling thread:
+    - `done()` polls the copy.
+    - `result()` waits for it and returns the host tensor, raising a
+      RuntimeError if the execution or the copy failed.
+
+  The device buffer fetched is not donated to the later graphs, so the tensor
+  can be updated in place while its copy is pending.
+
+  Args:
+    tensor (torch.Tensor): The XLA tensor to fetch.
+
+  Returns:
+    The HostTensorFuture of the host copy.
+  """
+  return torch_xla._XLAC._xla_fetch_async(tensor)
+
+
 def optimization_barrier_(tensors):
   """Blocks xla compiler from moving computations across this barrier. The common
   use case would be blocking xla common-subexpression elimination pass from undoing
@@ -1462,6 +1849,85 @@ def optimization_barrier_(tensors):
   torch_xla._XLAC._xla_optimization_barrier_(tensors)
 
 
+def nonzero_static(input, size=None, fill_value=-1):
+  """Returns the indices of the nonzero elements of `input` with a static shape.
+
+  Like `torch.nonzero_static()`, the result has `size` rows, the first ones
+  being the indices of the nonzero elements in row-major order, padded with
+  `fill_value`. The indices are compacted without dynamic shapes, so the graph
+  neither syncs with the host nor recompiles with the number of nonzero
+  elements.
+
+  Args:
+    input (torch.Tensor): The input tensor.
+    size (int, optional): The number of rows of the result. If `None`, it is the
+      number of elements of `input`, which always fits all the indices.
+    fill_value (int): The value of the padding rows.
+      Default: -1
+  Returns:
+    The `[size, input.dim()]` indices, and the number of nonzero elements as a
+    scalar tensor. The number is larger than `size` if indices were dropped.
+  """
+  if size is None:
+    size = input.numel()
+  return torch_xla._XLAC._xla_nonzero_static(input, size, fill_value)
+
+
+def masked_select_static(input, mask, size=None, fill_value=0):
+  """Selects the elements of `input` where `mask` is true with a static shape.
+
+  The static shape variant of `torch.masked_select()`, see
+  `nonzero_static()`.
+
+  Args:
+    input (torch.Tensor): The input tensor.
+    mask (torch.Tensor): The boolean mask, broadcastable to `input`.
+    size (int, optional): The number of elements of the result. If `None`, it
+      is the number of elements of `input`.
+    fill_value (float): The value of the padding elements.
+      Default: 0
+  Returns:
+    The `[size]` selected elements, and their number as a scalar tensor. The
+    number is larger than `size` if elements were dropped.
+  """
+  if size is None:
+    size = input.numel()
+  return torch_xla._XLAC._xla_masked_select_static(input, mask, size,
+                                                   fill_value)
+
+
+def batched_nms(boxes,
+                scores,
+                iou_threshold,
+                score_threshold=float('-inf'),
+                max_output_size=None):
+  """Performs the non-maximum suppression of every set of boxes of a batch.
+
+  The sets, for example the classes of the images of a batch, are suppressed
+  together within a single loop over the boxes and a single compiled graph,
+  with static output shapes.
+
+  Args:
+    boxes (torch.Tensor): The `[..., num_boxes, 4]` boxes of every set, in
+      `(x1, y1, x2, y2)` format.
+    scores (torch.Tensor): The `[..., num_boxes]` scores of the boxes.
+    iou_threshold (float): The boxes overlapping a kept box of higher score
+      with an IoU above this threshold are discarded.
+    score_threshold (float): The boxes with a score not above this threshold
+      are discarded.
+      Default: -inf
+    max_output_size (int, optional): The maximum number of kept boxes of every
+      set. If `None`, it is `num_boxes`.
+  Returns:
+    The `[..., max_output_size]` indices of the boxes kept in every set by
+    decreasing score, padded with -1, and the `[...]` number of kept boxes.
+  """
+  if max_output_size is None:
+    max_output_size = scores.size(-1)
+  return torch_xla._XLAC._xla_batched_nms(boxes, scores, iou_threshold,
+                                          score_threshold, max_output_size)
+
+
 def broadcast_master_param(model: torch.nn.Module) -> None:
   """
   Broadcast the model parameters from master process to other processes
@@ -0,0 +1,193 @@
+#include "torch_xla/csrc/all_reduce_buckets.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+#include <torch/csrc/lazy/core/util.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <optional>
+#include <tuple>
+
+#include "torch_xla/csrc/cross_replica_reduces.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "xla/client/xla_builder.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+// The AllReduce nodes with equal keys can be reduced together.
+using BucketKey = std::tuple<int64_t, double, std::vector<std::vector<int64_t>>,
+                             bool, xla::PrimitiveType>;
+
+struct OpenBucket {
+  std::vector<const AllReduce*> nodes;
+  int64_t bytes = 0;
+  // The first position in the post order using an output of the nodes.
+  size_t first_use = std::numeric_limits<size_t>::max();
+};
+
+// Whether `operand` is the token operand of the AllReduce node `user`, chaining
+// it to the AllReduce node which produced the token.
+bool IsTokenChain(const torch::lazy::Node* user, size_t operand_index,
+                  const torch::lazy::Output& operand) {
+  return user->op() == xla_cross_replica_sum &&
+         operand_index + 1 == user->operands().size() &&
+         operand.node->op() == xla_cross_replica_sum &&
+         operand.index + 1 == operand.node->num_outputs();
+}
+
+// The key of `node`, with the bytes of its operands, or nullopt if the node is
+// to be lowered alone: its operands are not static arrays of a single type, or
+// it is sharded.
+std::optional<BucketKey> GetBucketKey(const AllReduce* node, int64_t* bytes) {
+  if (node->GetSharding(0) != nullptr) {
+    return std::nullopt;
+  }
+  std::optional<xla::PrimitiveType> element_type;
+  *bytes = 0;
+  for (size_t i = 0; i + 1 < node->num_outputs(); ++i) {
+    const xla::Shape& shape = node->xla_shape(i);
+    if (!shape.IsArray() || shape.is_dynamic() ||
+        (element_type && *element_type != shape.element_type())) {
+      return std::nullopt;
+    }
+    element_type = shape.element_type();
+    *bytes += xla::ShapeUtil::ByteSizeOf(shape);
+  }
+  if (!element_type) {
+    return std::nullopt;
+  }
+  return BucketKey(torch::lazy::GetEnumValue(node->reduce_type()),
+                   node->scale(), node->groups(), node->pin_layout(),
+                   *element_type);
+}
+
+}  // namespace
+
+AllReduceBuckets::AllReduceBuckets(
+    c10::ArrayRef<const torch::lazy::Node*> post_order,
+    int64_t max_bucket_bytes) {
+  if (max_bucket_bytes <= 0) {
+    return;
+  }
+  std::unordered_map<const torch::lazy::Node*, size_t> first_use;
+  for (size_t p = 0; p < post_order.size(); ++p) {
+    const auto& operands = post_order[p]->operands();
+    for (size_t i = 0; i < operands.size(); ++i) {
+      // The token chaining the AllReduce nodes of a bucket goes through the
+      // single all-reduce of the bucket.
+      if (!IsTokenChain(post_order[p], i, operands[i])) {
+        first_use.emplace(operands[i].node, p);
+      }
+    }
+  }
+
+  std::map<BucketKey, OpenBucket> open_buckets;
+  std::unordered_map<const torch::lazy::Node*, BucketKey> open_keys;
+  auto close_bucket = [&](std::map<BucketKey, OpenBucket>::iterator it) {
+    std::vector<const AllReduce*>& nodes = it->second.nodes;
+    for (const AllReduce* node : nodes) {
+      open_keys.erase(node);
+    }
+    if (nodes.size() > 1) {
+      for (const AllReduce* node : nodes) {
+        bucket_index_[node] = buckets_.size();
+      }
+      buckets_.push_back(std::move(nodes));
+    }
+    open_buckets.erase(it);
+  };
+  for (size_t p = 0; p < post_order.size(); ++p) {
+    const AllReduce* node =
+        NodeCast<AllReduce>(post_order[p], xla_cross_replica_sum);
+    if (node == nullptr) {
+      continue;
+    }
+    int64_t bytes = 0;
+    std::optional<BucketKey> key = GetBucketKey(node, &bytes);
+    auto it = key ? open_buckets.find(*key) : open_buckets.end();
+    if (it != open_buckets.end() &&
+        (p >= it->second.first_use ||
+         it->second.bytes + bytes > max_bucket_bytes)) {
+      close_bucket(it);
+      it = open_buckets.end();
+    }
+    // The node producing the token must be lowered before this one, so its
+    // bucket is closed unless this node joins it.
+    auto token_key = open_keys.find(node->operands().back().node);
+    if (token_key != open_keys.end() &&
+        (it == open_buckets.end() || token_key->second != it->first)) {
+      close_bucket(open_buckets.find(token_key->second));
+    }
+    if (!key) {
+      continue;
+    }
+    if (it == open_buckets.end()) {
+      it = open_buckets.emplace(*key, OpenBucket()).first;
+    }
+    it->second.nodes.push_back(node);
+    it->second.bytes += bytes;
+    auto use = first_use.find(node);
+    if (use != first_use.end()) {
+      it->second.first_use = std::min(it->second.first_use, use->second);
+    }
+    open_keys.emplace(node, *key);
+  }
+  while (!open_buckets.empty()) {
+    close_bucket(open_buckets.begin());
+  }
+  if (!buckets_.empty()) {
+    TORCH_LAZY_COUNTER("AllReduceBuckets", buckets_.size());
+    TORCH_LAZY_COUNTER("AllReduceBucketedNodes", bucket_index_.size());
+  }
+}
+
+void AllReduceBuckets::LowerNode(const torch::lazy::Node* node,
+                                 LoweringContext* loctx) const {
+  auto it = bucket_index_.find(node);
+  if (it == bucket_index_.end()) {
+    loctx->LowerNode(node);
+    return;
+  }
+  const std::vector<const AllReduce*>& bucket = buckets_[it->second];
+  if (bucket.back() == node) {
+    LowerBucket(bucket, loctx);
+  }
+}
+
+void AllReduceBuckets::LowerBucket(const std::vector<const AllReduce*>& bucket,
+                                   LoweringContext* loctx) {
+  std::vector<xla::XlaOp> flat_inputs;
+  for (const AllReduce* node : bucket) {
+    for (size_t i = 0; i + 1 < node->num_outputs(); ++i) {
+      xla::XlaOp input = loctx->GetOutputOp(node->operand(i));
+      flat_inputs.push_back(xla::Reshape(
+          input, {xla::ShapeUtil::ElementsIn(node->xla_shape(i))}));
+    }
+  }
+  const AllReduce* first = bucket.front();
+  xla::XlaOp token = loctx->GetOutputOp(first->operands().back());
+  std::vector<xla::XlaOp> reduced = BuildAllReduce(
+      first->reduce_type(),
+      {xla::ConcatInDim(loctx->builder(), flat_inputs, 0)}, token,
+      first->scale(), first->groups(), first->pin_layout());
+
+  int64_t offset = 0;
+  for (const AllReduce* node : bucket) {
+    size_t num_inputs = node->num_outputs() - 1;
+    for (size_t i = 0; i < num_inputs; ++i) {
+      const xla::Shape& shape = node->xla_shape(i);
+      int64_t size = xla::ShapeUtil::ElementsIn(shape);
+      xla::XlaOp output =
+          xla::SliceInDim(reduced[0], offset, offset + size, 1, 0);
+      loctx->AssignOutputOp(torch::lazy::Output(node, i),
+                            xla::Reshape(output, shape.dimensions()));
+      offset += size;
+    }
+    loctx->AssignOutputOp(torch::lazy::Output(node, num_inputs), reduced[1]);
+  }
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,45 @@
+#ifndef XLA_TORCH_XLA_CSRC_ALL_REDUCE_BUCKETS_H_
+#define XLA_TORCH_XLA_CSRC_ALL_REDUCE_BUCKETS_H_
+
+#include <torch/csrc/lazy/core/ir.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/all_reduce.h"
+
+namespace torch_xla {
+
+// Groups the AllReduce nodes of a graph which can be reduced together (same
+// reduce type, scale, groups, layout pinning and element type) into buckets
+// holding at most `max_bucket_bytes` of operands. A bucket is lowered as a
+// single all-reduce of the flattened and concatenated operands of its nodes,
+// in place of its last node, so the nodes only join a bucket if none of the
+// outputs of the bucket is used before them. No bucket is made if
+// `max_bucket_bytes` is not positive.
+class AllReduceBuckets {
+ public:
+  AllReduceBuckets(c10::ArrayRef<const torch::lazy::Node*> post_order,
+                   int64_t max_bucket_bytes);
+
+  // Lowers `node` of the post order, as part of its bucket if it has one. The
+  // nodes of a bucket are all lowered along with its last one.
+  void LowerNode(const torch::lazy::Node* node, LoweringContext* loctx) const;
+
+  size_t size() const { return buckets_.size(); }
+
+ private:
+  static void LowerBucket(const std::vector<const AllReduce*>& bucket,
+                          LoweringContext* loctx);
+
+  std::vector<std::vector<const AllReduce*>> buckets_;
+  // The index in buckets_ of the bucket of each bucketed node.
+  std::unordered_map<const torch::lazy::Node*, size_t> bucket_index_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_ALL_REDUCE_BUCKETS_H_
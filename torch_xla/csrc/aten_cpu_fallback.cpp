@@ -1,27 +1,97 @@
 #include "torch_xla/csrc/aten_cpu_fallback.h"
 
+#include <mutex>
 #include <unordered_map>
 
+#include "absl/strings/str_cat.h"
+#include "torch_xla/csrc/aten_xla_bridge.h"
 #include "torch_xla/csrc/function_call_tracker.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/metrics.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/tf_logging.h"
 
 namespace torch_xla {
+namespace {
 
-// TODO(jwtan): Replace this with torch::lazy::Counter. We need
-// _cpu_fallback_counters to remain as torch_xla::runtime::metrics::Counter to
-// support torch_xla::runtime::metrics::CreatePerformanceReport(). For more
+// The metrics of the fallbacks of an operator. The metric and counter names
+// are prefixed per kind of cost, and suffixed with the operator name, for
+// CreatePerformanceReport() to rank the fallbacks by cost.
+struct FallbackMetrics {
+  explicit FallbackMetrics(const std::string& name)
+      : calls(name),
+        graph_breaks(absl::StrCat("CpuFallbackGraphBreaks.", name)),
+        time(absl::StrCat("CpuFallbackTime.", name),
+             runtime::metrics::MetricFnTime),
+        to_host_bytes(absl::StrCat("CpuFallbackToHostBytes.", name),
+                      runtime::metrics::MetricFnBytes),
+        to_device_bytes(absl::StrCat("CpuFallbackToDeviceBytes.", name),
+                        runtime::metrics::MetricFnBytes) {}
+
+  runtime::metrics::Counter calls;
+  // The fallbacks whose arguments had pending IR, which had to be executed
+  // before copying the arguments to the CPU, splitting the graph.
+  runtime::metrics::Counter graph_breaks;
+  runtime::metrics::Metric time;
+  runtime::metrics::Metric to_host_bytes;
+  runtime::metrics::Metric to_device_bytes;
+};
+
+// TODO(jwtan): Replace this with torch::lazy::Counter. We need the fallback
+// metrics to remain as torch_xla::runtime::metrics::Counter to support
+// torch_xla::runtime::metrics::CreatePerformanceReport(). For more
 // information, see NOTE: [TORCH_LAZY_COUNTER v.s. XLA_COUNTER].
-static std::unordered_map<std::string, ::torch_xla::runtime::metrics::Counter*>
-    _cpu_fallback_counters;
+std::mutex cpu_fallback_mutex;
+std::unordered_map<std::string, FallbackMetrics*> cpu_fallback_metrics;
+
+FallbackMetrics* GetFallbackMetrics(const std::string& name) {
+  std::lock_guard<std::mutex> lock(cpu_fallback_mutex);
+  auto it = cpu_fallback_metrics.find(name);
+  if (it == cpu_fallback_metrics.end()) {
+    it = cpu_fallback_metrics.emplace(name, new FallbackMetrics(name)).first;
+  }
+  return it->second;
+}
+
+// Returns the bytes of the XLA tensors within `ivalue`, and sets
+// `*pending_ir` if any of them holds IR not executed yet.
+int64_t XlaTensorBytes(const c10::IValue& ivalue, bool* pending_ir) {
+  int64_t bytes = 0;
+  auto add_tensor = [&](const at::Tensor& tensor) {
+    if (!tensor.defined() || !tensor.device().is_xla()) {
+      return;
+    }
+    bytes += tensor.nbytes();
+    if (pending_ir != nullptr) {
+      XLATensorPtr xtensor = bridge::TryGetXlaTensor(tensor);
+      *pending_ir |= xtensor && xtensor->CurrentIrValue();
+    }
+  };
+  if (ivalue.isTensor()) {
+    add_tensor(ivalue.toTensor());
+  } else if (ivalue.isTensorList()) {
+    for (const at::Tensor& tensor : ivalue.toTensorVector()) {
+      add_tensor(tensor);
+    }
+  } else if (ivalue.isOptionalTensorList()) {
+    for (c10::optional<at::Tensor> tensor : ivalue.toOptionalTensorList()) {
+      if (tensor) {
+        add_tensor(*tensor);
+      }
+    }
+  }
+  return bytes;
+}
+
+}  // namespace
 
 // Get all the executed fallback operations.
 // In other words, get all of them whose counters are not zero.
 std::vector<std::string> GetFallbackOperations() {
+  std::lock_guard<std::mutex> lock(cpu_fallback_mutex);
   std::vector<std::string> fallback;
-  for (auto const& pair : _cpu_fallback_counters) {
-    if (pair.second->Value() != 0) {
+  for (auto const& pair : cpu_fallback_metrics) {
+    if (pair.second->calls.Value() != 0) {
       fallback.push_back(pair.first);
     }
   }
@@ -37,27 +107,52 @@ void xla_cpu_fallback(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
   // because this boxed fallback kernel is used by multiple operators,
   // and the macro stamps out a static Counter object with a fixed name
   // at the code location that it was called.
-  if (_cpu_fallback_counters.find(name) == _cpu_fallback_counters.end()) {
-    _cpu_fallback_counters[name] =
-        new ::torch_xla::runtime::metrics::Counter(name);
-  }
-  _cpu_fallback_counters[name]->AddValue(1);
+  FallbackMetrics* metrics = GetFallbackMetrics(name);
+  metrics->calls.AddValue(1);
 
   auto& args = op.schema().arguments();
   auto arguments = torch::jit::last(stack, args.size());
 
-  // Log each tensor argument.
+  // Log each tensor argument, and account the bytes copied to the CPU. The
+  // arguments written by the operator are copied back to the device.
+  bool pending_ir = false;
+  int64_t to_host_bytes = 0;
+  int64_t to_device_bytes = 0;
   for (int64_t idx = 0; idx < arguments.size(); ++idx) {
     const auto& ivalue = arguments[idx];
     if (ivalue.isTensor()) {
       TF_VLOG(3) << ivalue.toTensor().toString();
     }
+    int64_t bytes = XlaTensorBytes(ivalue, &pending_ir);
+    to_host_bytes += bytes;
+    const c10::AliasInfo* alias_info = args[idx].alias_info();
+    if (alias_info != nullptr && alias_info->isWrite()) {
+      to_device_bytes += bytes;
+    }
+  }
+  if (pending_ir) {
+    metrics->graph_breaks.AddValue(1);
   }
 
   // Call the actual boxed CPU fallback.
   // Set error_on_views as XLA should take care
   // of all view ops after functionalization.
+  int64_t start_ns = runtime::sys_util::NowNs();
   at::native::cpu_fallback(op, stack, true);
+  metrics->time.AddSample(runtime::sys_util::NowNs() - start_ns);
+
+  // The returned tensors are the outputs copied to the device, or the
+  // arguments written in place, already accounted for.
+  const auto& returns = op.schema().returns();
+  auto results = torch::jit::last(stack, returns.size());
+  for (int64_t idx = 0; idx < results.size(); ++idx) {
+    const c10::AliasInfo* alias_info = returns[idx].alias_info();
+    if (alias_info == nullptr || !alias_info->isWrite()) {
+      to_device_bytes += XlaTensorBytes(results[idx], nullptr);
+    }
+  }
+  metrics->to_host_bytes.AddSample(to_host_bytes);
+  metrics->to_device_bytes.AddSample(to_device_bytes);
 }
 
 TORCH_LIBRARY_IMPL(_, XLA, m) {
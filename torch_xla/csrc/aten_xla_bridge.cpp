@@ -72,9 +72,21 @@ AtenXlaDeviceMapper* AtenXlaDeviceMapper::Get() {
   return device_mapper;
 }
 
+// Returns the XLATensorImpl of `tensor`, or of the tensor it wraps if
+// functional, without taking a reference on either, as this runs for every
+// operand of every op traced.
 XLATensorImpl* GetXlaTensorImpl(const at::Tensor& tensor) {
-  auto inner_tensor = torch::lazy::maybe_unwrap_functional(tensor);
-  return dynamic_cast<XLATensorImpl*>(inner_tensor.unsafeGetTensorImpl());
+  c10::TensorImpl* impl = tensor.unsafeGetTensorImpl();
+  if (at::functionalization::impl::isFunctionalTensor(tensor)) {
+    impl = at::functionalization::impl::unsafeGetFunctionalWrapper(tensor)
+               ->value()
+               .unsafeGetTensorImpl();
+  }
+  // The tensors of the other devices are told apart without the cast.
+  if (!impl->key_set().has(c10::DispatchKey::XLA)) {
+    return nullptr;
+  }
+  return dynamic_cast<XLATensorImpl*>(impl);
 }
 
 }  // namespace
@@ -107,6 +119,13 @@ XLATensorPtr GetXlaTensor(const at::Tensor& tensor) {
   return xtensor;
 }
 
+const XLATensorPtr& GetXlaTensorRef(const at::Tensor& tensor) {
+  XLATensorImpl* impl = GetXlaTensorImpl(tensor);
+  XLA_CHECK(impl != nullptr && impl->tensor())
+      << "Input tensor is not an XLA tensor: " << tensor.toString();
+  return impl->tensor();
+}
+
 void ReplaceXlaTensor(const at::Tensor& tensor, XLATensorPtr new_xla_tensor) {
   auto inner_tensor = torch::lazy::maybe_unwrap_functional(tensor);
   XLATensorImpl* impl =
@@ -162,6 +181,7 @@ std::vector<XLATensorPtr> GetOrCreateXlaTensors(
     absl::Span<const at::Tensor> tensors,
     const torch::lazy::BackendDevice& device) {
   std::vector<XLATensorPtr> xla_tensors;
+  xla_tensors.reserve(tensors.size());
   for (const at::Tensor& tensor : tensors) {
     xla_tensors.push_back(bridge::GetOrCreateXlaTensor(tensor, device));
   }
@@ -25,6 +25,12 @@ bool IsXlaTensor(const at::Tensor& tensor);
 // exception if tensor is not an XLA tensor.
 XLATensorPtr GetXlaTensor(const at::Tensor& tensor);
 
+// Same as above, but borrowing the XLATensorPtr held by the tensor rather than
+// copying it, for the read-only operands of the ops. The reference is valid as
+// long as `tensor` lives and its XLA tensor is not replaced, so it must not be
+// used for the operands updated in place.
+const XLATensorPtr& GetXlaTensorRef(const at::Tensor& tensor);
+
 // Replaces the XLA tensor embedded within the XLA TensorImpl with the new
 // version.
 void ReplaceXlaTensor(const at::Tensor& tensor, XLATensorPtr new_xla_tensor);
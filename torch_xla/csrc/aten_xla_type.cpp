@@ -335,11 +335,12 @@ std::pair<XLATensorPtr, XLATensorPtr> GetBinaryOperands(
     other_tensor = bridge::GetXlaTensor(other);
     self_tensor = bridge::GetOrCreateXlaTensor(self, other_tensor->GetDevice());
   } else {
-    self_tensor = self_xtensor;
+    self_tensor = std::move(self_xtensor);
     other_tensor =
         bridge::GetOrCreateXlaTensor(other, self_tensor->GetDevice());
   }
-  return std::pair<XLATensorPtr, XLATensorPtr>(self_tensor, other_tensor);
+  return std::pair<XLATensorPtr, XLATensorPtr>(std::move(self_tensor),
+                                               std::move(other_tensor));
 }
 
 // The input is in format of {N, C, H, W} and the output will be {H, W}.
@@ -382,7 +383,7 @@ template <typename B>
 at::Tensor DoBinaryOp(const at::Tensor& self, const at::Scalar& other,
                       const B& bin_op) {
   at::ScalarType dtype = at::result_type(self, other);
-  XLATensorPtr self_tensor = bridge::GetXlaTensor(self);
+  const XLATensorPtr& self_tensor = bridge::GetXlaTensorRef(self);
   XLATensorPtr result = bin_op(self_tensor, other, dtype);
   return bridge::AtenFromXlaTensor(result);
 }
@@ -391,7 +392,7 @@ template <typename B>
 at::Tensor DoBinaryOp(const at::Scalar& self, const at::Tensor& other,
                       const B& bin_op) {
   at::ScalarType dtype = at::result_type(self, other);
-  XLATensorPtr other_tensor = bridge::GetXlaTensor(other);
+  const XLATensorPtr& other_tensor = bridge::GetXlaTensorRef(other);
   XLATensorPtr result = bin_op(self, other_tensor, dtype);
   return bridge::AtenFromXlaTensor(result);
 }
@@ -409,7 +410,7 @@ at::Tensor DoBinaryOpWithoutPromo(const at::Tensor& self,
 template <typename B>
 at::Tensor DoBinaryOpWithoutPromo(const at::Tensor& self,
                                   const at::Scalar& other, const B& bin_op) {
-  XLATensorPtr self_tensor = bridge::GetXlaTensor(self);
+  const XLATensorPtr& self_tensor = bridge::GetXlaTensorRef(self);
   XLATensorPtr result = bin_op(self_tensor, other);
   return bridge::AtenFromXlaTensor(result);
 }
@@ -514,7 +515,7 @@ at::Tensor XLANativeFunctions::_adaptive_avg_pool3d(
   }
   auto common_device = torch_xla::bridge::GetXlaDevice(self);
   XLA_CHECK(common_device);
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<AdaptiveAvgPool3d>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AdaptiveAvgPool3d>(
       bridge::GetXlaTensor(self)->GetIrValue(),
       std::vector<int64_t>(output_size.begin(), output_size.end()));
   return torch_xla::bridge::AtenFromXlaTensor(
@@ -536,7 +537,7 @@ at::Tensor XLANativeFunctions::_adaptive_avg_pool3d_backward(
   }
   auto common_device = torch_xla::bridge::GetXlaDevice(grad_output, self);
   XLA_CHECK(common_device);
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<AdaptiveAvgPool3dBackward>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AdaptiveAvgPool3dBackward>(
       bridge::GetXlaTensor(grad_output)->GetIrValue(),
       bridge::GetXlaTensor(self)->GetIrValue());
 
@@ -785,8 +786,8 @@ std::tuple<at::Tensor, at::Tensor> XLANativeFunctions::_pack_padded_sequence(
 at::Tensor XLANativeFunctions::_softmax(const at::Tensor& self, int64_t dim,
                                         bool /* half_to_float */) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
-  return bridge::AtenFromXlaTensor(
-      tensor_methods::softmax(bridge::GetXlaTensor(self), dim, c10::nullopt));
+  return bridge::AtenFromXlaTensor(tensor_methods::softmax(
+      bridge::GetXlaTensorRef(self), dim, c10::nullopt));
 }
 
 at::Tensor XLANativeFunctions::_softmax_backward_data(
@@ -845,15 +846,15 @@ at::Tensor XLANativeFunctions::addmm(const at::Tensor& self,
                                                               beta, alpha);
   }
   return bridge::AtenFromXlaTensor(
-      tensor_methods::addmm(bridge::GetXlaTensor(mat1),
-                            /*weight=*/bridge::GetXlaTensor(mat2),
-                            /*bias=*/bridge::GetXlaTensor(self)));
+      tensor_methods::addmm(bridge::GetXlaTensorRef(mat1),
+                            /*weight=*/bridge::GetXlaTensorRef(mat2),
+                            /*bias=*/bridge::GetXlaTensorRef(self)));
 }
 
 at::Tensor XLANativeFunctions::alias_copy(const at::Tensor& self) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   return bridge::AtenFromXlaTensor(
-      tensor_methods::alias(bridge::GetXlaTensor(self)));
+      tensor_methods::alias(bridge::GetXlaTensorRef(self)));
 }
 
 at::Tensor& XLANativeFunctions::arange_out(const at::Scalar& start,
@@ -993,7 +994,7 @@ at::Tensor XLANativeFunctions::as_strided_scatter(
   }
   auto mutated_view_ = bridge::GetXlaTensor(mutated_view);
   return bridge::AtenFromXlaTensor(
-      base_->CreateFrom(torch::lazy::MakeNode<AsStridedViewUpdate>(
+      base_->CreateFrom(torch_xla::MakeNode<AsStridedViewUpdate>(
           base_->GetIrValue(), mutated_view_->GetIrValue(),
           torch::lazy::ToVector<int64_t>(base_->shape().get().dimensions()),
           xstride, storage_offset.value_or(0))));
@@ -1005,7 +1006,7 @@ at::Tensor XLANativeFunctions::atan2(const at::Tensor& self,
   auto common_device = torch_xla::bridge::GetXlaDevice(self, other);
   XLA_CHECK(common_device);
   torch::lazy::NodePtr node =
-      torch::lazy::MakeNode<Atan2>(bridge::GetXlaTensor(self)->GetIrValue(),
+      torch_xla::MakeNode<Atan2>(bridge::GetXlaTensor(self)->GetIrValue(),
                                    bridge::GetXlaTensor(other)->GetIrValue());
 
   return torch_xla::bridge::AtenFromXlaTensor(
@@ -1164,7 +1165,7 @@ at::Tensor XLANativeFunctions::bmm(const at::Tensor& self,
                                    const at::Tensor& mat2) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   return bridge::AtenFromXlaTensor(tensor_methods::bmm(
-      bridge::GetXlaTensor(self), bridge::GetXlaTensor(mat2)));
+      bridge::GetXlaTensorRef(self), bridge::GetXlaTensorRef(mat2)));
 }
 
 at::Tensor XLANativeFunctions::cat(const at::ITensorListRef& tensors,
@@ -1350,7 +1351,7 @@ at::Tensor XLANativeFunctions::diagonal_scatter(const at::Tensor& base,
   int64_t canonical_dim2 =
       torch::lazy::GetCanonicalDimensionIndex(dim2, base_rank);
   return bridge::AtenFromXlaTensor(
-      base_->CreateFrom(torch::lazy::MakeNode<DiagonalViewUpdate>(
+      base_->CreateFrom(torch_xla::MakeNode<DiagonalViewUpdate>(
           base_->GetIrValue(), mutated_view_->GetIrValue(), offset,
           canonical_dim1, canonical_dim2)));
 }
@@ -1464,7 +1465,7 @@ XLANativeFunctions::_embedding_bag_forward_only(
     bool sparse, const c10::optional<at::Tensor>& per_sample_weights,
     bool include_last_offset, int64_t padding_idx) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
-  if (mode == 1 || scale_grad_by_freq || sparse || padding_idx != -1) {
+  if (scale_grad_by_freq || sparse || padding_idx != -1) {
     return at::native::call_fallback_fn<
         &xla_cpu_fallback,
         ATEN_OP(_embedding_bag_forward_only)>::call(weight, indices, offsets,
@@ -1536,12 +1537,12 @@ at::Tensor XLANativeFunctions::expand_copy_symint(const at::Tensor& self,
   c10::optional<at::IntArrayRef> size = c10::asIntArrayRefSlowOpt(sym_size);
   if (size.has_value()) {
     return bridge::AtenFromXlaTensor(tensor_methods::expand(
-        bridge::GetXlaTensor(self), torch::lazy::ToVector<int64_t>(*size)));
+        bridge::GetXlaTensorRef(self), torch::lazy::ToVector<int64_t>(*size)));
   } else {
     // at least one of the dimension is symbolic, use the sym_int version of the
     // node
     return bridge::AtenFromXlaTensor(
-        tensor_methods::expand_symint(bridge::GetXlaTensor(self), sym_size));
+        tensor_methods::expand_symint(bridge::GetXlaTensorRef(self), sym_size));
   }
 }
 
@@ -1663,7 +1664,7 @@ at::Tensor XLANativeFunctions::gelu(const at::Tensor& self,
                                     c10::string_view approximate) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   return bridge::AtenFromXlaTensor(
-      tensor_methods::gelu(bridge::GetXlaTensor(self), approximate));
+      tensor_methods::gelu(bridge::GetXlaTensorRef(self), approximate));
 }
 
 at::Tensor XLANativeFunctions::gelu_backward(const at::Tensor& grad,
@@ -1831,7 +1832,7 @@ at::Tensor XLANativeFunctions::leaky_relu_backward(
   auto node_negative_slope =
       torch::lazy::LazyGraphExecutor::Get()->GetIrValueForScalarFromCodegen(
           negative_slope, *common_device);
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<LeakyReluBackward>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<LeakyReluBackward>(
       bridge::GetXlaTensor(grad_output)->GetIrValue(),
       bridge::GetXlaTensor(self)->GetIrValue(), node_negative_slope,
       self_is_result);
@@ -1892,7 +1893,7 @@ std::tuple<at::Tensor, at::Tensor> XLANativeFunctions::linalg_inv_ex(
   auto common_device = torch_xla::bridge::GetXlaDevice(self);
   TORCH_INTERNAL_ASSERT(common_device);
   torch::lazy::NodePtr node =
-      torch::lazy::MakeNode<Inverse>(bridge::GetXlaTensor(self)->GetIrValue());
+      torch_xla::MakeNode<Inverse>(bridge::GetXlaTensor(self)->GetIrValue());
   auto result = torch_xla::XLATensor::Create(std::move(node), *common_device);
   auto info = tensor_methods::full_like(result, 0, result->GetDevice(),
                                         at::ScalarType::Int);
@@ -2196,8 +2197,8 @@ at::Tensor XLANativeFunctions::mm(const at::Tensor& self,
                                   const at::Tensor& mat2) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   return bridge::AtenFromXlaTensor(
-      tensor_methods::mm(/*input=*/bridge::GetXlaTensor(self),
-                         /*weight=*/bridge::GetXlaTensor(mat2)));
+      tensor_methods::mm(/*input=*/bridge::GetXlaTensorRef(self),
+                         /*weight=*/bridge::GetXlaTensorRef(mat2)));
 }
 
 at::Tensor XLANativeFunctions::mse_loss(const at::Tensor& self,
@@ -2496,6 +2497,16 @@ at::Tensor XLANativeFunctions::nonzero(const at::Tensor& self) {
   return bridge::AtenFromXlaTensor(tensor_methods::nonzero(self_tensor));
 }
 
+at::Tensor XLANativeFunctions::nonzero_static(const at::Tensor& self,
+                                              int64_t size,
+                                              int64_t fill_value) {
+  TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
+  return bridge::AtenFromXlaTensor(
+      tensor_methods::nonzero_static(bridge::GetXlaTensor(self), size,
+                                     fill_value)
+          .first);
+}
+
 at::Tensor XLANativeFunctions::norm(const at::Tensor& self,
                                     const c10::optional<at::Scalar>& p,
                                     at::ScalarType dtype) {
@@ -2612,7 +2623,7 @@ at::Tensor XLANativeFunctions::permute_copy(const at::Tensor& self,
                                             at::IntArrayRef dims) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   return bridge::AtenFromXlaTensor(tensor_methods::permute(
-      bridge::GetXlaTensor(self), XlaHelpers::I64List(dims)));
+      bridge::GetXlaTensorRef(self), XlaHelpers::I64List(dims)));
 }
 
 at::Tensor XLANativeFunctions::pow(const at::Tensor& self,
@@ -2742,6 +2753,8 @@ void XLANativeFunctions::_propagate_xla_data(const at::Tensor& input,
     */
     output_tensor->data()->alias_id = input_tensor->data()->alias_id;
   }
+  // The updated tensor replaces the input, so it stays a step root.
+  output_tensor->data()->is_step_root = input_tensor->data()->is_step_root;
 
   // 2) Aid SPMD.
   XLATensor::ShardingSpecPtr sharding = input_tensor->sharding_spec();
@@ -3135,7 +3148,7 @@ at::Tensor XLANativeFunctions::select_copy(const at::Tensor& self, int64_t dim,
                                            int64_t index) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   return bridge::AtenFromXlaTensor(
-      tensor_methods::select(bridge::GetXlaTensor(self), dim, index));
+      tensor_methods::select(bridge::GetXlaTensorRef(self), dim, index));
 }
 
 at::Tensor XLANativeFunctions::select_scatter(const at::Tensor& base,
@@ -3153,7 +3166,7 @@ at::Tensor XLANativeFunctions::select_scatter(const at::Tensor& base,
   xla::Shape narrow_shape = base_tensor_shape;
   narrow_shape.set_dimensions(dim, 1);
   torch::lazy::NodePtr mutated_view_tensor_reshaped_node =
-      torch::lazy::MakeNode<ViewOp>(
+      torch_xla::MakeNode<ViewOp>(
           mutated_view_tensor->GetIrValue(),
           torch::lazy::ToVector<int64_t>(narrow_shape.dimensions()));
 
@@ -3162,7 +3175,7 @@ at::Tensor XLANativeFunctions::select_scatter(const at::Tensor& base,
       runtime::util::ToVector<int64_t>(base_tensor_shape.get().dimensions()),
       dim, index);
   return bridge::AtenFromXlaTensor(
-      base_tensor->CreateFrom(torch::lazy::MakeNode<UpdateSlice>(
+      base_tensor->CreateFrom(torch_xla::MakeNode<UpdateSlice>(
           base_tensor->GetIrValue(), mutated_view_tensor_reshaped_node,
           indices)));
 }
@@ -3198,8 +3211,8 @@ at::Tensor XLANativeFunctions::slice_copy(const at::Tensor& self, int64_t dim,
   int64_t start_val = start.has_value() ? start.value() : 0;
   int64_t end_val = end.has_value() ? end.value() : INT64_MAX;
   return bridge::AtenFromXlaTensor(bridge::SetBaseTensor(
-      tensor_methods::slice(bridge::GetXlaTensor(self), dim, start_val, end_val,
-                            step),
+      tensor_methods::slice(bridge::GetXlaTensorRef(self), dim, start_val,
+                            end_val, step),
       self));
 }
 
@@ -3227,7 +3240,7 @@ at::Tensor XLANativeFunctions::slice_scatter(
   step = std::min(step, end_val - start_val);
 
   return bridge::AtenFromXlaTensor(
-      base_->CreateFrom(torch::lazy::MakeNode<Unselect>(
+      base_->CreateFrom(torch_xla::MakeNode<Unselect>(
           base_->GetIrValue(), mutated_view_->GetIrValue(), dim, start_val,
           end_val, step)));
 }
@@ -3310,21 +3323,21 @@ std::vector<at::Tensor> XLANativeFunctions::split_with_sizes_copy(
 at::Tensor XLANativeFunctions::squeeze_copy(const at::Tensor& self) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   return bridge::AtenFromXlaTensor(
-      tensor_methods::squeeze(bridge::GetXlaTensor(self)));
+      tensor_methods::squeeze(bridge::GetXlaTensorRef(self)));
 }
 
 at::Tensor XLANativeFunctions::squeeze_copy(const at::Tensor& self,
                                             int64_t dim) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   return bridge::AtenFromXlaTensor(
-      tensor_methods::squeeze(bridge::GetXlaTensor(self), dim));
+      tensor_methods::squeeze(bridge::GetXlaTensorRef(self), dim));
 }
 
 at::Tensor XLANativeFunctions::squeeze_copy(const at::Tensor& self,
                                             at::IntArrayRef dim) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   return bridge::AtenFromXlaTensor(tensor_methods::squeeze(
-      bridge::GetXlaTensor(self), torch::lazy::ToVector<int64_t>(dim)));
+      bridge::GetXlaTensorRef(self), torch::lazy::ToVector<int64_t>(dim)));
 }
 
 at::Tensor XLANativeFunctions::stack(at::TensorList tensors, int64_t dim) {
@@ -3452,7 +3465,7 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> XLANativeFunctions::svd(
 at::Tensor XLANativeFunctions::t_copy(const at::Tensor& self) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   return bridge::AtenFromXlaTensor(
-      tensor_methods::transpose(bridge::GetXlaTensor(self), 0, 1));
+      tensor_methods::transpose(bridge::GetXlaTensorRef(self), 0, 1));
 }
 
 at::Tensor XLANativeFunctions::tanh_backward(const at::Tensor& grad_output,
@@ -3498,7 +3511,7 @@ at::Tensor XLANativeFunctions::transpose_copy(const at::Tensor& self,
                                               int64_t dim0, int64_t dim1) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   return bridge::AtenFromXlaTensor(
-      tensor_methods::transpose(bridge::GetXlaTensor(self), dim0, dim1));
+      tensor_methods::transpose(bridge::GetXlaTensorRef(self), dim0, dim1));
 }
 
 std::tuple<at::Tensor, at::Tensor> XLANativeFunctions::triangular_solve(
@@ -3539,7 +3552,7 @@ at::Tensor XLANativeFunctions::unsqueeze_copy(const at::Tensor& self,
                                               int64_t dim) {
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   return bridge::AtenFromXlaTensor(
-      tensor_methods::unsqueeze(bridge::GetXlaTensor(self), dim));
+      tensor_methods::unsqueeze(bridge::GetXlaTensorRef(self), dim));
 }
 
 at::Tensor XLANativeFunctions::upsample_bilinear2d(
@@ -3712,7 +3725,7 @@ at::Tensor XLANativeFunctions::view_copy_symint(const at::Tensor& self,
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   c10::optional<at::IntArrayRef> int_shape = c10::asIntArrayRefSlowOpt(shape);
   bool input_shape_static = int_shape.has_value();
-  XLATensorPtr xla_input = bridge::GetXlaTensor(self);
+  const XLATensorPtr& xla_input = bridge::GetXlaTensorRef(self);
   bool input_has_dyn_shape = xla_input->shape().get().is_dynamic();
 
   XLA_CHECK(!(input_has_dyn_shape && input_shape_static))
@@ -3808,13 +3821,18 @@ XLANativeFunctions::native_group_norm(const at::Tensor& input,
 at::Tensor XLANativeFunctions::_cdist_forward(
     const at::Tensor& x1, const at::Tensor& x2, double p,
     c10::optional<int64_t> compute_mode) {
-  // compute_mode is ignored because the use_mm_for_euclid_dist lowering
-  // (compute_mode is 0 or 1) is achieved through composite ops from
-  // native pytorch.
   TORCH_LAZY_FN_COUNTER_TIMED_TRACING("xla::");
   XLA_CHECK(p >= 0) << "p value for the p-norm distance must be >= 0";
+  // torch.cdist itself takes the composite matmul path for the large p == 2
+  // inputs, while the graphs calling _cdist_forward directly get the same
+  // choice here: compute_mode 1 always uses the matmul, 2 never, and the
+  // default one beyond 25 rows.
+  int64_t mode = compute_mode.value_or(0);
+  bool use_mm_for_euclid_dist =
+      mode == 1 || (mode == 0 && (x1.size(-2) > 25 || x2.size(-2) > 25));
   return bridge::AtenFromXlaTensor(tensor_methods::cdist_forward(
-      bridge::GetXlaTensor(x1), bridge::GetXlaTensor(x2), p));
+      bridge::GetXlaTensor(x1), bridge::GetXlaTensor(x2), p,
+      use_mm_for_euclid_dist));
 }
 
 at::Tensor XLANativeFunctions::_pdist_forward(const at::Tensor& self,
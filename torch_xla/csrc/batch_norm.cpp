@@ -1,6 +1,10 @@
 #include "torch_xla/csrc/batch_norm.h"
 
+#include <tuple>
+#include <vector>
+
 #include "torch_xla/csrc/helpers.h"
+#include "torch_xla/csrc/reduction.h"
 #include "torch_xla/csrc/shape_helper.h"
 #include "xla/client/lib/constants.h"
 #include "xla/client/xla_builder.h"
@@ -45,11 +49,32 @@ BatchNormOutput BuildBatchNormTraining(xla::XlaOp input, xla::XlaOp weight,
   if (is_batchnorm_with_fp16_inputs) {
     input = xla::ConvertElementType(input, xla::PrimitiveType::F32);
   }
-  xla::XlaOp outputs = xla::BatchNormTraining(input, weight, bias, eps_value,
-                                              /*feature_index=*/1);
-  xla::XlaOp output = xla::GetTupleElement(outputs, 0);
-  xla::XlaOp batch_mean = xla::GetTupleElement(outputs, 1);
-  xla::XlaOp batch_variance = xla::GetTupleElement(outputs, 2);
+  xla::XlaOp output;
+  xla::XlaOp batch_mean;
+  xla::XlaOp batch_variance;
+  const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
+  if (UseWelfordVariance() && !input_shape.is_dynamic()) {
+    // The batch statistics come from a single pass over the input, which is
+    // then only read once more to be normalized.
+    std::vector<int64_t> reduced_dimensions;
+    for (int64_t i = 0; i < input_shape.rank(); ++i) {
+      if (i != 1) {
+        reduced_dimensions.push_back(i);
+      }
+    }
+    std::tie(batch_variance, batch_mean) =
+        BuildVarMean(input, reduced_dimensions, /*correction=*/0,
+                     /*keep_reduced_dimensions=*/false);
+    output = xla::BatchNormInference(input, weight, bias, batch_mean,
+                                     batch_variance, eps_value,
+                                     /*feature_index=*/1);
+  } else {
+    xla::XlaOp outputs = xla::BatchNormTraining(input, weight, bias, eps_value,
+                                                /*feature_index=*/1);
+    output = xla::GetTupleElement(outputs, 0);
+    batch_mean = xla::GetTupleElement(outputs, 1);
+    batch_variance = xla::GetTupleElement(outputs, 2);
+  }
   if (is_batchnorm_with_fp16_inputs) {
     output = xla::ConvertElementType(output, xla::PrimitiveType::F16);
   }
@@ -1,7 +1,16 @@
 #include "torch_xla/csrc/convolution.h"
 
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <functional>
+#include <numeric>
+#include <vector>
+
+#include "torch_xla/csrc/aten_xla_bridge.h"
+#include "torch_xla/csrc/device.h"
 #include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/shape_helper.h"
 #include "torch_xla/csrc/xla_lower_util.h"
 #include "xla/client/lib/constants.h"
@@ -288,6 +297,269 @@ xla::XlaOp BuildTransposedConvolution(xla::XlaOp input, xla::XlaOp kernel,
       stride, padding, dilation, /*groups=*/1);
 }
 
+// The number of kernel taps up to which the depthwise convolutions are lowered
+// as sums of shifted products rather than as grouped convolutions, whose
+// filter gradient is a batch grouped convolution. The products are
+// elementwise and fuse, which is faster on TPU for the small kernels of the
+// MobileNet and EfficientNet style networks.
+int64_t DepthwiseMaxTaps() {
+  static const int64_t max_taps = []() -> int64_t {
+    int64_t value =
+        runtime::sys_util::GetEnvInt("XLA_DEPTHWISE_CONV_MAX_TAPS", -1);
+    if (value >= 0) {
+      return value;
+    }
+    XlaDeviceType hw_type =
+        static_cast<XlaDeviceType>(bridge::GetCurrentDevice().type());
+    return CheckTpuDevice(hw_type) ? 25 : 0;
+  }();
+  return max_taps;
+}
+
+// Whether the convolution of the NCHW `input_shape` with `kernel_shape` is a
+// depthwise one, each input channel convolved with its own filters, lowered
+// by taps.
+bool UseDepthwiseTaps(const xla::Shape& input_shape,
+                      const xla::Shape& kernel_shape, int64_t groups) {
+  if (groups == 1 || input_shape.dimensions(1) != groups ||
+      kernel_shape.dimensions(1) != 1 || !input_shape.is_static() ||
+      !kernel_shape.is_static()) {
+    return false;
+  }
+  int64_t taps = 1;
+  for (int64_t i = 2; i < kernel_shape.rank(); ++i) {
+    taps *= kernel_shape.dimensions(i);
+  }
+  return taps <= DepthwiseMaxTaps();
+}
+
+// The geometry of a depthwise convolution lowered by taps. The kernel taps are
+// visited in row major order, which is the one of the kernel.
+struct DepthwiseConv {
+  DepthwiseConv(const xla::Shape& input_shape, const xla::Shape& kernel_shape,
+                absl::Span<const int64_t> stride,
+                absl::Span<const int64_t> padding,
+                absl::Span<const int64_t> dilation)
+      : stride(stride.begin(), stride.end()),
+        padding(padding.begin(), padding.end()),
+        dilation(dilation.begin(), dilation.end()) {
+    batch = input_shape.dimensions(0);
+    channels = input_shape.dimensions(1);
+    output_channels = kernel_shape.dimensions(0);
+    for (int64_t i = 2; i < input_shape.rank(); ++i) {
+      int64_t padded_size = input_shape.dimensions(i) + 2 * padding[i - 2];
+      padded_sizes.push_back(padded_size);
+      kernel_sizes.push_back(kernel_shape.dimensions(i));
+      output_sizes.push_back(
+          (padded_size - dilation[i - 2] * (kernel_sizes.back() - 1) - 1) /
+              stride[i - 2] +
+          1);
+    }
+  }
+
+  void ForEachTap(
+      const std::function<void(absl::Span<const int64_t>)>& fn) const {
+    int64_t taps = std::accumulate(kernel_sizes.begin(), kernel_sizes.end(),
+                                   int64_t{1}, std::multiplies<int64_t>());
+    std::vector<int64_t> tap(kernel_sizes.size(), 0);
+    for (int64_t t = 0; t < taps; ++t) {
+      fn(tap);
+      for (int64_t i = tap.size() - 1; i >= 0; --i) {
+        if (++tap[i] < kernel_sizes[i]) {
+          break;
+        }
+        tap[i] = 0;
+      }
+    }
+  }
+
+  // The [N, Cout, output...] window of `padded` [N, Cout, padded...] seen by
+  // the kernel `tap`.
+  xla::XlaOp Window(xla::XlaOp padded, absl::Span<const int64_t> tap) const {
+    std::vector<int64_t> starts = {0, 0};
+    std::vector<int64_t> limits = {batch, output_channels};
+    std::vector<int64_t> strides = {1, 1};
+    for (size_t i = 0; i < tap.size(); ++i) {
+      starts.push_back(tap[i] * dilation[i]);
+      limits.push_back(starts.back() + (output_sizes[i] - 1) * stride[i] + 1);
+      strides.push_back(stride[i]);
+    }
+    return xla::Slice(padded, starts, limits, strides);
+  }
+
+  // The weights of the kernel `tap`, broadcast to [N, Cout, output...].
+  xla::XlaOp TapWeight(xla::XlaOp kernel, absl::Span<const int64_t> tap) const {
+    std::vector<int64_t> starts = {0, 0};
+    std::vector<int64_t> limits = {output_channels, 1};
+    for (int64_t index : tap) {
+      starts.push_back(index);
+      limits.push_back(index + 1);
+    }
+    std::vector<int64_t> strides(starts.size(), 1);
+    return xla::BroadcastInDim(
+        xla::Reshape(xla::Slice(kernel, starts, limits, strides),
+                     {output_channels}),
+        OutputDims(), {1});
+  }
+
+  std::vector<int64_t> OutputDims() const {
+    std::vector<int64_t> dims = {batch, output_channels};
+    dims.insert(dims.end(), output_sizes.begin(), output_sizes.end());
+    return dims;
+  }
+
+  int64_t multiplier() const { return output_channels / channels; }
+
+  int64_t batch;
+  int64_t channels;
+  int64_t output_channels;
+  std::vector<int64_t> padded_sizes;
+  std::vector<int64_t> kernel_sizes;
+  std::vector<int64_t> output_sizes;
+  std::vector<int64_t> stride;
+  std::vector<int64_t> padding;
+  std::vector<int64_t> dilation;
+};
+
+// The products of the taps are accumulated in F32 for the 16 bit types.
+xla::PrimitiveType DepthwiseAccumulationType(xla::PrimitiveType type) {
+  return type == xla::PrimitiveType::BF16 || type == xla::PrimitiveType::F16
+             ? xla::PrimitiveType::F32
+             : type;
+}
+
+// Pads the spatial dimensions of the [N, C, ...] `input` and repeats each
+// channel for the filters of its group, giving [N, Cout, padded...].
+xla::XlaOp PadAndRepeatChannels(xla::XlaOp input, const DepthwiseConv& conv) {
+  const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
+  xla::PaddingConfig padding_config;
+  for (int64_t i = 0; i < input_shape.rank(); ++i) {
+    auto* dims = padding_config.add_dimensions();
+    int64_t pad = i < 2 ? 0 : conv.padding[i - 2];
+    dims->set_edge_padding_low(pad);
+    dims->set_edge_padding_high(pad);
+    dims->set_interior_padding(0);
+  }
+  xla::XlaOp padded = xla::Pad(
+      input, xla::Zero(input.builder(), input_shape.element_type()),
+      padding_config);
+  if (conv.multiplier() == 1) {
+    return padded;
+  }
+  std::vector<int64_t> repeated_dims = {conv.batch, conv.channels,
+                                        conv.multiplier()};
+  std::vector<int64_t> broadcast_dims = {0, 1};
+  for (size_t i = 0; i < conv.padded_sizes.size(); ++i) {
+    repeated_dims.push_back(conv.padded_sizes[i]);
+    broadcast_dims.push_back(3 + i);
+  }
+  std::vector<int64_t> output_dims = {conv.batch, conv.output_channels};
+  output_dims.insert(output_dims.end(), conv.padded_sizes.begin(),
+                     conv.padded_sizes.end());
+  return xla::Reshape(
+      xla::BroadcastInDim(padded, repeated_dims, broadcast_dims), output_dims);
+}
+
+// The depthwise convolution, as the sum over the kernel taps of the windows of
+// the input multiplied by the weights of the taps.
+xla::XlaOp BuildDepthwiseConvolution(xla::XlaOp input, xla::XlaOp kernel,
+                                     const DepthwiseConv& conv) {
+  TORCH_LAZY_COUNTER("DepthwiseConvTaps", 1);
+  xla::PrimitiveType type = ShapeHelper::ShapeOfXlaOp(input).element_type();
+  xla::PrimitiveType accumulation_type = DepthwiseAccumulationType(type);
+  xla::XlaOp padded = PadAndRepeatChannels(input, conv);
+  xla::XlaOp output = xla::Broadcast(
+      xla::Zero(input.builder(), accumulation_type), conv.OutputDims());
+  conv.ForEachTap([&](absl::Span<const int64_t> tap) {
+    output = output +
+             xla::ConvertElementType(conv.Window(padded, tap),
+                                     accumulation_type) *
+                 xla::ConvertElementType(conv.TapWeight(kernel, tap),
+                                         accumulation_type);
+  });
+  return xla::ConvertElementType(output, type);
+}
+
+ConvGrads BuildDepthwiseConvolutionBackward(xla::XlaOp grad_output,
+                                            xla::XlaOp input,
+                                            xla::XlaOp kernel,
+                                            const DepthwiseConv& conv) {
+  TORCH_LAZY_COUNTER("DepthwiseConvTaps", 1);
+  xla::PrimitiveType type = ShapeHelper::ShapeOfXlaOp(input).element_type();
+  xla::PrimitiveType accumulation_type = DepthwiseAccumulationType(type);
+  xla::XlaBuilder* builder = input.builder();
+  xla::XlaOp zero = xla::Zero(builder, accumulation_type);
+  xla::XlaOp padded = PadAndRepeatChannels(input, conv);
+  xla::XlaOp grad = xla::ConvertElementType(grad_output, accumulation_type);
+  std::vector<int64_t> reduce_dims = {0};
+  for (size_t i = 0; i < conv.output_sizes.size(); ++i) {
+    reduce_dims.push_back(2 + i);
+  }
+  std::vector<int64_t> padded_dims = {conv.batch, conv.output_channels};
+  padded_dims.insert(padded_dims.end(), conv.padded_sizes.begin(),
+                     conv.padded_sizes.end());
+  // The filter gradient of each tap reduces the products of the gradient
+  // with its window, and the input gradient scatters back the products of
+  // the gradient with its weights into the window.
+  std::vector<xla::XlaOp> grad_weights;
+  xla::XlaOp grad_padded = xla::Broadcast(zero, padded_dims);
+  conv.ForEachTap([&](absl::Span<const int64_t> tap) {
+    xla::XlaOp window =
+        xla::ConvertElementType(conv.Window(padded, tap), accumulation_type);
+    grad_weights.push_back(xla::Reshape(
+        xla::Reduce(grad * window, zero,
+                    XlaHelpers::CreateAddComputation(accumulation_type),
+                    reduce_dims),
+        {conv.output_channels, 1}));
+    xla::PaddingConfig padding_config;
+    for (int64_t i = 0; i < 2; ++i) {
+      auto* dims = padding_config.add_dimensions();
+      dims->set_edge_padding_low(0);
+      dims->set_edge_padding_high(0);
+      dims->set_interior_padding(0);
+    }
+    for (size_t i = 0; i < tap.size(); ++i) {
+      auto* dims = padding_config.add_dimensions();
+      int64_t low = tap[i] * conv.dilation[i];
+      dims->set_edge_padding_low(low);
+      dims->set_edge_padding_high(conv.padded_sizes[i] - low -
+                                  (conv.output_sizes[i] - 1) * conv.stride[i] -
+                                  1);
+      dims->set_interior_padding(conv.stride[i] - 1);
+    }
+    xla::XlaOp product = grad * xla::ConvertElementType(
+                                    conv.TapWeight(kernel, tap),
+                                    accumulation_type);
+    grad_padded = grad_padded + xla::Pad(product, zero, padding_config);
+  });
+  // The gradients of the repeated channels add up.
+  if (conv.multiplier() > 1) {
+    std::vector<int64_t> grouped_dims = {conv.batch, conv.channels,
+                                         conv.multiplier()};
+    grouped_dims.insert(grouped_dims.end(), conv.padded_sizes.begin(),
+                        conv.padded_sizes.end());
+    grad_padded = xla::Reduce(
+        xla::Reshape(grad_padded, grouped_dims), zero,
+        XlaHelpers::CreateAddComputation(accumulation_type), {2});
+  }
+  std::vector<int64_t> starts = {0, 0};
+  std::vector<int64_t> limits = {conv.batch, conv.channels};
+  for (size_t i = 0; i < conv.padded_sizes.size(); ++i) {
+    starts.push_back(conv.padding[i]);
+    limits.push_back(conv.padded_sizes[i] - conv.padding[i]);
+  }
+  std::vector<int64_t> strides(starts.size(), 1);
+  xla::XlaOp grad_input = xla::ConvertElementType(
+      xla::Slice(grad_padded, starts, limits, strides), type);
+  std::vector<int64_t> kernel_dims = {conv.output_channels, 1};
+  kernel_dims.insert(kernel_dims.end(), conv.kernel_sizes.begin(),
+                     conv.kernel_sizes.end());
+  xla::XlaOp grad_weight = xla::ConvertElementType(
+      xla::Reshape(xla::ConcatInDim(builder, grad_weights, 1), kernel_dims),
+      type);
+  return {grad_input, grad_weight, BuildGradBias(grad_output)};
+}
+
 ConvGrads BuildTransposedConvolutionBackward(
     xla::XlaOp grad_output, xla::XlaOp input, xla::XlaOp kernel,
     absl::Span<const int64_t> stride, absl::Span<const int64_t> padding,
@@ -319,6 +591,13 @@ xla::XlaOp BuildConvolutionOverrideable(
     return BuildTransposedConvolution(input, kernel, stride, padding, dilation,
                                       output_padding, groups);
   } else {
+    const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
+    const xla::Shape& kernel_shape = ShapeHelper::ShapeOfXlaOp(kernel);
+    if (UseDepthwiseTaps(input_shape, kernel_shape, groups)) {
+      return BuildDepthwiseConvolution(
+          input, kernel,
+          DepthwiseConv(input_shape, kernel_shape, stride, padding, dilation));
+    }
     auto dims_padding = MakePadding(padding);
     xla::PrecisionConfig precision_config =
         XlaHelpers::BuildPrecisionConfig(XlaHelpers::mat_mul_precision());
@@ -379,6 +658,13 @@ ConvGrads BuildConvolutionBackwardOverrideable(
                                               stride, padding, dilation,
                                               output_padding, groups);
   } else {
+    const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
+    const xla::Shape& kernel_shape = ShapeHelper::ShapeOfXlaOp(kernel);
+    if (UseDepthwiseTaps(input_shape, kernel_shape, groups)) {
+      return BuildDepthwiseConvolutionBackward(
+          grad_output, input, kernel,
+          DepthwiseConv(input_shape, kernel_shape, stride, padding, dilation));
+    }
     xla::XlaOp grad_input = BuildConvBackwardInput(
         grad_output, kernel, ShapeHelper::ShapeOfXlaOp(input), stride, padding,
         dilation, groups);
@@ -1,8 +1,12 @@
 #include "torch_xla/csrc/cross_replica_reduces.h"
 
+#include <torch/csrc/lazy/core/metrics.h>
 #include <torch/csrc/lazy/core/util.h>
 
+#include <algorithm>
+#include <limits>
 #include <map>
+#include <numeric>
 
 #include "torch/csrc/lazy/core/util.h"
 #include "torch_xla/csrc/aten_xla_bridge.h"
@@ -10,12 +14,18 @@
 #include "torch_xla/csrc/device.h"
 #include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/layout_manager.h"
+#include "torch_xla/csrc/ops/ops.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/runtime.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/util.h"
 #include "torch_xla/csrc/shape_helper.h"
 #include "torch_xla/csrc/tensor_methods.h"
 #include "torch_xla/csrc/token_handler.h"
 #include "torch_xla/csrc/xla_graph_executor.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/client/lib/constants.h"
+#include "xla/client/lib/slicing.h"
 #include "xla/shape_util.h"
 
 namespace torch_xla {
@@ -26,6 +36,9 @@ namespace {
 // the 8 cores. Therefore, we need different tokens for different threads.
 std::unordered_map<int64_t, std::shared_ptr<torch::lazy::Value>>
     g_all_reduce_tokens;
+// The channel tokens, by device ordinal and channel id.
+std::map<std::pair<int64_t, int64_t>, std::shared_ptr<torch::lazy::Value>>
+    g_channel_tokens;
 
 struct PerTypeContext {
   std::vector<xla::XlaOp> ops;
@@ -94,11 +107,197 @@ std::vector<xla::ReplicaGroup> CreateReduceGroups(
   return reduce_groups;
 }
 
+// The bytes of operands from which the all-reduces are lowered hierarchically,
+// or zero if they never are.
+int64_t HierarchicalAllReduceBytes() {
+  static const int64_t hierarchical_bytes =
+      runtime::sys_util::GetEnvInt("XLA_HIERARCHICAL_ALL_REDUCE_BYTES", 0);
+  return hierarchical_bytes;
+}
+
+// The number of replicas per host, which defaults to the devices of all the
+// processes on the host.
+int64_t GetHostSize() {
+  static const int64_t host_size = runtime::sys_util::GetEnvInt(
+      "XLA_ALL_REDUCE_HOST_SIZE",
+      runtime::sys_util::GetEnvInt("LOCAL_WORLD_SIZE", 1) *
+          runtime::GetComputationClient()->GetLocalDevices().size());
+  return host_size;
+}
+
+bool IsHierarchical(const PerTypeContext& ctx) {
+  int64_t bytes = 0;
+  for (const xla::Shape& shape : ctx.operand_shapes) {
+    if (!shape.IsArray() || shape.is_dynamic()) {
+      return false;
+    }
+    bytes += xla::ShapeUtil::ByteSizeOf(shape);
+  }
+  return bytes >= HierarchicalAllReduceBytes();
+}
+
+// Reduces the operands of `ctx` as a reduce-scatter within the hosts, an
+// all-reduce of the scattered shards across the hosts and an all-gather within
+// the hosts, of the operands flattened and concatenated.
+std::vector<xla::XlaOp> BuildHierarchicalAllReduce(
+    AllReduceType reduce_type, xla::PrimitiveType type,
+    const PerTypeContext& ctx, const HierarchicalReduceGroups& hierarchy) {
+  xla::XlaBuilder* builder = ctx.ops.front().builder();
+  std::vector<xla::XlaOp> flat_ops;
+  int64_t size = 0;
+  for (size_t i = 0; i < ctx.ops.size(); ++i) {
+    int64_t op_size = xla::ShapeUtil::ElementsIn(ctx.operand_shapes[i]);
+    flat_ops.push_back(xla::Reshape(ctx.ops[i], {op_size}));
+    size += op_size;
+  }
+  xla::XlaOp flat = xla::ConcatInDim(builder, flat_ops, 0);
+  int64_t shard_count = hierarchy.intra_host.front().size();
+  int64_t padding = (shard_count - size % shard_count) % shard_count;
+  if (padding > 0) {
+    // The padding is reduced along and dropped.
+    flat = xla::PadInDim(flat, xla::Zero(builder, type), 0, 0, padding);
+  }
+  xla::XlaComputation computation = GetReduceComutation(reduce_type, type);
+  std::vector<xla::ReplicaGroup> intra_groups =
+      CreateReduceGroups(hierarchy.intra_host);
+  xla::XlaOp shard = xla::ReduceScatter(flat, computation,
+                                        /*scatter_dimension=*/0, shard_count,
+                                        intra_groups);
+  shard = xla::AllReduce(shard, computation,
+                         CreateReduceGroups(hierarchy.inter_host));
+  flat = xla::AllGather(shard, 0, shard_count, intra_groups);
+  TORCH_LAZY_COUNTER("HierarchicalAllReduce", 1);
+
+  std::vector<xla::XlaOp> results;
+  int64_t offset = 0;
+  for (const xla::Shape& shape : ctx.operand_shapes) {
+    int64_t op_size = xla::ShapeUtil::ElementsIn(shape);
+    xla::XlaOp result = xla::SliceInDim(flat, offset, offset + op_size, 1, 0);
+    results.push_back(xla::Reshape(result, shape.dimensions()));
+    offset += op_size;
+  }
+  return results;
+}
+
+// Lays out the `split_count` chunks of `input` along `split_dimension` as the
+// rows of a matrix.
+xla::XlaOp ChunksToRows(xla::XlaOp input, const xla::Shape& shape,
+                        int64_t split_dimension, int64_t split_count) {
+  std::vector<int64_t> dims(shape.dimensions().begin(),
+                            shape.dimensions().end());
+  XLA_CHECK_EQ(dims[split_dimension] % split_count, 0)
+      << "Dimension " << split_dimension << " of shape "
+      << shape.ToString() << " is not divisible by " << split_count;
+  dims[split_dimension] /= split_count;
+  dims.insert(dims.begin() + split_dimension, split_count);
+  std::vector<int64_t> permutation(dims.size());
+  std::iota(permutation.begin(), permutation.end(), 0);
+  std::rotate(permutation.begin(), permutation.begin() + split_dimension,
+              permutation.begin() + split_dimension + 1);
+  xla::XlaOp rows = xla::Transpose(xla::Reshape(input, dims), permutation);
+  return xla::Reshape(
+      rows, {split_count, xla::ShapeUtil::ElementsIn(shape) / split_count});
+}
+
+// The inverse of ChunksToRows() for the all-to-all result: concatenates the
+// rows received from the `split_count` replicas, as chunks of `shape`, along
+// `concat_dimension`.
+xla::XlaOp RowsToResult(xla::XlaOp rows, const xla::Shape& shape,
+                        int64_t split_dimension, int64_t concat_dimension,
+                        int64_t split_count) {
+  std::vector<int64_t> dims(shape.dimensions().begin(),
+                            shape.dimensions().end());
+  dims[split_dimension] /= split_count;
+  std::vector<int64_t> result_dims = dims;
+  result_dims[concat_dimension] *= split_count;
+  dims.insert(dims.begin(), split_count);
+  std::vector<int64_t> permutation(dims.size());
+  std::iota(permutation.begin(), permutation.end(), 0);
+  std::rotate(permutation.begin(), permutation.begin() + 1,
+              permutation.begin() + concat_dimension + 1);
+  xla::XlaOp chunks = xla::Transpose(xla::Reshape(rows, dims), permutation);
+  return xla::Reshape(chunks, result_dims);
+}
+
+// The pairs rotating the blocks of each ring of `groups` to the next replica.
+std::vector<std::pair<int64_t, int64_t>> GetRingPairs(
+    const std::vector<std::vector<int64_t>>& groups) {
+  XLA_CHECK(!groups.empty()) << "Ring attention needs explicit rings";
+  std::vector<std::pair<int64_t, int64_t>> pairs;
+  for (const std::vector<int64_t>& group : groups) {
+    XLA_CHECK_EQ(group.size(), groups.front().size())
+        << "The rings must have the same size";
+    for (size_t i = 0; i < group.size(); ++i) {
+      pairs.emplace_back(group[i], group[(i + 1) % group.size()]);
+    }
+  }
+  return pairs;
+}
+
+// The position of the replica in its ring of `groups`, as an S32 scalar.
+xla::XlaOp GetRingPosition(xla::XlaBuilder* builder,
+                           const std::vector<std::vector<int64_t>>& groups) {
+  std::vector<int32_t> positions;
+  for (const std::vector<int64_t>& group : groups) {
+    for (size_t i = 0; i < group.size(); ++i) {
+      if (group[i] >= static_cast<int64_t>(positions.size())) {
+        positions.resize(group[i] + 1, 0);
+      }
+      positions[group[i]] = i;
+    }
+  }
+  xla::XlaOp replica =
+      xla::ConvertElementType(xla::ReplicaId(builder), xla::PrimitiveType::S32);
+  xla::XlaOp position = xla::DynamicSlice(
+      xla::ConstantR1<int32_t>(builder, positions), {replica}, {1});
+  return xla::Reshape(position, {});
+}
+
+// The scaled attention scores [..., query rows, key rows] of `query` over the
+// `key` block which travelled `step` hops around the ring. With a `position`
+// in the ring, the scores of the keys past the queries in the sequence are
+// masked out.
+xla::XlaOp RingAttentionScores(xla::XlaOp query, xla::XlaOp key, double scale,
+                               xla::XlaOp position, int64_t step,
+                               int64_t ring_size) {
+  xla::XlaBuilder* builder = query.builder();
+  xla::XlaOp scores =
+      BuildAttentionDot(query, 1, key, 1) *
+      XlaHelpers::ScalarValue<float>(scale, xla::PrimitiveType::F32, builder);
+  if (!position.valid()) {
+    return scores;
+  }
+  xla::Shape index_shape = ShapeHelper::ShapeOfXlaOp(scores);
+  index_shape.set_element_type(xla::PrimitiveType::S32);
+  int64_t rank = index_shape.rank();
+  // The key block held at `step` comes from `step` replicas before.
+  xla::XlaOp block =
+      xla::Rem(position + xla::ConstantR0<int32_t>(builder, ring_size - step),
+               xla::ConstantR0<int32_t>(builder, ring_size));
+  xla::XlaOp rows =
+      xla::Iota(builder, index_shape, rank - 2) +
+      position * xla::ConstantR0<int32_t>(builder,
+                                          index_shape.dimensions(rank - 2));
+  xla::XlaOp columns =
+      xla::Iota(builder, index_shape, rank - 1) +
+      block * xla::ConstantR0<int32_t>(builder,
+                                       index_shape.dimensions(rank - 1));
+  xla::XlaOp masked = xla::Broadcast(
+      xla::MinValue(builder, xla::PrimitiveType::F32),
+      index_shape.dimensions());
+  return xla::Select(xla::Le(columns, rows), scores, masked);
+}
+
 std::shared_ptr<torch::lazy::Value> CreateToken(
     const torch::lazy::BackendDevice& device) {
   // This should be using xla::CreateToken() once we have added Token support to
   // XLA AllReduce(). Meanwhile we use a constant as token, and we handle it
   // accordingly in cross_replica_reduces.cpp.
+  if (TokenHandler::UseBarriers()) {
+    // The optimization barriers keep the constant, and its sequencing effects.
+    return std::make_shared<torch::lazy::Value>(
+        ScalarOp(0.0, xla::PrimitiveType::F32));
+  }
   // This needs to be device data (hence coming in as XLA computation parameter)
   // as otherwise the XLA compiler passes will remove it, vanishing its
   // sequencing effects.
@@ -107,6 +306,24 @@ std::shared_ptr<torch::lazy::Value> CreateToken(
   return std::make_shared<torch::lazy::Value>(std::move(ir_value));
 }
 
+// The XLA token of a send or receive sequenced by `token`, which is either an
+// XLA token or the numeric token of the collectives.
+xla::XlaOp GetXlaToken(xla::XlaOp token) {
+  if (ShapeHelper::ShapeOfXlaOp(token).IsToken()) {
+    return token;
+  }
+  return TokenHandler::After(xla::CreateToken(token.builder()), token);
+}
+
+// The token following a send or receive sequenced by `token`, of the same kind,
+// given the XLA token produced by the operation.
+xla::XlaOp GetNextToken(xla::XlaOp token, xla::XlaOp xla_token) {
+  if (ShapeHelper::ShapeOfXlaOp(token).IsToken()) {
+    return xla_token;
+  }
+  return TokenHandler::After(token, xla_token);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 // The traceable collectives integration follows here, listed in alphabetical
 // order. RFC: https://github.com/pytorch/pytorch/issues/93173
@@ -136,34 +353,64 @@ std::vector<xla::XlaOp> BuildAllReduce(
     xla::XlaOp token, double scale,
     const std::vector<std::vector<int64_t>>& groups, bool pin_layout) {
   std::vector<xla::ReplicaGroup> reduce_groups = CreateReduceGroups(groups);
+  std::optional<HierarchicalReduceGroups> hierarchy;
+  if (HierarchicalAllReduceBytes() > 0) {
+    hierarchy = GetHierarchicalReduceGroups(
+        groups, runtime::GetComputationClient()->GetAllDevices().size(),
+        GetHostSize());
+  }
   // TODO: We use pseudo-tokens ATM, which are real values. This need to be
   // switched to use the real XLA Token once support has been added to XLA
   // AllReduce().
   xla::XlaOp chained_token = token;
+  // With the optimization barriers, the token is only ordered with the
+  // operands, rather than reduced along with them.
+  bool use_barriers = TokenHandler::UseBarriers();
   ReduceContext redux = GetReduceContext(operands);
   std::vector<xla::XlaOp> result(operands.size());
   for (auto& type_ctx : redux.contexts) {
-    xla::XlaOp token_op = MaybeConvertTo(chained_token, type_ctx.first);
-    type_ctx.second.ops.push_back(token_op);
-    type_ctx.second.operand_shapes.push_back(
-        ShapeHelper::ShapeOfXlaOp(token_op));
+    bool hierarchical = hierarchy && IsHierarchical(type_ctx.second);
+    TokenHandler token_handler(chained_token);
+    if (use_barriers || hierarchical) {
+      type_ctx.second.ops[0] = token_handler.GetInput(
+          type_ctx.second.ops[0], &type_ctx.second.operand_shapes[0]);
+    } else {
+      xla::XlaOp token_op = MaybeConvertTo(chained_token, type_ctx.first);
+      type_ctx.second.ops.push_back(token_op);
+      type_ctx.second.operand_shapes.push_back(
+          ShapeHelper::ShapeOfXlaOp(token_op));
+    }
 
-    xla::XlaOp reduce;
-    if (pin_layout) {
-      reduce = xla::AllReduce(
-          xla::Tuple(operands[0].builder(), type_ctx.second.ops),
-          GetReduceComutation(reduce_type, type_ctx.first), reduce_groups,
-          /*channel_id=*/absl::nullopt,
-          /*shape_with_layout=*/
-          MakeReduceShape(type_ctx.second.operand_shapes));
+    std::vector<xla::XlaOp> reduced;
+    if (hierarchical) {
+      reduced = BuildHierarchicalAllReduce(reduce_type, type_ctx.first,
+                                           type_ctx.second, *hierarchy);
+      chained_token = token_handler.GetNewToken(reduced.front());
     } else {
-      reduce = xla::AllReduce(
-          xla::Tuple(operands[0].builder(), type_ctx.second.ops),
-          GetReduceComutation(reduce_type, type_ctx.first), reduce_groups);
+      xla::XlaOp reduce;
+      if (pin_layout) {
+        reduce = xla::AllReduce(
+            xla::Tuple(operands[0].builder(), type_ctx.second.ops),
+            GetReduceComutation(reduce_type, type_ctx.first), reduce_groups,
+            /*channel_id=*/absl::nullopt,
+            /*shape_with_layout=*/
+            MakeReduceShape(type_ctx.second.operand_shapes));
+      } else {
+        reduce = xla::AllReduce(
+            xla::Tuple(operands[0].builder(), type_ctx.second.ops),
+            GetReduceComutation(reduce_type, type_ctx.first), reduce_groups);
+      }
+      for (size_t i = 0; i < type_ctx.second.indices.size(); ++i) {
+        reduced.push_back(xla::GetTupleElement(reduce, i));
+      }
+      chained_token =
+          use_barriers
+              ? token_handler.GetNewToken(reduce)
+              : xla::GetTupleElement(reduce, type_ctx.second.indices.size());
     }
     for (size_t i = 0; i < type_ctx.second.indices.size(); ++i) {
       size_t op_idx = type_ctx.second.indices[i];
-      xla::XlaOp gte = xla::GetTupleElement(reduce, i);
+      xla::XlaOp gte = reduced[i];
       if (scale != 1.0) {
         xla::XlaOp scaling_value = XlaHelpers::ScalarValue<float>(
             scale, type_ctx.second.operand_shapes[i].element_type(),
@@ -172,14 +419,56 @@ std::vector<xla::XlaOp> BuildAllReduce(
       }
       result[op_idx] = gte;
     }
-    chained_token =
-        xla::GetTupleElement(reduce, type_ctx.second.indices.size());
   }
   result.push_back(
       MaybeConvertTo(chained_token, XlaHelpers::TypeOfXlaOp(token)));
   return result;
 }
 
+std::optional<HierarchicalReduceGroups> GetHierarchicalReduceGroups(
+    const std::vector<std::vector<int64_t>>& groups, int64_t num_replicas,
+    int64_t host_size) {
+  if (host_size <= 1) {
+    return std::nullopt;
+  }
+  std::vector<std::vector<int64_t>> all_replicas;
+  if (groups.empty()) {
+    all_replicas.emplace_back(num_replicas);
+    std::iota(all_replicas[0].begin(), all_replicas[0].end(), 0);
+  }
+  HierarchicalReduceGroups hierarchy;
+  size_t shard_count = 0;
+  for (const auto& group : groups.empty() ? all_replicas : groups) {
+    // The replicas of the group on each of its hosts, in the group order.
+    std::map<int64_t, std::vector<int64_t>> host_replicas;
+    for (int64_t replica_id : group) {
+      host_replicas[replica_id / host_size].push_back(replica_id);
+    }
+    if (host_replicas.size() <= 1) {
+      return std::nullopt;
+    }
+    for (auto& host_and_replicas : host_replicas) {
+      std::vector<int64_t>& replicas = host_and_replicas.second;
+      if (shard_count == 0) {
+        shard_count = replicas.size();
+      }
+      if (shard_count <= 1 || replicas.size() != shard_count) {
+        return std::nullopt;
+      }
+      hierarchy.intra_host.push_back(std::move(replicas));
+    }
+    size_t first_host = hierarchy.intra_host.size() - host_replicas.size();
+    for (size_t i = 0; i < shard_count; ++i) {
+      std::vector<int64_t> inter_group;
+      for (size_t h = first_host; h < hierarchy.intra_host.size(); ++h) {
+        inter_group.push_back(hierarchy.intra_host[h][i]);
+      }
+      hierarchy.inter_host.push_back(std::move(inter_group));
+    }
+  }
+  return hierarchy;
+}
+
 AllToAllResult BuildAllToAll(xla::XlaOp input, xla::XlaOp token,
                              int64_t split_dimension, int64_t concat_dimension,
                              int64_t split_count,
@@ -207,6 +496,52 @@ AllToAllResult BuildAllToAll(xla::XlaOp input, xla::XlaOp token,
   return {reduce_result, token_handler.GetNewToken(reduce_result)};
 }
 
+AllToAllResultCoalesced BuildAllToAllCoalesced(
+    absl::Span<const xla::XlaOp> inputs, xla::XlaOp token,
+    int64_t split_dimension, int64_t concat_dimension, int64_t split_count,
+    const std::vector<std::vector<int64_t>>& groups, bool pin_layout) {
+  std::vector<xla::ReplicaGroup> cc_groups = CreateReduceGroups(groups);
+  TokenHandler token_handler(token);
+  ReduceContext cc_ctx = GetReduceContext(inputs);
+  std::vector<xla::XlaOp> result(inputs.size());
+  xla::XlaOp new_token;
+  for (auto& type_ctx : cc_ctx.contexts) {
+    const PerTypeContext& ctx = type_ctx.second;
+    std::vector<xla::XlaOp> rows;
+    rows.reserve(ctx.ops.size());
+    for (size_t i = 0; i < ctx.ops.size(); ++i) {
+      rows.push_back(ChunksToRows(ctx.ops[i], ctx.operand_shapes[i],
+                                  split_dimension, split_count));
+    }
+    xla::XlaOp flat = xla::ConcatInDim(inputs[0].builder(), rows, 1);
+    xla::Shape flat_shape = ShapeHelper::ShapeOfXlaOp(flat);
+    flat = token_handler.GetInput(flat, &flat_shape);
+    xla::XlaOp all_to_all_result;
+    if (pin_layout) {
+      all_to_all_result = xla::AllToAll(
+          flat, /*split_dimension=*/0, /*concat_dimension=*/0, split_count,
+          cc_groups,
+          /*layout=*/MakeReduceShape({flat_shape}).tuple_shapes(0).layout());
+    } else {
+      all_to_all_result =
+          xla::AllToAll(flat, /*split_dimension=*/0, /*concat_dimension=*/0,
+                        split_count, cc_groups);
+    }
+    int64_t offset = 0;
+    for (size_t i = 0; i < ctx.ops.size(); ++i) {
+      const xla::Shape& shape = ctx.operand_shapes[i];
+      int64_t size = xla::ShapeUtil::ElementsIn(shape) / split_count;
+      xla::XlaOp op_rows =
+          xla::SliceInDim(all_to_all_result, offset, offset + size, 1, 1);
+      result[ctx.indices[i]] = RowsToResult(op_rows, shape, split_dimension,
+                                            concat_dimension, split_count);
+      offset += size;
+    }
+    new_token = token_handler.GetNewToken(all_to_all_result);
+  }
+  return {result, new_token};
+}
+
 AllGatherResult BuildAllGather(xla::XlaOp input, xla::XlaOp token, int64_t dim,
                                int64_t shard_count,
                                const std::vector<std::vector<int64_t>>& groups,
@@ -233,6 +568,55 @@ AllGatherResult BuildAllGather(xla::XlaOp input, xla::XlaOp token, int64_t dim,
   return {all_gather_result, token_handler.GetNewToken(all_gather_result)};
 }
 
+xla::XlaOp BuildAllGatherStart(xla::XlaOp input, xla::XlaOp token, int64_t dim,
+                               int64_t shard_count,
+                               const std::vector<std::vector<int64_t>>& groups,
+                               bool pin_layout) {
+  std::vector<xla::ReplicaGroup> reduce_groups = CreateReduceGroups(groups);
+  const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
+  TokenHandler token_handler(token);
+  std::optional<xla::Layout> layout;
+  if (pin_layout) {
+    layout = MakeReduceShape({input_shape}).tuple_shapes(0).layout();
+  }
+  return xla::internal::XlaBuilderFriend::BuildAllGatherStart(
+      input.builder(), token_handler.GetInput(input, &input_shape), dim,
+      shard_count, reduce_groups, /*channel_id=*/std::nullopt, layout);
+}
+
+xla::XlaOp BuildAllReduceStart(AllReduceType reduce_type, xla::XlaOp input,
+                               xla::XlaOp token,
+                               const std::vector<std::vector<int64_t>>& groups,
+                               bool pin_layout) {
+  std::vector<xla::ReplicaGroup> reduce_groups = CreateReduceGroups(groups);
+  const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
+  TokenHandler token_handler(token);
+  std::optional<xla::Shape> shape_with_layout;
+  if (pin_layout) {
+    shape_with_layout = MakeReduceShape({input_shape}).tuple_shapes(0);
+  }
+  return xla::internal::XlaBuilderFriend::BuildAllReduceStart(
+      input.builder(), token_handler.GetInput(input, &input_shape),
+      GetReduceComutation(reduce_type, input_shape.element_type()),
+      reduce_groups, /*channel_id=*/std::nullopt, shape_with_layout);
+}
+
+AsyncCollectiveDoneResult BuildAsyncCollectiveDone(xla::XlaOp start,
+                                                   xla::XlaOp token) {
+  xla::Shape start_shape = ShapeHelper::ShapeOfXlaOp(start);
+  xla::XlaOp result;
+  // The all-gather starts hold their input along with the result.
+  if (start_shape.IsTuple()) {
+    result = xla::internal::XlaBuilderFriend::BuildAllGatherDone(
+        start.builder(), start, start_shape.tuple_shapes(1));
+  } else {
+    result = xla::internal::XlaBuilderFriend::BuildAllReduceDone(
+        start.builder(), start, start_shape);
+  }
+  TokenHandler token_handler(token);
+  return {result, token_handler.GetNewToken(result)};
+}
+
 AllGatherResultCoalesced BuildAllGatherCoalesced(
     absl::Span<const xla::XlaOp> inputs, xla::XlaOp token, int64_t dim,
     int64_t shard_count, const std::vector<std::vector<int64_t>>& groups,
@@ -285,18 +669,344 @@ CollectivePermuteResult BuildCollectivePermute(
   return {result, token_handler.GetNewToken(result)};
 }
 
+CollectivePermuteResultCoalesced BuildCollectivePermuteCoalesced(
+    absl::Span<const xla::XlaOp> inputs, xla::XlaOp token,
+    const std::vector<std::pair<int64_t, int64_t>>& source_target_pairs) {
+  TokenHandler token_handler(token);
+  ReduceContext cc_ctx = GetReduceContext(inputs);
+  std::vector<xla::XlaOp> result(inputs.size());
+  xla::XlaOp new_token;
+  for (auto& type_ctx : cc_ctx.contexts) {
+    const PerTypeContext& ctx = type_ctx.second;
+    std::vector<xla::XlaOp> flat_ops;
+    flat_ops.reserve(ctx.ops.size());
+    for (size_t i = 0; i < ctx.ops.size(); ++i) {
+      flat_ops.push_back(xla::Reshape(
+          ctx.ops[i], {xla::ShapeUtil::ElementsIn(ctx.operand_shapes[i])}));
+    }
+    xla::XlaOp flat = xla::ConcatInDim(inputs[0].builder(), flat_ops, 0);
+    xla::Shape flat_shape = ShapeHelper::ShapeOfXlaOp(flat);
+    xla::XlaOp permuted = xla::CollectivePermute(
+        token_handler.GetInput(flat, &flat_shape), source_target_pairs);
+    int64_t offset = 0;
+    for (size_t i = 0; i < ctx.ops.size(); ++i) {
+      const xla::Shape& shape = ctx.operand_shapes[i];
+      int64_t size = xla::ShapeUtil::ElementsIn(shape);
+      xla::XlaOp op_result =
+          xla::SliceInDim(permuted, offset, offset + size, 1, 0);
+      result[ctx.indices[i]] = xla::Reshape(op_result, shape.dimensions());
+      offset += size;
+    }
+    new_token = token_handler.GetNewToken(permuted);
+  }
+  return {result, new_token};
+}
+
+RingAttentionResult BuildRingAttention(
+    xla::XlaOp query, xla::XlaOp key, xla::XlaOp value, xla::XlaOp token,
+    double scale, bool causal,
+    const std::vector<std::vector<int64_t>>& groups) {
+  xla::XlaBuilder* builder = query.builder();
+  std::vector<std::pair<int64_t, int64_t>> pairs = GetRingPairs(groups);
+  int64_t ring_size = groups.front().size();
+  xla::XlaOp position =
+      causal ? GetRingPosition(builder, groups) : xla::XlaOp();
+  xla::Shape query_shape = ShapeHelper::ShapeOfXlaOp(query);
+  xla::PrimitiveType value_type =
+      ShapeHelper::ShapeOfXlaOp(value).element_type();
+  TokenHandler token_handler(token);
+  query = token_handler.GetInput(query, &query_shape);
+
+  absl::Span<const int64_t> query_dims = query_shape.dimensions();
+  std::vector<int64_t> row_dims(query_dims.begin(), query_dims.end() - 1);
+  xla::XlaOp zero = xla::Zero(builder, xla::PrimitiveType::F32);
+  xla::XlaOp min_value = xla::MinValue(builder, xla::PrimitiveType::F32);
+  xla::XlaComputation max_computation =
+      XlaHelpers::CreateMaxComputation(xla::PrimitiveType::F32);
+  xla::XlaComputation add_computation =
+      XlaHelpers::CreateAddComputation(xla::PrimitiveType::F32);
+  xla::XlaOp accumulator = xla::Broadcast(zero, query_dims);
+  xla::XlaOp row_max = xla::Broadcast(min_value, row_dims);
+  xla::XlaOp row_sum = xla::Broadcast(zero, row_dims);
+  for (int64_t step = 0; step < ring_size; ++step) {
+    // Issued ahead of the attention of the blocks at hand, which they do not
+    // depend on, so that the transfers overlap it.
+    xla::XlaOp next_key;
+    xla::XlaOp next_value;
+    if (step + 1 < ring_size) {
+      next_key = xla::CollectivePermute(key, pairs);
+      next_value = xla::CollectivePermute(value, pairs);
+    }
+    xla::XlaOp scores =
+        RingAttentionScores(query, key, scale, position, step, ring_size);
+    xla::Shape scores_shape = ShapeHelper::ShapeOfXlaOp(scores);
+    xla::XlaOp new_max = xla::Max(
+        row_max, ReduceAttentionRows(scores, min_value, max_computation));
+    xla::XlaOp probs = xla::Exp(
+        scores - BroadcastAttentionRows(new_max, scores_shape.dimensions()));
+    xla::XlaOp correction = xla::Exp(row_max - new_max);
+    row_sum = row_sum * correction +
+              ReduceAttentionRows(probs, zero, add_computation);
+    accumulator = accumulator * BroadcastAttentionRows(correction, query_dims) +
+                  BuildAttentionDot(xla::ConvertElementType(probs, value_type),
+                                    1, value, 0);
+    row_max = new_max;
+    key = next_key;
+    value = next_value;
+  }
+  xla::XlaOp output = xla::ConvertElementType(
+      accumulator / BroadcastAttentionRows(row_sum, query_dims),
+      query_shape.element_type());
+  return {output, row_max + xla::Log(row_sum),
+          token_handler.GetNewToken(output)};
+}
+
+RingAttentionBackwardResult BuildRingAttentionBackward(
+    xla::XlaOp query, xla::XlaOp key, xla::XlaOp value, xla::XlaOp output,
+    xla::XlaOp logsumexp, xla::XlaOp grad_output, xla::XlaOp token,
+    double scale, bool causal,
+    const std::vector<std::vector<int64_t>>& groups) {
+  xla::XlaBuilder* builder = query.builder();
+  std::vector<std::pair<int64_t, int64_t>> pairs = GetRingPairs(groups);
+  int64_t ring_size = groups.front().size();
+  xla::XlaOp position =
+      causal ? GetRingPosition(builder, groups) : xla::XlaOp();
+  xla::Shape query_shape = ShapeHelper::ShapeOfXlaOp(query);
+  xla::Shape key_shape = ShapeHelper::ShapeOfXlaOp(key);
+  xla::Shape value_shape = ShapeHelper::ShapeOfXlaOp(value);
+  xla::PrimitiveType grad_type =
+      ShapeHelper::ShapeOfXlaOp(grad_output).element_type();
+  TokenHandler token_handler(token);
+  query = token_handler.GetInput(query, &query_shape);
+
+  xla::XlaOp zero = xla::Zero(builder, xla::PrimitiveType::F32);
+  xla::XlaComputation add_computation =
+      XlaHelpers::CreateAddComputation(xla::PrimitiveType::F32);
+  // The rows of the gradient of the softmax input shared by all the blocks.
+  xla::XlaOp delta = ReduceAttentionRows(
+      xla::ConvertElementType(grad_output, xla::PrimitiveType::F32) *
+          xla::ConvertElementType(output, xla::PrimitiveType::F32),
+      zero, add_computation);
+  xla::XlaOp scale_value =
+      XlaHelpers::ScalarValue<float>(scale, xla::PrimitiveType::F32, builder);
+  xla::XlaOp grad_query = xla::Broadcast(zero, query_shape.dimensions());
+  xla::XlaOp grad_key = xla::Broadcast(zero, key_shape.dimensions());
+  xla::XlaOp grad_value = xla::Broadcast(zero, value_shape.dimensions());
+  for (int64_t step = 0; step < ring_size; ++step) {
+    xla::XlaOp next_key;
+    xla::XlaOp next_value;
+    if (step + 1 < ring_size) {
+      next_key = xla::CollectivePermute(key, pairs);
+      next_value = xla::CollectivePermute(value, pairs);
+    }
+    xla::XlaOp scores =
+        RingAttentionScores(query, key, scale, position, step, ring_size);
+    xla::Shape scores_shape = ShapeHelper::ShapeOfXlaOp(scores);
+    xla::XlaOp probs = xla::Exp(
+        scores - BroadcastAttentionRows(logsumexp, scores_shape.dimensions()));
+    grad_value =
+        grad_value + BuildAttentionDot(
+                         xla::ConvertElementType(probs, grad_type), 0,
+                         grad_output, 0);
+    xla::XlaOp grad_probs = BuildAttentionDot(grad_output, 1, value, 1);
+    xla::XlaOp grad_scores =
+        probs *
+        (grad_probs -
+         BroadcastAttentionRows(delta, scores_shape.dimensions())) *
+        scale_value;
+    grad_query =
+        grad_query +
+        BuildAttentionDot(
+            xla::ConvertElementType(grad_scores, key_shape.element_type()), 1,
+            key, 0);
+    grad_key =
+        grad_key +
+        BuildAttentionDot(
+            xla::ConvertElementType(grad_scores, query_shape.element_type()),
+            0, query, 0);
+    grad_key = xla::CollectivePermute(grad_key, pairs);
+    grad_value = xla::CollectivePermute(grad_value, pairs);
+    key = next_key;
+    value = next_value;
+  }
+  grad_query =
+      xla::ConvertElementType(grad_query, query_shape.element_type());
+  grad_key = xla::ConvertElementType(grad_key, key_shape.element_type());
+  grad_value =
+      xla::ConvertElementType(grad_value, value_shape.element_type());
+  return {grad_query, grad_key, grad_value,
+          token_handler.GetNewToken(grad_query)};
+}
+
+namespace {
+
+const int64_t kEmbeddingBagMean = 1;
+const int64_t kEmbeddingBagMax = 2;
+
+struct ShardLookup {
+  // The rows of the local shard, clamped within it.
+  xla::XlaOp rows;
+  // The segments of the bags of all the replicas, out of bounds for the
+  // indices of other shards and past the last offset of the bags.
+  xla::XlaOp segments;
+};
+
+// Looks up the gathered `indices` of all the replicas in the local shard of
+// `num_rows` rows, given the gathered `bag_ids` of each of their `num_bags`
+// bags per replica.
+ShardLookup GetShardLookup(xla::XlaOp indices, xla::XlaOp bag_ids,
+                           int64_t num_rows, int64_t num_bags,
+                           const std::vector<std::vector<int64_t>>& groups) {
+  xla::XlaBuilder* builder = indices.builder();
+  const xla::Shape& indices_shape = ShapeHelper::ShapeOfXlaOp(indices);
+  xla::PrimitiveType type = indices_shape.element_type();
+  int64_t shard_count = groups.front().size();
+  int64_t num_indices = indices_shape.dimensions(0) / shard_count;
+  auto scalar = [&](int64_t value) {
+    return XlaHelpers::ScalarValue<int64_t>(value, type, builder);
+  };
+  xla::XlaOp position =
+      xla::ConvertElementType(GetRingPosition(builder, groups), type);
+  xla::XlaOp rows = indices - position * scalar(num_rows);
+  bag_ids = xla::ConvertElementType(bag_ids, type);
+  xla::XlaOp local = xla::And(
+      xla::And(xla::Ge(rows, scalar(0)), xla::Lt(rows, scalar(num_rows))),
+      xla::Lt(bag_ids, scalar(num_bags)));
+  xla::XlaOp sources =
+      xla::Div(xla::Iota(builder, indices_shape, 0), scalar(num_indices));
+  xla::XlaOp segments = sources * scalar(num_bags) + bag_ids;
+  return {xla::Clamp(scalar(0), rows, scalar(num_rows - 1)),
+          xla::Select(local, segments,
+                      xla::Broadcast(scalar(shard_count * num_bags),
+                                     indices_shape.dimensions()))};
+}
+
+// The number of indices in each of the `num_bags` bags of `bag_ids`, as values
+// of `type` broadcasted to [num_bags, dim].
+xla::XlaOp GetBagCounts(xla::XlaOp bag_ids, int64_t num_bags, int64_t dim,
+                        xla::PrimitiveType type) {
+  xla::XlaBuilder* builder = bag_ids.builder();
+  return xla::BroadcastInDim(
+      BuildSegmentReduce(xla::One(builder, type), bag_ids, num_bags,
+                         xla::Zero(builder, type), NumericAddCombiner()),
+      {num_bags, dim}, {0});
+}
+
+}  // namespace
+
+ShardedEmbeddingBagResult BuildShardedEmbeddingBag(
+    xla::XlaOp weight, xla::XlaOp indices, xla::XlaOp offsets,
+    xla::XlaOp per_sample_weights, xla::XlaOp token, int64_t mode,
+    bool include_last_offset, const std::vector<std::vector<int64_t>>& groups,
+    bool pin_layout) {
+  xla::XlaBuilder* builder = weight.builder();
+  const xla::Shape& weight_shape = ShapeHelper::ShapeOfXlaOp(weight);
+  int64_t num_rows = weight_shape.dimensions(0);
+  int64_t dim = weight_shape.dimensions(1);
+  xla::PrimitiveType type = weight_shape.element_type();
+  int64_t shard_count = groups.front().size();
+  int64_t num_indices = ShapeHelper::ShapeOfXlaOp(indices).dimensions(0);
+  int64_t num_offsets = ShapeHelper::ShapeOfXlaOp(offsets).dimensions(0);
+  int64_t num_bags = include_last_offset ? num_offsets - 1 : num_offsets;
+
+  xla::XlaOp bag_ids = BuildBagSegmentIds(offsets, num_indices);
+  AllGatherResultCoalesced gathered = BuildAllGatherCoalesced(
+      {indices, bag_ids, per_sample_weights}, token, 0, shard_count, groups,
+      pin_layout);
+  ShardLookup lookup =
+      GetShardLookup(gathered.result[0], gathered.result[1], num_rows,
+                     num_bags, groups);
+  xla::XlaOp embeddings = xla::TorchIndexSelect(weight, lookup.rows, 0);
+  embeddings = embeddings *
+               xla::BroadcastInDim(
+                   xla::ConvertElementType(gathered.result[2], type),
+                   {shard_count * num_indices, dim}, {0});
+
+  bool is_max = mode == kEmbeddingBagMax;
+  xla::XlaOp init =
+      is_max ? xla::MinValue(builder, type) : xla::Zero(builder, type);
+  xla::XlaOp partial_bags = BuildSegmentReduce(
+      embeddings, lookup.segments, shard_count * num_bags, init,
+      is_max ? NumericMaxCombiner() : NumericAddCombiner());
+  AllToAllResult exchanged = BuildAllToAll(
+      xla::Reshape(partial_bags, {shard_count, num_bags, dim}),
+      gathered.token, 0, 0, shard_count, groups, pin_layout);
+  xla::XlaOp result = xla::Reduce(
+      exchanged.result, init,
+      is_max ? XlaHelpers::CreateMaxComputation(type)
+             : XlaHelpers::CreateAddComputation(type),
+      {0});
+
+  if (mode == kEmbeddingBagMean || is_max) {
+    xla::XlaOp counts = GetBagCounts(bag_ids, num_bags, dim, type);
+    result = is_max
+                 ? xla::Select(xla::Gt(counts, xla::Zero(builder, type)),
+                               result, xla::ZerosLike(result))
+                 : xla::Div(result, xla::Max(counts, xla::One(builder, type)));
+  }
+  return {result, exchanged.token};
+}
+
+ShardedEmbeddingBagBackwardResult BuildShardedEmbeddingBagBackward(
+    xla::XlaOp grad_output, xla::XlaOp indices, xla::XlaOp offsets,
+    xla::XlaOp per_sample_weights, xla::XlaOp token, int64_t mode,
+    bool include_last_offset, int64_t num_rows,
+    const std::vector<std::vector<int64_t>>& groups, bool pin_layout) {
+  XLA_CHECK_NE(mode, kEmbeddingBagMax)
+      << "The max mode of the sharded embedding_bag is not differentiable";
+  xla::XlaBuilder* builder = grad_output.builder();
+  const xla::Shape& grad_shape = ShapeHelper::ShapeOfXlaOp(grad_output);
+  int64_t num_bags = grad_shape.dimensions(0);
+  int64_t dim = grad_shape.dimensions(1);
+  xla::PrimitiveType type = grad_shape.element_type();
+  int64_t shard_count = groups.front().size();
+  int64_t num_indices = ShapeHelper::ShapeOfXlaOp(indices).dimensions(0);
+
+  xla::XlaOp bag_ids = BuildBagSegmentIds(offsets, num_indices);
+  if (mode == kEmbeddingBagMean) {
+    xla::XlaOp counts = GetBagCounts(bag_ids, num_bags, dim, type);
+    grad_output =
+        xla::Div(grad_output, xla::Max(counts, xla::One(builder, type)));
+  }
+  AllGatherResultCoalesced gathered = BuildAllGatherCoalesced(
+      {grad_output, indices, bag_ids, per_sample_weights}, token, 0,
+      shard_count, groups, pin_layout);
+  ShardLookup lookup =
+      GetShardLookup(gathered.result[1], gathered.result[2], num_rows,
+                     num_bags, groups);
+  int64_t num_segments = shard_count * num_bags;
+  xla::XlaOp last_segment = XlaHelpers::ScalarValue<int64_t>(
+      num_segments - 1, XlaHelpers::TypeOfXlaOp(lookup.segments), builder);
+  xla::XlaOp local = xla::Le(lookup.segments, last_segment);
+  xla::XlaOp values = xla::TorchIndexSelect(
+      gathered.result[0], xla::Min(lookup.segments, last_segment), 0);
+  values = values * xla::BroadcastInDim(
+                        xla::ConvertElementType(local, type) *
+                            xla::ConvertElementType(gathered.result[3], type),
+                        {shard_count * num_indices, dim}, {0});
+  // The rows of the other shards are out of bounds, so that the sparse
+  // optimizer steps and scatters drop them.
+  xla::XlaOp out_of_bounds_row = XlaHelpers::ScalarValue<int64_t>(
+      num_rows, XlaHelpers::TypeOfXlaOp(lookup.rows), builder);
+  xla::XlaOp rows = xla::Select(
+      local, lookup.rows,
+      xla::Broadcast(out_of_bounds_row, {shard_count * num_indices}));
+  return {rows, values, gathered.token};
+}
+
 SendResult BuildSendWithToken(xla::XlaOp input, xla::XlaOp token,
                               int64_t channel_id) {
   xla::ChannelHandle channel_handle;
   channel_handle.set_handle(channel_id);
   channel_handle.set_type(xla::ChannelHandle::DEVICE_TO_DEVICE);
-  xla::XlaOp result_token = xla::SendWithToken(input, token, channel_handle);
+  xla::XlaOp result_token =
+      xla::SendWithToken(input, GetXlaToken(token), channel_handle);
   // Bind input into the result, so that the caller can depend on the result.
   // This can enable building the `send` op into the graph when the token
   // is ignored by some caller like `torch.distributed`.
   xla::XlaOp tuple_res = xla::Tuple(input.builder(), {result_token, input});
   xla::XlaOp input_as_result = xla::GetTupleElement(tuple_res, 1);
-  return {input_as_result, result_token};
+  return {input_as_result, GetNextToken(token, result_token)};
 }
 
 RecvResult BuildRecvWithToken(xla::XlaOp token, const xla::Shape& recv_shape,
@@ -304,10 +1014,11 @@ RecvResult BuildRecvWithToken(xla::XlaOp token, const xla::Shape& recv_shape,
   xla::ChannelHandle channel_handle;
   channel_handle.set_handle(channel_id);
   channel_handle.set_type(xla::ChannelHandle::DEVICE_TO_DEVICE);
-  xla::XlaOp recv = xla::RecvWithToken(token, recv_shape, channel_handle);
+  xla::XlaOp recv =
+      xla::RecvWithToken(GetXlaToken(token), recv_shape, channel_handle);
   xla::XlaOp result = xla::GetTupleElement(recv, 0);
   xla::XlaOp new_token = xla::GetTupleElement(recv, 1);
-  return {result, new_token};
+  return {result, GetNextToken(token, new_token)};
 }
 
 ReduceScatterResult BuildReduceScatter(
@@ -415,6 +1126,30 @@ const torch::lazy::Value& GetAllReduceToken(
 void SetAllReduceToken(const torch::lazy::BackendDevice& device,
                        const std::shared_ptr<torch::lazy::Value>& token) {
   g_all_reduce_tokens[device.ordinal()] = token;
+  if (token == nullptr) {
+    auto it = g_channel_tokens.lower_bound(
+        {device.ordinal(), std::numeric_limits<int64_t>::min()});
+    while (it != g_channel_tokens.end() &&
+           it->first.first == device.ordinal()) {
+      it = g_channel_tokens.erase(it);
+    }
+  }
+}
+
+const torch::lazy::Value& GetChannelToken(
+    const torch::lazy::BackendDevice& device, int64_t channel_id) {
+  std::shared_ptr<torch::lazy::Value>& token =
+      g_channel_tokens[{device.ordinal(), channel_id}];
+  if (token == nullptr) {
+    token = CreateToken(device);
+  }
+  return *token;
+}
+
+void SetChannelToken(const torch::lazy::BackendDevice& device,
+                     int64_t channel_id,
+                     const std::shared_ptr<torch::lazy::Value>& token) {
+  g_channel_tokens[{device.ordinal(), channel_id}] = token;
 }
 
 AllReduceType GetReduceType(c10::string_view reduce_type) {
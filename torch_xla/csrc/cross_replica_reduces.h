@@ -1,6 +1,7 @@
 #ifndef XLA_TORCH_XLA_CSRC_CROSS_REPLICA_REDUCES_H_
 #define XLA_TORCH_XLA_CSRC_CROSS_REPLICA_REDUCES_H_
 
+#include <optional>
 #include <vector>
 
 #include "absl/types/span.h"
@@ -35,11 +36,21 @@ struct AllGatherResultCoalesced {
   xla::XlaOp token;
 };
 
+struct AllToAllResultCoalesced {
+  std::vector<xla::XlaOp> result;
+  xla::XlaOp token;
+};
+
 struct CollectivePermuteResult {
   xla::XlaOp result;
   xla::XlaOp token;
 };
 
+struct CollectivePermuteResultCoalesced {
+  std::vector<xla::XlaOp> result;
+  xla::XlaOp token;
+};
+
 struct SendResult {
   xla::XlaOp input_as_result;
   xla::XlaOp token;
@@ -60,22 +71,97 @@ struct ReduceScatterResultCoalesced {
   xla::XlaOp token;
 };
 
+struct AsyncCollectiveDoneResult {
+  xla::XlaOp result;
+  xla::XlaOp token;
+};
+
+struct RingAttentionResult {
+  xla::XlaOp output;
+  // The log-sum-exp of the attention scores of each query row, in F32.
+  xla::XlaOp logsumexp;
+  xla::XlaOp token;
+};
+
+struct RingAttentionBackwardResult {
+  xla::XlaOp grad_query;
+  xla::XlaOp grad_key;
+  xla::XlaOp grad_value;
+  xla::XlaOp token;
+};
+
+struct ShardedEmbeddingBagResult {
+  xla::XlaOp result;
+  xla::XlaOp token;
+};
+
+struct ShardedEmbeddingBagBackwardResult {
+  // The rows of the local weight shard looked up by the indices of all the
+  // replicas, and their gradients. The indices of other shards have the out of
+  // bounds row num_rows and zero gradients.
+  xla::XlaOp rows;
+  xla::XlaOp values;
+  xla::XlaOp token;
+};
+
+struct HierarchicalReduceGroups {
+  // The groups of the reduce-scatter and all-gather within the hosts.
+  std::vector<std::vector<int64_t>> intra_host;
+  // The groups of the all-reduce of the scattered shards across the hosts.
+  std::vector<std::vector<int64_t>> inter_host;
+};
+
 std::vector<xla::XlaOp> BuildAllReduce(
     AllReduceType reduce_type, absl::Span<const xla::XlaOp> operands,
     xla::XlaOp token, double scale,
     const std::vector<std::vector<int64_t>>& groups, bool pin_layout);
 
+// The groups of a hierarchical all-reduce over `groups` (all the
+// `num_replicas` replicas if empty), where the hosts hold `host_size`
+// consecutive replicas each. Returns nullopt unless every group spans several
+// hosts, with the same number (above one) of its replicas on each of them.
+std::optional<HierarchicalReduceGroups> GetHierarchicalReduceGroups(
+    const std::vector<std::vector<int64_t>>& groups, int64_t num_replicas,
+    int64_t host_size);
+
 AllToAllResult BuildAllToAll(xla::XlaOp input, xla::XlaOp token,
                              int64_t split_dimension, int64_t concat_dimension,
                              int64_t split_count,
                              const std::vector<std::vector<int64_t>>& groups,
                              bool pin_layout);
 
+// Exchanges all the `inputs` as BuildAllToAll() does each of them, with a
+// single all-to-all per element type, of the chunks of the inputs laid out as
+// the rows of a matrix.
+AllToAllResultCoalesced BuildAllToAllCoalesced(
+    absl::Span<const xla::XlaOp> inputs, xla::XlaOp token,
+    int64_t split_dimension, int64_t concat_dimension, int64_t split_count,
+    const std::vector<std::vector<int64_t>>& groups, bool pin_layout);
+
 AllGatherResult BuildAllGather(xla::XlaOp input, xla::XlaOp token, int64_t dim,
                                int64_t shard_count,
                                const std::vector<std::vector<int64_t>>& groups,
                                bool pin_layout);
 
+// Starts an all-gather of `input` ordered after `token`, returning the state of
+// the collective in flight for BuildAsyncCollectiveDone().
+xla::XlaOp BuildAllGatherStart(xla::XlaOp input, xla::XlaOp token, int64_t dim,
+                               int64_t shard_count,
+                               const std::vector<std::vector<int64_t>>& groups,
+                               bool pin_layout);
+
+// Starts an all-reduce of `input` ordered after `token`, returning the state of
+// the collective in flight for BuildAsyncCollectiveDone().
+xla::XlaOp BuildAllReduceStart(AllReduceType reduce_type, xla::XlaOp input,
+                               xla::XlaOp token,
+                               const std::vector<std::vector<int64_t>>& groups,
+                               bool pin_layout);
+
+// Waits for the collective started as `start`, returning its result and the
+// token following `token`.
+AsyncCollectiveDoneResult BuildAsyncCollectiveDone(xla::XlaOp start,
+                                                   xla::XlaOp token);
+
 AllGatherResultCoalesced BuildAllGatherCoalesced(
     absl::Span<const xla::XlaOp> inputs, xla::XlaOp token, int64_t dim,
     int64_t shard_count, const std::vector<std::vector<int64_t>>& groups,
@@ -85,6 +171,52 @@ CollectivePermuteResult BuildCollectivePermute(
     xla::XlaOp input, xla::XlaOp token,
     const std::vector<std::pair<int64_t, int64_t>>& source_target_pairs);
 
+// Permutes all the `inputs` as BuildCollectivePermute() does each of them, with
+// a single collective permute per element type, of the inputs flattened and
+// concatenated.
+CollectivePermuteResultCoalesced BuildCollectivePermuteCoalesced(
+    absl::Span<const xla::XlaOp> inputs, xla::XlaOp token,
+    const std::vector<std::pair<int64_t, int64_t>>& source_target_pairs);
+
+// Computes the attention of the [..., rows, head_dim] `query` block over the
+// key and value blocks of all the replicas of its ring in `groups`, the i-th
+// replica of a ring holding the i-th blocks of the sequence. The key and value
+// blocks are rotated around the ring by collective permutes, overlapping the
+// attention of the blocks at hand, whose softmax is accumulated blockwise.
+RingAttentionResult BuildRingAttention(
+    xla::XlaOp query, xla::XlaOp key, xla::XlaOp value, xla::XlaOp token,
+    double scale, bool causal, const std::vector<std::vector<int64_t>>& groups);
+
+// The gradients of BuildRingAttention(), given its `output` and `logsumexp`.
+// The gradients of the key and value blocks rotate around the ring along with
+// them, back to their replicas after a last hop.
+RingAttentionBackwardResult BuildRingAttentionBackward(
+    xla::XlaOp query, xla::XlaOp key, xla::XlaOp value, xla::XlaOp output,
+    xla::XlaOp logsumexp, xla::XlaOp grad_output, xla::XlaOp token,
+    double scale, bool causal, const std::vector<std::vector<int64_t>>& groups);
+
+// Computes the embedding_bag (mode 0 sum, 1 mean, 2 max) of the bags of all
+// the replicas of `groups` over an embedding table whose i-th shard of rows is
+// held by the i-th replica of a group as `weight`. The indices and bags of the
+// replicas are all-gathered, each replica reduces the rows of its shard into
+// partial bags, and an all-to-all sends the partial bags back to their
+// replicas, so neither the table nor its lookups are ever gathered whole.
+ShardedEmbeddingBagResult BuildShardedEmbeddingBag(
+    xla::XlaOp weight, xla::XlaOp indices, xla::XlaOp offsets,
+    xla::XlaOp per_sample_weights, xla::XlaOp token, int64_t mode,
+    bool include_last_offset, const std::vector<std::vector<int64_t>>& groups,
+    bool pin_layout);
+
+// The gradient of BuildShardedEmbeddingBag() for the sum and mean modes, as
+// sparse rows of the `num_rows` rows weight shard and their gradients. The
+// gradients of the bags of all the replicas are all-gathered, and each replica
+// picks the ones of the indices of its shard.
+ShardedEmbeddingBagBackwardResult BuildShardedEmbeddingBagBackward(
+    xla::XlaOp grad_output, xla::XlaOp indices, xla::XlaOp offsets,
+    xla::XlaOp per_sample_weights, xla::XlaOp token, int64_t mode,
+    bool include_last_offset, int64_t num_rows,
+    const std::vector<std::vector<int64_t>>& groups, bool pin_layout);
+
 SendResult BuildSendWithToken(xla::XlaOp input, xla::XlaOp token,
                               int64_t channel_id);
 
@@ -107,9 +239,19 @@ std::vector<torch::lazy::Value> GetOperandListWithToken(
 
 const torch::lazy::Value& GetAllReduceToken(
     const torch::lazy::BackendDevice& device);
+// Resetting the token of a device (to nullptr) resets its channel tokens too.
 void SetAllReduceToken(const torch::lazy::BackendDevice& device,
                        const std::shared_ptr<torch::lazy::Value>& token);
 
+// The tokens sequencing the sends and receives of a channel of a device, apart
+// from the other channels and the collectives, so that the transfers of
+// different channels can be in flight together.
+const torch::lazy::Value& GetChannelToken(
+    const torch::lazy::BackendDevice& device, int64_t channel_id);
+void SetChannelToken(const torch::lazy::BackendDevice& device,
+                     int64_t channel_id,
+                     const std::shared_ptr<torch::lazy::Value>& token);
+
 AllReduceType GetReduceType(c10::string_view reduce_type);
 
 }  // namespace torch_xla
@@ -0,0 +1,46 @@
+#include "torch_xla/csrc/custom_kernel_registry.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include "torch_xla/csrc/runtime/debug_macros.h"
+
+namespace torch_xla {
+
+CustomKernelRegistry* CustomKernelRegistry::Get() {
+  static CustomKernelRegistry* registry = new CustomKernelRegistry();
+  return registry;
+}
+
+int64_t CustomKernelRegistry::Register(const std::string& payload) {
+  torch::lazy::hash_t hash = torch::lazy::Hash(payload);
+  std::lock_guard<std::mutex> lock(lock_);
+  std::vector<int64_t>& ids = ids_[hash];
+  for (int64_t id : ids) {
+    if (kernels_[id]->payload == payload) {
+      return id;
+    }
+  }
+  auto kernel = std::make_shared<CustomKernel>();
+  kernel->id = kernels_.size();
+  kernel->payload = payload;
+  kernel->hash = hash;
+  ids.push_back(kernel->id);
+  kernels_.push_back(std::move(kernel));
+  TORCH_LAZY_COUNTER("CustomKernelRegistered", 1);
+  return kernels_.back()->id;
+}
+
+std::shared_ptr<const CustomKernel> CustomKernelRegistry::GetKernel(
+    int64_t id) const {
+  std::lock_guard<std::mutex> lock(lock_);
+  XLA_CHECK(id >= 0 && id < static_cast<int64_t>(kernels_.size()))
+      << "Unknown custom kernel id " << id;
+  return kernels_[id];
+}
+
+size_t CustomKernelRegistry::Size() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return kernels_.size();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,50 @@
+#ifndef XLA_TORCH_XLA_CSRC_CUSTOM_KERNEL_REGISTRY_H_
+#define XLA_TORCH_XLA_CSRC_CUSTOM_KERNEL_REGISTRY_H_
+
+#include <torch/csrc/lazy/core/hash.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace torch_xla {
+
+// A serialized custom kernel (Pallas, Triton), with the hash of its payload.
+struct CustomKernel {
+  int64_t id = 0;
+  std::string payload;
+  torch::lazy::hash_t hash;
+};
+
+// Interns the payloads of the custom kernels by id. The custom call nodes of a
+// kernel share its registered payload and hash, so that a kernel called many
+// times per step is neither copied nor hashed again on each trace, the Python
+// side keeping the id of the kernels it has traced. The kernels are never
+// unregistered.
+class CustomKernelRegistry {
+ public:
+  static CustomKernelRegistry* Get();
+
+  // Returns the id of `payload`, registering it if new.
+  int64_t Register(const std::string& payload);
+
+  // The kernel of a registered id.
+  std::shared_ptr<const CustomKernel> GetKernel(int64_t id) const;
+
+  size_t Size() const;
+
+ private:
+  mutable std::mutex lock_;
+  std::vector<std::shared_ptr<const CustomKernel>> kernels_;
+  // The ids of the kernels by payload hash.
+  std::unordered_map<torch::lazy::hash_t, std::vector<int64_t>,
+                     torch::lazy::HashReducer>
+      ids_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_CUSTOM_KERNEL_REGISTRY_H_
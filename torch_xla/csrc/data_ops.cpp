@@ -1,5 +1,6 @@
 #include "torch_xla/csrc/data_ops.h"
 
+#include <torch/csrc/lazy/core/metrics.h>
 #include <torch/csrc/lazy/core/tensor_util.h>
 #include <torch/csrc/lazy/core/util.h>
 
@@ -26,6 +27,25 @@
 namespace torch_xla {
 namespace {
 
+// Concatenates the `inputs` along `dim` in a tree of concatenations of at most
+// XLA_CONCAT_MAX_OPERANDS operands each, as the compile time of a single
+// concatenation of thousands of operands grows with their number.
+xla::XlaOp BuildConcatTree(absl::Span<const xla::XlaOp> inputs, int64_t dim) {
+  static const size_t max_operands = std::max<int64_t>(
+      runtime::sys_util::GetEnvInt("XLA_CONCAT_MAX_OPERANDS", 128), 2);
+  if (inputs.size() <= max_operands) {
+    return xla::ConcatInDim(inputs[0].builder(), inputs, dim);
+  }
+  TORCH_LAZY_COUNTER("ConcatTreeLevels", 1);
+  std::vector<xla::XlaOp> concats;
+  for (size_t i = 0; i < inputs.size(); i += max_operands) {
+    concats.push_back(xla::ConcatInDim(
+        inputs[0].builder(),
+        inputs.subspan(i, std::min(max_operands, inputs.size() - i)), dim));
+  }
+  return BuildConcatTree(concats, dim);
+}
+
 bool IsSparseGather(const xla::Shape& input_shape,
                     const xla::Shape& index_shape, int64_t dim) {
   // Conservative sparsity check for multi-platform support
@@ -269,7 +289,7 @@ xla::XlaOp BuildStack(absl::Span<const xla::XlaOp> inputs, int64_t dim) {
     output_sizes.insert(output_sizes.begin() + dim, 1);
     reshaped_inputs.push_back(XlaHelpers::DynamicReshape(input, output_sizes));
   }
-  return xla::ConcatInDim(inputs[0].builder(), reshaped_inputs, dim);
+  return BuildConcatTree(reshaped_inputs, dim);
 }
 
 xla::XlaOp BuildCat(absl::Span<const xla::XlaOp> inputs, int64_t dim,
@@ -279,7 +299,7 @@ xla::XlaOp BuildCat(absl::Span<const xla::XlaOp> inputs, int64_t dim,
   for (const auto& op : inputs) {
     casted_inputs.push_back(CastToScalarType(op, dtype));
   }
-  return xla::ConcatInDim(inputs[0].builder(), casted_inputs, dim);
+  return BuildConcatTree(casted_inputs, dim);
 }
 
 xla::XlaOp BuildRepeat(xla::XlaOp input, absl::Span<const int64_t> repeats) {
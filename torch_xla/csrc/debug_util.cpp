@@ -2,8 +2,8 @@
 
 #include <torch/csrc/lazy/core/hash.h>
 #include <torch/csrc/lazy/core/unique.h>
-#include <torch/csrc/lazy/python/python_util.h>
 
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <mutex>
@@ -15,7 +15,9 @@
 #include "absl/strings/str_split.h"
 #include "torch_xla/csrc/aten_xla_bridge.h"
 #include "torch_xla/csrc/device.h"
+#include "torch_xla/csrc/frame_table.h"
 #include "torch_xla/csrc/ir.h"
+#include "torch_xla/csrc/ir_binary_dump.h"
 #include "torch_xla/csrc/ir_dump_util.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
@@ -35,6 +37,8 @@ DebugUtil::GraphFormat DefaultGraphFormat() {
     return DebugUtil::GraphFormat::kDot;
   } else if (fmt_str == "stablehlo") {
     return DebugUtil::GraphFormat::kStableHlo;
+  } else if (fmt_str == "binary") {
+    return DebugUtil::GraphFormat::kBinary;
   }
   XLA_ERROR() << "Invalid save graph format: " << fmt_str;
 }
@@ -51,6 +55,52 @@ std::unordered_set<std::string>* LoadExperiments() {
   return xset.release();
 }
 
+// Returns the IR values held at the tensors selected by `indices` (all the
+// tensors if nullptr), setting `unique_device` to their device.
+std::vector<torch::lazy::Value> GetRootValues(
+    absl::Span<const XLATensorPtr> tensors, const std::vector<size_t>* indices,
+    torch::lazy::Unique<torch::lazy::BackendDevice>* unique_device) {
+  std::vector<torch::lazy::Value> root_values;
+  auto add_tensor = [&](const XLATensorPtr& tensor) {
+    torch::lazy::Value ir_value = tensor->CurrentIrValue();
+    if (ir_value) {
+      root_values.push_back(std::move(ir_value));
+      unique_device->set(tensor->GetDevice());
+    }
+  };
+  if (indices != nullptr) {
+    for (auto index : *indices) {
+      add_tensor(tensors[index]);
+    }
+  } else {
+    for (auto& tensor : tensors) {
+      add_tensor(tensor);
+    }
+  }
+  return root_values;
+}
+
+std::string GetPythonFramesInfo() {
+  std::stringstream ss;
+  for (auto& location : FrameTable::Get()->CaptureFrames()) {
+    ss << "  " << location.function << " (" << location.file << ":"
+       << location.line << ")\n";
+  }
+  return ss.str();
+}
+
+// Appends `record` to the binary dump file at `path`, starting the file with
+// its header if it is empty.
+void AppendBinaryRecord(const std::string& path, const std::string& record) {
+  std::error_code ec;
+  bool empty = std::filesystem::file_size(path, ec) == 0 || ec;
+  std::ofstream graph_file(path, std::ios_base::app | std::ios_base::binary);
+  if (empty) {
+    graph_file << binary_dump::FileHeaderBytes();
+  }
+  graph_file << record;
+}
+
 }  // namespace
 
 DebugUtil::GraphFormat DebugUtil::GetDefaultGraphFormat() {
@@ -89,46 +139,21 @@ std::string DebugUtil::GetTensorsGraphHlo(
 std::string DebugUtil::GetTensorsGraphInfo(
     absl::Span<const XLATensorPtr> tensors, const std::vector<size_t>* indices,
     GraphFormat format) {
-  std::vector<const torch::lazy::Node*> root_nodes;
-  std::vector<torch::lazy::Value> root_values;
-  std::vector<torch::lazy::hash_t> root_hashes;
   torch::lazy::Unique<torch::lazy::BackendDevice> unique_device;
-  if (indices != nullptr) {
-    for (auto index : *indices) {
-      const XLATensorPtr& tensor = tensors[index];
-      torch::lazy::Value ir_value = tensor->CurrentIrValue();
-      if (ir_value) {
-        root_nodes.push_back(ir_value.node.get());
-        root_hashes.push_back(ir_value.hash());
-        root_values.push_back(std::move(ir_value));
-        unique_device.set(tensor->GetDevice());
-      }
-    }
-  } else {
-    for (auto& tensor : tensors) {
-      torch::lazy::Value ir_value = tensor->CurrentIrValue();
-      if (ir_value) {
-        root_nodes.push_back(ir_value.node.get());
-        root_hashes.push_back(ir_value.hash());
-        root_values.push_back(std::move(ir_value));
-        unique_device.set(tensor->GetDevice());
-      }
-    }
+  std::vector<torch::lazy::Value> root_values =
+      GetRootValues(tensors, indices, &unique_device);
+  std::vector<const torch::lazy::Node*> root_nodes;
+  for (auto& ir_value : root_values) {
+    root_nodes.push_back(ir_value.node.get());
   }
   std::stringstream ss;
-  std::vector<torch::lazy::SourceLocation> frames =
-      torch::lazy::GetPythonFrames();
-  ss << "TensorsGraphInfo:\n";
-  for (auto& location : frames) {
-    ss << "  " << location.function << " (" << location.file << ":"
-       << location.line << ")\n";
-  }
+  ss << "TensorsGraphInfo:\n" << GetPythonFramesInfo();
   ss << "\nRoot Hashes: (";
-  for (size_t i = 0; i < root_hashes.size(); ++i) {
+  for (size_t i = 0; i < root_values.size(); ++i) {
     if (i > 0) {
       ss << ", ";
     }
-    ss << torch::lazy::HashToString(root_hashes[i]);
+    ss << torch::lazy::HashToString(root_values[i].hash());
   }
   ss << ")\n";
 
@@ -146,6 +171,8 @@ std::string DebugUtil::GetTensorsGraphInfo(
         root_values,
         unique_device ? *unique_device : bridge::GetCurrentDevice(),
         EmitMode::kStableHloReadable);
+  } else if (format == GraphFormat::kBinary) {
+    graph_str = DumpUtil::ToText(root_nodes);
   } else {
     XLA_ERROR() << "Invalid graph format: " << format;
   }
@@ -171,6 +198,20 @@ void DebugUtil::SaveTensorsGraphInfo(const char* name,
       torch::lazy::BackendDevice device = tensors[(*indices)[0]]->GetDevice();
       XLAGraphExecutor::Get()->WaitDeviceOps({device.toString()});
     }
+    if (format == DebugUtil::GraphFormat::kBinary) {
+      torch::lazy::Unique<torch::lazy::BackendDevice> unique_device;
+      std::vector<torch::lazy::Value> root_values =
+          GetRootValues(tensors, indices, &unique_device);
+      std::vector<const torch::lazy::Node*> root_nodes;
+      for (auto& ir_value : root_values) {
+        root_nodes.push_back(ir_value.node.get());
+      }
+      std::string record =
+          DumpUtil::ToBinary(root_nodes, name, GetPythonFramesInfo());
+      std::lock_guard<std::mutex> guard(lock);
+      AppendBinaryRecord(save_file, record);
+      return;
+    }
     std::string info = GetTensorsGraphInfo(tensors, indices, format);
     std::lock_guard<std::mutex> guard(lock);
     std::ofstream graph_file(save_file, std::ios_base::app);
@@ -189,6 +230,13 @@ void DebugUtil::SaveGraphHash(torch::lazy::hash_t graph_hash) {
     // perfomrance implcation should be OK.
     static std::mutex lock;
     std::lock_guard<std::mutex> guard(lock);
+    if (GetDefaultGraphFormat() == GraphFormat::kBinary) {
+      AppendBinaryRecord(save_file,
+                         binary_dump::GraphHashRecord(
+                             c10::Uint128Low64(graph_hash),
+                             c10::Uint128High64(graph_hash)));
+      return;
+    }
     std::ofstream graph_file(save_file, std::ios_base::app);
     graph_file << "Graph Hash: " << torch::lazy::HashToString(graph_hash)
                << "\n\n## END_GRAPH\n\n";
@@ -280,7 +328,7 @@ void DebugUtil::analyze_graph_execution_python_frame(
     return;
   }
   std::vector<torch::lazy::SourceLocation> frames =
-      torch::lazy::GetPythonFrames();
+      FrameTable::Get()->CaptureFrames();
   // python frame must be > 1
   if (frames.size() == 0) {
     // There is no python frame. Current thread might be started by
@@ -18,6 +18,9 @@ class DebugUtil {
     kDot,
     kHlo,
     kStableHlo,
+    // The binary format of ir_binary_dump.h, only written by
+    // SaveTensorsGraphInfo(). GetTensorsGraphInfo() falls back to kText.
+    kBinary,
   };
 
   enum GraphAnalysisSource {
@@ -0,0 +1,160 @@
+#include "torch_xla/csrc/device_data_cache.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+#include "torch_xla/csrc/tensor_util.h"
+
+namespace torch_xla {
+namespace {
+
+// The number of evenly spaced samples hashed for the tensors too large to be
+// hashed whole, and their size.
+constexpr int64_t kNumSamples = 64;
+constexpr int64_t kSampleBytes = 256;
+// The number of sample keys of the large tensors remembered to have been seen.
+constexpr size_t kMaxSeenKeys = 1024;
+
+}  // namespace
+
+bool IsSharedDeviceData(const torch::lazy::BackendDataPtr& data) {
+  return dynamic_cast<const SharedDeviceDataInfo*>(data->info()) != nullptr;
+}
+
+DeviceDataCache* DeviceDataCache::Get() {
+  static DeviceDataCache* cache = []() -> DeviceDataCache* {
+    int64_t max_mb =
+        runtime::sys_util::GetEnvInt("XLA_DEVICE_DATA_CACHE_MB", 0);
+    if (max_mb <= 0) {
+      return nullptr;
+    }
+    int64_t sample_kb =
+        runtime::sys_util::GetEnvInt("XLA_DEVICE_DATA_CACHE_SAMPLE_KB", 1024);
+    return new DeviceDataCache(max_mb << 20, sample_kb << 10);
+  }();
+  return cache;
+}
+
+DeviceDataCache::DeviceDataCache(int64_t max_bytes, int64_t sample_bytes)
+    : max_bytes_(max_bytes),
+      sample_bytes_(std::max(sample_bytes, kNumSamples * kSampleBytes)) {}
+
+torch::lazy::BackendDataPtr DeviceDataCache::GetOrUpload(
+    const at::Tensor& tensor, const torch::lazy::BackendDevice& device) {
+  at::Tensor contiguous = tensor.contiguous();
+  int64_t bytes = contiguous.nbytes();
+  if (bytes > max_bytes_) {
+    return TensorToXlaData(contiguous, device);
+  }
+  bool sampled = bytes > sample_bytes_;
+  torch::lazy::hash_t hash =
+      sampled ? SampleHash(contiguous) : TensorHash(contiguous);
+  std::string key = absl::StrCat(
+      device.toString(), "|", c10::toString(contiguous.scalar_type()), "|",
+      absl::StrJoin(contiguous.sizes(), ","), "|",
+      torch::lazy::HashToString(hash));
+  torch::lazy::BackendDataPtr cached;
+  torch::lazy::hash_t cached_content_hash;
+  bool first_seen = false;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      cached = it->second.data;
+      cached_content_hash = it->second.content_hash;
+    } else if (sampled) {
+      first_seen = MarkSeenLocked(key);
+    }
+  }
+  if (first_seen) {
+    // The large tensors are only cached once their samples were seen before,
+    // so that the ones with new contents at every step, like the input
+    // batches, are not hashed whole.
+    TORCH_LAZY_COUNTER("DeviceDataCacheMiss", 1);
+    return TensorToXlaData(contiguous, device);
+  }
+  // A sampled key only tells that the contents may be the same.
+  torch::lazy::hash_t content_hash =
+      sampled ? TensorHash(contiguous) : torch::lazy::hash_t();
+  if (cached != nullptr && content_hash == cached_content_hash &&
+      cached->HasValue()) {
+    TORCH_LAZY_COUNTER("DeviceDataCacheHit", 1);
+    TORCH_LAZY_COUNTER("DeviceDataCacheBytesSaved", bytes);
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.data == cached) {
+      lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_it);
+    }
+    return cached;
+  }
+  TORCH_LAZY_COUNTER("DeviceDataCacheMiss", 1);
+  torch::lazy::BackendDataPtr data = TensorToXlaData(contiguous, device);
+  data->SetInfo(std::make_shared<SharedDeviceDataInfo>());
+
+  std::lock_guard<std::mutex> lock(lock_);
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    // The stale entry, or one uploaded concurrently by another thread.
+    bytes_ -= it->second.bytes;
+    lru_list_.erase(it->second.lru_it);
+    entries_.erase(it);
+  }
+  lru_list_.push_front(key);
+  entries_.emplace(std::move(key),
+                   Entry{data, bytes, content_hash, lru_list_.begin()});
+  bytes_ += bytes;
+  EvictLocked();
+  return data;
+}
+
+void DeviceDataCache::Clear() {
+  std::lock_guard<std::mutex> lock(lock_);
+  seen_list_.clear();
+  seen_keys_.clear();
+  lru_list_.clear();
+  entries_.clear();
+  bytes_ = 0;
+}
+
+torch::lazy::hash_t DeviceDataCache::SampleHash(
+    const at::Tensor& tensor) const {
+  const char* data = static_cast<const char*>(tensor.const_data_ptr());
+  int64_t bytes = tensor.nbytes();
+  int64_t stride = (bytes - kSampleBytes) / (kNumSamples - 1);
+  torch::lazy::hash_t hash = torch::lazy::MHash(bytes);
+  for (int64_t i = 0; i < kNumSamples; ++i) {
+    hash = torch::lazy::HashCombine(
+        hash, torch::lazy::DataHash(data + i * stride, kSampleBytes));
+  }
+  return hash;
+}
+
+bool DeviceDataCache::MarkSeenLocked(const std::string& key) {
+  if (!seen_keys_.insert(key).second) {
+    return false;
+  }
+  seen_list_.push_back(key);
+  if (seen_list_.size() > kMaxSeenKeys) {
+    seen_keys_.erase(seen_list_.front());
+    seen_list_.pop_front();
+  }
+  return true;
+}
+
+void DeviceDataCache::EvictLocked() {
+  while (bytes_ > max_bytes_ && !lru_list_.empty()) {
+    auto it = entries_.find(lru_list_.back());
+    bytes_ -= it->second.bytes;
+    entries_.erase(it);
+    lru_list_.pop_back();
+    TORCH_LAZY_COUNTER("DeviceDataCacheEvict", 1);
+  }
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,83 @@
+#ifndef XLA_TORCH_XLA_CSRC_DEVICE_DATA_CACHE_H_
+#define XLA_TORCH_XLA_CSRC_DEVICE_DATA_CACHE_H_
+
+#include <ATen/Tensor.h>
+#include <torch/csrc/lazy/backend/backend_data.h>
+#include <torch/csrc/lazy/backend/backend_device.h>
+#include <torch/csrc/lazy/core/hash.h>
+#include <torch/csrc/lazy/core/lazy_graph_executor.h>
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace torch_xla {
+
+// The info of the device data shared by the tensors of the same value, which
+// stays read only so that no graph donates it.
+struct SharedDeviceDataInfo
+    : public torch::lazy::LazyGraphExecutor::DeviceDataInfo {
+  SharedDeviceDataInfo()
+      : DeviceDataInfo(/*tensor_id=*/-1, /*read_only=*/true) {}
+};
+
+bool IsSharedDeviceData(const torch::lazy::BackendDataPtr& data);
+
+// Content addressed cache of the device data uploaded from the host tensors,
+// so that the tensors recreated with the same contents at every step, like
+// attention masks, position ids or rotary tables, reuse the device buffers of
+// their previous uploads. The least recently used data are evicted past
+// XLA_DEVICE_DATA_CACHE_MB. The tensors up to XLA_DEVICE_DATA_CACHE_SAMPLE_KB
+// are looked up by the hash of their contents; the larger ones by the hash of
+// evenly spaced samples of them, and only cached from the second time their
+// samples are seen, their full hash then confirming the hits.
+class DeviceDataCache {
+ public:
+  // The cache of the process, nullptr unless XLA_DEVICE_DATA_CACHE_MB is set.
+  static DeviceDataCache* Get();
+
+  DeviceDataCache(int64_t max_bytes, int64_t sample_bytes);
+
+  // Returns the device data holding the value of the host `tensor` on
+  // `device`, uploading it on a miss. The data are shared by all the tensors
+  // with the same value, and marked read only so that no graph donates them.
+  torch::lazy::BackendDataPtr GetOrUpload(
+      const at::Tensor& tensor, const torch::lazy::BackendDevice& device);
+
+  void Clear();
+
+ private:
+  struct Entry {
+    torch::lazy::BackendDataPtr data;
+    int64_t bytes = 0;
+    // The hash of the whole contents, for the keys made from samples.
+    torch::lazy::hash_t content_hash;
+    std::list<std::string>::iterator lru_it;
+  };
+
+  // Hashes samples of the contents, rather than all of them, when larger than
+  // `sample_bytes_`.
+  torch::lazy::hash_t SampleHash(const at::Tensor& tensor) const;
+
+  // Records that the sample key of a large tensor was seen, returning whether
+  // it was the first time.
+  bool MarkSeenLocked(const std::string& key);
+
+  void EvictLocked();
+
+  const int64_t max_bytes_;
+  const int64_t sample_bytes_;
+  std::mutex lock_;
+  std::list<std::string> lru_list_;
+  std::unordered_map<std::string, Entry> entries_;
+  std::list<std::string> seen_list_;
+  std::unordered_set<std::string> seen_keys_;
+  int64_t bytes_ = 0;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_DEVICE_DATA_CACHE_H_
@@ -0,0 +1,129 @@
+#include "torch_xla/csrc/device_loader.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "torch_xla/csrc/aten_xla_bridge.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/tensor_util.h"
+#include "torch_xla/csrc/thread_pool.h"
+
+namespace torch_xla {
+
+DeviceLoader::DeviceLoader(std::string device, size_t prefetch_depth)
+    : device_(std::move(device)),
+      prefetch_depth_(std::max<size_t>(prefetch_depth, 1)) {}
+
+DeviceLoader::~DeviceLoader() {
+  Close();
+  std::unique_lock<std::mutex> lock(lock_);
+  cv_.wait(lock, [this] { return inflight_transfers_ == 0; });
+}
+
+bool DeviceLoader::Put(std::vector<at::Tensor> tensors,
+                       std::vector<XLATensor::ShardingSpecPtr> sharding_specs) {
+  XLA_CHECK(sharding_specs.empty() || sharding_specs.size() == tensors.size())
+      << "Expected " << tensors.size() << " sharding specs, got "
+      << sharding_specs.size();
+  auto batch = std::make_shared<Batch>();
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    XLA_CHECK(!write_closed_ || closed_)
+        << "Batch put after the loader was closed for writing";
+    if (batches_.size() >= prefetch_depth_ && !closed_) {
+      TORCH_LAZY_COUNTER("DeviceLoaderPutWait", 1);
+      cv_.wait(lock, [this] {
+        return batches_.size() < prefetch_depth_ || closed_;
+      });
+    }
+    if (closed_) {
+      return false;
+    }
+    batches_.push_back(batch);
+    inflight_transfers_ += 1;
+  }
+  thread::ScheduleBackground(
+      [this, batch, tensors = std::move(tensors),
+       sharding_specs = std::move(sharding_specs)]() mutable {
+        Transfer(std::move(batch), std::move(tensors),
+                 std::move(sharding_specs));
+      });
+  return true;
+}
+
+std::optional<std::vector<at::Tensor>> DeviceLoader::Get() {
+  std::unique_lock<std::mutex> lock(lock_);
+  auto can_take = [this] {
+    return closed_ || (!batches_.empty() && batches_.front()->ready) ||
+           (batches_.empty() && write_closed_);
+  };
+  if (!can_take()) {
+    TORCH_LAZY_COUNTER("DeviceLoaderGetWait", 1);
+    cv_.wait(lock, can_take);
+  }
+  if (closed_ || batches_.empty()) {
+    return std::nullopt;
+  }
+  std::shared_ptr<Batch> batch = std::move(batches_.front());
+  batches_.pop_front();
+  cv_.notify_all();
+  lock.unlock();
+  if (batch->error) {
+    std::rethrow_exception(batch->error);
+  }
+  return std::move(batch->tensors);
+}
+
+void DeviceLoader::CloseWrite() {
+  std::lock_guard<std::mutex> lock(lock_);
+  write_closed_ = true;
+  cv_.notify_all();
+}
+
+void DeviceLoader::Close() {
+  std::lock_guard<std::mutex> lock(lock_);
+  write_closed_ = true;
+  closed_ = true;
+  batches_.clear();
+  cv_.notify_all();
+}
+
+size_t DeviceLoader::pending() {
+  std::lock_guard<std::mutex> lock(lock_);
+  return batches_.size();
+}
+
+void DeviceLoader::Transfer(
+    std::shared_ptr<Batch> batch, std::vector<at::Tensor> host_tensors,
+    std::vector<XLATensor::ShardingSpecPtr> sharding_specs) {
+  std::vector<at::Tensor> tensors;
+  std::exception_ptr error;
+  try {
+    TORCH_LAZY_TIMED("DeviceLoaderTransfer");
+    std::vector<std::string> devices(host_tensors.size(), device_);
+    std::vector<torch::lazy::BackendDataPtr> handles =
+        sharding_specs.empty()
+            ? CreateTensorsData(host_tensors, devices)
+            : CreateTensorsData(host_tensors, sharding_specs, devices);
+    tensors.reserve(handles.size());
+    for (size_t i = 0; i < handles.size(); ++i) {
+      XLATensorPtr xtensor = XLATensor::Create(std::move(handles[i]));
+      if (!sharding_specs.empty() && sharding_specs[i] != nullptr) {
+        xtensor->SetShardingSpec(*sharding_specs[i]);
+      }
+      tensors.push_back(bridge::AtenFromXlaTensor(std::move(xtensor)));
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  std::lock_guard<std::mutex> lock(lock_);
+  batch->tensors = std::move(tensors);
+  batch->error = error;
+  batch->ready = true;
+  inflight_transfers_ -= 1;
+  cv_.notify_all();
+}
+
+}  // namespace torch_xla
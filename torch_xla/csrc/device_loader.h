@@ -0,0 +1,75 @@
+#ifndef XLA_TORCH_XLA_CSRC_DEVICE_LOADER_H_
+#define XLA_TORCH_XLA_CSRC_DEVICE_LOADER_H_
+
+#include <ATen/Tensor.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "torch_xla/csrc/tensor.h"
+
+namespace torch_xla {
+
+// Moves the host batches of an input pipeline to a device out of the GIL.
+// The tensors of each batch are converted to their device types, sharded if
+// given sharding specs, and transferred on the background threads, while up to
+// `prefetch_depth` batches are in flight or ready. The ready batches are taken
+// in the order they were put, as XLA tensors backed by their device data.
+class DeviceLoader {
+ public:
+  DeviceLoader(std::string device, size_t prefetch_depth);
+
+  // Waits for the transfers in flight, whose batches are dropped.
+  ~DeviceLoader();
+
+  // Schedules the transfer of the host `tensors` of a batch, first waiting
+  // while `prefetch_depth` batches are pending. The `sharding_specs` are
+  // either empty or one per tensor, nullptr for the unsharded ones. Returns
+  // false, dropping the batch, once the loader is closed.
+  bool Put(std::vector<at::Tensor> tensors,
+           std::vector<XLATensor::ShardingSpecPtr> sharding_specs);
+
+  // Takes the next batch, waiting for its transfer to complete, or
+  // std::nullopt once the loader is closed and all the batches were taken.
+  // Rethrows the error of a failed transfer.
+  std::optional<std::vector<at::Tensor>> Get();
+
+  // No more batches are put, the pending ones still being taken by Get().
+  void CloseWrite();
+
+  // Drops the pending batches and wakes up the waiting Put() and Get().
+  void Close();
+
+  size_t pending();
+
+ private:
+  struct Batch {
+    std::vector<at::Tensor> tensors;
+    bool ready = false;
+    std::exception_ptr error;
+  };
+
+  void Transfer(std::shared_ptr<Batch> batch,
+                std::vector<at::Tensor> host_tensors,
+                std::vector<XLATensor::ShardingSpecPtr> sharding_specs);
+
+  const std::string device_;
+  const size_t prefetch_depth_;
+  std::mutex lock_;
+  std::condition_variable cv_;
+  std::deque<std::shared_ptr<Batch>> batches_;
+  size_t inflight_transfers_ = 0;
+  bool write_closed_ = false;
+  bool closed_ = false;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_DEVICE_LOADER_H_
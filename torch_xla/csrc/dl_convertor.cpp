@@ -1,6 +1,7 @@
 #include "torch_xla/csrc/dl_convertor.h"
 
 #include <ATen/DLConvertor.h>
+#include <torch/csrc/lazy/core/metrics.h>
 
 #include "absl/types/span.h"
 #include "torch_xla/csrc/aten_xla_bridge.h"
@@ -114,7 +115,8 @@ std::vector<int64_t> StridesForShape(xla::PrimitiveType element_type,
 }
 
 // Convert an XLA tensor to a dlPack tensor.
-DLManagedTensor* toDLPack(const at::Tensor& input) {
+DLManagedTensor* toDLPack(const at::Tensor& input,
+                          std::optional<std::intptr_t> stream) {
   std::shared_ptr<runtime::ComputationClient::Data> handle =
       get_data_handle(input);
   XLA_CHECK(handle != nullptr)
@@ -137,9 +139,17 @@ DLManagedTensor* toDLPack(const at::Tensor& input) {
     auto external_ref = pjrt_buffer->AcquireExternalReference();
     XLA_CHECK_OK(external_ref.status());
     pack->external_reference = std::move(external_ref.value());
-    xla::PjRtFuture<> future = pjrt_buffer->GetReadyFuture();
-    absl::Status status = future.Await();
-    XLA_CHECK_OK(status);
+    if (stream.has_value()) {
+      if (*stream != kDLPackNoSyncStream) {
+        XLA_CHECK_OK(
+            pack->external_reference->WaitUntilBufferReadyOnStream(*stream));
+      }
+      TORCH_LAZY_COUNTER("DLPackStreamOrderedExport", 1);
+    } else {
+      xla::PjRtFuture<> future = pjrt_buffer->GetReadyFuture();
+      absl::Status status = future.Await();
+      XLA_CHECK_OK(status);
+    }
   }
   pack->buffer_reference = pjrt_buffer;
 
@@ -297,7 +307,8 @@ absl::StatusOr<std::vector<int64_t>> StridesToLayout(
   return minor_to_major;
 }
 
-at::Tensor fromDLPack(DLManagedTensor* dlmt) {
+at::Tensor fromDLPack(DLManagedTensor* dlmt,
+                      std::optional<std::intptr_t> stream) {
   XLA_CHECK(dlmt->dl_tensor.ndim >= 0)
       << "Number of dimensions in DLManagedTensor must be nonnegative, got "
       << dlmt->dl_tensor.ndim;
@@ -320,6 +331,9 @@ at::Tensor fromDLPack(DLManagedTensor* dlmt) {
   xla::Shape shape = xla::ShapeUtil::MakeShapeWithDenseLayout(
       element_type, dimensions, minor_to_major);
 
+  if (stream.has_value() && *stream == kDLPackNoSyncStream) {
+    stream = std::nullopt;
+  }
   std::function<void()> on_delete_callback;
   if (dlmt->deleter) {
     on_delete_callback = [dlmt]() { dlmt->deleter(dlmt); };
@@ -328,7 +342,7 @@ at::Tensor fromDLPack(DLManagedTensor* dlmt) {
       device->client()->CreateViewOfDeviceBuffer(
           static_cast<char*>(dlmt->dl_tensor.data) +
               dlmt->dl_tensor.byte_offset,
-          shape, device, on_delete_callback);
+          shape, device, on_delete_callback, stream);
   XLA_CHECK_OK(pjrt_buffer.status()) << "Failed to create a pjrt buffer.";
   XLA_CHECK(pjrt_buffer.value() != nullptr) << "pjrt buffer is null.";
 
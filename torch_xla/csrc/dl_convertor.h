@@ -4,10 +4,26 @@
 #include <ATen/Tensor.h>
 #include <ATen/dlpack.h>
 
+#include <cstdint>
+#include <optional>
+
 namespace torch_xla {
 
-DLManagedTensor* toDLPack(const at::Tensor& src);
-at::Tensor fromDLPack(DLManagedTensor* src);
+// The DLPack stream of a consumer which orders its own accesses, so that no
+// synchronization is needed.
+constexpr std::intptr_t kDLPackNoSyncStream = -1;
+
+// Exports the buffer of `src`. With a consumer `stream`, per the DLPack stream
+// protocol, the stream is made to wait for the pending writes of the buffer,
+// instead of the host waiting for the buffer to be ready.
+DLManagedTensor* toDLPack(const at::Tensor& src,
+                          std::optional<std::intptr_t> stream = std::nullopt);
+
+// Imports the buffer of `src`. With a `stream` on which the producer ordered
+// its writes, like the one of GetCudaStreamForDevice(), the XLA computations
+// using the buffer are ordered after the work pending on it.
+at::Tensor fromDLPack(DLManagedTensor* src,
+                      std::optional<std::intptr_t> stream = std::nullopt);
 
 }  // namespace torch_xla
 
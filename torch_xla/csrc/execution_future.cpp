@@ -0,0 +1,122 @@
+#include "torch_xla/csrc/execution_future.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <algorithm>
+
+#include "torch_xla/csrc/runtime/runtime.h"
+#include "torch_xla/csrc/runtime/tf_logging.h"
+
+namespace torch_xla {
+namespace {
+
+thread_local std::shared_ptr<ExecutionFuture> g_last_execution_future;
+
+}  // namespace
+
+std::shared_ptr<ExecutionFuture> ExecutionFuture::Begin(
+    torch::lazy::hash_t hash) {
+  g_last_execution_future = std::make_shared<ExecutionFuture>(hash);
+  return g_last_execution_future;
+}
+
+std::shared_ptr<ExecutionFuture> ExecutionFuture::Last() {
+  return g_last_execution_future;
+}
+
+void ExecutionFuture::ClearLast() { g_last_execution_future = nullptr; }
+
+void ExecutionFuture::Dispatched(
+    absl::Span<const runtime::ComputationClient::DataPtr> outputs) {
+  // The outputs of an execution are defined together, the first one tells
+  // about the whole execution (one future per device for sharded data).
+  std::vector<xla::PjRtFuture<>> futures;
+  if (!outputs.empty()) {
+    futures =
+        runtime::GetComputationClient()->GetReadyFutures(outputs.subspan(0, 1));
+  }
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    pending_ = std::max<size_t>(futures.size(), 1);
+  }
+  if (futures.empty()) {
+    // The client does not track readiness, the dispatch is all there is.
+    Complete("");
+    return;
+  }
+  for (xla::PjRtFuture<>& future : futures) {
+    future.OnReady([this, self = shared_from_this()](xla::Status status) {
+      Complete(status.ok() ? "" : status.ToString());
+    });
+  }
+}
+
+void ExecutionFuture::Failed(std::exception_ptr exception) {
+  std::string error = "Unknown error";
+  try {
+    std::rethrow_exception(exception);
+  } catch (const std::exception& ex) {
+    error = ex.what();
+  } catch (...) {
+  }
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    pending_ = 1;
+  }
+  Complete(error);
+}
+
+bool ExecutionFuture::IsDone() {
+  std::lock_guard<std::mutex> lock(lock_);
+  return done_;
+}
+
+std::string ExecutionFuture::Wait() {
+  std::unique_lock<std::mutex> lock(lock_);
+  cv_.wait(lock, [this] { return done_; });
+  return error_;
+}
+
+std::string ExecutionFuture::GetError() {
+  std::lock_guard<std::mutex> lock(lock_);
+  return done_ ? error_ : "";
+}
+
+void ExecutionFuture::AddDoneCallback(DoneCallback callback) {
+  std::string error;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (!done_) {
+      callbacks_.push_back(std::move(callback));
+      return;
+    }
+    error = error_;
+  }
+  callback(error);
+}
+
+void ExecutionFuture::Complete(const std::string& error) {
+  std::vector<DoneCallback> callbacks;
+  std::string final_error;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (!error.empty() && error_.empty()) {
+      error_ = "Execution of IR graph hash " +
+               torch::lazy::HashToString(hash_) + " failed: " + error;
+      TF_LOG(ERROR) << error_;
+      TORCH_LAZY_COUNTER("ExecutionFutureError", 1);
+    }
+    if (--pending_ > 0) {
+      return;
+    }
+    done_ = true;
+    callbacks.swap(callbacks_);
+    final_error = error_;
+  }
+  cv_.notify_all();
+  for (DoneCallback& callback : callbacks) {
+    callback(final_error);
+  }
+}
+
+}  // namespace torch_xla
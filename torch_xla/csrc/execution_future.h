@@ -0,0 +1,80 @@
+#ifndef XLA_TORCH_XLA_CSRC_EXECUTION_FUTURE_H_
+#define XLA_TORCH_XLA_CSRC_EXECUTION_FUTURE_H_
+
+#include <torch/csrc/lazy/core/hash.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "torch_xla/csrc/runtime/computation_client.h"
+
+namespace torch_xla {
+
+// The completion of a graph execution scheduled by the graph executor, which
+// becomes done once the execution has completed on the device, or has failed
+// to be dispatched. Failures are logged as soon as they are known, with the
+// hash of the failed graph (counter ExecutionFutureError).
+class ExecutionFuture : public std::enable_shared_from_this<ExecutionFuture> {
+ public:
+  // Called with the error of the execution, empty on success.
+  using DoneCallback = std::function<void(const std::string& error)>;
+
+  // Creates the future of an execution about to be scheduled by the calling
+  // thread, which becomes the thread's last execution future.
+  static std::shared_ptr<ExecutionFuture> Begin(torch::lazy::hash_t hash);
+
+  // The future of the last execution scheduled by the calling thread, or
+  // nullptr if none was scheduled since the last ClearLast().
+  static std::shared_ptr<ExecutionFuture> Last();
+
+  static void ClearLast();
+
+  explicit ExecutionFuture(torch::lazy::hash_t hash) : hash_(hash) {}
+
+  torch::lazy::hash_t hash() const { return hash_; }
+
+  // To be called by the execution closure once the computation has been
+  // dispatched, with its outputs.
+  void Dispatched(
+      absl::Span<const runtime::ComputationClient::DataPtr> outputs);
+
+  // To be called by the execution closure when the dispatch failed.
+  void Failed(std::exception_ptr exception);
+
+  bool IsDone();
+
+  // Waits for the execution to be done and returns its error, empty on
+  // success.
+  std::string Wait();
+
+  // The error of the execution, empty on success or while not done.
+  std::string GetError();
+
+  // Runs `callback` once the execution is done, right away from the calling
+  // thread if it is done already, else from the thread completing it.
+  void AddDoneCallback(DoneCallback callback);
+
+ private:
+  // Records the completion of one of the pending device futures, with its
+  // error if any.
+  void Complete(const std::string& error);
+
+  const torch::lazy::hash_t hash_;
+  std::mutex lock_;
+  std::condition_variable cv_;
+  bool done_ = false;
+  size_t pending_ = 0;
+  std::string error_;
+  std::vector<DoneCallback> callbacks_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_EXECUTION_FUTURE_H_
@@ -0,0 +1,68 @@
+#include "torch_xla/csrc/frame_table.h"
+
+#include "torch_xla/csrc/runtime/debug_macros.h"
+
+namespace torch_xla {
+
+FrameTable* FrameTable::Get() {
+  static FrameTable* table = new FrameTable();
+  return table;
+}
+
+void FrameTable::SetCaptureFunction(CaptureFn capture_fn) {
+  capture_fn_ = std::move(capture_fn);
+}
+
+int32_t FrameTable::CaptureStack() const {
+  return capture_fn_ ? capture_fn_() : kNoStack;
+}
+
+std::vector<torch::lazy::SourceLocation> FrameTable::CaptureFrames() const {
+  return GetFrames(CaptureStack());
+}
+
+int32_t FrameTable::InternFrame(
+    const void* code, int line,
+    const std::function<torch::lazy::SourceLocation()>& make_location) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto it = frame_ids_.find({code, line});
+  if (it != frame_ids_.end()) {
+    return it->second;
+  }
+  frames_.push_back(make_location());
+  int32_t frame = static_cast<int32_t>(frames_.size() - 1);
+  frame_ids_.emplace(std::make_pair(code, line), frame);
+  return frame;
+}
+
+int32_t FrameTable::InternStack(int32_t caller, int32_t frame) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto it = stack_ids_.find({frame, caller});
+  if (it != stack_ids_.end()) {
+    return it->second;
+  }
+  stacks_.emplace_back(frame, caller);
+  int32_t stack = static_cast<int32_t>(stacks_.size());
+  stack_ids_.emplace(std::make_pair(frame, caller), stack);
+  return stack;
+}
+
+std::vector<torch::lazy::SourceLocation> FrameTable::GetFrames(
+    int32_t stack) const {
+  std::vector<torch::lazy::SourceLocation> frames;
+  std::lock_guard<std::mutex> lock(lock_);
+  while (stack != kNoStack) {
+    const std::pair<int32_t, int32_t>& entry = stacks_.at(stack - 1);
+    frames.push_back(frames_[entry.first]);
+    stack = entry.second;
+  }
+  return frames;
+}
+
+torch::lazy::SourceLocation FrameTable::GetTopFrame(int32_t stack) const {
+  XLA_CHECK_NE(stack, kNoStack);
+  std::lock_guard<std::mutex> lock(lock_);
+  return frames_[stacks_.at(stack - 1).first];
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,81 @@
+#ifndef XLA_TORCH_XLA_CSRC_FRAME_TABLE_H_
+#define XLA_TORCH_XLA_CSRC_FRAME_TABLE_H_
+
+#include <torch/csrc/lazy/core/ir_metadata.h>
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace torch_xla {
+
+// Interned Python call stacks, which make the frames of the IR nodes cheap
+// enough to capture in debug mode (XLA_IR_DEBUG or XLA_HLO_DEBUG). Each call
+// site (code object and line) is interned once along with its file and
+// function names, and a stack is interned as a (frame, caller stack) pair, so
+// that a node only keeps the id of its stack. The stacks are only expanded
+// into source locations when lowered or dumped.
+class FrameTable {
+ public:
+  // The id of the empty stack.
+  static constexpr int32_t kNoStack = 0;
+
+  // Captures the current stack, returning its id.
+  using CaptureFn = std::function<int32_t()>;
+
+  static FrameTable* Get();
+
+  // Installs the function capturing the Python stacks, set by the Python
+  // bindings.
+  void SetCaptureFunction(CaptureFn capture_fn);
+
+  // The id of the current stack, or kNoStack if no capture function is set.
+  int32_t CaptureStack() const;
+
+  // The frames of the current stack, for the debug reports. Unlike
+  // torch::lazy::GetPythonFrames, which the bindings leave empty so that the
+  // upstream IR metadata skips them, it works with the GIL released, which the
+  // capture function takes.
+  std::vector<torch::lazy::SourceLocation> CaptureFrames() const;
+
+  // The id of the call site at `line` of `code`, interned with the location
+  // returned by `make_location` the first time.
+  int32_t InternFrame(
+      const void* code, int line,
+      const std::function<torch::lazy::SourceLocation()>& make_location);
+
+  // The id of the stack of `frame` called from `caller`.
+  int32_t InternStack(int32_t caller, int32_t frame);
+
+  // The frames of `stack`, innermost first like torch::lazy::GetPythonFrames.
+  std::vector<torch::lazy::SourceLocation> GetFrames(int32_t stack) const;
+
+  // The innermost frame of the non empty `stack`.
+  torch::lazy::SourceLocation GetTopFrame(int32_t stack) const;
+
+ private:
+  struct PairHash {
+    template <typename T, typename U>
+    size_t operator()(const std::pair<T, U>& pair) const {
+      return std::hash<T>()(pair.first) * 31 + std::hash<U>()(pair.second);
+    }
+  };
+
+  CaptureFn capture_fn_;
+  mutable std::mutex lock_;
+  std::unordered_map<std::pair<const void*, int>, int32_t, PairHash>
+      frame_ids_;
+  std::vector<torch::lazy::SourceLocation> frames_;
+  std::unordered_map<std::pair<int32_t, int32_t>, int32_t, PairHash>
+      stack_ids_;
+  // The (frame, caller stack) pair of each stack, the stack of id s being at
+  // index s - 1.
+  std::vector<std::pair<int32_t, int32_t>> stacks_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_FRAME_TABLE_H_
@@ -1,7 +1,5 @@
 #include "torch_xla/csrc/function_call_tracker.h"
 
-#include <torch/csrc/lazy/python/python_util.h>
-
 #include <fstream>
 #include <limits>
 #include <mutex>
@@ -10,6 +8,7 @@
 #include <unordered_set>
 
 #include "absl/strings/str_split.h"
+#include "torch_xla/csrc/frame_table.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "tsl/platform/stacktrace.h"
 
@@ -58,7 +57,7 @@ void LogFunction(TrackerContext* tctx, const char* tag) {
   std::ofstream fn_file(tctx->path, std::ios_base::app);
   fn_file << "[TAG " << tag << " From Thread " << std::this_thread::get_id()
           << "]\n"
-          << torch::lazy::GetPythonFrames() << "\nC++ Frames:\n"
+          << FrameTable::Get()->CaptureFrames() << "\nC++ Frames:\n"
           << tsl::CurrentStackTrace() << "\n";
 }
 
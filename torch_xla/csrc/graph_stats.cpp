@@ -0,0 +1,153 @@
+#include "torch_xla/csrc/graph_stats.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include "absl/strings/str_cat.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+#include "torch_xla/csrc/runtime/tf_logging.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+
+namespace {
+
+// The bytes of the arrays of `shape`, within its tuples if any.
+int64_t ArrayBytes(const xla::Shape& shape) {
+  int64_t bytes = 0;
+  xla::ShapeUtil::ForEachSubshape(
+      shape, [&](const xla::Shape& subshape, const xla::ShapeIndex& index) {
+        if (subshape.IsArray()) {
+          bytes += xla::ShapeUtil::ByteSizeOfElements(subshape);
+        }
+      });
+  return bytes;
+}
+
+}  // namespace
+
+GraphStats* GraphStats::Get() {
+  static GraphStats* stats = new GraphStats();
+  return stats;
+}
+
+void GraphStats::RecordCompile(
+    const torch::lazy::hash_t& hash, int64_t compile_ns,
+    const runtime::ComputationClient::Computation& computation) {
+  const xla::ProgramShape& program_shape = computation.program_shape();
+  int64_t argument_bytes = 0;
+  for (const xla::Shape& shape : program_shape.parameters()) {
+    argument_bytes += ArrayBytes(shape);
+  }
+  int64_t output_bytes = ArrayBytes(program_shape.result());
+  const runtime::util::CollectiveStats& collective_stats =
+      computation.GetCollectiveStats();
+  int64_t collective_bytes = 0;
+  for (const auto& [name, bytes] : collective_stats.bytes) {
+    collective_bytes += bytes;
+  }
+  std::optional<runtime::ComputationClient::CompiledMemoryStats> memory_stats =
+      computation.GetCompiledMemoryStats();
+  std::lock_guard<std::mutex> lock(lock_);
+  Entry& entry = entries_[hash];
+  entry.compiles += 1;
+  entry.compile_ns += compile_ns;
+  entry.argument_bytes = argument_bytes;
+  entry.output_bytes = output_bytes;
+  entry.collective_bytes = collective_bytes;
+  entry.collective_bus_bytes = collective_stats.bus_bytes;
+  entry.memory_stats = memory_stats;
+}
+
+void GraphStats::RecordExecution(const torch::lazy::hash_t& hash,
+                                 int64_t start_ns, bool failed) {
+  int64_t execute_ns = runtime::sys_util::NowNs() - start_ns;
+  std::lock_guard<std::mutex> lock(lock_);
+  Entry& entry = entries_[hash];
+  if (failed) {
+    entry.failed_executions += 1;
+    return;
+  }
+  entry.executions += 1;
+  entry.execute_ns += execute_ns;
+  entry.max_execute_ns = std::max(entry.max_execute_ns, execute_ns);
+}
+
+int64_t GraphStats::GetCompiles(const torch::lazy::hash_t& hash) const {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto it = entries_.find(hash);
+  return it != entries_.end() ? it->second.compiles : 0;
+}
+
+std::vector<std::pair<torch::lazy::hash_t, GraphStats::Entry>>
+GraphStats::GetEntries() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return std::vector<std::pair<torch::lazy::hash_t, Entry>>(entries_.begin(),
+                                                            entries_.end());
+}
+
+std::string GraphStats::ToJson() const {
+  std::vector<std::pair<torch::lazy::hash_t, Entry>> entries = GetEntries();
+  // The graphs taking the most execution time first.
+  std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+    return a.second.execute_ns > b.second.execute_ns;
+  });
+  std::string json = "{";
+  for (auto& [hash, entry] : entries) {
+    if (json.size() > 1) {
+      absl::StrAppend(&json, ",");
+    }
+    absl::StrAppend(
+        &json, "\"", torch::lazy::HashToString(hash),
+        "\":{\"compiles\":", entry.compiles,
+        ",\"compile_ns\":", entry.compile_ns,
+        ",\"executions\":", entry.executions,
+        ",\"failed_executions\":", entry.failed_executions,
+        ",\"execute_ns\":", entry.execute_ns, ",\"avg_execute_ns\":",
+        entry.executions > 0 ? entry.execute_ns / entry.executions : 0,
+        ",\"max_execute_ns\":", entry.max_execute_ns,
+        ",\"argument_bytes\":", entry.argument_bytes,
+        ",\"output_bytes\":", entry.output_bytes,
+        ",\"collective_bytes\":", entry.collective_bytes,
+        ",\"collective_bus_bytes\":", entry.collective_bus_bytes);
+    if (entry.memory_stats) {
+      absl::StrAppend(
+          &json, ",\"temp_bytes\":", entry.memory_stats->temp_bytes,
+          ",\"alias_bytes\":", entry.memory_stats->alias_bytes,
+          ",\"generated_code_bytes\":",
+          entry.memory_stats->generated_code_bytes,
+          ",\"execution_bytes\":", entry.memory_stats->ExecutionBytes());
+    }
+    absl::StrAppend(&json, "}");
+  }
+  absl::StrAppend(&json, "}");
+  return json;
+}
+
+void GraphStats::DumpToFile() const {
+  static const std::string path =
+      runtime::sys_util::GetEnvString("XLA_GRAPH_STATS_FILE", "");
+  if (path.empty()) {
+    return;
+  }
+  std::string json = ToJson();
+  if (path == "STDOUT") {
+    std::cout << json << std::endl;
+  } else if (path == "STDERR") {
+    std::cerr << json << std::endl;
+  } else {
+    std::ofstream file(path);
+    file << json << std::endl;
+    if (!file) {
+      TF_LOG(WARNING) << "Failed to write the graph stats to " << path;
+    }
+  }
+}
+
+void GraphStats::Clear() {
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_.clear();
+}
+
+}  // namespace torch_xla
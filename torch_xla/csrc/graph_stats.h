@@ -0,0 +1,74 @@
+#ifndef XLA_TORCH_XLA_CSRC_GRAPH_STATS_H_
+#define XLA_TORCH_XLA_CSRC_GRAPH_STATS_H_
+
+#include <torch/csrc/lazy/core/hash.h>
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "torch_xla/csrc/runtime/computation_client.h"
+
+namespace torch_xla {
+
+// Keeps the compilation and execution statistics of each IR graph hash, so
+// that a slowdown of the global metrics can be attributed to the graphs it
+// comes from. The table is dumped as JSON at exit to XLA_GRAPH_STATS_FILE when
+// set (STDOUT and STDERR name the standard streams).
+class GraphStats {
+ public:
+  struct Entry {
+    int64_t compiles = 0;
+    // Total time of the compilations, lowering included.
+    int64_t compile_ns = 0;
+    int64_t executions = 0;
+    int64_t failed_executions = 0;
+    // Time from the dispatch of the successful executions to their outputs
+    // being ready.
+    int64_t execute_ns = 0;
+    int64_t max_execute_ns = 0;
+    int64_t argument_bytes = 0;
+    int64_t output_bytes = 0;
+    // The bytes of the results of the collectives of the graph, and the bytes
+    // each device moves for them (see util::CollectiveStats).
+    int64_t collective_bytes = 0;
+    double collective_bus_bytes = 0;
+    std::optional<runtime::ComputationClient::CompiledMemoryStats>
+        memory_stats;
+  };
+
+  static GraphStats* Get();
+
+  void RecordCompile(const torch::lazy::hash_t& hash, int64_t compile_ns,
+                     const runtime::ComputationClient::Computation& computation);
+
+  // Records an execution dispatched at `start_ns` once it is done.
+  void RecordExecution(const torch::lazy::hash_t& hash, int64_t start_ns,
+                       bool failed);
+
+  // The number of compilations recorded for `hash`.
+  int64_t GetCompiles(const torch::lazy::hash_t& hash) const;
+
+  std::vector<std::pair<torch::lazy::hash_t, Entry>> GetEntries() const;
+
+  // Dumps the entries as a JSON object keyed by graph hash.
+  std::string ToJson() const;
+
+  // Writes ToJson() to XLA_GRAPH_STATS_FILE, if set.
+  void DumpToFile() const;
+
+  void Clear();
+
+ private:
+  mutable std::mutex lock_;
+  std::unordered_map<torch::lazy::hash_t, Entry, torch::lazy::HashReducer>
+      entries_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_GRAPH_STATS_H_
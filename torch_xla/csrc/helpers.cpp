@@ -1,6 +1,7 @@
 #include "torch_xla/csrc/helpers.h"
 
 #include <torch/csrc/lazy/core/helpers.h>
+#include <torch/csrc/lazy/core/metrics.h>
 #include <torch/csrc/lazy/core/util.h>
 
 #include <iterator>
@@ -10,6 +11,7 @@
 #include "torch_xla/csrc/convert_ops.h"
 #include "torch_xla/csrc/dtype.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/tf_logging.h"
 #include "torch_xla/csrc/runtime/util.h"
 #include "torch_xla/csrc/shape_helper.h"
@@ -32,6 +34,31 @@ xla::XlaOp ConvertBinaryOpResult(xla::XlaOp op1, xla::XlaOp op2,
   return result;
 }
 
+enum class IndexNarrowing {
+  kNone,
+  kUnchecked,
+  kChecked,
+};
+
+// How the S64 indices of the gathers and scatters are narrowed, from
+// XLA_NARROW_INDICES.
+IndexNarrowing GetIndexNarrowing() {
+  static const IndexNarrowing narrowing = []() {
+    std::string mode_name =
+        runtime::sys_util::GetEnvString("XLA_NARROW_INDICES", "none");
+    if (mode_name == "unchecked") {
+      return IndexNarrowing::kUnchecked;
+    }
+    if (mode_name == "checked") {
+      return IndexNarrowing::kChecked;
+    }
+    XLA_CHECK_EQ(mode_name, "none")
+        << "Invalid XLA_NARROW_INDICES: " << mode_name;
+    return IndexNarrowing::kNone;
+  }();
+  return narrowing;
+}
+
 xla::XlaComputation CreateComputation(
     const std::string& name, xla::PrimitiveType type,
     const std::function<xla::XlaOp(xla::XlaOp, xla::XlaOp)>& op) {
@@ -228,6 +255,35 @@ xla::XlaComputation XlaHelpers::CreateOrComputation(xla::PrimitiveType type) {
       [&](xla::XlaOp x, xla::XlaOp y) { return xla::Or(x, y); });
 }
 
+xla::PrimitiveType XlaHelpers::NarrowIndexType(xla::PrimitiveType type,
+                                               int64_t dim_size) {
+  if (type != xla::PrimitiveType::S64 ||
+      GetIndexNarrowing() == IndexNarrowing::kNone ||
+      dim_size > std::numeric_limits<int32_t>::max()) {
+    return type;
+  }
+  return xla::PrimitiveType::S32;
+}
+
+xla::XlaOp XlaHelpers::NarrowIndices(xla::XlaOp indices, int64_t dim_size) {
+  xla::PrimitiveType type = TypeOfXlaOp(indices);
+  xla::PrimitiveType narrow_type = NarrowIndexType(type, dim_size);
+  if (narrow_type == type) {
+    return indices;
+  }
+  TORCH_LAZY_COUNTER("NarrowedIndices", 1);
+  if (GetIndexNarrowing() == IndexNarrowing::kChecked) {
+    xla::XlaBuilder* builder = indices.builder();
+    indices = xla::Clamp(
+        ScalarValue<int64_t>(std::numeric_limits<int32_t>::lowest(), type,
+                             builder),
+        indices,
+        ScalarValue<int64_t>(std::numeric_limits<int32_t>::max(), type,
+                             builder));
+  }
+  return xla::ConvertElementType(indices, narrow_type);
+}
+
 std::vector<int64_t> XlaHelpers::SizesOfXlaOp(xla::XlaOp op) {
   const xla::Shape& op_shape = ShapeHelper::ShapeOfXlaOp(op);
   return std::vector<int64_t>(op_shape.dimensions().begin(),
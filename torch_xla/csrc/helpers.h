@@ -229,6 +229,18 @@ class XlaHelpers {
 
   static xla::XlaComputation CreateOrComputation(xla::PrimitiveType type);
 
+  // The type in which the indices into dimensions of at most `dim_size`
+  // elements are computed: S32 for an S64 `type` when XLA_NARROW_INDICES is
+  // set and all the in bounds indices fit, `type` otherwise.
+  static xla::PrimitiveType NarrowIndexType(xla::PrimitiveType type,
+                                            int64_t dim_size);
+
+  // Converts the `indices` of a gather or scatter into dimensions of at most
+  // `dim_size` elements to their NarrowIndexType(). In the "checked" mode the
+  // values out of the S32 range saturate, so that they stay out of bounds and
+  // are clamped by the gathers and skipped by the scatters as before.
+  static xla::XlaOp NarrowIndices(xla::XlaOp indices, int64_t dim_size);
+
   // Returns an XLA operation which is a reshape to the expected rank, by
   // appending 1s to the major dimension. If offset is greater than zero, 1s
   // will be prepened to the minor dimension as well.
@@ -0,0 +1,68 @@
+#include "torch_xla/csrc/host_tensor_future.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <utility>
+#include <vector>
+
+#include "torch_xla/csrc/tensor_util.h"
+#include "torch_xla/csrc/thread_pool.h"
+#include "torch_xla/csrc/xla_graph_executor.h"
+
+namespace torch_xla {
+
+std::shared_ptr<HostTensorFuture> HostTensorFuture::Ready(at::Tensor tensor) {
+  auto future = std::make_shared<HostTensorFuture>();
+  future->Set(std::move(tensor), nullptr);
+  return future;
+}
+
+std::shared_ptr<HostTensorFuture> HostTensorFuture::Fetch(
+    torch::lazy::BackendDataPtr data, torch::lazy::BackendDevice device,
+    at::ScalarType element_type) {
+  TORCH_LAZY_COUNTER("HostTensorFetch", 1);
+  auto future = std::make_shared<HostTensorFuture>();
+  thread::ScheduleBackground([future, data = std::move(data),
+                              device = std::move(device), element_type]() {
+    at::Tensor tensor;
+    std::exception_ptr error;
+    try {
+      if (!data->HasValue()) {
+        // The data is the placeholder of an execution still being
+        // dispatched, which holds the device until its outputs are bound.
+        TORCH_LAZY_COUNTER("HostTensorFetchWait", 1);
+        XLAGraphExecutor::Get()->DeviceBarrier(device);
+      }
+      TORCH_LAZY_TIMED("HostTensorFetchTime");
+      tensor = std::move(XlaDataToTensors({data}, {element_type}).front());
+    } catch (...) {
+      error = std::current_exception();
+    }
+    future->Set(std::move(tensor), error);
+  });
+  return future;
+}
+
+bool HostTensorFuture::IsDone() {
+  std::lock_guard<std::mutex> lock(lock_);
+  return done_;
+}
+
+at::Tensor HostTensorFuture::Wait() {
+  std::unique_lock<std::mutex> lock(lock_);
+  cv_.wait(lock, [this] { return done_; });
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+  return tensor_;
+}
+
+void HostTensorFuture::Set(at::Tensor tensor, std::exception_ptr error) {
+  std::lock_guard<std::mutex> lock(lock_);
+  tensor_ = std::move(tensor);
+  error_ = error;
+  done_ = true;
+  cv_.notify_all();
+}
+
+}  // namespace torch_xla
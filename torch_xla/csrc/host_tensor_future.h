@@ -0,0 +1,48 @@
+#ifndef XLA_TORCH_XLA_CSRC_HOST_TENSOR_FUTURE_H_
+#define XLA_TORCH_XLA_CSRC_HOST_TENSOR_FUTURE_H_
+
+#include <ATen/Tensor.h>
+#include <torch/csrc/lazy/backend/backend_data.h>
+#include <torch/csrc/lazy/backend/backend_device.h>
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+namespace torch_xla {
+
+// The host copy of the value of an XLA tensor, fetched on the background
+// threads once the execution computing it has been dispatched, so that the
+// caller can read it later on without stalling the graphs it schedules in
+// the meantime.
+class HostTensorFuture {
+ public:
+  // A future holding the host `tensor` already.
+  static std::shared_ptr<HostTensorFuture> Ready(at::Tensor tensor);
+
+  // Fetches the value of `data`, on `device`, into a host tensor of
+  // `element_type`.
+  static std::shared_ptr<HostTensorFuture> Fetch(
+      torch::lazy::BackendDataPtr data, torch::lazy::BackendDevice device,
+      at::ScalarType element_type);
+
+  bool IsDone();
+
+  // Waits for the host tensor and returns it, rethrowing the error of a failed
+  // fetch. Do not call it while holding the GIL.
+  at::Tensor Wait();
+
+ private:
+  void Set(at::Tensor tensor, std::exception_ptr error);
+
+  std::mutex lock_;
+  std::condition_variable cv_;
+  bool done_ = false;
+  at::Tensor tensor_;
+  std::exception_ptr error_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_HOST_TENSOR_FUTURE_H_
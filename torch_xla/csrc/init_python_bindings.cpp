@@ -8,11 +8,13 @@
 #include <torch/csrc/jit/python/pybind.h>
 #include <torch/csrc/lazy/backend/backend_data.h>
 #include <torch/csrc/lazy/core/config.h>
+#include <torch/csrc/lazy/core/debug_util.h>
 #include <torch/csrc/lazy/core/ir_util.h>
 #include <torch/csrc/lazy/core/lazy_graph_executor.h>
 
 #include <cstring>
 #include <fstream>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <thread>
@@ -35,27 +37,40 @@
 #include "torch_xla/csrc/aten_autograd_ops.h"
 #include "torch_xla/csrc/aten_cpu_fallback.h"
 #include "torch_xla/csrc/aten_xla_bridge.h"
+#include "torch_xla/csrc/custom_kernel_registry.h"
 #include "torch_xla/csrc/device.h"
+#include "torch_xla/csrc/device_loader.h"
 #include "torch_xla/csrc/dl_convertor.h"
 #include "torch_xla/csrc/dtype.h"
+#include "torch_xla/csrc/execution_future.h"
+#include "torch_xla/csrc/frame_table.h"
+#include "torch_xla/csrc/graph_stats.h"
 #include "torch_xla/csrc/helpers.h"
+#include "torch_xla/csrc/host_tensor_future.h"
 #include "torch_xla/csrc/ir.h"
 #include "torch_xla/csrc/ir_dump_util.h"
 #include "torch_xla/csrc/layout_manager.h"
 #include "torch_xla/csrc/ops/device_data.h"
 #include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/recompile_analyzer.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/metrics_analysis.h"
 #include "torch_xla/csrc/runtime/metrics_reader.h"
+#include "torch_xla/csrc/runtime/metrics_server.h"
 #include "torch_xla/csrc/runtime/pjrt_registry.h"
 #include "torch_xla/csrc/runtime/profiler.h"
 #include "torch_xla/csrc/runtime/runtime.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
+#include "torch_xla/csrc/runtime/tenant.h"
 #include "torch_xla/csrc/runtime/util.h"
 #include "torch_xla/csrc/runtime/xla_coordinator.h"
 #include "torch_xla/csrc/runtime/xla_util.h"
 #include "torch_xla/csrc/shape_helper.h"
+#include "torch_xla/csrc/sharded_checkpoint.h"
+#include "torch_xla/csrc/size_guard_speculation.h"
+#include "torch_xla/csrc/step_pipeline.h"
+#include "torch_xla/csrc/step_timeline.h"
 #include "torch_xla/csrc/tensor_impl.h"
 #include "torch_xla/csrc/tensor_methods.h"
 #include "torch_xla/csrc/tensor_util.h"
@@ -67,6 +82,7 @@
 #include "torch_xla/csrc/xla_sharding_util.h"
 #include "tsl/platform/env.h"
 #include "tsl/profiler/lib/traceme.h"
+#include "tsl/profiler/lib/traceme_encode.h"
 #include "xla/pjrt/distributed/distributed.h"
 #include "xla/python/profiler/internal/traceme_wrapper.h"
 #include "xla/service/custom_call_target_registry.h"
@@ -128,6 +144,14 @@ void PrepareToExit() {
     SetAllReduceToken(xla_device, nullptr);
     XLAGraphExecutor::Get()->WaitDeviceOps({});
   }
+  GraphStats::Get()->DumpToFile();
+  if (XLAGraphExecutor::Get()->IsComputationCacheInitialized()) {
+    auto persistent_cache = dynamic_cast<XLAGraphExecutor::PersistentCache*>(
+        XLAGraphExecutor::Get()->GetComputationCache());
+    if (persistent_cache != nullptr) {
+      persistent_cache->Flush();
+    }
+  }
 }
 
 std::string GetTensorsDump(
@@ -204,7 +228,7 @@ std::vector<std::vector<int64_t>> CreateReduceGroups(const py::list& groups) {
 }
 
 std::vector<at::Tensor> XlaCustomCall(
-    const std::vector<at::Tensor>& inputs, const std::string& payload,
+    const std::vector<at::Tensor>& inputs, int64_t kernel_id,
     const std::vector<std::vector<int64_t>>& output_shapes,
     const std::vector<py::object>& output_dtypes, bool is_tpu) {
   std::vector<at::ScalarType> dtypes;
@@ -215,10 +239,10 @@ std::vector<at::Tensor> XlaCustomCall(
 
   if (is_tpu) {
     return bridge::AtenFromXlaTensors(tensor_methods::tpu_custom_call(
-        bridge::GetXlaTensors(inputs), payload, output_shapes, dtypes));
+        bridge::GetXlaTensors(inputs), kernel_id, output_shapes, dtypes));
   }
   return bridge::AtenFromXlaTensors(tensor_methods::gpu_custom_call(
-      bridge::GetXlaTensors(inputs), payload, output_shapes, dtypes));
+      bridge::GetXlaTensors(inputs), kernel_id, output_shapes, dtypes));
 }
 
 std::vector<std::pair<int64_t, int64_t>> CreateSourceTargetPairs(
@@ -415,6 +439,38 @@ std::shared_ptr<torch::lazy::Value> AllGatherCoalescedOut(
   return std::make_shared<torch::lazy::Value>(new_token);
 }
 
+std::shared_ptr<torch::lazy::Value> AllGatherStart(
+    const at::Tensor& input, const std::shared_ptr<torch::lazy::Value>& token,
+    int64_t dim, int64_t shard_count,
+    const std::vector<std::vector<int64_t>>& replica_groups, bool pin_layout) {
+  torch::lazy::Value start = tensor_methods::all_gather_start(
+      bridge::GetXlaTensor(input), *token, dim, shard_count, replica_groups,
+      pin_layout);
+  return std::make_shared<torch::lazy::Value>(start);
+}
+
+std::shared_ptr<torch::lazy::Value> AllReduceStart(
+    const std::string& reduce_type, const at::Tensor& input,
+    const std::shared_ptr<torch::lazy::Value>& token,
+    const std::vector<std::vector<int64_t>>& replica_groups, bool pin_layout) {
+  torch::lazy::Value start = tensor_methods::all_reduce_start(
+      bridge::GetXlaTensor(input), *token, GetReduceType(reduce_type),
+      replica_groups, pin_layout);
+  return std::make_shared<torch::lazy::Value>(start);
+}
+
+std::pair<at::Tensor, std::shared_ptr<torch::lazy::Value>> AsyncCollectiveDone(
+    const at::Tensor& input, const std::shared_ptr<torch::lazy::Value>& start,
+    const std::shared_ptr<torch::lazy::Value>& token) {
+  XLATensorPtr result;
+  torch::lazy::Value new_token;
+  std::tie(result, new_token) = tensor_methods::async_collective_done(
+      bridge::GetXlaTensor(input), *start, *token);
+  return std::pair<at::Tensor, std::shared_ptr<torch::lazy::Value>>(
+      bridge::AtenFromXlaTensor(std::move(result)),
+      std::make_shared<torch::lazy::Value>(new_token));
+}
+
 std::pair<at::Tensor, std::shared_ptr<torch::lazy::Value>> AllToAll(
     const at::Tensor& input, const std::shared_ptr<torch::lazy::Value>& token,
     int64_t split_dimension, int64_t concat_dimension, int64_t split_count,
@@ -429,6 +485,27 @@ std::pair<at::Tensor, std::shared_ptr<torch::lazy::Value>> AllToAll(
       std::make_shared<torch::lazy::Value>(new_token));
 }
 
+std::pair<std::vector<at::Tensor>, std::shared_ptr<torch::lazy::Value>>
+AllToAllCoalesced(const std::vector<at::Tensor>& tensors,
+                  const std::shared_ptr<torch::lazy::Value>& token,
+                  int64_t split_dimension, int64_t concat_dimension,
+                  int64_t split_count,
+                  const std::vector<std::vector<int64_t>>& replica_groups,
+                  bool pin_layout) {
+  std::vector<XLATensorPtr> xtensors =
+      GetXlaTensors(tensors, /*want_all=*/true);
+  std::vector<XLATensorPtr> result;
+  torch::lazy::Value new_token;
+  std::tie(result, new_token) = tensor_methods::all_to_all_coalesced(
+      xtensors, *token, split_dimension, concat_dimension, split_count,
+      replica_groups, pin_layout);
+  std::vector<at::Tensor> aten_result;
+  for (auto& xt : result) {
+    aten_result.emplace_back(bridge::AtenFromXlaTensor(std::move(xt)));
+  }
+  return {aten_result, std::make_shared<torch::lazy::Value>(new_token)};
+}
+
 std::pair<at::Tensor, std::shared_ptr<torch::lazy::Value>> CollectivePermute(
     const at::Tensor& input, const std::shared_ptr<torch::lazy::Value>& token,
     const std::vector<std::pair<int64_t, int64_t>>& source_target_pairs) {
@@ -441,6 +518,154 @@ std::pair<at::Tensor, std::shared_ptr<torch::lazy::Value>> CollectivePermute(
       std::make_shared<torch::lazy::Value>(new_token));
 }
 
+std::pair<std::vector<at::Tensor>, std::shared_ptr<torch::lazy::Value>>
+CollectivePermuteCoalesced(
+    const std::vector<at::Tensor>& tensors,
+    const std::shared_ptr<torch::lazy::Value>& token,
+    const std::vector<std::pair<int64_t, int64_t>>& source_target_pairs) {
+  std::vector<XLATensorPtr> xtensors =
+      GetXlaTensors(tensors, /*want_all=*/true);
+  std::vector<XLATensorPtr> result;
+  torch::lazy::Value new_token;
+  std::tie(result, new_token) = tensor_methods::collective_permute_coalesced(
+      xtensors, *token, source_target_pairs);
+  std::vector<at::Tensor> aten_result;
+  for (auto& xt : result) {
+    aten_result.emplace_back(bridge::AtenFromXlaTensor(std::move(xt)));
+  }
+  return {aten_result, std::make_shared<torch::lazy::Value>(new_token)};
+}
+
+std::tuple<at::Tensor, at::Tensor, std::shared_ptr<torch::lazy::Value>>
+RingAttention(const at::Tensor& query, const at::Tensor& key,
+              const at::Tensor& value,
+              const std::shared_ptr<torch::lazy::Value>& token, double scale,
+              bool causal, const std::vector<std::vector<int64_t>>& groups) {
+  XLATensorPtr output;
+  XLATensorPtr logsumexp;
+  torch::lazy::Value new_token;
+  std::tie(output, logsumexp, new_token) = tensor_methods::ring_attention(
+      bridge::GetXlaTensor(query), bridge::GetXlaTensor(key),
+      bridge::GetXlaTensor(value), *token, scale, causal, groups);
+  return std::make_tuple(bridge::AtenFromXlaTensor(std::move(output)),
+                         bridge::AtenFromXlaTensor(std::move(logsumexp)),
+                         std::make_shared<torch::lazy::Value>(new_token));
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor,
+           std::shared_ptr<torch::lazy::Value>>
+RingAttentionBackward(const at::Tensor& query, const at::Tensor& key,
+                      const at::Tensor& value, const at::Tensor& output,
+                      const at::Tensor& logsumexp,
+                      const at::Tensor& grad_output,
+                      const std::shared_ptr<torch::lazy::Value>& token,
+                      double scale, bool causal,
+                      const std::vector<std::vector<int64_t>>& groups) {
+  XLATensorPtr grad_query;
+  XLATensorPtr grad_key;
+  XLATensorPtr grad_value;
+  torch::lazy::Value new_token;
+  std::tie(grad_query, grad_key, grad_value, new_token) =
+      tensor_methods::ring_attention_backward(
+          bridge::GetXlaTensor(query), bridge::GetXlaTensor(key),
+          bridge::GetXlaTensor(value), bridge::GetXlaTensor(output),
+          bridge::GetXlaTensor(logsumexp), bridge::GetXlaTensor(grad_output),
+          *token, scale, causal, groups);
+  return std::make_tuple(bridge::AtenFromXlaTensor(std::move(grad_query)),
+                         bridge::AtenFromXlaTensor(std::move(grad_key)),
+                         bridge::AtenFromXlaTensor(std::move(grad_value)),
+                         std::make_shared<torch::lazy::Value>(new_token));
+}
+
+std::pair<at::Tensor, at::Tensor> FlashAttention(const at::Tensor& query,
+                                                 const at::Tensor& key,
+                                                 const at::Tensor& value,
+                                                 double scale, bool causal,
+                                                 int64_t block_size) {
+  XLATensorPtr output;
+  XLATensorPtr logsumexp;
+  std::tie(output, logsumexp) = tensor_methods::flash_attention(
+      bridge::GetXlaTensor(query), bridge::GetXlaTensor(key),
+      bridge::GetXlaTensor(value), scale, causal, block_size);
+  return {bridge::AtenFromXlaTensor(std::move(output)),
+          bridge::AtenFromXlaTensor(std::move(logsumexp))};
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> FlashAttentionBackward(
+    const at::Tensor& query, const at::Tensor& key, const at::Tensor& value,
+    const at::Tensor& output, const at::Tensor& logsumexp,
+    const at::Tensor& grad_output, double scale, bool causal,
+    int64_t block_size) {
+  XLATensorPtr grad_query;
+  XLATensorPtr grad_key;
+  XLATensorPtr grad_value;
+  std::tie(grad_query, grad_key, grad_value) =
+      tensor_methods::flash_attention_backward(
+          bridge::GetXlaTensor(query), bridge::GetXlaTensor(key),
+          bridge::GetXlaTensor(value), bridge::GetXlaTensor(output),
+          bridge::GetXlaTensor(logsumexp), bridge::GetXlaTensor(grad_output),
+          scale, causal, block_size);
+  return std::make_tuple(bridge::AtenFromXlaTensor(std::move(grad_query)),
+                         bridge::AtenFromXlaTensor(std::move(grad_key)),
+                         bridge::AtenFromXlaTensor(std::move(grad_value)));
+}
+
+at::Tensor GroupedMatmul(const at::Tensor& lhs, const at::Tensor& rhs,
+                         const at::Tensor& group_sizes, bool transpose_rhs,
+                         int64_t tile_rows) {
+  return bridge::AtenFromXlaTensor(tensor_methods::grouped_matmul(
+      bridge::GetXlaTensor(lhs), bridge::GetXlaTensor(rhs),
+      bridge::GetXlaTensor(group_sizes), transpose_rhs, tile_rows));
+}
+
+at::Tensor TransposedGroupedMatmul(const at::Tensor& lhs, const at::Tensor& rhs,
+                                   const at::Tensor& group_sizes,
+                                   int64_t tile_rows) {
+  return bridge::AtenFromXlaTensor(tensor_methods::transposed_grouped_matmul(
+      bridge::GetXlaTensor(lhs), bridge::GetXlaTensor(rhs),
+      bridge::GetXlaTensor(group_sizes), tile_rows));
+}
+
+std::pair<at::Tensor, std::shared_ptr<torch::lazy::Value>> ShardedEmbeddingBag(
+    const at::Tensor& weight, const at::Tensor& indices,
+    const at::Tensor& offsets, const at::Tensor& per_sample_weights,
+    const std::shared_ptr<torch::lazy::Value>& token, int64_t mode,
+    bool include_last_offset, const std::vector<std::vector<int64_t>>& groups,
+    bool pin_layout) {
+  XLATensorPtr result;
+  torch::lazy::Value new_token;
+  std::tie(result, new_token) = tensor_methods::sharded_embedding_bag(
+      bridge::GetXlaTensor(weight), bridge::GetXlaTensor(indices),
+      bridge::GetXlaTensor(offsets), bridge::GetXlaTensor(per_sample_weights),
+      *token, mode, include_last_offset, groups, pin_layout);
+  return {bridge::AtenFromXlaTensor(std::move(result)),
+          std::make_shared<torch::lazy::Value>(new_token)};
+}
+
+std::tuple<at::Tensor, at::Tensor, std::shared_ptr<torch::lazy::Value>>
+ShardedEmbeddingBagBackward(const at::Tensor& grad_output,
+                            const at::Tensor& indices,
+                            const at::Tensor& offsets,
+                            const at::Tensor& per_sample_weights,
+                            const std::shared_ptr<torch::lazy::Value>& token,
+                            int64_t mode, bool include_last_offset,
+                            int64_t num_rows,
+                            const std::vector<std::vector<int64_t>>& groups,
+                            bool pin_layout) {
+  XLATensorPtr rows;
+  XLATensorPtr values;
+  torch::lazy::Value new_token;
+  std::tie(rows, values, new_token) =
+      tensor_methods::sharded_embedding_bag_backward(
+          bridge::GetXlaTensor(grad_output), bridge::GetXlaTensor(indices),
+          bridge::GetXlaTensor(offsets),
+          bridge::GetXlaTensor(per_sample_weights), *token, mode,
+          include_last_offset, num_rows, groups, pin_layout);
+  return std::make_tuple(bridge::AtenFromXlaTensor(std::move(rows)),
+                         bridge::AtenFromXlaTensor(std::move(values)),
+                         std::make_shared<torch::lazy::Value>(new_token));
+}
+
 void OptimizationBarrier_(std::vector<at::Tensor>& tensors) {
   std::vector<XLATensorPtr> xtensors =
       GetXlaTensors(tensors, /*want_all=*/false);
@@ -488,11 +713,24 @@ void SyncLiveTensors(const std::string& device_str,
 void StepMarker(const std::string& device_str,
                 const std::vector<std::string>& devices, bool wait,
                 bool reset_scope) {
-  tsl::profiler::TraceMe activity("StepMarker",
-                                  tsl::profiler::TraceMeLevel::kInfo);
+  int64_t step = runtime::ComputationClient::GetStepId();
+  tsl::profiler::TraceMe activity(
+      [&] {
+        return tsl::profiler::TraceMeEncode("StepMarker", {{"step", step}});
+      },
+      tsl::profiler::TraceMeLevel::kInfo);
   torch::lazy::BackendDevice device = GetDeviceOrCurrent(device_str);
+  // Leaves the future of the step execution, if any, as the last one.
+  ExecutionFuture::ClearLast();
   XLAGraphExecutor::Get()->SyncLiveTensorsGraph(&device, devices, wait);
   XLAGraphExecutor::Get()->MarkStep(device, reset_scope);
+  XLAGraphExecutor::Get()->MaybeSnapshotForPreemption(step);
+  runtime::ComputationClient::SetStepId(step + 1);
+  runtime::profiler::StepTraceSampler* sampler =
+      runtime::profiler::GetStepTraceSampler();
+  if (sampler != nullptr) {
+    sampler->MarkStep(step);
+  }
   bool debug_mode = runtime::sys_util::GetEnvBool("PT_XLA_DEBUG", false);
   if (TF_PREDICT_FALSE(debug_mode)) {
     std::string report = runtime::metrics::CreatePerformanceReport(
@@ -598,8 +836,10 @@ std::string GetLiveTensorsReport(size_t nodes_threshold,
            << ", device=" << tensor->GetDevice()
            << ", ir_nodes=" << post_order.size() << "\n";
         for (size_t i = post_order.size(); i > 0; --i) {
-          if (!post_order[i - 1]->metadata().frame_info.empty()) {
-            ss << post_order[i - 1]->metadata().frame_info;
+          std::vector<torch::lazy::SourceLocation> frames =
+              GetNodeFrames(post_order[i - 1]);
+          if (!frames.empty()) {
+            ss << frames;
             break;
           }
         }
@@ -680,6 +920,37 @@ py::object GetMetricData(const T* data) {
   return result;
 }
 
+// See NOTE: [TORCH_LAZY_COUNTER v.s. XLA_COUNTER]. The PyTorch metrics are
+// exported as summaries, as their data has no histogram.
+std::string CreateOpenMetricsReport() {
+  static const char* const kPrefix = "ptxla_";
+  std::stringstream ss;
+  ss.precision(17);
+  torch::lazy::MetricsArena* arena = torch::lazy::MetricsArena::Get();
+  arena->ForEachMetric([&](const std::string& name,
+                           torch::lazy::MetricData* data) {
+    double accumulator = 0.0;
+    size_t total_samples = 0;
+    std::vector<runtime::metrics::Sample> samples;
+    for (const torch::lazy::Sample& sample :
+         data->Samples(&accumulator, &total_samples)) {
+      samples.emplace_back(sample.timestamp_ns, sample.value);
+    }
+    if (total_samples > 0) {
+      runtime::metrics::EmitOpenMetricsSummary(
+          kPrefix + runtime::metrics::OpenMetricsName(name), samples,
+          accumulator, total_samples, &ss);
+    }
+  });
+  arena->ForEachCounter([&](const std::string& name,
+                            torch::lazy::CounterData* data) {
+    runtime::metrics::EmitOpenMetricsCounter(
+        kPrefix + runtime::metrics::OpenMetricsName(name), data->Value(), &ss);
+  });
+  return ss.str() + runtime::metrics::CreateOpenMetricsReport(kPrefix) +
+         "# EOF\n";
+}
+
 py::object GetMetricData(const std::string& name) {
   if (auto* data = torch::lazy::GetMetric(name)) {
     return GetMetricData<torch::lazy::MetricData>(data);
@@ -749,6 +1020,26 @@ py::dict GetMemoryInfo(const std::string& device_str) {
   auto py_dict = py::dict();
   py_dict["bytes_used"] = mem_info.bytes_used;
   py_dict["bytes_limit"] = mem_info.bytes_limit;
+  py_dict["pinned_host_bytes_used"] = mem_info.pinned_host_bytes_used;
+  py_dict["peak_bytes_used"] = mem_info.peak_bytes_used;
+  py_dict["largest_free_block_bytes"] = mem_info.largest_free_block_bytes;
+  py_dict["fragmentation"] = mem_info.fragmentation;
+  return py_dict;
+}
+
+py::dict GetOperationStats(const std::string& device_str) {
+  runtime::ComputationClient::OperationStats stats;
+  {
+    NoGilSection nogil;
+    torch::lazy::BackendDevice device = GetDeviceOrCurrent(device_str);
+    stats =
+        runtime::GetComputationClient()->GetOperationStats(device.toString());
+  }
+  auto py_dict = py::dict();
+  py_dict["inflight"] = stats.inflight;
+  py_dict["high_water_mark"] = stats.high_water_mark;
+  py_dict["blocked_ns"] = stats.blocked_ns;
+  py_dict["rejected"] = stats.rejected;
   return py_dict;
 }
 
@@ -773,6 +1064,49 @@ ConvertDictToMap(const py::dict& dictionary) {
   return map;
 }
 
+// Captures the Python stack as an interned FrameTable stack. The code objects
+// interned are kept alive, so that their addresses are not reused.
+int32_t CapturePythonStack() {
+  if (!Py_IsInitialized()) {
+    return FrameTable::kNoStack;
+  }
+  py::gil_scoped_acquire gil;
+  FrameTable* table = FrameTable::Get();
+  std::vector<int32_t> frames;
+  PyFrameObject* frame = PyEval_GetFrame();
+  Py_XINCREF(frame);
+  while (frame != nullptr) {
+    PyCodeObject* code = PyFrame_GetCode(frame);
+    frames.push_back(
+        table->InternFrame(code, PyFrame_GetLineNumber(frame), [&]() {
+          Py_INCREF(code);
+          torch::lazy::SourceLocation location;
+          location.file = PyUnicode_AsUTF8(code->co_filename);
+          location.function = PyUnicode_AsUTF8(code->co_name);
+          location.line = PyFrame_GetLineNumber(frame);
+          return location;
+        }));
+    Py_DECREF(code);
+    PyFrameObject* caller = PyFrame_GetBack(frame);
+    Py_DECREF(frame);
+    frame = caller;
+  }
+  int32_t stack = FrameTable::kNoStack;
+  for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+    stack = table->InternStack(stack, *it);
+  }
+  return stack;
+}
+
+// The frames of the IR nodes are captured by XlaNode as interned stacks,
+// rather than as strings in their upstream metadata.
+void InstallPythonFrameCapture() {
+  FrameTable::Get()->SetCaptureFunction(CapturePythonStack);
+  torch::lazy::GetPythonFramesFunction() = []() {
+    return std::vector<torch::lazy::SourceLocation>();
+  };
+}
+
 // Maps PT/XLA env vars to upstream torch::lazy env vars.
 // Upstream lazy env vars defined in torch/csrc/lazy/core/config.h.
 void MapXlaEnvVarsToLazy() {
@@ -791,6 +1125,8 @@ void MapXlaEnvVarsToLazy() {
       runtime::sys_util::GetEnvInt("XLA_TRIM_GRAPH_CHECK_FREQUENCY", 5000);
   FLAGS_torch_lazy_trim_graph_size =
       runtime::sys_util::GetEnvInt("XLA_TRIM_GRAPH_SIZE", 100000);
+  FLAGS_torch_lazy_device_data_cache_size =
+      runtime::sys_util::GetEnvInt("XLA_DEVICE_DATA_CACHE_SIZE", 128);
 }
 
 at::Tensor MarkTensor(const at::Tensor& input, const std::string& info) {
@@ -984,6 +1320,37 @@ class PyLoweringContext {
     }
   }
 
+  // Builds a HLO graph given a set of output tensors, whose first parameters
+  // are the device data of the `parameters` tensors, in order. The other
+  // device data the outputs depend on become the parameters after them, see
+  // GetCapturedTensors().
+  void BuildWithParameters(std::vector<at::Tensor> tensors,
+                           std::vector<at::Tensor> parameters) {
+    for (XLATensorPtr& xtensor :
+         GetXlaTensors(parameters, /*want_all=*/true)) {
+      torch::lazy::BackendDataPtr data = xtensor->CurrentDataHandle();
+      XLA_CHECK(data != nullptr) << "The parameters must be device data";
+      lowering_ctx.GetParameter(data);
+    }
+    num_parameters = lowering_ctx.GetParametersData().size();
+    XLA_CHECK_EQ(num_parameters, parameters.size())
+        << "The parameters must hold distinct device data";
+    Build(std::move(tensors));
+  }
+
+  // The tensors of the device data captured as parameters by
+  // BuildWithParameters(), in parameter order.
+  std::vector<at::Tensor> GetCapturedTensors() {
+    const std::vector<torch::lazy::BackendDataPtr>& device_data =
+        lowering_ctx.GetParametersData();
+    std::vector<at::Tensor> results;
+    for (size_t i = num_parameters; i < device_data.size(); ++i) {
+      results.push_back(bridge::AtenFromXlaTensor(
+          XLATensor::Create(device_data[i])));
+    }
+    return results;
+  }
+
   // Get a mapping from the HLO input parameters to the backing Tensor values.
   // This allows the caller to get all parameter information regardless of
   // how the parameter was allocated (inline tensor, nn.Parameter, constant,
@@ -1073,6 +1440,7 @@ class PyLoweringContext {
  private:
   LoweringContext lowering_ctx;
   xla::XlaComputation computation;
+  size_t num_parameters = 0;
 };
 
 // Add a submodule which exposes the LoweringContext to python.
@@ -1110,6 +1478,8 @@ void BuildLoweringContextSubmodule(py::module* m) {
   lowering_context_class.def(py::init<>())
       .def("build", &PyLoweringContext::Build)
       .def("buildforiloop", &PyLoweringContext::BuildForiLoop)
+      .def("build_with_parameters", &PyLoweringContext::BuildWithParameters)
+      .def("captured_tensors", &PyLoweringContext::GetCapturedTensors)
       .def("hlo", &PyLoweringContext::GetHlo)
       .def("hlo_text", &PyLoweringContext::GetHloText)
       .def("hlo_json", &PyLoweringContext::GetHloJsonText)
@@ -1136,7 +1506,8 @@ void dlPack_Capsule_Destructor(PyObject* data) {
   }
 }
 
-at::Tensor tensor_fromDLPack(PyObject* data) {
+at::Tensor tensor_fromDLPack(PyObject* data,
+                             std::optional<std::intptr_t> stream) {
   DLManagedTensor* dlMTensor =
       (DLManagedTensor*)PyCapsule_GetPointer(data, "dltensor");
   XLA_CHECK(dlMTensor != nullptr)
@@ -1144,7 +1515,7 @@ at::Tensor tensor_fromDLPack(PyObject* data) {
          "capsule can be consumed only once. You may have already constructed "
          "a tensor from it once.";
 
-  at::Tensor tensor = torch_xla::fromDLPack(dlMTensor);
+  at::Tensor tensor = torch_xla::fromDLPack(dlMTensor, stream);
   PyCapsule_SetName(data, "used_dltensor");
   PyCapsule_SetDestructor(data, nullptr);
   return tensor;
@@ -1158,7 +1529,53 @@ void InitXlaModuleBindings(py::module m) {
   m.def("_xla_computation_cache_is_initialized", []() {
     return XLAGraphExecutor::Get()->IsComputationCacheInitialized();
   });
+  m.def("_xla_compilation_env_components", []() {
+    return runtime::GetComputationClient()->GetCompilationEnvComponents();
+  });
+  m.def("_xla_invalidate_compilation_env_hash", []() {
+    runtime::GetComputationClient()->InvalidateCompilationEnvHash();
+  });
+  m.def("_xla_wait_async_compilations", []() {
+    NoGilSection nogil;
+    XLAGraphExecutor::Get()->WaitAsyncCompilations();
+  });
+  m.def("_xla_graph_structure_compiles", []() {
+    py::dict compiles;
+    for (auto& [structure_hash, count] :
+         XLAGraphExecutor::Get()->GetGraphStructureCompiles()) {
+      compiles[py::str(torch::lazy::HashToString(structure_hash))] = count;
+    }
+    return compiles;
+  });
+  m.def("_xla_compiled_memory_stats", []() {
+    py::dict memory_stats;
+    for (auto& [hash, stats] :
+         XLAGraphExecutor::Get()->GetCompiledMemoryStats()) {
+      py::dict graph_stats;
+      graph_stats["argument_bytes"] = stats.argument_bytes;
+      graph_stats["output_bytes"] = stats.output_bytes;
+      graph_stats["alias_bytes"] = stats.alias_bytes;
+      graph_stats["temp_bytes"] = stats.temp_bytes;
+      graph_stats["generated_code_bytes"] = stats.generated_code_bytes;
+      graph_stats["execution_bytes"] = stats.ExecutionBytes();
+      memory_stats[py::str(torch::lazy::HashToString(hash))] = graph_stats;
+    }
+    return memory_stats;
+  });
+  m.def("_xla_graph_stats_json", []() { return GraphStats::Get()->ToJson(); });
+  m.def("_clear_xla_graph_stats", []() { GraphStats::Get()->Clear(); });
+  m.def("_xla_recompile_reports",
+        []() { return RecompileAnalyzer::Get()->GetReports(); });
+  m.def("_clear_xla_recompile_reports",
+        []() { RecompileAnalyzer::Get()->ClearReports(); });
   m.def("_get_git_revs", []() { return GetRevisions(); });
+  m.def("_xla_release_hot_path_build", []() {
+#ifdef XLA_RELEASE_HOT_PATH
+    return true;
+#else
+    return false;
+#endif
+  });
   m.def("_get_xla_tensor_dimension_size",
         [](const at::Tensor& tensor, int dim) {
           return GetXlaTensorDimensionSize(tensor, dim);
@@ -1173,6 +1590,23 @@ void InitXlaModuleBindings(py::module m) {
           }
           return results;
         });
+  m.def("_xla_while_loop",
+        [](const std::vector<at::Tensor>& carried,
+           const std::vector<at::Tensor>& invariants,
+           const runtime::ComputationClient::ComputationPtr& cond,
+           const runtime::ComputationClient::ComputationPtr& body) {
+          std::vector<at::Tensor> results;
+          {
+            NoGilSection nogil;
+            std::vector<XLATensorPtr> xresults = tensor_methods::while_loop(
+                GetXlaTensors(carried, /*want_all=*/true),
+                GetXlaTensors(invariants, /*want_all=*/true), cond, body);
+            for (auto& xresult : xresults) {
+              results.push_back(bridge::AtenFromXlaTensor(std::move(xresult)));
+            }
+          }
+          return results;
+        });
   m.def("_get_xla_tensors_dot",
         [](const std::vector<at::Tensor>& tensors) -> std::string {
           auto coverter = [](absl::Span<const torch::lazy::Node* const> nodes) {
@@ -1191,6 +1625,11 @@ void InitXlaModuleBindings(py::module m) {
         [](const std::vector<at::Tensor>& tensors) -> std::string {
           return GetTensorsHloGraph(tensors, EmitMode::kHloReadable);
         });
+  m.def("_get_xla_tensors_hlo_proto",
+        [](const std::vector<at::Tensor>& tensors) -> py::bytes {
+          NoGilSection nogil;
+          return py::bytes(GetTensorsHloGraph(tensors, EmitMode::kHloProto));
+        });
   m.def("_get_xla_tensor_debug_info",
         [](const at::Tensor& tensor) -> std::string {
           return GetXLATensorDebugInfo(tensor);
@@ -1441,6 +1880,37 @@ void InitXlaModuleBindings(py::module m) {
           }
           return result;
         });
+  m.def("_xla_quantized_matmul",
+        [](const at::Tensor& input, const at::Tensor& weight,
+           const at::Tensor& scale, int64_t block_size,
+           bool int4_weight) {
+          XLATensorPtr output;
+          {
+            NoGilSection nogil;
+            output = tensor_methods::quantized_matmul(
+                bridge::GetXlaTensor(input), bridge::GetXlaTensor(weight),
+                bridge::GetXlaTensor(scale), block_size, int4_weight);
+          }
+          return bridge::AtenFromXlaTensor(std::move(output));
+        });
+  m.def("_xla_fp8_scaled_mm",
+        [](const at::Tensor& a, const at::Tensor& b, const at::Tensor& a_scale,
+           const at::Tensor& b_scale, const std::string& a_format,
+           const std::string& b_format) {
+          XLATensorPtr output;
+          XLATensorPtr a_amax;
+          XLATensorPtr b_amax;
+          {
+            NoGilSection nogil;
+            std::tie(output, a_amax, b_amax) = tensor_methods::fp8_scaled_mm(
+                bridge::GetXlaTensor(a), bridge::GetXlaTensor(b),
+                bridge::GetXlaTensor(a_scale), bridge::GetXlaTensor(b_scale),
+                a_format, b_format);
+          }
+          return std::make_tuple(bridge::AtenFromXlaTensor(std::move(output)),
+                                 bridge::AtenFromXlaTensor(std::move(a_amax)),
+                                 bridge::AtenFromXlaTensor(std::move(b_amax)));
+        });
   m.def("_xla_all_to_all",
         [](const at::Tensor& input,
            const std::shared_ptr<torch::lazy::Value>& token,
@@ -1462,6 +1932,74 @@ void InitXlaModuleBindings(py::module m) {
           result_tuple[1] = new_token;
           return result_tuple;
         });
+  m.def("_xla_all_to_all_coalesced",
+        [](const std::vector<at::Tensor>& tensors,
+           const std::shared_ptr<torch::lazy::Value>& token,
+           int64_t split_dimension, int64_t concat_dimension,
+           int64_t split_count, const py::list& groups, bool pin_layout) {
+          std::vector<std::vector<int64_t>> replica_groups =
+              CreateReduceGroups(groups);
+          std::vector<at::Tensor> results;
+          std::shared_ptr<torch::lazy::Value> new_token;
+          {
+            NoGilSection nogil;
+            std::tie(results, new_token) = AllToAllCoalesced(
+                tensors, token, split_dimension, concat_dimension,
+                split_count, replica_groups, pin_layout);
+          }
+          auto result_list = py::list(results.size() + 1);
+          for (int i = 0; i < results.size(); ++i) {
+            result_list[i] = torch::autograd::make_variable(
+                results[i], /*requires_grad=*/tensors[i].requires_grad());
+          }
+          result_list[results.size()] = new_token;
+          return result_list;
+        });
+  m.def("_xla_all_gather_start",
+        [](const at::Tensor& input,
+           const std::shared_ptr<torch::lazy::Value>& token, int64_t dim,
+           int64_t shard_count, const py::list& groups, bool pin_layout) {
+          std::vector<std::vector<int64_t>> replica_groups =
+              CreateReduceGroups(groups);
+          std::shared_ptr<torch::lazy::Value> start;
+          {
+            NoGilSection nogil;
+            start = AllGatherStart(input, token, dim, shard_count,
+                                   replica_groups, pin_layout);
+          }
+          return start;
+        });
+  m.def("_xla_all_reduce_start",
+        [](const std::string& reduce_type, const at::Tensor& input,
+           const std::shared_ptr<torch::lazy::Value>& token,
+           const py::list& groups, bool pin_layout) {
+          std::vector<std::vector<int64_t>> replica_groups =
+              CreateReduceGroups(groups);
+          std::shared_ptr<torch::lazy::Value> start;
+          {
+            NoGilSection nogil;
+            start = AllReduceStart(reduce_type, input, token, replica_groups,
+                                   pin_layout);
+          }
+          return start;
+        });
+  m.def("_xla_async_collective_done",
+        [](const at::Tensor& input,
+           const std::shared_ptr<torch::lazy::Value>& start,
+           const std::shared_ptr<torch::lazy::Value>& token) {
+          at::Tensor result;
+          std::shared_ptr<torch::lazy::Value> new_token;
+          {
+            NoGilSection nogil;
+            std::tie(result, new_token) =
+                AsyncCollectiveDone(input, start, token);
+          }
+          auto result_tuple = py::tuple(2);
+          result_tuple[0] = torch::autograd::make_variable(
+              result, /*requires_grad=*/input.requires_grad());
+          result_tuple[1] = new_token;
+          return result_tuple;
+        });
   m.def("_xla_all_gather", [](const at::Tensor& input, int64_t dim,
                               int64_t shard_count, const py::list& groups,
                               bool pin_layout) {
@@ -1545,6 +2083,336 @@ void InitXlaModuleBindings(py::module m) {
           result_tuple[1] = new_token;
           return result_tuple;
         });
+  m.def("_xla_collective_permute_coalesced",
+        [](const std::vector<at::Tensor>& tensors,
+           const std::shared_ptr<torch::lazy::Value>& token,
+           const py::list& pairs) {
+          std::vector<std::pair<int64_t, int64_t>> source_target_pairs =
+              CreateSourceTargetPairs(pairs);
+          std::vector<at::Tensor> results;
+          std::shared_ptr<torch::lazy::Value> new_token;
+          {
+            NoGilSection nogil;
+            std::tie(results, new_token) =
+                CollectivePermuteCoalesced(tensors, token, source_target_pairs);
+          }
+          auto result_list = py::list(results.size() + 1);
+          for (int i = 0; i < results.size(); ++i) {
+            result_list[i] = torch::autograd::make_variable(
+                results[i], /*requires_grad=*/tensors[i].requires_grad());
+          }
+          result_list[results.size()] = new_token;
+          return result_list;
+        });
+  m.def("_xla_ring_attention",
+        [](const at::Tensor& query, const at::Tensor& key,
+           const at::Tensor& value,
+           const std::shared_ptr<torch::lazy::Value>& token, double scale,
+           bool causal, const py::list& groups) {
+          std::vector<std::vector<int64_t>> rings = CreateReduceGroups(groups);
+          at::Tensor output;
+          at::Tensor logsumexp;
+          std::shared_ptr<torch::lazy::Value> new_token;
+          {
+            NoGilSection nogil;
+            std::tie(output, logsumexp, new_token) =
+                RingAttention(query, key, value, token, scale, causal, rings);
+          }
+          auto result_list = py::list(3);
+          result_list[0] = torch::autograd::make_variable(
+              output, /*requires_grad=*/query.requires_grad());
+          result_list[1] = torch::autograd::make_variable(
+              logsumexp, /*requires_grad=*/false);
+          result_list[2] = new_token;
+          return result_list;
+        });
+  m.def("_xla_ring_attention_backward",
+        [](const at::Tensor& query, const at::Tensor& key,
+           const at::Tensor& value, const at::Tensor& output,
+           const at::Tensor& logsumexp, const at::Tensor& grad_output,
+           const std::shared_ptr<torch::lazy::Value>& token, double scale,
+           bool causal, const py::list& groups) {
+          std::vector<std::vector<int64_t>> rings = CreateReduceGroups(groups);
+          at::Tensor grad_query;
+          at::Tensor grad_key;
+          at::Tensor grad_value;
+          std::shared_ptr<torch::lazy::Value> new_token;
+          {
+            NoGilSection nogil;
+            std::tie(grad_query, grad_key, grad_value, new_token) =
+                RingAttentionBackward(query, key, value, output, logsumexp,
+                                      grad_output, token, scale, causal,
+                                      rings);
+          }
+          auto result_list = py::list(4);
+          result_list[0] = torch::autograd::make_variable(
+              grad_query, /*requires_grad=*/false);
+          result_list[1] = torch::autograd::make_variable(
+              grad_key, /*requires_grad=*/false);
+          result_list[2] = torch::autograd::make_variable(
+              grad_value, /*requires_grad=*/false);
+          result_list[3] = new_token;
+          return result_list;
+        });
+  m.def("_xla_flash_attention",
+        [](const at::Tensor& query, const at::Tensor& key,
+           const at::Tensor& value, double scale, bool causal,
+           int64_t block_size) {
+          at::Tensor output;
+          at::Tensor logsumexp;
+          {
+            NoGilSection nogil;
+            std::tie(output, logsumexp) =
+                FlashAttention(query, key, value, scale, causal, block_size);
+          }
+          auto result_list = py::list(2);
+          result_list[0] = torch::autograd::make_variable(
+              output, /*requires_grad=*/query.requires_grad());
+          result_list[1] = torch::autograd::make_variable(
+              logsumexp, /*requires_grad=*/false);
+          return result_list;
+        });
+  m.def("_xla_flash_attention_backward",
+        [](const at::Tensor& query, const at::Tensor& key,
+           const at::Tensor& value, const at::Tensor& output,
+           const at::Tensor& logsumexp, const at::Tensor& grad_output,
+           double scale, bool causal, int64_t block_size) {
+          at::Tensor grad_query;
+          at::Tensor grad_key;
+          at::Tensor grad_value;
+          {
+            NoGilSection nogil;
+            std::tie(grad_query, grad_key, grad_value) =
+                FlashAttentionBackward(query, key, value, output, logsumexp,
+                                       grad_output, scale, causal,
+                                       block_size);
+          }
+          auto result_list = py::list(3);
+          result_list[0] = torch::autograd::make_variable(
+              grad_query, /*requires_grad=*/false);
+          result_list[1] = torch::autograd::make_variable(
+              grad_key, /*requires_grad=*/false);
+          result_list[2] = torch::autograd::make_variable(
+              grad_value, /*requires_grad=*/false);
+          return result_list;
+        });
+  m.def("_xla_grouped_matmul",
+        [](const at::Tensor& lhs, const at::Tensor& rhs,
+           const at::Tensor& group_sizes, bool transpose_rhs,
+           int64_t tile_rows) {
+          at::Tensor output;
+          {
+            NoGilSection nogil;
+            output = GroupedMatmul(lhs, rhs, group_sizes, transpose_rhs,
+                                   tile_rows);
+          }
+          return torch::autograd::make_variable(output,
+                                                /*requires_grad=*/false);
+        });
+  m.def("_xla_transposed_grouped_matmul",
+        [](const at::Tensor& lhs, const at::Tensor& rhs,
+           const at::Tensor& group_sizes, int64_t tile_rows) {
+          at::Tensor output;
+          {
+            NoGilSection nogil;
+            output = TransposedGroupedMatmul(lhs, rhs, group_sizes, tile_rows);
+          }
+          return torch::autograd::make_variable(output,
+                                                /*requires_grad=*/false);
+        });
+  m.def("_xla_chunked_cross_entropy",
+        [](const at::Tensor& input, const at::Tensor& target,
+           int64_t reduction, int ignore_index, int64_t chunk_size) {
+          XLATensorPtr loss;
+          XLATensorPtr logsumexp;
+          {
+            NoGilSection nogil;
+            std::tie(loss, logsumexp) = tensor_methods::chunked_cross_entropy(
+                bridge::GetXlaTensor(input), bridge::GetXlaTensor(target),
+                reduction, ignore_index, chunk_size);
+          }
+          return std::make_pair(
+              bridge::AtenFromXlaTensor(std::move(loss)),
+              bridge::AtenFromXlaTensor(std::move(logsumexp)));
+        });
+  m.def("_xla_chunked_cross_entropy_backward",
+        [](const at::Tensor& grad_output, const at::Tensor& input,
+           const at::Tensor& target, const at::Tensor& logsumexp,
+           int64_t reduction, int ignore_index, int64_t chunk_size) {
+          XLATensorPtr grad_input;
+          {
+            NoGilSection nogil;
+            grad_input = tensor_methods::chunked_cross_entropy_backward(
+                bridge::GetXlaTensor(grad_output), bridge::GetXlaTensor(input),
+                bridge::GetXlaTensor(target), bridge::GetXlaTensor(logsumexp),
+                reduction, ignore_index, chunk_size);
+          }
+          return bridge::AtenFromXlaTensor(std::move(grad_input));
+        });
+  m.def("_xla_dropout_add_layer_norm",
+        [](const at::Tensor& input, const at::Tensor& residual,
+           const at::Tensor& weight, const at::Tensor& bias, double p,
+           double eps, bool return_mask) {
+          std::vector<XLATensorPtr> results;
+          {
+            NoGilSection nogil;
+            results = tensor_methods::dropout_add_layer_norm(
+                bridge::GetXlaTensor(input), bridge::GetXlaTensor(residual),
+                bridge::GetXlaTensor(weight), bridge::GetXlaTensor(bias), p,
+                eps, return_mask);
+          }
+          return bridge::AtenFromXlaTensors(results);
+        });
+  m.def("_xla_dropout_add_layer_norm_backward",
+        [](const at::Tensor& grad_output, const at::Tensor& grad_sum,
+           const at::Tensor& sum, const at::Tensor& weight,
+           const at::Tensor& mean, const at::Tensor& rstd,
+           const at::Tensor& seed, const std::optional<at::Tensor>& mask,
+           double p) {
+          XLATensorPtr grad_input;
+          XLATensorPtr grad_residual;
+          XLATensorPtr grad_weight;
+          XLATensorPtr grad_bias;
+          {
+            NoGilSection nogil;
+            std::tie(grad_input, grad_residual, grad_weight, grad_bias) =
+                tensor_methods::dropout_add_layer_norm_backward(
+                    bridge::GetXlaTensor(grad_output),
+                    bridge::GetXlaTensor(grad_sum), bridge::GetXlaTensor(sum),
+                    bridge::GetXlaTensor(weight), bridge::GetXlaTensor(mean),
+                    bridge::GetXlaTensor(rstd), bridge::GetXlaTensor(seed),
+                    mask ? bridge::GetXlaTensor(*mask) : XLATensorPtr(), p);
+          }
+          return std::make_tuple(
+              bridge::AtenFromXlaTensor(std::move(grad_input)),
+              bridge::AtenFromXlaTensor(std::move(grad_residual)),
+              bridge::AtenFromXlaTensor(std::move(grad_weight)),
+              bridge::AtenFromXlaTensor(std::move(grad_bias)));
+        });
+  m.def("_xla_masked_scaled_softmax",
+        [](const at::Tensor& input, const std::optional<at::Tensor>& mask,
+           double scale, bool causal) {
+          XLATensorPtr output;
+          {
+            NoGilSection nogil;
+            output = tensor_methods::masked_scaled_softmax(
+                bridge::GetXlaTensor(input),
+                mask ? bridge::GetXlaTensor(*mask) : XLATensorPtr(), scale,
+                causal);
+          }
+          return bridge::AtenFromXlaTensor(std::move(output));
+        });
+  m.def("_xla_masked_scaled_softmax_backward",
+        [](const at::Tensor& grad_output, const at::Tensor& output,
+           double scale) {
+          XLATensorPtr grad_input;
+          {
+            NoGilSection nogil;
+            grad_input = tensor_methods::masked_scaled_softmax_backward(
+                bridge::GetXlaTensor(grad_output), bridge::GetXlaTensor(output),
+                scale);
+          }
+          return bridge::AtenFromXlaTensor(std::move(grad_input));
+        });
+  m.def("_xla_approx_topk",
+        [](const at::Tensor& input, int64_t k, int64_t dim, bool largest,
+           double recall_target) {
+          XLATensorPtr values;
+          XLATensorPtr indices;
+          {
+            NoGilSection nogil;
+            std::tie(values, indices) = tensor_methods::approx_topk(
+                bridge::GetXlaTensor(input), k, dim, largest, recall_target);
+          }
+          return std::make_tuple(bridge::AtenFromXlaTensor(std::move(values)),
+                                 bridge::AtenFromXlaTensor(std::move(indices)));
+        });
+  m.def("_xla_sample_tokens",
+        [](const at::Tensor& logits, const at::Tensor& temperature,
+           int64_t top_k, const std::optional<at::Tensor>& top_p) {
+          XLATensorPtr tokens;
+          {
+            NoGilSection nogil;
+            tokens = tensor_methods::sample_tokens(
+                bridge::GetXlaTensor(logits), bridge::GetXlaTensor(temperature),
+                top_k, top_p ? bridge::GetXlaTensor(*top_p) : XLATensorPtr());
+          }
+          return bridge::AtenFromXlaTensor(std::move(tokens));
+        });
+  m.def("_xla_kv_cache_update_",
+        [](at::Tensor& cache, const at::Tensor& update,
+           const at::Tensor& position, int64_t dim) {
+          NoGilSection nogil;
+          XLATensorPtr cache_xla = bridge::GetXlaTensor(cache);
+          tensor_methods::kv_cache_update_(cache_xla,
+                                           bridge::GetXlaTensor(update),
+                                           bridge::GetXlaTensor(position), dim);
+        });
+  m.def("_xla_metric_accumulate_",
+        [](at::Tensor& state, const at::Tensor& value,
+           const std::optional<at::Tensor>& weight, int64_t reduction) {
+          NoGilSection nogil;
+          XLATensorPtr state_xla = bridge::GetXlaTensor(state);
+          tensor_methods::metric_accumulate_(
+              state_xla, bridge::GetXlaTensor(value),
+              weight ? bridge::GetXlaTensor(*weight) : XLATensorPtr(),
+              reduction);
+        });
+  m.def("_xla_kv_cache_rollback_",
+        [](at::Tensor& cache, const at::Tensor& position,
+           const at::Tensor& accepted, int64_t window, int64_t dim) {
+          NoGilSection nogil;
+          XLATensorPtr cache_xla = bridge::GetXlaTensor(cache);
+          tensor_methods::kv_cache_rollback_(
+              cache_xla, bridge::GetXlaTensor(position),
+              bridge::GetXlaTensor(accepted), window, dim);
+        });
+  m.def("_xla_sharded_embedding_bag",
+        [](const at::Tensor& weight, const at::Tensor& indices,
+           const at::Tensor& offsets, const at::Tensor& per_sample_weights,
+           const std::shared_ptr<torch::lazy::Value>& token, int64_t mode,
+           bool include_last_offset, const py::list& groups, bool pin_layout) {
+          std::vector<std::vector<int64_t>> replica_groups =
+              CreateReduceGroups(groups);
+          at::Tensor result;
+          std::shared_ptr<torch::lazy::Value> new_token;
+          {
+            NoGilSection nogil;
+            std::tie(result, new_token) = ShardedEmbeddingBag(
+                weight, indices, offsets, per_sample_weights, token, mode,
+                include_last_offset, replica_groups, pin_layout);
+          }
+          auto result_list = py::list(2);
+          result_list[0] = torch::autograd::make_variable(
+              result, /*requires_grad=*/weight.requires_grad());
+          result_list[1] = new_token;
+          return result_list;
+        });
+  m.def("_xla_sharded_embedding_bag_backward",
+        [](const at::Tensor& grad_output, const at::Tensor& indices,
+           const at::Tensor& offsets, const at::Tensor& per_sample_weights,
+           const std::shared_ptr<torch::lazy::Value>& token, int64_t mode,
+           bool include_last_offset, int64_t num_rows, const py::list& groups,
+           bool pin_layout) {
+          std::vector<std::vector<int64_t>> replica_groups =
+              CreateReduceGroups(groups);
+          at::Tensor rows;
+          at::Tensor values;
+          std::shared_ptr<torch::lazy::Value> new_token;
+          {
+            NoGilSection nogil;
+            std::tie(rows, values, new_token) = ShardedEmbeddingBagBackward(
+                grad_output, indices, offsets, per_sample_weights, token, mode,
+                include_last_offset, num_rows, replica_groups, pin_layout);
+          }
+          auto result_list = py::list(3);
+          result_list[0] = torch::autograd::make_variable(
+              rows, /*requires_grad=*/false);
+          result_list[1] = torch::autograd::make_variable(
+              values, /*requires_grad=*/false);
+          result_list[2] = new_token;
+          return result_list;
+        });
   m.def("_xla_send", [](const at::Tensor& input,
                         const std::shared_ptr<torch::lazy::Value>& token,
                         int64_t channel_id) {
@@ -1656,6 +2524,47 @@ void InitXlaModuleBindings(py::module m) {
           }
           return new_token;
         });
+  m.def("_xla_nonzero_static",
+        [](const at::Tensor& input, int64_t size, int64_t fill_value) {
+          XLATensorPtr indices;
+          XLATensorPtr count;
+          {
+            NoGilSection nogil;
+            std::tie(indices, count) = tensor_methods::nonzero_static(
+                bridge::GetXlaTensor(input), size, fill_value);
+          }
+          return std::make_pair(bridge::AtenFromXlaTensor(std::move(indices)),
+                                bridge::AtenFromXlaTensor(std::move(count)));
+        });
+  m.def("_xla_masked_select_static",
+        [](const at::Tensor& input, const at::Tensor& mask, int64_t size,
+           double fill_value) {
+          XLATensorPtr values;
+          XLATensorPtr count;
+          {
+            NoGilSection nogil;
+            std::tie(values, count) = tensor_methods::masked_select_static(
+                bridge::GetXlaTensor(input), bridge::GetXlaTensor(mask), size,
+                fill_value);
+          }
+          return std::make_pair(bridge::AtenFromXlaTensor(std::move(values)),
+                                bridge::AtenFromXlaTensor(std::move(count)));
+        });
+  m.def("_xla_batched_nms",
+        [](const at::Tensor& boxes, const at::Tensor& scores,
+           double iou_threshold, double score_threshold,
+           int64_t max_output_size) {
+          XLATensorPtr indices;
+          XLATensorPtr counts;
+          {
+            NoGilSection nogil;
+            std::tie(indices, counts) = tensor_methods::batched_nms(
+                bridge::GetXlaTensor(boxes), bridge::GetXlaTensor(scores),
+                iou_threshold, score_threshold, max_output_size);
+          }
+          return std::make_pair(bridge::AtenFromXlaTensor(std::move(indices)),
+                                bridge::AtenFromXlaTensor(std::move(counts)));
+        });
   m.def("_xla_optimization_barrier_",
         [](std::vector<at::Tensor>& inputs) { OptimizationBarrier_(inputs); });
   m.def("_xla_set_default_device", [](const std::string& device) {
@@ -1748,6 +2657,19 @@ void InitXlaModuleBindings(py::module m) {
                     /*warm_up_cache_only=*/true);
       },
       py::arg("tensors"), py::arg("devices"));
+  m.def(
+      "_xla_warm_up_cache_batch",
+      [](const std::vector<std::vector<at::Tensor>>& tensor_groups,
+         const std::vector<std::string>& devices) {
+        std::vector<std::vector<XLATensorPtr>> xtensor_groups;
+        xtensor_groups.reserve(tensor_groups.size());
+        for (const auto& tensors : tensor_groups) {
+          xtensor_groups.push_back(GetXlaTensors(tensors, /*want_all=*/false));
+        }
+        NoGilSection nogil;
+        XLAGraphExecutor::Get()->WarmUpCaches(&xtensor_groups, devices);
+      },
+      py::arg("tensor_groups"), py::arg("devices"));
   m.def(
       "_xla_sync_live_tensors",
       [](const std::string& device, const std::vector<std::string>& devices,
@@ -1787,6 +2709,9 @@ void InitXlaModuleBindings(py::module m) {
         [](const std::string& bytecode,
            const std::vector<at::IValue>& graph_inputs)
             -> std::vector<at::Tensor> {
+          // The inputs are already converted, so the compilation, the
+          // transfers and the execution run without the GIL.
+          NoGilSection nogil;
           torch::lazy::BackendDevice device =
               torch_xla::bridge::GetCurrentDevice();
           auto results = XLAGraphExecutor::Get()->ExecuteStablehlo(
@@ -1814,6 +2739,136 @@ void InitXlaModuleBindings(py::module m) {
         }
       },
       py::arg("devices"));
+  m.def("_xla_inflight_steps",
+        []() { return StepPipeline::Get()->InflightSteps(); });
+  py::class_<ExecutionFuture, std::shared_ptr<ExecutionFuture>>(
+      m, "ExecutionFuture")
+      .def_property_readonly("graph_hash",
+                             [](const ExecutionFuture& future) {
+                               return torch::lazy::HashToString(future.hash());
+                             })
+      .def("done", &ExecutionFuture::IsDone)
+      .def("wait",
+           [](ExecutionFuture& future) {
+             std::string error;
+             {
+               NoGilSection nogil;
+               error = future.Wait();
+             }
+             if (!error.empty()) {
+               throw std::runtime_error(error);
+             }
+           })
+      .def("error",
+           [](ExecutionFuture& future) -> std::optional<std::string> {
+             std::string error = future.GetError();
+             if (error.empty()) {
+               return std::nullopt;
+             }
+             return error;
+           })
+      .def("add_done_callback", [](std::shared_ptr<ExecutionFuture> future,
+                                   py::function fn) {
+        // The callback runs from the thread completing the execution, and
+        // can be released from it.
+        std::shared_ptr<py::function> callback(
+            new py::function(std::move(fn)), [](py::function* callback) {
+              py::gil_scoped_acquire gil;
+              delete callback;
+            });
+        // The callbacks only run while the future is alive, which they do not
+        // need to keep alive themselves.
+        ExecutionFuture* raw_future = future.get();
+        future->AddDoneCallback([callback, raw_future](const std::string&) {
+          py::gil_scoped_acquire gil;
+          try {
+            (*callback)(raw_future->shared_from_this());
+          } catch (py::error_already_set& e) {
+            e.restore();
+            PyErr_WriteUnraisable(callback->ptr());
+          }
+        });
+      });
+  m.def("_xla_last_execution_future", []() { return ExecutionFuture::Last(); });
+  py::class_<HostTensorFuture, std::shared_ptr<HostTensorFuture>>(
+      m, "HostTensorFuture")
+      .def("done", &HostTensorFuture::IsDone)
+      .def("result", [](HostTensorFuture& future) {
+        at::Tensor tensor;
+        {
+          NoGilSection nogil;
+          tensor = future.Wait();
+        }
+        return torch::autograd::make_variable(tensor, /*requires_grad=*/false);
+      });
+  m.def("_xla_fetch_async", [](const at::Tensor& tensor) {
+    return bridge::GetXlaTensor(tensor)->ToTensorAsync();
+  });
+  py::class_<DeviceLoader, std::shared_ptr<DeviceLoader>>(m, "DeviceLoader")
+      .def(py::init([](const std::string& device, size_t prefetch_depth) {
+             return std::make_shared<DeviceLoader>(
+                 GetXlaDevices({device}).front(), prefetch_depth);
+           }),
+           py::arg("device"), py::arg("prefetch_depth"))
+      .def(
+          "put",
+          [](DeviceLoader& loader, std::vector<at::Tensor> tensors,
+             const std::optional<std::vector<XLATensor::ShardingSpecPtr>>&
+                 shardings) {
+            NoGilSection nogil;
+            return loader.Put(std::move(tensors),
+                              shardings.value_or(
+                                  std::vector<XLATensor::ShardingSpecPtr>()));
+          },
+          py::arg("tensors"), py::arg("shardings") = py::none())
+      .def("get",
+           [](DeviceLoader& loader) -> std::optional<std::vector<at::Tensor>> {
+             std::optional<std::vector<at::Tensor>> tensors;
+             {
+               NoGilSection nogil;
+               tensors = loader.Get();
+             }
+             if (!tensors) {
+               return std::nullopt;
+             }
+             std::vector<at::Tensor> result;
+             result.reserve(tensors->size());
+             for (at::Tensor& tensor : *tensors) {
+               result.push_back(torch::autograd::make_variable(
+                   std::move(tensor), /*requires_grad=*/false));
+             }
+             return result;
+           })
+      .def("close_write", &DeviceLoader::CloseWrite)
+      .def("close", &DeviceLoader::Close)
+      .def("pending", &DeviceLoader::pending);
+  m.def("_xla_set_execution_lane", [](const std::string& lane) {
+    if (lane == "default") {
+      XLAGraphExecutor::SetExecutionLane(runtime::ExecutionLane::kDefault);
+    } else if (lane == "high_priority") {
+      XLAGraphExecutor::SetExecutionLane(runtime::ExecutionLane::kHighPriority);
+    } else {
+      XLA_ERROR() << "Invalid execution lane: " << lane;
+    }
+  });
+  m.def("_xla_set_intra_op_threads", [](int64_t threads) {
+    XLA_CHECK_GE(threads, 0);
+    XLAGraphExecutor::SetIntraOpThreads(threads);
+  });
+  m.def("_xla_get_intra_op_threads",
+        []() { return XLAGraphExecutor::GetIntraOpThreads(); });
+  m.def("_xla_set_compile_options",
+        [](runtime::ComputationClient::CompileOptionOverrides overrides) {
+          XLAGraphExecutor::SetCompileOptionOverrides(std::move(overrides));
+        });
+  m.def("_xla_get_compile_options",
+        []() { return XLAGraphExecutor::GetCompileOptionOverrides(); });
+  m.def("_xla_get_execution_lane", []() -> std::string {
+    return XLAGraphExecutor::GetExecutionLane() ==
+                   runtime::ExecutionLane::kHighPriority
+               ? "high_priority"
+               : "default";
+  });
   m.def("_get_executed_fallback_ops", []() { return GetFallbackOperations(); });
   m.def("_xla_counter_names", []() {
     auto counter_names = torch::lazy::GetCounterNames();
@@ -1877,6 +2932,32 @@ void InitXlaModuleBindings(py::module m) {
            runtime::metrics_reader::CreateMetricReport(counter_name_vec,
                                                        metric_name_vec);
   });
+  m.def("_xla_metric_histogram", [](const std::string& name) -> py::object {
+    runtime::metrics::MetricData* data = runtime::metrics::GetMetric(name);
+    if (data == nullptr || data->Histogram() == nullptr) {
+      return py::none();
+    }
+    return py::cast(data->Histogram()->Counts());
+  });
+  m.def("_xla_histogram_percentiles",
+        [](const std::vector<int64_t>& counts,
+           const std::vector<double>& percentiles) {
+          return runtime::metrics::LogLinearHistogram::Percentiles(counts,
+                                                                   percentiles);
+        });
+  m.def("_xla_open_metrics_report", []() { return CreateOpenMetricsReport(); });
+  py::class_<runtime::metrics::MetricsServer,
+             std::unique_ptr<runtime::metrics::MetricsServer>>(
+      m, "MetricsServer");
+  m.def(
+      "_xla_start_metrics_server",
+      [](int port) -> std::unique_ptr<runtime::metrics::MetricsServer> {
+        auto server = std::make_unique<runtime::metrics::MetricsServer>(
+            CreateOpenMetricsReport);
+        server->Start(port);
+        return server;
+      },
+      py::arg("port"));
   m.def("_clear_xla_counters", []() {
     torch::lazy::MetricsArena::Get()->ResetCounters();
     runtime::metrics::ClearCounters();
@@ -1885,14 +2966,66 @@ void InitXlaModuleBindings(py::module m) {
     torch::lazy::MetricsArena::Get()->ResetMetrics();
     runtime::metrics::ClearMetrics();
   });
+  m.def("_xla_step_timeline_json",
+        []() { return StepTimeline::Get()->ToJson(); });
+  m.def("_clear_xla_step_timeline", []() { StepTimeline::Get()->Clear(); });
   m.def(
       "_xla_tensors_report",
       [](size_t nodes_threshold, const std::string& device) {
         return GetLiveTensorsReport(nodes_threshold, device);
       },
       py::arg("nodes_threshold") = 100, py::arg("device") = "");
+  m.def("_xla_set_memory_kind", [](const std::vector<at::Tensor>& tensors,
+                                    const std::string& kind) {
+    runtime::MemoryKind memory_kind = runtime::MemoryKindFromString(kind);
+    NoGilSection nogil;
+    for (const at::Tensor& tensor : tensors) {
+      XLATensorPtr xtensor = bridge::GetXlaTensor(tensor);
+      torch::lazy::BackendDataPtr handle = xtensor->CurrentDataHandle();
+      XLA_CHECK(handle != nullptr && handle->HasValue())
+          << "Only the tensors backed by device data can be moved between "
+             "memory kinds, the pending ones must be materialized first (eg. "
+             "with mark_step)";
+      runtime::ComputationClient::DataPtr data = UnwrapXlaData(handle);
+      runtime::ComputationClient::DataPtr moved =
+          runtime::GetComputationClient()->CopyToMemoryKind(data,
+                                                            memory_kind);
+      if (moved != data) {
+        xtensor->SetXlaData(moved);
+      }
+    }
+  });
+  m.def("_xla_get_memory_kind", [](const at::Tensor& tensor) -> std::string {
+    XLATensorPtr xtensor = bridge::GetXlaTensor(tensor);
+    torch::lazy::BackendDataPtr handle = xtensor->CurrentDataHandle();
+    runtime::MemoryKind memory_kind =
+        handle != nullptr ? UnwrapXlaData(handle)->memory_kind()
+                          : runtime::MemoryKind::kDevice;
+    return runtime::MemoryKindToString(memory_kind);
+  });
   m.def("_xla_memory_info",
         [](const std::string& device) { return GetMemoryInfo(device); });
+  m.def("_xla_set_tenant", [](const std::string& tenant) {
+    runtime::tenant::SetCurrent(tenant);
+  });
+  m.def("_xla_get_tenant", []() { return runtime::tenant::Current(); });
+  m.def("_xla_set_tenant_memory_budget",
+        [](const std::string& tenant, int64_t bytes) {
+          runtime::tenant::SetBudget(tenant, bytes);
+        });
+  m.def("_xla_tenant_memory_usage", []() {
+    py::dict py_dict;
+    for (const auto& [tenant, usage] : runtime::tenant::GetUsage()) {
+      py::dict py_usage;
+      py_usage["bytes_used"] = usage.bytes_used;
+      py_usage["peak_bytes_used"] = usage.peak_bytes_used;
+      py_usage["budget_bytes"] = usage.budget_bytes;
+      py_dict[py::str(tenant)] = py_usage;
+    }
+    return py_dict;
+  });
+  m.def("_xla_operation_stats",
+        [](const std::string& device) { return GetOperationStats(device); });
   m.def(
       "_xla_set_use_full_mat_mul_precision",
       [](bool use_full_mat_mul_precision) {
@@ -1939,6 +3072,27 @@ void InitXlaModuleBindings(py::module m) {
           }
           return computation;
         });
+  // Compiles `computation` for `device` without running it, as the compile
+  // time benchmarks do.
+  m.def("_xla_compile_computation",
+        [](const runtime::ComputationClient::ComputationPtr& computation,
+           const std::string& device) {
+          NoGilSection nogil;
+          torch::lazy::BackendDevice backend_device =
+              GetDeviceOrCurrent(device);
+          xla::Shape shape = MakeShapeWithDeviceLayout(
+              ConsumeValue(computation->computation().GetProgramShape())
+                  .result(),
+              static_cast<XlaDeviceType>(backend_device.type()));
+          std::vector<runtime::ComputationClient::CompileInstance> instances;
+          instances.push_back(
+              {xla::XlaComputation(computation->computation().proto()),
+               backend_device.toString(),
+               runtime::GetComputationClient()->GetCompilationDevices(
+                   backend_device.toString(), {}),
+               &shape});
+          runtime::GetComputationClient()->Compile(std::move(instances));
+        });
   m.def("_xla_computation_text",
         [](const runtime::ComputationClient::ComputationPtr& computation) {
           std::string hlo_text;
@@ -1959,6 +3113,18 @@ void InitXlaModuleBindings(py::module m) {
            const std::vector<op_builder::OpPtr>& operands, py::dict args) {
           return op_builder::CreateOp(builder, opname, operands, args);
         });
+  m.def("_xla_op_create",
+        [](op_builder::BuilderPtr builder, int64_t opcode,
+           const std::vector<op_builder::OpPtr>& operands, py::dict args) {
+          return op_builder::CreateOp(builder, opcode, operands, args);
+        });
+  m.def("_xla_op_create_batch",
+        [](op_builder::BuilderPtr builder,
+           const std::vector<op_builder::OpPtr>& inputs,
+           py::list descriptors) {
+          return op_builder::CreateOps(builder, inputs, descriptors);
+        });
+  m.def("_xla_op_codes", []() { return op_builder::GetOpCodes(); });
   m.def("_xla_sgd_optimizer_step_",
         [](const at::Tensor& found_inf, at::Tensor& step, at::Tensor& param,
            at::Tensor& buf, const at::Tensor& d_p, double weight_decay,
@@ -1998,6 +3164,110 @@ void InitXlaModuleBindings(py::module m) {
                 weight_decay, eps, amsgrad, maximize, use_adamw);
           }
         });
+  m.def("_xla_foreach_sgd_optimizer_step_",
+        [](const at::Tensor& found_inf, const at::Tensor& grad_scale,
+           const std::vector<at::Tensor>& steps,
+           const std::vector<at::Tensor>& params,
+           const std::vector<at::Tensor>& bufs,
+           const std::vector<at::Tensor>& d_ps, double weight_decay,
+           double momentum, double lr, double dampening, bool nesterov,
+           bool maximize) {
+          {
+            NoGilSection nogil;
+            std::vector<XLATensorPtr> steps_xla = bridge::GetXlaTensors(steps);
+            std::vector<XLATensorPtr> params_xla =
+                bridge::GetXlaTensors(params);
+            std::vector<XLATensorPtr> bufs_xla = bridge::GetXlaTensors(bufs);
+            tensor_methods::foreach_sgd_optimizer_step_(
+                bridge::GetXlaTensor(found_inf),
+                bridge::GetXlaTensor(grad_scale), steps_xla, params_xla,
+                bufs_xla, bridge::GetXlaTensors(d_ps), weight_decay, momentum,
+                lr, dampening, nesterov, maximize);
+          }
+        });
+  m.def("_xla_foreach_adam_optimizer_step_",
+        [](const at::Tensor& found_inf, const at::Tensor& grad_scale,
+           const std::vector<at::Tensor>& steps,
+           const std::vector<at::Tensor>& params,
+           const std::vector<at::Tensor>& grads,
+           const std::vector<at::Tensor>& exp_avgs,
+           const std::vector<at::Tensor>& exp_avg_sqs,
+           const std::vector<at::Tensor>& max_exp_avg_sqs, double beta1,
+           double beta2, double lr, double weight_decay, double eps,
+           bool amsgrad, bool maximize, bool use_adamw) {
+          {
+            NoGilSection nogil;
+            std::vector<XLATensorPtr> steps_xla = bridge::GetXlaTensors(steps);
+            std::vector<XLATensorPtr> params_xla =
+                bridge::GetXlaTensors(params);
+            std::vector<XLATensorPtr> exp_avgs_xla =
+                bridge::GetXlaTensors(exp_avgs);
+            std::vector<XLATensorPtr> exp_avg_sqs_xla =
+                bridge::GetXlaTensors(exp_avg_sqs);
+            std::vector<XLATensorPtr> max_exp_avg_sqs_xla =
+                amsgrad ? bridge::GetXlaTensors(max_exp_avg_sqs)
+                        : std::vector<XLATensorPtr>();
+            tensor_methods::foreach_adam_optimizer_step_(
+                bridge::GetXlaTensor(found_inf),
+                bridge::GetXlaTensor(grad_scale), steps_xla, params_xla,
+                bridge::GetXlaTensors(grads), exp_avgs_xla, exp_avg_sqs_xla,
+                max_exp_avg_sqs_xla, beta1, beta2, lr, weight_decay, eps,
+                amsgrad, maximize, use_adamw);
+          }
+        });
+  m.def("_xla_foreach_grad_norm_",
+        [](at::Tensor& found_inf, const at::Tensor& inv_scale,
+           const std::vector<at::Tensor>& grads) {
+          XLATensorPtr norm;
+          {
+            NoGilSection nogil;
+            XLATensorPtr found_inf_xla = bridge::GetXlaTensor(found_inf);
+            norm = tensor_methods::foreach_grad_norm_(
+                found_inf_xla, bridge::GetXlaTensor(inv_scale),
+                bridge::GetXlaTensors(grads));
+          }
+          return bridge::AtenFromXlaTensor(std::move(norm));
+        });
+  m.def("_xla_sparse_sgd_optimizer_step_",
+        [](const at::Tensor& found_inf, at::Tensor& step, at::Tensor& param,
+           at::Tensor& buf, const at::Tensor& rows, const at::Tensor& values,
+           double weight_decay, double momentum, double lr, double dampening,
+           bool nesterov, bool maximize) {
+          {
+            NoGilSection nogil;
+            XLATensorPtr found_inf_xla = bridge::GetXlaTensor(found_inf);
+            XLATensorPtr step_xla = bridge::GetXlaTensor(step);
+            XLATensorPtr param_xla = bridge::GetXlaTensor(param);
+            XLATensorPtr buf_xla = bridge::GetXlaTensor(buf);
+            tensor_methods::sparse_sgd_optimizer_step_(
+                found_inf_xla, step_xla, param_xla, buf_xla,
+                bridge::GetXlaTensor(rows), bridge::GetXlaTensor(values),
+                weight_decay, momentum, lr, dampening, nesterov, maximize);
+          }
+        });
+  m.def("_xla_sparse_adam_optimizer_step_",
+        [](const at::Tensor& found_inf, at::Tensor& step, at::Tensor& param,
+           const at::Tensor& rows, const at::Tensor& values,
+           at::Tensor& exp_avg, at::Tensor& exp_avg_sq,
+           at::Tensor& max_exp_avg_sq, double beta1, double beta2, double lr,
+           double weight_decay, double eps, bool amsgrad, bool maximize,
+           bool use_adamw) {
+          {
+            NoGilSection nogil;
+            XLATensorPtr found_inf_xla = bridge::GetXlaTensor(found_inf);
+            XLATensorPtr step_xla = bridge::GetXlaTensor(step);
+            XLATensorPtr param_xla = bridge::GetXlaTensor(param);
+            XLATensorPtr exp_avg_xla = bridge::GetXlaTensor(exp_avg);
+            XLATensorPtr exp_avg_sq_xla = bridge::GetXlaTensor(exp_avg_sq);
+            XLATensorPtr max_exp_avg_sq_xla =
+                bridge::GetXlaTensor(max_exp_avg_sq);
+            tensor_methods::sparse_adam_optimizer_step_(
+                found_inf_xla, step_xla, param_xla, bridge::GetXlaTensor(rows),
+                bridge::GetXlaTensor(values), exp_avg_xla, exp_avg_sq_xla,
+                max_exp_avg_sq_xla, beta1, beta2, lr, weight_decay, eps,
+                amsgrad, maximize, use_adamw);
+          }
+        });
   py::class_<xla::OpSharding>(m, "OpSharding")
       .def(py::init([](const py::list& tile_assignment,
                        const py::list& group_assignment,
@@ -2024,7 +3294,7 @@ void InitXlaModuleBindings(py::module m) {
     auto shard_shape = xla::ShapeUtil::MakeShape(
         MakeXlaPrimitiveType(xtensor->dtype(), &(xtensor->GetDevice())),
         ShardingUtil::GetShardShape(sharding_spec));
-    auto output = xtensor->CreateFrom(torch::lazy::MakeNode<CustomSharding>(
+    auto output = xtensor->CreateFrom(torch_xla::MakeNode<CustomSharding>(
         xtensor->GetIrValue(), shard_shape,
         CustomSharding::Type::kSPMDFullToShardShape));
     output->SetShardingSpec(XLATensor::ShardingSpec(
@@ -2047,7 +3317,7 @@ void InitXlaModuleBindings(py::module m) {
                 reinterpret_cast<THPDtype*>(output_dtype.ptr())->scalar_type,
                 &(xtensor->GetDevice())),
             output_shape);
-        auto output = xtensor->CreateFrom(torch::lazy::MakeNode<CustomSharding>(
+        auto output = xtensor->CreateFrom(torch_xla::MakeNode<CustomSharding>(
             xtensor->GetIrValue(), full_shape,
             CustomSharding::Type::kSPMDShardToFullShape));
         output->SetShardingSpec(XLATensor::ShardingSpec(sharding, full_shape));
@@ -2178,8 +3448,13 @@ void InitXlaModuleBindings(py::module m) {
               << " vs " << expected_shard_shape;
         }
 
-        auto data_handle = ShardingUtil::CreateShardedData(
-            shards, local_devices, sharding_spec);
+        runtime::ComputationClient::DataPtr data_handle;
+        {
+          // Lets the data loader threads assemble their batches concurrently.
+          NoGilSection nogil;
+          data_handle = ShardingUtil::CreateShardedData(shards, local_devices,
+                                                        sharding_spec);
+        }
         XLATensorPtr xla_tensor = XLATensor::Create(std::move(data_handle));
         xla_tensor->SetShardingSpec(*sharding_spec);
         auto tensor = bridge::AtenFromXlaTensor(std::move(xla_tensor));
@@ -2326,6 +3601,26 @@ void InitXlaModuleBindings(py::module m) {
         ShardingUtil::CreateShardedData(shards, devices, sharding_spec);
     xtensor->SetXlaData(xla_data);
   });
+  // Streams the local shards of the tensors to and from one file per distinct
+  // shard, named after the prefix of their tensor.
+  m.def("_save_local_shards_to_files",
+        [](const std::vector<at::Tensor>& tensors,
+           const std::vector<std::string>& prefixes,
+           int64_t max_buffered_bytes) {
+          std::vector<XLATensorPtr> xtensors =
+              GetXlaTensors(tensors, /*want_all=*/true);
+          NoGilSection nogil;
+          SaveLocalShards(xtensors, prefixes, max_buffered_bytes);
+        });
+  m.def("_load_local_shards_from_files",
+        [](const std::vector<at::Tensor>& tensors,
+           const std::vector<std::string>& prefixes,
+           int64_t max_buffered_bytes) {
+          std::vector<XLATensorPtr> xtensors =
+              GetXlaTensors(tensors, /*want_all=*/true);
+          NoGilSection nogil;
+          LoadLocalShards(xtensors, prefixes, max_buffered_bytes);
+        });
   // Initialize the XlaCoordinator in the runtime if not already initialized.
   m.def(
       "_ensure_xla_coordinator_initialized",
@@ -2366,6 +3661,46 @@ void InitXlaModuleBindings(py::module m) {
     auto& coordinator = comp_client->GetCoordinator();
     return coordinator.ReachedSyncPoint(step);
   });
+  // Sets the tensors the step marker copies to host memory once a step is
+  // found to be the preemption sync point. The steps are counted by the step
+  // marker, so ReachedSyncPoint() must not be called with other steps then.
+  m.def("_xla_set_preemption_snapshot_tensors",
+        [](const std::vector<at::Tensor>& tensors) {
+          XLAGraphExecutor::Get()->SetPreemptionSnapshotTensors(
+              bridge::GetXlaTensors(tensors));
+        });
+  m.def("_xla_preemption_snapshot_step", []() -> std::optional<int64_t> {
+    return XLAGraphExecutor::Get()->PreemptionSnapshotStep();
+  });
+  m.def("_xla_wait_preemption_snapshot", []() {
+    std::vector<at::Tensor> result;
+    {
+      NoGilSection nogil;
+      result = XLAGraphExecutor::Get()->WaitPreemptionSnapshot();
+    }
+    return result;
+  });
+  // Exchanges the payloads of the processes through the distributed runtime,
+  // on the host. This requires that the distributed runtime be initialized.
+  m.def("_xla_host_all_gather",
+        [](const std::string& tag, const py::bytes& payload,
+           double timeout_s) {
+          auto comp_client = runtime::GetComputationClient();
+          XLA_CHECK(comp_client->CoordinatorInitialized())
+              << "Coordinator must be initialized";
+          std::string value = payload;
+          std::vector<std::string> values;
+          {
+            NoGilSection nogil;
+            values = comp_client->GetCoordinator().AllGather(
+                tag, value, absl::Seconds(timeout_s));
+          }
+          py::list result;
+          for (const std::string& rank_value : values) {
+            result.append(py::bytes(rank_value));
+          }
+          return result;
+        });
   m.def("_is_placecholder", [](at::Tensor& input) {
     XLATensorPtr xtensor = bridge::GetXlaTensor(input);
     return xtensor->CurrentDataHandle() &&
@@ -2373,6 +3708,7 @@ void InitXlaModuleBindings(py::module m) {
   });
   m.def("_init_xla_lazy_backend", []() {
     MapXlaEnvVarsToLazy();
+    InstallPythonFrameCapture();
     InitXlaBackend();
   });
   m.def("_set_ir_debug",
@@ -2415,22 +3751,45 @@ void InitXlaModuleBindings(py::module m) {
               has_side_effect, backend_config, api_version);
           return bridge::AtenFromXlaTensors(std::move(xtensors));
         });
+  m.def("_xla_register_custom_kernel", [](const std::string& payload) {
+    return CustomKernelRegistry::Get()->Register(payload);
+  });
+  // The custom calls take either the payload of the kernel, or the id it is
+  // registered as, which spares the interning of the payload on each call.
   m.def("_xla_tpu_custom_call",
-        [](const std::vector<at::Tensor>& inputs, const std::string& payload,
+        [](const std::vector<at::Tensor>& inputs, int64_t kernel_id,
            const std::vector<std::vector<int64_t>>& output_shapes,
            const std::vector<py::object>& output_dtypes)
             -> std::vector<at::Tensor> {
-          return XlaCustomCall(inputs, payload, output_shapes, output_dtypes,
+          return XlaCustomCall(inputs, kernel_id, output_shapes, output_dtypes,
                                /*is_tpu=*/true);
         });
-  m.def("_xla_gpu_custom_call",
+  m.def("_xla_tpu_custom_call",
         [](const std::vector<at::Tensor>& inputs, const std::string& payload,
            const std::vector<std::vector<int64_t>>& output_shapes,
            const std::vector<py::object>& output_dtypes)
             -> std::vector<at::Tensor> {
-          return XlaCustomCall(inputs, payload, output_shapes, output_dtypes,
+          return XlaCustomCall(inputs,
+                               CustomKernelRegistry::Get()->Register(payload),
+                               output_shapes, output_dtypes, /*is_tpu=*/true);
+        });
+  m.def("_xla_gpu_custom_call",
+        [](const std::vector<at::Tensor>& inputs, int64_t kernel_id,
+           const std::vector<std::vector<int64_t>>& output_shapes,
+           const std::vector<py::object>& output_dtypes)
+            -> std::vector<at::Tensor> {
+          return XlaCustomCall(inputs, kernel_id, output_shapes, output_dtypes,
                                /*is_tpu=*/false);
         });
+  m.def("_xla_gpu_custom_call",
+        [](const std::vector<at::Tensor>& inputs, const std::string& payload,
+           const std::vector<std::vector<int64_t>>& output_shapes,
+           const std::vector<py::object>& output_dtypes)
+            -> std::vector<at::Tensor> {
+          return XlaCustomCall(inputs,
+                               CustomKernelRegistry::Get()->Register(payload),
+                               output_shapes, output_dtypes, /*is_tpu=*/false);
+        });
   m.def("_xla_register_custom_call_target",
         [](const std::string& fn_name, const py::capsule& function_ptr,
            const std::string& platform) {
@@ -2446,6 +3805,24 @@ void InitXlaModuleBindings(py::module m) {
                                                      max_call_stack_depth);
           return xtensor->SetNodeUserMetadata(user_meta);
         });
+  m.def("_xla_mark_reusable_scope",
+        [](const std::vector<at::Tensor>& outputs,
+           const std::vector<at::Tensor>& inputs, const std::string& name) {
+          // The subgraphs of the inputs are marked first, so that they are
+          // left out of the scope.
+          std::shared_ptr<torch::lazy::UserMetaData> input_meta =
+              std::make_shared<CustomOpNameMetaData>(
+                  "", std::numeric_limits<int>::max());
+          for (const at::Tensor& input : inputs) {
+            bridge::GetXlaTensor(input)->SetNodeUserMetadata(input_meta);
+          }
+          std::shared_ptr<torch::lazy::UserMetaData> scope_meta =
+              std::make_shared<CustomOpNameMetaData>(
+                  name, std::numeric_limits<int>::max(), /*reusable=*/true);
+          for (const at::Tensor& output : outputs) {
+            bridge::GetXlaTensor(output)->SetNodeUserMetadata(scope_meta);
+          }
+        });
   m.def("_get_all_reduce_token",
         [](const std::string& device_str) -> const torch::lazy::Value& {
           auto device = GetDeviceOrCurrent(device_str);
@@ -2457,6 +3834,18 @@ void InitXlaModuleBindings(py::module m) {
           auto device = GetDeviceOrCurrent(device_str);
           SetAllReduceToken(device, token);
         });
+  m.def("_get_channel_token",
+        [](const std::string& device_str,
+           int64_t channel_id) -> const torch::lazy::Value& {
+          auto device = GetDeviceOrCurrent(device_str);
+          return GetChannelToken(device, channel_id);
+        });
+  m.def("_set_channel_token",
+        [](const std::string& device_str, int64_t channel_id,
+           const std::shared_ptr<torch::lazy::Value>& token) {
+          auto device = GetDeviceOrCurrent(device_str);
+          SetChannelToken(device, channel_id, token);
+        });
 
   BuildProfilerSubmodule(&m);
   BuildLoweringContextSubmodule(&m);
@@ -2509,6 +3898,37 @@ void InitXlaModuleBindings(py::module m) {
           }
           return result;
         });
+  m.def("_xla_set_speculative_size_guards", [](bool enabled) {
+    SizeGuardSpeculation::Get()->set_enabled(enabled);
+  });
+  // Returns the (site, predicted value, size tensor) of the guards speculated
+  // since the last call, the size tensors to sync along with the step.
+  m.def("_xla_take_speculative_size_guards", []() {
+    std::vector<std::tuple<std::string, int64_t, at::Tensor>> guards;
+    for (SizeGuardSpeculation::Pending& pending :
+         SizeGuardSpeculation::Get()->TakePending()) {
+      XLATensorPtr size = XLATensor::Create(
+          pending.node, *bridge::GetDefaultDevice(), at::ScalarType::Long);
+      guards.emplace_back(pending.site, pending.predicted,
+                          bridge::AtenFromXlaTensor(std::move(size)));
+    }
+    return guards;
+  });
+  m.def("_xla_observe_size_guard", [](const std::string& site, int64_t value) {
+    SizeGuardSpeculation::Get()->Observe(site, value);
+  });
+
+  m.def("_xla_set_step_roots",
+        [](const std::vector<at::Tensor>& tensors, bool is_root) {
+          for (XLATensorPtr& xtensor :
+               GetXlaTensors(tensors, /*want_all=*/false)) {
+            xtensor->data()->is_step_root = is_root;
+          }
+        });
+  m.def("_xla_is_step_root", [](const at::Tensor& tensor) -> bool {
+    XLATensorPtr xtensor = bridge::TryGetXlaTensor(tensor);
+    return xtensor && xtensor->data()->is_step_root;
+  });
 
   // This api will set the `should_donate_buffer_` field in the
   // ComputationClient::Data. This api is currently only useful if you are
@@ -2590,27 +4010,33 @@ void InitXlaModuleBindings(py::module m) {
         });
 
   // from an XLA tensor to a dlpack tensor.
-  // If ext_data is the result of an CUDA computation, we should synchronize
-  // (waits for all kernels in all streams on a CUDA device to complete) if the
-  // current stream is different from the ext_data's stream. Otherwise, we may
-  // risk of getting incorrect results.
-  m.def("_to_dlpack", [](const at::Tensor& input) -> py::handle {
-    DLManagedTensor* dlMTensor;
-    {
-      NoGilSection nogil;
-      dlMTensor = torch_xla::toDLPack(input);
-    }
-    return PyCapsule_New(dlMTensor, "dltensor", dlPack_Capsule_Destructor);
-  });
+  // Without a stream, waits for the buffer to be ready on the host. With the
+  // stream of the consumer, the stream waits for the buffer instead, and -1
+  // skips the synchronization, as in the DLPack stream protocol.
+  m.def(
+      "_to_dlpack",
+      [](const at::Tensor& input,
+         std::optional<std::intptr_t> stream) -> py::handle {
+        DLManagedTensor* dlMTensor;
+        {
+          NoGilSection nogil;
+          dlMTensor = torch_xla::toDLPack(input, stream);
+        }
+        return PyCapsule_New(dlMTensor, "dltensor", dlPack_Capsule_Destructor);
+      },
+      py::arg("input"), py::arg("stream") = py::none());
 
   // from a dlpack tensor to an XLA tensor
-  // If ext_data is the result of an CUDA computation, we should synchronize
-  // (waits for all kernels in all streams on a CUDA device to complete) if the
-  // current stream is different from the ext_data's stream. Otherwise, we may
-  // risk of getting incorrect results.
-  m.def("_from_dlpack", [](py::handle ext_data) -> at::Tensor {
-    return tensor_fromDLPack(ext_data.ptr());
-  });
+  // If ext_data is the result of an CUDA computation, its producer must order
+  // its writes on `stream`, the one the XLA computations using the buffer wait
+  // for. Without a stream, the producer must have synchronized the buffer.
+  m.def(
+      "_from_dlpack",
+      [](py::handle ext_data,
+         std::optional<std::intptr_t> stream) -> at::Tensor {
+        return tensor_fromDLPack(ext_data.ptr(), stream);
+      },
+      py::arg("ext_data"), py::arg("stream") = py::none());
 
   // -------------Dynamo Integration API Start-------------------------
   /*
@@ -2711,12 +4137,74 @@ void InitXlaModuleBindings(py::module m) {
     SetAllReduceToken(xla_device, nullptr);
   });
 
+  py::class_<XLAGraphExecutor::CallPlan,
+             std::shared_ptr<XLAGraphExecutor::CallPlan>>(m, "XlaCallPlan")
+      .def("__call__",
+           [](std::shared_ptr<XLAGraphExecutor::CallPlan> plan,
+              const std::vector<at::Tensor>& inputs) {
+             std::vector<at::Tensor> retlist;
+             {
+               NoGilSection nogil;
+               std::vector<torch::lazy::BackendDataPtr> results =
+                   XLAGraphExecutor::Get()->ExecuteCallPlan(*plan, inputs);
+               retlist.reserve(results.size());
+               for (auto& data : results) {
+                 retlist.push_back(bridge::AtenFromXlaTensor(
+                     torch_xla::XLATensor::Create(std::move(data))));
+               }
+               if (auto sequence =
+                       XLAGraphExecutor::GetCallSequenceCapture()) {
+                 sequence->Record(std::move(plan), inputs, retlist);
+               }
+             }
+             return retlist;
+           })
+      .def_property_readonly("graph_hash",
+                             [](const XLAGraphExecutor::CallPlan& plan) {
+                               return py::bytes(
+                                   reinterpret_cast<const char*>(&plan.hash),
+                                   sizeof(plan.hash));
+                             });
+  py::class_<XLAGraphExecutor::CallSequence,
+             std::shared_ptr<XLAGraphExecutor::CallSequence>>(
+      m, "XlaCallSequence")
+      .def("replay",
+           [](const XLAGraphExecutor::CallSequence& sequence) {
+             NoGilSection nogil;
+             XLAGraphExecutor::Get()->ReplayCallSequence(sequence);
+           })
+      .def_property_readonly("num_steps",
+                             &XLAGraphExecutor::CallSequence::num_steps);
+  m.def("_xla_begin_call_sequence_capture", []() {
+    XLA_CHECK(XLAGraphExecutor::GetCallSequenceCapture() == nullptr)
+        << "A call sequence is already being captured";
+    XLAGraphExecutor::SetCallSequenceCapture(
+        std::make_shared<XLAGraphExecutor::CallSequence>());
+  });
+  m.def("_xla_end_call_sequence_capture", []() {
+    std::shared_ptr<XLAGraphExecutor::CallSequence> sequence =
+        XLAGraphExecutor::GetCallSequenceCapture();
+    XLA_CHECK(sequence != nullptr) << "No call sequence is being captured";
+    XLAGraphExecutor::SetCallSequenceCapture(nullptr);
+    return sequence;
+  });
+  m.def("_xla_create_call_plan", [](const std::string& hash_str) {
+    XLA_CHECK(hash_str.size() == sizeof(torch::lazy::hash_t));
+    torch::lazy::hash_t hash = *(torch::lazy::hash_t*)(hash_str.c_str());
+    NoGilSection nogil;
+    // Device will be Virtual device if SPMD is enabled.
+    return XLAGraphExecutor::Get()->CreateCallPlan(
+        hash, torch_xla::bridge::GetCurrentDevice());
+  });
   m.def("_run_cached_graph",
         [](const std::string& hash_str,
            const std::vector<at::IValue>& graph_inputs)
             -> std::vector<at::Tensor> {
           XLA_CHECK(hash_str.size() == sizeof(torch::lazy::hash_t));
           torch::lazy::hash_t hash = *(torch::lazy::hash_t*)(hash_str.c_str());
+          // Waiting on the barrier of the previous execution does not hold
+          // the GIL.
+          NoGilSection nogil;
           // Device will be Virtual device if SPMD is enabled.
           torch::lazy::BackendDevice device =
               torch_xla::bridge::GetCurrentDevice();
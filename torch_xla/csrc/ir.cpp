@@ -5,6 +5,7 @@
 #include <torch/csrc/lazy/core/ir_metadata.h>
 #include <torch/csrc/lazy/python/python_util.h>
 
+#include <algorithm>
 #include <functional>
 #include <sstream>
 
@@ -17,16 +18,68 @@
 namespace torch_xla {
 namespace {
 
-using ShapeCache = runtime::util::Cache<torch::lazy::hash_t, xla::Shape,
-                                        torch::lazy::HashReducer>;
+using ShapeCache =
+    runtime::util::AbstractCache<torch::lazy::hash_t, xla::Shape,
+                                 torch::lazy::HashReducer>;
 
-ShapeCache* GetShapeCache() {
+ShapeCache* CreateShapeCache() {
   static int64_t shape_cache_size =
       runtime::sys_util::GetEnvInt("XLA_IR_SHAPE_CACHE_SIZE", 12288);
-  static ShapeCache* cache = new ShapeCache(shape_cache_size);
+  static int64_t shape_cache_shards =
+      runtime::sys_util::GetEnvInt("XLA_IR_SHAPE_CACHE_SHARDS", 1);
+  if (shape_cache_shards > 1) {
+    return new runtime::util::ShardedCache<torch::lazy::hash_t, xla::Shape,
+                                           torch::lazy::HashReducer>(
+        shape_cache_size, shape_cache_shards, /*name=*/"IrShapeCache");
+  }
+  return new runtime::util::Cache<torch::lazy::hash_t, xla::Shape,
+                                  torch::lazy::HashReducer>(shape_cache_size);
+}
+
+ShapeCache* GetShapeCache() {
+  static ShapeCache* cache = CreateShapeCache();
   return cache;
 }
 
+// A direct mapped cache of the shapes the thread looked up, in front of the
+// shared one, so that tracing a graph seen before takes no lock.
+class ThreadShapeCache {
+ public:
+  static ThreadShapeCache* Current() {
+    static const int64_t size =
+        runtime::sys_util::GetEnvInt("XLA_IR_SHAPE_THREAD_CACHE_SIZE", 4096);
+    static thread_local ThreadShapeCache cache(size);
+    return cache.entries_.empty() ? nullptr : &cache;
+  }
+
+  std::shared_ptr<xla::Shape> Get(const torch::lazy::hash_t& hash) const {
+    const Entry& entry = entries_[Index(hash)];
+    return entry.hash == hash ? entry.shape : nullptr;
+  }
+
+  void Add(const torch::lazy::hash_t& hash,
+           std::shared_ptr<xla::Shape> shape) {
+    Entry& entry = entries_[Index(hash)];
+    entry.hash = hash;
+    entry.shape = std::move(shape);
+  }
+
+ private:
+  struct Entry {
+    torch::lazy::hash_t hash = 0;
+    std::shared_ptr<xla::Shape> shape;
+  };
+
+  explicit ThreadShapeCache(int64_t size)
+      : entries_(std::max<int64_t>(size, 0)) {}
+
+  size_t Index(const torch::lazy::hash_t& hash) const {
+    return torch::lazy::HashReducer()(hash) % entries_.size();
+  }
+
+  std::vector<Entry> entries_;
+};
+
 torch::lazy::hash_t GetOperandHashes(const torch::lazy::OpList& operands,
                                      const torch::lazy::hash_t& node_hash) {
   torch::lazy::hash_t hash = node_hash;
@@ -110,6 +163,11 @@ XlaNode::XlaNode(torch::lazy::OpKind op, xla::Shape xla_shape,
 
 XlaNode::~XlaNode() {}
 
+int32_t XlaNode::CaptureFrameStack() {
+  return FLAGS_torch_lazy_ir_debug ? FrameTable::Get()->CaptureStack()
+                                   : FrameTable::kNoStack;
+}
+
 const xla::Shape& XlaNode::xla_shape(size_t output_index) const {
   if (xla_shape_.IsTuple()) {
     return xla_shape_.tuple_shapes(output_index);
@@ -163,11 +221,22 @@ void XlaNode::SetSharding(const xla::OpSharding& sharding, size_t index) {
 
 xla::Shape XlaNode::GetOpShape(
     const std::function<xla::Shape()>& shape_fn) const {
+  ThreadShapeCache* thread_cache = ThreadShapeCache::Current();
+  std::shared_ptr<xla::Shape> shape;
+  if (thread_cache != nullptr) {
+    shape = thread_cache->Get(hash());
+    if (shape != nullptr) {
+      return *shape;
+    }
+  }
   ShapeCache* shape_cache = GetShapeCache();
-  auto shape = shape_cache->Get(hash());
+  shape = shape_cache->Get(hash());
   if (shape == nullptr) {
     shape = shape_cache->Add(hash(), std::make_shared<xla::Shape>(shape_fn()));
   }
+  if (thread_cache != nullptr) {
+    thread_cache->Add(hash(), shape);
+  }
   return *shape;
 }
 
@@ -184,6 +253,13 @@ const xla::Shape& GetXlaShape(const torch::lazy::Value& value) {
   return casted->xla_shape(value.index);
 }
 
+std::vector<torch::lazy::SourceLocation> GetNodeFrames(
+    const torch::lazy::Node* node) {
+  const XlaNode* xla_node = dynamic_cast<const XlaNode*>(node);
+  return xla_node != nullptr ? xla_node->GetFrames()
+                             : node->metadata().frame_info;
+}
+
 // The sharding hash is only based on relevant fields from the xla::OpSharding
 // object. We skip the field that's irrelevant, which is the layout.
 void XlaNode::UpdateShardingHash() {
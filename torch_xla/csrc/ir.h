@@ -19,6 +19,8 @@
 #include "absl/container/inlined_vector.h"
 #include "absl/hash/hash.h"
 #include "absl/types/span.h"
+#include "torch_xla/csrc/frame_table.h"
+#include "torch_xla/csrc/ir_arena.h"
 #include "torch_xla/csrc/runtime/types.h"
 #include "xla/client/xla_builder.h"
 
@@ -109,6 +111,11 @@ class XlaNode : public torch::lazy::Node {
   XlaOpVector ReturnOps(absl::Span<const xla::XlaOp> ops,
                         LoweringContext* loctx) const;
 
+  // The operand at `index` as a value holding its node.
+  torch::lazy::Value operand_value(size_t index) const {
+    return torch::lazy::Value(operands_.at(index), operand(index).index);
+  }
+
   torch::lazy::hash_t node_hash() const { return node_hash_; }
 
   torch::lazy::hash_t hash() const override {
@@ -122,6 +129,14 @@ class XlaNode : public torch::lazy::Node {
 
   torch::lazy::hash_t shardingHash() const { return sharding_hash_; }
 
+  // The interned stack of the Python frames which created the node, see
+  // FrameTable. The frames are not in metadata().frame_info.
+  int32_t frame_stack() const { return frame_stack_; }
+
+  std::vector<torch::lazy::SourceLocation> GetFrames() const {
+    return FrameTable::Get()->GetFrames(frame_stack_);
+  }
+
   // The node's outputs get assigned the same HLO sharding
   const std::shared_ptr<xla::OpSharding> GetSharding(size_t index) const {
     if (output_shardings_.size() == 0) {
@@ -160,7 +175,9 @@ class XlaNode : public torch::lazy::Node {
                                        const xla::Shape& shape,
                                        torch::lazy::hash_t hash_seed);
 
-  static std::vector<torch::lazy::SourceLocation> GetFrameInfo();
+  // The interned stack of the Python frames creating the node, captured in
+  // debug mode.
+  static int32_t CaptureFrameStack();
 
   void UpdateShardingHash();
 
@@ -168,6 +185,7 @@ class XlaNode : public torch::lazy::Node {
   torch::lazy::hash_t node_hash_ = 0;
   torch::lazy::hash_t dag_hash_;
   torch::lazy::hash_t sharding_hash_ = 0;
+  int32_t frame_stack_ = CaptureFrameStack();
 
   // Experimental sharding annotations attached to the IR node.
   std::vector<std::shared_ptr<xla::OpSharding>> output_shardings_;
@@ -178,8 +196,23 @@ inline std::ostream& operator<<(std::ostream& stream, const XlaNode& node) {
   return stream;
 }
 
+// Creates the node T like torch::lazy::MakeNode(), in the IR node pool (see
+// ir_arena.h) unless XLA_IR_NODE_ARENA=0.
+template <typename T, typename... Args>
+torch::lazy::NodePtr MakeNode(Args&&... args) {
+  if (ir_arena::Enabled()) {
+    return std::allocate_shared<T>(ir_arena::Allocator<T>(),
+                                   std::forward<Args>(args)...);
+  }
+  return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
 const xla::Shape& GetXlaShape(const torch::lazy::Value& value);
 
+// The Python frames which created `node`, innermost first, in debug mode.
+std::vector<torch::lazy::SourceLocation> GetNodeFrames(
+    const torch::lazy::Node* node);
+
 template <typename T>
 T* NodeCast(const torch::lazy::Node* node, torch::lazy::OpKind op) {
   if (op != node->op()) {
@@ -196,11 +229,16 @@ T* NodeCast(const torch::lazy::Node* node, torch::lazy::OpKind op) {
 
 struct CustomOpNameMetaData : public torch::lazy::UserMetaData {
   CustomOpNameMetaData(const std::string& input_op_name_prefix,
-                       int input_max_stack_depth)
+                       int input_max_stack_depth, bool input_reusable = false)
       : op_name_prefix(input_op_name_prefix),
-        max_stack_depth(input_max_stack_depth) {}
+        max_stack_depth(input_max_stack_depth),
+        reusable(input_reusable) {}
   std::string op_name_prefix;
   size_t max_stack_depth;
+  // The nodes marked with this metadata form a reusable scope, lowered as a
+  // call to a computation shared with the scopes of the same structure (see
+  // ReusableScopeLowering).
+  bool reusable;
 };
 
 }  // namespace torch_xla
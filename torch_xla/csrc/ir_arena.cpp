@@ -0,0 +1,189 @@
+#include "torch_xla/csrc/ir_arena.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "torch_xla/csrc/runtime/sys_util.h"
+
+namespace torch_xla {
+namespace ir_arena {
+namespace {
+
+constexpr size_t kNumClasses = kMaxSize / kClassSize;
+// The pool hands out the blocks to the threads in batches of about
+// kBatchBytes, and a thread caching twice as much gives its blocks back.
+constexpr size_t kBatchBytes = 64 * 1024;
+constexpr size_t kSlabBytes = 1024 * 1024;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+// A singly linked list of free blocks of one size class.
+struct FreeList {
+  void Push(void* ptr) {
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = head;
+    head = block;
+    if (tail == nullptr) {
+      tail = block;
+    }
+    count += 1;
+  }
+
+  void* Pop() {
+    FreeBlock* block = head;
+    head = block->next;
+    if (head == nullptr) {
+      tail = nullptr;
+    }
+    count -= 1;
+    return block;
+  }
+
+  FreeBlock* head = nullptr;
+  FreeBlock* tail = nullptr;
+  size_t count = 0;
+};
+
+size_t SizeClass(size_t size) {
+  return (std::max<size_t>(size, 1) + kClassSize - 1) / kClassSize - 1;
+}
+
+size_t BatchCount(size_t size_class) {
+  return std::max<size_t>(kBatchBytes / ((size_class + 1) * kClassSize), 8);
+}
+
+// The blocks not cached by any thread, in batches, and the slabs.
+class Pool {
+ public:
+  static Pool* Get() {
+    // Leaked, as the caches of the threads still running at exit give their
+    // blocks back to it.
+    static Pool* pool = new Pool();
+    return pool;
+  }
+
+  FreeList TakeBatch(size_t size_class) {
+    std::lock_guard<std::mutex> lock(lock_);
+    std::vector<FreeList>& batches = batches_[size_class];
+    if (!batches.empty()) {
+      FreeList batch = batches.back();
+      batches.pop_back();
+      return batch;
+    }
+    size_t block_size = (size_class + 1) * kClassSize;
+    FreeList batch;
+    for (size_t i = BatchCount(size_class); i > 0; --i) {
+      if (slab_left_ < block_size) {
+        NewSlab();
+      }
+      batch.Push(slab_next_);
+      slab_next_ += block_size;
+      slab_left_ -= block_size;
+    }
+    return batch;
+  }
+
+  void GiveBatch(size_t size_class, FreeList batch) {
+    std::lock_guard<std::mutex> lock(lock_);
+    batches_[size_class].push_back(batch);
+  }
+
+  size_t SlabBytes() const { return slab_bytes_.load(); }
+
+ private:
+  void NewSlab() {
+    // The tail of the previous slab smaller than the block is left unused.
+    slabs_.emplace_back(new char[kSlabBytes]);
+    slab_next_ = slabs_.back().get();
+    slab_left_ = kSlabBytes;
+    slab_bytes_ += kSlabBytes;
+    TORCH_LAZY_COUNTER("IrNodeArenaSlabs", 1);
+  }
+
+  std::mutex lock_;
+  std::vector<FreeList> batches_[kNumClasses];
+  std::vector<std::unique_ptr<char[]>> slabs_;
+  char* slab_next_ = nullptr;
+  size_t slab_left_ = 0;
+  std::atomic<size_t> slab_bytes_{0};
+};
+
+// Whether the cache of the thread is gone, the nodes freed by the destructors
+// running after it going straight to the pool.
+thread_local bool g_cache_destroyed = false;
+
+// The free blocks cached by a thread.
+struct ThreadCache {
+  ~ThreadCache() {
+    for (size_t i = 0; i < kNumClasses; ++i) {
+      if (lists[i].count > 0) {
+        Pool::Get()->GiveBatch(i, lists[i]);
+      }
+    }
+    g_cache_destroyed = true;
+  }
+
+  FreeList lists[kNumClasses];
+};
+
+thread_local ThreadCache g_cache;
+
+}  // namespace
+
+bool Enabled() {
+  static const bool enabled =
+      runtime::sys_util::GetEnvBool("XLA_IR_NODE_ARENA", true);
+  return enabled;
+}
+
+void* Allocate(size_t size) {
+  if (size > kMaxSize) {
+    return ::operator new(size);
+  }
+  size_t size_class = SizeClass(size);
+  if (g_cache_destroyed) {
+    FreeList batch = Pool::Get()->TakeBatch(size_class);
+    void* ptr = batch.Pop();
+    if (batch.count > 0) {
+      Pool::Get()->GiveBatch(size_class, batch);
+    }
+    return ptr;
+  }
+  FreeList& list = g_cache.lists[size_class];
+  if (list.count == 0) {
+    list = Pool::Get()->TakeBatch(size_class);
+  }
+  return list.Pop();
+}
+
+void Deallocate(void* ptr, size_t size) {
+  if (size > kMaxSize) {
+    ::operator delete(ptr);
+    return;
+  }
+  size_t size_class = SizeClass(size);
+  if (g_cache_destroyed) {
+    FreeList batch;
+    batch.Push(ptr);
+    Pool::Get()->GiveBatch(size_class, batch);
+    return;
+  }
+  FreeList& list = g_cache.lists[size_class];
+  list.Push(ptr);
+  if (list.count >= 2 * BatchCount(size_class)) {
+    Pool::Get()->GiveBatch(size_class, list);
+    list = FreeList();
+  }
+}
+
+size_t SlabBytes() { return Pool::Get()->SlabBytes(); }
+
+}  // namespace ir_arena
+}  // namespace torch_xla
@@ -0,0 +1,77 @@
+#ifndef XLA_TORCH_XLA_CSRC_IR_ARENA_H_
+#define XLA_TORCH_XLA_CSRC_IR_ARENA_H_
+
+#include <cstddef>
+#include <new>
+
+namespace torch_xla {
+namespace ir_arena {
+
+// The pooled allocation of the IR nodes. The graphs are traced again on every
+// step, so most of the nodes of a step are freed before the ones of the next
+// step are created. The nodes, along with the shared_ptr control blocks which
+// std::allocate_shared places in the same block, are carved out of large
+// slabs in size classes, and the freed blocks are reused by the next nodes of
+// the same class instead of going back to the heap. The blocks are cached per
+// thread, so that tracing takes no lock but once per batch of blocks, and the
+// nodes may be freed on any thread. The slabs are never released, so the pool
+// holds on to the memory of the largest graph traced so far.
+
+// The blocks are multiples of kClassSize bytes, the larger allocations going
+// to the heap.
+constexpr size_t kClassSize = 64;
+constexpr size_t kMaxSize = 2048;
+
+// Whether the nodes are allocated in the pool (XLA_IR_NODE_ARENA).
+bool Enabled();
+
+void* Allocate(size_t size);
+
+// Frees the `ptr` returned by Allocate(size).
+void Deallocate(void* ptr, size_t size);
+
+// The bytes of slabs allocated by the pool so far.
+size_t SlabBytes();
+
+// The allocator of the pool, to pass to std::allocate_shared.
+template <typename T>
+class Allocator {
+ public:
+  using value_type = T;
+
+  Allocator() = default;
+
+  template <typename U>
+  Allocator(const Allocator<U>&) {}
+
+  T* allocate(size_t n) {
+    if (alignof(T) > alignof(std::max_align_t)) {
+      return static_cast<T*>(
+          ::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+    return static_cast<T*>(Allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, size_t n) {
+    if (alignof(T) > alignof(std::max_align_t)) {
+      ::operator delete(ptr, std::align_val_t(alignof(T)));
+    } else {
+      Deallocate(ptr, n * sizeof(T));
+    }
+  }
+
+  template <typename U>
+  bool operator==(const Allocator<U>&) const {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const Allocator<U>&) const {
+    return false;
+  }
+};
+
+}  // namespace ir_arena
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_IR_ARENA_H_
@@ -0,0 +1,151 @@
+#include "torch_xla/csrc/ir_binary_dump.h"
+
+#include <cstring>
+
+namespace torch_xla {
+namespace binary_dump {
+namespace {
+
+template <typename T>
+void AppendArray(const T* data, size_t count, std::string* out) {
+  out->append(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+void AppendPadding(std::string* out) {
+  out->resize(PaddedSize(out->size()), '\0');
+}
+
+std::string MakeRecord(RecordKind kind, const std::string& payload) {
+  RecordHeader header = {kRecordMagic, kind, payload.size()};
+  std::string record;
+  record.reserve(sizeof(header) + payload.size());
+  AppendArray(&header, 1, &record);
+  record.append(payload);
+  return record;
+}
+
+// Returns a pointer to `count` objects of type T at `*offset` in `data` and
+// advances the offset past them, or nullptr if `data` is too short.
+template <typename T>
+const T* Consume(std::string_view data, size_t count, size_t* offset) {
+  if (count > data.size() / sizeof(T) ||
+      data.size() - *offset < PaddedSize(count * sizeof(T))) {
+    return nullptr;
+  }
+  const T* ptr = reinterpret_cast<const T*>(data.data() + *offset);
+  *offset += PaddedSize(count * sizeof(T));
+  return ptr;
+}
+
+}  // namespace
+
+std::string FileHeaderBytes() {
+  FileHeader header = {};
+  std::memcpy(header.magic, kFileMagic, sizeof(header.magic));
+  header.version = kVersion;
+  std::string bytes;
+  AppendArray(&header, 1, &bytes);
+  return bytes;
+}
+
+std::string GraphHashRecord(uint64_t hash_low, uint64_t hash_high) {
+  GraphHashEntry entry = {hash_low, hash_high};
+  std::string payload;
+  AppendArray(&entry, 1, &payload);
+  return MakeRecord(kGraphHash, payload);
+}
+
+uint32_t GraphBuilder::AddString(std::string_view str) {
+  auto it = string_ids_.emplace(std::string(str), offsets_.size() - 1);
+  if (it.second) {
+    strings_.append(str);
+    offsets_.push_back(strings_.size());
+  }
+  return it.first->second;
+}
+
+uint32_t GraphBuilder::AddNode(NodeEntry entry) {
+  entry.operands_begin = operands_.size();
+  entry.num_operands = 0;
+  nodes_.push_back(entry);
+  return nodes_.size() - 1;
+}
+
+void GraphBuilder::AddOperand(uint32_t node, uint32_t index) {
+  operands_.push_back({node, index});
+  nodes_.back().num_operands += 1;
+}
+
+std::string GraphBuilder::Finish(std::string_view name,
+                                 std::string_view frames) {
+  GraphHeader header = {};
+  header.name = AddString(name);
+  header.frames = AddString(frames);
+  header.num_nodes = nodes_.size();
+  header.num_operands = operands_.size();
+  header.num_roots = roots_.size();
+  header.num_strings = offsets_.size() - 1;
+
+  std::string payload;
+  AppendArray(&header, 1, &payload);
+  AppendArray(nodes_.data(), nodes_.size(), &payload);
+  AppendArray(operands_.data(), operands_.size(), &payload);
+  AppendArray(roots_.data(), roots_.size(), &payload);
+  AppendPadding(&payload);
+  AppendArray(offsets_.data(), offsets_.size(), &payload);
+  payload.append(strings_);
+  AppendPadding(&payload);
+  return MakeRecord(kGraph, payload);
+}
+
+bool GraphView::Parse(std::string_view payload) {
+  size_t offset = 0;
+  header_ = Consume<GraphHeader>(payload, 1, &offset);
+  if (header_ == nullptr) {
+    return false;
+  }
+  nodes_ = Consume<NodeEntry>(payload, header_->num_nodes, &offset);
+  operands_ = Consume<OperandEntry>(payload, header_->num_operands, &offset);
+  roots_ = Consume<uint32_t>(payload, header_->num_roots, &offset);
+  offsets_ = Consume<uint64_t>(payload, header_->num_strings + 1, &offset);
+  if (nodes_ == nullptr || operands_ == nullptr || roots_ == nullptr ||
+      offsets_ == nullptr ||
+      payload.size() - offset < offsets_[header_->num_strings]) {
+    return false;
+  }
+  strings_ = payload.data() + offset;
+  return true;
+}
+
+std::string_view GraphView::string(uint32_t id) const {
+  if (id >= header_->num_strings) {
+    return std::string_view();
+  }
+  return std::string_view(strings_ + offsets_[id],
+                          offsets_[id + 1] - offsets_[id]);
+}
+
+Reader::Reader(std::string_view data) : data_(data) {
+  const FileHeader* header =
+      reinterpret_cast<const FileHeader*>(data_.data());
+  ok_ = data_.size() >= sizeof(FileHeader) &&
+        std::memcmp(header->magic, kFileMagic, sizeof(kFileMagic)) == 0 &&
+        header->version == kVersion;
+}
+
+bool Reader::Next(RecordHeader* header, std::string_view* payload) {
+  if (!ok_ || data_.size() - offset_ < sizeof(RecordHeader)) {
+    return false;
+  }
+  std::memcpy(header, data_.data() + offset_, sizeof(RecordHeader));
+  size_t available = data_.size() - offset_ - sizeof(RecordHeader);
+  if (header->magic != kRecordMagic || header->payload_size > available) {
+    return false;
+  }
+  *payload = data_.substr(offset_ + sizeof(RecordHeader), header->payload_size);
+  offset_ += sizeof(RecordHeader) + header->payload_size;
+  return true;
+}
+
+}  // namespace binary_dump
+}  // namespace torch_xla
@@ -0,0 +1,177 @@
+#ifndef XLA_TORCH_XLA_CSRC_IR_BINARY_DUMP_H_
+#define XLA_TORCH_XLA_CSRC_IR_BINARY_DUMP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace torch_xla {
+
+// The binary graph dump format, written with XLA_SAVE_TENSORS_FMT=binary. The
+// file is a FileHeader followed by records appended one after the other. All
+// the fields are little endian and every struct is 8 bytes aligned, so that a
+// reader can mmap() the file and point the structs into it without copying.
+// The Python reader is torch_xla.debug.graph_dump.
+//
+// A kGraph record payload is laid out as:
+//   GraphHeader
+//   NodeEntry[num_nodes]           (post order, operands before their users)
+//   OperandEntry[num_operands]     (NodeEntry::operands_begin indexes these)
+//   uint32_t roots[num_roots]      (node indices, padded to 8 bytes)
+//   uint64_t offsets[num_strings + 1]
+//   char strings[offsets[num_strings]]   (padded to 8 bytes)
+// String id i is the bytes in [offsets[i], offsets[i + 1]) of strings, and
+// equal strings share their id within a graph.
+// A kGraphHash record payload is a GraphHashEntry, with the hash of the graph
+// lowered from the previous kGraph record.
+namespace binary_dump {
+
+constexpr char kFileMagic[8] = {'P', 'T', 'X', 'L', 'A', 'I', 'R', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kRecordMagic = 0x52495850;  // "PXIR"
+
+enum RecordKind : uint32_t {
+  kGraph = 1,
+  kGraphHash = 2,
+};
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t kind;
+  // The size of the payload following the header, a multiple of 8.
+  uint64_t payload_size;
+};
+
+struct GraphHeader {
+  // The string ids of the name of the dump site and of the Python frames which
+  // triggered the dump, one per line.
+  uint32_t name;
+  uint32_t frames;
+  uint64_t num_nodes;
+  uint64_t num_operands;
+  uint64_t num_roots;
+  uint64_t num_strings;
+};
+
+struct NodeEntry {
+  uint64_t hash_low;
+  uint64_t hash_high;
+  // The string ids of the op name, the XLA shape, the ToString() of the node
+  // and the innermost Python frame which created it ("file:line function").
+  uint32_t op;
+  uint32_t shape;
+  uint32_t text;
+  uint32_t location;
+  uint32_t operands_begin;
+  uint32_t num_operands;
+  uint32_t num_outputs;
+  uint32_t reserved;
+};
+
+struct OperandEntry {
+  uint32_t node;
+  uint32_t index;
+};
+
+struct GraphHashEntry {
+  uint64_t hash_low;
+  uint64_t hash_high;
+};
+
+static_assert(sizeof(FileHeader) == 16, "");
+static_assert(sizeof(RecordHeader) == 16, "");
+static_assert(sizeof(GraphHeader) == 40, "");
+static_assert(sizeof(NodeEntry) == 48, "");
+static_assert(sizeof(OperandEntry) == 8, "");
+static_assert(sizeof(GraphHashEntry) == 16, "");
+
+inline size_t PaddedSize(size_t size) { return (size + 7) & ~size_t{7}; }
+
+// Returns the FileHeader bytes, to be written before the first record.
+std::string FileHeaderBytes();
+
+// Returns a record with a GraphHashEntry payload.
+std::string GraphHashRecord(uint64_t hash_low, uint64_t hash_high);
+
+// Builds a kGraph record. The nodes must be added in post order, each followed
+// by its operands.
+class GraphBuilder {
+ public:
+  // Returns the id of `str`, adding it to the string table if new.
+  uint32_t AddString(std::string_view str);
+
+  // Adds `entry`, whose operands_begin and num_operands are filled as the
+  // operands are added, and returns its index.
+  uint32_t AddNode(NodeEntry entry);
+
+  void AddOperand(uint32_t node, uint32_t index);
+
+  void AddRoot(uint32_t node) { roots_.push_back(node); }
+
+  // Returns the record bytes, header included.
+  std::string Finish(std::string_view name, std::string_view frames);
+
+ private:
+  std::vector<NodeEntry> nodes_;
+  std::vector<OperandEntry> operands_;
+  std::vector<uint32_t> roots_;
+  std::vector<uint64_t> offsets_ = {0};
+  std::string strings_;
+  std::unordered_map<std::string, uint32_t> string_ids_;
+};
+
+// A view over the payload of a kGraph record. The view points into the
+// payload, which must outlive it.
+class GraphView {
+ public:
+  // Returns false if the payload is too short for the counts in its header.
+  bool Parse(std::string_view payload);
+
+  const GraphHeader& header() const { return *header_; }
+  const NodeEntry& node(size_t i) const { return nodes_[i]; }
+  const OperandEntry& operand(size_t i) const { return operands_[i]; }
+  uint32_t root(size_t i) const { return roots_[i]; }
+  std::string_view string(uint32_t id) const;
+
+ private:
+  const GraphHeader* header_ = nullptr;
+  const NodeEntry* nodes_ = nullptr;
+  const OperandEntry* operands_ = nullptr;
+  const uint32_t* roots_ = nullptr;
+  const uint64_t* offsets_ = nullptr;
+  const char* strings_ = nullptr;
+};
+
+// Iterates the records of a dump file held in `data`, typically an mmap() of
+// the file. Reading stops at the first truncated or corrupted record, so a
+// file still being appended to can be read safely.
+class Reader {
+ public:
+  explicit Reader(std::string_view data);
+
+  // Whether `data` starts with a valid file header of a supported version.
+  bool ok() const { return ok_; }
+
+  // Reads the next record into `header` and `payload`, and returns false at
+  // the end of the records.
+  bool Next(RecordHeader* header, std::string_view* payload);
+
+ private:
+  std::string_view data_;
+  size_t offset_ = sizeof(FileHeader);
+  bool ok_ = false;
+};
+
+}  // namespace binary_dump
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_IR_BINARY_DUMP_H_
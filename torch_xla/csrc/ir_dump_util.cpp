@@ -7,7 +7,9 @@
 #include <unordered_map>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/optional.h"
+#include "torch_xla/csrc/ir_binary_dump.h"
 #include "torch_xla/csrc/lowering_context.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/runtime.h"
@@ -252,6 +254,49 @@ std::string DumpUtil::PostOrderToText(
   return ss.str();
 }
 
+std::string DumpUtil::ToBinary(absl::Span<const torch::lazy::Node* const> nodes,
+                               const std::string& name,
+                               const std::string& frames) {
+  auto post_order = torch::lazy::Util::ComputePostOrder(
+      c10::makeArrayRef(nodes.data(), nodes.size()));
+  return PostOrderToBinary(post_order, nodes, name, frames);
+}
+
+std::string DumpUtil::PostOrderToBinary(
+    absl::Span<const torch::lazy::Node* const> post_order,
+    absl::Span<const torch::lazy::Node* const> roots, const std::string& name,
+    const std::string& frames) {
+  NodeIdMap id_map = GenerateIdMap(post_order);
+  binary_dump::GraphBuilder builder;
+  for (auto node : post_order) {
+    const XlaNode* casted = dynamic_cast<const XlaNode*>(node);
+    std::vector<torch::lazy::SourceLocation> node_frames =
+        GetNodeFrames(node);
+    std::string location;
+    if (!node_frames.empty()) {
+      location = absl::StrCat(node_frames.front().file, ":",
+                              node_frames.front().line, " ",
+                              node_frames.front().function);
+    }
+    binary_dump::NodeEntry entry = {};
+    entry.hash_low = c10::Uint128Low64(node->hash());
+    entry.hash_high = c10::Uint128High64(node->hash());
+    entry.op = builder.AddString(node->op().ToString());
+    entry.shape = builder.AddString(casted->xla_shape().ToString());
+    entry.text = builder.AddString(node->ToString());
+    entry.location = builder.AddString(location);
+    entry.num_outputs = node->num_outputs();
+    builder.AddNode(entry);
+    for (auto& output : node->operands()) {
+      builder.AddOperand(id_map.at(output.node), output.index);
+    }
+  }
+  for (auto root : roots) {
+    builder.AddRoot(id_map.at(root));
+  }
+  return builder.Finish(name, frames);
+}
+
 std::string DumpUtil::ToHlo(c10::ArrayRef<torch::lazy::Value> values,
                             const torch::lazy::BackendDevice& device,
                             EmitMode mode) {
@@ -287,6 +332,8 @@ std::string DumpUtil::ToHlo(c10::ArrayRef<torch::lazy::Value> values,
   switch (mode) {
     case EmitMode::kHloReadable:
       return ConsumeValue(runtime::util::GetComputationHloText(computation));
+    case EmitMode::kHloProto:
+      return computation.proto().SerializeAsString();
     case EmitMode::kStableHloReadable:
       return hloToStablehlo(&computation.proto(),
                             /* emit_bytecode = */ false);
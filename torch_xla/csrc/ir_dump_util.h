@@ -12,6 +12,8 @@ namespace torch_xla {
 
 enum class EmitMode {
   kHloReadable,
+  // The serialized HloModuleProto.
+  kHloProto,
   kStableHloReadable,
   kStableHloBytecode,
 };
@@ -30,6 +32,18 @@ class DumpUtil {
       absl::Span<const torch::lazy::Node* const> post_order,
       absl::Span<const torch::lazy::Node* const> roots);
 
+  // Returns a kGraph record of the binary dump format (see ir_binary_dump.h)
+  // of the graph, with the name of the dump site and the Python frames which
+  // triggered it.
+  static std::string ToBinary(absl::Span<const torch::lazy::Node* const> nodes,
+                              const std::string& name,
+                              const std::string& frames);
+
+  static std::string PostOrderToBinary(
+      absl::Span<const torch::lazy::Node* const> post_order,
+      absl::Span<const torch::lazy::Node* const> roots, const std::string& name,
+      const std::string& frames);
+
   static std::string ToHlo(c10::ArrayRef<torch::lazy::Value> values,
                            const torch::lazy::BackendDevice& device,
                            EmitMode mode = EmitMode::kHloReadable);
@@ -176,6 +176,20 @@ xla::Shape MakeTorchTensorLayout(absl::Span<const int64_t> dimensions,
   return shape;
 }
 
+xla::Shape MakeTorchTensorLayoutFromStrides(
+    absl::Span<const int64_t> dimensions, absl::Span<const int64_t> strides,
+    xla::PrimitiveType type) {
+  XLA_CHECK_EQ(dimensions.size(), strides.size());
+  // On equal strides, which only size 1 dimensions share with others, the
+  // later dimension is the more minor one, as in the descending layout.
+  std::vector<int64_t> layout =
+      torch::lazy::Iota<int64_t>(dimensions.size(), dimensions.size() - 1, -1);
+  std::stable_sort(layout.begin(), layout.end(), [&](int64_t a, int64_t b) {
+    return strides[a] < strides[b];
+  });
+  return xla::ShapeUtil::MakeShapeWithDenseLayout(type, dimensions, layout);
+}
+
 xla::Shape MakeArrayShapeFromDimensions(
     absl::Span<const int64_t> dimensions,
     absl::Span<const bool> dynamic_dimensions, xla::PrimitiveType type,
@@ -191,4 +205,10 @@ xla::Shape MakeArrayShapeFromDimensions(
   return MakeTorchTensorLayout(dimensions, dynamic_dimensions, type);
 }
 
+bool UseAutoParameterLayouts() {
+  static const bool use_auto_layouts =
+      runtime::sys_util::GetEnvBool("XLA_AUTO_PARAMETER_LAYOUTS", false);
+  return use_auto_layouts;
+}
+
 }  // namespace torch_xla
@@ -14,6 +14,12 @@ xla::Shape MakeTorchTensorLayout(absl::Span<const int64_t> dimensions,
                                  absl::Span<const bool> dynamic_dimensions,
                                  xla::PrimitiveType type);
 
+// Creates the layout of a dense torch tensor of the given dimensions and
+// strides, the dimensions with the smaller strides being the more minor ones.
+xla::Shape MakeTorchTensorLayoutFromStrides(
+    absl::Span<const int64_t> dimensions, absl::Span<const int64_t> strides,
+    xla::PrimitiveType type);
+
 // Create an XLA shape with the given dimensions and type, suitable to be used
 // in the specified device type. The type of device can affect the choice of the
 // XLA layout. The dynamic_dimensions slice should be either empty, or of the
@@ -23,6 +29,11 @@ xla::Shape MakeArrayShapeFromDimensions(
     absl::Span<const bool> dynamic_dimensions, xla::PrimitiveType type,
     XlaDeviceType hw_type);
 
+// Whether the compiler chooses the device layouts of the parameters donated to
+// the outputs of a graph, which hold the state kept across steps, rather than
+// reading them in the layouts above (XLA_AUTO_PARAMETER_LAYOUTS).
+bool UseAutoParameterLayouts();
+
 }  // namespace torch_xla
 
 #endif  // XLA_TORCH_XLA_CSRC_LAYOUT_MANAGER_H_
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <torch/csrc/lazy/core/ir_metadata.h>
 
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <string_view>
@@ -18,6 +19,7 @@
 #include "torch_xla/csrc/shape_helper.h"
 #include "torch_xla/csrc/stack_frame_index_builder.h"
 #include "torch_xla/csrc/unwrap_data.h"
+#include "xla/shape_util.h"
 
 namespace torch_xla {
 
@@ -62,7 +64,7 @@ class HloMetadataSetter {
         dynamic_cast<const CustomOpNameMetaData*>(node->user_metadata());
 
     std::string op_name_prefix;
-    size_t max_stack_depth = nmeta.frame_info.size();
+    int max_stack_depth = std::numeric_limits<int>::max();
 
     if (custom_opname_meta != nullptr) {
       op_name_prefix = custom_opname_meta->op_name_prefix;
@@ -76,8 +78,14 @@ class HloMetadataSetter {
     metadata.set_op_name(absl::StrCat(op_name_prefix, op_type));
 
     // Sets file, line and stack_frame_id in metadata
-    loctx->stack_frame_index_builder()->AddStackFrameLocations(
-        nmeta.frame_info, max_stack_depth, metadata);
+    const XlaNode* xla_node = dynamic_cast<const XlaNode*>(node);
+    if (xla_node != nullptr) {
+      loctx->stack_frame_index_builder()->AddStackFrameLocations(
+          xla_node->frame_stack(), max_stack_depth, metadata);
+    } else {
+      loctx->stack_frame_index_builder()->AddStackFrameLocations(
+          nmeta.frame_info, max_stack_depth, metadata);
+    }
 
     loctx->builder()->SetOpMetadata(std::move(metadata));
   }
@@ -114,6 +122,8 @@ xla::XlaOp LoweringContext::GetParameter(
   torch::lazy::BackendData::Handle handle = data->GetHandle();
   auto it = parameters_map_.find(handle);
   if (it == parameters_map_.end()) {
+    XLA_CHECK(!has_tupled_parameters())
+        << "Parameter data missing from the tupled parameters";
     xla::Shape shape =
         std::dynamic_pointer_cast<runtime::ComputationClient::Data>(data)
             ->shape();
@@ -131,10 +141,42 @@ xla::XlaOp LoweringContext::GetParameter(
         << "The unbounded dynamic dims can only be set when Parameter is "
            "created.";
   }
+  if (!it->second.param.valid()) {
+    // The elements of the tuple parameter are extracted on first use.
+    it->second.param =
+        xla::GetTupleElement(tuple_parameter_, it->second.index);
+  }
   parameter_sequence_.push_back(it->second.index);
   return it->second.param;
 }
 
+void LoweringContext::SetTupledParameters(
+    absl::Span<const torch::lazy::BackendDataPtr> parameters_data) {
+  XLA_CHECK(parameters_.empty())
+      << "Tupled parameters set after parameters were created";
+  std::vector<xla::Shape> shapes;
+  shapes.reserve(parameters_data.size());
+  for (const torch::lazy::BackendDataPtr& data : parameters_data) {
+    shapes.push_back(
+        std::dynamic_pointer_cast<runtime::ComputationClient::Data>(data)
+            ->shape());
+    parameters_map_.emplace(data->GetHandle(),
+                            Parameter{xla::XlaOp(), parameters_.size()});
+    parameters_.push_back(data);
+  }
+  tuple_parameter_ = xla::Parameter(
+      builder(), 0, xla::ShapeUtil::MakeTupleShape(shapes), "in");
+}
+
+void LoweringContext::AddBufferDonor(size_t index) {
+  if (has_tupled_parameters()) {
+    builder_.AddBufferDonor(/*param_number=*/0,
+                            /*param_index=*/xla::ShapeIndex({index}));
+  } else {
+    builder_.AddBufferDonor(/*param_number=*/index, /*param_index=*/{});
+  }
+}
+
 const std::vector<torch::lazy::BackendDataPtr>&
 LoweringContext::GetParametersData() const {
   return parameters_;
@@ -255,7 +297,7 @@ void LoweringContext::ReportBuilderError(const torch::lazy::Node* node,
   if (!nmeta.scope.empty()) {
     ss << "Scope: " << nmeta.scope << "\n";
   }
-  ss << nmeta.frame_info;
+  ss << GetNodeFrames(node);
   throw std::runtime_error(ss.str());
 }
 
@@ -57,6 +57,18 @@ class LoweringContext : public torch::lazy::LoweringContext {
 
   const std::vector<size_t>& GetParameterSequence() const;
 
+  // Declares a single tuple parameter with an element per data, in order, so
+  // that GetParameter() returns its elements instead of creating one parameter
+  // per data. Must be called before any parameter is created.
+  void SetTupledParameters(
+      absl::Span<const torch::lazy::BackendDataPtr> parameters_data);
+
+  bool has_tupled_parameters() const { return tuple_parameter_.valid(); }
+
+  // Marks the parameter at `index` of GetParametersData() as a buffer donor,
+  // that is an element of the tuple parameter when they are tupled.
+  void AddBufferDonor(size_t index);
+
   xla::XlaOp GetResult(size_t index) const;
 
   void SetResult(size_t index, xla::XlaOp op);
@@ -123,6 +135,7 @@ class LoweringContext : public torch::lazy::LoweringContext {
   xla::XlaBuilder builder_;
   std::unordered_map<torch::lazy::BackendData::Handle, Parameter>
       parameters_map_;
+  xla::XlaOp tuple_parameter_;
   std::vector<xla::XlaOp> root_tuple_;
   OutputMap<xla::XlaOp> emitted_outputs_;
   std::string name_;
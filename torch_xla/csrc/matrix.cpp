@@ -1,17 +1,110 @@
 #include "torch_xla/csrc/matrix.h"
 
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <numeric>
+#include <vector>
+
 #include "torch_xla/csrc/convert_ops.h"
 #include "torch_xla/csrc/helpers.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/shape_helper.h"
 #include "xla/client/lib/constants.h"
 #include "xla/client/lib/matrix.h"
 #include "xla/client/lib/qr.h"
+#include "xla/primitive_util.h"
 #include "xla/shape_util.h"
 #include "xla/util.h"
 
 namespace torch_xla {
 namespace {
 
+// The [..., 1, 1] elements of the square matrices of small sizes, indexed by
+// row and column.
+using MatrixElements = std::vector<std::vector<xla::XlaOp>>;
+
+MatrixElements SliceElements(xla::XlaOp input) {
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
+  int64_t rank = shape.rank();
+  int64_t size = shape.dimensions(rank - 1);
+  MatrixElements elements(size);
+  for (int64_t i = 0; i < size; ++i) {
+    xla::XlaOp row = xla::SliceInDim(input, i, i + 1, 1, rank - 2);
+    for (int64_t j = 0; j < size; ++j) {
+      elements[i].push_back(xla::SliceInDim(row, j, j + 1, 1, rank - 1));
+    }
+  }
+  return elements;
+}
+
+xla::XlaOp ConcatElements(const MatrixElements& elements, int64_t rank) {
+  xla::XlaBuilder* builder = elements.front().front().builder();
+  std::vector<xla::XlaOp> rows;
+  for (const std::vector<xla::XlaOp>& row : elements) {
+    rows.push_back(xla::ConcatInDim(builder, row, rank - 1));
+  }
+  return xla::ConcatInDim(builder, rows, rank - 2);
+}
+
+// The elements without the ones of `row` and `column`.
+MatrixElements Minor(const MatrixElements& elements, size_t row,
+                     size_t column) {
+  MatrixElements minor;
+  for (size_t i = 0; i < elements.size(); ++i) {
+    if (i == row) {
+      continue;
+    }
+    minor.emplace_back();
+    for (size_t j = 0; j < elements.size(); ++j) {
+      if (j != column) {
+        minor.back().push_back(elements[i][j]);
+      }
+    }
+  }
+  return minor;
+}
+
+// The determinant, by cofactor expansion along the first row.
+xla::XlaOp Determinant(const MatrixElements& elements) {
+  if (elements.size() == 1) {
+    return elements[0][0];
+  }
+  if (elements.size() == 2) {
+    return elements[0][0] * elements[1][1] - elements[0][1] * elements[1][0];
+  }
+  xla::XlaOp determinant;
+  for (size_t j = 0; j < elements.size(); ++j) {
+    xla::XlaOp term = elements[0][j] * Determinant(Minor(elements, 0, j));
+    determinant =
+        j == 0 ? term : (j % 2 == 0 ? determinant + term : determinant - term);
+  }
+  return determinant;
+}
+
+// The inverse of the small matrices of `input`, as their adjugate divided by
+// their determinant.
+xla::XlaOp BuildSmallInverse(xla::XlaOp input) {
+  int64_t rank = ShapeHelper::ShapeOfXlaOp(input).rank();
+  MatrixElements elements = SliceElements(input);
+  xla::XlaOp inverse_determinant =
+      xla::One(input.builder(),
+               ShapeHelper::ShapeOfXlaOp(input).element_type()) /
+      Determinant(elements);
+  if (elements.size() == 1) {
+    return inverse_determinant;
+  }
+  MatrixElements inverse(elements.size());
+  for (size_t i = 0; i < elements.size(); ++i) {
+    for (size_t j = 0; j < elements.size(); ++j) {
+      xla::XlaOp cofactor = Determinant(Minor(elements, j, i));
+      inverse[i].push_back((i + j) % 2 == 0
+                               ? cofactor * inverse_determinant
+                               : xla::Neg(cofactor) * inverse_determinant);
+    }
+  }
+  return ConcatElements(inverse, rank);
+}
+
 struct DiagonalMask {
   xla::XlaOp source;
   xla::XlaOp mask;
@@ -127,7 +220,62 @@ xla::XlaOp BuildDiagonalViewUpdate(xla::XlaOp target, xla::XlaOp input,
   return result;
 }
 
+bool IsSmallMatrix(const xla::Shape& shape) {
+  static const int64_t max_size =
+      runtime::sys_util::GetEnvInt("XLA_SMALL_MATRIX_MAX_SIZE", 4);
+  int64_t rank = shape.rank();
+  return rank >= 2 &&
+         xla::primitive_util::IsFloatingPointType(shape.element_type()) &&
+         shape.dimensions(rank - 1) == shape.dimensions(rank - 2) &&
+         shape.dimensions(rank - 1) > 0 &&
+         shape.dimensions(rank - 1) <= max_size;
+}
+
+xla::XlaOp BuildSmallTriangularSolve(xla::XlaOp a, xla::XlaOp b,
+                                     bool left_side, bool lower,
+                                     bool transpose, bool unit_diagonal) {
+  TORCH_LAZY_COUNTER("SmallMatrixLowerings", 1);
+  // The right side systems x op(a) = b are solved as op(a)^T x^T = b^T.
+  if (transpose) {
+    a = xla::TransposeInMinorDims(a);
+    lower = !lower;
+  }
+  if (!left_side) {
+    a = xla::TransposeInMinorDims(a);
+    b = xla::TransposeInMinorDims(b);
+    lower = !lower;
+  }
+  int64_t rank = ShapeHelper::ShapeOfXlaOp(b).rank();
+  MatrixElements elements = SliceElements(a);
+  int64_t size = elements.size();
+  // Substitutes the rows of the solution in order, forward for the lower
+  // triangular systems and backward for the upper ones.
+  std::vector<int64_t> row_dims = XlaHelpers::SizesOfXlaOp(b);
+  row_dims[rank - 2] = 1;
+  std::vector<int64_t> broadcast_dims(rank);
+  std::iota(broadcast_dims.begin(), broadcast_dims.end(), 0);
+  auto element = [&](int64_t i, int64_t j) {
+    return xla::BroadcastInDim(elements[i][j], row_dims, broadcast_dims);
+  };
+  std::vector<xla::XlaOp> rows(size);
+  for (int64_t k = 0; k < size; ++k) {
+    int64_t i = lower ? k : size - 1 - k;
+    xla::XlaOp row = xla::SliceInDim(b, i, i + 1, 1, rank - 2);
+    for (int64_t l = 0; l < k; ++l) {
+      int64_t j = lower ? l : size - 1 - l;
+      row = row - element(i, j) * rows[j];
+    }
+    rows[i] = unit_diagonal ? row : row / element(i, i);
+  }
+  xla::XlaOp solution = xla::ConcatInDim(b.builder(), rows, rank - 2);
+  return left_side ? solution : xla::TransposeInMinorDims(solution);
+}
+
 xla::XlaOp BuildInverse(xla::XlaOp input) {
+  if (IsSmallMatrix(ShapeHelper::ShapeOfXlaOp(input))) {
+    TORCH_LAZY_COUNTER("SmallMatrixLowerings", 1);
+    return BuildSmallInverse(input);
+  }
   xla::XlaOp q, r;
   xla::QrExplicit(input, /*full_matrices=*/false, q, r);
 
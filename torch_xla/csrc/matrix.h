@@ -15,6 +15,21 @@ xla::XlaOp BuildDiagonal(xla::XlaOp input, int64_t offset, int64_t dim1,
 xla::XlaOp BuildDiagonalViewUpdate(xla::XlaOp target, xla::XlaOp input,
                                    int64_t offset, int64_t dim1, int64_t dim2);
 
+// Whether the square matrices of `shape` are small enough, up to
+// XLA_SMALL_MATRIX_MAX_SIZE rows, for the unrolled lowerings which, unlike the
+// generic XLA routines, have no loop over the rows and the columns. They win
+// on the large batches of tiny matrices, like the 3x3 and 4x4 transforms.
+bool IsSmallMatrix(const xla::Shape& shape);
+
+// Solves the triangular systems op(a) x = b (x op(a) = b if not `left_side`)
+// of the small matrices `a`, of the same batch dimensions as `b`, by unrolled
+// substitution.
+xla::XlaOp BuildSmallTriangularSolve(xla::XlaOp a, xla::XlaOp b,
+                                     bool left_side, bool lower,
+                                     bool transpose, bool unit_diagonal);
+
+// The small matrices are inverted in closed form, as their adjugate divided by
+// their determinant, the other ones from their QR decomposition.
 xla::XlaOp BuildInverse(xla::XlaOp input);
 
 }  // namespace torch_xla
@@ -1,12 +1,18 @@
 #include "torch_xla/csrc/nll_loss.h"
 
+#include <algorithm>
+
 #include "absl/types/span.h"
 #include "torch_xla/csrc/data_ops.h"
 #include "torch_xla/csrc/helpers.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/shape_helper.h"
 #include "torch_xla/csrc/tensor_util.h"
 #include "xla/client/lib/constants.h"
+#include "xla/client/lib/loops.h"
 #include "xla/client/lib/math.h"
+#include "xla/client/lib/slicing.h"
+#include "xla/util.h"
 
 namespace torch_xla {
 namespace {
@@ -107,6 +113,35 @@ WeightScale GetMaskedWeight(xla::XlaOp weight, const xla::Shape& logits_shape,
   return {result_weight, scale};
 }
 
+// Pads the classes of the [N, C] "logits" with the lowest value, up to a
+// multiple of "chunk_size", so that they have no weight in the softmax.
+xla::XlaOp PadClassesToChunks(xla::XlaOp logits, int64_t chunk_size) {
+  const xla::Shape& logits_shape = ShapeHelper::ShapeOfXlaOp(logits);
+  int64_t num_classes = logits_shape.dimensions(1);
+  int64_t padded_classes =
+      xla::CeilOfRatio(num_classes, chunk_size) * chunk_size;
+  return xla::PadInDim(
+      logits, xla::MinValue(logits.builder(), logits_shape.element_type()),
+      /*dimno=*/1, /*pad_lo=*/0, /*pad_hi=*/padded_classes - num_classes);
+}
+
+// The F32 [N, chunk_size] chunk of classes of the padded "logits" starting at
+// the S32 "start".
+xla::XlaOp GetClassChunk(xla::XlaOp logits, xla::XlaOp start,
+                         int64_t chunk_size) {
+  return xla::ConvertElementType(
+      xla::DynamicSliceInMinorDims(logits, {start}, {chunk_size}),
+      xla::PrimitiveType::F32);
+}
+
+// The F32 [N] mask of the "labels" which are not "ignore_index".
+xla::XlaOp GetValidLabels(xla::XlaOp labels, int ignore_index) {
+  xla::XlaOp ignore_index_op = XlaHelpers::ScalarValue<int64_t>(
+      ignore_index, XlaHelpers::TypeOfXlaOp(labels), labels.builder());
+  return xla::ConvertElementType(xla::Ne(labels, ignore_index_op),
+                                 xla::PrimitiveType::F32);
+}
+
 }  // namespace
 
 // Builds the NLLLoss for log-probabilities "logits" and class indices "labels".
@@ -190,4 +225,138 @@ xla::XlaOp BuildNllLossBackward(xla::XlaOp grad_output, xla::XlaOp logits,
   return result / weight_scale.scale;
 }
 
+CrossEntropyResult BuildChunkedCrossEntropy(xla::XlaOp logits,
+                                            xla::XlaOp labels, int ignore_index,
+                                            ReductionMode reduction_mode,
+                                            int64_t chunk_size) {
+  xla::XlaBuilder* builder = logits.builder();
+  const xla::Shape& logits_shape = ShapeHelper::ShapeOfXlaOp(logits);
+  XLA_CHECK_EQ(logits_shape.rank(), 2) << logits_shape;
+  int64_t batch = logits_shape.dimensions(0);
+  int64_t num_classes = logits_shape.dimensions(1);
+  chunk_size = std::min(chunk_size, num_classes);
+  int64_t num_chunks = xla::CeilOfRatio(num_classes, chunk_size);
+
+  // The loop values are the padded logits and the running maximum and sum of
+  // the exponentials of the rows.
+  auto body_fn = [&](xla::XlaOp i, absl::Span<const xla::XlaOp> values,
+                     xla::XlaBuilder* body_builder)
+      -> absl::StatusOr<std::vector<xla::XlaOp>> {
+    xla::XlaOp start = i * xla::ConstantR0<int32_t>(body_builder, chunk_size);
+    xla::XlaOp chunk = GetClassChunk(values[0], start, chunk_size);
+    xla::XlaOp row_max = values[1];
+    xla::XlaOp new_max = xla::Max(
+        row_max,
+        xla::Reduce(chunk, xla::MinValue(body_builder, xla::PrimitiveType::F32),
+                    XlaHelpers::CreateMaxComputation(xla::PrimitiveType::F32),
+                    {1}));
+    xla::XlaOp exps = xla::Exp(
+        chunk - xla::BroadcastInDim(new_max, {batch, chunk_size}, {0}));
+    xla::XlaOp row_sum =
+        values[2] * xla::Exp(row_max - new_max) +
+        xla::Reduce(exps, xla::Zero(body_builder, xla::PrimitiveType::F32),
+                    XlaHelpers::CreateAddComputation(xla::PrimitiveType::F32),
+                    {1});
+    return std::vector<xla::XlaOp>{values[0], new_max, row_sum};
+  };
+  xla::XlaOp zero = xla::Zero(builder, xla::PrimitiveType::F32);
+  std::vector<xla::XlaOp> results = ConsumeValue(xla::ForEachIndex(
+      num_chunks, xla::PrimitiveType::S32, body_fn,
+      {PadClassesToChunks(logits, chunk_size),
+       xla::Broadcast(xla::MinValue(builder, xla::PrimitiveType::F32), {batch}),
+       xla::Broadcast(zero, {batch})},
+      "ChunkedCrossEntropy", builder));
+  xla::XlaOp logsumexp = results[1] + xla::Log(results[2]);
+
+  xla::XlaOp valid = GetValidLabels(labels, ignore_index);
+  xla::XlaOp safe_labels = xla::Select(
+      xla::Ne(valid, xla::ZerosLike(valid)), labels, xla::ZerosLike(labels));
+  xla::XlaOp labeled_logits = xla::TorchGather(
+      logits, xla::Reshape(safe_labels, {batch, 1}), /*dim=*/1,
+      /*sparse=*/false);
+  labeled_logits = xla::ConvertElementType(
+      xla::Reshape(labeled_logits, {batch}), xla::PrimitiveType::F32);
+  xla::XlaOp losses = (logsumexp - labeled_logits) * valid;
+  xla::XlaComputation add_func =
+      XlaHelpers::CreateAddComputation(xla::PrimitiveType::F32);
+  xla::XlaOp loss = losses;
+  if (reduction_mode != ReductionMode::kNone) {
+    loss = xla::ReduceAll(losses, zero, add_func);
+  }
+  if (reduction_mode == ReductionMode::kMean) {
+    loss = loss / xla::ReduceAll(valid, zero, add_func);
+  }
+  return {xla::ConvertElementType(loss, logits_shape.element_type()),
+          logsumexp};
+}
+
+xla::XlaOp BuildChunkedCrossEntropyBackward(xla::XlaOp grad_output,
+                                            xla::XlaOp logits,
+                                            xla::XlaOp labels,
+                                            xla::XlaOp logsumexp,
+                                            int ignore_index,
+                                            ReductionMode reduction_mode,
+                                            int64_t chunk_size) {
+  xla::XlaBuilder* builder = logits.builder();
+  const xla::Shape& logits_shape = ShapeHelper::ShapeOfXlaOp(logits);
+  int64_t batch = logits_shape.dimensions(0);
+  int64_t num_classes = logits_shape.dimensions(1);
+  chunk_size = std::min(chunk_size, num_classes);
+
+  // The gradient of the loss of every row, zero for the ignored ones.
+  xla::XlaOp valid = GetValidLabels(labels, ignore_index);
+  xla::XlaOp grad =
+      xla::ConvertElementType(grad_output, xla::PrimitiveType::F32);
+  if (reduction_mode == ReductionMode::kMean) {
+    // When all the labels are ignored the gradient is zero, not NaN.
+    xla::XlaOp count = xla::ReduceAll(
+        valid, xla::Zero(builder, xla::PrimitiveType::F32),
+        XlaHelpers::CreateAddComputation(xla::PrimitiveType::F32));
+    grad = grad / xla::Max(count, xla::One(builder, xla::PrimitiveType::F32));
+  }
+  if (reduction_mode != ReductionMode::kNone) {
+    grad = xla::Broadcast(grad, {batch});
+  }
+  xla::XlaOp row_grads = grad * valid;
+
+  // The loop values are the padded logits, the labels, the log-sum-exp, the
+  // row gradients and the padded logits gradient, every chunk writing its own
+  // columns.
+  auto body_fn = [&](xla::XlaOp i, absl::Span<const xla::XlaOp> values,
+                     xla::XlaBuilder* body_builder)
+      -> absl::StatusOr<std::vector<xla::XlaOp>> {
+    xla::XlaOp start = i * xla::ConstantR0<int32_t>(body_builder, chunk_size);
+    xla::XlaOp chunk = GetClassChunk(values[0], start, chunk_size);
+    xla::XlaOp probs = xla::Exp(
+        chunk - xla::BroadcastInDim(values[2], {batch, chunk_size}, {0}));
+    xla::PrimitiveType labels_type = XlaHelpers::TypeOfXlaOp(values[1]);
+    xla::XlaOp classes =
+        xla::Iota(body_builder,
+                  xla::ShapeUtil::MakeShape(labels_type, {batch, chunk_size}),
+                  1) +
+        xla::ConvertElementType(start, labels_type);
+    xla::XlaOp one_hot = xla::ConvertElementType(
+        xla::Eq(classes,
+                xla::BroadcastInDim(values[1], {batch, chunk_size}, {0})),
+        xla::PrimitiveType::F32);
+    xla::XlaOp chunk_grad =
+        (probs - one_hot) *
+        xla::BroadcastInDim(values[3], {batch, chunk_size}, {0});
+    xla::XlaOp grad_logits = xla::DynamicUpdateSliceInMinorDims(
+        values[4],
+        xla::ConvertElementType(chunk_grad, logits_shape.element_type()),
+        {start});
+    return std::vector<xla::XlaOp>{values[0], values[1], values[2], values[3],
+                                   grad_logits};
+  };
+  xla::XlaOp padded_logits = PadClassesToChunks(logits, chunk_size);
+  std::vector<xla::XlaOp> results = ConsumeValue(xla::ForEachIndex(
+      xla::CeilOfRatio(num_classes, chunk_size), xla::PrimitiveType::S32,
+      body_fn,
+      {padded_logits, labels, logsumexp, row_grads,
+       xla::ZerosLike(padded_logits)},
+      "ChunkedCrossEntropyBackward", builder));
+  return xla::SliceInDim(results[4], 0, num_classes, 1, 1);
+}
+
 }  // namespace torch_xla
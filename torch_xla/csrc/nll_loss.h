@@ -18,6 +18,30 @@ xla::XlaOp BuildNllLossBackward(xla::XlaOp grad_output, xla::XlaOp logits,
                                 xla::XlaOp total_weight, int ignore_index,
                                 ReductionMode reduction_mode);
 
+struct CrossEntropyResult {
+  xla::XlaOp loss;
+  // The F32 [N] log-sum-exp of the logits rows, for the backward.
+  xla::XlaOp logsumexp;
+};
+
+// Builds the NLLLoss of the log-softmax of the [N, C] "logits" for the [N]
+// class indices "labels", visiting the classes in chunks of "chunk_size"
+// within a loop, so that the [N, C] log-probabilities are never materialized.
+CrossEntropyResult BuildChunkedCrossEntropy(xla::XlaOp logits,
+                                            xla::XlaOp labels, int ignore_index,
+                                            ReductionMode reduction_mode,
+                                            int64_t chunk_size);
+
+// Builds the gradient of BuildChunkedCrossEntropy() for the "logits", one
+// chunk of classes at a time, from the saved "logsumexp".
+xla::XlaOp BuildChunkedCrossEntropyBackward(xla::XlaOp grad_output,
+                                            xla::XlaOp logits,
+                                            xla::XlaOp labels,
+                                            xla::XlaOp logsumexp,
+                                            int ignore_index,
+                                            ReductionMode reduction_mode,
+                                            int64_t chunk_size);
+
 }  // namespace torch_xla
 
 #endif  // XLA_TORCH_XLA_CSRC_NLL_LOSS_H_
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "torch_xla/csrc/node_deduplicator.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+
+namespace torch_xla {
+namespace {
+
+// The ops with side effects, tokens or annotations which must be emitted once
+// per node.
+bool HasSideEffects(const torch::lazy::OpKind& op) {
+  static const std::vector<torch::lazy::OpKind>* ops =
+      new std::vector<torch::lazy::OpKind>({
+          xla_all_gather,
+          xla_all_gather_start,
+          xla_all_reduce_start,
+          xla_all_to_all,
+          xla_async_collective_done,
+          xla_collective_permute,
+          xla_cross_replica_sum,
+          xla_custom_call,
+          xla_custom_sharding,
+          xla_gpu_custom_call,
+          xla_mark_tensor,
+          xla_optimization_barrier,
+          xla_recv,
+          xla_reduce_scatter,
+          xla_ring_attention,
+          xla_ring_attention_backward,
+          xla_send,
+          xla_tpu_custom_call,
+      });
+  return std::find(ops->begin(), ops->end(), op) != ops->end();
+}
+
+}  // namespace
+
+bool NodeDeduplicator::Enabled() {
+  static const bool enabled =
+      runtime::sys_util::GetEnvBool("XLA_IR_CSE", false);
+  return enabled;
+}
+
+bool NodeDeduplicator::TryReuse(const torch::lazy::Node* node,
+                                LoweringContext* loctx) {
+  if (!IsDeduplicable(node)) {
+    return false;
+  }
+  std::vector<const torch::lazy::Node*>& lowered = lowered_[Key(node)];
+  for (const torch::lazy::Node* other : lowered) {
+    if (other->op() == node->op() && other->hash() == node->hash() &&
+        other->num_outputs() == node->num_outputs() &&
+        SameOperands(node, other)) {
+      for (size_t i = 0; i < node->num_outputs(); ++i) {
+        xla::XlaOp op = loctx->GetOutputOp(torch::lazy::Output(other, i));
+        loctx->AssignOutputOp(torch::lazy::Output(node, i), op);
+      }
+      canonical_[node] = other;
+      ++removed_nodes_;
+      TORCH_LAZY_COUNTER("IrNodesDeduplicated", 1);
+      return true;
+    }
+  }
+  lowered.push_back(node);
+  return false;
+}
+
+bool NodeDeduplicator::IsDeduplicable(const torch::lazy::Node* node) const {
+  if (node->operands().empty()) {
+    return node->op() == torch::lazy::OpKind(at::prim::Constant);
+  }
+  return !HasSideEffects(node->op());
+}
+
+bool NodeDeduplicator::SameOperands(const torch::lazy::Node* node,
+                                    const torch::lazy::Node* other) const {
+  const std::vector<torch::lazy::Output>& operands = node->operands();
+  const std::vector<torch::lazy::Output>& other_operands = other->operands();
+  if (operands.size() != other_operands.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < operands.size(); ++i) {
+    if (operands[i].index != other_operands[i].index ||
+        Canonical(operands[i].node) != Canonical(other_operands[i].node)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const torch::lazy::Node* NodeDeduplicator::Canonical(
+    const torch::lazy::Node* node) const {
+  auto it = canonical_.find(node);
+  return it != canonical_.end() ? it->second : node;
+}
+
+torch::lazy::hash_t NodeDeduplicator::Key(const torch::lazy::Node* node) const {
+  torch::lazy::hash_t key = node->hash();
+  for (const torch::lazy::Output& operand : node->operands()) {
+    key = torch::lazy::HashCombine(
+        key, reinterpret_cast<uintptr_t>(Canonical(operand.node)));
+    key = torch::lazy::HashCombine(key, operand.index);
+  }
+  return key;
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,57 @@
+#ifndef XLA_TORCH_XLA_CSRC_NODE_DEDUPLICATOR_H_
+#define XLA_TORCH_XLA_CSRC_NODE_DEDUPLICATOR_H_
+
+#include <torch/csrc/lazy/core/hash.h>
+#include <torch/csrc/lazy/core/ir.h>
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "torch_xla/csrc/lowering_context.h"
+
+namespace torch_xla {
+
+// Eliminates the common subexpressions of a graph while lowering its post
+// order. A node with the same hash, op and (deduplicated) operands as a node
+// lowered before it reuses the outputs of that node instead of being lowered
+// again. The graphs traced from Python often repeat the same masks, expands
+// and scalars, which would otherwise be emitted once per copy. The leaves are
+// only deduplicated if constants, as the device data nodes of the same shape
+// hash alike whatever their data, and the collectives, custom calls and other
+// ops with side effects or annotations are never deduplicated.
+class NodeDeduplicator {
+ public:
+  // Whether the deduplication is enabled (XLA_IR_CSE).
+  static bool Enabled();
+
+  // Reuses for `node` of the post order the outputs of the earlier node it
+  // duplicates, returning whether it did. Otherwise the node is recorded, to
+  // be lowered by the caller.
+  bool TryReuse(const torch::lazy::Node* node, LoweringContext* loctx);
+
+  size_t removed_nodes() const { return removed_nodes_; }
+
+ private:
+  bool IsDeduplicable(const torch::lazy::Node* node) const;
+
+  bool SameOperands(const torch::lazy::Node* node,
+                    const torch::lazy::Node* other) const;
+
+  const torch::lazy::Node* Canonical(const torch::lazy::Node* node) const;
+
+  torch::lazy::hash_t Key(const torch::lazy::Node* node) const;
+
+  // The lowered nodes, by Key().
+  std::unordered_map<torch::lazy::hash_t, std::vector<const torch::lazy::Node*>,
+                     torch::lazy::HashReducer>
+      lowered_;
+  // The earlier node each deduplicated node reuses.
+  std::unordered_map<const torch::lazy::Node*, const torch::lazy::Node*>
+      canonical_;
+  size_t removed_nodes_ = 0;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_NODE_DEDUPLICATOR_H_
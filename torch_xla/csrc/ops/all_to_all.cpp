@@ -24,6 +24,25 @@ xla::Shape NodeOutputShape(const torch::lazy::Value& input,
   return InferOutputShape({GetXlaShape(input), GetXlaShape(token)}, shape_fn);
 }
 
+xla::Shape NodeOutputShapeCoalesced(
+    c10::ArrayRef<torch::lazy::Value> inputs, const torch::lazy::Value& token,
+    int64_t split_dimension, int64_t concat_dimension, int64_t split_count,
+    const std::vector<std::vector<int64_t>>& groups, bool pin_layout) {
+  auto shape_fn = [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
+    AllToAllResultCoalesced result = BuildAllToAllCoalesced(
+        operands.subspan(0, operands.size() - 1), operands.back(),
+        split_dimension, concat_dimension, split_count, groups, pin_layout);
+    result.result.emplace_back(result.token);
+    return xla::Tuple(operands[0].builder(), result.result);
+  };
+  std::vector<xla::Shape> input_shapes;
+  for (const auto& input : inputs) {
+    input_shapes.emplace_back(GetXlaShape(input));
+  }
+  input_shapes.emplace_back(GetXlaShape(token));
+  return InferOutputShape(input_shapes, shape_fn);
+}
+
 }  // namespace
 
 AllToAll::AllToAll(const torch::lazy::Value& input,
@@ -46,12 +65,40 @@ AllToAll::AllToAll(const torch::lazy::Value& input,
       groups_(std::move(groups)),
       pin_layout_(pin_layout) {}
 
+AllToAllCoalesced::AllToAllCoalesced(
+    c10::ArrayRef<torch::lazy::Value> inputs, const torch::lazy::Value& token,
+    int64_t split_dimension, int64_t concat_dimension, int64_t split_count,
+    std::vector<std::vector<int64_t>> groups, bool pin_layout)
+    : XlaNode(
+          xla_all_to_all, GetOperandListWithToken(inputs, token),
+          [&]() {
+            return NodeOutputShapeCoalesced(inputs, token, split_dimension,
+                                            concat_dimension, split_count,
+                                            groups, pin_layout);
+          },
+          /*num_outputs=*/inputs.size() + 1,
+          torch::lazy::MHash(split_dimension, concat_dimension, split_count,
+                             groups, pin_layout)),
+      split_dimension_(split_dimension),
+      concat_dimension_(concat_dimension),
+      split_count_(split_count),
+      groups_(std::move(groups)),
+      pin_layout_(pin_layout) {}
+
 torch::lazy::NodePtr AllToAll::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<AllToAll>(operands.at(0), operands.at(1),
+  return torch_xla::MakeNode<AllToAll>(operands.at(0), operands.at(1),
                                          split_dimension_, concat_dimension_,
                                          split_count_, groups_, pin_layout_);
 }
 
+torch::lazy::NodePtr AllToAllCoalesced::Clone(
+    torch::lazy::OpList operands) const {
+  std::vector<torch::lazy::Value> inputs(operands.begin(), operands.end() - 1);
+  return torch_xla::MakeNode<AllToAllCoalesced>(
+      inputs, operands.back(), split_dimension_, concat_dimension_,
+      split_count_, groups_, pin_layout_);
+}
+
 XlaOpVector AllToAll::Lower(LoweringContext* loctx) const {
   xla::XlaOp input = loctx->GetOutputOp(operand(0));
   xla::XlaOp token = loctx->GetOutputOp(operand(1));
@@ -61,6 +108,21 @@ XlaOpVector AllToAll::Lower(LoweringContext* loctx) const {
   return ReturnOps({result.result, result.token}, loctx);
 }
 
+XlaOpVector AllToAllCoalesced::Lower(LoweringContext* loctx) const {
+  auto& operand_list = operands();
+  std::vector<xla::XlaOp> inputs;
+  inputs.reserve(operand_list.size());
+  for (size_t i = 0; i + 1 < operand_list.size(); ++i) {
+    inputs.push_back(loctx->GetOutputOp(operand_list[i]));
+  }
+  xla::XlaOp token = loctx->GetOutputOp(operand_list.back());
+  AllToAllResultCoalesced result =
+      BuildAllToAllCoalesced(inputs, token, split_dimension_, concat_dimension_,
+                             split_count_, groups_, pin_layout_);
+  result.result.push_back(result.token);
+  return ReturnOps(result.result, loctx);
+}
+
 std::string AllToAll::ToString() const {
   std::stringstream ss;
   ss << XlaNode::ToString() << ", split_dimension=" << split_dimension_
@@ -75,4 +137,18 @@ std::string AllToAll::ToString() const {
   return ss.str();
 }
 
+std::string AllToAllCoalesced::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", split_dimension=" << split_dimension_
+     << ", concat_dimension=" << concat_dimension_
+     << ", split_count=" << split_count_ << ", pin_layout=" << pin_layout_
+     << ", groups=(";
+  for (size_t i = 0; i < groups_.size(); ++i) {
+    ss << (i == 0 ? "(" : ",(");
+    ss << absl::StrJoin(groups_[i], ", ") << ")";
+  }
+  ss << ")";
+  return ss.str();
+}
+
 }  // namespace torch_xla
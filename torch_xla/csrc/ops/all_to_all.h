@@ -37,6 +37,37 @@ class AllToAll : public XlaNode {
   bool pin_layout_;
 };
 
+class AllToAllCoalesced : public XlaNode {
+ public:
+  AllToAllCoalesced(c10::ArrayRef<torch::lazy::Value> inputs,
+                    const torch::lazy::Value& token, int64_t split_dimension,
+                    int64_t concat_dimension, int64_t split_count,
+                    std::vector<std::vector<int64_t>> groups, bool pin_layout);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t split_dimension() const { return split_dimension_; }
+
+  int64_t concat_dimension() const { return concat_dimension_; }
+
+  int64_t split_count() const { return split_count_; }
+
+  const std::vector<std::vector<int64_t>>& groups() const { return groups_; }
+
+  bool pin_layout() const { return pin_layout_; }
+
+ private:
+  int64_t split_dimension_;
+  int64_t concat_dimension_;
+  int64_t split_count_;
+  std::vector<std::vector<int64_t>> groups_;
+  bool pin_layout_;
+};
+
 }  // namespace torch_xla
 
 #endif  // XLA_TORCH_XLA_CSRC_OPS_ALL_TO_ALL_H_
\ No newline at end of file
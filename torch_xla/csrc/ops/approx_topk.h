@@ -0,0 +1,38 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_APPROX_TOPK_H_
+#define XLA_TORCH_XLA_CSRC_OPS_APPROX_TOPK_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The sorted top-k of `input` along `dim`, approximate for a recall_target
+// below 1. See CreateApproxTopK().
+class ApproxTopK : public XlaNode {
+ public:
+  ApproxTopK(const torch::lazy::Value& input, int64_t k, int64_t dim,
+             bool largest, float recall_target);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t k() const { return k_; };
+
+  int64_t dim() const { return dim_; };
+
+  bool largest() const { return largest_; }
+
+  float recall_target() const { return recall_target_; }
+
+ private:
+  int64_t k_;
+  int64_t dim_;
+  bool largest_;
+  float recall_target_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_APPROX_TOPK_H_
@@ -65,7 +65,7 @@ std::string AsStrided::ToString() const {
 }
 
 torch::lazy::NodePtr AsStrided::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<AsStrided>(operands.at(0), size_, stride_,
+  return torch_xla::MakeNode<AsStrided>(operands.at(0), size_, stride_,
                                           storage_offset_);
 }
 
@@ -0,0 +1,158 @@
+#include "torch_xla/csrc/ops/async_collective.h"
+
+#include <torch/csrc/lazy/core/util.h>
+
+#include "absl/strings/str_join.h"
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/infer_output_shape.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+std::string GroupsToString(const std::vector<std::vector<int64_t>>& groups) {
+  std::stringstream ss;
+  ss << "(";
+  for (size_t i = 0; i < groups.size(); ++i) {
+    ss << (i == 0 ? "(" : ",(");
+    ss << absl::StrJoin(groups[i], ", ") << ")";
+  }
+  ss << ")";
+  return ss.str();
+}
+
+xla::Shape AllGatherStartOutputShape(
+    const torch::lazy::Value& input, const torch::lazy::Value& token,
+    int64_t dim, int64_t shard_count,
+    const std::vector<std::vector<int64_t>>& groups, bool pin_layout) {
+  auto shape_fn = [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
+    return BuildAllGatherStart(operands[0], operands[1], dim, shard_count,
+                               groups, pin_layout);
+  };
+  return InferOutputShape({GetXlaShape(input), GetXlaShape(token)}, shape_fn);
+}
+
+xla::Shape AllReduceStartOutputShape(
+    AllReduceType reduce_type, const torch::lazy::Value& input,
+    const torch::lazy::Value& token,
+    const std::vector<std::vector<int64_t>>& groups, bool pin_layout) {
+  auto shape_fn = [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
+    return BuildAllReduceStart(reduce_type, operands[0], operands[1], groups,
+                               pin_layout);
+  };
+  return InferOutputShape({GetXlaShape(input), GetXlaShape(token)}, shape_fn);
+}
+
+xla::Shape AsyncCollectiveDoneOutputShape(const torch::lazy::Value& start,
+                                          const torch::lazy::Value& token) {
+  // The whole shape of the start node, which is a tuple of the input and the
+  // result for the all-gathers.
+  const xla::Shape& start_shape =
+      dynamic_cast<const XlaNode*>(start.node.get())->xla_shape();
+  return xla::ShapeUtil::MakeTupleShape(
+      {start_shape.IsTuple() ? start_shape.tuple_shapes(1) : start_shape,
+       GetXlaShape(token)});
+}
+
+}  // namespace
+
+AllGatherStart::AllGatherStart(const torch::lazy::Value& input,
+                               const torch::lazy::Value& token, int64_t dim,
+                               int64_t shard_count,
+                               std::vector<std::vector<int64_t>> groups,
+                               bool pin_layout)
+    : XlaNode(
+          xla_all_gather_start, {input, token},
+          [&]() {
+            return AllGatherStartOutputShape(input, token, dim, shard_count,
+                                             groups, pin_layout);
+          },
+          /*num_outputs=*/1,
+          torch::lazy::MHash(dim, shard_count, groups, pin_layout)),
+      dim_(dim),
+      shard_count_(shard_count),
+      groups_(std::move(groups)),
+      pin_layout_(pin_layout) {}
+
+torch::lazy::NodePtr AllGatherStart::Clone(torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<AllGatherStart>(
+      operands.at(0), operands.at(1), dim_, shard_count_, groups_, pin_layout_);
+}
+
+XlaOpVector AllGatherStart::Lower(LoweringContext* loctx) const {
+  xla::XlaOp input = loctx->GetOutputOp(operand(0));
+  xla::XlaOp token = loctx->GetOutputOp(operand(1));
+  return ReturnOp(BuildAllGatherStart(input, token, dim_, shard_count_,
+                                      groups_, pin_layout_),
+                  loctx);
+}
+
+std::string AllGatherStart::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", dim=" << dim_
+     << ", shard_count=" << shard_count_ << ", pin_layout=" << pin_layout_
+     << ", groups=" << GroupsToString(groups_);
+  return ss.str();
+}
+
+AllReduceStart::AllReduceStart(AllReduceType reduce_type,
+                               const torch::lazy::Value& input,
+                               const torch::lazy::Value& token,
+                               std::vector<std::vector<int64_t>> groups,
+                               bool pin_layout)
+    : XlaNode(
+          xla_all_reduce_start, {input, token},
+          [&]() {
+            return AllReduceStartOutputShape(reduce_type, input, token, groups,
+                                             pin_layout);
+          },
+          /*num_outputs=*/1,
+          torch::lazy::MHash(torch::lazy::GetEnumValue(reduce_type), groups,
+                             pin_layout)),
+      reduce_type_(reduce_type),
+      groups_(std::move(groups)),
+      pin_layout_(pin_layout) {}
+
+torch::lazy::NodePtr AllReduceStart::Clone(torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<AllReduceStart>(
+      reduce_type_, operands.at(0), operands.at(1), groups_, pin_layout_);
+}
+
+XlaOpVector AllReduceStart::Lower(LoweringContext* loctx) const {
+  xla::XlaOp input = loctx->GetOutputOp(operand(0));
+  xla::XlaOp token = loctx->GetOutputOp(operand(1));
+  return ReturnOp(
+      BuildAllReduceStart(reduce_type_, input, token, groups_, pin_layout_),
+      loctx);
+}
+
+std::string AllReduceStart::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString()
+     << ", reduce_type=" << torch::lazy::GetEnumValue(reduce_type_)
+     << ", pin_layout=" << pin_layout_
+     << ", groups=" << GroupsToString(groups_);
+  return ss.str();
+}
+
+AsyncCollectiveDone::AsyncCollectiveDone(const torch::lazy::Value& start,
+                                         const torch::lazy::Value& token)
+    : XlaNode(xla_async_collective_done, {start, token},
+              AsyncCollectiveDoneOutputShape(start, token),
+              /*num_outputs=*/2) {}
+
+torch::lazy::NodePtr AsyncCollectiveDone::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<AsyncCollectiveDone>(operands.at(0),
+                                                    operands.at(1));
+}
+
+XlaOpVector AsyncCollectiveDone::Lower(LoweringContext* loctx) const {
+  xla::XlaOp start = loctx->GetOutputOp(operand(0));
+  xla::XlaOp token = loctx->GetOutputOp(operand(1));
+  AsyncCollectiveDoneResult result = BuildAsyncCollectiveDone(start, token);
+  return ReturnOps({result.result, result.token}, loctx);
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,79 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_ASYNC_COLLECTIVE_H_
+#define XLA_TORCH_XLA_CSRC_OPS_ASYNC_COLLECTIVE_H_
+
+#include "torch_xla/csrc/cross_replica_reduces.h"
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// Starts an all-gather, whose single output is the state of the collective in
+// flight, only to be consumed by an AsyncCollectiveDone node.
+class AllGatherStart : public XlaNode {
+ public:
+  AllGatherStart(const torch::lazy::Value& input,
+                 const torch::lazy::Value& token, int64_t dim,
+                 int64_t shard_count, std::vector<std::vector<int64_t>> groups,
+                 bool pin_layout);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t dim() const { return dim_; }
+
+  int64_t shard_count() const { return shard_count_; }
+
+  const std::vector<std::vector<int64_t>>& groups() const { return groups_; }
+
+  bool pin_layout() const { return pin_layout_; }
+
+ private:
+  int64_t dim_;
+  int64_t shard_count_;
+  std::vector<std::vector<int64_t>> groups_;
+  bool pin_layout_;
+};
+
+// Starts an all-reduce, whose single output is the state of the collective in
+// flight, only to be consumed by an AsyncCollectiveDone node.
+class AllReduceStart : public XlaNode {
+ public:
+  AllReduceStart(AllReduceType reduce_type, const torch::lazy::Value& input,
+                 const torch::lazy::Value& token,
+                 std::vector<std::vector<int64_t>> groups, bool pin_layout);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  AllReduceType reduce_type() const { return reduce_type_; }
+
+  const std::vector<std::vector<int64_t>>& groups() const { return groups_; }
+
+  bool pin_layout() const { return pin_layout_; }
+
+ private:
+  AllReduceType reduce_type_;
+  std::vector<std::vector<int64_t>> groups_;
+  bool pin_layout_;
+};
+
+// Waits for the collective of an AllGatherStart or AllReduceStart node. The
+// outputs are the result of the collective and the token following `token`.
+class AsyncCollectiveDone : public XlaNode {
+ public:
+  AsyncCollectiveDone(const torch::lazy::Value& start,
+                      const torch::lazy::Value& token);
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_ASYNC_COLLECTIVE_H_
@@ -68,7 +68,7 @@ AvgPoolNd::AvgPoolNd(const torch::lazy::Value& input, int64_t spatial_dim_count,
       divisor_override_(divisor_override) {}
 
 torch::lazy::NodePtr AvgPoolNd::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<AvgPoolNd>(operands.at(0), spatial_dim_count_,
+  return torch_xla::MakeNode<AvgPoolNd>(operands.at(0), spatial_dim_count_,
                                           kernel_size_, stride_, padding_,
                                           ceil_mode_, count_include_pad_);
 }
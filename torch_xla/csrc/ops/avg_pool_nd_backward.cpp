@@ -69,7 +69,7 @@ AvgPoolNdBackward::AvgPoolNdBackward(const torch::lazy::Value& grad_output,
 
 torch::lazy::NodePtr AvgPoolNdBackward::Clone(
     torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<AvgPoolNdBackward>(
+  return torch_xla::MakeNode<AvgPoolNdBackward>(
       operands.at(0), operands.at(1), spatial_dim_count_, kernel_size_, stride_,
       padding_, ceil_mode_, count_include_pad_);
 }
@@ -0,0 +1,59 @@
+#include "torch_xla/csrc/ops/batched_nms.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& scores,
+                           int64_t max_output_size) {
+  const xla::Shape& scores_shape = GetXlaShape(scores);
+  std::vector<int64_t> batch_dims(scores_shape.dimensions().begin(),
+                                  scores_shape.dimensions().end() - 1);
+  std::vector<int64_t> indices_dims(batch_dims);
+  indices_dims.push_back(max_output_size);
+  return xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(xla::PrimitiveType::S64, indices_dims),
+       xla::ShapeUtil::MakeShape(xla::PrimitiveType::S64, batch_dims)});
+}
+
+}  // namespace
+
+BatchedNms::BatchedNms(const torch::lazy::Value& boxes,
+                       const torch::lazy::Value& scores, double iou_threshold,
+                       double score_threshold, int64_t max_output_size)
+    : XlaNode(xla_batched_nms, {boxes, scores},
+              NodeOutputShape(scores, max_output_size),
+              /*num_outputs=*/2,
+              torch::lazy::MHash(iou_threshold, score_threshold,
+                                 max_output_size)),
+      iou_threshold_(iou_threshold),
+      score_threshold_(score_threshold),
+      max_output_size_(max_output_size) {}
+
+torch::lazy::NodePtr BatchedNms::Clone(torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<BatchedNms>(operands.at(0), operands.at(1),
+                                           iou_threshold_, score_threshold_,
+                                           max_output_size_);
+}
+
+XlaOpVector BatchedNms::Lower(LoweringContext* loctx) const {
+  xla::XlaOp boxes = loctx->GetOutputOp(operand(0));
+  xla::XlaOp scores = loctx->GetOutputOp(operand(1));
+  return ReturnOps(BuildBatchedNms(boxes, scores, iou_threshold_,
+                                   score_threshold_, max_output_size_),
+                   loctx);
+}
+
+std::string BatchedNms::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", iou_threshold=" << iou_threshold_
+     << ", score_threshold=" << score_threshold_
+     << ", max_output_size=" << max_output_size_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,36 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_BATCHED_NMS_H_
+#define XLA_TORCH_XLA_CSRC_OPS_BATCHED_NMS_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The outputs are the [..., max_output_size] indices of the boxes kept in
+// every set, padded with -1, and the [...] number of kept boxes.
+class BatchedNms : public XlaNode {
+ public:
+  BatchedNms(const torch::lazy::Value& boxes, const torch::lazy::Value& scores,
+             double iou_threshold, double score_threshold,
+             int64_t max_output_size);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  double iou_threshold() const { return iou_threshold_; }
+
+  double score_threshold() const { return score_threshold_; }
+
+  int64_t max_output_size() const { return max_output_size_; }
+
+ private:
+  double iou_threshold_;
+  double score_threshold_;
+  int64_t max_output_size_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_BATCHED_NMS_H_
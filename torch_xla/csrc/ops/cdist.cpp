@@ -10,11 +10,11 @@ namespace {
 xla::Shape NodeOutputShape(const torch::lazy::Value& x1,
                            const torch::lazy::Value& x2,
                            const torch::lazy::Value& p, bool use_hamming,
-                           bool use_chebyshev) {
+                           bool use_chebyshev, bool use_euclidean) {
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildCdistForward(operands[0], operands[1], operands[2], use_hamming,
-                             use_chebyshev);
+                             use_chebyshev, use_euclidean);
   };
   return InferOutputShape({GetXlaShape(x1), GetXlaShape(x2), GetXlaShape(p)},
                           lower_for_shape_fn);
@@ -25,34 +25,38 @@ xla::Shape NodeOutputShape(const torch::lazy::Value& x1,
 CdistForward::CdistForward(const torch::lazy::Value& x1,
                            const torch::lazy::Value& x2,
                            const torch::lazy::Value& p, bool use_hamming,
-                           bool use_chebyshev)
-    : XlaNode(
-          torch::lazy::OpKind(at::aten::_cdist_forward), {x1, x2, p},
-          [&]() {
-            return NodeOutputShape(x1, x2, p, use_hamming, use_chebyshev);
-          },
-          /*num_outputs=*/1, torch::lazy::MHash(use_hamming, use_chebyshev)),
+                           bool use_chebyshev, bool use_euclidean)
+    : XlaNode(torch::lazy::OpKind(at::aten::_cdist_forward), {x1, x2, p},
+              [&]() {
+                return NodeOutputShape(x1, x2, p, use_hamming, use_chebyshev,
+                                       use_euclidean);
+              },
+              /*num_outputs=*/1,
+              torch::lazy::MHash(use_hamming, use_chebyshev, use_euclidean)),
       use_hamming_(use_hamming),
-      use_chebyshev_(use_chebyshev) {}
+      use_chebyshev_(use_chebyshev),
+      use_euclidean_(use_euclidean) {}
 
 torch::lazy::NodePtr CdistForward::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<CdistForward>(operands.at(0), operands.at(1),
+  return torch_xla::MakeNode<CdistForward>(operands.at(0), operands.at(1),
                                              operands.at(2), use_hamming_,
-                                             use_chebyshev_);
+                                             use_chebyshev_, use_euclidean_);
 }
 
 XlaOpVector CdistForward::Lower(LoweringContext* loctx) const {
   xla::XlaOp x1 = loctx->GetOutputOp(operand(0));
   xla::XlaOp x2 = loctx->GetOutputOp(operand(1));
   xla::XlaOp p = loctx->GetOutputOp(operand(2));
-  return ReturnOp(BuildCdistForward(x1, x2, p, use_hamming_, use_chebyshev_),
+  return ReturnOp(BuildCdistForward(x1, x2, p, use_hamming_, use_chebyshev_,
+                                    use_euclidean_),
                   loctx);
 }
 
 std::string CdistForward::ToString() const {
   std::stringstream ss;
   ss << XlaNode::ToString() << ", use_hamming=" << use_hamming_
-     << ", use_chebyshev=" << use_chebyshev_;
+     << ", use_chebyshev=" << use_chebyshev_
+     << ", use_euclidean=" << use_euclidean_;
   return ss.str();
 }
 
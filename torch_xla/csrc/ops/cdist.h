@@ -9,7 +9,7 @@ class CdistForward : public XlaNode {
  public:
   CdistForward(const torch::lazy::Value& x1, const torch::lazy::Value& x2,
                const torch::lazy::Value& p, bool use_hamming,
-               bool use_chebyshev);
+               bool use_chebyshev, bool use_euclidean);
 
   std::string ToString() const override;
 
@@ -20,6 +20,7 @@ class CdistForward : public XlaNode {
  private:
   bool use_hamming_;    // handle p == 0
   bool use_chebyshev_;  // handle p == +inf
+  bool use_euclidean_;  // handle p == 2 with a matmul
 };
 
 }  // namespace torch_xla
@@ -0,0 +1,105 @@
+#include "torch_xla/csrc/ops/chunked_cross_entropy.h"
+
+#include <torch/csrc/lazy/core/util.h>
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/nll_loss.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& logits,
+                           ReductionMode reduction) {
+  const xla::Shape& logits_shape = GetXlaShape(logits);
+  int64_t batch = logits_shape.dimensions(0);
+  xla::Shape loss_shape =
+      reduction == ReductionMode::kNone
+          ? xla::ShapeUtil::MakeShape(logits_shape.element_type(), {batch})
+          : xla::ShapeUtil::MakeShape(logits_shape.element_type(), {});
+  return xla::ShapeUtil::MakeTupleShape(
+      {loss_shape,
+       xla::ShapeUtil::MakeShape(xla::PrimitiveType::F32, {batch})});
+}
+
+}  // namespace
+
+ChunkedCrossEntropy::ChunkedCrossEntropy(const torch::lazy::Value& logits,
+                                         const torch::lazy::Value& labels,
+                                         int ignore_index,
+                                         ReductionMode reduction,
+                                         int64_t chunk_size)
+    : XlaNode(xla_chunked_cross_entropy, {logits, labels},
+              NodeOutputShape(logits, reduction),
+              /*num_outputs=*/2,
+              torch::lazy::MHash(ignore_index,
+                                 torch::lazy::GetEnumValue(reduction),
+                                 chunk_size)),
+      ignore_index_(ignore_index),
+      reduction_(reduction),
+      chunk_size_(chunk_size) {}
+
+torch::lazy::NodePtr ChunkedCrossEntropy::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<ChunkedCrossEntropy>(
+      operands.at(0), operands.at(1), ignore_index_, reduction_, chunk_size_);
+}
+
+XlaOpVector ChunkedCrossEntropy::Lower(LoweringContext* loctx) const {
+  xla::XlaOp logits = loctx->GetOutputOp(operand(0));
+  xla::XlaOp labels = loctx->GetOutputOp(operand(1));
+  CrossEntropyResult result = BuildChunkedCrossEntropy(
+      logits, labels, ignore_index_, reduction_, chunk_size_);
+  return ReturnOps({result.loss, result.logsumexp}, loctx);
+}
+
+std::string ChunkedCrossEntropy::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", ignore_index=" << ignore_index_
+     << ", reduction=" << torch::lazy::GetEnumValue(reduction_)
+     << ", chunk_size=" << chunk_size_;
+  return ss.str();
+}
+
+ChunkedCrossEntropyBackward::ChunkedCrossEntropyBackward(
+    const torch::lazy::Value& grad_output, const torch::lazy::Value& logits,
+    const torch::lazy::Value& labels, const torch::lazy::Value& logsumexp,
+    int ignore_index, ReductionMode reduction, int64_t chunk_size)
+    : XlaNode(xla_chunked_cross_entropy_backward,
+              {grad_output, logits, labels, logsumexp}, GetXlaShape(logits),
+              /*num_outputs=*/1,
+              torch::lazy::MHash(ignore_index,
+                                 torch::lazy::GetEnumValue(reduction),
+                                 chunk_size)),
+      ignore_index_(ignore_index),
+      reduction_(reduction),
+      chunk_size_(chunk_size) {}
+
+torch::lazy::NodePtr ChunkedCrossEntropyBackward::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<ChunkedCrossEntropyBackward>(
+      operands.at(0), operands.at(1), operands.at(2), operands.at(3),
+      ignore_index_, reduction_, chunk_size_);
+}
+
+XlaOpVector ChunkedCrossEntropyBackward::Lower(LoweringContext* loctx) const {
+  xla::XlaOp grad_output = loctx->GetOutputOp(operand(0));
+  xla::XlaOp logits = loctx->GetOutputOp(operand(1));
+  xla::XlaOp labels = loctx->GetOutputOp(operand(2));
+  xla::XlaOp logsumexp = loctx->GetOutputOp(operand(3));
+  return ReturnOp(BuildChunkedCrossEntropyBackward(grad_output, logits, labels,
+                                                   logsumexp, ignore_index_,
+                                                   reduction_, chunk_size_),
+                  loctx);
+}
+
+std::string ChunkedCrossEntropyBackward::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", ignore_index=" << ignore_index_
+     << ", reduction=" << torch::lazy::GetEnumValue(reduction_)
+     << ", chunk_size=" << chunk_size_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
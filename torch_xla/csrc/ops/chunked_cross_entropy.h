@@ -0,0 +1,63 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_CHUNKED_CROSS_ENTROPY_H_
+#define XLA_TORCH_XLA_CSRC_OPS_CHUNKED_CROSS_ENTROPY_H_
+
+#include "torch_xla/csrc/ir.h"
+#include "torch_xla/csrc/reduction.h"
+
+namespace torch_xla {
+
+// The outputs are the loss and the F32 [N] log-sum-exp of the logits rows.
+class ChunkedCrossEntropy : public XlaNode {
+ public:
+  ChunkedCrossEntropy(const torch::lazy::Value& logits,
+                      const torch::lazy::Value& labels, int ignore_index,
+                      ReductionMode reduction, int64_t chunk_size);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int ignore_index() const { return ignore_index_; }
+
+  ReductionMode reduction() const { return reduction_; }
+
+  int64_t chunk_size() const { return chunk_size_; }
+
+ private:
+  int ignore_index_;
+  ReductionMode reduction_;
+  int64_t chunk_size_;
+};
+
+class ChunkedCrossEntropyBackward : public XlaNode {
+ public:
+  ChunkedCrossEntropyBackward(const torch::lazy::Value& grad_output,
+                              const torch::lazy::Value& logits,
+                              const torch::lazy::Value& labels,
+                              const torch::lazy::Value& logsumexp,
+                              int ignore_index, ReductionMode reduction,
+                              int64_t chunk_size);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int ignore_index() const { return ignore_index_; }
+
+  ReductionMode reduction() const { return reduction_; }
+
+  int64_t chunk_size() const { return chunk_size_; }
+
+ private:
+  int ignore_index_;
+  ReductionMode reduction_;
+  int64_t chunk_size_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_CHUNKED_CROSS_ENTROPY_H_
@@ -20,6 +20,24 @@ xla::Shape NodeOutputShape(
   return InferOutputShape({GetXlaShape(input), GetXlaShape(token)}, shape_fn);
 }
 
+xla::Shape NodeOutputShapeCoalesced(
+    c10::ArrayRef<torch::lazy::Value> inputs, const torch::lazy::Value& token,
+    const std::vector<std::pair<int64_t, int64_t>>& source_target_pairs) {
+  auto shape_fn = [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
+    CollectivePermuteResultCoalesced result = BuildCollectivePermuteCoalesced(
+        operands.subspan(0, operands.size() - 1), operands.back(),
+        source_target_pairs);
+    result.result.emplace_back(result.token);
+    return xla::Tuple(operands[0].builder(), result.result);
+  };
+  std::vector<xla::Shape> input_shapes;
+  for (const auto& input : inputs) {
+    input_shapes.emplace_back(GetXlaShape(input));
+  }
+  input_shapes.emplace_back(GetXlaShape(token));
+  return InferOutputShape(input_shapes, shape_fn);
+}
+
 }  // namespace
 
 CollectivePermute::CollectivePermute(
@@ -31,12 +49,32 @@ CollectivePermute::CollectivePermute(
           /*num_outputs=*/2, torch::lazy::MHash(source_target_pairs)),
       source_target_pairs_(std::move(source_target_pairs)) {}
 
+CollectivePermuteCoalesced::CollectivePermuteCoalesced(
+    c10::ArrayRef<torch::lazy::Value> inputs, const torch::lazy::Value& token,
+    std::vector<std::pair<int64_t, int64_t>> source_target_pairs)
+    : XlaNode(
+          xla_collective_permute, GetOperandListWithToken(inputs, token),
+          [&]() {
+            return NodeOutputShapeCoalesced(inputs, token,
+                                            source_target_pairs);
+          },
+          /*num_outputs=*/inputs.size() + 1,
+          torch::lazy::MHash(source_target_pairs)),
+      source_target_pairs_(std::move(source_target_pairs)) {}
+
 torch::lazy::NodePtr CollectivePermute::Clone(
     torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<CollectivePermute>(
+  return torch_xla::MakeNode<CollectivePermute>(
       operands.at(0), operands.at(1), source_target_pairs_);
 }
 
+torch::lazy::NodePtr CollectivePermuteCoalesced::Clone(
+    torch::lazy::OpList operands) const {
+  std::vector<torch::lazy::Value> inputs(operands.begin(), operands.end() - 1);
+  return torch_xla::MakeNode<CollectivePermuteCoalesced>(
+      inputs, operands.back(), source_target_pairs_);
+}
+
 XlaOpVector CollectivePermute::Lower(LoweringContext* loctx) const {
   xla::XlaOp input = loctx->GetOutputOp(operand(0));
   xla::XlaOp token = loctx->GetOutputOp(operand(1));
@@ -45,6 +83,20 @@ XlaOpVector CollectivePermute::Lower(LoweringContext* loctx) const {
   return ReturnOps({result.result, result.token}, loctx);
 }
 
+XlaOpVector CollectivePermuteCoalesced::Lower(LoweringContext* loctx) const {
+  auto& operand_list = operands();
+  std::vector<xla::XlaOp> inputs;
+  inputs.reserve(operand_list.size());
+  for (size_t i = 0; i + 1 < operand_list.size(); ++i) {
+    inputs.push_back(loctx->GetOutputOp(operand_list[i]));
+  }
+  xla::XlaOp token = loctx->GetOutputOp(operand_list.back());
+  CollectivePermuteResultCoalesced result =
+      BuildCollectivePermuteCoalesced(inputs, token, source_target_pairs_);
+  result.result.push_back(result.token);
+  return ReturnOps(result.result, loctx);
+}
+
 std::string CollectivePermute::ToString() const {
   std::stringstream ss;
   ss << XlaNode::ToString() << ", source_target_pairs=(";
@@ -57,4 +109,16 @@ std::string CollectivePermute::ToString() const {
   return ss.str();
 }
 
+std::string CollectivePermuteCoalesced::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", source_target_pairs=(";
+  for (size_t i = 0; i < source_target_pairs_.size(); ++i) {
+    ss << (i == 0 ? "(" : ", (");
+    ss << source_target_pairs_[i].first << ", "
+       << source_target_pairs_[i].second << ")";
+  }
+  ss << ")";
+  return ss.str();
+}
+
 }  // namespace torch_xla
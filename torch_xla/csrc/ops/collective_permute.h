@@ -26,6 +26,26 @@ class CollectivePermute : public XlaNode {
   std::vector<std::pair<int64_t, int64_t>> source_target_pairs_;
 };
 
+class CollectivePermuteCoalesced : public XlaNode {
+ public:
+  CollectivePermuteCoalesced(
+      c10::ArrayRef<torch::lazy::Value> inputs, const torch::lazy::Value& token,
+      std::vector<std::pair<int64_t, int64_t>> source_target_pairs);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  const std::vector<std::pair<int64_t, int64_t>>& source_target_pairs() const {
+    return source_target_pairs_;
+  }
+
+ private:
+  std::vector<std::pair<int64_t, int64_t>> source_target_pairs_;
+};
+
 }  // namespace torch_xla
 
 #endif  // XLA_TORCH_XLA_CSRC_OPS_COLLECTIVE_PERMUTE_H_
\ No newline at end of file
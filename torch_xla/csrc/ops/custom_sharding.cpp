@@ -27,7 +27,7 @@ CustomSharding::CustomSharding(const torch::lazy::Value& input,
       output_shape(output_shape) {}
 
 torch::lazy::NodePtr CustomSharding::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<CustomSharding>(operands.at(0), output_shape,
+  return torch_xla::MakeNode<CustomSharding>(operands.at(0), output_shape,
                                                type);
 }
 
@@ -8,13 +8,30 @@
 #include "torch_xla/csrc/tensor_util.h"
 
 namespace torch_xla {
+namespace {
+
+// Graphs reading host placed data are compiled for it, so the memory kind is
+// part of the hash of the node when it is not the device memory.
+torch::lazy::hash_t DeviceDataHashSeed(
+    const std::shared_ptr<torch::lazy::BackendData>& data) {
+  runtime::MemoryKind memory_kind =
+      std::dynamic_pointer_cast<runtime::ComputationClient::Data>(data)
+          ->memory_kind();
+  if (memory_kind == runtime::MemoryKind::kDevice) {
+    return (uint32_t)101;
+  }
+  return torch::lazy::HashCombine((uint32_t)101,
+                                  static_cast<int>(memory_kind));
+}
+
+}  // namespace
 
 DeviceData::DeviceData(std::shared_ptr<torch::lazy::BackendData> data)
     : XlaNode(xla_device_data,
               std::dynamic_pointer_cast<runtime::ComputationClient::Data>(data)
                   ->shape(),
               /*num_outputs=*/1,
-              /*hash_seed=*/(uint32_t)101),
+              /*hash_seed=*/DeviceDataHashSeed(data)),
       data_(std::move(data)) {
   std::optional<xla::OpSharding> op_sharding =
       torch_xla::runtime::GetComputationClient()->GetDataSharding(
@@ -32,7 +49,7 @@ std::string DeviceData::ToString() const {
 }
 
 torch::lazy::NodePtr DeviceData::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<DeviceData>(data_);
+  return torch_xla::MakeNode<DeviceData>(data_);
 }
 
 XlaOpVector DeviceData::Lower(LoweringContext* loctx) const {
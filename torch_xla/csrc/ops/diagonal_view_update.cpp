@@ -18,7 +18,7 @@ DiagonalViewUpdate::DiagonalViewUpdate(const torch::lazy::Value& target,
 
 torch::lazy::NodePtr DiagonalViewUpdate::Clone(
     torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<DiagonalViewUpdate>(
+  return torch_xla::MakeNode<DiagonalViewUpdate>(
       operands.at(0), operands.at(1), offset_, dim1_, dim2_);
 }
 
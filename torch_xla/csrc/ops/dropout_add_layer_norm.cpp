@@ -0,0 +1,117 @@
+#include "torch_xla/csrc/ops/dropout_add_layer_norm.h"
+
+#include <torch/csrc/lazy/core/util.h>
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/runtime/util.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& input, bool return_mask) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  absl::Span<const int64_t> dims = input_shape.dimensions();
+  xla::Shape rows_shape = xla::ShapeUtil::MakeShape(
+      xla::PrimitiveType::F32, dims.subspan(0, dims.size() - 1));
+  std::vector<xla::Shape> shapes = {input_shape, input_shape, rows_shape,
+                                    rows_shape};
+  if (return_mask) {
+    shapes.push_back(input_shape);
+  }
+  return xla::ShapeUtil::MakeTupleShape(shapes);
+}
+
+}  // namespace
+
+DropoutAddLayerNorm::DropoutAddLayerNorm(
+    const torch::lazy::Value& input, const torch::lazy::Value& residual,
+    const torch::lazy::Value& weight, const torch::lazy::Value& bias,
+    const torch::lazy::Value& seed, float p, double eps, bool return_mask)
+    : XlaNode(xla_dropout_add_layer_norm, {input, residual, weight, bias, seed},
+              NodeOutputShape(input, return_mask),
+              /*num_outputs=*/return_mask ? 5 : 4,
+              torch::lazy::MHash(p, eps, return_mask)),
+      p_(p),
+      eps_(eps),
+      return_mask_(return_mask) {}
+
+torch::lazy::NodePtr DropoutAddLayerNorm::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<DropoutAddLayerNorm>(
+      operands.at(0), operands.at(1), operands.at(2), operands.at(3),
+      operands.at(4), p_, eps_, return_mask_);
+}
+
+XlaOpVector DropoutAddLayerNorm::Lower(LoweringContext* loctx) const {
+  xla::XlaOp input = loctx->GetOutputOp(operand(0));
+  xla::XlaOp residual = loctx->GetOutputOp(operand(1));
+  xla::XlaOp weight = loctx->GetOutputOp(operand(2));
+  xla::XlaOp bias = loctx->GetOutputOp(operand(3));
+  xla::XlaOp seed = loctx->GetOutputOp(operand(4));
+  return ReturnOps(BuildDropoutAddLayerNorm(input, residual, weight, bias,
+                                            seed, p_, eps_, return_mask_),
+                   loctx);
+}
+
+std::string DropoutAddLayerNorm::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", p=" << p_ << ", eps=" << eps_
+     << ", return_mask=" << return_mask_;
+  return ss.str();
+}
+
+DropoutAddLayerNormBackward::DropoutAddLayerNormBackward(
+    const torch::lazy::Value& grad_output, const torch::lazy::Value& grad_sum,
+    const torch::lazy::Value& sum, const torch::lazy::Value& weight,
+    const torch::lazy::Value& mean, const torch::lazy::Value& rstd,
+    const torch::lazy::Value& seed,
+    const absl::optional<torch::lazy::Value>& mask, float p)
+    : XlaNode(xla_dropout_add_layer_norm_backward,
+              torch_xla::runtime::util::GetValuesVector<torch::lazy::Value>(
+                  {grad_output, grad_sum, sum, weight, mean, rstd, seed},
+                  {&mask}),
+              xla::ShapeUtil::MakeTupleShape(
+                  {GetXlaShape(sum), GetXlaShape(sum), GetXlaShape(weight),
+                   GetXlaShape(weight)}),
+              /*num_outputs=*/4, torch::lazy::MHash(p)),
+      p_(p) {}
+
+torch::lazy::NodePtr DropoutAddLayerNormBackward::Clone(
+    torch::lazy::OpList operands) const {
+  absl::optional<torch::lazy::Value> mask;
+  if (operands.size() > 7) {
+    mask = operands.at(7);
+  }
+  return torch_xla::MakeNode<DropoutAddLayerNormBackward>(
+      operands.at(0), operands.at(1), operands.at(2), operands.at(3),
+      operands.at(4), operands.at(5), operands.at(6), mask, p_);
+}
+
+XlaOpVector DropoutAddLayerNormBackward::Lower(LoweringContext* loctx) const {
+  xla::XlaOp grad_output = loctx->GetOutputOp(operand(0));
+  xla::XlaOp grad_sum = loctx->GetOutputOp(operand(1));
+  xla::XlaOp sum = loctx->GetOutputOp(operand(2));
+  xla::XlaOp weight = loctx->GetOutputOp(operand(3));
+  xla::XlaOp mean = loctx->GetOutputOp(operand(4));
+  xla::XlaOp rstd = loctx->GetOutputOp(operand(5));
+  xla::XlaOp seed = loctx->GetOutputOp(operand(6));
+  absl::optional<xla::XlaOp> mask;
+  if (operands().size() > 7) {
+    mask = loctx->GetOutputOp(operand(7));
+  }
+  return ReturnOps(
+      BuildDropoutAddLayerNormBackward(grad_output, grad_sum, sum, weight,
+                                       mean, rstd, seed, mask, p_),
+      loctx);
+}
+
+std::string DropoutAddLayerNormBackward::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", p=" << p_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
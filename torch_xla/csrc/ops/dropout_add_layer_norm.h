@@ -0,0 +1,67 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_DROPOUT_ADD_LAYER_NORM_H_
+#define XLA_TORCH_XLA_CSRC_OPS_DROPOUT_ADD_LAYER_NORM_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The layer norm over the last dimension of dropout(input) + residual. The
+// outputs are the layer norm, the sum, and the F32 mean and reciprocal
+// standard deviation of its rows, followed by the dropout mask with
+// return_mask.
+class DropoutAddLayerNorm : public XlaNode {
+ public:
+  DropoutAddLayerNorm(const torch::lazy::Value& input,
+                      const torch::lazy::Value& residual,
+                      const torch::lazy::Value& weight,
+                      const torch::lazy::Value& bias,
+                      const torch::lazy::Value& seed, float p, double eps,
+                      bool return_mask);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  float p() const { return p_; }
+
+  double eps() const { return eps_; }
+
+  bool return_mask() const { return return_mask_; }
+
+ private:
+  float p_;
+  double eps_;
+  bool return_mask_;
+};
+
+// The outputs are the input, residual, weight and bias gradients. Without a
+// mask, the dropout mask is drawn again from the forward seed.
+class DropoutAddLayerNormBackward : public XlaNode {
+ public:
+  DropoutAddLayerNormBackward(const torch::lazy::Value& grad_output,
+                              const torch::lazy::Value& grad_sum,
+                              const torch::lazy::Value& sum,
+                              const torch::lazy::Value& weight,
+                              const torch::lazy::Value& mean,
+                              const torch::lazy::Value& rstd,
+                              const torch::lazy::Value& seed,
+                              const absl::optional<torch::lazy::Value>& mask,
+                              float p);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  float p() const { return p_; }
+
+ private:
+  float p_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_DROPOUT_ADD_LAYER_NORM_H_
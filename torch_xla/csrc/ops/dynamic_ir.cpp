@@ -1,5 +1,10 @@
 #include "torch_xla/csrc/ops/dynamic_ir.h"
 
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <optional>
+#include <utility>
+
 #include "absl/strings/str_join.h"
 #include "torch_xla/csrc/aten_xla_bridge.h"
 #include "torch_xla/csrc/lowering_context.h"
@@ -10,6 +15,64 @@
 #include "torch_xla/csrc/xla_graph_executor.h"
 
 namespace torch_xla {
+namespace {
+
+// The range of the values of a size known without executing the graph. The
+// constants are exact and the size of a dynamic dimension lies between zero
+// and its upper bound, while the other size expressions are not bounded.
+std::optional<std::pair<int64_t, int64_t>> KnownRange(
+    const torch::lazy::Output& output) {
+  if (const auto* constant = dynamic_cast<const SizeConstant*>(output.node)) {
+    return std::make_pair(constant->getStaticValue(),
+                          constant->getStaticValue());
+  }
+  if (const auto* size = dynamic_cast<const SizeNode*>(output.node)) {
+    return std::make_pair(int64_t{0}, size->getStaticValue());
+  }
+  return std::nullopt;
+}
+
+// Whether a < b, when the ranges of the sizes decide it, so that the guards
+// on the sizes like `size >= 0` do not sync with the device.
+std::optional<bool> LessFromBounds(const torch::lazy::Output& a,
+                                   const torch::lazy::Output& b) {
+  auto range_a = KnownRange(a);
+  auto range_b = KnownRange(b);
+  if (!range_a || !range_b) {
+    return std::nullopt;
+  }
+  if (range_a->second < range_b->first) {
+    return true;
+  }
+  if (range_a->first >= range_b->second) {
+    return false;
+  }
+  return std::nullopt;
+}
+
+// Whether a == b, when the ranges of the sizes decide it.
+std::optional<bool> EqualFromBounds(const torch::lazy::Output& a,
+                                    const torch::lazy::Output& b) {
+  auto range_a = KnownRange(a);
+  auto range_b = KnownRange(b);
+  if (!range_a || !range_b) {
+    return std::nullopt;
+  }
+  if (range_a->second < range_b->first || range_b->second < range_a->first) {
+    return false;
+  }
+  if (range_a->first == range_a->second && range_b->first == range_b->second) {
+    return true;
+  }
+  return std::nullopt;
+}
+
+int64_t FromBounds(bool value) {
+  TORCH_LAZY_COUNTER("SizeCompareFromBounds", 1);
+  return value ? 1 : 0;
+}
+
+}  // namespace
 
 const torch::lazy::DimensionNode* DimCast(const torch::lazy::Node* node) {
   return dynamic_cast<const torch::lazy::DimensionNode*>(node);
@@ -45,7 +108,7 @@ int64_t SizeNode::getDynamicValue() const {
     return runtime_size_;
   }
   torch::lazy::NodePtr cloned =
-      torch::lazy::MakeNode<SizeNode>(operands_[0], dim_);
+      torch_xla::MakeNode<SizeNode>(operands_[0], dim_);
   // Wrap the IR of SizeNode into a dummy tensor and execute/fetch the value
   // of this tensor. GetTensors will return a cpu at::Tensor so we can just
   // extract the value of it.
@@ -144,6 +207,9 @@ int64_t SizeEq::getDynamicValue() const {
   if (operand(0) == operand(1)) {
     return 1;
   }
+  if (std::optional<bool> equal = EqualFromBounds(operand(0), operand(1))) {
+    return FromBounds(*equal);
+  }
   const torch::lazy::DimensionNode* dim_node_0 = DimCast(operand(0));
   const torch::lazy::DimensionNode* dim_node_1 = DimCast(operand(1));
   XLA_CHECK(dim_node_0);
@@ -166,6 +232,9 @@ SizeNe::SizeNe(torch::lazy::Value a, torch::lazy::Value b)
 };
 
 int64_t SizeNe::getDynamicValue() const {
+  if (std::optional<bool> equal = EqualFromBounds(operand(0), operand(1))) {
+    return FromBounds(!*equal);
+  }
   const torch::lazy::DimensionNode* dim_node_0 = DimCast(operand(0));
   const torch::lazy::DimensionNode* dim_node_1 = DimCast(operand(1));
   XLA_CHECK(dim_node_0);
@@ -188,6 +257,9 @@ SizeGe::SizeGe(torch::lazy::Value a, torch::lazy::Value b)
 };
 
 int64_t SizeGe::getDynamicValue() const {
+  if (std::optional<bool> less = LessFromBounds(operand(0), operand(1))) {
+    return FromBounds(!*less);
+  }
   const torch::lazy::DimensionNode* dim_node_0 = DimCast(operand(0));
   const torch::lazy::DimensionNode* dim_node_1 = DimCast(operand(1));
   XLA_CHECK(dim_node_0);
@@ -210,6 +282,9 @@ SizeGt::SizeGt(torch::lazy::Value a, torch::lazy::Value b)
 };
 
 int64_t SizeGt::getDynamicValue() const {
+  if (std::optional<bool> less = LessFromBounds(operand(1), operand(0))) {
+    return FromBounds(*less);
+  }
   const torch::lazy::DimensionNode* dim_node_0 = DimCast(operand(0));
   const torch::lazy::DimensionNode* dim_node_1 = DimCast(operand(1));
   XLA_CHECK(dim_node_0);
@@ -232,6 +307,9 @@ SizeLt::SizeLt(torch::lazy::Value a, torch::lazy::Value b)
 };
 
 int64_t SizeLt::getDynamicValue() const {
+  if (std::optional<bool> less = LessFromBounds(operand(0), operand(1))) {
+    return FromBounds(*less);
+  }
   const torch::lazy::DimensionNode* dim_node_0 = DimCast(operand(0));
   const torch::lazy::DimensionNode* dim_node_1 = DimCast(operand(1));
   XLA_CHECK(dim_node_0);
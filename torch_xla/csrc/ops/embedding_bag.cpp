@@ -4,6 +4,7 @@
 #include "torch_xla/csrc/lowering_context.h"
 #include "torch_xla/csrc/ops/infer_output_shape.h"
 #include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/shape_helper.h"
 #include "torch_xla/csrc/xla_lower_util.h"
 #include "tsl/platform/stacktrace.h"
@@ -17,48 +18,67 @@ namespace {
 const int MODE_SUM = 0;
 const int MODE_MEAN = 1;
 const int MODE_MAX = 2;
-std::vector<xla::XlaOp> BuildEmbeddingBag(xla::XlaOp weight, xla::XlaOp indices,
-                                          xla::XlaOp offsets,
-                                          xla::XlaOp per_sample_weights,
-                                          bool include_last_offset, int mode) {
-  xla::Shape offset_shape = ShapeHelper::ShapeOfXlaOp(offsets);
-  int64_t n = offset_shape.dimensions(0);
-  xla::Shape weight_shape = ShapeHelper::ShapeOfXlaOp(weight);
-  int64_t weight_dim = weight_shape.dimensions(1);
-  xla::Shape indices_shape = ShapeHelper::ShapeOfXlaOp(indices);
-  int64_t num_embeddings = indices_shape.dimensions(0);
-  XLA_CHECK(indices_shape.rank() == 1 || indices_shape.rank() == 2)
-      << "input has to be a 1D or 2D Tensor, but got Tensor of dimension "
-      << indices_shape.rank();
-  if (indices_shape.rank() == 1) {
-    XLA_CHECK(offset_shape.rank() == 1)
-        << "offsets has to be a 1D Tensor, but got Tensor of dimension "
-        << offset_shape.rank();
-  }
-  XLA_CHECK(weight_shape.rank() == 2)
-      << "weight has to be a 2D Tensor, but got Tensor of dimension "
-      << weight_shape.rank();
 
-  xla::XlaOp output2 = xla::ZerosLike(indices);
-  xla::XlaOp output3 = xla::ZerosLike(offsets);
-  std::vector<int64_t> sizes = {n, weight_dim};
-  xla::XlaOp output4 =
-      xla::Zeros(offsets.builder(),
-                 xla::ShapeUtil::MakeShape(offset_shape.element_type(), sizes));
+bool UseWhileLoop() {
+  static const bool use_while_loop =
+      runtime::sys_util::GetEnvBool("XLA_EMBEDDING_BAG_WHILE_LOOP", false);
+  return use_while_loop;
+}
 
-  xla::XlaOp embeddings = xla::TorchIndexSelect(weight, indices, 0);
-  xla::XlaOp embeddings_weighted = xla::Mul(
-      embeddings, xla::ConvertElementType(
-                      xla::BroadcastInDim(per_sample_weights,
-                                          {num_embeddings, weight_dim}, {0}),
-                      weight_shape.element_type()));
+// Reduces the bags of the gathered `embeddings` as segment reductions: the bag
+// of each embedding is the cumulative count of the bags starting at or before
+// it, and the embeddings are then scattered into their bags, so that all the
+// bags are reduced at once. The elements past the last offset of an
+// include_last_offset input fall in an out of bounds bag, which the scatters
+// drop. Empty bags are zeros in every mode.
+xla::XlaOp ReduceBagsWithSegments(xla::XlaOp embeddings, xla::XlaOp offsets,
+                                  bool include_last_offset, int mode) {
+  xla::XlaBuilder* builder = offsets.builder();
+  const xla::Shape& embeddings_shape = ShapeHelper::ShapeOfXlaOp(embeddings);
+  int64_t weight_dim = embeddings_shape.dimensions(1);
+  xla::PrimitiveType type = embeddings_shape.element_type();
+  int64_t n = ShapeHelper::ShapeOfXlaOp(offsets).dimensions(0);
+  int64_t num_bags = include_last_offset ? n - 1 : n;
+
+  xla::XlaOp bag_ids =
+      BuildBagSegmentIds(offsets, embeddings_shape.dimensions(0));
+  xla::XlaOp zero = xla::Zero(builder, type);
+  xla::XlaOp sums = BuildSegmentReduce(embeddings, bag_ids, num_bags, zero,
+                                       NumericAddCombiner());
+  if (mode == MODE_SUM) {
+    return sums;
+  }
+  xla::XlaOp counts = xla::BroadcastInDim(
+      BuildSegmentReduce(xla::One(builder, type), bag_ids, num_bags, zero,
+                         NumericAddCombiner()),
+      {num_bags, weight_dim}, {0});
+  if (mode == MODE_MEAN) {
+    return xla::Div(sums, xla::Max(counts, xla::One(builder, type)));
+  }
+  xla::XlaOp maxes =
+      BuildSegmentReduce(embeddings, bag_ids, num_bags,
+                         xla::MinValue(builder, type), NumericMaxCombiner());
+  return xla::Select(xla::Gt(counts, zero), maxes, xla::ZerosLike(maxes));
+}
+
+// Reduces the bags of the gathered `embeddings` one after the other, with a
+// While loop per bag. Only supports the sum and max modes.
+xla::XlaOp ReduceBagsWithWhile(xla::XlaOp embeddings_weighted,
+                               xla::XlaOp offsets, bool include_last_offset,
+                               int mode) {
+  xla::Shape offset_shape = ShapeHelper::ShapeOfXlaOp(offsets);
+  int64_t n = offset_shape.dimensions(0);
+  const xla::Shape& embeddings_shape =
+      ShapeHelper::ShapeOfXlaOp(embeddings_weighted);
+  int64_t num_embeddings = embeddings_shape.dimensions(0);
+  int64_t weight_dim = embeddings_shape.dimensions(1);
+  xla::PrimitiveType type = embeddings_shape.element_type();
 
   std::vector<xla::Shape> shape_elements = {
       xla::ShapeUtil::MakeShape(offset_shape.element_type(), {}),
       xla::ShapeUtil::MakeShape(offset_shape.element_type(), {}),
-      xla::ShapeUtil::MakeShape(weight_shape.element_type(),
-                                {num_embeddings, weight_dim}),
-      xla::ShapeUtil::MakeShape(weight_shape.element_type(), {1, weight_dim})};
+      xla::ShapeUtil::MakeShape(type, {num_embeddings, weight_dim}),
+      xla::ShapeUtil::MakeShape(type, {1, weight_dim})};
   xla::Shape result_shape = xla::ShapeUtil::MakeTupleShape(shape_elements);
 
   xla::XlaComputation condition;
@@ -120,11 +140,57 @@ std::vector<xla::XlaOp> BuildEmbeddingBag(xla::XlaOp weight, xla::XlaOp indices,
          embeddings_weighted,
          xla::ConvertElementType(
              xla::ConstantFromArray<float>(offsets.builder(), initial_vector),
-             weight_shape.element_type())});
+             type)});
     auto result = xla::While(condition, body, init_tuple);
     results.push_back(xla::GetTupleElement(result, 3));
   };
-  xla::XlaOp output1 = xla::ConcatInDim(offsets.builder(), results, 0);
+  return xla::ConcatInDim(offsets.builder(), results, 0);
+}
+
+std::vector<xla::XlaOp> BuildEmbeddingBag(xla::XlaOp weight, xla::XlaOp indices,
+                                          xla::XlaOp offsets,
+                                          xla::XlaOp per_sample_weights,
+                                          bool include_last_offset, int mode) {
+  xla::Shape offset_shape = ShapeHelper::ShapeOfXlaOp(offsets);
+  int64_t n = offset_shape.dimensions(0);
+  xla::Shape weight_shape = ShapeHelper::ShapeOfXlaOp(weight);
+  int64_t weight_dim = weight_shape.dimensions(1);
+  xla::Shape indices_shape = ShapeHelper::ShapeOfXlaOp(indices);
+  int64_t num_embeddings = indices_shape.dimensions(0);
+  XLA_CHECK(indices_shape.rank() == 1 || indices_shape.rank() == 2)
+      << "input has to be a 1D or 2D Tensor, but got Tensor of dimension "
+      << indices_shape.rank();
+  if (indices_shape.rank() == 1) {
+    XLA_CHECK(offset_shape.rank() == 1)
+        << "offsets has to be a 1D Tensor, but got Tensor of dimension "
+        << offset_shape.rank();
+  }
+  XLA_CHECK(weight_shape.rank() == 2)
+      << "weight has to be a 2D Tensor, but got Tensor of dimension "
+      << weight_shape.rank();
+
+  xla::XlaOp output2 = xla::ZerosLike(indices);
+  xla::XlaOp output3 = xla::ZerosLike(offsets);
+  std::vector<int64_t> sizes = {n, weight_dim};
+  xla::XlaOp output4 =
+      xla::Zeros(offsets.builder(),
+                 xla::ShapeUtil::MakeShape(offset_shape.element_type(), sizes));
+
+  xla::XlaOp embeddings = xla::TorchIndexSelect(
+      weight, XlaHelpers::NarrowIndices(indices, weight_shape.dimensions(0)),
+      0);
+  xla::XlaOp embeddings_weighted = xla::Mul(
+      embeddings, xla::ConvertElementType(
+                      xla::BroadcastInDim(per_sample_weights,
+                                          {num_embeddings, weight_dim}, {0}),
+                      weight_shape.element_type()));
+
+  xla::XlaOp output1 =
+      UseWhileLoop() && mode != MODE_MEAN
+          ? ReduceBagsWithWhile(embeddings_weighted, offsets,
+                                include_last_offset, mode)
+          : ReduceBagsWithSegments(embeddings_weighted, offsets,
+                                   include_last_offset, mode);
   return {output1, output2, output3, output4};
 }
 
@@ -132,7 +198,7 @@ xla::Shape NodeOutputShapes(const torch::lazy::Value& weight,
                             const torch::lazy::Value& indices,
                             const torch::lazy::Value& offsets,
                             const torch::lazy::Value& per_sample_weights,
-                            bool include_last_offset, bool mode) {
+                            bool include_last_offset, int64_t mode) {
   auto lower_for_shapes_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return xla::Tuple(
@@ -173,7 +239,7 @@ EmbeddingBag::EmbeddingBag(const torch::lazy::Value& weight,
       include_last_offset_(include_last_offset) {}
 
 torch::lazy::NodePtr EmbeddingBag::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<EmbeddingBag>(operands.at(0), operands.at(1),
+  return torch_xla::MakeNode<EmbeddingBag>(operands.at(0), operands.at(1),
                                              operands.at(2), mode_,
                                              operands.at(3), false);
 }
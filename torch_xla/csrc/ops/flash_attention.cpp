@@ -0,0 +1,102 @@
+#include "torch_xla/csrc/ops/flash_attention.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& query,
+                           const torch::lazy::Value& value) {
+  const xla::Shape& query_shape = GetXlaShape(query);
+  const xla::Shape& value_shape = GetXlaShape(value);
+  std::vector<int64_t> output_dims(query_shape.dimensions().begin(),
+                                   query_shape.dimensions().end());
+  output_dims.back() = value_shape.dimensions(value_shape.rank() - 1);
+  std::vector<int64_t> row_dims(output_dims.begin(), output_dims.end() - 1);
+  return xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(query_shape.element_type(), output_dims),
+       xla::ShapeUtil::MakeShape(xla::PrimitiveType::F32, row_dims)});
+}
+
+}  // namespace
+
+FlashAttention::FlashAttention(const torch::lazy::Value& query,
+                               const torch::lazy::Value& key,
+                               const torch::lazy::Value& value, double scale,
+                               bool causal, int64_t block_size)
+    : XlaNode(
+          xla_flash_attention, {query, key, value},
+          [&]() { return NodeOutputShape(query, value); },
+          /*num_outputs=*/2, torch::lazy::MHash(scale, causal, block_size)),
+      scale_(scale),
+      causal_(causal),
+      block_size_(block_size) {}
+
+torch::lazy::NodePtr FlashAttention::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<FlashAttention>(operands.at(0), operands.at(1),
+                                               operands.at(2), scale_, causal_,
+                                               block_size_);
+}
+
+XlaOpVector FlashAttention::Lower(LoweringContext* loctx) const {
+  FlashAttentionResult result = BuildFlashAttention(
+      loctx->GetOutputOp(operand(0)), loctx->GetOutputOp(operand(1)),
+      loctx->GetOutputOp(operand(2)), scale_, causal_, block_size_);
+  return ReturnOps({result.output, result.logsumexp}, loctx);
+}
+
+std::string FlashAttention::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", scale=" << scale_ << ", causal=" << causal_
+     << ", block_size=" << block_size_;
+  return ss.str();
+}
+
+FlashAttentionBackward::FlashAttentionBackward(
+    const torch::lazy::Value& query, const torch::lazy::Value& key,
+    const torch::lazy::Value& value, const torch::lazy::Value& output,
+    const torch::lazy::Value& logsumexp, const torch::lazy::Value& grad_output,
+    double scale, bool causal, int64_t block_size)
+    : XlaNode(
+          xla_flash_attention_backward,
+          {query, key, value, output, logsumexp, grad_output},
+          [&]() {
+            return xla::ShapeUtil::MakeTupleShape(
+                {GetXlaShape(query), GetXlaShape(key), GetXlaShape(value)});
+          },
+          /*num_outputs=*/3, torch::lazy::MHash(scale, causal, block_size)),
+      scale_(scale),
+      causal_(causal),
+      block_size_(block_size) {}
+
+torch::lazy::NodePtr FlashAttentionBackward::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<FlashAttentionBackward>(
+      operands.at(0), operands.at(1), operands.at(2), operands.at(3),
+      operands.at(4), operands.at(5), scale_, causal_, block_size_);
+}
+
+XlaOpVector FlashAttentionBackward::Lower(LoweringContext* loctx) const {
+  std::vector<xla::XlaOp> ops;
+  for (const torch::lazy::Output& operand : operands()) {
+    ops.push_back(loctx->GetOutputOp(operand));
+  }
+  FlashAttentionBackwardResult result =
+      BuildFlashAttentionBackward(ops[0], ops[1], ops[2], ops[3], ops[4],
+                                  ops[5], scale_, causal_, block_size_);
+  return ReturnOps({result.grad_query, result.grad_key, result.grad_value},
+                   loctx);
+}
+
+std::string FlashAttentionBackward::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", scale=" << scale_ << ", causal=" << causal_
+     << ", block_size=" << block_size_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,66 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_FLASH_ATTENTION_H_
+#define XLA_TORCH_XLA_CSRC_OPS_FLASH_ATTENTION_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The outputs are the attention output and its F32 log-sum-exp.
+class FlashAttention : public XlaNode {
+ public:
+  FlashAttention(const torch::lazy::Value& query,
+                 const torch::lazy::Value& key,
+                 const torch::lazy::Value& value, double scale, bool causal,
+                 int64_t block_size);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  double scale() const { return scale_; }
+
+  bool causal() const { return causal_; }
+
+  int64_t block_size() const { return block_size_; }
+
+ private:
+  double scale_;
+  bool causal_;
+  int64_t block_size_;
+};
+
+// The operands are the query, key, value, output, log-sum-exp and output
+// gradient. The outputs are the query, key and value gradients.
+class FlashAttentionBackward : public XlaNode {
+ public:
+  FlashAttentionBackward(const torch::lazy::Value& query,
+                         const torch::lazy::Value& key,
+                         const torch::lazy::Value& value,
+                         const torch::lazy::Value& output,
+                         const torch::lazy::Value& logsumexp,
+                         const torch::lazy::Value& grad_output, double scale,
+                         bool causal, int64_t block_size);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  double scale() const { return scale_; }
+
+  bool causal() const { return causal_; }
+
+  int64_t block_size() const { return block_size_; }
+
+ private:
+  double scale_;
+  bool causal_;
+  int64_t block_size_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_FLASH_ATTENTION_H_
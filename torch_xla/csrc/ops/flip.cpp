@@ -11,7 +11,7 @@ Flip::Flip(const torch::lazy::Value& input, std::vector<int64_t> dims)
       dims_(std::move(dims)) {}
 
 torch::lazy::NodePtr Flip::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<Flip>(operands.at(0), dims_);
+  return torch_xla::MakeNode<Flip>(operands.at(0), dims_);
 }
 
 XlaOpVector Flip::Lower(LoweringContext* loctx) const {
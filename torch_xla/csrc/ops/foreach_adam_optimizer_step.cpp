@@ -0,0 +1,113 @@
+#include "torch_xla/csrc/ops/foreach_adam_optimizer_step.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+
+namespace torch_xla {
+namespace {
+
+// The found_inf, grad_scale, beta1, beta2, lr, weight_decay and eps operands.
+const size_t kNumScalars = 7;
+
+std::vector<torch::lazy::Value> GetOperands(
+    const torch::lazy::Value& found_inf, const torch::lazy::Value& grad_scale,
+    const torch::lazy::Value& beta1, const torch::lazy::Value& beta2,
+    const torch::lazy::Value& lr, const torch::lazy::Value& weight_decay,
+    const torch::lazy::Value& eps,
+    c10::ArrayRef<torch::lazy::Value> steps,
+    c10::ArrayRef<torch::lazy::Value> params,
+    c10::ArrayRef<torch::lazy::Value> grads,
+    c10::ArrayRef<torch::lazy::Value> exp_avgs,
+    c10::ArrayRef<torch::lazy::Value> exp_avg_sqs,
+    c10::ArrayRef<torch::lazy::Value> max_exp_avg_sqs) {
+  std::vector<torch::lazy::Value> operands = {
+      found_inf, grad_scale, beta1, beta2, lr, weight_decay, eps};
+  for (auto values :
+       {steps, params, grads, exp_avgs, exp_avg_sqs, max_exp_avg_sqs}) {
+    operands.insert(operands.end(), values.begin(), values.end());
+  }
+  return operands;
+}
+
+xla::Shape NodeOutputShape(c10::ArrayRef<torch::lazy::Value> steps,
+                           c10::ArrayRef<torch::lazy::Value> params,
+                           bool use_amsgrad) {
+  std::vector<xla::Shape> shapes;
+  for (const torch::lazy::Value& step : steps) {
+    shapes.push_back(GetXlaShape(step));
+  }
+  // The params, then the moments.
+  for (int i = 0; i < (use_amsgrad ? 4 : 3); ++i) {
+    for (const torch::lazy::Value& param : params) {
+      shapes.push_back(GetXlaShape(param));
+    }
+  }
+  return xla::ShapeUtil::MakeTupleShape(shapes);
+}
+
+}  // namespace
+
+ForeachAdamOptimizerStep::ForeachAdamOptimizerStep(
+    const torch::lazy::Value& found_inf, const torch::lazy::Value& grad_scale,
+    const torch::lazy::Value& beta1, const torch::lazy::Value& beta2,
+    const torch::lazy::Value& lr, const torch::lazy::Value& weight_decay,
+    const torch::lazy::Value& eps,
+    c10::ArrayRef<torch::lazy::Value> steps,
+    c10::ArrayRef<torch::lazy::Value> params,
+    c10::ArrayRef<torch::lazy::Value> grads,
+    c10::ArrayRef<torch::lazy::Value> exp_avgs,
+    c10::ArrayRef<torch::lazy::Value> exp_avg_sqs,
+    c10::ArrayRef<torch::lazy::Value> max_exp_avg_sqs, bool use_weight_decay,
+    bool use_amsgrad, bool use_adamw)
+    : XlaNode(xla_foreach_adam_optimizer_step,
+              GetOperands(found_inf, grad_scale, beta1, beta2, lr,
+                          weight_decay, eps, steps, params, grads, exp_avgs,
+                          exp_avg_sqs, max_exp_avg_sqs),
+              NodeOutputShape(steps, params, use_amsgrad),
+              /*num_outputs=*/(use_amsgrad ? 5 : 4) * params.size(),
+              torch::lazy::MHash(use_weight_decay, use_amsgrad, use_adamw)),
+      num_params_(params.size()),
+      use_weight_decay_(use_weight_decay),
+      use_amsgrad_(use_amsgrad),
+      use_adamw_(use_adamw) {
+  XLA_CHECK_EQ(max_exp_avg_sqs.size(), use_amsgrad ? num_params_ : 0);
+}
+
+torch::lazy::NodePtr ForeachAdamOptimizerStep::Clone(
+    torch::lazy::OpList operands) const {
+  auto values = [&](size_t index) {
+    if (index == 5 && !use_amsgrad_) {
+      return torch::lazy::OpList();
+    }
+    return operands.slice(kNumScalars + index * num_params_, num_params_);
+  };
+  return torch_xla::MakeNode<ForeachAdamOptimizerStep>(
+      operands.at(0), operands.at(1), operands.at(2), operands.at(3),
+      operands.at(4), operands.at(5), operands.at(6), values(0), values(1),
+      values(2), values(3), values(4), values(5), use_weight_decay_,
+      use_amsgrad_, use_adamw_);
+}
+
+XlaOpVector ForeachAdamOptimizerStep::Lower(LoweringContext* loctx) const {
+  std::vector<xla::XlaOp> ops;
+  for (const torch::lazy::Output& operand : operands()) {
+    ops.push_back(loctx->GetOutputOp(operand));
+  }
+  auto values = [&](size_t index) {
+    if (index == 5 && !use_amsgrad_) {
+      return absl::Span<const xla::XlaOp>();
+    }
+    return absl::MakeConstSpan(ops).subspan(kNumScalars + index * num_params_,
+                                            num_params_);
+  };
+  return ReturnOps(
+      BuildForeachAdamOptimizerStep(
+          ops[0], ops[1], values(0), values(1), values(2), values(3),
+          values(4), values(5), ops[2], ops[3], ops[4], ops[5], ops[6],
+          use_weight_decay_, use_amsgrad_, use_adamw_),
+      loctx);
+}
+
+}  // namespace torch_xla
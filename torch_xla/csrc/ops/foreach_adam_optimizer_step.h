@@ -0,0 +1,41 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_FOREACH_ADAM_OPTIMIZER_STEP_H_
+#define XLA_TORCH_XLA_CSRC_OPS_FOREACH_ADAM_OPTIMIZER_STEP_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// An AdamOptimizerStep over a list of params, lowered as a single update of
+// their flattened concatenation. The outputs are the new steps, params,
+// exp_avgs, exp_avg_sqs and, with `use_amsgrad`, max_exp_avg_sqs, one list
+// after the other. The `max_exp_avg_sqs` are only operands with `use_amsgrad`.
+// The gradients are multiplied by the rank 0 `grad_scale` within the update.
+class ForeachAdamOptimizerStep : public XlaNode {
+ public:
+  ForeachAdamOptimizerStep(
+      const torch::lazy::Value& found_inf, const torch::lazy::Value& grad_scale,
+      const torch::lazy::Value& beta1, const torch::lazy::Value& beta2,
+      const torch::lazy::Value& lr, const torch::lazy::Value& weight_decay,
+      const torch::lazy::Value& eps,
+      c10::ArrayRef<torch::lazy::Value> steps,
+      c10::ArrayRef<torch::lazy::Value> params,
+      c10::ArrayRef<torch::lazy::Value> grads,
+      c10::ArrayRef<torch::lazy::Value> exp_avgs,
+      c10::ArrayRef<torch::lazy::Value> exp_avg_sqs,
+      c10::ArrayRef<torch::lazy::Value> max_exp_avg_sqs, bool use_weight_decay,
+      bool use_amsgrad, bool use_adamw);
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+ private:
+  size_t num_params_;
+  bool use_weight_decay_;
+  bool use_amsgrad_;
+  bool use_adamw_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_FOREACH_ADAM_OPTIMIZER_STEP_H_
@@ -0,0 +1,50 @@
+#include "torch_xla/csrc/ops/foreach_grad_norm.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+std::vector<torch::lazy::Value> GetOperands(
+    const torch::lazy::Value& found_inf, const torch::lazy::Value& inv_scale,
+    c10::ArrayRef<torch::lazy::Value> grads) {
+  std::vector<torch::lazy::Value> operands = {found_inf, inv_scale};
+  operands.insert(operands.end(), grads.begin(), grads.end());
+  return operands;
+}
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& found_inf) {
+  return xla::ShapeUtil::MakeTupleShape(
+      {GetXlaShape(found_inf),
+       xla::ShapeUtil::MakeShape(xla::PrimitiveType::F32, {})});
+}
+
+}  // namespace
+
+ForeachGradNorm::ForeachGradNorm(const torch::lazy::Value& found_inf,
+                                 const torch::lazy::Value& inv_scale,
+                                 c10::ArrayRef<torch::lazy::Value> grads)
+    : XlaNode(xla_foreach_grad_norm, GetOperands(found_inf, inv_scale, grads),
+              NodeOutputShape(found_inf),
+              /*num_outputs=*/2) {}
+
+torch::lazy::NodePtr ForeachGradNorm::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<ForeachGradNorm>(
+      operands.at(0), operands.at(1), operands.slice(2));
+}
+
+XlaOpVector ForeachGradNorm::Lower(LoweringContext* loctx) const {
+  std::vector<xla::XlaOp> ops;
+  for (const torch::lazy::Output& operand : operands()) {
+    ops.push_back(loctx->GetOutputOp(operand));
+  }
+  return ReturnOps(BuildForeachGradNorm(ops[0], ops[1],
+                                        absl::MakeConstSpan(ops).subspan(2)),
+                   loctx);
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,24 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_FOREACH_GRAD_NORM_H_
+#define XLA_TORCH_XLA_CSRC_OPS_FOREACH_GRAD_NORM_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// Checks a list of gradients for non-finite values and computes their global
+// norm, once scaled by `inv_scale`, in a single pass. The outputs are the new
+// `found_inf` flag and the F32 norm.
+class ForeachGradNorm : public XlaNode {
+ public:
+  ForeachGradNorm(const torch::lazy::Value& found_inf,
+                  const torch::lazy::Value& inv_scale,
+                  c10::ArrayRef<torch::lazy::Value> grads);
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_FOREACH_GRAD_NORM_H_
@@ -0,0 +1,95 @@
+#include "torch_xla/csrc/ops/foreach_sgd_optimizer_step.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+
+namespace torch_xla {
+namespace {
+
+// The found_inf, grad_scale, weight_decay, momentum, lr and dampening
+// operands.
+const size_t kNumScalars = 6;
+
+std::vector<torch::lazy::Value> GetOperands(
+    const torch::lazy::Value& found_inf, const torch::lazy::Value& grad_scale,
+    const torch::lazy::Value& weight_decay, const torch::lazy::Value& momentum,
+    const torch::lazy::Value& lr, const torch::lazy::Value& dampening,
+    c10::ArrayRef<torch::lazy::Value> steps,
+    c10::ArrayRef<torch::lazy::Value> params,
+    c10::ArrayRef<torch::lazy::Value> bufs,
+    c10::ArrayRef<torch::lazy::Value> d_ps) {
+  std::vector<torch::lazy::Value> operands = {
+      found_inf, grad_scale, weight_decay, momentum, lr, dampening};
+  for (auto values : {steps, params, bufs, d_ps}) {
+    operands.insert(operands.end(), values.begin(), values.end());
+  }
+  return operands;
+}
+
+xla::Shape NodeOutputShape(c10::ArrayRef<torch::lazy::Value> steps,
+                           c10::ArrayRef<torch::lazy::Value> params) {
+  std::vector<xla::Shape> shapes;
+  for (const torch::lazy::Value& step : steps) {
+    shapes.push_back(GetXlaShape(step));
+  }
+  // The params, then the momentum buffers.
+  for (int i = 0; i < 2; ++i) {
+    for (const torch::lazy::Value& param : params) {
+      shapes.push_back(GetXlaShape(param));
+    }
+  }
+  return xla::ShapeUtil::MakeTupleShape(shapes);
+}
+
+}  // namespace
+
+ForeachSgdOptimizerStep::ForeachSgdOptimizerStep(
+    const torch::lazy::Value& found_inf, const torch::lazy::Value& grad_scale,
+    const torch::lazy::Value& weight_decay, const torch::lazy::Value& momentum,
+    const torch::lazy::Value& lr, const torch::lazy::Value& dampening,
+    c10::ArrayRef<torch::lazy::Value> steps,
+    c10::ArrayRef<torch::lazy::Value> params,
+    c10::ArrayRef<torch::lazy::Value> bufs,
+    c10::ArrayRef<torch::lazy::Value> d_ps, bool use_weight_decay,
+    bool use_momentum, bool use_nesterov)
+    : XlaNode(xla_foreach_sgd_optimizer_step,
+              GetOperands(found_inf, grad_scale, weight_decay, momentum, lr,
+                          dampening, steps, params, bufs, d_ps),
+              NodeOutputShape(steps, params),
+              /*num_outputs=*/3 * params.size(),
+              torch::lazy::MHash(use_weight_decay, use_momentum, use_nesterov)),
+      num_params_(params.size()),
+      use_weight_decay_(use_weight_decay),
+      use_momentum_(use_momentum),
+      use_nesterov_(use_nesterov) {}
+
+torch::lazy::NodePtr ForeachSgdOptimizerStep::Clone(
+    torch::lazy::OpList operands) const {
+  auto values = [&](size_t index) {
+    return operands.slice(kNumScalars + index * num_params_, num_params_);
+  };
+  return torch_xla::MakeNode<ForeachSgdOptimizerStep>(
+      operands.at(0), operands.at(1), operands.at(2), operands.at(3),
+      operands.at(4), operands.at(5), values(0), values(1), values(2),
+      values(3), use_weight_decay_, use_momentum_, use_nesterov_);
+}
+
+XlaOpVector ForeachSgdOptimizerStep::Lower(LoweringContext* loctx) const {
+  std::vector<xla::XlaOp> ops;
+  for (const torch::lazy::Output& operand : operands()) {
+    ops.push_back(loctx->GetOutputOp(operand));
+  }
+  auto values = [&](size_t index) {
+    return absl::MakeConstSpan(ops).subspan(kNumScalars + index * num_params_,
+                                            num_params_);
+  };
+  return ReturnOps(
+      BuildForeachSgdOptimizerStep(ops[0], ops[1], values(0), values(1),
+                                   values(2), values(3), ops[2], ops[3],
+                                   ops[4], ops[5], use_weight_decay_,
+                                   use_momentum_, use_nesterov_),
+      loctx);
+}
+
+}  // namespace torch_xla
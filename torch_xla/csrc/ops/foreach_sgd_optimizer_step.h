@@ -0,0 +1,40 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_FOREACH_SGD_OPTIMIZER_STEP_H_
+#define XLA_TORCH_XLA_CSRC_OPS_FOREACH_SGD_OPTIMIZER_STEP_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// A SgdOptimizerStep over a list of params, lowered as a single update of
+// their flattened concatenation. The outputs are the new steps, followed by
+// the new params, followed by the new momentum buffers. The gradients are
+// multiplied by the rank 0 `grad_scale` within the update.
+class ForeachSgdOptimizerStep : public XlaNode {
+ public:
+  ForeachSgdOptimizerStep(const torch::lazy::Value& found_inf,
+                          const torch::lazy::Value& grad_scale,
+                          const torch::lazy::Value& weight_decay,
+                          const torch::lazy::Value& momentum,
+                          const torch::lazy::Value& lr,
+                          const torch::lazy::Value& dampening,
+                          c10::ArrayRef<torch::lazy::Value> steps,
+                          c10::ArrayRef<torch::lazy::Value> params,
+                          c10::ArrayRef<torch::lazy::Value> bufs,
+                          c10::ArrayRef<torch::lazy::Value> d_ps,
+                          bool use_weight_decay, bool use_momentum,
+                          bool use_nesterov);
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+ private:
+  size_t num_params_;
+  bool use_weight_decay_;
+  bool use_momentum_;
+  bool use_nesterov_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_FOREACH_SGD_OPTIMIZER_STEP_H_
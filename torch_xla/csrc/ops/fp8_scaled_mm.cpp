@@ -0,0 +1,64 @@
+#include "torch_xla/csrc/ops/fp8_scaled_mm.h"
+
+#include <torch/csrc/lazy/core/util.h>
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/primitive_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& a,
+                           const torch::lazy::Value& b) {
+  const xla::Shape& a_shape = GetXlaShape(a);
+  xla::Shape amax_shape =
+      xla::ShapeUtil::MakeShape(xla::PrimitiveType::F32, {});
+  return xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(
+           a_shape.element_type(),
+           {a_shape.dimensions(0), GetXlaShape(b).dimensions(1)}),
+       amax_shape, amax_shape});
+}
+
+}  // namespace
+
+Fp8ScaledMm::Fp8ScaledMm(const torch::lazy::Value& a,
+                         const torch::lazy::Value& b,
+                         const torch::lazy::Value& a_scale,
+                         const torch::lazy::Value& b_scale,
+                         xla::PrimitiveType a_type, xla::PrimitiveType b_type)
+    : XlaNode(xla_fp8_scaled_mm, {a, b, a_scale, b_scale},
+              NodeOutputShape(a, b),
+              /*num_outputs=*/3,
+              torch::lazy::MHash(static_cast<int>(a_type),
+                                 static_cast<int>(b_type))),
+      a_type_(a_type),
+      b_type_(b_type) {}
+
+torch::lazy::NodePtr Fp8ScaledMm::Clone(torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<Fp8ScaledMm>(operands.at(0), operands.at(1),
+                                            operands.at(2), operands.at(3),
+                                            a_type_, b_type_);
+}
+
+XlaOpVector Fp8ScaledMm::Lower(LoweringContext* loctx) const {
+  xla::XlaOp a = loctx->GetOutputOp(operand(0));
+  xla::XlaOp b = loctx->GetOutputOp(operand(1));
+  xla::XlaOp a_scale = loctx->GetOutputOp(operand(2));
+  xla::XlaOp b_scale = loctx->GetOutputOp(operand(3));
+  return ReturnOps(
+      BuildFp8ScaledMatmul(a, b, a_scale, b_scale, a_type_, b_type_), loctx);
+}
+
+std::string Fp8ScaledMm::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString()
+     << ", a_type=" << xla::primitive_util::LowercasePrimitiveTypeName(a_type_)
+     << ", b_type=" << xla::primitive_util::LowercasePrimitiveTypeName(b_type_);
+  return ss.str();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,35 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_FP8_SCALED_MM_H_
+#define XLA_TORCH_XLA_CSRC_OPS_FP8_SCALED_MM_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The matmul of the [M, K] `a` by the [K, N] `b`, both converted to FP8 after
+// being multiplied by their scalar scales. The outputs are the [M, N] matmul,
+// of the `a` type, and the F32 absolute maxima of `a` and `b`.
+class Fp8ScaledMm : public XlaNode {
+ public:
+  Fp8ScaledMm(const torch::lazy::Value& a, const torch::lazy::Value& b,
+              const torch::lazy::Value& a_scale,
+              const torch::lazy::Value& b_scale, xla::PrimitiveType a_type,
+              xla::PrimitiveType b_type);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  xla::PrimitiveType a_type() const { return a_type_; }
+
+  xla::PrimitiveType b_type() const { return b_type_; }
+
+ private:
+  xla::PrimitiveType a_type_;
+  xla::PrimitiveType b_type_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_FP8_SCALED_MM_H_
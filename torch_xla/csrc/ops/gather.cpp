@@ -32,12 +32,13 @@ Gather::Gather(const torch::lazy::Value& input, int64_t dim,
       dim_(dim) {}
 
 torch::lazy::NodePtr Gather::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<Gather>(operands.at(0), dim_, operands.at(1));
+  return torch_xla::MakeNode<Gather>(operands.at(0), dim_, operands.at(1));
 }
 
 XlaOpVector Gather::Lower(LoweringContext* loctx) const {
   xla::XlaOp input = loctx->GetOutputOp(operand(0));
-  xla::XlaOp index = loctx->GetOutputOp(operand(1));
+  xla::XlaOp index = XlaHelpers::NarrowIndices(
+      loctx->GetOutputOp(operand(1)), XlaHelpers::SizesOfXlaOp(input)[dim_]);
   return ReturnOp(
       xla::TorchGather(input, index, dim_, IsSparseGather(input, index, dim_)),
       loctx);
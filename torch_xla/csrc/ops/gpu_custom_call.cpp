@@ -8,14 +8,13 @@ namespace torch_xla {
 
 GpuCustomCall::GpuCustomCall(torch::lazy::OpList inputs,
                              xla::Shape output_shape,
-                             const std::string& payload)
+                             std::shared_ptr<const CustomKernel> kernel)
     : XlaNode(xla_gpu_custom_call, inputs, std::move(output_shape),
-              /*num_outputs=*/output_shape.tuple_shapes_size(),
-              torch::lazy::MHash(payload)),
-      payload_(payload) {}
+              /*num_outputs=*/output_shape.tuple_shapes_size(), kernel->hash),
+      kernel_(std::move(kernel)) {}
 
 torch::lazy::NodePtr GpuCustomCall::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<GpuCustomCall>(operands, xla_shape(), payload_);
+  return torch_xla::MakeNode<GpuCustomCall>(operands, xla_shape(), kernel_);
 }
 
 XlaOpVector GpuCustomCall::Lower(LoweringContext* loctx) const {
@@ -24,13 +23,13 @@ XlaOpVector GpuCustomCall::Lower(LoweringContext* loctx) const {
   for (auto& operand : operands()) {
     inputs.push_back(loctx->GetOutputOp(operand));
   }
-  auto output = BuildGpuCustomCall(inputs, xla_shape(), payload_);
+  auto output = BuildGpuCustomCall(inputs, xla_shape(), kernel_->payload);
   return ReturnOps(output, loctx);
 }
 
 std::string GpuCustomCall::ToString() const {
   std::stringstream ss;
-  ss << XlaNode::ToString() << ", " << payload_;
+  ss << XlaNode::ToString() << ", kernel_id=" << kernel_->id;
   return ss.str();
 }
 
@@ -0,0 +1,82 @@
+#include "torch_xla/csrc/ops/grouped_matmul.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+
+GroupedMatmul::GroupedMatmul(const torch::lazy::Value& lhs,
+                             const torch::lazy::Value& rhs,
+                             const torch::lazy::Value& group_sizes,
+                             bool transpose_rhs, int64_t tile_rows)
+    : XlaNode(
+          xla_grouped_matmul, {lhs, rhs, group_sizes},
+          [&]() {
+            const xla::Shape& lhs_shape = GetXlaShape(lhs);
+            const xla::Shape& rhs_shape = GetXlaShape(rhs);
+            return xla::ShapeUtil::MakeShape(
+                lhs_shape.element_type(),
+                {lhs_shape.dimensions(0),
+                 rhs_shape.dimensions(transpose_rhs ? 1 : 2)});
+          },
+          /*num_outputs=*/1, torch::lazy::MHash(transpose_rhs, tile_rows)),
+      transpose_rhs_(transpose_rhs),
+      tile_rows_(tile_rows) {}
+
+torch::lazy::NodePtr GroupedMatmul::Clone(torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<GroupedMatmul>(operands.at(0), operands.at(1),
+                                              operands.at(2), transpose_rhs_,
+                                              tile_rows_);
+}
+
+XlaOpVector GroupedMatmul::Lower(LoweringContext* loctx) const {
+  xla::XlaOp output = BuildGroupedMatmul(
+      loctx->GetOutputOp(operand(0)), loctx->GetOutputOp(operand(1)),
+      loctx->GetOutputOp(operand(2)), transpose_rhs_, tile_rows_);
+  return ReturnOp(output, loctx);
+}
+
+std::string GroupedMatmul::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", transpose_rhs=" << transpose_rhs_
+     << ", tile_rows=" << tile_rows_;
+  return ss.str();
+}
+
+TransposedGroupedMatmul::TransposedGroupedMatmul(
+    const torch::lazy::Value& lhs, const torch::lazy::Value& rhs,
+    const torch::lazy::Value& group_sizes, int64_t tile_rows)
+    : XlaNode(
+          xla_transposed_grouped_matmul, {lhs, rhs, group_sizes},
+          [&]() {
+            const xla::Shape& lhs_shape = GetXlaShape(lhs);
+            return xla::ShapeUtil::MakeShape(
+                lhs_shape.element_type(),
+                {GetXlaShape(group_sizes).dimensions(0),
+                 lhs_shape.dimensions(1), GetXlaShape(rhs).dimensions(1)});
+          },
+          /*num_outputs=*/1, torch::lazy::MHash(tile_rows)),
+      tile_rows_(tile_rows) {}
+
+torch::lazy::NodePtr TransposedGroupedMatmul::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<TransposedGroupedMatmul>(
+      operands.at(0), operands.at(1), operands.at(2), tile_rows_);
+}
+
+XlaOpVector TransposedGroupedMatmul::Lower(LoweringContext* loctx) const {
+  xla::XlaOp output = BuildTransposedGroupedMatmul(
+      loctx->GetOutputOp(operand(0)), loctx->GetOutputOp(operand(1)),
+      loctx->GetOutputOp(operand(2)), tile_rows_);
+  return ReturnOp(output, loctx);
+}
+
+std::string TransposedGroupedMatmul::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", tile_rows=" << tile_rows_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
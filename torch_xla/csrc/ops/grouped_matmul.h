@@ -0,0 +1,54 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_GROUPED_MATMUL_H_
+#define XLA_TORCH_XLA_CSRC_OPS_GROUPED_MATMUL_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The operands are the [m, k] lhs, the [groups, k, n] rhs ([groups, n, k] with
+// transpose_rhs) and the [groups] group sizes. The output is [m, n].
+class GroupedMatmul : public XlaNode {
+ public:
+  GroupedMatmul(const torch::lazy::Value& lhs, const torch::lazy::Value& rhs,
+                const torch::lazy::Value& group_sizes, bool transpose_rhs,
+                int64_t tile_rows);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  bool transpose_rhs() const { return transpose_rhs_; }
+
+  int64_t tile_rows() const { return tile_rows_; }
+
+ private:
+  bool transpose_rhs_;
+  int64_t tile_rows_;
+};
+
+// The operands are the [m, k] lhs, the [m, n] rhs and the [groups] group
+// sizes. The output is [groups, k, n].
+class TransposedGroupedMatmul : public XlaNode {
+ public:
+  TransposedGroupedMatmul(const torch::lazy::Value& lhs,
+                          const torch::lazy::Value& rhs,
+                          const torch::lazy::Value& group_sizes,
+                          int64_t tile_rows);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t tile_rows() const { return tile_rows_; }
+
+ private:
+  int64_t tile_rows_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_GROUPED_MATMUL_H_
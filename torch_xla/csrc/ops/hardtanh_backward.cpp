@@ -25,7 +25,7 @@ std::string HardtanhBackward::ToString() const {
 
 torch::lazy::NodePtr HardtanhBackward::Clone(
     torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<HardtanhBackward>(operands.at(0), operands.at(1),
+  return torch_xla::MakeNode<HardtanhBackward>(operands.at(0), operands.at(1),
                                                  min_val_, max_val_);
 }
 
@@ -22,7 +22,7 @@ std::string IndexPut::ToString() const {
 }
 
 torch::lazy::NodePtr IndexPut::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<IndexPut>(
+  return torch_xla::MakeNode<IndexPut>(
       operands.at(0), operands.at(1), start_dim_, operands.at(2), accumulate_);
 }
 
@@ -29,13 +29,14 @@ IndexSelect::IndexSelect(const torch::lazy::Value& input, int64_t dim,
       dim_(dim) {}
 
 torch::lazy::NodePtr IndexSelect::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<IndexSelect>(operands.at(0), dim_,
+  return torch_xla::MakeNode<IndexSelect>(operands.at(0), dim_,
                                             operands.at(1));
 }
 
 XlaOpVector IndexSelect::Lower(LoweringContext* loctx) const {
   xla::XlaOp input = loctx->GetOutputOp(operand(0));
-  xla::XlaOp index = loctx->GetOutputOp(operand(1));
+  xla::XlaOp index = XlaHelpers::NarrowIndices(
+      loctx->GetOutputOp(operand(1)), XlaHelpers::SizesOfXlaOp(input)[dim_]);
   return ReturnOp(xla::TorchIndexSelect(input, index, dim_), loctx);
 }
 
@@ -0,0 +1,93 @@
+#include "torch_xla/csrc/ops/kv_cache_update.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "xla/client/lib/constants.h"
+#include "xla/client/xla_builder.h"
+
+namespace torch_xla {
+
+KvCacheUpdate::KvCacheUpdate(const torch::lazy::Value& cache,
+                             const torch::lazy::Value& update,
+                             const torch::lazy::Value& position, int64_t dim)
+    : XlaNode(xla_kv_cache_update, {cache, update, position},
+              GetXlaShape(cache), /*num_outputs=*/1, torch::lazy::MHash(dim)),
+      dim_(dim) {}
+
+torch::lazy::NodePtr KvCacheUpdate::Clone(torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<KvCacheUpdate>(operands.at(0), operands.at(1),
+                                            operands.at(2), dim_);
+}
+
+XlaOpVector KvCacheUpdate::Lower(LoweringContext* loctx) const {
+  xla::XlaOp cache = loctx->GetOutputOp(operand(0));
+  xla::XlaOp update = loctx->GetOutputOp(operand(1));
+  xla::XlaOp position = xla::ConvertElementType(
+      loctx->GetOutputOp(operand(2)), xla::PrimitiveType::S32);
+  std::vector<xla::XlaOp> start_indices(
+      GetXlaShape(operand(0)).rank(),
+      xla::Zero(loctx->builder(), xla::PrimitiveType::S32));
+  start_indices[dim_] = position;
+  return ReturnOp(xla::DynamicUpdateSlice(cache, update, start_indices),
+                  loctx);
+}
+
+std::string KvCacheUpdate::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", dim=" << dim_;
+  return ss.str();
+}
+
+KvCacheRollback::KvCacheRollback(const torch::lazy::Value& cache,
+                                 const torch::lazy::Value& position,
+                                 const torch::lazy::Value& accepted,
+                                 int64_t window, int64_t dim)
+    : XlaNode(xla_kv_cache_rollback, {cache, position, accepted},
+              GetXlaShape(cache), /*num_outputs=*/1,
+              torch::lazy::MHash(window, dim)),
+      window_(window),
+      dim_(dim) {}
+
+torch::lazy::NodePtr KvCacheRollback::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<KvCacheRollback>(operands.at(0), operands.at(1),
+                                              operands.at(2), window_, dim_);
+}
+
+XlaOpVector KvCacheRollback::Lower(LoweringContext* loctx) const {
+  xla::XlaBuilder* builder = loctx->builder();
+  xla::XlaOp cache = loctx->GetOutputOp(operand(0));
+  xla::XlaOp position = xla::ConvertElementType(
+      loctx->GetOutputOp(operand(1)), xla::PrimitiveType::S32);
+  xla::XlaOp accepted = xla::ConvertElementType(
+      loctx->GetOutputOp(operand(2)), xla::PrimitiveType::S32);
+  const xla::Shape& cache_shape = GetXlaShape(operand(0));
+  // The dynamic slices clamp their start so that the window fits; the window
+  // start is clamped the same way to keep the accepted entries in place.
+  int64_t max_start = cache_shape.dimensions(dim_) - window_;
+  xla::XlaOp start = xla::Clamp(
+      xla::Zero(builder, xla::PrimitiveType::S32), position,
+      xla::ConstantR0<int32_t>(builder, static_cast<int32_t>(max_start)));
+  std::vector<xla::XlaOp> start_indices(
+      cache_shape.rank(), xla::Zero(builder, xla::PrimitiveType::S32));
+  start_indices[dim_] = start;
+  std::vector<int64_t> window_sizes(cache_shape.dimensions().begin(),
+                                    cache_shape.dimensions().end());
+  window_sizes[dim_] = window_;
+  xla::XlaOp entries = xla::DynamicSlice(cache, start_indices, window_sizes);
+  xla::Shape window_shape =
+      xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32, window_sizes);
+  xla::XlaOp kept = xla::Lt(
+      xla::Iota(builder, window_shape, dim_) + start, position + accepted);
+  entries = xla::Select(kept, entries, xla::ZerosLike(entries));
+  return ReturnOp(xla::DynamicUpdateSlice(cache, entries, start_indices),
+                  loctx);
+}
+
+std::string KvCacheRollback::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", window=" << window_ << ", dim=" << dim_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
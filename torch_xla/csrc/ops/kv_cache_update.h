@@ -0,0 +1,58 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_KV_CACHE_UPDATE_H_
+#define XLA_TORCH_XLA_CSRC_OPS_KV_CACHE_UPDATE_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The cache with the update written at the scalar position along dim, as a
+// dynamic update slice. The position being an operand, the graph is the same
+// whatever position is written.
+class KvCacheUpdate : public XlaNode {
+ public:
+  KvCacheUpdate(const torch::lazy::Value& cache,
+                const torch::lazy::Value& update,
+                const torch::lazy::Value& position, int64_t dim);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t dim() const { return dim_; }
+
+ private:
+  int64_t dim_;
+};
+
+// The cache with the entries [position + accepted, position + window) along
+// dim zeroed, rolling back the tail of a window of `window` entries written
+// from the scalar position of which only the scalar `accepted` first ones are
+// kept. Only the window is sliced and written back, and the graph is keyed by
+// the window size alone.
+class KvCacheRollback : public XlaNode {
+ public:
+  KvCacheRollback(const torch::lazy::Value& cache,
+                  const torch::lazy::Value& position,
+                  const torch::lazy::Value& accepted, int64_t window,
+                  int64_t dim);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t window() const { return window_; }
+
+  int64_t dim() const { return dim_; }
+
+ private:
+  int64_t window_;
+  int64_t dim_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_KV_CACHE_UPDATE_H_
@@ -0,0 +1,74 @@
+#include "torch_xla/csrc/ops/masked_scaled_softmax.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/runtime/util.h"
+#include "torch_xla/csrc/softmax_builder.h"
+
+namespace torch_xla {
+
+MaskedScaledSoftmax::MaskedScaledSoftmax(
+    const torch::lazy::Value& logits,
+    const absl::optional<torch::lazy::Value>& mask, double scale, bool causal)
+    : XlaNode(xla_masked_scaled_softmax,
+              torch_xla::runtime::util::GetValuesVector<torch::lazy::Value>(
+                  {logits}, {&mask}),
+              GetXlaShape(logits), /*num_outputs=*/1,
+              torch::lazy::MHash(scale, causal)),
+      scale_(scale),
+      causal_(causal) {}
+
+torch::lazy::NodePtr MaskedScaledSoftmax::Clone(
+    torch::lazy::OpList operands) const {
+  absl::optional<torch::lazy::Value> mask;
+  if (operands.size() > 1) {
+    mask = operands.at(1);
+  }
+  return torch_xla::MakeNode<MaskedScaledSoftmax>(operands.at(0), mask,
+                                                    scale_, causal_);
+}
+
+XlaOpVector MaskedScaledSoftmax::Lower(LoweringContext* loctx) const {
+  xla::XlaOp logits = loctx->GetOutputOp(operand(0));
+  absl::optional<xla::XlaOp> mask;
+  if (operands().size() > 1) {
+    mask = loctx->GetOutputOp(operand(1));
+  }
+  return ReturnOp(BuildMaskedScaledSoftmax(logits, mask, scale_, causal_),
+                  loctx);
+}
+
+std::string MaskedScaledSoftmax::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", scale=" << scale_ << ", causal=" << causal_;
+  return ss.str();
+}
+
+MaskedScaledSoftmaxBackward::MaskedScaledSoftmaxBackward(
+    const torch::lazy::Value& grad_output, const torch::lazy::Value& output,
+    double scale)
+    : XlaNode(xla_masked_scaled_softmax_backward, {grad_output, output},
+              GetXlaShape(output), /*num_outputs=*/1,
+              torch::lazy::MHash(scale)),
+      scale_(scale) {}
+
+torch::lazy::NodePtr MaskedScaledSoftmaxBackward::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<MaskedScaledSoftmaxBackward>(
+      operands.at(0), operands.at(1), scale_);
+}
+
+XlaOpVector MaskedScaledSoftmaxBackward::Lower(LoweringContext* loctx) const {
+  xla::XlaOp grad_output = loctx->GetOutputOp(operand(0));
+  xla::XlaOp output = loctx->GetOutputOp(operand(1));
+  return ReturnOp(BuildMaskedScaledSoftmaxGrad(grad_output, output, scale_),
+                  loctx);
+}
+
+std::string MaskedScaledSoftmaxBackward::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", scale=" << scale_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,50 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_MASKED_SCALED_SOFTMAX_H_
+#define XLA_TORCH_XLA_CSRC_OPS_MASKED_SCALED_SOFTMAX_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The softmax over the last dimension of logits * scale, with the optional
+// boolean or additive mask and the causal mask applied within the op.
+class MaskedScaledSoftmax : public XlaNode {
+ public:
+  MaskedScaledSoftmax(const torch::lazy::Value& logits,
+                      const absl::optional<torch::lazy::Value>& mask,
+                      double scale, bool causal);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  double scale() const { return scale_; }
+
+  bool causal() const { return causal_; }
+
+ private:
+  double scale_;
+  bool causal_;
+};
+
+class MaskedScaledSoftmaxBackward : public XlaNode {
+ public:
+  MaskedScaledSoftmaxBackward(const torch::lazy::Value& grad_output,
+                              const torch::lazy::Value& output, double scale);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  double scale() const { return scale_; }
+
+ private:
+  double scale_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_MASKED_SCALED_SOFTMAX_H_
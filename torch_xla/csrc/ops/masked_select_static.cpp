@@ -0,0 +1,49 @@
+#include "torch_xla/csrc/ops/masked_select_static.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& input, int64_t size) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  return xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(input_shape.element_type(), {size}),
+       xla::ShapeUtil::MakeShape(xla::PrimitiveType::S64, {})});
+}
+
+}  // namespace
+
+MaskedSelectStatic::MaskedSelectStatic(const torch::lazy::Value& input,
+                                       const torch::lazy::Value& mask,
+                                       const torch::lazy::Value& fill_value,
+                                       int64_t size)
+    : XlaNode(xla_masked_select_static, {input, mask, fill_value},
+              NodeOutputShape(input, size),
+              /*num_outputs=*/2, torch::lazy::MHash(size)),
+      size_(size) {}
+
+torch::lazy::NodePtr MaskedSelectStatic::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<MaskedSelectStatic>(
+      operands.at(0), operands.at(1), operands.at(2), size_);
+}
+
+XlaOpVector MaskedSelectStatic::Lower(LoweringContext* loctx) const {
+  xla::XlaOp input = loctx->GetOutputOp(operand(0));
+  xla::XlaOp mask = loctx->GetOutputOp(operand(1));
+  xla::XlaOp fill_value = loctx->GetOutputOp(operand(2));
+  return ReturnOps(BuildMaskedSelectStatic(input, mask, fill_value, size_),
+                   loctx);
+}
+
+std::string MaskedSelectStatic::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", size=" << size_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,31 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_MASKED_SELECT_STATIC_H_
+#define XLA_TORCH_XLA_CSRC_OPS_MASKED_SELECT_STATIC_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The operands are the input, the mask and the scalar fill value. The outputs
+// are the first `size` selected elements, padded with the fill value, and the
+// number of selected elements.
+class MaskedSelectStatic : public XlaNode {
+ public:
+  MaskedSelectStatic(const torch::lazy::Value& input,
+                     const torch::lazy::Value& mask,
+                     const torch::lazy::Value& fill_value, int64_t size);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t size() const { return size_; }
+
+ private:
+  int64_t size_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_MASKED_SELECT_STATIC_H_
@@ -0,0 +1,76 @@
+#include "torch_xla/csrc/ops/metric_accumulate.h"
+
+#include "torch_xla/csrc/helpers.h"
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "xla/client/lib/constants.h"
+#include "xla/client/xla_builder.h"
+
+namespace torch_xla {
+
+MetricAccumulate::MetricAccumulate(const torch::lazy::Value& state,
+                                   const torch::lazy::Value& value,
+                                   const torch::lazy::Value& weight,
+                                   MetricReduction reduction)
+    : XlaNode(xla_metric_accumulate, {state, value, weight},
+              GetXlaShape(state), /*num_outputs=*/1,
+              torch::lazy::MHash(static_cast<int64_t>(reduction))),
+      reduction_(reduction) {}
+
+torch::lazy::NodePtr MetricAccumulate::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<MetricAccumulate>(operands.at(0), operands.at(1),
+                                               operands.at(2), reduction_);
+}
+
+XlaOpVector MetricAccumulate::Lower(LoweringContext* loctx) const {
+  constexpr xla::PrimitiveType kF32 = xla::PrimitiveType::F32;
+  xla::XlaBuilder* builder = loctx->builder();
+  xla::XlaOp state = loctx->GetOutputOp(operand(0));
+  xla::XlaOp value =
+      xla::ConvertElementType(loctx->GetOutputOp(operand(1)), kF32);
+  xla::XlaOp weight =
+      xla::ConvertElementType(loctx->GetOutputOp(operand(2)), kF32);
+  // The conversions keep the dimensions, which is all the broadcast needs.
+  xla::Shape value_shape = GetXlaShape(operand(1));
+  xla::Shape weight_shape = GetXlaShape(operand(2));
+  value_shape.set_element_type(kF32);
+  weight_shape.set_element_type(kF32);
+  weight = XlaHelpers::ImplicitBroadcast(weight, weight_shape, value_shape);
+
+  xla::XlaOp previous = xla::Reshape(xla::SliceInDim(state, 0, 1, 1, 0), {});
+  xla::XlaOp count = xla::Reshape(xla::SliceInDim(state, 1, 2, 1, 0), {});
+  xla::XlaOp zero = xla::Zero(builder, kF32);
+  xla::XlaComputation add = XlaHelpers::CreateAddComputation(kF32);
+  xla::XlaOp accumulated;
+  switch (reduction_) {
+    case MetricReduction::kSum:
+      accumulated = previous + xla::ReduceAll(value * weight, zero, add);
+      break;
+    case MetricReduction::kMax:
+      accumulated = xla::Max(
+          previous, xla::ReduceAll(value, xla::MinValue(builder, kF32),
+                                   XlaHelpers::CreateMaxComputation(kF32)));
+      break;
+    case MetricReduction::kMin:
+      accumulated = xla::Min(
+          previous, xla::ReduceAll(value, xla::MaxValue(builder, kF32),
+                                   XlaHelpers::CreateMinComputation(kF32)));
+      break;
+  }
+  count = count + xla::ReduceAll(weight, zero, add);
+  return ReturnOp(
+      xla::ConcatInDim(
+          builder, {xla::Reshape(accumulated, {1}), xla::Reshape(count, {1})},
+          0),
+      loctx);
+}
+
+std::string MetricAccumulate::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString()
+     << ", reduction=" << static_cast<int64_t>(reduction_);
+  return ss.str();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,37 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_METRIC_ACCUMULATE_H_
+#define XLA_TORCH_XLA_CSRC_OPS_METRIC_ACCUMULATE_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The reductions of the values accumulated into a device metric.
+enum class MetricReduction : int64_t { kSum = 0, kMax = 1, kMin = 2 };
+
+// The F32 [2] state of a device metric updated with the values of `value`:
+// the sum (of the values weighted by the scalar or value shaped `weight`),
+// maximum or minimum of the values accumulated so far, and their count (the
+// sum of their weights). The state stays on the device, so that the update is
+// part of the step graph and the metric is only read when fetched.
+class MetricAccumulate : public XlaNode {
+ public:
+  MetricAccumulate(const torch::lazy::Value& state,
+                   const torch::lazy::Value& value,
+                   const torch::lazy::Value& weight,
+                   MetricReduction reduction);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  MetricReduction reduction() const { return reduction_; }
+
+ private:
+  MetricReduction reduction_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_METRIC_ACCUMULATE_H_
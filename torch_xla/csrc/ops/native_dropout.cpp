@@ -25,7 +25,7 @@ NativeDropout::NativeDropout(const torch::lazy::Value& input,
       train_(train) {}
 
 torch::lazy::NodePtr NativeDropout::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<NativeDropout>(operands.at(0), operands.at(1),
+  return torch_xla::MakeNode<NativeDropout>(operands.at(0), operands.at(1),
                                               p_, train_);
 }
 
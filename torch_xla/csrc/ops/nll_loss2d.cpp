@@ -58,7 +58,7 @@ torch::lazy::NodePtr NllLoss2d::Clone(torch::lazy::OpList operands) const {
   if (operands.size() > 2) {
     weight = operands.at(2);
   }
-  return torch::lazy::MakeNode<NllLoss2d>(operands.at(0), operands.at(1),
+  return torch_xla::MakeNode<NllLoss2d>(operands.at(0), operands.at(1),
                                           weight, reduction_, ignore_index_);
 }
 
@@ -32,7 +32,7 @@ Nms::Nms(const torch::lazy::Value& boxes, const torch::lazy::Value& scores,
           [&]() { return NodeOutputShape(boxes, scores, iou_threshold); }) {}
 
 torch::lazy::NodePtr Nms::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<Nms>(operands.at(0), operands.at(1),
+  return torch_xla::MakeNode<Nms>(operands.at(0), operands.at(1),
                                     operands.at(2));
 }
 
@@ -0,0 +1,45 @@
+#include "torch_xla/csrc/ops/nonzero_static.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& input, int64_t size) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  return xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(xla::PrimitiveType::S64,
+                                 {size, input_shape.rank()}),
+       xla::ShapeUtil::MakeShape(xla::PrimitiveType::S64, {})});
+}
+
+}  // namespace
+
+NonZeroStatic::NonZeroStatic(const torch::lazy::Value& input, int64_t size,
+                             int64_t fill_value)
+    : XlaNode(torch::lazy::OpKind(at::aten::nonzero_static), {input},
+              NodeOutputShape(input, size),
+              /*num_outputs=*/2, torch::lazy::MHash(size, fill_value)),
+      size_(size),
+      fill_value_(fill_value) {}
+
+torch::lazy::NodePtr NonZeroStatic::Clone(torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<NonZeroStatic>(operands.at(0), size_,
+                                              fill_value_);
+}
+
+XlaOpVector NonZeroStatic::Lower(LoweringContext* loctx) const {
+  xla::XlaOp input = loctx->GetOutputOp(operand(0));
+  return ReturnOps(BuildNonZeroStatic(input, size_, fill_value_), loctx);
+}
+
+std::string NonZeroStatic::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", size=" << size_
+     << ", fill_value=" << fill_value_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
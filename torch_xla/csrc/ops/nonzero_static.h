@@ -0,0 +1,32 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_NONZERO_STATIC_H_
+#define XLA_TORCH_XLA_CSRC_OPS_NONZERO_STATIC_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The outputs are the [size, rank] indices of the first `size` nonzero
+// elements, padded with `fill_value`, and the number of nonzero elements.
+class NonZeroStatic : public XlaNode {
+ public:
+  NonZeroStatic(const torch::lazy::Value& input, int64_t size,
+                int64_t fill_value);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t size() const { return size_; }
+
+  int64_t fill_value() const { return fill_value_; }
+
+ private:
+  int64_t size_;
+  int64_t fill_value_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_NONZERO_STATIC_H_
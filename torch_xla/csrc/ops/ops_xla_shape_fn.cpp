@@ -7,6 +7,7 @@
 #include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/pooling.h"
 #include "torch_xla/csrc/reduction.h"
+#include "torch_xla/csrc/tensor_util.h"
 #include "torch_xla/csrc/xla_lower_util.h"
 #include "xla/client/lib/logdet.h"
 #include "xla/shape_util.h"
@@ -41,6 +42,70 @@ xla::Shape InferBinaryOpShape(const torch::lazy::Value& first,
 
   return InferOutputShape(shapes, lower_for_shape_fn);
 }
+
+// The closed form shapes below spare building the op to infer its shape. They
+// only handle the static shapes, the dynamic ones still being inferred from
+// the lowering.
+
+// The shape of the reduction of `dimensions` of `shape`, keeping them as 1s if
+// `keepdim`.
+xla::Shape ReducedShape(const xla::Shape& shape,
+                        absl::Span<const int64_t> dimensions, bool keepdim,
+                        xla::PrimitiveType type) {
+  std::vector<bool> reduced(shape.rank(), false);
+  for (int64_t dim : torch::lazy::GetCanonicalDimensionIndices(
+           std::vector<int64_t>(dimensions.begin(), dimensions.end()),
+           shape.rank())) {
+    reduced[dim] = true;
+  }
+  std::vector<int64_t> sizes;
+  for (int64_t i = 0; i < shape.rank(); ++i) {
+    if (!reduced[i]) {
+      sizes.push_back(shape.dimensions(i));
+    } else if (keepdim) {
+      sizes.push_back(1);
+    }
+  }
+  return xla::ShapeUtil::MakeShape(type, sizes);
+}
+
+// The type of the result of BuildAll() and BuildAny().
+xla::PrimitiveType LogicalReductionType(xla::PrimitiveType type) {
+  return type == xla::PrimitiveType::U8 ? xla::PrimitiveType::U8
+                                        : xla::PrimitiveType::PRED;
+}
+
+xla::Shape BroadcastShape(const xla::Shape& shape1, const xla::Shape& shape2,
+                          xla::PrimitiveType type) {
+  return xla::ShapeUtil::MakeShape(
+      type, XlaHelpers::GetPromotedShape(shape1, shape2).dimensions());
+}
+
+xla::Shape ComparisonOpShape(c10::Symbol kind, const torch::lazy::Value& self,
+                             const torch::lazy::Value& other) {
+  const xla::Shape& self_shape = GetXlaShape(self);
+  const xla::Shape& other_shape = GetXlaShape(other);
+  if (self_shape.is_static() && other_shape.is_static()) {
+    return BroadcastShape(self_shape, other_shape, xla::PrimitiveType::PRED);
+  }
+  auto lower_for_shape_fn =
+      [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
+    return BuildComparisonOp(kind, operands[0], operands[1]);
+  };
+  return InferOutputShape({self_shape, other_shape}, lower_for_shape_fn);
+}
+
+xla::Shape ArgMinMaxShape(const xla::Shape& input_shape,
+                          c10::optional<int64_t> dim, bool keepdim) {
+  xla::PrimitiveType type =
+      GetXlaPrimitiveTypeForCurrentDevice(xla::PrimitiveType::S64);
+  if (dim.has_value()) {
+    return ReducedShape(input_shape, {*dim}, keepdim, type);
+  }
+  // The input is flattened, and the kept dimensions are all 1s.
+  return xla::ShapeUtil::MakeShape(
+      type, std::vector<int64_t>(keepdim ? input_shape.rank() : 0, 1));
+}
 }  // namespace
 
 xla::Shape AbsOutputShape(const torch::lazy::Value& input) {
@@ -133,8 +198,13 @@ xla::Shape AddcmulOutputShape(const torch::lazy::Value& input,
 }
 
 xla::Shape AllOutputShape(const torch::lazy::Value& input) {
+  const xla::Shape& input_shape = GetXlaShape(input);
   std::vector<int64_t> dimensions =
-      torch::lazy::Iota<int64_t>(GetXlaShape(input).rank());
+      torch::lazy::Iota<int64_t>(input_shape.rank());
+  if (input_shape.is_static()) {
+    return ReducedShape(input_shape, dimensions, false,
+                        LogicalReductionType(input_shape.element_type()));
+  }
   auto lower_for_shape_fn =
       [dimensions](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildAll(operands[0], dimensions, false);
@@ -145,6 +215,11 @@ xla::Shape AllOutputShape(const torch::lazy::Value& input) {
 
 xla::Shape AllDimOutputShape(const torch::lazy::Value& input, const int64_t dim,
                              const bool keepdim) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  if (input_shape.is_static()) {
+    return ReducedShape(input_shape, {dim}, keepdim,
+                        LogicalReductionType(input_shape.element_type()));
+  }
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     xla::XlaOp ret = BuildAll(operands[0], {dim}, keepdim);
@@ -156,6 +231,10 @@ xla::Shape AllDimOutputShape(const torch::lazy::Value& input, const int64_t dim,
 
 xla::Shape AmaxOutputShape(const torch::lazy::Value& input,
                            absl::Span<const int64_t> dim, bool keepdim) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  if (input_shape.is_static()) {
+    return ReducedShape(input_shape, dim, keepdim, input_shape.element_type());
+  }
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildMaxInDims(operands[0], dim, keepdim);
@@ -165,6 +244,10 @@ xla::Shape AmaxOutputShape(const torch::lazy::Value& input,
 
 xla::Shape AminOutputShape(const torch::lazy::Value& input,
                            absl::Span<const int64_t> dim, bool keepdim) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  if (input_shape.is_static()) {
+    return ReducedShape(input_shape, dim, keepdim, input_shape.element_type());
+  }
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildMinInDims(operands[0], dim, keepdim);
@@ -173,8 +256,13 @@ xla::Shape AminOutputShape(const torch::lazy::Value& input,
 }
 
 xla::Shape AnyOutputShape(const torch::lazy::Value& input) {
+  const xla::Shape& input_shape = GetXlaShape(input);
   std::vector<int64_t> dimensions =
-      torch::lazy::Iota<int64_t>(GetXlaShape(input).rank());
+      torch::lazy::Iota<int64_t>(input_shape.rank());
+  if (input_shape.is_static()) {
+    return ReducedShape(input_shape, dimensions, false,
+                        LogicalReductionType(input_shape.element_type()));
+  }
   auto lower_for_shape_fn =
       [dimensions](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildAny(operands[0], dimensions, false);
@@ -184,6 +272,11 @@ xla::Shape AnyOutputShape(const torch::lazy::Value& input) {
 
 xla::Shape AnyDimOutputShape(const torch::lazy::Value& input, int64_t dim,
                              bool keepdim) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  if (input_shape.is_static()) {
+    return ReducedShape(input_shape, {dim}, keepdim,
+                        LogicalReductionType(input_shape.element_type()));
+  }
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return BuildAny(operands[0], {dim}, keepdim);
@@ -193,6 +286,9 @@ xla::Shape AnyDimOutputShape(const torch::lazy::Value& input, int64_t dim,
 
 xla::Shape ArgmaxOutputShape(const torch::lazy::Value& input,
                              c10::optional<int64_t> dim, bool keepdim) {
+  if (GetXlaShape(input).is_static()) {
+    return ArgMinMaxShape(GetXlaShape(input), dim, keepdim);
+  }
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     if (dim.has_value()) {
@@ -209,6 +305,9 @@ xla::Shape ArgmaxOutputShape(const torch::lazy::Value& input,
 
 xla::Shape ArgminOutputShape(const torch::lazy::Value& input,
                              c10::optional<int64_t> dim, bool keepdim) {
+  if (GetXlaShape(input).is_static()) {
+    return ArgMinMaxShape(GetXlaShape(input), dim, keepdim);
+  }
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     if (dim.has_value()) {
@@ -449,12 +548,7 @@ xla::Shape EluOutputShape(const torch::lazy::Value& input,
 
 xla::Shape EqScalarOutputShape(const torch::lazy::Value& self,
                                const torch::lazy::Value& other) {
-  auto lower_for_shape_fn =
-      [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
-    return BuildComparisonOp(at::aten::eq, operands[0], operands[1]);
-  };
-  return InferOutputShape({GetXlaShape(self), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  return ComparisonOpShape(at::aten::eq, self, other);
 }
 
 xla::Shape EqTensorOutputShape(const torch::lazy::Value& self,
@@ -504,12 +598,7 @@ xla::Shape FracOutputShape(const torch::lazy::Value& input) {
 
 xla::Shape GeScalarOutputShape(const torch::lazy::Value& self,
                                const torch::lazy::Value& other) {
-  auto lower_for_shape_fn =
-      [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
-    return BuildComparisonOp(at::aten::ge, operands[0], operands[1]);
-  };
-  return InferOutputShape({GetXlaShape(self), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  return ComparisonOpShape(at::aten::ge, self, other);
 }
 
 xla::Shape GeTensorOutputShape(const torch::lazy::Value& self,
@@ -534,12 +623,7 @@ xla::Shape GluOutputShape(const torch::lazy::Value& input, int64_t dim) {
 
 xla::Shape GtScalarOutputShape(const torch::lazy::Value& self,
                                const torch::lazy::Value& other) {
-  auto lower_for_shape_fn =
-      [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
-    return BuildComparisonOp(at::aten::gt, operands[0], operands[1]);
-  };
-  return InferOutputShape({GetXlaShape(self), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  return ComparisonOpShape(at::aten::gt, self, other);
 }
 
 xla::Shape GtTensorOutputShape(const torch::lazy::Value& self,
@@ -612,12 +696,7 @@ xla::Shape LeakyReluBackwardOutputShape(
 
 xla::Shape LeScalarOutputShape(const torch::lazy::Value& self,
                                const torch::lazy::Value& other) {
-  auto lower_for_shape_fn =
-      [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
-    return BuildComparisonOp(at::aten::le, operands[0], operands[1]);
-  };
-  return InferOutputShape({GetXlaShape(self), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  return ComparisonOpShape(at::aten::le, self, other);
 }
 
 xla::Shape LeTensorOutputShape(const torch::lazy::Value& self,
@@ -627,12 +706,7 @@ xla::Shape LeTensorOutputShape(const torch::lazy::Value& self,
 
 xla::Shape LtScalarOutputShape(const torch::lazy::Value& self,
                                const torch::lazy::Value& other) {
-  auto lower_for_shape_fn =
-      [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
-    return BuildComparisonOp(at::aten::lt, operands[0], operands[1]);
-  };
-  return InferOutputShape({GetXlaShape(self), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  return ComparisonOpShape(at::aten::lt, self, other);
 }
 
 xla::Shape LtTensorOutputShape(const torch::lazy::Value& self,
@@ -652,6 +726,11 @@ xla::Shape LogdetOutputShape(const torch::lazy::Value& input) {
 
 xla::Shape LogicalAndOutputShape(const torch::lazy::Value& input,
                                  const torch::lazy::Value& other) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  const xla::Shape& other_shape = GetXlaShape(other);
+  if (input_shape.is_static() && other_shape.is_static()) {
+    return BroadcastShape(input_shape, other_shape, xla::PrimitiveType::PRED);
+  }
   auto shape_fn = [](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return XlaHelpers::PromotedLogicalBinaryOp(
         operands[0], operands[1], [](xla::XlaOp lhs, xla::XlaOp rhs) {
@@ -659,10 +738,14 @@ xla::Shape LogicalAndOutputShape(const torch::lazy::Value& input,
                           XlaHelpers::getBroadcastDimensions(lhs, rhs));
         });
   };
-  return InferOutputShape({GetXlaShape(input), GetXlaShape(other)}, shape_fn);
+  return InferOutputShape({input_shape, other_shape}, shape_fn);
 }
 
 xla::Shape LogicalNotOutputShape(const torch::lazy::Value& input) {
+  if (GetXlaShape(input).is_static()) {
+    return xla::ShapeUtil::ChangeElementType(GetXlaShape(input),
+                                             xla::PrimitiveType::PRED);
+  }
   auto shape_fn = [](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return XlaHelpers::PromotedLogicalUnaryOp(
         operands[0], [](xla::XlaOp lhs) { return xla::Not(lhs); });
@@ -672,6 +755,11 @@ xla::Shape LogicalNotOutputShape(const torch::lazy::Value& input) {
 
 xla::Shape LogicalOrOutputShape(const torch::lazy::Value& input,
                                 const torch::lazy::Value& other) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  const xla::Shape& other_shape = GetXlaShape(other);
+  if (input_shape.is_static() && other_shape.is_static()) {
+    return BroadcastShape(input_shape, other_shape, xla::PrimitiveType::PRED);
+  }
   auto shape_fn = [](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return XlaHelpers::PromotedLogicalBinaryOp(
         operands[0], operands[1], [](xla::XlaOp lhs, xla::XlaOp rhs) {
@@ -679,11 +767,16 @@ xla::Shape LogicalOrOutputShape(const torch::lazy::Value& input,
                          XlaHelpers::getBroadcastDimensions(lhs, rhs));
         });
   };
-  return InferOutputShape({GetXlaShape(input), GetXlaShape(other)}, shape_fn);
+  return InferOutputShape({input_shape, other_shape}, shape_fn);
 }
 
 xla::Shape LogicalXorOutputShape(const torch::lazy::Value& input,
                                  const torch::lazy::Value& other) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  const xla::Shape& other_shape = GetXlaShape(other);
+  if (input_shape.is_static() && other_shape.is_static()) {
+    return BroadcastShape(input_shape, other_shape, xla::PrimitiveType::PRED);
+  }
   auto shape_fn = [](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     return XlaHelpers::PromotedLogicalBinaryOp(
         operands[0], operands[1], [](xla::XlaOp lhs, xla::XlaOp rhs) {
@@ -691,7 +784,7 @@ xla::Shape LogicalXorOutputShape(const torch::lazy::Value& input,
                           XlaHelpers::getBroadcastDimensions(lhs, rhs));
         });
   };
-  return InferOutputShape({GetXlaShape(input), GetXlaShape(other)}, shape_fn);
+  return InferOutputShape({input_shape, other_shape}, shape_fn);
 }
 
 xla::Shape LogSigmoidForwardOutputShape(const torch::lazy::Value& input) {
@@ -725,6 +818,11 @@ xla::Shape MaskedFillTensorOutputShape(const torch::lazy::Value& input,
 
 xla::Shape MaximumOutputShape(const torch::lazy::Value& input,
                               const torch::lazy::Value& other) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  const xla::Shape& other_shape = GetXlaShape(other);
+  if (input_shape.is_static() && other_shape.is_static()) {
+    return XlaHelpers::GetPromotedBinaryOpShape(input_shape, other_shape);
+  }
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     auto promoted = XlaHelpers::Promote(operands[0], operands[1]);
@@ -738,6 +836,11 @@ xla::Shape MaximumOutputShape(const torch::lazy::Value& input,
 
 xla::Shape MinimumOutputShape(const torch::lazy::Value& input,
                               const torch::lazy::Value& other) {
+  const xla::Shape& input_shape = GetXlaShape(input);
+  const xla::Shape& other_shape = GetXlaShape(other);
+  if (input_shape.is_static() && other_shape.is_static()) {
+    return XlaHelpers::GetPromotedBinaryOpShape(input_shape, other_shape);
+  }
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     auto promoted = XlaHelpers::Promote(operands[0], operands[1]);
@@ -756,12 +859,7 @@ xla::Shape NativeDropoutBackwardOutputShape(
 
 xla::Shape NeScalarOutputShape(const torch::lazy::Value& self,
                                const torch::lazy::Value& other) {
-  auto lower_for_shape_fn =
-      [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
-    return BuildComparisonOp(at::aten::ne, operands[0], operands[1]);
-  };
-  return InferOutputShape({GetXlaShape(self), GetXlaShape(other)},
-                          lower_for_shape_fn);
+  return ComparisonOpShape(at::aten::ne, self, other);
 }
 
 xla::Shape NeTensorOutputShape(const torch::lazy::Value& self,
@@ -778,6 +876,9 @@ xla::Shape ReciprocalOutputShape(const torch::lazy::Value& input) {
 }
 
 xla::Shape ReluOutputShape(const torch::lazy::Value& input) {
+  if (GetXlaShape(input).is_static()) {
+    return GetXlaShape(input);
+  }
   auto lower_for_shape_fn =
       [](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
     XLA_CHECK_EQ(operands.size(), 1) << "Unexpected number of operands";
@@ -0,0 +1,56 @@
+#include "torch_xla/csrc/ops/quantized_matmul.h"
+
+#include <torch/csrc/lazy/core/util.h>
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& input,
+                           const torch::lazy::Value& weight) {
+  xla::Shape output_shape = GetXlaShape(input);
+  output_shape.set_dimensions(output_shape.rank() - 1,
+                              GetXlaShape(weight).dimensions(0));
+  return output_shape;
+}
+
+}  // namespace
+
+QuantizedMatmul::QuantizedMatmul(const torch::lazy::Value& input,
+                                 const torch::lazy::Value& weight,
+                                 const torch::lazy::Value& scale,
+                                 int64_t block_size, bool int4_weight)
+    : XlaNode(xla_quantized_matmul, {input, weight, scale},
+              NodeOutputShape(input, weight),
+              /*num_outputs=*/1, torch::lazy::MHash(block_size, int4_weight)),
+      block_size_(block_size),
+      int4_weight_(int4_weight) {}
+
+torch::lazy::NodePtr QuantizedMatmul::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<QuantizedMatmul>(
+      operands.at(0), operands.at(1), operands.at(2), block_size_,
+      int4_weight_);
+}
+
+XlaOpVector QuantizedMatmul::Lower(LoweringContext* loctx) const {
+  xla::XlaOp input = loctx->GetOutputOp(operand(0));
+  xla::XlaOp weight = loctx->GetOutputOp(operand(1));
+  xla::XlaOp scale = loctx->GetOutputOp(operand(2));
+  return ReturnOp(BuildWeightOnlyQuantizedMatmul(input, weight, scale,
+                                                 block_size_, int4_weight_),
+                  loctx);
+}
+
+std::string QuantizedMatmul::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", block_size=" << block_size_
+     << ", int4_weight=" << int4_weight_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
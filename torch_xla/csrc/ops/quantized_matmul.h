@@ -0,0 +1,35 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_QUANTIZED_MATMUL_H_
+#define XLA_TORCH_XLA_CSRC_OPS_QUANTIZED_MATMUL_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The weight-only quantized matmul of the [..., in_channels] input with the
+// S8 [out_channels, in_channels] weight, or [out_channels, in_channels / 2]
+// with int4_weight. The dequantization is fused into the dot.
+class QuantizedMatmul : public XlaNode {
+ public:
+  QuantizedMatmul(const torch::lazy::Value& input,
+                  const torch::lazy::Value& weight,
+                  const torch::lazy::Value& scale, int64_t block_size,
+                  bool int4_weight);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t block_size() const { return block_size_; }
+
+  bool int4_weight() const { return int4_weight_; }
+
+ private:
+  int64_t block_size_;
+  bool int4_weight_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_QUANTIZED_MATMUL_H_
@@ -33,7 +33,7 @@ ReplicationPadBackward::ReplicationPadBackward(
 
 torch::lazy::NodePtr ReplicationPadBackward::Clone(
     torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<ReplicationPadBackward>(
+  return torch_xla::MakeNode<ReplicationPadBackward>(
       operands.at(0), operands.at(1), padding_);
 }
 
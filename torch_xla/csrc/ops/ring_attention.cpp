@@ -0,0 +1,143 @@
+#include "torch_xla/csrc/ops/ring_attention.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/infer_output_shape.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(c10::ArrayRef<torch::lazy::Value> operands,
+                           double scale, bool causal,
+                           const std::vector<std::vector<int64_t>>& groups) {
+  auto shape_fn = [&](absl::Span<const xla::XlaOp> ops) -> xla::XlaOp {
+    RingAttentionResult result =
+        BuildRingAttention(ops[0], ops[1], ops[2], ops[3], scale, causal,
+                           groups);
+    return xla::Tuple(ops[0].builder(),
+                      {result.output, result.logsumexp, result.token});
+  };
+  std::vector<xla::Shape> shapes;
+  for (const torch::lazy::Value& operand : operands) {
+    shapes.push_back(GetXlaShape(operand));
+  }
+  return InferOutputShape(shapes, shape_fn);
+}
+
+xla::Shape NodeOutputShapeBackward(
+    c10::ArrayRef<torch::lazy::Value> operands, double scale, bool causal,
+    const std::vector<std::vector<int64_t>>& groups) {
+  auto shape_fn = [&](absl::Span<const xla::XlaOp> ops) -> xla::XlaOp {
+    RingAttentionBackwardResult result = BuildRingAttentionBackward(
+        ops[0], ops[1], ops[2], ops[3], ops[4], ops[5], ops[6], scale, causal,
+        groups);
+    return xla::Tuple(ops[0].builder(),
+                      {result.grad_query, result.grad_key, result.grad_value,
+                       result.token});
+  };
+  std::vector<xla::Shape> shapes;
+  for (const torch::lazy::Value& operand : operands) {
+    shapes.push_back(GetXlaShape(operand));
+  }
+  return InferOutputShape(shapes, shape_fn);
+}
+
+std::string GroupsToString(const std::vector<std::vector<int64_t>>& groups) {
+  std::vector<std::string> rings;
+  for (const std::vector<int64_t>& group : groups) {
+    rings.push_back(absl::StrJoin(group, ", "));
+  }
+  return absl::StrCat("(", absl::StrJoin(rings, "), ("), ")");
+}
+
+}  // namespace
+
+RingAttention::RingAttention(const torch::lazy::Value& query,
+                             const torch::lazy::Value& key,
+                             const torch::lazy::Value& value,
+                             const torch::lazy::Value& token, double scale,
+                             bool causal,
+                             std::vector<std::vector<int64_t>> groups)
+    : XlaNode(
+          xla_ring_attention, {query, key, value, token},
+          [&]() {
+            return NodeOutputShape({query, key, value, token}, scale, causal,
+                                   groups);
+          },
+          /*num_outputs=*/3, torch::lazy::MHash(scale, causal, groups)),
+      scale_(scale),
+      causal_(causal),
+      groups_(std::move(groups)) {}
+
+torch::lazy::NodePtr RingAttention::Clone(torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<RingAttention>(operands.at(0), operands.at(1),
+                                              operands.at(2), operands.at(3),
+                                              scale_, causal_, groups_);
+}
+
+XlaOpVector RingAttention::Lower(LoweringContext* loctx) const {
+  RingAttentionResult result = BuildRingAttention(
+      loctx->GetOutputOp(operand(0)), loctx->GetOutputOp(operand(1)),
+      loctx->GetOutputOp(operand(2)), loctx->GetOutputOp(operand(3)), scale_,
+      causal_, groups_);
+  return ReturnOps({result.output, result.logsumexp, result.token}, loctx);
+}
+
+std::string RingAttention::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", scale=" << scale_ << ", causal=" << causal_
+     << ", groups=(" << GroupsToString(groups_) << ")";
+  return ss.str();
+}
+
+RingAttentionBackward::RingAttentionBackward(
+    const torch::lazy::Value& query, const torch::lazy::Value& key,
+    const torch::lazy::Value& value, const torch::lazy::Value& output,
+    const torch::lazy::Value& logsumexp, const torch::lazy::Value& grad_output,
+    const torch::lazy::Value& token, double scale, bool causal,
+    std::vector<std::vector<int64_t>> groups)
+    : XlaNode(
+          xla_ring_attention_backward,
+          {query, key, value, output, logsumexp, grad_output, token},
+          [&]() {
+            return NodeOutputShapeBackward(
+                {query, key, value, output, logsumexp, grad_output, token},
+                scale, causal, groups);
+          },
+          /*num_outputs=*/4, torch::lazy::MHash(scale, causal, groups)),
+      scale_(scale),
+      causal_(causal),
+      groups_(std::move(groups)) {}
+
+torch::lazy::NodePtr RingAttentionBackward::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<RingAttentionBackward>(
+      operands.at(0), operands.at(1), operands.at(2), operands.at(3),
+      operands.at(4), operands.at(5), operands.at(6), scale_, causal_,
+      groups_);
+}
+
+XlaOpVector RingAttentionBackward::Lower(LoweringContext* loctx) const {
+  std::vector<xla::XlaOp> ops;
+  for (const torch::lazy::Output& operand : operands()) {
+    ops.push_back(loctx->GetOutputOp(operand));
+  }
+  RingAttentionBackwardResult result =
+      BuildRingAttentionBackward(ops[0], ops[1], ops[2], ops[3], ops[4],
+                                 ops[5], ops[6], scale_, causal_, groups_);
+  return ReturnOps(
+      {result.grad_query, result.grad_key, result.grad_value, result.token},
+      loctx);
+}
+
+std::string RingAttentionBackward::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", scale=" << scale_ << ", causal=" << causal_
+     << ", groups=(" << GroupsToString(groups_) << ")";
+  return ss.str();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,69 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_RING_ATTENTION_H_
+#define XLA_TORCH_XLA_CSRC_OPS_RING_ATTENTION_H_
+
+#include "torch_xla/csrc/cross_replica_reduces.h"
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The outputs are the attention output, its F32 log-sum-exp and the token.
+class RingAttention : public XlaNode {
+ public:
+  RingAttention(const torch::lazy::Value& query, const torch::lazy::Value& key,
+                const torch::lazy::Value& value,
+                const torch::lazy::Value& token, double scale, bool causal,
+                std::vector<std::vector<int64_t>> groups);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  double scale() const { return scale_; }
+
+  bool causal() const { return causal_; }
+
+  const std::vector<std::vector<int64_t>>& groups() const { return groups_; }
+
+ private:
+  double scale_;
+  bool causal_;
+  std::vector<std::vector<int64_t>> groups_;
+};
+
+// The operands are the query, key, value, output, log-sum-exp and output
+// gradient, and the token. The outputs are the query, key and value gradients
+// and the token.
+class RingAttentionBackward : public XlaNode {
+ public:
+  RingAttentionBackward(const torch::lazy::Value& query,
+                        const torch::lazy::Value& key,
+                        const torch::lazy::Value& value,
+                        const torch::lazy::Value& output,
+                        const torch::lazy::Value& logsumexp,
+                        const torch::lazy::Value& grad_output,
+                        const torch::lazy::Value& token, double scale,
+                        bool causal, std::vector<std::vector<int64_t>> groups);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  double scale() const { return scale_; }
+
+  bool causal() const { return causal_; }
+
+  const std::vector<std::vector<int64_t>>& groups() const { return groups_; }
+
+ private:
+  double scale_;
+  bool causal_;
+  std::vector<std::vector<int64_t>> groups_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_RING_ATTENTION_H_
@@ -12,7 +12,7 @@ Roll::Roll(const torch::lazy::Value& input, std::vector<int64_t> shifts,
       dims_(std::move(dims)) {}
 
 torch::lazy::NodePtr Roll::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<Roll>(operands.at(0), shifts_, dims_);
+  return torch_xla::MakeNode<Roll>(operands.at(0), shifts_, dims_);
 }
 
 XlaOpVector Roll::Lower(LoweringContext* loctx) const {
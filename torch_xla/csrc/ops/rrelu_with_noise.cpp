@@ -22,7 +22,7 @@ RreluWithNoise::RreluWithNoise(const torch::lazy::Value& input,
       training_(training) {}
 
 torch::lazy::NodePtr RreluWithNoise::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<RreluWithNoise>(operands.at(0), operands.at(1),
+  return torch_xla::MakeNode<RreluWithNoise>(operands.at(0), operands.at(1),
                                                lower_, upper_, training_);
 }
 
@@ -21,7 +21,7 @@ RreluWithNoiseBackward::RreluWithNoiseBackward(
 
 torch::lazy::NodePtr RreluWithNoiseBackward::Clone(
     torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<RreluWithNoiseBackward>(
+  return torch_xla::MakeNode<RreluWithNoiseBackward>(
       operands.at(0), operands.at(1), operands.at(2), lower_, upper_,
       training_);
 }
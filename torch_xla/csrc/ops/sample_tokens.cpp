@@ -0,0 +1,60 @@
+#include "torch_xla/csrc/ops/sample_tokens.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/runtime/util.h"
+#include "torch_xla/csrc/tensor_util.h"
+#include "torch_xla/csrc/xla_lower_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(const torch::lazy::Value& logits) {
+  absl::Span<const int64_t> dims = GetXlaShape(logits).dimensions();
+  return xla::ShapeUtil::MakeShape(
+      GetXlaPrimitiveTypeForCurrentDevice(xla::PrimitiveType::S64),
+      dims.subspan(0, dims.size() - 1));
+}
+
+}  // namespace
+
+SampleTokens::SampleTokens(const torch::lazy::Value& logits,
+                           const torch::lazy::Value& temperature,
+                           const torch::lazy::Value& seed, int64_t top_k,
+                           const absl::optional<torch::lazy::Value>& top_p)
+    : XlaNode(xla_sample_tokens,
+              torch_xla::runtime::util::GetValuesVector<torch::lazy::Value>(
+                  {logits, temperature, seed}, {&top_p}),
+              NodeOutputShape(logits), /*num_outputs=*/1,
+              torch::lazy::MHash(top_k)),
+      top_k_(top_k) {}
+
+torch::lazy::NodePtr SampleTokens::Clone(torch::lazy::OpList operands) const {
+  absl::optional<torch::lazy::Value> top_p;
+  if (operands.size() > 3) {
+    top_p = operands.at(3);
+  }
+  return torch_xla::MakeNode<SampleTokens>(operands.at(0), operands.at(1),
+                                             operands.at(2), top_k_, top_p);
+}
+
+XlaOpVector SampleTokens::Lower(LoweringContext* loctx) const {
+  xla::XlaOp logits = loctx->GetOutputOp(operand(0));
+  xla::XlaOp temperature = loctx->GetOutputOp(operand(1));
+  xla::XlaOp seed = loctx->GetOutputOp(operand(2));
+  absl::optional<xla::XlaOp> top_p;
+  if (operands().size() > 3) {
+    top_p = loctx->GetOutputOp(operand(3));
+  }
+  return ReturnOp(BuildSampleTokens(logits, temperature, seed, top_k_, top_p),
+                  loctx);
+}
+
+std::string SampleTokens::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", top_k=" << top_k_;
+  return ss.str();
+}
+
+}  // namespace torch_xla
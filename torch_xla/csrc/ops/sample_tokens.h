@@ -0,0 +1,31 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_SAMPLE_TOKENS_H_
+#define XLA_TORCH_XLA_CSRC_OPS_SAMPLE_TOKENS_H_
+
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The token ids sampled from the [..., V] logits with the temperature, top-k
+// and optional top-p sampling. See BuildSampleTokens().
+class SampleTokens : public XlaNode {
+ public:
+  SampleTokens(const torch::lazy::Value& logits,
+               const torch::lazy::Value& temperature,
+               const torch::lazy::Value& seed, int64_t top_k,
+               const absl::optional<torch::lazy::Value>& top_p);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t top_k() const { return top_k_; }
+
+ private:
+  int64_t top_k_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_SAMPLE_TOKENS_H_
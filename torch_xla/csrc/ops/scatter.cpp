@@ -14,7 +14,7 @@ Scatter::Scatter(const torch::lazy::Value& input,
       dim_(dim) {}
 
 torch::lazy::NodePtr Scatter::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<Scatter>(operands.at(0), operands.at(1),
+  return torch_xla::MakeNode<Scatter>(operands.at(0), operands.at(1),
                                         operands.at(2), dim_);
 }
 
@@ -16,7 +16,7 @@ ScatterAdd::ScatterAdd(const torch::lazy::Value& input,
       dim_(dim) {}
 
 torch::lazy::NodePtr ScatterAdd::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<ScatterAdd>(operands.at(0), operands.at(1),
+  return torch_xla::MakeNode<ScatterAdd>(operands.at(0), operands.at(1),
                                            operands.at(2), dim_);
 }
 
@@ -0,0 +1,155 @@
+#include "torch_xla/csrc/ops/sharded_embedding_bag.h"
+
+#include "absl/strings/str_join.h"
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/infer_output_shape.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(c10::ArrayRef<torch::lazy::Value> operands,
+                           int64_t mode, bool include_last_offset,
+                           const std::vector<std::vector<int64_t>>& groups,
+                           bool pin_layout) {
+  auto shape_fn = [&](absl::Span<const xla::XlaOp> ops) -> xla::XlaOp {
+    ShardedEmbeddingBagResult result =
+        BuildShardedEmbeddingBag(ops[0], ops[1], ops[2], ops[3], ops[4], mode,
+                                 include_last_offset, groups, pin_layout);
+    return xla::Tuple(ops[0].builder(), {result.result, result.token});
+  };
+  std::vector<xla::Shape> shapes;
+  for (const torch::lazy::Value& operand : operands) {
+    shapes.push_back(GetXlaShape(operand));
+  }
+  return InferOutputShape(shapes, shape_fn);
+}
+
+xla::Shape NodeOutputShapeBackward(
+    c10::ArrayRef<torch::lazy::Value> operands, int64_t mode,
+    bool include_last_offset, int64_t num_rows,
+    const std::vector<std::vector<int64_t>>& groups, bool pin_layout) {
+  auto shape_fn = [&](absl::Span<const xla::XlaOp> ops) -> xla::XlaOp {
+    ShardedEmbeddingBagBackwardResult result = BuildShardedEmbeddingBagBackward(
+        ops[0], ops[1], ops[2], ops[3], ops[4], mode, include_last_offset,
+        num_rows, groups, pin_layout);
+    return xla::Tuple(ops[0].builder(),
+                      {result.rows, result.values, result.token});
+  };
+  std::vector<xla::Shape> shapes;
+  for (const torch::lazy::Value& operand : operands) {
+    shapes.push_back(GetXlaShape(operand));
+  }
+  return InferOutputShape(shapes, shape_fn);
+}
+
+void GroupsToStream(const std::vector<std::vector<int64_t>>& groups,
+                    std::stringstream* ss) {
+  *ss << ", groups=(";
+  for (size_t i = 0; i < groups.size(); ++i) {
+    *ss << (i == 0 ? "(" : ",(");
+    *ss << absl::StrJoin(groups[i], ", ") << ")";
+  }
+  *ss << ")";
+}
+
+}  // namespace
+
+ShardedEmbeddingBag::ShardedEmbeddingBag(
+    const torch::lazy::Value& weight, const torch::lazy::Value& indices,
+    const torch::lazy::Value& offsets,
+    const torch::lazy::Value& per_sample_weights,
+    const torch::lazy::Value& token, int64_t mode, bool include_last_offset,
+    std::vector<std::vector<int64_t>> groups, bool pin_layout)
+    : XlaNode(
+          xla_sharded_embedding_bag,
+          {weight, indices, offsets, per_sample_weights, token},
+          [&]() {
+            return NodeOutputShape(
+                {weight, indices, offsets, per_sample_weights, token}, mode,
+                include_last_offset, groups, pin_layout);
+          },
+          /*num_outputs=*/2,
+          torch::lazy::MHash(mode, include_last_offset, groups, pin_layout)),
+      mode_(mode),
+      include_last_offset_(include_last_offset),
+      groups_(std::move(groups)),
+      pin_layout_(pin_layout) {}
+
+torch::lazy::NodePtr ShardedEmbeddingBag::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<ShardedEmbeddingBag>(
+      operands.at(0), operands.at(1), operands.at(2), operands.at(3),
+      operands.at(4), mode_, include_last_offset_, groups_, pin_layout_);
+}
+
+XlaOpVector ShardedEmbeddingBag::Lower(LoweringContext* loctx) const {
+  ShardedEmbeddingBagResult result = BuildShardedEmbeddingBag(
+      loctx->GetOutputOp(operand(0)), loctx->GetOutputOp(operand(1)),
+      loctx->GetOutputOp(operand(2)), loctx->GetOutputOp(operand(3)),
+      loctx->GetOutputOp(operand(4)), mode_, include_last_offset_, groups_,
+      pin_layout_);
+  return ReturnOps({result.result, result.token}, loctx);
+}
+
+std::string ShardedEmbeddingBag::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", mode=" << mode_
+     << ", include_last_offset=" << include_last_offset_
+     << ", pin_layout=" << pin_layout_;
+  GroupsToStream(groups_, &ss);
+  return ss.str();
+}
+
+ShardedEmbeddingBagBackward::ShardedEmbeddingBagBackward(
+    const torch::lazy::Value& grad_output, const torch::lazy::Value& indices,
+    const torch::lazy::Value& offsets,
+    const torch::lazy::Value& per_sample_weights,
+    const torch::lazy::Value& token, int64_t mode, bool include_last_offset,
+    int64_t num_rows, std::vector<std::vector<int64_t>> groups,
+    bool pin_layout)
+    : XlaNode(
+          xla_sharded_embedding_bag_backward,
+          {grad_output, indices, offsets, per_sample_weights, token},
+          [&]() {
+            return NodeOutputShapeBackward(
+                {grad_output, indices, offsets, per_sample_weights, token},
+                mode, include_last_offset, num_rows, groups, pin_layout);
+          },
+          /*num_outputs=*/3,
+          torch::lazy::MHash(mode, include_last_offset, num_rows, groups,
+                             pin_layout)),
+      mode_(mode),
+      include_last_offset_(include_last_offset),
+      num_rows_(num_rows),
+      groups_(std::move(groups)),
+      pin_layout_(pin_layout) {}
+
+torch::lazy::NodePtr ShardedEmbeddingBagBackward::Clone(
+    torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<ShardedEmbeddingBagBackward>(
+      operands.at(0), operands.at(1), operands.at(2), operands.at(3),
+      operands.at(4), mode_, include_last_offset_, num_rows_, groups_,
+      pin_layout_);
+}
+
+XlaOpVector ShardedEmbeddingBagBackward::Lower(LoweringContext* loctx) const {
+  ShardedEmbeddingBagBackwardResult result = BuildShardedEmbeddingBagBackward(
+      loctx->GetOutputOp(operand(0)), loctx->GetOutputOp(operand(1)),
+      loctx->GetOutputOp(operand(2)), loctx->GetOutputOp(operand(3)),
+      loctx->GetOutputOp(operand(4)), mode_, include_last_offset_, num_rows_,
+      groups_, pin_layout_);
+  return ReturnOps({result.rows, result.values, result.token}, loctx);
+}
+
+std::string ShardedEmbeddingBagBackward::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", mode=" << mode_
+     << ", include_last_offset=" << include_last_offset_
+     << ", num_rows=" << num_rows_ << ", pin_layout=" << pin_layout_;
+  GroupsToStream(groups_, &ss);
+  return ss.str();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,84 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_SHARDED_EMBEDDING_BAG_H_
+#define XLA_TORCH_XLA_CSRC_OPS_SHARDED_EMBEDDING_BAG_H_
+
+#include "torch_xla/csrc/cross_replica_reduces.h"
+#include "torch_xla/csrc/ir.h"
+
+namespace torch_xla {
+
+// The operands are the local weight shard, the indices, offsets and per sample
+// weights of the local bags, and the token. The outputs are the local bags and
+// the token.
+class ShardedEmbeddingBag : public XlaNode {
+ public:
+  ShardedEmbeddingBag(const torch::lazy::Value& weight,
+                      const torch::lazy::Value& indices,
+                      const torch::lazy::Value& offsets,
+                      const torch::lazy::Value& per_sample_weights,
+                      const torch::lazy::Value& token, int64_t mode,
+                      bool include_last_offset,
+                      std::vector<std::vector<int64_t>> groups,
+                      bool pin_layout);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t mode() const { return mode_; }
+
+  bool include_last_offset() const { return include_last_offset_; }
+
+  const std::vector<std::vector<int64_t>>& groups() const { return groups_; }
+
+  bool pin_layout() const { return pin_layout_; }
+
+ private:
+  int64_t mode_;
+  bool include_last_offset_;
+  std::vector<std::vector<int64_t>> groups_;
+  bool pin_layout_;
+};
+
+// The operands are the gradient of the local bags, the indices, offsets and
+// per sample weights of the local bags, and the token. The outputs are the
+// rows of the `num_rows` rows weight shard, their gradients and the token.
+class ShardedEmbeddingBagBackward : public XlaNode {
+ public:
+  ShardedEmbeddingBagBackward(const torch::lazy::Value& grad_output,
+                              const torch::lazy::Value& indices,
+                              const torch::lazy::Value& offsets,
+                              const torch::lazy::Value& per_sample_weights,
+                              const torch::lazy::Value& token, int64_t mode,
+                              bool include_last_offset, int64_t num_rows,
+                              std::vector<std::vector<int64_t>> groups,
+                              bool pin_layout);
+
+  std::string ToString() const override;
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  int64_t mode() const { return mode_; }
+
+  bool include_last_offset() const { return include_last_offset_; }
+
+  int64_t num_rows() const { return num_rows_; }
+
+  const std::vector<std::vector<int64_t>>& groups() const { return groups_; }
+
+  bool pin_layout() const { return pin_layout_; }
+
+ private:
+  int64_t mode_;
+  bool include_last_offset_;
+  int64_t num_rows_;
+  std::vector<std::vector<int64_t>> groups_;
+  bool pin_layout_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_SHARDED_EMBEDDING_BAG_H_
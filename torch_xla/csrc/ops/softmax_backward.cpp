@@ -16,7 +16,7 @@ SoftmaxBackward::SoftmaxBackward(const torch::lazy::Value& grad_output,
 
 torch::lazy::NodePtr SoftmaxBackward::Clone(
     torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<SoftmaxBackward>(operands.at(0), operands.at(1),
+  return torch_xla::MakeNode<SoftmaxBackward>(operands.at(0), operands.at(1),
                                                 dim_);
 }
 
@@ -40,7 +40,7 @@ StdMean::StdMean(const torch::lazy::Value& input,
       keep_reduced_dimensions_(keep_reduced_dimensions) {}
 
 torch::lazy::NodePtr StdMean::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<StdMean>(operands.at(0), dimensions_,
+  return torch_xla::MakeNode<StdMean>(operands.at(0), dimensions_,
                                         correction_, keep_reduced_dimensions_);
 }
 
@@ -77,7 +77,7 @@ SVD::SVD(const torch::lazy::Value& input, bool some, bool compute_uv)
       compute_uv_(compute_uv) {}
 
 torch::lazy::NodePtr SVD::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<SVD>(operands.at(0), some_, compute_uv_);
+  return torch_xla::MakeNode<SVD>(operands.at(0), some_, compute_uv_);
 }
 
 XlaOpVector SVD::Lower(LoweringContext* loctx) const {
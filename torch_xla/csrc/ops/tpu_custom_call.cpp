@@ -8,14 +8,13 @@ namespace torch_xla {
 
 TpuCustomCall::TpuCustomCall(torch::lazy::OpList inputs,
                              xla::Shape output_shape,
-                             const std::string& payload)
+                             std::shared_ptr<const CustomKernel> kernel)
     : XlaNode(xla_tpu_custom_call, inputs, std::move(output_shape),
-              /*num_outputs=*/output_shape.tuple_shapes_size(),
-              torch::lazy::MHash(payload)),
-      payload_(payload) {}
+              /*num_outputs=*/output_shape.tuple_shapes_size(), kernel->hash),
+      kernel_(std::move(kernel)) {}
 
 torch::lazy::NodePtr TpuCustomCall::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<TpuCustomCall>(operands, xla_shape(), payload_);
+  return torch_xla::MakeNode<TpuCustomCall>(operands, xla_shape(), kernel_);
 }
 
 XlaOpVector TpuCustomCall::Lower(LoweringContext* loctx) const {
@@ -24,13 +23,13 @@ XlaOpVector TpuCustomCall::Lower(LoweringContext* loctx) const {
   for (auto& operand : operands()) {
     inputs.push_back(loctx->GetOutputOp(operand));
   }
-  auto output = BuildTpuCustomCall(inputs, xla_shape(), payload_);
+  auto output = BuildTpuCustomCall(inputs, xla_shape(), kernel_->payload);
   return ReturnOps(output, loctx);
 }
 
 std::string TpuCustomCall::ToString() const {
   std::stringstream ss;
-  ss << XlaNode::ToString() << ", " << payload_;
+  ss << XlaNode::ToString() << ", kernel_id=" << kernel_->id;
   return ss.str();
 }
 
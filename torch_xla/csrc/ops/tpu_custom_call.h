@@ -1,6 +1,7 @@
 #ifndef XLA_TORCH_XLA_CSRC_OPS_TPU_CUSTOM_CALL_H_
 #define XLA_TORCH_XLA_CSRC_OPS_TPU_CUSTOM_CALL_H_
 
+#include "torch_xla/csrc/custom_kernel_registry.h"
 #include "torch_xla/csrc/ir.h"
 
 namespace torch_xla {
@@ -9,7 +10,7 @@ class TpuCustomCall : public XlaNode {
  public:
   // Make a TPU custom call with payload, e.g., Mosaic.
   TpuCustomCall(torch::lazy::OpList inputs, xla::Shape output_shape,
-                const std::string& payload);
+                std::shared_ptr<const CustomKernel> kernel);
 
   torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
 
@@ -18,7 +19,7 @@ class TpuCustomCall : public XlaNode {
   std::string ToString() const override;
 
  private:
-  std::string payload_;
+  std::shared_ptr<const CustomKernel> kernel_;
 };
 
 }  // namespace torch_xla
@@ -2,6 +2,7 @@
 
 #include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/matrix.h"
 #include "torch_xla/csrc/shape_helper.h"
 #include "xla/client/xla_builder.h"
 #include "xla/layout_util.h"
@@ -56,6 +57,12 @@ std::vector<xla::XlaOp> LowerTriangularSolve(xla::XlaOp rhs, xla::XlaOp lhs,
   xla::XlaOp lhs_broadcasted =
       XlaHelpers::ImplicitBroadcast(lhs, lhs_shape, broadcasted_shapes.second);
 
+  if (IsSmallMatrix(broadcasted_shapes.second)) {
+    return {BuildSmallTriangularSolve(lhs_broadcasted, rhs_broadcasted,
+                                      left_side, lower, transpose,
+                                      unit_diagonal),
+            lhs_broadcasted};
+  }
   xla::XlaOp solution = xla::TriangularSolve(
       lhs_broadcasted, rhs_broadcasted, left_side, lower, unit_diagonal,
       transpose ? xla::TriangularSolveOptions::TRANSPOSE
@@ -88,7 +95,7 @@ TriangularSolve::TriangularSolve(const torch::lazy::Value& rhs,
 
 torch::lazy::NodePtr TriangularSolve::Clone(
     torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<TriangularSolve>(operands.at(0), operands.at(1),
+  return torch_xla::MakeNode<TriangularSolve>(operands.at(0), operands.at(1),
                                                 left_side_, lower_, transpose_,
                                                 unit_diagonal_);
 }
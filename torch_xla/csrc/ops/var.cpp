@@ -37,7 +37,7 @@ Var::Var(const torch::lazy::Value& input, std::vector<int64_t> dimensions,
       keep_reduced_dimensions_(keep_reduced_dimensions) {}
 
 torch::lazy::NodePtr Var::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<Var>(operands.at(0), dimensions_, correction_,
+  return torch_xla::MakeNode<Var>(operands.at(0), dimensions_, correction_,
                                     keep_reduced_dimensions_);
 }
 
@@ -16,11 +16,10 @@ xla::Shape NodeOutputShape(const torch::lazy::Value& input,
                            bool keep_reduced_dimensions) {
   auto lower_for_shape_fn =
       [&](absl::Span<const xla::XlaOp> operands) -> xla::XlaOp {
-    xla::XlaOp var =
-        BuildVar(operands[0], dimensions, correction, keep_reduced_dimensions);
-    xla::XlaOp mean =
-        BuildMean(operands[0], dimensions, keep_reduced_dimensions);
-    return xla::Tuple(operands[0].builder(), {var, mean});
+    std::pair<xla::XlaOp, xla::XlaOp> var_mean = BuildVarMean(
+        operands[0], dimensions, correction, keep_reduced_dimensions);
+    return xla::Tuple(operands[0].builder(),
+                      {var_mean.first, var_mean.second});
   };
   return InferOutputShape({GetXlaShape(input)}, lower_for_shape_fn);
 }
@@ -43,16 +42,15 @@ VarMean::VarMean(const torch::lazy::Value& input,
       keep_reduced_dimensions_(keep_reduced_dimensions) {}
 
 torch::lazy::NodePtr VarMean::Clone(torch::lazy::OpList operands) const {
-  return torch::lazy::MakeNode<VarMean>(operands.at(0), dimensions_,
+  return torch_xla::MakeNode<VarMean>(operands.at(0), dimensions_,
                                         correction_, keep_reduced_dimensions_);
 }
 
 XlaOpVector VarMean::Lower(LoweringContext* loctx) const {
   xla::XlaOp input = loctx->GetOutputOp(operand(0));
-  xla::XlaOp op_var =
-      BuildVar(input, dimensions_, correction_, keep_reduced_dimensions_);
-  xla::XlaOp op_mean = BuildMean(input, dimensions_, keep_reduced_dimensions_);
-  return ReturnOps({op_var, op_mean}, loctx);
+  std::pair<xla::XlaOp, xla::XlaOp> var_mean =
+      BuildVarMean(input, dimensions_, correction_, keep_reduced_dimensions_);
+  return ReturnOps({var_mean.first, var_mean.second}, loctx);
 }
 
 std::string VarMean::ToString() const {
@@ -0,0 +1,117 @@
+#include "torch_xla/csrc/ops/while_loop.h"
+
+#include "torch_xla/csrc/lowering_context.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/shape_helper.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+xla::Shape NodeOutputShape(torch::lazy::OpList operands, size_t num_carried) {
+  std::vector<xla::Shape> shapes;
+  for (size_t i = 0; i < num_carried; ++i) {
+    shapes.push_back(GetXlaShape(operands[i]));
+  }
+  return xla::ShapeUtil::MakeTupleShape(shapes);
+}
+
+void CheckComputations(torch::lazy::OpList operands, size_t num_carried,
+                       const runtime::ComputationClient::Computation& cond,
+                       const runtime::ComputationClient::Computation& body) {
+  XLA_CHECK_LE(num_carried, operands.size());
+  int64_t num_operands = operands.size();
+  XLA_CHECK_EQ(cond.program_shape().parameters_size(), num_operands)
+      << "The cond computation must take the carried values and invariants";
+  XLA_CHECK_EQ(body.program_shape().parameters_size(), num_operands)
+      << "The body computation must take the carried values and invariants";
+  const xla::Shape& result = body.program_shape().result();
+  int64_t num_results = result.IsTuple() ? result.tuple_shapes_size() : 1;
+  XLA_CHECK_EQ(num_results, static_cast<int64_t>(num_carried))
+      << "The body computation must return the carried values";
+}
+
+// Builds the computation of the loop state tuple calling `computation` on its
+// elements. The cond returns the predicate, and the body the new carried
+// values followed by the invariants of the state.
+xla::XlaComputation MakeStateComputation(
+    const std::string& name, const xla::Shape& state_shape,
+    const xla::XlaComputation& computation, size_t num_carried, bool is_body) {
+  xla::XlaBuilder builder(name);
+  xla::XlaOp state = xla::Parameter(&builder, 0, state_shape, "state");
+  std::vector<xla::XlaOp> args;
+  for (int64_t i = 0; i < state_shape.tuple_shapes_size(); ++i) {
+    args.push_back(xla::GetTupleElement(state, i));
+  }
+  xla::XlaOp result = xla::Call(&builder, computation, args);
+  const xla::Shape& result_shape =
+      ConsumeValue(computation.GetProgramShape()).result();
+  if (!is_body) {
+    if (result_shape.IsTuple()) {
+      xla::GetTupleElement(result, 0);
+    }
+    return ConsumeValue(builder.Build());
+  }
+  std::vector<xla::XlaOp> next;
+  if (result_shape.IsTuple()) {
+    for (size_t i = 0; i < num_carried; ++i) {
+      next.push_back(xla::GetTupleElement(result, i));
+    }
+  } else {
+    next.push_back(result);
+  }
+  next.insert(next.end(), args.begin() + num_carried, args.end());
+  xla::Tuple(&builder, next);
+  return ConsumeValue(builder.Build());
+}
+
+}  // namespace
+
+WhileLoop::WhileLoop(torch::lazy::OpList operands, size_t num_carried,
+                     runtime::ComputationClient::ComputationPtr cond,
+                     runtime::ComputationClient::ComputationPtr body)
+    : XlaNode(xla_while_loop, operands, NodeOutputShape(operands, num_carried),
+              num_carried,
+              torch::lazy::MHash(num_carried, cond->hash(), body->hash())),
+      num_carried_(num_carried),
+      cond_(std::move(cond)),
+      body_(std::move(body)) {
+  CheckComputations(operands, num_carried_, *cond_, *body_);
+}
+
+torch::lazy::NodePtr WhileLoop::Clone(torch::lazy::OpList operands) const {
+  return torch_xla::MakeNode<WhileLoop>(operands, num_carried_, cond_, body_);
+}
+
+XlaOpVector WhileLoop::Lower(LoweringContext* loctx) const {
+  std::vector<xla::XlaOp> inputs;
+  std::vector<xla::Shape> shapes;
+  for (auto& operand : operands()) {
+    inputs.push_back(loctx->GetOutputOp(operand));
+    shapes.push_back(ShapeHelper::ShapeOfXlaOp(inputs.back()));
+  }
+  xla::Shape state_shape = xla::ShapeUtil::MakeTupleShape(shapes);
+  xla::XlaComputation cond =
+      MakeStateComputation("WhileLoopCond", state_shape, cond_->computation(),
+                           num_carried_, /*is_body=*/false);
+  xla::XlaComputation body =
+      MakeStateComputation("WhileLoopBody", state_shape, body_->computation(),
+                           num_carried_, /*is_body=*/true);
+  xla::XlaOp state =
+      xla::While(cond, body, xla::Tuple(loctx->builder(), inputs));
+  std::vector<xla::XlaOp> results;
+  for (size_t i = 0; i < num_carried_; ++i) {
+    results.push_back(xla::GetTupleElement(state, i));
+  }
+  return ReturnOps(results, loctx);
+}
+
+std::string WhileLoop::ToString() const {
+  std::stringstream ss;
+  ss << XlaNode::ToString() << ", num_carried=" << num_carried_
+     << ", cond=" << cond_->name() << ", body=" << body_->name();
+  return ss.str();
+}
+
+}  // namespace torch_xla
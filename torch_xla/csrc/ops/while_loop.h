@@ -0,0 +1,39 @@
+#ifndef XLA_TORCH_XLA_CSRC_OPS_WHILE_LOOP_H_
+#define XLA_TORCH_XLA_CSRC_OPS_WHILE_LOOP_H_
+
+#include "torch_xla/csrc/ir.h"
+#include "torch_xla/csrc/runtime/computation_client.h"
+
+namespace torch_xla {
+
+// The structured while loop of fori_loop and while_loop. The operands are the
+// `num_carried` carried values followed by the loop invariants, and the
+// outputs the final carried values. The cond and body computations take the
+// operands as separate parameters, in the same order, the body returning the
+// new carried values only. The invariants are threaded through the state of
+// the XLA while unchanged, as XLA requires, so that the compiler keeps their
+// buffers in place across the iterations and hoists the computations of the
+// body which only depend on them.
+class WhileLoop : public XlaNode {
+ public:
+  WhileLoop(torch::lazy::OpList operands, size_t num_carried,
+            runtime::ComputationClient::ComputationPtr cond,
+            runtime::ComputationClient::ComputationPtr body);
+
+  torch::lazy::NodePtr Clone(torch::lazy::OpList operands) const override;
+
+  XlaOpVector Lower(LoweringContext* loctx) const override;
+
+  std::string ToString() const override;
+
+  size_t num_carried() const { return num_carried_; }
+
+ private:
+  size_t num_carried_;
+  runtime::ComputationClient::ComputationPtr cond_;
+  runtime::ComputationClient::ComputationPtr body_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_OPS_WHILE_LOOP_H_
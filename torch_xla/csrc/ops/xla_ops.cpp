@@ -4,37 +4,80 @@ namespace torch_xla {
 
 const OpKindWrapper xla_adam_optimizer_step("xla::adam_optimizer_step");
 const OpKindWrapper xla_all_gather("xla::all_gather");
+const OpKindWrapper xla_all_gather_start("xla::all_gather_start");
+const OpKindWrapper xla_all_reduce_start("xla::all_reduce_start");
 const OpKindWrapper xla_all_to_all("xla::all_to_all");
+const OpKindWrapper xla_approx_topk("xla::approx_topk");
 const OpKindWrapper xla_as_strided_view_update("xla::as_strided_view_update");
+const OpKindWrapper xla_async_collective_done("xla::async_collective_done");
+const OpKindWrapper xla_batched_nms("xla::batched_nms");
 const OpKindWrapper xla_cast("xla::cast");
+const OpKindWrapper xla_chunked_cross_entropy("xla::chunked_cross_entropy");
+const OpKindWrapper xla_chunked_cross_entropy_backward(
+    "xla::chunked_cross_entropy_backward");
 const OpKindWrapper xla_collective_permute("xla::collective_permute");
 const OpKindWrapper xla_cross_replica_sum("xla::cross_replica_sum");
 const OpKindWrapper xla_custom_call("xla::custom_call");
 const OpKindWrapper xla_device_data("xla::device_data");
 const OpKindWrapper xla_dequantize_tensor("xla::dequantize_tensor");
 const OpKindWrapper xla_diagonal_view_update("xla::diagonal_view_update");
+const OpKindWrapper xla_dropout_add_layer_norm("xla::dropout_add_layer_norm");
+const OpKindWrapper xla_dropout_add_layer_norm_backward(
+    "xla::dropout_add_layer_norm_backward");
 const OpKindWrapper xla_dynamic_expand("xla::dynamic_expand");
 const OpKindWrapper xla_dynamic_view("xla::dynamic_view");
 const OpKindWrapper xla_einsum_backward("xla::einsum_backward");
+const OpKindWrapper xla_flash_attention("xla::flash_attention");
+const OpKindWrapper xla_flash_attention_backward(
+    "xla::flash_attention_backward");
+const OpKindWrapper xla_foreach_adam_optimizer_step(
+    "xla::foreach_adam_optimizer_step");
+const OpKindWrapper xla_foreach_grad_norm("xla::foreach_grad_norm");
+const OpKindWrapper xla_foreach_sgd_optimizer_step(
+    "xla::foreach_sgd_optimizer_step");
+const OpKindWrapper xla_fp8_scaled_mm("xla::fp8_scaled_mm");
 const OpKindWrapper xla_generic_slice("xla::generic_slice");
 const OpKindWrapper xla_get_dimensions_size("xla::xla_get_dimensions_size");
+const OpKindWrapper xla_grouped_matmul("xla::grouped_matmul");
+const OpKindWrapper xla_kv_cache_rollback("xla::kv_cache_rollback");
+const OpKindWrapper xla_kv_cache_update("xla::kv_cache_update");
 const OpKindWrapper xla_mark_tensor("xla::mark_tensor");
+const OpKindWrapper xla_masked_scaled_softmax("xla::masked_scaled_softmax");
+const OpKindWrapper xla_masked_scaled_softmax_backward(
+    "xla::masked_scaled_softmax_backward");
+const OpKindWrapper xla_masked_select_static("xla::masked_select_static");
+const OpKindWrapper xla_metric_accumulate("xla::metric_accumulate");
 const OpKindWrapper xla_moving_average("xla::moving_average");
 const OpKindWrapper xla_nms("xla::nms");
 const OpKindWrapper xla_not_supported("xla::not_supported");
 const OpKindWrapper xla_optimization_barrier("xla::optimization_barrier");
 const OpKindWrapper xla_quantize_tensor("xla::quantize_tensor");
+const OpKindWrapper xla_quantized_matmul("xla::quantized_matmul");
 const OpKindWrapper xla_recv("xla::recv");
 const OpKindWrapper xla_reduce_scatter("xla::reduce_scatter");
 const OpKindWrapper xla_replication_pad("xla::replication_pad");
 const OpKindWrapper xla_replication_pad_backward(
     "xla::replication_pad_backward");
+const OpKindWrapper xla_ring_attention("xla::ring_attention");
+const OpKindWrapper xla_ring_attention_backward(
+    "xla::ring_attention_backward");
+const OpKindWrapper xla_sample_tokens("xla::sample_tokens");
 const OpKindWrapper xla_select("xla::select");
 const OpKindWrapper xla_send("xla::send");
 const OpKindWrapper xla_sgd_optimizer_step("xla::sgd_optimizer_step");
+const OpKindWrapper xla_sharded_embedding_bag("xla::sharded_embedding_bag");
+const OpKindWrapper xla_sharded_embedding_bag_backward(
+    "xla::sharded_embedding_bag_backward");
+const OpKindWrapper xla_sparse_adam_optimizer_step(
+    "xla::sparse_adam_optimizer_step");
+const OpKindWrapper xla_sparse_sgd_optimizer_step(
+    "xla::sparse_sgd_optimizer_step");
 const OpKindWrapper xla_tensor_data("xla::tensor_data");
+const OpKindWrapper xla_transposed_grouped_matmul(
+    "xla::transposed_grouped_matmul");
 const OpKindWrapper xla_unselect("xla::unselect");
 const OpKindWrapper xla_update_slice("xla::update_slice");
+const OpKindWrapper xla_while_loop("xla::while_loop");
 const OpKindWrapper xla_custom_sharding("xla::custom_sharding");
 const OpKindWrapper xla_tpu_custom_call("xla::tpu_custom_call");
 const OpKindWrapper xla_gpu_custom_call("xla::gpu_custom_call");
@@ -30,36 +30,68 @@ class OpKindWrapper {
 
 extern const OpKindWrapper xla_adam_optimizer_step;
 extern const OpKindWrapper xla_all_gather;
+extern const OpKindWrapper xla_all_gather_start;
+extern const OpKindWrapper xla_all_reduce_start;
 extern const OpKindWrapper xla_all_to_all;
+extern const OpKindWrapper xla_approx_topk;
 extern const OpKindWrapper xla_as_strided_view_update;
+extern const OpKindWrapper xla_async_collective_done;
+extern const OpKindWrapper xla_batched_nms;
 extern const OpKindWrapper xla_cast;
+extern const OpKindWrapper xla_chunked_cross_entropy;
+extern const OpKindWrapper xla_chunked_cross_entropy_backward;
 extern const OpKindWrapper xla_collective_permute;
 extern const OpKindWrapper xla_cross_replica_sum;
 extern const OpKindWrapper xla_custom_call;
 extern const OpKindWrapper xla_device_data;
 extern const OpKindWrapper xla_dequantize_tensor;
 extern const OpKindWrapper xla_diagonal_view_update;
+extern const OpKindWrapper xla_dropout_add_layer_norm;
+extern const OpKindWrapper xla_dropout_add_layer_norm_backward;
 extern const OpKindWrapper xla_dynamic_expand;
 extern const OpKindWrapper xla_dynamic_view;
 extern const OpKindWrapper xla_einsum_backward;
+extern const OpKindWrapper xla_flash_attention;
+extern const OpKindWrapper xla_flash_attention_backward;
+extern const OpKindWrapper xla_foreach_adam_optimizer_step;
+extern const OpKindWrapper xla_foreach_grad_norm;
+extern const OpKindWrapper xla_foreach_sgd_optimizer_step;
+extern const OpKindWrapper xla_fp8_scaled_mm;
 extern const OpKindWrapper xla_generic_slice;
 extern const OpKindWrapper xla_get_dimensions_size;
+extern const OpKindWrapper xla_grouped_matmul;
+extern const OpKindWrapper xla_kv_cache_rollback;
+extern const OpKindWrapper xla_kv_cache_update;
 extern const OpKindWrapper xla_mark_tensor;
+extern const OpKindWrapper xla_masked_scaled_softmax;
+extern const OpKindWrapper xla_masked_scaled_softmax_backward;
+extern const OpKindWrapper xla_masked_select_static;
+extern const OpKindWrapper xla_metric_accumulate;
 extern const OpKindWrapper xla_moving_average;
 extern const OpKindWrapper xla_nms;
 extern const OpKindWrapper xla_not_supported;
 extern const OpKindWrapper xla_optimization_barrier;
 extern const OpKindWrapper xla_quantize_tensor;
+extern const OpKindWrapper xla_quantized_matmul;
 extern const OpKindWrapper xla_recv;
 extern const OpKindWrapper xla_reduce_scatter;
 extern const OpKindWrapper xla_replication_pad;
 extern const OpKindWrapper xla_replication_pad_backward;
+extern const OpKindWrapper xla_ring_attention;
+extern const OpKindWrapper xla_ring_attention_backward;
+extern const OpKindWrapper xla_sample_tokens;
 extern const OpKindWrapper xla_select;
 extern const OpKindWrapper xla_send;
 extern const OpKindWrapper xla_sgd_optimizer_step;
+extern const OpKindWrapper xla_sharded_embedding_bag;
+extern const OpKindWrapper xla_sharded_embedding_bag_backward;
+extern const OpKindWrapper xla_sparse_adam_optimizer_step;
+extern const OpKindWrapper xla_sparse_sgd_optimizer_step;
 extern const OpKindWrapper xla_tensor_data;
+extern const OpKindWrapper xla_transposed_grouped_matmul;
 extern const OpKindWrapper xla_unselect;
 extern const OpKindWrapper xla_update_slice;
+extern const OpKindWrapper xla_while_loop;
 extern const OpKindWrapper xla_custom_sharding;
 extern const OpKindWrapper xla_tpu_custom_call;
 extern const OpKindWrapper xla_gpu_custom_call;
@@ -0,0 +1,196 @@
+#include "torch_xla/csrc/parallel_lowering.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <exception>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "torch_xla/csrc/ir.h"
+#include "torch_xla/csrc/node_deduplicator.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+#include "torch_xla/csrc/thread_pool.h"
+#include "xla/client/xla_builder.h"
+
+namespace torch_xla {
+namespace {
+
+struct Segment {
+  size_t begin = 0;
+  size_t end = 0;
+  // The outputs of the earlier segments used, in parameter order.
+  std::vector<torch::lazy::Output> inputs;
+  // The outputs used by the later segments or the roots, in result order.
+  std::vector<torch::lazy::Output> outputs;
+  xla::XlaComputation computation;
+  std::exception_ptr error;
+};
+
+const std::string* OpNamePrefix(const torch::lazy::Node* node) {
+  const CustomOpNameMetaData* metadata =
+      dynamic_cast<const CustomOpNameMetaData*>(node->user_metadata());
+  return metadata != nullptr ? &metadata->op_name_prefix : nullptr;
+}
+
+bool SamePrefix(const std::string* prefix, const std::string* other) {
+  return prefix == other ||
+         (prefix != nullptr && other != nullptr && *prefix == *other);
+}
+
+// Cuts the post order in segments of at least `segment_nodes` nodes, ending
+// at a change of op name prefix, or at twice the size without one.
+std::vector<Segment> MakeSegments(
+    absl::Span<const torch::lazy::Node* const> post_order,
+    size_t segment_nodes) {
+  std::vector<Segment> segments;
+  Segment segment;
+  for (size_t i = 0; i < post_order.size(); ++i) {
+    size_t size = i - segment.begin;
+    if (size >= 2 * segment_nodes ||
+        (size >= segment_nodes &&
+         !SamePrefix(OpNamePrefix(post_order[i - 1]),
+                     OpNamePrefix(post_order[i])))) {
+      segment.end = i;
+      segments.push_back(segment);
+      segment = Segment();
+      segment.begin = i;
+    }
+  }
+  segment.end = post_order.size();
+  segments.push_back(segment);
+  return segments;
+}
+
+const xla::Shape& OutputShape(const torch::lazy::Output& output) {
+  return static_cast<const XlaNode*>(output.node)->xla_shape(output.index);
+}
+
+void LowerSegment(absl::Span<const torch::lazy::Node* const> post_order,
+                  const std::unordered_set<const torch::lazy::Node*>& leaves,
+                  const torch::lazy::BackendDevice& device, size_t index,
+                  Segment* segment) {
+  if (segment->outputs.empty()) {
+    // Only device data nodes, already lowered.
+    return;
+  }
+  LoweringContext loctx(absl::StrCat("Segment", index), device);
+  for (size_t i = 0; i < segment->inputs.size(); ++i) {
+    const torch::lazy::Output& input = segment->inputs[i];
+    loctx.AssignOutputOp(input,
+                         xla::Parameter(loctx.builder(), i, OutputShape(input),
+                                        absl::StrCat("p", i)));
+  }
+  NodeDeduplicator deduplicator;
+  for (size_t i = segment->begin; i < segment->end; ++i) {
+    const torch::lazy::Node* node = post_order[i];
+    if (leaves.count(node) > 0 || (NodeDeduplicator::Enabled() &&
+                                   deduplicator.TryReuse(node, &loctx))) {
+      continue;
+    }
+    loctx.LowerNode(node);
+  }
+  std::vector<xla::XlaOp> results;
+  for (const torch::lazy::Output& output : segment->outputs) {
+    results.push_back(loctx.GetOutputOp(output));
+  }
+  segment->computation =
+      ConsumeValue(loctx.BuildXla(xla::Tuple(loctx.builder(), results)));
+}
+
+}  // namespace
+
+int64_t ParallelLoweringMinNodes() {
+  static const int64_t min_nodes =
+      runtime::sys_util::GetEnvInt("XLA_PARALLEL_LOWERING_MIN_NODES", 0);
+  return min_nodes;
+}
+
+void LowerInParallel(absl::Span<const torch::lazy::Node* const> post_order,
+                     absl::Span<const torch::lazy::Value> roots,
+                     size_t segment_nodes, LoweringContext* loctx) {
+  // The device data nodes are the parameters of the whole graph.
+  std::unordered_set<const torch::lazy::Node*> leaves;
+  for (const torch::lazy::Node* node : post_order) {
+    if (node->op() == xla_device_data) {
+      loctx->LowerNode(node);
+      leaves.insert(node);
+    }
+  }
+
+  std::vector<Segment> segments = MakeSegments(post_order, segment_nodes);
+  std::unordered_map<const torch::lazy::Node*, size_t> segment_index;
+  for (size_t s = 0; s < segments.size(); ++s) {
+    for (size_t i = segments[s].begin; i < segments[s].end; ++i) {
+      if (leaves.count(post_order[i]) == 0) {
+        segment_index[post_order[i]] = s;
+      }
+    }
+  }
+  std::vector<OutputMap<bool>> exported(segments.size());
+  auto export_output = [&](const torch::lazy::Output& output) {
+    size_t s = segment_index.at(output.node);
+    if (exported[s].emplace(output, true).second) {
+      segments[s].outputs.push_back(output);
+    }
+  };
+  for (size_t s = 0; s < segments.size(); ++s) {
+    OutputMap<bool> inputs;
+    for (size_t i = segments[s].begin; i < segments[s].end; ++i) {
+      for (const torch::lazy::Output& operand : post_order[i]->operands()) {
+        auto it = segment_index.find(operand.node);
+        if ((it == segment_index.end() || it->second != s) &&
+            inputs.emplace(operand, true).second) {
+          segments[s].inputs.push_back(operand);
+          if (it != segment_index.end()) {
+            export_output(operand);
+          }
+        }
+      }
+    }
+  }
+  for (const torch::lazy::Value& root : roots) {
+    torch::lazy::Output output(root.node.get(), root.index);
+    if (segment_index.count(output.node) > 0) {
+      export_output(output);
+    }
+  }
+
+  absl::BlockingCounter counter(segments.size());
+  for (size_t s = 0; s < segments.size(); ++s) {
+    thread::Schedule([&, s]() {
+      try {
+        LowerSegment(post_order, leaves, loctx->device(), s, &segments[s]);
+      } catch (...) {
+        segments[s].error = std::current_exception();
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  TORCH_LAZY_COUNTER("ParallelLoweringSegments", segments.size());
+
+  for (Segment& segment : segments) {
+    if (segment.error) {
+      std::rethrow_exception(segment.error);
+    }
+    if (segment.outputs.empty()) {
+      continue;
+    }
+    std::vector<xla::XlaOp> args;
+    for (const torch::lazy::Output& input : segment.inputs) {
+      args.push_back(loctx->GetOutputOp(input));
+    }
+    xla::XlaOp call = xla::Call(loctx->builder(), segment.computation, args);
+    for (size_t i = 0; i < segment.outputs.size(); ++i) {
+      loctx->AssignOutputOp(segment.outputs[i], xla::GetTupleElement(call, i));
+    }
+  }
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,34 @@
+#ifndef XLA_TORCH_XLA_CSRC_PARALLEL_LOWERING_H_
+#define XLA_TORCH_XLA_CSRC_PARALLEL_LOWERING_H_
+
+#include <torch/csrc/lazy/core/ir.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/types/span.h"
+#include "torch_xla/csrc/lowering_context.h"
+
+namespace torch_xla {
+
+// The minimum number of nodes of the graphs lowered with
+// LowerInParallel(), or 0 if disabled (XLA_PARALLEL_LOWERING_MIN_NODES).
+int64_t ParallelLoweringMinNodes();
+
+// Lowers the `post_order` of the graph of `roots` into `loctx`, as contiguous
+// segments lowered into their own builders on the thread pool, then stitched
+// in order as called computations. As the post order is topological, the
+// parameters of a segment are outputs of the earlier segments, and its results
+// the outputs used after it. The segments are cut at a change of the op name
+// prefix (see CustomOpNameMetaData) once they hold `segment_nodes` nodes, so
+// that the layers of a model tend to be lowered as units. The device data
+// nodes are lowered in `loctx` first, so that the graph has the same
+// parameters as with a sequential lowering. The outputs are not annotated with
+// shardings, and the nodes are deduplicated within each segment only.
+void LowerInParallel(absl::Span<const torch::lazy::Node* const> post_order,
+                     absl::Span<const torch::lazy::Value> roots,
+                     size_t segment_nodes, LoweringContext* loctx);
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_PARALLEL_LOWERING_H_
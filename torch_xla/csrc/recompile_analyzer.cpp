@@ -0,0 +1,229 @@
+#include "torch_xla/csrc/recompile_analyzer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "torch_xla/csrc/frame_table.h"
+#include "torch_xla/csrc/ir.h"
+#include "torch_xla/csrc/ops/scalar.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+
+namespace torch_xla {
+namespace {
+
+const char* const kOutputPrefix = "Recompilation Analysis: ";
+
+std::string FormatFrame(const torch::lazy::SourceLocation& location) {
+  std::stringstream ss;
+  ss << location.function << " (" << location.file << ":" << location.line
+     << ")";
+  return ss.str();
+}
+
+void EmitReport(const std::string& report) {
+  static const std::string debug_file_name =
+      runtime::sys_util::GetEnvString("PT_XLA_DEBUG_FILE", "");
+  if (debug_file_name.empty()) {
+    std::cerr << report;
+  } else {
+    std::ofstream out_file(debug_file_name, std::ios_base::app);
+    out_file << report;
+  }
+}
+
+}  // namespace
+
+RecompileAnalyzer* RecompileAnalyzer::Get() {
+  static RecompileAnalyzer* analyzer = new RecompileAnalyzer(
+      runtime::sys_util::GetEnvBool("XLA_ANALYZE_RECOMPILES", false)
+          ? runtime::sys_util::GetEnvInt("XLA_ANALYZE_RECOMPILES_HISTORY", 32)
+          : 0);
+  return analyzer;
+}
+
+void RecompileAnalyzer::AnalyzeCompilation(
+    torch::lazy::hash_t hash,
+    absl::Span<const torch::lazy::Node* const> post_order) {
+  if (!enabled()) {
+    return;
+  }
+  GraphSummary graph = Summarize(hash, post_order);
+  // Taken before locking, the Python frames need the GIL.
+  std::vector<torch::lazy::SourceLocation> sync_frames =
+      FrameTable::Get()->CaptureFrames();
+  std::string report;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    const GraphSummary* closest = nullptr;
+    int64_t closest_distance = 0;
+    // Most recent first, so that ties go to the latest compilation.
+    for (auto it = graphs_.rbegin(); it != graphs_.rend(); ++it) {
+      int64_t distance = Distance(graph, *it);
+      if (closest == nullptr || distance < closest_distance) {
+        closest = &(*it);
+        closest_distance = distance;
+      }
+    }
+    if (closest != nullptr) {
+      report = Compare(graph, *closest, sync_frames);
+      if (reports_.size() >= history_size_) {
+        reports_.pop_front();
+      }
+      reports_.push_back(report);
+    }
+    if (graphs_.size() >= history_size_) {
+      graphs_.pop_front();
+    }
+    graphs_.push_back(std::move(graph));
+  }
+  if (!report.empty()) {
+    EmitReport(report);
+  }
+}
+
+std::vector<std::string> RecompileAnalyzer::GetReports() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return std::vector<std::string>(reports_.begin(), reports_.end());
+}
+
+void RecompileAnalyzer::ClearReports() {
+  std::lock_guard<std::mutex> lock(lock_);
+  reports_.clear();
+}
+
+RecompileAnalyzer::GraphSummary RecompileAnalyzer::Summarize(
+    torch::lazy::hash_t hash,
+    absl::Span<const torch::lazy::Node* const> post_order) {
+  GraphSummary graph;
+  graph.hash = hash;
+  graph.nodes.reserve(post_order.size());
+  for (const torch::lazy::Node* node : post_order) {
+    NodeSummary summary;
+    summary.op = node->op().ToString();
+    summary.text = node->ToString();
+    summary.is_scalar = dynamic_cast<const Scalar*>(node) != nullptr;
+    const XlaNode* xla_node = dynamic_cast<const XlaNode*>(node);
+    if (xla_node != nullptr) {
+      std::stringstream ss;
+      ss << xla_node->xla_shape();
+      summary.shape = ss.str();
+      if (xla_node->shardingHash() != 0) {
+        for (size_t i = 0; i < node->num_outputs(); ++i) {
+          std::shared_ptr<xla::OpSharding> sharding = xla_node->GetSharding(i);
+          summary.sharding +=
+              sharding != nullptr ? sharding->ShortDebugString() : "none";
+          summary.sharding += ";";
+        }
+      }
+    }
+    std::vector<torch::lazy::SourceLocation> frames = GetNodeFrames(node);
+    if (!frames.empty()) {
+      summary.frame = FormatFrame(frames.front());
+    }
+    graph.op_histogram[summary.op] += 1;
+    graph.nodes.push_back(std::move(summary));
+  }
+  return graph;
+}
+
+int64_t RecompileAnalyzer::Distance(const GraphSummary& lhs,
+                                    const GraphSummary& rhs) {
+  int64_t distance = std::abs(static_cast<int64_t>(lhs.nodes.size()) -
+                              static_cast<int64_t>(rhs.nodes.size()));
+  for (auto& op_count : lhs.op_histogram) {
+    auto it = rhs.op_histogram.find(op_count.first);
+    distance += std::abs(
+        op_count.second - (it != rhs.op_histogram.end() ? it->second : 0));
+  }
+  for (auto& op_count : rhs.op_histogram) {
+    if (lhs.op_histogram.count(op_count.first) == 0) {
+      distance += op_count.second;
+    }
+  }
+  return distance;
+}
+
+std::string RecompileAnalyzer::Compare(
+    const GraphSummary& graph, const GraphSummary& closest,
+    absl::Span<const torch::lazy::SourceLocation> sync_frames) {
+  static const int64_t max_frame_count =
+      runtime::sys_util::GetEnvInt("PT_XLA_DEBUG_MAX_FRAME", 8);
+  std::stringstream ss;
+  ss << "\n" << kOutputPrefix << "Graph Hash "
+     << torch::lazy::HashToString(graph.hash) << " (" << graph.nodes.size()
+     << " nodes) is closest to the compiled Graph Hash "
+     << torch::lazy::HashToString(closest.hash) << " ("
+     << closest.nodes.size() << " nodes)\n";
+
+  size_t common_size = std::min(graph.nodes.size(), closest.nodes.size());
+  size_t index = 0;
+  std::string kind;
+  std::string before;
+  std::string after;
+  for (; index < common_size; ++index) {
+    const NodeSummary& node = graph.nodes[index];
+    const NodeSummary& previous = closest.nodes[index];
+    if (node.op != previous.op) {
+      kind = "operation";
+      before = previous.op;
+      after = node.op;
+    } else if (node.shape != previous.shape) {
+      kind = "shape";
+      before = previous.shape;
+      after = node.shape;
+    } else if (node.sharding != previous.sharding) {
+      kind = "sharding";
+      before = previous.sharding.empty() ? "none" : previous.sharding;
+      after = node.sharding.empty() ? "none" : node.sharding;
+    } else if (node.text != previous.text) {
+      kind = node.is_scalar ? "scalar constant" : "attributes";
+      before = previous.text;
+      after = node.text;
+    } else {
+      continue;
+    }
+    break;
+  }
+
+  if (kind.empty()) {
+    if (graph.nodes.size() == closest.nodes.size()) {
+      ss << kOutputPrefix
+         << "  Identical IR, the graphs differ in their parameters (eg. "
+            "donated or read only inputs) or in the graph executor state\n";
+      return ss.str();
+    }
+    ss << kOutputPrefix << "  The first " << common_size
+       << " nodes are identical, the graphs differ in their node count\n";
+    if (graph.nodes.size() < closest.nodes.size()) {
+      return ss.str();
+    }
+    after = graph.nodes[index].text;
+  } else {
+    ss << kOutputPrefix << "  First difference at node " << index
+       << ", in its " << kind << ":\n";
+    ss << kOutputPrefix << "    compiled: " << before << "\n";
+  }
+  ss << kOutputPrefix << "    new: " << after << "\n";
+
+  const std::string& frame = graph.nodes[index].frame;
+  if (!frame.empty()) {
+    ss << kOutputPrefix << "  Created at: " << frame << "\n";
+  } else {
+    ss << kOutputPrefix
+       << "  Python frame of the sync (set XLA_IR_DEBUG=1 for the frame "
+          "which created the node):\n";
+    for (size_t i = 0; i < sync_frames.size(); ++i) {
+      if (i >= static_cast<size_t>(max_frame_count)) {
+        ss << kOutputPrefix << "    ..........\n";
+        break;
+      }
+      ss << kOutputPrefix << "    " << FormatFrame(sync_frames[i]) << "\n";
+    }
+  }
+  return ss.str();
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,83 @@
+#ifndef XLA_TORCH_XLA_CSRC_RECOMPILE_ANALYZER_H_
+#define XLA_TORCH_XLA_CSRC_RECOMPILE_ANALYZER_H_
+
+#include <torch/csrc/lazy/core/hash.h>
+#include <torch/csrc/lazy/core/ir.h>
+#include <torch/csrc/lazy/core/ir_metadata.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+
+namespace torch_xla {
+
+// When XLA_ANALYZE_RECOMPILES is set, explains every uncached compilation by
+// comparing its IR graph with the closest of the last
+// XLA_ANALYZE_RECOMPILES_HISTORY compiled graphs (by node count and operation
+// histogram), and reporting the first node which differs in operation, shape,
+// scalar constant, attributes or sharding, together with the Python frame which
+// created it (needs XLA_IR_DEBUG, else the frame of the sync is reported).
+// Reports go to PT_XLA_DEBUG_FILE, or stderr by default.
+class RecompileAnalyzer {
+ public:
+  static RecompileAnalyzer* Get();
+
+  bool enabled() const { return history_size_ > 0; }
+
+  // Analyzes the compilation of the graph with the given hash and post order,
+  // then records it for the analysis of the later compilations.
+  void AnalyzeCompilation(
+      torch::lazy::hash_t hash,
+      absl::Span<const torch::lazy::Node* const> post_order);
+
+  // The reports of the analyzed compilations which followed an earlier one,
+  // oldest first.
+  std::vector<std::string> GetReports() const;
+
+  void ClearReports();
+
+ private:
+  struct NodeSummary {
+    std::string op;
+    std::string shape;
+    // The node string, covering the scalar values and the op attributes.
+    std::string text;
+    std::string sharding;
+    bool is_scalar = false;
+    std::string frame;
+  };
+
+  struct GraphSummary {
+    torch::lazy::hash_t hash;
+    std::vector<NodeSummary> nodes;
+    std::map<std::string, int64_t> op_histogram;
+  };
+
+  explicit RecompileAnalyzer(size_t history_size)
+      : history_size_(history_size) {}
+
+  static GraphSummary Summarize(
+      torch::lazy::hash_t hash,
+      absl::Span<const torch::lazy::Node* const> post_order);
+
+  static int64_t Distance(const GraphSummary& lhs, const GraphSummary& rhs);
+
+  static std::string Compare(
+      const GraphSummary& graph, const GraphSummary& closest,
+      absl::Span<const torch::lazy::SourceLocation> sync_frames);
+
+  const size_t history_size_;
+  mutable std::mutex lock_;
+  std::deque<GraphSummary> graphs_;
+  std::deque<std::string> reports_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_RECOMPILE_ANALYZER_H_
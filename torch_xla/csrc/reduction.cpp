@@ -5,18 +5,21 @@
 #include <torch/csrc/lazy/core/util.h>
 
 #include <cmath>
+#include <numeric>
 #include <unordered_set>
 
 #include "torch_xla/csrc/convert_ops.h"
 #include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/ops/einsum_utilities.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/shape_helper.h"
 #include "torch_xla/csrc/tensor_util.h"
 #include "xla/client/lib/arithmetic.h"
 #include "xla/client/lib/constants.h"
 #include "xla/client/lib/matrix.h"
 #include "xla/literal_util.h"
+#include "xla/primitive_util.h"
 
 namespace torch_xla {
 namespace {
@@ -273,7 +276,26 @@ xla::XlaOp BuildMseLossBackward(xla::XlaOp grad_output, xla::XlaOp input,
 xla::XlaOp BuildCumulativeComputation(xla::XlaOp input, int64_t dim,
                                       const xla::XlaComputation& reducer,
                                       xla::XlaOp init) {
+  static const int64_t scan_threshold = runtime::sys_util::GetEnvInt(
+      "XLA_CUMULATIVE_SCAN_THRESHOLD", 1024);
   const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
+  int64_t size = input_shape.dimensions(dim);
+  if (size >= scan_threshold && !input_shape.is_dynamic_dimension(dim)) {
+    // A window spanning the whole dimension is O(n^2) work. Lower instead as
+    // a log-step scan, where at step k every element is combined with the one
+    // 2^k before it, for O(n log n) work over log(n) elementwise steps. The
+    // init value is the identity of the reducer, shifted in at the front.
+    std::vector<int64_t> dimensions(input_shape.rank());
+    std::iota(dimensions.begin(), dimensions.end(), 0);
+    xla::XlaOp result = input;
+    for (int64_t shift = 1; shift < size; shift *= 2) {
+      xla::XlaOp shifted = xla::SliceInDim(
+          xla::PadInDim(result, init, dim, shift, 0), 0, size, 1, dim);
+      result = xla::Map(input.builder(), {shifted, result}, reducer,
+                        dimensions);
+    }
+    return result;
+  }
   std::vector<int64_t> window_strides(input_shape.rank(), 1);
   std::vector<int64_t> window_dims(input_shape.rank(), 1);
   window_dims[dim] = input_shape.dimensions(dim);
@@ -304,9 +326,84 @@ xla::XlaOp ApplyCorrectedScaling(const SummationResult& sum_result,
   return sum_result.result * scale;
 }
 
+namespace {
+
+// Merges the (count, mean, M2) statistics of two sets of elements, M2 being
+// the sum of their squared differences to the mean, as in the parallel
+// formulation of Welford's algorithm.
+xla::XlaComputation CreateWelfordComputation(xla::PrimitiveType type) {
+  xla::XlaBuilder builder("WelfordComputation");
+  xla::Shape scalar = xla::ShapeUtil::MakeShape(type, {});
+  xla::XlaOp count_a = xla::Parameter(&builder, 0, scalar, "count_a");
+  xla::XlaOp mean_a = xla::Parameter(&builder, 1, scalar, "mean_a");
+  xla::XlaOp m2_a = xla::Parameter(&builder, 2, scalar, "m2_a");
+  xla::XlaOp count_b = xla::Parameter(&builder, 3, scalar, "count_b");
+  xla::XlaOp mean_b = xla::Parameter(&builder, 4, scalar, "mean_b");
+  xla::XlaOp m2_b = xla::Parameter(&builder, 5, scalar, "m2_b");
+  xla::XlaOp zero = xla::Zero(&builder, type);
+  xla::XlaOp count = count_a + count_b;
+  xla::XlaOp weight_b =
+      xla::Select(xla::Eq(count, zero), zero, count_b / count);
+  xla::XlaOp delta = mean_b - mean_a;
+  xla::Tuple(&builder, {count, mean_a + delta * weight_b,
+                        m2_a + m2_b + delta * delta * count_a * weight_b});
+  return ConsumeValue(builder.Build());
+}
+
+bool CanBuildWelfordVar(const xla::Shape& shape) {
+  return UseWelfordVariance() && !shape.is_dynamic() &&
+         !XlaHelpers::IsUnboundedDynamismEnabled() &&
+         xla::primitive_util::IsFloatingPointType(shape.element_type());
+}
+
+// Reduces the per element statistics of the input in a single pass, instead
+// of reading it once for the mean and once more for the squared differences.
+// The narrower float types accumulate in F32.
+std::pair<xla::XlaOp, xla::XlaOp> BuildWelfordVarMean(
+    xla::XlaOp input, absl::Span<const int64_t> dimensions, double correction,
+    bool keep_reduced_dimensions) {
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
+  xla::PrimitiveType type = shape.element_type();
+  xla::PrimitiveType accumulation_type =
+      type == xla::PrimitiveType::F16 || type == xla::PrimitiveType::BF16
+          ? xla::PrimitiveType::F32
+          : type;
+  xla::XlaBuilder* builder = input.builder();
+  xla::XlaOp zero = xla::Zero(builder, accumulation_type);
+  xla::XlaOp stats = xla::Reduce(
+      builder,
+      {xla::Broadcast(xla::One(builder, accumulation_type), shape.dimensions()),
+       MaybeConvertTo(input, accumulation_type),
+       xla::Broadcast(zero, shape.dimensions())},
+      {zero, zero, zero}, CreateWelfordComputation(accumulation_type),
+      dimensions);
+  SummationResult m2;
+  m2.rinfo =
+      GetReductionInfo(input, shape, dimensions, keep_reduced_dimensions);
+  m2.result = xla::GetTupleElement(stats, 2);
+  xla::XlaOp var =
+      correction != 0
+          ? ApplyCorrectedScaling(m2, correction, accumulation_type)
+          : GetScaleValue(m2.result, m2.rinfo.element_count.size,
+                          accumulation_type);
+  xla::XlaOp mean = xla::GetTupleElement(stats, 1);
+  if (keep_reduced_dimensions) {
+    var = XlaHelpers::DynamicReshape(var, m2.rinfo.new_dimensions);
+    mean = XlaHelpers::DynamicReshape(mean, m2.rinfo.new_dimensions);
+  }
+  return {MaybeConvertTo(var, type), MaybeConvertTo(mean, type)};
+}
+
+}  // namespace
+
 xla::XlaOp BuildVar(xla::XlaOp input, absl::Span<const int64_t> dimensions,
                     double correction, bool keep_reduced_dimensions) {
   const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
+  if (CanBuildWelfordVar(input_shape)) {
+    return BuildWelfordVarMean(input, dimensions, correction,
+                               keep_reduced_dimensions)
+        .first;
+  }
   xla::XlaOp mean =
       BuildMean(input, dimensions, /*keep_reduced_dimensions*/ true);
   xla::XlaOp bcast_mean;
@@ -335,6 +432,23 @@ xla::XlaOp BuildVar(xla::XlaOp input, absl::Span<const int64_t> dimensions,
   return var;
 }
 
+std::pair<xla::XlaOp, xla::XlaOp> BuildVarMean(
+    xla::XlaOp input, absl::Span<const int64_t> dimensions, double correction,
+    bool keep_reduced_dimensions) {
+  if (CanBuildWelfordVar(ShapeHelper::ShapeOfXlaOp(input))) {
+    return BuildWelfordVarMean(input, dimensions, correction,
+                               keep_reduced_dimensions);
+  }
+  return {BuildVar(input, dimensions, correction, keep_reduced_dimensions),
+          BuildMean(input, dimensions, keep_reduced_dimensions)};
+}
+
+bool UseWelfordVariance() {
+  static const bool use_welford =
+      runtime::sys_util::GetEnvBool("XLA_WELFORD_VARIANCE", false);
+  return use_welford;
+}
+
 xla::XlaOp BuildStdDeviation(xla::XlaOp input,
                              absl::Span<const int64_t> dimensions,
                              bool keep_reduced_dimensions, double correction) {
@@ -429,9 +543,15 @@ xla::XlaOp BuildArgMax(xla::XlaOp input, int64_t dim, bool keepdim) {
       shape = &ShapeHelper::ShapeOfXlaOp(operand);
     }
   }
-  xla::XlaOp result = xla::ArgMax(
-      operand, GetXlaPrimitiveTypeForCurrentDevice(xla::PrimitiveType::S64),
-      dim);
+  // The index carried by the reduction is narrowed when it fits the dimension.
+  xla::PrimitiveType index_type =
+      GetXlaPrimitiveTypeForCurrentDevice(xla::PrimitiveType::S64);
+  xla::XlaOp result = xla::ConvertElementType(
+      xla::ArgMax(operand,
+                  XlaHelpers::NarrowIndexType(
+                      index_type, XlaHelpers::SizesOfXlaOp(operand)[dim]),
+                  dim),
+      index_type);
   if (keepdim) {
     auto dimensions = torch::lazy::ToVector<int64_t>(shape->dimensions());
     if (dim_is_none) {
@@ -459,9 +579,15 @@ xla::XlaOp BuildArgMin(xla::XlaOp input, int64_t dim, bool keepdim) {
       shape = &ShapeHelper::ShapeOfXlaOp(operand);
     }
   }
-  xla::XlaOp result = xla::ArgMinMax(
-      operand, GetXlaPrimitiveTypeForCurrentDevice(xla::PrimitiveType::S64),
-      dim, /* is_min */ true);
+  // The index carried by the reduction is narrowed when it fits the dimension.
+  xla::PrimitiveType index_type =
+      GetXlaPrimitiveTypeForCurrentDevice(xla::PrimitiveType::S64);
+  xla::XlaOp result = xla::ConvertElementType(
+      xla::ArgMinMax(operand,
+                     XlaHelpers::NarrowIndexType(
+                         index_type, XlaHelpers::SizesOfXlaOp(operand)[dim]),
+                     dim, /* is_min */ true),
+      index_type);
   if (keepdim) {
     auto dimensions = torch::lazy::ToVector<int64_t>(shape->dimensions());
     if (dim_is_none) {
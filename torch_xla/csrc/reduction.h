@@ -1,6 +1,8 @@
 #ifndef XLA_TORCH_XLA_CSRC_REDUCTION_H_
 #define XLA_TORCH_XLA_CSRC_REDUCTION_H_
 
+#include <utility>
+
 #include "absl/types/span.h"
 #include "xla/client/xla_builder.h"
 
@@ -97,6 +99,16 @@ xla::XlaOp BuildAny(xla::XlaOp input, absl::Span<const int64_t> dimensions,
 xla::XlaOp BuildVar(xla::XlaOp input, absl::Span<const int64_t> dimensions,
                     double correction, bool keep_reduced_dimensions);
 
+// Returns the variance and the mean of the input over the given dimensions,
+// from a single reduction when XLA_WELFORD_VARIANCE is set.
+std::pair<xla::XlaOp, xla::XlaOp> BuildVarMean(
+    xla::XlaOp input, absl::Span<const int64_t> dimensions, double correction,
+    bool keep_reduced_dimensions);
+
+// Whether the variances are reduced in a single pass over the input, merging
+// per element statistics with Welford's algorithm (XLA_WELFORD_VARIANCE).
+bool UseWelfordVariance();
+
 xla::XlaOp BuildLogsumexp(xla::XlaOp input,
                           absl::Span<const int64_t> dimensions,
                           bool keep_reduced_dimensions);
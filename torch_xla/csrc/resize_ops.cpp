@@ -220,6 +220,106 @@ xla::XlaOp BuildResize(xla::XlaOp input, const xla::Shape& output_shape,
   return input;
 }
 
+bool IsKernelBilinear(const std::string& target) {
+  if (target == "ResizeBilinear" || target == "ResizeBilinearGrad") {
+    return true;
+  }
+  XLA_CHECK(target == "ResizeNearest" || target == "ResizeNearestGrad")
+      << "Resize kernel: " << target << " is not supported";
+  return false;
+}
+
+// Returns the [out_size, in_size] F32 matrix of the interpolation weights,
+// whose product with a dimension of in_size elements resizes it to out_size
+// elements, with the sample positions of BuildResize(). Being dense, it turns
+// the resize into matmuls rather than gathers.
+xla::XlaOp BuildInterpolationMatrix(xla::XlaBuilder* builder, int64_t in_size,
+                                    int64_t out_size, bool align_corners,
+                                    bool half_pixel_centers,
+                                    bool is_kernel_bilinear) {
+  float scale = align_corners && out_size > 1
+                    ? (in_size - 1) / static_cast<float>(out_size - 1)
+                    : in_size / static_cast<float>(out_size);
+  xla::Shape shape = xla::ShapeUtil::MakeShape(xla::F32, {out_size, in_size});
+  xla::XlaOp out_pos = xla::Iota(builder, shape, 0);
+  xla::XlaOp in_pos = xla::Iota(builder, shape, 1);
+  xla::XlaOp half = xla::ConstantR0<float>(builder, 0.5f);
+  xla::XlaOp zero = xla::Zero(builder, xla::F32);
+  if (half_pixel_centers) {
+    out_pos = xla::Add(out_pos, half);
+  }
+  xla::XlaOp sample =
+      xla::Mul(out_pos, xla::ConstantR0<float>(builder, scale));
+  if (is_kernel_bilinear) {
+    if (half_pixel_centers) {
+      sample = xla::Sub(sample, half);
+    }
+    // The triangle kernel, normalized over the input positions, which also
+    // clamps the samples falling outside of the input.
+    xla::XlaOp weight =
+        xla::Max(zero, xla::Sub(xla::One(builder, xla::F32),
+                                xla::Abs(xla::Sub(in_pos, sample))));
+    xla::XlaOp weight_sum = xla::Reduce(
+        weight, zero, XlaHelpers::CreateAddComputation(xla::F32), {1});
+    return xla::Div(weight, weight_sum, {0});
+  }
+  xla::XlaOp index = align_corners ? xla::Round(sample) : xla::Floor(sample);
+  index = xla::Min(index, xla::ConstantR0<float>(builder, in_size - 1));
+  return xla::ConvertElementType(xla::Eq(in_pos, index), xla::F32);
+}
+
+// Resizes the H and W dimensions of the NCHW `input` to the ones of
+// `output_shape` as two matmuls by the interpolation matrices, which map onto
+// the matrix units. The backward multiplies the gradients by the transposed
+// matrices of the forward resize from `output_shape` to `input`.
+xla::XlaOp BuildMatmulResize(xla::XlaOp input, const xla::Shape& output_shape,
+                             bool align_corners, bool half_pixel_centers,
+                             bool is_kernel_bilinear, bool backward) {
+  xla::XlaBuilder* builder = input.builder();
+  const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
+  XLA_CHECK_EQ(input_shape.rank(), 4)
+      << "input must be 4-dimensional, got " << input_shape;
+  const xla::Shape& small_shape = backward ? output_shape : input_shape;
+  const xla::Shape& large_shape = backward ? input_shape : output_shape;
+  xla::PrimitiveType original_type = input_shape.element_type();
+  xla::PrimitiveType type =
+      xla::primitive_util::IsIntegralType(original_type) ? xla::F32
+                                                         : original_type;
+  input = xla::ConvertElementType(input, type);
+  std::vector<xla::XlaOp> matrices;
+  for (int64_t dim : {2, 3}) {
+    matrices.push_back(xla::ConvertElementType(
+        BuildInterpolationMatrix(builder, small_shape.dimensions(dim),
+                                 large_shape.dimensions(dim), align_corners,
+                                 half_pixel_centers, is_kernel_bilinear),
+        type));
+  }
+  // The matrices are [forward output, forward input], so the forward resize
+  // contracts their minor dimension and the backward their major one.
+  int64_t contracting_dim = backward ? 0 : 1;
+  xla::PrecisionConfig precision_config =
+      XlaHelpers::BuildPrecisionConfig(XlaHelpers::mat_mul_precision());
+  xla::DotDimensionNumbers w_dnums;
+  w_dnums.add_lhs_contracting_dimensions(3);
+  w_dnums.add_rhs_contracting_dimensions(contracting_dim);
+  // [N, C, H, W] x [W', W] -> [N, C, H, W']
+  xla::XlaOp output =
+      xla::DotGeneral(input, matrices[1], w_dnums, &precision_config);
+  xla::DotDimensionNumbers h_dnums;
+  h_dnums.add_lhs_contracting_dimensions(2);
+  h_dnums.add_rhs_contracting_dimensions(contracting_dim);
+  // [N, C, H, W'] x [H', H] -> [N, C, W', H']
+  output = xla::DotGeneral(output, matrices[0], h_dnums, &precision_config);
+  output = xla::Transpose(output, {0, 1, 3, 2});
+  return xla::ConvertElementType(output, original_type);
+}
+
+bool UseMatmulResize() {
+  static const bool use_matmul =
+      runtime::sys_util::GetEnvBool("XLA_RESIZE_WITH_MATMUL", false);
+  return use_matmul;
+}
+
 std::string GetBackendConfig(bool align_corners, bool half_pixel_centers) {
   return absl::StrCat("\"", align_corners, half_pixel_centers, "\"");
 }
@@ -259,6 +359,11 @@ xla::XlaOp LowerForward2d(const std::string& target, xla::XlaOp input,
   if (input_shape.dimensions(2) == 1 && input_shape.dimensions(3) == 1) {
     return input + xla::Zeros(input.builder(), output_shape);
   }
+  if (UseMatmulResize()) {
+    return BuildMatmulResize(input, output_shape, align_corners,
+                             half_pixel_centers, IsKernelBilinear(target),
+                             /*backward=*/false);
+  }
   // XLA wants NHWC while PyTorch comes in as NCHW, so we need to transpose,
   // call the kernel, and transpose back.
   std::vector<int64_t> transpose_permute({0, 3, 2, 1});
@@ -277,16 +382,8 @@ xla::XlaOp LowerForward2d(const std::string& target, xla::XlaOp input,
         xla::CustomCall(input.builder(), target, {tinput}, resized_shape,
                         GetBackendConfig(align_corners, half_pixel_centers));
   } else {
-    bool is_kernel_bilinear = false;
-    if (target == "ResizeBilinear") {
-      is_kernel_bilinear = true;
-    } else if (target == "ResizeNearest") {
-      is_kernel_bilinear = false;
-    } else {
-      XLA_ERROR() << "Resize kernel: " << target << " is not supported";
-    }
     resized = BuildResize(tinput, resized_shape, align_corners,
-                          half_pixel_centers, is_kernel_bilinear);
+                          half_pixel_centers, IsKernelBilinear(target));
   }
   return xla::Transpose(resized, inv_transpose_permute);
 }
@@ -302,6 +399,11 @@ xla::XlaOp LowerBackward2d(const std::string& target, xla::XlaOp input,
       input_shape.dimensions(3) == output_shape.dimensions(3)) {
     return input;
   }
+  if (UseMatmulResize()) {
+    return BuildMatmulResize(input, output_shape, align_corners,
+                             half_pixel_centers, IsKernelBilinear(target),
+                             /*backward=*/true);
+  }
   // XLA wants NHWC while PyTorch comes in as NCHW, so we need to transpose,
   // call the kernel, and transpose back.
   std::vector<int64_t> transpose_permute({0, 3, 2, 1});
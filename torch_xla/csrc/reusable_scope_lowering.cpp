@@ -0,0 +1,194 @@
+#include "torch_xla/csrc/reusable_scope_lowering.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "torch_xla/csrc/ir.h"
+#include "torch_xla/csrc/node_deduplicator.h"
+#include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "xla/client/xla_builder.h"
+
+namespace torch_xla {
+namespace {
+
+const CustomOpNameMetaData* ReusableScopeMetadata(
+    const torch::lazy::Node* node) {
+  if (node->op() == xla_device_data) {
+    return nullptr;
+  }
+  const CustomOpNameMetaData* metadata =
+      dynamic_cast<const CustomOpNameMetaData*>(node->user_metadata());
+  return metadata != nullptr && metadata->reusable ? metadata : nullptr;
+}
+
+const xla::Shape& OutputShape(const torch::lazy::Output& output) {
+  return static_cast<const XlaNode*>(output.node)->xla_shape(output.index);
+}
+
+torch::lazy::hash_t ShapeHash(const xla::Shape& shape) {
+  return torch::lazy::Hash(shape.ToString());
+}
+
+}  // namespace
+
+ReusableScopeLowering::ReusableScopeLowering(
+    absl::Span<const torch::lazy::Node* const> post_order,
+    absl::Span<const torch::lazy::Value> roots) {
+  std::unordered_map<const CustomOpNameMetaData*, size_t> scope_of_metadata;
+  std::vector<size_t> last_position;
+  for (size_t i = 0; i < post_order.size(); ++i) {
+    const CustomOpNameMetaData* metadata = ReusableScopeMetadata(post_order[i]);
+    if (metadata == nullptr) {
+      continue;
+    }
+    auto it = scope_of_metadata.emplace(metadata, scopes_.size()).first;
+    if (it->second == scopes_.size()) {
+      scopes_.emplace_back();
+      last_position.push_back(0);
+    }
+    scopes_[it->second].nodes.push_back(post_order[i]);
+    scope_index_[post_order[i]] = it->second;
+    last_position[it->second] = i;
+  }
+  if (scopes_.empty()) {
+    return;
+  }
+
+  // A scope is called at its last node, which requires all the users of its
+  // outputs outside of it to come later in the post order.
+  std::vector<bool> callable(scopes_.size(), true);
+  std::vector<OutputMap<bool>> exported(scopes_.size());
+  for (size_t i = 0; i < post_order.size(); ++i) {
+    auto user_it = scope_index_.find(post_order[i]);
+    for (const torch::lazy::Output& operand : post_order[i]->operands()) {
+      auto it = scope_index_.find(operand.node);
+      if (it != scope_index_.end() &&
+          (user_it == scope_index_.end() || user_it->second != it->second)) {
+        exported[it->second].emplace(operand, true);
+        if (i < last_position[it->second]) {
+          callable[it->second] = false;
+        }
+      }
+    }
+  }
+  for (const torch::lazy::Value& root : roots) {
+    torch::lazy::Output output(root.node.get(), root.index);
+    auto it = scope_index_.find(output.node);
+    if (it != scope_index_.end()) {
+      exported[it->second].emplace(output, true);
+    }
+  }
+  for (size_t s = 0; s < scopes_.size(); ++s) {
+    if (callable[s]) {
+      MakeSignature(exported[s], &scopes_[s]);
+      continue;
+    }
+    TF_VLOG(3) << "Reusable scope " << s << " of " << scopes_[s].nodes.size()
+               << " nodes is used before its last node, lowered node by node";
+    for (const torch::lazy::Node* node : scopes_[s].nodes) {
+      scope_index_.erase(node);
+    }
+  }
+}
+
+void ReusableScopeLowering::MakeSignature(const OutputMap<bool>& exported,
+                                          Scope* scope) {
+  std::unordered_map<const torch::lazy::Node*, size_t> local_index;
+  for (size_t i = 0; i < scope->nodes.size(); ++i) {
+    local_index[scope->nodes[i]] = i;
+  }
+  OutputMap<size_t> input_index;
+  torch::lazy::hash_t hash = torch::lazy::Hash(scope->nodes.size());
+  for (const torch::lazy::Node* node : scope->nodes) {
+    const XlaNode* xla_node = static_cast<const XlaNode*>(node);
+    hash = torch::lazy::HashCombine(hash, xla_node->node_hash());
+    for (size_t i = 0; i < node->num_outputs(); ++i) {
+      hash = torch::lazy::HashCombine(hash, ShapeHash(xla_node->xla_shape(i)));
+    }
+    for (const torch::lazy::Output& operand : node->operands()) {
+      auto it = local_index.find(operand.node);
+      if (it != local_index.end()) {
+        hash = torch::lazy::MHash(hash, "node", it->second, operand.index);
+        continue;
+      }
+      auto input_it = input_index.emplace(operand, scope->inputs.size()).first;
+      if (input_it->second == scope->inputs.size()) {
+        scope->inputs.push_back(operand);
+        hash = torch::lazy::HashCombine(hash, ShapeHash(OutputShape(operand)));
+      }
+      hash = torch::lazy::MHash(hash, "input", input_it->second);
+    }
+    // The results follow the post order, whatever the order of the users.
+    for (size_t i = 0; i < node->num_outputs(); ++i) {
+      torch::lazy::Output output(node, i);
+      if (exported.count(output) > 0) {
+        scope->outputs.push_back(output);
+        hash = torch::lazy::MHash(hash, "output", local_index.at(node), i);
+      }
+    }
+  }
+  scope->hash = hash;
+}
+
+bool ReusableScopeLowering::TryLower(const torch::lazy::Node* node,
+                                     LoweringContext* loctx) {
+  auto it = scope_index_.find(node);
+  if (it == scope_index_.end()) {
+    return false;
+  }
+  const Scope& scope = scopes_[it->second];
+  if (node == scope.nodes.back()) {
+    LowerScope(scope, loctx);
+  }
+  return true;
+}
+
+void ReusableScopeLowering::LowerScope(const Scope& scope,
+                                       LoweringContext* loctx) {
+  if (scope.outputs.empty()) {
+    return;
+  }
+  auto it = computations_.find(scope.hash);
+  if (it == computations_.end()) {
+    LoweringContext scope_loctx(
+        absl::StrCat("ReusableScope", computations_.size()), loctx->device());
+    for (size_t i = 0; i < scope.inputs.size(); ++i) {
+      const torch::lazy::Output& input = scope.inputs[i];
+      scope_loctx.AssignOutputOp(
+          input, xla::Parameter(scope_loctx.builder(), i, OutputShape(input),
+                                absl::StrCat("p", i)));
+    }
+    NodeDeduplicator deduplicator;
+    for (const torch::lazy::Node* node : scope.nodes) {
+      if (NodeDeduplicator::Enabled() &&
+          deduplicator.TryReuse(node, &scope_loctx)) {
+        continue;
+      }
+      scope_loctx.LowerNode(node);
+    }
+    std::vector<xla::XlaOp> results;
+    for (const torch::lazy::Output& output : scope.outputs) {
+      results.push_back(scope_loctx.GetOutputOp(output));
+    }
+    xla::XlaComputation computation = ConsumeValue(
+        scope_loctx.BuildXla(xla::Tuple(scope_loctx.builder(), results)));
+    it = computations_.emplace(scope.hash, std::move(computation)).first;
+    TORCH_LAZY_COUNTER("ReusableScopeComputations", 1);
+  } else {
+    TORCH_LAZY_COUNTER("ReusedScopeLowerings", 1);
+  }
+  std::vector<xla::XlaOp> args;
+  for (const torch::lazy::Output& input : scope.inputs) {
+    args.push_back(loctx->GetOutputOp(input));
+  }
+  xla::XlaOp call = xla::Call(loctx->builder(), it->second, args);
+  for (size_t i = 0; i < scope.outputs.size(); ++i) {
+    loctx->AssignOutputOp(scope.outputs[i], xla::GetTupleElement(call, i));
+  }
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,63 @@
+#ifndef XLA_TORCH_XLA_CSRC_REUSABLE_SCOPE_LOWERING_H_
+#define XLA_TORCH_XLA_CSRC_REUSABLE_SCOPE_LOWERING_H_
+
+#include <torch/csrc/lazy/core/hash.h>
+#include <torch/csrc/lazy/core/ir.h>
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "torch_xla/csrc/lowering_context.h"
+#include "xla/client/xla_computation.h"
+
+namespace torch_xla {
+
+// Lowers the reusable scopes of a graph as calls to shared computations. A
+// reusable scope is the subgraph marked with the same reusable
+// CustomOpNameMetaData (see mark_reusable_scope() in Python), like a layer of
+// a model. The scopes of the same structure (the same ops, attributes, shapes
+// and wiring of their nodes, and the same input shapes) call the computation
+// lowered for the first of them, so that the repeated layers are lowered once.
+// The device data nodes are inputs of the scopes, as the data differs between
+// layers. A scope whose outputs are used before its last node in the post
+// order cannot be emitted as a single call and is lowered node by node.
+class ReusableScopeLowering {
+ public:
+  ReusableScopeLowering(absl::Span<const torch::lazy::Node* const> post_order,
+                        absl::Span<const torch::lazy::Value> roots);
+
+  // Handles `node` of the post order if it belongs to a reusable scope,
+  // emitting the call of the scope at its last node. Returns false for the
+  // nodes to be lowered by the caller.
+  bool TryLower(const torch::lazy::Node* node, LoweringContext* loctx);
+
+ private:
+  struct Scope {
+    // The nodes of the scope, in post order.
+    std::vector<const torch::lazy::Node*> nodes;
+    // The outputs of the other nodes used by the scope, in parameter order.
+    std::vector<torch::lazy::Output> inputs;
+    // The outputs used after the scope or by the roots, in result order.
+    std::vector<torch::lazy::Output> outputs;
+    torch::lazy::hash_t hash;
+  };
+
+  // Sets the inputs, the outputs among `exported` and the structural hash of
+  // `scope`.
+  void MakeSignature(const OutputMap<bool>& exported, Scope* scope);
+
+  void LowerScope(const Scope& scope, LoweringContext* loctx);
+
+  std::vector<Scope> scopes_;
+  std::unordered_map<const torch::lazy::Node*, size_t> scope_index_;
+  // The computations of the scopes, by structural hash.
+  std::unordered_map<torch::lazy::hash_t, xla::XlaComputation,
+                     torch::lazy::HashReducer>
+      computations_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_REUSABLE_SCOPE_LOWERING_H_
@@ -1,18 +1,28 @@
 #ifndef XLA_CLIENT_CACHE_H_
 #define XLA_CLIENT_CACHE_H_
 
-#include <sys/stat.h>
+#include <unistd.h>
 #include <torch/csrc/lazy/core/metrics.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <sstream>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace torch_xla {
 namespace runtime {
@@ -27,6 +37,10 @@ class AbstractCache {
   virtual TypePtr Get(const K& key) = 0;
   virtual bool Erase(const K& key) = 0;
   virtual void Clear() = 0;
+  // Removes up to `count` of the least recently used objects, so that their
+  // memory is released once the users holding them are done, and returns how
+  // many were removed.
+  virtual size_t Shrink(size_t count) { return 0; }
 };
 
 // Generic key and object cache with LRU expiration policy. The objects of type
@@ -91,6 +105,16 @@ class Cache : public AbstractCache<K, T, H, E> {
     element_list_.clear();
   }
 
+  size_t Shrink(size_t count) override {
+    std::lock_guard<std::mutex> slock(lock_);
+    size_t removed = 0;
+    for (; removed < count && !element_list_.empty(); ++removed) {
+      element_map_.erase(&element_list_.back().first);
+      element_list_.pop_back();
+    }
+    return removed;
+  }
+
  private:
   using ElementList = std::list<Element>;
 
@@ -122,9 +146,288 @@ class Cache : public AbstractCache<K, T, H, E> {
   ElementMap element_map_;
 };
 
+// Key and object cache split into independently locked shards, so that
+// concurrent lookups of different keys do not contend on a single mutex. Each
+// shard evicts with the CLOCK policy, which approximates LRU: a hit only sets a
+// reference bit (under a shared lock), and the eviction hand gives referenced
+// objects a second chance. If a name is given, hits, misses and evictions are
+// reported as the <name>Hit, <name>Miss and <name>Eviction counters.
+template <typename K, typename T, typename H = std::hash<K>,
+          typename E = std::equal_to<K>>
+class ShardedCache : public AbstractCache<K, T, H, E> {
+ public:
+  using TypePtr = std::shared_ptr<T>;
+
+  ShardedCache(size_t max_size, size_t num_shards, const std::string& name = "")
+      : shards_(std::max<size_t>(num_shards, 1)) {
+    size_t shard_size = std::max<size_t>(
+        (max_size + shards_.size() - 1) / shards_.size(), 1);
+    for (auto& shard : shards_) {
+      shard = std::make_unique<Shard>(shard_size);
+    }
+    if (!name.empty()) {
+      hit_counter_ = std::make_unique<torch::lazy::Counter>(name + "Hit");
+      miss_counter_ = std::make_unique<torch::lazy::Counter>(name + "Miss");
+      eviction_counter_ =
+          std::make_unique<torch::lazy::Counter>(name + "Eviction");
+    }
+  }
+
+  // Adds an object to the cache, unless it already exists, in which case the
+  // existing object is returned. If the shard is full, the first object the
+  // CLOCK hand finds unreferenced is removed from the cache.
+  TypePtr Add(K key, TypePtr object) override {
+    Shard& shard = GetShard(key);
+    std::unique_lock<std::shared_mutex> slock(shard.lock);
+    auto it = shard.element_map.find(key);
+    if (it != shard.element_map.end()) {
+      Slot& slot = shard.slots[it->second];
+      slot.referenced.store(true, std::memory_order_relaxed);
+      return slot.object;
+    }
+    size_t index;
+    if (!shard.free_slots.empty()) {
+      index = shard.free_slots.back();
+      shard.free_slots.pop_back();
+    } else {
+      index = Evict(&shard);
+    }
+    auto emplace_result = shard.element_map.emplace(std::move(key), index);
+    Slot& slot = shard.slots[index];
+    slot.key = &emplace_result.first->first;
+    slot.object = std::move(object);
+    slot.referenced.store(false, std::memory_order_relaxed);
+    return slot.object;
+  }
+
+  // Retrieves the existing object if it exists, and marks it as recently used.
+  // Returns nullptr if no object with the specified key is found within the
+  // cache.
+  TypePtr Get(const K& key) override {
+    Shard& shard = GetShard(key);
+    std::shared_lock<std::shared_mutex> slock(shard.lock);
+    auto it = shard.element_map.find(key);
+    if (it == shard.element_map.end()) {
+      AddToCounter(miss_counter_.get());
+      return nullptr;
+    }
+    AddToCounter(hit_counter_.get());
+    Slot& slot = shard.slots[it->second];
+    slot.referenced.store(true, std::memory_order_relaxed);
+    return slot.object;
+  }
+
+  bool Erase(const K& key) override {
+    Shard& shard = GetShard(key);
+    std::unique_lock<std::shared_mutex> slock(shard.lock);
+    auto it = shard.element_map.find(key);
+    if (it == shard.element_map.end()) {
+      return false;
+    }
+    ReleaseSlot(&shard, it->second);
+    shard.element_map.erase(it);
+    return true;
+  }
+
+  void Clear() override {
+    for (auto& shard : shards_) {
+      std::unique_lock<std::shared_mutex> slock(shard->lock);
+      for (auto& element : shard->element_map) {
+        ReleaseSlot(shard.get(), element.second);
+      }
+      shard->element_map.clear();
+    }
+  }
+
+  // Removes the objects the CLOCK hands find unreferenced, taking them from
+  // the shards in turn.
+  size_t Shrink(size_t count) override {
+    size_t removed = 0;
+    bool any_removed = true;
+    while (removed < count && any_removed) {
+      any_removed = false;
+      for (auto& shard : shards_) {
+        if (removed == count) {
+          break;
+        }
+        std::unique_lock<std::shared_mutex> slock(shard->lock);
+        if (!shard->element_map.empty()) {
+          ReleaseSlot(shard.get(), Evict(shard.get()));
+          removed += 1;
+          any_removed = true;
+        }
+      }
+    }
+    return removed;
+  }
+
+ private:
+  struct Slot {
+    // Points into the owning shard's element_map, nullptr for free slots.
+    const K* key = nullptr;
+    TypePtr object;
+    std::atomic<bool> referenced{false};
+  };
+
+  struct Shard {
+    explicit Shard(size_t size) : slots(size) {
+      free_slots.reserve(size);
+      for (size_t i = size; i > 0; --i) {
+        free_slots.push_back(i - 1);
+      }
+    }
+
+    std::shared_mutex lock;
+    std::vector<Slot> slots;
+    std::vector<size_t> free_slots;
+    std::unordered_map<K, size_t, H, E> element_map;
+    size_t hand = 0;
+  };
+
+  Shard& GetShard(const K& key) {
+    // Mix the hash, so the shard does not correlate with the map bucket.
+    uint64_t hash =
+        static_cast<uint64_t>(hasher_(key)) * 0x9E3779B97F4A7C15ULL;
+    return *shards_[(hash >> 32) % shards_.size()];
+  }
+
+  // Frees the slot of the first unreferenced object found by the CLOCK hand,
+  // skipping the free slots. Only called on non empty shards.
+  size_t Evict(Shard* shard) {
+    while (true) {
+      size_t index = shard->hand;
+      shard->hand = (shard->hand + 1) % shard->slots.size();
+      Slot& slot = shard->slots[index];
+      if (slot.key == nullptr) {
+        continue;
+      }
+      if (!slot.referenced.exchange(false, std::memory_order_relaxed)) {
+        shard->element_map.erase(*slot.key);
+        slot.key = nullptr;
+        slot.object = nullptr;
+        AddToCounter(eviction_counter_.get());
+        return index;
+      }
+    }
+  }
+
+  void ReleaseSlot(Shard* shard, size_t index) {
+    Slot& slot = shard->slots[index];
+    slot.key = nullptr;
+    slot.object = nullptr;
+    shard->free_slots.push_back(index);
+  }
+
+  static void AddToCounter(torch::lazy::Counter* counter) {
+    if (counter != nullptr) {
+      counter->AddValue(1);
+    }
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  H hasher_;
+  std::unique_ptr<torch::lazy::Counter> hit_counter_;
+  std::unique_ptr<torch::lazy::Counter> miss_counter_;
+  std::unique_ptr<torch::lazy::Counter> eviction_counter_;
+};
+
+// Storage of named values backing a PersistentCache. Names starting with a dot
+// are reserved for the cache metadata, and are not reported by List().
+class CacheStorage {
+ public:
+  virtual ~CacheStorage() = default;
+
+  // Returns the size of the stored value, or -1 if there is none.
+  virtual int64_t Size(const std::string& name) = 0;
+
+  virtual bool Read(const std::string& name, std::string* value) = 0;
+
+  // Stores the value such that concurrent readers never observe a partially
+  // written value.
+  virtual void Write(const std::string& name, const std::string& value) = 0;
+
+  virtual bool Remove(const std::string& name) = 0;
+
+  virtual void RemoveAll() = 0;
+
+  // Returns the name and size of all the stored values.
+  virtual std::vector<std::pair<std::string, int64_t>> List() = 0;
+};
+
+// Stores the values as files within a local (or mounted) directory.
+class LocalCacheStorage : public CacheStorage {
+ public:
+  explicit LocalCacheStorage(std::string dir) : dir_(std::move(dir)) {
+    std::filesystem::create_directories(dir_);
+  }
+
+  int64_t Size(const std::string& name) override {
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(dir_ / name, ec);
+    return ec ? -1 : static_cast<int64_t>(size);
+  }
+
+  bool Read(const std::string& name, std::string* value) override {
+    std::ifstream in(dir_ / name, std::ios::binary);
+    if (!in) {
+      return false;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    *value = ss.str();
+    return true;
+  }
+
+  void Write(const std::string& name, const std::string& value) override {
+    // Processes sharing the directory may write the same name concurrently.
+    std::filesystem::path tmp_path =
+        dir_ / ("." + name + "." + std::to_string(getpid()) + ".tmp");
+    {
+      std::ofstream out(tmp_path, std::ios::binary);
+      out << value;
+    }
+    std::filesystem::rename(tmp_path, dir_ / name);
+  }
+
+  bool Remove(const std::string& name) override {
+    std::error_code ec;
+    return std::filesystem::remove(dir_ / name, ec);
+  }
+
+  void RemoveAll() override {
+    std::filesystem::remove_all(dir_);
+    std::filesystem::create_directories(dir_);
+  }
+
+  std::vector<std::pair<std::string, int64_t>> List() override {
+    std::vector<std::pair<std::string, int64_t>> values;
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(dir_, ec)) {
+      std::string name = file.path().filename().string();
+      if (file.is_regular_file() && !name.empty() && name[0] != '.') {
+        values.emplace_back(name, file.file_size());
+      }
+    }
+    return values;
+  }
+
+ private:
+  std::filesystem::path dir_;
+};
+
 // A persistent cache which serializes values to disk. This wraps a Cache
 // instance, so values will only be read from disk once and subsequent reads
 // will go through the wrapped Cache.
+// The values are kept in a CacheStorage, a local directory by default, which
+// can be shared by multiple processes. The storage also holds an index of the
+// stored values (size, last access time and the tag of the environment which
+// wrote them), which is used to keep the stored values within
+// max_storage_bytes, evicting the least recently used ones first. When
+// async_writes is set, values are serialized and written by a background
+// thread, and Flush() must be called to make sure pending writes reach the
+// storage. When prefetch is set, the most recently used values written with
+// the same index_tag are loaded at construction, so the first lookups do not
+// have to hit the storage.
 template <typename K, typename T, typename H = std::hash<K>,
           typename E = std::equal_to<K>>
 class PersistentCache : public AbstractCache<K, T, H, E> {
@@ -134,13 +437,48 @@ class PersistentCache : public AbstractCache<K, T, H, E> {
   explicit PersistentCache(
       int kMaxMemoryCacheSize, std::string cache_dir, bool readonly_storage,
       std::function<std::string(const TypePtr&)> serialize,
-      std::function<TypePtr(const std::string&)> deserialize)
+      std::function<TypePtr(const std::string&)> deserialize,
+      size_t max_storage_bytes = 0, bool async_writes = false,
+      std::string index_tag = "", bool prefetch = false)
+      : PersistentCache(kMaxMemoryCacheSize,
+                        std::make_unique<LocalCacheStorage>(cache_dir),
+                        readonly_storage, serialize, deserialize,
+                        max_storage_bytes, async_writes, index_tag, prefetch) {}
+
+  PersistentCache(int kMaxMemoryCacheSize,
+                  std::unique_ptr<CacheStorage> storage, bool readonly_storage,
+                  std::function<std::string(const TypePtr&)> serialize,
+                  std::function<TypePtr(const std::string&)> deserialize,
+                  size_t max_storage_bytes = 0, bool async_writes = false,
+                  std::string index_tag = "", bool prefetch = false)
       : memory_cache_(kMaxMemoryCacheSize),
-        cache_dir_(cache_dir),
-        readonly_storage_(readonly_storage),
         serialize_(serialize),
-        deserialize_(deserialize) {
-    std::filesystem::create_directories(cache_dir);
+        deserialize_(deserialize),
+        storage_(std::move(storage)),
+        readonly_storage_(readonly_storage),
+        max_memory_cache_size_(kMaxMemoryCacheSize),
+        max_storage_bytes_(max_storage_bytes),
+        index_tag_(index_tag.empty() ? "-" : index_tag) {
+    LoadIndex();
+    if (async_writes && !readonly_storage_) {
+      prefetch_pending_ = prefetch;
+      writer_ = std::thread([this]() { WriterLoop(); });
+    } else if (prefetch) {
+      Prefetch();
+    }
+  }
+
+  ~PersistentCache() {
+    if (writer_.joinable()) {
+      {
+        std::lock_guard<std::mutex> slock(lock_);
+        stop_ = true;
+      }
+      writer_cv_.notify_all();
+      writer_.join();
+    }
+    std::lock_guard<std::mutex> slock(lock_);
+    MaybeWriteIndex();
   }
 
   // Add the value to the persistent cache. This only writes to disk if no
@@ -150,10 +488,18 @@ class PersistentCache : public AbstractCache<K, T, H, E> {
   // If the cache is readonly, nothing is written to disk.
   TypePtr Add(K key, TypePtr obj) override {
     std::lock_guard<std::mutex> slock(lock_);
-    std::string path = GetPath(key);
-    if (!Exists(path) && !readonly_storage_) {
-      std::ofstream out(path, std::ios::binary);
-      out << serialize_(obj);
+    if (!readonly_storage_) {
+      std::string name = GetName(key);
+      if (index_.count(name) == 0 && pending_writes_.count(name) == 0) {
+        if (writer_.joinable()) {
+          pending_writes_.emplace(name, obj);
+          write_queue_.push_back(name);
+          writer_cv_.notify_one();
+        } else {
+          RecordWrite(name, WriteValue(name, obj));
+          MaybeWriteIndex();
+        }
+      }
     }
     return memory_cache_.Add(key, obj);
   }
@@ -165,20 +511,33 @@ class PersistentCache : public AbstractCache<K, T, H, E> {
     std::lock_guard<std::mutex> slock(lock_);
     TypePtr mem = memory_cache_.Get(key);
     if (mem) {
+      if (max_storage_bytes_ > 0) {
+        Touch(GetName(key));
+      }
       return mem;
     }
 
-    std::string path = GetPath(key);
-    if (!Exists(path)) {
+    std::string name = GetName(key);
+    auto pending_it = pending_writes_.find(name);
+    if (pending_it != pending_writes_.end()) {
+      return memory_cache_.Add(key, pending_it->second);
+    }
+    auto prefetched_it = prefetched_.find(name);
+    if (prefetched_it != prefetched_.end()) {
+      TORCH_LAZY_COUNTER("PersistentCacheHit", 1);
+      TORCH_LAZY_COUNTER("PersistentCachePrefetchHit", 1);
+      TypePtr val = std::move(prefetched_it->second);
+      prefetched_.erase(prefetched_it);
+      Touch(name);
+      return memory_cache_.Add(key, val);
+    }
+
+    std::string serialization;
+    if (!storage_->Read(name, &serialization)) {
       TORCH_LAZY_COUNTER("PersistentCacheMiss", 1);
       return nullptr;
     }
     TORCH_LAZY_TIMED("PersistentCacheLoad");
-    std::stringstream ss;
-    std::ifstream in(path, std::ios::binary);
-    ss << in.rdbuf();
-    std::string serialization = ss.str();
-
     TypePtr val = deserialize_(serialization);
     if (!val) {
       TORCH_LAZY_COUNTER("PersistentCacheDeserializeFailure", 1);
@@ -187,6 +546,11 @@ class PersistentCache : public AbstractCache<K, T, H, E> {
       return nullptr;
     }
     TORCH_LAZY_COUNTER("PersistentCacheHit", 1);
+    if (index_.count(name) == 0) {
+      // Written by another process sharing the cache directory.
+      RecordWrite(name, serialization.size(), /*tag=*/"-");
+    }
+    Touch(name);
     // Make sure the memory_cache_ tracks the value to prevent multiple loads
     return memory_cache_.Add(key, val);
   }
@@ -194,10 +558,15 @@ class PersistentCache : public AbstractCache<K, T, H, E> {
   void Clear() override {
     std::lock_guard<std::mutex> slock(lock_);
     memory_cache_.Clear();
-    // Delete and recreate the cache directory on disk.
+    prefetched_.clear();
+    // Delete all the stored values.
     if (!readonly_storage_) {
-      std::filesystem::remove_all(cache_dir_);
-      std::filesystem::create_directories(cache_dir_);
+      pending_writes_.clear();
+      write_queue_.clear();
+      index_.clear();
+      storage_bytes_ = 0;
+      index_dirty_ = false;
+      storage_->RemoveAll();
     }
   }
 
@@ -206,35 +575,279 @@ class PersistentCache : public AbstractCache<K, T, H, E> {
     return EraseImpl(key);
   }
 
+  // Only the memory cache is shrunk, the objects removed being loaded again
+  // from the storage on their next use.
+  size_t Shrink(size_t count) override {
+    std::lock_guard<std::mutex> slock(lock_);
+    return memory_cache_.Shrink(count);
+  }
+
+  // Blocks until all the pending writes are on disk, and persists the index.
+  void Flush() {
+    std::unique_lock<std::mutex> slock(lock_);
+    flush_cv_.wait(slock, [this]() {
+      return write_queue_.empty() && writes_in_flight_ == 0 &&
+             !prefetch_pending_;
+    });
+    MaybeWriteIndex();
+  }
+
   Cache<K, T, H, E>& GetMemoryCache() { return memory_cache_; }
 
  private:
-  std::string GetPath(K key) {
+  struct IndexEntry {
+    size_t size = 0;
+    int64_t last_access = 0;
+    std::string tag;
+  };
+
+  static constexpr const char* kIndexName = ".index";
+
+  // Access times are in microseconds, and strictly increasing within a
+  // process so that the eviction order is deterministic.
+  int64_t Now() {
+    int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+    last_access_ = std::max(now, last_access_ + 1);
+    return last_access_;
+  }
+
+  std::string GetName(const K& key) {
     std::stringstream ss;
     ss << key;
-    return cache_dir_ / ss.str();
+    return ss.str();
   }
 
-  bool Exists(std::string path) {
-    struct stat buffer;
-    return stat(path.c_str(), &buffer) == 0;
+  // Writes the serialized value unless another process already did, and
+  // returns the size of the stored value. Does not require lock_.
+  size_t WriteValue(const std::string& name, const TypePtr& obj) {
+    int64_t existing_size = storage_->Size(name);
+    if (existing_size >= 0) {
+      return existing_size;
+    }
+    std::string serialization = serialize_(obj);
+    storage_->Write(name, serialization);
+    return serialization.size();
+  }
+
+  void RecordWrite(const std::string& name, size_t size,
+                   const std::string& tag = "") {
+    IndexEntry& entry = index_[name];
+    storage_bytes_ += size;
+    storage_bytes_ -= entry.size;
+    entry.size = size;
+    entry.last_access = Now();
+    entry.tag = tag.empty() ? index_tag_ : tag;
+    index_dirty_ = true;
+    EvictStorage(name);
+  }
+
+  void Touch(const std::string& name) {
+    auto it = index_.find(name);
+    if (it != index_.end()) {
+      it->second.last_access = Now();
+      index_dirty_ = true;
+    }
+  }
+
+  // Removes the least recently used stored values, other than `keep`, until
+  // the storage budget is met. Values tracked in memory remain valid.
+  void EvictStorage(const std::string& keep) {
+    if (max_storage_bytes_ == 0 || readonly_storage_) {
+      return;
+    }
+    while (storage_bytes_ > max_storage_bytes_ && index_.size() > 1) {
+      auto victim = index_.end();
+      for (auto it = index_.begin(); it != index_.end(); ++it) {
+        if (it->first != keep &&
+            (victim == index_.end() ||
+             it->second.last_access < victim->second.last_access)) {
+          victim = it;
+        }
+      }
+      storage_->Remove(victim->first);
+      storage_bytes_ -= victim->second.size;
+      prefetched_.erase(victim->first);
+      index_.erase(victim);
+      index_dirty_ = true;
+      TORCH_LAZY_COUNTER("PersistentCacheEviction", 1);
+    }
+  }
+
+  // Loads the index written by previous runs, and reconciles it with the
+  // content of the storage, which may have been changed by processes sharing
+  // it.
+  void LoadIndex() {
+    std::unordered_map<std::string, IndexEntry> stored;
+    std::string index_content;
+    if (storage_->Read(kIndexName, &index_content)) {
+      std::istringstream in(index_content);
+      std::string name;
+      IndexEntry entry;
+      while (in >> name >> entry.size >> entry.last_access >> entry.tag) {
+        stored[name] = entry;
+      }
+    }
+    for (const auto& value : storage_->List()) {
+      IndexEntry& indexed = index_[value.first];
+      auto it = stored.find(value.first);
+      if (it != stored.end()) {
+        indexed = it->second;
+      } else {
+        indexed.last_access = Now();
+        indexed.tag = "-";
+      }
+      indexed.size = value.second;
+      storage_bytes_ += indexed.size;
+    }
+    index_dirty_ = index_.size() != stored.size();
+  }
+
+  void MaybeWriteIndex() {
+    if (!index_dirty_ || readonly_storage_) {
+      return;
+    }
+    std::stringstream out;
+    for (const auto& it : index_) {
+      out << it.first << " " << it.second.size << " " << it.second.last_access
+          << " " << it.second.tag << "\n";
+    }
+    try {
+      storage_->Write(kIndexName, out.str());
+    } catch (const std::exception&) {
+      // The index is only advisory, it is rebuilt from the storage content.
+      TORCH_LAZY_COUNTER("PersistentCacheIndexWriteFailure", 1);
+    }
+    index_dirty_ = false;
+  }
+
+  // Deserializes the most recently used values written in the same
+  // environment, up to the memory cache size. Called without lock_ held.
+  void Prefetch() {
+    TORCH_LAZY_TIMED("PersistentCachePrefetch");
+    std::vector<std::pair<int64_t, std::string>> candidates;
+    {
+      std::lock_guard<std::mutex> slock(lock_);
+      for (const auto& it : index_) {
+        if (it.second.tag == index_tag_) {
+          candidates.emplace_back(it.second.last_access, it.first);
+        }
+      }
+    }
+    std::sort(candidates.rbegin(), candidates.rend());
+    if (candidates.size() > max_memory_cache_size_) {
+      candidates.resize(max_memory_cache_size_);
+    }
+    for (const auto& candidate : candidates) {
+      std::string serialization;
+      if (!storage_->Read(candidate.second, &serialization)) {
+        continue;
+      }
+      TypePtr val = deserialize_(serialization);
+      if (val) {
+        std::lock_guard<std::mutex> slock(lock_);
+        prefetched_.emplace(candidate.second, std::move(val));
+      }
+    }
+  }
+
+  void WriterLoop() {
+    if (prefetch_pending_) {
+      Prefetch();
+      std::lock_guard<std::mutex> slock(lock_);
+      prefetch_pending_ = false;
+      flush_cv_.notify_all();
+    }
+    std::unique_lock<std::mutex> slock(lock_);
+    while (true) {
+      writer_cv_.wait(slock,
+                      [this]() { return stop_ || !write_queue_.empty(); });
+      if (write_queue_.empty()) {
+        break;
+      }
+      std::string name = std::move(write_queue_.front());
+      write_queue_.pop_front();
+      auto it = pending_writes_.find(name);
+      if (it != pending_writes_.end()) {
+        TypePtr obj = it->second;
+        ++writes_in_flight_;
+        slock.unlock();
+        size_t size = 0;
+        bool written = false;
+        try {
+          TORCH_LAZY_TIMED("PersistentCacheWrite");
+          size = WriteValue(name, obj);
+          written = true;
+        } catch (const std::exception&) {
+          TORCH_LAZY_COUNTER("PersistentCacheWriteFailure", 1);
+        }
+        slock.lock();
+        --writes_in_flight_;
+        it = pending_writes_.find(name);
+        if (it == pending_writes_.end()) {
+          // Erased or cleared while being written.
+          storage_->Remove(name);
+        } else if (it->second == obj) {
+          pending_writes_.erase(it);
+          if (written) {
+            RecordWrite(name, size);
+          }
+        }
+      }
+      if (write_queue_.empty()) {
+        MaybeWriteIndex();
+        flush_cv_.notify_all();
+      }
+    }
   }
 
   bool EraseImpl(const K& key) {
     memory_cache_.Erase(key);
-    return !readonly_storage_ && std::filesystem::remove(GetPath(key));
+    std::string name = GetName(key);
+    prefetched_.erase(name);
+    if (readonly_storage_) {
+      return false;
+    }
+    bool erased = pending_writes_.erase(name) > 0;
+    auto it = index_.find(name);
+    if (it != index_.end()) {
+      storage_bytes_ -= it->second.size;
+      index_.erase(it);
+      index_dirty_ = true;
+    }
+    return storage_->Remove(name) || erased;
   }
 
   Cache<K, T, H, E> memory_cache_;
   std::function<std::string(const TypePtr&)> serialize_;
   std::function<TypePtr(const std::string&)> deserialize_;
-  std::filesystem::path cache_dir_;
+  std::unique_ptr<CacheStorage> storage_;
   std::mutex lock_;
   // readonly_storage_ controls whether the cache will treat the persistence
   // layer as readonly. When set, operations which mutate the cache, such as
   // Erase and Add, are not written to disk, but they are still applied to the
   // in-memory cache.
   const bool readonly_storage_;
+  const size_t max_memory_cache_size_;
+  // Zero means the storage is not bounded.
+  const size_t max_storage_bytes_;
+  const std::string index_tag_;
+  std::unordered_map<std::string, IndexEntry> index_;
+  size_t storage_bytes_ = 0;
+  int64_t last_access_ = 0;
+  bool index_dirty_ = false;
+  // Values loaded by Prefetch(), moved to memory_cache_ on first use.
+  std::unordered_map<std::string, TypePtr> prefetched_;
+  // Values waiting for the writer_ thread, keyed by file name.
+  std::unordered_map<std::string, TypePtr> pending_writes_;
+  std::deque<std::string> write_queue_;
+  size_t writes_in_flight_ = 0;
+  bool prefetch_pending_ = false;
+  bool stop_ = false;
+  std::condition_variable writer_cv_;
+  std::condition_variable flush_cv_;
+  std::thread writer_;
 };
 
 }  // namespace util
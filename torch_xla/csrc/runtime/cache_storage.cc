@@ -0,0 +1,96 @@
+#include "torch_xla/csrc/runtime/cache_storage.h"
+
+#include "absl/strings/match.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace util {
+
+FileSystemCacheStorage::FileSystemCacheStorage(std::string dir)
+    : dir_(std::move(dir)) {
+  tsl::Env* env = tsl::Env::Default();
+  if (!env->IsDirectory(dir_).ok()) {
+    XLA_CHECK_OK(env->RecursivelyCreateDir(dir_));
+  }
+}
+
+int64_t FileSystemCacheStorage::Size(const std::string& name) {
+  uint64_t size = 0;
+  if (!tsl::Env::Default()->GetFileSize(GetPath(name), &size).ok()) {
+    return -1;
+  }
+  return static_cast<int64_t>(size);
+}
+
+bool FileSystemCacheStorage::Read(const std::string& name,
+                                  std::string* value) {
+  return tsl::ReadFileToString(tsl::Env::Default(), GetPath(name), value).ok();
+}
+
+void FileSystemCacheStorage::Write(const std::string& name,
+                                   const std::string& value) {
+  tsl::Env* env = tsl::Env::Default();
+  std::string path = GetPath(name);
+  bool has_atomic_move = false;
+  if (!env->HasAtomicMove(path, &has_atomic_move).ok() || !has_atomic_move) {
+    // Object stores publish an object only once fully uploaded, and do not
+    // support atomic renames.
+    XLA_CHECK_OK(tsl::WriteStringToFile(env, path, value));
+    return;
+  }
+  // Hidden from List(), and unique across the processes sharing the storage.
+  std::string tmp_name = "." + name;
+  XLA_CHECK(env->CreateUniqueFileName(&tmp_name, ".tmp"));
+  std::string tmp_path = GetPath(tmp_name);
+  XLA_CHECK_OK(tsl::WriteStringToFile(env, tmp_path, value));
+  XLA_CHECK_OK(env->RenameFile(tmp_path, path));
+}
+
+bool FileSystemCacheStorage::Remove(const std::string& name) {
+  return tsl::Env::Default()->DeleteFile(GetPath(name)).ok();
+}
+
+void FileSystemCacheStorage::RemoveAll() {
+  tsl::Env* env = tsl::Env::Default();
+  int64_t undeleted_files = 0;
+  int64_t undeleted_dirs = 0;
+  env->DeleteRecursively(dir_, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  XLA_CHECK_OK(env->RecursivelyCreateDir(dir_));
+}
+
+std::vector<std::pair<std::string, int64_t>> FileSystemCacheStorage::List() {
+  std::vector<std::pair<std::string, int64_t>> values;
+  std::vector<std::string> children;
+  if (!tsl::Env::Default()->GetChildren(dir_, &children).ok()) {
+    return values;
+  }
+  for (const std::string& name : children) {
+    if (name.empty() || name[0] == '.') {
+      continue;
+    }
+    int64_t size = Size(name);
+    if (size >= 0) {
+      values.emplace_back(name, size);
+    }
+  }
+  return values;
+}
+
+std::string FileSystemCacheStorage::GetPath(const std::string& name) const {
+  return tsl::io::JoinPath(dir_, name);
+}
+
+std::unique_ptr<CacheStorage> CreateCacheStorage(const std::string& dir) {
+  if (absl::StrContains(dir, "://")) {
+    return std::make_unique<FileSystemCacheStorage>(dir);
+  }
+  return std::make_unique<LocalCacheStorage>(dir);
+}
+
+}  // namespace util
+}  // namespace runtime
+}  // namespace torch_xla
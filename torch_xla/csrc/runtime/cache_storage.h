@@ -0,0 +1,48 @@
+#ifndef XLA_CLIENT_CACHE_STORAGE_H_
+#define XLA_CLIENT_CACHE_STORAGE_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "torch_xla/csrc/runtime/cache.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace util {
+
+// Stores the values through the TSL file system layer, so any registered
+// scheme (like gs://) can back a cache shared by all the hosts of a job.
+class FileSystemCacheStorage : public CacheStorage {
+ public:
+  explicit FileSystemCacheStorage(std::string dir);
+
+  int64_t Size(const std::string& name) override;
+
+  bool Read(const std::string& name, std::string* value) override;
+
+  void Write(const std::string& name, const std::string& value) override;
+
+  bool Remove(const std::string& name) override;
+
+  void RemoveAll() override;
+
+  std::vector<std::pair<std::string, int64_t>> List() override;
+
+ private:
+  std::string GetPath(const std::string& name) const;
+
+  std::string dir_;
+};
+
+// Creates the storage for the cache directory `dir`. Paths with a scheme
+// (like gs://bucket/dir) go through the TSL file system layer, while local
+// paths are accessed directly.
+std::unique_ptr<CacheStorage> CreateCacheStorage(const std::string& dir);
+
+}  // namespace util
+}  // namespace runtime
+}  // namespace torch_xla
+
+#endif  // XLA_CLIENT_CACHE_STORAGE_H_
@@ -38,6 +38,92 @@ TEST(UtilTest, XlaUtilCacheTest) {
   EXPECT_EQ(ptr, nullptr);
 }
 
+TEST(UtilTest, XlaUtilShardedCacheTest) {
+  static const int kMaxSize = 64;
+  static const int kNumShards = 4;
+  ShardedCache<int, std::string> cache(kMaxSize, kNumShards);
+
+  auto ptr = cache.Add(0, std::make_shared<std::string>("0"));
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(*ptr, "0");
+  // Adding an existing key keeps the cached object.
+  ptr = cache.Add(0, std::make_shared<std::string>("ZERO"));
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(*ptr, "0");
+
+  // Objects are distributed across shards, so each of them may evict before
+  // kMaxSize objects are live, but never holds more than kMaxSize in total.
+  int live = 0;
+  for (int i = 0; i < 2 * kMaxSize; ++i) {
+    std::string istr = std::to_string(i);
+    cache.Add(i, std::make_shared<std::string>(istr));
+    ptr = cache.Get(i);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(*ptr, istr);
+  }
+  for (int i = 0; i < 2 * kMaxSize; ++i) {
+    if (cache.Get(i) != nullptr) {
+      ++live;
+    }
+  }
+  EXPECT_GT(live, 0);
+  EXPECT_LE(live, kMaxSize);
+
+  ptr = cache.Add(-1, std::make_shared<std::string>("MINUS"));
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(*ptr, "MINUS");
+  EXPECT_TRUE(cache.Erase(-1));
+  EXPECT_FALSE(cache.Erase(-1));
+  EXPECT_EQ(cache.Get(-1), nullptr);
+
+  cache.Clear();
+  for (int i = 0; i < 2 * kMaxSize; ++i) {
+    EXPECT_EQ(cache.Get(i), nullptr);
+  }
+}
+
+TEST(UtilTest, XlaUtilShardedCacheSecondChanceTest) {
+  // With a single shard, a referenced object survives the next eviction.
+  ShardedCache<int, std::string> cache(/*max_size=*/2, /*num_shards=*/1);
+  cache.Add(0, std::make_shared<std::string>("0"));
+  cache.Add(1, std::make_shared<std::string>("1"));
+  ASSERT_NE(cache.Get(0), nullptr);
+  cache.Add(2, std::make_shared<std::string>("2"));
+  EXPECT_NE(cache.Get(0), nullptr);
+  EXPECT_EQ(cache.Get(1), nullptr);
+  EXPECT_NE(cache.Get(2), nullptr);
+}
+
+TEST(UtilTest, XlaUtilCacheShrinkTest) {
+  Cache<int, std::string> cache(/*max_size=*/4);
+  for (int i = 0; i < 4; ++i) {
+    cache.Add(i, std::make_shared<std::string>(std::to_string(i)));
+  }
+  ASSERT_NE(cache.Get(0), nullptr);
+  EXPECT_EQ(cache.Shrink(2), 2);
+  EXPECT_NE(cache.Get(0), nullptr);
+  EXPECT_EQ(cache.Get(1), nullptr);
+  EXPECT_EQ(cache.Get(2), nullptr);
+  EXPECT_NE(cache.Get(3), nullptr);
+  EXPECT_EQ(cache.Shrink(4), 2);
+  EXPECT_EQ(cache.Get(0), nullptr);
+
+  ShardedCache<int, std::string> sharded_cache(/*max_size=*/8,
+                                               /*num_shards=*/2);
+  for (int i = 0; i < 4; ++i) {
+    sharded_cache.Add(i, std::make_shared<std::string>(std::to_string(i)));
+  }
+  EXPECT_EQ(sharded_cache.Shrink(3), 3);
+  EXPECT_EQ(sharded_cache.Shrink(3), 1);
+  // The freed slots are reused, each shard holding up to four objects.
+  for (int i = 0; i < 4; ++i) {
+    sharded_cache.Add(i, std::make_shared<std::string>(std::to_string(i)));
+  }
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NE(sharded_cache.Get(i), nullptr);
+  }
+}
+
 TEST(UtilTest, XlaUtilPersistentCacheTest) {
   static const int kMaxSize = 64;
   auto serialize_fn = [](std::shared_ptr<std::string> value) -> std::string {
@@ -155,6 +241,76 @@ TEST(UtilTest, XlaUtilPersistentCacheTest) {
   unlink(tmpdir);
 }
 
+TEST(UtilTest, XlaUtilPersistentCacheStorageTest) {
+  static const int kMaxSize = 64;
+  static const size_t kValueSize = 8;
+  auto serialize_fn = [](std::shared_ptr<std::string> value) -> std::string {
+    return *value;
+  };
+  auto deserialize_fn = [](std::string value) -> std::shared_ptr<std::string> {
+    return std::make_shared<std::string>(value);
+  };
+  auto make_value = [](int i) {
+    std::string istr = std::to_string(i);
+    return std::make_shared<std::string>(
+        std::string(kValueSize - istr.size(), '0') + istr);
+  };
+  char format[] = "/tmp/tmp.XXXXXX";
+  char* tmpdir = mkdtemp(format);
+  ASSERT_NE(tmpdir, nullptr);
+
+  // Values are written in background, and only the last four fit within the
+  // storage budget.
+  auto cache = std::make_unique<PersistentCache<int, std::string>>(
+      kMaxSize, std::string(tmpdir), /*readonly=*/false, serialize_fn,
+      deserialize_fn, /*max_storage_bytes=*/4 * kValueSize,
+      /*async_writes=*/true, /*index_tag=*/"env0");
+  for (int i = 0; i < 8; ++i) {
+    auto ptr = cache->Add(i, make_value(i));
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(*ptr, *make_value(i));
+  }
+  cache->Flush();
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(std::filesystem::exists(std::string(tmpdir) + "/" +
+                                      std::to_string(i)),
+              i >= 4);
+  }
+  // Evicted values are still served from memory.
+  for (int i = 0; i < 8; ++i) {
+    auto ptr = cache->Get(i);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(*ptr, *make_value(i));
+  }
+
+  // A new cache picks up the index, and prefetches the values stored with the
+  // same environment tag.
+  cache.reset();
+  cache = std::make_unique<PersistentCache<int, std::string>>(
+      kMaxSize, std::string(tmpdir), /*readonly=*/false, serialize_fn,
+      deserialize_fn, /*max_storage_bytes=*/4 * kValueSize,
+      /*async_writes=*/false, /*index_tag=*/"env0", /*prefetch=*/true);
+  for (int i = 0; i < 8; ++i) {
+    auto ptr = cache->Get(i);
+    if (i < 4) {
+      EXPECT_EQ(ptr, nullptr);
+    } else {
+      ASSERT_NE(ptr, nullptr);
+      EXPECT_EQ(*ptr, *make_value(i));
+    }
+  }
+
+  // Adding a new value evicts the least recently used one.
+  ASSERT_NE(cache->Get(4), nullptr);
+  cache->Add(8, make_value(8));
+  EXPECT_TRUE(std::filesystem::exists(std::string(tmpdir) + "/4"));
+  EXPECT_FALSE(std::filesystem::exists(std::string(tmpdir) + "/5"));
+
+  cache->Clear();
+  cache.reset();
+  std::filesystem::remove_all(tmpdir);
+}
+
 }  // namespace util
 }  // namespace runtime
 }  // namespace torch_xla
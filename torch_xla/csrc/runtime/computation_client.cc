@@ -1,6 +1,7 @@
 #include "torch_xla/csrc/runtime/computation_client.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <fstream>
 #include <map>
@@ -18,6 +19,11 @@
 
 namespace torch_xla {
 namespace runtime {
+namespace {
+
+std::atomic<int64_t> current_step_id(0);
+
+}  // namespace
 
 std::shared_ptr<ComputationClient::Computation> ComputationClient::Compile(
     xla::XlaComputation computation, std::string compilation_device,
@@ -47,6 +53,14 @@ std::vector<std::string> ComputationClient::GetCompilationDevices(
   return compilation_devices;
 }
 
+int64_t ComputationClient::GetStepId() {
+  return current_step_id.load(std::memory_order_relaxed);
+}
+
+void ComputationClient::SetStepId(int64_t step_id) {
+  current_step_id.store(step_id, std::memory_order_relaxed);
+}
+
 int64_t ComputationClient::GetDeviceOrdinal(const std::string& device) {
   auto pos = device.rfind(':');
   XLA_CHECK_NE(pos, std::string::npos) << device;
@@ -10,9 +10,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <variant>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -20,10 +22,14 @@
 #include "absl/types/span.h"
 #include "torch_xla/csrc/device.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/execution_dispatcher.h"
+#include "torch_xla/csrc/runtime/host_buffer_pool.h"
+#include "torch_xla/csrc/runtime/memory_kind.h"
 #include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/tensor_source.h"
 #include "torch_xla/csrc/runtime/types.h"
 #include "torch_xla/csrc/runtime/util.h"
+#include "torch_xla/csrc/runtime/xla_util.h"
 #include "xla/client/xla_computation.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/literal_util.h"
@@ -46,6 +52,14 @@ class XlaCoordinator;
 // ComputationClient.
 struct ClientExecuteOptions {
   bool explode_tuple{true};
+  // The dispatch lane of the execution, see ExecutionDispatcher.
+  ExecutionLane lane{ExecutionLane::kDefault};
+  // Attached to the traces of the execution: the hash of the graph it runs and
+  // the step it was scheduled in.
+  std::string graph_hash;
+  int64_t step_id{-1};
+  // The tenant charged for the outputs, see tenant.h.
+  std::string tenant;
 };
 
 class ComputationClient {
@@ -73,6 +87,12 @@ class ComputationClient {
       should_donate_buffer_ = should_donate_buffer;
     }
 
+    // The memory the data is placed in, as requested for a placeholder before
+    // it gets its buffer.
+    virtual MemoryKind memory_kind() const { return memory_kind_; }
+
+    void set_memory_kind(MemoryKind memory_kind) { memory_kind_ = memory_kind; }
+
     virtual std::string ToString() const = 0;
 
     virtual bool HasSharding() const = 0;
@@ -83,10 +103,29 @@ class ComputationClient {
     std::string xla_device_;
     xla::Shape xla_shape_;
     bool should_donate_buffer_;
+    MemoryKind memory_kind_ = MemoryKind::kDevice;
   };
 
   using DataPtr = std::shared_ptr<Data>;
 
+  // The memory a compiled executable needs on its device, as estimated by the
+  // compiler. The arguments and outputs aliasing each other (donated buffers)
+  // are counted in both `argument_bytes` and `output_bytes`, and once in
+  // `alias_bytes`.
+  struct CompiledMemoryStats {
+    int64_t argument_bytes = 0;
+    int64_t output_bytes = 0;
+    int64_t alias_bytes = 0;
+    int64_t temp_bytes = 0;
+    int64_t generated_code_bytes = 0;
+
+    // The device memory needed by an execution on top of the memory already
+    // holding its arguments.
+    int64_t ExecutionBytes() const {
+      return output_bytes - alias_bytes + temp_bytes + generated_code_bytes;
+    }
+  };
+
   // There are 4 different Computation class being used here
   // 1. torch::lazy::Computation represent a general computation from LTC
   // perspective.
@@ -197,6 +236,27 @@ class ComputationClient {
       XLA_ERROR() << "Unimplemented";
     }
 
+    // The memory stats of the compiled executable, if the runtime reports
+    // them.
+    virtual std::optional<CompiledMemoryStats> GetCompiledMemoryStats() const {
+      return std::nullopt;
+    }
+
+    // The collectives of the compiled executable. Empty if it has none, or if
+    // the runtime does not report its HLO.
+    virtual const util::CollectiveStats& GetCollectiveStats() const {
+      static const util::CollectiveStats* empty_stats =
+          new util::CollectiveStats();
+      return *empty_stats;
+    }
+
+    // The costs of an execution estimated by the compiler, by property name
+    // (eg. "flops" or "bytes accessed"). Empty if the runtime does not report
+    // them.
+    virtual std::map<std::string, double> GetCostAnalysis() const {
+      return {};
+    }
+
    private:
     xla::XlaComputation computation_;
     xla::ProgramShape program_shape_;
@@ -209,6 +269,11 @@ class ComputationClient {
 
   using ComputationPtr = std::shared_ptr<Computation>;
 
+  // XLA compile options by the name of their debug option or backend flag,
+  // like xla_backend_optimization_level, passed to the client as overrides.
+  using CompileOptionValue = std::variant<bool, int64_t, std::string>;
+  using CompileOptionOverrides = std::map<std::string, CompileOptionValue>;
+
   // TODO(wcromar): Should CompileInstance still exist? Should it be a subclass
   // of torch::lazy::Computation?
   struct CompileInstance {
@@ -245,24 +310,94 @@ class ComputationClient {
     bool use_auto_spmd_partitioning;
     std::vector<int64_t> auto_spmd_mesh_shape;
     std::vector<int64_t> auto_spmd_mesh_ids;
+    // Overrides the XLA backend optimization level when non negative. A low
+    // level trades executable performance for compilation time.
+    int64_t backend_optimization_level = -1;
+    // The intra-op parallelism of the executable on the CPU client, the
+    // default of XLA_CPU_INTRA_OP_THREADS when zero.
+    int64_t intra_op_threads = 0;
+    // The memory kinds of the parameters and of the outputs, all in device
+    // memory when empty. The executable then reads and writes the host placed
+    // ones from and to the host memory.
+    std::vector<MemoryKind> argument_memory_kinds;
+    std::vector<MemoryKind> output_memory_kinds;
+    // The parameters whose device layouts the compiler chooses, along with
+    // the ones of the outputs. The executable then relayouts the arguments
+    // held in other layouts once, in place.
+    std::vector<size_t> auto_layout_parameters;
+    // The StableHLO portable artifact `computation` was converted from, if
+    // any. With XLA_STABLEHLO_COMPILE it is compiled as is, rather than
+    // converting the HLO back to StableHLO.
+    std::string stablehlo_bytecode;
+    // The compile options of this executable overriding the ones of the
+    // client and of XLA_FLAGS.
+    CompileOptionOverrides option_overrides;
   };
 
   struct ExecuteComputationOptions : public ClientExecuteOptions {};
 
   struct ExecuteReplicatedOptions : public ClientExecuteOptions {};
 
+  struct ExecuteChainedOptions : public ClientExecuteOptions {};
+
+  // An argument of an ExecuteChained computation: either device data, or the
+  // output `output` of the earlier computation `computation` of the chain.
+  struct ChainedArgument {
+    ChainedArgument(DataPtr data) : data(std::move(data)) {}
+    ChainedArgument(int64_t computation, int64_t output)
+        : computation(computation), output(output) {}
+
+    DataPtr data;
+    int64_t computation = -1;
+    int64_t output = -1;
+  };
+
+  struct ChainedComputation {
+    ComputationPtr computation;
+    std::vector<ChainedArgument> arguments;
+  };
+
   struct MemoryInfo {
     int64_t bytes_used = 0;
     int64_t bytes_limit = 0;
+    // The bytes of the live buffers of the device placed in pinned host
+    // memory, which are not part of `bytes_used`.
+    int64_t pinned_host_bytes_used = 0;
+    // The highest `bytes_used` since the client was created.
+    int64_t peak_bytes_used = 0;
+    // The largest allocation which can currently succeed, zero when the
+    // allocator does not report it.
+    int64_t largest_free_block_bytes = 0;
+    // The fraction of the free memory which is not part of the largest free
+    // block, zero when unknown. High values mean that large allocations can
+    // fail even though enough memory is free overall.
+    double fragmentation = 0.0;
+  };
+
+  // Statistics of the inflight operations (transfers and executions) of a
+  // device.
+  struct OperationStats {
+    int64_t inflight = 0;
+    int64_t high_water_mark = 0;
+    // Time spent waiting for the XLA_MAX_INFLIGHT_DEVICE_OPERATIONS bound.
+    int64_t blocked_ns = 0;
+    int64_t rejected = 0;
   };
 
   virtual ~ComputationClient() {}
 
+  // The name of the trailing parameters of a computation which take the
+  // output buffers of its previous executions, supplied by the client on
+  // execution rather than passed as arguments. They are buffer donors, which
+  // the compiler aliases to the outputs of the same shapes.
+  static constexpr const char* kRecycledOutputParameter = "recycled_output";
+
   // Creates a Data object with no actual device handle in it. The device handle
   // will be populated in an asynchrounous fashion.
   virtual DataPtr CreateDataPlaceholder(
       std::string device, xla::Shape shape,
-      std::optional<xla::OpSharding> sharding = std::nullopt) = 0;
+      std::optional<xla::OpSharding> sharding = std::nullopt,
+      MemoryKind memory_kind = MemoryKind::kDevice) = 0;
 
   // Returns data shards. We expect this to be called on PjRtShardedData to
   // retrieve the shards. If other data type is passed, it returns the input
@@ -303,6 +438,10 @@ class ComputationClient {
   // Copies `data->buffer` to `dst` device buffer.
   virtual DataPtr CopyToDevice(DataPtr data, std::string dst) = 0;
 
+  // Copies `data` to the `memory_kind` memory of its device. Returns `data`
+  // itself if it is already placed there.
+  virtual DataPtr CopyToMemoryKind(DataPtr data, MemoryKind memory_kind) = 0;
+
   // Reads the tensor literal values stored at TPU server sites, behind the
   // supplied handles.
   // Note: `TransferFromDevice` call will block until the `DataPtrs` are ready
@@ -311,6 +450,30 @@ class ComputationClient {
   virtual std::vector<xla::Literal> TransferFromDevice(
       absl::Span<const DataPtr> handles) = 0;
 
+  // Returns the literal the value of the i-th handle is to be read into. The
+  // literal must have the given host shape, layout included.
+  using TransferDestinationFn =
+      std::function<xla::MutableLiteralBase*(size_t, const xla::Shape&)>;
+
+  // Streaming version of `TransferFromDevice`, which lets the caller provide
+  // the host memory the values are read into. The returned futures become
+  // ready independently, in whatever order the transfers complete, and each
+  // destination literal must stay alive until its future is ready. Same as
+  // `TransferFromDevice`, do not wait on the futures while holding the GIL.
+  virtual std::vector<xla::PjRtFuture<>> TransferFromDeviceAsync(
+      absl::Span<const DataPtr> handles,
+      const TransferDestinationFn& destination_fn) = 0;
+
+  // Returns futures which become ready once the device buffers backing
+  // `handles` have been computed. Placeholders not bound to device buffers
+  // yet contribute no future.
+  virtual std::vector<xla::PjRtFuture<>> GetReadyFutures(
+      absl::Span<const DataPtr> handles) = 0;
+
+  // Returns the pool of host buffers used to stage transfers to and from the
+  // devices, or nullptr if staging buffers are disabled.
+  virtual HostBufferPool* GetHostBufferPool() = 0;
+
   virtual std::uintptr_t UnsafeBufferPointer(const DataPtr handle) = 0;
 
   virtual std::shared_ptr<xla::PjRtBuffer> GetPjRtBuffer(
@@ -332,6 +495,14 @@ class ComputationClient {
   // Returns a hash of the current compilation environment.
   virtual torch::lazy::hash_t HashCompilationEnv() = 0;
 
+  // Returns the values hashed by HashCompilationEnv(), by component, to
+  // diagnose the persistent cache misses due to a different environment.
+  virtual std::map<std::string, std::string> GetCompilationEnvComponents() = 0;
+
+  // Has HashCompilationEnv() read the environment again on its next use,
+  // after a change of the environment variables it covers.
+  virtual void InvalidateCompilationEnvHash() = 0;
+
   // Executes computation with arguments and returns the result.
   // The passed device must match the common device of the arguments Data.
   // If options.explode_tuple is true, the output tuple will be decomposed into
@@ -352,6 +523,16 @@ class ComputationClient {
       absl::Span<const std::string> devices,
       const ExecuteReplicatedOptions& options) = 0;
 
+  // Executes the computations in order on `device`, as a single dispatch: the
+  // arguments of a computation can be outputs of the earlier ones, which never
+  // leave the device, and the whole chain completes as a single operation.
+  // Returns the outputs of every computation, exploded according to
+  // options.explode_tuple.
+  virtual std::vector<std::vector<DataPtr>> ExecuteChained(
+      absl::Span<const ChainedComputation> computations,
+      const std::string& device,
+      const ExecuteChainedOptions& options = ExecuteChainedOptions{}) = 0;
+
   virtual std::string GetDefaultDevice() const = 0;
 
   virtual torch_xla::DeviceType GetDeviceType() const = 0;
@@ -389,6 +570,8 @@ class ComputationClient {
 
   virtual MemoryInfo GetMemoryInfo(const std::string& device) = 0;
 
+  virtual OperationStats GetOperationStats(const std::string& device) = 0;
+
   // Block until pass in devices' async operation are finished. If empty, all
   // the local devices will be waited for.
   virtual void WaitDeviceOps(absl::Span<const std::string> devices) = 0;
@@ -422,6 +605,11 @@ class ComputationClient {
   // after the last ':' character of the device string.
   static int64_t GetDeviceOrdinal(const std::string& device);
 
+  // The id of the current step, counted by the step markers, which the
+  // transfers attach to their traces.
+  static int64_t GetStepId();
+  static void SetStepId(int64_t step_id);
+
  protected:
   static constexpr auto spmd_device_str = "SPMD:0";
 
@@ -15,6 +15,17 @@
 #define XLA_CHECK_LT(a, b) TF_CHECK_LT(a, b) << "\n" << tsl::CurrentStackTrace()
 #define XLA_CHECK_GT(a, b) TF_CHECK_GT(a, b) << "\n" << tsl::CurrentStackTrace()
 
+// The checks of the execution hot paths, repeated per argument or device,
+// whose conditions are not evaluated in the release hot path builds
+// (XLA_RELEASE_HOT_PATH).
+#ifdef XLA_RELEASE_HOT_PATH
+#define XLA_HOT_CHECK(c) while (false) XLA_CHECK(c)
+#define XLA_HOT_CHECK_EQ(a, b) while (false) XLA_CHECK_EQ(a, b)
+#else
+#define XLA_HOT_CHECK(c) XLA_CHECK(c)
+#define XLA_HOT_CHECK_EQ(a, b) XLA_CHECK_EQ(a, b)
+#endif
+
 template <typename T>
 T ConsumeValue(xla::StatusOr<T>&& status) {
   XLA_CHECK_OK(status.status());
@@ -4,6 +4,8 @@
 #include <sstream>
 #include <unordered_set>
 
+#include "absl/strings/str_join.h"
+
 #include "torch_xla/csrc/runtime/sys_util.h"
 
 namespace torch_xla {
@@ -38,7 +40,8 @@ static const std::unordered_set<std::string> FlagsToExclude = {
     "--xla_tpu_sdc_checker_enable_sdc_event_callbacks",
 };
 
-torch::lazy::hash_t hash_xla_flags(std::string env_var_name) {
+torch::lazy::hash_t hash_xla_flags(std::string env_var_name,
+                                   EnvComponents* components) {
   std::stringstream xla_flag_env(
       sys_util::GetEnvString(env_var_name.c_str(), ""));
   std::string current_flag;
@@ -68,15 +71,20 @@ torch::lazy::hash_t hash_xla_flags(std::string env_var_name) {
     hash =
         torch::lazy::HashCombine(hash, torch::lazy::StringHash(flag.c_str()));
   }
+  if (components != nullptr) {
+    (*components)[env_var_name] = absl::StrJoin(xla_flags, " ");
+  }
   return hash;
 }
 
 torch::lazy::hash_t hash_xla_env_vars(std::vector<std::string> flag_vars,
-                                      std::vector<std::string> raw_vars) {
+                                      std::vector<std::string> raw_vars,
+                                      EnvComponents* components) {
   torch::lazy::hash_t hash;
   // Parse the flag_vars for XLA flags.
   for (auto& env_var_name : flag_vars) {
-    hash = torch::lazy::HashCombine(hash, hash_xla_flags(env_var_name));
+    hash = torch::lazy::HashCombine(hash,
+                                    hash_xla_flags(env_var_name, components));
   }
 
   // Include the raw flag value for raw_vars
@@ -84,18 +92,46 @@ torch::lazy::hash_t hash_xla_env_vars(std::vector<std::string> flag_vars,
     std::string raw_val = sys_util::GetEnvString(env_var_name.c_str(), "");
     hash = torch::lazy::HashCombine(hash,
                                     torch::lazy::StringHash(raw_val.c_str()));
+    if (components != nullptr) {
+      (*components)[env_var_name] = raw_val;
+    }
   }
   return hash;
 }
 }  // namespace
 
-torch::lazy::hash_t HashXlaEnvVars() {
+torch::lazy::hash_t HashXlaEnvVars(EnvComponents* components) {
   // Both XLA_FLAGS and LIBTPU_INIT_ARGS contain XLA flags which impact
   // the compilation result.
   static std::vector<std::string> flag_vars = {"XLA_FLAGS", "LIBTPU_INIT_ARGS"};
   static std::vector<std::string> raw_vars = {"TPU_MEGACORE", "XLA_HLO_DEBUG",
                                               "XLA_IR_DEBUG"};
-  return hash_xla_env_vars(flag_vars, raw_vars);
+  return hash_xla_env_vars(flag_vars, raw_vars, components);
+}
+
+torch::lazy::hash_t CachedEnvHash::Get(const ComputeFn& compute) {
+  return GetEntry(compute)->hash;
+}
+
+EnvComponents CachedEnvHash::GetComponents(const ComputeFn& compute) {
+  return GetEntry(compute)->components;
+}
+
+void CachedEnvHash::Invalidate() {
+  std::lock_guard<std::mutex> lock(lock_);
+  entry_ = nullptr;
+}
+
+std::shared_ptr<const CachedEnvHash::Entry> CachedEnvHash::GetEntry(
+    const ComputeFn& compute) {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (entry_ == nullptr) {
+    auto entry = std::make_shared<Entry>();
+    entry->hash = compute(&entry->components);
+    entry->components["hash"] = torch::lazy::HashToString(entry->hash);
+    entry_ = std::move(entry);
+  }
+  return entry_;
 }
 
 }  // namespace hash
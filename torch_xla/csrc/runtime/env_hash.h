@@ -1,14 +1,50 @@
 #include <torch/csrc/lazy/core/hash.h>
 
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
 namespace torch_xla {
 namespace runtime {
 namespace hash {
 
-// Take a hash of XLA flags which impact the compilation result.
+// The values hashed into a compilation environment hash, by component.
+using EnvComponents = std::map<std::string, std::string>;
+
+// Take a hash of XLA flags which impact the compilation result. The values
+// hashed, the flags filtered and sorted, are added to `components` if given.
 // TODO(jonbolin): We should move away from manually hashing the env vars and
 // instead hash the compilation environment directly when the functionality is
 // supported in the runtime.
-torch::lazy::hash_t HashXlaEnvVars();
+torch::lazy::hash_t HashXlaEnvVars(EnvComponents* components = nullptr);
+
+// A compilation environment hash along with its components, computed on first
+// use and then again only after Invalidate(), as it is part of the hash of
+// every graph synced.
+class CachedEnvHash {
+ public:
+  using ComputeFn = std::function<torch::lazy::hash_t(EnvComponents*)>;
+
+  torch::lazy::hash_t Get(const ComputeFn& compute);
+
+  EnvComponents GetComponents(const ComputeFn& compute);
+
+  // Drops the hash, for the next use to read the environment again.
+  void Invalidate();
+
+ private:
+  struct Entry {
+    torch::lazy::hash_t hash;
+    EnvComponents components;
+  };
+
+  std::shared_ptr<const Entry> GetEntry(const ComputeFn& compute);
+
+  std::mutex lock_;
+  std::shared_ptr<const Entry> entry_;
+};
 
 }  // namespace hash
 }  // namespace runtime
@@ -47,6 +47,45 @@ TEST(HashTest, CompilationEnvHashTest) {
   EXPECT_TRUE(base_hash != HashXlaEnvVars());
 }
 
+TEST(HashTest, CompilationEnvComponentsTest) {
+  setenv("XLA_FLAGS", "--xla_foo_bar=1 --xla_dump_to=/foo/bar --xla_a=0",
+         /*overwrite=*/true);
+  setenv("TPU_MEGACORE", "megacore", /*overwrite=*/true);
+  EnvComponents components;
+  torch::lazy::hash_t hash = HashXlaEnvVars(&components);
+  EXPECT_TRUE(hash == HashXlaEnvVars());
+  // The flags are filtered and sorted as hashed.
+  EXPECT_EQ(components["XLA_FLAGS"], "--xla_a=0 --xla_foo_bar=1");
+  EXPECT_EQ(components["TPU_MEGACORE"], "megacore");
+  EXPECT_EQ(components.count("LIBTPU_INIT_ARGS"), 1);
+}
+
+TEST(HashTest, CachedEnvHashTest) {
+  int computed = 0;
+  CachedEnvHash::ComputeFn compute = [&](EnvComponents* components) {
+    computed += 1;
+    return HashXlaEnvVars(components);
+  };
+  setenv("TPU_MEGACORE", "megacore", /*overwrite=*/true);
+  CachedEnvHash cached;
+  torch::lazy::hash_t hash = cached.Get(compute);
+  EXPECT_TRUE(hash == cached.Get(compute));
+  EXPECT_EQ(computed, 1);
+
+  // The hash is only computed again once invalidated.
+  setenv("TPU_MEGACORE", "other", /*overwrite=*/true);
+  EXPECT_TRUE(hash == cached.Get(compute));
+  cached.Invalidate();
+  torch::lazy::hash_t new_hash = cached.Get(compute);
+  EXPECT_TRUE(hash != new_hash);
+  EXPECT_EQ(computed, 2);
+
+  EnvComponents components = cached.GetComponents(compute);
+  EXPECT_EQ(components["TPU_MEGACORE"], "other");
+  EXPECT_EQ(components["hash"], torch::lazy::HashToString(new_hash));
+  EXPECT_EQ(computed, 2);
+}
+
 }  // namespace hash
 }  // namespace runtime
 }  // namespace torch_xla
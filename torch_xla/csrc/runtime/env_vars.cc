@@ -30,6 +30,16 @@ const char* const kEnvDistSvcMaxMissingHeartbeats =
     "DIST_SERVICE_MAX_MISSING_HEARTBEATS";
 const char* const kEnvDistSvcShutdownTimeoutInMin =
     "DIST_SERVICE_SHUTDOWN_TIMEOUT_IN_MIN";
+const char* const kEnvCompileParallelism = "XLA_COMPILE_PARALLELISM";
+const char* const kEnvHostBufferPoolBytes = "XLA_HOST_BUFFER_POOL_BYTES";
+const char* const kEnvHostBufferPoolPin = "XLA_HOST_BUFFER_POOL_PIN";
+const char* const kEnvExecutionLaneMaxHoldMs = "XLA_EXECUTION_LANE_MAX_HOLD_MS";
+const char* const kEnvMaxInflightDeviceOperations =
+    "XLA_MAX_INFLIGHT_DEVICE_OPERATIONS";
+const char* const kEnvCopyReplicatedShards = "XLA_COPY_REPLICATED_SHARDS";
+const char* const kEnvReshardCacheSize = "XLA_RESHARD_CACHE_SIZE";
+const char* const kEnvCpuIntraOpThreads = "XLA_CPU_INTRA_OP_THREADS";
+const char* const kEnvCpuNumaNode = "XLA_CPU_NUMA_NODE";
 
 }  // namespace env
 }  // namespace runtime
@@ -37,6 +37,15 @@ extern const char* const kEnvPjrtDynamicPlugins;
 extern const char* const kEnvDistSvcHeartbeatIntervalInSec;
 extern const char* const kEnvDistSvcMaxMissingHeartbeats;
 extern const char* const kEnvDistSvcShutdownTimeoutInMin;
+extern const char* const kEnvCompileParallelism;
+extern const char* const kEnvHostBufferPoolBytes;
+extern const char* const kEnvHostBufferPoolPin;
+extern const char* const kEnvExecutionLaneMaxHoldMs;
+extern const char* const kEnvMaxInflightDeviceOperations;
+extern const char* const kEnvCopyReplicatedShards;
+extern const char* const kEnvReshardCacheSize;
+extern const char* const kEnvCpuIntraOpThreads;
+extern const char* const kEnvCpuNumaNode;
 
 }  // namespace env
 }  // namespace runtime
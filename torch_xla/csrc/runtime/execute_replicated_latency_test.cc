@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "torch_xla/csrc/runtime/computation_client.h"
+#include "torch_xla/csrc/runtime/ifrt_computation_client.h"
+#include "torch_xla/csrc/runtime/pjrt_computation_client.h"
+#include "torch_xla/csrc/runtime/tensor_source.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/test.h"
+#include "xla/client/xla_builder.h"
+#include "xla/hlo/ir/hlo_sharding.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/tests/literal_test_util.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace {
+
+constexpr int kNumArguments = 16;
+constexpr int kNumOutputs = 256;
+constexpr int kIterations = 10;
+
+// Runs the same replicated computation through `client` and returns the host
+// latency of an ExecuteReplicated call, in microseconds.
+int64_t MeasureExecuteReplicated(ComputationClient* client) {
+  std::vector<std::string> devices = client->GetLocalDevices();
+  xla::Shape shape = xla::ShapeUtil::MakeShape(xla::F32, {2, 2});
+  xla::OpSharding replicated = xla::HloSharding::Replicate().ToProto();
+  xla::XlaBuilder builder("ExecuteReplicatedLatency");
+  builder.SetSharding(replicated);
+  std::vector<xla::XlaOp> parameters;
+  for (int i = 0; i < kNumArguments; ++i) {
+    parameters.push_back(
+        xla::Parameter(&builder, i, shape, absl::StrCat("p", i)));
+  }
+  std::vector<xla::XlaOp> outputs;
+  for (int i = 0; i < kNumOutputs; ++i) {
+    outputs.push_back(xla::Add(parameters[i % kNumArguments],
+                               xla::ConstantR0<float>(&builder, i)));
+  }
+  builder.ClearSharding();
+  xla::Tuple(&builder, outputs);
+  xla::Shape output_shape = xla::ShapeUtil::MakeTupleShape(
+      std::vector<xla::Shape>(kNumOutputs, shape));
+
+  std::string device = client->GetDefaultDevice();
+  std::vector<ComputationClient::CompileInstance> instances;
+  instances.push_back(ComputationClient::CompileInstance(
+      builder.Build().value(), device,
+      client->GetCompilationDevices(device, {}), &output_shape,
+      /*parameter_is_tupled_arguments=*/false, /*is_sharded=*/true));
+  std::vector<ComputationClient::ComputationPtr> computations =
+      client->Compile(std::move(instances));
+
+  std::vector<ComputationClient::DataPtr> arguments;
+  for (int i = 0; i < kNumArguments; ++i) {
+    std::vector<std::shared_ptr<const TensorSource>> shards;
+    for (const std::string& shard_device : devices) {
+      shards.push_back(std::make_shared<LiteralSource>(
+          xla::LiteralUtil::CreateR2<float>({{1.0f, 2.0f}, {3.0f, 4.0f}}),
+          shard_device));
+    }
+    arguments.push_back(client->TransferShardsToDevice(
+        shards, ComputationClient::spmd_device_str, shape, replicated));
+  }
+
+  ComputationClient::ExecuteReplicatedOptions options;
+  std::vector<ComputationClient::DataPtr> results;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    results = client->ExecuteReplicated(*computations[0], arguments, devices,
+                                        options);
+  }
+  int64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count() /
+                       kIterations;
+
+  EXPECT_EQ(results.size(), kNumOutputs);
+  std::vector<ComputationClient::DataPtr> last = {results.back()};
+  std::vector<xla::Literal> literals = client->TransferFromDevice(last);
+  EXPECT_TRUE(xla::LiteralTestUtil::Equal(
+      xla::LiteralUtil::CreateR2<float>(
+          {{1.0f + kNumOutputs - 1, 2.0f + kNumOutputs - 1},
+           {3.0f + kNumOutputs - 1, 4.0f + kNumOutputs - 1}}),
+      literals[0]));
+  return latency_us;
+}
+
+}  // namespace
+
+// Compares the host latency of ExecuteReplicated between the PJRT and the IFRT
+// clients, on the same computation and devices.
+TEST(ExecuteReplicatedLatencyTest, PjRtVsIfrt) {
+  tsl::setenv("PJRT_DEVICE", "CPU", true);
+  for (int num_devices : {1, 4, 8}) {
+    tsl::setenv("CPU_NUM_DEVICES", absl::StrCat(num_devices).c_str(), true);
+    auto pjrt_client = std::make_unique<PjRtComputationClient>();
+    int64_t pjrt_us = MeasureExecuteReplicated(pjrt_client.get());
+    auto ifrt_client = std::make_unique<IfrtComputationClient>();
+    int64_t ifrt_us = MeasureExecuteReplicated(ifrt_client.get());
+    LOG(INFO) << "ExecuteReplicated latency with " << num_devices
+              << " devices, " << kNumArguments << " arguments and "
+              << kNumOutputs << " outputs: PJRT " << pjrt_us << "us, IFRT "
+              << ifrt_us << "us";
+  }
+}
+
+}  // namespace runtime
+}  // namespace torch_xla
@@ -0,0 +1,113 @@
+#include "torch_xla/csrc/runtime/execution_dispatcher.h"
+
+#include <chrono>
+
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/metrics.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace {
+
+size_t LaneIndex(ExecutionLane lane) { return static_cast<size_t>(lane); }
+
+metrics::Metric* QueueDepthMetric(ExecutionLane lane) {
+  static metrics::Metric* const metrics[] = {
+      new metrics::Metric("ExecutionLaneDefaultQueueDepth"),
+      new metrics::Metric("ExecutionLaneHighPriorityQueueDepth")};
+  return metrics[LaneIndex(lane)];
+}
+
+metrics::Metric* WaitTimeMetric(ExecutionLane lane) {
+  static metrics::Metric* const metrics[] = {
+      new metrics::Metric("ExecutionLaneDefaultWaitTime",
+                          metrics::MetricFnTime),
+      new metrics::Metric("ExecutionLaneHighPriorityWaitTime",
+                          metrics::MetricFnTime)};
+  return metrics[LaneIndex(lane)];
+}
+
+metrics::Metric* DeviceBusyTimeMetric() {
+  static metrics::Metric* metric =
+      new metrics::Metric("DeviceBusyTime", metrics::MetricFnTime);
+  return metric;
+}
+
+metrics::Metric* DeviceIdleTimeMetric() {
+  static metrics::Metric* metric =
+      new metrics::Metric("DeviceIdleTime", metrics::MetricFnTime);
+  return metric;
+}
+
+int64_t TotalPending(const int64_t* pending) { return pending[0] + pending[1]; }
+
+}  // namespace
+
+ExecutionDispatcher::Ticket::~Ticket() {
+  bool notify = false;
+  {
+    std::lock_guard<std::mutex> lock(queue_->lock);
+    int64_t pending = --queue_->pending[LaneIndex(lane_)];
+    notify = lane_ == ExecutionLane::kHighPriority && pending == 0;
+    if (TotalPending(queue_->pending) == 0) {
+      queue_->idle_since_ns = sys_util::NowNs();
+      DeviceBusyTimeMetric()->AddSample(queue_->idle_since_ns -
+                                        queue_->busy_since_ns);
+    }
+  }
+  if (notify) {
+    queue_->cv.notify_all();
+  }
+}
+
+ExecutionDispatcher::ExecutionDispatcher(absl::Span<const std::string> devices,
+                                         int64_t max_hold_ms)
+    : max_hold_ms_(max_hold_ms) {
+  for (const std::string& device : devices) {
+    queues_.emplace(device, std::make_unique<DeviceQueue>());
+  }
+}
+
+std::unique_ptr<ExecutionDispatcher::Ticket> ExecutionDispatcher::Enter(
+    const std::string& device, ExecutionLane lane) {
+  auto it = queues_.find(device);
+  XLA_CHECK(it != queues_.end()) << "Unknown device " << device;
+  DeviceQueue* queue = it->second.get();
+  int64_t start_ns = sys_util::NowNs();
+  std::unique_lock<std::mutex> lock(queue->lock);
+  if (TotalPending(queue->pending) == 0) {
+    queue->busy_since_ns = sys_util::NowNs();
+    if (queue->idle_since_ns > 0) {
+      DeviceIdleTimeMetric()->AddSample(queue->busy_since_ns -
+                                        queue->idle_since_ns);
+    }
+  }
+  int64_t pending = ++queue->pending[LaneIndex(lane)];
+  QueueDepthMetric(lane)->AddSample(pending);
+  auto no_high_priority = [queue]() {
+    return queue->pending[LaneIndex(ExecutionLane::kHighPriority)] == 0;
+  };
+  if (lane == ExecutionLane::kDefault && !no_high_priority()) {
+    if (max_hold_ms_ < 0) {
+      queue->cv.wait(lock, no_high_priority);
+    } else {
+      queue->cv.wait_for(lock, std::chrono::milliseconds(max_hold_ms_),
+                         no_high_priority);
+    }
+  }
+  lock.unlock();
+  WaitTimeMetric(lane)->AddSample(sys_util::NowNs() - start_ns);
+  return std::unique_ptr<Ticket>(new Ticket(queue, lane));
+}
+
+int64_t ExecutionDispatcher::PendingExecutions(const std::string& device,
+                                               ExecutionLane lane) {
+  auto it = queues_.find(device);
+  XLA_CHECK(it != queues_.end()) << "Unknown device " << device;
+  std::lock_guard<std::mutex> lock(it->second->lock);
+  return it->second->pending[LaneIndex(lane)];
+}
+
+}  // namespace runtime
+}  // namespace torch_xla
@@ -0,0 +1,91 @@
+#ifndef XLA_CLIENT_EXECUTION_DISPATCHER_H_
+#define XLA_CLIENT_EXECUTION_DISPATCHER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "absl/types/span.h"
+
+namespace torch_xla {
+namespace runtime {
+
+// The lanes an execution can be dispatched in.
+enum class ExecutionLane {
+  // Throughput oriented work, eg. training steps.
+  kDefault = 0,
+  // Latency sensitive work, eg. online evaluation or sampling graphs, which
+  // should not wait behind the work of the default lane.
+  kHighPriority = 1,
+};
+
+// Host side dispatcher of the executions of each device. The device runtime
+// queues are FIFO, so the dispatcher holds back the executions of the default
+// lane while high priority executions are pending on the same device (waiting
+// to be dispatched or running), which keeps the default lane from queueing
+// work ahead of them. A default lane execution is held back for at most
+// `max_hold_ms` (unbounded when negative), so that a steady stream of high
+// priority work cannot starve it.
+//
+// For each lane, metric ExecutionLane<Lane>QueueDepth samples the pending
+// executions of the lane when one enters, and ExecutionLane<Lane>WaitTime the
+// time it then waited before being let through (only default lane executions
+// are ever held back). Metric DeviceBusyTime samples the spans during which a
+// device has pending executions, and DeviceIdleTime the gaps between them, in
+// which the device waits for the host to dispatch more work.
+class ExecutionDispatcher {
+  struct DeviceQueue {
+    std::mutex lock;
+    std::condition_variable cv;
+    // Pending executions, indexed by lane.
+    int64_t pending[2] = {0, 0};
+    // When the device last started and stopped having pending executions.
+    int64_t busy_since_ns = 0;
+    int64_t idle_since_ns = 0;
+  };
+
+ public:
+  // An execution registered with the dispatcher, pending until destroyed.
+  class Ticket {
+   public:
+    ~Ticket();
+
+    Ticket(const Ticket&) = delete;
+    Ticket& operator=(const Ticket&) = delete;
+
+   private:
+    friend class ExecutionDispatcher;
+
+    Ticket(DeviceQueue* queue, ExecutionLane lane)
+        : queue_(queue), lane_(lane) {}
+
+    DeviceQueue* queue_;
+    ExecutionLane lane_;
+  };
+
+  ExecutionDispatcher() = default;
+  ExecutionDispatcher(absl::Span<const std::string> devices,
+                      int64_t max_hold_ms);
+
+  ExecutionDispatcher(ExecutionDispatcher&&) = default;
+  ExecutionDispatcher& operator=(ExecutionDispatcher&&) = default;
+
+  // Registers an execution on `device`. Default lane executions first wait
+  // for the pending high priority executions of the device, see above.
+  std::unique_ptr<Ticket> Enter(const std::string& device, ExecutionLane lane);
+
+  // Number of executions of `lane` pending on `device`.
+  int64_t PendingExecutions(const std::string& device, ExecutionLane lane);
+
+ private:
+  int64_t max_hold_ms_ = -1;
+  std::unordered_map<std::string, std::unique_ptr<DeviceQueue>> queues_;
+};
+
+}  // namespace runtime
+}  // namespace torch_xla
+
+#endif  // XLA_CLIENT_EXECUTION_DISPATCHER_H_
@@ -0,0 +1,90 @@
+#include "torch_xla/csrc/runtime/execution_dispatcher.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "torch_xla/csrc/runtime/metrics.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace {
+
+size_t TotalSamples(const metrics::Metric& metric) {
+  size_t total_samples = 0;
+  metric.Samples(nullptr, &total_samples);
+  return total_samples;
+}
+
+}  // namespace
+
+TEST(ExecutionDispatcherTest, HoldsBackDefaultLane) {
+  std::vector<std::string> devices = {"CPU:0", "CPU:1"};
+  ExecutionDispatcher dispatcher(devices, /*max_hold_ms=*/-1);
+  std::unique_ptr<ExecutionDispatcher::Ticket> high_priority =
+      dispatcher.Enter("CPU:0", ExecutionLane::kHighPriority);
+
+  // Other devices are not held back.
+  dispatcher.Enter("CPU:1", ExecutionLane::kDefault);
+
+  std::atomic<bool> dispatched(false);
+  std::thread thread([&]() {
+    auto ticket = dispatcher.Enter("CPU:0", ExecutionLane::kDefault);
+    dispatched = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(dispatched);
+  EXPECT_EQ(dispatcher.PendingExecutions("CPU:0", ExecutionLane::kDefault), 1);
+
+  // High priority executions are never held back.
+  dispatcher.Enter("CPU:0", ExecutionLane::kHighPriority);
+  EXPECT_FALSE(dispatched);
+
+  high_priority.reset();
+  thread.join();
+  EXPECT_TRUE(dispatched);
+  EXPECT_EQ(dispatcher.PendingExecutions("CPU:0", ExecutionLane::kDefault), 0);
+  EXPECT_EQ(
+      dispatcher.PendingExecutions("CPU:0", ExecutionLane::kHighPriority), 0);
+}
+
+TEST(ExecutionDispatcherTest, BoundsTheHoldTime) {
+  std::vector<std::string> devices = {"CPU:0"};
+  ExecutionDispatcher dispatcher(devices, /*max_hold_ms=*/10);
+  auto high_priority = dispatcher.Enter("CPU:0", ExecutionLane::kHighPriority);
+  auto start = std::chrono::steady_clock::now();
+  auto ticket = dispatcher.Enter("CPU:0", ExecutionLane::kDefault);
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(10));
+  EXPECT_EQ(dispatcher.PendingExecutions("CPU:0", ExecutionLane::kDefault), 1);
+}
+
+TEST(ExecutionDispatcherTest, TimesDeviceIdleGaps) {
+  // The metrics are shared with the other tests, so only new samples count.
+  metrics::Metric idle("DeviceIdleTime", metrics::MetricFnTime);
+  metrics::Metric busy("DeviceBusyTime", metrics::MetricFnTime);
+  size_t idle_samples = TotalSamples(idle);
+  size_t busy_samples = TotalSamples(busy);
+
+  std::vector<std::string> devices = {"CPU:0"};
+  ExecutionDispatcher dispatcher(devices, /*max_hold_ms=*/-1);
+  dispatcher.Enter("CPU:0", ExecutionLane::kDefault);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  {
+    auto ticket = dispatcher.Enter("CPU:0", ExecutionLane::kDefault);
+    // Not a gap, the device is busy with `ticket`.
+    dispatcher.Enter("CPU:0", ExecutionLane::kHighPriority);
+  }
+
+  ASSERT_EQ(TotalSamples(idle), idle_samples + 1);
+  EXPECT_GE(idle.Samples(nullptr, nullptr).back().value, 20e6);
+  EXPECT_EQ(TotalSamples(busy), busy_samples + 2);
+}
+
+}  // namespace runtime
+}  // namespace torch_xla
@@ -0,0 +1,144 @@
+#include "torch_xla/csrc/runtime/host_buffer_pool.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/metrics.h"
+#include "torch_xla/csrc/runtime/tf_logging.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace {
+
+constexpr size_t kMinSizeClass = 4096;
+
+size_t PageSize() {
+  static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return page_size;
+}
+
+}  // namespace
+
+std::shared_ptr<HostBufferPool> HostBufferPool::Create(size_t max_cached_bytes,
+                                                       bool pin_memory) {
+  return std::make_shared<HostBufferPool>(max_cached_bytes, pin_memory);
+}
+
+HostBufferPool::HostBufferPool(size_t max_cached_bytes, bool pin_memory)
+    : max_cached_bytes_(max_cached_bytes), pin_memory_(pin_memory) {}
+
+HostBufferPool::~HostBufferPool() { Clear(); }
+
+size_t HostBufferPool::SizeClass(size_t size) {
+  size_t size_class = kMinSizeClass;
+  while (size_class < size) {
+    size_class <<= 1;
+  }
+  return size_class;
+}
+
+std::shared_ptr<char> HostBufferPool::Allocate(size_t size) {
+  size_t size_class = SizeClass(size);
+  if (size_class > max_cached_bytes_) {
+    // Too large to ever be cached, so do not pay the page-locking cost for a
+    // buffer which is going to be freed right after the transfer.
+    XLA_COUNTER("HostBufferPoolFallbackAllocation", 1);
+    return std::shared_ptr<char>(new char[size],
+                                 std::default_delete<char[]>());
+  }
+  char* buffer = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = free_buffers_.find(size_class);
+    if (it != free_buffers_.end() && !it->second.empty()) {
+      buffer = it->second.back();
+      it->second.pop_back();
+      cached_bytes_ -= size_class;
+    }
+  }
+  if (buffer != nullptr) {
+    XLA_COUNTER("HostBufferPoolHit", 1);
+  } else {
+    XLA_COUNTER("HostBufferPoolMiss", 1);
+    buffer = AllocateBuffer(size_class);
+  }
+  std::shared_ptr<HostBufferPool> pool = shared_from_this();
+  return std::shared_ptr<char>(buffer, [pool, size_class](char* buffer) {
+    pool->Release(buffer, size_class);
+  });
+}
+
+void HostBufferPool::Clear() {
+  std::map<size_t, std::vector<char*>> free_buffers;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    free_buffers.swap(free_buffers_);
+    cached_bytes_ = 0;
+  }
+  for (auto& [size_class, buffers] : free_buffers) {
+    for (char* buffer : buffers) {
+      FreeBuffer(buffer, size_class);
+    }
+  }
+}
+
+size_t HostBufferPool::cached_bytes() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return cached_bytes_;
+}
+
+char* HostBufferPool::AllocateBuffer(size_t size_class) {
+  // Size classes are powers of two not smaller than 4KB, hence multiples of
+  // the page size as required by aligned_alloc().
+  size_t alignment = std::min(PageSize(), size_class);
+  char* buffer = static_cast<char*>(std::aligned_alloc(alignment, size_class));
+  XLA_CHECK(buffer != nullptr)
+      << "Failed to allocate " << size_class << " bytes host staging buffer";
+  if (pin_memory_) {
+    if (mlock(buffer, size_class) == 0) {
+      XLA_COUNTER("HostBufferPoolPinnedBytes", size_class);
+      std::lock_guard<std::mutex> lock(lock_);
+      pinned_buffers_.insert(buffer);
+    } else {
+      // Typically RLIMIT_MEMLOCK being too low. The buffer is still usable,
+      // only the transfers from and into it will be slower.
+      TF_VLOG(3) << "Failed to page-lock " << size_class
+                 << " bytes host staging buffer: errno " << errno;
+      XLA_COUNTER("HostBufferPoolPinFailure", 1);
+    }
+  }
+  return buffer;
+}
+
+void HostBufferPool::FreeBuffer(char* buffer, size_t size_class) {
+  bool pinned = false;
+  if (pin_memory_) {
+    std::lock_guard<std::mutex> lock(lock_);
+    pinned = pinned_buffers_.erase(buffer) > 0;
+  }
+  if (pinned) {
+    munlock(buffer, size_class);
+    XLA_COUNTER("HostBufferPoolPinnedBytes", -static_cast<int64_t>(size_class));
+  }
+  std::free(buffer);
+}
+
+void HostBufferPool::Release(char* buffer, size_t size_class) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (cached_bytes_ + size_class <= max_cached_bytes_) {
+      free_buffers_[size_class].push_back(buffer);
+      cached_bytes_ += size_class;
+      return;
+    }
+  }
+  FreeBuffer(buffer, size_class);
+}
+
+}  // namespace runtime
+}  // namespace torch_xla
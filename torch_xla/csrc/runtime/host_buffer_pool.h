@@ -0,0 +1,71 @@
+#ifndef XLA_CLIENT_HOST_BUFFER_POOL_H_
+#define XLA_CLIENT_HOST_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace torch_xla {
+namespace runtime {
+
+// Pool of page aligned host buffers used to stage host<->device transfers.
+// Buffers are grouped in power of two size classes and returned to the pool
+// when the last reference to them is dropped, so that repeated transfers of
+// similarly sized data do not go through the allocator every time. When
+// `pin_memory` is set, buffers are page-locked (mlock) so the device runtime
+// can DMA from and into them without an intermediate bounce copy.
+//
+// The pool keeps at most `max_cached_bytes` of idle buffers. Allocations are
+// never refused: requests that cannot be served from the pool are satisfied
+// with a fresh buffer, which is only kept once released if it fits within the
+// cached bytes limit.
+class HostBufferPool : public std::enable_shared_from_this<HostBufferPool> {
+ public:
+  static std::shared_ptr<HostBufferPool> Create(size_t max_cached_bytes,
+                                                bool pin_memory);
+
+  HostBufferPool(size_t max_cached_bytes, bool pin_memory);
+
+  ~HostBufferPool();
+
+  HostBufferPool(const HostBufferPool&) = delete;
+  HostBufferPool& operator=(const HostBufferPool&) = delete;
+
+  // Returns a buffer of at least `size` bytes. The buffer goes back to the pool
+  // when the returned pointer (and all its copies) are destroyed.
+  std::shared_ptr<char> Allocate(size_t size);
+
+  // Frees all the idle buffers held by the pool.
+  void Clear();
+
+  size_t cached_bytes() const;
+
+  bool pin_memory() const { return pin_memory_; }
+
+ private:
+  static size_t SizeClass(size_t size);
+
+  char* AllocateBuffer(size_t size_class);
+
+  void FreeBuffer(char* buffer, size_t size_class);
+
+  void Release(char* buffer, size_t size_class);
+
+  const size_t max_cached_bytes_;
+  const bool pin_memory_;
+  mutable std::mutex lock_;
+  // Idle buffers, keyed by size class.
+  std::map<size_t, std::vector<char*>> free_buffers_;
+  size_t cached_bytes_ = 0;
+  // Buffers which have been successfully page-locked.
+  std::unordered_set<char*> pinned_buffers_;
+};
+
+}  // namespace runtime
+}  // namespace torch_xla
+
+#endif  // XLA_CLIENT_HOST_BUFFER_POOL_H_
@@ -0,0 +1,87 @@
+#include "torch_xla/csrc/runtime/host_buffer_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "torch_xla/csrc/runtime/metrics.h"
+
+namespace torch_xla {
+namespace runtime {
+
+namespace {
+
+int64_t CounterValue(const std::string& name) {
+  metrics::CounterData* data = metrics::GetCounter(name);
+  return data != nullptr ? data->Value() : 0;
+}
+
+}  // namespace
+
+TEST(HostBufferPoolTest, ReusesReleasedBuffers) {
+  std::shared_ptr<HostBufferPool> pool =
+      HostBufferPool::Create(/*max_cached_bytes=*/1 << 20,
+                             /*pin_memory=*/false);
+  int64_t hits = CounterValue("HostBufferPoolHit");
+
+  char* data = nullptr;
+  {
+    std::shared_ptr<char> buffer = pool->Allocate(5000);
+    ASSERT_NE(buffer, nullptr);
+    data = buffer.get();
+    // Buffers are page aligned and usable for the whole requested size.
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % 4096, 0);
+    std::fill(data, data + 5000, 'x');
+  }
+  EXPECT_EQ(pool->cached_bytes(), 8192);
+
+  // Same size class, so the released buffer is handed out again.
+  std::shared_ptr<char> buffer = pool->Allocate(8000);
+  EXPECT_EQ(buffer.get(), data);
+  EXPECT_EQ(pool->cached_bytes(), 0);
+  EXPECT_EQ(CounterValue("HostBufferPoolHit"), hits + 1);
+
+  // A different size class does not reuse it.
+  std::shared_ptr<char> other = pool->Allocate(100);
+  EXPECT_NE(other.get(), data);
+  EXPECT_EQ(CounterValue("HostBufferPoolHit"), hits + 1);
+}
+
+TEST(HostBufferPoolTest, RespectsCachedBytesLimit) {
+  std::shared_ptr<HostBufferPool> pool =
+      HostBufferPool::Create(/*max_cached_bytes=*/16384,
+                             /*pin_memory=*/false);
+  {
+    std::shared_ptr<char> a = pool->Allocate(8192);
+    std::shared_ptr<char> b = pool->Allocate(8192);
+    std::shared_ptr<char> c = pool->Allocate(8192);
+  }
+  EXPECT_EQ(pool->cached_bytes(), 16384);
+  pool->Clear();
+  EXPECT_EQ(pool->cached_bytes(), 0);
+
+  // Requests larger than the limit bypass the pool.
+  int64_t fallbacks = CounterValue("HostBufferPoolFallbackAllocation");
+  { std::shared_ptr<char> large = pool->Allocate(1 << 20); }
+  EXPECT_EQ(CounterValue("HostBufferPoolFallbackAllocation"), fallbacks + 1);
+  EXPECT_EQ(pool->cached_bytes(), 0);
+}
+
+TEST(HostBufferPoolTest, OutstandingBuffersOutliveThePool) {
+  std::shared_ptr<char> buffer;
+  {
+    std::shared_ptr<HostBufferPool> pool =
+        HostBufferPool::Create(/*max_cached_bytes=*/1 << 20,
+                               /*pin_memory=*/true);
+    buffer = pool->Allocate(4096);
+  }
+  // The buffer keeps the pool alive until it is released.
+  buffer.get()[4095] = 'x';
+  buffer.reset();
+}
+
+}  // namespace runtime
+}  // namespace torch_xla
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_join.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/types/span.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
@@ -16,6 +17,7 @@
 #include "torch_xla/csrc/runtime/tf_logging.h"
 #include "torch_xla/csrc/runtime/xla_coordinator.h"
 #include "tsl/profiler/lib/traceme.h"
+#include "tsl/profiler/lib/traceme_encode.h"
 #include "xla/client/xla_builder.h"
 #include "xla/client/xla_computation.h"
 #include "xla/layout_util.h"
@@ -39,6 +41,13 @@ namespace runtime {
 
 namespace {
 
+xla::ifrt::MemoryKind ToIfrtMemoryKind(MemoryKind memory_kind) {
+  if (memory_kind == MemoryKind::kDevice) {
+    return xla::ifrt::MemoryKind();
+  }
+  return xla::ifrt::MemoryKind(std::string(MemoryKindToString(memory_kind)));
+}
+
 // Builds a map from the device's global ordinal to its index in the `devices`
 // array.
 std::unordered_map<int, int> build_index_map(
@@ -55,9 +64,9 @@ std::unordered_map<int, int> build_index_map(
 }
 
 torch::lazy::hash_t hash_comp_env(
-    xla::ifrt::Client* client,
-    std::vector<xla::ifrt::Device*>& ordered_devices) {
-  torch::lazy::hash_t hash = hash::HashXlaEnvVars();
+    xla::ifrt::Client* client, std::vector<xla::ifrt::Device*>& ordered_devices,
+    hash::EnvComponents* components) {
+  torch::lazy::hash_t hash = hash::HashXlaEnvVars(components);
   std::string platform_name(client->platform_name());
   std::string platform_version(client->platform_version());
   hash = torch::lazy::HashCombine(
@@ -65,14 +74,19 @@ torch::lazy::hash_t hash_comp_env(
   // platform_version incorporates libtpu version and hardware type.
   hash = torch::lazy::HashCombine(
       hash, torch::lazy::StringHash(platform_version.c_str()));
+  (*components)["platform_name"] = platform_name;
+  (*components)["platform_version"] = platform_version;
   // Include global devices in the hash, ensuring order is consistent.
   xla::ifrt::DeviceList::Devices ifrt_devices;
+  std::vector<std::string> device_strs;
   for (auto& device : ordered_devices) {
     std::string device_str(device->ToString());
     hash = torch::lazy::HashCombine(
         hash, torch::lazy::StringHash(device_str.c_str()));
     ifrt_devices.push_back(device);
+    device_strs.push_back(std::move(device_str));
   }
+  (*components)["devices"] = absl::StrJoin(device_strs, ", ");
 
   xla::ifrt::DeviceList device_list(std::move(ifrt_devices));
   auto topology_desc = client->GetTopologyForDevices(device_list);
@@ -81,15 +95,47 @@ torch::lazy::hash_t hash_comp_env(
     // view of the specific compilation environment.
     auto serialized = topology_desc.value()->Serialize();
     if (serialized.ok()) {
-      return torch::lazy::HashCombine(
-          hash,
-          torch::lazy::DataHash(serialized->data(), serialized->length()));
+      torch::lazy::hash_t topology_hash =
+          torch::lazy::DataHash(serialized->data(), serialized->length());
+      (*components)["topology"] = torch::lazy::HashToString(topology_hash);
+      return torch::lazy::HashCombine(hash, topology_hash);
     }
     // If serialization fails, fallthrough to the manual approach.
   }
   return hash;
 }
 
+// Builds the IFRT sharding of an array assembled from shards of the given
+// shapes. Prefers the HloSharding, which carries the OpSharding semantics to
+// the runtime, and falls back to a ConcreteSharding listing the shard shapes
+// when its shards would not match those.
+std::unique_ptr<xla::ifrt::Sharding> CreateIfrtSharding(
+    const xla::ifrt::DeviceList& devices, const xla::ifrt::Shape& shape,
+    const std::vector<xla::ifrt::Shape>& shard_shapes,
+    const xla::OpSharding& sharding) {
+  if (sharding.type() == xla::OpSharding::REPLICATED ||
+      sharding.type() == xla::OpSharding::OTHER) {
+    auto hlo_sharding = xla::HloSharding::FromProto(sharding);
+    if (hlo_sharding.ok()) {
+      std::unique_ptr<xla::ifrt::HloSharding> ifrt_sharding =
+          xla::ifrt::HloSharding::Create(devices, xla::ifrt::MemoryKind(),
+                                         *hlo_sharding);
+      auto disassembled = ifrt_sharding->Disassemble(shape);
+      bool matches = disassembled.ok() &&
+                     disassembled->size() == shard_shapes.size();
+      for (size_t i = 0; matches && i < shard_shapes.size(); ++i) {
+        matches = (*disassembled)[i].first == shard_shapes[i];
+      }
+      if (matches) {
+        return ifrt_sharding;
+      }
+    }
+  }
+  XLA_COUNTER("IfrtConcreteSharding", 1);
+  return xla::ifrt::ConcreteSharding::Create(devices, xla::ifrt::MemoryKind(),
+                                             shape, shard_shapes);
+}
+
 }  // namespace
 
 std::string IfrtComputationClient::IfrtDeviceToString(
@@ -133,11 +179,11 @@ IfrtComputationClient::IfrtComputationClient() {
     std::string device_str = IfrtDeviceToString(device);
     string_to_device_.emplace(device_str, device);
   }
-  comp_env_hash_ = hash_comp_env(client_.get(), ordered_devices);
-
   auto tracked_devices = GetLocalDevices();
   tracked_devices.emplace_back(spmd_device_str);
-  operation_manager_ = std::move(OperationManager(std::move(tracked_devices)));
+  operation_manager_ = std::move(OperationManager(
+      std::move(tracked_devices),
+      sys_util::GetEnvInt(env::kEnvMaxInflightDeviceOperations, 0)));
 }
 
 IfrtComputationClient::~IfrtComputationClient() {
@@ -182,10 +228,12 @@ xla::OpSharding IfrtComputationClient::IfrtData::GetSharding() const {
 
 ComputationClient::DataPtr IfrtComputationClient::CreateDataPlaceholder(
     std::string device, xla::Shape shape,
-    std::optional<xla::OpSharding> sharding) {
-  return std::make_shared<IfrtData>(std::move(device), std::move(shape),
-                                    tsl::RCReference<xla::ifrt::Array>(),
-                                    std::move(sharding));
+    std::optional<xla::OpSharding> sharding, MemoryKind memory_kind) {
+  auto data = std::make_shared<IfrtData>(std::move(device), std::move(shape),
+                                         tsl::RCReference<xla::ifrt::Array>(),
+                                         std::move(sharding));
+  data->set_memory_kind(memory_kind);
+  return data;
 }
 
 std::vector<ComputationClient::DataPtr> IfrtComputationClient::GetDataShards(
@@ -198,7 +246,7 @@ std::vector<ComputationClient::DataPtr> IfrtComputationClient::GetDataShards(
     std::vector<tsl::RCReference<xla::ifrt::Array>> arrays =
         ifrt_data->buffer
             ->DisassembleIntoSingleDeviceArrays(
-                xla::ifrt::ArrayCopySemantics::kAlwaysCopy)
+                xla::ifrt::ArrayCopySemantics::kReuseInput)
             .value();
 
     for (auto array : arrays) {
@@ -234,20 +282,13 @@ ComputationClient::DataPtr IfrtComputationClient::WrapDataShards(
                                       client_->addressable_devices().end()});
   XLA_CHECK_EQ(shard_shapes.size(), devices_list.size());
   std::unique_ptr<xla::ifrt::Sharding> ifrt_sharding =
-      xla::ifrt::ConcreteSharding::Create(devices_list, xla::ifrt::MemoryKind(),
-                                          ifrt_shape, shard_shapes);
-  // TODO: Attach HloSharding instead when it is supported
-  // std::unique_ptr<xla::ifrt::Sharding> ifrt_sharding =
-  // xla::ifrt::HloSharding::Create(
-  //   devices_list,
-  //   xla::ifrt::MemoryKind(),
-  //   xla::HloSharding::FromProto(sharding).value()
-  // );
+      CreateIfrtSharding(devices_list, ifrt_shape, shard_shapes, sharding);
+  // The shards stay owned by their data handles, share their buffers.
   tsl::RCReference<xla::ifrt::Array> sharded_array =
       client_
           ->AssembleArrayFromSingleDeviceArrays(
               ifrt_shape, std::move(ifrt_sharding), absl::MakeSpan(arrays),
-              xla::ifrt::ArrayCopySemantics::kAlwaysCopy)
+              xla::ifrt::ArrayCopySemantics::kReuseInput)
           .value();
   return std::make_shared<IfrtData>(device, shape, sharded_array, sharding);
 }
@@ -262,33 +303,56 @@ std::vector<ComputationClient::DataPtr> IfrtComputationClient::TransferToDevice(
     absl::Span<const std::shared_ptr<const TensorSource>> tensors) {
   auto timed =
       std::make_shared<metrics::TimedSection>(TransferToDeviceMetric());
-  tsl::profiler::TraceMe activity("IfrtComputationClient::TransferToDevice",
-                                  tsl::profiler::TraceMeLevel::kInfo);
-  std::vector<ComputationClient::DataPtr> datas;
-  datas.reserve(tensors.size());
+  std::vector<ComputationClient::DataPtr> datas(tensors.size());
   int64_t total_size = 0;
   for (auto& tensor : tensors) {
-    xla::ifrt::Device* ifrt_device = StringToIfrtDevice(tensor->device());
-
     total_size += xla::ShapeUtil::ByteSizeOf(tensor->shape());
+  }
+  tsl::profiler::TraceMe activity(
+      [&] {
+        return tsl::profiler::TraceMeEncode(
+            "IfrtComputationClient::TransferToDevice",
+            {{"step", GetStepId()},
+             {"tensors", tensors.size()},
+             {"bytes", total_size}});
+      },
+      tsl::profiler::TraceMeLevel::kInfo);
 
-    tsl::RCReference<xla::ifrt::Array> buffer =
-        client_
-            ->MakeArrayFromHostBuffer(
-                tensor->data(),
-                xla::ifrt::ToDType(tensor->primitive_type()).value(),
-                xla::ifrt::Shape(tensor->dimensions()), tensor->byte_strides(),
-                // TODO: what is MemoryKind?
-                xla::ifrt::SingleDeviceSharding::Create(
-                    ifrt_device, xla::ifrt::MemoryKind()),
-                xla::ifrt::Client::HostBufferSemantics::
-                    kImmutableUntilTransferCompletes,
-                [tensor, timed]() { /* frees tensor and timer */ })
-            .value();
-
-    ComputationClient::DataPtr data =
-        std::make_shared<IfrtData>(tensor->device(), tensor->shape(), buffer);
-    datas.push_back(data);
+  auto transfer_fn = [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      const std::shared_ptr<const TensorSource>& tensor = tensors[i];
+      xla::ifrt::Device* ifrt_device = StringToIfrtDevice(tensor->device());
+
+      tsl::RCReference<xla::ifrt::Array> buffer =
+          client_
+              ->MakeArrayFromHostBuffer(
+                  tensor->data(),
+                  xla::ifrt::ToDType(tensor->primitive_type()).value(),
+                  xla::ifrt::Shape(tensor->dimensions()),
+                  tensor->byte_strides(),
+                  xla::ifrt::SingleDeviceSharding::Create(
+                      ifrt_device, ToIfrtMemoryKind(tensor->memory_kind())),
+                  xla::ifrt::Client::HostBufferSemantics::
+                      kImmutableUntilTransferCompletes,
+                  [tensor, timed]() { /* frees tensor and timer */ })
+              .value();
+
+      datas[i] = std::make_shared<IfrtData>(tensor->device(), tensor->shape(),
+                                            buffer);
+      datas[i]->set_memory_kind(tensor->memory_kind());
+    }
+  };
+  if (tensors.size() > 1) {
+    // Same as PjRtComputationClient::TransferToDevice, the host side staging
+    // of the transfers is spread over the pool.
+    static constexpr int64_t transfer_cost_ns = 10000;
+    static constexpr int64_t transfer_cost_ns_per_kb = 100;
+    int64_t cost_per_tensor =
+        transfer_cost_ns +
+        transfer_cost_ns_per_kb * total_size / 1024 / tensors.size();
+    pool_.ParallelFor(tensors.size(), cost_per_tensor, transfer_fn);
+  } else {
+    transfer_fn(0, tensors.size());
   }
   OutboundDataMetric()->AddSample(total_size);
   CreateDataHandlesCounter()->AddValue(datas.size());
@@ -302,11 +366,6 @@ ComputationClient::DataPtr IfrtComputationClient::TransferShardsToDevice(
   tsl::profiler::TraceMe activity(
       "IfrtComputationClient::TransferShardsToDevice",
       tsl::profiler::TraceMeLevel::kInfo);
-  // TODO(jonbolin): Consider using CopyToDevice when sharding is REPLICATED.
-  // We are opting out of CopyToDevice for now due to the synchronization
-  // issues observed in ShardingUtil::InputHandler, but because CopyToDevice
-  // directly copies buffers between devices using ICI, it can be much faster
-  // than transferring from the host to each device.
   auto data_shards = TransferToDevice(tensor_shards);
   std::vector<tsl::RCReference<xla::ifrt::Array>> arrays;
   std::vector<xla::ifrt::Shape> shard_shapes;
@@ -319,20 +378,14 @@ ComputationClient::DataPtr IfrtComputationClient::TransferShardsToDevice(
   xla::ifrt::DeviceList devices_list({client_->addressable_devices().begin(),
                                       client_->addressable_devices().end()});
   std::unique_ptr<xla::ifrt::Sharding> ifrt_sharding =
-      xla::ifrt::ConcreteSharding::Create(devices_list, xla::ifrt::MemoryKind(),
-                                          ifrt_shape, shard_shapes);
-  // TODO: Attach HloSharding instead when it is supported
-  // std::unique_ptr<xla::ifrt::Sharding> ifrt_sharding =
-  // xla::ifrt::HloSharding::Create(
-  //   devices_list,
-  //   xla::ifrt::MemoryKind(),
-  //   xla::HloSharding::FromProto(sharding).value()
-  // );
+      CreateIfrtSharding(devices_list, ifrt_shape, shard_shapes, sharding);
+  // The freshly uploaded shards are not referenced anywhere else, donate them
+  // to the assembled array.
   tsl::RCReference<xla::ifrt::Array> sharded_array =
       client_
           ->AssembleArrayFromSingleDeviceArrays(
               ifrt_shape, std::move(ifrt_sharding), absl::MakeSpan(arrays),
-              xla::ifrt::ArrayCopySemantics::kAlwaysCopy)
+              xla::ifrt::ArrayCopySemantics::kDonateInput)
           .value();
   return std::make_shared<IfrtData>(device, shape, sharded_array, sharding);
 }
@@ -389,10 +442,12 @@ tsl::RCReference<xla::ifrt::Array> IfrtComputationClient::ReplicateShardedData(
 
   auto sharded_results = ExecuteReplicated(*computations.front(), {{handle}},
                                            GetLocalDevices(), execute_options);
+  // The replicated result is only used to get its shard, which can take over
+  // its buffer.
   auto replicated_output =
       std::dynamic_pointer_cast<IfrtData>(sharded_results[0])
           ->buffer->FullyReplicatedShard(
-              xla::ifrt::ArrayCopySemantics::kAlwaysCopy);
+              xla::ifrt::ArrayCopySemantics::kDonateInput);
   // TODO: sanity check outputs
   return *replicated_output;
 }
@@ -410,8 +465,13 @@ std::shared_ptr<xla::PjRtBuffer> IfrtComputationClient::GetPjRtBuffer(
 std::vector<xla::Literal> IfrtComputationClient::TransferFromDevice(
     absl::Span<const DataPtr> handles) {
   metrics::TimedSection timed(TransferFromDeviceMetric());
-  tsl::profiler::TraceMe activity("IfrtComputationClient::TransferFromDevice",
-                                  tsl::profiler::TraceMeLevel::kInfo);
+  tsl::profiler::TraceMe activity(
+      [&] {
+        return tsl::profiler::TraceMeEncode(
+            "IfrtComputationClient::TransferFromDevice",
+            {{"step", GetStepId()}, {"tensors", handles.size()}});
+      },
+      tsl::profiler::TraceMeLevel::kInfo);
   std::vector<xla::Literal> literals;
   literals.reserve(handles.size());
   int64_t total_size = 0;
@@ -437,6 +497,8 @@ std::vector<xla::Literal> IfrtComputationClient::TransferFromDevice(
     total_size += literal.size_bytes();
   }
   InboundDataMetric()->AddSample(total_size);
+  activity.AppendMetadata(
+      [&] { return tsl::profiler::TraceMeEncode({{"bytes", total_size}}); });
 
   return literals;
 }
@@ -477,15 +539,27 @@ std::vector<ComputationClient::ComputationPtr> IfrtComputationClient::Compile(
       XLA_ERROR() << "Only SPMD compilation is supported";
     }
 
+    if (instance.backend_optimization_level >= 0) {
+      compile_options.executable_build_options.mutable_debug_options()
+          ->set_xla_backend_optimization_level(
+              instance.backend_optimization_level);
+    }
+
     // Convert HLO to StableHLO for Ifrt client compilation.
-    mlir::MLIRContext context;
-    mlir::ModuleOp mlir_module =
-        mlir::ModuleOp::create(mlir::UnknownLoc::get(&context));
-    torch_xla::ConvertHloToStableHlo(instance.computation.mutable_proto(),
-                                     &mlir_module);
+    std::shared_ptr<mlir::MLIRContext> context = GetStablehloContext();
+    mlir::OwningOpRef<mlir::ModuleOp> mlir_module;
+    if (!instance.stablehlo_bytecode.empty()) {
+      mlir_module =
+          DeserializeStablehlo(instance.stablehlo_bytecode, context.get());
+    } else {
+      mlir_module =
+          mlir::ModuleOp::create(mlir::UnknownLoc::get(context.get()));
+      torch_xla::ConvertHloToStableHlo(instance.computation.mutable_proto(),
+                                       &*mlir_module);
+    }
     std::unique_ptr<xla::ifrt::LoadedExecutable> executable =
         ConsumeValue(client_->GetDefaultCompiler()->Compile(
-            std::make_unique<xla::ifrt::HloProgram>(std::move(mlir_module)),
+            std::make_unique<xla::ifrt::HloProgram>(*mlir_module),
             std::make_unique<xla::ifrt::XlaCompileOptions>(compile_options)));
     StableHloCompileCounter()->AddValue(1);
 
@@ -513,6 +587,14 @@ IfrtComputationClient::ExecuteComputation(
   XLA_ERROR() << __FUNCTION__ << " not implemented";
 }
 
+std::vector<std::vector<ComputationClient::DataPtr>>
+IfrtComputationClient::ExecuteChained(
+    absl::Span<const ChainedComputation> computations,
+    const std::string& device, const ExecuteChainedOptions& options) {
+  // TODO: Implement chained exec in IFRT
+  XLA_ERROR() << __FUNCTION__ << " not implemented";
+}
+
 std::vector<ComputationClient::DataPtr>
 IfrtComputationClient::ExecuteReplicated(
     const ComputationClient::Computation& computation,
@@ -525,29 +607,25 @@ IfrtComputationClient::ExecuteReplicated(
   // complete; a copy is held from the lambda that releases it when done.
   auto timed =
       std::make_shared<metrics::TimedSection>(ExecuteReplicatedMetric());
-  tsl::profiler::TraceMe activity("IfrtComputationClient::ExecuteReplicated",
-                                  tsl::profiler::TraceMeLevel::kInfo);
+  tsl::profiler::TraceMe activity(
+      [&] {
+        return tsl::profiler::TraceMeEncode(
+            "IfrtComputationClient::ExecuteReplicated",
+            {{"graph_hash", options.graph_hash},
+             {"step", options.step_id},
+             {"devices", devices.size()}});
+      },
+      tsl::profiler::TraceMeLevel::kInfo);
   const IfrtComputation& ifrt_computation =
       dynamic_cast<const IfrtComputation&>(computation);
 
-  std::vector<tsl::RCReference<xla::ifrt::Array>> argument_handles(
-      arguments.size());
-  {
-    absl::BlockingCounter counter(arguments.size());
-
-    // Cost to handle one input argument. See tsl::ThreadPool::ParallelFor
-    // documentation
-    static const int32_t argument_handle_cost_ns = 1000;
-    pool_.ParallelFor(arguments.size(), argument_handle_cost_ns,
-                      [&](int64_t start, int64_t end) {
-                        for (int32_t i = start; i < end; ++i) {
-                          auto ifrt_data =
-                              std::dynamic_pointer_cast<IfrtData>(arguments[i]);
-                          argument_handles[i] = ifrt_data->buffer;
-                          counter.DecrementCount();
-                        }
-                      });
-    counter.Wait();
+  // Collecting the array of each argument is a pointer copy, which is cheaper
+  // done inline than fanned out to the pool.
+  std::vector<tsl::RCReference<xla::ifrt::Array>> argument_handles;
+  argument_handles.reserve(arguments.size());
+  for (const ComputationClient::DataPtr& argument : arguments) {
+    argument_handles.push_back(
+        dynamic_cast<const IfrtData*>(argument.get())->buffer);
   }
 
   xla::ExecuteOptions execute_options;
@@ -587,20 +665,16 @@ IfrtComputationClient::ExecuteReplicated(
 
   std::vector<ComputationClient::DataPtr> data_handles(outputs.size());
   {
-    absl::BlockingCounter counter(outputs.size());
-
     // Cost to handle one output. See tsl::ThreadPool::ParallelFor
-    // documentation.
+    // documentation. ParallelFor returns once all the ranges are done.
     static const int32_t result_handle_cost_ns = 2000;
     pool_.ParallelFor(outputs.size(), result_handle_cost_ns,
                       [&](int64_t start, int64_t end) {
                         for (int32_t i = start; i < end; ++i) {
                           data_handles[i] = std::make_shared<IfrtData>(
                               spmd_device_str, outputs[i], output_shardings[i]);
-                          counter.DecrementCount();
                         }
                       });
-    counter.Wait();
   }
 
   TF_VLOG(1) << "Returning " << data_handles.size() << " sharded outputs.";
@@ -615,6 +689,34 @@ std::string IfrtComputationClient::GetDefaultDevice() const {
   return IfrtDeviceToString(client_->addressable_devices()[0]);
 }
 
+torch::lazy::hash_t IfrtComputationClient::HashCompilationEnv() {
+  return comp_env_hash_.Get([this](hash::EnvComponents* components) {
+    return ComputeEnvHash(components);
+  });
+}
+
+std::map<std::string, std::string>
+IfrtComputationClient::GetCompilationEnvComponents() {
+  return comp_env_hash_.GetComponents(
+      [this](hash::EnvComponents* components) {
+        return ComputeEnvHash(components);
+      });
+}
+
+void IfrtComputationClient::InvalidateCompilationEnvHash() {
+  comp_env_hash_.Invalidate();
+}
+
+torch::lazy::hash_t IfrtComputationClient::ComputeEnvHash(
+    hash::EnvComponents* components) {
+  std::vector<xla::ifrt::Device*> ordered_devices(client_->device_count());
+  std::partial_sort_copy(
+      client_->devices().begin(), client_->devices().end(),
+      ordered_devices.begin(), ordered_devices.end(),
+      [](auto& a, auto& b) { return a->Id().value() < b->Id().value(); });
+  return hash_comp_env(client_.get(), ordered_devices, components);
+}
+
 std::vector<std::string> IfrtComputationClient::GetLocalDevices() const {
   return IfrtDevicesToString(client_->addressable_devices());
 }
@@ -668,5 +770,12 @@ std::map<std::string, Metric> IfrtComputationClient::GetMetrics() const {
   return {};
 }
 
+ComputationClient::OperationStats IfrtComputationClient::GetOperationStats(
+    const std::string& device) {
+  OperationManager::Stats stats = operation_manager_.GetStats(device);
+  return {stats.inflight, stats.high_water_mark, stats.blocked_ns,
+          stats.rejected};
+}
+
 }  // namespace runtime
 }  // namespace torch_xla
@@ -10,6 +10,7 @@
 #include "absl/types/span.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/env_hash.h"
 #include "torch_xla/csrc/runtime/operation_manager.h"
 #include "torch_xla/csrc/runtime/util.h"
 #include "xla/client/xla_computation.h"
@@ -32,7 +33,8 @@ class IfrtComputationClient : public ComputationClient {
 
   DataPtr CreateDataPlaceholder(
       std::string device, xla::Shape shape,
-      std::optional<xla::OpSharding> sharding = std::nullopt) override;
+      std::optional<xla::OpSharding> sharding = std::nullopt,
+      MemoryKind memory_kind = MemoryKind::kDevice) override;
 
   std::vector<DataPtr> GetDataShards(DataPtr data) override;
 
@@ -55,6 +57,20 @@ class IfrtComputationClient : public ComputationClient {
   std::vector<xla::Literal> TransferFromDevice(
       absl::Span<const DataPtr> handles) override;
 
+  std::vector<xla::PjRtFuture<>> TransferFromDeviceAsync(
+      absl::Span<const DataPtr> handles,
+      const TransferDestinationFn& destination_fn) override {
+    XLA_ERROR() << __FUNCTION__ << " not implemented";
+  }
+
+  std::vector<xla::PjRtFuture<>> GetReadyFutures(
+      absl::Span<const DataPtr> handles) override {
+    // Readiness is not tracked, callers only get to wait for the dispatch.
+    return {};
+  }
+
+  HostBufferPool* GetHostBufferPool() override { return nullptr; }
+
   std::uintptr_t UnsafeBufferPointer(const DataPtr handle) override;
 
   std::shared_ptr<xla::PjRtBuffer> GetPjRtBuffer(const DataPtr handle) override;
@@ -65,6 +81,10 @@ class IfrtComputationClient : public ComputationClient {
 
   DataPtr CopyToDevice(DataPtr data, std::string dst) override;
 
+  DataPtr CopyToMemoryKind(DataPtr data, MemoryKind memory_kind) override {
+    XLA_ERROR() << __FUNCTION__ << " not implemented";
+  }
+
   std::vector<ComputationPtr> Compile(
       std::vector<CompileInstance> instances) override;
 
@@ -78,6 +98,11 @@ class IfrtComputationClient : public ComputationClient {
       absl::Span<const std::string> devices,
       const ExecuteReplicatedOptions& options) override;
 
+  std::vector<std::vector<DataPtr>> ExecuteChained(
+      absl::Span<const ChainedComputation> computations,
+      const std::string& device,
+      const ExecuteChainedOptions& options) override;
+
   size_t GetNumDevices() const override;
 
   std::string GetDefaultDevice() const override;
@@ -129,14 +154,19 @@ class IfrtComputationClient : public ComputationClient {
 
   bool CoordinatorInitialized() const override;
 
-  torch::lazy::hash_t HashCompilationEnv() override { return comp_env_hash_; }
+  torch::lazy::hash_t HashCompilationEnv() override;
+
+  std::map<std::string, std::string> GetCompilationEnvComponents() override;
+
+  void InvalidateCompilationEnvHash() override;
+
+  OperationStats GetOperationStats(const std::string& device) override;
 
   // NOT IMPLEMENTED
 
   MemoryInfo GetMemoryInfo(const std::string& device) override {
     XLA_ERROR() << __FUNCTION__ << " not implemented";
   };
-
   std::string PjRtDeviceToString(xla::PjRtDevice* const device) const override {
     XLA_ERROR() << __FUNCTION__ << " not implemented";
   }
@@ -161,7 +191,7 @@ class IfrtComputationClient : public ComputationClient {
   OperationManager operation_manager_;
   tsl::thread::ThreadPool pool_ = tsl::thread::ThreadPool(
       tsl::Env::Default(), "ifrt", std::thread::hardware_concurrency());
-  torch::lazy::hash_t comp_env_hash_;
+  hash::CachedEnvHash comp_env_hash_;
 
   xla::ifrt::Device* StringToIfrtDevice(const std::string& device);
 
@@ -169,6 +199,10 @@ class IfrtComputationClient : public ComputationClient {
   std::vector<std::string> IfrtDevicesToString(
       absl::Span<xla::ifrt::Device* const> devices) const;
 
+  // Hashes the compilation environment, adding the values hashed to
+  // `components`.
+  torch::lazy::hash_t ComputeEnvHash(hash::EnvComponents* components);
+
   struct IfrtData : public Data {
     IfrtData(std::string device, xla::Shape device_shape)
         : Data(std::move(device), std::move(device_shape)) {}
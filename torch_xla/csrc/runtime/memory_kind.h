@@ -0,0 +1,44 @@
+#ifndef XLA_CLIENT_MEMORY_KIND_H_
+#define XLA_CLIENT_MEMORY_KIND_H_
+
+#include <string_view>
+
+#include "torch_xla/csrc/runtime/debug_macros.h"
+
+namespace torch_xla {
+namespace runtime {
+
+// The memory a buffer is placed in.
+enum class MemoryKind {
+  // The memory of the device, the default.
+  kDevice = 0,
+  // Host memory pinned for the device, in which large and rarely used state
+  // (eg. the optimizer state) can be offloaded and streamed in when needed.
+  kPinnedHost = 1,
+};
+
+// The PJRT name of the memory kind.
+inline const char* MemoryKindToString(MemoryKind kind) {
+  switch (kind) {
+    case MemoryKind::kDevice:
+      return "device";
+    case MemoryKind::kPinnedHost:
+      return "pinned_host";
+  }
+  XLA_ERROR() << "Invalid memory kind: " << static_cast<int>(kind);
+}
+
+inline MemoryKind MemoryKindFromString(std::string_view kind) {
+  if (kind == "device") {
+    return MemoryKind::kDevice;
+  }
+  if (kind == "pinned_host") {
+    return MemoryKind::kPinnedHost;
+  }
+  XLA_ERROR() << "Invalid memory kind: " << kind;
+}
+
+}  // namespace runtime
+}  // namespace torch_xla
+
+#endif  // XLA_CLIENT_MEMORY_KIND_H_
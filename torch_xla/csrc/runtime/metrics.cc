@@ -1,7 +1,10 @@
 #include "torch_xla/csrc/runtime/metrics.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <cmath>
+#include <numeric>
 #include <sstream>
 
 #include "absl/memory/memory.h"
@@ -30,11 +33,35 @@ const std::vector<double>* ReadEnvPercentiles() {
   return metrics_percentiles.release();
 }
 
+// The histogram bucket of `value`, the first whose bound is not smaller.
+size_t GetBucketIndex(double value) {
+  if (!(value > 1.0)) {
+    return 0;
+  }
+  if (std::isinf(value)) {
+    return MetricData::kNumBuckets - 1;
+  }
+  int exponent = 0;
+  // value = mantissa * 2^exponent, with mantissa in [0.5, 1).
+  double mantissa = std::frexp(value, &exponent);
+  size_t index = mantissa == 0.5 ? exponent - 1 : exponent;
+  return std::min(index, MetricData::kNumBuckets - 1);
+}
+
 const std::vector<double>& GetPercentiles() {
   static const std::vector<double>* metrics_percentiles = ReadEnvPercentiles();
   return *metrics_percentiles;
 }
 
+// Whether the metric `name` has a LogLinearHistogram of its samples.
+bool HasLogLinearHistogram(const std::string& name) {
+  static const std::vector<std::string>* names =
+      new std::vector<std::string>(absl::StrSplit(
+          sys_util::GetEnvString("XLA_METRICS_HISTOGRAMS", ""), ',',
+          absl::SkipEmpty()));
+  return std::find(names->begin(), names->end(), name) != names->end();
+}
+
 void EmitMetricInfo(const std::string& name, MetricData* data,
                     std::stringstream* ss) {
   double accumulator = 0.0;
@@ -74,6 +101,23 @@ void EmitMetricInfo(const std::string& name, MetricData* data,
           << "%=" << data->Repr(samples[index].value);
   }
   (*ss) << std::endl;
+  if (const LogLinearHistogram* histogram = data->Histogram()) {
+    std::vector<double> percentiles = metrics_percentiles;
+    if (std::find(percentiles.begin(), percentiles.end(), 0.999) ==
+        percentiles.end()) {
+      percentiles.push_back(0.999);
+    }
+    std::vector<double> values =
+        LogLinearHistogram::Percentiles(histogram->Counts(), percentiles);
+    (*ss) << "  AllPercentiles: ";
+    for (size_t i = 0; i < percentiles.size(); ++i) {
+      if (i > 0) {
+        (*ss) << "; ";
+      }
+      (*ss) << (percentiles[i] * 100.0) << "%=" << data->Repr(values[i]);
+    }
+    (*ss) << std::endl;
+  }
 }
 
 void EmitCounterInfo(const std::string& name, CounterData* data,
@@ -95,7 +139,8 @@ void MetricsArena::RegisterMetric(const std::string& name, MetricReprFn repr_fn,
   std::lock_guard<std::mutex> lock(lock_);
   if (*data == nullptr) {
     *data = torch_xla::runtime::util::MapInsert(&metrics_, name, [&]() {
-      return std::make_shared<MetricData>(std::move(repr_fn), max_samples);
+      return std::make_shared<MetricData>(std::move(repr_fn), max_samples,
+                                          HasLogLinearHistogram(name));
     });
   }
 }
@@ -174,51 +219,179 @@ void MetricsArena::ClearMetrics() {
   }
 }
 
-MetricData::MetricData(MetricReprFn repr_fn, size_t max_samples)
-    : repr_fn_(std::move(repr_fn)), samples_(max_samples) {}
+LogLinearHistogram::LogLinearHistogram()
+    : counts_(new std::atomic<int64_t>[kNumBuckets]) {
+  Clear();
+}
+
+size_t LogLinearHistogram::BucketIndex(double value) {
+  if (!(value > 1.0)) {
+    return 0;
+  }
+  if (std::isinf(value)) {
+    return kNumBuckets - 1;
+  }
+  int exponent = 0;
+  // value = mantissa * 2^exponent, with mantissa in [0.5, 1).
+  double mantissa = std::frexp(value, &exponent);
+  size_t sub_bucket = (2.0 * mantissa - 1.0) * kSubBuckets;
+  size_t index = 1 + (exponent - 1) * kSubBuckets + sub_bucket;
+  return std::min(index, kNumBuckets - 1);
+}
+
+double LogLinearHistogram::BucketValue(size_t index) {
+  if (index == 0) {
+    return 0.0;
+  }
+  size_t exponent = (index - 1) / kSubBuckets;
+  size_t sub_bucket = (index - 1) % kSubBuckets;
+  return std::ldexp(1.0 + (sub_bucket + 0.5) / kSubBuckets, exponent);
+}
+
+void LogLinearHistogram::Add(double value) {
+  counts_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<int64_t> LogLinearHistogram::Counts() const {
+  std::vector<int64_t> counts(kNumBuckets);
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    counts[i] = counts_[i].load(std::memory_order_relaxed);
+  }
+  return counts;
+}
+
+void LogLinearHistogram::Clear() {
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+std::vector<double> LogLinearHistogram::Percentiles(
+    const std::vector<int64_t>& counts,
+    const std::vector<double>& percentiles) {
+  int64_t total = std::accumulate(counts.begin(), counts.end(), int64_t{0});
+  std::vector<double> values;
+  for (double percentile : percentiles) {
+    // The rank of the value of the percentile, from 1.
+    int64_t rank = std::max<int64_t>(std::ceil(percentile * total), 1);
+    int64_t count = 0;
+    size_t index = 0;
+    while (index + 1 < counts.size() && count + counts[index] < rank) {
+      count += counts[index];
+      ++index;
+    }
+    values.push_back(total > 0 ? BucketValue(index) : 0.0);
+  }
+  return values;
+}
+
+MetricData::MetricData(MetricReprFn repr_fn, size_t max_samples,
+                       bool log_linear_histogram)
+    : repr_fn_(std::move(repr_fn)),
+      max_samples_(max_samples),
+      histogram_(log_linear_histogram ? std::make_unique<LogLinearHistogram>()
+                                      : nullptr) {}
+
+MetricData::Shard& MetricData::GetShard() {
+  static std::atomic<size_t> next_shard(0);
+  static thread_local size_t shard = next_shard++ % kNumShards;
+  return shards_[shard];
+}
+
+double MetricData::BucketBound(size_t i) { return std::ldexp(1.0, i); }
 
 void MetricData::AddSample(int64_t timestamp_ns, double value) {
-  std::lock_guard<std::mutex> lock(lock_);
-  size_t position = count_ % samples_.size();
-  ++count_;
-  accumulator_ += value;
-  samples_[position] = Sample(timestamp_ns, value);
+  if (histogram_ != nullptr) {
+    histogram_->Add(value);
+  }
+  Shard& shard = GetShard();
+  std::lock_guard<std::mutex> lock(shard.lock);
+  if (shard.samples.empty()) {
+    shard.samples.resize(max_samples_);
+  }
+  size_t position = shard.count % shard.samples.size();
+  ++shard.count;
+  shard.accumulator += value;
+  shard.samples[position] = Sample(timestamp_ns, value);
+  shard.buckets[GetBucketIndex(value)] += 1;
+}
+
+std::array<int64_t, MetricData::kNumBuckets> MetricData::BucketCounts() const {
+  std::array<int64_t, kNumBuckets> counts = {};
+  for (Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      counts[i] += shard.buckets[i];
+    }
+  }
+  return counts;
 }
 
 double MetricData::Accumulator() const {
-  std::lock_guard<std::mutex> lock(lock_);
-  return accumulator_;
+  double accumulator = 0.0;
+  for (Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    accumulator += shard.accumulator;
+  }
+  return accumulator;
 }
 
 size_t MetricData::TotalSamples() const {
-  std::lock_guard<std::mutex> lock(lock_);
-  return count_;
+  size_t count = 0;
+  for (Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    count += shard.count;
+  }
+  return count;
 }
 
 void MetricData::Clear() {
-  std::lock_guard<std::mutex> lock(lock_);
-  count_ = 0;
-  accumulator_ = 0.0;
-  samples_ = std::vector<Sample>(samples_.size());
+  if (histogram_ != nullptr) {
+    histogram_->Clear();
+  }
+  for (Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    shard.count = 0;
+    shard.accumulator = 0.0;
+    shard.buckets.fill(0);
+    shard.samples.clear();
+  }
 }
 
 std::vector<Sample> MetricData::Samples(double* accumulator,
                                         size_t* total_samples) const {
-  std::lock_guard<std::mutex> lock(lock_);
   std::vector<Sample> samples;
-  if (count_ <= samples_.size()) {
-    samples.insert(samples.end(), samples_.begin(), samples_.begin() + count_);
-  } else {
-    size_t position = count_ % samples_.size();
-    samples.insert(samples.end(), samples_.begin() + position, samples_.end());
-    samples.insert(samples.end(), samples_.begin(),
-                   samples_.begin() + position);
+  double total_accumulator = 0.0;
+  size_t count = 0;
+  for (Shard& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    if (shard.count <= shard.samples.size()) {
+      samples.insert(samples.end(), shard.samples.begin(),
+                     shard.samples.begin() + shard.count);
+    } else {
+      size_t position = shard.count % shard.samples.size();
+      samples.insert(samples.end(), shard.samples.begin() + position,
+                     shard.samples.end());
+      samples.insert(samples.end(), shard.samples.begin(),
+                     shard.samples.begin() + position);
+    }
+    total_accumulator += shard.accumulator;
+    count += shard.count;
+  }
+  // The samples of each shard are in order, and the newest max_samples_ of all
+  // are among the newest max_samples_ of their shards.
+  std::stable_sort(samples.begin(), samples.end(),
+                   [](const Sample& s1, const Sample& s2) {
+                     return s1.timestamp_ns < s2.timestamp_ns;
+                   });
+  if (samples.size() > max_samples_) {
+    samples.erase(samples.begin(), samples.end() - max_samples_);
   }
   if (accumulator != nullptr) {
-    *accumulator = accumulator_;
+    *accumulator = total_accumulator;
   }
   if (total_samples != nullptr) {
-    *total_samples = count_;
+    *total_samples = count;
   }
   return samples;
 }
@@ -301,6 +474,10 @@ std::string MetricFnBytes(double value) {
   return ss.str();
 }
 
+std::string MetricFnBandwidth(double value) {
+  return MetricFnBytes(value) + "/s";
+}
+
 std::string MetricFnTime(double value) {
   static struct TimePart {
     const char* suffix;
@@ -346,6 +523,85 @@ std::string CreateMetricReport() {
   return ss.str();
 }
 
+std::string OpenMetricsName(const std::string& name) {
+  std::string result = name;
+  for (char& c : result) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+      c = '_';
+    }
+  }
+  return result;
+}
+
+void EmitOpenMetricsCounter(const std::string& name, int64_t value,
+                            std::stringstream* ss) {
+  (*ss) << "# TYPE " << name << " counter\n";
+  (*ss) << name << "_total " << value << "\n";
+}
+
+void EmitOpenMetricsSummary(const std::string& name,
+                            const std::vector<Sample>& samples,
+                            double accumulator, size_t total_samples,
+                            std::stringstream* ss) {
+  std::vector<double> values;
+  values.reserve(samples.size());
+  for (const Sample& sample : samples) {
+    values.push_back(sample.value);
+  }
+  std::sort(values.begin(), values.end());
+  (*ss) << "# TYPE " << name << " summary\n";
+  if (!values.empty()) {
+    for (double percentile : GetPercentiles()) {
+      size_t index = percentile * values.size();
+      // Labels with the shortest representation of the percentiles.
+      (*ss) << name << "{quantile=\"" << absl::StrCat(percentile) << "\"} "
+            << values[index] << "\n";
+    }
+  }
+  (*ss) << name << "_sum " << accumulator << "\n";
+  (*ss) << name << "_count " << total_samples << "\n";
+}
+
+std::string CreateOpenMetricsReport(const std::string& prefix) {
+  MetricsArena* arena = MetricsArena::Get();
+  std::stringstream ss;
+  ss.precision(17);
+  arena->ForEachMetric([&](const std::string& name, MetricData* data) {
+    double accumulator = 0.0;
+    size_t total_samples = 0;
+    std::vector<Sample> samples = data->Samples(&accumulator, &total_samples);
+    if (total_samples == 0) {
+      return;
+    }
+    std::string metric_name = prefix + OpenMetricsName(name);
+    std::array<int64_t, MetricData::kNumBuckets> counts = data->BucketCounts();
+    size_t last_bucket = MetricData::kNumBuckets - 1;
+    while (last_bucket > 0 && counts[last_bucket] == 0) {
+      --last_bucket;
+    }
+    ss << "# TYPE " << metric_name << " histogram\n";
+    int64_t count = 0;
+    for (size_t i = 0; i <= last_bucket && i + 1 < MetricData::kNumBuckets;
+         ++i) {
+      count += counts[i];
+      ss << metric_name << "_bucket{le=\"" << MetricData::BucketBound(i)
+         << "\"} " << count << "\n";
+    }
+    // The bucket counts are read apart from the samples, so the total of the
+    // histogram is theirs.
+    count = std::accumulate(counts.begin(), counts.end(), int64_t{0});
+    ss << metric_name << "_bucket{le=\"+Inf\"} " << count << "\n";
+    ss << metric_name << "_sum " << accumulator << "\n";
+    ss << metric_name << "_count " << count << "\n";
+    EmitOpenMetricsSummary(metric_name + "_recent", samples, accumulator,
+                           total_samples, &ss);
+  });
+  arena->ForEachCounter([&](const std::string& name, CounterData* data) {
+    EmitOpenMetricsCounter(prefix + OpenMetricsName(name), data->Value(), &ss);
+  });
+  return ss.str();
+}
+
 std::string CreateMetricReport(const std::vector<std::string>& counter_names,
                                const std::vector<std::string>& metric_names) {
   MetricsArena* arena = MetricsArena::Get();
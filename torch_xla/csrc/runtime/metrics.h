@@ -1,10 +1,12 @@
 #ifndef XLA_CLIENT_METRICS_H_
 #define XLA_CLIENT_METRICS_H_
 
+#include <array>
 #include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -27,14 +29,64 @@ struct Sample {
 
 using MetricReprFn = std::function<std::string(double)>;
 
+// Fixed memory histogram of all the values posted to it, with buckets split
+// linearly within each power of two: the values between 2^e and 2^(e+1) fall in
+// one of kSubBuckets buckets of equal width, so that the values read back are
+// within 1/(2*kSubBuckets) of the posted ones. The increments are lock-free, so
+// that any thread can post values without contending with the others.
+class LogLinearHistogram {
+ public:
+  static constexpr size_t kSubBuckets = 32;
+  // Values up to 1 share the first bucket.
+  static constexpr size_t kNumBuckets = 1 + 64 * kSubBuckets;
+
+  LogLinearHistogram();
+
+  void Add(double value);
+
+  // Returns the count of the values posted to each bucket. The counts of an
+  // interval are the difference of the counts returned at its boundaries.
+  std::vector<int64_t> Counts() const;
+
+  void Clear();
+
+  // Returns the value of each percentile in `percentiles`, in [0, 1], of the
+  // values of the bucket `counts`.
+  static std::vector<double> Percentiles(
+      const std::vector<int64_t>& counts,
+      const std::vector<double>& percentiles);
+
+ private:
+  static size_t BucketIndex(double value);
+
+  // The middle of the values of the bucket `index`.
+  static double BucketValue(size_t index);
+
+  std::unique_ptr<std::atomic<int64_t>[]> counts_;
+};
+
 // Class used to collect time-stamped numeric samples. The samples are stored in
-// a circular buffer whose size can be configured at constructor time.
+// a circular buffer whose size can be configured at constructor time. Each
+// thread records its samples in one of a few shards, each with its own lock and
+// circular buffer, so that the threads posting samples concurrently do not
+// contend. The shards are merged when the samples are read.
 class MetricData {
  public:
+  // The number of histogram buckets counting all the samples posted to the
+  // metric. The i-th bucket counts the samples not greater than BucketBound(i)
+  // and greater than the bound of the previous bucket, the last one all the
+  // greater samples.
+  static constexpr size_t kNumBuckets = 64;
+
+  // Returns 2^i.
+  static double BucketBound(size_t i);
+
   // Creates a new MetricData object with the internal circular buffer storing
   // max_samples samples. The repr_fn argument allow to specify a function which
-  // pretty-prints a sample value.
-  MetricData(MetricReprFn repr_fn, size_t max_samples);
+  // pretty-prints a sample value. With log_linear_histogram, all the samples
+  // are also posted to a LogLinearHistogram.
+  MetricData(MetricReprFn repr_fn, size_t max_samples,
+             bool log_linear_histogram = false);
 
   // Returns the total values of all the samples being posted to this metric.
   double Accumulator() const;
@@ -49,16 +101,38 @@ class MetricData {
   // is not nullptr, it will receive the count of the posted values.
   std::vector<Sample> Samples(double* accumulator, size_t* total_samples) const;
 
+  // Returns the count of all the samples posted to this metric in each of the
+  // histogram buckets.
+  std::array<int64_t, kNumBuckets> BucketCounts() const;
+
+  // Returns the LogLinearHistogram of all the samples, or nullptr if the
+  // metric has none.
+  const LogLinearHistogram* Histogram() const { return histogram_.get(); }
+
   std::string Repr(double value) const { return repr_fn_(value); }
 
   void Clear();
 
  private:
-  mutable std::mutex lock_;
+  static constexpr size_t kNumShards = 16;
+
+  // Aligned to keep the shards of different threads off the same cache line.
+  struct alignas(64) Shard {
+    std::mutex lock;
+    size_t count = 0;
+    double accumulator = 0.0;
+    std::array<int64_t, kNumBuckets> buckets = {};
+    // Allocated with the first sample, as most metrics are only posted to by
+    // a few threads.
+    std::vector<Sample> samples;
+  };
+
+  Shard& GetShard();
+
   MetricReprFn repr_fn_;
-  size_t count_ = 0;
-  std::vector<Sample> samples_;
-  double accumulator_ = 0.0;
+  size_t max_samples_;
+  mutable std::array<Shard, kNumShards> shards_;
+  std::unique_ptr<LogLinearHistogram> histogram_;
 };
 
 // Counters are a very lightweight form of metrics which do not need to track
@@ -116,6 +190,9 @@ class MetricsArena {
 std::string MetricFnValue(double value);
 // Emits the value in a humanized bytes representation.
 std::string MetricFnBytes(double value);
+// Emits the value, in bytes per second, in a humanized bandwidth
+// representation.
+std::string MetricFnBandwidth(double value);
 // Emits the value in a humanized time representation. The value is expressed in
 // nanoseconds EPOCH time.
 std::string MetricFnTime(double value);
@@ -205,6 +282,29 @@ std::string CreateMetricReport();
 std::string CreateMetricReport(const std::vector<std::string>& counter_names,
                                const std::vector<std::string>& metric_names);
 
+// Creates a report with the current metrics and counters in the OpenMetrics
+// text format, without its final "# EOF" line, so that reports can be joined.
+// The names are prefixed with `prefix`. The metrics are exported as histograms
+// of all their samples, and as "<name>_recent" summaries of the percentiles of
+// their recent samples.
+std::string CreateOpenMetricsReport(const std::string& prefix);
+
+// Emits the counter `name` in the OpenMetrics text format.
+void EmitOpenMetricsCounter(const std::string& name, int64_t value,
+                            std::stringstream* ss);
+
+// Emits the summary `name` of the percentiles of `samples`, out of the
+// `total_samples` posted ones summing to `accumulator`, in the OpenMetrics text
+// format.
+void EmitOpenMetricsSummary(const std::string& name,
+                            const std::vector<Sample>& samples,
+                            double accumulator, size_t total_samples,
+                            std::stringstream* ss);
+
+// Returns `name` with the characters not allowed in OpenMetrics names replaced
+// by underscores.
+std::string OpenMetricsName(const std::string& name);
+
 // Returns the currently registered metric names. Note that the list can grow
 // since metrics are usualy function intialized (they are static function
 // variables).
@@ -1,6 +1,9 @@
 #include "torch_xla/csrc/runtime/metrics_analysis.h"
 
+#include <algorithm>
+
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/variant.h"
 #include "torch_xla/csrc/runtime/metrics.h"
@@ -166,7 +169,7 @@ class UnloweredOp : public Analyzer {
     std::stringstream ss;
     MetricsArena* arena = MetricsArena::Get();
     arena->ForEachCounter([&ss](const std::string& name, CounterData* data) {
-      if (absl::StrContains(name, "aten::") &&
+      if (absl::StartsWith(name, "aten::") &&
           name != "aten::_local_scalar_dense") {
         ss << name << ", ";
       }
@@ -183,13 +186,316 @@ class UnloweredOp : public Analyzer {
   }
 };
 
+// Reports the devices whose shards of the replicated executions are often
+// ready last, well after the shards of the other devices.
+class ShardStraggler : public Analyzer {
+ public:
+  explicit ShardStraggler(float frequency_threshold)
+      : frequency_threshold_(frequency_threshold) {}
+
+  Analysis Run() override {
+    static const std::string kStragglerPrefix = "ExecuteReplicatedStraggler.";
+    MetricData* skew = GetMetric("ExecuteReplicatedShardSkew");
+    if (!skew) {
+      return {Analysis::Symptom::kNormal};
+    }
+    double total_skew = 0;
+    size_t executions = 0;
+    skew->Samples(&total_skew, &executions);
+    std::stringstream ss;
+    int64_t stragglers = 0;
+    MetricsArena* arena = MetricsArena::Get();
+    arena->ForEachCounter([&](const std::string& name, CounterData* data) {
+      if (absl::StartsWith(name, kStragglerPrefix) && data->Value() > 0) {
+        ss << name.substr(kStragglerPrefix.size()) << " (" << data->Value()
+           << " times), ";
+        stragglers += data->Value();
+      }
+    });
+    if (executions == 0 ||
+        stragglers <= frequency_threshold_ * static_cast<float>(executions)) {
+      return {Analysis::Symptom::kNormal};
+    }
+    return {
+        Analysis::Symptom::kShardStraggler,
+        absl::StrFormat("%s: Shards finish unevenly: mean skew of %s over %zu "
+                        "replicated executions. Slowest devices: %s",
+                        kAnalysisPrefix, MetricFnTime(total_skew / executions),
+                        executions, ss.str()),
+    };
+  }
+
+ private:
+  float frequency_threshold_;
+};
+
+// Reports the approximate bus bandwidth achieved by the executions of the
+// graphs with collectives, from the bytes their collectives move over the
+// interconnect and the execution times. A graph achieving a bus bandwidth close
+// to the one of the interconnect is bound by its collectives.
+class CollectiveBandwidth : public Analyzer {
+ public:
+  Analysis Run() override {
+    static const std::string kBandwidthPrefix =
+        "ExecuteCollectiveBusBandwidth.";
+    static const std::string kBytesPrefix = "CompiledCollectiveBytes.";
+    std::stringstream graphs;
+    std::stringstream bytes;
+    MetricsArena* arena = MetricsArena::Get();
+    arena->ForEachMetric([&](const std::string& name, MetricData* data) {
+      if (!absl::StartsWith(name, kBandwidthPrefix)) {
+        return;
+      }
+      double total_bandwidth = 0;
+      size_t executions = 0;
+      data->Samples(&total_bandwidth, &executions);
+      if (executions > 0) {
+        graphs << name.substr(kBandwidthPrefix.size()) << " ("
+               << MetricFnBandwidth(total_bandwidth / executions) << " over "
+               << executions << " executions), ";
+      }
+    });
+    arena->ForEachCounter([&](const std::string& name, CounterData* data) {
+      if (absl::StartsWith(name, kBytesPrefix) && data->Value() > 0) {
+        bytes << name.substr(kBytesPrefix.size()) << " ("
+              << MetricFnBytes(data->Value()) << "), ";
+      }
+    });
+    std::string repr = graphs.str();
+    if (repr.empty()) {
+      return {Analysis::Symptom::kNormal};
+    }
+    return {
+        Analysis::Symptom::kCollectiveBandwidth,
+        absl::StrFormat("%s: Mean bus bandwidth of the graphs with "
+                        "collectives: %sCompiled collective bytes: %s",
+                        kAnalysisPrefix, repr, bytes.str()),
+    };
+  }
+};
+
+// Reports the transfers from the devices happening in most steps, which
+// serialize the host with the device executions.
+class TransferFromDeviceFrequency : public Analyzer {
+ public:
+  explicit TransferFromDeviceFrequency(float frequency_threshold)
+      : frequency_threshold_(frequency_threshold) {}
+
+  Analysis Run() override {
+    CounterData* step = GetCounter("MarkStep");
+    MetricData* transfers = GetMetric("TransferFromDeviceTime");
+    if (!step || !transfers || step->Value() == 0) {
+      return {Analysis::Symptom::kNormal};
+    }
+    size_t transfer_count = transfers->TotalSamples();
+    int64_t step_count = step->Value();
+    if (transfer_count <= frequency_threshold_ * step_count) {
+      return {Analysis::Symptom::kNormal};
+    }
+    CounterData* item = GetCounter("aten::_local_scalar_dense");
+    return {
+        Analysis::Symptom::kMetricTooFrequent,
+        absl::StrFormat(
+            "%s: TransferFromDeviceTime too frequent: %zu counts during %zu "
+            "steps, %lld of them from reading tensors as Python scalars. "
+            "Each transfer waits for the pending executions: move the "
+            ".item(), print and Python control flow on tensors out of the "
+            "step, or accumulate the values on the device and read them "
+            "once every few steps.",
+            kAnalysisPrefix, transfer_count, step_count,
+            item ? static_cast<long long>(item->Value()) : 0LL),
+    };
+  }
+
+ private:
+  float frequency_threshold_;
+};
+
+// Reports the devices waiting on the host between their executions for a
+// large share of the recent time, from the spans the execution dispatcher
+// measures.
+class HostBound : public Analyzer {
+ public:
+  HostBound(float idle_threshold, long warmup_steps)
+      : idle_threshold_(idle_threshold), warmup_steps_(warmup_steps) {}
+
+  Analysis Run() override {
+    CounterData* step = GetCounter("MarkStep");
+    MetricData* idle = GetMetric("DeviceIdleTime");
+    MetricData* busy = GetMetric("DeviceBusyTime");
+    if (!step || !idle || !busy || step->Value() <= warmup_steps_) {
+      return {Analysis::Symptom::kNormal};
+    }
+    // The recent samples only, as the compilations of the first steps leave
+    // the devices idle too.
+    double idle_ns = 0;
+    std::vector<Sample> idle_samples = idle->Samples(nullptr, nullptr);
+    for (const Sample& sample : idle_samples) {
+      idle_ns += sample.value;
+    }
+    double busy_ns = 0;
+    for (const Sample& sample : busy->Samples(nullptr, nullptr)) {
+      busy_ns += sample.value;
+    }
+    if (idle_samples.empty() ||
+        idle_ns <= idle_threshold_ * (idle_ns + busy_ns)) {
+      return {Analysis::Symptom::kNormal};
+    }
+    return {
+        Analysis::Symptom::kHostBound,
+        absl::StrFormat(
+            "%s: Devices idle %.0f%% of the recent time, %s on average "
+            "between executions: the steps are host bound. Load the inputs "
+            "with MpDeviceLoader, avoid reading tensors in the step and "
+            "reduce the Python work between the steps.",
+            kAnalysisPrefix, 100 * idle_ns / (idle_ns + busy_ns),
+            MetricFnTime(idle_ns / idle_samples.size())),
+    };
+  }
+
+ private:
+  float idle_threshold_;
+  long warmup_steps_;
+};
+
+// Reports many host-device transfers per step moving few bytes each, which
+// cost a round trip each whatever their size.
+class SmallTransfers : public Analyzer {
+ public:
+  SmallTransfers(float frequency_threshold, double max_mean_bytes)
+      : frequency_threshold_(frequency_threshold),
+        max_mean_bytes_(max_mean_bytes) {}
+
+  Analysis Run() override {
+    CounterData* step = GetCounter("MarkStep");
+    if (!step || step->Value() == 0) {
+      return {Analysis::Symptom::kNormal};
+    }
+    double total_bytes = 0;
+    size_t transfers = 0;
+    for (const char* name : {"InboundData", "OutboundData"}) {
+      MetricData* metric = GetMetric(name);
+      if (metric) {
+        double bytes = 0;
+        size_t count = 0;
+        metric->Samples(&bytes, &count);
+        total_bytes += bytes;
+        transfers += count;
+      }
+    }
+    int64_t step_count = step->Value();
+    if (transfers <= frequency_threshold_ * step_count ||
+        total_bytes > max_mean_bytes_ * transfers) {
+      return {Analysis::Symptom::kNormal};
+    }
+    return {
+        Analysis::Symptom::kSmallTransfers,
+        absl::StrFormat(
+            "%s: Small transfers too frequent: %zu host-device transfers of "
+            "%s on average during %zu steps. Move the tensors of a step "
+            "together, eg. with a single xm.send_cpu_data_to_device call, "
+            "and create the constants and scalars on the device.",
+            kAnalysisPrefix, transfers, MetricFnBytes(total_bytes / transfers),
+            step_count),
+    };
+  }
+
+ private:
+  float frequency_threshold_;
+  double max_mean_bytes_;
+};
+
+// Reports the graphs compiled again after having been evicted from the
+// compilation cache, which is then too small for the graphs of the program.
+class CacheThrash : public Analyzer {
+ public:
+  Analysis Run() override {
+    CounterData* recompiles = GetCounter("UncachedRecompile");
+    if (!recompiles || recompiles->Value() == 0) {
+      return {Analysis::Symptom::kNormal};
+    }
+    return {
+        Analysis::Symptom::kCacheThrash,
+        absl::StrFormat(
+            "%s: Compilation cache thrashing: %lld compilations of graphs "
+            "evicted from the full cache. Increase XLA_COMPILATION_CACHE_SIZE, "
+            "or make the graphs of the program less dynamic.",
+            kAnalysisPrefix, static_cast<long long>(recompiles->Value())),
+    };
+  }
+};
+
+// Reports the operators falling back to the CPU which cost the most, from the
+// time spent in their fallbacks, the bytes they copied between the host and the
+// devices, and the graph breaks they caused.
+class CpuFallbackCost : public Analyzer {
+ public:
+  explicit CpuFallbackCost(size_t max_ops) : max_ops_(max_ops) {}
+
+  Analysis Run() override {
+    static const std::string kTimePrefix = "CpuFallbackTime.";
+    struct Cost {
+      std::string op;
+      double time_ns;
+      size_t calls;
+    };
+    std::vector<Cost> costs;
+    double total_ns = 0;
+    MetricsArena* arena = MetricsArena::Get();
+    arena->ForEachMetric([&](const std::string& name, MetricData* data) {
+      if (absl::StartsWith(name, kTimePrefix) && data->TotalSamples() > 0) {
+        costs.push_back({name.substr(kTimePrefix.size()), data->Accumulator(),
+                         data->TotalSamples()});
+        total_ns += data->Accumulator();
+      }
+    });
+    if (costs.empty()) {
+      return {Analysis::Symptom::kNormal};
+    }
+    std::sort(costs.begin(), costs.end(), [](const Cost& a, const Cost& b) {
+      return a.time_ns > b.time_ns;
+    });
+    std::stringstream ss;
+    for (size_t i = 0; i < std::min(costs.size(), max_ops_); ++i) {
+      const Cost& cost = costs[i];
+      CounterData* graph_breaks =
+          GetCounter(absl::StrCat("CpuFallbackGraphBreaks.", cost.op));
+      ss << absl::StrFormat(
+          "%s (%zu calls, %s, %s to host, %s to device, %lld graph breaks), ",
+          cost.op, cost.calls, MetricFnTime(cost.time_ns),
+          MetricFnBytes(MetricTotal("CpuFallbackToHostBytes.", cost.op)),
+          MetricFnBytes(MetricTotal("CpuFallbackToDeviceBytes.", cost.op)),
+          static_cast<long long>(graph_breaks ? graph_breaks->Value() : 0));
+    }
+    return {
+        Analysis::Symptom::kCpuFallbackCost,
+        absl::StrFormat("%s: CPU fallbacks took %s. Most expensive: %s",
+                        kAnalysisPrefix, MetricFnTime(total_ns), ss.str()),
+    };
+  }
+
+ private:
+  static double MetricTotal(const std::string& prefix, const std::string& op) {
+    MetricData* data = GetMetric(absl::StrCat(prefix, op));
+    return data ? data->Accumulator() : 0;
+  }
+
+  size_t max_ops_;
+};
+
 std::vector<Analyzer*>* GetAnalyzers() {
   static std::vector<Analyzer*>* analyzers = new std::vector<Analyzer*>{
       new MetricFrequency("CompileTime", 0.5f, 10),
-      new MetricFrequency("TransferFromDeviceTime", 0.5f),
+      new TransferFromDeviceFrequency(0.5f),
       new MetricTime("CompileTime", 300e9),
       new MetricTime("ExecuteTime", 30e9),
       new UnloweredOp(),
+      new CpuFallbackCost(5),
+      new ShardStraggler(0.1f),
+      new CollectiveBandwidth(),
+      new HostBound(0.3f, 10),
+      new SmallTransfers(16.0f, 64 * 1024),
+      new CacheThrash(),
       new XrtMetricFrequency({{"XrtTryFreeMemory", 0.1f},
                               {"XrtCompaction", 0.1f},
                               {"XrtExecutorEvict", 0.1f}},
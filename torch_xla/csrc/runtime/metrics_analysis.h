@@ -20,6 +20,12 @@ namespace metrics {
 // - Frequent XLA->CPU transfers
 // - Device HBM to host RAM swapping and HBM defragmentation
 // - Unlowered aten:: ops
+// - Costly CPU fallbacks, from their time, transfers and graph breaks
+// - Replicated executions straggling on some devices
+// - Graphs bound by their collectives, from the bus bandwidth they achieve
+// - Host bound steps, leaving the devices idle between executions
+// - Frequent small host-device transfers
+// - Graphs compiled again after their eviction from the compilation cache
 
 struct Analysis {
   enum class Symptom {
@@ -27,6 +33,12 @@ struct Analysis {
     kMetricTooFrequent,
     kMetricTooSlow,
     kUnloweredOp,
+    kShardStraggler,
+    kCollectiveBandwidth,
+    kHostBound,
+    kSmallTransfers,
+    kCacheThrash,
+    kCpuFallbackCost,
   };
 
   Analysis() = default;
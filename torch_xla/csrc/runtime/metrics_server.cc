@@ -0,0 +1,144 @@
+#include "torch_xla/csrc/runtime/metrics_server.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/tf_logging.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace metrics {
+namespace {
+
+// Requests are read up to the end of their headers, which scrapers keep short.
+constexpr size_t kMaxRequestBytes = 8192;
+
+// A stalled client only holds the serving thread up to this long.
+constexpr int kTimeoutSeconds = 5;
+
+void SendAll(int connection, const std::string& data) {
+  size_t offset = 0;
+  while (offset < data.size()) {
+    ssize_t sent = send(connection, data.data() + offset, data.size() - offset,
+                        MSG_NOSIGNAL);
+    if (sent <= 0) {
+      if (sent < 0 && errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    offset += sent;
+  }
+}
+
+std::string HttpResponse(const std::string& status,
+                         const std::string& content_type,
+                         const std::string& body) {
+  return absl::StrCat("HTTP/1.1 ", status, "\r\nContent-Type: ", content_type,
+                      "\r\nContent-Length: ", body.size(),
+                      "\r\nConnection: close\r\n\r\n", body);
+}
+
+}  // namespace
+
+MetricsServer::MetricsServer(std::function<std::string()> report_fn)
+    : report_fn_(std::move(report_fn)) {}
+
+MetricsServer::~MetricsServer() {
+  if (thread_ != nullptr) {
+    stopped_ = true;
+    // Wakes up the serving thread blocked in accept().
+    shutdown(socket_, SHUT_RDWR);
+    thread_->join();
+  }
+  if (socket_ >= 0) {
+    close(socket_);
+  }
+}
+
+void MetricsServer::Start(int port) {
+  XLA_CHECK(thread_ == nullptr) << "The metrics server is already started";
+  socket_ = socket(AF_INET6, SOCK_STREAM, 0);
+  XLA_CHECK_GE(socket_, 0) << "Failed to create the metrics server socket: "
+                           << std::strerror(errno);
+  int enable = 1;
+  setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  // Accept IPv4 connections too.
+  int disable = 0;
+  setsockopt(socket_, IPPROTO_IPV6, IPV6_V6ONLY, &disable, sizeof(disable));
+  sockaddr_in6 address = {};
+  address.sin6_family = AF_INET6;
+  address.sin6_addr = in6addr_any;
+  address.sin6_port = htons(port);
+  XLA_CHECK_EQ(
+      bind(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0)
+      << "Failed to bind the metrics server to port " << port << ": "
+      << std::strerror(errno);
+  XLA_CHECK_EQ(listen(socket_, SOMAXCONN), 0)
+      << "Failed to listen on port " << port << ": " << std::strerror(errno);
+  thread_ = std::make_unique<std::thread>([this]() { Serve(); });
+  TF_VLOG(1) << "Serving metrics on port " << port;
+}
+
+void MetricsServer::Serve() {
+  while (!stopped_) {
+    int connection = accept(socket_, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno != EINTR && !stopped_) {
+        TF_LOG(WARNING) << "Metrics server accept failed: "
+                        << std::strerror(errno);
+      }
+      continue;
+    }
+    Respond(connection);
+    close(connection);
+  }
+}
+
+void MetricsServer::Respond(int connection) {
+  timeval timeout = {};
+  timeout.tv_sec = kTimeoutSeconds;
+  setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  std::string request;
+  char buffer[1024];
+  while (request.size() < kMaxRequestBytes &&
+         request.find("\r\n\r\n") == std::string::npos) {
+    ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+    if (received <= 0) {
+      if (received < 0 && errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    request.append(buffer, received);
+  }
+  if (!absl::StartsWith(request, "GET ")) {
+    SendAll(connection, HttpResponse("405 Method Not Allowed", "text/plain",
+                                     "Only GET is supported\n"));
+    return;
+  }
+  std::string path = request.substr(4, request.find(' ', 4) - 4);
+  if (path != "/metrics" && !absl::StartsWith(path, "/metrics?")) {
+    SendAll(connection,
+            HttpResponse("404 Not Found", "text/plain", "Not found\n"));
+    return;
+  }
+  SendAll(connection,
+          HttpResponse("200 OK",
+                       "application/openmetrics-text; version=1.0.0; "
+                       "charset=utf-8",
+                       report_fn_()));
+}
+
+}  // namespace metrics
+}  // namespace runtime
+}  // namespace torch_xla
@@ -0,0 +1,43 @@
+#ifndef XLA_CLIENT_METRICS_SERVER_H_
+#define XLA_CLIENT_METRICS_SERVER_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace torch_xla {
+namespace runtime {
+namespace metrics {
+
+// Minimal HTTP server answering the GET requests of metric scrapers (like
+// Prometheus) with the report created by `report_fn`, in the OpenMetrics text
+// format. The requests are served one at a time by a thread of the server, and
+// the server stops when destroyed.
+class MetricsServer {
+ public:
+  explicit MetricsServer(std::function<std::string()> report_fn);
+
+  ~MetricsServer();
+
+  // Starts serving the reports on `port` of all the interfaces, at the /metrics
+  // path.
+  void Start(int port);
+
+ private:
+  void Serve();
+
+  void Respond(int connection);
+
+  std::function<std::string()> report_fn_;
+  int socket_ = -1;
+  std::atomic<bool> stopped_{false};
+  std::unique_ptr<std::thread> thread_;
+};
+
+}  // namespace metrics
+}  // namespace runtime
+}  // namespace torch_xla
+
+#endif  // XLA_CLIENT_METRICS_SERVER_H_
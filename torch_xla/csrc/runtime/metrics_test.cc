@@ -0,0 +1,102 @@
+#include "torch_xla/csrc/runtime/metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace torch_xla {
+namespace runtime {
+namespace metrics {
+
+TEST(MetricDataTest, MergesThreadSamples) {
+  MetricData data(MetricFnValue, /*max_samples=*/8);
+  std::vector<std::thread> threads;
+  for (int64_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&data, t]() {
+      for (int64_t i = 0; i < 10; ++i) {
+        // Interleaved timestamps across the threads.
+        data.AddSample(/*timestamp_ns=*/i * 4 + t, /*value=*/1.0);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  double accumulator = 0.0;
+  size_t total_samples = 0;
+  std::vector<Sample> samples = data.Samples(&accumulator, &total_samples);
+  EXPECT_EQ(total_samples, 40);
+  EXPECT_EQ(accumulator, 40.0);
+  EXPECT_EQ(data.TotalSamples(), 40);
+  // The newest samples of all the threads, from the oldest to the newer.
+  ASSERT_EQ(samples.size(), 8);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    EXPECT_EQ(samples[i].timestamp_ns, 32 + i);
+  }
+
+  data.Clear();
+  EXPECT_EQ(data.TotalSamples(), 0);
+  EXPECT_TRUE(data.Samples(nullptr, nullptr).empty());
+}
+
+TEST(MetricDataTest, KeepsSingleThreadOrder) {
+  MetricData data(MetricFnValue, /*max_samples=*/4);
+  for (int64_t i = 0; i < 6; ++i) {
+    data.AddSample(/*timestamp_ns=*/i, /*value=*/i);
+  }
+  std::vector<Sample> samples = data.Samples(nullptr, nullptr);
+  ASSERT_EQ(samples.size(), 4);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    EXPECT_EQ(samples[i].value, i + 2);
+  }
+  EXPECT_EQ(data.Accumulator(), 15.0);
+}
+
+TEST(MetricDataTest, CountsBuckets) {
+  MetricData data(MetricFnValue, /*max_samples=*/2);
+  for (double value : {-3.0, 1.0, 2.0, 3.0, 4.0, 1e30}) {
+    data.AddSample(/*timestamp_ns=*/0, value);
+  }
+  std::array<int64_t, MetricData::kNumBuckets> counts = data.BucketCounts();
+  EXPECT_EQ(counts[0], 2);
+  EXPECT_EQ(counts[1], 1);
+  EXPECT_EQ(counts[2], 2);
+  EXPECT_EQ(counts[MetricData::kNumBuckets - 1], 1);
+  EXPECT_EQ(MetricData::BucketBound(2), 4.0);
+}
+
+TEST(LogLinearHistogramTest, Percentiles) {
+  LogLinearHistogram histogram;
+  for (int64_t value = 1; value <= 10000; ++value) {
+    histogram.Add(value * 1000.0);
+  }
+  std::vector<int64_t> counts = histogram.Counts();
+  std::vector<double> percentiles =
+      LogLinearHistogram::Percentiles(counts, {0.5, 0.99, 0.999});
+  ASSERT_EQ(percentiles.size(), 3);
+  EXPECT_NEAR(percentiles[0], 5.0e6, 5.0e6 / 32);
+  EXPECT_NEAR(percentiles[1], 9.9e6, 9.9e6 / 32);
+  EXPECT_NEAR(percentiles[2], 9.99e6, 9.99e6 / 32);
+
+  // The percentiles of the values posted after a snapshot of the counts.
+  for (int64_t i = 0; i < 100; ++i) {
+    histogram.Add(1.0e9);
+  }
+  std::vector<int64_t> interval = histogram.Counts();
+  for (size_t i = 0; i < interval.size(); ++i) {
+    interval[i] -= counts[i];
+  }
+  EXPECT_NEAR(LogLinearHistogram::Percentiles(interval, {0.5})[0], 1.0e9,
+              1.0e9 / 32);
+
+  histogram.Clear();
+  counts = histogram.Counts();
+  EXPECT_EQ(std::accumulate(counts.begin(), counts.end(), int64_t{0}), 0);
+}
+
+}  // namespace metrics
+}  // namespace runtime
+}  // namespace torch_xla
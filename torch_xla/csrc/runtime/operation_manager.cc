@@ -4,14 +4,17 @@
 
 #include "absl/types/span.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/metrics.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/tf_logging.h"
 
 namespace torch_xla {
 namespace runtime {
 
-OperationManager::OperationManager(absl::Span<const std::string> devices) {
+OperationManager::OperationManager(absl::Span<const std::string> devices,
+                                   int64_t max_inflight_operations) {
   for (auto& device : devices) {
-    op_counters_.try_emplace(device, device);
+    op_counters_.try_emplace(device, device, max_inflight_operations);
   }
 }
 
@@ -21,6 +24,12 @@ OperationManager::OperationTracker::OperationTracker(Counter* counter)
   counter_->Increment();
 }
 
+OperationManager::OperationTracker::OperationTracker(Counter* counter,
+                                                     std::adopt_lock_t)
+    : counter_(counter) {
+  XLA_CHECK(counter_);
+}
+
 OperationManager::OperationTracker::~OperationTracker() {
   counter_->Decrement();
 }
@@ -30,6 +39,19 @@ OperationManager::StartOperation(std::string device) {
   return std::make_unique<OperationTracker>(&op_counters_.at(device));
 }
 
+std::unique_ptr<OperationManager::OperationTracker>
+OperationManager::TryStartOperation(std::string device) {
+  Counter* counter = &op_counters_.at(device);
+  if (!counter->TryIncrement()) {
+    return nullptr;
+  }
+  return std::make_unique<OperationTracker>(counter, std::adopt_lock);
+}
+
+OperationManager::Stats OperationManager::GetStats(const std::string& device) {
+  return op_counters_.at(device).GetStats();
+}
+
 void OperationManager::WaitForDevices(absl::Span<const std::string> devices) {
   std::vector<std::unique_lock<std::shared_mutex>> locks;
   locks.reserve(devices.size());
@@ -51,8 +73,50 @@ void OperationManager::Counter::Increment() {
   // already atomic, so atomic so we don't need an exclusive lock to prevent
   // data races.
   std::shared_lock lock(pending_operations_mu_);
-  auto current = count_.fetch_add(1, std::memory_order_acq_rel) + 1;
+  if (max_inflight_ <= 0) {
+    Started(count_.fetch_add(1, std::memory_order_acq_rel) + 1);
+    return;
+  }
+  // Bounded admissions are serialized by cv_mu_, so that they never go past
+  // the maximum.
+  std::unique_lock cv_lock(cv_mu_);
+  if (count_.load(std::memory_order_acquire) >= max_inflight_) {
+    TF_VLOG(5) << "Waiting for one of the " << count_ << " operations on "
+               << device_ << " to complete";
+    XLA_TIMED("InflightOperationsBlockTime");
+    int64_t start_ns = sys_util::NowNs();
+    admission_cv_.wait(cv_lock, [this] {
+      return count_.load(std::memory_order_acquire) < max_inflight_;
+    });
+    blocked_ns_ += sys_util::NowNs() - start_ns;
+  }
+  Started(count_.fetch_add(1, std::memory_order_acq_rel) + 1);
+}
+
+bool OperationManager::Counter::TryIncrement() {
+  std::shared_lock lock(pending_operations_mu_);
+  if (max_inflight_ <= 0) {
+    Started(count_.fetch_add(1, std::memory_order_acq_rel) + 1);
+    return true;
+  }
+  std::unique_lock cv_lock(cv_mu_);
+  if (count_.load(std::memory_order_acquire) >= max_inflight_) {
+    ++rejected_;
+    XLA_COUNTER("InflightOperationsRejected", 1);
+    return false;
+  }
+  Started(count_.fetch_add(1, std::memory_order_acq_rel) + 1);
+  return true;
+}
+
+void OperationManager::Counter::Started(int64_t current) {
   TF_VLOG(5) << "Incremented operations for " << device_ << " to " << current;
+  XLA_VALUE_METRIC("InflightOperations", current);
+  int64_t high_water_mark = high_water_mark_.load(std::memory_order_relaxed);
+  while (current > high_water_mark &&
+         !high_water_mark_.compare_exchange_weak(high_water_mark, current,
+                                                 std::memory_order_relaxed)) {
+  }
 }
 
 void OperationManager::Counter::Decrement() {
@@ -64,6 +128,21 @@ void OperationManager::Counter::Decrement() {
     TF_VLOG(3) << "All operations complete for " << device_;
     cv_.notify_all();
   }
+  if (max_inflight_ > 0 && current == max_inflight_ - 1) {
+    // Taking the lock orders the notification after the check of a blocked
+    // Increment.
+    std::unique_lock cv_lock(cv_mu_);
+    admission_cv_.notify_all();
+  }
+}
+
+OperationManager::Stats OperationManager::Counter::GetStats() {
+  Stats stats;
+  stats.inflight = count_.load(std::memory_order_acquire);
+  stats.high_water_mark = high_water_mark_.load(std::memory_order_relaxed);
+  stats.blocked_ns = blocked_ns_.load(std::memory_order_relaxed);
+  stats.rejected = rejected_.load(std::memory_order_relaxed);
+  return stats;
 }
 
 std::unique_lock<std::shared_mutex>
@@ -3,9 +3,12 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <string>
+#include <unordered_map>
 
 #include "absl/types/span.h"
 
@@ -13,10 +16,28 @@ namespace torch_xla {
 namespace runtime {
 
 // Track inflight operations for each device.
+//
+// When `max_inflight_operations` is positive, it bounds the inflight
+// operations of each device: StartOperation blocks until one completes, while
+// TryStartOperation refuses to start a new one. Since inflight transfers hold
+// on to their host buffers, this also caps the host memory of data heavy
+// phases.
+//
+// Metrics: InflightOperations samples the depth of the device when an
+// operation starts, InflightOperationsBlockTime the time StartOperation
+// blocked, and counter InflightOperationsRejected counts the refusals.
 class OperationManager {
  public:
+  struct Stats {
+    int64_t inflight = 0;
+    int64_t high_water_mark = 0;
+    int64_t blocked_ns = 0;
+    int64_t rejected = 0;
+  };
+
   OperationManager() = default;
-  OperationManager(absl::Span<const std::string>);
+  OperationManager(absl::Span<const std::string>,
+                   int64_t max_inflight_operations = 0);
 
   OperationManager(const OperationManager&) = delete;
   OperationManager& operator=(const OperationManager&) = delete;
@@ -26,14 +47,20 @@ class OperationManager {
 
   class Counter {
    public:
-    Counter(const std::string& device) : device_(device){};
+    Counter(const std::string& device, int64_t max_inflight = 0)
+        : device_(device), max_inflight_(max_inflight){};
 
     Counter(const Counter&) = delete;
     Counter& operator=(const Counter&) = delete;
 
-    // Register a new operation. Blocks if `BlockNewOperations` has been called.
+    // Register a new operation. Blocks if `BlockNewOperations` has been called,
+    // or while the maximum of inflight operations is reached.
     void Increment();
 
+    // Like `Increment`, but returns false instead of blocking on the maximum
+    // of inflight operations.
+    bool TryIncrement();
+
     // Mark an inflight task completed.
     void Decrement();
 
@@ -44,14 +71,26 @@ class OperationManager {
     // Returns a lock that prevents new operations on the device.
     std::unique_lock<std::shared_mutex> BlockNewOperations();
 
+    Stats GetStats();
+
    private:
+    // Accounts for an operation now counted in `count_`.
+    void Started(int64_t current);
+
     std::string device_;
+    const int64_t max_inflight_;
 
     std::shared_mutex pending_operations_mu_;
     std::atomic<int64_t> count_{0};
 
     std::mutex cv_mu_;
     std::condition_variable cv_;
+    // Signaled when an operation completes while the maximum is reached.
+    std::condition_variable admission_cv_;
+
+    std::atomic<int64_t> high_water_mark_{0};
+    std::atomic<int64_t> blocked_ns_{0};
+    std::atomic<int64_t> rejected_{0};
   };
 
   class OperationTracker {
@@ -59,6 +98,9 @@ class OperationManager {
     // Register an operation in the `counter_`.
     OperationTracker(Counter* counter);
 
+    // Takes over an operation already registered in the `counter_`.
+    OperationTracker(Counter* counter, std::adopt_lock_t);
+
     // Mark an operation complete in `counter_`.
     ~OperationTracker();
 
@@ -73,6 +115,12 @@ class OperationManager {
   // Register a new operation for `device`.
   std::unique_ptr<OperationTracker> StartOperation(std::string device);
 
+  // Register a new operation for `device`, unless the maximum of inflight
+  // operations is reached in which case nullptr is returned.
+  std::unique_ptr<OperationTracker> TryStartOperation(std::string device);
+
+  Stats GetStats(const std::string& device);
+
   // Wait for all device execution to complete on devices.
   void WaitForDevices(absl::Span<const std::string> devices);
 
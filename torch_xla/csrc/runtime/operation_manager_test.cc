@@ -0,0 +1,56 @@
+#include "torch_xla/csrc/runtime/operation_manager.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace torch_xla {
+namespace runtime {
+
+TEST(OperationManagerTest, TracksInflightOperations) {
+  std::vector<std::string> devices = {"CPU:0"};
+  OperationManager manager(devices);
+  {
+    auto first = manager.StartOperation("CPU:0");
+    auto second = manager.StartOperation("CPU:0");
+    EXPECT_EQ(manager.GetStats("CPU:0").inflight, 2);
+  }
+  OperationManager::Stats stats = manager.GetStats("CPU:0");
+  EXPECT_EQ(stats.inflight, 0);
+  EXPECT_EQ(stats.high_water_mark, 2);
+  EXPECT_EQ(stats.blocked_ns, 0);
+}
+
+TEST(OperationManagerTest, BoundsInflightOperations) {
+  std::vector<std::string> devices = {"CPU:0"};
+  OperationManager manager(devices, /*max_inflight_operations=*/1);
+  auto first = manager.StartOperation("CPU:0");
+
+  EXPECT_EQ(manager.TryStartOperation("CPU:0"), nullptr);
+  EXPECT_EQ(manager.GetStats("CPU:0").rejected, 1);
+
+  std::atomic<bool> started(false);
+  std::thread thread([&]() {
+    auto second = manager.StartOperation("CPU:0");
+    started = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(started);
+
+  first.reset();
+  thread.join();
+  EXPECT_TRUE(started);
+  OperationManager::Stats stats = manager.GetStats("CPU:0");
+  EXPECT_EQ(stats.inflight, 0);
+  EXPECT_EQ(stats.high_water_mark, 1);
+  EXPECT_GT(stats.blocked_ns, 0);
+  EXPECT_NE(manager.TryStartOperation("CPU:0"), nullptr);
+}
+
+}  // namespace runtime
+}  // namespace torch_xla
@@ -1,13 +1,21 @@
 #include "torch_xla/csrc/runtime/pjrt_computation_client.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
 #include <future>
+#include <map>
 #include <unordered_set>
+#include <variant>
 #include <vector>
 
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/types/span.h"
+#include "torch_xla/csrc/runtime/cache_storage.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/env_hash.h"
@@ -16,19 +24,23 @@
 #include "torch_xla/csrc/runtime/pjrt_registry.h"
 #include "torch_xla/csrc/runtime/profiler.h"
 #include "torch_xla/csrc/runtime/stablehlo_helper.h"
+#include "torch_xla/csrc/runtime/tenant.h"
 #include "torch_xla/csrc/runtime/tensor_source.h"
 #include "torch_xla/csrc/runtime/tf_logging.h"
 #include "torch_xla/csrc/runtime/xla_coordinator.h"
 #include "torch_xla/csrc/thread_pool.h"
 #include "tsl/profiler/lib/traceme.h"
+#include "tsl/profiler/lib/traceme_encode.h"
 #include "xla/client/xla_builder.h"
 #include "xla/client/xla_computation.h"
 #include "xla/layout_util.h"
 #include "xla/literal.h"
 #include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_compiler.h"
 #include "xla/pjrt/pjrt_executable.h"
 #include "xla/protobuf_util.h"
 #include "xla/shape.h"
+#include "xla/shape_util.h"
 
 using xla::internal::XlaBuilderFriend;
 
@@ -37,6 +49,12 @@ namespace runtime {
 
 namespace {
 
+int64_t BufferBytes(const xla::PjRtBuffer& buffer) {
+  absl::StatusOr<size_t> size = buffer.GetOnDeviceSizeInBytes();
+  return size.ok() ? *size
+                   : xla::ShapeUtil::ByteSizeOf(buffer.on_device_shape());
+}
+
 // Builds a map from the device's global ordinal to its index in the `devices`
 // array.
 std::unordered_map<int, int> build_index_map(
@@ -62,17 +80,19 @@ xla::Shape host_output_shape(xla::PjRtBuffer* buffer) {
 }
 
 torch::lazy::hash_t hash_comp_env(
-    xla::PjRtClient* client, std::vector<xla::PjRtDevice*>& ordered_devices) {
-  torch::lazy::hash_t hash = hash::HashXlaEnvVars();
+    xla::PjRtClient* client, std::vector<xla::PjRtDevice*>& ordered_devices,
+    hash::EnvComponents* components) {
+  torch::lazy::hash_t hash = hash::HashXlaEnvVars(components);
   auto topology_desc = client->GetTopologyDescription();
   if (topology_desc.ok()) {
     // Some backends support a topology description which provides a better
     // view of the specific compilation environment.
     auto serialized = topology_desc.value()->Serialize();
     if (serialized.ok()) {
-      return torch::lazy::HashCombine(
-          hash,
-          torch::lazy::DataHash(serialized->data(), serialized->length()));
+      torch::lazy::hash_t topology_hash =
+          torch::lazy::DataHash(serialized->data(), serialized->length());
+      (*components)["topology"] = torch::lazy::HashToString(topology_hash);
+      return torch::lazy::HashCombine(hash, topology_hash);
     }
     // If serialization fails, fallthrough to the manual approach.
   }
@@ -83,17 +103,259 @@ torch::lazy::hash_t hash_comp_env(
   // platform_version incorporates libtpu version and hardware type.
   hash = torch::lazy::HashCombine(
       hash, torch::lazy::StringHash(platform_version.c_str()));
+  (*components)["platform_name"] = platform_name;
+  (*components)["platform_version"] = platform_version;
   // Include global devices in the hash, ensuring order is consistent.
+  std::vector<std::string> device_strs;
   for (auto& device : ordered_devices) {
     std::string device_str(device->ToString());
     hash = torch::lazy::HashCombine(
         hash, torch::lazy::StringHash(device_str.c_str()));
+    device_strs.push_back(std::move(device_str));
   }
+  (*components)["devices"] = absl::StrJoin(device_strs, ", ");
   return hash;
 }
 
+// Whether `cached` still refers to the `data` object. Comparing the owners
+// needs no locking, and cannot be fooled by a new object at the same address
+// since the weak reference keeps the control block alive.
+bool IsSameData(const std::weak_ptr<ComputationClient::Data>& cached,
+                const ComputationClient::DataPtr& data) {
+  return !cached.owner_before(data) && !data.owner_before(cached);
+}
+
+// Returns, for each shard, the index of the first shard holding the same data
+// according to the sharding, or an empty vector if every shard is distinct.
+// Shards are replicas of each other if the sharding is replicated (or unknown,
+// which marks the implicitly replicated data of auto-sharding), or if they
+// cover the same tile of a sharding partially replicated on its last tile
+// dimension.
+std::vector<size_t> ReplicaSources(
+    absl::Span<const std::shared_ptr<const TensorSource>> shards,
+    const xla::OpSharding& sharding) {
+  std::vector<size_t> sources(shards.size());
+  if (shards.size() < 2) {
+    return {};
+  }
+  if (sharding.type() == xla::OpSharding::REPLICATED ||
+      sharding.type() == xla::OpSharding::UNKNOWN) {
+    for (size_t i = 0; i < shards.size(); ++i) {
+      sources[i] = 0;
+    }
+  } else if (sharding.type() == xla::OpSharding::OTHER &&
+             sharding.replicate_on_last_tile_dim() &&
+             sharding.last_tile_dims_size() == 0) {
+    xla::HloSharding hlo_sharding =
+        xla::HloSharding::FromProto(sharding).value();
+    std::map<std::vector<int64_t>, size_t> tile_sources;
+    for (size_t i = 0; i < shards.size(); ++i) {
+      std::vector<std::string> device_spec =
+          absl::StrSplit(shards[i]->device(), ':');
+      XLA_CHECK_EQ(device_spec.size(), 2)
+          << "Invalid device specification: " << shards[i]->device();
+      std::vector<int64_t> tile =
+          hlo_sharding.TileIndexForDevice(std::stoi(device_spec[1]));
+      // Drops the replication dimension.
+      tile.pop_back();
+      sources[i] = tile_sources.emplace(std::move(tile), i).first->second;
+    }
+  } else {
+    return {};
+  }
+  for (size_t i = 0; i < shards.size(); ++i) {
+    if (!xla::ShapeUtil::Equal(shards[i]->shape(),
+                               shards[sources[i]]->shape())) {
+      return {};
+    }
+  }
+  return sources;
+}
+
+// The fraction of the execution time past which the skew between the shards
+// of a replicated execution marks the last one as a straggler.
+constexpr double kStragglerSkewFraction = 0.1;
+
+// The times at which the shards of a replicated execution become ready on
+// their devices, recorded from the futures of the shards.
+struct ShardTimeline {
+  ShardTimeline(int64_t dispatch_ns, std::vector<metrics::Counter*> stragglers)
+      : dispatch_ns(dispatch_ns),
+        ready_ns(stragglers.size()),
+        straggler_counters(std::move(stragglers)),
+        pending(straggler_counters.size()) {}
+
+  // Records the ready time of the shard `index`, and the skew between the
+  // shards once all of them are ready.
+  void ShardReady(size_t index) {
+    ready_ns[index] = sys_util::NowNs();
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    auto [first, last] = std::minmax_element(ready_ns.begin(), ready_ns.end());
+    int64_t skew = *last - *first;
+    static metrics::Metric* skew_metric = new metrics::Metric(
+        "ExecuteReplicatedShardSkew", metrics::MetricFnTime);
+    skew_metric->AddSample(skew);
+    if (skew > kStragglerSkewFraction * (*last - dispatch_ns)) {
+      straggler_counters[last - ready_ns.begin()]->AddValue(1);
+    }
+  }
+
+  const int64_t dispatch_ns;
+  std::vector<int64_t> ready_ns;
+  const std::vector<metrics::Counter*> straggler_counters;
+  std::atomic<size_t> pending;
+};
+
+// Returns `shape` laid out in the memory of `memory_kind`.
+xla::Shape WithMemoryKind(xla::Shape shape, MemoryKind memory_kind) {
+  if (!shape.has_layout()) {
+    xla::LayoutUtil::SetToDefaultLayout(&shape);
+  }
+  shape.mutable_layout()->set_memory_space(
+      memory_kind == MemoryKind::kPinnedHost
+          ? xla::Layout::kHostMemorySpace
+          : xla::Layout::kDefaultMemorySpace);
+  return shape;
+}
+
+// Returns `shapes` laid out in the memory of `memory_kinds`, the i-th memory
+// kind applying to the i-th shape, or to the i-th element of the single tuple
+// shape when `tupled`.
+std::vector<xla::Shape> WithMemoryKinds(
+    absl::Span<const xla::Shape> shapes,
+    absl::Span<const MemoryKind> memory_kinds, bool tupled) {
+  if (tupled) {
+    XLA_CHECK_EQ(shapes.size(), 1);
+    std::vector<xla::Shape> elements = WithMemoryKinds(
+        shapes[0].tuple_shapes(), memory_kinds, /*tupled=*/false);
+    return {xla::ShapeUtil::MakeTupleShape(elements)};
+  }
+  XLA_CHECK_EQ(shapes.size(), memory_kinds.size());
+  std::vector<xla::Shape> laid_out;
+  laid_out.reserve(shapes.size());
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    laid_out.push_back(WithMemoryKind(shapes[i], memory_kinds[i]));
+  }
+  return laid_out;
+}
+
+// Lets the compiler choose the layouts of the `auto_parameters` and of all the
+// outputs, the other parameters keeping the default ones, through the layout
+// modes of the module.
+void SetAutoLayoutModes(absl::Span<const size_t> auto_parameters,
+                        xla::XlaComputation* computation) {
+  xla::ProgramShape program_shape = computation->GetProgramShape().value();
+  std::vector<std::string> parameter_modes(program_shape.parameters_size(),
+                                           "default");
+  for (size_t index : auto_parameters) {
+    parameter_modes[index] = "auto";
+  }
+  const xla::Shape& result = program_shape.result();
+  std::vector<std::string> output_modes(
+      result.IsTuple() ? result.tuple_shapes_size() : 1, "auto");
+  auto* attributes = computation->mutable_proto()
+                         ->mutable_frontend_attributes()
+                         ->mutable_map();
+  (*attributes)[PjRtComputationClient::PjRtComputation::
+                    kArgLayoutModesAttribute] =
+      absl::StrJoin(parameter_modes, ";");
+  (*attributes)[PjRtComputationClient::PjRtComputation::
+                    kOutLayoutModesAttribute] =
+      absl::StrJoin(output_modes, ";");
+}
+
+// Accounts the collectives of a compiled graph, by HLO opcode and replica
+// group size.
+void CountCollectives(const util::CollectiveStats& stats) {
+  if (stats.empty()) {
+    return;
+  }
+  XLA_COUNTER("CompiledGraphsWithCollectives", 1);
+  for (const auto& [name, count] : stats.counts) {
+    metrics::Counter(absl::StrCat("CompiledCollectives.", name))
+        .AddValue(count);
+    metrics::Counter(absl::StrCat("CompiledCollectiveBytes.", name))
+        .AddValue(stats.bytes.at(name));
+  }
+  for (const auto& [group_size, count] : stats.group_sizes) {
+    metrics::Counter(absl::StrCat("CompiledCollectiveGroupSize.", group_size))
+        .AddValue(count);
+  }
+}
+
+// Records the bus bandwidth of an execution moving `bus_bytes` over the
+// collectives in `seconds`.
+void RecordBusBandwidth(metrics::Metric* metric, double bus_bytes,
+                        double seconds) {
+  if (metric != nullptr && seconds > 0) {
+    metric->AddSample(bus_bytes / seconds);
+  }
+}
+
+void CountArgumentTable(size_t num_arguments, int64_t patched) {
+  XLA_COUNTER("ArgumentTableReused", num_arguments - patched);
+  XLA_COUNTER("ArgumentTablePatched", patched);
+}
+
+// The serialized computations start with this header, followed by the size
+// and the bytes of the HLO module proto of the computation, then by the
+// serialized executable. The serializations without the header hold the
+// executable only, and take their HLO from its modules.
+constexpr char kSerializedComputationMagic[] = "PTXLAEX1";
+constexpr size_t kSerializedComputationMagicSize =
+    sizeof(kSerializedComputationMagic) - 1;
+
+std::string SerializeWithHlo(const xla::HloModuleProto& hlo,
+                             const std::string& executable) {
+  std::string serialized_hlo = hlo.SerializeAsString();
+  uint64_t hlo_size = serialized_hlo.size();
+  std::string serialized(kSerializedComputationMagic,
+                         kSerializedComputationMagicSize);
+  serialized.append(reinterpret_cast<const char*>(&hlo_size),
+                    sizeof(hlo_size));
+  serialized.append(serialized_hlo);
+  serialized.append(executable);
+  return serialized;
+}
+
+// Splits the `serialized` computation into its HLO and executable, returning
+// false for the serializations holding the executable only.
+bool ParseWithHlo(const std::string& serialized, xla::HloModuleProto* hlo,
+                  absl::string_view* executable) {
+  size_t header_size = kSerializedComputationMagicSize + sizeof(uint64_t);
+  if (serialized.size() < header_size ||
+      serialized.compare(0, kSerializedComputationMagicSize,
+                         kSerializedComputationMagic) != 0) {
+    return false;
+  }
+  uint64_t hlo_size;
+  std::memcpy(&hlo_size, serialized.data() + kSerializedComputationMagicSize,
+              sizeof(hlo_size));
+  XLA_CHECK_LE(hlo_size, serialized.size() - header_size)
+      << "Truncated serialized computation";
+  XLA_CHECK(hlo->ParseFromArray(serialized.data() + header_size, hlo_size))
+      << "Failed to parse the HLO of the serialized computation";
+  *executable = absl::string_view(serialized).substr(header_size + hlo_size);
+  return true;
+}
+
 }  // namespace
 
+void PjRtComputationClient::PjRtComputation::ArgumentTable::Prepare(
+    absl::Span<xla::PjRtDevice* const> devices, size_t num_arguments) {
+  if (arguments.size() == num_arguments &&
+      std::equal(devices.begin(), devices.end(), this->devices.begin(),
+                 this->devices.end())) {
+    return;
+  }
+  this->devices.assign(devices.begin(), devices.end());
+  arguments.assign(num_arguments, std::weak_ptr<ComputationClient::Data>());
+  buffers.assign(devices.size(),
+                 std::vector<xla::PjRtBuffer*>(num_arguments, nullptr));
+}
+
 std::string PjRtComputationClient::PjRtDeviceToString(
     xla::PjRtDevice* const device) const {
   std::string platform =
@@ -117,7 +379,11 @@ std::vector<std::string> PjRtComputationClient::PjRtDevicesToString(
 
 PjRtComputationClient::PjRtComputationClient() {
   std::string device_type = sys_util::GetEnvString(env::kEnvPjRtDevice, "");
-  std::tie(client_, coordinator_) = InitializePjRt(device_type);
+  {
+    XLA_TIMED("PjRtStartupClientTime");
+    std::tie(client_, coordinator_) = InitializePjRt(device_type);
+  }
+  XLA_TIMED("PjRtStartupTopologyTime");
 
   // PjRtDevice IDs are not guaranteed to be dense, so we need to track
   // a device's global ordinal separately from its device ID. Order the
@@ -130,12 +396,38 @@ PjRtComputationClient::PjRtComputationClient() {
     global_ordinals_[device->id()] = global_ordinals_.size();
     std::string device_str = PjRtDeviceToString(device);
     string_to_device_.emplace(device_str, device);
+    pinned_host_bytes_.emplace(device_str,
+                               std::make_shared<std::atomic<int64_t>>(0));
+    if (device->IsAddressable()) {
+      straggler_counters_.emplace(
+          device, new metrics::Counter(
+                      absl::StrCat("ExecuteReplicatedStraggler.", device_str)));
+    }
   }
-  comp_env_hash_ = hash_comp_env(client_.get(), ordered_devices);
 
   auto tracked_devices = GetLocalDevices();
   tracked_devices.emplace_back(spmd_device_str);
-  operation_manager_ = std::move(OperationManager(std::move(tracked_devices)));
+  execution_dispatcher_ = ExecutionDispatcher(
+      tracked_devices,
+      sys_util::GetEnvInt(env::kEnvExecutionLaneMaxHoldMs, 1000));
+  operation_manager_ = std::move(OperationManager(
+      std::move(tracked_devices),
+      sys_util::GetEnvInt(env::kEnvMaxInflightDeviceOperations, 0)));
+
+  int64_t compile_parallelism = sys_util::GetEnvInt(
+      env::kEnvCompileParallelism, std::thread::hardware_concurrency());
+  if (compile_parallelism > 1) {
+    compile_pool_ = std::make_unique<tsl::thread::ThreadPool>(
+        tsl::Env::Default(), "pjrt_compile", compile_parallelism);
+  }
+
+  int64_t host_buffer_pool_bytes =
+      sys_util::GetEnvInt(env::kEnvHostBufferPoolBytes, 0);
+  if (host_buffer_pool_bytes > 0) {
+    host_buffer_pool_ = HostBufferPool::Create(
+        host_buffer_pool_bytes,
+        sys_util::GetEnvBool(env::kEnvHostBufferPoolPin, true));
+  }
 }
 
 PjRtComputationClient::~PjRtComputationClient() {
@@ -175,13 +467,16 @@ void PjRtComputationClient::PjRtData::Assign(
 
 ComputationClient::DataPtr PjRtComputationClient::CreateDataPlaceholder(
     std::string device, xla::Shape shape,
-    std::optional<xla::OpSharding> sharding) {
+    std::optional<xla::OpSharding> sharding, MemoryKind memory_kind) {
+  DataPtr data;
   if (sharding.has_value()) {
-    return std::make_shared<PjRtShardedData>(
+    data = std::make_shared<PjRtShardedData>(
         std::move(device), std::move(shape), std::move(*sharding));
+  } else {
+    data = std::make_shared<PjRtData>(std::move(device), std::move(shape));
   }
-
-  return std::make_shared<PjRtData>(std::move(device), std::move(shape));
+  data->set_memory_kind(memory_kind);
+  return data;
 }
 
 ComputationClient::DataPtr PjRtComputationClient::CreateData(
@@ -252,29 +547,110 @@ std::optional<xla::OpSharding> PjRtComputationClient::GetDataSharding(
 std::vector<ComputationClient::DataPtr> PjRtComputationClient::TransferToDevice(
     absl::Span<const std::shared_ptr<const TensorSource>> tensors) {
   metrics::TimedSection timed(TransferToDeviceMetric());
-  tsl::profiler::TraceMe activity("PjRtComputationClient::TransferToDevice",
-                                  tsl::profiler::TraceMeLevel::kInfo);
-  std::vector<ComputationClient::DataPtr> datas;
-  datas.reserve(tensors.size());
+  std::vector<ComputationClient::DataPtr> datas(tensors.size());
   int64_t total_size = 0;
   for (auto& tensor : tensors) {
-    xla::PjRtDevice* pjrt_device = StringToPjRtDevice(tensor->device());
-
     total_size += xla::ShapeUtil::ByteSizeOf(tensor->shape());
+  }
+  tsl::profiler::TraceMe activity(
+      [&] {
+        return tsl::profiler::TraceMeEncode(
+            "PjRtComputationClient::TransferToDevice",
+            {{"step", GetStepId()},
+             {"tensors", tensors.size()},
+             {"bytes", total_size}});
+      },
+      tsl::profiler::TraceMeLevel::kInfo);
+  // The budget of the tenant is enforced before any allocation, here as the
+  // transfers may run on the bulk pools.
+  std::vector<std::shared_ptr<void>> charges(tensors.size());
+  const std::string& tenant = tenant::Current();
+  if (!tenant.empty()) {
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      if (tensors[i]->memory_kind() == MemoryKind::kDevice) {
+        charges[i] = tenant::Charge(
+            tenant, xla::ShapeUtil::ByteSizeOf(tensors[i]->shape()));
+      }
+    }
+  }
 
-    std::shared_ptr<xla::PjRtBuffer> buffer =
-        std::move(client_
-                      ->BufferFromHostBuffer(
-                          tensor->data(), tensor->primitive_type(),
-                          tensor->dimensions(), tensor->byte_strides(),
-                          xla::PjRtClient::HostBufferSemantics::
-                              kImmutableUntilTransferCompletes,
-                          [tensor]() { /* frees tensor */ }, pjrt_device)
-                      .value());
-
-    ComputationClient::DataPtr data =
-        std::make_shared<PjRtData>(tensor->device(), tensor->shape(), buffer);
-    datas.push_back(data);
+  auto transfer_fn = [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      const std::shared_ptr<const TensorSource>& tensor = tensors[i];
+      xla::PjRtDevice* pjrt_device = StringToPjRtDevice(tensor->device());
+      // Inflight until the host buffer is released, which bounds the host
+      // memory held by the transfers along with the device operations.
+      std::shared_ptr<OperationManager::OperationTracker> op_tracker =
+          operation_manager_.StartOperation(tensor->device());
+
+      std::shared_ptr<xla::PjRtBuffer> buffer;
+      xla::PjRtMemorySpace* memory_space =
+          tensor->memory_kind() != MemoryKind::kDevice
+              ? GetMemorySpace(pjrt_device, tensor->memory_kind())
+              : nullptr;
+      if (memory_space == nullptr && tensor->owns_data() &&
+          client_->platform_id() == xla::CpuId()) {
+        // The CPU client aliases the host data instead of copying it, when
+        // aligned, for the lifetime of the buffer. The source owns its copy,
+        // so it is held until then, and the staging buffers of a request
+        // become the buffers of its arguments.
+        buffer = client_
+                     ->BufferFromHostBuffer(
+                         tensor->data(), tensor->primitive_type(),
+                         tensor->dimensions(), tensor->byte_strides(),
+                         xla::PjRtClient::HostBufferSemantics::
+                             kImmutableZeroCopy,
+                         [tensor]() { /* frees tensor */ }, pjrt_device)
+                     .value();
+        XLA_COUNTER("CpuZeroCopyTransfers", 1);
+      } else if (memory_space != nullptr) {
+        buffer = TrackPinnedHostBuffer(
+            client_
+                ->BufferFromHostBuffer(
+                    tensor->data(), tensor->primitive_type(),
+                    tensor->dimensions(), tensor->byte_strides(),
+                    xla::PjRtClient::HostBufferSemantics::
+                        kImmutableUntilTransferCompletes,
+                    [tensor, op_tracker]() { /* frees tensor */ },
+                    memory_space, /*device_layout=*/nullptr)
+                .value(),
+            tensor->device());
+      } else {
+        buffer =
+            std::move(client_
+                          ->BufferFromHostBuffer(
+                              tensor->data(), tensor->primitive_type(),
+                              tensor->dimensions(), tensor->byte_strides(),
+                              xla::PjRtClient::HostBufferSemantics::
+                                  kImmutableUntilTransferCompletes,
+                              [tensor, op_tracker]() { /* frees tensor */ },
+                              pjrt_device)
+                          .value());
+      }
+
+      buffer = TrackTenantBuffer(std::move(buffer), std::move(charges[i]));
+
+      datas[i] = std::make_shared<PjRtData>(tensor->device(), tensor->shape(),
+                                            buffer);
+    }
+  };
+  if (tensors.size() > 1) {
+    // The returned buffers are only enqueued for transfer, and executions
+    // consuming them wait on their definition events on the device. What is
+    // done on the host here is staging the data, which for some clients
+    // includes a full copy, so spread it over the bulk pools instead of
+    // issuing the transfers one after the other. The small tensors are
+    // grouped so that each range takes at least range_cost_ns.
+    static constexpr int64_t transfer_cost_ns = 10000;
+    static constexpr int64_t transfer_cost_ns_per_kb = 100;
+    static constexpr int64_t range_cost_ns = 50000;
+    int64_t cost_per_tensor =
+        transfer_cost_ns +
+        transfer_cost_ns_per_kb * total_size / 1024 / tensors.size();
+    thread::ParallelFor(tensors.size(), range_cost_ns / cost_per_tensor,
+                        transfer_fn);
+  } else {
+    transfer_fn(0, tensors.size());
   }
   OutboundDataMetric()->AddSample(total_size);
   CreateDataHandlesCounter()->AddValue(datas.size());
@@ -288,18 +664,61 @@ ComputationClient::DataPtr PjRtComputationClient::TransferShardsToDevice(
   tsl::profiler::TraceMe activity(
       "PjRtComputationClient::TransferShardsToDevice",
       tsl::profiler::TraceMeLevel::kInfo);
-  // TODO(jonbolin): Consider using CopyToDevice when sharding is REPLICATED.
-  // We are opting out of CopyToDevice for now due to the synchronization
-  // issues observed in ShardingUtil::InputHandler, but because CopyToDevice
-  // directly copies buffers between devices using ICI, it can be much faster
-  // than transferring from the host to each device.
-  auto data_shards = TransferToDevice(tensor_shards);
-  std::vector<std::shared_ptr<PjRtData>> pjrt_data_shards;
-  for (auto& shard : data_shards) {
-    auto pjrt_shard = dynamic_cast<PjRtData*>(shard.get());
-    pjrt_data_shards.push_back(std::make_shared<PjRtData>(
-        pjrt_shard->device(), pjrt_shard->shape(), pjrt_shard->buffer));
+  // Shards holding the same data, as per the sharding, are only uploaded once
+  // and then copied between the devices, over ICI or NVLink, which is much
+  // faster than transferring from the host to each device.
+  static const bool copy_replicas =
+      sys_util::GetEnvBool(env::kEnvCopyReplicatedShards, true);
+  std::vector<size_t> sources =
+      copy_replicas ? ReplicaSources(tensor_shards, sharding)
+                    : std::vector<size_t>();
+  std::vector<std::shared_ptr<const TensorSource>> uploads;
+  std::vector<size_t> upload_index(tensor_shards.size());
+  for (size_t i = 0; i < tensor_shards.size(); ++i) {
+    if (sources.empty() || sources[i] == i) {
+      upload_index[i] = uploads.size();
+      uploads.push_back(tensor_shards[i]);
+    }
+  }
+  std::vector<DataPtr> uploaded = TransferToDevice(uploads);
+  int64_t host_bytes = 0;
+  for (auto& upload : uploads) {
+    host_bytes += xla::ShapeUtil::ByteSizeOf(upload->shape());
+  }
+  XLA_COUNTER("TransferShardsHostBytes", host_bytes);
+
+  std::vector<std::shared_ptr<PjRtData>> pjrt_data_shards(tensor_shards.size());
+  int64_t copied_bytes = 0;
+  for (size_t i = 0; i < tensor_shards.size(); ++i) {
+    if (!sources.empty() && sources[i] != i) {
+      continue;
+    }
+    auto pjrt_shard =
+        std::dynamic_pointer_cast<PjRtData>(uploaded[upload_index[i]]);
+    pjrt_data_shards[i] = std::make_shared<PjRtData>(
+        pjrt_shard->device(), pjrt_shard->shape(), pjrt_shard->buffer);
   }
+  for (size_t i = 0; i < tensor_shards.size(); ++i) {
+    if (pjrt_data_shards[i] != nullptr) {
+      continue;
+    }
+    std::shared_ptr<PjRtData> source = pjrt_data_shards[sources[i]];
+    // The copies only start from fully uploaded buffers, so that the replicas
+    // are consistent with the source whatever the runtime does with the
+    // definition events of in flight uploads.
+    XLA_CHECK_OK(source->buffer->GetReadyFuture().Await());
+    DataPtr copy = CopyToDevice(source, tensor_shards[i]->device());
+    if (copy == source) {
+      // The runtime cannot copy between these devices.
+      copy = TransferToDevice({tensor_shards[i]}).front();
+      XLA_COUNTER("TransferShardsHostBytes",
+                  xla::ShapeUtil::ByteSizeOf(tensor_shards[i]->shape()));
+    } else {
+      copied_bytes += xla::ShapeUtil::ByteSizeOf(source->shape());
+    }
+    pjrt_data_shards[i] = std::dynamic_pointer_cast<PjRtData>(copy);
+  }
+  XLA_COUNTER("TransferShardsDeviceCopyBytes", copied_bytes);
   return std::make_shared<PjRtShardedData>(device, shape, pjrt_data_shards,
                                            sharding);
 }
@@ -324,6 +743,93 @@ ComputationClient::DataPtr PjRtComputationClient::CopyToDevice(
                                     std::move(status_or.value()));
 }
 
+ComputationClient::DataPtr PjRtComputationClient::CopyToMemoryKind(
+    ComputationClient::DataPtr data, MemoryKind memory_kind) {
+  tsl::profiler::TraceMe activity("PjRtComputationClient::CopyToMemoryKind",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  if (data->memory_kind() == memory_kind) {
+    return data;
+  }
+  if (auto sharded_data = std::dynamic_pointer_cast<PjRtShardedData>(data)) {
+    std::vector<DataPtr> shards;
+    shards.reserve(sharded_data->shards.size());
+    for (const std::shared_ptr<PjRtData>& shard : sharded_data->shards) {
+      shards.push_back(CopyToMemoryKind(shard, memory_kind));
+    }
+    return WrapDataShards(shards, sharded_data->device(),
+                          sharded_data->shape(), sharded_data->GetSharding());
+  }
+  const PjRtData* pjrt_data = dynamic_cast<PjRtData*>(data.get());
+  XLA_CHECK(pjrt_data->HasValue()) << "Can't copy invalid device data.";
+  xla::PjRtMemorySpace* memory_space =
+      GetMemorySpace(pjrt_data->buffer->device(), memory_kind);
+  if (memory_space == nullptr) {
+    return data;
+  }
+  std::shared_ptr<xla::PjRtBuffer> buffer =
+      pjrt_data->buffer->CopyToMemorySpace(memory_space).value();
+  if (memory_kind == MemoryKind::kPinnedHost) {
+    buffer = TrackPinnedHostBuffer(std::move(buffer), pjrt_data->device());
+  }
+  XLA_COUNTER("CopyToMemoryKind", 1);
+  return std::make_shared<PjRtData>(pjrt_data->device(), pjrt_data->shape(),
+                                    std::move(buffer));
+}
+
+xla::PjRtMemorySpace* PjRtComputationClient::GetMemorySpace(
+    xla::PjRtDevice* device, MemoryKind memory_kind) {
+  absl::StatusOr<xla::PjRtMemorySpace*> memory_space =
+      device->memory_space_by_kind(MemoryKindToString(memory_kind));
+  if (!memory_space.ok()) {
+    XLA_COUNTER("MemoryKindFallback", 1);
+    TF_VLOG(1) << device->DebugString() << " has no "
+               << MemoryKindToString(memory_kind)
+               << " memory, using its default memory";
+    return nullptr;
+  }
+  return *memory_space;
+}
+
+std::shared_ptr<xla::PjRtBuffer> PjRtComputationClient::TrackPinnedHostBuffer(
+    std::shared_ptr<xla::PjRtBuffer> buffer, const std::string& device) {
+  auto it = pinned_host_bytes_.find(device);
+  XLA_CHECK(it != pinned_host_bytes_.end()) << device;
+  int64_t bytes = BufferBytes(*buffer);
+  it->second->fetch_add(bytes);
+  xla::PjRtBuffer* raw_buffer = buffer.get();
+  return std::shared_ptr<xla::PjRtBuffer>(
+      raw_buffer, [buffer = std::move(buffer), pinned_host_bytes = it->second,
+                   bytes](xla::PjRtBuffer*) mutable {
+        pinned_host_bytes->fetch_sub(bytes);
+        buffer.reset();
+      });
+}
+
+std::shared_ptr<xla::PjRtBuffer> PjRtComputationClient::TrackTenantBuffer(
+    std::shared_ptr<xla::PjRtBuffer> buffer, std::shared_ptr<void> charge) {
+  if (charge == nullptr) {
+    return buffer;
+  }
+  xla::PjRtBuffer* raw_buffer = buffer.get();
+  return std::shared_ptr<xla::PjRtBuffer>(
+      raw_buffer, [buffer = std::move(buffer),
+                   charge = std::move(charge)](xla::PjRtBuffer*) mutable {
+        // The buffer goes before the charge of its bytes.
+        buffer.reset();
+        charge.reset();
+      });
+}
+
+std::shared_ptr<xla::PjRtBuffer> PjRtComputationClient::TrackTenantOutput(
+    std::shared_ptr<xla::PjRtBuffer> buffer, const std::string& tenant) {
+  if (tenant.empty()) {
+    return buffer;
+  }
+  std::shared_ptr<void> charge =
+      tenant::Charge(tenant, BufferBytes(*buffer), /*enforce=*/false);
+  return TrackTenantBuffer(std::move(buffer), std::move(charge));
+}
+
 std::shared_ptr<PjRtComputationClient::PjRtData>
 PjRtComputationClient::ReplicateShardedData(
     const ComputationClient::DataPtr& handle) {
@@ -406,6 +912,7 @@ std::vector<ComputationClient::DataPtr> PjRtComputationClient::ReshardData(
   hlo_shardings.reserve(handles.size());
   std::vector<xla::XlaOp> param_ops;
   param_ops.reserve(handles.size());
+  torch::lazy::hash_t key = HashCompilationEnv();
   for (int i = 0; i < handles.size(); ++i) {
     PjRtShardedData* sharded_data =
         dynamic_cast<PjRtShardedData*>(handles[i].get());
@@ -423,10 +930,15 @@ std::vector<ComputationClient::DataPtr> PjRtComputationClient::ReshardData(
 
     xla::OpSharding fallback_sharding;
     fallback_sharding.set_type(xla::OpSharding::REPLICATED);
-    xla::XlaScopedShardingAssignment assign(
-        &builder, sharded_data->GetSharding().type() == xla::OpSharding::UNKNOWN
-                      ? fallback_sharding
-                      : sharded_data->GetSharding());
+    xla::OpSharding source_sharding =
+        sharded_data->GetSharding().type() == xla::OpSharding::UNKNOWN
+            ? fallback_sharding
+            : sharded_data->GetSharding();
+    key = torch::lazy::HashCombine(
+        key, torch::lazy::MHash(shapes[i].ToString(/*print_layout=*/true),
+                                source_sharding.SerializeAsString(),
+                                sharding.SerializeAsString()));
+    xla::XlaScopedShardingAssignment assign(&builder, source_sharding);
     param_ops.push_back(
         xla::Parameter(&builder, i, shapes[i], absl::StrCat("p.", i)));
   }
@@ -442,20 +954,30 @@ std::vector<ComputationClient::DataPtr> PjRtComputationClient::ReshardData(
     root = xla::Tuple(&builder, param_ops);
   }
 
-  xla::XlaComputation xla_computation = ConsumeValue(builder.Build(root));
-  xla::ProgramShape program_shape =
-      ConsumeValue(xla_computation.GetProgramShape());
+  // The program only depends on the shapes and shardings, whose resharding
+  // is usually repeated (eg. by auto-sharding for every new graph).
+  ReshardCache* cache = GetReshardCache();
+  ComputationPtr computation = cache->Get(key);
+  if (computation != nullptr) {
+    XLA_COUNTER("ReshardCacheHit", 1);
+  } else {
+    XLA_COUNTER("ReshardCacheMiss", 1);
+    xla::XlaComputation xla_computation = ConsumeValue(builder.Build(root));
+    xla::ProgramShape program_shape =
+        ConsumeValue(xla_computation.GetProgramShape());
 
-  std::string device = GetDefaultDevice();
-  std::vector<torch_xla::runtime::ComputationClient::CompileInstance> instances;
-  instances.push_back({std::move(xla_computation), device,
-                       GetCompilationDevices(device, {}),
-                       &program_shape.result(),
-                       /*should_wrap_parameter=*/false,
-                       /*is_sharded=*/true,
-                       /*allow_spmd_sharding_propagation_to_output=*/false});
-  std::shared_ptr<torch_xla::runtime::ComputationClient::Computation>
-      computation = Compile(std::move(instances)).front();
+    std::string device = GetDefaultDevice();
+    std::vector<torch_xla::runtime::ComputationClient::CompileInstance>
+        instances;
+    instances.push_back({std::move(xla_computation), device,
+                         GetCompilationDevices(device, {}),
+                         &program_shape.result(),
+                         /*should_wrap_parameter=*/false,
+                         /*is_sharded=*/true,
+                         /*allow_spmd_sharding_propagation_to_output=*/false});
+    computation = Compile(std::move(instances)).front();
+    cache->Add(key, computation);
+  }
 
   torch_xla::runtime::ComputationClient::ExecuteReplicatedOptions
       execute_options;
@@ -464,6 +986,37 @@ std::vector<ComputationClient::DataPtr> PjRtComputationClient::ReshardData(
   return resharded_results;
 }
 
+PjRtComputationClient::ReshardCache* PjRtComputationClient::GetReshardCache() {
+  std::call_once(reshard_cache_once_, [this]() {
+    static const size_t max_cache_size =
+        sys_util::GetEnvInt(env::kEnvReshardCacheSize, 256);
+    std::string persistent_cache_dir =
+        sys_util::GetEnvString("XLA_PERSISTENT_CACHE_PATH", "");
+    if (persistent_cache_dir.empty()) {
+      reshard_cache_ =
+          std::make_unique<util::Cache<torch::lazy::hash_t, Computation,
+                                       torch::lazy::HashReducer>>(
+              max_cache_size);
+      return;
+    }
+    // In a directory of their own, so that they do not share the index of the
+    // compiled graphs.
+    std::string reshard_cache_dir =
+        absl::StrCat(persistent_cache_dir, "/reshard");
+    reshard_cache_ = std::make_unique<util::PersistentCache<
+        torch::lazy::hash_t, Computation, torch::lazy::HashReducer>>(
+        max_cache_size, util::CreateCacheStorage(reshard_cache_dir),
+        sys_util::GetEnvBool("XLA_PERSISTENT_CACHE_READ_ONLY", false),
+        [this](const ComputationPtr& computation) {
+          return SerializeComputation(computation);
+        },
+        [this](const std::string& serialization) {
+          return DeserializeComputation(serialization);
+        });
+  });
+  return reshard_cache_.get();
+}
+
 std::uintptr_t PjRtComputationClient::UnsafeBufferPointer(
     const DataPtr handle) {
   std::shared_ptr<PjRtData> pjrt_data =
@@ -497,8 +1050,13 @@ std::shared_ptr<xla::PjRtBuffer> PjRtComputationClient::GetPjRtBuffer(
 std::vector<xla::Literal> PjRtComputationClient::TransferFromDevice(
     absl::Span<const DataPtr> handles) {
   metrics::TimedSection timed(TransferFromDeviceMetric());
-  tsl::profiler::TraceMe activity("PjRtComputationClient::TransferFromDevice",
-                                  tsl::profiler::TraceMeLevel::kInfo);
+  tsl::profiler::TraceMe activity(
+      [&] {
+        return tsl::profiler::TraceMeEncode(
+            "PjRtComputationClient::TransferFromDevice",
+            {{"step", GetStepId()}, {"tensors", handles.size()}});
+      },
+      tsl::profiler::TraceMeLevel::kInfo);
   std::vector<xla::PjRtFuture<>> futures;
   futures.reserve(handles.size());
   std::vector<xla::Literal> literals;
@@ -524,122 +1082,259 @@ std::vector<xla::Literal> PjRtComputationClient::TransferFromDevice(
                          << __FUNCTION__;
   }
   InboundDataMetric()->AddSample(total_size);
+  activity.AppendMetadata(
+      [&] { return tsl::profiler::TraceMeEncode({{"bytes", total_size}}); });
 
   return literals;
 }
 
+std::vector<xla::PjRtFuture<>> PjRtComputationClient::TransferFromDeviceAsync(
+    absl::Span<const DataPtr> handles,
+    const TransferDestinationFn& destination_fn) {
+  tsl::profiler::TraceMe activity(
+      "PjRtComputationClient::TransferFromDeviceAsync",
+      tsl::profiler::TraceMeLevel::kInfo);
+  std::vector<xla::PjRtFuture<>> futures;
+  futures.reserve(handles.size());
+  int64_t total_size = 0;
+  for (size_t i = 0; i < handles.size(); ++i) {
+    std::shared_ptr<PjRtData> pjrt_data = ReplicateShardedData(handles[i]);
+    XLA_CHECK(pjrt_data) << "PjRt_data is null in " << __FUNCTION__;
+    XLA_CHECK(pjrt_data->buffer != nullptr)
+        << "PjRt buffer is null in " << __FUNCTION__;
+
+    xla::Shape shape = host_output_shape(pjrt_data->buffer.get());
+    xla::MutableLiteralBase* literal = destination_fn(i, shape);
+    XLA_CHECK(xla::ShapeUtil::Equal(literal->shape(), shape))
+        << "Transfer destination has shape " << literal->shape().ToString()
+        << ", expected " << shape.ToString();
+    futures.push_back(pjrt_data->buffer->ToLiteral(literal));
+
+    total_size += literal->size_bytes();
+  }
+  InboundDataMetric()->AddSample(total_size);
+
+  return futures;
+}
+
+std::vector<xla::PjRtFuture<>> PjRtComputationClient::GetReadyFutures(
+    absl::Span<const DataPtr> handles) {
+  std::vector<xla::PjRtFuture<>> futures;
+  for (const DataPtr& handle : handles) {
+    std::vector<std::shared_ptr<PjRtData>> buffers_data;
+    if (auto sharded_data =
+            std::dynamic_pointer_cast<PjRtShardedData>(handle)) {
+      buffers_data = sharded_data->shards;
+    } else {
+      std::shared_ptr<PjRtData> pjrt_data =
+          std::dynamic_pointer_cast<PjRtData>(handle);
+      XLA_CHECK(pjrt_data) << "Data must be PjRtData or PjRtShardedData, got "
+                           << handle->ToString();
+      buffers_data.push_back(std::move(pjrt_data));
+    }
+    for (const std::shared_ptr<PjRtData>& pjrt_data : buffers_data) {
+      if (pjrt_data->buffer != nullptr) {
+        futures.push_back(pjrt_data->buffer->GetReadyFuture());
+      }
+    }
+  }
+  return futures;
+}
+
 std::vector<ComputationClient::ComputationPtr> PjRtComputationClient::Compile(
     std::vector<ComputationClient::CompileInstance> instances) {
   metrics::TimedSection timed(CompileMetric());
   tsl::profiler::TraceMe activity("PjRtComputationClient::Compile",
                                   tsl::profiler::TraceMeLevel::kInfo);
-  std::vector<ComputationClient::ComputationPtr> computations;
-
-  for (auto& instance : instances) {
-    xla::CompileOptions compile_options;
-    if (instance.is_sharded) {
-      // TODO(yeounoh) multi-host, multi-slice configurations
-      compile_options.executable_build_options.set_use_spmd_partitioning(true);
+  std::vector<ComputationClient::ComputationPtr> computations(instances.size());
+  if (compile_pool_ == nullptr || instances.size() == 1) {
+    for (size_t i = 0; i < instances.size(); ++i) {
+      computations[i] = CompileSingleInstance(instances[i]);
+    }
+    return computations;
+  }
 
-      // We can override the compiler's default behavior to replicate the
-      // outputs. Setting this to true would wrapping the sharded outputs in
-      // PjRtShardedData.
-      compile_options.executable_build_options
-          .set_allow_spmd_sharding_propagation_to_output(
-              {instance.allow_spmd_sharding_propagation_to_output});
-
-      int num_partitions = client_->device_count();
-      compile_options.executable_build_options.set_num_partitions(
-          num_partitions);
-      compile_options.executable_build_options.set_num_replicas(1);
-      compile_options.parameter_is_tupled_arguments =
-          instance.parameter_is_tupled_arguments;
-      compile_options.executable_build_options.set_use_auto_spmd_partitioning(
-          instance.use_auto_spmd_partitioning);
-      TF_VLOG(3) << "Auto SPMD partitioning "
-                 << (instance.use_auto_spmd_partitioning ? "enabled!"
-                                                         : "disabled.");
-      if (!instance.auto_spmd_mesh_shape.empty()) {
-        compile_options.executable_build_options
-            .set_auto_spmd_partitioning_mesh_shape(
-                instance.auto_spmd_mesh_shape);
-        TF_VLOG(3) << "auto_spmd_partitioning_mesh_shape="
-                   << absl::StrJoin(compile_options.executable_build_options
-                                        .auto_spmd_partitioning_mesh_shape(),
-                                    ",");
-      }
-      if (!instance.auto_spmd_mesh_ids.empty()) {
-        compile_options.executable_build_options
-            .set_auto_spmd_partitioning_mesh_ids(instance.auto_spmd_mesh_ids);
-        TF_VLOG(3) << "auto_spmd_partitioning_mesh_ids="
-                   << absl::StrJoin(compile_options.executable_build_options
-                                        .auto_spmd_partitioning_mesh_ids(),
-                                    ",");
+  // Instances are independent from each other, so compile them concurrently.
+  // The number of workers is bounded by the size of compile_pool_.
+  TF_VLOG(3) << "Compiling " << instances.size() << " instances concurrently";
+  std::vector<std::exception_ptr> errors(instances.size());
+  absl::BlockingCounter counter(instances.size());
+  for (size_t i = 0; i < instances.size(); ++i) {
+    compile_pool_->Schedule([&, i]() {
+      try {
+        computations[i] = CompileSingleInstance(instances[i]);
+      } catch (...) {
+        errors[i] = std::current_exception();
       }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  return computations;
+}
 
-      // TODO(244391366) verify this is correct for the collectives ops
-      xla::DeviceAssignment device_assignment(1, client_->device_count());
-      // DeviceAssignment values must be the PjRtDevice ID, so we need to
-      // unwind the global ordinal mapping.
-      for (const auto& [device_id, global_ordinal] : global_ordinals_) {
-        device_assignment(0, global_ordinal) = device_id;
-      }
-      compile_options.executable_build_options.set_device_assignment(
-          device_assignment);
-    } else {
-      // TODO(wcromar): set compile_options.argument_layouts, enable strict
-      // shapes
-      compile_options.executable_build_options.set_num_partitions(1);
-      compile_options.executable_build_options.set_num_replicas(
-          client_->device_count());
-      compile_options.parameter_is_tupled_arguments =
-          instance.parameter_is_tupled_arguments;
-
-      xla::DeviceAssignment device_assignment(client_->device_count(), 1);
-      // DeviceAssignment values must be the PjRtDevice ID, so we need to
-      // unwind the global ordinal mapping.
-      for (const auto& [device_id, global_ordinal] : global_ordinals_) {
-        device_assignment(global_ordinal, 0) = device_id;
-      }
-      compile_options.executable_build_options.set_device_assignment(
-          device_assignment);
+ComputationClient::ComputationPtr PjRtComputationClient::CompileSingleInstance(
+    ComputationClient::CompileInstance& instance) {
+  tsl::profiler::TraceMe activity(
+      "PjRtComputationClient::CompileSingleInstance",
+      tsl::profiler::TraceMeLevel::kInfo);
+  xla::CompileOptions compile_options;
+  if (instance.is_sharded) {
+    // TODO(yeounoh) multi-host, multi-slice configurations
+    compile_options.executable_build_options.set_use_spmd_partitioning(true);
+
+    // We can override the compiler's default behavior to replicate the
+    // outputs. Setting this to true would wrapping the sharded outputs in
+    // PjRtShardedData.
+    compile_options.executable_build_options
+        .set_allow_spmd_sharding_propagation_to_output(
+            {instance.allow_spmd_sharding_propagation_to_output});
+
+    int num_partitions = client_->device_count();
+    compile_options.executable_build_options.set_num_partitions(num_partitions);
+    compile_options.executable_build_options.set_num_replicas(1);
+    compile_options.parameter_is_tupled_arguments =
+        instance.parameter_is_tupled_arguments;
+    compile_options.executable_build_options.set_use_auto_spmd_partitioning(
+        instance.use_auto_spmd_partitioning);
+    TF_VLOG(3) << "Auto SPMD partitioning "
+               << (instance.use_auto_spmd_partitioning ? "enabled!"
+                                                       : "disabled.");
+    if (!instance.auto_spmd_mesh_shape.empty()) {
+      compile_options.executable_build_options
+          .set_auto_spmd_partitioning_mesh_shape(instance.auto_spmd_mesh_shape);
+      TF_VLOG(3) << "auto_spmd_partitioning_mesh_shape="
+                 << absl::StrJoin(compile_options.executable_build_options
+                                      .auto_spmd_partitioning_mesh_shape(),
+                                  ",");
+    }
+    if (!instance.auto_spmd_mesh_ids.empty()) {
+      compile_options.executable_build_options
+          .set_auto_spmd_partitioning_mesh_ids(instance.auto_spmd_mesh_ids);
+      TF_VLOG(3) << "auto_spmd_partitioning_mesh_ids="
+                 << absl::StrJoin(compile_options.executable_build_options
+                                      .auto_spmd_partitioning_mesh_ids(),
+                                  ",");
     }
 
-    std::unique_ptr<xla::PjRtLoadedExecutable> executable;
-    if (runtime::sys_util::GetEnvBool("XLA_STABLEHLO_COMPILE", false)) {
-      // Convert HLO to StableHLO for PjRt client compilation.
-      mlir::MLIRContext context;
-      mlir::ModuleOp mlir_module =
-          mlir::ModuleOp::create(mlir::UnknownLoc::get(&context));
-      ConvertHloToStableHlo(instance.computation.mutable_proto(), &mlir_module);
-      executable = client_->Compile(mlir_module, compile_options).value();
-      StableHloCompileCounter()->AddValue(1);
-    } else {
-      executable =
-          client_->Compile(instance.computation, compile_options).value();
+    // TODO(244391366) verify this is correct for the collectives ops
+    xla::DeviceAssignment device_assignment(1, client_->device_count());
+    // DeviceAssignment values must be the PjRtDevice ID, so we need to
+    // unwind the global ordinal mapping.
+    for (const auto& [device_id, global_ordinal] : global_ordinals_) {
+      device_assignment(0, global_ordinal) = device_id;
     }
+    compile_options.executable_build_options.set_device_assignment(
+        device_assignment);
+  } else {
+    // TODO(wcromar): set compile_options.argument_layouts, enable strict
+    // shapes
+    compile_options.executable_build_options.set_num_partitions(1);
+    compile_options.executable_build_options.set_num_replicas(
+        client_->device_count());
+    compile_options.parameter_is_tupled_arguments =
+        instance.parameter_is_tupled_arguments;
+
+    xla::DeviceAssignment device_assignment(client_->device_count(), 1);
+    // DeviceAssignment values must be the PjRtDevice ID, so we need to
+    // unwind the global ordinal mapping.
+    for (const auto& [device_id, global_ordinal] : global_ordinals_) {
+      device_assignment(global_ordinal, 0) = device_id;
+    }
+    compile_options.executable_build_options.set_device_assignment(
+        device_assignment);
+  }
 
-    auto memory_stats_status_or = executable->GetCompiledMemoryStats();
-    if (memory_stats_status_or.ok()) {
-      xla::CompiledMemoryStats memory_stats = memory_stats_status_or.value();
-      TF_VLOG(3) << "memory usage detail = " << memory_stats.DebugString();
-    } else {
-      TF_VLOG(3) << "memory usage is not availiable";
+  if (!instance.argument_memory_kinds.empty() ||
+      !instance.output_memory_kinds.empty()) {
+    // The host placed parameters and outputs are part of the entry layout, so
+    // that XLA accesses them from the host memory.
+    xla::ProgramShape program_shape =
+        instance.computation.GetProgramShape().value();
+    if (!instance.argument_memory_kinds.empty()) {
+      compile_options.argument_layouts = WithMemoryKinds(
+          program_shape.parameters(), instance.argument_memory_kinds,
+          instance.parameter_is_tupled_arguments);
+    }
+    if (!instance.output_memory_kinds.empty()) {
+      const xla::Shape& result = program_shape.result();
+      compile_options.executable_build_options.set_result_layout(
+          WithMemoryKinds({result}, instance.output_memory_kinds,
+                          /*tupled=*/result.IsTuple())[0]);
     }
+    XLA_COUNTER("CompileWithMemoryKinds", 1);
+  } else if (!instance.auto_layout_parameters.empty() &&
+             !instance.is_sharded && !instance.parameter_is_tupled_arguments) {
+    SetAutoLayoutModes(instance.auto_layout_parameters, &instance.computation);
+    XLA_COUNTER("CompileWithAutoParameterLayouts", 1);
+  }
 
-    const auto& hlo_modules = ConsumeValue(executable->GetHloModules());
-    xla::HloComputation* hlo_computation = hlo_modules[0]->entry_computation();
-    std::shared_ptr<PjRtComputation> pjrt_computation =
-        std::make_shared<PjRtComputation>(
-            std::move(xla::XlaComputation(hlo_modules[0]->ToProto())),
-            instance.devices, std::move(executable));
+  if (instance.backend_optimization_level >= 0) {
+    compile_options.executable_build_options.mutable_debug_options()
+        ->set_xla_backend_optimization_level(
+            instance.backend_optimization_level);
+  }
+  // Read by the CPU client as it configures the module, on this thread.
+  CpuCompileIntraOpThreads() = instance.intra_op_threads;
+  auto to_option_override =
+      [](const auto& option) -> xla::CompileOptions::OptionOverride {
+    return option;
+  };
+  for (const auto& [name, value] : instance.option_overrides) {
+    compile_options.env_option_overrides.emplace_back(
+        name, std::visit(to_option_override, value));
+  }
+  if (!instance.option_overrides.empty()) {
+    XLA_COUNTER("CompileWithOptionOverrides", 1);
+  }
 
-    computations.push_back(pjrt_computation);
+  std::unique_ptr<xla::PjRtLoadedExecutable> executable;
+  static const bool stablehlo_compile =
+      runtime::sys_util::GetEnvBool("XLA_STABLEHLO_COMPILE", false);
+  if (stablehlo_compile) {
+    std::shared_ptr<mlir::MLIRContext> context = GetStablehloContext();
+    mlir::OwningOpRef<mlir::ModuleOp> mlir_module;
+    if (!instance.stablehlo_bytecode.empty()) {
+      mlir_module =
+          DeserializeStablehlo(instance.stablehlo_bytecode, context.get());
+      XLA_COUNTER("StableHloCompileWithoutConversion", 1);
+    } else {
+      // Convert HLO to StableHLO for PjRt client compilation.
+      mlir_module =
+          mlir::ModuleOp::create(mlir::UnknownLoc::get(context.get()));
+      ConvertHloToStableHlo(instance.computation.mutable_proto(),
+                            &*mlir_module);
+    }
+    executable = client_->Compile(*mlir_module, compile_options).value();
+    StableHloCompileCounter()->AddValue(1);
+  } else {
+    executable =
+        client_->Compile(instance.computation, compile_options).value();
+  }
 
-    CreateCompileHandlesCounter()->AddValue(1);
+  auto memory_stats_status_or = executable->GetCompiledMemoryStats();
+  if (memory_stats_status_or.ok()) {
+    xla::CompiledMemoryStats memory_stats = memory_stats_status_or.value();
+    TF_VLOG(3) << "memory usage detail = " << memory_stats.DebugString();
+  } else {
+    TF_VLOG(3) << "memory usage is not availiable";
   }
 
-  return computations;
+  const auto& hlo_modules = ConsumeValue(executable->GetHloModules());
+  xla::HloComputation* hlo_computation = hlo_modules[0]->entry_computation();
+  std::shared_ptr<PjRtComputation> pjrt_computation =
+      std::make_shared<PjRtComputation>(
+          std::move(xla::XlaComputation(hlo_modules[0]->ToProto())),
+          instance.devices, std::move(executable));
+  CountCollectives(pjrt_computation->GetCollectiveStats());
+
+  CreateCompileHandlesCounter()->AddValue(1);
+  return pjrt_computation;
 }
 
 std::string PjRtComputationClient::SerializeComputation(
@@ -647,12 +1342,18 @@ std::string PjRtComputationClient::SerializeComputation(
   const PjRtComputation& pjrt_computation =
       dynamic_cast<const PjRtComputation&>(*computation);
 
-  return ConsumeValue(pjrt_computation.executable->SerializeExecutable());
+  return SerializeWithHlo(
+      pjrt_computation.computation().proto(),
+      ConsumeValue(pjrt_computation.executable->SerializeExecutable()));
 }
 
 ComputationClient::ComputationPtr PjRtComputationClient::DeserializeComputation(
     const std::string& serialized) {
-  auto executable_or = client_->DeserializeExecutable(serialized, std::nullopt);
+  xla::HloModuleProto hlo;
+  absl::string_view serialized_executable = serialized;
+  bool has_hlo = ParseWithHlo(serialized, &hlo, &serialized_executable);
+  auto executable_or =
+      client_->DeserializeExecutable(serialized_executable, std::nullopt);
   if (!executable_or.ok()) {
     TF_LOG(WARNING) << "Failed to deserialize executable: "
                     << executable_or.status();
@@ -660,17 +1361,23 @@ ComputationClient::ComputationPtr PjRtComputationClient::DeserializeComputation(
   }
   auto executable = std::move(*executable_or);
 
-  auto hlo_modules = executable->GetHloModules();
-  if (!hlo_modules.ok()) {
-    TF_LOG(WARNING)
-        << "Failed to retrieve HLO modules from deserialized executable";
-    return nullptr;
+  if (!has_hlo) {
+    auto hlo_modules = executable->GetHloModules();
+    if (!hlo_modules.ok()) {
+      TF_LOG(WARNING)
+          << "Failed to retrieve HLO modules from deserialized executable";
+      return nullptr;
+    }
+    XLA_CHECK(hlo_modules->size() == 1)
+        << "Only a single module is supported for persistent computation "
+           "caching. Please unset the XLA_PERSISTENT_CACHE_PATH "
+           "variable to disable persistent caching.";
+    hlo = (*hlo_modules)[0]->ToProto();
+  }
+  if (has_hlo) {
+    XLA_COUNTER("DeserializedComputationsWithHlo", 1);
   }
-  XLA_CHECK(hlo_modules->size() == 1)
-      << "Only a single module is supported for persistent computation "
-         "caching. Please unset the XLA_PERSISTENT_CACHE_PATH "
-         "variable to disable persistent caching.";
-  xla::XlaComputation computation((*hlo_modules)[0]->ToProto());
+  xla::XlaComputation computation(std::move(hlo));
 
   std::vector<std::string> devices = {UseVirtualDevice() ? spmd_device_str
                                                          : GetDefaultDevice()};
@@ -682,7 +1389,32 @@ torch::lazy::hash_t PjRtComputationClient::HashCompilationEnv() {
   // TODO(jonbolin): Incorporate CompileOptions into the hash. These are
   // deterministically generated at the moment, so they don't need to be
   // included. It will require a small refactor, so punting on this for now.
-  return comp_env_hash_;
+  // The topology description of some backends is costly to serialize, so the
+  // hash is computed on first use rather than at startup.
+  return comp_env_hash_.Get([this](hash::EnvComponents* components) {
+    return ComputeEnvHash(components);
+  });
+}
+
+std::map<std::string, std::string>
+PjRtComputationClient::GetCompilationEnvComponents() {
+  return comp_env_hash_.GetComponents(
+      [this](hash::EnvComponents* components) {
+        return ComputeEnvHash(components);
+      });
+}
+
+void PjRtComputationClient::InvalidateCompilationEnvHash() {
+  comp_env_hash_.Invalidate();
+}
+
+torch::lazy::hash_t PjRtComputationClient::ComputeEnvHash(
+    hash::EnvComponents* components) {
+  std::vector<xla::PjRtDevice*> ordered_devices(client_->device_count());
+  std::partial_sort_copy(client_->devices().begin(), client_->devices().end(),
+                         ordered_devices.begin(), ordered_devices.end(),
+                         [](auto& a, auto& b) { return a->id() < b->id(); });
+  return hash_comp_env(client_.get(), ordered_devices, components);
 }
 
 std::vector<ComputationClient::DataPtr>
@@ -694,24 +1426,63 @@ PjRtComputationClient::ExecuteComputation(
   // once both `ExecuteComputation` and the async work in `ExecuteSharded` are
   // complete; a copy is held from the lambda that releases it when done.
   auto timed = std::make_shared<metrics::TimedSection>(ExecuteMetric());
-  tsl::profiler::TraceMe activity("PjRtComputationClient::ExecuteComputation",
-                                  tsl::profiler::TraceMeLevel::kInfo);
-  TF_VLOG(1) << "Executing PjRt computation on " << device;
+  tsl::profiler::TraceMe activity(
+      [&] {
+        return tsl::profiler::TraceMeEncode(
+            "PjRtComputationClient::ExecuteComputation",
+            {{"graph_hash", options.graph_hash},
+             {"step", options.step_id},
+             {"device", device}});
+      },
+      tsl::profiler::TraceMeLevel::kInfo);
+  TF_HOT_VLOG(1) << "Executing PjRt computation on " << device;
   const PjRtComputation& pjrt_computation =
       dynamic_cast<const PjRtComputation&>(computation);
+  tenant::CheckBudget(options.tenant);
 
   xla::PjRtDevice* pjrt_device = StringToPjRtDevice(device);
   XLA_CHECK(pjrt_device->IsAddressable()) << pjrt_device->DebugString();
 
-  std::vector<xla::PjRtBuffer*> buffers;
-  buffers.reserve(arguments.size());
-  for (auto& argument : arguments) {
-    const PjRtData* pjrt_data = dynamic_cast<PjRtData*>(argument.get());
+  // Pending until the execution completes on the device.
+  std::unique_ptr<ExecutionDispatcher::Ticket> lane_ticket =
+      execution_dispatcher_.Enter(device, options.lane);
+
+  for (size_t i = 0; i < pjrt_computation.auto_parameter_layouts.size() &&
+                     i < arguments.size();
+       ++i) {
+    MaybeRelayoutArgument(pjrt_computation, i, arguments[i]);
+  }
 
-    XLA_CHECK(pjrt_device == pjrt_data->buffer->device())
-        << pjrt_device->DebugString() << " vs "
-        << pjrt_data->buffer->device()->DebugString();
-    buffers.push_back(pjrt_data->buffer.get());
+  std::vector<xla::PjRtBuffer*> buffers;
+  {
+    PjRtComputation::ArgumentTable& table = pjrt_computation.argument_table;
+    std::lock_guard<std::mutex> lock(table.lock);
+    table.Prepare({pjrt_device}, arguments.size());
+    std::vector<xla::PjRtBuffer*>& table_buffers = table.buffers.front();
+    int64_t patched = 0;
+    for (size_t i = 0; i < arguments.size(); ++i) {
+      const DataPtr& argument = arguments[i];
+      if (IsSameData(table.arguments[i], argument) &&
+          static_cast<const PjRtData*>(argument.get())->buffer.get() ==
+              table_buffers[i]) {
+        continue;
+      }
+      const PjRtData* pjrt_data = dynamic_cast<PjRtData*>(argument.get());
+
+      XLA_HOT_CHECK(pjrt_device == pjrt_data->buffer->device())
+          << pjrt_device->DebugString() << " vs "
+          << pjrt_data->buffer->device()->DebugString();
+      table.arguments[i] = argument;
+      table_buffers[i] = pjrt_data->buffer.get();
+      ++patched;
+    }
+    CountArgumentTable(arguments.size(), patched);
+    buffers = table_buffers;
+  }
+  std::vector<std::shared_ptr<xla::PjRtBuffer>> recycled_outputs =
+      TakeRecycledOutputs(pjrt_computation, pjrt_device);
+  for (const std::shared_ptr<xla::PjRtBuffer>& buffer : recycled_outputs) {
+    buffers.push_back(buffer.get());
   }
 
   xla::ExecuteOptions execute_options;
@@ -721,10 +1492,11 @@ PjRtComputationClient::ExecuteComputation(
   // Required as of cl/518733871
   execute_options.use_major_to_minor_data_layout_for_callbacks = true;
 
-  TF_VLOG(5) << "ExecuteComputation acquiring PJRT device lock for " << device;
+  TF_HOT_VLOG(5) << "ExecuteComputation acquiring PJRT device lock for "
+                 << device;
   auto op_tracker = operation_manager_.StartOperation(device);
-  TF_VLOG(5) << "ExecuteComputation acquiring PJRT device lock for " << device
-             << " Done";
+  TF_HOT_VLOG(5) << "ExecuteComputation acquiring PJRT device lock for "
+                 << device << " Done";
 
   std::optional<xla::PjRtFuture<>> returned_future;
   std::vector<std::unique_ptr<xla::PjRtBuffer>> results =
@@ -734,15 +1506,25 @@ PjRtComputationClient::ExecuteComputation(
           .value();
 
   returned_future->OnReady(std::move(
-      [timed, op_tracker = std::move(op_tracker)](xla::Status unused) mutable {
+      [timed, bus_bandwidth = pjrt_computation.bus_bandwidth_metric,
+       bus_bytes = pjrt_computation.GetCollectiveStats().bus_bytes,
+       op_tracker = std::move(op_tracker),
+       lane_ticket = std::move(lane_ticket)](xla::Status unused) mutable {
+        RecordBusBandwidth(bus_bandwidth.get(), bus_bytes, timed->Elapsed());
         timed.reset();
-        TF_VLOG(3) << "ExecuteComputation returned_future->OnReady finished";
+        TF_HOT_VLOG(3)
+            << "ExecuteComputation returned_future->OnReady finished";
       }));
 
   std::vector<DataPtr> datas;
   datas.reserve(results.size());
-  for (auto& result : results) {
-    std::unique_ptr<xla::PjRtBuffer> buffer = std::move(result);
+  for (size_t i = 0; i < results.size(); ++i) {
+    std::shared_ptr<xla::PjRtBuffer> buffer = std::move(results[i]);
+    if (pjrt_computation.IsPinnedHostOutput(i)) {
+      buffer = TrackPinnedHostBuffer(std::move(buffer), device);
+    } else {
+      buffer = TrackTenantOutput(std::move(buffer), options.tenant);
+    }
 
     std::shared_ptr<PjRtData> data =
         std::make_shared<PjRtData>(device, std::move(buffer));
@@ -750,8 +1532,9 @@ PjRtComputationClient::ExecuteComputation(
     datas.push_back(data);
   }
   CreateDataHandlesCounter()->AddValue(datas.size());
+  RecycleOutputs(pjrt_computation, datas);
 
-  TF_VLOG(1) << "Returning " << datas.size() << " results";
+  TF_HOT_VLOG(1) << "Returning " << datas.size() << " results";
   return datas;
 }
 
@@ -766,46 +1549,77 @@ PjRtComputationClient::ExecuteReplicated(
   // complete; a copy is held from the lambda that releases it when done.
   auto timed =
       std::make_shared<metrics::TimedSection>(ExecuteReplicatedMetric());
-  tsl::profiler::TraceMe activity("PjRtComputationClient::ExecuteReplicated",
-                                  tsl::profiler::TraceMeLevel::kInfo);
+  tsl::profiler::TraceMe activity(
+      [&] {
+        return tsl::profiler::TraceMeEncode(
+            "PjRtComputationClient::ExecuteReplicated",
+            {{"graph_hash", options.graph_hash},
+             {"step", options.step_id},
+             {"devices", devices.size()}});
+      },
+      tsl::profiler::TraceMeLevel::kInfo);
   const PjRtComputation& pjrt_computation =
       dynamic_cast<const PjRtComputation&>(computation);
+  tenant::CheckBudget(options.tenant);
+
+  // Pending until the execution completes on the devices.
+  std::unique_ptr<ExecutionDispatcher::Ticket> lane_ticket =
+      execution_dispatcher_.Enter(spmd_device_str, options.lane);
+
+  // Resolved once, rather than once per argument and device.
+  std::vector<xla::PjRtDevice*> pjrt_devices(devices.size());
+  for (size_t d = 0; d < devices.size(); ++d) {
+    pjrt_devices[d] = StringToPjRtDevice(devices[d]);
+    XLA_CHECK(pjrt_devices[d]->IsAddressable())
+        << pjrt_devices[d]->DebugString();
+  }
 
-  std::vector<std::vector<xla::PjRtBuffer*>> argument_handles(
-      devices.size(), std::vector<xla::PjRtBuffer*>(arguments.size()));
+  std::vector<std::vector<xla::PjRtBuffer*>> argument_handles;
   {
     tsl::profiler::TraceMe activity(
         "PjRtComputationClient::ExecuteReplicated_argument_handle",
         tsl::profiler::TraceMeLevel::kInfo);
 
-    absl::BlockingCounter counter(arguments.size());
-
     // Time in nanoseconds that it takes to prepare an argument. Used to tune
     // number of threads spawned by ParallelFor. Measured on 2023/11/28.
     static constexpr int64_t argument_handle_cost_ns = 10000;
+    PjRtComputation::ArgumentTable& table = pjrt_computation.argument_table;
+    std::lock_guard<std::mutex> lock(table.lock);
+    table.Prepare(pjrt_devices, arguments.size());
+    std::atomic<int64_t> patched(0);
+    // ParallelFor returns once all the ranges are done.
     pool_.ParallelFor(
         arguments.size(), argument_handle_cost_ns,
         [&](int64_t start, int64_t end) {
           for (int32_t i = start; i < end; ++i) {
+            if (IsSameData(table.arguments[i], arguments[i])) {
+              const PjRtShardedData* sharded_data =
+                  static_cast<const PjRtShardedData*>(arguments[i].get());
+              bool unchanged = sharded_data->shards.size() == devices.size();
+              for (int32_t d = 0; unchanged && d < devices.size(); d++) {
+                unchanged = sharded_data->shards[d]->buffer.get() ==
+                            table.buffers[d][i];
+              }
+              if (unchanged) {
+                continue;
+              }
+            }
             auto pjrt_data =
                 std::dynamic_pointer_cast<PjRtShardedData>(arguments[i]);
-            XLA_CHECK_EQ(pjrt_data->shards.size(), devices.size())
+            XLA_HOT_CHECK_EQ(pjrt_data->shards.size(), devices.size())
                 << "Expected one shard per device";
 
             for (int32_t d = 0; d < devices.size(); d++) {
-              std::shared_ptr<PjRtData> shard = pjrt_data->shards[d];
-
-              xla::PjRtDevice* pjrt_device = StringToPjRtDevice(devices[d]);
-              XLA_CHECK_EQ(shard->buffer->device(), pjrt_device);
-              XLA_CHECK(pjrt_device->IsAddressable())
-                  << pjrt_device->DebugString();
-
-              argument_handles[d][i] = shard->buffer.get();
+              xla::PjRtBuffer* buffer = pjrt_data->shards[d]->buffer.get();
+              XLA_HOT_CHECK_EQ(buffer->device(), pjrt_devices[d]);
+              table.buffers[d][i] = buffer;
             }
-            counter.DecrementCount();
-          };
+            table.arguments[i] = arguments[i];
+            ++patched;
+          }
         });
-    counter.Wait();
+    CountArgumentTable(arguments.size(), patched);
+    argument_handles = table.buffers;
   }
 
   xla::ExecuteOptions execute_options;
@@ -820,11 +1634,11 @@ PjRtComputationClient::ExecuteReplicated(
   // Grab the shared lock and block the `WaitDeviceOps` until buffer is
   // ready. Since this is the SPMD code path. There is no points to grab
   // devices lock for every individual device.
-  TF_VLOG(5) << "ExecuteReplicated acquiring PJRT device lock for "
-             << spmd_device_str;
+  TF_HOT_VLOG(5) << "ExecuteReplicated acquiring PJRT device lock for "
+                 << spmd_device_str;
   auto op_tracker = operation_manager_.StartOperation(spmd_device_str);
-  TF_VLOG(5) << "ExecuteReplicated acquiring PJRT device lock for "
-             << spmd_device_str << " Done";
+  TF_HOT_VLOG(5) << "ExecuteReplicated acquiring PJRT device lock for "
+                 << spmd_device_str << " Done";
 
   std::optional<std::vector<xla::PjRtFuture<>>> returned_futures =
       std::vector<xla::PjRtFuture<>>();
@@ -833,17 +1647,34 @@ PjRtComputationClient::ExecuteReplicated(
     tsl::profiler::TraceMe activity(
         "PjRtComputationClient::ExecuteReplicated_execute",
         tsl::profiler::TraceMeLevel::kInfo);
+    std::vector<metrics::Counter*> stragglers(pjrt_devices.size());
+    for (size_t d = 0; d < pjrt_devices.size(); ++d) {
+      stragglers[d] = straggler_counters_.at(pjrt_devices[d]);
+    }
+    auto timeline = std::make_shared<ShardTimeline>(sys_util::NowNs(),
+                                                    std::move(stragglers));
     results = pjrt_computation.executable
                   ->Execute(std::move(argument_handles), execute_options,
                             returned_futures)
                   .value();
 
     (*returned_futures)[0].OnReady(
-        std::move([timed, op_tracker = std::move(op_tracker)](
+        std::move([timed, bus_bandwidth = pjrt_computation.bus_bandwidth_metric,
+                   bus_bytes = pjrt_computation.GetCollectiveStats().bus_bytes,
+                   op_tracker = std::move(op_tracker),
+                   lane_ticket = std::move(lane_ticket)](
                       xla::Status unused) mutable {
+          RecordBusBandwidth(bus_bandwidth.get(), bus_bytes, timed->Elapsed());
           timed.reset();
-          TF_VLOG(3) << "ExecuteReplicated returned_future->OnReady finished";
+          TF_HOT_VLOG(3)
+              << "ExecuteReplicated returned_future->OnReady finished";
         }));
+    if (returned_futures->size() == pjrt_devices.size()) {
+      for (size_t d = 0; d < returned_futures->size(); ++d) {
+        (*returned_futures)[d].OnReady(
+            [timeline, d](xla::Status unused) { timeline->ShardReady(d); });
+      }
+    }
   }
 
   size_t num_outputs = results[0].size();
@@ -855,7 +1686,8 @@ PjRtComputationClient::ExecuteReplicated(
         tsl::profiler::TraceMeLevel::kInfo);
 
     const xla::Shape& result_shape = computation.program_shape().result();
-    TF_VLOG(3) << "Processing output with shape " << result_shape.ToString();
+    TF_HOT_VLOG(3) << "Processing output with shape "
+                   << result_shape.ToString();
     const std::vector<xla::Shape>& output_shapes =
         result_shape.IsTuple() ? result_shape.tuple_shapes()
                                : std::vector<xla::Shape>({result_shape});
@@ -870,37 +1702,265 @@ PjRtComputationClient::ExecuteReplicated(
             std::vector<xla::OpSharding>(num_outputs);
     XLA_CHECK_EQ(output_shardings.size(), num_outputs);
 
-    absl::BlockingCounter counter(num_outputs);
-
     // Time in nanoseconds that it takes to process a result buffer.
     // Measured on 2023/11/28.
     static constexpr int64_t result_handle_cost_ns = 10000;
     pool_.ParallelFor(
         num_outputs, result_handle_cost_ns, [&](int64_t start, int64_t end) {
           for (int32_t i = start; i < end; ++i) {
-            std::vector<std::shared_ptr<PjRtData>> shards(devices.size());
+            // The shards of an output are allocated as a single block, which
+            // the shard handles share, rather than one allocation each. The
+            // shards of an output are released together in practice, a shard
+            // kept alone keeps its siblings alive.
+            auto shard_block = std::make_shared<std::vector<PjRtData>>();
+            shard_block->reserve(devices.size());
+            std::vector<std::shared_ptr<PjRtData>> shards;
+            shards.reserve(devices.size());
             for (int32_t d = 0; d < devices.size(); d++) {
-              std::unique_ptr<xla::PjRtBuffer> buffer =
-                  std::move(results[d][i]);
-              shards[d] =
-                  std::make_shared<PjRtData>(devices[d], std::move(buffer));
+              shard_block->emplace_back(devices[d], std::move(results[d][i]));
+              if (pjrt_computation.IsPinnedHostOutput(i)) {
+                shard_block->back().buffer = TrackPinnedHostBuffer(
+                    std::move(shard_block->back().buffer), devices[d]);
+              } else {
+                shard_block->back().buffer = TrackTenantOutput(
+                    std::move(shard_block->back().buffer), options.tenant);
+              }
+              shards.emplace_back(shard_block, &shard_block->back());
             }
 
             data_handles[i] = std::make_shared<PjRtShardedData>(
                 spmd_device_str, output_shapes[i], std::move(shards),
                 output_shardings[i]);
-            TF_VLOG(5) << "Created sharded data with shape "
-                       << data_handles[i]->shape().ToString();
-            counter.DecrementCount();
+            TF_HOT_VLOG(5) << "Created sharded data with shape "
+                           << data_handles[i]->shape().ToString();
           }
         });
-    counter.Wait();
   }
 
-  TF_VLOG(1) << "Returning " << data_handles.size() << " sharded outputs.";
+  TF_HOT_VLOG(1) << "Returning " << data_handles.size()
+                 << " sharded outputs.";
   return data_handles;
 }
 
+std::vector<std::vector<ComputationClient::DataPtr>>
+PjRtComputationClient::ExecuteChained(
+    absl::Span<const ChainedComputation> computations,
+    const std::string& device, const ExecuteChainedOptions& options) {
+  tenant::CheckBudget(options.tenant);
+  // Released once all the computations of the chain are complete, by the
+  // callback of the last one to complete.
+  struct ChainCompletion {
+    std::shared_ptr<metrics::TimedSection> timed;
+    std::unique_ptr<OperationManager::OperationTracker> op_tracker;
+    std::unique_ptr<ExecutionDispatcher::Ticket> lane_ticket;
+  };
+  auto timed = std::make_shared<metrics::TimedSection>(ExecuteChainedMetric());
+  tsl::profiler::TraceMe activity(
+      [&] {
+        return tsl::profiler::TraceMeEncode(
+            "PjRtComputationClient::ExecuteChained",
+            {{"graph_hash", options.graph_hash},
+             {"step", options.step_id},
+             {"computations", computations.size()}});
+      },
+      tsl::profiler::TraceMeLevel::kInfo);
+  TF_HOT_VLOG(1) << "Executing " << computations.size()
+                 << " chained PjRt computations on " << device;
+  XLA_COUNTER("ExecuteChainedComputations", computations.size());
+
+  xla::PjRtDevice* pjrt_device = StringToPjRtDevice(device);
+  XLA_CHECK(pjrt_device->IsAddressable()) << pjrt_device->DebugString();
+
+  std::unique_ptr<ExecutionDispatcher::Ticket> lane_ticket =
+      execution_dispatcher_.Enter(device, options.lane);
+
+  xla::ExecuteOptions execute_options;
+  execute_options.untuple_result = options.explode_tuple;
+  execute_options.strict_shape_checking = false;
+  // Required as of cl/518733871
+  execute_options.use_major_to_minor_data_layout_for_callbacks = true;
+
+  // The whole chain counts as a single device operation.
+  auto op_tracker = operation_manager_.StartOperation(device);
+
+  std::vector<std::vector<DataPtr>> results(computations.size());
+  std::vector<xla::PjRtFuture<>> futures;
+  futures.reserve(computations.size());
+  for (size_t c = 0; c < computations.size(); ++c) {
+    const ChainedComputation& chained = computations[c];
+    const PjRtComputation& pjrt_computation =
+        dynamic_cast<const PjRtComputation&>(*chained.computation);
+
+    std::vector<xla::PjRtBuffer*> buffers;
+    buffers.reserve(chained.arguments.size());
+    for (const ChainedArgument& argument : chained.arguments) {
+      const DataPtr* data = &argument.data;
+      if (*data == nullptr) {
+        XLA_CHECK(argument.computation >= 0 &&
+                  argument.computation < static_cast<int64_t>(c))
+            << "Chained computation " << c << " refers to computation "
+            << argument.computation;
+        const std::vector<DataPtr>& outputs = results[argument.computation];
+        XLA_CHECK(argument.output >= 0 &&
+                  argument.output < static_cast<int64_t>(outputs.size()))
+            << "Chained computation " << c << " refers to output "
+            << argument.output << " of computation " << argument.computation
+            << ", which has " << outputs.size() << " outputs";
+        data = &outputs[argument.output];
+      }
+      MaybeRelayoutArgument(pjrt_computation, buffers.size(), *data);
+      const PjRtData* pjrt_data = dynamic_cast<PjRtData*>(data->get());
+      XLA_CHECK(pjrt_data != nullptr) << "Sharded data cannot be chained";
+      XLA_HOT_CHECK(pjrt_device == pjrt_data->buffer->device())
+          << pjrt_device->DebugString() << " vs "
+          << pjrt_data->buffer->device()->DebugString();
+      buffers.push_back(pjrt_data->buffer.get());
+    }
+    std::vector<std::shared_ptr<xla::PjRtBuffer>> recycled_outputs =
+        TakeRecycledOutputs(pjrt_computation, pjrt_device);
+    for (const std::shared_ptr<xla::PjRtBuffer>& buffer : recycled_outputs) {
+      buffers.push_back(buffer.get());
+    }
+
+    std::optional<xla::PjRtFuture<>> returned_future;
+    std::vector<std::unique_ptr<xla::PjRtBuffer>> buffer_results =
+        pjrt_computation.executable
+            ->ExecuteSharded(buffers, pjrt_device, execute_options,
+                             returned_future)
+            .value();
+    futures.push_back(std::move(*returned_future));
+
+    std::vector<DataPtr>& datas = results[c];
+    datas.reserve(buffer_results.size());
+    for (size_t i = 0; i < buffer_results.size(); ++i) {
+      std::shared_ptr<xla::PjRtBuffer> buffer = std::move(buffer_results[i]);
+      if (pjrt_computation.IsPinnedHostOutput(i)) {
+        buffer = TrackPinnedHostBuffer(std::move(buffer), device);
+      } else {
+        buffer = TrackTenantOutput(std::move(buffer), options.tenant);
+      }
+      datas.push_back(std::make_shared<PjRtData>(device, std::move(buffer)));
+    }
+    CreateDataHandlesCounter()->AddValue(datas.size());
+    RecycleOutputs(pjrt_computation, datas);
+  }
+
+  auto completion = std::make_shared<ChainCompletion>();
+  completion->timed = std::move(timed);
+  completion->op_tracker = std::move(op_tracker);
+  completion->lane_ticket = std::move(lane_ticket);
+  for (xla::PjRtFuture<>& future : futures) {
+    future.OnReady([completion](xla::Status unused) {
+      TF_HOT_VLOG(3) << "ExecuteChained returned_future->OnReady finished";
+    });
+  }
+
+  TF_HOT_VLOG(1) << "Returning the results of " << results.size()
+                 << " chained computations";
+  return results;
+}
+
+std::vector<std::shared_ptr<xla::PjRtBuffer>>
+PjRtComputationClient::TakeRecycledOutputs(const PjRtComputation& computation,
+                                           xla::PjRtDevice* device) {
+  std::vector<std::shared_ptr<xla::PjRtBuffer>> buffers;
+  if (computation.recycled_output_parameters == 0) {
+    return buffers;
+  }
+  const std::vector<xla::Shape>& parameters =
+      computation.program_shape().parameters();
+  std::lock_guard<std::mutex> lock(computation.recycled_outputs.lock);
+  std::vector<std::shared_ptr<xla::PjRtBuffer>>& outputs =
+      computation.recycled_outputs.buffers;
+  for (size_t i = parameters.size() - computation.recycled_output_parameters;
+       i < parameters.size(); ++i) {
+    // An output still held by any data, like the one of a live tensor or of
+    // an execution future, is not reused.
+    auto it = std::find_if(
+        outputs.begin(), outputs.end(),
+        [&](const std::shared_ptr<xla::PjRtBuffer>& buffer) {
+          return buffer.use_count() == 1 && buffer->device() == device &&
+                 !buffer->IsDeleted() &&
+                 xla::ShapeUtil::Compatible(buffer->on_device_shape(),
+                                            parameters[i]);
+        });
+    if (it != outputs.end()) {
+      buffers.push_back(std::move(*it));
+      outputs.erase(it);
+      XLA_COUNTER("RecycledOutputBuffers", 1);
+    } else {
+      buffers.push_back(
+          client_->CreateUninitializedBuffer(parameters[i], device).value());
+      XLA_COUNTER("RecycledOutputAllocations", 1);
+    }
+  }
+  // The outputs not taken are released along with their data.
+  outputs.clear();
+  return buffers;
+}
+
+void PjRtComputationClient::MaybeRelayoutArgument(
+    const PjRtComputation& computation, size_t index,
+    const DataPtr& argument) {
+  if (index >= computation.auto_parameter_layouts.size() ||
+      !computation.auto_parameter_layouts[index].has_value()) {
+    return;
+  }
+  PjRtData* pjrt_data = dynamic_cast<PjRtData*>(argument.get());
+  if (pjrt_data == nullptr || !pjrt_data->HasValue()) {
+    return;
+  }
+  const xla::Layout& layout = *computation.auto_parameter_layouts[index];
+  if (xla::GetXlaLayoutUnsafe(pjrt_data->buffer->layout()) == layout) {
+    return;
+  }
+  XLA_COUNTER("AutoLayoutRelayouts", 1);
+  auto literal = std::make_shared<xla::Literal>(
+      host_output_shape(pjrt_data->buffer.get()));
+  XLA_CHECK_OK(pjrt_data->buffer->ToLiteral(literal.get()).Await());
+  std::optional<absl::InlinedVector<int64_t, 4>> strides =
+      xla::ShapeUtil::ByteStrides(literal->shape());
+  std::optional<absl::Span<const int64_t>> byte_strides;
+  if (strides.has_value()) {
+    byte_strides = *strides;
+  }
+  pjrt_data->buffer =
+      client_
+          ->BufferFromHostBuffer(
+              literal->untyped_data(), literal->shape().element_type(),
+              literal->shape().dimensions(), byte_strides,
+              xla::PjRtClient::HostBufferSemantics::
+                  kImmutableUntilTransferCompletes,
+              [literal]() { /* frees literal */ },
+              pjrt_data->buffer->memory_space(), &layout)
+          .value();
+}
+
+void PjRtComputationClient::RecycleOutputs(const PjRtComputation& computation,
+                                           absl::Span<const DataPtr> outputs) {
+  if (computation.recycled_output_parameters == 0) {
+    return;
+  }
+  const std::vector<xla::Shape>& parameters =
+      computation.program_shape().parameters();
+  std::lock_guard<std::mutex> lock(computation.recycled_outputs.lock);
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    if (computation.IsPinnedHostOutput(i)) {
+      continue;
+    }
+    const std::shared_ptr<xla::PjRtBuffer>& buffer =
+        static_cast<const PjRtData*>(outputs[i].get())->buffer;
+    for (size_t p = parameters.size() - computation.recycled_output_parameters;
+         p < parameters.size(); ++p) {
+      if (xla::ShapeUtil::Compatible(buffer->on_device_shape(),
+                                     parameters[p])) {
+        computation.recycled_outputs.buffers.push_back(buffer);
+        break;
+      }
+    }
+  }
+}
+
 size_t PjRtComputationClient::GetNumDevices() const {
   return client_->addressable_device_count();
 }
@@ -970,10 +2030,27 @@ ComputationClient::MemoryInfo PjRtComputationClient::GetMemoryInfo(
       PjRtComputationClient::StringToPjRtDevice(device);
   tsl::AllocatorStats stats = pjrt_device->GetAllocatorStats().value();
 
-  return {
-      stats.bytes_in_use,
-      *stats.bytes_limit,
-  };
+  MemoryInfo info;
+  info.bytes_used = stats.bytes_in_use;
+  info.bytes_limit = *stats.bytes_limit;
+  info.pinned_host_bytes_used = pinned_host_bytes_.at(device)->load();
+  info.peak_bytes_used = stats.peak_bytes_in_use;
+  info.largest_free_block_bytes = stats.largest_free_block_bytes;
+  int64_t free_bytes = info.bytes_limit - info.bytes_used;
+  if (info.largest_free_block_bytes > 0 && free_bytes > 0) {
+    info.fragmentation =
+        1.0 - static_cast<double>(std::min(info.largest_free_block_bytes,
+                                           free_bytes)) /
+                  free_bytes;
+  }
+  return info;
+}
+
+ComputationClient::OperationStats PjRtComputationClient::GetOperationStats(
+    const std::string& device) {
+  OperationManager::Stats stats = operation_manager_.GetStats(device);
+  return {stats.inflight, stats.high_water_mark, stats.blocked_ns,
+          stats.rejected};
 }
 
 }  // namespace runtime
@@ -3,15 +3,29 @@
 
 #include <torch/csrc/lazy/backend/backend_data.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <shared_mutex>
+#include <unordered_map>
+#include <variant>
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "absl/types/span.h"
+#include "torch_xla/csrc/runtime/cache.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/env_hash.h"
+#include "torch_xla/csrc/runtime/execution_dispatcher.h"
+#include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/operation_manager.h"
 #include "torch_xla/csrc/runtime/util.h"
+#include "torch_xla/csrc/runtime/xla_util.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/threadpool.h"
 #include "xla/client/xla_computation.h"
@@ -30,7 +44,8 @@ class PjRtComputationClient : public ComputationClient {
 
   DataPtr CreateDataPlaceholder(
       std::string device, xla::Shape shape,
-      std::optional<xla::OpSharding> sharding = std::nullopt) override;
+      std::optional<xla::OpSharding> sharding = std::nullopt,
+      MemoryKind memory_kind = MemoryKind::kDevice) override;
 
   static DataPtr CreateData(std::string device, xla::Shape shape,
                             std::shared_ptr<xla::PjRtBuffer> pjrt_buffer);
@@ -58,6 +73,17 @@ class PjRtComputationClient : public ComputationClient {
   std::vector<xla::Literal> TransferFromDevice(
       absl::Span<const DataPtr> handles) override;
 
+  std::vector<xla::PjRtFuture<>> TransferFromDeviceAsync(
+      absl::Span<const DataPtr> handles,
+      const TransferDestinationFn& destination_fn) override;
+
+  std::vector<xla::PjRtFuture<>> GetReadyFutures(
+      absl::Span<const DataPtr> handles) override;
+
+  HostBufferPool* GetHostBufferPool() override {
+    return host_buffer_pool_.get();
+  }
+
   std::uintptr_t UnsafeBufferPointer(const DataPtr handle) override;
 
   std::shared_ptr<xla::PjRtBuffer> GetPjRtBuffer(const DataPtr handle) override;
@@ -68,6 +94,8 @@ class PjRtComputationClient : public ComputationClient {
 
   DataPtr CopyToDevice(DataPtr data, std::string dst) override;
 
+  DataPtr CopyToMemoryKind(DataPtr data, MemoryKind memory_kind) override;
+
   std::vector<ComputationPtr> Compile(
       std::vector<CompileInstance> instances) override;
 
@@ -85,6 +113,11 @@ class PjRtComputationClient : public ComputationClient {
       absl::Span<const std::string> devices,
       const ExecuteReplicatedOptions& options) override;
 
+  std::vector<std::vector<DataPtr>> ExecuteChained(
+      absl::Span<const ChainedComputation> computations,
+      const std::string& device,
+      const ExecuteChainedOptions& options) override;
+
   size_t GetNumDevices() const override;
 
   std::string GetDefaultDevice() const override;
@@ -121,6 +154,10 @@ class PjRtComputationClient : public ComputationClient {
 
   torch::lazy::hash_t HashCompilationEnv() override;
 
+  std::map<std::string, std::string> GetCompilationEnvComponents() override;
+
+  void InvalidateCompilationEnvHash() override;
+
   int GetProcessIndex() const override { return client_->process_index(); };
 
   int GetNumProcesses() const override;
@@ -148,6 +185,8 @@ class PjRtComputationClient : public ComputationClient {
 
   MemoryInfo GetMemoryInfo(const std::string& device) override;
 
+  OperationStats GetOperationStats(const std::string& device) override;
+
   std::string PjRtDeviceToString(xla::PjRtDevice* const device) const override;
   std::vector<std::string> PjRtDevicesToString(
       absl::Span<xla::PjRtDevice* const> devices) const;
@@ -161,12 +200,62 @@ class PjRtComputationClient : public ComputationClient {
   std::unordered_map<std::string, xla::PjRtDevice* const> string_to_device_;
   std::shared_ptr<std::vector<std::string>> replication_devices_;
   OperationManager operation_manager_;
+  ExecutionDispatcher execution_dispatcher_;
   tsl::thread::ThreadPool pool_ = tsl::thread::ThreadPool(
       tsl::Env::Default(), "pjrt", std::thread::hardware_concurrency());
-  torch::lazy::hash_t comp_env_hash_;
+  // Compilations can take minutes, so they get their own pool to not delay
+  // the short lived work scheduled on pool_. Null when compiling serially.
+  std::unique_ptr<tsl::thread::ThreadPool> compile_pool_;
+  // Reusable host buffers for device transfers. Null when disabled.
+  std::shared_ptr<HostBufferPool> host_buffer_pool_;
+  hash::CachedEnvHash comp_env_hash_;
+
+  // Counts, for every addressable device, the replicated executions whose
+  // shard was ready last on the device by a margin of the execution time.
+  std::unordered_map<xla::PjRtDevice*, metrics::Counter*> straggler_counters_;
+
+  // The bytes of the live pinned host buffers of each device.
+  std::unordered_map<std::string, std::shared_ptr<std::atomic<int64_t>>>
+      pinned_host_bytes_;
+
+  // The compiled resharding programs, by the hash of their argument shapes
+  // and of their source and target shardings. Persisted along with the
+  // compiled graphs when XLA_PERSISTENT_CACHE_PATH is set.
+  using ReshardCache = util::AbstractCache<torch::lazy::hash_t, Computation,
+                                           torch::lazy::HashReducer>;
+  std::once_flag reshard_cache_once_;
+  std::unique_ptr<ReshardCache> reshard_cache_;
+
+  ReshardCache* GetReshardCache();
 
   xla::PjRtDevice* StringToPjRtDevice(const std::string& device);
 
+  // The memory space of `memory_kind` of `device`, or nullptr if the device
+  // has none (counter MemoryKindFallback), in which case the device memory is
+  // used instead.
+  xla::PjRtMemorySpace* GetMemorySpace(xla::PjRtDevice* device,
+                                       MemoryKind memory_kind);
+
+  // Accounts for the bytes of a pinned host buffer of `device` until it is
+  // released.
+  std::shared_ptr<xla::PjRtBuffer> TrackPinnedHostBuffer(
+      std::shared_ptr<xla::PjRtBuffer> buffer, const std::string& device);
+
+  // Holds the `charge` of a tenant (see tenant::Charge) until the buffer is
+  // released.
+  std::shared_ptr<xla::PjRtBuffer> TrackTenantBuffer(
+      std::shared_ptr<xla::PjRtBuffer> buffer, std::shared_ptr<void> charge);
+
+  // Charges the bytes of an output buffer to `tenant` until it is released.
+  std::shared_ptr<xla::PjRtBuffer> TrackTenantOutput(
+      std::shared_ptr<xla::PjRtBuffer> buffer, const std::string& tenant);
+
+  ComputationPtr CompileSingleInstance(CompileInstance& instance);
+
+  // Hashes the compilation environment, adding the values hashed to
+  // `components`.
+  torch::lazy::hash_t ComputeEnvHash(hash::EnvComponents* components);
+
   struct PjRtData : public Data {
     PjRtData(std::string device, xla::Shape device_shape)
         : Data(std::move(device), std::move(device_shape)) {}
@@ -194,6 +283,15 @@ class PjRtComputationClient : public ComputationClient {
 
     bool HasSharding() const override { return false; }
 
+    MemoryKind memory_kind() const override {
+      if (buffer == nullptr || buffer->memory_space() == nullptr) {
+        return Data::memory_kind();
+      }
+      return buffer->memory_space()->kind() == "pinned_host"
+                 ? MemoryKind::kPinnedHost
+                 : MemoryKind::kDevice;
+    }
+
     xla::OpSharding GetSharding() const override {
       XLA_CHECK(false) << "GetSharding should not be called on PjRtData, check "
                           "HasSharding first";
@@ -270,6 +368,10 @@ class PjRtComputationClient : public ComputationClient {
 
     bool HasSharding() const override { return true; }
 
+    MemoryKind memory_kind() const override {
+      return shards.empty() ? Data::memory_kind() : shards[0]->memory_kind();
+    }
+
     xla::OpSharding GetSharding() const override { return sharding; }
 
     std::vector<std::shared_ptr<PjRtData>> shards;
@@ -283,6 +385,71 @@ class PjRtComputationClient : public ComputationClient {
         : Computation(std::move(computation), std::move(devices)),
           executable(std::move(executable)) {
       output_shardings_ = this->executable->GetOutputShardings();
+      auto output_memory_kinds = this->executable->GetOutputMemoryKinds();
+      if (output_memory_kinds.ok() && !output_memory_kinds->empty()) {
+        for (absl::string_view kind : output_memory_kinds->front()) {
+          MemoryKind memory_kind = kind == "pinned_host"
+                                       ? MemoryKind::kPinnedHost
+                                       : MemoryKind::kDevice;
+          has_pinned_host_outputs |= memory_kind == MemoryKind::kPinnedHost;
+          this->output_memory_kinds.push_back(memory_kind);
+        }
+      }
+      auto memory_stats = this->executable->GetCompiledMemoryStats();
+      if (memory_stats.ok()) {
+        compiled_memory_stats_ = CompiledMemoryStats{
+            memory_stats->argument_size_in_bytes,
+            memory_stats->output_size_in_bytes,
+            memory_stats->alias_size_in_bytes,
+            memory_stats->temp_size_in_bytes,
+            memory_stats->generated_code_size_in_bytes};
+      }
+      auto hlo_modules = this->executable->GetHloModules();
+      if (hlo_modules.ok() && !hlo_modules->empty()) {
+        const xla::HloModule& module = *hlo_modules->front();
+        collective_stats_ = util::GetCollectiveStats(module);
+        if (!collective_stats_.empty()) {
+          bus_bandwidth_metric = std::make_shared<metrics::Metric>(
+              absl::StrCat("ExecuteCollectiveBusBandwidth.", module.name()),
+              metrics::MetricFnBandwidth);
+        }
+        const auto& attributes = module.frontend_attributes().map();
+        auto modes = attributes.find(kArgLayoutModesAttribute);
+        if (modes != attributes.end()) {
+          std::vector<absl::string_view> parameter_modes =
+              absl::StrSplit(modes->second, ';');
+          const xla::ComputationLayout& layout =
+              module.entry_computation_layout();
+          size_t parameters = std::min<size_t>(parameter_modes.size(),
+                                               layout.parameter_count());
+          for (size_t i = 0; i < parameters; ++i) {
+            if (parameter_modes[i] == "auto" &&
+                layout.parameter_shape(i).has_layout()) {
+              auto_parameter_layouts.resize(parameter_modes.size());
+              auto_parameter_layouts[i] = layout.parameter_shape(i).layout();
+            }
+          }
+        }
+      }
+      const std::vector<std::string>& parameter_names =
+          program_shape().parameter_names();
+      while (recycled_output_parameters < parameter_names.size() &&
+             absl::StartsWith(
+                 parameter_names[parameter_names.size() - 1 -
+                                 recycled_output_parameters],
+                 kRecycledOutputParameter)) {
+        ++recycled_output_parameters;
+      }
+      auto cost_analysis = this->executable->GetCostAnalysis();
+      if (cost_analysis.ok()) {
+        for (const auto& [name, value] : *cost_analysis) {
+          if (const float* cost = std::get_if<float>(&value)) {
+            cost_analysis_[name] = *cost;
+          } else if (const int64_t* cost = std::get_if<int64_t>(&value)) {
+            cost_analysis_[name] = static_cast<double>(*cost);
+          }
+        }
+      }
     }
 
     const std::string get_memory_info() const override {
@@ -294,10 +461,91 @@ class PjRtComputationClient : public ComputationClient {
       }
     }
 
+    std::optional<CompiledMemoryStats> GetCompiledMemoryStats()
+        const override {
+      return compiled_memory_stats_;
+    }
+
+    std::map<std::string, double> GetCostAnalysis() const override {
+      return cost_analysis_;
+    }
+
+    const util::CollectiveStats& GetCollectiveStats() const override {
+      return collective_stats_;
+    }
+
     std::unique_ptr<xla::PjRtLoadedExecutable> executable;
     std::optional<std::vector<xla::OpSharding>> output_shardings_;
+    std::optional<CompiledMemoryStats> compiled_memory_stats_;
+    std::map<std::string, double> cost_analysis_;
+    util::CollectiveStats collective_stats_;
+    // The bus bandwidth of the executions, for executables with collectives.
+    // Shared with the callbacks recording it once the executions complete.
+    std::shared_ptr<metrics::Metric> bus_bandwidth_metric;
+    // The memory kinds of the outputs, when the executable reports them.
+    std::vector<MemoryKind> output_memory_kinds;
+    bool has_pinned_host_outputs = false;
+
+    bool IsPinnedHostOutput(size_t index) const {
+      return has_pinned_host_outputs && index < output_memory_kinds.size() &&
+             output_memory_kinds[index] == MemoryKind::kPinnedHost;
+    }
+
+    // The validated argument buffers of the last execution. The arguments of
+    // consecutive executions are mostly the same data (eg. the weights), whose
+    // buffers are then reused as is, only the changed arguments are validated
+    // and patched in.
+    struct ArgumentTable {
+      std::mutex lock;
+      std::vector<xla::PjRtDevice*> devices;
+      std::vector<std::weak_ptr<Data>> arguments;
+      // buffers[d][i] is the buffer of the argument i on devices[d].
+      std::vector<std::vector<xla::PjRtBuffer*>> buffers;
+
+      // Resets the table if the devices or the argument count changed.
+      void Prepare(absl::Span<xla::PjRtDevice* const> devices,
+                   size_t num_arguments);
+    };
+    mutable ArgumentTable argument_table;
+
+    // The trailing kRecycledOutputParameter parameters, and the output buffers
+    // of the last execution, which the next one takes for them once they are
+    // only held here.
+    size_t recycled_output_parameters = 0;
+    struct RecycledOutputs {
+      std::mutex lock;
+      std::vector<std::shared_ptr<xla::PjRtBuffer>> buffers;
+    };
+    mutable RecycledOutputs recycled_outputs;
+    // The layouts the compiler chose for the parameters compiled with auto
+    // layouts, indexed by parameter, empty if none.
+    std::vector<std::optional<xla::Layout>> auto_parameter_layouts;
+
+    // The frontend attribute of the module holding the layout mode of each
+    // parameter, read by the PJRT compilers.
+    static constexpr const char* kArgLayoutModesAttribute = "arg_layout_modes";
+    static constexpr const char* kOutLayoutModesAttribute = "out_layout_modes";
   };
 
+  // Relayouts, in place through the host, the argument `index` of
+  // `computation` when it is held in another layout than the one the compiler
+  // chose for it (counter AutoLayoutRelayouts). The data keeps the new layout,
+  // so this happens once per tensor.
+  void MaybeRelayoutArgument(const PjRtComputation& computation, size_t index,
+                             const DataPtr& argument);
+
+  // The buffers of the recycled output parameters of an execution of
+  // `computation` on `device`: the released outputs of its last execution of
+  // the same shapes (counter RecycledOutputBuffers), or new uninitialized
+  // ones (counter RecycledOutputAllocations).
+  std::vector<std::shared_ptr<xla::PjRtBuffer>> TakeRecycledOutputs(
+      const PjRtComputation& computation, xla::PjRtDevice* device);
+
+  // Keeps the device outputs of an execution of `computation` which match its
+  // recycled output parameters, for its next execution.
+  void RecycleOutputs(const PjRtComputation& computation,
+                      absl::Span<const DataPtr> outputs);
+
   // Use XLA replication to re-assemble the sharded data.
   std::shared_ptr<PjRtData> ReplicateShardedData(const DataPtr& handle);
 };
@@ -0,0 +1,210 @@
+// Benchmarks of the host side of PjRtComputationClient on CPU, as a signal of
+// the runtime overheads without accelerators: the transfer bandwidth by size,
+// the compile latency by graph size and the dispatch overhead of the
+// executions by argument and device count. The single device benchmarks run
+// on the CPU plugin of plugins/cpu loaded through PJRT_LIBRARY_PATH, and the
+// replicated ones on the built-in CPU client with CPU_NUM_DEVICES devices, as
+// the plugin is created with one device.
+//
+//   bazel run //torch_xla/csrc/runtime:pjrt_computation_client_bench
+
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "torch_xla/csrc/runtime/computation_client.h"
+#include "torch_xla/csrc/runtime/pjrt_computation_client.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+#include "torch_xla/csrc/runtime/tensor_source.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/logging.h"
+#include "xla/client/xla_builder.h"
+#include "xla/hlo/ir/hlo_sharding.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace {
+
+// The client with `num_devices` CPU devices, created once per count.
+ComputationClient* GetClient(int num_devices) {
+  static auto* clients =
+      new std::map<int, std::unique_ptr<PjRtComputationClient>>();
+  std::unique_ptr<PjRtComputationClient>& client = (*clients)[num_devices];
+  if (client == nullptr) {
+    if (num_devices == 1 &&
+        !sys_util::GetEnvString("PJRT_LIBRARY_PATH", "").empty()) {
+      tsl::setenv("PJRT_DEVICE", "LIBRARY", true);
+      tsl::setenv("PJRT_DYNAMIC_PLUGINS", "1", true);
+    } else {
+      tsl::setenv("PJRT_DEVICE", "CPU", true);
+      tsl::setenv("CPU_NUM_DEVICES", absl::StrCat(num_devices).c_str(), true);
+    }
+    client = std::make_unique<PjRtComputationClient>();
+  }
+  return client.get();
+}
+
+xla::Shape VectorShape(int64_t bytes) {
+  return xla::ShapeUtil::MakeShape(xla::F32, {bytes / 4});
+}
+
+std::shared_ptr<const TensorSource> MakeSource(const xla::Shape& shape,
+                                               const std::string& device) {
+  xla::Literal literal(shape);
+  literal.PopulateWithValue(1.0f);
+  return std::make_shared<LiteralSource>(std::move(literal), device);
+}
+
+ComputationClient::ComputationPtr CompileOne(ComputationClient* client,
+                                             xla::XlaComputation computation,
+                                             const xla::Shape& output_shape,
+                                             bool is_sharded = false) {
+  std::string device = client->GetDefaultDevice();
+  std::vector<ComputationClient::CompileInstance> instances;
+  instances.push_back(ComputationClient::CompileInstance(
+      std::move(computation), device,
+      client->GetCompilationDevices(device, is_sharded
+                                                ? client->GetLocalDevices()
+                                                : std::vector<std::string>()),
+      &output_shape, /*parameter_is_tupled_arguments=*/false, is_sharded));
+  return client->Compile(std::move(instances))[0];
+}
+
+// The sum of `num_args` scalars, a computation doing no work to speak of.
+xla::XlaComputation SumComputation(int64_t num_args, bool is_sharded) {
+  xla::Shape shape = xla::ShapeUtil::MakeShape(xla::F32, {});
+  xla::XlaBuilder builder("Sum");
+  if (is_sharded) {
+    builder.SetSharding(xla::HloSharding::Replicate().ToProto());
+  }
+  xla::XlaOp sum = xla::ConstantR0<float>(&builder, 0.0f);
+  std::vector<xla::XlaOp> parameters;
+  for (int64_t i = 0; i < num_args; ++i) {
+    parameters.push_back(
+        xla::Parameter(&builder, i, shape, absl::StrCat("p", i)));
+  }
+  builder.ClearSharding();
+  for (const xla::XlaOp& parameter : parameters) {
+    sum = xla::Add(sum, parameter);
+  }
+  xla::Tuple(&builder, {sum});
+  return builder.Build().value();
+}
+
+void BM_TransferToDevice(benchmark::State& state) {
+  ComputationClient* client = GetClient(1);
+  std::string device = client->GetDefaultDevice();
+  std::vector<std::shared_ptr<const TensorSource>> sources = {
+      MakeSource(VectorShape(state.range(0)), device)};
+  for (auto _ : state) {
+    std::vector<ComputationClient::DataPtr> data =
+        client->TransferToDevice(sources);
+    benchmark::DoNotOptimize(data);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransferToDevice)->RangeMultiplier(8)->Range(1 << 12, 1 << 27);
+
+void BM_TransferFromDevice(benchmark::State& state) {
+  ComputationClient* client = GetClient(1);
+  std::string device = client->GetDefaultDevice();
+  std::vector<std::shared_ptr<const TensorSource>> sources = {
+      MakeSource(VectorShape(state.range(0)), device)};
+  std::vector<ComputationClient::DataPtr> data =
+      client->TransferToDevice(sources);
+  for (auto _ : state) {
+    std::vector<xla::Literal> literals = client->TransferFromDevice(data);
+    benchmark::DoNotOptimize(literals);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TransferFromDevice)->RangeMultiplier(8)->Range(1 << 12, 1 << 27);
+
+// Compiles a chain of `range(0)` elementwise ops, each on a new shape so that
+// the compiler does not fold them.
+void BM_Compile(benchmark::State& state) {
+  ComputationClient* client = GetClient(1);
+  xla::Shape shape = xla::ShapeUtil::MakeShape(xla::F32, {128});
+  for (auto _ : state) {
+    xla::XlaBuilder builder("Chain");
+    xla::XlaOp x = xla::Parameter(&builder, 0, shape, "x");
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      x = i % 2 == 0 ? xla::Tanh(x)
+                     : xla::Add(x, xla::ConstantR0<float>(&builder, i));
+    }
+    xla::Tuple(&builder, {x});
+    xla::Shape output_shape = xla::ShapeUtil::MakeTupleShape({shape});
+    ComputationClient::ComputationPtr computation =
+        CompileOne(client, builder.Build().value(), output_shape);
+    benchmark::DoNotOptimize(computation);
+  }
+  state.counters["ops"] = state.range(0);
+}
+BENCHMARK(BM_Compile)
+    ->RangeMultiplier(4)
+    ->Range(16, 4096)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_ExecuteComputation(benchmark::State& state) {
+  ComputationClient* client = GetClient(1);
+  std::string device = client->GetDefaultDevice();
+  int64_t num_args = state.range(0);
+  xla::Shape output_shape = xla::ShapeUtil::MakeTupleShape(
+      {xla::ShapeUtil::MakeShape(xla::F32, {})});
+  ComputationClient::ComputationPtr computation = CompileOne(
+      client, SumComputation(num_args, /*is_sharded=*/false), output_shape);
+  std::vector<std::shared_ptr<const TensorSource>> sources(
+      num_args, MakeSource(xla::ShapeUtil::MakeShape(xla::F32, {}), device));
+  std::vector<ComputationClient::DataPtr> arguments =
+      client->TransferToDevice(sources);
+  ComputationClient::ExecuteComputationOptions options;
+  for (auto _ : state) {
+    std::vector<ComputationClient::DataPtr> results =
+        client->ExecuteComputation(*computation, arguments, device, options);
+    client->WaitDeviceOps({});
+    benchmark::DoNotOptimize(results);
+  }
+}
+BENCHMARK(BM_ExecuteComputation)->RangeMultiplier(4)->Range(1, 1024);
+
+// The arguments by range(0), and the devices by range(1).
+void BM_ExecuteReplicated(benchmark::State& state) {
+  int64_t num_args = state.range(0);
+  ComputationClient* client = GetClient(state.range(1));
+  std::vector<std::string> devices = client->GetLocalDevices();
+  xla::Shape shape = xla::ShapeUtil::MakeShape(xla::F32, {});
+  xla::Shape output_shape = xla::ShapeUtil::MakeTupleShape({shape});
+  ComputationClient::ComputationPtr computation =
+      CompileOne(client, SumComputation(num_args, /*is_sharded=*/true),
+                 output_shape, /*is_sharded=*/true);
+  xla::OpSharding replicated = xla::HloSharding::Replicate().ToProto();
+  std::vector<ComputationClient::DataPtr> arguments;
+  for (int64_t i = 0; i < num_args; ++i) {
+    std::vector<std::shared_ptr<const TensorSource>> shards;
+    for (const std::string& device : devices) {
+      shards.push_back(MakeSource(shape, device));
+    }
+    arguments.push_back(client->TransferShardsToDevice(
+        shards, ComputationClient::spmd_device_str, shape, replicated));
+  }
+  ComputationClient::ExecuteReplicatedOptions options;
+  for (auto _ : state) {
+    std::vector<ComputationClient::DataPtr> results =
+        client->ExecuteReplicated(*computation, arguments, devices, options);
+    client->WaitDeviceOps({});
+    benchmark::DoNotOptimize(results);
+  }
+}
+BENCHMARK(BM_ExecuteReplicated)
+    ->ArgsProduct({benchmark::CreateRange(1, 256, /*multi=*/16), {2, 4, 8}});
+
+}  // namespace
+}  // namespace runtime
+}  // namespace torch_xla
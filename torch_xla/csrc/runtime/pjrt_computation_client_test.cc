@@ -2,11 +2,15 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+
 #include "torch_xla/csrc/runtime/computation_client.h"
+#include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/pjrt_computation_client.h"
 #include "torch_xla/csrc/runtime/tensor_source.h"
 #include "tsl/lib/core/status_test_util.h"
@@ -15,6 +19,7 @@
 #include "tsl/platform/test.h"
 #include "xla/client/xla_builder.h"
 #include "xla/client/xla_computation.h"
+#include "xla/hlo/ir/hlo_sharding.h"
 #include "xla/literal.h"
 #include "xla/literal_util.h"
 #include "xla/status.h"
@@ -78,5 +83,274 @@ TEST(PjRtComputationClientTest, Init) {
       result_literals[0]));
 }
 
+TEST(PjRtComputationClientTest, ArgumentTable) {
+  tsl::setenv("PJRT_DEVICE", "CPU", true);
+  auto client = std::make_unique<PjRtComputationClient>();
+  std::string device = client->GetDefaultDevice();
+
+  auto shape = xla::ShapeUtil::MakeShape(xla::F32, {2, 2});
+  std::vector<ComputationClient::CompileInstance> instances;
+  instances.push_back(ComputationClient::CompileInstance(
+      std::move(MakeComputation().value()), device,
+      client->GetCompilationDevices(device, client->GetLocalDevices()),
+      &shape));
+  std::vector<ComputationClient::ComputationPtr> computations =
+      client->Compile(std::move(instances));
+
+  auto transfer = [&](xla::Literal literal) {
+    std::vector<std::shared_ptr<const TensorSource>> args = {
+        std::make_shared<LiteralSource>(std::move(literal), device)};
+    return client->TransferToDevice(absl::MakeConstSpan(args)).front();
+  };
+  ComputationClient::DataPtr x =
+      transfer(xla::LiteralUtil::CreateR2<float>({{1.0f, 2.0f}, {3.0f, 4.0f}}));
+  ComputationClient::DataPtr y =
+      transfer(xla::LiteralUtil::CreateR2<float>({{5.0f, 6.0f}, {7.0f, 8.0f}}));
+  auto patched = [] {
+    metrics::CounterData* counter = metrics::GetCounter("ArgumentTablePatched");
+    return counter != nullptr ? counter->Value() : 0;
+  };
+
+  // The first execution binds both arguments, the second reuses them, the
+  // third only patches the replaced one.
+  ComputationClient::ExecuteComputationOptions options{};
+  int64_t start = patched();
+  client->ExecuteComputation(*computations[0], {x, y}, device, options);
+  EXPECT_EQ(patched() - start, 2);
+  client->ExecuteComputation(*computations[0], {x, y}, device, options);
+  EXPECT_EQ(patched() - start, 2);
+  y = transfer(xla::LiteralUtil::CreateR2<float>({{1.0f, 1.0f}, {1.0f, 1.0f}}));
+  std::vector<ComputationClient::DataPtr> results =
+      client->ExecuteComputation(*computations[0], {x, y}, device, options);
+  EXPECT_EQ(patched() - start, 3);
+
+  auto result_literals = client->TransferFromDevice(results);
+  ASSERT_THAT(result_literals, ::testing::SizeIs(1));
+  EXPECT_TRUE(xla::LiteralTestUtil::Equal(
+      xla::LiteralUtil::CreateR2<float>({{2.0f, 3.0f}, {4.0f, 5.0f}}),
+      result_literals[0]));
+}
+
+TEST(PjRtComputationClientTest, ExecuteChained) {
+  tsl::setenv("PJRT_DEVICE", "CPU", true);
+  auto client = std::make_unique<PjRtComputationClient>();
+  std::string device = client->GetDefaultDevice();
+
+  auto shape = xla::ShapeUtil::MakeShape(xla::F32, {2, 2});
+  std::vector<ComputationClient::CompileInstance> instances;
+  instances.push_back(ComputationClient::CompileInstance(
+      std::move(MakeComputation().value()), device,
+      client->GetCompilationDevices(device, client->GetLocalDevices()),
+      &shape));
+  std::vector<ComputationClient::ComputationPtr> computations =
+      client->Compile(std::move(instances));
+
+  std::vector<std::shared_ptr<const TensorSource>> args = {
+      std::make_shared<LiteralSource>(
+          xla::LiteralUtil::CreateR2<float>({{1.0f, 2.0f}, {3.0f, 4.0f}}),
+          device),
+      std::make_shared<LiteralSource>(
+          xla::LiteralUtil::CreateR2<float>({{5.0f, 6.0f}, {7.0f, 8.0f}}),
+          device)};
+  std::vector<ComputationClient::DataPtr> inputs =
+      client->TransferToDevice(absl::MakeConstSpan(args));
+
+  // a = x + y, b = a + y, c = b + a, with a and b staying on the device.
+  std::vector<ComputationClient::ChainedComputation> chain = {
+      {computations[0], {inputs[0], inputs[1]}},
+      {computations[0], {{0, 0}, inputs[1]}},
+      {computations[0], {{1, 0}, {0, 0}}},
+  };
+  ComputationClient::ExecuteChainedOptions options{};
+  std::vector<std::vector<ComputationClient::DataPtr>> results =
+      client->ExecuteChained(chain, device, options);
+
+  ASSERT_EQ(results.size(), 3);
+  for (const std::vector<ComputationClient::DataPtr>& outputs : results) {
+    ASSERT_EQ(outputs.size(), 1);
+  }
+  auto result_literals = client->TransferFromDevice(
+      {results[0][0], results[1][0], results[2][0]});
+  ASSERT_THAT(result_literals, ::testing::SizeIs(3));
+  EXPECT_TRUE(xla::LiteralTestUtil::Equal(
+      xla::LiteralUtil::CreateR2<float>({{6.0f, 8.0f}, {10.0f, 12.0f}}),
+      result_literals[0]));
+  EXPECT_TRUE(xla::LiteralTestUtil::Equal(
+      xla::LiteralUtil::CreateR2<float>({{11.0f, 14.0f}, {17.0f, 20.0f}}),
+      result_literals[1]));
+  EXPECT_TRUE(xla::LiteralTestUtil::Equal(
+      xla::LiteralUtil::CreateR2<float>({{17.0f, 22.0f}, {27.0f, 32.0f}}),
+      result_literals[2]));
+}
+
+TEST(PjRtComputationClientTest, MemoryKind) {
+  tsl::setenv("PJRT_DEVICE", "CPU", true);
+  auto client = std::make_unique<PjRtComputationClient>();
+  std::string device = client->GetDefaultDevice();
+  auto fallbacks = [] {
+    metrics::CounterData* counter = metrics::GetCounter("MemoryKindFallback");
+    return counter != nullptr ? counter->Value() : 0;
+  };
+
+  // Without pinned host memory, the data stays in device memory.
+  auto source = std::make_shared<LiteralSource>(
+      xla::LiteralUtil::CreateR2<float>({{1.0f, 2.0f}, {3.0f, 4.0f}}), device);
+  source->set_memory_kind(MemoryKind::kPinnedHost);
+  int64_t start = fallbacks();
+  std::vector<std::shared_ptr<const TensorSource>> args = {source};
+  ComputationClient::DataPtr data =
+      client->TransferToDevice(absl::MakeConstSpan(args)).front();
+  if (data->memory_kind() == MemoryKind::kDevice) {
+    EXPECT_EQ(fallbacks() - start, 1);
+  }
+
+  ComputationClient::DataPtr moved =
+      client->CopyToMemoryKind(data, MemoryKind::kDevice);
+  EXPECT_EQ(moved->memory_kind(), MemoryKind::kDevice);
+  auto result_literals = client->TransferFromDevice({moved});
+  ASSERT_THAT(result_literals, ::testing::SizeIs(1));
+  EXPECT_TRUE(xla::LiteralTestUtil::Equal(
+      xla::LiteralUtil::CreateR2<float>({{1.0f, 2.0f}, {3.0f, 4.0f}}),
+      result_literals[0]));
+
+  ComputationClient::DataPtr placeholder = client->CreateDataPlaceholder(
+      device, xla::ShapeUtil::MakeShape(xla::F32, {2, 2}), std::nullopt,
+      MemoryKind::kPinnedHost);
+  EXPECT_EQ(placeholder->memory_kind(), MemoryKind::kPinnedHost);
+}
+
+TEST(PjRtComputationClientTest, TransferReplicatedShards) {
+  tsl::setenv("PJRT_DEVICE", "CPU", true);
+  tsl::setenv("CPU_NUM_DEVICES", "4", true);
+  auto client = std::make_unique<PjRtComputationClient>();
+  std::vector<std::string> devices = client->GetLocalDevices();
+  ASSERT_EQ(devices.size(), 4);
+  auto counter = [](const std::string& name) {
+    metrics::CounterData* data = metrics::GetCounter(name);
+    return data != nullptr ? data->Value() : 0;
+  };
+  xla::Literal literal =
+      xla::LiteralUtil::CreateR2<float>({{1.0f, 2.0f}, {3.0f, 4.0f}});
+  int64_t shard_bytes = xla::ShapeUtil::ByteSizeOf(literal.shape());
+
+  // Replicated over all the devices, implicitly replicated for auto-sharding,
+  // and partially replicated over two groups of two devices.
+  std::vector<xla::OpSharding> shardings = {
+      xla::HloSharding::Replicate().ToProto(),
+      xla::HloSharding::Unknown().ToProto(),
+      xla::HloSharding::PartialTile(xla::TileAssignment({2, 1, 2}))
+          .ToProto()};
+  std::vector<int64_t> expected_uploads = {1, 1, 2};
+  for (size_t s = 0; s < shardings.size(); ++s) {
+    std::vector<std::shared_ptr<const TensorSource>> shards;
+    for (const std::string& device : devices) {
+      shards.push_back(
+          std::make_shared<LiteralSource>(literal.Clone(), device));
+    }
+    int64_t host_bytes = counter("TransferShardsHostBytes");
+    int64_t copied_bytes = counter("TransferShardsDeviceCopyBytes");
+    ComputationClient::DataPtr data = client->TransferShardsToDevice(
+        shards, ComputationClient::spmd_device_str, literal.shape(),
+        shardings[s]);
+    EXPECT_EQ(counter("TransferShardsHostBytes") - host_bytes,
+              expected_uploads[s] * shard_bytes);
+    EXPECT_EQ(counter("TransferShardsDeviceCopyBytes") - copied_bytes,
+              (devices.size() - expected_uploads[s]) * shard_bytes);
+
+    std::vector<ComputationClient::DataPtr> data_shards =
+        client->GetDataShards(data);
+    ASSERT_EQ(data_shards.size(), devices.size());
+    for (size_t i = 0; i < data_shards.size(); ++i) {
+      EXPECT_EQ(data_shards[i]->device(), devices[i]);
+    }
+    std::vector<xla::Literal> literals =
+        client->TransferFromDevice(data_shards);
+    for (const xla::Literal& shard_literal : literals) {
+      EXPECT_TRUE(xla::LiteralTestUtil::Equal(literal, shard_literal));
+    }
+  }
+}
+
+// Measures the host latency of ExecuteReplicated, which prepares the argument
+// handles and wraps the result buffers for every device, against the number of
+// local devices.
+TEST(PjRtComputationClientTest, ExecuteReplicatedDispatchLatency) {
+  constexpr int kNumArguments = 16;
+  constexpr int kNumOutputs = 256;
+  constexpr int kIterations = 10;
+  tsl::setenv("PJRT_DEVICE", "CPU", true);
+  for (int num_devices : {1, 2, 4, 8}) {
+    tsl::setenv("CPU_NUM_DEVICES", absl::StrCat(num_devices).c_str(), true);
+    auto client = std::make_unique<PjRtComputationClient>();
+    std::vector<std::string> devices = client->GetLocalDevices();
+    ASSERT_EQ(devices.size(), num_devices);
+
+    xla::Shape shape = xla::ShapeUtil::MakeShape(xla::F32, {2, 2});
+    xla::OpSharding replicated = xla::HloSharding::Replicate().ToProto();
+    xla::XlaBuilder builder("DispatchLatency");
+    builder.SetSharding(replicated);
+    std::vector<xla::XlaOp> parameters;
+    for (int i = 0; i < kNumArguments; ++i) {
+      parameters.push_back(
+          xla::Parameter(&builder, i, shape, absl::StrCat("p", i)));
+    }
+    std::vector<xla::XlaOp> outputs;
+    for (int i = 0; i < kNumOutputs; ++i) {
+      outputs.push_back(xla::Add(parameters[i % kNumArguments],
+                                 xla::ConstantR0<float>(&builder, i)));
+    }
+    builder.ClearSharding();
+    xla::Tuple(&builder, outputs);
+    xla::Shape output_shape = xla::ShapeUtil::MakeTupleShape(
+        std::vector<xla::Shape>(kNumOutputs, shape));
+
+    std::string device = client->GetDefaultDevice();
+    std::vector<ComputationClient::CompileInstance> instances;
+    instances.push_back(ComputationClient::CompileInstance(
+        builder.Build().value(), device,
+        client->GetCompilationDevices(device, {}), &output_shape,
+        /*parameter_is_tupled_arguments=*/false, /*is_sharded=*/true));
+    std::vector<ComputationClient::ComputationPtr> computations =
+        client->Compile(std::move(instances));
+
+    std::vector<ComputationClient::DataPtr> arguments;
+    for (int i = 0; i < kNumArguments; ++i) {
+      std::vector<std::shared_ptr<const TensorSource>> shards;
+      for (const std::string& shard_device : devices) {
+        shards.push_back(std::make_shared<LiteralSource>(
+            xla::LiteralUtil::CreateR2<float>({{1.0f, 2.0f}, {3.0f, 4.0f}}),
+            shard_device));
+      }
+      arguments.push_back(client->TransferShardsToDevice(
+          shards, ComputationClient::spmd_device_str, shape, replicated));
+    }
+
+    ComputationClient::ExecuteReplicatedOptions options;
+    std::vector<ComputationClient::DataPtr> results;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+      results = client->ExecuteReplicated(*computations[0], arguments, devices,
+                                          options);
+    }
+    int64_t latency_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count() /
+        kIterations;
+    LOG(INFO) << "ExecuteReplicated dispatch latency with " << num_devices
+              << " devices, " << kNumArguments << " arguments and "
+              << kNumOutputs << " outputs: " << latency_us << "us";
+
+    ASSERT_EQ(results.size(), kNumOutputs);
+    std::vector<ComputationClient::DataPtr> last = {results.back()};
+    std::vector<xla::Literal> literals = client->TransferFromDevice(last);
+    EXPECT_TRUE(xla::LiteralTestUtil::Equal(
+        xla::LiteralUtil::CreateR2<float>(
+            {{1.0f + kNumOutputs - 1, 2.0f + kNumOutputs - 1},
+             {3.0f + kNumOutputs - 1, 4.0f + kNumOutputs - 1}}),
+        literals[0]));
+  }
+}
+
 }  // namespace runtime
 }  // namespace torch_xla
@@ -1,12 +1,19 @@
 #include "torch_xla/csrc/runtime/pjrt_registry.h"
 
+#include <pthread.h>
+#include <sched.h>
+
+#include <future>
+
 #include "absl/log/initialize.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/env_vars.h"
+#include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/profiler.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/tf_logging.h"
 #include "torch_xla/csrc/runtime/xla_coordinator.h"
+#include "tsl/platform/numa.h"
 #include "xla/pjrt/c/pjrt_c_api.h"
 #include "xla/pjrt/distributed/client.h"
 #include "xla/pjrt/distributed/distributed.h"
@@ -15,6 +22,7 @@
 #include "xla/pjrt/pjrt_api.h"
 #include "xla/pjrt/pjrt_c_api_client.h"
 #include "xla/pjrt/tfrt_cpu_pjrt_client.h"
+#include "xla/service/hlo_module_config.h"
 
 namespace torch_xla {
 namespace runtime {
@@ -57,6 +65,14 @@ xla::GpuAllocatorConfig GetGpuAllocatorConfig() {
   return allocator_config;
 }
 
+std::unique_ptr<XlaCoordinator> CreateCoordinator(
+    int global_process_rank, int global_world_size,
+    const std::string& master_addr, const std::string& port) {
+  XLA_TIMED("PjRtStartupCoordinatorTime");
+  return std::make_unique<XlaCoordinator>(global_process_rank,
+                                          global_world_size, master_addr, port);
+}
+
 std::shared_ptr<const PjRtPlugin> GetPjRtPlugin(
     const std::string& device_type) {
   auto plugin_path = pjrt_plugins_.find(device_type);
@@ -71,6 +87,11 @@ void RegisterPjRtPlugin(std::string name,
   pjrt_plugins_[name] = plugin;
 }
 
+int64_t& CpuCompileIntraOpThreads() {
+  thread_local int64_t intra_op_threads = 0;
+  return intra_op_threads;
+}
+
 std::tuple<std::unique_ptr<xla::PjRtClient>, std::unique_ptr<XlaCoordinator>>
 InitializePjRt(const std::string& device_type) {
   std::unique_ptr<xla::PjRtClient> client;
@@ -82,8 +103,19 @@ InitializePjRt(const std::string& device_type) {
     if (plugin) {
       TF_VLOG(1) << "Initializing client for PjRt plugin " << device_type;
 
+      auto load_plugin = [&]() {
+        XLA_TIMED("PjRtStartupPluginLoadTime");
+        const PJRT_Api* c_api = *pjrt::LoadPjrtPlugin(
+            absl::AsciiStrToLower(device_type), plugin->library_path());
+        XLA_CHECK_OK(pjrt::InitializePjrtPlugin(device_type));
+        return c_api;
+      };
+      std::future<const PJRT_Api*> c_api_future;
       std::shared_ptr<xla::KeyValueStoreInterface> kv_store = nullptr;
       if (plugin->requires_xla_coordinator()) {
+        // Loading the plugin does not depend on the coordinator, which waits
+        // for all the processes to connect, so the two run at once.
+        c_api_future = std::async(std::launch::async, load_plugin);
         int local_process_rank = sys_util::GetEnvInt(
             env::kEnvPjRtLocalRank, sys_util::GetEnvInt("LOCAL_RANK", 0));
         int global_process_rank =
@@ -104,16 +136,16 @@ InitializePjRt(const std::string& device_type) {
                    << ", coordinator address=" << master_addr << ":" << port;
 
         // Use the XlaCoordinator as the distributed key-value store.
-        coordinator = std::make_unique<XlaCoordinator>(
-            global_process_rank, global_world_size, master_addr, port);
+        coordinator = CreateCoordinator(global_process_rank,
+                                        global_world_size, master_addr, port);
         std::shared_ptr<xla::DistributedRuntimeClient> distributed_client =
             coordinator->GetClient();
         kv_store = xla::GetDistributedKeyValueStore(distributed_client,
                                                     /*key_prefix=*/"pjrt:");
+      } else {
+        c_api_future = std::async(std::launch::deferred, load_plugin);
       }
-      const PJRT_Api* c_api = *pjrt::LoadPjrtPlugin(
-          absl::AsciiStrToLower(device_type), plugin->library_path());
-      XLA_CHECK_OK(pjrt::InitializePjrtPlugin(device_type));
+      const PJRT_Api* c_api = c_api_future.get();
       auto create_options = plugin->client_create_options();
       client = xla::GetCApiClient(
                    absl::AsciiStrToUpper(device_type),
@@ -125,7 +157,39 @@ InitializePjRt(const std::string& device_type) {
     TF_VLOG(1) << "Initializing PjRt CPU client...";
     bool async = sys_util::GetEnvBool(env::kEnvPjrtAsyncCpuClient, true);
     int cpu_device_count = sys_util::GetEnvInt(env::kEnvNumCpu, 1);
-    client = std::move(xla::GetTfrtCpuClient(async, cpu_device_count).value());
+    int64_t default_intra_op_threads =
+        sys_util::GetEnvInt(env::kEnvCpuIntraOpThreads, 0);
+    auto customize_hlo_module_config =
+        [default_intra_op_threads](xla::HloModuleConfig& config) {
+          int64_t intra_op_threads = CpuCompileIntraOpThreads() > 0
+                                         ? CpuCompileIntraOpThreads()
+                                         : default_intra_op_threads;
+          if (intra_op_threads > 0) {
+            config.set_intra_op_parallelism_threads(intra_op_threads);
+          }
+        };
+    // The client starts its execution threads as it is created, and they
+    // inherit the affinity of the creating thread, so binding this thread to
+    // the node meanwhile binds the executions to it.
+    int numa_node = sys_util::GetEnvInt(env::kEnvCpuNumaNode, -1);
+    cpu_set_t affinity;
+    bool restore_affinity = false;
+    if (numa_node >= 0 && tsl::port::NUMAEnabled()) {
+      XLA_CHECK_LT(numa_node, tsl::port::NUMANumNodes())
+          << env::kEnvCpuNumaNode << " is not a node of this host";
+      restore_affinity =
+          pthread_getaffinity_np(pthread_self(), sizeof(affinity),
+                                 &affinity) == 0;
+      tsl::port::NUMASetThreadNodeAffinity(numa_node);
+    }
+    client = std::move(xla::GetTfrtCpuClient(
+                           async, cpu_device_count,
+                           /*max_inflight_computations_per_device=*/32,
+                           customize_hlo_module_config)
+                           .value());
+    if (restore_affinity) {
+      pthread_setaffinity_np(pthread_self(), sizeof(affinity), &affinity);
+    }
   } else if (device_type == "TPU") {
     TF_VLOG(1) << "Initializing TFRT TPU client...";
     // Init the absl logging to avoid the log spam.
@@ -134,9 +198,12 @@ InitializePjRt(const std::string& device_type) {
     auto tpu_library_path = sys_util::GetEnvString(
         env::kEnvTpuLibraryPath,
         sys_util::GetEnvString(env::kEnvInferredTpuLibraryPath, "libtpu.so"));
-    XLA_CHECK_OK(pjrt::LoadPjrtPlugin("tpu", tpu_library_path).status());
-    xla::Status tpu_status = pjrt::InitializePjrtPlugin("tpu");
-    XLA_CHECK_OK(tpu_status);
+    {
+      XLA_TIMED("PjRtStartupPluginLoadTime");
+      XLA_CHECK_OK(pjrt::LoadPjrtPlugin("tpu", tpu_library_path).status());
+      xla::Status tpu_status = pjrt::InitializePjrtPlugin("tpu");
+      XLA_CHECK_OK(tpu_status);
+    }
     client = std::move(xla::GetCApiClient("TPU").value());
     const PJRT_Api* c_api =
         static_cast<xla::PjRtCApiClient*>(client.get())->pjrt_c_api();
@@ -174,8 +241,8 @@ InitializePjRt(const std::string& device_type) {
           runtime::sys_util::GetEnvString("MASTER_ADDR", "localhost");
       std::string port = runtime::sys_util::GetEnvString(
           "XLA_COORDINATOR_PORT", XlaCoordinator::kDefaultCoordinatorPort);
-      coordinator = std::make_unique<XlaCoordinator>(
-          global_process_rank, global_world_size, master_addr, port);
+      coordinator = CreateCoordinator(global_process_rank, global_world_size,
+                                      master_addr, port);
       std::shared_ptr<xla::DistributedRuntimeClient> distributed_client =
           coordinator->GetClient();
       kv_store = xla::GetDistributedKeyValueStore(distributed_client,
@@ -1,6 +1,8 @@
 #ifndef XLA_CLIENT_INITIALIZE_PJRT_CLIENT_H_
 #define XLA_CLIENT_INITIALIZE_PJRT_CLIENT_H_
 
+#include <cstdint>
+
 #include "torch_xla/csrc/runtime/xla_coordinator.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_common.h"
@@ -24,6 +26,11 @@ void RegisterPjRtPlugin(std::string name,
 std::tuple<std::unique_ptr<xla::PjRtClient>, std::unique_ptr<XlaCoordinator>>
 InitializePjRt(const std::string& device_type);
 
+// The intra-op parallelism of the CPU executables compiled on the calling
+// thread, which the CPU client reads as it configures their modules. Zero for
+// the default of XLA_CPU_INTRA_OP_THREADS.
+int64_t& CpuCompileIntraOpThreads();
+
 }  // namespace runtime
 }  // namespace torch_xla
 
@@ -1,9 +1,19 @@
 #include "torch_xla/csrc/runtime/profiler.h"
 
+#include <algorithm>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "torch_xla/csrc/runtime/metrics.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/tf_logging.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/host_info.h"
 #include "tsl/profiler/lib/profiler_factory.h"
+#include "tsl/profiler/lib/profiler_session.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
 #include "tsl/profiler/rpc/client/capture_profile.h"
+#include "tsl/profiler/rpc/client/save_profile.h"
 #include "tsl/profiler/rpc/profiler_server.h"
 #include "xla/backends/profiler/plugin/plugin_tracer.h"
 #include "xla/backends/profiler/plugin/profiler_c_api.h"
@@ -56,6 +66,88 @@ xla::Status Trace(
       options);
 }
 
+struct StepTraceSampler::Impl {
+  std::unique_ptr<tsl::ProfilerSession> session;
+};
+
+StepTraceSampler::StepTraceSampler(std::string logdir, int64_t every_n_steps,
+                                   int64_t trace_steps, size_t max_traces)
+    : logdir_(std::move(logdir)),
+      every_n_steps_(std::max<int64_t>(every_n_steps, 1)),
+      trace_steps_(std::max<int64_t>(trace_steps, 1)),
+      max_traces_(std::max<size_t>(max_traces, 1)),
+      impl_(new Impl()) {}
+
+StepTraceSampler::~StepTraceSampler() {}
+
+void StepTraceSampler::MarkStep(int64_t step) {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (impl_->session != nullptr && step + 1 >= first_step_ + trace_steps_) {
+    StopTrace();
+  }
+  if (impl_->session == nullptr && (step + 1) % every_n_steps_ == 0) {
+    StartTrace(step + 1);
+  }
+}
+
+void StepTraceSampler::StartTrace(int64_t step) {
+  std::unique_ptr<tsl::ProfilerSession> session =
+      tsl::ProfilerSession::Create(tsl::ProfilerSession::DefaultOptions());
+  absl::Status status = session->Status();
+  if (!status.ok()) {
+    TF_VLOG(1) << "Skipping the sampled trace of step " << step << ": "
+               << status;
+    return;
+  }
+  impl_->session = std::move(session);
+  first_step_ = step;
+}
+
+void StepTraceSampler::StopTrace() {
+  tensorflow::profiler::XSpace xspace;
+  absl::Status status = impl_->session->CollectData(&xspace);
+  impl_->session.reset();
+  std::string run = absl::StrCat("step_", first_step_);
+  std::string repository_root =
+      tsl::profiler::GetTensorBoardProfilePluginDir(logdir_);
+  if (status.ok()) {
+    status = tsl::profiler::SaveXSpace(repository_root, run,
+                                       tsl::port::Hostname(), xspace);
+  }
+  if (!status.ok()) {
+    TF_LOG(WARNING) << "Failed to write the sampled trace of step "
+                    << first_step_ << " to " << logdir_ << ": " << status;
+    return;
+  }
+  XLA_COUNTER("SampledTraces", 1);
+  runs_.push_back(absl::StrCat(repository_root, "/", run));
+  while (runs_.size() > max_traces_) {
+    int64_t undeleted_files = 0;
+    int64_t undeleted_dirs = 0;
+    status = tsl::Env::Default()->DeleteRecursively(
+        runs_.front(), &undeleted_files, &undeleted_dirs);
+    if (!status.ok()) {
+      TF_LOG(WARNING) << "Failed to delete the sampled trace " << runs_.front()
+                      << ": " << status;
+    }
+    runs_.pop_front();
+  }
+}
+
+StepTraceSampler* GetStepTraceSampler() {
+  static StepTraceSampler* sampler = []() -> StepTraceSampler* {
+    std::string logdir = sys_util::GetEnvString("XLA_SAMPLED_TRACE_DIR", "");
+    if (logdir.empty()) {
+      return nullptr;
+    }
+    return new StepTraceSampler(
+        logdir, sys_util::GetEnvInt("XLA_SAMPLED_TRACE_EVERY_N_STEPS", 1000),
+        sys_util::GetEnvInt("XLA_SAMPLED_TRACE_STEPS", 1),
+        sys_util::GetEnvInt("XLA_SAMPLED_TRACE_MAX_TRACES", 10));
+  }();
+  return sampler;
+}
+
 void RegisterProfilerForPlugin(const PJRT_Api* c_api) {
   const PLUGIN_Profiler_Api* profiler_api = FindProfilerApi(c_api);
   if (!profiler_api) {
@@ -1,7 +1,11 @@
 #ifndef XLA_CLIENT_PROFILER_H_
 #define XLA_CLIENT_PROFILER_H_
 
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <string>
 
 #include "absl/container/flat_hash_map.h"
 #include "xla/pjrt/c/pjrt_c_api.h"
@@ -23,6 +27,43 @@ class ProfilerServer {
   std::unique_ptr<Impl> impl_;
 };
 
+// Captures in-process traces of `trace_steps` steps every `every_n_steps`
+// steps, so that intermittent slowdowns of long running jobs get traced
+// without a remote capture. The traces are written as TensorBoard profile runs
+// named after their first step under `logdir`, of which the newest
+// `max_traces` are kept. A capture is skipped if another profiler session is
+// active.
+class StepTraceSampler {
+  struct Impl;
+
+ public:
+  StepTraceSampler(std::string logdir, int64_t every_n_steps,
+                   int64_t trace_steps, size_t max_traces);
+  ~StepTraceSampler();
+
+  // Called once `step` is marked, starting or stopping the capture of the
+  // steps which follow.
+  void MarkStep(int64_t step);
+
+ private:
+  void StartTrace(int64_t step);
+  void StopTrace();
+
+  std::string logdir_;
+  int64_t every_n_steps_;
+  int64_t trace_steps_;
+  size_t max_traces_;
+  std::mutex lock_;
+  std::unique_ptr<Impl> impl_;
+  int64_t first_step_ = 0;
+  // The profile runs written, oldest first.
+  std::deque<std::string> runs_;
+};
+
+// The sampler configured by XLA_SAMPLED_TRACE_DIR and the other
+// XLA_SAMPLED_TRACE_* variables, or nullptr if not enabled.
+StepTraceSampler* GetStepTraceSampler();
+
 xla::Status Trace(
     const char* service_addr, const char* logdir, int duration_ms,
     int num_tracing_attempts,
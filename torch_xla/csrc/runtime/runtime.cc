@@ -4,6 +4,7 @@
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/env_vars.h"
 #include "torch_xla/csrc/runtime/ifrt_computation_client.h"
+#include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/pjrt_computation_client.h"
 #include "tsl/platform/stacktrace_handler.h"
 
@@ -18,6 +19,7 @@ ComputationClient* GetComputationClient() {
       tsl::testing::InstallStacktraceHandler();
     }
 
+    XLA_TIMED("ComputationClientStartupTime");
     std::unique_ptr<ComputationClient> client;
 
     static bool use_ifrt = sys_util::GetEnvBool("XLA_USE_IFRT", false);
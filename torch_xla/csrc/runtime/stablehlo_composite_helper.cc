@@ -4,9 +4,12 @@
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <vector>
 
 #include "absl/log/log.h"
 #include "absl/strings/str_cat.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "mlir/Analysis/TopologicalSortUtils.h"
 #include "mlir/IR/IRMapping.h"
 #include "mlir/Support/LogicalResult.h"
@@ -61,6 +64,10 @@ struct BoundaryMetadata {
     return Build(j);
   }
 
+  bool SameBoundary(const BoundaryMetadata& other) const {
+    return name == other.name && id == other.id;
+  }
+
  private:
   template <typename T>
   static bool CopyJsonValue(const nlohmann::basic_json<>& j,
@@ -102,6 +109,82 @@ struct BoundaryMetadata {
   }
 };
 
+// The ops of a function in order, and the metadata of its boundary markers,
+// parsed in a single walk for all the composites built from the function.
+class BoundaryIndex {
+ public:
+  explicit BoundaryIndex(mlir::func::FuncOp func_op) {
+    std::unordered_map<std::string, size_t> boundaries;
+    for (const auto& op : llvm::enumerate(func_op.getOps())) {
+      mlir::Operation* operation = &op.value();
+      op_order_[operation] = op.index();
+      if (!IsXlaMarkTensorOp(operation)) {
+        continue;
+      }
+      auto backend_config = llvm::dyn_cast_or_null<mlir::StringAttr>(
+          operation->getAttr("backend_config"));
+      if (backend_config == nullptr) {
+        continue;
+      }
+      std::unique_ptr<BoundaryMetadata> metadata =
+          BoundaryMetadata::Parse(backend_config);
+      if (metadata == nullptr) {
+        operation->emitError() << "invalid boundary metadata JSON.";
+        invalid_.insert(operation);
+        continue;
+      }
+      if (!metadata->is_input) {
+        auto [it, inserted] =
+            boundaries.emplace(metadata->boundary_key(), output_ops_.size());
+        if (inserted) {
+          output_ops_.emplace_back();
+        }
+        llvm::SmallVector<mlir::Operation*>& output_ops =
+            output_ops_[it->second];
+        if (metadata->pos >= output_ops.size()) {
+          output_ops.resize(metadata->pos + 1, nullptr);
+        }
+        output_ops[metadata->pos] = operation;
+      }
+      metadata_[operation] = std::move(metadata);
+    }
+  }
+
+  // The metadata of `op`, or nullptr if it is not a boundary marker. Fails
+  // for the markers with invalid metadata.
+  mlir::FailureOr<const BoundaryMetadata*> Lookup(mlir::Operation* op) const {
+    if (invalid_.contains(op)) {
+      return mlir::failure();
+    }
+    auto it = metadata_.find(op);
+    return it != metadata_.end() ? it->second.get() : nullptr;
+  }
+
+  bool HasOrder(const mlir::Operation* op) const {
+    return op_order_.contains(op);
+  }
+
+  size_t Order(const mlir::Operation* op) const { return op_order_.at(op); }
+
+  void SetOrder(const mlir::Operation* op, size_t order) {
+    op_order_[op] = order;
+  }
+
+  // The output markers of each boundary, by position, in the order of their
+  // first marker.
+  const std::vector<llvm::SmallVector<mlir::Operation*>>& boundary_output_ops()
+      const {
+    return output_ops_;
+  }
+
+ private:
+  llvm::DenseMap<const mlir::Operation*, size_t> op_order_;
+  llvm::DenseMap<const mlir::Operation*, std::unique_ptr<BoundaryMetadata>>
+      metadata_;
+  llvm::DenseSet<const mlir::Operation*> invalid_;
+  std::vector<llvm::SmallVector<mlir::Operation*>> output_ops_;
+};
+
 class BuildStableHLOCompositePass : public mlir::OperationPass<mlir::ModuleOp> {
  public:
   explicit BuildStableHLOCompositePass()
@@ -112,20 +195,25 @@ class BuildStableHLOCompositePass : public mlir::OperationPass<mlir::ModuleOp> {
 
   void runOnOperation() override {
     mlir::ModuleOp module_op = getOperation();
+    mlir::SymbolTable symbol_table(module_op);
     llvm::SmallVector<mlir::func::FuncOp> func_ops(
         module_op.getOps<mlir::func::FuncOp>());
     for (mlir::func::FuncOp& func_op : func_ops) {
-      llvm::DenseMap<const mlir::Operation*, size_t> op_order_map =
-          BuildOpOrderMap(func_op);
-      std::unordered_map<std::string, llvm::SmallVector<mlir::Operation*>>
-          boundary_output_ops_map = BuildBoundaryOutputOpsMap(func_op);
-
-      for (const auto& [unused, ops] : boundary_output_ops_map) {
-        if (mlir::failed(BuildStableHLOComposite(ops, op_order_map))) {
+      BoundaryIndex index(func_op);
+      for (const auto& ops : index.boundary_output_ops()) {
+        if (mlir::failed(BuildStableHLOComposite(ops, &index, symbol_table))) {
           func_op.emitError() << "failed to build composite.";
           return signalPassFailure();
         }
       }
+      // The composites are inserted after their first output, possibly before
+      // some of their args, so the function is sorted once they are all built.
+      if (!index.boundary_output_ops().empty() &&
+          !mlir::sortTopologically(&func_op.getBody().front())) {
+        func_op.emitError() << "The graph is not acyclic after "
+                               "BuildStableHLOCompositePass pass.";
+        return signalPassFailure();
+      }
     }
   }
 
@@ -138,58 +226,6 @@ class BuildStableHLOCompositePass : public mlir::OperationPass<mlir::ModuleOp> {
   }
 
  private:
-  llvm::DenseMap<const mlir::Operation*, size_t> BuildOpOrderMap(
-      mlir::func::FuncOp func_op) const {
-    llvm::DenseMap<const mlir::Operation*, size_t> op_order_map;
-    for (const auto& op : llvm::enumerate(func_op.getOps())) {
-      op_order_map[&op.value()] = op.index();
-    }
-    return op_order_map;
-  }
-
-  std::unordered_map<std::string, llvm::SmallVector<mlir::Operation*>>
-  BuildBoundaryOutputOpsMap(mlir::func::FuncOp func_op) {
-    std::unordered_map<std::string, llvm::SmallVector<mlir::Operation*>>
-        boundary_output_ops;
-
-    for (auto op : func_op.getOps<mlir::stablehlo::CustomCallOp>()) {
-      auto metadata_or = GetBoundaryMetadata(op);
-      if (mlir::failed(metadata_or)) {
-        continue;
-      }
-
-      std::unique_ptr<BoundaryMetadata> metadata = std::move(*metadata_or);
-      if (metadata == nullptr || metadata->is_input) {
-        continue;
-      }
-
-      auto& output_ops = boundary_output_ops[metadata->boundary_key()];
-      if (metadata->pos >= output_ops.size()) {
-        output_ops.resize(metadata->pos + 1, nullptr);
-      }
-      output_ops[metadata->pos] = op.getOperation();
-    }
-    return boundary_output_ops;
-  }
-
-  mlir::FailureOr<std::unique_ptr<BoundaryMetadata>> GetBoundaryMetadata(
-      mlir::Operation* op) {
-    if (!IsXlaMarkTensorOp(op)) {
-      return mlir::FailureOr(nullptr);
-    }
-    auto backend_config =
-        op->getAttr("backend_config").dyn_cast<mlir::StringAttr>();
-    if (backend_config == nullptr) {
-      return mlir::FailureOr(nullptr);
-    }
-    std::unique_ptr<BoundaryMetadata> metadata =
-        BoundaryMetadata::Parse(backend_config);
-    if (metadata == nullptr) {
-      return op->emitError() << "invalid boundary metadata JSON.";
-    }
-    return metadata;
-  }
-
   mlir::FailureOr<mlir::Attribute> BuildAttrFromJson(mlir::OpBuilder& builder,
                                                      mlir::Operation* op,
                                                      const json& json_value) {
@@ -268,7 +304,7 @@ class BuildStableHLOCompositePass : public mlir::OperationPass<mlir::ModuleOp> {
 
   mlir::LogicalResult BuildStableHLOComposite(
       const llvm::SmallVector<mlir::Operation*>& output_ops,
-      const llvm::DenseMap<const mlir::Operation*, size_t>& op_order_map) {
+      BoundaryIndex* index, mlir::SymbolTable& symbol_table) {
     if (output_ops.empty()) {
       return mlir::success();
     }
@@ -276,25 +312,24 @@ class BuildStableHLOCompositePass : public mlir::OperationPass<mlir::ModuleOp> {
     // Get the output op with minimum order num as the representative.
     mlir::Operation* first_output_op = output_ops[0];
     for (mlir::Operation* op : output_ops) {
-      if (op_order_map.at(op) < op_order_map.at(first_output_op)) {
+      if (index->Order(op) < index->Order(first_output_op)) {
         first_output_op = op;
       }
     }
 
-    auto metadata_or = GetBoundaryMetadata(first_output_op);
+    auto metadata_or = index->Lookup(first_output_op);
     if (mlir::failed(metadata_or)) {
       return mlir::failure();
     }
 
-    std::unique_ptr<BoundaryMetadata> metadata = std::move(*metadata_or);
+    const BoundaryMetadata* metadata = *metadata_or;
     if (metadata == nullptr || metadata->is_input) {
       // There should always be a valid boundary output metadata associated with
       // each op in output_ops.
       return mlir::failure();
     }
 
-    auto args_ops_or =
-        GetBoundaryArgsAndOps(output_ops, *metadata, op_order_map);
+    auto args_ops_or = GetBoundaryArgsAndOps(output_ops, *metadata, *index);
     if (mlir::failed(args_ops_or)) {
       return mlir::failure();
     }
@@ -302,13 +337,16 @@ class BuildStableHLOCompositePass : public mlir::OperationPass<mlir::ModuleOp> {
     auto [args, impl_ops] = *args_ops_or;
 
     mlir::func::FuncOp impl_func = BuildStableHLOCompositeImplFunc(
-        output_ops, absl::StrCat(metadata->name, ".impl"), args, impl_ops);
+        output_ops, absl::StrCat(metadata->name, ".impl"), args, impl_ops,
+        symbol_table);
     mlir::FailureOr<mlir::Operation*> composite_op_or =
         BuildStableHLOCompositeOp(first_output_op, impl_func, args, *metadata);
     if (mlir::failed(composite_op_or)) {
       return mlir::failure();
     }
     mlir::Operation* composite_op = *composite_op_or;
+    // The composite may be part of the impl ops of a later composite.
+    index->SetOrder(composite_op, index->Order(first_output_op));
 
     // Updates all users of this op's result(s) to use the results(s) of impl
     // func call.
@@ -321,11 +359,6 @@ class BuildStableHLOCompositePass : public mlir::OperationPass<mlir::ModuleOp> {
       }
     }
 
-    if (!mlir::sortTopologically(composite_op->getBlock())) {
-      composite_op->emitError()
-          << "The graph is not acyclic after BuildStableHLOCompositePass pass.";
-      return mlir::failure();
-    }
     // The unused impl_ops will be eliminated with canonicalizer.
     return mlir::success();
   }
@@ -334,8 +367,7 @@ class BuildStableHLOCompositePass : public mlir::OperationPass<mlir::ModuleOp> {
                             llvm::SmallVector<mlir::Operation*>>>
   GetBoundaryArgsAndOps(
       const llvm::SmallVector<mlir::Operation*> boundary_output_ops,
-      const BoundaryMetadata& metadata,
-      const llvm::DenseMap<const mlir::Operation*, size_t>& op_order_map) {
+      const BoundaryMetadata& metadata, const BoundaryIndex& index) {
     llvm::SetVector<mlir::Operation*> impl_ops_setvec;
     llvm::SetVector<std::pair<mlir::Value, int64_t>> arg_pos_setvec;
     llvm::SmallVector<mlir::Operation*> processing(boundary_output_ops.begin(),
@@ -350,15 +382,13 @@ class BuildStableHLOCompositePass : public mlir::OperationPass<mlir::ModuleOp> {
         continue;
       }
 
-      auto curr_metadata_or = GetBoundaryMetadata(curr_op);
+      auto curr_metadata_or = index.Lookup(curr_op);
       if (mlir::failed(curr_metadata_or)) {
-        return mlir::failure();
+        return curr_op->emitError() << "invalid boundary metadata JSON.";
       }
-      std::unique_ptr<BoundaryMetadata> curr_metadata =
-          std::move(*curr_metadata_or);
+      const BoundaryMetadata* curr_metadata = *curr_metadata_or;
       if (curr_metadata != nullptr) {
-        if (curr_metadata->is_input &&
-            curr_metadata->boundary_key() == metadata.boundary_key()) {
+        if (curr_metadata->is_input && curr_metadata->SameBoundary(metadata)) {
           // Terminal condition: boundary input op.
           arg_pos_setvec.insert({curr_op->getResult(0).dyn_cast<mlir::Value>(),
                                  curr_metadata->pos});
@@ -385,15 +415,21 @@ class BuildStableHLOCompositePass : public mlir::OperationPass<mlir::ModuleOp> {
     // order.
     llvm::SmallVector<mlir::Operation*> impl_ops = impl_ops_setvec.takeVector();
     for (auto& op : impl_ops) {
-      if (!op_order_map.contains(op)) {
+      if (!index.HasOrder(op)) {
         return op->emitError()
                << "does not have a ordering number in its outer func.";
       }
     }
     std::sort(impl_ops.begin(), impl_ops.end(),
-              [&op_order_map](const auto& a, const auto& b) {
-                return op_order_map.at(a) < op_order_map.at(b);
+              [&index](const auto& a, const auto& b) {
+                return index.Order(a) < index.Order(b);
               });
+    // The composites built before have the order of their first output and
+    // may come before their args, which the sorting moves ahead of them.
+    if (!mlir::computeTopologicalSorting(impl_ops)) {
+      return boundary_output_ops[0]->emitError()
+             << "The boundary ops are not acyclic.";
+    }
 
     // Sorts boundary args by their positions. Note that the args of the
     // composite and impl function may be more than the boundary inputs, because
@@ -416,7 +452,8 @@ class BuildStableHLOCompositePass : public mlir::OperationPass<mlir::ModuleOp> {
   mlir::func::FuncOp BuildStableHLOCompositeImplFunc(
       const llvm::SmallVector<mlir::Operation*> boundary_output_ops,
       llvm::StringRef func_name, const llvm::SmallVector<mlir::Value>& args,
-      const llvm::SmallVector<mlir::Operation*>& impl_ops) {
+      const llvm::SmallVector<mlir::Operation*>& impl_ops,
+      mlir::SymbolTable& symbol_table) {
     mlir::ModuleOp module_op = getOperation();
     mlir::MLIRContext* context = &getContext();
     mlir::OpBuilder builder(context);
@@ -457,7 +494,6 @@ class BuildStableHLOCompositePass : public mlir::OperationPass<mlir::ModuleOp> {
     builder.create<mlir::func::ReturnOp>(impl_func.getBody().getLoc(), results);
 
     // Adds the new function to symbol table.
-    mlir::SymbolTable symbol_table(module_op);
     impl_func.setPrivate();
     symbol_table.insert(impl_func);
 
@@ -0,0 +1,92 @@
+// Benchmarks of the pass building the StableHLO composites out of the
+// boundary markers of an exported model, over synthetic models of many
+// layers, each marked as a composite.
+//
+//   bazel run //torch_xla/csrc/runtime:stablehlo_composite_helper_bench
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/substitute.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Pass/PassManager.h"
+#include "stablehlo/dialect/StablehloOps.h"
+#include "torch_xla/csrc/runtime/stablehlo_composite_helper.h"
+#include "tsl/platform/logging.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace {
+
+// The backend config of a boundary marker, escaped for the MLIR string.
+std::string BoundaryConfig(int64_t layer, int64_t pos, bool is_input) {
+  return absl::Substitute(
+      R"({\"name\": \"test.layer\", \"id\": \"$0\", \"pos\": $1, )"
+      R"(\"is_input\": $2, \"attr\": {\"layer\": $0, \"eps\": 1e-5}})",
+      layer, pos, is_input);
+}
+
+// A chain of `layers` layers of a few ops, with the activations and the
+// shared weight passed to each as its boundary inputs.
+std::string LayersModule(int64_t layers) {
+  std::string text =
+      "!a = tensor<8x128xf32>\n"
+      "!w = tensor<128xf32>\n"
+      "func.func @main(%x: !a, %w: !w) -> !a {\n";
+  std::string input = "%x";
+  for (int64_t l = 0; l < layers; ++l) {
+    absl::StrAppend(
+        &text,
+        absl::Substitute(R"(  %in$0 = stablehlo.custom_call @xla_mark_tensor($1)
+      {backend_config = "$2"} : (!a) -> !a
+  %w$0 = stablehlo.custom_call @xla_mark_tensor(%w)
+      {backend_config = "$3"} : (!w) -> !w
+  %b$0 = stablehlo.broadcast_in_dim %w$0, dims = [1] : (!w) -> !a
+  %m$0 = stablehlo.multiply %in$0, %in$0 : !a
+  %a$0 = stablehlo.add %m$0, %b$0 : !a
+  %t$0 = stablehlo.tanh %a$0 : !a
+  %out$0 = stablehlo.custom_call @xla_mark_tensor(%t$0)
+      {backend_config = "$4"} : (!a) -> !a
+)",
+                         l, input, BoundaryConfig(l, 0, true),
+                         BoundaryConfig(l, 1, true),
+                         BoundaryConfig(l, 0, false)));
+    input = absl::StrCat("%out", l);
+  }
+  absl::StrAppend(&text, "  return ", input, " : !a\n}\n");
+  return text;
+}
+
+void BM_BuildComposites(benchmark::State& state) {
+  mlir::MLIRContext context;
+  context.loadDialect<mlir::func::FuncDialect,
+                      mlir::stablehlo::StablehloDialect>();
+  std::string text = LayersModule(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    mlir::OwningOpRef<mlir::ModuleOp> module =
+        mlir::parseSourceString<mlir::ModuleOp>(text, &context);
+    CHECK(module);
+    mlir::PassManager pm(&context);
+    pm.addPass(CreateBuildStableHLOCompositePass());
+    state.ResumeTiming();
+    CHECK(mlir::succeeded(pm.run(*module)));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_BuildComposites)
+    ->Arg(64)
+    ->Arg(512)
+    ->Arg(4096)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace runtime
+}  // namespace torch_xla
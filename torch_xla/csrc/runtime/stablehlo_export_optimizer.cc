@@ -0,0 +1,116 @@
+#include "torch_xla/csrc/runtime/stablehlo_export_optimizer.h"
+
+#include <utility>
+
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Support/LogicalResult.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+#include "stablehlo/dialect/StablehloOps.h"
+
+namespace torch_xla {
+namespace runtime {
+
+namespace {
+
+// Whether all the values of `from` are exactly representable in `to`.
+bool IsExactWidening(mlir::Type from, mlir::Type to) {
+  if (from.isF16() || from.isBF16() || from.isF32()) {
+    return llvm::isa<mlir::FloatType>(to) &&
+           to.getIntOrFloatBitWidth() > from.getIntOrFloatBitWidth();
+  }
+  auto from_int = llvm::dyn_cast<mlir::IntegerType>(from);
+  auto to_int = llvm::dyn_cast<mlir::IntegerType>(to);
+  return from_int != nullptr && to_int != nullptr &&
+         from_int.getWidth() > 1 && to_int.getWidth() > from_int.getWidth() &&
+         from_int.isUnsigned() == to_int.isUnsigned();
+}
+
+// convert(convert(x : A) : B) : A -> x, when B holds all the values of A.
+class FoldRoundTripConvert
+    : public mlir::OpRewritePattern<mlir::stablehlo::ConvertOp> {
+ public:
+  using OpRewritePattern::OpRewritePattern;
+
+  mlir::LogicalResult matchAndRewrite(
+      mlir::stablehlo::ConvertOp op,
+      mlir::PatternRewriter& rewriter) const override {
+    mlir::Value operand = op.getOperand();
+    if (operand.getType() == op.getType()) {
+      rewriter.replaceOp(op, operand);
+      return mlir::success();
+    }
+    auto inner = operand.getDefiningOp<mlir::stablehlo::ConvertOp>();
+    if (inner == nullptr || inner.getOperand().getType() != op.getType() ||
+        !IsExactWidening(mlir::getElementTypeOrSelf(inner.getOperand()),
+                         mlir::getElementTypeOrSelf(inner.getType()))) {
+      return mlir::failure();
+    }
+    rewriter.replaceOp(op, inner.getOperand());
+    return mlir::success();
+  }
+};
+
+// broadcast_in_dim(splat constant) -> splat constant.
+class FoldBroadcastOfSplat
+    : public mlir::OpRewritePattern<mlir::stablehlo::BroadcastInDimOp> {
+ public:
+  using OpRewritePattern::OpRewritePattern;
+
+  mlir::LogicalResult matchAndRewrite(
+      mlir::stablehlo::BroadcastInDimOp op,
+      mlir::PatternRewriter& rewriter) const override {
+    auto constant =
+        op.getOperand().getDefiningOp<mlir::stablehlo::ConstantOp>();
+    auto type = llvm::dyn_cast<mlir::RankedTensorType>(op.getType());
+    if (constant == nullptr || type == nullptr || !type.hasStaticShape()) {
+      return mlir::failure();
+    }
+    auto value = llvm::dyn_cast<mlir::SplatElementsAttr>(constant.getValue());
+    if (value == nullptr) {
+      return mlir::failure();
+    }
+    rewriter.replaceOpWithNewOp<mlir::stablehlo::ConstantOp>(
+        op, mlir::SplatElementsAttr::get(
+                type, value.getSplatValue<mlir::Attribute>()));
+    return mlir::success();
+  }
+};
+
+class OptimizeStablehloExportPass
+    : public mlir::OperationPass<mlir::func::FuncOp> {
+ public:
+  explicit OptimizeStablehloExportPass()
+      : mlir::OperationPass<mlir::func::FuncOp>::OperationPass(
+            mlir::TypeID::get<OptimizeStablehloExportPass>()) {}
+
+  ~OptimizeStablehloExportPass() override = default;
+
+  void runOnOperation() override {
+    mlir::RewritePatternSet patterns(&getContext());
+    patterns.add<FoldRoundTripConvert, FoldBroadcastOfSplat>(&getContext());
+    if (mlir::failed(mlir::applyPatternsAndFoldGreedily(getOperation(),
+                                                        std::move(patterns)))) {
+      signalPassFailure();
+    }
+  }
+
+  mlir::StringRef getName() const override {
+    return llvm::getTypeName<OptimizeStablehloExportPass>();
+  }
+
+  std::unique_ptr<mlir::Pass> clonePass() const override {
+    return std::make_unique<OptimizeStablehloExportPass>(*this);
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateOptimizeStablehloExportPass() {
+  return std::make_unique<OptimizeStablehloExportPass>();
+}
+
+}  // namespace runtime
+}  // namespace torch_xla
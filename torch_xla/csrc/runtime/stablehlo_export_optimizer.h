@@ -0,0 +1,20 @@
+#ifndef STABLEHLO_EXPORT_OPTIMIZER_H_
+#define STABLEHLO_EXPORT_OPTIMIZER_H_
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/Pass/Pass.h"
+
+namespace torch_xla {
+namespace runtime {
+
+// Simplifies the exported StableHLO beyond the canonicalizer: removes the
+// converts to a wider type converted back, and folds the broadcasts of splat
+// constants into splat constants of the broadcast shape.
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateOptimizeStablehloExportPass();
+
+}  // namespace runtime
+}  // namespace torch_xla
+
+#endif
@@ -2,25 +2,58 @@
 
 #include <iostream>
 
-#include "mlir/IR/Verifier.h"       // from @llvm-project
-#include "mlir/Pass/PassManager.h"  // from @llvm-project
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/DialectRegistry.h"       // from @llvm-project
+#include "mlir/IR/Verifier.h"              // from @llvm-project
+#include "mlir/Pass/PassManager.h"         // from @llvm-project
 #include "mlir/Transforms/Passes.h"
 #include "stablehlo/api/PortableApi.h"        // from @stablehlo
+#include "stablehlo/dialect/Register.h"       // from @stablehlo
 #include "stablehlo/dialect/Serialization.h"  // from @stablehlo
 #include "stablehlo/dialect/StablehloOps.h"   // from @stablehlo
 #include "stablehlo/dialect/Version.h"        // from @stablehlo
 #include "stablehlo/dialect/VhloOps.h"        // from @stablehlo
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/stablehlo_composite_helper.h"
+#include "torch_xla/csrc/runtime/stablehlo_export_optimizer.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/xla_mlir_debuginfo_helper.h"
 #include "torch_xla/csrc/runtime/xla_util.h"
+#include "xla/mlir_hlo/mhlo/IR/register.h"
 #include "xla/mlir_hlo/mhlo/transforms/passes.h"
 #include "xla/translate/hlo_to_mhlo/hlo_to_mlir_hlo.h"
 #include "xla/translate/mhlo_to_hlo/mlir_hlo_to_hlo.h"
 
 namespace torch_xla {
 
+std::shared_ptr<mlir::MLIRContext> GetStablehloContext() {
+  static const int64_t max_uses =
+      runtime::sys_util::GetEnvInt("XLA_STABLEHLO_CONTEXT_REUSE", 64);
+  thread_local std::shared_ptr<mlir::MLIRContext> context;
+  thread_local int64_t uses = 0;
+  if (context == nullptr || uses >= max_uses) {
+    mlir::DialectRegistry registry;
+    mlir::mhlo::registerAllMhloDialects(registry);
+    mlir::stablehlo::registerAllDialects(registry);
+    registry.insert<mlir::func::FuncDialect>();
+    context = std::make_shared<mlir::MLIRContext>(registry);
+    context->loadAllAvailableDialects();
+    uses = 0;
+    XLA_COUNTER("StableHloContextCreated", 1);
+  }
+  uses += 1;
+  return context;
+}
+
+mlir::OwningOpRef<mlir::ModuleOp> DeserializeStablehlo(
+    const std::string& bytecode, mlir::MLIRContext* context) {
+  mlir::OwningOpRef<mlir::ModuleOp> module =
+      mlir::stablehlo::deserializePortableArtifact(bytecode, context);
+  XLA_CHECK(module) << "Failed to deserialize the StableHLO module";
+  return module;
+}
+
 static std::string getHloModuleStr(const xla::HloModuleProto* proto) {
   auto hlo_module = torch_xla::runtime::util::CreateModuleFromProto(*proto);
   return hlo_module.value()->ToString();
@@ -99,6 +132,7 @@ static absl::Status mhloToStablehloHelper(mlir::ModuleOp* mlir_module,
 
 void ConvertHloToStableHlo(const xla::HloModuleProto* proto,
                            mlir::ModuleOp* mlir_module) {
+  XLA_TIMED("HloToStableHloTime");
   static const std::string err_msg =
       "Please open a github issue to PyTorch/XLA.\nOriginal HLO dump:\n";
   auto status = ConvertHloToMhlo(proto, mlir_module);
@@ -111,17 +145,48 @@ void ConvertHloToStableHlo(const xla::HloModuleProto* proto,
                          << getHloModuleStr(proto);
 }
 
+static int64_t CountOps(mlir::ModuleOp& mlir_module) {
+  int64_t count = 0;
+  mlir_module.walk([&](mlir::Operation*) { count += 1; });
+  return count;
+}
+
+// Optimizes the exported module further, at the cost of the export time
+// (XLA_STABLEHLO_EXPORT_OPTIMIZE). The converted graphs still hold the
+// round-trip converts and the broadcasts of the traced dtype promotions and
+// scalars, and the decompositions left unused by the composites.
+static void OptimizeForExport(mlir::ModuleOp* mlir_module) {
+  static const bool enabled =
+      runtime::sys_util::GetEnvBool("XLA_STABLEHLO_EXPORT_OPTIMIZE", false);
+  if (!enabled) {
+    return;
+  }
+  XLA_TIMED("StableHloExportOptimizeTime");
+  int64_t num_ops = CountOps(*mlir_module);
+  mlir::PassManager pm(mlir_module->getContext());
+  pm.addNestedPass<mlir::func::FuncOp>(
+      torch_xla::runtime::CreateOptimizeStablehloExportPass());
+  pm.addNestedPass<mlir::func::FuncOp>(mlir::createCanonicalizerPass());
+  pm.addNestedPass<mlir::func::FuncOp>(mlir::createCSEPass());
+  pm.addPass(mlir::createSymbolDCEPass());
+  XLA_CHECK(mlir::succeeded(pm.run(*mlir_module)))
+      << "StableHLO export optimization failed:\n"
+      << getMlirModuleStr(*mlir_module);
+  XLA_VALUE_METRIC("StableHloExportOpsRemoved",
+                   num_ops - CountOps(*mlir_module));
+}
+
 std::string hloToStablehlo(const xla::HloModuleProto* proto,
                            bool emit_bytecode) {
-  mlir::MLIRContext context;
-  mlir::ModuleOp mlir_module =
-      mlir::ModuleOp::create(mlir::UnknownLoc::get(&context));
-  ConvertHloToStableHlo(proto, &mlir_module);
-  if (emit_bytecode) {
-    return getMlirModuleBytecode(mlir_module);
-  } else {
-    return getMlirModuleStr(mlir_module);
-  }
+  std::shared_ptr<mlir::MLIRContext> context = GetStablehloContext();
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      mlir::ModuleOp::create(mlir::UnknownLoc::get(context.get()));
+  ConvertHloToStableHlo(proto, &*mlir_module);
+  OptimizeForExport(&*mlir_module);
+  std::string result = emit_bytecode ? getMlirModuleBytecode(*mlir_module)
+                                     : getMlirModuleStr(*mlir_module);
+  XLA_VALUE_METRIC("StableHloExportBytes", result.size());
+  return result;
 }
 
 std::string GetHloModuleStr(const xla::HloModuleProto* proto) {
@@ -157,6 +222,7 @@ static absl::Status MhloToHloHelper(const mlir::ModuleOp* mlir_module,
 void ConvertStableHloToHlo(mlir::ModuleOp* mlir_module,
                            mlir::MLIRContext* context,
                            xla::HloProto* hlo_proto) {
+  XLA_TIMED("StableHloToHloTime");
   static const std::string err_msg =
       "Please open a github issue to PyTorch/XLA.\nOriginal StableHLO dump:\n";
   auto status = ConvertStablehloToMhlo(mlir_module, context);
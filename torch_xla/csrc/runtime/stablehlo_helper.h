@@ -1,15 +1,27 @@
 #ifndef STABLEHLO_HELPER_H_
 #define STABLEHLO_HELPER_H_
 
-#include "xla/client/xla_computation.h"
+#include <memory>
+#include <string>
 
-namespace mlir {
-class ModuleOp;
-class MLIRContext;
-}  // namespace mlir
+#include "mlir/IR/BuiltinOps.h"   // from @llvm-project
+#include "mlir/IR/MLIRContext.h"  // from @llvm-project
+#include "mlir/IR/OwningOpRef.h"  // from @llvm-project
+#include "xla/client/xla_computation.h"
 
 namespace torch_xla {
 
+// Returns the MLIR context of the StableHLO conversions of the calling thread,
+// with the dialects they use loaded, instead of building and loading one per
+// conversion. The attributes and types uniqued in a context are only freed
+// with it, so the context of a thread is replaced after some conversions; the
+// modules created in it must be erased before the returned reference goes.
+std::shared_ptr<mlir::MLIRContext> GetStablehloContext();
+
+// Deserializes a StableHLO portable artifact into `context`.
+mlir::OwningOpRef<mlir::ModuleOp> DeserializeStablehlo(
+    const std::string& bytecode, mlir::MLIRContext* context);
+
 std::string hloToStablehlo(const xla::HloModuleProto* proto,
                            bool emit_bytecode);
 
@@ -0,0 +1,127 @@
+#include "torch_xla/csrc/runtime/tenant.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+
+namespace torch_xla {
+namespace runtime {
+namespace tenant {
+namespace {
+
+struct State {
+  explicit State(const std::string& name)
+      : bytes_counter(absl::StrCat("TenantAllocatedBytes_", name)),
+        exceeded_counter(absl::StrCat("TenantBudgetExceeded_", name)) {}
+
+  std::atomic<int64_t> bytes_used{0};
+  std::atomic<int64_t> peak_bytes_used{0};
+  std::atomic<int64_t> budget_bytes{0};
+  torch::lazy::Counter bytes_counter;
+  torch::lazy::Counter exceeded_counter;
+};
+
+class Registry {
+ public:
+  static Registry* Get() {
+    // Leaked, as the buffers released at exit still refer to the states.
+    static Registry* registry = new Registry();
+    return registry;
+  }
+
+  std::shared_ptr<State> GetState(const std::string& tenant) {
+    std::lock_guard<std::mutex> lock(lock_);
+    std::shared_ptr<State>& state = states_[tenant];
+    if (state == nullptr) {
+      state = std::make_shared<State>(tenant);
+    }
+    return state;
+  }
+
+  std::map<std::string, Usage> GetUsage() {
+    std::lock_guard<std::mutex> lock(lock_);
+    std::map<std::string, Usage> usage;
+    for (const auto& [tenant, state] : states_) {
+      Usage& tenant_usage = usage[tenant];
+      tenant_usage.bytes_used = state->bytes_used.load();
+      tenant_usage.peak_bytes_used = state->peak_bytes_used.load();
+      tenant_usage.budget_bytes = state->budget_bytes.load();
+    }
+    return usage;
+  }
+
+ private:
+  std::mutex lock_;
+  std::unordered_map<std::string, std::shared_ptr<State>> states_;
+};
+
+thread_local std::string g_current_tenant;
+
+}  // namespace
+
+const std::string& Current() { return g_current_tenant; }
+
+void SetCurrent(std::string tenant) { g_current_tenant = std::move(tenant); }
+
+void SetBudget(const std::string& tenant, int64_t bytes) {
+  XLA_CHECK(!tenant.empty());
+  XLA_CHECK_GE(bytes, 0);
+  Registry::Get()->GetState(tenant)->budget_bytes.store(bytes);
+}
+
+std::map<std::string, Usage> GetUsage() { return Registry::Get()->GetUsage(); }
+
+void CheckBudget(const std::string& tenant) {
+  if (tenant.empty()) {
+    return;
+  }
+  std::shared_ptr<State> state = Registry::Get()->GetState(tenant);
+  int64_t used = state->bytes_used.load();
+  int64_t budget = state->budget_bytes.load();
+  if (budget > 0 && used > budget) {
+    state->exceeded_counter.AddValue(1);
+    XLA_ERROR() << "Tenant " << tenant << " out of memory: " << used
+                << " bytes in use, over its " << budget << " bytes budget";
+  }
+}
+
+std::shared_ptr<void> Charge(const std::string& tenant, int64_t bytes,
+                             bool enforce) {
+  if (tenant.empty()) {
+    return nullptr;
+  }
+  std::shared_ptr<State> state = Registry::Get()->GetState(tenant);
+  int64_t used = state->bytes_used.load();
+  int64_t new_used;
+  do {
+    new_used = used + bytes;
+    int64_t budget = state->budget_bytes.load();
+    if (enforce && budget > 0 && new_used > budget) {
+      state->exceeded_counter.AddValue(1);
+      XLA_ERROR() << "Tenant " << tenant << " out of memory: allocating "
+                  << bytes << " bytes with " << used << " of its " << budget
+                  << " bytes budget in use";
+    }
+  } while (!state->bytes_used.compare_exchange_weak(used, new_used));
+  int64_t peak = state->peak_bytes_used.load();
+  while (peak < new_used &&
+         !state->peak_bytes_used.compare_exchange_weak(peak, new_used)) {
+  }
+  state->bytes_counter.AddValue(bytes);
+  State* raw_state = state.get();
+  return std::shared_ptr<void>(raw_state, [state = std::move(state),
+                                           bytes](void*) mutable {
+    state->bytes_used.fetch_sub(bytes);
+    state.reset();
+  });
+}
+
+}  // namespace tenant
+}  // namespace runtime
+}  // namespace torch_xla
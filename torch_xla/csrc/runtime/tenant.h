@@ -0,0 +1,69 @@
+#ifndef XLA_CLIENT_TENANT_H_
+#define XLA_CLIENT_TENANT_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace torch_xla {
+namespace runtime {
+namespace tenant {
+
+// The accounting of the device memory of the tenants, the models sharing the
+// devices of a process. The work of a thread is charged to the tenant set on
+// it, none by default, for the bytes of the device buffers it transfers and
+// the executions it schedules produce, until they are released. A tenant with
+// a budget fails the transfers which would take it over budget, and the
+// executions once it is, rather than running the other tenants out of memory.
+// The bytes charged and the failures are reported as the
+// TenantAllocatedBytes_<tenant> and TenantBudgetExceeded_<tenant> counters.
+
+// The tenant of the calling thread, empty for none.
+const std::string& Current();
+
+void SetCurrent(std::string tenant);
+
+// Sets the tenant of the calling thread for the lifetime of the object.
+class ScopedTenant {
+ public:
+  explicit ScopedTenant(std::string tenant) : previous_(Current()) {
+    SetCurrent(std::move(tenant));
+  }
+
+  ~ScopedTenant() { SetCurrent(std::move(previous_)); }
+
+ private:
+  std::string previous_;
+};
+
+// Sets the budget of `tenant` in bytes, 0 for none.
+void SetBudget(const std::string& tenant, int64_t bytes);
+
+struct Usage {
+  int64_t bytes_used = 0;
+  // The highest `bytes_used` since the tenant was first charged.
+  int64_t peak_bytes_used = 0;
+  int64_t budget_bytes = 0;
+};
+
+// The usage of the tenants with a budget or charged so far.
+std::map<std::string, Usage> GetUsage();
+
+// Charges `bytes` to `tenant` until the returned object is released. If
+// `enforce`, throws instead if that would take the tenant over its budget,
+// otherwise the bytes are charged anyway, as for the outputs of an execution
+// already allocated. Returns nullptr for the empty tenant, which is not
+// accounted.
+std::shared_ptr<void> Charge(const std::string& tenant, int64_t bytes,
+                             bool enforce = true);
+
+// Throws if `tenant` is over its budget, so that its executions fail before
+// allocating their outputs.
+void CheckBudget(const std::string& tenant);
+
+}  // namespace tenant
+}  // namespace runtime
+}  // namespace torch_xla
+
+#endif  // XLA_CLIENT_TENANT_H_
@@ -0,0 +1,53 @@
+#include "torch_xla/csrc/runtime/tenant.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+
+namespace torch_xla {
+namespace runtime {
+namespace tenant {
+
+TEST(TenantTest, ChargesUntilReleased) {
+  EXPECT_EQ(Charge("", 1024), nullptr);
+
+  std::shared_ptr<void> charge = Charge("charged", 1024);
+  ASSERT_NE(charge, nullptr);
+  EXPECT_EQ(GetUsage().at("charged").bytes_used, 1024);
+  charge.reset();
+  Usage usage = GetUsage().at("charged");
+  EXPECT_EQ(usage.bytes_used, 0);
+  EXPECT_EQ(usage.peak_bytes_used, 1024);
+}
+
+TEST(TenantTest, EnforcesBudget) {
+  SetBudget("budgeted", 1000);
+  std::shared_ptr<void> charge = Charge("budgeted", 600);
+  EXPECT_THROW(Charge("budgeted", 600), std::exception);
+  EXPECT_EQ(GetUsage().at("budgeted").bytes_used, 600);
+  std::shared_ptr<void> output =
+      Charge("budgeted", 600, /*enforce=*/false);
+  EXPECT_EQ(GetUsage().at("budgeted").bytes_used, 1200);
+  EXPECT_THROW(CheckBudget("budgeted"), std::exception);
+  output.reset();
+  CheckBudget("budgeted");
+  charge.reset();
+  EXPECT_NE(Charge("budgeted", 600), nullptr);
+  SetBudget("budgeted", 0);
+  EXPECT_NE(Charge("budgeted", 2000), nullptr);
+}
+
+TEST(TenantTest, ScopedTenant) {
+  EXPECT_EQ(Current(), "");
+  {
+    ScopedTenant scoped("scoped");
+    EXPECT_EQ(Current(), "scoped");
+  }
+  EXPECT_EQ(Current(), "");
+}
+
+}  // namespace tenant
+}  // namespace runtime
+}  // namespace torch_xla
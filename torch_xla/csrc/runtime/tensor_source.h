@@ -1,13 +1,18 @@
 #ifndef XLA_CLIENT_TENSOR_SOURCE_H_
 #define XLA_CLIENT_TENSOR_SOURCE_H_
 
+#include <ATen/Functions.h>
 #include <ATen/Tensor.h>
 #include <torch/csrc/lazy/core/metrics.h>
 
+#include <memory>
 #include <vector>
 
 #include "torch_xla/csrc/dtype.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/host_buffer_pool.h"
+#include "torch_xla/csrc/runtime/memory_kind.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "xla/literal.h"
 #include "xla/shape.h"
 #include "xla/shape_util.h"
@@ -26,6 +31,11 @@ class TensorSource {
 
   const std::string& device() const { return device_; }
 
+  // The memory the tensor is to be transferred to, device memory by default.
+  MemoryKind memory_kind() const { return memory_kind_; }
+
+  void set_memory_kind(MemoryKind memory_kind) { memory_kind_ = memory_kind; }
+
   virtual std::vector<int64_t> byte_strides() const {
     std::vector<int64_t> byte_strides(shape().dimensions_size());
     XLA_CHECK_OK(
@@ -42,25 +52,88 @@ class TensorSource {
     return shape().element_type();
   }
 
+  // Whether the data is a copy owned by the source, which a buffer may then
+  // alias for as long as it holds the source.
+  virtual bool owns_data() const { return false; }
+
  private:
   std::string device_;
+  MemoryKind memory_kind_ = MemoryKind::kDevice;
 };
 
+// Whether `tensor` is dense in the channels last memory format but not
+// contiguous, the layout of the vision models which PyTorch calls
+// channels_last.
+inline bool IsChannelsLastContiguous(const at::Tensor& tensor) {
+  return !tensor.is_contiguous() &&
+         ((tensor.dim() == 4 &&
+           tensor.is_contiguous(at::MemoryFormat::ChannelsLast)) ||
+          (tensor.dim() == 5 &&
+           tensor.is_contiguous(at::MemoryFormat::ChannelsLast3d)));
+}
+
 class AtenSource : public TensorSource {
  public:
-  AtenSource(const at::Tensor& tensor, xla::Shape shape, std::string device)
+  // If `staging_pool` is not null, the tensor data is copied into a buffer
+  // taken from it rather than into a freshly allocated tensor.
+  AtenSource(const at::Tensor& tensor, xla::Shape shape, std::string device,
+             HostBufferPool* staging_pool = nullptr)
       : TensorSource(std::move(device)), shape_(std::move(shape)) {
+    TORCH_LAZY_TIMED("AtenSourceConversion");
     at::ScalarType target_torch_type = TorchTypeFromXlaType(primitive_type());
     if (target_torch_type != tensor.type().scalarType()) {
       TORCH_LAZY_COUNTER("AtenSourceDowncasts", 1);
     }
+    // With XLA_ZERO_COPY_HOST_TO_DEVICE, a CPU tensor which is already
+    // contiguous and of the target type is transferred straight from its own
+    // storage, which is kept alive until the transfer completes. The caller
+    // must then not modify the tensor in place while it is being transferred.
+    static const bool zero_copy =
+        sys_util::GetEnvBool("XLA_ZERO_COPY_HOST_TO_DEVICE", false);
+    at::TensorOptions options =
+        at::TensorOptions().device(at::kCPU).dtype(target_torch_type);
+    // A channels last tensor keeps its layout, and the transfer lays it out on
+    // the device from its byte strides, instead of it being transposed on the
+    // host first.
+    bool channels_last = IsChannelsLastContiguous(tensor);
+    if (channels_last) {
+      TORCH_LAZY_COUNTER("AtenSourceChannelsLast", 1);
+    }
+    bool borrowable = tensor.device().is_cpu() &&
+                      tensor.scalar_type() == target_torch_type &&
+                      (tensor.is_contiguous() || channels_last);
+    if (staging_pool != nullptr && !(zero_copy && borrowable)) {
+      staging_ = staging_pool->Allocate(tensor.numel() *
+                                        c10::elementSize(target_torch_type));
+      tensor_ = channels_last ? at::from_blob(staging_.get(), tensor.sizes(),
+                                              tensor.strides(), options)
+                              : at::from_blob(staging_.get(), tensor.sizes(),
+                                              options);
+      tensor_.copy_(tensor);
+      TORCH_LAZY_COUNTER("AtenSourceStaged", 1);
+      return;
+    }
     // TODO(ysiraichi): check, first, if tensor lives in a device that the
     // current PjRt client has access. If so, we don't need to go through the
     // CPU.
-    tensor_ = std::move(
-        tensor.to(at::TensorOptions().device(at::kCPU).dtype(target_torch_type),
-                  /*non_blocking=*/false,
-                  /*copy=*/true, at::MemoryFormat::Contiguous));
+    tensor_ = std::move(tensor.to(
+        options, /*non_blocking=*/false, /*copy=*/!zero_copy,
+        channels_last ? tensor.suggest_memory_format()
+                      : at::MemoryFormat::Contiguous));
+    owns_data_ = !tensor_.is_alias_of(tensor);
+    if (zero_copy && tensor_.is_same(tensor)) {
+      TORCH_LAZY_COUNTER("AtenSourceZeroCopy", 1);
+    }
+  }
+
+  // Shares the converted data of `source`, to be transferred to `device`.
+  AtenSource(const AtenSource& source, std::string device)
+      : TensorSource(std::move(device)),
+        tensor_(source.tensor_),
+        shape_(source.shape_),
+        staging_(source.staging_),
+        owns_data_(source.owns_data_) {
+    set_memory_kind(source.memory_kind());
   }
 
   const void* data() const override { return tensor_.const_data_ptr(); }
@@ -80,9 +153,101 @@ class AtenSource : public TensorSource {
     return {sizes.begin(), sizes.end()};
   }
 
+  bool owns_data() const override { return owns_data_; }
+
  private:
   at::Tensor tensor_;
   xla::Shape shape_;
+  // Backing memory of `tensor_` when it was copied into a staging buffer.
+  std::shared_ptr<char> staging_;
+  // Whether `tensor_` is a copy rather than the caller's own tensor.
+  bool owns_data_ = true;
+};
+
+// A region of a CPU tensor, like the shard of a sharded tensor, given as a view
+// of the tensor of the element type of `shape`. The region sizes can be
+// smaller than the dimensions of `shape`, the difference being zero padding.
+//
+// A region which needs no padding is transferred straight from the storage of
+// the tensor, with its byte strides, if XLA_ZERO_COPY_HOST_TO_DEVICE is set
+// (see AtenSource for the caveat). Otherwise the region is copied once into a
+// buffer of the dimensions of `shape`, taken from `staging_pool` if not null,
+// of which only the padding is zero filled.
+class StridedSource : public TensorSource {
+ public:
+  StridedSource(const at::Tensor& region, xla::Shape shape, std::string device,
+                HostBufferPool* staging_pool = nullptr)
+      : TensorSource(std::move(device)), shape_(std::move(shape)) {
+    XLA_CHECK(region.device().is_cpu());
+    XLA_CHECK_EQ(region.scalar_type(), TorchTypeFromXlaType(primitive_type()));
+    XLA_CHECK_EQ(region.dim(), shape_.dimensions_size());
+    bool padded = false;
+    for (int64_t i = 0; i < region.dim(); ++i) {
+      XLA_CHECK_LE(region.size(i), shape_.dimensions(i));
+      padded = padded || region.size(i) < shape_.dimensions(i);
+    }
+    static const bool zero_copy =
+        sys_util::GetEnvBool("XLA_ZERO_COPY_HOST_TO_DEVICE", false);
+    if (zero_copy && !padded) {
+      region_ = region;
+      TORCH_LAZY_COUNTER("StridedSourceZeroCopy", 1);
+      return;
+    }
+    std::vector<int64_t> dimensions(shape_.dimensions().begin(),
+                                    shape_.dimensions().end());
+    at::TensorOptions options =
+        at::TensorOptions().device(at::kCPU).dtype(region.scalar_type());
+    if (staging_pool != nullptr) {
+      staging_ = staging_pool->Allocate(xla::ShapeUtil::ByteSizeOf(shape_));
+      region_ = at::from_blob(staging_.get(), dimensions, options);
+    } else {
+      region_ = at::empty(dimensions, options);
+    }
+    at::Tensor target = region_;
+    for (int64_t i = 0; i < region.dim(); ++i) {
+      if (region.size(i) < dimensions[i]) {
+        region_.narrow(i, region.size(i), dimensions[i] - region.size(i))
+            .zero_();
+        target = target.narrow(i, 0, region.size(i));
+      }
+    }
+    target.copy_(region);
+    if (padded) {
+      TORCH_LAZY_COUNTER("StridedSourcePadded", 1);
+    }
+  }
+
+  // Shares the data of `source`, to be transferred to `device`.
+  StridedSource(const StridedSource& source, std::string device)
+      : TensorSource(std::move(device)),
+        region_(source.region_),
+        shape_(source.shape_),
+        staging_(source.staging_) {
+    set_memory_kind(source.memory_kind());
+  }
+
+  const void* data() const override { return region_.const_data_ptr(); }
+
+  const xla::Shape& shape() const override { return shape_; }
+
+  std::vector<int64_t> byte_strides() const override {
+    std::vector<int64_t> strides;
+    for (auto& stride : region_.strides()) {
+      strides.push_back(stride * region_.itemsize());
+    }
+    return strides;
+  }
+
+  std::vector<int64_t> dimensions() const override {
+    auto sizes = region_.sizes();
+    return {sizes.begin(), sizes.end()};
+  }
+
+ private:
+  at::Tensor region_;
+  xla::Shape shape_;
+  // Backing memory of `region_` when it was copied into a staging buffer.
+  std::shared_ptr<char> staging_;
 };
 
 class LiteralSource : public TensorSource {
@@ -94,6 +259,8 @@ class LiteralSource : public TensorSource {
 
   const xla::Shape& shape() const override { return literal_.shape(); }
 
+  bool owns_data() const override { return true; }
+
  private:
   xla::Literal literal_;
 };
@@ -29,6 +29,18 @@ namespace internal {
   : ::tsl::internal::Voidifier() &       \
           ::tsl::internal::LogMessage(__FILE__, __LINE__, ::tsl::INFO)
 
+// The verbose logging of the execution hot paths, compiled out of the release
+// hot path builds (XLA_RELEASE_HOT_PATH, see the release_hot_path Bazel
+// config), where the streamed values are never evaluated.
+#ifdef XLA_RELEASE_HOT_PATH
+#define TF_HOT_VLOG(level)              \
+  true ? (void)0                        \
+       : ::tsl::internal::Voidifier() & \
+             ::tsl::internal::LogMessage(__FILE__, __LINE__, ::tsl::INFO)
+#else
+#define TF_HOT_VLOG(level) TF_VLOG(level)
+#endif
+
 struct ErrorSink : public std::basic_ostringstream<char> {};
 
 class ErrorGenerator {
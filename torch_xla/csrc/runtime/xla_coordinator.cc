@@ -1,7 +1,10 @@
 #include "torch_xla/csrc/runtime/xla_coordinator.h"
 
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/env_vars.h"
+#include "torch_xla/csrc/runtime/metrics.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "xla/pjrt/distributed/distributed.h"
 
@@ -9,7 +12,8 @@ namespace torch_xla {
 namespace runtime {
 
 XlaCoordinator::XlaCoordinator(int global_rank, int world_size,
-                               std::string master_addr, std::string port) {
+                               std::string master_addr, std::string port)
+    : global_rank_(global_rank), world_size_(world_size) {
   std::string dist_service_addr = absl::StrJoin({master_addr, port}, ":");
   if (global_rank == 0) {
     xla::CoordinationServiceImpl::Options service_options;
@@ -82,5 +86,49 @@ bool XlaCoordinator::ReachedSyncPoint(int step) {
   return preemption_sync_manager_->ReachedSyncPoint(step);
 }
 
+void XlaCoordinator::SetKeyValue(const std::string& key,
+                                 const std::string& value) {
+  absl::Status status = GetClient()->KeyValueSet(key, value);
+  XLA_CHECK(status.ok() || absl::IsAlreadyExists(status)) << status;
+}
+
+bool XlaCoordinator::WaitForKey(const std::string& key,
+                                absl::Duration timeout) {
+  return GetClient()->BlockingKeyValueGet(key, timeout).ok();
+}
+
+std::vector<std::string> XlaCoordinator::AllGather(const std::string& tag,
+                                                   const std::string& value,
+                                                   absl::Duration timeout) {
+  int64_t round;
+  {
+    std::lock_guard<std::mutex> lock(all_gather_mutex_);
+    round = all_gather_rounds_[tag]++;
+  }
+  auto key = [&](int64_t key_round, int rank) {
+    return absl::StrCat("torch_xla/all_gather/", tag, "/", key_round, "/",
+                        rank);
+  };
+  SetKeyValue(key(round, global_rank_), value);
+  std::vector<std::string> values;
+  values.reserve(world_size_);
+  for (int rank = 0; rank < world_size_; ++rank) {
+    absl::StatusOr<std::string> rank_value =
+        GetClient()->BlockingKeyValueGet(key(round, rank), timeout);
+    XLA_CHECK(rank_value.ok())
+        << "Host all-gather '" << tag << "' failed waiting for process "
+        << rank << ": " << rank_value.status();
+    values.push_back(std::move(*rank_value));
+  }
+  // Every process published this round, so they are all done reading the
+  // previous one.
+  if (round > 0) {
+    GetClient()->KeyValueDelete(key(round - 1, global_rank_)).IgnoreError();
+  }
+  XLA_COUNTER("HostAllGather", 1);
+  XLA_COUNTER("HostAllGatherBytes", value.size());
+  return values;
+}
+
 }  // namespace runtime
 }  // namespace torch_xla
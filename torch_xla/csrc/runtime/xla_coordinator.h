@@ -2,7 +2,12 @@
 #define PTXLA_RUNTIME_COORDINATOR_H_
 
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
+#include "absl/time/time.h"
 #include "xla/pjrt/distributed/distributed.h"
 #include "xla/tsl/distributed_runtime/preemption/preemption_sync_manager.h"
 
@@ -35,13 +40,41 @@ class XlaCoordinator {
   // destroy the current instance.
   void DeactivatePreemptionSyncManager();
 
+  bool PreemptionSyncManagerActive() const {
+    return preemption_sync_manager_ != nullptr;
+  }
+
   // A pass-through API to PreemptionSyncManager::ReachedSyncPoint.
   // The PreemptionSyncManager must be activated within the XlaCoordinator.
   // Returns true when the input step has been identified as a sync point, and
   // false otherwise.
   bool ReachedSyncPoint(int step);
 
+  int global_rank() const { return global_rank_; }
+
+  int world_size() const { return world_size_; }
+
+  // Publishes the key to all the processes of the distributed runtime.
+  void SetKeyValue(const std::string& key, const std::string& value);
+
+  // Waits until some process publishes the key. Returns false if that did not
+  // happen within the timeout.
+  bool WaitForKey(const std::string& key, absl::Duration timeout);
+
+  // Exchanges `value` with all the processes through the key-value store of the
+  // distributed runtime, without any device involved. Returns the values of the
+  // processes, by rank. The processes must make the calls with the same `tag`
+  // in the same order.
+  std::vector<std::string> AllGather(const std::string& tag,
+                                     const std::string& value,
+                                     absl::Duration timeout);
+
  private:
+  int global_rank_;
+  int world_size_;
+  std::mutex all_gather_mutex_;
+  // The number of AllGather() calls made with each tag.
+  std::unordered_map<std::string, int64_t> all_gather_rounds_;
   std::unique_ptr<xla::DistributedRuntimeService> dist_runtime_service_;
   std::shared_ptr<xla::DistributedRuntimeClient> dist_runtime_client_;
   std::unique_ptr<tsl::PreemptionSyncManager> preemption_sync_manager_;
@@ -13,6 +13,9 @@
 #include "torch_xla/csrc/runtime/util.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/stacktrace.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/shape_util.h"
 #include "xla/util.h"
 
@@ -64,6 +67,18 @@ std::string MaybeDumpHloGraph(
   return ss.str();
 }
 
+// The bytes of the arrays of `shape`.
+int64_t ArrayBytes(const xla::Shape& shape) {
+  int64_t bytes = 0;
+  xla::ShapeUtil::ForEachSubshape(
+      shape, [&](const xla::Shape& subshape, const xla::ShapeIndex&) {
+        if (subshape.IsArray()) {
+          bytes += xla::ShapeUtil::ByteSizeOf(subshape);
+        }
+      });
+  return bytes;
+}
+
 }  // namespace
 
 xla::StatusOr<std::unique_ptr<xla::HloModule>> CreateModuleFromProto(
@@ -106,6 +121,64 @@ void CheckComputationStatus(
   }
 }
 
+CollectiveStats GetCollectiveStats(const xla::HloModule& module) {
+  const int64_t num_devices =
+      module.config().replica_count() * module.config().num_partitions();
+  CollectiveStats stats;
+  for (const xla::HloComputation* computation : module.computations()) {
+    for (const xla::HloInstruction* instruction :
+         computation->instructions()) {
+      xla::HloOpcode opcode = instruction->opcode();
+      const xla::Shape* result_shape = &instruction->shape();
+      switch (opcode) {
+        case xla::HloOpcode::kAllGatherStart:
+        case xla::HloOpcode::kCollectivePermuteStart:
+          // The starts hold their operands along with their results.
+          result_shape = &result_shape->tuple_shapes(1);
+          opcode = opcode == xla::HloOpcode::kAllGatherStart
+                       ? xla::HloOpcode::kAllGather
+                       : xla::HloOpcode::kCollectivePermute;
+          break;
+        case xla::HloOpcode::kAllReduceStart:
+          opcode = xla::HloOpcode::kAllReduce;
+          break;
+        case xla::HloOpcode::kAllGather:
+        case xla::HloOpcode::kAllReduce:
+        case xla::HloOpcode::kAllToAll:
+        case xla::HloOpcode::kCollectivePermute:
+        case xla::HloOpcode::kReduceScatter:
+          break;
+        default:
+          continue;
+      }
+      std::string name(xla::HloOpcodeString(opcode));
+      int64_t bytes = ArrayBytes(*result_shape);
+      stats.counts[name] += 1;
+      stats.bytes[name] += bytes;
+      if (opcode == xla::HloOpcode::kCollectivePermute) {
+        stats.bus_bytes += bytes;
+        continue;
+      }
+      int64_t group_size = instruction->replica_groups().empty()
+                               ? num_devices
+                               : instruction->replica_groups()
+                                     .front()
+                                     .replica_ids_size();
+      stats.group_sizes[group_size] += 1;
+      double fraction = static_cast<double>(group_size - 1) / group_size;
+      if (opcode == xla::HloOpcode::kAllReduce) {
+        stats.bus_bytes += 2 * fraction * bytes;
+      } else if (opcode == xla::HloOpcode::kReduceScatter) {
+        // The scattered data is the operand, group_size times the result.
+        stats.bus_bytes += fraction * bytes * group_size;
+      } else {
+        stats.bus_bytes += fraction * bytes;
+      }
+    }
+  }
+  return stats;
+}
+
 torch::lazy::hash_t ShapeHash(const xla::Shape& shape) {
   torch::lazy::hash_t hash = 0xa5d2d6916;
   xla::ShapeUtil::ForEachSubshape(
@@ -115,6 +188,19 @@ torch::lazy::hash_t ShapeHash(const xla::Shape& shape) {
   return hash;
 }
 
+torch::lazy::hash_t ComputationFingerprint(
+    const xla::XlaComputation& computation) {
+  std::unique_ptr<xla::HloModule> module =
+      CreateModuleFromProto(computation.proto()).value();
+  module->set_name("fingerprint");
+  // The constants and backend configs, like the payloads of the custom
+  // kernels, are part of the program.
+  xla::HloPrintOptions options = xla::HloPrintOptions::Canonical()
+                                     .set_print_large_constants(true)
+                                     .set_print_backend_config(true);
+  return torch::lazy::Hash(module->ToString(options));
+}
+
 }  // namespace util
 }  // namespace runtime
 }  // namespace torch_xla
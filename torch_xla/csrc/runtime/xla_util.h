@@ -3,6 +3,7 @@
 
 #include <torch/csrc/lazy/core/hash.h>
 
+#include <map>
 #include <string>
 
 #include "absl/types/span.h"
@@ -39,6 +40,33 @@ void CheckComputationStatus(
 
 torch::lazy::hash_t ShapeHash(const xla::Shape& shape);
 
+// The hash of the canonical text of the HLO module of `computation`, with its
+// module and instructions renamed and without its metadata, so that the
+// computations differing only in their debug information hash the same.
+torch::lazy::hash_t ComputationFingerprint(
+    const xla::XlaComputation& computation);
+
+// The collectives of an HLO module, each counted once, even within a loop.
+struct CollectiveStats {
+  // The number of collectives, by HLO opcode (eg. "all-reduce"), with the
+  // asynchronous ones counted under the opcode of their synchronous form.
+  std::map<std::string, int64_t> counts;
+  // The bytes of the results of the collectives, by HLO opcode.
+  std::map<std::string, int64_t> bytes;
+  // The number of collectives by the size of their replica groups.
+  std::map<int64_t, int64_t> group_sizes;
+  // The bytes each device moves over the interconnect for the collectives,
+  // following the bus bandwidth conventions of the NCCL tests: 2(n-1)/n times
+  // the bytes of an all-reduce over n devices, (n-1)/n times the bytes of the
+  // gathered or scattered data for the other collectives, and the bytes of a
+  // collective permute.
+  double bus_bytes = 0;
+
+  bool empty() const { return counts.empty(); }
+};
+
+CollectiveStats GetCollectiveStats(const xla::HloModule& module);
+
 }  // namespace util
 }  // namespace runtime
 }  // namespace torch_xla
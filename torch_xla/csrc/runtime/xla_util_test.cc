@@ -115,6 +115,39 @@ TEST(XlaUtilrest, XlaToHlo) {
                   HasSubstr("ROOT %add.3"))));
 }
 
+TEST(XlaUtilTest, CollectiveStats) {
+  xla::Shape input_shape =
+      xla::ShapeUtil::MakeShape(xla::PrimitiveType::F32, {4, 8});
+  xla::XlaBuilder builder("CollectiveComputation");
+  xla::XlaOp x = xla::Parameter(&builder, 0, input_shape, "x");
+  xla::XlaComputation add;
+  {
+    xla::XlaBuilder add_builder("add");
+    xla::Shape scalar = xla::ShapeUtil::MakeShape(xla::PrimitiveType::F32, {});
+    xla::Add(xla::Parameter(&add_builder, 0, scalar, "a"),
+             xla::Parameter(&add_builder, 1, scalar, "b"));
+    add = *add_builder.Build();
+  }
+  xla::ReplicaGroup group;
+  for (int64_t i = 0; i < 4; ++i) {
+    group.add_replica_ids(i);
+  }
+  xla::XlaOp sum = xla::AllReduce(x, add, {group});
+  xla::AllGather(sum, /*all_gather_dimension=*/0, /*shard_count=*/4, {group});
+  xla::XlaComputation computation = *builder.Build();
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xla::HloModule> module,
+                          CreateModuleFromProto(computation.proto()));
+
+  CollectiveStats stats = GetCollectiveStats(*module);
+  EXPECT_EQ(stats.counts["all-reduce"], 1);
+  EXPECT_EQ(stats.counts["all-gather"], 1);
+  EXPECT_EQ(stats.bytes["all-reduce"], 4 * 8 * 4);
+  EXPECT_EQ(stats.bytes["all-gather"], 16 * 8 * 4);
+  EXPECT_EQ(stats.group_sizes[4], 2);
+  // 2(n-1)/n of the all-reduce bytes and (n-1)/n of the gathered bytes.
+  EXPECT_DOUBLE_EQ(stats.bus_bytes, 1.5 * 128 + 0.75 * 512);
+}
+
 }  // namespace util
 }  // namespace runtime
 }  // namespace torch_xla
@@ -0,0 +1,266 @@
+#include "torch_xla/csrc/sharded_checkpoint.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+#include <torch/csrc/lazy/core/util.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "torch_xla/csrc/device.h"
+#include "torch_xla/csrc/dtype.h"
+#include "torch_xla/csrc/runtime/computation_client.h"
+#include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/runtime.h"
+#include "torch_xla/csrc/thread_pool.h"
+#include "torch_xla/csrc/xla_sharding_util.h"
+#include "tsl/profiler/lib/traceme.h"
+#include "xla/layout_util.h"
+#include "xla/literal.h"
+#include "xla/shape_util.h"
+
+namespace torch_xla {
+namespace {
+
+// Bounds the bytes of the shard buffers alive at once.
+class ByteBudget {
+ public:
+  explicit ByteBudget(int64_t max_bytes) : max_bytes_(max_bytes) {}
+
+  void Acquire(int64_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return used_ == 0 || used_ + bytes <= max_bytes_; });
+    used_ += bytes;
+  }
+
+  void Release(int64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    used_ -= bytes;
+    cv_.notify_all();
+  }
+
+  void WaitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return used_ == 0; });
+  }
+
+ private:
+  const int64_t max_bytes_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int64_t used_ = 0;
+};
+
+// Keeps the first exception thrown by the background tasks, rethrown once
+// they are all done.
+class FirstError {
+ public:
+  template <typename F>
+  void Run(const F& fn) {
+    try {
+      fn();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+
+  void MaybeRethrow() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::exception_ptr error_;
+};
+
+std::string ShardPath(const std::string& prefix,
+                      const ShardingUtil::ShardRegion& region) {
+  return absl::StrCat(
+      prefix, ".",
+      region.starts.empty() ? "0" : absl::StrJoin(region.starts, "_"));
+}
+
+// The regions of the shards of `tensor` on `devices`, in the same order.
+std::vector<ShardingUtil::ShardRegion> GetShardRegions(
+    const XLATensorPtr& tensor, const std::vector<std::string>& devices) {
+  XLATensor::ShardingSpecPtr sharding_spec = tensor->sharding_spec();
+  xla::Shape shape =
+      sharding_spec != nullptr ? sharding_spec->shape : tensor->shape().get();
+  std::vector<int64_t> tensor_shape =
+      torch::lazy::ToVector<int64_t>(shape.dimensions());
+  if (sharding_spec != nullptr &&
+      sharding_spec->sharding.type() == xla::OpSharding::OTHER) {
+    return ShardingUtil::GetShardRegionsForDevices(
+        ShardingUtil::GetShardShape(sharding_spec), tensor_shape,
+        sharding_spec->sharding, devices);
+  }
+  XLA_CHECK(sharding_spec == nullptr ||
+            sharding_spec->sharding.type() == xla::OpSharding::REPLICATED)
+      << "Unsupported OpSharding type " << sharding_spec->sharding.type();
+  std::vector<ShardingUtil::ShardRegion> regions(devices.size());
+  for (size_t i = 0; i < devices.size(); ++i) {
+    regions[i].replica_id = ParseDeviceString(devices[i]).ordinal();
+    regions[i].starts.assign(tensor_shape.size(), 0);
+    regions[i].sizes.assign(tensor_shape.begin(), tensor_shape.end());
+  }
+  return regions;
+}
+
+void WriteShardFile(const std::string& path, const xla::Literal& literal) {
+  // Written aside then renamed, so that a partial write is never mistaken
+  // for a shard.
+  std::string tmp_path = absl::StrCat(path, ".tmp");
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    out.write(static_cast<const char*>(literal.untyped_data()),
+              literal.size_bytes());
+    XLA_CHECK(out.good()) << "Failed to write checkpoint shard " << tmp_path;
+  }
+  XLA_CHECK_EQ(std::rename(tmp_path.c_str(), path.c_str()), 0)
+      << "Failed to rename checkpoint shard " << tmp_path << " to " << path;
+}
+
+void ReadShardFile(const std::string& path, at::Tensor* shard) {
+  int64_t size = shard->numel() * shard->element_size();
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  XLA_CHECK(in.good()) << "Failed to open checkpoint shard " << path;
+  XLA_CHECK_EQ(static_cast<int64_t>(in.tellg()), size)
+      << "Checkpoint shard " << path << " does not match the shard shape "
+      << shard->sizes();
+  in.seekg(0);
+  in.read(static_cast<char*>(shard->data_ptr()), size);
+  XLA_CHECK(in.good()) << "Failed to read checkpoint shard " << path;
+}
+
+}  // namespace
+
+void SaveLocalShards(absl::Span<const XLATensorPtr> tensors,
+                     absl::Span<const std::string> prefixes,
+                     int64_t max_buffered_bytes) {
+  tsl::profiler::TraceMe activity("SaveLocalShards",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  XLA_CHECK_EQ(tensors.size(), prefixes.size());
+  XLA_CHECK(UseVirtualDevice())
+      << "Please enable SPMD via `torch_xla.runtime.use_spmd()`";
+  runtime::ComputationClient* client = runtime::GetComputationClient();
+  ByteBudget budget(max_buffered_bytes);
+  FirstError error;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    auto handle = std::dynamic_pointer_cast<runtime::ComputationClient::Data>(
+        tensors[i]->GetXlaData());
+    XLA_CHECK(handle != nullptr) << "Shard data is not available";
+    std::vector<runtime::ComputationClient::DataPtr> shards =
+        client->GetDataShards(handle);
+    std::vector<std::string> devices;
+    devices.reserve(shards.size());
+    for (const auto& shard : shards) {
+      devices.push_back(shard->device());
+    }
+    std::vector<ShardingUtil::ShardRegion> regions =
+        GetShardRegions(tensors[i], devices);
+    for (size_t j = 0; j < shards.size(); ++j) {
+      if (regions[j].replica_id != 0) {
+        continue;
+      }
+      int64_t bytes = xla::ShapeUtil::ByteSizeOf(shards[j]->shape());
+      budget.Acquire(bytes);
+      std::shared_ptr<xla::Literal> literal;
+      std::vector<xla::PjRtFuture<>> futures = client->TransferFromDeviceAsync(
+          {shards[j]}, [&](size_t, const xla::Shape& host_shape) {
+            literal = std::make_shared<xla::Literal>(host_shape);
+            return literal.get();
+          });
+      std::string path = ShardPath(prefixes[i], regions[j]);
+      futures.front().OnReady([&budget, &error, literal, path,
+                               bytes](absl::Status status) {
+        thread::Schedule([&budget, &error, literal, path, bytes, status]() {
+          error.Run([&]() {
+            XLA_CHECK_OK(status) << "Failed to transfer " << path;
+            // The shards are stored row major, as the tensors they load into.
+            const xla::Shape& shape = literal->shape();
+            if (xla::LayoutUtil::IsMonotonicWithDim0Major(shape.layout())) {
+              WriteShardFile(path, *literal);
+            } else {
+              xla::Layout layout =
+                  xla::LayoutUtil::GetDefaultLayoutForShape(shape);
+              WriteShardFile(path, literal->Relayout(layout));
+            }
+            TORCH_LAZY_COUNTER("CheckpointShardWritten", 1);
+          });
+          budget.Release(bytes);
+        });
+      });
+    }
+  }
+  budget.WaitIdle();
+  error.MaybeRethrow();
+}
+
+void LoadLocalShards(absl::Span<const XLATensorPtr> tensors,
+                     absl::Span<const std::string> prefixes,
+                     int64_t max_buffered_bytes) {
+  tsl::profiler::TraceMe activity("LoadLocalShards",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  XLA_CHECK_EQ(tensors.size(), prefixes.size());
+  XLA_CHECK(UseVirtualDevice())
+      << "Please enable SPMD via `torch_xla.runtime.use_spmd()`";
+  std::vector<std::string> devices =
+      runtime::GetComputationClient()->GetLocalDevices();
+  ByteBudget budget(max_buffered_bytes);
+  FirstError error;
+  std::vector<runtime::ComputationClient::DataPtr> data(tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    XLATensor::ShardingSpecPtr sharding_spec = tensors[i]->sharding_spec();
+    xla::Shape shape = sharding_spec != nullptr ? sharding_spec->shape
+                                                : tensors[i]->shape().get();
+    std::vector<int64_t> shard_shape =
+        sharding_spec != nullptr &&
+                sharding_spec->sharding.type() == xla::OpSharding::OTHER
+            ? ShardingUtil::GetShardShape(sharding_spec)
+            : torch::lazy::ToVector<int64_t>(shape.dimensions());
+    at::ScalarType scalar_type = TorchTypeFromXlaType(shape.element_type());
+    int64_t bytes =
+        devices.size() * xla::ShapeUtil::ByteSizeOf(xla::ShapeUtil::MakeShape(
+                             shape.element_type(), shard_shape));
+    budget.Acquire(bytes);
+    std::vector<ShardingUtil::ShardRegion> regions =
+        GetShardRegions(tensors[i], devices);
+    std::string prefix = prefixes[i];
+    thread::Schedule([&, i, sharding_spec, shard_shape, scalar_type, bytes,
+                      regions = std::move(regions),
+                      prefix = std::move(prefix)]() {
+      error.Run([&]() {
+        std::vector<at::Tensor> shards;
+        shards.reserve(regions.size());
+        for (const ShardingUtil::ShardRegion& region : regions) {
+          shards.push_back(
+              at::empty(shard_shape, at::TensorOptions(scalar_type)));
+          ReadShardFile(ShardPath(prefix, region), &shards.back());
+        }
+        TORCH_LAZY_COUNTER("CheckpointShardRead", shards.size());
+        data[i] =
+            ShardingUtil::CreateShardedData(shards, devices, sharding_spec);
+      });
+      budget.Release(bytes);
+    });
+  }
+  budget.WaitIdle();
+  error.MaybeRethrow();
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    tensors[i]->SetXlaData(data[i]);
+  }
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,36 @@
+#ifndef XLA_TORCH_XLA_CSRC_SHARDED_CHECKPOINT_H_
+#define XLA_TORCH_XLA_CSRC_SHARDED_CHECKPOINT_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/types/span.h"
+#include "torch_xla/csrc/tensor.h"
+
+namespace torch_xla {
+
+// Streams the local shards of tensors between the devices and files, keeping
+// at most `max_buffered_bytes` of shard data in host memory (a larger shard
+// goes through alone). Each distinct shard lives in its own file, named after
+// the path prefix of its tensor and the offset of the shard in the tensor
+// (eg. "<prefix>.0_128"), so that any process holding the shard can read it
+// back. Unsharded tensors are handled as replicated.
+
+// Writes the local shards of `tensors[i]` under `prefixes[i]`. Only the first
+// replica of every shard is written. The device reads overlap with the file
+// writes, which run on the thread pool.
+void SaveLocalShards(absl::Span<const XLATensorPtr> tensors,
+                     absl::Span<const std::string> prefixes,
+                     int64_t max_buffered_bytes);
+
+// Reads the local shards of `tensors[i]` from under `prefixes[i]` and
+// transfers them to the devices, replacing the data of the tensors. The
+// tensors keep their sharding, which must be the one the shards were written
+// with. The files are read on the thread pool.
+void LoadLocalShards(absl::Span<const XLATensorPtr> tensors,
+                     absl::Span<const std::string> prefixes,
+                     int64_t max_buffered_bytes);
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_SHARDED_CHECKPOINT_H_
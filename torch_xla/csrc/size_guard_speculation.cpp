@@ -0,0 +1,48 @@
+#include "torch_xla/csrc/size_guard_speculation.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include "absl/strings/str_cat.h"
+#include "torch_xla/csrc/frame_table.h"
+#include "torch_xla/csrc/ops/dynamic_ir.h"
+
+namespace torch_xla {
+
+SizeGuardSpeculation* SizeGuardSpeculation::Get() {
+  static SizeGuardSpeculation* speculation = new SizeGuardSpeculation();
+  return speculation;
+}
+
+int64_t SizeGuardSpeculation::Guard(const torch::lazy::NodePtr& node,
+                                    const char* file, int64_t line) {
+  // The C++ location of a guard is the same for all the Python conditions on a
+  // size, so the site includes the interned Python stack.
+  std::string site = absl::StrCat(file != nullptr ? file : "", ":", line, "@",
+                                  FrameTable::Get()->CaptureStack());
+  if (enabled()) {
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = predictions_.find(site);
+    if (it != predictions_.end()) {
+      TORCH_LAZY_COUNTER("SpeculatedSizeGuards", 1);
+      pending_.push_back({site, node, it->second});
+      return it->second;
+    }
+  }
+  int64_t value = DimCast(node)->getDynamicValue();
+  Observe(site, value);
+  return value;
+}
+
+std::vector<SizeGuardSpeculation::Pending> SizeGuardSpeculation::TakePending() {
+  std::lock_guard<std::mutex> lock(lock_);
+  std::vector<Pending> pending;
+  pending.swap(pending_);
+  return pending;
+}
+
+void SizeGuardSpeculation::Observe(const std::string& site, int64_t value) {
+  std::lock_guard<std::mutex> lock(lock_);
+  predictions_[site] = value;
+}
+
+}  // namespace torch_xla
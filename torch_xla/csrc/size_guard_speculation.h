@@ -0,0 +1,58 @@
+#ifndef XLA_TORCH_XLA_CSRC_SIZE_GUARD_SPECULATION_H_
+#define XLA_TORCH_XLA_CSRC_SIZE_GUARD_SPECULATION_H_
+
+#include <torch/csrc/lazy/core/ir.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace torch_xla {
+
+// Speculates the values of the guards on the dynamic sizes. A guard like
+// `if x.shape[0] > 0` needs the concrete value of the size, which executes the
+// pending graph up to it. While speculating, a guard of a call site whose
+// value was observed before returns that value, and the size expression is
+// kept as pending, so that the caller validates the speculations once the
+// graph executes, and traces the step again only on a misprediction. The call
+// sites seen for the first time are still evaluated.
+class SizeGuardSpeculation {
+ public:
+  // A speculated guard, to validate.
+  struct Pending {
+    std::string site;
+    torch::lazy::NodePtr node;
+    int64_t predicted = 0;
+  };
+
+  static SizeGuardSpeculation* Get();
+
+  bool enabled() const { return enabled_.load(); }
+
+  void set_enabled(bool enabled) { enabled_ = enabled; }
+
+  // Returns the value of the size `node` guarded at `file:line`, from the
+  // current Python stack.
+  int64_t Guard(const torch::lazy::NodePtr& node, const char* file,
+                int64_t line);
+
+  // Takes the guards speculated since the last call.
+  std::vector<Pending> TakePending();
+
+  // Records the value the guard of `site` evaluated to, which is the next
+  // prediction of the site.
+  void Observe(const std::string& site, int64_t value);
+
+ private:
+  std::atomic<bool> enabled_{false};
+  std::mutex lock_;
+  std::unordered_map<std::string, int64_t> predictions_;
+  std::vector<Pending> pending_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_SIZE_GUARD_SPECULATION_H_
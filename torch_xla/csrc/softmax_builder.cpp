@@ -1,5 +1,7 @@
 #include "torch_xla/csrc/softmax_builder.h"
 
+#include <torch/csrc/lazy/core/util.h>
+
 #include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/shape_helper.h"
@@ -147,4 +149,50 @@ xla::XlaOp BuildSoftmaxGrad(xla::XlaOp grad_output, xla::XlaOp output,
   return xla::Mul(output, xla::Sub(grad_output, sum, broadcast_dimensions));
 }
 
+xla::XlaOp BuildMaskedScaledSoftmax(xla::XlaOp logits,
+                                    const absl::optional<xla::XlaOp>& mask,
+                                    double scale, bool causal) {
+  const xla::Shape& logits_shape = ShapeHelper::ShapeOfXlaOp(logits);
+  int64_t rank = logits_shape.rank();
+  XLA_CHECK_GE(rank, causal ? 2 : 1) << logits_shape;
+  xla::PrimitiveType type = logits_shape.element_type();
+  xla::XlaBuilder* builder = logits.builder();
+  xla::XlaOp scaled = xla::Mul(
+      logits, XlaHelpers::ScalarValue<double>(scale, type, builder));
+  // The dropped positions are -inf, so that all of them being dropped gives
+  // NaNs, like the softmax of masked_fill(-inf) does.
+  xla::XlaOp dropped = xla::Broadcast(xla::MinValue(builder, type),
+                                      logits_shape.dimensions());
+  if (mask) {
+    const xla::Shape& mask_shape = ShapeHelper::ShapeOfXlaOp(*mask);
+    XLA_CHECK_LE(mask_shape.rank(), rank) << mask_shape;
+    xla::XlaOp broadcast_mask = xla::BroadcastInDim(
+        *mask, logits_shape.dimensions(),
+        torch::lazy::Iota<int64_t>(mask_shape.rank(),
+                                   rank - mask_shape.rank()));
+    scaled = mask_shape.element_type() == xla::PrimitiveType::PRED
+                 ? xla::Select(broadcast_mask, scaled, dropped)
+                 : xla::Add(scaled,
+                            xla::ConvertElementType(broadcast_mask, type));
+  }
+  if (causal) {
+    xla::Shape iota_shape = xla::ShapeUtil::MakeShape(
+        xla::PrimitiveType::S32, logits_shape.dimensions());
+    xla::XlaOp rows = xla::Iota(builder, iota_shape, rank - 2);
+    xla::XlaOp cols = xla::Iota(builder, iota_shape, rank - 1);
+    scaled = xla::Select(xla::Ge(rows, cols), scaled, dropped);
+  }
+  return BuildSoftmax(scaled, rank - 1);
+}
+
+xla::XlaOp BuildMaskedScaledSoftmaxGrad(xla::XlaOp grad_output,
+                                        xla::XlaOp output, double scale) {
+  const xla::Shape& output_shape = ShapeHelper::ShapeOfXlaOp(output);
+  xla::XlaOp grad_scaled =
+      BuildSoftmaxGrad(grad_output, output, output_shape.rank() - 1);
+  return xla::Mul(grad_scaled,
+                  XlaHelpers::ScalarValue<double>(
+                      scale, output_shape.element_type(), output.builder()));
+}
+
 }  // namespace torch_xla
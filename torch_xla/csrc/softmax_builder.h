@@ -1,6 +1,7 @@
 #ifndef XLA_TORCH_XLA_CSRC_SOFTMAX_BUILDER_H_
 #define XLA_TORCH_XLA_CSRC_SOFTMAX_BUILDER_H_
 
+#include "absl/types/optional.h"
 #include "xla/client/xla_builder.h"
 
 namespace torch_xla {
@@ -17,6 +18,20 @@ xla::XlaOp BuildSoftmax(xla::XlaOp logits, int64_t dim);
 xla::XlaOp BuildSoftmaxGrad(xla::XlaOp grad_output, xla::XlaOp output,
                             int64_t dim);
 
+// Computes softmax(logits * scale + mask) along the last dimension. A PRED
+// mask drops the positions where it is false, and a floating point one is
+// added to the scaled logits; it broadcasts to the logits by its minor
+// dimensions. With `causal`, the positions above the diagonal of the two minor
+// dimensions are dropped too, from an iota comparison rather than a mask.
+xla::XlaOp BuildMaskedScaledSoftmax(xla::XlaOp logits,
+                                    const absl::optional<xla::XlaOp>& mask,
+                                    double scale, bool causal);
+
+// Computes the gradient of the logits of BuildMaskedScaledSoftmax() from its
+// output, which is zero at the dropped positions.
+xla::XlaOp BuildMaskedScaledSoftmaxGrad(xla::XlaOp grad_output,
+                                        xla::XlaOp output, double scale);
+
 }  // namespace torch_xla
 
 #endif  // XLA_TORCH_XLA_CSRC_SOFTMAX_BUILDER_H_
\ No newline at end of file
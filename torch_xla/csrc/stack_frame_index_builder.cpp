@@ -1,5 +1,7 @@
 #include "torch_xla/csrc/stack_frame_index_builder.h"
 
+#include "torch_xla/csrc/frame_table.h"
+
 namespace torch_xla {
 
 // Invalid stack frame id - used for stack frame population
@@ -36,6 +38,24 @@ void StackFrameIndexBuilder::AddStackFrameLocations(
   }
 }
 
+void StackFrameIndexBuilder::AddStackFrameLocations(
+    int32_t stack, int max_stack_depth, xla::OpMetadata& metadata_to_populate) {
+  if (stack == FrameTable::kNoStack) {
+    return;
+  }
+  auto key = std::make_pair(stack, max_stack_depth);
+  auto it = stack_to_metadata_.find(key);
+  if (it == stack_to_metadata_.end()) {
+    xla::OpMetadata metadata;
+    AddStackFrameLocations(FrameTable::Get()->GetFrames(stack),
+                           max_stack_depth, metadata);
+    it = stack_to_metadata_.emplace(key, std::move(metadata)).first;
+  }
+  metadata_to_populate.set_source_file(it->second.source_file());
+  metadata_to_populate.set_source_line(it->second.source_line());
+  metadata_to_populate.set_stack_frame_id(it->second.stack_frame_id());
+}
+
 int StackFrameIndexBuilder::AddStackFrameLocation(
     const torch::lazy::SourceLocation& frame, int parent_frame_id) {
   int line = frame.line;
@@ -2,9 +2,12 @@
 
 #include <torch/csrc/lazy/core/ir_metadata.h>  // SourceLocation
 
+#include <cstdint>
 #include <map>
 #include <string_view>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include "xla/service/hlo.pb.h"
 #include "xla/types.h"
@@ -22,6 +25,11 @@ class StackFrameIndexBuilder {
                               int max_stack_depth,
                               xla::OpMetadata& metadata_to_populate);
 
+  // Same as above for the interned `stack` of the FrameTable, which is only
+  // expanded the first time it is added with `max_stack_depth`.
+  void AddStackFrameLocations(int32_t stack, int max_stack_depth,
+                              xla::OpMetadata& metadata_to_populate);
+
   const xla::StackFrameIndexProto& stack_frame_index() const {
     return indexes_;
   }
@@ -37,6 +45,8 @@ class StackFrameIndexBuilder {
   std::map<std::string_view, int> file_name_to_id_;
   std::map<std::tuple<int, int, int, int>, int> file_location_to_id_;
   std::map<std::tuple<int, int>, int> frame_to_id_;
+  // The source file, line and stack frame id of the interned stacks added.
+  std::map<std::pair<int32_t, int>, xla::OpMetadata> stack_to_metadata_;
 };  // StackFrameIndexBuilder
 
 }  // namespace torch_xla
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "torch_xla/csrc/step_pipeline.h"
+
+#include <torch/csrc/lazy/core/metrics.h>
+
+#include "torch_xla/csrc/runtime/runtime.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+#include "tsl/profiler/lib/traceme.h"
+
+namespace torch_xla {
+namespace {
+
+void CountDrain(StepPipeline::DrainCause cause) {
+  switch (cause) {
+    case StepPipeline::DrainCause::kInflightLimit:
+      TORCH_LAZY_COUNTER("StepPipelineDrainInflightLimit", 1);
+      break;
+    case StepPipeline::DrainCause::kWaitDeviceOps:
+      TORCH_LAZY_COUNTER("StepPipelineDrainWaitDeviceOps", 1);
+      break;
+    case StepPipeline::DrainCause::kSyncWait:
+      TORCH_LAZY_COUNTER("StepPipelineDrainSyncWait", 1);
+      break;
+  }
+}
+
+}  // namespace
+
+void StepPipeline::Step::Dispatched(
+    absl::Span<const runtime::ComputationClient::DataPtr> outputs) {
+  std::vector<xla::PjRtFuture<>> futures;
+  if (!outputs.empty()) {
+    futures = runtime::GetComputationClient()->GetReadyFutures(outputs);
+  }
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    dispatched_ = true;
+    futures_ = std::move(futures);
+  }
+  cv_.notify_all();
+}
+
+bool StepPipeline::Step::IsComplete() {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (!dispatched_) {
+    return false;
+  }
+  for (xla::PjRtFuture<>& future : futures_) {
+    if (!future.IsReady()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void StepPipeline::Step::Wait() {
+  std::vector<xla::PjRtFuture<>> futures;
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    cv_.wait(lock, [this] { return dispatched_; });
+    futures = futures_;
+  }
+  for (xla::PjRtFuture<>& future : futures) {
+    // Execution errors surface when the outputs are used, the pipeline only
+    // cares about the execution being over.
+    future.Await().IgnoreError();
+  }
+}
+
+StepPipeline* StepPipeline::Get() {
+  static StepPipeline* pipeline = new StepPipeline(
+      runtime::sys_util::GetEnvInt("XLA_MAX_INFLIGHT_STEPS", 0));
+  return pipeline;
+}
+
+std::shared_ptr<StepPipeline::Step> StepPipeline::BeginStep() {
+  if (!enabled()) {
+    return nullptr;
+  }
+  std::unique_lock<std::mutex> lock(lock_);
+  PruneCompleted();
+  while (steps_.size() >= max_inflight_steps_) {
+    std::shared_ptr<Step> oldest = std::move(steps_.front());
+    steps_.pop_front();
+    lock.unlock();
+    if (!oldest->IsComplete()) {
+      tsl::profiler::TraceMe activity("StepPipelineDrain",
+                                      tsl::profiler::TraceMeLevel::kInfo);
+      TORCH_LAZY_TIMED("StepPipelineDrainTime");
+      CountDrain(DrainCause::kInflightLimit);
+      oldest->Wait();
+    }
+    lock.lock();
+    PruneCompleted();
+  }
+  auto step = std::make_shared<Step>();
+  steps_.push_back(step);
+  return step;
+}
+
+void StepPipeline::Drain(DrainCause cause) {
+  if (!enabled()) {
+    return;
+  }
+  std::deque<std::shared_ptr<Step>> steps;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    PruneCompleted();
+    steps.swap(steps_);
+  }
+  bool pending = false;
+  for (std::shared_ptr<Step>& step : steps) {
+    pending = pending || !step->IsComplete();
+  }
+  if (!pending) {
+    return;
+  }
+  tsl::profiler::TraceMe activity("StepPipelineDrain",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  TORCH_LAZY_TIMED("StepPipelineDrainTime");
+  CountDrain(cause);
+  for (std::shared_ptr<Step>& step : steps) {
+    step->Wait();
+  }
+}
+
+void StepPipeline::RecordFetch(
+    absl::Span<const runtime::ComputationClient::DataPtr> data) {
+  if (!enabled() || data.empty()) {
+    return;
+  }
+  for (xla::PjRtFuture<>& future :
+       runtime::GetComputationClient()->GetReadyFutures(data)) {
+    if (!future.IsReady()) {
+      TORCH_LAZY_COUNTER("StepPipelineFetchWait", 1);
+      return;
+    }
+  }
+}
+
+size_t StepPipeline::InflightSteps() {
+  std::lock_guard<std::mutex> lock(lock_);
+  PruneCompleted();
+  size_t count = 0;
+  for (std::shared_ptr<Step>& step : steps_) {
+    if (!step->IsComplete()) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+void StepPipeline::PruneCompleted() {
+  while (!steps_.empty() && steps_.front()->IsComplete()) {
+    steps_.pop_front();
+  }
+}
+
+}  // namespace torch_xla
@@ -0,0 +1,92 @@
+#ifndef XLA_TORCH_XLA_CSRC_STEP_PIPELINE_H_
+#define XLA_TORCH_XLA_CSRC_STEP_PIPELINE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "torch_xla/csrc/runtime/computation_client.h"
+
+namespace torch_xla {
+
+// Bounds the number of graph executions which have been scheduled by the
+// graph executor but not yet completed on the device, so that tracing can run
+// ahead of the device by at most XLA_MAX_INFLIGHT_STEPS executions (unbounded
+// when zero, the default, in which case nothing is tracked).
+//
+// Within the bound, the host never waits for the device, except for:
+//  - Scheduling an execution while the bound is reached, which waits for the
+//    oldest execution to complete (drain cause InflightLimit).
+//  - Waiting for the device ops (drain cause WaitDeviceOps) or syncing with
+//    `wait` set, eg. XLA_SYNC_WAIT (drain cause SyncWait), which wait for all
+//    the inflight executions.
+// Fetching tensor values only waits for the executions computing them, never
+// for the later ones, so logging the loss of a step does not stall the next
+// one (counter StepPipelineFetchWait when the values are not ready yet).
+class StepPipeline {
+ public:
+  enum class DrainCause {
+    kInflightLimit,
+    kWaitDeviceOps,
+    kSyncWait,
+  };
+
+  // An execution tracked by the pipeline.
+  class Step {
+   public:
+    // To be called by the execution closure once the computation has been
+    // dispatched, with its outputs. Failed executions pass no outputs.
+    void Dispatched(
+        absl::Span<const runtime::ComputationClient::DataPtr> outputs);
+
+   private:
+    friend class StepPipeline;
+
+    bool IsComplete();
+
+    void Wait();
+
+    std::mutex lock_;
+    std::condition_variable cv_;
+    bool dispatched_ = false;
+    std::vector<xla::PjRtFuture<>> futures_;
+  };
+
+  static StepPipeline* Get();
+
+  bool enabled() const { return max_inflight_steps_ > 0; }
+
+  // Registers an execution about to be scheduled, first waiting for the
+  // oldest ones to complete if the bound is reached. Returns nullptr when the
+  // pipeline is not enabled.
+  std::shared_ptr<Step> BeginStep();
+
+  // Waits for all the inflight executions to complete.
+  void Drain(DrainCause cause);
+
+  // Accounts for a fetch of `data`, which then waits for the device buffers
+  // to be computed.
+  void RecordFetch(absl::Span<const runtime::ComputationClient::DataPtr> data);
+
+  // Number of inflight executions, completed ones not included.
+  size_t InflightSteps();
+
+ private:
+  explicit StepPipeline(size_t max_inflight_steps)
+      : max_inflight_steps_(max_inflight_steps) {}
+
+  // Drops the completed executions at the front of `steps_`.
+  void PruneCompleted();
+
+  const size_t max_inflight_steps_;
+  std::mutex lock_;
+  std::deque<std::shared_ptr<Step>> steps_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_STEP_PIPELINE_H_
@@ -0,0 +1,135 @@
+#include "torch_xla/csrc/step_timeline.h"
+
+#include "absl/strings/str_cat.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
+
+namespace torch_xla {
+namespace {
+
+thread_local std::shared_ptr<StepTimeline::Record> g_current_step;
+
+}  // namespace
+
+StepTimeline::ScopedStep::ScopedStep() {
+  if (g_current_step == nullptr && StepTimeline::Get()->enabled()) {
+    record_ = std::make_shared<Record>();
+    record_->id = StepTimeline::Get()->next_id_.fetch_add(1);
+    record_->start_ns = runtime::sys_util::NowNs();
+    g_current_step = record_;
+  }
+}
+
+StepTimeline::ScopedStep::~ScopedStep() {
+  if (record_ != nullptr) {
+    record_->host_ns = runtime::sys_util::NowNs() - record_->start_ns;
+    g_current_step.reset();
+    if (record_->num_tensors > 0) {
+      StepTimeline::Get()->Add(std::move(record_));
+    }
+  }
+}
+
+StepTimeline::ScopedStage::ScopedStage(Record* record, Stage stage)
+    : record_(record), stage_(stage) {
+  if (record_ != nullptr) {
+    start_ns_ = runtime::sys_util::NowNs();
+  }
+}
+
+StepTimeline::ScopedStage::~ScopedStage() {
+  if (record_ != nullptr) {
+    AddStageTime(record_, stage_, runtime::sys_util::NowNs() - start_ns_);
+  }
+}
+
+StepTimeline* StepTimeline::Get() {
+  static StepTimeline* timeline = new StepTimeline(
+      runtime::sys_util::GetEnvInt("XLA_STEP_TIMELINE_SIZE", 0));
+  return timeline;
+}
+
+const char* StepTimeline::StageName(Stage stage) {
+  switch (stage) {
+    case Stage::kCollectSyncTensors:
+      return "CollectSyncTensors";
+    case Stage::kExtractIRAndPrepareXlaData:
+      return "ExtractIRAndPrepareXlaData";
+    case Stage::kRunPostOrder:
+      return "RunPostOrder";
+    case Stage::kLookupCachedCompile:
+      return "LookupCachedCompile";
+    case Stage::kCompile:
+      return "Compile";
+    case Stage::kParameterWrapping:
+      return "ParameterWrapping";
+    case Stage::kSetTensorData:
+      return "SetTensorData";
+    case Stage::kTensorCollectionBarrier:
+      return "TensorCollectionBarrier";
+    case Stage::kQueueWait:
+      return "QueueWait";
+    case Stage::kExecute:
+      return "Execute";
+    case Stage::kGatherTensorsXlaData:
+      return "GatherTensorsXlaData";
+    default:
+      return "Unknown";
+  }
+}
+
+StepTimeline::Record* StepTimeline::Current() { return g_current_step.get(); }
+
+std::shared_ptr<StepTimeline::Record> StepTimeline::CurrentShared() {
+  return g_current_step;
+}
+
+void StepTimeline::AddStageTime(Record* record, Stage stage, int64_t ns) {
+  record->stage_ns[static_cast<size_t>(stage)].fetch_add(
+      ns, std::memory_order_relaxed);
+}
+
+std::vector<std::shared_ptr<const StepTimeline::Record>>
+StepTimeline::GetRecords() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return std::vector<std::shared_ptr<const Record>>(records_.begin(),
+                                                    records_.end());
+}
+
+std::string StepTimeline::ToJson() const {
+  std::string json = "[";
+  for (auto& record : GetRecords()) {
+    if (json.size() > 1) {
+      absl::StrAppend(&json, ",");
+    }
+    absl::StrAppend(
+        &json, "{\"id\":", record->id, ",\"start_ns\":", record->start_ns,
+        ",\"host_ns\":", record->host_ns.load(),
+        ",\"num_tensors\":", record->num_tensors, ",\"graph_hash\":\"",
+        torch::lazy::HashToString(record->graph_hash),
+        "\",\"cache_hit\":", record->cache_hit ? "true" : "false",
+        ",\"stages_ns\":{");
+    for (size_t i = 0; i < kNumStages; ++i) {
+      absl::StrAppend(&json, i > 0 ? "," : "", "\"",
+                      StageName(static_cast<Stage>(i)),
+                      "\":", record->stage_ns[i].load());
+    }
+    absl::StrAppend(&json, "}}");
+  }
+  absl::StrAppend(&json, "]");
+  return json;
+}
+
+void StepTimeline::Clear() {
+  std::lock_guard<std::mutex> lock(lock_);
+  records_.clear();
+}
+
+void StepTimeline::Add(std::shared_ptr<Record> record) {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (records_.size() >= capacity_) {
+    records_.pop_front();
+  }
+  records_.push_back(std::move(record));
+}
+
+}  // namespace torch_xla
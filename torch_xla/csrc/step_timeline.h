@@ -0,0 +1,122 @@
+#ifndef XLA_TORCH_XLA_CSRC_STEP_TIMELINE_H_
+#define XLA_TORCH_XLA_CSRC_STEP_TIMELINE_H_
+
+#include <torch/csrc/lazy/core/hash.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace torch_xla {
+
+// Keeps a per-step breakdown of the host time spent between a tensors sync
+// request and the dispatch of the resulting computation, for the last
+// XLA_STEP_TIMELINE_SIZE syncs (disabled when zero, the default). Unlike the
+// TSL profiler this is cheap enough to be left on in production: a step costs
+// one allocation and a couple of clock reads per stage.
+class StepTimeline {
+ public:
+  enum class Stage {
+    kCollectSyncTensors,
+    kExtractIRAndPrepareXlaData,
+    kRunPostOrder,
+    kLookupCachedCompile,
+    kCompile,
+    kParameterWrapping,
+    kSetTensorData,
+    kTensorCollectionBarrier,
+    // Time the scheduled computation waited for a thread to run on.
+    kQueueWait,
+    kExecute,
+    kGatherTensorsXlaData,
+    kNumStages,
+  };
+
+  static constexpr size_t kNumStages = static_cast<size_t>(Stage::kNumStages);
+
+  struct Record {
+    int64_t id = 0;
+    int64_t start_ns = 0;
+    // Time spent by the calling thread within the sync, stages included.
+    std::atomic<int64_t> host_ns{0};
+    size_t num_tensors = 0;
+    torch::lazy::hash_t graph_hash;
+    bool cache_hit = false;
+    // Written by the execution thread too, hence atomic.
+    std::array<std::atomic<int64_t>, kNumStages> stage_ns{};
+  };
+
+  // Makes a new record the current step of the calling thread for the scope
+  // life time. Nested scopes belong to the outermost step. The record is only
+  // kept if the step ends up syncing some tensors.
+  class ScopedStep {
+   public:
+    ScopedStep();
+    ~ScopedStep();
+
+    ScopedStep(const ScopedStep&) = delete;
+    ScopedStep& operator=(const ScopedStep&) = delete;
+
+   private:
+    std::shared_ptr<Record> record_;
+  };
+
+  // Adds the scope life time to the given stage of `record`, which defaults
+  // to the current step of the calling thread. No-op without a record.
+  class ScopedStage {
+   public:
+    explicit ScopedStage(Stage stage) : ScopedStage(Current(), stage) {}
+    ScopedStage(Record* record, Stage stage);
+    ~ScopedStage();
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+   private:
+    Record* record_;
+    Stage stage_;
+    int64_t start_ns_ = 0;
+  };
+
+  static StepTimeline* Get();
+
+  static const char* StageName(Stage stage);
+
+  // The current step of the calling thread, or nullptr.
+  static Record* Current();
+
+  // Returns the shared owner of the current step, to be captured by the
+  // closures which carry on the step on other threads.
+  static std::shared_ptr<Record> CurrentShared();
+
+  static void AddStageTime(Record* record, Stage stage, int64_t ns);
+
+  bool enabled() const { return capacity_ > 0; }
+
+  std::vector<std::shared_ptr<const Record>> GetRecords() const;
+
+  // Dumps the records, oldest first, as a JSON list with one object per step.
+  std::string ToJson() const;
+
+  void Clear();
+
+ private:
+  explicit StepTimeline(size_t capacity) : capacity_(capacity) {}
+
+  void Add(std::shared_ptr<Record> record);
+
+  const size_t capacity_;
+  std::atomic<int64_t> next_id_{0};
+  mutable std::mutex lock_;
+  std::deque<std::shared_ptr<const Record>> records_;
+};
+
+}  // namespace torch_xla
+
+#endif  // XLA_TORCH_XLA_CSRC_STEP_TIMELINE_H_
@@ -21,6 +21,7 @@
 
 #include "torch_xla/csrc/aten_xla_bridge.h"
 #include "torch_xla/csrc/debug_util.h"
+#include "torch_xla/csrc/device_data_cache.h"
 #include "torch_xla/csrc/dtype.h"
 #include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/layout_manager.h"
@@ -40,6 +41,7 @@
 #include "torch_xla/csrc/runtime/pjrt_computation_client.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/xla_util.h"
+#include "torch_xla/csrc/size_guard_speculation.h"
 #include "torch_xla/csrc/tensor_util.h"
 #include "torch_xla/csrc/torch_util.h"
 #include "torch_xla/csrc/xla_graph_executor.h"
@@ -56,6 +58,80 @@ bool CanApplySharding(const XLATensor::ShardingSpecPtr sharding) {
          sharding->sharding.type() == xla::OpSharding::REPLICATED ||
          sharding->sharding.type() == xla::OpSharding::UNKNOWN;
 }
+
+// The XLA tensors created from host tensors by the calling thread, whose data
+// are uploaded in a single batch on the first use of any of them, rather than
+// one at a time. Those already uploaded or released are pruned past
+// g_pending_uploads_prune_size.
+thread_local std::vector<std::weak_ptr<XLATensor::Data>> g_pending_uploads;
+thread_local size_t g_pending_uploads_prune_size = 1024;
+
+bool BatchTensorUploads() {
+  static const bool batch_uploads =
+      runtime::sys_util::GetEnvBool("XLA_BATCH_TENSOR_UPLOADS", true);
+  return batch_uploads;
+}
+
+bool IsPendingUpload(const XLATensor::Data& data) {
+  return data.handle == nullptr && !data.ir_value && data.view == nullptr &&
+         data.tensor_data;
+}
+
+void AddPendingUpload(const std::shared_ptr<XLATensor::Data>& data) {
+  if (g_pending_uploads.size() >= g_pending_uploads_prune_size) {
+    g_pending_uploads.erase(
+        std::remove_if(g_pending_uploads.begin(), g_pending_uploads.end(),
+                       [](const std::weak_ptr<XLATensor::Data>& pending) {
+                         std::shared_ptr<XLATensor::Data> data = pending.lock();
+                         return data == nullptr || !IsPendingUpload(*data);
+                       }),
+        g_pending_uploads.end());
+    g_pending_uploads_prune_size =
+        std::max<size_t>(1024, 2 * g_pending_uploads.size());
+  }
+  g_pending_uploads.push_back(data);
+}
+
+// Uploads the data of the pending tensors with a single CreateTensorsData(),
+// which transfers them in parallel.
+void UploadPendingTensorsData() {
+  if (g_pending_uploads.empty()) {
+    return;
+  }
+  std::vector<std::shared_ptr<XLATensor::Data>> pending;
+  std::vector<at::Tensor> tensors;
+  std::vector<XLATensor::ShardingSpecPtr> shardings;
+  std::vector<std::string> devices;
+  for (const std::weak_ptr<XLATensor::Data>& weak_data : g_pending_uploads) {
+    std::shared_ptr<XLATensor::Data> data = weak_data.lock();
+    if (data != nullptr && IsPendingUpload(*data)) {
+      tensors.push_back(*data->tensor_data);
+      shardings.push_back(data->sharding);
+      devices.push_back(data->device.toString());
+      pending.push_back(std::move(data));
+    }
+  }
+  g_pending_uploads.clear();
+  if (pending.empty()) {
+    return;
+  }
+  TORCH_LAZY_COUNTER("BatchedTensorUploads", 1);
+  TORCH_LAZY_COUNTER("BatchedTensorUploadTensors", pending.size());
+  std::vector<torch::lazy::BackendDataPtr> handles =
+      XLAGraphExecutor::UseAsyncTensorUploads() &&
+              std::all_of(shardings.begin(), shardings.end(),
+                          [](const XLATensor::ShardingSpecPtr& sharding) {
+                            return sharding == nullptr;
+                          })
+          ? XLAGraphExecutor::Get()->CreateTensorsDataAsync(tensors, devices)
+          : CreateTensorsData(tensors, shardings, devices);
+  for (size_t i = 0; i < pending.size(); ++i) {
+    // The host data is released, as GetIrValue() does once uploaded, not to
+    // hold a host copy of all the parameters of a module.
+    pending[i]->handle = std::move(handles[i]);
+    pending[i]->tensor_data = c10::nullopt;
+  }
+}
 }  // namespace
 
 XLATensor::Data::~Data() { XLAGraphExecutor::Get()->UnregisterTensor(this); }
@@ -66,6 +142,13 @@ XLATensorPtr XLATensor::Create(const at::Tensor& tensor,
   XLATensorPtr xtensor =
       c10::make_intrusive<XLATensor>(XLATensor(tensor, device));
   XLAGraphExecutor::Get()->RegisterTensor(xtensor->data());
+  // The scalars and the cached constants or device data are uploaded on their
+  // own paths, see GetIrValueForTensor().
+  if (BatchTensorUploads() && !(tensor.dim() == 0 && tensor.numel() == 1) &&
+      !XLAGraphExecutor::IsCachedConstant(tensor) &&
+      DeviceDataCache::Get() == nullptr) {
+    AddPendingUpload(xtensor->data());
+  }
   return xtensor;
 }
 
@@ -240,7 +323,10 @@ torch::lazy::BackendDataPtr XLATensor::GetXlaData() {
     }
   } else {
     XLA_CHECK(data()->tensor_data);
-    data()->handle = TensorToXlaData(*data()->tensor_data, GetDevice());
+    UploadPendingTensorsData();
+    if (data()->handle == nullptr) {
+      data()->handle = TensorToXlaData(*data()->tensor_data, GetDevice());
+    }
   }
   return data()->handle;
 }
@@ -354,7 +440,7 @@ void XLATensor::SetInPlaceIrValue(torch::lazy::Value ir_value) {
   auto xla_shape = shape();
   if (xla_shape.get().element_type() != GetXlaShape(ir_value).element_type()) {
     ir_value =
-        torch::lazy::MakeNode<Cast>(ir_value, xla_shape.get().element_type());
+        torch_xla::MakeNode<Cast>(ir_value, xla_shape.get().element_type());
   }
   SetIrValue(std::move(ir_value), /*inplace=*/true);
 }
@@ -373,6 +459,10 @@ torch::lazy::Value XLATensor::GetIrValue() const {
     return ir_value;
   }
   torch::lazy::BackendDataPtr handle = CurrentDataHandle();
+  if (handle == nullptr && IsPendingUpload(*data())) {
+    UploadPendingTensorsData();
+    handle = CurrentDataHandle();
+  }
   if (handle != nullptr) {
     // In case of tensor node, we do not clear the XLA data when we set the IR
     // node. This because we want further calls to GetIrValue() to fetch the
@@ -411,11 +501,24 @@ torch::lazy::Value XLATensor::GetIrValueForTensor(
   if (tensor.dim() == 0 && tensor.numel() == 1) {
     at::Scalar value = tensor.item();
     if (torch::lazy::IsSpecialScalar(value)) {
+      TORCH_LAZY_COUNTER("BakedScalar", 1);
       return ScalarOp(std::move(value),
                       MakeXlaPrimitiveType(tensor.scalar_type(), &device));
     }
+    TORCH_LAZY_COUNTER("HoistedScalar", 1);
     data = XLAGraphExecutor::Get()->GetDeviceData(tensor.cpu(), device);
     read_only = true;
+  } else if (XLAGraphExecutor::IsCachedConstant(tensor)) {
+    data = XLAGraphExecutor::Get()->GetConstantData(tensor, device);
+    read_only = true;
+  } else if (DeviceDataCache::Get() != nullptr) {
+    // The data shared with the tensors of the same value keeps the read only
+    // info set by the cache, rather than one for this tensor.
+    return torch_xla::MakeNode<DeviceData>(
+        DeviceDataCache::Get()->GetOrUpload(tensor, device));
+  } else if (XLAGraphExecutor::UseAsyncTensorUploads()) {
+    data = XLAGraphExecutor::Get()->CreateTensorsDataAsync(
+        {tensor}, {device.toString()})[0];
   } else {
     TORCH_LAZY_TIMED("IrValueTensorToXlaData");
     data = TensorToXlaData(tensor, device);
@@ -521,6 +624,37 @@ at::Tensor XLATensor::ToTensor(bool detached) {
   return tensor;
 }
 
+std::shared_ptr<HostTensorFuture> XLATensor::ToTensorAsync() {
+  c10::optional<at::Tensor> tensor_data = CurrentTensorData();
+  if (tensor_data) {
+    return HostTensorFuture::Ready(torch::lazy::CopyTensor(*tensor_data));
+  }
+  torch::lazy::BackendDataPtr handle = CurrentDataHandle();
+  if (handle == nullptr || data()->view != nullptr) {
+    // The data of the scheduled graph is a placeholder until its execution is
+    // dispatched, which GetXlaData() does not take.
+    std::vector<XLATensorPtr> tensors({c10::make_intrusive<XLATensor>(*this)});
+    XLAGraphExecutor::Get()->SyncTensorsGraph(&tensors, {}, /*wait=*/false,
+                                              /*sync_xla_data=*/false);
+    handle = CurrentDataHandle();
+  }
+  if (handle == nullptr) {
+    // The data of a device data IR value, taken directly.
+    handle = GetXlaData();
+  }
+  auto* data_info =
+      static_cast<torch::lazy::LazyGraphExecutor::DeviceDataInfo*>(
+          handle->info());
+  if (data_info == nullptr || !data_info->read_only) {
+    int64_t tensor_id =
+        data_info != nullptr ? data_info->tensor_id : GetUniqueId();
+    handle->SetInfo(
+        std::make_shared<torch::lazy::LazyGraphExecutor::DeviceDataInfo>(
+            tensor_id, /*read_only=*/true));
+  }
+  return HostTensorFuture::Fetch(std::move(handle), GetDevice(), dtype());
+}
+
 void XLATensor::ShallowCopyTo(XLATensorPtr dest) const {
   dest->SetScalarType(data()->logical_element_type);
   dest->SetIrValue(GetIrValue(), /*inplace=*/false);
@@ -606,7 +740,7 @@ torch::lazy::Value XLATensor::MaybeCastIrValue(
   }
   if (logical_element_type &&
       RequiresRawTypeCasting(*logical_element_type, &device)) {
-    ir_value = torch::lazy::MakeNode<Cast>(ir_value, *logical_element_type);
+    ir_value = torch_xla::MakeNode<Cast>(ir_value, *logical_element_type);
   }
   return ir_value;
 }
@@ -667,7 +801,7 @@ c10::SymNode XLASymNodeImpl::add(const c10::SymNode& other) {
   auto p_other = dynamic_cast<XLASymNodeImpl*>(other.get());
   XLA_CHECK(is_int()) << __FUNCTION__ << " with non-int NYI";
   XLA_CHECK(p_other->is_int()) << __FUNCTION__ << " with non-int NYI";
-  auto n_add = torch::lazy::MakeNode<SizeAdd>(node(), p_other->node());
+  auto n_add = torch_xla::MakeNode<SizeAdd>(node(), p_other->node());
   return c10::make_intrusive<XLASymNodeImpl>(n_add, PyType::INT);
 }
 
@@ -679,7 +813,7 @@ c10::SymNode XLASymNodeImpl::sub(const c10::SymNode& other) {
   XLA_CHECK(is_int()) << __FUNCTION__ << " with non-int NYI";
   XLA_CHECK(p_other->is_int()) << __FUNCTION__ << " with non-int NYI";
   torch::lazy::NodePtr n_sub =
-      torch::lazy::MakeNode<SizeSub>(node(), p_other->node());
+      torch_xla::MakeNode<SizeSub>(node(), p_other->node());
   return c10::make_intrusive<XLASymNodeImpl>(n_sub, PyType::INT);
 }
 
@@ -688,7 +822,7 @@ c10::SymNode XLASymNodeImpl::mul(const c10::SymNode& other) {
   XLA_CHECK(is_int()) << __FUNCTION__ << " with non-int NYI";
   XLA_CHECK(p_other->is_int()) << __FUNCTION__ << " with non-int NYI";
   auto n_mul =
-      torch::lazy::MakeNode<torch_xla::SizeMul>(node(), p_other->node());
+      torch_xla::MakeNode<torch_xla::SizeMul>(node(), p_other->node());
   return c10::make_intrusive<XLASymNodeImpl>(n_mul, PyType::INT);
 }
 
@@ -706,7 +840,7 @@ c10::SymNode XLASymNodeImpl::floordiv(const c10::SymNode& other) {
   auto p_other = dynamic_cast<XLASymNodeImpl*>(other.get());
   XLA_CHECK(is_int()) << __FUNCTION__ << " with non-int NYI";
   XLA_CHECK(p_other->is_int()) << __FUNCTION__ << " with non-int NYI";
-  auto n_div = torch::lazy::MakeNode<SizeDiv>(node(), p_other->node());
+  auto n_div = torch_xla::MakeNode<SizeDiv>(node(), p_other->node());
   return c10::make_intrusive<XLASymNodeImpl>(n_div, PyType::INT);
 }
 
@@ -717,7 +851,7 @@ c10::SymNode XLASymNodeImpl::mod(const c10::SymNode& other) {
   XLA_CHECK(is_int()) << __FUNCTION__ << " with non-int NYI";
   XLA_CHECK(p_other->is_int()) << __FUNCTION__ << " with non-int NYI";
   torch::lazy::NodePtr n_mod =
-      torch::lazy::MakeNode<SizeMod>(node(), p_other->node());
+      torch_xla::MakeNode<SizeMod>(node(), p_other->node());
   return c10::make_intrusive<XLASymNodeImpl>(n_mod, PyType::INT);
 }
 
@@ -725,7 +859,7 @@ c10::SymNode XLASymNodeImpl::eq(const c10::SymNode& other) {
   auto p_other = dynamic_cast<XLASymNodeImpl*>(other.get());
   XLA_CHECK(is_int()) << __FUNCTION__ << " with non-int NYI";
   XLA_CHECK(p_other->is_int()) << __FUNCTION__ << " with non-int NYI";
-  auto n_eq = torch::lazy::MakeNode<SizeEq>(node(), p_other->node());
+  auto n_eq = torch_xla::MakeNode<SizeEq>(node(), p_other->node());
   return c10::make_intrusive<XLASymNodeImpl>(n_eq, PyType::BOOL);
 }
 
@@ -734,7 +868,7 @@ c10::SymNode XLASymNodeImpl::ne(const c10::SymNode& other) {
   auto p_other = dynamic_cast<XLASymNodeImpl*>(other.get());
   XLA_CHECK(is_int()) << __FUNCTION__ << " with non-int NYI";
   XLA_CHECK(p_other->is_int()) << __FUNCTION__ << " with non-int NYI";
-  auto n_ne = torch::lazy::MakeNode<SizeNe>(node(), p_other->node());
+  auto n_ne = torch_xla::MakeNode<SizeNe>(node(), p_other->node());
   return c10::make_intrusive<XLASymNodeImpl>(n_ne, PyType::BOOL);
 }
 
@@ -743,7 +877,7 @@ c10::SymNode XLASymNodeImpl::gt(const c10::SymNode& other) {
   auto p_other = dynamic_cast<XLASymNodeImpl*>(other.get());
   XLA_CHECK(is_int()) << __FUNCTION__ << " with non-int NYI";
   XLA_CHECK(p_other->is_int()) << __FUNCTION__ << " with non-int NYI";
-  auto n_gt = torch::lazy::MakeNode<SizeGt>(node(), p_other->node());
+  auto n_gt = torch_xla::MakeNode<SizeGt>(node(), p_other->node());
   return c10::make_intrusive<XLASymNodeImpl>(n_gt, PyType::BOOL);
 }
 
@@ -752,7 +886,7 @@ c10::SymNode XLASymNodeImpl::lt(const c10::SymNode& other) {
   auto p_other = dynamic_cast<XLASymNodeImpl*>(other.get());
   XLA_CHECK(is_int()) << __FUNCTION__ << " with non-int NYI";
   XLA_CHECK(p_other->is_int()) << __FUNCTION__ << " with non-int NYI";
-  auto n_lt = torch::lazy::MakeNode<SizeLt>(node(), p_other->node());
+  auto n_lt = torch_xla::MakeNode<SizeLt>(node(), p_other->node());
   return c10::make_intrusive<XLASymNodeImpl>(n_lt, PyType::BOOL);
 }
 
@@ -766,7 +900,7 @@ c10::SymNode XLASymNodeImpl::ge(const c10::SymNode& other) {
   auto p_other = dynamic_cast<XLASymNodeImpl*>(other.get());
   XLA_CHECK(is_int()) << __FUNCTION__ << " with non-int NYI";
   XLA_CHECK(p_other->is_int()) << __FUNCTION__ << " with non-int NYI";
-  auto n_ge = torch::lazy::MakeNode<SizeGe>(node(), p_other->node());
+  auto n_ge = torch_xla::MakeNode<SizeGe>(node(), p_other->node());
   return c10::make_intrusive<XLASymNodeImpl>(n_ge, PyType::BOOL);
 }
 
@@ -800,20 +934,20 @@ c10::SymNode XLASymNodeImpl::sym_max(const c10::SymNode& other) {
 c10::SymNode XLASymNodeImpl::sym_or(const c10::SymNode& other) {
   auto a =
       guard_bool(__FILE__, __LINE__) || other->guard_bool(__FILE__, __LINE__);
-  auto cnst = torch::lazy::MakeNode<SizeConstant>(a);
+  auto cnst = torch_xla::MakeNode<SizeConstant>(a);
   return c10::make_intrusive<XLASymNodeImpl>(cnst, PyType::BOOL);
 }
 
 c10::SymNode XLASymNodeImpl::sym_and(const c10::SymNode& other) {
   auto a =
       guard_bool(__FILE__, __LINE__) && other->guard_bool(__FILE__, __LINE__);
-  auto cnst = torch::lazy::MakeNode<SizeConstant>(a);
+  auto cnst = torch_xla::MakeNode<SizeConstant>(a);
   return c10::make_intrusive<XLASymNodeImpl>(cnst, PyType::BOOL);
 }
 
 c10::SymNode XLASymNodeImpl::sym_not() {
   auto a = !guard_bool(__FILE__, __LINE__);
-  auto cnst = torch::lazy::MakeNode<SizeConstant>(a);
+  auto cnst = torch_xla::MakeNode<SizeConstant>(a);
   return c10::make_intrusive<XLASymNodeImpl>(cnst, PyType::BOOL);
 }
 
@@ -849,7 +983,7 @@ c10::SymNode XLASymNodeImpl::is_channels_last_strides_3d(
 // them to error only if poked.
 c10::SymNode XLASymNodeImpl::is_non_overlapping_and_dense(
     at::ArrayRef<c10::SymNode> sizes, at::ArrayRef<c10::SymNode> strides) {
-  auto error_node = torch::lazy::MakeNode<SizeError>();
+  auto error_node = torch_xla::MakeNode<SizeError>();
   return c10::make_intrusive<XLASymNodeImpl>(error_node, PyType::BOOL);
 }
 
@@ -864,7 +998,7 @@ c10::SymNode XLASymNodeImpl::sym_float() {
 }
 
 c10::SymNode XLASymNodeImpl::wrap_int(int64_t num) {
-  auto cnst = torch::lazy::MakeNode<SizeConstant>(num);
+  auto cnst = torch_xla::MakeNode<SizeConstant>(num);
   return c10::make_intrusive<XLASymNodeImpl>(cnst, PyType::INT);
 }
 
@@ -874,13 +1008,12 @@ c10::SymNode XLASymNodeImpl::wrap_float(double num) {
 }
 
 c10::SymNode XLASymNodeImpl::wrap_bool(bool num) {
-  auto cnst = torch::lazy::MakeNode<SizeConstant>(num);
+  auto cnst = torch_xla::MakeNode<SizeConstant>(num);
   return c10::make_intrusive<XLASymNodeImpl>(cnst, PyType::BOOL);
 }
 
 int64_t XLASymNodeImpl::guard_int(const char* file, int64_t line) {
-  XLA_CHECK(false) << "XLASymNodeImpl::" << __FUNCTION__
-                   << " has not been implemented.";
+  return SizeGuardSpeculation::Get()->Guard(node(), file, line);
 }
 
 double XLASymNodeImpl::guard_float(const char* file, int64_t line) {
@@ -889,8 +1022,7 @@ double XLASymNodeImpl::guard_float(const char* file, int64_t line) {
 }
 
 bool XLASymNodeImpl::guard_bool(const char* file, int64_t line) {
-  // TODO: Take advantages of file and line.
-  return bool_();
+  return SizeGuardSpeculation::Get()->Guard(node(), file, line) != 0;
 }
 
 int64_t XLASymNodeImpl::int_() {
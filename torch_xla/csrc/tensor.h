@@ -9,6 +9,7 @@
 #include <memory>
 #include <string>
 
+#include "torch_xla/csrc/host_tensor_future.h"
 #include "torch_xla/csrc/runtime/util.h"
 #include "torch_xla/csrc/view.h"
 
@@ -147,6 +148,9 @@ class XLATensor : public torch::lazy::LazyTensor {
     // op funtionalize pass to point to the input.
     int64_t alias_id{0};
     bool is_cloned = false;
+    // With XLA_SYNC_ROOTS_ONLY, step syncs only materialize the live tensors
+    // marked as roots, when there are some.
+    bool is_step_root = false;
   };
 
   static XLATensorPtr Create(const at::Tensor& tensor,
@@ -184,6 +188,12 @@ class XLATensor : public torch::lazy::LazyTensor {
   // Override to use XLAGraphExecutor.
   at::Tensor ToTensor(bool detached) final;
 
+  // Schedules the pending graph of the tensor, if any, without waiting for it
+  // and fetches its value to the host in the background. The device data
+  // fetched is not donated to the later graphs, which could otherwise reuse
+  // its buffer before it is read.
+  std::shared_ptr<HostTensorFuture> ToTensorAsync();
+
   // We don't use the upsteram ShallowCopyTo because of logical_element_type.
   void ShallowCopyTo(XLATensorPtr dest) const;
 
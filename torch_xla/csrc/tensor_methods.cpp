@@ -4,15 +4,19 @@
 #include <ATen/core/Reduction.h>
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/lazy/core/helpers.h>
+#include <torch/csrc/lazy/core/metrics.h>
 #include <torch/csrc/lazy/core/util.h>
 
 #include <algorithm>
 #include <functional>
+#include <optional>
 
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "torch_xla/csrc/LazyIr.h"
 #include "torch_xla/csrc/aten_xla_bridge.h"
+#include "torch_xla/csrc/custom_kernel_registry.h"
 #include "torch_xla/csrc/data_ops.h"
 #include "torch_xla/csrc/dtype.h"
 #include "torch_xla/csrc/helpers.h"
@@ -25,14 +29,18 @@
 #include "torch_xla/csrc/ops/all_to_all.h"
 #include "torch_xla/csrc/ops/amp_foreach_non_finite_check_and_unscale.h"
 #include "torch_xla/csrc/ops/amp_update_scale.h"
+#include "torch_xla/csrc/ops/approx_topk.h"
 #include "torch_xla/csrc/ops/arithmetic_ir_ops.h"
 #include "torch_xla/csrc/ops/as_strided.h"
+#include "torch_xla/csrc/ops/async_collective.h"
 #include "torch_xla/csrc/ops/avg_pool_nd.h"
 #include "torch_xla/csrc/ops/avg_pool_nd_backward.h"
+#include "torch_xla/csrc/ops/batched_nms.h"
 #include "torch_xla/csrc/ops/bernoulli.h"
 #include "torch_xla/csrc/ops/cast.h"
 #include "torch_xla/csrc/ops/cat.h"
 #include "torch_xla/csrc/ops/cdist.h"
+#include "torch_xla/csrc/ops/chunked_cross_entropy.h"
 #include "torch_xla/csrc/ops/collective_permute.h"
 #include "torch_xla/csrc/ops/constant.h"
 #include "torch_xla/csrc/ops/constant_pad_nd.h"
@@ -46,6 +54,7 @@
 #include "torch_xla/csrc/ops/device_data.h"
 #include "torch_xla/csrc/ops/diagonal.h"
 #include "torch_xla/csrc/ops/discrete_uniform.h"
+#include "torch_xla/csrc/ops/dropout_add_layer_norm.h"
 #include "torch_xla/csrc/ops/dynamic_expand.h"
 #include "torch_xla/csrc/ops/dynamic_view.h"
 #include "torch_xla/csrc/ops/einsum.h"
@@ -54,29 +63,39 @@
 #include "torch_xla/csrc/ops/expand.h"
 #include "torch_xla/csrc/ops/expand_symint.h"
 #include "torch_xla/csrc/ops/exponential.h"
+#include "torch_xla/csrc/ops/flash_attention.h"
 #include "torch_xla/csrc/ops/flip.h"
 #include "torch_xla/csrc/ops/gather.h"
 #include "torch_xla/csrc/ops/generic.h"
+#include "torch_xla/csrc/ops/foreach_adam_optimizer_step.h"
+#include "torch_xla/csrc/ops/foreach_grad_norm.h"
+#include "torch_xla/csrc/ops/foreach_sgd_optimizer_step.h"
+#include "torch_xla/csrc/ops/fp8_scaled_mm.h"
 #include "torch_xla/csrc/ops/generic_slice.h"
 #include "torch_xla/csrc/ops/get_dimensions_size.h"
 #include "torch_xla/csrc/ops/gpu_custom_call.h"
+#include "torch_xla/csrc/ops/grouped_matmul.h"
 #include "torch_xla/csrc/ops/hardtanh_backward.h"
 #include "torch_xla/csrc/ops/index_ops.h"
 #include "torch_xla/csrc/ops/index_select.h"
 #include "torch_xla/csrc/ops/infer_output_shape.h"
 #include "torch_xla/csrc/ops/kth_value.h"
+#include "torch_xla/csrc/ops/kv_cache_update.h"
 #include "torch_xla/csrc/ops/linear_interpolation.h"
 #include "torch_xla/csrc/ops/linspace.h"
 #include "torch_xla/csrc/ops/log_softmax.h"
 #include "torch_xla/csrc/ops/logsumexp.h"
 #include "torch_xla/csrc/ops/mark_tensor.h"
+#include "torch_xla/csrc/ops/masked_scaled_softmax.h"
 #include "torch_xla/csrc/ops/masked_scatter.h"
 #include "torch_xla/csrc/ops/masked_select.h"
+#include "torch_xla/csrc/ops/masked_select_static.h"
 #include "torch_xla/csrc/ops/max_in_dim.h"
 #include "torch_xla/csrc/ops/max_pool_nd.h"
 #include "torch_xla/csrc/ops/max_pool_nd_backward.h"
 #include "torch_xla/csrc/ops/max_unpool_nd.h"
 #include "torch_xla/csrc/ops/mean.h"
+#include "torch_xla/csrc/ops/metric_accumulate.h"
 #include "torch_xla/csrc/ops/min_in_dim.h"
 #include "torch_xla/csrc/ops/mse_loss.h"
 #include "torch_xla/csrc/ops/mse_loss_backward.h"
@@ -90,6 +109,7 @@
 #include "torch_xla/csrc/ops/nll_loss_backward.h"
 #include "torch_xla/csrc/ops/nms.h"
 #include "torch_xla/csrc/ops/nonzero.h"
+#include "torch_xla/csrc/ops/nonzero_static.h"
 #include "torch_xla/csrc/ops/normal.h"
 #include "torch_xla/csrc/ops/not_supported.h"
 #include "torch_xla/csrc/ops/ops.h"
@@ -99,6 +119,7 @@
 #include "torch_xla/csrc/ops/put.h"
 #include "torch_xla/csrc/ops/qr.h"
 #include "torch_xla/csrc/ops/quant_tensor.h"
+#include "torch_xla/csrc/ops/quantized_matmul.h"
 #include "torch_xla/csrc/ops/randperm.h"
 #include "torch_xla/csrc/ops/recv.h"
 #include "torch_xla/csrc/ops/reduce_scatter.h"
@@ -107,6 +128,7 @@
 #include "torch_xla/csrc/ops/replication_pad.h"
 #include "torch_xla/csrc/ops/replication_pad_backward.h"
 #include "torch_xla/csrc/ops/resize.h"
+#include "torch_xla/csrc/ops/ring_attention.h"
 #include "torch_xla/csrc/ops/roll.h"
 #include "torch_xla/csrc/ops/rrelu_with_noise.h"
 #include "torch_xla/csrc/ops/rrelu_with_noise_backward.h"
@@ -114,10 +136,14 @@
 #include "torch_xla/csrc/ops/scatter.h"
 #include "torch_xla/csrc/ops/scatter_add.h"
 #include "torch_xla/csrc/ops/scatter_reduce.h"
+#include "torch_xla/csrc/ops/sample_tokens.h"
 #include "torch_xla/csrc/ops/select.h"
 #include "torch_xla/csrc/ops/send.h"
 #include "torch_xla/csrc/ops/sgd_optimizer_step.h"
+#include "torch_xla/csrc/ops/sharded_embedding_bag.h"
 #include "torch_xla/csrc/ops/softmax.h"
+#include "torch_xla/csrc/ops/sparse_adam_optimizer_step.h"
+#include "torch_xla/csrc/ops/sparse_sgd_optimizer_step.h"
 #include "torch_xla/csrc/ops/split.h"
 #include "torch_xla/csrc/ops/squeeze.h"
 #include "torch_xla/csrc/ops/stack.h"
@@ -140,6 +166,7 @@
 #include "torch_xla/csrc/ops/var.h"
 #include "torch_xla/csrc/ops/var_mean.h"
 #include "torch_xla/csrc/ops/view.h"
+#include "torch_xla/csrc/ops/while_loop.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/metrics.h"
@@ -167,7 +194,7 @@ torch::lazy::Value MaybeExpand(const torch::lazy::Value& input,
   if (GetXlaShape(input).dimensions() == target_shape.dimensions()) {
     return input;
   }
-  return torch::lazy::MakeNode<Expand>(
+  return torch_xla::MakeNode<Expand>(
       input, torch::lazy::ToVector<int64_t>(target_shape.dimensions()));
 }
 
@@ -286,7 +313,7 @@ torch::lazy::Value GetFloatingIrValue(const XLATensorPtr& input,
   xla::PrimitiveType input_type = GetXlaShape(input_value).element_type();
   if (xla::primitive_util::IsIntegralType(input_type) ||
       input_type == xla::PRED) {
-    input_value = torch::lazy::MakeNode<Cast>(input_value, float_type);
+    input_value = torch_xla::MakeNode<Cast>(input_value, float_type);
   }
   return input_value;
 }
@@ -294,7 +321,7 @@ torch::lazy::Value GetFloatingIrValue(const XLATensorPtr& input,
 torch::lazy::Value GetBooleanIrValue(torch::lazy::Value input_value) {
   if (GetXlaShape(input_value).element_type() != xla::PrimitiveType::PRED) {
     input_value =
-        torch::lazy::MakeNode<Cast>(input_value, xla::PrimitiveType::PRED);
+        torch_xla::MakeNode<Cast>(input_value, xla::PrimitiveType::PRED);
   }
   return input_value;
 }
@@ -340,6 +367,90 @@ XLATensorPtr DispatchComparisonOp(c10::Symbol kind, const XLATensorPtr& input,
   return XLATensor::Create(node, input->GetDevice(), at::ScalarType::Bool);
 }
 
+std::vector<torch::lazy::Value> GetIrValues(
+    const std::vector<XLATensorPtr>& tensors) {
+  std::vector<torch::lazy::Value> values;
+  values.reserve(tensors.size());
+  for (const XLATensorPtr& tensor : tensors) {
+    values.push_back(tensor->GetIrValue());
+  }
+  return values;
+}
+
+void SetInPlaceIrValues(std::vector<XLATensorPtr>& tensors,
+                        const torch::lazy::NodePtr& node, size_t offset) {
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    tensors[i]->SetInPlaceIrValue(torch::lazy::Value(node, offset + i));
+  }
+}
+
+// Returns the operands of the concatenation `input` along `dim` which cover
+// exactly its [start, end) range, so that the slices and splits of a cat use
+// its inputs rather than materializing its buffer. The value is an operand, or
+// the concatenation of a few of them. Returns nullopt if `input` is not such a
+// concatenation, or if the range does not fall on the operand boundaries.
+std::optional<torch::lazy::Value> SliceOfCat(const XLATensorPtr& input,
+                                             int64_t dim, int64_t start,
+                                             int64_t end) {
+  torch::lazy::Value ir_value = input->CurrentIrValue();
+  if (!ir_value || start >= end) {
+    return std::nullopt;
+  }
+  const Cat* cat = torch::lazy::NodeCast<Cat>(
+      ir_value.node.get(), torch::lazy::OpKind(at::aten::cat));
+  if (cat == nullptr || cat->dim() != dim) {
+    return std::nullopt;
+  }
+  std::vector<torch::lazy::Value> operands;
+  int64_t offset = 0;
+  for (size_t i = 0; i < cat->operands().size() && offset < end; ++i) {
+    int64_t size = GetXlaShape(cat->operand(i)).dimensions(dim);
+    if (offset >= start) {
+      operands.push_back(cat->operand_value(i));
+    } else if (offset + size > start) {
+      return std::nullopt;
+    }
+    offset += size;
+  }
+  if (offset != end || operands.empty()) {
+    return std::nullopt;
+  }
+  if (operands.size() == cat->operands().size()) {
+    return ir_value;
+  }
+  TORCH_LAZY_COUNTER("CatSlicesElided", 1);
+  if (operands.size() == 1 && GetXlaShape(operands.front()).element_type() ==
+                                  GetXlaShape(ir_value).element_type()) {
+    return operands.front();
+  }
+  return torch_xla::MakeNode<Cat>(operands, dim, cat->dtype());
+}
+
+// Returns the operand of the stack `input` along `dim` at `index`, or nullopt.
+std::optional<torch::lazy::Value> SelectOfStack(const XLATensorPtr& input,
+                                                int64_t dim, int64_t index) {
+  torch::lazy::Value ir_value = input->CurrentIrValue();
+  if (!ir_value) {
+    return std::nullopt;
+  }
+  const Stack* stack = torch::lazy::NodeCast<Stack>(
+      ir_value.node.get(), torch::lazy::OpKind(at::aten::stack));
+  if (stack == nullptr || stack->dim() != dim) {
+    return std::nullopt;
+  }
+  TORCH_LAZY_COUNTER("CatSlicesElided", 1);
+  return stack->operand_value(index);
+}
+
+void CheckForeachParams(const std::vector<XLATensorPtr>& params) {
+  XLA_CHECK(!params.empty());
+  for (const XLATensorPtr& param : params) {
+    XLA_CHECK_EQ(param->shape().get().element_type(),
+                 params.front()->shape().get().element_type())
+        << "The params of a foreach optimizer step must have the same type";
+  }
+}
+
 }  // namespace
 
 //////////////////////////////////////////////////////////////////////////////
@@ -349,7 +460,7 @@ XLATensorPtr all_reduce(const XLATensorPtr& input, AllReduceType reduce_type,
                         double scale, std::vector<std::vector<int64_t>> groups,
                         bool pin_layout) {
   std::vector<torch::lazy::Value> input_values({input->GetIrValue()});
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<AllReduce>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AllReduce>(
       reduce_type, input_values, GetAllReduceToken(input->GetDevice()), scale,
       std::move(groups), pin_layout);
   SetAllReduceToken(input->GetDevice(),
@@ -365,7 +476,7 @@ void all_reduce(const std::vector<XLATensorPtr>& inputs,
   for (auto& input : inputs) {
     input_values.push_back(input->GetIrValue());
   }
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<AllReduce>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AllReduce>(
       reduce_type, input_values, GetAllReduceToken(inputs.front()->GetDevice()),
       scale, std::move(groups), pin_layout);
   for (size_t i = 0; i < inputs.size(); ++i) {
@@ -380,7 +491,7 @@ std::pair<XLATensorPtr, torch::lazy::Value> reduce_scatter(
     AllReduceType reduce_type, double scale, int64_t scatter_dim,
     int64_t shard_count, std::vector<std::vector<int64_t>> groups,
     bool pin_layout) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<ReduceScatter>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ReduceScatter>(
       reduce_type, input->GetIrValue(), token, scale, scatter_dim, shard_count,
       std::move(groups), pin_layout);
   return {input->CreateFrom(torch::lazy::Value(node, 0)),
@@ -394,7 +505,7 @@ torch::lazy::Value reduce_scatter_out(XLATensorPtr& output,
                                       int64_t scatter_dim, int64_t shard_count,
                                       std::vector<std::vector<int64_t>> groups,
                                       bool pin_layout) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<ReduceScatter>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ReduceScatter>(
       reduce_type, input->GetIrValue(), token, scale, scatter_dim, shard_count,
       std::move(groups), pin_layout);
   output->SetIrValue(torch::lazy::Value(node, 0));
@@ -413,7 +524,7 @@ reduce_scatter_coalesced(const std::vector<XLATensorPtr>& inputs,
   for (auto& input : inputs) {
     input_values.push_back(input->GetIrValue());
   }
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<ReduceScatterCoalesced>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ReduceScatterCoalesced>(
       reduce_type, input_values, token, scale, scatter_dim, shard_count,
       std::move(groups), pin_layout);
   std::vector<XLATensorPtr> result;
@@ -434,7 +545,7 @@ torch::lazy::Value reduce_scatter_coalesced_out(
   for (auto& input : inputs) {
     input_values.push_back(input->GetIrValue());
   }
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<ReduceScatterCoalesced>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ReduceScatterCoalesced>(
       reduce_type, input_values, token, scale, scatter_dim, shard_count,
       std::move(groups), pin_layout);
   for (size_t i = 0; i < inputs.size(); ++i) {
@@ -447,18 +558,37 @@ std::pair<XLATensorPtr, torch::lazy::Value> all_to_all(
     const XLATensorPtr& input, const torch::lazy::Value& token,
     int64_t split_dimension, int64_t concat_dimension, int64_t split_count,
     std::vector<std::vector<int64_t>> groups, bool pin_layout) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<AllToAll>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AllToAll>(
       input->GetIrValue(), token, split_dimension, concat_dimension,
       split_count, std::move(groups), pin_layout);
   return {input->CreateFrom(torch::lazy::Value(node, 0)),
           torch::lazy::Value(node, 1)};
 }
 
+std::pair<std::vector<XLATensorPtr>, torch::lazy::Value> all_to_all_coalesced(
+    const std::vector<XLATensorPtr>& inputs, const torch::lazy::Value& token,
+    int64_t split_dimension, int64_t concat_dimension, int64_t split_count,
+    std::vector<std::vector<int64_t>> groups, bool pin_layout) {
+  std::vector<torch::lazy::Value> input_values;
+  input_values.reserve(inputs.size());
+  for (auto& input : inputs) {
+    input_values.push_back(input->GetIrValue());
+  }
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AllToAllCoalesced>(
+      input_values, token, split_dimension, concat_dimension, split_count,
+      std::move(groups), pin_layout);
+  std::vector<XLATensorPtr> result;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    result.emplace_back(inputs[i]->CreateFrom(torch::lazy::Value(node, i)));
+  }
+  return {result, torch::lazy::Value(node, inputs.size())};
+}
+
 XLATensorPtr all_gather(const XLATensorPtr& input, int64_t dim,
                         int64_t shard_count,
                         std::vector<std::vector<int64_t>> groups,
                         bool pin_layout) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<AllGather>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AllGather>(
       input->GetIrValue(), GetAllReduceToken(input->GetDevice()), dim,
       shard_count, std::move(groups), pin_layout);
   SetAllReduceToken(input->GetDevice(),
@@ -472,7 +602,7 @@ torch::lazy::Value all_gather_out(XLATensorPtr& output,
                                   int64_t shard_count,
                                   std::vector<std::vector<int64_t>> groups,
                                   bool pin_layout) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<AllGather>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AllGather>(
       input->GetIrValue(), token, dim, shard_count, std::move(groups),
       pin_layout);
   output->SetIrValue(torch::lazy::Value(node, 0));
@@ -488,7 +618,7 @@ std::pair<std::vector<XLATensorPtr>, torch::lazy::Value> all_gather_coalesced(
   for (auto& input : inputs) {
     input_values.push_back(input->GetIrValue());
   }
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<AllGatherCoalesced>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AllGatherCoalesced>(
       input_values, token, dim, shard_count, std::move(groups), pin_layout);
   std::vector<XLATensorPtr> result;
   for (size_t i = 0; i < inputs.size(); ++i) {
@@ -506,7 +636,7 @@ torch::lazy::Value all_gather_coalesced_out(
   for (auto& input : inputs) {
     input_values.push_back(input->GetIrValue());
   }
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<AllGatherCoalesced>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AllGatherCoalesced>(
       input_values, token, dim, shard_count, std::move(groups), pin_layout);
   for (size_t i = 0; i < inputs.size(); ++i) {
     outputs[i]->SetIrValue(torch::lazy::Value(node, i));
@@ -514,15 +644,352 @@ torch::lazy::Value all_gather_coalesced_out(
   return torch::lazy::Value(node, inputs.size());
 }
 
+torch::lazy::Value all_gather_start(const XLATensorPtr& input,
+                                    const torch::lazy::Value& token,
+                                    int64_t dim, int64_t shard_count,
+                                    std::vector<std::vector<int64_t>> groups,
+                                    bool pin_layout) {
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AllGatherStart>(
+      input->GetIrValue(), token, dim, shard_count, std::move(groups),
+      pin_layout);
+  return torch::lazy::Value(node, 0);
+}
+
+torch::lazy::Value all_reduce_start(const XLATensorPtr& input,
+                                    const torch::lazy::Value& token,
+                                    AllReduceType reduce_type,
+                                    std::vector<std::vector<int64_t>> groups,
+                                    bool pin_layout) {
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AllReduceStart>(
+      reduce_type, input->GetIrValue(), token, std::move(groups), pin_layout);
+  return torch::lazy::Value(node, 0);
+}
+
+std::pair<XLATensorPtr, torch::lazy::Value> async_collective_done(
+    const XLATensorPtr& input, const torch::lazy::Value& start,
+    const torch::lazy::Value& token) {
+  torch::lazy::NodePtr node =
+      torch_xla::MakeNode<AsyncCollectiveDone>(start, token);
+  return {input->CreateFrom(torch::lazy::Value(node, 0)),
+          torch::lazy::Value(node, 1)};
+}
+
 std::pair<XLATensorPtr, torch::lazy::Value> collective_permute(
     const XLATensorPtr& input, const torch::lazy::Value& token,
     std::vector<std::pair<int64_t, int64_t>> source_target_pairs) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<CollectivePermute>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<CollectivePermute>(
       input->GetIrValue(), token, std::move(source_target_pairs));
   return {input->CreateFrom(torch::lazy::Value(node, 0)),
           torch::lazy::Value(node, 1)};
 }
 
+std::pair<std::vector<XLATensorPtr>, torch::lazy::Value>
+collective_permute_coalesced(
+    const std::vector<XLATensorPtr>& inputs, const torch::lazy::Value& token,
+    std::vector<std::pair<int64_t, int64_t>> source_target_pairs) {
+  std::vector<torch::lazy::Value> input_values;
+  input_values.reserve(inputs.size());
+  for (auto& input : inputs) {
+    input_values.push_back(input->GetIrValue());
+  }
+  torch::lazy::NodePtr node = torch_xla::MakeNode<CollectivePermuteCoalesced>(
+      input_values, token, std::move(source_target_pairs));
+  std::vector<XLATensorPtr> result;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    result.emplace_back(inputs[i]->CreateFrom(torch::lazy::Value(node, i)));
+  }
+  return {result, torch::lazy::Value(node, inputs.size())};
+}
+
+std::tuple<XLATensorPtr, XLATensorPtr, torch::lazy::Value> ring_attention(
+    const XLATensorPtr& query, const XLATensorPtr& key,
+    const XLATensorPtr& value, const torch::lazy::Value& token, double scale,
+    bool causal, std::vector<std::vector<int64_t>> groups) {
+  torch::lazy::NodePtr node = torch_xla::MakeNode<RingAttention>(
+      query->GetIrValue(), key->GetIrValue(), value->GetIrValue(), token,
+      scale, causal, std::move(groups));
+  return std::make_tuple(
+      query->CreateFrom(torch::lazy::Value(node, 0)),
+      query->CreateFrom(torch::lazy::Value(node, 1), at::ScalarType::Float),
+      torch::lazy::Value(node, 2));
+}
+
+std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr, torch::lazy::Value>
+ring_attention_backward(const XLATensorPtr& query, const XLATensorPtr& key,
+                        const XLATensorPtr& value, const XLATensorPtr& output,
+                        const XLATensorPtr& logsumexp,
+                        const XLATensorPtr& grad_output,
+                        const torch::lazy::Value& token, double scale,
+                        bool causal, std::vector<std::vector<int64_t>> groups) {
+  torch::lazy::NodePtr node = torch_xla::MakeNode<RingAttentionBackward>(
+      query->GetIrValue(), key->GetIrValue(), value->GetIrValue(),
+      output->GetIrValue(), logsumexp->GetIrValue(), grad_output->GetIrValue(),
+      token, scale, causal, std::move(groups));
+  return std::make_tuple(query->CreateFrom(torch::lazy::Value(node, 0)),
+                         key->CreateFrom(torch::lazy::Value(node, 1)),
+                         value->CreateFrom(torch::lazy::Value(node, 2)),
+                         torch::lazy::Value(node, 3));
+}
+
+std::pair<XLATensorPtr, XLATensorPtr> flash_attention(
+    const XLATensorPtr& query, const XLATensorPtr& key,
+    const XLATensorPtr& value, double scale, bool causal,
+    int64_t block_size) {
+  torch::lazy::NodePtr node = torch_xla::MakeNode<FlashAttention>(
+      query->GetIrValue(), key->GetIrValue(), value->GetIrValue(), scale,
+      causal, block_size);
+  return {query->CreateFrom(torch::lazy::Value(node, 0)),
+          query->CreateFrom(torch::lazy::Value(node, 1),
+                            at::ScalarType::Float)};
+}
+
+std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> flash_attention_backward(
+    const XLATensorPtr& query, const XLATensorPtr& key,
+    const XLATensorPtr& value, const XLATensorPtr& output,
+    const XLATensorPtr& logsumexp, const XLATensorPtr& grad_output,
+    double scale, bool causal, int64_t block_size) {
+  torch::lazy::NodePtr node = torch_xla::MakeNode<FlashAttentionBackward>(
+      query->GetIrValue(), key->GetIrValue(), value->GetIrValue(),
+      output->GetIrValue(), logsumexp->GetIrValue(), grad_output->GetIrValue(),
+      scale, causal, block_size);
+  return std::make_tuple(query->CreateFrom(torch::lazy::Value(node, 0)),
+                         key->CreateFrom(torch::lazy::Value(node, 1)),
+                         value->CreateFrom(torch::lazy::Value(node, 2)));
+}
+
+XLATensorPtr grouped_matmul(const XLATensorPtr& lhs, const XLATensorPtr& rhs,
+                            const XLATensorPtr& group_sizes,
+                            bool transpose_rhs, int64_t tile_rows) {
+  return lhs->CreateFrom(torch_xla::MakeNode<GroupedMatmul>(
+      lhs->GetIrValue(), rhs->GetIrValue(), group_sizes->GetIrValue(),
+      transpose_rhs, tile_rows));
+}
+
+XLATensorPtr transposed_grouped_matmul(const XLATensorPtr& lhs,
+                                       const XLATensorPtr& rhs,
+                                       const XLATensorPtr& group_sizes,
+                                       int64_t tile_rows) {
+  return lhs->CreateFrom(torch_xla::MakeNode<TransposedGroupedMatmul>(
+      lhs->GetIrValue(), rhs->GetIrValue(), group_sizes->GetIrValue(),
+      tile_rows));
+}
+
+std::vector<XLATensorPtr> dropout_add_layer_norm(
+    const XLATensorPtr& input, const XLATensorPtr& residual,
+    const XLATensorPtr& weight, const XLATensorPtr& bias, double p, double eps,
+    bool return_mask) {
+  xla::Shape input_shape = input->shape();
+  XLA_CHECK(xla::ShapeUtil::Compatible(input_shape, residual->shape()))
+      << "The residual " << residual->shape()
+      << " does not match the input " << input_shape;
+  XLA_CHECK_GE(input_shape.rank(), 1);
+  std::vector<int64_t> features = {
+      input_shape.dimensions(input_shape.rank() - 1)};
+  XLA_CHECK(weight->shape().get().dimensions() ==
+                absl::Span<const int64_t>(features) &&
+            bias->shape().get().dimensions() ==
+                absl::Span<const int64_t>(features))
+      << "Expected the weight and bias to be [" << features[0] << "]";
+  torch::lazy::Value seed =
+      XLAGraphExecutor::Get()->GetRngSeed(input->GetDevice());
+  torch::lazy::NodePtr node = torch_xla::MakeNode<DropoutAddLayerNorm>(
+      input->GetIrValue(), residual->GetIrValue(), weight->GetIrValue(),
+      bias->GetIrValue(), seed, p, eps, return_mask);
+  std::vector<XLATensorPtr> results = {
+      input->CreateFrom(torch::lazy::Value(node, 0)),
+      input->CreateFrom(torch::lazy::Value(node, 1)),
+      input->CreateFrom(torch::lazy::Value(node, 2), at::ScalarType::Float),
+      input->CreateFrom(torch::lazy::Value(node, 3), at::ScalarType::Float),
+      XLATensor::Create(seed, input->GetDevice(), at::ScalarType::Long)};
+  if (return_mask) {
+    results.push_back(input->CreateFrom(torch::lazy::Value(node, 4)));
+  }
+  return results;
+}
+
+std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr, XLATensorPtr>
+dropout_add_layer_norm_backward(
+    const XLATensorPtr& grad_output, const XLATensorPtr& grad_sum,
+    const XLATensorPtr& sum, const XLATensorPtr& weight,
+    const XLATensorPtr& mean, const XLATensorPtr& rstd,
+    const XLATensorPtr& seed, const XLATensorPtr& mask, double p) {
+  torch::lazy::NodePtr node =
+      torch_xla::MakeNode<DropoutAddLayerNormBackward>(
+          grad_output->GetIrValue(), grad_sum->GetIrValue(), sum->GetIrValue(),
+          weight->GetIrValue(), mean->GetIrValue(), rstd->GetIrValue(),
+          seed->GetIrValue(), GetOptionalIrValue(mask), p);
+  return std::make_tuple(sum->CreateFrom(torch::lazy::Value(node, 0)),
+                         sum->CreateFrom(torch::lazy::Value(node, 1)),
+                         weight->CreateFrom(torch::lazy::Value(node, 2)),
+                         weight->CreateFrom(torch::lazy::Value(node, 3)));
+}
+
+XLATensorPtr masked_scaled_softmax(const XLATensorPtr& input,
+                                   const XLATensorPtr& mask, double scale,
+                                   bool causal) {
+  xla::Shape input_shape = input->shape();
+  XLA_CHECK_GE(input_shape.rank(), causal ? 2 : 1);
+  if (mask) {
+    xla::Shape mask_shape = mask->shape();
+    int64_t offset = input_shape.rank() - mask_shape.rank();
+    XLA_CHECK_GE(offset, 0) << "The mask " << mask_shape
+                            << " has more dimensions than the input";
+    for (int64_t i = 0; i < mask_shape.rank(); ++i) {
+      XLA_CHECK(mask_shape.dimensions(i) == 1 ||
+                mask_shape.dimensions(i) == input_shape.dimensions(offset + i))
+          << "The mask " << mask_shape << " does not broadcast to the input "
+          << input_shape;
+    }
+  }
+  return input->CreateFrom(torch_xla::MakeNode<MaskedScaledSoftmax>(
+      input->GetIrValue(), GetOptionalIrValue(mask), scale, causal));
+}
+
+XLATensorPtr masked_scaled_softmax_backward(const XLATensorPtr& grad_output,
+                                            const XLATensorPtr& output,
+                                            double scale) {
+  return output->CreateFrom(torch_xla::MakeNode<MaskedScaledSoftmaxBackward>(
+      grad_output->GetIrValue(), output->GetIrValue(), scale));
+}
+
+std::tuple<XLATensorPtr, XLATensorPtr> approx_topk(const XLATensorPtr& input,
+                                                   int64_t k, int64_t dim,
+                                                   bool largest,
+                                                   double recall_target) {
+  XLA_CHECK(recall_target > 0 && recall_target <= 1)
+      << "The recall target must be in (0, 1], got " << recall_target;
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ApproxTopK>(
+      input->GetIrValue(), k,
+      torch::lazy::GetCanonicalDimensionIndex(dim, input->shape().get().rank()),
+      largest, recall_target);
+  return std::make_tuple(
+      input->CreateFrom(torch::lazy::Value(node, 0)),
+      input->CreateFrom(torch::lazy::Value(node, 1), at::ScalarType::Long));
+}
+
+XLATensorPtr sample_tokens(const XLATensorPtr& logits,
+                           const XLATensorPtr& temperature, int64_t top_k,
+                           const XLATensorPtr& top_p) {
+  xla::Shape logits_shape = logits->shape();
+  XLA_CHECK_GE(logits_shape.rank(), 1);
+  XLA_CHECK_GE(top_k, 0);
+  absl::Span<const int64_t> batch_dims = logits_shape.dimensions().subspan(
+      0, logits_shape.rank() - 1);
+  for (const XLATensorPtr& param : {temperature, top_p}) {
+    if (param) {
+      xla::Shape param_shape = param->shape();
+      XLA_CHECK(param_shape.rank() == 0 ||
+                param_shape.dimensions() == batch_dims)
+          << "The sampling parameter " << param_shape
+          << " must be a scalar or match the batch dimensions of the logits "
+          << logits_shape;
+    }
+  }
+  torch::lazy::NodePtr node = torch_xla::MakeNode<SampleTokens>(
+      logits->GetIrValue(), temperature->GetIrValue(),
+      XLAGraphExecutor::Get()->GetRngSeed(logits->GetDevice()), top_k,
+      GetOptionalIrValue(top_p));
+  return logits->CreateFrom(torch::lazy::Value(node), at::ScalarType::Long);
+}
+
+void kv_cache_update_(XLATensorPtr& cache, const XLATensorPtr& update,
+                      const XLATensorPtr& position, int64_t dim) {
+  xla::Shape cache_shape = cache->shape();
+  xla::Shape update_shape = update->shape();
+  xla::Shape position_shape = position->shape();
+  dim = torch::lazy::GetCanonicalDimensionIndex(dim, cache_shape.rank());
+  XLA_CHECK_EQ(update_shape.rank(), cache_shape.rank())
+      << "The update " << update_shape << " must have the rank of the cache "
+      << cache_shape;
+  for (int64_t i = 0; i < cache_shape.rank(); ++i) {
+    int64_t update_size = update_shape.dimensions(i);
+    int64_t cache_size = cache_shape.dimensions(i);
+    XLA_CHECK(i == dim ? update_size <= cache_size : update_size == cache_size)
+        << "The update " << update_shape << " does not fit the cache "
+        << cache_shape << " along dimension " << dim;
+  }
+  XLA_CHECK(position_shape.rank() == 0 &&
+            xla::primitive_util::IsIntegralType(position_shape.element_type()))
+      << "The position must be an integer scalar, got " << position_shape;
+  cache->SetInPlaceIrValue(torch_xla::MakeNode<KvCacheUpdate>(
+      cache->GetIrValue(), update->GetIrValue(), position->GetIrValue(), dim));
+}
+
+void metric_accumulate_(XLATensorPtr& state, const XLATensorPtr& value,
+                        const XLATensorPtr& weight, int64_t reduction) {
+  xla::Shape state_shape = state->shape();
+  XLA_CHECK(state_shape.element_type() == xla::PrimitiveType::F32 &&
+            state_shape.rank() == 1 && state_shape.dimensions(0) == 2)
+      << "The metric state must be a F32 [2] tensor, got " << state_shape;
+  XLA_CHECK(reduction >= static_cast<int64_t>(MetricReduction::kSum) &&
+            reduction <= static_cast<int64_t>(MetricReduction::kMin))
+      << "Invalid metric reduction: " << reduction;
+  if (weight) {
+    xla::Shape weight_shape = weight->shape();
+    xla::Shape value_shape = value->shape();
+    XLA_CHECK(weight_shape.rank() == 0 ||
+              xla::ShapeUtil::SameDimensions(weight_shape, value_shape))
+        << "The weight " << weight_shape << " must be a scalar or of the shape "
+        << "of the value " << value_shape;
+  }
+  torch::lazy::Value weight_value = GetIrValueOrDefault(
+      weight, 1.0, xla::ShapeUtil::MakeShape(xla::PrimitiveType::F32, {}),
+      state->GetDevice());
+  state->SetInPlaceIrValue(torch_xla::MakeNode<MetricAccumulate>(
+      state->GetIrValue(), value->GetIrValue(), weight_value,
+      static_cast<MetricReduction>(reduction)));
+}
+
+void kv_cache_rollback_(XLATensorPtr& cache, const XLATensorPtr& position,
+                        const XLATensorPtr& accepted, int64_t window,
+                        int64_t dim) {
+  xla::Shape cache_shape = cache->shape();
+  dim = torch::lazy::GetCanonicalDimensionIndex(dim, cache_shape.rank());
+  XLA_CHECK(window > 0 && window <= cache_shape.dimensions(dim))
+      << "The window " << window << " does not fit the cache " << cache_shape
+      << " along dimension " << dim;
+  for (const XLATensorPtr& scalar : {position, accepted}) {
+    xla::Shape scalar_shape = scalar->shape();
+    XLA_CHECK(scalar_shape.rank() == 0 &&
+              xla::primitive_util::IsIntegralType(scalar_shape.element_type()))
+        << "The position and the accepted count must be integer scalars, got "
+        << scalar_shape;
+  }
+  cache->SetInPlaceIrValue(torch_xla::MakeNode<KvCacheRollback>(
+      cache->GetIrValue(), position->GetIrValue(), accepted->GetIrValue(),
+      window, dim));
+}
+
+std::pair<XLATensorPtr, torch::lazy::Value> sharded_embedding_bag(
+    const XLATensorPtr& weight, const XLATensorPtr& indices,
+    const XLATensorPtr& offsets, const XLATensorPtr& per_sample_weights,
+    const torch::lazy::Value& token, int64_t mode, bool include_last_offset,
+    std::vector<std::vector<int64_t>> groups, bool pin_layout) {
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ShardedEmbeddingBag>(
+      weight->GetIrValue(), indices->GetIrValue(), offsets->GetIrValue(),
+      per_sample_weights->GetIrValue(), token, mode, include_last_offset,
+      std::move(groups), pin_layout);
+  return {weight->CreateFrom(torch::lazy::Value(node, 0)),
+          torch::lazy::Value(node, 1)};
+}
+
+std::tuple<XLATensorPtr, XLATensorPtr, torch::lazy::Value>
+sharded_embedding_bag_backward(
+    const XLATensorPtr& grad_output, const XLATensorPtr& indices,
+    const XLATensorPtr& offsets, const XLATensorPtr& per_sample_weights,
+    const torch::lazy::Value& token, int64_t mode, bool include_last_offset,
+    int64_t num_rows, std::vector<std::vector<int64_t>> groups,
+    bool pin_layout) {
+  torch::lazy::NodePtr node =
+      torch_xla::MakeNode<ShardedEmbeddingBagBackward>(
+          grad_output->GetIrValue(), indices->GetIrValue(),
+          offsets->GetIrValue(), per_sample_weights->GetIrValue(), token, mode,
+          include_last_offset, num_rows, std::move(groups), pin_layout);
+  return std::make_tuple(indices->CreateFrom(torch::lazy::Value(node, 0)),
+                         grad_output->CreateFrom(torch::lazy::Value(node, 1)),
+                         torch::lazy::Value(node, 2));
+}
+
 std::vector<XLATensorPtr> custom_call(
     const std::vector<XLATensorPtr>& inputs, const std::string& target,
     const std::vector<std::vector<int64_t>>& output_shapes,
@@ -545,7 +1012,7 @@ std::vector<XLATensorPtr> custom_call(
         output_shapes[i]));
   }
 
-  auto node = torch::lazy::MakeNode<CustomCall>(
+  auto node = torch_xla::MakeNode<CustomCall>(
       values, target, xla::ShapeUtil::MakeTupleShape(output_xla_shapes),
       has_side_effect, backend_config, api_version);
 
@@ -562,13 +1029,13 @@ void custom_sharding_(
     const XLATensorPtr& input,
     const std::shared_ptr<XLATensor::ShardingSpec>& sharding_spec,
     const CustomSharding::Type& type) {
-  input->SetInPlaceIrValue(torch::lazy::MakeNode<CustomSharding>(
+  input->SetInPlaceIrValue(torch_xla::MakeNode<CustomSharding>(
       input->GetIrValue(), input->shape().get(), type));
   input->SetShardingSpec(*sharding_spec);
 }
 
 std::vector<XLATensorPtr> gpu_custom_call(
-    const std::vector<XLATensorPtr>& inputs, const std::string& payload,
+    const std::vector<XLATensorPtr>& inputs, int64_t kernel_id,
     const std::vector<std::vector<int64_t>>& output_shapes,
     const std::vector<at::ScalarType>& output_dtypes) {
   XLA_CHECK(inputs.size() > 0) << "inputs are empty";
@@ -588,8 +1055,9 @@ std::vector<XLATensorPtr> gpu_custom_call(
         output_shapes[i]));
   }
 
-  auto node = torch::lazy::MakeNode<GpuCustomCall>(
-      values, xla::ShapeUtil::MakeTupleShape(output_xla_shapes), payload);
+  auto node = torch_xla::MakeNode<GpuCustomCall>(
+      values, xla::ShapeUtil::MakeTupleShape(output_xla_shapes),
+      CustomKernelRegistry::Get()->GetKernel(kernel_id));
 
   std::vector<XLATensorPtr> outputs;
   outputs.reserve(output_shapes.size());
@@ -601,7 +1069,7 @@ std::vector<XLATensorPtr> gpu_custom_call(
 }
 
 std::vector<XLATensorPtr> tpu_custom_call(
-    const std::vector<XLATensorPtr>& inputs, const std::string& payload,
+    const std::vector<XLATensorPtr>& inputs, int64_t kernel_id,
     const std::vector<std::vector<int64_t>>& output_shapes,
     const std::vector<at::ScalarType>& output_dtypes) {
   XLA_CHECK(inputs.size() > 0) << "inputs are empty";
@@ -621,8 +1089,9 @@ std::vector<XLATensorPtr> tpu_custom_call(
         output_shapes[i]));
   }
 
-  auto node = torch::lazy::MakeNode<TpuCustomCall>(
-      values, xla::ShapeUtil::MakeTupleShape(output_xla_shapes), payload);
+  auto node = torch_xla::MakeNode<TpuCustomCall>(
+      values, xla::ShapeUtil::MakeTupleShape(output_xla_shapes),
+      CustomKernelRegistry::Get()->GetKernel(kernel_id));
 
   std::vector<XLATensorPtr> outputs;
   outputs.reserve(output_shapes.size());
@@ -635,14 +1104,14 @@ std::vector<XLATensorPtr> tpu_custom_call(
 
 XLATensorPtr get_dimensions_size(const XLATensorPtr& input,
                                  std::vector<int64_t> dimensions) {
-  return input->CreateFrom(torch::lazy::MakeNode<GetDimensionsSize>(
+  return input->CreateFrom(torch_xla::MakeNode<GetDimensionsSize>(
                                input->GetIrValue(), std::move(dimensions)),
                            at::ScalarType::Int);
 }
 
 std::pair<XLATensorPtr, torch::lazy::Value> recv(
     XLATensorPtr& output, const torch::lazy::Value& token, int64_t channel_id) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<ir::ops::Recv>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ir::ops::Recv>(
       token, GetXlaShape(output->GetIrValue()), channel_id);
   output->SetIrValue(torch::lazy::Value(node, 0));
   return {output->CreateFrom(torch::lazy::Value(node, 0)),
@@ -652,7 +1121,7 @@ std::pair<XLATensorPtr, torch::lazy::Value> recv(
 std::pair<XLATensorPtr, torch::lazy::Value> send(
     const XLATensorPtr& input, const torch::lazy::Value& token,
     int64_t channel_id) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<ir::ops::Send>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ir::ops::Send>(
       input->GetIrValue(), token, channel_id);
   return {input->CreateFrom(torch::lazy::Value(node, 0)),
           torch::lazy::Value(node, 1)};
@@ -674,7 +1143,7 @@ void sgd_optimizer_step_(const XLATensorPtr& found_inf, XLATensorPtr& step,
   torch::lazy::Value dampening_value =
       XLAGraphExecutor::Get()->GetIrValueForScalar(dampening, param->shape(),
                                                    param->GetDevice());
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<SgdOptimizerStep>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<SgdOptimizerStep>(
       found_inf->GetIrValue(), step->GetIrValue(), param->GetIrValue(),
       buf->GetIrValue(), d_p->GetIrValue(), weight_decay_value, momentum_value,
       lr_value, dampening_value,
@@ -705,7 +1174,7 @@ void adam_optimizer_step_(const XLATensorPtr& found_inf, XLATensorPtr& step,
                                                    param->GetDevice());
   torch::lazy::Value eps_value = XLAGraphExecutor::Get()->GetIrValueForScalar(
       eps, param->shape(), param->GetDevice());
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<AdamOptimizerStep>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AdamOptimizerStep>(
       found_inf->GetIrValue(), step->GetIrValue(), param->GetIrValue(),
       grad_value, exp_avg->GetIrValue(), exp_avg_sq->GetIrValue(),
       max_exp_avg_sq->GetIrValue(), beta1_value, beta2_value, lr_value,
@@ -721,6 +1190,142 @@ void adam_optimizer_step_(const XLATensorPtr& found_inf, XLATensorPtr& step,
   }
 }
 
+void foreach_sgd_optimizer_step_(const XLATensorPtr& found_inf,
+                                 const XLATensorPtr& grad_scale,
+                                 std::vector<XLATensorPtr>& steps,
+                                 std::vector<XLATensorPtr>& params,
+                                 std::vector<XLATensorPtr>& bufs,
+                                 const std::vector<XLATensorPtr>& d_ps,
+                                 double weight_decay, double momentum,
+                                 double lr, double dampening, bool nesterov,
+                                 bool maximize) {
+  CheckForeachParams(params);
+  // The scalars are rank 0, as they apply to the flattened params.
+  auto scalar = [&](double value) {
+    return XLAGraphExecutor::Get()->GetIrValueForScalar(
+        value, params.front()->shape().get().element_type(),
+        params.front()->GetDevice());
+  };
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ForeachSgdOptimizerStep>(
+      found_inf->GetIrValue(), grad_scale->GetIrValue(), scalar(weight_decay),
+      scalar(momentum), scalar(maximize ? -lr : lr), scalar(dampening),
+      GetIrValues(steps), GetIrValues(params), GetIrValues(bufs),
+      GetIrValues(d_ps),
+      /*use_weight_decay=*/weight_decay != 0,
+      /*use_momentum=*/momentum != 0, /*use_nesterov=*/nesterov);
+  SetInPlaceIrValues(steps, node, 0);
+  SetInPlaceIrValues(params, node, params.size());
+  SetInPlaceIrValues(bufs, node, 2 * params.size());
+}
+
+void foreach_adam_optimizer_step_(
+    const XLATensorPtr& found_inf, const XLATensorPtr& grad_scale,
+    std::vector<XLATensorPtr>& steps, std::vector<XLATensorPtr>& params,
+    const std::vector<XLATensorPtr>& grads, std::vector<XLATensorPtr>& exp_avgs,
+    std::vector<XLATensorPtr>& exp_avg_sqs,
+    std::vector<XLATensorPtr>& max_exp_avg_sqs, double beta1, double beta2,
+    double lr, double weight_decay, double eps, bool amsgrad, bool maximize,
+    bool use_adamw) {
+  CheckForeachParams(params);
+  auto step_scalar = [&](double value) {
+    return XLAGraphExecutor::Get()->GetIrValueForScalar(
+        value, found_inf->shape(), found_inf->GetDevice());
+  };
+  auto param_scalar = [&](double value) {
+    return XLAGraphExecutor::Get()->GetIrValueForScalar(
+        value, params.front()->shape().get().element_type(),
+        params.front()->GetDevice());
+  };
+  std::vector<torch::lazy::Value> grad_values;
+  for (const XLATensorPtr& grad : grads) {
+    grad_values.push_back(maximize ? mul(grad, -1)->GetIrValue()
+                                   : grad->GetIrValue());
+  }
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ForeachAdamOptimizerStep>(
+      found_inf->GetIrValue(), grad_scale->GetIrValue(), step_scalar(beta1),
+      step_scalar(beta2), step_scalar(lr), param_scalar(weight_decay),
+      param_scalar(eps), GetIrValues(steps), GetIrValues(params), grad_values,
+      GetIrValues(exp_avgs), GetIrValues(exp_avg_sqs),
+      amsgrad ? GetIrValues(max_exp_avg_sqs)
+              : std::vector<torch::lazy::Value>(),
+      /*use_weight_decay=*/weight_decay != 0,
+      /*use_amsgrad=*/amsgrad, /*use_adamw=*/use_adamw);
+  SetInPlaceIrValues(steps, node, 0);
+  SetInPlaceIrValues(params, node, params.size());
+  SetInPlaceIrValues(exp_avgs, node, 2 * params.size());
+  SetInPlaceIrValues(exp_avg_sqs, node, 3 * params.size());
+  if (amsgrad) {
+    SetInPlaceIrValues(max_exp_avg_sqs, node, 4 * params.size());
+  }
+}
+
+XLATensorPtr foreach_grad_norm_(XLATensorPtr& found_inf,
+                                const XLATensorPtr& inv_scale,
+                                const std::vector<XLATensorPtr>& grads) {
+  XLA_CHECK(!grads.empty());
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ForeachGradNorm>(
+      found_inf->GetIrValue(), inv_scale->GetIrValue(), GetIrValues(grads));
+  found_inf->SetInPlaceIrValue(torch::lazy::Value(node, 0));
+  return found_inf->CreateFrom(torch::lazy::Value(node, 1),
+                               at::ScalarType::Float);
+}
+
+void sparse_sgd_optimizer_step_(const XLATensorPtr& found_inf,
+                                XLATensorPtr& step, XLATensorPtr& param,
+                                XLATensorPtr& buf, const XLATensorPtr& rows,
+                                const XLATensorPtr& values, double weight_decay,
+                                double momentum, double lr, double dampening,
+                                bool nesterov, bool maximize) {
+  // The scalars are rank 0, as the update is computed over the rows only.
+  auto scalar = [&](double value) {
+    return XLAGraphExecutor::Get()->GetIrValueForScalar(
+        value, param->shape().get().element_type(), param->GetDevice());
+  };
+  torch::lazy::NodePtr node = torch_xla::MakeNode<SparseSgdOptimizerStep>(
+      found_inf->GetIrValue(), step->GetIrValue(), param->GetIrValue(),
+      buf->GetIrValue(), rows->GetIrValue(), values->GetIrValue(),
+      scalar(weight_decay), scalar(momentum), scalar(maximize ? -lr : lr),
+      scalar(dampening),
+      /*use_weight_decay=*/weight_decay != 0,
+      /*use_momentum=*/momentum != 0, /*use_nesterov=*/nesterov);
+  step->SetInPlaceIrValue(torch::lazy::Value(node, 0));
+  param->SetInPlaceIrValue(torch::lazy::Value(node, 1));
+  buf->SetInPlaceIrValue(torch::lazy::Value(node, 2));
+}
+
+void sparse_adam_optimizer_step_(
+    const XLATensorPtr& found_inf, XLATensorPtr& step, XLATensorPtr& param,
+    const XLATensorPtr& rows, const XLATensorPtr& values, XLATensorPtr& exp_avg,
+    XLATensorPtr& exp_avg_sq, XLATensorPtr& max_exp_avg_sq, double beta1,
+    double beta2, double lr, double weight_decay, double eps, bool amsgrad,
+    bool maximize, bool use_adamw) {
+  auto step_scalar = [&](double value) {
+    return XLAGraphExecutor::Get()->GetIrValueForScalar(
+        value, found_inf->shape(), found_inf->GetDevice());
+  };
+  auto param_scalar = [&](double value) {
+    return XLAGraphExecutor::Get()->GetIrValueForScalar(
+        value, param->shape().get().element_type(), param->GetDevice());
+  };
+  torch::lazy::Value values_value =
+      maximize ? mul(values, -1)->GetIrValue() : values->GetIrValue();
+  torch::lazy::NodePtr node = torch_xla::MakeNode<SparseAdamOptimizerStep>(
+      found_inf->GetIrValue(), step->GetIrValue(), param->GetIrValue(),
+      rows->GetIrValue(), values_value, exp_avg->GetIrValue(),
+      exp_avg_sq->GetIrValue(), max_exp_avg_sq->GetIrValue(),
+      step_scalar(beta1), step_scalar(beta2), step_scalar(lr),
+      param_scalar(weight_decay), param_scalar(eps),
+      /*use_weight_decay=*/weight_decay != 0,
+      /*use_amsgrad=*/amsgrad, /*use_adamw=*/use_adamw);
+  step->SetInPlaceIrValue(torch::lazy::Value(node, 0));
+  param->SetInPlaceIrValue(torch::lazy::Value(node, 1));
+  exp_avg->SetInPlaceIrValue(torch::lazy::Value(node, 2));
+  exp_avg_sq->SetInPlaceIrValue(torch::lazy::Value(node, 3));
+  if (amsgrad) {
+    max_exp_avg_sq->SetInPlaceIrValue(torch::lazy::Value(node, 4));
+  }
+}
+
 std::vector<XLATensorPtr> user_computation(
     const std::string& opname, absl::Span<const XLATensorPtr> inputs,
     runtime::ComputationClient::ComputationPtr computation) {
@@ -729,7 +1334,7 @@ std::vector<XLATensorPtr> user_computation(
   for (auto& input : inputs) {
     input_values.push_back(input->GetIrValue());
   }
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<UserComputation>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<UserComputation>(
       torch::lazy::OpKind::Get(opname), input_values, std::move(computation));
   // Cast can be one of the user computation and we don't want to inherit the
   // logical_element_type in this case
@@ -737,6 +1342,25 @@ std::vector<XLATensorPtr> user_computation(
                                            /*inherit_logical_type=*/false);
 }
 
+std::vector<XLATensorPtr> while_loop(
+    absl::Span<const XLATensorPtr> carried,
+    absl::Span<const XLATensorPtr> invariants,
+    runtime::ComputationClient::ComputationPtr cond,
+    runtime::ComputationClient::ComputationPtr body) {
+  XLA_CHECK(!carried.empty());
+  std::vector<torch::lazy::Value> input_values;
+  for (auto& input : carried) {
+    input_values.push_back(input->GetIrValue());
+  }
+  for (auto& input : invariants) {
+    input_values.push_back(input->GetIrValue());
+  }
+  torch::lazy::NodePtr node = torch_xla::MakeNode<WhileLoop>(
+      input_values, carried.size(), std::move(cond), std::move(body));
+  return carried.front()->MakeOutputTensors(node,
+                                            /*inherit_logical_type=*/false);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // ATEN operators follows here, listed in alphabetical order.
 //////////////////////////////////////////////////////////////////////////////
@@ -782,7 +1406,7 @@ XLATensorPtr __rshift__(const XLATensorPtr& input, const XLATensorPtr& other,
 
 std::tuple<XLATensorPtr, XLATensorPtr> adaptive_max_pool2d(
     const XLATensorPtr& input, std::vector<int64_t> output_size) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<AdaptiveMaxPool2d>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AdaptiveMaxPool2d>(
       input->GetIrValue(), output_size);
   XLATensorPtr out = input->CreateFrom(torch::lazy::Value(node, 0));
   XLATensorPtr indices =
@@ -798,13 +1422,13 @@ XLATensorPtr adaptive_max_pool2d_backward(const XLATensorPtr& grad_output,
 
 XLATensorPtr _adaptive_avg_pool2d(const XLATensorPtr& input,
                                   std::vector<int64_t> output_size) {
-  return input->CreateFrom(torch::lazy::MakeNode<AdaptiveAvgPool2d>(
+  return input->CreateFrom(torch_xla::MakeNode<AdaptiveAvgPool2d>(
       input->GetIrValue(), std::move(output_size)));
 }
 
 XLATensorPtr _adaptive_avg_pool2d_backward(const XLATensorPtr& grad_output,
                                            const XLATensorPtr& input) {
-  return input->CreateFrom(torch::lazy::MakeNode<AdaptiveAvgPool2dBackward>(
+  return input->CreateFrom(torch_xla::MakeNode<AdaptiveAvgPool2dBackward>(
       grad_output->GetIrValue(), input->GetIrValue()));
 }
 
@@ -817,7 +1441,7 @@ void _amp_foreach_non_finite_check_and_unscale_(std::vector<XLATensorPtr> self,
     inputs.push_back(x->GetIrValue());
   }
   torch::lazy::NodePtr node =
-      torch::lazy::MakeNode<AmpForachNonFiniteCheckAndUnscale>(
+      torch_xla::MakeNode<AmpForachNonFiniteCheckAndUnscale>(
           inputs, found_inf->GetIrValue(), new_inv_scale->GetIrValue());
   for (size_t i = 0; i < self.size(); ++i) {
     self[i]->SetInPlaceIrValue(torch::lazy::Value(node, i));
@@ -830,7 +1454,7 @@ void _amp_update_scale_(XLATensorPtr& current_scale,
                         const XLATensorPtr& found_inf,
                         double scale_growth_factor, double scale_backoff_factor,
                         int growth_interval) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<AmpUpdateScale>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<AmpUpdateScale>(
       growth_tracker->GetIrValue(), current_scale->GetIrValue(),
       found_inf->GetIrValue(), scale_growth_factor, scale_backoff_factor,
       growth_interval);
@@ -839,7 +1463,7 @@ void _amp_update_scale_(XLATensorPtr& current_scale,
 }
 
 XLATensorPtr abs(const XLATensorPtr& input) {
-  return input->CreateFrom(torch::lazy::MakeNode<Abs>(input->GetIrValue()));
+  return input->CreateFrom(torch_xla::MakeNode<Abs>(input->GetIrValue()));
 }
 
 XLATensorPtr add(const XLATensorPtr& input, const XLATensorPtr& other,
@@ -913,7 +1537,7 @@ XLATensorPtr as_strided(const XLATensorPtr& input, std::vector<int64_t> size,
     return input->CreateViewTensor(CreateAsStridedViewInfo(
         input_shape, std::move(size), std::move(stride), storage_offset));
   }
-  return input->CreateFrom(torch::lazy::MakeNode<AsStrided>(
+  return input->CreateFrom(torch_xla::MakeNode<AsStrided>(
       input->GetIrValue(), std::move(size), std::move(stride),
       storage_offset.value_or(0)));
 }
@@ -922,7 +1546,7 @@ void as_strided_(XLATensorPtr& input, std::vector<int64_t> size,
                  std::vector<int64_t> stride,
                  c10::optional<int64_t> storage_offset) {
   if (input->data()->view == nullptr) {
-    input->SetIrValue(torch::lazy::MakeNode<AsStrided>(
+    input->SetIrValue(torch_xla::MakeNode<AsStrided>(
         input->GetIrValue(), std::move(size), std::move(stride),
         storage_offset.value_or(0)));
   } else {
@@ -941,7 +1565,7 @@ XLATensorPtr avg_pool_nd(const XLATensorPtr& input, int64_t spatial_dim_count,
   kernel_size = CheckIntList(kernel_size, spatial_dim_count, "kernel_size");
   stride = CheckIntList(stride, spatial_dim_count, "stride", kernel_size);
   padding = CheckIntList(padding, spatial_dim_count, "padding");
-  return input->CreateFrom(torch::lazy::MakeNode<AvgPoolNd>(
+  return input->CreateFrom(torch_xla::MakeNode<AvgPoolNd>(
       input->GetIrValue(), spatial_dim_count, std::move(kernel_size),
       std::move(stride), std::move(padding), ceil_mode, count_include_pad,
       divisor_override));
@@ -957,7 +1581,7 @@ XLATensorPtr avg_pool_nd_backward(const XLATensorPtr& out_backprop,
   kernel_size = CheckIntList(kernel_size, spatial_dim_count, "kernel_size");
   stride = CheckIntList(stride, spatial_dim_count, "stride", kernel_size);
   padding = CheckIntList(padding, spatial_dim_count, "padding");
-  return out_backprop->CreateFrom(torch::lazy::MakeNode<AvgPoolNdBackward>(
+  return out_backprop->CreateFrom(torch_xla::MakeNode<AvgPoolNdBackward>(
       out_backprop->GetIrValue(), input->GetIrValue(), spatial_dim_count,
       std::move(kernel_size), std::move(stride), std::move(padding), ceil_mode,
       count_include_pad));
@@ -973,14 +1597,14 @@ XLATensorPtr baddbmm(const XLATensorPtr& input, const XLATensorPtr& batch1,
   torch::lazy::Value bias_multiplier =
       XLAGraphExecutor::Get()->GetIrValueForScalar(
           beta, input->shape().get().element_type(), input->GetDevice());
-  return input->CreateFrom(torch::lazy::MakeNode<Baddbmm>(
+  return input->CreateFrom(torch_xla::MakeNode<Baddbmm>(
       input->GetIrValue(), batch1->GetIrValue(), batch2->GetIrValue(),
       bias_multiplier, product_multiplier));
 }
 
 XLATensorPtr bernoulli(const XLATensorPtr& input, double probability) {
   auto input_shape = input->shape();
-  return input->CreateFrom(torch::lazy::MakeNode<Bernoulli>(
+  return input->CreateFrom(torch_xla::MakeNode<Bernoulli>(
       XLAGraphExecutor::Get()->GetIrValueForScalar(probability, input_shape,
                                                    input->GetDevice()),
       XLAGraphExecutor::Get()->GetRngSeed(input->GetDevice()),
@@ -988,31 +1612,31 @@ XLATensorPtr bernoulli(const XLATensorPtr& input, double probability) {
 }
 
 XLATensorPtr bernoulli(const XLATensorPtr& input) {
-  return input->CreateFrom(torch::lazy::MakeNode<Bernoulli>(
+  return input->CreateFrom(torch_xla::MakeNode<Bernoulli>(
       input->GetIrValue(),
       XLAGraphExecutor::Get()->GetRngSeed(input->GetDevice()),
       input->shape().get()));
 }
 
 void bernoulli_(XLATensorPtr& input, const XLATensorPtr& probability) {
-  input->SetInPlaceIrValue(torch::lazy::MakeNode<Bernoulli>(
+  input->SetInPlaceIrValue(torch_xla::MakeNode<Bernoulli>(
       probability->GetIrValue(),
       XLAGraphExecutor::Get()->GetRngSeed(input->GetDevice()),
       input->shape().get()));
 }
 
 XLATensorPtr bitwise_and(const XLATensorPtr& input, const XLATensorPtr& other) {
-  return input->CreateFrom(torch::lazy::MakeNode<BitwiseAndTensor>(
+  return input->CreateFrom(torch_xla::MakeNode<BitwiseAndTensor>(
       input->GetIrValue(), other->GetIrValue()));
 }
 
 XLATensorPtr bitwise_or(const XLATensorPtr& input, const XLATensorPtr& other) {
-  return input->CreateFrom(torch::lazy::MakeNode<BitwiseOrTensor>(
+  return input->CreateFrom(torch_xla::MakeNode<BitwiseOrTensor>(
       input->GetIrValue(), other->GetIrValue()));
 }
 
 XLATensorPtr bitwise_xor(const XLATensorPtr& input, const XLATensorPtr& other) {
-  return input->CreateFrom(torch::lazy::MakeNode<BitwiseXorTensor>(
+  return input->CreateFrom(torch_xla::MakeNode<BitwiseXorTensor>(
       input->GetIrValue(), other->GetIrValue()));
 }
 
@@ -1062,18 +1686,19 @@ XLATensorPtr cat(absl::Span<const XLATensorPtr> tensors, int64_t dim,
   if (values.empty()) {
     return tensors[0];
   }
-  return tensors[0]->CreateFrom(torch::lazy::MakeNode<Cat>(values, dim, dtype),
+  return tensors[0]->CreateFrom(torch_xla::MakeNode<Cat>(values, dim, dtype),
                                 dtype);
 }
 
 XLATensorPtr cdist_forward(const XLATensorPtr& x1, const XLATensorPtr& x2,
-                           double p) {
+                           double p, bool use_mm_for_euclid_dist) {
   torch::lazy::Value exponent_node =
       XLAGraphExecutor::Get()->GetIrValueForScalar(p, x1->GetDevice());
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<CdistForward>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<CdistForward>(
       x1->GetIrValue(), x2->GetIrValue(), exponent_node,
       /*use_hamming=*/p == 0.0,
-      /*use_chebyshev=*/std::isinf(p));
+      /*use_chebyshev=*/std::isinf(p),
+      /*use_euclidean=*/p == 2.0 && use_mm_for_euclid_dist);
   return x1->CreateFrom(node);
 }
 
@@ -1096,6 +1721,29 @@ void celu_(XLATensorPtr& input, const at::Scalar& alpha) {
   input->SetInPlaceIrValue(Celu(input->GetIrValue(), alpha));
 }
 
+std::pair<XLATensorPtr, XLATensorPtr> chunked_cross_entropy(
+    const XLATensorPtr& input, const XLATensorPtr& target, int64_t reduction,
+    int ignore_index, int64_t chunk_size) {
+  torch::lazy::NodePtr node = torch_xla::MakeNode<ChunkedCrossEntropy>(
+      input->GetIrValue(), target->GetIrValue(), ignore_index,
+      GetXlaReductionMode(reduction), chunk_size);
+  return {input->CreateFrom(torch::lazy::Value(node, 0)),
+          input->CreateFrom(torch::lazy::Value(node, 1),
+                            at::ScalarType::Float)};
+}
+
+XLATensorPtr chunked_cross_entropy_backward(const XLATensorPtr& grad_output,
+                                            const XLATensorPtr& input,
+                                            const XLATensorPtr& target,
+                                            const XLATensorPtr& logsumexp,
+                                            int64_t reduction, int ignore_index,
+                                            int64_t chunk_size) {
+  return input->CreateFrom(torch_xla::MakeNode<ChunkedCrossEntropyBackward>(
+      grad_output->GetIrValue(), input->GetIrValue(), target->GetIrValue(),
+      logsumexp->GetIrValue(), ignore_index, GetXlaReductionMode(reduction),
+      chunk_size));
+}
+
 XLATensorPtr clamp(const XLATensorPtr& input,
                    const c10::optional<at::Scalar>& min,
                    const c10::optional<at::Scalar>& max) {
@@ -1118,7 +1766,7 @@ XLATensorPtr constant_pad_nd(const XLATensorPtr& input,
                              const at::Scalar& value) {
   std::vector<int64_t> complete_pad(pad.begin(), pad.end());
   complete_pad.resize(2 * input->shape().get().rank());
-  return input->CreateFrom(torch::lazy::MakeNode<ConstantPadNd>(
+  return input->CreateFrom(torch_xla::MakeNode<ConstantPadNd>(
       input->GetIrValue(), complete_pad, value));
 }
 
@@ -1128,7 +1776,7 @@ XLATensorPtr convolution_overrideable(
     std::vector<int64_t> padding, std::vector<int64_t> dilation,
     bool transposed, std::vector<int64_t> output_padding, int64_t groups) {
   torch::lazy::NodePtr ir_value =
-      torch::lazy::MakeNode<ConvolutionOverrideable>(
+      torch_xla::MakeNode<ConvolutionOverrideable>(
           input->GetIrValue(), weight->GetIrValue(), bias->GetIrValue(),
           std::move(stride), std::move(padding), std::move(dilation),
           transposed, std::move(output_padding), groups);
@@ -1141,7 +1789,7 @@ XLATensorPtr convolution_overrideable(
     std::vector<int64_t> dilation, bool transposed,
     std::vector<int64_t> output_padding, int64_t groups) {
   torch::lazy::NodePtr ir_value =
-      torch::lazy::MakeNode<ConvolutionOverrideable>(
+      torch_xla::MakeNode<ConvolutionOverrideable>(
           input->GetIrValue(), weight->GetIrValue(), std::move(stride),
           std::move(padding), std::move(dilation), transposed,
           std::move(output_padding), groups);
@@ -1155,7 +1803,7 @@ convolution_backward_overrideable(
     std::vector<int64_t> padding, std::vector<int64_t> dilation,
     bool transposed, std::vector<int64_t> output_padding, int64_t groups) {
   torch::lazy::NodePtr node =
-      torch::lazy::MakeNode<ConvolutionBackwardOverrideable>(
+      torch_xla::MakeNode<ConvolutionBackwardOverrideable>(
           out_backprop->GetIrValue(), input->GetIrValue(), weight->GetIrValue(),
           std::move(stride), std::move(padding), std::move(dilation),
           transposed, std::move(output_padding), groups);
@@ -1172,7 +1820,7 @@ convolution_backward_overrideable(
 XLATensorPtr count_nonzero(const XLATensorPtr& input,
                            std::vector<int64_t> dims) {
   torch::lazy::NodePtr ir_value =
-      torch::lazy::MakeNode<CountNonzero>(input->GetIrValue(), dims);
+      torch_xla::MakeNode<CountNonzero>(input->GetIrValue(), dims);
   return input->CreateFrom(ir_value);
 }
 
@@ -1189,7 +1837,7 @@ XLATensorPtr cumprod(const XLATensorPtr& input, int64_t dim,
     dtype = input->dtype_optional();
   }
   return input->CreateFrom(
-      torch::lazy::MakeNode<CumProd>(input->GetIrValue(), canonical_dim, dtype),
+      torch_xla::MakeNode<CumProd>(input->GetIrValue(), canonical_dim, dtype),
       dtype);
 }
 
@@ -1201,7 +1849,7 @@ XLATensorPtr cumsum(const XLATensorPtr& input, int64_t dim,
     dtype = input->dtype_optional();
   }
   return input->CreateFrom(
-      torch::lazy::MakeNode<CumSum>(input->GetIrValue(), canonical_dim, dtype),
+      torch_xla::MakeNode<CumSum>(input->GetIrValue(), canonical_dim, dtype),
       dtype);
 }
 
@@ -1233,7 +1881,7 @@ XLATensorPtr diagonal(const XLATensorPtr& input, int64_t offset, int64_t dim1,
     return input->CreateViewTensor(std::move(view_info));
   }
 
-  return input->CreateFrom(torch::lazy::MakeNode<Diagonal>(
+  return input->CreateFrom(torch_xla::MakeNode<Diagonal>(
       input->GetIrValue(), offset, canonical_dim1, canonical_dim2));
 }
 
@@ -1258,9 +1906,9 @@ XLATensorPtr div(const XLATensorPtr& input, const XLATensorPtr& other,
   torch::lazy::Value res = Div(input_value, other_value);
   if (rounding_mode.has_value()) {
     if (*rounding_mode == "trunc") {
-      res = torch::lazy::MakeNode<Trunc>(res);
+      res = torch_xla::MakeNode<Trunc>(res);
     } else if (*rounding_mode == "floor") {
-      res = torch::lazy::MakeNode<Floor>(res);
+      res = torch_xla::MakeNode<Floor>(res);
     } else {
       XLA_CHECK(false)
           << "rounding_mode must be one of None, 'trunc', or 'floor'";
@@ -1276,7 +1924,7 @@ XLATensorPtr div(const XLATensorPtr& input, const XLATensorPtr& other,
       xla::PrimitiveType res_intended_type =
           MakeXlaPrimitiveType(*logical_element_type, &input->GetDevice());
       if (GetXlaShape(res).element_type() != res_intended_type) {
-        res = torch::lazy::MakeNode<Cast>(res, res_intended_type);
+        res = torch_xla::MakeNode<Cast>(res, res_intended_type);
       }
     }
     return input->CreateFrom(res, logical_element_type);
@@ -1297,11 +1945,11 @@ XLATensorPtr div(const XLATensorPtr& input, const at::Scalar& other) {
   }
   at::ScalarType op_math_type = at::toOpMathType(scalar_type);
   torch::lazy::Value input_value =
-      torch::lazy::MakeNode<Cast>(input->GetIrValue(), op_math_type);
+      torch_xla::MakeNode<Cast>(input->GetIrValue(), op_math_type);
   torch::lazy::Value other_value = XLAGraphExecutor::Get()->GetIrValueForScalar(
       other, XlaTypeFromTorchType(op_math_type), input->GetDevice());
   return input->CreateFrom(
-      torch::lazy::MakeNode<Cast>(Div(input_value, other_value), scalar_type),
+      torch_xla::MakeNode<Cast>(Div(input_value, other_value), scalar_type),
       scalar_type);
 }
 
@@ -1313,7 +1961,7 @@ XLATensorPtr einsum(const std::string& equation,
     irs.push_back(tensor->GetIrValue());
   }
 
-  return tensors[0]->CreateFrom(torch::lazy::MakeNode<Einsum>(irs, equation));
+  return tensors[0]->CreateFrom(torch_xla::MakeNode<Einsum>(irs, equation));
 }
 
 std::tuple<XLATensorPtr, XLATensorPtr> einsum_backward(
@@ -1325,7 +1973,7 @@ std::tuple<XLATensorPtr, XLATensorPtr> einsum_backward(
     irs.push_back(tensor->GetIrValue());
   }
 
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<EinsumBackward>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<EinsumBackward>(
       grad_output->GetIrValue(), irs, equation);
 
   if (node->num_outputs() == 2) {
@@ -1373,7 +2021,7 @@ embedding_bag(const XLATensorPtr& weight, const XLATensorPtr& indices,
               const XLATensorPtr& offsets, int64_t mode,
               const XLATensorPtr& per_sample_weights,
               bool include_last_offset) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<EmbeddingBag>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<EmbeddingBag>(
       weight->GetIrValue(), indices->GetIrValue(), offsets->GetIrValue(), mode,
       per_sample_weights->GetIrValue(), include_last_offset);
   return std::make_tuple(weight->CreateFrom(torch::lazy::Value(node, 0)),
@@ -1388,7 +2036,7 @@ XLATensorPtr exp(const XLATensorPtr& input) {
 
 XLATensorPtr expand(const XLATensorPtr& input, std::vector<int64_t> size) {
   auto input_shape = input->shape();
-  auto output = input->CreateFrom(torch::lazy::MakeNode<Expand>(
+  auto output = input->CreateFrom(torch_xla::MakeNode<Expand>(
       input->GetIrValue(),
       GetExpandDimensions(input_shape.get(), std::move(size))));
   output->SetStorage(input->Storage());
@@ -1399,14 +2047,14 @@ XLATensorPtr expand_symint(const XLATensorPtr& input,
                            c10::SymIntArrayRef sym_size) {
   SymIntElements size_elements = SymIntElements(sym_size);
   XLATensorPtr output = input->CreateFrom(
-      torch::lazy::MakeNode<ExpandSymInt>(input->GetIrValue(), size_elements));
+      torch_xla::MakeNode<ExpandSymInt>(input->GetIrValue(), size_elements));
   output->SetStorage(input->Storage());
   return output;
 }
 
 void exponential_(XLATensorPtr& input, double lambd) {
   auto input_shape = input->shape();
-  input->SetInPlaceIrValue(torch::lazy::MakeNode<Exponential>(
+  input->SetInPlaceIrValue(torch_xla::MakeNode<Exponential>(
       XLAGraphExecutor::Get()->GetIrValueForScalar(
           lambd, input_shape.get().element_type(), input->GetDevice()),
       XLAGraphExecutor::Get()->GetRngSeed(input->GetDevice()),
@@ -1447,7 +2095,7 @@ XLATensorPtr flip(const XLATensorPtr& input, absl::Span<const int64_t> dims) {
   std::set<int64_t> unique_dims(dimensions.begin(), dimensions.end());
   XLA_CHECK_EQ(unique_dims.size(), dimensions.size());
   return input->CreateFrom(
-      torch::lazy::MakeNode<Flip>(input->GetIrValue(), dimensions));
+      torch_xla::MakeNode<Flip>(input->GetIrValue(), dimensions));
 }
 
 XLATensorPtr fmod(const XLATensorPtr& input, const XLATensorPtr& other,
@@ -1523,7 +2171,7 @@ XLATensorPtr gather(const XLATensorPtr& input, int64_t dim,
       XLA_CHECK_LE(index->size(dim), input->size(dim));
     }
   }
-  return input->CreateFrom(torch::lazy::MakeNode<Gather>(
+  return input->CreateFrom(torch_xla::MakeNode<Gather>(
       input->GetIrValue(), canonical_dim, index->GetIrValue()));
 }
 
@@ -1639,14 +2287,14 @@ void index_put_(XLATensorPtr& input, const XLATensorPtr& canonical_base,
 XLATensorPtr index_select(const XLATensorPtr& input, int64_t dim,
                           const XLATensorPtr& index) {
   torch::lazy::Value index_value = EnsureRank1(index->GetIrValue());
-  return input->CreateFrom(torch::lazy::MakeNode<IndexSelect>(
+  return input->CreateFrom(torch_xla::MakeNode<IndexSelect>(
       input->GetIrValue(),
       torch::lazy::GetCanonicalDimensionIndex(dim, input->shape().get().rank()),
       index_value));
 }
 
 XLATensorPtr isnan(const XLATensorPtr& input) {
-  torch::lazy::Value result = torch::lazy::MakeNode<Isnan>(input->GetIrValue());
+  torch::lazy::Value result = torch_xla::MakeNode<Isnan>(input->GetIrValue());
   torch::lazy::Value casted = GetBooleanIrValue(result);
   return input->CreateFrom(casted, at::ScalarType::Bool);
 }
@@ -1654,7 +2302,7 @@ XLATensorPtr isnan(const XLATensorPtr& input) {
 std::tuple<XLATensorPtr, XLATensorPtr> kthvalue(const XLATensorPtr& input,
                                                 int64_t k, int64_t dim,
                                                 bool keepdim) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<KthValue>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<KthValue>(
       input->GetIrValue(), k,
       torch::lazy::GetCanonicalDimensionIndex(dim, input->shape().get().rank()),
       keepdim);
@@ -1675,7 +2323,7 @@ XLATensorPtr hardtanh_backward(const XLATensorPtr& grad_output,
                                const XLATensorPtr& input,
                                const at::Scalar& min_val,
                                const at::Scalar& max_val) {
-  return grad_output->CreateFrom(torch::lazy::MakeNode<HardtanhBackward>(
+  return grad_output->CreateFrom(torch_xla::MakeNode<HardtanhBackward>(
       grad_output->GetIrValue(), input->GetIrValue(), min_val, max_val));
 }
 
@@ -1714,7 +2362,7 @@ XLATensorPtr linalg_vector_norm(const XLATensorPtr& input,
   xla::PrimitiveType res_intended_type =
       MakeXlaPrimitiveType(*dtype, &input->GetDevice());
   if (GetXlaShape(res).element_type() != res_intended_type) {
-    res = torch::lazy::MakeNode<Cast>(res, res_intended_type);
+    res = torch_xla::MakeNode<Cast>(res, res_intended_type);
   }
   return input->CreateFrom(res, dtype);
 }
@@ -1727,7 +2375,7 @@ XLATensorPtr linspace(const at::Scalar& start, const at::Scalar& end,
   torch::lazy::Value end_val = XLAGraphExecutor::Get()->GetIrValueForScalar(
       end, xla::PrimitiveType::F32, device);
   return XLATensor::Create(
-      torch::lazy::MakeNode<Linspace>(start_val, end_val, steps), device,
+      torch_xla::MakeNode<Linspace>(start_val, end_val, steps), device,
       element_type);
 }
 
@@ -1773,7 +2421,7 @@ XLATensorPtr log_softmax(const XLATensorPtr& input, int64_t dim,
     dtype = input->dtype_optional();
   }
   return input->CreateFrom(
-      torch::lazy::MakeNode<LogSoftmax>(input->GetIrValue(),
+      torch_xla::MakeNode<LogSoftmax>(input->GetIrValue(),
                                         torch::lazy::GetCanonicalDimensionIndex(
                                             dim, input->shape().get().rank()),
                                         dtype, std::move(shapes)),
@@ -1802,7 +2450,7 @@ void log1p_(XLATensorPtr& input) {
 XLATensorPtr logsumexp(const XLATensorPtr& input,
                        std::vector<int64_t> dimensions,
                        bool keep_reduced_dimensions) {
-  return input->CreateFrom(torch::lazy::MakeNode<Logsumexp>(
+  return input->CreateFrom(torch_xla::MakeNode<Logsumexp>(
       input->GetIrValue(),
       torch::lazy::GetCanonicalDimensionIndices(
           torch_xla::runtime::util::ToVector<int64_t>(dimensions),
@@ -1831,7 +2479,7 @@ XLATensorPtr lt(const XLATensorPtr& input, const XLATensorPtr& other) {
 
 XLATensorPtr mark_tensor(const XLATensorPtr& input, const std::string& info) {
   torch::lazy::NodePtr node =
-      torch::lazy::MakeNode<MarkTensor>(input->GetIrValue(), info);
+      torch_xla::MakeNode<MarkTensor>(input->GetIrValue(), info);
   return input->CreateFrom(torch::lazy::Value(node));
 }
 
@@ -1847,18 +2495,30 @@ XLATensorPtr masked_scatter(XLATensorPtr& input, const XLATensorPtr& mask,
   if (input->shape().get().dimensions() < mask->shape().get().dimensions()) {
     input_value = MaybeExpand(input->GetIrValue(), mask->shape());
   }
-  return input->CreateFrom(torch::lazy::MakeNode<MaskedScatter>(
+  return input->CreateFrom(torch_xla::MakeNode<MaskedScatter>(
       input_value, MaybeExpand(mask->GetIrValue(), GetXlaShape(input_value)),
       source->GetIrValue()));
 }
 
 XLATensorPtr masked_select(const XLATensorPtr& input,
                            const XLATensorPtr& mask) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<MaskedSelect>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<MaskedSelect>(
       input->GetIrValue(), mask->GetIrValue());
   return input->CreateFrom(torch::lazy::Value(node, 0));
 }
 
+std::pair<XLATensorPtr, XLATensorPtr> masked_select_static(
+    const XLATensorPtr& input, const XLATensorPtr& mask, int64_t size,
+    const at::Scalar& fill_value) {
+  torch::lazy::Value fill = XLAGraphExecutor::Get()->GetIrValueForScalar(
+      fill_value, input->shape().get().element_type(), input->GetDevice());
+  torch::lazy::NodePtr node = torch_xla::MakeNode<MaskedSelectStatic>(
+      input->GetIrValue(), mask->GetIrValue(), fill, size);
+  return {input->CreateFrom(torch::lazy::Value(node, 0)),
+          XLATensor::Create(torch::lazy::Value(node, 1), input->GetDevice(),
+                            at::ScalarType::Long)};
+}
+
 XLATensorPtr matmul(const XLATensorPtr& input, const XLATensorPtr& other) {
   return input->CreateFrom(MatMul(input->GetIrValue(), other->GetIrValue()));
 }
@@ -1871,7 +2531,7 @@ std::tuple<XLATensorPtr, XLATensorPtr> max(const XLATensorPtr& input,
                                            int64_t dim, bool keepdim) {
   int64_t canonical_dim =
       torch::lazy::GetCanonicalDimensionIndex(dim, input->shape().get().rank());
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<MaxInDim>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<MaxInDim>(
       input->GetIrValue(), canonical_dim, keepdim);
   return std::make_tuple(
       input->CreateFrom(torch::lazy::Value(node, 0)),
@@ -1882,7 +2542,7 @@ void max_out(XLATensorPtr& max, XLATensorPtr& max_values,
              const XLATensorPtr& input, int64_t dim, bool keepdim) {
   int64_t canonical_dim =
       torch::lazy::GetCanonicalDimensionIndex(dim, input->shape().get().rank());
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<MaxInDim>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<MaxInDim>(
       input->GetIrValue(), canonical_dim, keepdim);
   max->SetIrValue(torch::lazy::Value(node, 0));
   max_values->SetIrValue(torch::lazy::Value(node, 1));
@@ -1895,7 +2555,7 @@ std::tuple<XLATensorPtr, XLATensorPtr> max_pool_nd(
   kernel_size = CheckIntList(kernel_size, spatial_dim_count, "kernel_size");
   stride = CheckIntList(stride, spatial_dim_count, "stride", kernel_size);
   padding = CheckIntList(padding, spatial_dim_count, "padding");
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<MaxPoolNd>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<MaxPoolNd>(
       input->GetIrValue(), spatial_dim_count, std::move(kernel_size),
       std::move(stride), std::move(padding), ceil_mode);
   return std::make_tuple(
@@ -1910,7 +2570,7 @@ XLATensorPtr max_pool_nd_backward(
   kernel_size = CheckIntList(kernel_size, spatial_dim_count, "kernel_size");
   stride = CheckIntList(stride, spatial_dim_count, "stride", kernel_size);
   padding = CheckIntList(padding, spatial_dim_count, "padding");
-  return out_backprop->CreateFrom(torch::lazy::MakeNode<MaxPoolNdBackward>(
+  return out_backprop->CreateFrom(torch_xla::MakeNode<MaxPoolNdBackward>(
       out_backprop->GetIrValue(), input->GetIrValue(), spatial_dim_count,
       std::move(kernel_size), std::move(stride), std::move(padding),
       ceil_mode));
@@ -1918,7 +2578,7 @@ XLATensorPtr max_pool_nd_backward(
 
 XLATensorPtr max_unpool(const XLATensorPtr& input, const XLATensorPtr& indices,
                         std::vector<int64_t> output_size) {
-  return input->CreateFrom(torch::lazy::MakeNode<MaxUnpoolNd>(
+  return input->CreateFrom(torch_xla::MakeNode<MaxUnpoolNd>(
       input->GetIrValue(), indices->GetIrValue(), std::move(output_size)));
 }
 
@@ -1929,7 +2589,7 @@ XLATensorPtr mean(const XLATensorPtr& input, std::vector<int64_t> dimensions,
     dtype = input->dtype_optional();
   }
   return input->CreateFrom(
-      torch::lazy::MakeNode<Mean>(
+      torch_xla::MakeNode<Mean>(
           input->GetIrValue(),
           torch::lazy::GetCanonicalDimensionIndices(
               torch_xla::runtime::util::ToVector<int64_t>(dimensions),
@@ -1952,7 +2612,7 @@ std::tuple<XLATensorPtr, XLATensorPtr> min(const XLATensorPtr& input,
                                            int64_t dim, bool keepdim) {
   int64_t canonical_dim =
       torch::lazy::GetCanonicalDimensionIndex(dim, input->shape().get().rank());
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<MinInDim>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<MinInDim>(
       input->GetIrValue(), canonical_dim, keepdim);
   return std::make_tuple(
       input->CreateFrom(torch::lazy::Value(node, 0)),
@@ -1963,7 +2623,7 @@ void min_out(XLATensorPtr& min, XLATensorPtr& min_indices,
              const XLATensorPtr& input, int64_t dim, bool keepdim) {
   int64_t canonical_dim =
       torch::lazy::GetCanonicalDimensionIndex(dim, input->shape().get().rank());
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<MinInDim>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<MinInDim>(
       input->GetIrValue(), canonical_dim, keepdim);
   min->SetIrValue(torch::lazy::Value(node, 0));
   min_indices->SetIrValue(torch::lazy::Value(node, 1));
@@ -1972,7 +2632,7 @@ void min_out(XLATensorPtr& min, XLATensorPtr& min_indices,
 XLATensorPtr mish(const XLATensorPtr& input) {
   return input->CreateFrom(
       input->GetIrValue() *
-      torch::lazy::MakeNode<Tanh>(
+      torch_xla::MakeNode<Tanh>(
           tensor_ops::Softplus(input, 1, 20)->GetIrValue()));
 }
 
@@ -1987,7 +2647,7 @@ XLATensorPtr mse_loss(const XLATensorPtr& input, const XLATensorPtr& target,
   // case of mse_loss(long, float16) -> float16, we want to derive the dtype
   // from IR value instead of input's logical_element_type.
   return input->CreateFrom(
-      torch::lazy::MakeNode<MseLoss>(input->GetIrValue(), target->GetIrValue(),
+      torch_xla::MakeNode<MseLoss>(input->GetIrValue(), target->GetIrValue(),
                                      GetXlaReductionMode(reduction)),
       c10::nullopt);
 }
@@ -1995,7 +2655,7 @@ XLATensorPtr mse_loss(const XLATensorPtr& input, const XLATensorPtr& target,
 XLATensorPtr mse_loss_backward(const XLATensorPtr& grad_output,
                                const XLATensorPtr& input,
                                const XLATensorPtr& target, int64_t reduction) {
-  return input->CreateFrom(torch::lazy::MakeNode<MseLossBackward>(
+  return input->CreateFrom(torch_xla::MakeNode<MseLossBackward>(
       grad_output->GetIrValue(), input->GetIrValue(), target->GetIrValue(),
       GetXlaReductionMode(reduction)));
 }
@@ -2022,7 +2682,7 @@ XLATensorPtr multinomial(const XLATensorPtr& input, int64_t num_samples,
                          bool replacement) {
   auto input_shape = input->shape();
   return input->CreateFrom(
-      torch::lazy::MakeNode<Multinomial>(
+      torch_xla::MakeNode<Multinomial>(
           input->GetIrValue(),
           XLAGraphExecutor::Get()->GetRngSeed(input->GetDevice()), num_samples,
           replacement),
@@ -2077,7 +2737,12 @@ XLATensorPtr narrow(const XLATensorPtr& input, int64_t dim, int64_t start,
     return input->CreateViewTensor(std::move(view_info));
   }
 
-  return input->CreateFrom(torch::lazy::MakeNode<GenericSlice>(
+  std::optional<torch::lazy::Value> operands =
+      SliceOfCat(input, dim, indices[dim], indices[dim] + length);
+  if (operands) {
+    return input->CreateFrom(*operands);
+  }
+  return input->CreateFrom(torch_xla::MakeNode<GenericSlice>(
       input->GetIrValue(), std::move(indices), narrow_shape.dimensions()));
 }
 
@@ -2094,7 +2759,7 @@ std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> native_batch_norm(
       GetIrValueOrDefault(running_mean, 0, features_shape, input->GetDevice());
   torch::lazy::Value running_var_value =
       GetIrValueOrDefault(running_var, 0, features_shape, input->GetDevice());
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<NativeBatchNormForward>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<NativeBatchNormForward>(
       input->GetIrValue(), weight_value, bias_value, running_mean_value,
       running_var_value, training, eps);
   XLATensorPtr output = input->CreateFrom(torch::lazy::Value(node, 0));
@@ -2104,11 +2769,11 @@ std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> native_batch_norm(
     mean = input->CreateFrom(torch::lazy::Value(node, 1));
     variance_inverse = input->CreateFrom(torch::lazy::Value(node, 3));
     if (running_mean) {
-      running_mean->SetIrValue(torch::lazy::MakeNode<LinearInterpolation>(
+      running_mean->SetIrValue(torch_xla::MakeNode<LinearInterpolation>(
           mean->GetIrValue(), running_mean->GetIrValue(), momentum));
     }
     if (running_var) {
-      running_var->SetIrValue(torch::lazy::MakeNode<LinearInterpolation>(
+      running_var->SetIrValue(torch_xla::MakeNode<LinearInterpolation>(
           torch::lazy::Value(node, 2), running_var->GetIrValue(), momentum));
     }
   } else {
@@ -2127,7 +2792,7 @@ std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> native_batch_norm_backward(
   xla::Shape features_shape = BatchNormFeaturesShape(input);
   torch::lazy::Value weight_value =
       GetIrValueOrDefault(weight, 1, features_shape, input->GetDevice());
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<NativeBatchNormBackward>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<NativeBatchNormBackward>(
       grad_out->GetIrValue(), input->GetIrValue(), weight_value,
       save_mean->GetIrValue(), save_invstd->GetIrValue(), training, eps);
   XLATensorPtr grad_input = input->CreateFrom(torch::lazy::Value(node, 0));
@@ -2139,7 +2804,7 @@ std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> native_batch_norm_backward(
 
 std::tuple<XLATensorPtr, XLATensorPtr> native_dropout(
     const XLATensorPtr& input, double p, c10::optional<bool> train) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<NativeDropout>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<NativeDropout>(
       input->GetIrValue(),
       XLAGraphExecutor::Get()->GetRngSeed(input->GetDevice()), p, train);
   return std::make_tuple(
@@ -2162,7 +2827,7 @@ XLATensorPtr neg(const XLATensorPtr& input) {
 XLATensorPtr nll_loss(const XLATensorPtr& input, const XLATensorPtr& target,
                       const XLATensorPtr& weight, int64_t reduction,
                       int ignore_index) {
-  return input->CreateFrom(torch::lazy::MakeNode<NllLoss>(
+  return input->CreateFrom(torch_xla::MakeNode<NllLoss>(
       input->GetIrValue(), target->GetIrValue(), GetOptionalIrValue(weight),
       GetXlaReductionMode(reduction), ignore_index));
 }
@@ -2170,7 +2835,7 @@ XLATensorPtr nll_loss(const XLATensorPtr& input, const XLATensorPtr& target,
 XLATensorPtr nll_loss2d(const XLATensorPtr& input, const XLATensorPtr& target,
                         const XLATensorPtr& weight, int64_t reduction,
                         int ignore_index) {
-  return input->CreateFrom(torch::lazy::MakeNode<NllLoss2d>(
+  return input->CreateFrom(torch_xla::MakeNode<NllLoss2d>(
       input->GetIrValue(), target->GetIrValue(), GetOptionalIrValue(weight),
       GetXlaReductionMode(reduction), ignore_index));
 }
@@ -2181,7 +2846,7 @@ XLATensorPtr nll_loss2d_backward(const XLATensorPtr& grad_output,
                                  const XLATensorPtr& weight, int64_t reduction,
                                  int ignore_index,
                                  const XLATensorPtr& total_weight) {
-  return input->CreateFrom(torch::lazy::MakeNode<NllLoss2dBackward>(
+  return input->CreateFrom(torch_xla::MakeNode<NllLoss2dBackward>(
       grad_output->GetIrValue(), input->GetIrValue(), target->GetIrValue(),
       GetOptionalIrValue(weight), GetOptionalIrValue(total_weight),
       GetXlaReductionMode(reduction), ignore_index));
@@ -2193,7 +2858,7 @@ XLATensorPtr nll_loss_backward(const XLATensorPtr& grad_output,
                                const XLATensorPtr& weight, int64_t reduction,
                                int ignore_index,
                                const XLATensorPtr& total_weight) {
-  return input->CreateFrom(torch::lazy::MakeNode<NllLossBackward>(
+  return input->CreateFrom(torch_xla::MakeNode<NllLossBackward>(
       grad_output->GetIrValue(), input->GetIrValue(), target->GetIrValue(),
       GetOptionalIrValue(weight), GetOptionalIrValue(total_weight),
       GetXlaReductionMode(reduction), ignore_index));
@@ -2202,21 +2867,49 @@ XLATensorPtr nll_loss_backward(const XLATensorPtr& grad_output,
 XLATensorPtr nms(const XLATensorPtr& boxes, const XLATensorPtr& scores,
                  double iou_threshold) {
   const torch::lazy::BackendDevice& device = boxes->GetDevice();
-  torch::lazy::NodePtr xla_iou_threshold =
-      ScalarOp(iou_threshold, MakeXlaPrimitiveType(at::kDouble, &device));
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<Nms>(
+  torch::lazy::Value xla_iou_threshold =
+      XLAGraphExecutor::Get()->GetIrValueForConstantScalar(
+          iou_threshold, MakeXlaPrimitiveType(at::kDouble, &device), device);
+  torch::lazy::NodePtr node = torch_xla::MakeNode<Nms>(
       boxes->GetIrValue(), scores->GetIrValue(), xla_iou_threshold);
   return XLATensor::Create(node, device, at::ScalarType::Long);
 }
 
+std::pair<XLATensorPtr, XLATensorPtr> batched_nms(const XLATensorPtr& boxes,
+                                                  const XLATensorPtr& scores,
+                                                  double iou_threshold,
+                                                  double score_threshold,
+                                                  int64_t max_output_size) {
+  const torch::lazy::BackendDevice& device = boxes->GetDevice();
+  torch::lazy::NodePtr node = torch_xla::MakeNode<BatchedNms>(
+      boxes->GetIrValue(), scores->GetIrValue(), iou_threshold,
+      score_threshold, max_output_size);
+  return {XLATensor::Create(torch::lazy::Value(node, 0), device,
+                            at::ScalarType::Long),
+          XLATensor::Create(torch::lazy::Value(node, 1), device,
+                            at::ScalarType::Long)};
+}
+
 XLATensorPtr nonzero(const XLATensorPtr& input) {
   torch::lazy::NodePtr node =
-      torch::lazy::MakeNode<NonZero>(input->GetIrValue());
+      torch_xla::MakeNode<NonZero>(input->GetIrValue());
   // Nonzero result type should not depend on input type, hence we shouldn't
   // use input->CreateFrom which will inherit the logical_element_type.
   return XLATensor::Create(torch::lazy::Value(node, 0), input->GetDevice());
 }
 
+std::pair<XLATensorPtr, XLATensorPtr> nonzero_static(const XLATensorPtr& input,
+                                                     int64_t size,
+                                                     int64_t fill_value) {
+  torch::lazy::NodePtr node =
+      torch_xla::MakeNode<NonZeroStatic>(input->GetIrValue(), size,
+                                           fill_value);
+  return {XLATensor::Create(torch::lazy::Value(node, 0), input->GetDevice(),
+                            at::ScalarType::Long),
+          XLATensor::Create(torch::lazy::Value(node, 1), input->GetDevice(),
+                            at::ScalarType::Long)};
+}
+
 XLATensorPtr norm(const XLATensorPtr& input, const c10::optional<at::Scalar>& p,
                   c10::optional<at::ScalarType> dtype, at::IntArrayRef dim,
                   bool keepdim) {
@@ -2230,7 +2923,7 @@ XLATensorPtr norm(const XLATensorPtr& input, const c10::optional<at::Scalar>& p,
 }
 
 XLATensorPtr normal(double mean, const XLATensorPtr& std) {
-  return std->CreateFrom(torch::lazy::MakeNode<Normal>(
+  return std->CreateFrom(torch_xla::MakeNode<Normal>(
       XLAGraphExecutor::Get()->GetIrValueForScalar(mean, std->shape(),
                                                    std->GetDevice()),
       std->GetIrValue(),
@@ -2238,7 +2931,7 @@ XLATensorPtr normal(double mean, const XLATensorPtr& std) {
 }
 
 XLATensorPtr normal(const XLATensorPtr& mean, double std) {
-  return mean->CreateFrom(torch::lazy::MakeNode<Normal>(
+  return mean->CreateFrom(torch_xla::MakeNode<Normal>(
       mean->GetIrValue(),
       XLAGraphExecutor::Get()->GetIrValueForScalar(std, mean->shape(),
                                                    mean->GetDevice()),
@@ -2246,13 +2939,13 @@ XLATensorPtr normal(const XLATensorPtr& mean, double std) {
 }
 
 XLATensorPtr normal(const XLATensorPtr& mean, const XLATensorPtr& std) {
-  return mean->CreateFrom(torch::lazy::MakeNode<Normal>(
+  return mean->CreateFrom(torch_xla::MakeNode<Normal>(
       mean->GetIrValue(), MaybeExpand(std->GetIrValue(), mean->shape()),
       XLAGraphExecutor::Get()->GetRngSeed(mean->GetDevice())));
 }
 
 void normal_(XLATensorPtr& input, double mean, double std) {
-  input->SetInPlaceIrValue(torch::lazy::MakeNode<Normal>(
+  input->SetInPlaceIrValue(torch_xla::MakeNode<Normal>(
       XLAGraphExecutor::Get()->GetIrValueForScalar(mean, input->shape(),
                                                    input->GetDevice()),
       XLAGraphExecutor::Get()->GetIrValueForScalar(std, input->shape(),
@@ -2262,7 +2955,7 @@ void normal_(XLATensorPtr& input, double mean, double std) {
 
 XLATensorPtr not_supported(std::string description, xla::Shape shape,
                            const torch::lazy::BackendDevice& device) {
-  return XLATensor::Create(torch::lazy::MakeNode<NotSupported>(
+  return XLATensor::Create(torch_xla::MakeNode<NotSupported>(
                                std::move(description), std::move(shape)),
                            device);
 }
@@ -2273,7 +2966,7 @@ void optimization_barrier_(std::vector<XLATensorPtr>& tensors) {
   for (XLATensorPtr& tensor : tensors) {
     irs.push_back(tensor->GetIrValue());
   }
-  torch::lazy::NodePtr result = torch::lazy::MakeNode<OptimizationBarrier>(irs);
+  torch::lazy::NodePtr result = torch_xla::MakeNode<OptimizationBarrier>(irs);
   for (int i = 0; i < tensors.size(); i++) {
     tensors[i]->SetInPlaceIrValue(torch::lazy::Value(result, i));
   }
@@ -2293,7 +2986,7 @@ XLATensorPtr permute(const XLATensorPtr& input,
   }
 
   return input->CreateFrom(
-      torch::lazy::MakeNode<Permute>(input->GetIrValue(), dimensions));
+      torch_xla::MakeNode<Permute>(input->GetIrValue(), dimensions));
 }
 
 XLATensorPtr pow(const XLATensorPtr& input, const at::Scalar& exponent,
@@ -2304,9 +2997,11 @@ XLATensorPtr pow(const XLATensorPtr& input, const at::Scalar& exponent,
       logical_element_type
           ? *logical_element_type
           : at::result_type(bridge::AtenFromXlaTensor(input), exponent);
+  const torch::lazy::BackendDevice& device = input->GetDevice();
   return input->CreateFrom(
       Pow(input->GetIrValue(),
-          ScalarOp(exponent, MakeXlaPrimitiveType(type, &input->GetDevice()))),
+          XLAGraphExecutor::Get()->GetIrValueForConstantScalar(
+              exponent, MakeXlaPrimitiveType(type, &device), device)),
       type);
 }
 
@@ -2327,8 +3022,10 @@ XLATensorPtr pow(const at::Scalar& input, const XLATensorPtr& exponent,
       logical_element_type
           ? *logical_element_type
           : at::result_type(input, bridge::AtenFromXlaTensor(exponent));
+  const torch::lazy::BackendDevice& device = exponent->GetDevice();
   return exponent->CreateFrom(
-      Pow(ScalarOp(input, MakeXlaPrimitiveType(type, &exponent->GetDevice())),
+      Pow(XLAGraphExecutor::Get()->GetIrValueForConstantScalar(
+              input, MakeXlaPrimitiveType(type, &device), device),
           exponent->GetIrValue()),
       type);
 }
@@ -2353,7 +3050,7 @@ XLATensorPtr prod(const XLATensorPtr& input, std::vector<int64_t> dimensions,
     dtype = input->dtype_optional();
   }
   return input->CreateFrom(
-      torch::lazy::MakeNode<Prod>(
+      torch_xla::MakeNode<Prod>(
           input->GetIrValue(),
           torch::lazy::GetCanonicalDimensionIndices(
               torch_xla::runtime::util::ToVector<int64_t>(dimensions),
@@ -2365,14 +3062,14 @@ XLATensorPtr prod(const XLATensorPtr& input, std::vector<int64_t> dimensions,
 void put_(XLATensorPtr& input, const XLATensorPtr& index,
           const XLATensorPtr& source, bool accumulate) {
   input->SetInPlaceIrValue(
-      torch::lazy::MakeNode<Put>(input->GetIrValue(), index->GetIrValue(),
+      torch_xla::MakeNode<Put>(input->GetIrValue(), index->GetIrValue(),
                                  source->GetIrValue(), accumulate));
 }
 
 std::tuple<XLATensorPtr, XLATensorPtr> qr(const XLATensorPtr& input,
                                           bool some) {
   torch::lazy::NodePtr node =
-      torch::lazy::MakeNode<QR>(input->GetIrValue(), some);
+      torch_xla::MakeNode<QR>(input->GetIrValue(), some);
   return std::make_tuple(input->CreateFrom(torch::lazy::Value(node, 0)),
                          input->CreateFrom(torch::lazy::Value(node, 1)));
 }
@@ -2382,7 +3079,7 @@ XLATensorPtr quantize_tensor(const XLATensorPtr& input,
                              const std::vector<int>& zero_point_list,
                              int quant_min, int quant_max,
                              const std::string& dtype, int axis) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<QuantizeTensor>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<QuantizeTensor>(
       input->GetIrValue(), scale_list, zero_point_list, quant_min, quant_max,
       dtype, axis);
   return input->CreateFrom(torch::lazy::Value(node));
@@ -2393,12 +3090,68 @@ XLATensorPtr dequantize_tensor(const XLATensorPtr& input,
                                const std::vector<int>& zero_point_list,
                                int quant_min, int quant_max,
                                const std::string& dtype, int axis) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<DequantizeTensor>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<DequantizeTensor>(
       input->GetIrValue(), scale_list, zero_point_list, quant_min, quant_max,
       dtype, axis);
   return input->CreateFrom(torch::lazy::Value(node));
 }
 
+XLATensorPtr quantized_matmul(const XLATensorPtr& input,
+                              const XLATensorPtr& weight,
+                              const XLATensorPtr& scale, int64_t block_size,
+                              bool int4_weight) {
+  xla::Shape input_shape = input->shape();
+  xla::Shape weight_shape = weight->shape();
+  XLA_CHECK_EQ(weight_shape.element_type(), xla::PrimitiveType::S8)
+      << "The quantized weight must be int8";
+  XLA_CHECK_EQ(weight_shape.rank(), 2) << "The quantized weight must be 2D";
+  int64_t in_channels = input_shape.dimensions(input_shape.rank() - 1);
+  int64_t out_channels = weight_shape.dimensions(0);
+  XLA_CHECK_EQ(weight_shape.dimensions(1) * (int4_weight ? 2 : 1),
+               in_channels)
+      << "The quantized weight " << weight_shape
+      << " does not match the input " << input_shape;
+  std::vector<int64_t> scale_dims = {out_channels};
+  if (block_size > 0) {
+    XLA_CHECK_EQ(in_channels % block_size, 0)
+        << "The in channels " << in_channels
+        << " are not a multiple of the block size " << block_size;
+    scale_dims.push_back(in_channels / block_size);
+  }
+  xla::Shape scale_shape = scale->shape();
+  XLA_CHECK(scale_shape.dimensions() == absl::Span<const int64_t>(scale_dims))
+      << "Expected the scale dimensions to be ["
+      << absl::StrJoin(scale_dims, ", ") << "], got " << scale_shape;
+  return input->CreateFrom(torch_xla::MakeNode<QuantizedMatmul>(
+      input->GetIrValue(), weight->GetIrValue(), scale->GetIrValue(),
+      block_size, int4_weight));
+}
+
+std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> fp8_scaled_mm(
+    const XLATensorPtr& a, const XLATensorPtr& b, const XLATensorPtr& a_scale,
+    const XLATensorPtr& b_scale, const std::string& a_format,
+    const std::string& b_format) {
+  auto fp8_type = [](const std::string& format) {
+    if (format == "e4m3") {
+      return xla::PrimitiveType::F8E4M3FN;
+    }
+    XLA_CHECK_EQ(format, "e5m2") << "Unsupported FP8 format: " << format;
+    return xla::PrimitiveType::F8E5M2;
+  };
+  xla::Shape a_shape = a->shape();
+  xla::Shape b_shape = b->shape();
+  XLA_CHECK(a_shape.rank() == 2 && b_shape.rank() == 2 &&
+            a_shape.dimensions(1) == b_shape.dimensions(0))
+      << "Cannot multiply " << a_shape << " by " << b_shape;
+  torch::lazy::NodePtr node = torch_xla::MakeNode<Fp8ScaledMm>(
+      a->GetIrValue(), b->GetIrValue(), a_scale->GetIrValue(),
+      b_scale->GetIrValue(), fp8_type(a_format), fp8_type(b_format));
+  return std::make_tuple(
+      a->CreateFrom(torch::lazy::Value(node, 0)),
+      a->CreateFrom(torch::lazy::Value(node, 1), at::ScalarType::Float),
+      a->CreateFrom(torch::lazy::Value(node, 2), at::ScalarType::Float));
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // Dynamic Reshape ops here.
 //////////////////////////////////////////////////////////////////////////////
@@ -2409,7 +3162,7 @@ XLATensorPtr dynamic_expand(const XLATensorPtr& input,
                             int target_dim) {
   std::vector<int64_t> expanded_size =
       GetExpandDimensions(input->shape().get(), size);
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<DynamicExpand>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<DynamicExpand>(
       input->GetIrValue(), expanded_size, src_tensor->GetIrValue(), src_dim,
       target_dim);
   return input->CreateFrom(torch::lazy::Value(node));
@@ -2425,7 +3178,7 @@ XLATensorPtr dynamic_view(const XLATensorPtr& input,
   xla::Shape shape =
       XlaHelpers::GetDynamicReshape(input_shape, complete_dimensions);
 
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<DynamicView>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<DynamicView>(
       input->GetIrValue(), torch::lazy::ToVector<int64_t>(shape.dimensions()),
       src_tensor->GetIrValue(), src_dim, target_dim, mul_scaler);
   return input->CreateFrom(torch::lazy::Value(node));
@@ -2436,7 +3189,7 @@ XLATensorPtr dynamic_view(const XLATensorPtr& input,
 void random_(XLATensorPtr& input, int64_t from, int64_t to) {
   XLA_CHECK_LE(from, to);
   auto input_shape = input->shape();
-  input->SetInPlaceIrValue(torch::lazy::MakeNode<DiscreteUniform>(
+  input->SetInPlaceIrValue(torch_xla::MakeNode<DiscreteUniform>(
       XLAGraphExecutor::Get()->GetIrValueForScalar(
           from, xla::PrimitiveType::S64, input->GetDevice()),
       XLAGraphExecutor::Get()->GetIrValueForScalar(to, xla::PrimitiveType::S64,
@@ -2448,7 +3201,7 @@ XLATensorPtr randperm(int64_t n, const torch::lazy::BackendDevice& device,
                       at::ScalarType scalar_type) {
   // These are all PyTorch defaults. PyTorch/XLA doesn't support non default
   // params here yet.
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<RandPerm>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<RandPerm>(
       n, at::ScalarType::Long, at::Layout::Strided, at::DeviceType::XLA,
       /*pin_memory=*/false);
   return XLATensor::Create(node, device, scalar_type);
@@ -2458,7 +3211,7 @@ XLATensorPtr reflection_pad1d(const XLATensorPtr& input,
                               std::vector<int64_t> padding) {
   // `ReflectionPad2d` is used due to `at::aten::reflection_pad2d_backward`
   // named already
-  return input->CreateFrom(torch::lazy::MakeNode<ReflectionPad2d>(
+  return input->CreateFrom(torch_xla::MakeNode<ReflectionPad2d>(
       input->GetIrValue(), std::move(padding)));
 }
 
@@ -2467,20 +3220,20 @@ XLATensorPtr reflection_pad1d_backward(const XLATensorPtr& grad_output,
                                        std::vector<int64_t> padding) {
   // `ReflectionPad2dBackward` is used due to
   // `at::aten::reflection_pad2d_backward` named already
-  return input->CreateFrom(torch::lazy::MakeNode<ReflectionPad2dBackward>(
+  return input->CreateFrom(torch_xla::MakeNode<ReflectionPad2dBackward>(
       grad_output->GetIrValue(), input->GetIrValue(), std::move(padding)));
 }
 
 XLATensorPtr reflection_pad2d(const XLATensorPtr& input,
                               std::vector<int64_t> padding) {
-  return input->CreateFrom(torch::lazy::MakeNode<ReflectionPad2d>(
+  return input->CreateFrom(torch_xla::MakeNode<ReflectionPad2d>(
       input->GetIrValue(), std::move(padding)));
 }
 
 XLATensorPtr reflection_pad2d_backward(const XLATensorPtr& grad_output,
                                        const XLATensorPtr& input,
                                        std::vector<int64_t> padding) {
-  return input->CreateFrom(torch::lazy::MakeNode<ReflectionPad2dBackward>(
+  return input->CreateFrom(torch_xla::MakeNode<ReflectionPad2dBackward>(
       grad_output->GetIrValue(), input->GetIrValue(), std::move(padding)));
 }
 
@@ -2488,7 +3241,7 @@ XLATensorPtr reflection_pad3d(const XLATensorPtr& input,
                               std::vector<int64_t> padding) {
   // `ReflectionPad2d` is used due to `at::aten::reflection_pad2d_backward`
   // named already
-  return input->CreateFrom(torch::lazy::MakeNode<ReflectionPad2d>(
+  return input->CreateFrom(torch_xla::MakeNode<ReflectionPad2d>(
       input->GetIrValue(), std::move(padding)));
 }
 
@@ -2497,7 +3250,7 @@ XLATensorPtr reflection_pad3d_backward(const XLATensorPtr& grad_output,
                                        std::vector<int64_t> padding) {
   // `ReflectionPad2dBackward` is used due to
   // `at::aten::reflection_pad2d_backward` named already
-  return input->CreateFrom(torch::lazy::MakeNode<ReflectionPad2dBackward>(
+  return input->CreateFrom(torch_xla::MakeNode<ReflectionPad2dBackward>(
       grad_output->GetIrValue(), input->GetIrValue(), std::move(padding)));
 }
 
@@ -2513,47 +3266,47 @@ XLATensorPtr remainder(const XLATensorPtr& input, const at::Scalar& other) {
 
 XLATensorPtr replication_pad1d(const XLATensorPtr& input,
                                std::vector<int64_t> padding) {
-  return input->CreateFrom(torch::lazy::MakeNode<ReplicationPad>(
+  return input->CreateFrom(torch_xla::MakeNode<ReplicationPad>(
       input->GetIrValue(), std::move(padding)));
 }
 
 XLATensorPtr replication_pad1d_backward(const XLATensorPtr& grad_output,
                                         const XLATensorPtr& input,
                                         std::vector<int64_t> padding) {
-  return input->CreateFrom(torch::lazy::MakeNode<ReplicationPadBackward>(
+  return input->CreateFrom(torch_xla::MakeNode<ReplicationPadBackward>(
       grad_output->GetIrValue(), input->GetIrValue(), std::move(padding)));
 }
 
 XLATensorPtr replication_pad2d(const XLATensorPtr& input,
                                std::vector<int64_t> padding) {
-  return input->CreateFrom(torch::lazy::MakeNode<ReplicationPad>(
+  return input->CreateFrom(torch_xla::MakeNode<ReplicationPad>(
       input->GetIrValue(), std::move(padding)));
 }
 
 XLATensorPtr replication_pad2d_backward(const XLATensorPtr& grad_output,
                                         const XLATensorPtr& input,
                                         std::vector<int64_t> padding) {
-  return input->CreateFrom(torch::lazy::MakeNode<ReplicationPadBackward>(
+  return input->CreateFrom(torch_xla::MakeNode<ReplicationPadBackward>(
       grad_output->GetIrValue(), input->GetIrValue(), std::move(padding)));
 }
 
 XLATensorPtr replication_pad3d(const XLATensorPtr& input,
                                std::vector<int64_t> padding) {
-  return input->CreateFrom(torch::lazy::MakeNode<ReplicationPad>(
+  return input->CreateFrom(torch_xla::MakeNode<ReplicationPad>(
       input->GetIrValue(), std::move(padding)));
 }
 
 XLATensorPtr replication_pad3d_backward(const XLATensorPtr& grad_output,
                                         const XLATensorPtr& input,
                                         std::vector<int64_t> padding) {
-  return input->CreateFrom(torch::lazy::MakeNode<ReplicationPadBackward>(
+  return input->CreateFrom(torch_xla::MakeNode<ReplicationPadBackward>(
       grad_output->GetIrValue(), input->GetIrValue(), std::move(padding)));
 }
 
 void resize_(XLATensorPtr& input, std::vector<int64_t> size) {
   if (input->data()->view == nullptr) {
     input->SetIrValue(
-        torch::lazy::MakeNode<Resize>(input->GetIrValue(), std::move(size)));
+        torch_xla::MakeNode<Resize>(input->GetIrValue(), std::move(size)));
   } else {
     auto input_shape = input->shape();
     xla::Shape resize_shape =
@@ -2574,7 +3327,7 @@ XLATensorPtr roll(const XLATensorPtr& input, absl::Span<const int64_t> shifts,
   }
   auto canonical_dims = torch::lazy::GetCanonicalDimensionIndices(
       torch::lazy::ToVector<int64_t>(dims), input->shape().get().rank());
-  return input->CreateFrom(torch::lazy::MakeNode<Roll>(
+  return input->CreateFrom(torch_xla::MakeNode<Roll>(
       input->GetIrValue(), torch::lazy::ToVector<int64_t>(shifts),
       canonical_dims));
 }
@@ -2582,7 +3335,7 @@ XLATensorPtr roll(const XLATensorPtr& input, absl::Span<const int64_t> shifts,
 XLATensorPtr rrelu_with_noise(const XLATensorPtr& input, XLATensorPtr& noise,
                               const at::Scalar& lower, const at::Scalar& upper,
                               bool training) {
-  torch::lazy::NodePtr output_node = torch::lazy::MakeNode<RreluWithNoise>(
+  torch::lazy::NodePtr output_node = torch_xla::MakeNode<RreluWithNoise>(
       input->GetIrValue(),
       XLAGraphExecutor::Get()->GetRngSeed(input->GetDevice()), lower, upper,
       training);
@@ -2595,7 +3348,7 @@ XLATensorPtr rrelu_with_noise_backward(const XLATensorPtr& grad_output,
                                        const XLATensorPtr& noise,
                                        const at::Scalar& lower,
                                        const at::Scalar& upper, bool training) {
-  return grad_output->CreateFrom(torch::lazy::MakeNode<RreluWithNoiseBackward>(
+  return grad_output->CreateFrom(torch_xla::MakeNode<RreluWithNoiseBackward>(
       grad_output->GetIrValue(), input->GetIrValue(), noise->GetIrValue(),
       lower, upper, training));
 }
@@ -2640,7 +3393,7 @@ void copy_(XLATensorPtr& input, XLATensorPtr& src) {
     if (input->dtype() == src->dtype()) {
       copy_value = src->GetIrValue();
     } else {
-      copy_value = torch::lazy::MakeNode<Cast>(src->GetIrValue(),
+      copy_value = torch_xla::MakeNode<Cast>(src->GetIrValue(),
                                                input->dtype(), src->dtype());
     }
     input->SetIrValue(MaybeExpand(copy_value, input->shape()));
@@ -2663,7 +3416,7 @@ void copy_(XLATensorPtr& input, XLATensorPtr& src) {
 
 XLATensorPtr scatter(const XLATensorPtr& input, int64_t dim,
                      const XLATensorPtr& index, const XLATensorPtr& src) {
-  return input->CreateFrom(torch::lazy::MakeNode<Scatter>(
+  return input->CreateFrom(torch_xla::MakeNode<Scatter>(
       input->GetIrValue(), index->GetIrValue(), src->GetIrValue(),
       torch::lazy::GetCanonicalDimensionIndex(dim,
                                               input->shape().get().rank())));
@@ -2673,7 +3426,7 @@ XLATensorPtr scatter(const XLATensorPtr& input, int64_t dim,
                      const XLATensorPtr& index, const at::Scalar& value) {
   torch::lazy::Value constant = XLAGraphExecutor::Get()->GetIrValueForScalar(
       value, input->shape(), input->GetDevice());
-  return input->CreateFrom(torch::lazy::MakeNode<Scatter>(
+  return input->CreateFrom(torch_xla::MakeNode<Scatter>(
       input->GetIrValue(), index->GetIrValue(), constant,
       torch::lazy::GetCanonicalDimensionIndex(dim,
                                               input->shape().get().rank())));
@@ -2681,7 +3434,7 @@ XLATensorPtr scatter(const XLATensorPtr& input, int64_t dim,
 
 XLATensorPtr scatter_add(const XLATensorPtr& input, int64_t dim,
                          const XLATensorPtr& index, const XLATensorPtr& src) {
-  return input->CreateFrom(torch::lazy::MakeNode<ScatterAdd>(
+  return input->CreateFrom(torch_xla::MakeNode<ScatterAdd>(
       input->GetIrValue(), index->GetIrValue(), src->GetIrValue(),
       torch::lazy::GetCanonicalDimensionIndex(dim,
                                               input->shape().get().rank())));
@@ -2691,7 +3444,7 @@ XLATensorPtr scatter_add(const XLATensorPtr& input, int64_t dim,
                          const XLATensorPtr& index, const at::Scalar& value) {
   torch::lazy::Value constant = XLAGraphExecutor::Get()->GetIrValueForScalar(
       value, input->shape(), input->GetDevice());
-  return input->CreateFrom(torch::lazy::MakeNode<ScatterAdd>(
+  return input->CreateFrom(torch_xla::MakeNode<ScatterAdd>(
       input->GetIrValue(), index->GetIrValue(), constant,
       torch::lazy::GetCanonicalDimensionIndex(dim,
                                               input->shape().get().rank())));
@@ -2700,7 +3453,7 @@ XLATensorPtr scatter_add(const XLATensorPtr& input, int64_t dim,
 XLATensorPtr scatter_reduce(const XLATensorPtr& input, int64_t dim,
                             const XLATensorPtr& index, const XLATensorPtr& src,
                             c10::string_view reduce, bool include_self) {
-  return input->CreateFrom(torch::lazy::MakeNode<ScatterReduce>(
+  return input->CreateFrom(torch_xla::MakeNode<ScatterReduce>(
       input->GetIrValue(), index->GetIrValue(), src->GetIrValue(), reduce,
       include_self,
       torch::lazy::GetCanonicalDimensionIndex(dim,
@@ -2708,6 +3461,16 @@ XLATensorPtr scatter_reduce(const XLATensorPtr& input, int64_t dim,
 }
 
 XLATensorPtr select(const XLATensorPtr& input, int64_t dim, int64_t index) {
+  int64_t rank = input->shape().get().rank();
+  int64_t canonical_dim = torch::lazy::GetCanonicalDimensionIndex(dim, rank);
+  int64_t size = input->size(canonical_dim);
+  if (index >= -size && index < size) {
+    std::optional<torch::lazy::Value> operand = SelectOfStack(
+        input, canonical_dim, index < 0 ? index + size : index);
+    if (operand) {
+      return input->CreateFrom(*operand);
+    }
+  }
   return tensor_ops::Select(input, dim, index);
 }
 
@@ -2735,7 +3498,7 @@ XLATensorPtr slice(const XLATensorPtr& input, int64_t dim, int64_t start,
     // `GetCanonicalDimensionIndex` doesn't support case where dim size = 0.
     // So we add a special handling in torch_xla.
     return input->CreateFrom(
-        torch::lazy::MakeNode<Select>(input->GetIrValue(), dim, 0, 0, step));
+        torch_xla::MakeNode<Select>(input->GetIrValue(), dim, 0, 0, step));
   }
   start = torch::lazy::GetCanonicalPosition(input_dims, dim, start);
   end = torch::lazy::GetCanonicalPosition(input_dims, dim, end);
@@ -2751,7 +3514,14 @@ XLATensorPtr slice(const XLATensorPtr& input, int64_t dim, int64_t start,
     ViewInfo view_info(ViewInfo::Type::kSelect, input_shape, std::move(select));
     return input->CreateViewTensor(std::move(view_info));
   }
-  return input->CreateFrom(torch::lazy::MakeNode<Select>(
+  if (step == 1) {
+    std::optional<torch::lazy::Value> operands =
+        SliceOfCat(input, dim, start, end);
+    if (operands) {
+      return input->CreateFrom(*operands);
+    }
+  }
+  return input->CreateFrom(torch_xla::MakeNode<Select>(
       input->GetIrValue(), dim, start, end, step));
 }
 
@@ -2782,7 +3552,7 @@ XLATensorPtr softmax(const XLATensorPtr& input, int64_t dim,
     dtype = input->dtype_optional();
   }
   return input->CreateFrom(
-      torch::lazy::MakeNode<Softmax>(input->GetIrValue(),
+      torch_xla::MakeNode<Softmax>(input->GetIrValue(),
                                      torch::lazy::GetCanonicalDimensionIndex(
                                          dim, input->shape().get().rank()),
                                      dtype),
@@ -2824,15 +3594,13 @@ std::vector<XLATensorPtr> split(const XLATensorPtr& input, int64_t split_size,
     // no matter what split_size is.
     xla::Literal literal(input_shape.get());
     return {
-        input->CreateFrom(torch::lazy::MakeNode<Constant>(std::move(literal)))};
+        input->CreateFrom(torch_xla::MakeNode<Constant>(std::move(literal)))};
   }
   std::vector<int64_t> split_sizes;
   for (; dim_size > 0; dim_size -= split_size) {
     split_sizes.push_back(std::min<int64_t>(dim_size, split_size));
   }
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<Split>(
-      input->GetIrValue(), std::move(split_sizes), split_dim);
-  return input->MakeOutputTensors(node);
+  return split_with_sizes(input, std::move(split_sizes), split_dim);
 }
 
 std::vector<XLATensorPtr> split_with_sizes(const XLATensorPtr& input,
@@ -2841,7 +3609,22 @@ std::vector<XLATensorPtr> split_with_sizes(const XLATensorPtr& input,
   auto input_shape = input->shape();
   int split_dim =
       torch::lazy::GetCanonicalDimensionIndex(dim, input_shape.get().rank());
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<Split>(
+  // The splits falling on the inputs of a cat take them rather than the cat.
+  std::vector<XLATensorPtr> splits;
+  int64_t start = 0;
+  for (int64_t size : split_size) {
+    std::optional<torch::lazy::Value> operands =
+        SliceOfCat(input, split_dim, start, start + size);
+    if (!operands) {
+      break;
+    }
+    splits.push_back(input->CreateFrom(*operands));
+    start += size;
+  }
+  if (splits.size() == split_size.size()) {
+    return splits;
+  }
+  torch::lazy::NodePtr node = torch_xla::MakeNode<Split>(
       input->GetIrValue(), std::move(split_size), split_dim);
   return input->MakeOutputTensors(node);
 }
@@ -2890,12 +3673,12 @@ XLATensorPtr stack(absl::Span<const XLATensorPtr> tensors, int64_t dim) {
   int64_t canonical_dim = torch::lazy::GetCanonicalDimensionIndex(
       dim, tensors.front()->shape().get().rank() + 1);
   return tensors[0]->CreateFrom(
-      torch::lazy::MakeNode<Stack>(values, canonical_dim));
+      torch_xla::MakeNode<Stack>(values, canonical_dim));
 }
 
 XLATensorPtr std(const XLATensorPtr& input, std::vector<int64_t> dimensions,
                  bool keep_reduced_dimensions, double correction) {
-  return input->CreateFrom(torch::lazy::MakeNode<Std>(
+  return input->CreateFrom(torch_xla::MakeNode<Std>(
       input->GetIrValue(),
       torch::lazy::GetCanonicalDimensionIndices(
           torch_xla::runtime::util::ToVector<int64_t>(dimensions),
@@ -2907,7 +3690,7 @@ std::tuple<XLATensorPtr, XLATensorPtr> std_mean(const XLATensorPtr& input,
                                                 std::vector<int64_t> dimensions,
                                                 double correction,
                                                 bool keep_reduced_dimensions) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<StdMean>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<StdMean>(
       input->GetIrValue(),
       torch::lazy::GetCanonicalDimensionIndices(
           torch_xla::runtime::util::ToVector<int64_t>(dimensions),
@@ -2965,7 +3748,7 @@ XLATensorPtr sum(const XLATensorPtr& input, std::vector<int64_t> dimensions,
     dtype = input->dtype_optional();
   }
   return input->CreateFrom(
-      torch::lazy::MakeNode<Sum>(
+      torch_xla::MakeNode<Sum>(
           input->GetIrValue(),
           torch::lazy::GetCanonicalDimensionIndices(
               torch_xla::runtime::util::ToVector<int64_t>(dimensions),
@@ -2977,7 +3760,7 @@ XLATensorPtr sum(const XLATensorPtr& input, std::vector<int64_t> dimensions,
 std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> svd(
     const XLATensorPtr& input, bool some, bool compute_uv) {
   torch::lazy::NodePtr node =
-      torch::lazy::MakeNode<SVD>(input->GetIrValue(), some, compute_uv);
+      torch_xla::MakeNode<SVD>(input->GetIrValue(), some, compute_uv);
   return std::make_tuple(input->CreateFrom(torch::lazy::Value(node, 0)),
                          input->CreateFrom(torch::lazy::Value(node, 1)),
                          input->CreateFrom(torch::lazy::Value(node, 2)));
@@ -2991,12 +3774,12 @@ XLATensorPtr tanh_backward(const XLATensorPtr& grad_output,
 XLATensorPtr threshold(const XLATensorPtr& input, float threshold,
                        float value) {
   return input->CreateFrom(
-      torch::lazy::MakeNode<Threshold>(input->GetIrValue(), threshold, value));
+      torch_xla::MakeNode<Threshold>(input->GetIrValue(), threshold, value));
 }
 
 XLATensorPtr threshold_backward(const XLATensorPtr& grad_output,
                                 const XLATensorPtr& input, float threshold) {
-  return grad_output->CreateFrom(torch::lazy::MakeNode<ThresholdBackward>(
+  return grad_output->CreateFrom(torch_xla::MakeNode<ThresholdBackward>(
       grad_output->GetIrValue(), input->GetIrValue(), threshold));
 }
 
@@ -3025,7 +3808,7 @@ std::tuple<XLATensorPtr, XLATensorPtr> topk(const XLATensorPtr& input,
                                             int64_t k, int64_t dim,
                                             bool largest, bool sorted,
                                             bool stable) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<TopK>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<TopK>(
       input->GetIrValue(), k,
       torch::lazy::GetCanonicalDimensionIndex(dim, input->shape().get().rank()),
       largest, sorted, stable);
@@ -3073,7 +3856,7 @@ XLATensorPtr transpose(const XLATensorPtr& input, int64_t dim0, int64_t dim1) {
     std::vector<int64_t> permute_dims = torch::lazy::MakeTransposePermutation(
         /*dim0=*/dim0, /*dim1=*/dim1, /*rank=*/input_shape.get().rank());
     result = input->CreateFrom(
-        torch::lazy::MakeNode<Permute>(input->GetIrValue(), permute_dims));
+        torch_xla::MakeNode<Permute>(input->GetIrValue(), permute_dims));
   }
 
   return result;
@@ -3083,7 +3866,7 @@ std::tuple<XLATensorPtr, XLATensorPtr> triangular_solve(
     const XLATensorPtr& rhs, const XLATensorPtr& lhs, bool left_side,
     bool upper, bool transpose, bool unitriangular) {
   // TriangularSolve takes lower instead of upper, hence the negation.
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<TriangularSolve>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<TriangularSolve>(
       rhs->GetIrValue(), lhs->GetIrValue(), left_side, !upper, transpose,
       unitriangular);
   return std::make_tuple(rhs->CreateFrom(torch::lazy::Value(node, 0)),
@@ -3105,7 +3888,7 @@ std::vector<XLATensorPtr> unbind(const XLATensorPtr& input, int64_t dim) {
 void uniform_(XLATensorPtr& input, double from, double to) {
   XLA_CHECK_LE(from, to);
   auto input_shape = input->shape();
-  input->SetInPlaceIrValue(torch::lazy::MakeNode<Uniform>(
+  input->SetInPlaceIrValue(torch_xla::MakeNode<Uniform>(
       XLAGraphExecutor::Get()->GetIrValueForScalar(
           from, input_shape.get().element_type(), input->GetDevice()),
       XLAGraphExecutor::Get()->GetIrValueForScalar(
@@ -3126,13 +3909,13 @@ void unsqueeze_(XLATensorPtr& input, int64_t dim) {
   int squeeze_dim = torch::lazy::GetCanonicalDimensionIndex(
       dim, input->shape().get().rank() + 1);
   input->SetIrValue(
-      torch::lazy::MakeNode<Unsqueeze>(input->GetIrValue(), squeeze_dim));
+      torch_xla::MakeNode<Unsqueeze>(input->GetIrValue(), squeeze_dim));
 }
 
 XLATensorPtr upsample_bilinear2d(const XLATensorPtr& input,
                                  std::vector<int64_t> output_size,
                                  bool align_corners) {
-  return input->CreateFrom(torch::lazy::MakeNode<UpsampleBilinear>(
+  return input->CreateFrom(torch_xla::MakeNode<UpsampleBilinear>(
       input->GetIrValue(), std::move(output_size), align_corners));
 }
 
@@ -3141,21 +3924,21 @@ XLATensorPtr upsample_bilinear2d_backward(const XLATensorPtr& grad_output,
                                           std::vector<int64_t> input_size,
                                           bool align_corners) {
   return grad_output->CreateFrom(
-      torch::lazy::MakeNode<UpsampleBilinearBackward>(
+      torch_xla::MakeNode<UpsampleBilinearBackward>(
           grad_output->GetIrValue(), std::move(output_size),
           std::move(input_size), align_corners));
 }
 
 XLATensorPtr upsample_nearest2d(const XLATensorPtr& input,
                                 std::vector<int64_t> output_size) {
-  return input->CreateFrom(torch::lazy::MakeNode<UpsampleNearest>(
+  return input->CreateFrom(torch_xla::MakeNode<UpsampleNearest>(
       input->GetIrValue(), std::move(output_size)));
 }
 
 XLATensorPtr upsample_nearest2d_backward(const XLATensorPtr& grad_output,
                                          std::vector<int64_t> output_size,
                                          std::vector<int64_t> input_size) {
-  return grad_output->CreateFrom(torch::lazy::MakeNode<UpsampleNearestBackward>(
+  return grad_output->CreateFrom(torch_xla::MakeNode<UpsampleNearestBackward>(
       grad_output->GetIrValue(), std::move(output_size),
       std::move(input_size)));
 }
@@ -3184,7 +3967,7 @@ XLATensorPtr view(const XLATensorPtr& input,
     ViewInfo view_info(ViewInfo::Type::kReshape, std::move(shape), input_shape);
     return input->CreateViewTensor(std::move(view_info));
   }
-  return input->CreateFrom(torch::lazy::MakeNode<ViewOp>(
+  return input->CreateFrom(torch_xla::MakeNode<ViewOp>(
       input->GetIrValue(), torch::lazy::ToVector<int64_t>(shape.dimensions())));
 }
 
@@ -3204,7 +3987,7 @@ XLATensorPtr view_symint(const XLATensorPtr& input,
     return input->CreateViewTensor(std::move(view_info));
   }
   return input->CreateFrom(
-      torch::lazy::MakeNode<ViewOp>(input->GetIrValue(), result_shape));
+      torch_xla::MakeNode<ViewOp>(input->GetIrValue(), result_shape));
 }
 
 XLATensorPtr view_as_complex_copy(const XLATensorPtr& input) {
@@ -3219,7 +4002,7 @@ XLATensorPtr view_as_real_copy(const XLATensorPtr& input) {
 
 XLATensorPtr var(const XLATensorPtr& input, std::vector<int64_t> dimensions,
                  double correction, bool keep_reduced_dimensions) {
-  return input->CreateFrom(torch::lazy::MakeNode<Var>(
+  return input->CreateFrom(torch_xla::MakeNode<Var>(
       input->GetIrValue(),
       torch::lazy::GetCanonicalDimensionIndices(
           torch_xla::runtime::util::ToVector<int64_t>(dimensions),
@@ -3231,7 +4014,7 @@ std::tuple<XLATensorPtr, XLATensorPtr> var_mean(const XLATensorPtr& input,
                                                 std::vector<int64_t> dimensions,
                                                 double correction,
                                                 bool keep_reduced_dimensions) {
-  torch::lazy::NodePtr node = torch::lazy::MakeNode<VarMean>(
+  torch::lazy::NodePtr node = torch_xla::MakeNode<VarMean>(
       input->GetIrValue(),
       torch::lazy::GetCanonicalDimensionIndices(
           torch_xla::runtime::util::ToVector<int64_t>(dimensions),
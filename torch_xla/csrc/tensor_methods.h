@@ -54,6 +54,11 @@ std::pair<XLATensorPtr, torch::lazy::Value> all_to_all(
     int64_t split_dimension, int64_t concat_dimension, int64_t split_count,
     std::vector<std::vector<int64_t>> groups, bool pin_layout);
 
+std::pair<std::vector<XLATensorPtr>, torch::lazy::Value> all_to_all_coalesced(
+    const std::vector<XLATensorPtr>& inputs, const torch::lazy::Value& token,
+    int64_t split_dimension, int64_t concat_dimension, int64_t split_count,
+    std::vector<std::vector<int64_t>> groups, bool pin_layout);
+
 XLATensorPtr all_gather(const XLATensorPtr& input, int64_t dim,
                         int64_t shard_count,
                         std::vector<std::vector<int64_t>> groups,
@@ -76,10 +81,163 @@ torch::lazy::Value all_gather_coalesced_out(
     const torch::lazy::Value& token, int64_t dim, int64_t shard_count,
     std::vector<std::vector<int64_t>> groups, bool pin_layout);
 
+// Starts an all-gather of `input`, returning the state of the collective in
+// flight, for async_collective_done().
+torch::lazy::Value all_gather_start(const XLATensorPtr& input,
+                                    const torch::lazy::Value& token,
+                                    int64_t dim, int64_t shard_count,
+                                    std::vector<std::vector<int64_t>> groups,
+                                    bool pin_layout);
+
+// Starts an all-reduce of `input`, returning the state of the collective in
+// flight, for async_collective_done().
+torch::lazy::Value all_reduce_start(const XLATensorPtr& input,
+                                    const torch::lazy::Value& token,
+                                    AllReduceType reduce_type,
+                                    std::vector<std::vector<int64_t>> groups,
+                                    bool pin_layout);
+
+// Waits for the collective `start` of `input`, returning its result and the
+// token following `token`.
+std::pair<XLATensorPtr, torch::lazy::Value> async_collective_done(
+    const XLATensorPtr& input, const torch::lazy::Value& start,
+    const torch::lazy::Value& token);
+
 std::pair<XLATensorPtr, torch::lazy::Value> collective_permute(
     const XLATensorPtr& input, const torch::lazy::Value& token,
     std::vector<std::pair<int64_t, int64_t>> source_target_pairs);
 
+std::pair<std::vector<XLATensorPtr>, torch::lazy::Value>
+collective_permute_coalesced(
+    const std::vector<XLATensorPtr>& inputs, const torch::lazy::Value& token,
+    std::vector<std::pair<int64_t, int64_t>> source_target_pairs);
+
+// Returns the attention output and its F32 log-sum-exp, with the token
+// following `token`.
+std::tuple<XLATensorPtr, XLATensorPtr, torch::lazy::Value> ring_attention(
+    const XLATensorPtr& query, const XLATensorPtr& key,
+    const XLATensorPtr& value, const torch::lazy::Value& token, double scale,
+    bool causal, std::vector<std::vector<int64_t>> groups);
+
+// Returns the query, key and value gradients, with the token following
+// `token`.
+std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr, torch::lazy::Value>
+ring_attention_backward(const XLATensorPtr& query, const XLATensorPtr& key,
+                        const XLATensorPtr& value, const XLATensorPtr& output,
+                        const XLATensorPtr& logsumexp,
+                        const XLATensorPtr& grad_output,
+                        const torch::lazy::Value& token, double scale,
+                        bool causal, std::vector<std::vector<int64_t>> groups);
+
+// Returns the attention output and its F32 log-sum-exp, computed over blocks
+// of `block_size` keys at a time.
+std::pair<XLATensorPtr, XLATensorPtr> flash_attention(
+    const XLATensorPtr& query, const XLATensorPtr& key,
+    const XLATensorPtr& value, double scale, bool causal, int64_t block_size);
+
+// Returns the query, key and value gradients of flash_attention().
+std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> flash_attention_backward(
+    const XLATensorPtr& query, const XLATensorPtr& key,
+    const XLATensorPtr& value, const XLATensorPtr& output,
+    const XLATensorPtr& logsumexp, const XLATensorPtr& grad_output,
+    double scale, bool causal, int64_t block_size);
+
+// Returns the [m, n] products of the rows of the [m, k] `lhs`, sorted by
+// group, with the [k, n] matrices of their groups in the [groups, k, n] `rhs`
+// ([groups, n, k] with `transpose_rhs`), for the [groups] `group_sizes`.
+XLATensorPtr grouped_matmul(const XLATensorPtr& lhs, const XLATensorPtr& rhs,
+                            const XLATensorPtr& group_sizes,
+                            bool transpose_rhs, int64_t tile_rows);
+
+// Returns the [groups, k, n] products of the transposed rows of each group of
+// the [m, k] `lhs` with the ones of the [m, n] `rhs`, the rhs gradient of
+// grouped_matmul().
+XLATensorPtr transposed_grouped_matmul(const XLATensorPtr& lhs,
+                                       const XLATensorPtr& rhs,
+                                       const XLATensorPtr& group_sizes,
+                                       int64_t tile_rows);
+
+// Returns the layer norm over the last dimension of dropout(input, p) +
+// residual, the sum, the F32 mean and reciprocal standard deviation of its
+// rows, and the seed of the dropout mask. With `return_mask` the scaled mask
+// follows, otherwise the backward draws it again from the seed.
+std::vector<XLATensorPtr> dropout_add_layer_norm(
+    const XLATensorPtr& input, const XLATensorPtr& residual,
+    const XLATensorPtr& weight, const XLATensorPtr& bias, double p, double eps,
+    bool return_mask);
+
+// Returns the input, residual, weight and bias gradients of
+// dropout_add_layer_norm(). The `mask` is null if it was not returned.
+std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr, XLATensorPtr>
+dropout_add_layer_norm_backward(
+    const XLATensorPtr& grad_output, const XLATensorPtr& grad_sum,
+    const XLATensorPtr& sum, const XLATensorPtr& weight,
+    const XLATensorPtr& mean, const XLATensorPtr& rstd,
+    const XLATensorPtr& seed, const XLATensorPtr& mask, double p);
+
+// Returns the softmax over the last dimension of input * scale, with the
+// boolean or additive `mask`, which may be null, broadcast to the input by its
+// minor dimensions, and with the causal mask of the two minor dimensions.
+XLATensorPtr masked_scaled_softmax(const XLATensorPtr& input,
+                                   const XLATensorPtr& mask, double scale,
+                                   bool causal);
+
+XLATensorPtr masked_scaled_softmax_backward(const XLATensorPtr& grad_output,
+                                            const XLATensorPtr& output,
+                                            double scale);
+
+// Returns the sorted top-k values and indices of `input` along `dim`, with the
+// expected recall of recall_target. See CreateApproxTopK().
+std::tuple<XLATensorPtr, XLATensorPtr> approx_topk(const XLATensorPtr& input,
+                                                   int64_t k, int64_t dim,
+                                                   bool largest,
+                                                   double recall_target);
+
+// Returns the Long token ids sampled from each row of the [..., V] logits.
+// The `temperature` and `top_p`, which may be null, are scalars or of the batch
+// shape [...]. See BuildSampleTokens().
+XLATensorPtr sample_tokens(const XLATensorPtr& logits,
+                           const XLATensorPtr& temperature, int64_t top_k,
+                           const XLATensorPtr& top_p);
+
+// Writes `update` into `cache` from the scalar `position` along `dim`, the
+// other dimensions matching. The cache buffer is donated to the result at the
+// step barrier, so that a decoding step does not copy the whole cache.
+void kv_cache_update_(XLATensorPtr& cache, const XLATensorPtr& update,
+                      const XLATensorPtr& position, int64_t dim);
+
+// Accumulates the values of `value`, weighted by the scalar or value shaped
+// `weight` (1 if undefined), into the F32 [2] metric `state` in place. The
+// state holds the sum, maximum or minimum of the values, per `reduction`, and
+// their count. See MetricAccumulate.
+void metric_accumulate_(XLATensorPtr& state, const XLATensorPtr& value,
+                        const XLATensorPtr& weight, int64_t reduction);
+
+// Zeroes the entries [position + accepted, position + window) of `cache` along
+// `dim`, the rejected tail of a window written from the scalar `position`, in
+// place. Only the window is written, and the cache buffer is donated.
+void kv_cache_rollback_(XLATensorPtr& cache, const XLATensorPtr& position,
+                        const XLATensorPtr& accepted, int64_t window,
+                        int64_t dim);
+
+// Returns the bags of the embedding table sharded by rows across `groups`, with
+// the token following `token`.
+std::pair<XLATensorPtr, torch::lazy::Value> sharded_embedding_bag(
+    const XLATensorPtr& weight, const XLATensorPtr& indices,
+    const XLATensorPtr& offsets, const XLATensorPtr& per_sample_weights,
+    const torch::lazy::Value& token, int64_t mode, bool include_last_offset,
+    std::vector<std::vector<int64_t>> groups, bool pin_layout);
+
+// Returns the rows of the `num_rows` rows weight shard and their gradients,
+// with the token following `token`.
+std::tuple<XLATensorPtr, XLATensorPtr, torch::lazy::Value>
+sharded_embedding_bag_backward(
+    const XLATensorPtr& grad_output, const XLATensorPtr& indices,
+    const XLATensorPtr& offsets, const XLATensorPtr& per_sample_weights,
+    const torch::lazy::Value& token, int64_t mode, bool include_last_offset,
+    int64_t num_rows, std::vector<std::vector<int64_t>> groups,
+    bool pin_layout);
+
 std::vector<XLATensorPtr> custom_call(
     const std::vector<XLATensorPtr>& inputs, const std::string& target,
     const std::vector<std::vector<int64_t>>& output_shapes,
@@ -91,13 +249,15 @@ void custom_sharding_(
     const std::shared_ptr<XLATensor::ShardingSpec>& spec,
     const CustomSharding::Type& type = CustomSharding::Type::kSharding);
 
+// The custom calls of the kernel registered by CustomKernelRegistry as
+// `kernel_id`.
 std::vector<XLATensorPtr> gpu_custom_call(
-    const std::vector<XLATensorPtr>& inputs, const std::string& payload,
+    const std::vector<XLATensorPtr>& inputs, int64_t kernel_id,
     const std::vector<std::vector<int64_t>>& output_shapes,
     const std::vector<at::ScalarType>& output_dtypes);
 
 std::vector<XLATensorPtr> tpu_custom_call(
-    const std::vector<XLATensorPtr>& inputs, const std::string& payload,
+    const std::vector<XLATensorPtr>& inputs, int64_t kernel_id,
     const std::vector<std::vector<int64_t>>& output_shapes,
     const std::vector<at::ScalarType>& output_dtypes);
 
@@ -125,10 +285,69 @@ void adam_optimizer_step_(const XLATensorPtr& found_inf, XLATensorPtr& step,
                           double eps, bool amsgrad, bool maximize,
                           bool use_adamw);
 
+// Like sgd_optimizer_step_(), over a list of params of the same type updated
+// as a single flattened buffer. The gradients are multiplied by the scalar
+// `grad_scale` within the update.
+void foreach_sgd_optimizer_step_(const XLATensorPtr& found_inf,
+                                 const XLATensorPtr& grad_scale,
+                                 std::vector<XLATensorPtr>& steps,
+                                 std::vector<XLATensorPtr>& params,
+                                 std::vector<XLATensorPtr>& bufs,
+                                 const std::vector<XLATensorPtr>& d_ps,
+                                 double weight_decay, double momentum,
+                                 double lr, double dampening, bool nesterov,
+                                 bool maximize);
+
+// Like adam_optimizer_step_(), over a list of params of the same type updated
+// as a single flattened buffer. The `max_exp_avg_sqs` are only used with
+// `amsgrad`. The gradients are multiplied by the scalar `grad_scale` within
+// the update.
+void foreach_adam_optimizer_step_(
+    const XLATensorPtr& found_inf, const XLATensorPtr& grad_scale,
+    std::vector<XLATensorPtr>& steps, std::vector<XLATensorPtr>& params,
+    const std::vector<XLATensorPtr>& grads, std::vector<XLATensorPtr>& exp_avgs,
+    std::vector<XLATensorPtr>& exp_avg_sqs,
+    std::vector<XLATensorPtr>& max_exp_avg_sqs, double beta1, double beta2,
+    double lr, double weight_decay, double eps, bool amsgrad, bool maximize,
+    bool use_adamw);
+
+// Sets `found_inf` if any of the `grads` is not finite and returns the global
+// L2 norm of the `grads` multiplied by `inv_scale`, reading the grads once.
+XLATensorPtr foreach_grad_norm_(XLATensorPtr& found_inf,
+                                const XLATensorPtr& inv_scale,
+                                const std::vector<XLATensorPtr>& grads);
+
+// Like sgd_optimizer_step_(), with the gradient given as the 1D `rows` of the
+// param and their `values`. Only those rows of `param` and `buf` are updated.
+void sparse_sgd_optimizer_step_(const XLATensorPtr& found_inf,
+                                XLATensorPtr& step, XLATensorPtr& param,
+                                XLATensorPtr& buf, const XLATensorPtr& rows,
+                                const XLATensorPtr& values, double weight_decay,
+                                double momentum, double lr, double dampening,
+                                bool nesterov, bool maximize);
+
+// Like adam_optimizer_step_(), with the gradient given as the 1D `rows` of the
+// param and their `values`. Only those rows of `param` and of the moments are
+// updated.
+void sparse_adam_optimizer_step_(
+    const XLATensorPtr& found_inf, XLATensorPtr& step, XLATensorPtr& param,
+    const XLATensorPtr& rows, const XLATensorPtr& values, XLATensorPtr& exp_avg,
+    XLATensorPtr& exp_avg_sq, XLATensorPtr& max_exp_avg_sq, double beta1,
+    double beta2, double lr, double weight_decay, double eps, bool amsgrad,
+    bool maximize, bool use_adamw);
+
 std::vector<XLATensorPtr> user_computation(
     const std::string& opname, absl::Span<const XLATensorPtr> inputs,
     runtime::ComputationClient::ComputationPtr computation);
 
+// Runs the structured while loop of the `carried` values, the `invariants`
+// being passed to `cond` and `body` after them, see WhileLoop.
+std::vector<XLATensorPtr> while_loop(
+    absl::Span<const XLATensorPtr> carried,
+    absl::Span<const XLATensorPtr> invariants,
+    runtime::ComputationClient::ComputationPtr cond,
+    runtime::ComputationClient::ComputationPtr body);
+
 //////////////////////////////////////////////////////////////////////////////
 // Quantization related ops here.
 //////////////////////////////////////////////////////////////////////////////
@@ -144,6 +363,22 @@ XLATensorPtr dequantize_tensor(const XLATensorPtr& input,
                                int quant_min, int quant_max,
                                const std::string& dtype, int axis);
 
+// The matmul of `input` with the transposed S8 `weight`, dequantized by
+// `scale` per out channel or, with a positive `block_size`, per block of
+// in channels. With `int4_weight`, every weight byte packs two in channels.
+XLATensorPtr quantized_matmul(const XLATensorPtr& input,
+                              const XLATensorPtr& weight,
+                              const XLATensorPtr& scale, int64_t block_size,
+                              bool int4_weight);
+
+// The matmul of the 2D `a` and `b` with FP8 operands, scaled by the scalar
+// `a_scale` and `b_scale`, in the "e4m3" or "e5m2" formats. Returns the matmul
+// and the F32 absolute maxima of `a` and `b`.
+std::tuple<XLATensorPtr, XLATensorPtr, XLATensorPtr> fp8_scaled_mm(
+    const XLATensorPtr& a, const XLATensorPtr& b, const XLATensorPtr& a_scale,
+    const XLATensorPtr& b_scale, const std::string& a_format,
+    const std::string& b_format);
+
 //////////////////////////////////////////////////////////////////////////////
 // Dynamic Reshape ops here.
 //////////////////////////////////////////////////////////////////////////////
@@ -296,8 +531,10 @@ std::vector<XLATensorPtr> broadcast_tensors(
 XLATensorPtr cat(absl::Span<const XLATensorPtr> tensors, int64_t dim,
                  at::ScalarType dtype);
 
+// With `use_mm_for_euclid_dist`, the p == 2 distances are computed with a
+// matmul.
 XLATensorPtr cdist_forward(const XLATensorPtr& x1, const XLATensorPtr& x2,
-                           double p);
+                           double p, bool use_mm_for_euclid_dist);
 
 XLATensorPtr pdist_forward(const XLATensorPtr& input, double p);
 
@@ -306,6 +543,20 @@ XLATensorPtr pixel_shuffle(const XLATensorPtr& self, int64_t upscale_factor);
 XLATensorPtr celu(const XLATensorPtr& input, const at::Scalar& alpha);
 void celu_(XLATensorPtr& input, const at::Scalar& alpha);
 
+// Returns the cross entropy of the log-softmax of the [N, C] `input` for the
+// [N] class indices `target`, computed over chunks of `chunk_size` classes,
+// and the log-sum-exp of the `input` rows for the backward.
+std::pair<XLATensorPtr, XLATensorPtr> chunked_cross_entropy(
+    const XLATensorPtr& input, const XLATensorPtr& target, int64_t reduction,
+    int ignore_index, int64_t chunk_size);
+
+XLATensorPtr chunked_cross_entropy_backward(const XLATensorPtr& grad_output,
+                                            const XLATensorPtr& input,
+                                            const XLATensorPtr& target,
+                                            const XLATensorPtr& logsumexp,
+                                            int64_t reduction, int ignore_index,
+                                            int64_t chunk_size);
+
 XLATensorPtr clamp(const XLATensorPtr& input,
                    const c10::optional<at::Scalar>& min,
                    const c10::optional<at::Scalar>& max);
@@ -577,6 +828,12 @@ XLATensorPtr masked_scatter(XLATensorPtr& input, const XLATensorPtr& mask,
 
 XLATensorPtr masked_select(const XLATensorPtr& input, const XLATensorPtr& mask);
 
+// Returns the first `size` elements of masked_select(), padded with
+// `fill_value`, and the number of selected elements.
+std::pair<XLATensorPtr, XLATensorPtr> masked_select_static(
+    const XLATensorPtr& input, const XLATensorPtr& mask, int64_t size,
+    const at::Scalar& fill_value);
+
 XLATensorPtr matmul(const XLATensorPtr& input, const XLATensorPtr& other);
 
 XLATensorPtr max(const XLATensorPtr& input);
@@ -703,8 +960,22 @@ XLATensorPtr nll_loss_backward(const XLATensorPtr& grad_output,
 XLATensorPtr nms(const XLATensorPtr& boxes, const XLATensorPtr& scores,
                  double iou_threshold);
 
+// Returns the indices of the boxes kept by the NMS of every set of `boxes`,
+// padded with -1, and the number of kept boxes of every set.
+std::pair<XLATensorPtr, XLATensorPtr> batched_nms(const XLATensorPtr& boxes,
+                                                  const XLATensorPtr& scores,
+                                                  double iou_threshold,
+                                                  double score_threshold,
+                                                  int64_t max_output_size);
+
 XLATensorPtr nonzero(const XLATensorPtr& input);
 
+// Returns the first `size` rows of nonzero(), padded with `fill_value`, and the
+// number of nonzero elements.
+std::pair<XLATensorPtr, XLATensorPtr> nonzero_static(const XLATensorPtr& input,
+                                                     int64_t size,
+                                                     int64_t fill_value);
+
 XLATensorPtr norm(const XLATensorPtr& input, const c10::optional<at::Scalar>& p,
                   c10::optional<at::ScalarType> dtype, at::IntArrayRef dim,
                   bool keepdim);
@@ -9,8 +9,10 @@
 #include <cstring>
 #include <functional>
 #include <list>
+#include <mutex>
 #include <numeric>
 #include <thread>
+#include <type_traits>
 
 #include "absl/synchronization/blocking_counter.h"
 #include "torch_xla/csrc/aten_xla_bridge.h"
@@ -29,6 +31,7 @@
 #include "torch_xla/csrc/xla_backend_impl.h"
 #include "torch_xla/csrc/xla_sharding_util.h"
 #include "tsl/platform/bfloat16.h"
+#include "xla/layout_util.h"
 #include "xla/literal_util.h"
 #include "xla/shape_util.h"
 
@@ -218,6 +221,63 @@ struct CopyType<true> {
   using type = CopyCasted;
 };
 
+// Maps the element types shared by PyTorch and XLA to the ATen scalar type.
+// Complex types are left out, since the casts below keep the real part only
+// when copying them to real types.
+template <typename T>
+struct AtenType {
+  static constexpr bool supported = false;
+};
+#define DEFINE_ATEN_TYPE(T, S)                    \
+  template <>                                     \
+  struct AtenType<T> {                            \
+    static constexpr bool supported = true;       \
+    static constexpr at::ScalarType type = at::S; \
+  };
+DEFINE_ATEN_TYPE(bool, kBool)
+DEFINE_ATEN_TYPE(uint8_t, kByte)
+DEFINE_ATEN_TYPE(int8_t, kChar)
+DEFINE_ATEN_TYPE(int16_t, kShort)
+DEFINE_ATEN_TYPE(int32_t, kInt)
+DEFINE_ATEN_TYPE(int64_t, kLong)
+DEFINE_ATEN_TYPE(float, kFloat)
+DEFINE_ATEN_TYPE(double, kDouble)
+DEFINE_ATEN_TYPE(at::BFloat16, kBFloat16)
+DEFINE_ATEN_TYPE(tsl::bfloat16, kBFloat16)
+DEFINE_ATEN_TYPE(at::Half, kHalf)
+DEFINE_ATEN_TYPE(xla::half, kHalf)
+#undef DEFINE_ATEN_TYPE
+
+// Copies n elements with the given element strides (in logical dimension
+// order) using the ATen CPU copy kernels, which are vectorized for the
+// instruction set detected at runtime and split over the intra-op thread pool.
+// Returns false if the copy is not worth (or not possible) going through ATen,
+// in which case nothing has been copied.
+template <typename D, typename S>
+bool AtenCopy(D* dest, absl::Span<const int64_t> dest_strides, const S* source,
+              absl::Span<const int64_t> source_strides,
+              absl::Span<const int64_t> dimensions) {
+  // Below this, setting up the tensor iterator costs more than it saves.
+  static const int64_t kMinAtenCopyElements = 32768;
+  if constexpr (AtenType<S>::supported && AtenType<D>::supported) {
+    if (runtime::util::Multiply<int64_t>(dimensions) < kMinAtenCopyElements) {
+      return false;
+    }
+    at::IntArrayRef sizes(dimensions.data(), dimensions.size());
+    at::Tensor source_tensor = at::from_blob(
+        const_cast<S*>(source), sizes,
+        at::IntArrayRef(source_strides.data(), source_strides.size()),
+        at::TensorOptions(AtenType<S>::type));
+    at::Tensor dest_tensor =
+        at::from_blob(dest, sizes,
+                      at::IntArrayRef(dest_strides.data(), dest_strides.size()),
+                      at::TensorOptions(AtenType<D>::type));
+    dest_tensor.copy_(source_tensor);
+    return true;
+  }
+  return false;
+}
+
 template <typename D, typename S>
 void CheckedMemcpy(D* dest, const S* source, int64_t n) {
   static_assert(sizeof(S) == sizeof(D), "Types size mismatch");
@@ -226,11 +286,19 @@ void CheckedMemcpy(D* dest, const S* source, int64_t n) {
 
 template <typename D, typename S>
 void CopyData(D* dest, const S* source, int64_t n, const CopyDirect&) {
+  if constexpr (!std::is_same_v<D, S>) {
+    if (AtenCopy(dest, {1}, source, {1}, {n})) {
+      return;
+    }
+  }
   std::copy(source, source + n, dest);
 }
 
 template <typename D, typename S>
 void CopyData(D* dest, const S* source, int64_t n, const CopyCasted&) {
+  if (AtenCopy(dest, {1}, source, {1}, {n})) {
+    return;
+  }
   // Use strided copy with step 1 since it has the static_cast<> required to
   // convert from/to bfloat16.
   StridedCopy(dest, 1, source, 1, n);
@@ -359,24 +427,26 @@ void CopyTensors(const void* src_buffer, const xla::Shape& src_shape,
                            typename CopyType < NeedCast<SType>::value ||
                                NeedCast<DType>::value > ::type());
   } else if (total_elements > 0) {
+    std::vector<int64_t> src_strides = ComputeShapeStrides(src_shape);
+    std::vector<int64_t> dest_strides = ComputeShapeStrides(dest_shape);
+    if (AtenCopy(dest_data, dest_strides, src_data, src_strides,
+                 dest_shape.dimensions())) {
+      return;
+    }
     // We issue a multi-threaded copy by slicing the bigger dimension and
     // assigning its copy to different threads. This code is only valid for
     // ranks >= 2, but the layout check above covers the case.
-    std::vector<int64_t> src_strides = ComputeShapeStrides(src_shape);
-    std::vector<int64_t> dest_strides = ComputeShapeStrides(dest_shape);
     std::vector<int64_t> iter_dims = GetIterationDimensions(dest_shape);
     std::vector<CopyPartition> parts =
         CreateCopyPartitions(dest_shape.dimensions(), iter_dims.front());
-    absl::BlockingCounter counter(parts.size());
-    for (size_t i = 0; i < parts.size(); ++i) {
-      auto copy_fn = [&, i]() {
-        SlicedCopy<SType, DType>(dest_shape.dimensions(), src_data, src_strides,
-                                 dest_data, dest_strides, iter_dims, parts[i]);
-        counter.DecrementCount();
-      };
-      thread::Schedule(std::move(copy_fn));
-    }
-    counter.Wait();
+    thread::ParallelFor(parts.size(), /*grain=*/1,
+                        [&](int64_t begin, int64_t end) {
+                          for (int64_t i = begin; i < end; ++i) {
+                            SlicedCopy<SType, DType>(
+                                dest_shape.dimensions(), src_data, src_strides,
+                                dest_data, dest_strides, iter_dims, parts[i]);
+                          }
+                        });
   }
 }
 
@@ -384,12 +454,20 @@ template <typename SType, typename DType>
 void TensorToBuffer(const at::Tensor& tensor, const xla::Shape& dest_shape,
                     void* dest_buffer, size_t dest_buffer_size,
                     const torch::lazy::BackendDevice& device) {
-  at::Tensor contiguous_tensor = tensor.contiguous();
-  xla::Shape src_shape = MakeTorchTensorLayout(
-      XlaHelpers::I64List(contiguous_tensor.sizes()), /*dynamic_dimensions=*/{},
-      MaybeDowncastToXlaDeviceType(contiguous_tensor.type().scalarType(),
-                                   device));
-  CopyTensors<SType, DType>(contiguous_tensor.data_ptr<SType>(), src_shape,
+  // A channels last tensor is copied from its own layout, rather than being
+  // made contiguous first and copied again.
+  bool channels_last = runtime::IsChannelsLastContiguous(tensor);
+  at::Tensor src_tensor = channels_last ? tensor : tensor.contiguous();
+  xla::PrimitiveType src_type =
+      MaybeDowncastToXlaDeviceType(src_tensor.type().scalarType(), device);
+  xla::Shape src_shape =
+      channels_last
+          ? MakeTorchTensorLayoutFromStrides(
+                XlaHelpers::I64List(src_tensor.sizes()),
+                XlaHelpers::I64List(src_tensor.strides()), src_type)
+          : MakeTorchTensorLayout(XlaHelpers::I64List(src_tensor.sizes()),
+                                  /*dynamic_dimensions=*/{}, src_type);
+  CopyTensors<SType, DType>(src_tensor.data_ptr<SType>(), src_shape,
                             dest_buffer, dest_buffer_size, dest_shape);
 }
 
@@ -480,7 +558,9 @@ torch::lazy::BackendDataPtr TensorToXlaData(
 
   std::vector<std::shared_ptr<const runtime::TensorSource>> source_tensors;
   source_tensors.push_back(
-      std::make_shared<runtime::AtenSource>(tensor, shape, device.toString()));
+      std::make_shared<runtime::AtenSource>(
+          tensor, shape, device.toString(),
+          runtime::GetComputationClient()->GetHostBufferPool()));
 
   auto handles =
       runtime::GetComputationClient()->TransferToDevice(source_tensors);
@@ -489,7 +569,7 @@ torch::lazy::BackendDataPtr TensorToXlaData(
 }
 
 template <typename SType, typename DType>
-at::Tensor XlaLiteralToTensor(const xla::Literal& literal,
+at::Tensor XlaLiteralToTensor(const xla::LiteralBase& literal,
                               at::ScalarType atype) {
   std::vector<int64_t> dimensions =
       torch::lazy::ToVector<int64_t>(literal.shape().dimensions());
@@ -507,7 +587,7 @@ at::Tensor XlaLiteralToTensor(const xla::Literal& literal,
 }
 
 template <typename SType>
-at::Tensor XlaLiteralToTensorHelper(const xla::Literal& literal,
+at::Tensor XlaLiteralToTensorHelper(const xla::LiteralBase& literal,
                                     at::ScalarType dest_element_type) {
   switch (dest_element_type) {
     case at::ScalarType::Bool:
@@ -618,7 +698,7 @@ std::vector<int64_t> ComputeShapeStrides(const xla::Shape& shape) {
   return strides;
 }
 
-at::Tensor MakeTensorFromXlaLiteral(const xla::Literal& literal,
+at::Tensor MakeTensorFromXlaLiteral(const xla::LiteralBase& literal,
                                     at::ScalarType dest_element_type) {
   switch (literal.shape().element_type()) {
     case xla::PrimitiveType::PRED:
@@ -699,22 +779,24 @@ std::vector<torch::lazy::BackendDataPtr> CreateTensorsData(
         runtime::GetComputationClient()->GetLocalDevices();
     std::vector<runtime::ComputationClient::DataPtr> handles;
     for (size_t i = 0; i < tensors.size(); ++i) {
-      auto device = ParseDeviceString(devices[i]);
-      auto shape = CreateComputationShapeFromTensor(tensors[i], &device);
-      auto replicated_data =
-          std::vector<at::Tensor>(local_devices.size(), tensors[i]);
+      // The replicas share the data of a single source, which is uploaded
+      // once and then copied between the devices.
       handles.push_back(ShardingUtil::CreateShardedData(
-          replicated_data, local_devices, nullptr));
+          ShardingUtil::ShardTensorToSources(tensors[i], nullptr,
+                                             local_devices),
+          nullptr));
     }
     return WrapXlaData(handles);
   }
 
+  runtime::HostBufferPool* staging_pool =
+      runtime::GetComputationClient()->GetHostBufferPool();
   std::vector<std::shared_ptr<const runtime::TensorSource>> source_tensors;
   for (size_t i = 0; i < tensors.size(); ++i) {
     torch::lazy::BackendDevice device = ParseDeviceString(devices[i]);
     xla::Shape shape = CreateComputationShapeFromTensor(tensors[i], &device);
     source_tensors.push_back(std::make_shared<runtime::AtenSource>(
-        tensors[i], std::move(shape), devices[i]));
+        tensors[i], std::move(shape), devices[i], staging_pool));
   }
   return WrapXlaData(
       runtime::GetComputationClient()->TransferToDevice(source_tensors));
@@ -745,14 +827,14 @@ std::vector<torch::lazy::BackendDataPtr> CreateTensorsData(
       // Shards the input tensors with padding, to split evenly.
       // The execution requires consistent shard sizes, and the zero-padded
       // values should be ignored.
-      std::vector<at::Tensor> local_shards =
-          ShardingUtil::ShardTensor(tensors[i], shardings[i], local_devices,
-                                    /*padded=*/true);
       new_handles.push_back(ShardingUtil::CreateShardedData(
-          local_shards, local_devices, shardings[i]));
+          ShardingUtil::ShardTensorToSources(tensors[i], shardings[i],
+                                             local_devices),
+          shardings[i]));
     } else {
       source_tensors.push_back(std::make_shared<runtime::AtenSource>(
-          tensors[i], std::move(shape), devices[i]));
+          tensors[i], std::move(shape), devices[i],
+          runtime::GetComputationClient()->GetHostBufferPool()));
       new_handles =
           runtime::GetComputationClient()->TransferToDevice(source_tensors);
     }
@@ -778,8 +860,11 @@ xla::Literal GetTensorLiteral(const at::Tensor& tensor, const xla::Shape* shape,
   return literal;
 }
 
-std::vector<xla::Literal> ReleaseGilAndTransferData(
-    absl::Span<const torch::lazy::BackendDataPtr> xla_data) {
+namespace {
+
+// Runs `fn` with the GIL released if the calling thread holds it.
+template <typename F>
+auto WithGilReleased(F&& fn) -> decltype(fn()) {
   // HACK: This method may be called outside of python (mainly in C++ tests) or
   // when the GIL is already released, so we must check both cases here. If
   // possible, prefer to release the GIL in the python bindings before copying
@@ -791,66 +876,191 @@ std::vector<xla::Literal> ReleaseGilAndTransferData(
   if (release_gil && Py_IsInitialized() && PyGILState_Check()) {
     save = PyEval_SaveThread();
   }
-  std::vector<xla::Literal> literals =
-      runtime::GetComputationClient()->TransferFromDevice(
-          UnwrapXlaData(xla_data));
-  if (save) {
-    PyEval_RestoreThread(save);
+  struct GilRestorer {
+    ~GilRestorer() {
+      if (save) {
+        PyEval_RestoreThread(save);
+      }
+    }
+    PyThreadState* save;
+  } restorer{save};
+  return fn();
+}
+
+// Whether data with the given host shape can be read straight into the memory
+// of a contiguous tensor of type `dest_element_type`.
+bool CanTransferIntoTensor(const xla::Shape& host_shape,
+                           at::ScalarType dest_element_type) {
+  if (!host_shape.IsArray() || host_shape.is_dynamic() ||
+      xla::ShapeUtil::IsZeroElementArray(host_shape) ||
+      XlaTypeFromTorchType(dest_element_type) != host_shape.element_type()) {
+    return false;
   }
+  xla::Shape torch_shape =
+      MakeTorchTensorLayout(host_shape.dimensions(), /*dynamic_dimensions=*/{},
+                            host_shape.element_type());
+  return xla::LayoutUtil::Equal(host_shape.layout(), torch_shape.layout());
+}
 
-  return literals;
+// The size of the chunks of the large tensors hashed in parallel, which the
+// sizes of all the element types divide.
+constexpr int64_t kHashChunkBytes = 1 << 20;
+
+// Copies `count` elements of the row major contents of the strided `tensor`,
+// from the element `first` on, into `dest`. The runs along a contiguous
+// innermost dimension are copied at once.
+void GatherElements(const at::Tensor& tensor, int64_t first, int64_t count,
+                    char* dest) {
+  c10::IntArrayRef sizes = tensor.sizes();
+  c10::IntArrayRef strides = tensor.strides();
+  int64_t rank = sizes.size();
+  int64_t element_size = tensor.element_size();
+  const char* base = static_cast<const char*>(tensor.const_data_ptr());
+  std::vector<int64_t> indices(rank);
+  for (int64_t dim = rank - 1, rest = first; dim >= 0; --dim) {
+    indices[dim] = rest % sizes[dim];
+    rest /= sizes[dim];
+  }
+  bool inner_contiguous = rank > 0 && strides[rank - 1] == 1;
+  while (count > 0) {
+    int64_t offset = 0;
+    for (int64_t dim = 0; dim < rank; ++dim) {
+      offset += indices[dim] * strides[dim];
+    }
+    int64_t run = inner_contiguous
+                      ? std::min(count, sizes[rank - 1] - indices[rank - 1])
+                      : 1;
+    std::memcpy(dest, base + offset * element_size, run * element_size);
+    dest += run * element_size;
+    count -= run;
+    if (rank == 0) {
+      break;
+    }
+    indices[rank - 1] += run;
+    for (int64_t dim = rank - 1; dim > 0 && indices[dim] >= sizes[dim];
+         --dim) {
+      indices[dim] = 0;
+      indices[dim - 1] += 1;
+    }
+  }
+}
+
+}  // namespace
+
+std::vector<xla::Literal> ReleaseGilAndTransferData(
+    absl::Span<const torch::lazy::BackendDataPtr> xla_data) {
+  return WithGilReleased([&]() {
+    return runtime::GetComputationClient()->TransferFromDevice(
+        UnwrapXlaData(xla_data));
+  });
 }
 
 std::vector<at::Tensor> XlaDataToTensors(
     absl::Span<const torch::lazy::BackendDataPtr> xla_data,
     absl::Span<const at::ScalarType> dest_element_type) {
-  std::vector<xla::Literal> literals = ReleaseGilAndTransferData(xla_data);
-  std::vector<at::Tensor> tensors(literals.size());
-  absl::BlockingCounter counter(literals.size());
-  for (size_t i = 0; i < tensors.size(); ++i) {
-    auto copy_fn = [&, i]() {
-      tensors[i] = MakeTensorFromXlaLiteral(literals[i], dest_element_type[i]);
-      counter.DecrementCount();
-    };
-    thread::Schedule(std::move(copy_fn));
+  TORCH_LAZY_TIMED("XlaDataToTensors");
+  runtime::ComputationClient* client = runtime::GetComputationClient();
+  runtime::HostBufferPool* staging_pool = client->GetHostBufferPool();
+  std::vector<at::Tensor> tensors(xla_data.size());
+  std::vector<std::shared_ptr<xla::MutableLiteralBase>> literals(
+      xla_data.size());
+  std::vector<bool> direct(xla_data.size(), false);
+  auto destination_fn = [&](size_t i, const xla::Shape& host_shape) {
+    if (CanTransferIntoTensor(host_shape, dest_element_type[i])) {
+      // The device data lands straight into the output tensor, no conversion
+      // needed afterwards.
+      tensors[i] = at::empty(
+          torch::lazy::ToVector<int64_t>(host_shape.dimensions()),
+          at::TensorOptions(dest_element_type[i]));
+      literals[i] = std::make_shared<xla::MutableBorrowingLiteral>(
+          static_cast<char*>(tensors[i].data_ptr()), host_shape);
+      direct[i] = true;
+    } else if (staging_pool != nullptr) {
+      std::shared_ptr<char> staging =
+          staging_pool->Allocate(xla::ShapeUtil::ByteSizeOf(host_shape));
+      literals[i] = std::shared_ptr<xla::MutableBorrowingLiteral>(
+          new xla::MutableBorrowingLiteral(staging.get(), host_shape),
+          [staging](xla::MutableBorrowingLiteral* literal) { delete literal; });
+    } else {
+      literals[i] = std::make_shared<xla::Literal>(host_shape);
+    }
+    return literals[i].get();
+  };
+
+  WithGilReleased([&]() {
+    std::vector<xla::PjRtFuture<>> futures = client->TransferFromDeviceAsync(
+        UnwrapXlaData(xla_data), destination_fn);
+    // Convert each value as soon as it arrives, in the order in which the
+    // transfers complete, so that the values of a device do not wait for the
+    // transfers from the devices preceding it.
+    absl::BlockingCounter counter(futures.size());
+    std::mutex status_mutex;
+    absl::Status status;
+    for (size_t i = 0; i < futures.size(); ++i) {
+      futures[i].OnReady([&, i](absl::Status transfer_status) {
+        if (!transfer_status.ok() || direct[i]) {
+          std::lock_guard<std::mutex> lock(status_mutex);
+          status.Update(transfer_status);
+          counter.DecrementCount();
+          return;
+        }
+        // The conversion runs on the pool, off the transfer callback thread.
+        auto copy_fn = [&, i]() {
+          tensors[i] =
+              MakeTensorFromXlaLiteral(*literals[i], dest_element_type[i]);
+          // Hand back the staging memory right away.
+          literals[i] = nullptr;
+          counter.DecrementCount();
+        };
+        thread::Schedule(std::move(copy_fn));
+      });
+    }
+    counter.Wait();
+    XLA_CHECK_OK(status) << "Failed to transfer data from device";
+  });
+  int64_t direct_count = std::count(direct.begin(), direct.end(), true);
+  if (direct_count > 0) {
+    TORCH_LAZY_COUNTER("DirectTransferToTensor", direct_count);
   }
-  counter.Wait();
   return tensors;
 }
 
 torch::lazy::hash_t TensorHash(const at::Tensor& tensor) {
-  at::Tensor ctensor = tensor.contiguous();
-  int64_t size = ctensor.numel() * ctensor.element_size();
-  switch (ctensor.scalar_type()) {
-    case at::ScalarType::Bool:
-      return torch::lazy::DataHash(ctensor.data_ptr<bool>(), size);
-    case at::ScalarType::Byte:
-      return torch::lazy::DataHash(ctensor.data_ptr<uint8_t>(), size);
-    case at::ScalarType::Char:
-      return torch::lazy::DataHash(ctensor.data_ptr<int8_t>(), size);
-    case at::ScalarType::Short:
-      return torch::lazy::DataHash(ctensor.data_ptr<int16_t>(), size);
-    case at::ScalarType::Int:
-      return torch::lazy::DataHash(ctensor.data_ptr<int32_t>(), size);
-    case at::ScalarType::Long:
-      return torch::lazy::DataHash(ctensor.data_ptr<int64_t>(), size);
-    case at::ScalarType::Float:
-      return torch::lazy::DataHash(ctensor.data_ptr<float>(), size);
-    case at::ScalarType::Double:
-      return torch::lazy::DataHash(ctensor.data_ptr<double>(), size);
-    case at::ScalarType::BFloat16:
-      return torch::lazy::DataHash(ctensor.data_ptr<at::BFloat16>(), size);
-    case at::ScalarType::Half:
-      return torch::lazy::DataHash(ctensor.data_ptr<at::Half>(), size);
-    case at::ScalarType::ComplexFloat:
-      return torch::lazy::DataHash(ctensor.data_ptr<c10::complex<float>>(),
-                                   size);
-    case at::ScalarType::ComplexDouble:
-      return torch::lazy::DataHash(ctensor.data_ptr<c10::complex<double>>(),
-                                   size);
-    default:
-      XLA_ERROR() << "Unsupported scalar type: " << ctensor.scalar_type();
+  int64_t size = tensor.numel() * tensor.element_size();
+  if (size <= kHashChunkBytes) {
+    at::Tensor ctensor = tensor.contiguous();
+    return torch::lazy::DataHash(ctensor.const_data_ptr(), size);
+  }
+  // The large tensors are hashed in chunks of their row major contents, in
+  // parallel, the ones strided being gathered one chunk at a time rather than
+  // made contiguous.
+  TORCH_LAZY_TIMED("TensorHashTime");
+  int64_t num_chunks = (size + kHashChunkBytes - 1) / kHashChunkBytes;
+  std::vector<torch::lazy::hash_t> chunk_hashes(num_chunks);
+  const char* data = tensor.is_contiguous()
+                         ? static_cast<const char*>(tensor.const_data_ptr())
+                         : nullptr;
+  thread::ParallelFor(
+      num_chunks, /*grain=*/1, [&](int64_t begin, int64_t end) {
+        std::vector<char> buffer;
+        for (int64_t i = begin; i < end; ++i) {
+          int64_t offset = i * kHashChunkBytes;
+          int64_t bytes = std::min(kHashChunkBytes, size - offset);
+          const char* chunk = data + offset;
+          if (data == nullptr) {
+            buffer.resize(bytes);
+            GatherElements(tensor, offset / tensor.element_size(),
+                           bytes / tensor.element_size(), buffer.data());
+            chunk = buffer.data();
+          }
+          chunk_hashes[i] = torch::lazy::DataHash(chunk, bytes);
+        }
+      });
+  torch::lazy::hash_t hash = torch::lazy::MHash(size);
+  for (const torch::lazy::hash_t& chunk_hash : chunk_hashes) {
+    hash = torch::lazy::HashCombine(hash, chunk_hash);
   }
+  return hash;
 }
 
 std::vector<xla::Shape> GetComponentShapes(const xla::Shape& shape) {
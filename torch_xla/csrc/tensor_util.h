@@ -22,7 +22,7 @@ namespace torch_xla {
 std::vector<int64_t> ComputeShapeStrides(const xla::Shape& shape);
 
 // Converts an XLA literal to an at::Tensor of the given element type.
-at::Tensor MakeTensorFromXlaLiteral(const xla::Literal& literal,
+at::Tensor MakeTensorFromXlaLiteral(const xla::LiteralBase& literal,
                                     at::ScalarType dest_element_type);
 
 // Execution and data transfer are async in PJRT, so TransferFromDevice may
@@ -44,6 +44,8 @@ bool TensorCompare(const at::Tensor& t1, const at::Tensor& t2);
 torch::lazy::BackendDataPtr TensorToXlaData(
     const at::Tensor& tensor, const torch::lazy::BackendDevice& device);
 
+// Hashes the row major contents of a tensor, whatever its strides, the large
+// ones in parallel.
 torch::lazy::hash_t TensorHash(const at::Tensor& tensor);
 
 // Retrieves the device data handles by parallel uploading data onto the
@@ -1,13 +1,67 @@
 #include "torch_xla/csrc/thread_pool.h"
 
+#include <algorithm>
 #include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
 
+#include "absl/synchronization/blocking_counter.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/numa.h"
 #include "tsl/platform/threadpool.h"
 
 namespace torch_xla {
 namespace thread {
+namespace {
+
+// The pools of the bulk work, one per NUMA node when the threads can be bound
+// to the nodes, a single unbound one otherwise.
+class BulkPools {
+ public:
+  static BulkPools* Get() {
+    static BulkPools* pools = new BulkPools();
+    return pools;
+  }
+
+  size_t size() const { return pools_.size(); }
+
+  int64_t num_threads() const { return num_threads_; }
+
+  tsl::thread::ThreadPool* pool(size_t node) { return pools_[node].get(); }
+
+ private:
+  BulkPools() {
+    num_threads_ = torch_xla::runtime::sys_util::GetEnvInt(
+        "XLA_BULK_THREAD_POOL_SIZE", 0);
+    if (num_threads_ <= 0) {
+      num_threads_ = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+    }
+    int num_nodes = 1;
+    if (torch_xla::runtime::sys_util::GetEnvBool("XLA_THREAD_POOL_NUMA",
+                                                 true) &&
+        tsl::port::NUMAEnabled()) {
+      num_nodes = std::min<int64_t>(tsl::port::NUMANumNodes(), num_threads_);
+    }
+    for (int node = 0; node < num_nodes; ++node) {
+      tsl::ThreadOptions options;
+      if (num_nodes > 1) {
+        options.numa_node = node;
+      }
+      // The threads are spread evenly, the first nodes getting the remainder.
+      int64_t node_threads =
+          num_threads_ / num_nodes + (node < num_threads_ % num_nodes ? 1 : 0);
+      pools_.push_back(std::make_unique<tsl::thread::ThreadPool>(
+          tsl::Env::Default(), options, "pytorchxla_bulk", node_threads));
+    }
+  }
+
+  int64_t num_threads_ = 0;
+  std::vector<std::unique_ptr<tsl::thread::ThreadPool>> pools_;
+};
+
+}  // namespace
 
 void Schedule(std::function<void()> fn) {
   static size_t num_threads = torch_xla::runtime::sys_util::GetEnvInt(
@@ -17,5 +71,46 @@ void Schedule(std::function<void()> fn) {
   pool.Schedule(std::move(fn));
 }
 
+void ScheduleBackground(std::function<void()> fn) {
+  static size_t num_threads = torch_xla::runtime::sys_util::GetEnvInt(
+      "XLA_BACKGROUND_THREAD_POOL_SIZE", 1);
+  static tsl::thread::ThreadPool pool(tsl::Env::Default(),
+                                      "pytorchxla_background", num_threads);
+  pool.Schedule(std::move(fn));
+}
+
+void ParallelFor(int64_t n, int64_t grain,
+                 const std::function<void(int64_t, int64_t)>& fn) {
+  if (n <= 0) {
+    return;
+  }
+  grain = std::max<int64_t>(grain, 1);
+  BulkPools* pools = BulkPools::Get();
+  // A handful of ranges per thread balances their uneven running times, the
+  // tsl pools stealing the queued ranges of the busy threads.
+  int64_t num_ranges = std::min<int64_t>((n + grain - 1) / grain,
+                                         4 * pools->num_threads());
+  if (num_ranges <= 1) {
+    fn(0, n);
+    return;
+  }
+  int64_t range_size =
+      std::max<int64_t>((n + num_ranges - 1) / num_ranges, grain);
+  num_ranges = (n + range_size - 1) / range_size;
+  absl::BlockingCounter counter(num_ranges - 1);
+  for (int64_t r = 1; r < num_ranges; ++r) {
+    // The ranges go in contiguous slabs to the nodes.
+    size_t node = r * pools->size() / num_ranges;
+    int64_t begin = r * range_size;
+    int64_t end = std::min(begin + range_size, n);
+    pools->pool(node)->Schedule([&fn, &counter, begin, end]() {
+      fn(begin, end);
+      counter.DecrementCount();
+    });
+  }
+  fn(0, std::min(range_size, n));
+  counter.Wait();
+}
+
 }  // namespace thread
 }  // namespace torch_xla
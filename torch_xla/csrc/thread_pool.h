@@ -1,6 +1,7 @@
 #ifndef XLA_CLIENT_THREAD_POOL_H_
 #define XLA_CLIENT_THREAD_POOL_H_
 
+#include <cstdint>
 #include <functional>
 
 namespace torch_xla {
@@ -10,6 +11,22 @@ namespace thread {
 // events.
 void Schedule(std::function<void()> fn);
 
+// Schedules a long running closure, like a background compilation, on a
+// dedicated pool so that it does not delay the closures scheduled with
+// Schedule().
+void ScheduleBackground(std::function<void()> fn);
+
+// Runs `fn(begin, end)` over contiguous ranges covering [0, n), of at least
+// `grain` elements each but for the last one, and returns once all of them
+// are done. The ranges run on the bulk pools, which hold the host copies of
+// the tensor data so that they do not queue ahead of the latency sensitive
+// closures of Schedule(). On a multi socket host there is one bulk pool per
+// NUMA node, its threads bound to the node, and [0, n) is split in one slab
+// of ranges per node, so that the neighbouring ranges of a copy touch the
+// memory from the same node. The calling thread runs the first range itself.
+void ParallelFor(int64_t n, int64_t grain,
+                 const std::function<void(int64_t, int64_t)>& fn);
+
 }  // namespace thread
 }  // namespace torch_xla
 
@@ -32,6 +32,18 @@ xla::XlaOp SliceOneToken(xla::XlaOp input) {
 
 }  // namespace
 
+bool TokenHandler::UseBarriers() {
+  static const bool use_barriers =
+      runtime::sys_util::GetEnvBool("XLA_CC_TOKEN_BARRIER", true);
+  return use_barriers;
+}
+
+xla::XlaOp TokenHandler::After(xla::XlaOp value, xla::XlaOp dependency) {
+  xla::XlaOp barrier = xla::OptimizationBarrier(
+      xla::Tuple(value.builder(), {value, dependency}));
+  return xla::GetTupleElement(barrier, 0);
+}
+
 xla::XlaOp TokenHandler::GetInput(xla::XlaOp input,
                                   const xla::Shape* input_shape) {
   static bool disable_numeric_token =
@@ -39,6 +51,9 @@ xla::XlaOp TokenHandler::GetInput(xla::XlaOp input,
   if (disable_numeric_token) {
     return input;
   }
+  if (UseBarriers()) {
+    return After(input, token_);
+  }
 
   if (input_shape == nullptr) {
     input_shape = &ShapeHelper::ShapeOfXlaOp(input);
@@ -53,6 +68,10 @@ xla::XlaOp TokenHandler::GetNewToken(xla::XlaOp result) {
   if (disable_numeric_token) {
     return token_;
   }
+  if (UseBarriers()) {
+    token_ = After(token_, result);
+    return token_;
+  }
 
   xla::XlaOp slice = SliceOneToken(result);
   // Token is always a numeric zero, and multiplying it for one element of the
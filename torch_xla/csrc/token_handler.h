@@ -5,10 +5,23 @@
 
 namespace torch_xla {
 
+// Sequences the collectives by threading a token through them. The token is a
+// numeric zero, rather than an XLA token which the collectives do not take.
+// By default (XLA_CC_TOKEN_BARRIER), the token is tied to the inputs and
+// results of the collectives by optimization barriers, which only order them.
+// Otherwise the token is added to the input and multiplied by an element of
+// the result, which costs a pass over the input and requires the token to be
+// a parameter, so that the compiler does not fold it away.
 class TokenHandler {
  public:
   explicit TokenHandler(xla::XlaOp token) : token_(token) {}
 
+  // Whether the collectives are sequenced by optimization barriers.
+  static bool UseBarriers();
+
+  // Returns `value` once `dependency` is computed too.
+  static xla::XlaOp After(xla::XlaOp value, xla::XlaOp dependency);
+
   xla::XlaOp GetInput(xla::XlaOp input, const xla::Shape* input_shape);
 
   xla::XlaOp GetNewToken(xla::XlaOp result);
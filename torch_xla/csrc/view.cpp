@@ -1,14 +1,18 @@
 #include "torch_xla/csrc/view.h"
 
+#include <torch/csrc/lazy/core/metrics.h>
 #include <torch/csrc/lazy/core/util.h>
 
 #include <algorithm>
 #include <functional>
 #include <numeric>
+#include <optional>
 
+#include "torch_xla/csrc/dtype.h"
 #include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/ops/as_strided.h"
 #include "torch_xla/csrc/ops/as_strided_view_update.h"
+#include "torch_xla/csrc/ops/cat.h"
 #include "torch_xla/csrc/ops/diagonal.h"
 #include "torch_xla/csrc/ops/diagonal_view_update.h"
 #include "torch_xla/csrc/ops/generic_slice.h"
@@ -20,6 +24,7 @@
 #include "torch_xla/csrc/ops/update_slice.h"
 #include "torch_xla/csrc/ops/view.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/util.h"
 #include "xla/shape_util.h"
 #include "xla/util.h"
@@ -31,31 +36,31 @@ torch::lazy::Value ApplyViewInfo(torch::lazy::Value ir_value,
                                  const ViewInfo& view_info) {
   switch (view_info.view_type) {
     case ViewInfo::Type::kSelect:
-      return torch::lazy::MakeNode<Select>(
+      return torch_xla::MakeNode<Select>(
           ir_value, view_info.select->dim, view_info.select->start,
           view_info.select->end, view_info.select->stride);
     case ViewInfo::Type::kNarrow:
-      return torch::lazy::MakeNode<GenericSlice>(ir_value, view_info.indices,
+      return torch_xla::MakeNode<GenericSlice>(ir_value, view_info.indices,
                                                  view_info.shape.dimensions());
     case ViewInfo::Type::kNoOp:
       return ir_value;
     case ViewInfo::Type::kPermute:
-      return torch::lazy::MakeNode<Permute>(ir_value, view_info.permutation);
+      return torch_xla::MakeNode<Permute>(ir_value, view_info.permutation);
     case ViewInfo::Type::kReshape:
-      return torch::lazy::MakeNode<ViewOp>(
+      return torch_xla::MakeNode<ViewOp>(
           ir_value,
           torch::lazy::ToVector<int64_t>(view_info.shape.dimensions()));
     case ViewInfo::Type::kResize:
-      return torch::lazy::MakeNode<Resize>(
+      return torch_xla::MakeNode<Resize>(
           ir_value,
           torch::lazy::ToVector<int64_t>(view_info.shape.dimensions()));
     case ViewInfo::Type::kAsStrided:
-      return torch::lazy::MakeNode<AsStrided>(
+      return torch_xla::MakeNode<AsStrided>(
           ir_value,
           torch::lazy::ToVector<int64_t>(view_info.shape.dimensions()),
           view_info.as_strided->stride, view_info.as_strided->offset);
     case ViewInfo::Type::kDiagonal:
-      return torch::lazy::MakeNode<Diagonal>(
+      return torch_xla::MakeNode<Diagonal>(
           ir_value, view_info.diagonal->offset, view_info.diagonal->dim1,
           view_info.diagonal->dim2);
     default:
@@ -79,39 +84,39 @@ torch::lazy::Value ApplyUpdate(torch::lazy::Value ir_value,
     const ViewInfo& view_info = update_data.view_infos[i - 1];
     switch (view_info.view_type) {
       case ViewInfo::Type::kSelect:
-        result = torch::lazy::MakeNode<Unselect>(
+        result = torch_xla::MakeNode<Unselect>(
             tmp_values[i - 1], result, view_info.select->dim,
             view_info.select->start, view_info.select->end,
             view_info.select->stride);
         break;
       case ViewInfo::Type::kNarrow:
-        result = torch::lazy::MakeNode<UpdateSlice>(tmp_values[i - 1], result,
+        result = torch_xla::MakeNode<UpdateSlice>(tmp_values[i - 1], result,
                                                     view_info.indices);
         break;
       case ViewInfo::Type::kNoOp:
         break;
       case ViewInfo::Type::kPermute:
-        result = torch::lazy::MakeNode<Permute>(
+        result = torch_xla::MakeNode<Permute>(
             result, xla::InversePermutation(view_info.permutation));
         break;
       case ViewInfo::Type::kReshape:
-        result = torch::lazy::MakeNode<ViewOp>(
+        result = torch_xla::MakeNode<ViewOp>(
             result, torch::lazy::ToVector<int64_t>(
                         view_info.source_shape.dimensions()));
         break;
       case ViewInfo::Type::kResize:
-        result = torch::lazy::MakeNode<Resize>(
+        result = torch_xla::MakeNode<Resize>(
             result, torch::lazy::ToVector<int64_t>(
                         view_info.source_shape.dimensions()));
         break;
       case ViewInfo::Type::kAsStrided:
-        result = torch::lazy::MakeNode<AsStridedViewUpdate>(
+        result = torch_xla::MakeNode<AsStridedViewUpdate>(
             tmp_values[i - 1], result,
             torch::lazy::ToVector<int64_t>(view_info.source_shape.dimensions()),
             view_info.as_strided->stride, view_info.as_strided->offset);
         break;
       case ViewInfo::Type::kDiagonal:
-        result = torch::lazy::MakeNode<DiagonalViewUpdate>(
+        result = torch_xla::MakeNode<DiagonalViewUpdate>(
             tmp_values[i - 1], result, view_info.diagonal->offset,
             view_info.diagonal->dim1, view_info.diagonal->dim2);
         break;
@@ -123,6 +128,104 @@ torch::lazy::Value ApplyUpdate(torch::lazy::Value ir_value,
   return result;
 }
 
+// The box of the alias written by an update, in the coordinates of the alias.
+struct UpdateRegion {
+  std::vector<int64_t> begin;
+  std::vector<int64_t> sizes;
+};
+
+// Returns the region written through `view_infos`, if only made of narrows,
+// unit stride selects and no-ops.
+std::optional<UpdateRegion> GetUpdateRegion(
+    const std::vector<ViewInfo>& view_infos) {
+  if (view_infos.empty() || !view_infos.front().source_shape.is_static()) {
+    return std::nullopt;
+  }
+  const xla::Shape& alias_shape = view_infos.front().source_shape;
+  UpdateRegion region;
+  region.begin.assign(alias_shape.rank(), 0);
+  region.sizes = runtime::util::ToVector<int64_t>(alias_shape.dimensions());
+  for (const ViewInfo& view_info : view_infos) {
+    switch (view_info.view_type) {
+      case ViewInfo::Type::kNoOp:
+        break;
+      case ViewInfo::Type::kReshape:
+        // The narrows spanning a whole dimension are recorded as reshapes.
+        if (view_info.shape.dimensions() !=
+            view_info.source_shape.dimensions()) {
+          return std::nullopt;
+        }
+        break;
+      case ViewInfo::Type::kNarrow:
+        for (int64_t dim = 0; dim < view_info.shape.rank(); ++dim) {
+          region.begin[dim] += view_info.indices[dim];
+          region.sizes[dim] = view_info.shape.dimensions(dim);
+        }
+        break;
+      case ViewInfo::Type::kSelect: {
+        const SelectInfo& select = *view_info.select;
+        if (select.stride != 1) {
+          return std::nullopt;
+        }
+        region.begin[select.dim] += select.start;
+        region.sizes[select.dim] = view_info.shape.dimensions(select.dim);
+        break;
+      }
+      default:
+        return std::nullopt;
+    }
+  }
+  return region;
+}
+
+bool Covers(const UpdateRegion& region, const UpdateRegion& other) {
+  for (size_t dim = 0; dim < region.begin.size(); ++dim) {
+    if (other.begin[dim] < region.begin[dim] ||
+        other.begin[dim] + other.sizes[dim] >
+            region.begin[dim] + region.sizes[dim]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the dimension along which `region` and `other` are adjacent and
+// equal otherwise, or -1 if none.
+int64_t AdjacentDim(const UpdateRegion& region, const UpdateRegion& other) {
+  int64_t adjacent_dim = -1;
+  for (size_t dim = 0; dim < region.begin.size(); ++dim) {
+    if (region.begin[dim] == other.begin[dim] &&
+        region.sizes[dim] == other.sizes[dim]) {
+      continue;
+    }
+    if (adjacent_dim >= 0 ||
+        (region.begin[dim] + region.sizes[dim] != other.begin[dim] &&
+         other.begin[dim] + other.sizes[dim] != region.begin[dim])) {
+      return -1;
+    }
+    adjacent_dim = dim;
+  }
+  return adjacent_dim;
+}
+
+// Whether `ir_value` has the shape of `region`, and the type of the alias.
+bool HasRegionShape(const torch::lazy::Value& ir_value,
+                    const UpdateRegion& region,
+                    const std::vector<ViewInfo>& view_infos) {
+  const xla::Shape& shape = GetXlaShape(ir_value);
+  return shape.is_static() &&
+         shape.element_type() ==
+             view_infos.front().source_shape.element_type() &&
+         runtime::util::ToVector<int64_t>(shape.dimensions()) == region.sizes;
+}
+
+// The number of updates an alias stacks before applying them to its value.
+size_t MaxPendingUpdates() {
+  static const size_t max_pending_updates =
+      runtime::sys_util::GetEnvInt("XLA_VIEW_MAX_PENDING_UPDATES", 64);
+  return max_pending_updates;
+}
+
 }  // namespace
 
 ViewInfo::ViewInfo(Type view_type, xla::Shape shape, xla::Shape source_shape)
@@ -171,15 +274,63 @@ ViewInfo::ViewInfo(Type view_type, const xla::Shape& source_shape,
 
 void Alias::Update(torch::lazy::Value ir_value,
                    std::vector<ViewInfo> view_infos) {
+  ++generation_;
   if (!updates_.empty() && updates_.back().view_infos == view_infos) {
     updates_.back().ir_value = std::move(ir_value);
-  } else {
-    updates_.push_back({std::move(ir_value), std::move(view_infos)});
+    return;
+  }
+  std::optional<UpdateRegion> region = GetUpdateRegion(view_infos);
+  if (region) {
+    // The updates of the regions this one overwrites are dropped.
+    size_t num_updates = updates_.size();
+    updates_.erase(
+        std::remove_if(updates_.begin(), updates_.end(),
+                       [&](const UpdateData& update_data) {
+                         std::optional<UpdateRegion> other =
+                             GetUpdateRegion(update_data.view_infos);
+                         return other && Covers(*region, *other);
+                       }),
+        updates_.end());
+    TORCH_LAZY_COUNTER("ViewUpdatesCoalesced", num_updates - updates_.size());
+  }
+  std::optional<UpdateRegion> last_region =
+      region && !updates_.empty() ? GetUpdateRegion(updates_.back().view_infos)
+                                  : std::nullopt;
+  int64_t dim = last_region ? AdjacentDim(*last_region, *region) : -1;
+  if (dim >= 0 && HasRegionShape(ir_value, *region, view_infos) &&
+      HasRegionShape(updates_.back().ir_value, *last_region, view_infos)) {
+    // The update of the region next to the last one merges with it, as the
+    // update of their union with the concatenation of their values.
+    const xla::Shape& alias_shape = view_infos.front().source_shape;
+    UpdateData& last = updates_.back();
+    bool last_first = last_region->begin[dim] < region->begin[dim];
+    std::vector<torch::lazy::Value> values =
+        last_first ? std::vector<torch::lazy::Value>{last.ir_value, ir_value}
+                   : std::vector<torch::lazy::Value>{ir_value, last.ir_value};
+    UpdateRegion merged = *region;
+    merged.begin[dim] = std::min(region->begin[dim], last_region->begin[dim]);
+    merged.sizes[dim] += last_region->sizes[dim];
+    ViewInfo view_info(
+        ViewInfo::Type::kNarrow,
+        xla::ShapeUtil::MakeShape(alias_shape.element_type(), merged.sizes),
+        alias_shape);
+    view_info.indices = std::move(merged.begin);
+    last.ir_value = torch_xla::MakeNode<Cat>(
+        values, dim, TorchTypeFromXlaType(alias_shape.element_type()));
+    last.view_infos = {std::move(view_info)};
+    TORCH_LAZY_COUNTER("ViewUpdatesCoalesced", 1);
+    return;
+  }
+  updates_.push_back({std::move(ir_value), std::move(view_infos)});
+  if (MaxPendingUpdates() > 0 && updates_.size() > MaxPendingUpdates()) {
+    SyncUpdateOperations();
   }
-  ++generation_;
 }
 
 torch::lazy::Value Alias::SyncUpdateOperations() {
+  if (!updates_.empty()) {
+    TORCH_LAZY_VALUE_METRIC("ViewUpdateDepth", updates_.size());
+  }
   for (auto& update_data : updates_) {
     ir_value_ = ApplyUpdate(ir_value_, update_data);
   }
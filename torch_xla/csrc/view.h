@@ -111,7 +111,10 @@ class Alias {
 
   // Appends an update to the IR value stored within the alias. The ir_value is
   // the value to be written, and view_infos represents the forward path from
-  // the alias's ir_value to the update ir_value.
+  // the alias's ir_value to the update ir_value. The updates of the regions
+  // the new one overwrites are dropped, and the update of a slice next to the
+  // one of the last update merges with it. The updates are applied once more
+  // than XLA_VIEW_MAX_PENDING_UPDATES of them are stacked.
   void Update(torch::lazy::Value ir_value, std::vector<ViewInfo> view_infos);
 
   torch::lazy::Value SyncUpdateOperations();
@@ -14,24 +14,34 @@
 #include <algorithm>
 #include <cmath>
 #include <condition_variable>
+#include <deque>
 #include <exception>
 #include <fstream>
 #include <functional>
+#include <map>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <variant>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
-#include "stablehlo/dialect/Serialization.h"  // from @stablehlo
+#include "torch_xla/csrc/all_reduce_buckets.h"
 #include "torch_xla/csrc/aten_xla_bridge.h"
+#include "torch_xla/csrc/device_data_cache.h"
 #include "torch_xla/csrc/dtype.h"
+#include "torch_xla/csrc/execution_future.h"
+#include "torch_xla/csrc/graph_stats.h"
 #include "torch_xla/csrc/helpers.h"
 #include "torch_xla/csrc/ir_dump_util.h"
 #include "torch_xla/csrc/layout_manager.h"
+#include "torch_xla/csrc/node_deduplicator.h"
 #include "torch_xla/csrc/ops/arithmetic_ir_ops.h"
 #include "torch_xla/csrc/ops/cast.h"
 #include "torch_xla/csrc/ops/device_data.h"
@@ -41,7 +51,11 @@
 #include "torch_xla/csrc/ops/ops.h"
 #include "torch_xla/csrc/ops/view.h"
 #include "torch_xla/csrc/ops/xla_ops.h"
+#include "torch_xla/csrc/parallel_lowering.h"
+#include "torch_xla/csrc/recompile_analyzer.h"
+#include "torch_xla/csrc/reusable_scope_lowering.h"
 #include "torch_xla/csrc/runtime/cache.h"
+#include "torch_xla/csrc/runtime/cache_storage.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
 #include "torch_xla/csrc/runtime/env_vars.h"
@@ -49,8 +63,12 @@
 #include "torch_xla/csrc/runtime/runtime.h"
 #include "torch_xla/csrc/runtime/stablehlo_helper.h"
 #include "torch_xla/csrc/runtime/sys_util.h"
+#include "torch_xla/csrc/runtime/tenant.h"
+#include "torch_xla/csrc/runtime/xla_coordinator.h"
 #include "torch_xla/csrc/runtime/xla_util.h"
 #include "torch_xla/csrc/shape_helper.h"
+#include "torch_xla/csrc/step_pipeline.h"
+#include "torch_xla/csrc/step_timeline.h"
 #include "torch_xla/csrc/tensor_util.h"
 #include "torch_xla/csrc/thread_pool.h"
 #include "torch_xla/csrc/torch_util.h"
@@ -70,7 +88,33 @@ torch::lazy::Value IrValueFromScalar(const at::Scalar& value,
                                      const torch::lazy::BackendDevice& device) {
   at::Tensor tensor = at::scalar_tensor(value, at::TensorOptions(scalar_type));
   torch::lazy::BackendDataPtr device_data = TensorToXlaData(tensor, device);
-  return torch::lazy::MakeNode<DeviceData>(std::move(device_data));
+  return torch_xla::MakeNode<DeviceData>(std::move(device_data));
+}
+
+// Returns the indices of the tensors on each device, in the order the devices
+// first appear, or no group at all when the tensors are on a single device.
+std::vector<std::vector<size_t>> GroupTensorsByDevice(
+    const std::vector<XLATensorPtr>& tensors) {
+  std::vector<std::vector<size_t>> groups;
+  bool single_device = true;
+  for (size_t i = 1; i < tensors.size() && single_device; ++i) {
+    single_device = tensors[i]->GetDevice() == tensors[0]->GetDevice();
+  }
+  if (single_device) {
+    return groups;
+  }
+  std::vector<torch::lazy::BackendDevice> group_devices;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const torch::lazy::BackendDevice& device = tensors[i]->GetDevice();
+    auto it = std::find(group_devices.begin(), group_devices.end(), device);
+    if (it == group_devices.end()) {
+      group_devices.push_back(device);
+      groups.emplace_back();
+      it = group_devices.end() - 1;
+    }
+    groups[it - group_devices.begin()].push_back(i);
+  }
+  return groups;
 }
 
 bool ShouldSyncIrValue(const torch::lazy::Value& ir_value) {
@@ -107,15 +151,438 @@ XLAGraphExecutor::ComputationCache* CreateComputationCache() {
              "or XLA_IR_DEBUG=1 is not recommended. Changes to the HLO "
              "metadata will not be reflected in loaded executables.";
     }
+    static const size_t kMaxStorageBytes = runtime::sys_util::GetEnvInt(
+        "XLA_PERSISTENT_CACHE_MAX_BYTES", 0);
+    static const bool asyncPersistentCacheWrites =
+        runtime::sys_util::GetEnvBool("XLA_PERSISTENT_CACHE_ASYNC_WRITE",
+                                      false);
+    static const bool prefetchPersistentCache =
+        runtime::sys_util::GetEnvBool("XLA_PERSISTENT_CACHE_PREFETCH", false);
+    // Keys already include the compilation environment hash. Tagging the
+    // stored values with it lets prefetching skip the ones written by other
+    // environments sharing the directory.
+    std::string index_tag = torch::lazy::HashToString(
+        runtime::GetComputationClient()->HashCompilationEnv());
     return new XLAGraphExecutor::PersistentCache(
-        kMaxCacheSize, persistentCacheDir, readonlyPersistentCache,
-        serialize_fn, deserialize_fn);
+        kMaxCacheSize, runtime::util::CreateCacheStorage(persistentCacheDir),
+        readonlyPersistentCache, serialize_fn, deserialize_fn, kMaxStorageBytes,
+        asyncPersistentCacheWrites, index_tag, prefetchPersistentCache);
+  }
+  static const size_t kCacheShards =
+      runtime::sys_util::GetEnvInt("XLA_COMPILATION_CACHE_SHARDS", 1);
+  if (kCacheShards > 1) {
+    return new XLAGraphExecutor::ShardedMemoryCache(
+        kMaxCacheSize, kCacheShards, /*name=*/"ComputationCache");
   }
   return new XLAGraphExecutor::MemoryCache(kMaxCacheSize);
 }
 
+// With XLA_PERSISTENT_CACHE_COORDINATED, the processes of a distributed run
+// sharing a persistent cache compile each graph only once. The owner of the
+// graph hash compiles and stores the executable, while the other processes
+// wait for it to be published and load it from the cache.
+bool UseCoordinatedCompilation() {
+  static const bool coordinated =
+      runtime::sys_util::GetEnvBool("XLA_PERSISTENT_CACHE_COORDINATED",
+                                    false) &&
+      !runtime::sys_util::GetEnvString("XLA_PERSISTENT_CACHE_PATH", "")
+           .empty() &&
+      !runtime::sys_util::GetEnvBool("XLA_PERSISTENT_CACHE_READ_ONLY", false);
+  if (!coordinated) {
+    return false;
+  }
+  runtime::ComputationClient* client = runtime::GetComputationClient();
+  return client->CoordinatorInitialized() &&
+         client->GetCoordinator().world_size() > 1;
+}
+
+bool IsCompilationOwner(const torch::lazy::hash_t& hash) {
+  runtime::XlaCoordinator& coordinator =
+      runtime::GetComputationClient()->GetCoordinator();
+  return torch::lazy::HashReducer()(hash) % coordinator.world_size() ==
+         coordinator.global_rank();
+}
+
+std::string GetCompilationKey(const torch::lazy::hash_t& hash) {
+  return "ptxla_compilation/" + torch::lazy::HashToString(hash);
+}
+
+bool SyncRootsOnly() {
+  static const bool roots_only =
+      runtime::sys_util::GetEnvBool("XLA_SYNC_ROOTS_ONLY", false);
+  return roots_only;
+}
+
+int64_t MaxSyncGraphSize() {
+  static const int64_t max_graph_size =
+      runtime::sys_util::GetEnvInt("XLA_SYNC_MAX_GRAPH_SIZE", 0);
+  return max_graph_size;
+}
+
+// Marks the device data read by the pending IR of `tensors` as read only, so
+// that it is not donated to the outputs of the graphs executed before that IR.
+// Returns the number of IR nodes pending on `tensors`.
+size_t ProtectDeviceData(absl::Span<const XLATensorPtr> tensors) {
+  std::vector<const torch::lazy::Node*> roots;
+  for (const XLATensorPtr& tensor : tensors) {
+    torch::lazy::Value ir_value = tensor->CurrentIrValue();
+    if (ir_value) {
+      roots.push_back(ir_value.node.get());
+    }
+  }
+  if (roots.empty()) {
+    return 0;
+  }
+  std::vector<const torch::lazy::Node*> post_order =
+      torch::lazy::Util::ComputePostOrder(roots);
+  for (const torch::lazy::Node* node : post_order) {
+    DeviceData* device_data = DeviceData::Cast(node);
+    if (device_data == nullptr) {
+      continue;
+    }
+    auto* data_info =
+        static_cast<torch::lazy::LazyGraphExecutor::DeviceDataInfo*>(
+            device_data->data()->info());
+    if (data_info == nullptr || !data_info->read_only) {
+      device_data->data()->SetInfo(
+          std::make_shared<torch::lazy::LazyGraphExecutor::DeviceDataInfo>(
+              data_info != nullptr ? data_info->tensor_id : -1,
+              /*read_only=*/true));
+    }
+  }
+  return post_order.size();
+}
+
+// Drops from `tensors` the ones with pending IR which are not step roots, if
+// some of the tensors are roots.
+void PruneNonRootTensors(std::vector<XLATensorPtr>* tensors) {
+  bool has_roots = std::any_of(
+      tensors->begin(), tensors->end(),
+      [](const XLATensorPtr& tensor) { return tensor->data()->is_step_root; });
+  if (!has_roots) {
+    return;
+  }
+  std::vector<XLATensorPtr> kept;
+  std::vector<XLATensorPtr> pruned;
+  for (XLATensorPtr& tensor : *tensors) {
+    torch::lazy::Value ir_value = tensor->CurrentIrValue();
+    if (tensor->data()->is_step_root || !ir_value ||
+        DeviceData::Cast(ir_value.node.get()) != nullptr) {
+      kept.push_back(std::move(tensor));
+    } else {
+      TF_VLOG(5) << "Pruning live tensor " << tensor->GetUniqueId()
+                 << ", shape=" << tensor->shape().get();
+      pruned.push_back(std::move(tensor));
+    }
+  }
+  if (!pruned.empty()) {
+    size_t pruned_graph_size = ProtectDeviceData(pruned);
+    TORCH_LAZY_COUNTER("PrunedLiveTensors", pruned.size());
+    TORCH_LAZY_VALUE_METRIC("PrunedGraphSize", pruned_graph_size);
+    TF_VLOG(3) << "Pruned " << pruned.size()
+               << " live tensors which are not step roots, with "
+               << pruned_graph_size << " pending IR nodes";
+  }
+  tensors->swap(kept);
+}
+
+// Splits `tensors` in groups whose pending IR graphs have at most
+// `max_graph_size` nodes, except for single tensors with larger graphs. The
+// nodes shared by several groups are computed by each of them.
+std::vector<std::vector<XLATensorPtr>> SplitTensorsGraph(
+    const std::vector<XLATensorPtr>& tensors, size_t max_graph_size) {
+  std::vector<std::vector<XLATensorPtr>> groups(1);
+  torch::lazy::Util::EmissionMap emission_map;
+  size_t graph_size = 0;
+  for (const XLATensorPtr& tensor : tensors) {
+    torch::lazy::Value ir_value = tensor->CurrentIrValue();
+    if (ir_value) {
+      size_t new_nodes =
+          torch::lazy::Util::ComputePostOrder(ir_value.node.get(),
+                                              &emission_map)
+              .size();
+      if (graph_size > 0 && graph_size + new_nodes > max_graph_size) {
+        groups.emplace_back();
+        emission_map.clear();
+        new_nodes = torch::lazy::Util::ComputePostOrder(ir_value.node.get(),
+                                                        &emission_map)
+                        .size();
+        graph_size = 0;
+      }
+      graph_size += new_nodes;
+    }
+    groups.back().push_back(tensor);
+  }
+  return groups;
+}
+
+// Evicts the coldest computations of `cache` when the memory of `device` is
+// above XLA_COMPILATION_CACHE_EVICT_MEMORY_FRACTION of its limit, so that a
+// process sharing its devices gives the memory of the executables it no longer
+// runs back before compiling new ones. The executables still used by pending
+// executions are released once they complete.
+void MaybeEvictColdComputations(const torch::lazy::BackendDevice& device,
+                                XLAGraphExecutor::ComputationCache* cache) {
+  static const double evict_fraction = runtime::sys_util::GetEnvDouble(
+      "XLA_COMPILATION_CACHE_EVICT_MEMORY_FRACTION", 0.0);
+  static const size_t evict_count = runtime::sys_util::GetEnvInt(
+      "XLA_COMPILATION_CACHE_EVICT_COUNT", 8);
+  if (evict_fraction <= 0.0) {
+    return;
+  }
+  std::string memory_device =
+      device == GetVirtualDevice()
+          ? runtime::GetComputationClient()->GetLocalDevices().front()
+          : device.toString();
+  runtime::ComputationClient::MemoryInfo info =
+      runtime::GetComputationClient()->GetMemoryInfo(memory_device);
+  if (info.bytes_limit > 0 &&
+      info.bytes_used > evict_fraction * info.bytes_limit) {
+    TORCH_LAZY_COUNTER("ComputationCacheMemoryPressureEvictions",
+                       cache->Shrink(evict_count));
+  }
+}
+
+// The cut, in computed nodes, splitting the graph in two halves when the
+// execution of its executable needs more than XLA_GRAPH_SPLIT_MEMORY_FRACTION
+// of the free memory of the device, std::nullopt to run it whole.
+std::optional<size_t> GraphSplitCut(
+    const runtime::ComputationClient::Computation& computation,
+    const torch::lazy::BackendDevice& device,
+    absl::Span<const torch::lazy::Node* const> post_order) {
+  static const double split_fraction = runtime::sys_util::GetEnvDouble(
+      "XLA_GRAPH_SPLIT_MEMORY_FRACTION", 0.0);
+  if (split_fraction <= 0.0 || device == GetVirtualDevice() ||
+      UseVirtualDevice()) {
+    return std::nullopt;
+  }
+  std::optional<runtime::ComputationClient::CompiledMemoryStats> stats =
+      computation.GetCompiledMemoryStats();
+  if (!stats.has_value()) {
+    return std::nullopt;
+  }
+  size_t computed_nodes = 0;
+  for (const torch::lazy::Node* node : post_order) {
+    if (node->op() != xla_device_data) {
+      ++computed_nodes;
+    }
+  }
+  if (computed_nodes < 2) {
+    return std::nullopt;
+  }
+  runtime::ComputationClient::MemoryInfo info =
+      runtime::GetComputationClient()->GetMemoryInfo(device.toString());
+  int64_t free_bytes = info.bytes_limit - info.bytes_used;
+  if (info.bytes_limit <= 0 ||
+      stats->ExecutionBytes() <= split_fraction * free_bytes) {
+    return std::nullopt;
+  }
+  TF_VLOG(3) << "Splitting graph of " << computed_nodes
+             << " computed nodes, whose execution needs "
+             << stats->ExecutionBytes() << " bytes with " << free_bytes
+             << " bytes free on " << device;
+  return computed_nodes / 2;
+}
+
+thread_local runtime::ExecutionLane g_execution_lane =
+    runtime::ExecutionLane::kDefault;
+thread_local int64_t g_intra_op_threads = 0;
+thread_local runtime::ComputationClient::CompileOptionOverrides
+    g_compile_option_overrides;
+thread_local std::shared_ptr<XLAGraphExecutor::CallSequence>
+    g_call_sequence_capture;
+
+runtime::ComputationClient::CompileInstance CloneCompileInstance(
+    const runtime::ComputationClient::CompileInstance& instance) {
+  runtime::ComputationClient::CompileInstance clone(
+      xla::XlaComputation(instance.computation.proto()),
+      instance.compilation_device, instance.devices, instance.output_shape,
+      instance.parameter_is_tupled_arguments, instance.is_sharded,
+      instance.allow_spmd_sharding_propagation_to_output,
+      instance.use_auto_spmd_partitioning, instance.auto_spmd_mesh_shape,
+      instance.auto_spmd_mesh_ids);
+  clone.backend_optimization_level = instance.backend_optimization_level;
+  clone.intra_op_threads = instance.intra_op_threads;
+  clone.argument_memory_kinds = instance.argument_memory_kinds;
+  clone.output_memory_kinds = instance.output_memory_kinds;
+  clone.auto_layout_parameters = instance.auto_layout_parameters;
+  clone.option_overrides = instance.option_overrides;
+  return clone;
+}
+
+torch::lazy::hash_t CompileOptionOverridesHash(
+    const runtime::ComputationClient::CompileOptionOverrides& overrides) {
+  torch::lazy::hash_t hash = torch::lazy::MHash(overrides.size());
+  for (const auto& [name, value] : overrides) {
+    hash = torch::lazy::HashCombine(
+        hash, torch::lazy::MHash(name, value.index()));
+    hash = torch::lazy::HashCombine(
+        hash, std::visit(
+                  [](const auto& option) { return torch::lazy::Hash(option); },
+                  value));
+  }
+  return hash;
+}
+
+// The key of the executables compiled from the same HLO with the same options,
+// whatever the graph hashes of the IR lowered to it.
+torch::lazy::hash_t CompiledHloFingerprint(
+    const runtime::ComputationClient::CompileInstance& instance) {
+  auto indices_hash = [](const auto& values) {
+    std::vector<int64_t> indices(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+      indices[i] = static_cast<int64_t>(values[i]);
+    }
+    return torch::lazy::Hash(indices);
+  };
+  torch::lazy::hash_t hash =
+      runtime::util::ComputationFingerprint(instance.computation);
+  hash = torch::lazy::HashCombine(
+      hash, torch::lazy::MHash(instance.compilation_device, instance.devices,
+                               instance.parameter_is_tupled_arguments,
+                               instance.is_sharded,
+                               instance.use_auto_spmd_partitioning,
+                               instance.auto_spmd_mesh_shape,
+                               instance.auto_spmd_mesh_ids));
+  hash = torch::lazy::HashCombine(
+      hash,
+      torch::lazy::MHash(instance.allow_spmd_sharding_propagation_to_output,
+                         instance.backend_optimization_level,
+                         instance.intra_op_threads,
+                         instance.stablehlo_bytecode));
+  hash = torch::lazy::HashCombine(
+      hash, indices_hash(instance.argument_memory_kinds));
+  hash = torch::lazy::HashCombine(
+      hash, indices_hash(instance.output_memory_kinds));
+  hash = torch::lazy::HashCombine(
+      hash, indices_hash(instance.auto_layout_parameters));
+  return torch::lazy::HashCombine(
+      hash, CompileOptionOverridesHash(instance.option_overrides));
+}
+
+// The cost of an auto-sharding candidate, lower is better: the bytes the
+// execution accesses as estimated by the compiler, which accounts for the
+// collectives the partitioning adds, then the device memory it needs.
+std::pair<double, int64_t> AutoShardingCost(
+    const runtime::ComputationClient::Computation& computation) {
+  std::map<std::string, double> cost_analysis = computation.GetCostAnalysis();
+  auto it = cost_analysis.find("bytes accessed");
+  std::optional<runtime::ComputationClient::CompiledMemoryStats> memory_stats =
+      computation.GetCompiledMemoryStats();
+  return {it != cost_analysis.end() ? it->second : 0.0,
+          memory_stats ? memory_stats->ExecutionBytes() : 0};
+}
+
+// Records the execution of `future` in the GraphStats once it is done.
+void RecordExecutionStats(const torch::lazy::hash_t& hash,
+                          ExecutionFuture* future) {
+  future->AddDoneCallback(
+      [hash, start_ns = runtime::sys_util::NowNs()](const std::string& error) {
+        GraphStats::Get()->RecordExecution(hash, start_ns, !error.empty());
+      });
+}
+
+// With XLA_REUSE_OUTPUT_BUFFERS, adds the recycled output parameters (see
+// ComputationClient::kRecycledOutputParameter) of the outputs of the graph
+// left without a donated parameter of the same shape, whose buffers are then
+// the outputs of the previous execution rather than new allocations. Returns
+// the number of parameters added.
+size_t AddRecycledOutputParameters(size_t num_results,
+                                   absl::Span<const size_t> donor_indices,
+                                   LoweringContext* lowering_ctx) {
+  static const bool reuse_output_buffers =
+      runtime::sys_util::GetEnvBool("XLA_REUSE_OUTPUT_BUFFERS", false);
+  if (!reuse_output_buffers || lowering_ctx->has_tupled_parameters()) {
+    return 0;
+  }
+  std::vector<xla::Shape> output_shapes;
+  for (size_t i = 0; i < num_results; ++i) {
+    output_shapes.push_back(
+        ShapeHelper::ShapeOfXlaOp(lowering_ctx->GetResult(i)));
+  }
+  const std::vector<torch::lazy::BackendDataPtr>& parameters_data =
+      lowering_ctx->GetParametersData();
+  for (size_t index : donor_indices) {
+    const xla::Shape& shape = UnwrapXlaData(parameters_data[index])->shape();
+    auto it = std::find_if(output_shapes.begin(), output_shapes.end(),
+                           [&](const xla::Shape& output_shape) {
+                             return xla::ShapeUtil::Compatible(output_shape,
+                                                               shape);
+                           });
+    if (it != output_shapes.end()) {
+      output_shapes.erase(it);
+    }
+  }
+  size_t first_index = parameters_data.size();
+  for (size_t i = 0; i < output_shapes.size(); ++i) {
+    xla::Parameter(lowering_ctx->builder(), first_index + i, output_shapes[i],
+                   absl::StrCat(runtime::ComputationClient::
+                                    kRecycledOutputParameter,
+                                i));
+    lowering_ctx->AddBufferDonor(first_index + i);
+  }
+  TORCH_LAZY_VALUE_METRIC("RecycledOutputParameters", output_shapes.size());
+  return output_shapes.size();
+}
+
+// The uploads of XLAGraphExecutor::CreateTensorsDataAsync() to a device, run
+// in order on a background thread holding the lock of the device, which is
+// released once the queue is drained.
+struct UploadQueue {
+  struct Upload {
+    std::vector<at::Tensor> tensors;
+    std::vector<std::string> devices;
+    std::vector<torch::lazy::BackendDataPtr> placeholders;
+  };
+
+  std::mutex mutex;
+  std::deque<Upload> uploads;
+  bool closed = false;
+  std::vector<torch::lazy::ExceptionCleanup> unlocker;
+};
+
+void RunUploads(const std::shared_ptr<UploadQueue>& queue) {
+  std::exception_ptr error;
+  while (true) {
+    UploadQueue::Upload upload;
+    {
+      std::lock_guard<std::mutex> lock(queue->mutex);
+      if (queue->uploads.empty()) {
+        queue->closed = true;
+        break;
+      }
+      upload = std::move(queue->uploads.front());
+      queue->uploads.pop_front();
+    }
+    try {
+      std::vector<torch::lazy::BackendDataPtr> handles =
+          CreateTensorsData(upload.tensors, upload.devices);
+      for (size_t i = 0; i < handles.size(); ++i) {
+        upload.placeholders[i]->Assign(*handles[i]);
+      }
+    } catch (...) {
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  }
+  // As for a failed execution, the error is surfaced when the device is
+  // locked next, by the execution waiting for the data or a barrier.
+  if (error) {
+    for (auto& unlocker : queue->unlocker) {
+      unlocker.SetStatus(error);
+    }
+  }
+  queue->unlocker.clear();
+}
+
 }  // namespace
 
+XLAGraphExecutor::DeviceContextArena::DeviceContextArena()
+    : constant_data_cache(std::make_unique<ConstantDataCache>(
+          runtime::sys_util::GetEnvInt("XLA_CONSTANT_DATA_CACHE_SIZE",
+                                       1024))) {}
+
 auto XLAGraphExecutor::DeviceContextArena::Get() -> DeviceContextArena* {
   static DeviceContextArena* arena = new DeviceContextArena();
   return arena;
@@ -145,10 +612,24 @@ torch::lazy::Value XLAGraphExecutor::DeviceContextArena::GetRngSeed(
   static const uint64_t kSeedAdd = 2531011;
   DeviceContext* devctx = GetDeviceContext(device);
   std::lock_guard<std::mutex> lock(devctx->lock);
+  static const bool counter_seeds =
+      runtime::sys_util::GetEnvBool("XLA_RNG_COUNTER_SEEDS", false);
   if (!devctx->seed_ir_value) {
     devctx->seed_ir_value =
         IrValueFromScalar(MakeIntScalar(devctx->seed), kSeedType, device);
   }
+  if (counter_seeds) {
+    // The seed of every random op is the root seed plus the index of the op
+    // since the root was set, rather than the update of the previous seed, so
+    // that the seeds of the random ops do not chain. The counter based bit
+    // generators decorrelate the neighboring seeds. The running seed is the
+    // root plus the index, the seed of the last op.
+    devctx->running_seed += 1;
+    torch::lazy::Value index =
+        ScalarOp(MakeIntScalar(devctx->running_seed - devctx->seed),
+                 MakeXlaPrimitiveType(kSeedType, &device));
+    return devctx->seed_ir_value + index;
+  }
   // Keep the running seed as scalar as well, so we can return it directly
   // without executing graphs.
   devctx->running_seed = kSeedAdd + kSeedMul * devctx->running_seed;
@@ -171,11 +652,30 @@ XLAGraphExecutor::DeviceContextArena::GetBaseSeedData(
   at::Tensor tensor = at::scalar_tensor(MakeIntScalar(devctx->seed),
                                         at::TensorOptions(kSeedType));
   torch::lazy::BackendDataPtr device_data = TensorToXlaData(tensor, device);
-  devctx->seed_ir_value = torch::lazy::MakeNode<DeviceData>(device_data);
+  devctx->seed_ir_value = torch_xla::MakeNode<DeviceData>(device_data);
   devctx->running_seed = devctx->seed;
   return torch_xla::DeviceData::Cast(devctx->seed_ir_value.node.get())->data();
 }
 
+torch::lazy::BackendDataPtr
+XLAGraphExecutor::DeviceContextArena::GetConstantData(
+    const at::Tensor& tensor, const torch::lazy::BackendDevice& device) {
+  at::Tensor contiguous = tensor.contiguous();
+  std::string key = absl::StrCat(
+      device.toString(), "|", c10::toString(contiguous.scalar_type()), "|",
+      absl::StrJoin(contiguous.sizes(), ","), "|");
+  key.append(static_cast<const char*>(contiguous.const_data_ptr()),
+             contiguous.nbytes());
+  torch::lazy::BackendDataPtr data = constant_data_cache->Get(key);
+  if (data != nullptr) {
+    TORCH_LAZY_COUNTER("ConstantDataCacheHit", 1);
+    return data;
+  }
+  TORCH_LAZY_COUNTER("ConstantDataCacheMiss", 1);
+  return constant_data_cache->Add(std::move(key),
+                                  TensorToXlaData(contiguous, device));
+}
+
 void XLAGraphExecutor::DeviceContextArena::SaveGraphAsString(
     torch::lazy::hash_t hash, absl::Span<const XLATensorPtr> tensors,
     const std::vector<size_t>* indices, DebugUtil::GraphFormat format) {
@@ -223,8 +723,8 @@ torch::lazy::Value XLAGraphExecutor::DeviceContextArena::IrValueFromScalar(
     const at::Scalar& value, at::ScalarType scalar_type,
     const torch::lazy::BackendDevice& device) {
   at::Tensor tensor = at::scalar_tensor(value, at::TensorOptions(scalar_type));
-  torch::lazy::BackendDataPtr device_data = TensorToXlaData(tensor, device);
-  return torch::lazy::MakeNode<DeviceData>(std::move(device_data));
+  torch::lazy::BackendDataPtr device_data = GetConstantData(tensor, device);
+  return torch_xla::MakeNode<DeviceData>(std::move(device_data));
 }
 
 XLAGraphExecutor::Async::Async(
@@ -236,6 +736,13 @@ XLAGraphExecutor::Async::Async(
                                             nullptr),
       cached_computation(std::move(cached_computation)) {}
 
+void XLAGraphExecutor::Async::WaitExecution() {
+  mwait.Wait();
+  for (std::shared_ptr<Async>& device_async : device_asyncs) {
+    device_async->mwait.Wait();
+  }
+}
+
 XLAGraphExecutor* XLAGraphExecutor::Get() {
   static XLAGraphExecutor arena = XLAGraphExecutor();
   return &arena;
@@ -253,9 +760,99 @@ void XLAGraphExecutor::UnregisterTensor(torch::lazy::LazyTensor::Data* data) {
 }
 
 void XLAGraphExecutor::ApplyEagerSync(std::vector<XLATensorPtr>& tensors) {
+  if (tensors.size() == 1 && TryRunEagerOp(tensors.front())) {
+    return;
+  }
   SyncTensorsGraph(&tensors, {}, /*wait=*/false, /*sync_ltc_data=*/false);
 }
 
+bool XLAGraphExecutor::TryRunEagerOp(const XLATensorPtr& tensor) {
+  static const size_t cache_size =
+      runtime::sys_util::GetEnvInt("XLA_EAGER_OP_CACHE_SIZE", 1024);
+  torch::lazy::Value ir_value = tensor->CurrentIrValue();
+  if (cache_size == 0 || !ir_value || UseVirtualDevice() ||
+      tensor->sharding_spec() != nullptr) {
+    return false;
+  }
+  const XlaNode* node = dynamic_cast<const XlaNode*>(ir_value.node.get());
+  if (node == nullptr || node->op() == xla_device_data ||
+      node->xla_shape(ir_value.index).is_dynamic() ||
+      node->GetSharding(ir_value.index) != nullptr) {
+    return false;
+  }
+  for (const torch::lazy::Output& operand : node->operands()) {
+    DeviceData* device_data = DeviceData::Cast(operand.node);
+    if (device_data == nullptr ||
+        UnwrapXlaData(device_data->data())->memory_kind() !=
+            runtime::MemoryKind::kDevice) {
+      return false;
+    }
+  }
+
+  const torch::lazy::BackendDevice& device = tensor->GetDevice();
+  // Waits for the pending executions, whose outputs may be the operands.
+  std::vector<torch::lazy::ExceptionCleanup> unlocker =
+      DeviceLockerArena::Get()->LockDevices({device});
+  std::vector<runtime::ComputationClient::DataPtr> arguments;
+  for (const torch::lazy::Output& operand : node->operands()) {
+    runtime::ComputationClient::DataPtr data =
+        UnwrapXlaData(DeviceData::Cast(operand.node)->data());
+    if (!data->HasValue() || data->HasSharding()) {
+      return false;
+    }
+    arguments.push_back(std::move(data));
+  }
+
+  static MemoryCache* cache = new MemoryCache(cache_size);
+  torch::lazy::hash_t key = torch::lazy::HashCombine(
+      torch::lazy::HashCombine(node->hash(),
+                               static_cast<int64_t>(ir_value.index)),
+      torch::lazy::StringHash(device.toString().c_str()));
+  ComputationCache::TypePtr cached_computation = cache->Get(key);
+  if (cached_computation == nullptr) {
+    TORCH_LAZY_COUNTER("EagerOpCacheMiss", 1);
+    // One parameter per operand, so that the executable does not depend on
+    // which operands share their data.
+    LoweringContext lowering_ctx("EagerOp", device);
+    for (size_t i = 0; i < node->operands().size(); ++i) {
+      const torch::lazy::Output& operand = node->operand(i);
+      lowering_ctx.AssignOutputOp(
+          operand, xla::Parameter(lowering_ctx.builder(), i,
+                                  static_cast<const XlaNode*>(operand.node)
+                                      ->xla_shape(operand.index),
+                                  absl::StrCat("p", i)));
+    }
+    lowering_ctx.LowerNode(node);
+    xla::XlaComputation computation = ConsumeValue(lowering_ctx.BuildXla(
+        lowering_ctx.GetOutputOp(torch::lazy::Output(node, ir_value.index))));
+    xla::ProgramShape program_shape =
+        ConsumeValue(computation.GetProgramShape());
+    xla::Shape shape = MakeShapeWithDeviceLayout(
+        program_shape.result(), static_cast<XlaDeviceType>(device.type()));
+    std::vector<runtime::ComputationClient::CompileInstance> instances;
+    instances.emplace_back(
+        std::move(computation), device.toString(),
+        runtime::GetComputationClient()->GetCompilationDevices(
+            device.toString(),
+            runtime::GetComputationClient()->GetLocalDevices()),
+        &shape);
+    cached_computation = cache->Add(
+        key, std::make_shared<CachedComputation>(
+                 runtime::GetComputationClient()
+                     ->Compile(std::move(instances))
+                     .front()));
+  } else {
+    TORCH_LAZY_COUNTER("EagerOpCacheHit", 1);
+  }
+
+  std::vector<runtime::ComputationClient::DataPtr> results =
+      runtime::GetComputationClient()->ExecuteComputation(
+          *cached_computation->computation, arguments, device.toString());
+  XLA_CHECK_EQ(results.size(), 1);
+  tensor->SetXlaData(std::move(results.front()));
+  return true;
+}
+
 torch::lazy::Value XLAGraphExecutor::GetDeviceDataIrValue(
     const at::Scalar& value, xla::PrimitiveType type,
     const torch::lazy::BackendDevice& device) {
@@ -264,18 +861,102 @@ torch::lazy::Value XLAGraphExecutor::GetDeviceDataIrValue(
   data->SetInfo(
       std::make_shared<torch::lazy::LazyGraphExecutor::DeviceDataInfo>(
           /*tensor_id=*/-1, /*read_only=*/true));
-  return torch::lazy::MakeNode<DeviceData>(std::move(data));
+  return torch_xla::MakeNode<DeviceData>(std::move(data));
+}
+
+bool XLAGraphExecutor::IsCachedConstant(const at::Tensor& tensor) {
+  static const int64_t max_constant_bytes =
+      runtime::sys_util::GetEnvInt("XLA_CONSTANT_DATA_MAX_BYTES", 1024);
+  return tensor.device().is_cpu() &&
+         static_cast<int64_t>(tensor.nbytes()) <= max_constant_bytes;
+}
+
+torch::lazy::BackendDataPtr XLAGraphExecutor::GetConstantData(
+    const at::Tensor& tensor, const torch::lazy::BackendDevice& device) {
+  return DeviceContextArena::Get()->GetConstantData(tensor, device);
+}
+
+bool XLAGraphExecutor::UseAsyncTensorUploads() {
+  static const bool async_uploads =
+      runtime::sys_util::GetEnvBool("XLA_ASYNC_TENSOR_UPLOADS", false) &&
+      !UseVirtualDevice();
+  return async_uploads;
+}
+
+std::vector<torch::lazy::BackendDataPtr>
+XLAGraphExecutor::CreateTensorsDataAsync(
+    const std::vector<at::Tensor>& tensors,
+    const std::vector<std::string>& devices) {
+  XLA_CHECK_EQ(tensors.size(), devices.size());
+  static std::mutex* queues_mutex = new std::mutex();
+  static auto* queues =
+      new std::map<std::string, std::shared_ptr<UploadQueue>>();
+  std::vector<runtime::ComputationClient::DataPtr> placeholders;
+  placeholders.reserve(tensors.size());
+  std::map<std::string, UploadQueue::Upload> device_uploads;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    torch::lazy::BackendDevice device = ParseDeviceString(devices[i]);
+    placeholders.push_back(
+        runtime::GetComputationClient()->CreateDataPlaceholder(
+            devices[i], CreateComputationShapeFromTensor(tensors[i], &device)));
+  }
+  std::vector<torch::lazy::BackendDataPtr> datas = WrapXlaData(placeholders);
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    UploadQueue::Upload& upload = device_uploads[devices[i]];
+    upload.tensors.push_back(tensors[i]);
+    upload.devices.push_back(devices[i]);
+    upload.placeholders.push_back(datas[i]);
+  }
+  TORCH_LAZY_COUNTER("AsyncTensorUploads", 1);
+  TORCH_LAZY_COUNTER("AsyncTensorUploadTensors", tensors.size());
+
+  std::lock_guard<std::mutex> lock(*queues_mutex);
+  for (auto& device_upload : device_uploads) {
+    std::shared_ptr<UploadQueue>& queue = (*queues)[device_upload.first];
+    if (queue != nullptr) {
+      // The uploads of a model arrive one tensor at a time, and join the ones
+      // in flight rather than waiting for them to take the device lock.
+      std::lock_guard<std::mutex> queue_lock(queue->mutex);
+      if (!queue->closed) {
+        queue->uploads.push_back(std::move(device_upload.second));
+        continue;
+      }
+    }
+    queue = std::make_shared<UploadQueue>();
+    // Taken on the calling thread, so that the uploads come after the
+    // executions scheduled before them, and the ones scheduled after them
+    // wait for the data, as they do for the outputs of the previous ones.
+    queue->unlocker = DeviceLockerArena::Get()->LockDevices(
+        {ParseDeviceString(device_upload.first)});
+    queue->uploads.push_back(std::move(device_upload.second));
+    thread::ScheduleBackground([queue]() { RunUploads(queue); });
+  }
+  return datas;
 }
 
 torch::lazy::Value XLAGraphExecutor::GetIrValueForScalar(
     const at::Scalar& value, xla::PrimitiveType type,
     const torch::lazy::BackendDevice& device) {
   if (torch::lazy::IsSpecialScalar(value)) {
+    TORCH_LAZY_COUNTER("BakedScalar", 1);
     return ScalarOp(std::move(value), type);
   }
+  TORCH_LAZY_COUNTER("HoistedScalar", 1);
   return GetDeviceDataIrValue(value, type, device);
 }
 
+torch::lazy::Value XLAGraphExecutor::GetIrValueForConstantScalar(
+    const at::Scalar& value, xla::PrimitiveType type,
+    const torch::lazy::BackendDevice& device) {
+  static const bool hoist_scalars =
+      runtime::sys_util::GetEnvBool("XLA_HOIST_SCALARS", false);
+  if (hoist_scalars) {
+    return GetIrValueForScalar(value, type, device);
+  }
+  TORCH_LAZY_COUNTER("BakedScalar", 1);
+  return ScalarOp(value, type);
+}
+
 torch::lazy::Value XLAGraphExecutor::GetIrValueForScalar(
     const at::Scalar& value, const torch::lazy::BackendDevice& device) {
   return GetIrValueForScalar(
@@ -288,7 +969,7 @@ torch::lazy::Value XLAGraphExecutor::GetIrValueForScalar(
     const torch::lazy::BackendDevice& device) {
   torch::lazy::Value ir_value = GetIrValueForScalar(value, type, device);
   if (!dimensions.empty()) {
-    ir_value = torch::lazy::MakeNode<Expand>(
+    ir_value = torch_xla::MakeNode<Expand>(
         ir_value, torch::lazy::ToVector<int64_t>(dimensions));
   }
   return ir_value;
@@ -299,7 +980,7 @@ torch::lazy::Value XLAGraphExecutor::GetIrValueForScalar(
     c10::SymIntArrayRef sym_size, const torch::lazy::BackendDevice& device) {
   torch::lazy::Value ir_value = GetIrValueForScalar(value, type, device);
   SymIntElements size_elements = SymIntElements(sym_size);
-  return torch::lazy::MakeNode<ExpandSymInt>(ir_value, size_elements);
+  return torch_xla::MakeNode<ExpandSymInt>(ir_value, size_elements);
 }
 
 torch::lazy::Value XLAGraphExecutor::GetIrValueForScalar(
@@ -331,7 +1012,7 @@ torch::lazy::Value XLAGraphExecutor::GetIrValueForScalar(
           : shape.element_type();
   torch::lazy::Value ir_value =
       GetIrValueForScalar(value, primitive_type, device);
-  return torch::lazy::MakeNode<ExpandSymInt>(ir_value, size_elements);
+  return torch_xla::MakeNode<ExpandSymInt>(ir_value, size_elements);
 }
 
 torch::lazy::Value XLAGraphExecutor::GetRngSeed(
@@ -362,6 +1043,30 @@ bool XLAGraphExecutor::GetAliasWithBufferDonorConfig() {
   return DeviceContextArena::Get()->GetAliasWithBufferDonorConfig();
 }
 
+void XLAGraphExecutor::SetExecutionLane(runtime::ExecutionLane lane) {
+  g_execution_lane = lane;
+}
+
+runtime::ExecutionLane XLAGraphExecutor::GetExecutionLane() {
+  return g_execution_lane;
+}
+
+void XLAGraphExecutor::SetIntraOpThreads(int64_t threads) {
+  g_intra_op_threads = threads;
+}
+
+int64_t XLAGraphExecutor::GetIntraOpThreads() { return g_intra_op_threads; }
+
+void XLAGraphExecutor::SetCompileOptionOverrides(
+    runtime::ComputationClient::CompileOptionOverrides overrides) {
+  g_compile_option_overrides = std::move(overrides);
+}
+
+const runtime::ComputationClient::CompileOptionOverrides&
+XLAGraphExecutor::GetCompileOptionOverrides() {
+  return g_compile_option_overrides;
+}
+
 std::string XLAGraphExecutor::DumpHloComputation(
     const std::vector<XLATensorPtr>& tensors, EmitMode mode) {
   std::vector<torch::lazy::Value> ir_values;
@@ -397,7 +1102,8 @@ void XLAGraphExecutor::SyncTensorsGraph(std::vector<XLATensorPtr>* tensors,
   auto async =
       SyncTensorsGraphInternal(tensors, devices, config, warm_up_cache_only);
   if (wait && async != nullptr && !warm_up_cache_only) {
-    async->mwait.Wait();
+    async->WaitExecution();
+    StepPipeline::Get()->Drain(StepPipeline::DrainCause::kSyncWait);
   }
 }
 
@@ -409,6 +1115,25 @@ void XLAGraphExecutor::SyncLiveTensorsGraph(
   auto tensors = GetLiveTensors(device);
   TF_VLOG(4) << tensors.size() << " live tensors: devices=("
              << c10::Join(",", devices) << ")";
+  if (SyncRootsOnly()) {
+    PruneNonRootTensors(&tensors);
+  }
+  if (MaxSyncGraphSize() > 0) {
+    std::vector<std::vector<XLATensorPtr>> groups =
+        SplitTensorsGraph(tensors, MaxSyncGraphSize());
+    if (groups.size() > 1) {
+      TORCH_LAZY_COUNTER("SplitTensorsGraph", groups.size() - 1);
+      TF_VLOG(3) << "Syncing " << tensors.size() << " live tensors with "
+                 << groups.size() << " graphs";
+      // The first groups must not donate the buffers the later ones read.
+      ProtectDeviceData(std::vector<XLATensorPtr>(
+          tensors.begin() + groups.front().size(), tensors.end()));
+      for (std::vector<XLATensorPtr>& group : groups) {
+        SyncTensorsGraph(&group, devices, wait, /*sync_ltc_data=*/true);
+      }
+      return;
+    }
+  }
   SyncTensorsGraph(&tensors, devices, wait, /*sync_ltc_data=*/true);
 }
 
@@ -446,8 +1171,7 @@ std::vector<size_t> XLAGraphExecutor::SetBufferDonorsFromUserConfig(
   std::vector<size_t> buffer_donor_indexs =
       GetBufferDonorIndexFromUserConfig(parameters_data);
   for (size_t i : buffer_donor_indexs) {
-    lowering_ctx->builder()->AddBufferDonor(/*param_number=*/i,
-                                            /*param_index=*/{});
+    lowering_ctx->AddBufferDonor(i);
   }
   TORCH_LAZY_VALUE_METRIC("InputOutputAliasCount", buffer_donor_indexs.size());
   return buffer_donor_indexs;
@@ -473,23 +1197,103 @@ void XLAGraphExecutor::WaitDeviceOps(absl::Span<const std::string> devices) {
   // torch::lazy::ExceptionCleanup object, which is going to be freed
   // immediately, turning this operation into a lock barrier.
   DeviceLockerArena::Get()->LockDevices(wait_devices);
+  StepPipeline::Get()->Drain(StepPipeline::DrainCause::kWaitDeviceOps);
   TF_VLOG(4) << "XLAGraphExecutor::WaitDeviceOps completed";
 }
 
+void XLAGraphExecutor::SetPreemptionSnapshotTensors(
+    std::vector<XLATensorPtr> tensors) {
+  std::lock_guard<std::mutex> lock(preemption_snapshot_mutex_);
+  preemption_snapshot_tensors_ = std::move(tensors);
+}
+
+bool XLAGraphExecutor::MaybeSnapshotForPreemption(int64_t step) {
+  std::lock_guard<std::mutex> lock(preemption_snapshot_mutex_);
+  if (preemption_snapshot_tensors_.empty() ||
+      preemption_snapshot_step_.has_value()) {
+    return false;
+  }
+  runtime::ComputationClient* client = runtime::GetComputationClient();
+  if (!client->CoordinatorInitialized() ||
+      !client->GetCoordinator().PreemptionSyncManagerActive() ||
+      !client->GetCoordinator().ReachedSyncPoint(step)) {
+    return false;
+  }
+  TF_VLOG(1) << "Preemption sync point reached at step " << step
+             << ", snapshotting " << preemption_snapshot_tensors_.size()
+             << " tensor(s)";
+  std::set<torch::lazy::BackendDevice> devices;
+  for (const XLATensorPtr& tensor : preemption_snapshot_tensors_) {
+    devices.insert(tensor->GetDevice());
+  }
+  // Waits for the executions of the step, which produce the snapshot data.
+  auto unlocker = std::make_shared<std::vector<torch::lazy::ExceptionCleanup>>(
+      DeviceLockerArena::Get()->LockDevices(devices));
+  std::vector<torch::lazy::BackendDataPtr> tensors_data;
+  std::vector<at::ScalarType> element_types;
+  for (const XLATensorPtr& tensor : preemption_snapshot_tensors_) {
+    torch::lazy::BackendDataPtr data = tensor->CurrentDataHandle();
+    XLA_CHECK(data != nullptr)
+        << "The preemption snapshot tensors must be synced by the step marker";
+    tensors_data.push_back(std::move(data));
+    element_types.push_back(tensor->dtype());
+  }
+  preemption_snapshot_step_ = step;
+  preemption_snapshot_ =
+      std::async(std::launch::async,
+                 [tensors_data = std::move(tensors_data),
+                  element_types = std::move(element_types),
+                  unlocker]() mutable {
+                   // Unlocks the devices on return rather than along with the
+                   // shared state of the future.
+                   auto devices_unlocker = std::move(unlocker);
+                   return XlaDataToTensors(tensors_data, element_types);
+                 })
+          .share();
+  TORCH_LAZY_COUNTER("PreemptionSnapshots", 1);
+  return true;
+}
+
+std::optional<int64_t> XLAGraphExecutor::PreemptionSnapshotStep() {
+  std::lock_guard<std::mutex> lock(preemption_snapshot_mutex_);
+  return preemption_snapshot_step_;
+}
+
+std::vector<at::Tensor> XLAGraphExecutor::WaitPreemptionSnapshot() {
+  std::shared_future<std::vector<at::Tensor>> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(preemption_snapshot_mutex_);
+    XLA_CHECK(preemption_snapshot_step_.has_value())
+        << "No preemption snapshot was taken";
+    snapshot = preemption_snapshot_;
+  }
+  TORCH_LAZY_TIMED("PreemptionSnapshotWait");
+  return snapshot.get();
+}
+
 std::vector<at::Tensor> XLAGraphExecutor::GetTensors(
     std::vector<XLATensorPtr>* tensors) {
   TF_VLOG(4) << "Trying to get the value of " << tensors->size()
              << " tensor(s)";
   SyncTensorsConfig config;
   config.force_ltc_data = false;
-  auto async = SyncTensorsGraphInternal(tensors, {}, config);
-  if (async != nullptr) {
-    async->mwait.Wait();
+  std::shared_ptr<Async> async;
+  std::vector<torch::lazy::BackendDataPtr> tensors_data;
+  {
+    StepTimeline::ScopedStep timeline_step;
+    async = SyncTensorsGraphInternal(tensors, {}, config);
+    if (async != nullptr) {
+      async->WaitExecution();
+    }
+    StepTimeline::ScopedStage timeline_stage(
+        StepTimeline::Stage::kGatherTensorsXlaData);
+    tensors_data = GatherTensorsXlaData(
+        *tensors,
+        async != nullptr ? async->indices : absl::Span<const size_t>(),
+        async != nullptr ? async->tensors_data
+                         : absl::Span<const torch::lazy::BackendDataPtr>());
   }
-  std::vector<torch::lazy::BackendDataPtr> tensors_data = GatherTensorsXlaData(
-      *tensors, async != nullptr ? async->indices : absl::Span<const size_t>(),
-      async != nullptr ? async->tensors_data
-                       : absl::Span<const torch::lazy::BackendDataPtr>());
+  StepPipeline::Get()->RecordFetch(UnwrapXlaData(tensors_data));
 
   std::vector<xla::Literal> literals = ReleaseGilAndTransferData(tensors_data);
 
@@ -517,26 +1321,7 @@ torch::lazy::hash_t XLAGraphExecutor::GetGraphHash(
         static_cast<XlaDeviceType>(tensor->GetDevice().type())));
   }
   PostOrderData po_data = RunPostOrder(ir_values, &coll);
-  torch::lazy::hash_t res_hash = torch::lazy::HashCombine(
-      coll.hash, torch::lazy::Hash(po_data.parameter_sequence));
-  if (GetAliasWithBufferDonorConfig()) {
-    std::vector<size_t> buffer_donor_index =
-        GetBufferDonorIndexFromUserConfig(po_data.parameters_data);
-    // Do not include hash on a empty vector.
-    if (buffer_donor_index.size() > 0) {
-      res_hash = torch::lazy::HashCombine(
-          res_hash, torch::lazy::Hash(buffer_donor_index));
-    }
-  }
-  {
-    // Auto-sharding configs
-    res_hash = torch::lazy::HashCombine(
-        res_hash, torch::lazy::MHash(ShardingUtil::GetAutoSharding()));
-    res_hash = torch::lazy::HashCombine(
-        res_hash,
-        torch::lazy::StringHash(
-            runtime::sys_util::GetEnvString("XLA_AUTO_SPMD_MESH", "").c_str()));
-  }
+  torch::lazy::hash_t res_hash = CombineGraphHash(coll.hash, po_data);
   DeviceContextArena::Get()->SaveOutputShapes(res_hash,
                                               std::move(output_shapes));
   DeviceContextArena::Get()->SaveGraphAsString(res_hash, tensors,
@@ -575,7 +1360,8 @@ void XLAGraphExecutor::ClearPendingIrs(
     const torch::lazy::BackendDevice& device) {
   std::unordered_set<int64_t> tensor_ids;
   for (size_t i = 0; i < tensors.size(); ++i) {
-    if (tensor_ids.insert(tensors[i]->GetUniqueId()).second &&
+    if ((unique_tensors ||
+         tensor_ids.insert(tensors[i]->GetUniqueId()).second) &&
         tensors[i]->CurrentDataHandle() == nullptr) {
       torch::lazy::Value ir_value = tensors[i]->CurrentIrValue();
       // Only clear the IR that is not a DeviceData Node.
@@ -607,6 +1393,9 @@ XLAGraphExecutor::SyncTensorCollection XLAGraphExecutor::CollectSyncTensors(
     const std::vector<XLATensorPtr>& tensors, const SyncTensorsConfig& config) {
   tsl::profiler::TraceMe activity("CollectSyncTensors",
                                   tsl::profiler::TraceMeLevel::kInfo);
+  TORCH_LAZY_TIMED("CollectSyncTensorsTime");
+  StepTimeline::ScopedStage timeline_stage(
+      StepTimeline::Stage::kCollectSyncTensors);
   torch::lazy::Unique<torch::lazy::BackendDevice> unique_device;
   for (size_t i = 0; i < tensors.size(); ++i) {
     unique_device.set(tensors[i]->GetDevice());
@@ -620,7 +1409,18 @@ XLAGraphExecutor::SyncTensorCollection XLAGraphExecutor::CollectSyncTensors(
   std::vector<std::string> devices;
   std::vector<XLATensor::ShardingSpecPtr> shardings;
   std::vector<size_t> at_tensor_index;
+  // The live tensors of the device contexts come ordered by unique id, in which
+  // case none can repeat and the bookkeeping to skip duplicates is not needed.
+  bool unique_tensors = true;
+  for (size_t i = 1; i < tensors.size() && unique_tensors; ++i) {
+    unique_tensors = tensors[i - 1]->GetUniqueId() < tensors[i]->GetUniqueId();
+  }
   std::unordered_set<int64_t> tensor_ids;
+  if (!unique_tensors) {
+    tensor_ids.reserve(tensors.size());
+  }
+  static const torch::lazy::hash_t gitrev_hash =
+      torch::lazy::StringHash(XLA_GITREV);
   // The force_ltc_data controls aliasing compilation, so effectively the same
   // graph with on/off force_ltc_data should not match, hash wise.
   coll.hash = torch::lazy::MHash(config.force_ltc_data);
@@ -628,8 +1428,15 @@ XLAGraphExecutor::SyncTensorCollection XLAGraphExecutor::CollectSyncTensors(
   // hash.
   coll.hash = torch::lazy::HashCombine(
       coll.hash, runtime::GetComputationClient()->HashCompilationEnv());
-  coll.hash =
-      torch::lazy::HashCombine(coll.hash, torch::lazy::StringHash(XLA_GITREV));
+  coll.hash = torch::lazy::HashCombine(coll.hash, gitrev_hash);
+  if (g_intra_op_threads > 0) {
+    coll.hash = torch::lazy::HashCombine(
+        coll.hash, torch::lazy::MHash(g_intra_op_threads));
+  }
+  if (!g_compile_option_overrides.empty()) {
+    coll.hash = torch::lazy::HashCombine(
+        coll.hash, CompileOptionOverridesHash(g_compile_option_overrides));
+  }
   coll.config = config;
   coll.device = *unique_device;
   coll.indices.reserve(tensors.size());
@@ -660,10 +1467,14 @@ XLAGraphExecutor::SyncTensorCollection XLAGraphExecutor::CollectSyncTensors(
             // result of the computation. Call `GetXlaData` to extract the
             // XlaData from the DeviceData Node and reset the IR. We also want
             // to update XlaData's tensorID to make it match with the current
-            // XLATensor.
-            tensors[i]->GetXlaData()->SetInfo(
-                std::make_shared<LazyGraphExecutor::DeviceDataInfo>(
-                    tensors[i]->GetUniqueId(), /*=read_only=*/false));
+            // XLATensor, unless the data is shared by the tensors of the same
+            // value in the DeviceDataCache, which must never be donated.
+            torch::lazy::BackendDataPtr handle = tensors[i]->GetXlaData();
+            if (!IsSharedDeviceData(handle)) {
+              handle->SetInfo(
+                  std::make_shared<LazyGraphExecutor::DeviceDataInfo>(
+                      tensors[i]->GetUniqueId(), /*=read_only=*/false));
+            }
           } else {
             // Add only tensors which need to be synced.
             coll.hash = torch::lazy::HashCombine(coll.hash, ir_value.hash());
@@ -707,6 +1518,8 @@ XLAGraphExecutor::SyncTensorCollection XLAGraphExecutor::CollectSyncTensors(
 void XLAGraphExecutor::TensorCollectionBarrier(SyncTensorCollection* coll) {
   tsl::profiler::TraceMe activity("TensorCollectionBarrier",
                                   tsl::profiler::TraceMeLevel::kInfo);
+  StepTimeline::ScopedStage timeline_stage(
+      StepTimeline::Stage::kTensorCollectionBarrier);
   TF_VLOG(4) << "waiting barrier for device " << coll->device.toString()
              << " start";
   torch::lazy::LazyGraphExecutor::TensorCollectionBarrier(coll);
@@ -714,24 +1527,68 @@ void XLAGraphExecutor::TensorCollectionBarrier(SyncTensorCollection* coll) {
              << " done";
 }
 
+std::shared_ptr<XLAGraphExecutor::CallPlan> XLAGraphExecutor::CreateCallPlan(
+    torch::lazy::hash_t hash, const torch::lazy::BackendDevice& device) {
+  ComputationCache::TypePtr cached_computation =
+      GetComputationCache()->Get(hash);
+  // TODO implement a fallback mechanism, or make sure those entries
+  // never get kicked out
+  XLA_CHECK(cached_computation)
+      << "Failed to get computation by hash " << torch::lazy::HashToString(hash)
+      << ". Maybe the entry get "
+         "kicked out of the LRU cache";
+  TF_HOT_VLOG(5) << "Cached computation (hash: "
+                 << torch::lazy::HashToString(hash)
+                 << ") is_sharded=" << cached_computation->is_sharded;
+
+  auto plan = std::make_shared<CallPlan>();
+  plan->hash = hash;
+  plan->device = device;
+  plan->device_str = device.toString();
+  plan->output_shapes =
+      *DeviceContextArena::Get()->GetOutputShapesByHash(hash);
+  if (static_cast<XlaDeviceType>(device.type()) == XlaDeviceType::SPMD) {
+    // For any given graph(each hash correspodning to one graph) there is only
+    // one output sharding, kept with the cached computation to avoid retrive
+    // the sharding from the computation every time.
+    std::call_once(cached_computation->output_sharding_once, [&]() {
+      TORCH_LAZY_COUNTER("UncachedOutputSharding", 1);
+      cached_computation->output_sharding_specs =
+          ShardingUtil::GetOutputSharding(plan->output_shapes,
+                                          cached_computation->computation);
+    });
+    plan->output_sharding_specs = cached_computation->output_sharding_specs;
+  }
+  plan->cached_computation = std::move(cached_computation);
+  TORCH_LAZY_COUNTER("CreateCallPlan", 1);
+  return plan;
+}
+
 std::vector<torch::lazy::BackendDataPtr>
 XLAGraphExecutor::ExecuteComputationWithBarrier(
     torch::lazy::hash_t hash, const std::vector<at::IValue>& graph_inputs,
     const torch::lazy::BackendDevice& device) {
+  std::vector<at::Tensor> inputs;
+  inputs.reserve(graph_inputs.size());
+  for (const at::IValue& ivalue : graph_inputs) {
+    inputs.push_back(ivalue.toTensor());
+  }
+  return ExecuteCallPlan(*CreateCallPlan(hash, device), inputs);
+}
+
+std::vector<torch::lazy::BackendDataPtr> XLAGraphExecutor::ExecuteCallPlan(
+    const CallPlan& plan, const std::vector<at::Tensor>& inputs) {
   tsl::profiler::TraceMe activity("ExecuteComputationWithBarrier",
                                   tsl::profiler::TraceMeLevel::kInfo);
+  torch::lazy::hash_t hash = plan.hash;
+  const torch::lazy::BackendDevice& device = plan.device;
   MaybeDumpGraph("dynamo", hash);
-  auto cachedComputation =
-      XLAGraphExecutor::Get()->GetComputationCache()->Get(hash);
-  TF_VLOG(5) << "Cached computation (hash: " << torch::lazy::HashToString(hash)
-             << ") is_sharded=" << cachedComputation->is_sharded << std::endl;
-
-  // TODO implement a fallback mechanism, or make sure those entries
-  // never get kicked out
-  XLA_CHECK(cachedComputation)
-      << "Failed to get computation by hash " << torch::lazy::HashToString(hash)
-      << ". Maybe the entry get "
-         "kicked out of the LRU cache";
+  ComputationCache::TypePtr cachedComputation =
+      GetComputationCache()->Get(hash);
+  if (cachedComputation == nullptr) {
+    TORCH_LAZY_COUNTER("CallPlanEvictedComputation", 1);
+    cachedComputation = plan.cached_computation;
+  }
 
   DebugUtil::analyze_graph_execution_python_frame(
       DebugUtil::GraphAnalysisSource::DynamoExecution,
@@ -739,35 +1596,19 @@ XLAGraphExecutor::ExecuteComputationWithBarrier(
       /*program_shape=*/&(cachedComputation->computation->program_shape()));
 
   // Create DataPlaceHolder that will get filled in async executions.
-  std::vector<xla::Shape>* output_shapes =
-      DeviceContextArena::Get()->GetOutputShapesByHash(hash);
   std::vector<torch::lazy::BackendDataPtr> placeholders;
-
   std::vector<XLATensor::ShardingSpecPtr> sharding_specs;
   if (static_cast<XlaDeviceType>(device.type()) == XlaDeviceType::SPMD) {
     sharding_specs =
-        std::vector<XLATensor::ShardingSpecPtr>(output_shapes->size());
-    // TODO(JackCaoG): Use LRU cache and add same cache to non-dynamo path.
-    static std::unordered_map<torch::lazy::hash_t,
-                              std::vector<XLATensor::ShardingSpecPtr>,
-                              torch::lazy::HashReducer>
-        output_sharding_hash;
-    // For any given graph(each hash correspodning to one graph) there is only
-    // one output sharding. We can cache this sharding here to avoid retrive
-    // the sharding from the computation every time.
-    if (output_sharding_hash.find(hash) == output_sharding_hash.end()) {
-      TORCH_LAZY_COUNTER("UncachedOutputSharding", 1);
-      output_sharding_hash[hash] = ShardingUtil::GetOutputSharding(
-          *output_shapes, cachedComputation->computation);
-    }
+        std::vector<XLATensor::ShardingSpecPtr>(plan.output_shapes.size());
     placeholders =
-        ShardingUtil::CreateShardedPlaceholder(output_sharding_hash[hash]);
+        ShardingUtil::CreateShardedPlaceholder(plan.output_sharding_specs);
   } else {
-    for (const xla::Shape& shape : *output_shapes) {
-      torch::lazy::BackendDataPtr handle =
+    placeholders.reserve(plan.output_shapes.size());
+    for (const xla::Shape& shape : plan.output_shapes) {
+      placeholders.push_back(
           runtime::GetComputationClient()->CreateDataPlaceholder(
-              device.toString(), std::move(shape));
-      placeholders.push_back(handle);
+              plan.device_str, shape));
     }
   }
 
@@ -776,9 +1617,9 @@ XLAGraphExecutor::ExecuteComputationWithBarrier(
   {
     tsl::profiler::TraceMe activity("DeviceBarrier",
                                     tsl::profiler::TraceMeLevel::kInfo);
-    TF_VLOG(5) << "Lock device " << device.toString() << "...";
+    TF_HOT_VLOG(5) << "Lock device " << device.toString() << "...";
     coll.unlocker = DeviceLockerArena::Get()->LockDevices({device});
-    TF_VLOG(5) << "Locking device " << device.toString() << " Done!";
+    TF_HOT_VLOG(5) << "Locking device " << device.toString() << " Done!";
   }
 
   std::vector<torch::lazy::BackendDataPtr> arguments;
@@ -787,15 +1628,16 @@ XLAGraphExecutor::ExecuteComputationWithBarrier(
     // extract the placeholder inserted by previous execution.
     TORCH_LAZY_TIMED("RunCachedGraphInputData");
     // setup the arguments
-    for (auto& ivalue : graph_inputs) {
+    arguments.reserve(inputs.size());
+    for (const at::Tensor& input : inputs) {
       torch::lazy::BackendDataPtr dataptr;
-      if (auto xla_tensor_ptr = bridge::TryGetXlaTensor(ivalue.toTensor())) {
+      if (auto xla_tensor_ptr = bridge::TryGetXlaTensor(input)) {
         dataptr = xla_tensor_ptr->GetXlaData();
       } else {
         XLA_CHECK(device.type() != (int8_t)XlaDeviceType::SPMD)
             << "SPMD device data should already be on the XLA backend "
                "(XLATensor).";
-        dataptr = torch_xla::TensorToXlaData(ivalue.toTensor(), device);
+        dataptr = torch_xla::TensorToXlaData(input, device);
       }
       arguments.push_back(dataptr);
     }
@@ -804,19 +1646,33 @@ XLAGraphExecutor::ExecuteComputationWithBarrier(
   std::shared_ptr<XLAGraphExecutor::Async> async = std::make_shared<Async>(
       &coll, std::move(arguments), placeholders, std::move(cachedComputation));
 
-  auto syncfn = [async, hash, sharding_specs]() {
+  auto syncfn = [async, hash, sharding_specs, lane = GetExecutionLane(),
+                 tenant = runtime::tenant::Current(),
+                 step_id = runtime::ComputationClient::GetStepId(),
+                 execution_future = ExecutionFuture::Begin(hash)]() {
+    RecordExecutionStats(hash, execution_future.get());
     try {
-      tsl::profiler::TraceMe activity("ExecuteComputationWithBarrier_syncfn",
-                                      tsl::profiler::TraceMeLevel::kInfo);
-      TF_VLOG(3) << "Executing Dynamo IR graph hash "
-                 << torch::lazy::HashToString(hash) << " on device "
-                 << async->device << " ...";
+      tsl::profiler::TraceMe activity(
+          [&] {
+            return tsl::profiler::TraceMeEncode(
+                "ExecuteComputationWithBarrier_syncfn",
+                {{"graph_hash", torch::lazy::HashToString(hash)},
+                 {"step", step_id}});
+          },
+          tsl::profiler::TraceMeLevel::kInfo);
+      TF_HOT_VLOG(3) << "Executing Dynamo IR graph hash "
+                     << torch::lazy::HashToString(hash) << " on device "
+                     << async->device << " ...";
 
       std::vector<torch::lazy::BackendDataPtr> results;
       if (async->cached_computation->is_sharded) {
         std::vector<std::string> devices =
             runtime::GetComputationClient()->GetLocalDevices();
         runtime::ComputationClient::ExecuteReplicatedOptions execute_options;
+        execute_options.lane = lane;
+        execute_options.tenant = tenant;
+        execute_options.graph_hash = torch::lazy::HashToString(hash);
+        execute_options.step_id = step_id;
         // OutputHandler creates sharded data for sharded
         // tensor results. Both sharded and unsharded results should be
         // "Assign"ed to the corresponding data placeholders.
@@ -826,16 +1682,24 @@ XLAGraphExecutor::ExecuteComputationWithBarrier(
                 UnwrapXlaData(async->parameters_data), devices,
                 execute_options);
         results = WrapXlaData(outputs);
-        TF_VLOG(3) << "Executing Dynamo IR sharded graph hash "
-                   << torch::lazy::HashToString(hash) << " on devices "
-                   << absl::StrJoin(devices, ",") << " done!";
+        TF_HOT_VLOG(3) << "Executing Dynamo IR sharded graph hash "
+                       << torch::lazy::HashToString(hash) << " on devices "
+                       << absl::StrJoin(devices, ",") << " done!";
       } else {
-        results = torch::lazy::getBackend()->ExecuteComputation(
-            async->cached_computation->computation, async->parameters_data,
-            async->device);
-        TF_VLOG(3) << "Executing Dynamo IR graph hash "
-                   << torch::lazy::HashToString(hash) << " on device "
-                   << async->device << " done!";
+        runtime::ComputationClient::ExecuteComputationOptions execute_options;
+        execute_options.lane = lane;
+        execute_options.tenant = tenant;
+        execute_options.graph_hash = torch::lazy::HashToString(hash);
+        execute_options.step_id = step_id;
+        std::vector<runtime::ComputationClient::DataPtr> outputs =
+            runtime::GetComputationClient()->ExecuteComputation(
+                *async->cached_computation->computation,
+                UnwrapXlaData(async->parameters_data),
+                async->device.toString(), execute_options);
+        results = WrapXlaData(outputs);
+        TF_HOT_VLOG(3) << "Executing Dynamo IR graph hash "
+                       << torch::lazy::HashToString(hash) << " on device "
+                       << async->device << " done!";
       }
 
       // Updating placeholder with actual output handle.
@@ -847,7 +1711,9 @@ XLAGraphExecutor::ExecuteComputationWithBarrier(
           async->tensors_data[i]->Assign(*results[i]);
         }
       }
+      execution_future->Dispatched(UnwrapXlaData(results));
     } catch (...) {
+      execution_future->Failed(std::current_exception());
       // There are two paths of discovery of an exception happening on an
       // asynchronous task. One happens if the creator of the asynchronous task
       // explicitly waits for completion, in which case the exception will be
@@ -869,23 +1735,186 @@ XLAGraphExecutor::ExecuteComputationWithBarrier(
   return placeholders;
 }
 
-std::vector<torch::lazy::BackendDataPtr> XLAGraphExecutor::ExecuteStablehlo(
-    std::string bytecode, const std::vector<at::IValue>& graph_inputs,
-    const torch::lazy::BackendDevice& device) {
-  // Convert StableHLO to HLO for XLA compilation.
-  // TODO(lsy323): Pass StableHLO to PjrtComputationClient for compilation
-  // after StableHLO compilation API is added in ComputationClient.
-  mlir::MLIRContext context;
-  mlir::OwningOpRef<mlir::ModuleOp> module =
-      mlir::stablehlo::deserializePortableArtifact(bytecode, &context);
-  mlir::ModuleOp mlir_module = *module;
-  xla::HloProto hlo_proto;
-  ConvertStableHloToHlo(&mlir_module, &context, &hlo_proto);
-  xla::HloModuleProto* hlo_module_proto = hlo_proto.mutable_hlo_module();
-  xla::XlaComputation computation(*hlo_module_proto);
+void XLAGraphExecutor::CallSequence::Record(
+    std::shared_ptr<CallPlan> plan, const std::vector<at::Tensor>& inputs,
+    const std::vector<at::Tensor>& outputs) {
+  XLA_CHECK(static_cast<XlaDeviceType>(plan->device.type()) !=
+            XlaDeviceType::SPMD)
+      << "Call sequences are not supported on the SPMD virtual device";
+  XLA_CHECK(steps_.empty() || steps_.front().plan->device == plan->device)
+      << "The steps of a call sequence must run on the same device";
+  Step step;
+  step.plan = std::move(plan);
+  step.arguments.reserve(inputs.size());
+  for (const at::Tensor& input : inputs) {
+    Argument argument;
+    XLATensorPtr xtensor = bridge::TryGetXlaTensor(input);
+    torch::lazy::BackendDataPtr handle =
+        xtensor ? xtensor->CurrentDataHandle() : nullptr;
+    auto it = handle ? output_index_.find(handle.get()) : output_index_.end();
+    if (it != output_index_.end()) {
+      argument.step = it->second.first;
+      argument.output = it->second.second;
+    } else {
+      auto [input_it, inserted] =
+          input_index_.emplace(input.unsafeGetTensorImpl(), inputs_.size());
+      if (inserted) {
+        inputs_.push_back(input);
+      }
+      argument.input = input_it->second;
+    }
+    step.arguments.push_back(argument);
+  }
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    XLATensorPtr xtensor = bridge::GetXlaTensor(outputs[i]);
+    output_index_[xtensor->CurrentDataHandle().get()] = {steps_.size(), i};
+    step.outputs.push_back(std::move(xtensor));
+  }
+  steps_.push_back(std::move(step));
+}
 
-  // Get program output shape.
-  // TODO(lsy323): Get shape info from MLIR Module.
+void XLAGraphExecutor::SetCallSequenceCapture(
+    std::shared_ptr<CallSequence> sequence) {
+  g_call_sequence_capture = std::move(sequence);
+}
+
+std::shared_ptr<XLAGraphExecutor::CallSequence>
+XLAGraphExecutor::GetCallSequenceCapture() {
+  return g_call_sequence_capture;
+}
+
+void XLAGraphExecutor::ReplayCallSequence(const CallSequence& sequence) {
+  tsl::profiler::TraceMe activity("ReplayCallSequence",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  XLA_CHECK(!sequence.steps_.empty()) << "Replaying an empty call sequence";
+  const torch::lazy::BackendDevice& device =
+      sequence.steps_.front().plan->device;
+
+  std::vector<ComputationCache::TypePtr> cached_computations;
+  std::vector<runtime::ComputationClient::ChainedComputation> chain(
+      sequence.steps_.size());
+  std::vector<torch::lazy::BackendDataPtr> placeholders;
+  for (size_t s = 0; s < sequence.steps_.size(); ++s) {
+    const CallPlan& plan = *sequence.steps_[s].plan;
+    ComputationCache::TypePtr cached_computation =
+        GetComputationCache()->Get(plan.hash);
+    if (cached_computation == nullptr) {
+      TORCH_LAZY_COUNTER("CallPlanEvictedComputation", 1);
+      cached_computation = plan.cached_computation;
+    }
+    chain[s].computation = cached_computation->computation;
+    cached_computations.push_back(std::move(cached_computation));
+    for (const xla::Shape& shape : plan.output_shapes) {
+      placeholders.push_back(
+          runtime::GetComputationClient()->CreateDataPlaceholder(
+              plan.device_str, shape));
+    }
+  }
+
+  SyncTensorCollection coll;
+  coll.device = device;
+  {
+    tsl::profiler::TraceMe activity("DeviceBarrier",
+                                    tsl::profiler::TraceMeLevel::kInfo);
+    coll.unlocker = DeviceLockerArena::Get()->LockDevices({device});
+  }
+
+  std::vector<torch::lazy::BackendDataPtr> input_data;
+  {
+    // As for the call plans, the data is only read within the lock region.
+    TORCH_LAZY_TIMED("ReplayCallSequenceInputData");
+    input_data.reserve(sequence.inputs_.size());
+    for (const at::Tensor& input : sequence.inputs_) {
+      torch::lazy::BackendDataPtr data;
+      if (XLATensorPtr xtensor = bridge::TryGetXlaTensor(input)) {
+        data = xtensor->GetXlaData();
+        XLA_CHECK(data != nullptr)
+            << "The inputs of a call sequence must be materialized";
+      } else {
+        data = torch_xla::TensorToXlaData(input, device);
+      }
+      input_data.push_back(std::move(data));
+    }
+    for (size_t s = 0; s < sequence.steps_.size(); ++s) {
+      for (const CallSequence::Argument& argument :
+           sequence.steps_[s].arguments) {
+        if (argument.input >= 0) {
+          chain[s].arguments.emplace_back(
+              UnwrapXlaData(input_data[argument.input]));
+        } else {
+          chain[s].arguments.emplace_back(argument.step, argument.output);
+        }
+      }
+    }
+  }
+
+  auto async = std::make_shared<Async>(&coll, std::move(input_data),
+                                       placeholders, /*cached_computation=*/
+                                       nullptr);
+  auto syncfn = [async, chain = std::move(chain),
+                 cached_computations = std::move(cached_computations),
+                 lane = GetExecutionLane(),
+                 tenant = runtime::tenant::Current(),
+                 step_id = runtime::ComputationClient::GetStepId()]() {
+    try {
+      tsl::profiler::TraceMe activity(
+          [&] {
+            return tsl::profiler::TraceMeEncode(
+                "ReplayCallSequence_syncfn",
+                {{"steps", chain.size()}, {"step", step_id}});
+          },
+          tsl::profiler::TraceMeLevel::kInfo);
+      runtime::ComputationClient::ExecuteChainedOptions execute_options;
+      execute_options.lane = lane;
+      execute_options.tenant = tenant;
+      execute_options.step_id = step_id;
+      std::vector<std::vector<runtime::ComputationClient::DataPtr>> results =
+          runtime::GetComputationClient()->ExecuteChained(
+              chain, async->device.toString(), execute_options);
+      size_t index = 0;
+      for (const auto& step_results : results) {
+        for (const runtime::ComputationClient::DataPtr& result :
+             step_results) {
+          async->tensors_data[index++]->Assign(*result);
+        }
+      }
+    } catch (...) {
+      // As for the call plans, the exception is surfaced by the next lock of
+      // the device.
+      for (auto& unlocker : async->unlocker) {
+        unlocker.SetStatus(std::current_exception());
+      }
+      throw;
+    }
+  };
+  thread::Schedule(async->mwait.Completer(std::move(syncfn)));
+
+  size_t index = 0;
+  for (const CallSequence::Step& step : sequence.steps_) {
+    for (const XLATensorPtr& output : step.outputs) {
+      output->SetXlaData(placeholders[index++]);
+    }
+  }
+  TORCH_LAZY_COUNTER("ReplayCallSequence", 1);
+}
+
+std::vector<torch::lazy::BackendDataPtr> XLAGraphExecutor::ExecuteStablehlo(
+    std::string bytecode, const std::vector<at::IValue>& graph_inputs,
+    const torch::lazy::BackendDevice& device) {
+  // Convert StableHLO to HLO for XLA compilation.
+  // TODO(lsy323): Pass StableHLO to PjrtComputationClient for compilation
+  // after StableHLO compilation API is added in ComputationClient.
+  std::shared_ptr<mlir::MLIRContext> context = GetStablehloContext();
+  mlir::OwningOpRef<mlir::ModuleOp> module =
+      DeserializeStablehlo(bytecode, context.get());
+  mlir::ModuleOp mlir_module = *module;
+  xla::HloProto hlo_proto;
+  ConvertStableHloToHlo(&mlir_module, context.get(), &hlo_proto);
+  xla::HloModuleProto* hlo_module_proto = hlo_proto.mutable_hlo_module();
+  xla::XlaComputation computation(*hlo_module_proto);
+
+  // Get program output shape.
+  // TODO(lsy323): Get shape info from MLIR Module.
   xla::ProgramShape program_shape = ConsumeValue(computation.GetProgramShape());
   xla::Shape shape = MakeShapeWithDeviceLayout(
       program_shape.result(), static_cast<XlaDeviceType>(device.type()));
@@ -897,6 +1926,8 @@ std::vector<torch::lazy::BackendDataPtr> XLAGraphExecutor::ExecuteStablehlo(
           device.toString(),
           runtime::GetComputationClient()->GetLocalDevices()),
       &shape);
+  // The StableHLO compilation does not need the HLO converted back.
+  instances.back().stablehlo_bytecode = std::move(bytecode);
   std::vector<std::shared_ptr<runtime::ComputationClient::Computation>>
       computations =
           runtime::GetComputationClient()->Compile(std::move(instances));
@@ -970,6 +2001,7 @@ std::vector<torch::lazy::BackendDataPtr> XLAGraphExecutor::SetTensorData(
     const std::vector<torch::lazy::BackendDataPtr>& tensor_data_vec) {
   tsl::profiler::TraceMe activity("SetTensorData",
                                   tsl::profiler::TraceMeLevel::kInfo);
+  StepTimeline::ScopedStage timeline_stage(StepTimeline::Stage::kSetTensorData);
   std::vector<torch::lazy::BackendDataPtr> tensors_data;
   tensors_data.reserve(indices.size());
   for (int i = 0; i < indices.size(); i++) {
@@ -1012,6 +2044,8 @@ void XLAGraphExecutor::ExtractIRAndPrepareXlaData_(
     std::vector<torch::lazy::BackendDataPtr>& tensor_data_vec) {
   tsl::profiler::TraceMe activity("ExtractIRAndPrepareXlaData_",
                                   tsl::profiler::TraceMeLevel::kInfo);
+  StepTimeline::ScopedStage timeline_stage(
+      StepTimeline::Stage::kExtractIRAndPrepareXlaData);
   ir_values.reserve(indices.size());
   tensor_data_vec.reserve(indices.size());
   for (auto index : indices) {
@@ -1084,11 +2118,36 @@ XLAGraphExecutor::ScheduleSyncTensorsGraph(
       /*program_shape=*/&(cached_computation->computation->program_shape()));
   tsl::profiler::TraceMe activity("ScheduleSyncTensorsGraph",
                                   tsl::profiler::TraceMeLevel::kInfo);
+  std::shared_ptr<StepPipeline::Step> pipeline_step =
+      StepPipeline::Get()->BeginStep();
   TensorCollectionBarrier(coll);
   std::shared_ptr<XLAGraphExecutor::Async> async = std::make_shared<Async>(
       coll, std::move(parameters_data), std::move(tensors_data),
       std::move(cached_computation));
-  auto syncfn = [async, hash = coll->hash, sharding_specs = sharding_specs]() {
+  auto syncfn = [async, hash = coll->hash, sharding_specs = sharding_specs,
+                 pipeline_step = std::move(pipeline_step),
+                 timeline_step = StepTimeline::CurrentShared(),
+                 schedule_ns = runtime::sys_util::NowNs(),
+                 lane = GetExecutionLane(),
+                 tenant = runtime::tenant::Current(),
+                 step_id = runtime::ComputationClient::GetStepId(),
+                 execution_future = ExecutionFuture::Begin(coll->hash)]() {
+    if (timeline_step != nullptr) {
+      StepTimeline::AddStageTime(timeline_step.get(),
+                                 StepTimeline::Stage::kQueueWait,
+                                 runtime::sys_util::NowNs() - schedule_ns);
+    }
+    tsl::profiler::TraceMe activity(
+        [&] {
+          return tsl::profiler::TraceMeEncode(
+              "XLAGraphExecutor::Execute",
+              {{"graph_hash", torch::lazy::HashToString(hash)},
+               {"step", step_id}});
+        },
+        tsl::profiler::TraceMeLevel::kInfo);
+    StepTimeline::ScopedStage timeline_stage(timeline_step.get(),
+                                             StepTimeline::Stage::kExecute);
+    RecordExecutionStats(hash, execution_future.get());
     try {
       std::vector<torch::lazy::BackendDataPtr> results;
       // Execute replicated if the compiled computation is partitioned.
@@ -1096,9 +2155,13 @@ XLAGraphExecutor::ScheduleSyncTensorsGraph(
         std::vector<std::string> devices =
             runtime::GetComputationClient()->GetLocalDevices();
         runtime::ComputationClient::ExecuteReplicatedOptions execute_options;
-        TF_VLOG(3) << "Executing IR graph hash "
-                   << torch::lazy::HashToString(hash)
-                   << " on devices: " << absl::StrJoin(devices, ",");
+        execute_options.lane = lane;
+        execute_options.tenant = tenant;
+        execute_options.graph_hash = torch::lazy::HashToString(hash);
+        execute_options.step_id = step_id;
+        TF_HOT_VLOG(3) << "Executing IR graph hash "
+                       << torch::lazy::HashToString(hash)
+                       << " on devices: " << absl::StrJoin(devices, ",");
         // OutputHandler creates sharded data for sharded
         // tensor results. Both sharded and unsharded results should be
         // "Assign"ed to the corresponding data placeholders.
@@ -1109,21 +2172,32 @@ XLAGraphExecutor::ScheduleSyncTensorsGraph(
                 execute_options);
         results = WrapXlaData(outputs);
         TORCH_LAZY_COUNTER("ExecuteReplicated", 1);
-        TF_VLOG(3) << "Executing IR graph hash "
-                   << torch::lazy::HashToString(hash)
-                   << " on devices: " << absl::StrJoin(devices, ",")
-                   << " done!";
+        TF_HOT_VLOG(3) << "Executing IR graph hash "
+                       << torch::lazy::HashToString(hash)
+                       << " on devices: " << absl::StrJoin(devices, ",")
+                       << " done!";
       } else {
-        TF_VLOG(3) << "Executing IR graph hash "
-                   << torch::lazy::HashToString(hash) << " on device "
-                   << async->device << " ...";
-        results = torch::lazy::getBackend()->ExecuteComputation(
-            async->cached_computation->computation, async->parameters_data,
-            async->device);
+        TF_HOT_VLOG(3) << "Executing IR graph hash "
+                       << torch::lazy::HashToString(hash) << " on device "
+                       << async->device << " ...";
+        runtime::ComputationClient::ExecuteComputationOptions execute_options;
+        execute_options.lane = lane;
+        execute_options.tenant = tenant;
+        execute_options.graph_hash = torch::lazy::HashToString(hash);
+        execute_options.step_id = step_id;
+        std::vector<runtime::ComputationClient::DataPtr> outputs =
+            runtime::GetComputationClient()->ExecuteComputation(
+                *async->cached_computation->computation,
+                UnwrapXlaData(async->parameters_data),
+                async->device.toString(), execute_options);
+        results = WrapXlaData(outputs);
         TORCH_LAZY_COUNTER("ExecuteComputation", 1);
-        TF_VLOG(3) << "Executing IR graph hash "
-                   << torch::lazy::HashToString(hash) << " on device "
-                   << async->device << " done!";
+        TF_HOT_VLOG(3) << "Executing IR graph hash "
+                       << torch::lazy::HashToString(hash) << " on device "
+                       << async->device << " done!";
+      }
+      if (pipeline_step != nullptr) {
+        pipeline_step->Dispatched(UnwrapXlaData(results));
       }
       for (size_t i = 0; i < results.size(); ++i) {
         if (async->tensors_data[i] != nullptr) {
@@ -1132,7 +2206,12 @@ XLAGraphExecutor::ScheduleSyncTensorsGraph(
           async->tensors_data[i] = std::move(results[i]);
         }
       }
+      execution_future->Dispatched(UnwrapXlaData(async->tensors_data));
     } catch (...) {
+      if (pipeline_step != nullptr) {
+        pipeline_step->Dispatched({});
+      }
+      execution_future->Failed(std::current_exception());
       // There are two paths of discovery of an exception happening on an
       // asynchronous task. One happens if the creator of the asynchronous task
       // explicitly waits for completion, in which case the exception will be
@@ -1167,9 +2246,20 @@ XLAGraphExecutor::ScheduleSyncTensorsGraph(
   // Extract sharding specs for the results and prepare the sharded data
   // placeholders if the computation is sharded.
   if (cached_computation->is_sharded) {
+    std::call_once(cached_computation->output_sharding_once, [&]() {
+      TORCH_LAZY_COUNTER("UncachedOutputSharding", 1);
+      std::vector<xla::Shape> output_shapes;
+      output_shapes.reserve(coll->indices.size());
+      for (size_t index : coll->indices) {
+        output_shapes.push_back((*tensors)[index]->shape().get());
+      }
+      cached_computation->output_sharding_specs =
+          ShardingUtil::GetOutputSharding(output_shapes,
+                                          cached_computation->computation);
+    });
     ShardingUtil::PrepareOutputShardingPropagation(
-        tensors, coll->indices, cached_computation->computation, &tensors_data,
-        &sharding_specs);
+        tensors, coll->indices, cached_computation->output_sharding_specs,
+        &tensors_data, &sharding_specs);
     DebugUtil::SaveOutputShardingInfo(tensors, coll->indices);
   }
 
@@ -1183,27 +2273,77 @@ XLAGraphExecutor::PostOrderData XLAGraphExecutor::RunPostOrder(
     SyncTensorCollection* coll) {
   tsl::profiler::TraceMe activity("RunPostOrder",
                                   tsl::profiler::TraceMeLevel::kInfo);
+  StepTimeline::ScopedStage timeline_stage(StepTimeline::Stage::kRunPostOrder);
   return torch::lazy::LazyGraphExecutor::RunPostOrder(ir_values, coll);
 }
 
 XLAGraphExecutor::ComputationCache::TypePtr
 XLAGraphExecutor::LookupCachedCompile(const torch::lazy::hash_t& hash) {
+  StepTimeline::ScopedStage timeline_stage(
+      StepTimeline::Stage::kLookupCachedCompile);
   ComputationCache::TypePtr cached_computation =
       GetComputationCache()->Get(hash);
+  if (cached_computation == nullptr && UseCoordinatedCompilation() &&
+      !IsCompilationOwner(hash)) {
+    cached_computation = WaitForSharedCompilation(hash);
+  }
   if (cached_computation == nullptr) {
     TORCH_LAZY_COUNTER("UncachedCompile", 1);
+    // A graph compiled before was evicted from the cache. XLA_COUNTER to
+    // support runtime::metrics::CreatePerformanceReport(), see NOTE:
+    // [TORCH_LAZY_COUNTER v.s. XLA_COUNTER].
+    if (GraphStats::Get()->GetCompiles(hash) > 0) {
+      XLA_COUNTER("UncachedRecompile", 1);
+    }
     return nullptr;
   }
-  TF_VLOG(5) << "Graph hash " << torch::lazy::HashToString(hash)
-             << " is computation hash "
-             << torch::lazy::HashToString(torch::lazy::Hash(
-                    cached_computation->computation->computation()
-                        .proto()
-                        .SerializeAsString()));
+  TF_HOT_VLOG(5) << "Graph hash " << torch::lazy::HashToString(hash)
+                 << " is computation hash "
+                 << torch::lazy::HashToString(torch::lazy::Hash(
+                        cached_computation->computation->computation()
+                            .proto()
+                            .SerializeAsString()));
   TORCH_LAZY_COUNTER("CachedCompile", 1);
   return cached_computation;
 }
 
+XLAGraphExecutor::ComputationCache::TypePtr
+XLAGraphExecutor::WaitForSharedCompilation(const torch::lazy::hash_t& hash) {
+  static const int64_t timeout_seconds = runtime::sys_util::GetEnvInt(
+      "XLA_PERSISTENT_CACHE_COORDINATED_TIMEOUT", 1800);
+  TORCH_LAZY_TIMED("CoordinatedCompileWaitTime");
+  TF_VLOG(3) << "Waiting for IR graph hash "
+             << torch::lazy::HashToString(hash) << " to be compiled remotely";
+  if (!runtime::GetComputationClient()->GetCoordinator().WaitForKey(
+          GetCompilationKey(hash), absl::Seconds(timeout_seconds))) {
+    TORCH_LAZY_COUNTER("CoordinatedCompileTimeout", 1);
+    TF_LOG(WARNING) << "Timed out waiting for IR graph hash "
+                    << torch::lazy::HashToString(hash)
+                    << " to be compiled remotely, compiling locally";
+    return nullptr;
+  }
+  ComputationCache::TypePtr cached_computation =
+      GetComputationCache()->Get(hash);
+  if (cached_computation != nullptr) {
+    TORCH_LAZY_COUNTER("CoordinatedCompileFetched", 1);
+  }
+  return cached_computation;
+}
+
+void XLAGraphExecutor::PublishSharedCompilation(
+    const torch::lazy::hash_t& hash) {
+  if (!UseCoordinatedCompilation() || !IsCompilationOwner(hash)) {
+    return;
+  }
+  auto persistent_cache = dynamic_cast<PersistentCache*>(GetComputationCache());
+  XLA_CHECK(persistent_cache != nullptr);
+  // The waiting processes load the executable from the storage.
+  persistent_cache->Flush();
+  runtime::GetComputationClient()->GetCoordinator().SetKeyValue(
+      GetCompilationKey(hash), "1");
+  TORCH_LAZY_COUNTER("CoordinatedCompilePublished", 1);
+}
+
 std::pair<bool, std::shared_ptr<XLAGraphExecutor::Async>>
 XLAGraphExecutor::TryRunCachedSync(
     std::vector<XLATensorPtr>* tensors, SyncTensorCollection* coll,
@@ -1219,6 +2359,12 @@ XLAGraphExecutor::TryRunCachedSync(
   } else {
     cache_hit = true;
   }
+  if (StepTimeline::Record* timeline_record = StepTimeline::Current()) {
+    timeline_record->cache_hit = true;
+  }
+  if (!warm_up_cache_only) {
+    CountFallbackExecution(coll->hash);
+  }
   TORCH_LAZY_VALUE_METRIC("TensorsGraphSize", po_data->post_order.size());
   TF_VLOG(5) << "TensorsGraphSize=" << po_data->post_order.size();
 
@@ -1271,8 +2417,7 @@ std::vector<size_t> XLAGraphExecutor::SetBufferDonors(
       // this buffer is not needed after execution since XLATensor will get a
       // new buffer.
       if (it != output_tensor_id_map.end()) {
-        lowering_ctx->builder()->AddBufferDonor(/*param_number=*/i,
-                                                /*param_index=*/{});
+        lowering_ctx->AddBufferDonor(i);
         buffer_donor_indexs.push_back(i);
       }
     }
@@ -1281,40 +2426,120 @@ std::vector<size_t> XLAGraphExecutor::SetBufferDonors(
   return buffer_donor_indexs;
 }
 
-XLAGraphExecutor::CompilationResult XLAGraphExecutor::Compile(
+std::unique_ptr<XLAGraphExecutor::PreparedCompilation>
+XLAGraphExecutor::PrepareCompilation(
     std::vector<XLATensorPtr>& tensors, absl::Span<const std::string> devices,
     const SyncTensorCollection& coll, PostOrderData* po_data,
-    const std::vector<torch::lazy::Value>& ir_values) {
-  tsl::profiler::TraceMe activity(
-      [&] {
-        return tsl::profiler::TraceMeEncode(
-            "XLAGraphExecutor::Compile",
-            {{"graph_hash", torch::lazy::HashToString(coll.hash)}});
-      },
-      tsl::profiler::TraceMeLevel::kInfo);
+    const std::vector<torch::lazy::Value>& ir_values, bool allow_async_compile,
+    absl::Span<const torch::lazy::Output> materialized_outputs) {
   static const bool enable_aliasing =
       runtime::sys_util::GetEnvBool("XLA_ENABLE_PARAM_ALIASING", true);
   static const size_t parameter_wrapping_threadshold =
       runtime::sys_util::GetEnvInt("XLA_PARAMETER_WRAPPING_THREADSHOLD", 3200);
   static const bool use_autosharding = ShardingUtil::GetAutoSharding();
+  {
+    torch::lazy::hash_t structure_hash = torch::lazy::MHash(
+        static_cast<int64_t>(po_data->post_order.size()));
+    for (const torch::lazy::Node* node : po_data->post_order) {
+      structure_hash =
+          torch::lazy::HashCombine(structure_hash, node->op().hash());
+    }
+    std::lock_guard<std::mutex> lock(graph_structure_mutex_);
+    if (++graph_structure_compiles_[structure_hash] > 1) {
+      // Same operations as an already compiled graph, so the new compilation
+      // most likely comes from different input shapes.
+      TORCH_LAZY_COUNTER("ShapeInducedRecompile", 1);
+    }
+  }
+  RecompileAnalyzer::Get()->AnalyzeCompilation(coll.hash,
+                                                po_data->post_order);
+  // The compatible all-reduces are issued as a few large collectives, rather
+  // than one per gradient, when XLA_ALL_REDUCE_BUCKET_MB is set.
+  static const int64_t all_reduce_bucket_bytes =
+      runtime::sys_util::GetEnvInt("XLA_ALL_REDUCE_BUCKET_MB", 0) << 20;
+  AllReduceBuckets all_reduce_buckets(po_data->post_order,
+                                      all_reduce_bucket_bytes);
   LoweringContext lowering_ctx("SyncTensorsGraph", coll.device,
-                               po_data->post_order,
+                               /*post_order=*/{},
                                std::move(po_data->emission_map));
+  auto prepared = std::make_unique<PreparedCompilation>();
+  // The graphs with many parameters take them in a single tuple, lowered as
+  // such rather than wrapped once built.
+  // TODO(yeounoh) enable wrapping with auto-sharding.
+  prepared->should_wrap_parameter =
+      (po_data->parameters_data.size() >= parameter_wrapping_threadshold) &&
+      !use_autosharding && !XlaHelpers::IsUnboundedDynamismEnabled();
+  if (prepared->should_wrap_parameter) {
+    TF_VLOG(3) << "Wrapping graph with " << po_data->parameters_data.size()
+               << " parameters. Threadshold = "
+               << parameter_wrapping_threadshold;
+    TORCH_LAZY_COUNTER("TupledParametersGraph", 1);
+    StepTimeline::ScopedStage timeline_stage(
+        StepTimeline::Stage::kParameterWrapping);
+    lowering_ctx.SetTupledParameters(po_data->parameters_data);
+  }
+  // The outputs computed by the first part of a split graph are read from
+  // their parameters, in place of the nodes left out of the post order.
+  for (size_t i = 0; i < materialized_outputs.size(); ++i) {
+    lowering_ctx.AssignOutputOp(
+        materialized_outputs[i],
+        lowering_ctx.GetParameter(po_data->parameters_data[i]));
+  }
+  // The large graphs are lowered in segments on the thread pool, unless the
+  // outputs need sharding annotations or all-reduce buckets, which are made
+  // over the whole graph.
+  static const int64_t parallel_lowering_min_nodes = ParallelLoweringMinNodes();
+  if (parallel_lowering_min_nodes > 0 &&
+      po_data->post_order.size() >= parallel_lowering_min_nodes &&
+      all_reduce_buckets.size() == 0 && coll.device != GetVirtualDevice() &&
+      !UseVirtualDevice() && !XlaHelpers::IsUnboundedDynamismEnabled()) {
+    size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    size_t segment_nodes =
+        std::max<size_t>(po_data->post_order.size() / threads,
+                         parallel_lowering_min_nodes / 8);
+    LowerInParallel(po_data->post_order, ir_values, segment_nodes,
+                    &lowering_ctx);
+  } else {
+    // The reusable scopes are called as shared computations, unless the
+    // all-reduce buckets or the sharding annotations need their nodes in the
+    // graph builder.
+    std::optional<ReusableScopeLowering> reusable_scopes;
+    if (all_reduce_buckets.size() == 0 && coll.device != GetVirtualDevice() &&
+        !UseVirtualDevice()) {
+      reusable_scopes.emplace(po_data->post_order, ir_values);
+    }
+    NodeDeduplicator deduplicator;
+    for (const torch::lazy::Node* node : po_data->post_order) {
+      if (reusable_scopes && reusable_scopes->TryLower(node, &lowering_ctx)) {
+        continue;
+      }
+      if (NodeDeduplicator::Enabled() &&
+          deduplicator.TryReuse(node, &lowering_ctx)) {
+        continue;
+      }
+      all_reduce_buckets.LowerNode(node, &lowering_ctx);
+    }
+    if (NodeDeduplicator::Enabled()) {
+      TF_VLOG(5) << "Deduplicated " << deduplicator.removed_nodes() << " of "
+                 << po_data->post_order.size() << " IR nodes";
+    }
+  }
   for (auto ir_value : ir_values) {
     xla::XlaOp root = lowering_ctx.GetOutputOp(
         torch::lazy::Output(ir_value.node.get(), ir_value.index));
     lowering_ctx.AddResult(root);
   }
   // Always execute sharded when running in SPMD mode
-  bool is_sharded = (coll.device == GetVirtualDevice()) || UseVirtualDevice();
+  prepared->is_sharded =
+      (coll.device == GetVirtualDevice()) || UseVirtualDevice();
   // Annotate HLO sharding selectively in the compuation.
   ShardingUtil::SetHloSharding(&lowering_ctx);
 
-  std::vector<size_t> buffer_donor_indices;
-  // TODO(yeounoh) enable aliasing is disabled for partitioned computation,
-  // since the current aliasing compares the unpartitioned input and output
-  // shapes which can lead to an incorrect aliasing pairs if sharded.
-  if (enable_aliasing && !use_autosharding) {
+  // The parameters are only marked as buffer donors, which the compiler pairs
+  // with the outputs after partitioning, by their per-shard shapes. This holds
+  // for auto-sharding too, where the shardings are only known once compiled.
+  std::vector<size_t> donor_indices;
+  if (enable_aliasing) {
     if (coll.config.sync_ltc_data && coll.config.force_ltc_data) {
       // We can only alias at the step barrier, when force_ltc_data is true.
       // Consider the case:
@@ -1340,60 +2565,121 @@ XLAGraphExecutor::CompilationResult XLAGraphExecutor::Compile(
       // will later fetch the new value of A, which is incorrect.
       // But, when we issue a step barrier (force_ltc_data == true) we have to
       // turn everything into DEVICE_DATA, so we can activate aliasing.
-      buffer_donor_indices =
-          SetBufferDonors(tensors, coll.indices, &lowering_ctx);
+      donor_indices = SetBufferDonors(tensors, coll.indices, &lowering_ctx);
     } else if (GetAliasWithBufferDonorConfig()) {
       // only alias based on buffer donor if LTC can't auto infer the input
       // output aliasing.
-      buffer_donor_indices = SetBufferDonorsFromUserConfig(&lowering_ctx);
+      donor_indices = SetBufferDonorsFromUserConfig(&lowering_ctx);
     }
   }
+  if (!prepared->is_sharded) {
+    prepared->recycled_output_parameters =
+        AddRecycledOutputParameters(ir_values.size(), donor_indices,
+                                    &lowering_ctx);
+  }
 
   xla::XlaComputation computation = ConsumeValue(lowering_ctx.BuildXla());
-  xla::ProgramShape program_shape = ConsumeValue(computation.GetProgramShape());
-
-  // TODO(yeounoh) enable wrapping with auto-sharding.
-  bool should_wrap_parameter =
-      (program_shape.parameters_size() >= parameter_wrapping_threadshold) &&
-      !use_autosharding;
-  if (should_wrap_parameter) {
-    TF_VLOG(3) << "Wrapping graph with " << program_shape.parameters_size()
-               << " parameters. Threadshold = "
-               << parameter_wrapping_threadshold;
-    computation = ConsumeValue(XlaHelpers::WrapXlaComputation(
-        computation, program_shape.parameters(), buffer_donor_indices));
-    program_shape = ConsumeValue(computation.GetProgramShape());
-  }
-  xla::Shape shape = MakeShapeWithDeviceLayout(
+  xla::ProgramShape& program_shape = prepared->program_shape;
+  program_shape = ConsumeValue(computation.GetProgramShape());
+  prepared->output_shape = MakeShapeWithDeviceLayout(
       program_shape.result(), static_cast<XlaDeviceType>(coll.device.type()));
+  prepared->emitted_nodes = lowering_ctx.GetEmittedNodeCount();
 
-  std::vector<runtime::ComputationClient::CompileInstance> instances;
-  instances.push_back({std::move(computation), coll.device.toString(),
-                       runtime::GetComputationClient()->GetCompilationDevices(
-                           coll.device.toString(), devices),
-                       &shape, should_wrap_parameter, is_sharded});
+  runtime::ComputationClient::CompileInstance& instance = prepared->instance;
+  instance = runtime::ComputationClient::CompileInstance(
+      std::move(computation), coll.device.toString(),
+      runtime::GetComputationClient()->GetCompilationDevices(
+          coll.device.toString(), devices),
+      &prepared->output_shape, prepared->should_wrap_parameter,
+      prepared->is_sharded);
+  instance.intra_op_threads = g_intra_op_threads;
+  instance.option_overrides = g_compile_option_overrides;
+  // The donated parameters are the state updated by every step, which is
+  // best kept in the layouts the compiled program wants to read.
+  if (UseAutoParameterLayouts() && !prepared->is_sharded &&
+      !prepared->should_wrap_parameter) {
+    instance.auto_layout_parameters = donor_indices;
+  }
+  // The executable reads the parameters placed in host memory from there.
+  const std::vector<torch::lazy::BackendDataPtr>& parameters_data =
+      lowering_ctx.GetParametersData();
+  for (size_t i = 0; i < parameters_data.size(); ++i) {
+    runtime::MemoryKind memory_kind =
+        UnwrapXlaData(parameters_data[i])->memory_kind();
+    if (memory_kind != runtime::MemoryKind::kDevice &&
+        instance.argument_memory_kinds.empty()) {
+      instance.argument_memory_kinds.assign(parameters_data.size(),
+                                            runtime::MemoryKind::kDevice);
+    }
+    if (!instance.argument_memory_kinds.empty()) {
+      instance.argument_memory_kinds[i] = memory_kind;
+    }
+  }
 
   if (use_autosharding) {
     TF_VLOG(5) << "use_auto_spmd_partitioning is set.";
-    TF_CHECK(is_sharded) << "Auto-sharding pass requires SPMD mode.";
-    instances.front().use_auto_spmd_partitioning = use_autosharding;
+    TF_CHECK(prepared->is_sharded) << "Auto-sharding pass requires SPMD mode.";
+    instance.use_auto_spmd_partitioning = use_autosharding;
     TORCH_LAZY_COUNTER("CompileWithAutoSharding", 1);
 
-    // Apply XLA_AUTO_SPMD_MESH if it is set.
-    // TODO(yeounoh) allow multi mesh exploration.
+    // Apply XLA_AUTO_SPMD_MESH if it is set, else the mesh selected by an
+    // earlier exploration of the graph, else explore the candidate meshes.
     std::vector<int64_t> auto_spmd_mesh_shape =
         ShardingUtil::GetAutoShardingMesh();
+    if (auto_spmd_mesh_shape.empty()) {
+      auto_spmd_mesh_shape = LookupAutoShardingMesh(coll.hash);
+    }
+    if (auto_spmd_mesh_shape.empty()) {
+      prepared->auto_spmd_mesh_candidates =
+          ShardingUtil::GetAutoShardingMeshCandidates();
+      if (!prepared->auto_spmd_mesh_candidates.empty()) {
+        auto_spmd_mesh_shape = prepared->auto_spmd_mesh_candidates.front();
+      }
+    }
     std::vector<int64_t> auto_spmd_mesh_ids =
         ShardingUtil::GetAutoShardingMeshIds(
-            instances.front().computation.proto());
-    instances.front().auto_spmd_mesh_shape = auto_spmd_mesh_shape;
-    instances.front().auto_spmd_mesh_ids = auto_spmd_mesh_ids;
+            instance.computation.proto());
+    instance.auto_spmd_mesh_shape = auto_spmd_mesh_shape;
+    instance.auto_spmd_mesh_ids = auto_spmd_mesh_ids;
     TF_VLOG(5) << "auto_spmd_mesh_shape={"
                << absl::StrJoin(auto_spmd_mesh_shape, ",") << "}\n"
                << "auto_spmd_mesh_ids={"
                << absl::StrJoin(auto_spmd_mesh_ids, ",") << "}";
   }
 
+  // With XLA_ASYNC_COMPILE the current step runs a quickly compiled fallback,
+  // while the optimized executable is built in background. Auto-sharding
+  // reshards the parameters based on the compiled module, so it needs the
+  // final executable right away.
+  static const bool use_async_compile =
+      runtime::sys_util::GetEnvBool("XLA_ASYNC_COMPILE", false);
+  if (allow_async_compile && use_async_compile && !use_autosharding) {
+    static const int64_t fallback_optimization_level =
+        runtime::sys_util::GetEnvInt("XLA_ASYNC_COMPILE_FALLBACK_OPT_LEVEL",
+                                     0);
+    runtime::ComputationClient::CompileInstance& fallback = instance;
+    auto async_compile_request = std::make_shared<AsyncCompileRequest>();
+    async_compile_request->output_shape = prepared->output_shape;
+    async_compile_request->instance =
+        runtime::ComputationClient::CompileInstance(
+            xla::XlaComputation(fallback.computation.proto()),
+            fallback.compilation_device, fallback.devices,
+            &async_compile_request->output_shape,
+            fallback.parameter_is_tupled_arguments, fallback.is_sharded,
+            fallback.allow_spmd_sharding_propagation_to_output);
+    async_compile_request->instance.argument_memory_kinds =
+        fallback.argument_memory_kinds;
+    async_compile_request->instance.auto_layout_parameters =
+        fallback.auto_layout_parameters;
+    async_compile_request->instance.intra_op_threads =
+        fallback.intra_op_threads;
+    async_compile_request->instance.option_overrides =
+        fallback.option_overrides;
+    fallback.backend_optimization_level = fallback_optimization_level;
+    prepared->async_compile_request = std::move(async_compile_request);
+    TORCH_LAZY_COUNTER("AsyncCompileFallback", 1);
+  }
+
   DebugUtil::analyze_graph_execution_python_frame(
       DebugUtil::GraphAnalysisSource::Compilation,
       /*graph_hash=*/coll.hash, /*program_shape=*/&program_shape);
@@ -1401,24 +2687,33 @@ XLAGraphExecutor::CompilationResult XLAGraphExecutor::Compile(
   TF_VLOG(3) << "Compiling IR graph hash "
              << torch::lazy::HashToString(coll.hash) << " on device "
              << coll.device << " ...";
-  std::vector<std::shared_ptr<runtime::ComputationClient::Computation>>
-      computations =
-          runtime::GetComputationClient()->Compile(std::move(instances));
-  DebugUtil::post_compilation_analysis(computations[0]);
+  return prepared;
+}
+
+XLAGraphExecutor::CompilationResult XLAGraphExecutor::FinishCompilation(
+    std::vector<XLATensorPtr>& tensors, const SyncTensorCollection& coll,
+    PostOrderData* po_data, PreparedCompilation* prepared,
+    runtime::ComputationClient::ComputationPtr computation) {
+  static const bool use_autosharding = ShardingUtil::GetAutoSharding();
+  DebugUtil::post_compilation_analysis(computation);
   TF_VLOG(3) << "Compiling IR graph hash "
              << torch::lazy::HashToString(coll.hash) << " on device "
              << coll.device << " done!";
   TF_VLOG(5) << "Compiled program shape "
-             << computations.front()->program_shape().ToString() << std::endl;
+             << computation->program_shape().ToString() << std::endl;
   TF_VLOG(5)
       << "Graph hash " << torch::lazy::HashToString(coll.hash)
       << " is computation hash "
       << torch::lazy::HashToString(torch::lazy::Hash(
-             computations.front()->computation().proto().SerializeAsString()));
+             computation->computation().proto().SerializeAsString()));
+  RecordCompiledMemoryStats(coll.hash, *computation);
 
   if (use_autosharding) {
     const xla::HloModuleProto& computation_proto =
-        computations.front()->computation().proto();
+        computation->computation().proto();
+    TORCH_LAZY_VALUE_METRIC(
+        "AutoShardingAliasCount",
+        ShardingUtil::CountPartitionedAliases(computation_proto));
     ShardingUtil::ReshardParameters(computation_proto, &tensors,
                                     &po_data->parameters_data,
                                     &po_data->post_order);
@@ -1426,20 +2721,417 @@ XLAGraphExecutor::CompilationResult XLAGraphExecutor::Compile(
                << torch::lazy::Hash(po_data->parameter_sequence);
   }
 
-  if (should_wrap_parameter) {
+  const xla::ProgramShape& program_shape = prepared->program_shape;
+  if (prepared->should_wrap_parameter) {
     XLA_CHECK_EQ(program_shape.parameters_size(), 1);
     XLA_CHECK_EQ(program_shape.parameters()[0].tuple_shapes_size(),
                  po_data->parameters_data.size());
   } else {
     XLA_CHECK_EQ(program_shape.parameters_size(),
-                 po_data->parameters_data.size());
+                 po_data->parameters_data.size() +
+                     prepared->recycled_output_parameters);
   }
 
   return {/*device=*/coll.device,
-          /*emitted_nodes=*/lowering_ctx.GetEmittedNodeCount(),
-          /*computation=*/computations.front(),
+          /*emitted_nodes=*/prepared->emitted_nodes,
+          /*computation=*/std::move(computation),
           /*parameters_data=*/std::move(po_data->parameters_data),
-          /*is_sharded=*/is_sharded};
+          /*is_sharded=*/prepared->is_sharded,
+          /*async_compile_request=*/
+          std::move(prepared->async_compile_request)};
+}
+
+XLAGraphExecutor::CompilationResult XLAGraphExecutor::Compile(
+    std::vector<XLATensorPtr>& tensors, absl::Span<const std::string> devices,
+    const SyncTensorCollection& coll, PostOrderData* po_data,
+    const std::vector<torch::lazy::Value>& ir_values,
+    absl::Span<const torch::lazy::Output> materialized_outputs) {
+  tsl::profiler::TraceMe activity(
+      [&] {
+        return tsl::profiler::TraceMeEncode(
+            "XLAGraphExecutor::Compile",
+            {{"graph_hash", torch::lazy::HashToString(coll.hash)}});
+      },
+      tsl::profiler::TraceMeLevel::kInfo);
+  StepTimeline::ScopedStage timeline_stage(StepTimeline::Stage::kCompile);
+  int64_t start_ns = runtime::sys_util::NowNs();
+  std::unique_ptr<PreparedCompilation> prepared =
+      PrepareCompilation(tensors, devices, coll, po_data, ir_values,
+                         /*allow_async_compile=*/true, materialized_outputs);
+  std::vector<runtime::ComputationClient::ComputationPtr> computations =
+      CompilePrepared({coll.hash}, {prepared.get()});
+  CompilationResult result =
+      FinishCompilation(tensors, coll, po_data, prepared.get(),
+                        std::move(computations.front()));
+  GraphStats::Get()->RecordCompile(
+      coll.hash, runtime::sys_util::NowNs() - start_ns, *result.computation);
+  return result;
+}
+
+std::vector<runtime::ComputationClient::ComputationPtr>
+XLAGraphExecutor::CompilePrepared(
+    absl::Span<const torch::lazy::hash_t> hashes,
+    absl::Span<PreparedCompilation* const> prepared) {
+  static const bool dedup_executables =
+      runtime::sys_util::GetEnvBool("XLA_DEDUP_EXECUTABLES", true);
+  std::vector<runtime::ComputationClient::CompileInstance> instances;
+  // The instances of prepared[i] start at offsets[i], one per mesh candidate.
+  std::vector<size_t> offsets;
+  offsets.reserve(prepared.size());
+  // The fingerprints of the graphs without mesh candidates, and the
+  // executables of theirs already compiled.
+  std::vector<std::optional<torch::lazy::hash_t>> fingerprints(prepared.size());
+  std::vector<runtime::ComputationClient::ComputationPtr> reused(
+      prepared.size());
+  for (size_t i = 0; i < prepared.size(); ++i) {
+    PreparedCompilation* graph = prepared[i];
+    offsets.push_back(instances.size());
+    if (dedup_executables && graph->auto_spmd_mesh_candidates.empty()) {
+      fingerprints[i] = CompiledHloFingerprint(graph->instance);
+      reused[i] = LookupHloExecutable(*fingerprints[i]);
+      if (reused[i] != nullptr) {
+        TF_VLOG(3) << "IR graph hash " << torch::lazy::HashToString(hashes[i])
+                   << " reuses the executable of HLO fingerprint "
+                   << torch::lazy::HashToString(*fingerprints[i]);
+        TORCH_LAZY_COUNTER("DeduplicatedExecutables", 1);
+        continue;
+      }
+    }
+    std::vector<runtime::ComputationClient::CompileInstance> alternatives;
+    for (size_t j = 1; j < graph->auto_spmd_mesh_candidates.size(); ++j) {
+      alternatives.push_back(CloneCompileInstance(graph->instance));
+      alternatives.back().auto_spmd_mesh_shape =
+          graph->auto_spmd_mesh_candidates[j];
+    }
+    instances.push_back(std::move(graph->instance));
+    for (auto& alternative : alternatives) {
+      instances.push_back(std::move(alternative));
+    }
+  }
+  std::vector<runtime::ComputationClient::ComputationPtr> candidates;
+  if (!instances.empty()) {
+    candidates =
+        runtime::GetComputationClient()->Compile(std::move(instances));
+  }
+
+  std::vector<runtime::ComputationClient::ComputationPtr> computations;
+  computations.reserve(prepared.size());
+  for (size_t i = 0; i < prepared.size(); ++i) {
+    const std::vector<std::vector<int64_t>>& meshes =
+        prepared[i]->auto_spmd_mesh_candidates;
+    if (reused[i] != nullptr) {
+      computations.push_back(std::move(reused[i]));
+      continue;
+    }
+    if (meshes.empty()) {
+      computations.push_back(std::move(candidates[offsets[i]]));
+      if (fingerprints[i].has_value()) {
+        std::lock_guard<std::mutex> lock(hlo_executables_mutex_);
+        hlo_executables_[*fingerprints[i]] = computations.back();
+      }
+      continue;
+    }
+    TORCH_LAZY_COUNTER("AutoShardingMeshExplored", meshes.size());
+    size_t best = 0;
+    std::pair<double, int64_t> best_cost;
+    for (size_t j = 0; j < meshes.size(); ++j) {
+      std::pair<double, int64_t> cost =
+          AutoShardingCost(*candidates[offsets[i] + j]);
+      TF_VLOG(3) << "Auto-sharding mesh {" << absl::StrJoin(meshes[j], ",")
+                 << "} of IR graph hash "
+                 << torch::lazy::HashToString(hashes[i])
+                 << ": bytes accessed=" << cost.first
+                 << ", memory=" << cost.second;
+      if (j == 0 || cost < best_cost) {
+        best = j;
+        best_cost = cost;
+      }
+    }
+    TF_VLOG(3) << "Selected auto-sharding mesh {"
+               << absl::StrJoin(meshes[best], ",") << "} for IR graph hash "
+               << torch::lazy::HashToString(hashes[i]);
+    {
+      std::lock_guard<std::mutex> lock(auto_sharding_mesh_mutex_);
+      auto_sharding_meshes_[hashes[i]] = meshes[best];
+    }
+    computations.push_back(std::move(candidates[offsets[i] + best]));
+  }
+  return computations;
+}
+
+std::vector<int64_t> XLAGraphExecutor::LookupAutoShardingMesh(
+    const torch::lazy::hash_t& hash) {
+  std::lock_guard<std::mutex> lock(auto_sharding_mesh_mutex_);
+  auto it = auto_sharding_meshes_.find(hash);
+  if (it == auto_sharding_meshes_.end()) {
+    return {};
+  }
+  TORCH_LAZY_COUNTER("AutoShardingMeshReused", 1);
+  return it->second;
+}
+
+runtime::ComputationClient::ComputationPtr
+XLAGraphExecutor::LookupHloExecutable(const torch::lazy::hash_t& fingerprint) {
+  std::lock_guard<std::mutex> lock(hlo_executables_mutex_);
+  auto it = hlo_executables_.find(fingerprint);
+  if (it == hlo_executables_.end()) {
+    return nullptr;
+  }
+  runtime::ComputationClient::ComputationPtr computation = it->second.lock();
+  if (computation == nullptr) {
+    // All the graphs of the executable were evicted from the cache.
+    hlo_executables_.erase(it);
+  }
+  return computation;
+}
+
+void XLAGraphExecutor::WarmUpCaches(
+    std::vector<std::vector<XLATensorPtr>>* tensor_groups,
+    absl::Span<const std::string> devices) {
+  tsl::profiler::TraceMe activity("WarmUpCaches",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  struct PendingGraph {
+    std::vector<XLATensorPtr>* tensors;
+    SyncTensorCollection coll;
+    PostOrderData po_data;
+    std::unique_ptr<PreparedCompilation> prepared;
+  };
+  SyncTensorsConfig config;
+  config.sync_ltc_data = false;
+  config.force_ltc_data = false;
+  std::vector<std::unique_ptr<PendingGraph>> graphs;
+  std::unordered_set<torch::lazy::hash_t, torch::lazy::HashReducer> hashes;
+  for (std::vector<XLATensorPtr>& tensors : *tensor_groups) {
+    std::unique_ptr<PendingGraph> graph(
+        new PendingGraph{&tensors, CollectSyncTensors(tensors, config)});
+    if (graph->coll.indices.empty()) {
+      continue;
+    }
+    std::vector<torch::lazy::Value> ir_values =
+        CollectRoots(tensors, graph->coll.indices);
+    graph->po_data = RunPostOrder(ir_values, &graph->coll);
+    graph->coll.hash = CombineGraphHash(graph->coll.hash, graph->po_data);
+    if (!hashes.insert(graph->coll.hash).second ||
+        LookupCachedCompile(graph->coll.hash) != nullptr) {
+      continue;
+    }
+    graph->prepared =
+        PrepareCompilation(tensors, devices, graph->coll, &graph->po_data,
+                           ir_values, /*allow_async_compile=*/false);
+    // Nothing gets executed, so the device lock is not needed past lowering.
+    // Holding it would deadlock the next group targeting the same device.
+    graph->coll.unlocker.clear();
+    graphs.push_back(std::move(graph));
+  }
+  if (graphs.empty()) {
+    return;
+  }
+
+  TORCH_LAZY_COUNTER("WarmUpCacheBatchGraphs", graphs.size());
+  std::vector<torch::lazy::hash_t> graph_hashes;
+  std::vector<PreparedCompilation*> prepared;
+  graph_hashes.reserve(graphs.size());
+  prepared.reserve(graphs.size());
+  for (auto& graph : graphs) {
+    graph_hashes.push_back(graph->coll.hash);
+    prepared.push_back(graph->prepared.get());
+  }
+  int64_t start_ns = runtime::sys_util::NowNs();
+  std::vector<runtime::ComputationClient::ComputationPtr> computations =
+      CompilePrepared(graph_hashes, prepared);
+  // The graphs of the batch share its compile time.
+  int64_t compile_ns = (runtime::sys_util::NowNs() - start_ns) /
+                       static_cast<int64_t>(graphs.size());
+  for (size_t i = 0; i < graphs.size(); ++i) {
+    PendingGraph& graph = *graphs[i];
+    CompilationResult compile_result =
+        FinishCompilation(*graph.tensors, graph.coll, &graph.po_data,
+                          graph.prepared.get(), std::move(computations[i]));
+    GraphStats::Get()->RecordCompile(graph.coll.hash, compile_ns,
+                                     *compile_result.computation);
+    GetComputationCache()->Add(
+        graph.coll.hash, std::make_shared<CachedComputation>(
+                             std::move(compile_result.computation),
+                             compile_result.is_sharded));
+    PublishSharedCompilation(graph.coll.hash);
+  }
+}
+
+void XLAGraphExecutor::ScheduleAsyncCompile(
+    torch::lazy::hash_t hash, std::shared_ptr<AsyncCompileRequest> request) {
+  static const int64_t hot_executions = runtime::sys_util::GetEnvInt(
+      "XLA_ASYNC_COMPILE_HOT_EXECUTIONS", 1);
+  if (hot_executions > 1) {
+    // The fallback is about to run for the first time.
+    std::lock_guard<std::mutex> lock(async_compile_mutex_);
+    deferred_async_compiles_[hash] = {std::move(request), /*executions=*/1};
+    TORCH_LAZY_COUNTER("AsyncCompileDeferred", 1);
+    return;
+  }
+  LaunchAsyncCompile(hash, std::move(request));
+}
+
+void XLAGraphExecutor::CountFallbackExecution(
+    const torch::lazy::hash_t& hash) {
+  static const int64_t hot_executions = runtime::sys_util::GetEnvInt(
+      "XLA_ASYNC_COMPILE_HOT_EXECUTIONS", 1);
+  std::shared_ptr<AsyncCompileRequest> request;
+  {
+    std::lock_guard<std::mutex> lock(async_compile_mutex_);
+    auto it = deferred_async_compiles_.find(hash);
+    if (it == deferred_async_compiles_.end() ||
+        ++it->second.executions < hot_executions) {
+      return;
+    }
+    request = std::move(it->second.request);
+    deferred_async_compiles_.erase(it);
+  }
+  TF_VLOG(3) << "IR graph hash " << torch::lazy::HashToString(hash)
+             << " is hot, compiling its optimized executable";
+  LaunchAsyncCompile(hash, std::move(request));
+}
+
+void XLAGraphExecutor::LaunchAsyncCompile(
+    torch::lazy::hash_t hash, std::shared_ptr<AsyncCompileRequest> request) {
+  {
+    std::lock_guard<std::mutex> lock(async_compile_mutex_);
+    if (!pending_async_compiles_.insert(hash).second) {
+      return;
+    }
+  }
+  TORCH_LAZY_COUNTER("AsyncCompileScheduled", 1);
+  auto compilefn = [this, hash, request = std::move(request)]() {
+    tsl::profiler::TraceMe activity(
+        [&] {
+          return tsl::profiler::TraceMeEncode(
+              "XLAGraphExecutor::AsyncCompile",
+              {{"graph_hash", torch::lazy::HashToString(hash)}});
+        },
+        tsl::profiler::TraceMeLevel::kInfo);
+    try {
+      TORCH_LAZY_TIMED("AsyncCompileTime");
+      int64_t start_ns = runtime::sys_util::NowNs();
+      bool is_sharded = request->instance.is_sharded;
+      std::vector<runtime::ComputationClient::CompileInstance> instances;
+      instances.push_back(std::move(request->instance));
+      std::vector<std::shared_ptr<runtime::ComputationClient::Computation>>
+          computations =
+              runtime::GetComputationClient()->Compile(std::move(instances));
+      // The fallback entry has to go first, since Add() keeps existing values.
+      // Executions already scheduled hold their own reference to it.
+      RecordCompiledMemoryStats(hash, *computations.front());
+      GraphStats::Get()->RecordCompile(
+          hash, runtime::sys_util::NowNs() - start_ns, *computations.front());
+      ComputationCache* cache = GetComputationCache();
+      cache->Erase(hash);
+      cache->Add(hash, std::make_shared<CachedComputation>(
+                           computations.front(), is_sharded));
+      PublishSharedCompilation(hash);
+      TORCH_LAZY_COUNTER("AsyncCompileCompleted", 1);
+      TF_VLOG(3) << "Background compilation of IR graph hash "
+                 << torch::lazy::HashToString(hash) << " done!";
+    } catch (const std::exception& ex) {
+      TORCH_LAZY_COUNTER("AsyncCompileFailed", 1);
+      TF_LOG(WARNING) << "Background compilation of IR graph hash "
+                      << torch::lazy::HashToString(hash)
+                      << " failed, keeping the fallback executable: "
+                      << ex.what();
+    }
+    {
+      std::lock_guard<std::mutex> lock(async_compile_mutex_);
+      pending_async_compiles_.erase(hash);
+    }
+    async_compile_cv_.notify_all();
+  };
+  thread::ScheduleBackground(std::move(compilefn));
+}
+
+void XLAGraphExecutor::WaitAsyncCompilations() {
+  std::unique_lock<std::mutex> lock(async_compile_mutex_);
+  async_compile_cv_.wait(lock,
+                         [this] { return pending_async_compiles_.empty(); });
+}
+
+std::vector<std::pair<torch::lazy::hash_t, int64_t>>
+XLAGraphExecutor::GetGraphStructureCompiles() {
+  std::lock_guard<std::mutex> lock(graph_structure_mutex_);
+  return std::vector<std::pair<torch::lazy::hash_t, int64_t>>(
+      graph_structure_compiles_.begin(), graph_structure_compiles_.end());
+}
+
+void XLAGraphExecutor::RecordCompiledMemoryStats(
+    const torch::lazy::hash_t& hash,
+    const runtime::ComputationClient::Computation& computation) {
+  std::optional<runtime::ComputationClient::CompiledMemoryStats> stats =
+      computation.GetCompiledMemoryStats();
+  if (!stats) {
+    return;
+  }
+  TF_VLOG(3) << "IR graph hash " << torch::lazy::HashToString(hash)
+             << " needs " << stats->ExecutionBytes()
+             << " device bytes on top of its " << stats->argument_bytes
+             << " argument bytes";
+  std::lock_guard<std::mutex> lock(compiled_memory_stats_mutex_);
+  compiled_memory_stats_[hash] = *stats;
+}
+
+std::vector<std::pair<torch::lazy::hash_t,
+                      runtime::ComputationClient::CompiledMemoryStats>>
+XLAGraphExecutor::GetCompiledMemoryStats() {
+  std::lock_guard<std::mutex> lock(compiled_memory_stats_mutex_);
+  return std::vector<std::pair<
+      torch::lazy::hash_t, runtime::ComputationClient::CompiledMemoryStats>>(
+      compiled_memory_stats_.begin(), compiled_memory_stats_.end());
+}
+
+torch::lazy::hash_t XLAGraphExecutor::CombineGraphHash(
+    torch::lazy::hash_t hash, const PostOrderData& po_data) {
+  hash = torch::lazy::HashCombine(
+      hash, torch::lazy::Hash(po_data.parameter_sequence));
+  if (GetAliasWithBufferDonorConfig()) {
+    std::vector<size_t> buffer_donor_index =
+        GetBufferDonorIndexFromUserConfig(po_data.parameters_data);
+    if (buffer_donor_index.size() > 0) {
+      // Do not include hash on a empty vector.
+      hash = torch::lazy::HashCombine(hash,
+                                      torch::lazy::Hash(buffer_donor_index));
+    }
+  }
+  if (SyncRootsOnly() || MaxSyncGraphSize() > 0) {
+    // Pruned and split syncs keep some parameters from being donated, which
+    // changes the aliasing of the compiled graph.
+    std::vector<size_t> read_only_index;
+    for (size_t i = 0; i < po_data.parameters_data.size(); ++i) {
+      auto* data_info =
+          static_cast<torch::lazy::LazyGraphExecutor::DeviceDataInfo*>(
+              po_data.parameters_data[i]->info());
+      if (data_info != nullptr && data_info->read_only) {
+        read_only_index.push_back(i);
+      }
+    }
+    if (!read_only_index.empty()) {
+      hash =
+          torch::lazy::HashCombine(hash, torch::lazy::Hash(read_only_index));
+    }
+  }
+  {
+    // Auto-sharding configs
+    hash = torch::lazy::HashCombine(
+        hash, torch::lazy::MHash(ShardingUtil::GetAutoSharding()));
+    hash = torch::lazy::HashCombine(
+        hash,
+        torch::lazy::StringHash(
+            runtime::sys_util::GetEnvString("XLA_AUTO_SPMD_MESH", "").c_str()));
+    if (runtime::sys_util::GetEnvBool("XLA_AUTO_SPMD_MESH_EXPLORE", false)) {
+      hash = torch::lazy::HashCombine(
+          hash, torch::lazy::StringHash("XLA_AUTO_SPMD_MESH_EXPLORE"));
+    }
+  }
+  if (UseAutoParameterLayouts()) {
+    hash = torch::lazy::HashCombine(
+        hash, torch::lazy::StringHash("XLA_AUTO_PARAMETER_LAYOUTS"));
+  }
+  return hash;
 }
 
 std::shared_ptr<XLAGraphExecutor::Async>
@@ -1448,6 +3140,13 @@ XLAGraphExecutor::SyncTensorsGraphInternal(
     const SyncTensorsConfig& config, bool warm_up_cache_only) {
   tsl::profiler::TraceMe activity("SyncTensorsGraphInternal",
                                   tsl::profiler::TraceMeLevel::kInfo);
+  std::vector<std::vector<size_t>> device_groups =
+      GroupTensorsByDevice(*tensors);
+  if (device_groups.size() > 1) {
+    return SyncMultiDeviceTensorsGraph(tensors, devices, config,
+                                       warm_up_cache_only, device_groups);
+  }
+  StepTimeline::ScopedStep timeline_step;
   SyncTensorCollection coll = CollectSyncTensors(*tensors, config);
   if (coll.indices.empty()) {
     // Enure previous execution is complete before exiting this
@@ -1472,31 +3171,25 @@ XLAGraphExecutor::SyncTensorsGraphInternal(
   ExtractIRAndPrepareXlaData_(tensors, coll.config, coll.indices, ir_values,
                               tensor_data_vec);
   PostOrderData po_data = RunPostOrder(ir_values, &coll);
-  coll.hash = torch::lazy::HashCombine(
-      coll.hash, torch::lazy::Hash(po_data.parameter_sequence));
-  if (GetAliasWithBufferDonorConfig()) {
-    std::vector<size_t> buffer_donor_index =
-        GetBufferDonorIndexFromUserConfig(po_data.parameters_data);
-    if (buffer_donor_index.size() > 0) {
-      // Do not include hash on a empty vector.
-      coll.hash = torch::lazy::HashCombine(
-          coll.hash, torch::lazy::Hash(buffer_donor_index));
-    }
-  }
-  {
-    // Auto-sharding configs
-    coll.hash = torch::lazy::HashCombine(
-        coll.hash, torch::lazy::MHash(ShardingUtil::GetAutoSharding()));
-    coll.hash = torch::lazy::HashCombine(
-        coll.hash,
-        torch::lazy::StringHash(
-            runtime::sys_util::GetEnvString("XLA_AUTO_SPMD_MESH", "").c_str()));
+  coll.hash = CombineGraphHash(coll.hash, po_data);
+  if (StepTimeline::Record* timeline_record = StepTimeline::Current()) {
+    timeline_record->num_tensors = coll.indices.size();
+    timeline_record->graph_hash = coll.hash;
   }
 
   DebugUtil::SaveGraphHash(coll.hash);
   TF_VLOG(4) << "Parameter sequence graph hash "
              << torch::lazy::HashToString(coll.hash);
 
+  // The graphs found too large for the device memory run in two parts, the
+  // second one cached under its own hash.
+  std::vector<torch::lazy::Output> materialized_outputs;
+  std::optional<size_t> split_cut =
+      warm_up_cache_only ? std::nullopt : LookupGraphSplitCut(coll.hash);
+  if (split_cut.has_value()) {
+    materialized_outputs =
+        SplitGraph(devices, &coll, &po_data, ir_values, *split_cut);
+  }
   std::pair<bool, std::shared_ptr<XLAGraphExecutor::Async>> cache_res =
       TryRunCachedSync(tensors, &coll, &po_data, tensor_data_vec,
                        warm_up_cache_only);
@@ -1504,14 +3197,52 @@ XLAGraphExecutor::SyncTensorsGraphInternal(
     // we have a cache hit, execution has been scheduled by TryRunCachedSync.
     return cache_res.second;
   }
-  CompilationResult compile_result =
-      Compile(*tensors, devices, coll, &po_data, ir_values);
+  MaybeEvictColdComputations(coll.device, GetComputationCache());
+  CompilationResult compile_result = Compile(*tensors, devices, coll, &po_data,
+                                             ir_values, materialized_outputs);
+  if (!split_cut.has_value() && !warm_up_cache_only) {
+    split_cut = GraphSplitCut(*compile_result.computation, coll.device,
+                              po_data.post_order);
+    if (split_cut.has_value()) {
+      // The executable of the whole graph is dropped, the next syncs of the
+      // graph go split from the start.
+      TORCH_LAZY_COUNTER("GraphSplits", 1);
+      {
+        std::lock_guard<std::mutex> lock(graph_split_mutex_);
+        graph_split_cuts_[coll.hash] = *split_cut;
+      }
+      materialized_outputs =
+          SplitGraph(devices, &coll, &po_data, ir_values, *split_cut);
+      cache_res = TryRunCachedSync(tensors, &coll, &po_data, tensor_data_vec,
+                                   /*warm_up_cache_only=*/false);
+      if (cache_res.first) {
+        return cache_res.second;
+      }
+      compile_result = Compile(*tensors, devices, coll, &po_data, ir_values,
+                               materialized_outputs);
+    }
+  }
 
   TORCH_LAZY_VALUE_METRIC("TensorsGraphSize", compile_result.emitted_nodes);
   TF_VLOG(5) << "TensorsGraphSize=" << compile_result.emitted_nodes;
   auto cached_computation = std::make_shared<CachedComputation>(
       std::move(compile_result.computation), compile_result.is_sharded);
-  GetComputationCache()->Add(coll.hash, cached_computation);
+  if (compile_result.async_compile_request != nullptr) {
+    // Only the optimized executable should be persisted, so the fallback is
+    // only tracked in memory.
+    auto persistent_cache =
+        dynamic_cast<PersistentCache*>(GetComputationCache());
+    if (persistent_cache != nullptr) {
+      persistent_cache->GetMemoryCache().Add(coll.hash, cached_computation);
+    } else {
+      GetComputationCache()->Add(coll.hash, cached_computation);
+    }
+    ScheduleAsyncCompile(coll.hash,
+                         std::move(compile_result.async_compile_request));
+  } else {
+    GetComputationCache()->Add(coll.hash, cached_computation);
+    PublishSharedCompilation(coll.hash);
+  }
 
   if (warm_up_cache_only) {
     return nullptr;
@@ -1523,4 +3254,170 @@ XLAGraphExecutor::SyncTensorsGraphInternal(
   }
 }
 
+std::optional<size_t> XLAGraphExecutor::LookupGraphSplitCut(
+    const torch::lazy::hash_t& hash) {
+  std::lock_guard<std::mutex> lock(graph_split_mutex_);
+  auto it = graph_split_cuts_.find(hash);
+  if (it == graph_split_cuts_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::vector<torch::lazy::Output> XLAGraphExecutor::SplitGraph(
+    absl::Span<const std::string> devices, SyncTensorCollection* coll,
+    PostOrderData* po_data, const std::vector<torch::lazy::Value>& ir_values,
+    size_t cut) {
+  tsl::profiler::TraceMe activity("SplitGraph",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  TORCH_LAZY_COUNTER("GraphSplitSyncs", 1);
+  std::unordered_set<const torch::lazy::Node*> head;
+  std::vector<const torch::lazy::Node*> tail;
+  for (const torch::lazy::Node* node : po_data->post_order) {
+    if (node->op() == xla_device_data) {
+      continue;
+    }
+    if (head.size() < cut) {
+      head.insert(node);
+    } else {
+      tail.push_back(node);
+    }
+  }
+  // The post order is topological, so the head holds all the computed nodes
+  // the materialized outputs depend on.
+  std::vector<torch::lazy::Output> materialized_outputs;
+  OutputMap<bool> materialized;
+  std::unordered_set<const torch::lazy::Node*> tail_data;
+  auto use = [&](const torch::lazy::Output& output) {
+    if (head.count(output.node) > 0) {
+      if (materialized.emplace(output, true).second) {
+        materialized_outputs.push_back(output);
+      }
+    } else if (output.node->op() == xla_device_data) {
+      tail_data.insert(output.node);
+    }
+  };
+  for (const torch::lazy::Node* node : tail) {
+    for (const torch::lazy::Output& operand : node->operands()) {
+      use(operand);
+    }
+  }
+  for (const torch::lazy::Value& ir_value : ir_values) {
+    use(torch::lazy::Output(ir_value.node.get(), ir_value.index));
+  }
+
+  // The head runs as the graph of temporary tensors, which keep the roots,
+  // and so the head nodes, alive.
+  auto roots = std::make_shared<std::vector<torch::lazy::Value>>(ir_values);
+  std::vector<XLATensorPtr> head_tensors;
+  head_tensors.reserve(materialized_outputs.size());
+  for (const torch::lazy::Output& output : materialized_outputs) {
+    torch::lazy::NodePtr node(roots,
+                              const_cast<torch::lazy::Node*>(output.node));
+    head_tensors.push_back(XLATensor::Create(
+        torch::lazy::Value(std::move(node), output.index), coll->device));
+  }
+  // The head takes the device lock for its own execution, the tail taking it
+  // again when scheduled. None of the parameters of the head are donated, as
+  // the tail can still read them.
+  coll->unlocker.clear();
+  SyncTensorsConfig config;
+  config.force_ltc_data = false;
+  std::shared_ptr<Async> async =
+      SyncTensorsGraphInternal(&head_tensors, devices, config);
+  if (async != nullptr) {
+    // The tail is lowered with the handles of the materialized outputs.
+    async->WaitExecution();
+  }
+
+  // The parameters are declared in the order the lowering meets them, the
+  // materialized outputs first, each device data once.
+  PostOrderData tail_po_data;
+  std::unordered_set<torch::lazy::BackendData::Handle> handles;
+  auto add_parameter = [&](const torch::lazy::BackendDataPtr& data) {
+    if (handles.insert(data->GetHandle()).second) {
+      tail_po_data.parameters_data.push_back(data);
+    }
+    tail_po_data.parameter_sequence.push_back(
+        tail_po_data.parameters_data.size() - 1);
+  };
+  for (const XLATensorPtr& tensor : head_tensors) {
+    add_parameter(tensor->CurrentDataHandle());
+  }
+  XLA_CHECK_EQ(tail_po_data.parameters_data.size(),
+               materialized_outputs.size());
+  for (const torch::lazy::Node* node : po_data->post_order) {
+    if (tail_data.count(node) > 0) {
+      tail_po_data.post_order.push_back(node);
+      add_parameter(DeviceData::Cast(node)->data());
+    }
+  }
+  tail_po_data.post_order.insert(tail_po_data.post_order.end(), tail.begin(),
+                                 tail.end());
+  TORCH_LAZY_VALUE_METRIC("GraphSplitMaterializedOutputs",
+                          materialized_outputs.size());
+  TF_VLOG(4) << "Split graph " << torch::lazy::HashToString(coll->hash)
+             << " after " << cut << " computed nodes, materializing "
+             << materialized_outputs.size() << " outputs";
+  coll->hash = torch::lazy::HashCombine(
+      coll->hash, torch::lazy::MHash(std::string("GraphSplitTail"),
+                                     static_cast<int64_t>(cut)));
+  *po_data = std::move(tail_po_data);
+  return materialized_outputs;
+}
+
+std::shared_ptr<XLAGraphExecutor::Async>
+XLAGraphExecutor::SyncMultiDeviceTensorsGraph(
+    std::vector<XLATensorPtr>* tensors, absl::Span<const std::string> devices,
+    const SyncTensorsConfig& config, bool warm_up_cache_only,
+    const std::vector<std::vector<size_t>>& device_groups) {
+  TORCH_LAZY_COUNTER("MultiDeviceSyncTensorsGraph", 1);
+  TF_VLOG(4) << "Syncing " << tensors->size() << " tensor(s) across "
+             << device_groups.size() << " devices";
+  std::vector<std::shared_ptr<Async>> device_asyncs;
+  std::vector<std::pair<size_t, torch::lazy::BackendDataPtr>> synced_data;
+  for (const std::vector<size_t>& group : device_groups) {
+    std::vector<XLATensorPtr> device_tensors;
+    device_tensors.reserve(group.size());
+    for (size_t index : group) {
+      device_tensors.push_back((*tensors)[index]);
+    }
+    // Only waits for the earlier executions on the same device.
+    std::shared_ptr<Async> device_async = SyncTensorsGraphInternal(
+        &device_tensors, devices, config, warm_up_cache_only);
+    if (device_async == nullptr) {
+      continue;
+    }
+    for (size_t i = 0; i < device_async->indices.size(); ++i) {
+      synced_data.emplace_back(group[device_async->indices[i]],
+                               device_async->tensors_data[i]);
+    }
+    device_asyncs.push_back(std::move(device_async));
+  }
+  if (device_asyncs.empty()) {
+    return nullptr;
+  }
+  std::sort(synced_data.begin(), synced_data.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs.first < rhs.first;
+            });
+  SyncTensorCollection coll;
+  coll.device = device_asyncs.front()->device;
+  std::vector<torch::lazy::BackendDataPtr> tensors_data;
+  coll.indices.reserve(synced_data.size());
+  tensors_data.reserve(synced_data.size());
+  for (auto& index_data : synced_data) {
+    coll.indices.push_back(index_data.first);
+    tensors_data.push_back(std::move(index_data.second));
+  }
+  auto async = std::make_shared<Async>(&coll, /*parameters_data=*/{},
+                                       std::move(tensors_data),
+                                       /*cached_computation=*/nullptr);
+  async->device_asyncs = std::move(device_asyncs);
+  // Nothing runs for the aggregate itself, WaitExecution() waits for the
+  // device executions.
+  async->mwait.Done();
+  return async;
+}
+
 }  // namespace torch_xla
@@ -5,10 +5,15 @@
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/lazy/core/ir_util.h>
 
+#include <condition_variable>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "absl/synchronization/blocking_counter.h"
 #include "torch_xla/csrc/cross_replica_reduces.h"
@@ -63,6 +68,31 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
   torch::lazy::Value GetDeviceDataIrValue(
       const at::Scalar& value, xla::PrimitiveType type,
       const torch::lazy::BackendDevice& device);
+
+  // Whether `tensor` is a CPU tensor small enough for GetConstantData().
+  static bool IsCachedConstant(const at::Tensor& tensor);
+
+  // Returns read only device data holding the value of `tensor`, shared by all
+  // the callers asking for the same value, type and device through an LRU
+  // cache of XLA_CONSTANT_DATA_CACHE_SIZE entries, so that the constants
+  // repeated across steps do not cost a host to device transfer each.
+  torch::lazy::BackendDataPtr GetConstantData(
+      const at::Tensor& tensor, const torch::lazy::BackendDevice& device);
+
+  // Whether the data of the XLA tensors created from host tensors are uploaded
+  // by CreateTensorsDataAsync(), with XLA_ASYNC_TENSOR_UPLOADS outside of SPMD.
+  static bool UseAsyncTensorUploads();
+
+  // Returns placeholders for the device data of `tensors`, uploaded in order
+  // on a background thread holding the locks of their devices. The tracing
+  // of the graphs using them overlaps the transfers, and their syncs wait for
+  // them at the device barrier of RunPostOrder(), as for the outputs of the
+  // previous executions. The host tensors must not be modified in place until
+  // the uploads complete.
+  std::vector<torch::lazy::BackendDataPtr> CreateTensorsDataAsync(
+      const std::vector<at::Tensor>& tensors,
+      const std::vector<std::string>& devices);
+
   torch::lazy::Value GetIrValueForScalar(
       const at::Scalar& value, xla::PrimitiveType type,
       const torch::lazy::BackendDevice& device);
@@ -88,6 +118,15 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
       c10::optional<at::ScalarType> logical_element_type,
       const torch::lazy::BackendDevice& device);
 
+  // Returns the IR value of a scalar which the lowering would rather see as a
+  // constant, like a pow exponent. The scalar is baked into the graph, unless
+  // XLA_HOIST_SCALARS is set, in which case the non special scalars are lifted
+  // into device data parameters like in GetIrValueForScalar(), so that changing
+  // their value does not trigger a compilation.
+  torch::lazy::Value GetIrValueForConstantScalar(
+      const at::Scalar& value, xla::PrimitiveType type,
+      const torch::lazy::BackendDevice& device);
+
   // Override to use our own DeviceContextArena.
   torch::lazy::Value GetRngSeed(const torch::lazy::BackendDevice& device) final;
   void SetRngSeed(const torch::lazy::BackendDevice& device,
@@ -100,6 +139,23 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
 
   bool GetAliasWithBufferDonorConfig();
 
+  // The dispatch lane of the executions scheduled by the syncs of the calling
+  // thread, runtime::ExecutionLane::kDefault unless set.
+  static void SetExecutionLane(runtime::ExecutionLane lane);
+  static runtime::ExecutionLane GetExecutionLane();
+
+  // The intra-op parallelism of the CPU executables of the graphs synced by the
+  // calling thread, which is part of their hash, or 0 for the default.
+  static void SetIntraOpThreads(int64_t threads);
+  static int64_t GetIntraOpThreads();
+
+  // The XLA compile options of the graphs synced by the calling thread, which
+  // are part of their hash, or empty for the defaults of the client.
+  static void SetCompileOptionOverrides(
+      runtime::ComputationClient::CompileOptionOverrides overrides);
+  static const runtime::ComputationClient::CompileOptionOverrides&
+  GetCompileOptionOverrides();
+
   // Dumps the XLA HLO text of the computation accumulated in the graph which is
   // attached the tensors.
   // We don't use upstream DumpBackendComputation given we have our own format.
@@ -142,6 +198,25 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
   // active devices.
   void WaitDeviceOps(absl::Span<const std::string> devices);
 
+  // Sets the tensors copied to host memory by a preemption snapshot, like the
+  // parameters and the optimizer state, or none to disable the snapshot.
+  void SetPreemptionSnapshotTensors(std::vector<XLATensorPtr> tensors);
+
+  // Called by the step marker once the graph of `step` is scheduled. If the
+  // coordinator reports `step` as the preemption sync point, waits for the
+  // step to execute and starts the transfer of the snapshot tensors to host
+  // memory in the background, returning true. Their devices stay locked until
+  // the transfer is done, so that the next step does not donate the buffers
+  // being copied. A single snapshot is taken.
+  bool MaybeSnapshotForPreemption(int64_t step);
+
+  // The step of the preemption snapshot, if one was taken.
+  std::optional<int64_t> PreemptionSnapshotStep();
+
+  // Waits for the preemption snapshot to be transferred and returns its host
+  // tensors, in the order of SetPreemptionSnapshotTensors().
+  std::vector<at::Tensor> WaitPreemptionSnapshot();
+
   // Retrieves the PyTorch CPU tensors behind the XLA tensors IR operations.
   // All the tensors must be on the same device.
   std::vector<at::Tensor> GetTensors(std::vector<XLATensorPtr>* tensors);
@@ -160,6 +235,10 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
 
     runtime::ComputationClient::ComputationPtr computation;
     bool is_sharded;
+    // The output sharding specs of a sharded computation, extracted from the
+    // compiled module by its first execution and reused by the later ones.
+    std::once_flag output_sharding_once;
+    std::vector<XLATensor::ShardingSpecPtr> output_sharding_specs;
   };
 
   using ComputationCache =
@@ -168,6 +247,9 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
   using MemoryCache =
       runtime::util::Cache<torch::lazy::hash_t, CachedComputation,
                            torch::lazy::HashReducer>;
+  using ShardedMemoryCache =
+      runtime::util::ShardedCache<torch::lazy::hash_t, CachedComputation,
+                                  torch::lazy::HashReducer>;
   using PersistentCache =
       runtime::util::PersistentCache<torch::lazy::hash_t, CachedComputation,
                                      torch::lazy::HashReducer>;
@@ -175,6 +257,83 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
   ComputationCache* GetComputationCache();
   bool IsComputationCacheInitialized();
 
+  // The executions of a cached computation by the Dynamo bridge, resolved
+  // once rather than on every call: the device, the output shapes and output
+  // shardings of the graph, and the computation itself, which is executed if
+  // it is evicted from the cache. A computation replaced in the cache, like an
+  // asynchronously optimized one, is picked up by the next execution.
+  struct CallPlan {
+    torch::lazy::hash_t hash;
+    torch::lazy::BackendDevice device;
+    std::string device_str;
+    ComputationCache::TypePtr cached_computation;
+    std::vector<xla::Shape> output_shapes;
+    // The output shardings on the SPMD virtual device, empty otherwise.
+    std::vector<XLATensor::ShardingSpecPtr> output_sharding_specs;
+  };
+
+  // Creates the plan of the cached computation of `hash` on `device`.
+  std::shared_ptr<CallPlan> CreateCallPlan(
+      torch::lazy::hash_t hash, const torch::lazy::BackendDevice& device);
+
+  // Schedules the execution of `plan` on `inputs`, returning the placeholders
+  // of its outputs.
+  std::vector<torch::lazy::BackendDataPtr> ExecuteCallPlan(
+      const CallPlan& plan, const std::vector<at::Tensor>& inputs);
+
+  // A sequence of executions of call plans, like the graphs a Dynamo model is
+  // split in around its graph breaks, recorded by running it once and then
+  // replayed as a single dispatch (see ComputationClient::ExecuteChained). An
+  // argument of a step is either an output of an earlier step, which stays on
+  // the device, or an input tensor from outside the sequence, whose current
+  // data is read by each replay. Each replay sets the data of the output
+  // tensors returned by the recorded executions. The code running between the
+  // steps, like the in place updates of the inputs by the Dynamo bridge, is
+  // not replayed.
+  class CallSequence {
+   public:
+    // Records the execution of `plan` on `inputs`, which returned `outputs`.
+    void Record(std::shared_ptr<CallPlan> plan,
+                const std::vector<at::Tensor>& inputs,
+                const std::vector<at::Tensor>& outputs);
+
+    size_t num_steps() const { return steps_.size(); }
+
+   private:
+    friend class XLAGraphExecutor;
+
+    struct Argument {
+      // The index of the input, or -1 for the output `output` of the step
+      // `step`.
+      int64_t input = -1;
+      int64_t step = -1;
+      int64_t output = -1;
+    };
+
+    struct Step {
+      std::shared_ptr<CallPlan> plan;
+      std::vector<Argument> arguments;
+      std::vector<XLATensorPtr> outputs;
+    };
+
+    std::vector<at::Tensor> inputs_;
+    std::vector<Step> steps_;
+    // The index of each input, by tensor.
+    std::unordered_map<const void*, int64_t> input_index_;
+    // The step and output of the data of each output tensor, as recorded.
+    std::unordered_map<const torch::lazy::BackendData*,
+                       std::pair<int64_t, int64_t>>
+        output_index_;
+  };
+
+  // The sequence the executions of call plans by the calling thread are
+  // recorded to, if any.
+  static void SetCallSequenceCapture(std::shared_ptr<CallSequence> sequence);
+  static std::shared_ptr<CallSequence> GetCallSequenceCapture();
+
+  // Schedules the replay of `sequence` as a single dispatch.
+  void ReplayCallSequence(const CallSequence& sequence);
+
   std::vector<torch::lazy::BackendDataPtr> ExecuteComputationWithBarrier(
       torch::lazy::hash_t hash, const std::vector<at::IValue>& graph_inputs,
       const torch::lazy::BackendDevice& device);
@@ -187,7 +346,48 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
   void ClearPendingIrs(std::vector<XLATensorPtr> tensors,
                        const torch::lazy::BackendDevice& device);
 
+  // Blocks until all the background compilations scheduled because of
+  // XLA_ASYNC_COMPILE have landed in the computation cache.
+  void WaitAsyncCompilations();
+
+  // Compiles the pending graphs of each tensor group and adds them to the
+  // computation cache, without executing them. Graphs missing from the cache
+  // are handed to the computation client in a single Compile() call, so they
+  // can be built concurrently.
+  void WarmUpCaches(std::vector<std::vector<XLATensorPtr>>* tensor_groups,
+                    absl::Span<const std::string> devices);
+
+  // Returns the number of graphs compiled for each graph structure, that is
+  // the sequence of operations of a graph regardless of the shapes and
+  // attributes of its nodes. Structures with more than one compilation are
+  // typically recompiled because of varying input shapes.
+  std::vector<std::pair<torch::lazy::hash_t, int64_t>>
+  GetGraphStructureCompiles();
+
+  // Returns the memory stats of the executable compiled by this process for
+  // each graph hash, for the graphs whose runtime reports them. A graph served
+  // by a cheaper executable while its fully optimized one compiles reports the
+  // latter once available.
+  std::vector<std::pair<torch::lazy::hash_t,
+                        runtime::ComputationClient::CompiledMemoryStats>>
+  GetCompiledMemoryStats();
+
  private:
+  // Runs the pending op of `tensor` in eager mode as a single op executable,
+  // when all its operands are device data, returning whether it did. The
+  // executables are cached by the hash of the node, which covers its op, scalar
+  // attributes and the shapes of its operands, so that a hit skips the
+  // collection, lowering and compilation of the graph.
+  bool TryRunEagerOp(const XLATensorPtr& tensor);
+
+  // The fully optimized compilation of a graph which has been temporarily
+  // served by a cheaper to compile executable.
+  struct AsyncCompileRequest {
+    runtime::ComputationClient::CompileInstance instance;
+    // Owned here since instance.output_shape only points to it.
+    xla::Shape output_shape;
+  };
+
   // This is just to group results from compile(). Since our computation is
   // different, we don't reuse the upstream CompilationResult.
   struct CompilationResult {
@@ -196,6 +396,27 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
     runtime::ComputationClient::ComputationPtr computation;
     std::vector<torch::lazy::BackendDataPtr> parameters_data;
     bool is_sharded = false;
+    // Set when `computation` is a fallback and the optimized executable still
+    // needs to be compiled in background.
+    std::shared_ptr<AsyncCompileRequest> async_compile_request;
+  };
+
+  // A lowered graph which is ready to be handed to the computation client.
+  struct PreparedCompilation {
+    runtime::ComputationClient::CompileInstance instance;
+    // Owned here since instance.output_shape only points to it.
+    xla::Shape output_shape;
+    xla::ProgramShape program_shape;
+    size_t emitted_nodes = 0;
+    bool should_wrap_parameter = false;
+    bool is_sharded = false;
+    // The trailing parameters supplied by the computation client with the
+    // outputs of the previous execution, not passed as arguments.
+    size_t recycled_output_parameters = 0;
+    std::shared_ptr<AsyncCompileRequest> async_compile_request;
+    // The auto-sharding meshes to compile the graph with, the cheapest
+    // executable wins. The instance is set up for the first one.
+    std::vector<std::vector<int64_t>> auto_spmd_mesh_candidates;
   };
 
   struct Async : public torch::lazy::LazyGraphExecutor::Async {
@@ -204,7 +425,14 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
           std::vector<torch::lazy::BackendDataPtr> tensors_data,
           ComputationCache::TypePtr cached_computation);
 
+    // Waits for the execution, or for the execution on each device of a sync
+    // spanning several devices.
+    void WaitExecution();
+
     ComputationCache::TypePtr cached_computation;
+    // The executions of a sync spanning several devices, whose outputs the
+    // tensors_data of this Async gathers.
+    std::vector<std::shared_ptr<Async>> device_asyncs;
   };
 
   class DeviceContextArena
@@ -247,7 +475,15 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
     // signle threaded.
     std::vector<xla::Shape>* GetOutputShapesByHash(torch::lazy::hash_t hash);
 
+    torch::lazy::BackendDataPtr GetConstantData(
+        const at::Tensor& tensor, const torch::lazy::BackendDevice& device);
+
    private:
+    using ConstantDataCache =
+        runtime::util::Cache<std::string, torch::lazy::BackendData>;
+
+    DeviceContextArena();
+
     // Below two maps are used for dynamo integration.
     std::unordered_map<torch::lazy::hash_t, std::string,
                        torch::lazy::HashReducer>
@@ -260,6 +496,8 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
         const at::Scalar& value, at::ScalarType scalar_type,
         const torch::lazy::BackendDevice& device) final;
     bool should_alias_with_buffer_donor = false;
+    // Keyed by the device, type, shape and bytes of the constants.
+    std::unique_ptr<ConstantDataCache> constant_data_cache;
   };
 
   XLAGraphExecutor() = default;
@@ -331,6 +569,21 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
   ComputationCache::TypePtr LookupCachedCompile(
       const torch::lazy::hash_t& hash);
 
+  // Waits for the process owning the graph hash to compile it into the shared
+  // persistent cache, and loads the result. Returns nullptr on timeout.
+  ComputationCache::TypePtr WaitForSharedCompilation(
+      const torch::lazy::hash_t& hash);
+
+  // Lets the processes waiting on the graph hash load it from the shared
+  // persistent cache, if this process owns the hash.
+  void PublishSharedCompilation(const torch::lazy::hash_t& hash);
+
+  // Records the memory stats of the executable compiled for the graph hash,
+  // replacing the ones of an earlier executable.
+  void RecordCompiledMemoryStats(
+      const torch::lazy::hash_t& hash,
+      const runtime::ComputationClient::Computation& computation);
+
   // We don't use the upstream TryRunCachedSync since
   // our CachedComputation is different from upstream.
   std::pair<bool, std::shared_ptr<Async>> TryRunCachedSync(
@@ -346,13 +599,63 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
   std::vector<size_t> SetBufferDonorsFromUserConfig(
       LoweringContext* lowering_ctx);
 
+  // Folds the parameter sequence and the compilation configs into the IR graph
+  // hash.
+  torch::lazy::hash_t CombineGraphHash(torch::lazy::hash_t hash,
+                                       const PostOrderData& po_data);
+
+  // Lowers the graph and builds the compile instance for it.
+  std::unique_ptr<PreparedCompilation> PrepareCompilation(
+      std::vector<XLATensorPtr>& tensors, absl::Span<const std::string> devices,
+      const SyncTensorCollection& coll, PostOrderData* po_data,
+      const std::vector<torch::lazy::Value>& ir_values,
+      bool allow_async_compile,
+      absl::Span<const torch::lazy::Output> materialized_outputs = {});
+
+  // Compiles the prepared graphs in one batch, along with the alternative
+  // auto-sharding meshes of each. Returns the selected computation of every
+  // graph.
+  std::vector<runtime::ComputationClient::ComputationPtr> CompilePrepared(
+      absl::Span<const torch::lazy::hash_t> hashes,
+      absl::Span<PreparedCompilation* const> prepared);
+
+  // The auto-sharding mesh selected for the graph hash by an earlier
+  // exploration, empty if none.
+  std::vector<int64_t> LookupAutoShardingMesh(const torch::lazy::hash_t& hash);
+
+  // The live executable compiled from the HLO of `fingerprint`, see
+  // CompiledHloFingerprint(), nullptr if none.
+  runtime::ComputationClient::ComputationPtr LookupHloExecutable(
+      const torch::lazy::hash_t& fingerprint);
+
+  CompilationResult FinishCompilation(
+      std::vector<XLATensorPtr>& tensors, const SyncTensorCollection& coll,
+      PostOrderData* po_data, PreparedCompilation* prepared,
+      runtime::ComputationClient::ComputationPtr computation);
+
   // TODO(yeounoh) auto-sharding can change tensors shardings, which needs to be
   // accounted for in Dynamo integration.
-  CompilationResult Compile(std::vector<XLATensorPtr>& tensors,
-                            absl::Span<const std::string> devices,
-                            const SyncTensorCollection& coll,
-                            PostOrderData* po_data,
-                            const std::vector<torch::lazy::Value>& ir_values);
+  // The `materialized_outputs` of a split graph, computed by its first part,
+  // are the leading parameters of `po_data`.
+  CompilationResult Compile(
+      std::vector<XLATensorPtr>& tensors, absl::Span<const std::string> devices,
+      const SyncTensorCollection& coll, PostOrderData* po_data,
+      const std::vector<torch::lazy::Value>& ir_values,
+      absl::Span<const torch::lazy::Output> materialized_outputs = {});
+
+  // Compiles the request on the background pool and replaces the fallback
+  // computation cached under `hash` once done. With
+  // XLA_ASYNC_COMPILE_HOT_EXECUTIONS, the compilation is held back until the
+  // fallback has run that many times, see CountFallbackExecution().
+  void ScheduleAsyncCompile(torch::lazy::hash_t hash,
+                            std::shared_ptr<AsyncCompileRequest> request);
+
+  void LaunchAsyncCompile(torch::lazy::hash_t hash,
+                          std::shared_ptr<AsyncCompileRequest> request);
+
+  // Counts an execution of the cached computation of `hash`, launching its
+  // held back optimized compilation once the graph is hot.
+  void CountFallbackExecution(const torch::lazy::hash_t& hash);
 
   // We don't use the upstream SyncTensorsGraphInternal since
   // our CachedComputation is different from upstream.
@@ -360,7 +663,74 @@ class XLAGraphExecutor : public torch::lazy::LazyGraphExecutor {
       std::vector<XLATensorPtr>* tensors, absl::Span<const std::string> devices,
       const SyncTensorsConfig& config, bool warm_up_cache_only = false);
 
+  // The cut of the graph hash, in computed nodes, when its executable was
+  // found too large for the device memory.
+  std::optional<size_t> LookupGraphSplitCut(const torch::lazy::hash_t& hash);
+
+  // Runs the first `cut` computed nodes of the graph as a graph of their own,
+  // materializing the outputs used by the rest of the graph or by the roots,
+  // and replaces `po_data` by the rest of the graph, taking them as its
+  // leading parameters. Returns the materialized outputs.
+  std::vector<torch::lazy::Output> SplitGraph(
+      absl::Span<const std::string> devices, SyncTensorCollection* coll,
+      PostOrderData* po_data, const std::vector<torch::lazy::Value>& ir_values,
+      size_t cut);
+
+  // Syncs tensors spread across several devices, one graph per device. The
+  // graphs are all dispatched before any is waited for, so that the devices
+  // execute in parallel, and the returned Async covers all of them.
+  std::shared_ptr<Async> SyncMultiDeviceTensorsGraph(
+      std::vector<XLATensorPtr>* tensors, absl::Span<const std::string> devices,
+      const SyncTensorsConfig& config, bool warm_up_cache_only,
+      const std::vector<std::vector<size_t>>& device_groups);
+
   ComputationCache* computation_cache_;
+
+  std::mutex async_compile_mutex_;
+  std::condition_variable async_compile_cv_;
+  std::unordered_set<torch::lazy::hash_t, torch::lazy::HashReducer>
+      pending_async_compiles_;
+  // The held back optimized compilations and the executions of their
+  // fallbacks so far, by graph hash.
+  struct DeferredAsyncCompile {
+    std::shared_ptr<AsyncCompileRequest> request;
+    int64_t executions = 0;
+  };
+  std::unordered_map<torch::lazy::hash_t, DeferredAsyncCompile,
+                     torch::lazy::HashReducer>
+      deferred_async_compiles_;
+
+  std::mutex graph_structure_mutex_;
+  std::unordered_map<torch::lazy::hash_t, int64_t, torch::lazy::HashReducer>
+      graph_structure_compiles_;
+
+  std::mutex compiled_memory_stats_mutex_;
+  std::unordered_map<torch::lazy::hash_t,
+                     runtime::ComputationClient::CompiledMemoryStats,
+                     torch::lazy::HashReducer>
+      compiled_memory_stats_;
+
+  std::mutex graph_split_mutex_;
+  std::unordered_map<torch::lazy::hash_t, size_t, torch::lazy::HashReducer>
+      graph_split_cuts_;
+
+  std::mutex auto_sharding_mesh_mutex_;
+  std::unordered_map<torch::lazy::hash_t, std::vector<int64_t>,
+                     torch::lazy::HashReducer>
+      auto_sharding_meshes_;
+
+  // The executables by HLO fingerprint, held by the computation cache entries
+  // of the graphs lowered to them.
+  std::mutex hlo_executables_mutex_;
+  std::unordered_map<torch::lazy::hash_t,
+                     std::weak_ptr<runtime::ComputationClient::Computation>,
+                     torch::lazy::HashReducer>
+      hlo_executables_;
+
+  std::mutex preemption_snapshot_mutex_;
+  std::vector<XLATensorPtr> preemption_snapshot_tensors_;
+  std::optional<int64_t> preemption_snapshot_step_;
+  std::shared_future<std::vector<at::Tensor>> preemption_snapshot_;
 };
 
 }  // namespace torch_xla
@@ -1,9 +1,15 @@
 #include "torch_xla/csrc/xla_lower_util.h"
 
 #include <torch/csrc/lazy/core/helpers.h>
+#include <torch/csrc/lazy/core/metrics.h>
 #include <torch/csrc/lazy/core/util.h>
 
 #include <algorithm>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <tuple>
 #include <vector>
 
 #include "torch_xla/csrc/convert_ops.h"
@@ -14,9 +20,12 @@
 #include "torch_xla/csrc/random.h"
 #include "torch_xla/csrc/reduction.h"
 #include "torch_xla/csrc/runtime/debug_macros.h"
+#include "torch_xla/csrc/runtime/sys_util.h"
 #include "torch_xla/csrc/runtime/util.h"
 #include "torch_xla/csrc/shape_helper.h"
+#include "torch_xla/csrc/softmax_builder.h"
 #include "torch_xla/csrc/tensor_util.h"
+#include "xla/client/lib/approx_topk.h"
 #include "xla/client/lib/arithmetic.h"
 #include "xla/client/lib/comparators.h"
 #include "xla/client/lib/constants.h"
@@ -155,6 +164,7 @@ xla::XlaOp CreateIndexAlongDim(
     bool broadcast_value_to_index,
     const std::function<xla::XlaOp(xla::XlaOp, xla::XlaOp)>& combiner) {
   const xla::Shape& buffer_shape = ShapeHelper::ShapeOfXlaOp(buffer);
+  index = XlaHelpers::NarrowIndices(index, buffer_shape.dimensions(dim));
   xla::ScatterDimensionNumbers dim_numbers;
   dim_numbers.set_index_vector_dim(1);
   for (int64_t window_dim = 0; window_dim < buffer_shape.rank(); ++window_dim) {
@@ -297,6 +307,188 @@ std::vector<xla::XlaOp> BuildConditionIndices(xla::XlaOp condition) {
   return {result_padded, cmd.length};
 }
 
+// The row of the compacted result of every element of the R1 PRED
+// `condition`: the number of true elements before it if it is true, and `size`
+// otherwise. The scatter of the false elements and of the true ones past the
+// first `size` is out of bounds, and dropped.
+xla::XlaOp GetCompactionRows(xla::XlaOp condition, int64_t size) {
+  xla::XlaBuilder* builder = condition.builder();
+  xla::PrimitiveType type = xla::PrimitiveType::S64;
+  xla::XlaOp counts = BuildCumulativeComputation(
+      xla::ConvertElementType(condition, type), 0,
+      XlaHelpers::CreateAddComputation(type), xla::Zero(builder, type));
+  xla::XlaOp size_value = XlaHelpers::ScalarValue<int64_t>(size, type, builder);
+  return xla::Select(
+      condition, counts - xla::One(builder, type),
+      xla::Broadcast(size_value,
+                     ShapeHelper::ShapeOfXlaOp(condition).dimensions()));
+}
+
+// The S64 number of true elements of the R1 PRED `condition`.
+xla::XlaOp CountTrue(xla::XlaOp condition) {
+  xla::XlaBuilder* builder = condition.builder();
+  xla::PrimitiveType type = xla::PrimitiveType::S64;
+  return xla::ReduceAll(xla::ConvertElementType(condition, type),
+                        xla::Zero(builder, type),
+                        XlaHelpers::CreateAddComputation(type));
+}
+
+// The largest of the `num_index_dims` dimensions of `shape` from `start_dim`,
+// which bounds the indices into them.
+int64_t MaxIndexedDimSize(const xla::Shape& shape, int64_t start_dim,
+                          int64_t num_index_dims) {
+  int64_t max_size = 0;
+  for (int64_t i = start_dim; i < start_dim + num_index_dims; ++i) {
+    max_size = std::max(max_size, shape.dimensions(i));
+  }
+  return max_size;
+}
+
+enum class ScatterIndicesMode {
+  kUnsorted,
+  kSorted,
+  kSegmentReduce,
+};
+
+// How the scatter lowerings order their indices, from XLA_SCATTER_INDICES_MODE.
+ScatterIndicesMode GetScatterIndicesMode() {
+  static const ScatterIndicesMode mode = []() {
+    std::string mode_name = runtime::sys_util::GetEnvString(
+        "XLA_SCATTER_INDICES_MODE", "unsorted");
+    if (mode_name == "sorted") {
+      return ScatterIndicesMode::kSorted;
+    }
+    if (mode_name == "segment_reduce") {
+      return ScatterIndicesMode::kSegmentReduce;
+    }
+    XLA_CHECK_EQ(mode_name, "unsorted")
+        << "Invalid XLA_SCATTER_INDICES_MODE: " << mode_name;
+    return ScatterIndicesMode::kUnsorted;
+  }();
+  return mode;
+}
+
+struct ScatterUpdates {
+  // The [K, d] indices, with the index vector in dimension 1.
+  xla::XlaOp indices;
+  xla::XlaOp updates;
+  bool indices_are_sorted = false;
+  bool unique_indices = false;
+};
+
+// Shifts `input` by `shift` positions towards the higher indices of `dim`,
+// filling the first ones with `fill_value`.
+xla::XlaOp ShiftInDim(xla::XlaOp input, int64_t dim, int64_t shift,
+                      xla::XlaOp fill_value) {
+  int64_t size = ShapeHelper::ShapeOfXlaOp(input).dimensions(dim);
+  return xla::SliceInDim(xla::PadInDim(input, fill_value, dim, shift, 0), 0,
+                         size, 1, dim);
+}
+
+// Combines with `combiner` every update with the ones preceding it in its run
+// of equal indices, whose first updates are the true `run_starts`, with a
+// log-step scan along `dim`. The last update of every run then holds the
+// combination of the whole run.
+xla::XlaOp ScanIndexRuns(xla::XlaOp updates, int64_t dim, xla::XlaOp run_starts,
+                         const XlaOpCombiner& combiner) {
+  xla::XlaBuilder* builder = updates.builder();
+  const xla::Shape& updates_shape = ShapeHelper::ShapeOfXlaOp(updates);
+  int64_t num_updates = updates_shape.dimensions(dim);
+  xla::XlaOp zero = xla::Zero(builder, updates_shape.element_type());
+  xla::XlaOp true_value = xla::ConstantR0<bool>(builder, true);
+  // Before the step of a shift, the run start flag of an update tells whether
+  // a run starts within the `shift` updates ending with it, and thus whether
+  // its partial combination is complete.
+  for (int64_t shift = 1; shift < num_updates; shift *= 2) {
+    xla::XlaOp complete = xla::BroadcastInDim(
+        run_starts, updates_shape.dimensions(), {dim});
+    updates = xla::Select(
+        complete, updates,
+        combiner(ShiftInDim(updates, dim, shift, zero), updates));
+    run_starts =
+        xla::Or(run_starts, ShiftInDim(run_starts, 0, shift, true_value));
+  }
+  return updates;
+}
+
+// Sorts the rows of the [K, d] `indices` together with the K `updates` along
+// `updates_dim`. The sort is stable so that the updates of an index keep their
+// program order. In kSegmentReduce mode, the updates of every index are then
+// combined with `combiner`, or the last one kept if null, into the last of
+// them, and the other ones are moved out of the `index_dim_size` bounds of the
+// first index, so that every index in bounds is updated once.
+ScatterUpdates OrderScatterUpdates(xla::XlaOp indices, xla::XlaOp updates,
+                                   int64_t updates_dim,
+                                   const XlaOpCombiner& combiner,
+                                   int64_t index_dim_size,
+                                   ScatterIndicesMode mode) {
+  xla::XlaBuilder* builder = indices.builder();
+  const xla::Shape& indices_shape = ShapeHelper::ShapeOfXlaOp(indices);
+  int64_t num_updates = indices_shape.dimensions(0);
+  int64_t num_index_dims = indices_shape.dimensions(1);
+  xla::PrimitiveType index_type = indices_shape.element_type();
+  if (num_updates == 0) {
+    return {indices, updates};
+  }
+
+  std::vector<xla::XlaOp> to_sort;
+  std::vector<xla::PrimitiveType> types_to_sort;
+  std::vector<absl::optional<xla::XlaOpGenerator>> generators;
+  for (int64_t i = 0; i < num_index_dims; ++i) {
+    to_sort.push_back(
+        xla::Reshape(xla::SliceInDim(indices, i, i + 1, 1, 1), {num_updates}));
+    types_to_sort.push_back(index_type);
+    generators.push_back(xla::Lt);
+  }
+  to_sort.push_back(xla::Iota(builder, xla::PrimitiveType::S32, num_updates));
+  types_to_sort.push_back(xla::PrimitiveType::S32);
+  generators.push_back(absl::nullopt);
+  xla::XlaOp sorted = xla::Sort(
+      to_sort,
+      xla::CreateScalarComparisonComputation("IndicesLt", types_to_sort,
+                                             generators, builder),
+      /*dimension=*/0, /*is_stable=*/true);
+  std::vector<xla::XlaOp> columns;
+  for (int64_t i = 0; i < num_index_dims; ++i) {
+    columns.push_back(xla::GetTupleElement(sorted, i));
+  }
+  updates = xla::TorchIndexSelect(
+      updates, xla::GetTupleElement(sorted, num_index_dims), updates_dim);
+  if (mode == ScatterIndicesMode::kSorted) {
+    for (auto& column : columns) {
+      column = xla::Reshape(column, {num_updates, 1});
+    }
+    return {xla::ConcatInDim(builder, columns, 1), updates,
+            /*indices_are_sorted=*/true};
+  }
+
+  xla::XlaOp false_value = xla::ConstantR0<bool>(builder, false);
+  xla::XlaOp iota = xla::Iota(builder, index_type, num_updates);
+  xla::XlaOp run_starts = xla::Eq(iota, xla::Zero(builder, index_type));
+  for (xla::XlaOp column : columns) {
+    run_starts = xla::Or(
+        run_starts,
+        xla::Ne(column,
+                ShiftInDim(column, 0, 1, xla::Zero(builder, index_type))));
+  }
+  xla::XlaOp run_ends = xla::SliceInDim(
+      xla::PadInDim(run_starts, xla::ConstantR0<bool>(builder, true), 0, 0, 1),
+      1, num_updates + 1, 1, 0);
+  if (combiner != nullptr) {
+    updates = ScanIndexRuns(updates, updates_dim, run_starts, combiner);
+  }
+  // Distinct out of bounds indices keep the indices unique.
+  columns[0] = xla::Select(
+      run_ends, columns[0],
+      iota + XlaHelpers::ScalarValue<int64_t>(index_dim_size, index_type,
+                                              builder));
+  for (auto& column : columns) {
+    column = xla::Reshape(column, {num_updates, 1});
+  }
+  return {xla::ConcatInDim(builder, columns, 1), updates,
+          /*indices_are_sorted=*/false, /*unique_indices=*/true};
+}
+
 }  // namespace
 
 xla::XlaOp PadToSize(xla::XlaOp input, absl::Span<const int64_t> size,
@@ -389,6 +581,83 @@ std::vector<xla::XlaOp> CreateTopK(xla::XlaOp input, int64_t k, int64_t dim,
                                                xla::PrimitiveType::S64))};
 }
 
+std::vector<xla::XlaOp> CreateApproxTopK(xla::XlaOp input, int64_t k,
+                                         int64_t dim, bool largest,
+                                         float recall_target) {
+  // The chunks are large enough for the top-k of all of them to be a small
+  // fraction of the dimension.
+  static const int64_t kMinChunkSize = 1024;
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
+  XLA_CHECK_LE(k, shape.dimensions(dim));
+  xla::XlaBuilder* builder = input.builder();
+  xla::PrimitiveType type = shape.element_type();
+  xla::XlaComputation comparator =
+      largest ? xla::CreateScalarGtComputation(
+                    {type, xla::PrimitiveType::S32}, builder)
+              : xla::CreateScalarLtComputation(
+                    {type, xla::PrimitiveType::S32}, builder);
+  xla::XlaOp init_value =
+      largest ? xla::MinValue(builder, type) : xla::MaxValue(builder, type);
+  xla::PrimitiveType index_type =
+      GetXlaPrimitiveTypeForCurrentDevice(xla::PrimitiveType::S64);
+  if (recall_target < 1.0) {
+    xla::XlaOp iota = xla::Iota(
+        builder,
+        xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32, shape.dimensions()),
+        dim);
+    xla::XlaOp result = xla::ApproxTopK(
+        builder, {input, iota},
+        {init_value, xla::ConstantR0<int32_t>(builder, -1)}, k, dim,
+        comparator, recall_target, /*aggregate_to_topk=*/true);
+    return {xla::GetTupleElement(result, 0),
+            xla::ConvertElementType(xla::GetTupleElement(result, 1),
+                                    index_type)};
+  }
+  int64_t size = shape.dimensions(dim);
+  int64_t chunk_size = std::max<int64_t>(kMinChunkSize, 16 * k);
+  if (size < 4 * chunk_size) {
+    return CreateTopK(input, k, dim, largest, /*stable=*/true);
+  }
+  // Sorts `values` and `indices` along `sort_dim` and slices the first k.
+  auto sorted_top_k = [&](xla::XlaOp values, xla::XlaOp indices,
+                          int64_t sort_dim) -> std::vector<xla::XlaOp> {
+    xla::XlaOp sorted = xla::Sort({values, indices}, comparator, sort_dim,
+                                  /*is_stable=*/true);
+    return {xla::SliceInDim(xla::GetTupleElement(sorted, 0), 0, k, 1,
+                            sort_dim),
+            xla::SliceInDim(xla::GetTupleElement(sorted, 1), 0, k, 1,
+                            sort_dim)};
+  };
+  int64_t num_chunks = xla::CeilOfRatio(size, chunk_size);
+  std::vector<int64_t> padded_sizes(shape.dimensions().begin(),
+                                    shape.dimensions().end());
+  padded_sizes[dim] = num_chunks * chunk_size;
+  std::vector<int64_t> chunked_sizes = padded_sizes;
+  chunked_sizes[dim] = num_chunks;
+  chunked_sizes.insert(chunked_sizes.begin() + dim + 1, chunk_size);
+  // The padding sorts last, and on ties after the inputs, as its indices are
+  // the larger ones.
+  xla::XlaOp values = xla::Reshape(
+      xla::PadInDim(input, init_value, dim, 0, padded_sizes[dim] - size),
+      chunked_sizes);
+  xla::XlaOp indices = xla::Reshape(
+      xla::Iota(builder,
+                xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32,
+                                          padded_sizes),
+                dim),
+      chunked_sizes);
+  std::vector<xla::XlaOp> chunk_top_k =
+      sorted_top_k(values, indices, dim + 1);
+  // The candidates are ordered by chunk, and within a chunk the equal values
+  // by index, so that the stable sort keeps the lower indices first.
+  std::vector<int64_t> candidate_sizes = padded_sizes;
+  candidate_sizes[dim] = num_chunks * k;
+  std::vector<xla::XlaOp> top_k =
+      sorted_top_k(xla::Reshape(chunk_top_k[0], candidate_sizes),
+                   xla::Reshape(chunk_top_k[1], candidate_sizes), dim);
+  return {top_k[0], xla::ConvertElementType(top_k[1], index_type)};
+}
+
 xla::XlaOp CreateMatMul(xla::XlaOp lhs, xla::XlaOp rhs) {
   // Expand cases in https://pytorch.org/docs/stable/torch.html#torch.matmul
   xla::Shape lhs_shape = ShapeHelper::ShapeOfXlaOp(lhs);
@@ -532,6 +801,121 @@ std::vector<xla::XlaOp> BuildNativeDropout(xla::XlaOp input, xla::XlaOp seed,
   }
 }
 
+namespace {
+
+// The dropout keep mask of `shape` drawn from `seed`, scaled by the inverse of
+// the keep probability, as BuildNativeDropout() draws it.
+xla::XlaOp BuildScaledDropoutMask(const xla::Shape& shape, xla::XlaOp seed,
+                                  float probability) {
+  xla::XlaBuilder* builder = seed.builder();
+  if (probability <= 0.0f) {
+    return xla::Broadcast(xla::One(builder, shape.element_type()),
+                          shape.dimensions());
+  }
+  xla::XlaOp prob =
+      XlaHelpers::ScalarBroadcast<float>(1 - probability, shape, builder);
+  return BuildBernoulli(prob, seed, shape.element_type()) / prob;
+}
+
+// Broadcasts the [features] `features` values along the rows of `dims`.
+xla::XlaOp BroadcastFeatures(xla::XlaOp features,
+                             absl::Span<const int64_t> dims) {
+  return xla::BroadcastInDim(
+      xla::ConvertElementType(features, xla::PrimitiveType::F32), dims,
+      {static_cast<int64_t>(dims.size()) - 1});
+}
+
+// The F32 mean of the rows of the F32 `input`.
+xla::XlaOp ReduceRowsMean(xla::XlaOp input) {
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
+  int64_t rank = shape.rank();
+  xla::XlaOp sum = xla::Reduce(
+      input, xla::Zero(input.builder(), xla::PrimitiveType::F32),
+      XlaHelpers::CreateAddComputation(xla::PrimitiveType::F32), {rank - 1});
+  return sum / XlaHelpers::ScalarValue<float>(
+                   shape.dimensions(rank - 1), xla::PrimitiveType::F32,
+                   input.builder());
+}
+
+}  // namespace
+
+std::vector<xla::XlaOp> BuildDropoutAddLayerNorm(
+    xla::XlaOp input, xla::XlaOp residual, xla::XlaOp weight, xla::XlaOp bias,
+    xla::XlaOp seed, float probability, double eps, bool return_mask) {
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
+  absl::Span<const int64_t> dims = shape.dimensions();
+  xla::XlaOp mask = BuildScaledDropoutMask(shape, seed, probability);
+  xla::XlaOp sum = input * mask + residual;
+  xla::XlaOp centered = xla::ConvertElementType(sum, xla::PrimitiveType::F32);
+  xla::XlaOp mean;
+  xla::XlaOp variance;
+  if (UseWelfordVariance()) {
+    std::tie(variance, mean) =
+        BuildVarMean(centered, {shape.rank() - 1}, /*correction=*/0,
+                     /*keep_reduced_dimensions=*/false);
+    centered = centered - BroadcastAttentionRows(mean, dims);
+  } else {
+    mean = ReduceRowsMean(centered);
+    centered = centered - BroadcastAttentionRows(mean, dims);
+    variance = ReduceRowsMean(centered * centered);
+  }
+  xla::XlaOp rstd =
+      xla::Rsqrt(variance + XlaHelpers::ScalarValue<double>(
+                                eps, xla::PrimitiveType::F32, input.builder()));
+  xla::XlaOp normalized = centered * BroadcastAttentionRows(rstd, dims);
+  xla::XlaOp output = xla::ConvertElementType(
+      normalized * BroadcastFeatures(weight, dims) +
+          BroadcastFeatures(bias, dims),
+      shape.element_type());
+  std::vector<xla::XlaOp> results = {output, sum, mean, rstd};
+  if (return_mask) {
+    results.push_back(mask);
+  }
+  return results;
+}
+
+std::vector<xla::XlaOp> BuildDropoutAddLayerNormBackward(
+    xla::XlaOp grad_output, xla::XlaOp grad_sum, xla::XlaOp sum,
+    xla::XlaOp weight, xla::XlaOp mean, xla::XlaOp rstd, xla::XlaOp seed,
+    const absl::optional<xla::XlaOp>& mask, float probability) {
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(sum);
+  absl::Span<const int64_t> dims = shape.dimensions();
+  xla::PrimitiveType weight_type =
+      ShapeHelper::ShapeOfXlaOp(weight).element_type();
+  xla::XlaOp grad =
+      xla::ConvertElementType(grad_output, xla::PrimitiveType::F32);
+  xla::XlaOp rstd_rows = BroadcastAttentionRows(rstd, dims);
+  xla::XlaOp normalized =
+      (xla::ConvertElementType(sum, xla::PrimitiveType::F32) -
+       BroadcastAttentionRows(mean, dims)) *
+      rstd_rows;
+  xla::XlaOp grad_normalized = grad * BroadcastFeatures(weight, dims);
+  xla::XlaOp grad_mean =
+      BroadcastAttentionRows(ReduceRowsMean(grad_normalized), dims);
+  xla::XlaOp grad_projection = BroadcastAttentionRows(
+      ReduceRowsMean(grad_normalized * normalized), dims);
+  xla::XlaOp grad_sum_total =
+      rstd_rows *
+          (grad_normalized - grad_mean - normalized * grad_projection) +
+      xla::ConvertElementType(grad_sum, xla::PrimitiveType::F32);
+  xla::XlaOp grad_residual =
+      xla::ConvertElementType(grad_sum_total, shape.element_type());
+  xla::XlaOp grad_input =
+      grad_residual * (mask ? *mask
+                            : BuildScaledDropoutMask(shape, seed, probability));
+  std::vector<int64_t> row_dims(shape.rank() - 1);
+  std::iota(row_dims.begin(), row_dims.end(), 0);
+  xla::XlaOp zero = xla::Zero(sum.builder(), xla::PrimitiveType::F32);
+  xla::XlaComputation add =
+      XlaHelpers::CreateAddComputation(xla::PrimitiveType::F32);
+  xla::XlaOp grad_weight = xla::ConvertElementType(
+      xla::Reduce(grad * normalized, zero, add, row_dims), weight_type);
+  xla::XlaOp grad_bias =
+      xla::ConvertElementType(xla::Reduce(grad, zero, add, row_dims),
+                              weight_type);
+  return {grad_input, grad_residual, grad_weight, grad_bias};
+}
+
 std::vector<xla::XlaOp> CreateBroadcastTensors(
     absl::Span<const xla::XlaOp> operands) {
   xla::Shape result_shape = ShapeHelper::ShapeOfXlaOp(operands.front());
@@ -555,6 +939,8 @@ xla::XlaOp CreateIndex(xla::XlaOp input, xla::XlaOp indices,
   const xla::Shape& indices_shape = ShapeHelper::ShapeOfXlaOp(indices);
   XLA_CHECK_GE(indices_shape.rank(), 1);
   int64_t num_index_dims = indices_shape.dimensions(indices_shape.rank() - 1);
+  indices = XlaHelpers::NarrowIndices(
+      indices, MaxIndexedDimSize(input_shape, start_dim, num_index_dims));
   xla::GatherDimensionNumbers dim_numbers;
   std::vector<int64_t> slice_sizes;
   slice_sizes.reserve(input_shape.rank());
@@ -592,6 +978,8 @@ xla::XlaOp CreateIndexUpdate(
   // The minor dimension of indices contains the indices to update.
   int64_t num_index_dims = indices_dims.back();
   indices_dims.remove_suffix(1);
+  indices = XlaHelpers::NarrowIndices(
+      indices, MaxIndexedDimSize(buffer_shape, start_dim, num_index_dims));
   xla::ScatterDimensionNumbers dim_numbers;
   dim_numbers.set_index_vector_dim(indices_shape.rank() - 1);
 
@@ -618,6 +1006,35 @@ xla::XlaOp CreateIndexUpdate(
   const xla::Shape& new_values_shape = ShapeHelper::ShapeOfXlaOp(new_values);
   values_rank = new_values_shape.rank();
 
+  xla::XlaOp scatter_indices = indices;
+  bool indices_are_sorted = false;
+  bool unique_indices = false;
+  ScatterIndicesMode mode = GetScatterIndicesMode();
+  if (mode != ScatterIndicesMode::kUnsorted && indices_shape.is_static()) {
+    // Flatten the index dimensions of the indices and of the values into one,
+    // along which they are ordered.
+    int64_t num_updates =
+        xla::ShapeUtil::ElementsIn(indices_shape) / num_index_dims;
+    std::vector<int64_t> flat_values_dims(
+        buffer_shape.dimensions().begin(),
+        buffer_shape.dimensions().begin() + start_dim);
+    flat_values_dims.push_back(num_updates);
+    flat_values_dims.insert(
+        flat_values_dims.end(),
+        buffer_shape.dimensions().begin() + start_dim + num_index_dims,
+        buffer_shape.dimensions().end());
+    ScatterUpdates ordered = OrderScatterUpdates(
+        xla::Reshape(indices, {num_updates, num_index_dims}),
+        xla::Reshape(new_values, flat_values_dims), start_dim, combiner,
+        buffer_shape.dimensions(start_dim), mode);
+    scatter_indices = ordered.indices;
+    new_values = ordered.updates;
+    indices_are_sorted = ordered.indices_are_sorted;
+    unique_indices = ordered.unique_indices;
+    values_rank = flat_values_dims.size();
+    dim_numbers.set_index_vector_dim(1);
+  }
+
   for (int64_t dim = 0; dim < start_dim; ++dim) {
     dim_numbers.add_update_window_dims(dim);
   }
@@ -631,8 +1048,8 @@ xla::XlaOp CreateIndexUpdate(
   }
   xla::XlaComputation combiner_computation =
       MakeScatterComputation(combiner, buffer_shape.element_type());
-  return xla::Scatter(buffer, indices, new_values, combiner_computation,
-                      dim_numbers);
+  return xla::Scatter(buffer, scatter_indices, new_values, combiner_computation,
+                      dim_numbers, indices_are_sorted, unique_indices);
 }
 
 xla::XlaOp CreateIndexAdd(xla::XlaOp buffer, int64_t dim, xla::XlaOp index,
@@ -698,6 +1115,39 @@ XlaOpCombiner NumericMaxCombiner() {
   };
 }
 
+xla::XlaOp BuildBagSegmentIds(xla::XlaOp offsets, int64_t num_indices) {
+  xla::XlaBuilder* builder = offsets.builder();
+  const xla::Shape& offsets_shape = ShapeHelper::ShapeOfXlaOp(offsets);
+  int64_t num_offsets = offsets_shape.dimensions(0);
+  xla::PrimitiveType type = offsets_shape.element_type();
+  xla::XlaOp bag_starts =
+      xla::Zeros(builder, xla::ShapeUtil::MakeShape(type, {num_indices}));
+  if (num_offsets > 1) {
+    xla::XlaOp starts = xla::Reshape(
+        xla::SliceInDim(offsets, 1, num_offsets, 1, 0), {num_offsets - 1, 1});
+    bag_starts = CreateIndexUpdate(bag_starts, starts, /*start_dim=*/0,
+                                   xla::One(builder, type),
+                                   NumericAddCombiner());
+  }
+  return BuildCumulativeComputation(bag_starts, 0,
+                                    XlaHelpers::CreateAddComputation(type),
+                                    xla::Zero(builder, type));
+}
+
+xla::XlaOp BuildSegmentReduce(xla::XlaOp values, xla::XlaOp segment_ids,
+                              int64_t num_segments, xla::XlaOp init,
+                              const XlaOpCombiner& combiner) {
+  const xla::Shape& values_shape = ShapeHelper::ShapeOfXlaOp(values);
+  std::vector<int64_t> dims = {num_segments};
+  for (int64_t dim = 1; dim < values_shape.rank(); ++dim) {
+    dims.push_back(values_shape.dimensions(dim));
+  }
+  int64_t num_values = ShapeHelper::ShapeOfXlaOp(segment_ids).dimensions(0);
+  return CreateIndexUpdate(xla::Broadcast(init, dims),
+                           xla::Reshape(segment_ids, {num_values, 1}),
+                           /*start_dim=*/0, values, combiner);
+}
+
 xla::XlaOp CreateScatter(const torch::lazy::BackendDevice& device,
                          xla::XlaOp input, xla::XlaOp index, xla::XlaOp source,
                          int64_t dim, const ScatterOptions& options) {
@@ -714,6 +1164,10 @@ xla::XlaOp CreateScatter(const torch::lazy::BackendDevice& device,
     return XlaDenseScatter(input, index, source_op, dim, options);
   }
 
+  // The iotas of the other dimensions take the type of the narrowed index.
+  index = XlaHelpers::NarrowIndices(
+      index, MaxIndexedDimSize(input_shape, 0, input_shape.rank()));
+  index_shape.set_element_type(XlaHelpers::TypeOfXlaOp(index));
   xla::ShapeUtil::AppendMajorDimension(1, &index_shape);
   std::vector<xla::XlaOp> to_concat;
   to_concat.reserve(input_shape.rank());
@@ -733,10 +1187,25 @@ xla::XlaOp CreateScatter(const torch::lazy::BackendDevice& device,
     scatter_dnums.add_inserted_window_dims(i);
     scatter_dnums.add_scatter_dims_to_operand_dims(i);
   }
+  bool indices_are_sorted = false;
+  bool unique_indices = false;
+  ScatterIndicesMode mode = GetScatterIndicesMode();
+  if (mode != ScatterIndicesMode::kUnsorted && index_shape.is_static()) {
+    int64_t num_updates = xla::ShapeUtil::ElementsIn(index_shape);
+    ScatterUpdates ordered = OrderScatterUpdates(
+        xla::Reshape(scatter_indices, {num_updates, input_shape.rank()}),
+        xla::Reshape(source_op, {num_updates}), /*updates_dim=*/0,
+        options.combiner, input_shape.dimensions(0), mode);
+    scatter_indices = ordered.indices;
+    source_op = ordered.updates;
+    indices_are_sorted = ordered.indices_are_sorted;
+    unique_indices = ordered.unique_indices;
+    scatter_dnums.set_index_vector_dim(1);
+  }
   return xla::Scatter(
       input, scatter_indices, source_op,
       MakeScatterComputation(options.combiner, input_shape.element_type()),
-      scatter_dnums);
+      scatter_dnums, indices_are_sorted, unique_indices);
 }
 
 xla::XlaOp CreatePut(const torch::lazy::BackendDevice& device, xla::XlaOp input,
@@ -827,6 +1296,51 @@ std::vector<xla::XlaOp> BuildMaskedSelect(xla::XlaOp input, xla::XlaOp mask) {
   return {sorted_input_padded, cmd.length};
 }
 
+std::vector<xla::XlaOp> BuildNonZeroStatic(xla::XlaOp input, int64_t size,
+                                           int64_t fill_value) {
+  xla::XlaBuilder* builder = input.builder();
+  const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
+  int64_t rank = input_shape.rank();
+  int64_t num_elements = xla::ShapeUtil::ElementsIn(input_shape);
+  xla::XlaOp condition = xla::Reshape(
+      xla::Ne(input, xla::Zero(builder, input_shape.element_type())),
+      {num_elements});
+  xla::Shape iota_shape = input_shape;
+  iota_shape.set_element_type(xla::PrimitiveType::S64);
+  xla::XlaOp coordinates =
+      xla::Broadcast(xla::Zero(builder, xla::PrimitiveType::S64),
+                     {num_elements, rank});
+  if (rank > 0) {
+    std::vector<xla::XlaOp> to_concat;
+    for (int64_t axis = 0; axis < rank; ++axis) {
+      to_concat.push_back(xla::Reshape(xla::Iota(builder, iota_shape, axis),
+                                       {num_elements, 1}));
+    }
+    coordinates = xla::ConcatInDim(builder, to_concat, 1);
+  }
+  xla::XlaOp result = xla::Broadcast(
+      XlaHelpers::ScalarValue<int64_t>(fill_value, xla::PrimitiveType::S64,
+                                       builder),
+      {size, rank});
+  return {CreateIndexCopy(result, 0, GetCompactionRows(condition, size),
+                          coordinates),
+          CountTrue(condition)};
+}
+
+std::vector<xla::XlaOp> BuildMaskedSelectStatic(xla::XlaOp input,
+                                                xla::XlaOp mask,
+                                                xla::XlaOp fill_value,
+                                                int64_t size) {
+  xla::Shape input_shape;
+  xla::XlaOp r1_input = XlaHelpers::Flatten(input, &input_shape);
+  xla::XlaOp condition = xla::ConvertElementType(
+      GetPromotedR1Mask(mask, input_shape), xla::PrimitiveType::PRED);
+  xla::XlaOp result = xla::Broadcast(fill_value, {size});
+  return {CreateIndexCopy(result, 0, GetCompactionRows(condition, size),
+                          r1_input),
+          CountTrue(condition)};
+}
+
 xla::XlaOp BuildMaskedScatter(xla::XlaOp input, xla::XlaOp mask,
                               xla::XlaOp source) {
   const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
@@ -1043,6 +1557,723 @@ std::vector<xla::XlaOp> BuildAdamOptimizerStep(
   return results;
 }
 
+namespace {
+
+// Concatenates the `inputs`, flattened to 1D.
+xla::XlaOp FlattenConcat(absl::Span<const xla::XlaOp> inputs) {
+  std::vector<xla::XlaOp> flat_inputs;
+  for (const xla::XlaOp& input : inputs) {
+    flat_inputs.push_back(xla::Reshape(
+        input,
+        {xla::ShapeUtil::ElementsIn(ShapeHelper::ShapeOfXlaOp(input))}));
+  }
+  return xla::ConcatInDim(inputs.front().builder(), flat_inputs, 0);
+}
+
+// Concatenates the scalar `steps`, each broadcasted to the number of elements
+// of its param.
+xla::XlaOp FlattenSteps(absl::Span<const xla::XlaOp> steps,
+                        absl::Span<const xla::XlaOp> params) {
+  std::vector<xla::XlaOp> flat_steps;
+  for (size_t i = 0; i < steps.size(); ++i) {
+    flat_steps.push_back(xla::Broadcast(
+        steps[i],
+        {xla::ShapeUtil::ElementsIn(ShapeHelper::ShapeOfXlaOp(params[i]))}));
+  }
+  return xla::ConcatInDim(steps.front().builder(), flat_steps, 0);
+}
+
+// Splits the 1D `flat` result of FlattenConcat() back into `like` shapes,
+// appending the pieces to `results`.
+void SplitFlat(xla::XlaOp flat, absl::Span<const xla::XlaOp> like,
+               std::vector<xla::XlaOp>* results) {
+  int64_t offset = 0;
+  for (const xla::XlaOp& input : like) {
+    const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
+    int64_t size = xla::ShapeUtil::ElementsIn(shape);
+    results->push_back(
+        xla::Reshape(xla::SliceInDim(flat, offset, offset + size, 1, 0),
+                     shape.dimensions()));
+    offset += size;
+  }
+}
+
+// Returns the `steps` incremented by one, unless `found_inf`.
+void AppendNewSteps(const xla::XlaOp& found_inf,
+                    absl::Span<const xla::XlaOp> steps,
+                    std::vector<xla::XlaOp>* results) {
+  xla::XlaOp found_inf_cond = xla::Ne(
+      found_inf,
+      xla::Zero(found_inf.builder(), XlaHelpers::TypeOfXlaOp(found_inf)));
+  for (const xla::XlaOp& step : steps) {
+    results->push_back(step + xla::ConvertElementType(
+                                  xla::Not(found_inf_cond),
+                                  XlaHelpers::TypeOfXlaOp(step)));
+  }
+}
+
+// Returns the `grads` flattened by FlattenConcat() and multiplied by the rank
+// 0 `grad_scale`.
+xla::XlaOp FlattenScaledGrads(absl::Span<const xla::XlaOp> grads,
+                              const xla::XlaOp& grad_scale) {
+  xla::XlaOp flat_grad = FlattenConcat(grads);
+  return flat_grad * xla::ConvertElementType(
+                         grad_scale, XlaHelpers::TypeOfXlaOp(flat_grad));
+}
+
+}  // namespace
+
+std::vector<xla::XlaOp> BuildForeachSgdOptimizerStep(
+    const xla::XlaOp& found_inf, const xla::XlaOp& grad_scale,
+    absl::Span<const xla::XlaOp> steps, absl::Span<const xla::XlaOp> params,
+    absl::Span<const xla::XlaOp> bufs, absl::Span<const xla::XlaOp> d_ps,
+    const xla::XlaOp& weight_decay, const xla::XlaOp& momentum,
+    const xla::XlaOp& lr, const xla::XlaOp& dampening, bool use_weight_decay,
+    bool use_momentum, bool use_nesterov) {
+  XLA_CHECK(!params.empty());
+  xla::XlaOp flat_d_p = FlattenScaledGrads(d_ps, grad_scale);
+  std::vector<xla::XlaOp> flat_results = BuildSgdOptimizerStep(
+      found_inf, FlattenSteps(steps, params), FlattenConcat(params),
+      use_momentum ? FlattenConcat(bufs) : flat_d_p, flat_d_p, weight_decay,
+      momentum, lr, dampening, use_weight_decay, use_momentum, use_nesterov);
+  std::vector<xla::XlaOp> results;
+  AppendNewSteps(found_inf, steps, &results);
+  SplitFlat(flat_results[1], params, &results);
+  if (use_momentum) {
+    SplitFlat(flat_results[2], bufs, &results);
+  } else {
+    results.insert(results.end(), bufs.begin(), bufs.end());
+  }
+  return results;
+}
+
+std::vector<xla::XlaOp> BuildForeachAdamOptimizerStep(
+    const xla::XlaOp& found_inf, const xla::XlaOp& grad_scale,
+    absl::Span<const xla::XlaOp> steps, absl::Span<const xla::XlaOp> params,
+    absl::Span<const xla::XlaOp> grads, absl::Span<const xla::XlaOp> exp_avgs,
+    absl::Span<const xla::XlaOp> exp_avg_sqs,
+    absl::Span<const xla::XlaOp> max_exp_avg_sqs, const xla::XlaOp& beta1,
+    const xla::XlaOp& beta2, const xla::XlaOp& lr,
+    const xla::XlaOp& weight_decay, const xla::XlaOp& eps,
+    bool use_weight_decay, bool use_amsgrad, bool use_adamw) {
+  XLA_CHECK(!params.empty());
+  std::vector<xla::XlaOp> flat_results = BuildAdamOptimizerStep(
+      found_inf, FlattenSteps(steps, params), FlattenConcat(params),
+      FlattenScaledGrads(grads, grad_scale), FlattenConcat(exp_avgs),
+      FlattenConcat(exp_avg_sqs),
+      use_amsgrad ? FlattenConcat(max_exp_avg_sqs) : xla::XlaOp(), beta1,
+      beta2, lr, weight_decay, eps, use_weight_decay, use_amsgrad, use_adamw);
+  std::vector<xla::XlaOp> results;
+  AppendNewSteps(found_inf, steps, &results);
+  // The flat results are the step followed by the flat states.
+  for (size_t i = 1; i < flat_results.size(); ++i) {
+    SplitFlat(flat_results[i], params, &results);
+  }
+  return results;
+}
+
+std::vector<xla::XlaOp> BuildForeachGradNorm(
+    const xla::XlaOp& found_inf, const xla::XlaOp& inv_scale,
+    absl::Span<const xla::XlaOp> grads) {
+  xla::XlaBuilder* builder = found_inf.builder();
+  xla::PrimitiveType found_inf_type = XlaHelpers::TypeOfXlaOp(found_inf);
+  xla::XlaOp f32_inv_scale =
+      xla::ConvertElementType(inv_scale, xla::PrimitiveType::F32);
+  xla::XlaOp all_finite =
+      xla::Eq(found_inf, xla::Zero(builder, found_inf_type));
+  xla::XlaOp zero = xla::Zero(builder, xla::PrimitiveType::F32);
+  xla::XlaOp sum_sq = zero;
+  for (const xla::XlaOp& grad : grads) {
+    xla::XlaOp f32_grad =
+        xla::ConvertElementType(grad, xla::PrimitiveType::F32) * f32_inv_scale;
+    all_finite = xla::And(
+        all_finite,
+        xla::ReduceAll(xla::IsFinite(f32_grad),
+                       xla::One(builder, xla::PrimitiveType::PRED),
+                       xla::CreateScalarAndComputation(
+                           xla::PrimitiveType::PRED, builder)));
+    sum_sq = sum_sq +
+             xla::ReduceAll(
+                 f32_grad * f32_grad, zero,
+                 XlaHelpers::CreateAddComputation(xla::PrimitiveType::F32));
+  }
+  return {xla::ConvertElementType(xla::Not(all_finite), found_inf_type),
+          xla::Sqrt(sum_sq)};
+}
+
+SparseRows BuildCoalescedRows(const SparseRows& grad, int64_t num_rows) {
+  xla::XlaBuilder* builder = grad.rows.builder();
+  const xla::Shape& rows_shape = ShapeHelper::ShapeOfXlaOp(grad.rows);
+  xla::PrimitiveType type = rows_shape.element_type();
+  int64_t num_values = rows_shape.dimensions(0);
+  XLA_CHECK_GT(num_values, 0);
+  xla::XlaOp iota = xla::Iota(
+      builder, xla::ShapeUtil::MakeShape(xla::PrimitiveType::S32, {num_values}),
+      0);
+  xla::XlaOp sort_result = xla::Sort(
+      {grad.rows, iota},
+      xla::CreateScalarLtComputation({type, xla::PrimitiveType::S32}, builder),
+      0);
+  xla::XlaOp sorted_rows = xla::GetTupleElement(sort_result, 0);
+  xla::XlaOp sorted_values = xla::TorchIndexSelect(
+      grad.values, xla::GetTupleElement(sort_result, 1), 0);
+
+  // The segment of a sorted row is the number of distinct rows before it.
+  xla::XlaOp previous_rows = xla::ConcatInDim(
+      builder,
+      {xla::Broadcast(XlaHelpers::ScalarValue<int64_t>(-1, type, builder), {1}),
+       xla::SliceInDim(sorted_rows, 0, num_values - 1, 1, 0)},
+      0);
+  xla::XlaOp starts =
+      xla::ConvertElementType(xla::Ne(sorted_rows, previous_rows), type);
+  xla::XlaOp segments =
+      BuildCumulativeComputation(starts, 0,
+                                 XlaHelpers::CreateAddComputation(type),
+                                 xla::Zero(builder, type)) -
+      xla::One(builder, type);
+  xla::XlaOp values_zero =
+      xla::Zero(builder, XlaHelpers::TypeOfXlaOp(grad.values));
+  return {BuildSegmentReduce(
+              sorted_rows, segments, num_values,
+              XlaHelpers::ScalarValue<int64_t>(num_rows, type, builder),
+              NumericMinCombiner()),
+          BuildSegmentReduce(sorted_values, segments, num_values, values_zero,
+                             NumericAddCombiner())};
+}
+
+namespace {
+
+// Returns the `rows` of `input`, the out of bounds ones clamped in bounds.
+xla::XlaOp GatherRows(xla::XlaOp input, xla::XlaOp rows) {
+  int64_t num_rows = ShapeHelper::ShapeOfXlaOp(input).dimensions(0);
+  xla::PrimitiveType type = XlaHelpers::TypeOfXlaOp(rows);
+  return xla::TorchIndexSelect(
+      input,
+      xla::Clamp(xla::Zero(rows.builder(), type), rows,
+                 XlaHelpers::ScalarValue<int64_t>(num_rows - 1, type,
+                                                  rows.builder())),
+      0);
+}
+
+// Overwrites the `rows` of `input` with `values`. The out of bounds rows are
+// dropped by the scatter.
+xla::XlaOp ScatterRows(xla::XlaOp input, xla::XlaOp rows, xla::XlaOp values) {
+  return CreateIndexCopy(input, 0, rows, values);
+}
+
+}  // namespace
+
+std::vector<xla::XlaOp> BuildSparseSgdOptimizerStep(
+    const xla::XlaOp& found_inf, const xla::XlaOp& step,
+    const xla::XlaOp& param, const xla::XlaOp& buf, const SparseRows& d_p,
+    const xla::XlaOp& weight_decay, const xla::XlaOp& momentum,
+    const xla::XlaOp& lr, const xla::XlaOp& dampening, bool use_weight_decay,
+    bool use_momentum, bool use_nesterov) {
+  SparseRows grad = BuildCoalescedRows(
+      d_p, ShapeHelper::ShapeOfXlaOp(param).dimensions(0));
+  std::vector<xla::XlaOp> results = BuildSgdOptimizerStep(
+      found_inf, step, GatherRows(param, grad.rows),
+      use_momentum ? GatherRows(buf, grad.rows) : grad.values, grad.values,
+      weight_decay, momentum, lr, dampening, use_weight_decay, use_momentum,
+      use_nesterov);
+  results[1] = ScatterRows(param, grad.rows, results[1]);
+  results[2] = use_momentum ? ScatterRows(buf, grad.rows, results[2]) : buf;
+  return results;
+}
+
+std::vector<xla::XlaOp> BuildSparseAdamOptimizerStep(
+    const xla::XlaOp& found_inf, const xla::XlaOp& step,
+    const xla::XlaOp& param, const SparseRows& grad, const xla::XlaOp& exp_avg,
+    const xla::XlaOp& exp_avg_sq, const xla::XlaOp& max_exp_avg_sq,
+    const xla::XlaOp& beta1, const xla::XlaOp& beta2, const xla::XlaOp& lr,
+    const xla::XlaOp& weight_decay, const xla::XlaOp& eps,
+    bool use_weight_decay, bool use_amsgrad, bool use_adamw) {
+  SparseRows coalesced = BuildCoalescedRows(
+      grad, ShapeHelper::ShapeOfXlaOp(param).dimensions(0));
+  std::vector<xla::XlaOp> states = {param, exp_avg, exp_avg_sq};
+  if (use_amsgrad) {
+    states.push_back(max_exp_avg_sq);
+  }
+  std::vector<xla::XlaOp> state_rows;
+  for (const xla::XlaOp& state : states) {
+    state_rows.push_back(GatherRows(state, coalesced.rows));
+  }
+  std::vector<xla::XlaOp> results = BuildAdamOptimizerStep(
+      found_inf, step, state_rows[0], coalesced.values, state_rows[1],
+      state_rows[2], use_amsgrad ? state_rows[3] : max_exp_avg_sq, beta1,
+      beta2, lr, weight_decay, eps, use_weight_decay, use_amsgrad, use_adamw);
+  // The results are the step followed by the updated rows of the states.
+  for (size_t i = 0; i < states.size(); ++i) {
+    results[i + 1] = ScatterRows(states[i], coalesced.rows, results[i + 1]);
+  }
+  return results;
+}
+
+xla::XlaOp BuildAttentionDot(xla::XlaOp lhs, int64_t lhs_contracting,
+                             xla::XlaOp rhs, int64_t rhs_contracting) {
+  int64_t batch_rank = ShapeHelper::ShapeOfXlaOp(lhs).rank() - 2;
+  xla::DotDimensionNumbers dims;
+  for (int64_t i = 0; i < batch_rank; ++i) {
+    dims.add_lhs_batch_dimensions(i);
+    dims.add_rhs_batch_dimensions(i);
+  }
+  dims.add_lhs_contracting_dimensions(batch_rank + lhs_contracting);
+  dims.add_rhs_contracting_dimensions(batch_rank + rhs_contracting);
+  xla::PrecisionConfig precision_config =
+      XlaHelpers::BuildPrecisionConfig(XlaHelpers::mat_mul_precision());
+  return xla::DotGeneral(lhs, rhs, dims, &precision_config,
+                         xla::PrimitiveType::F32);
+}
+
+xla::XlaOp BroadcastAttentionRows(xla::XlaOp rows,
+                                  absl::Span<const int64_t> dims) {
+  std::vector<int64_t> broadcast_dims(dims.size() - 1);
+  std::iota(broadcast_dims.begin(), broadcast_dims.end(), 0);
+  return xla::BroadcastInDim(rows, dims, broadcast_dims);
+}
+
+xla::XlaOp ReduceAttentionRows(xla::XlaOp input, xla::XlaOp init_value,
+                               const xla::XlaComputation& computation) {
+  int64_t rank = ShapeHelper::ShapeOfXlaOp(input).rank();
+  return xla::Reduce(input, init_value, computation, {rank - 1});
+}
+
+namespace {
+
+// The key and value rows of the block of BuildFlashAttention() starting at
+// the S32 `start`, with the scaled scores of the queries over them. The
+// `valid` scores are those of the keys within the `key_rows` unpadded ones
+// and, with `causal`, up to the position of their query. The others are
+// masked out.
+struct AttentionBlock {
+  xla::XlaOp key;
+  xla::XlaOp value;
+  xla::XlaOp scores;
+  xla::XlaOp valid;
+};
+
+AttentionBlock GetAttentionBlock(xla::XlaOp query, xla::XlaOp key,
+                                 xla::XlaOp value, xla::XlaOp start,
+                                 int64_t block_size, int64_t key_rows,
+                                 double scale, bool causal) {
+  xla::XlaBuilder* builder = query.builder();
+  xla::XlaOp zero = xla::Zero(builder, xla::PrimitiveType::S32);
+  const xla::Shape& key_shape = ShapeHelper::ShapeOfXlaOp(key);
+  const xla::Shape& value_shape = ShapeHelper::ShapeOfXlaOp(value);
+  AttentionBlock block;
+  block.key = xla::DynamicSliceInMinorDims(
+      key, {start, zero},
+      {block_size, key_shape.dimensions(key_shape.rank() - 1)});
+  block.value = xla::DynamicSliceInMinorDims(
+      value, {start, zero},
+      {block_size, value_shape.dimensions(value_shape.rank() - 1)});
+  xla::XlaOp scores =
+      BuildAttentionDot(query, 1, block.key, 1) *
+      XlaHelpers::ScalarValue<float>(scale, xla::PrimitiveType::F32, builder);
+  xla::Shape index_shape = ShapeHelper::ShapeOfXlaOp(scores);
+  index_shape.set_element_type(xla::PrimitiveType::S32);
+  int64_t rank = index_shape.rank();
+  xla::XlaOp columns = xla::Iota(builder, index_shape, rank - 1) + start;
+  block.valid =
+      xla::Lt(columns, xla::ConstantR0<int32_t>(builder, key_rows));
+  if (causal) {
+    xla::XlaOp rows = xla::Iota(builder, index_shape, rank - 2);
+    block.valid = xla::And(block.valid, xla::Le(columns, rows));
+  }
+  block.scores = xla::Select(
+      block.valid, scores,
+      xla::Broadcast(xla::MinValue(builder, xla::PrimitiveType::F32),
+                     index_shape.dimensions()));
+  return block;
+}
+
+// Pads the [..., rows, columns] `input` with zero rows up to `rows`.
+xla::XlaOp PadAttentionRows(xla::XlaOp input, int64_t rows) {
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
+  int64_t dim = shape.rank() - 2;
+  return xla::PadInDim(input,
+                       xla::Zero(input.builder(), shape.element_type()), dim,
+                       /*pad_lo=*/0, /*pad_hi=*/rows - shape.dimensions(dim));
+}
+
+}  // namespace
+
+FlashAttentionResult BuildFlashAttention(xla::XlaOp query, xla::XlaOp key,
+                                         xla::XlaOp value, double scale,
+                                         bool causal, int64_t block_size) {
+  xla::XlaBuilder* builder = query.builder();
+  xla::Shape query_shape = ShapeHelper::ShapeOfXlaOp(query);
+  const xla::Shape& key_shape = ShapeHelper::ShapeOfXlaOp(key);
+  const xla::Shape& value_shape = ShapeHelper::ShapeOfXlaOp(value);
+  int64_t key_rows = key_shape.dimensions(key_shape.rank() - 2);
+  block_size = std::min(block_size, key_rows);
+  int64_t num_blocks = xla::CeilOfRatio(key_rows, block_size);
+  xla::PrimitiveType value_type = value_shape.element_type();
+  std::vector<int64_t> output_dims(query_shape.dimensions().begin(),
+                                   query_shape.dimensions().end());
+  output_dims.back() = value_shape.dimensions(value_shape.rank() - 1);
+  std::vector<int64_t> row_dims(output_dims.begin(), output_dims.end() - 1);
+
+  // The loop values are the query, key and value, and the output accumulator
+  // with the running maximum and sum of the exponentials of the score rows.
+  auto body_fn = [&](xla::XlaOp i, absl::Span<const xla::XlaOp> values,
+                     xla::XlaBuilder* body_builder)
+      -> absl::StatusOr<std::vector<xla::XlaOp>> {
+    xla::XlaOp start = i * xla::ConstantR0<int32_t>(body_builder, block_size);
+    AttentionBlock block =
+        GetAttentionBlock(values[0], values[1], values[2], start, block_size,
+                          key_rows, scale, causal);
+    xla::XlaOp row_max = values[4];
+    xla::XlaOp zero = xla::Zero(body_builder, xla::PrimitiveType::F32);
+    absl::Span<const int64_t> scores_dims =
+        ShapeHelper::ShapeOfXlaOp(block.scores).dimensions();
+    xla::XlaOp new_max = xla::Max(
+        row_max,
+        ReduceAttentionRows(
+            block.scores, xla::MinValue(body_builder, xla::PrimitiveType::F32),
+            XlaHelpers::CreateMaxComputation(xla::PrimitiveType::F32)));
+    xla::XlaOp probs = xla::Select(
+        block.valid,
+        xla::Exp(block.scores - BroadcastAttentionRows(new_max, scores_dims)),
+        xla::Broadcast(zero, scores_dims));
+    xla::XlaOp correction = xla::Exp(row_max - new_max);
+    xla::XlaOp row_sum =
+        values[5] * correction +
+        ReduceAttentionRows(
+            probs, zero,
+            XlaHelpers::CreateAddComputation(xla::PrimitiveType::F32));
+    xla::XlaOp accumulator =
+        values[3] * BroadcastAttentionRows(correction, output_dims) +
+        BuildAttentionDot(xla::ConvertElementType(probs, value_type), 1,
+                          block.value, 0);
+    return std::vector<xla::XlaOp>{values[0],   values[1], values[2],
+                                   accumulator, new_max,   row_sum};
+  };
+  int64_t padded_rows = num_blocks * block_size;
+  xla::XlaOp zero = xla::Zero(builder, xla::PrimitiveType::F32);
+  std::vector<xla::XlaOp> results = ConsumeValue(xla::ForEachIndex(
+      num_blocks, xla::PrimitiveType::S32, body_fn,
+      {query, PadAttentionRows(key, padded_rows),
+       PadAttentionRows(value, padded_rows), xla::Broadcast(zero, output_dims),
+       xla::Broadcast(xla::MinValue(builder, xla::PrimitiveType::F32),
+                      row_dims),
+       xla::Broadcast(zero, row_dims)},
+      "FlashAttention", builder));
+  xla::XlaOp output = xla::ConvertElementType(
+      results[3] / BroadcastAttentionRows(results[5], output_dims),
+      query_shape.element_type());
+  return {output, results[4] + xla::Log(results[5])};
+}
+
+FlashAttentionBackwardResult BuildFlashAttentionBackward(
+    xla::XlaOp query, xla::XlaOp key, xla::XlaOp value, xla::XlaOp output,
+    xla::XlaOp logsumexp, xla::XlaOp grad_output, double scale, bool causal,
+    int64_t block_size) {
+  xla::XlaBuilder* builder = query.builder();
+  xla::Shape query_shape = ShapeHelper::ShapeOfXlaOp(query);
+  xla::Shape key_shape = ShapeHelper::ShapeOfXlaOp(key);
+  xla::Shape value_shape = ShapeHelper::ShapeOfXlaOp(value);
+  xla::PrimitiveType grad_type =
+      ShapeHelper::ShapeOfXlaOp(grad_output).element_type();
+  int64_t rank = key_shape.rank();
+  int64_t key_rows = key_shape.dimensions(rank - 2);
+  block_size = std::min(block_size, key_rows);
+  int64_t num_blocks = xla::CeilOfRatio(key_rows, block_size);
+  int64_t padded_rows = num_blocks * block_size;
+
+  xla::XlaOp zero = xla::Zero(builder, xla::PrimitiveType::F32);
+  // The rows of the gradient of the softmax input shared by all the blocks.
+  xla::XlaOp delta = ReduceAttentionRows(
+      xla::ConvertElementType(grad_output, xla::PrimitiveType::F32) *
+          xla::ConvertElementType(output, xla::PrimitiveType::F32),
+      zero, XlaHelpers::CreateAddComputation(xla::PrimitiveType::F32));
+  std::vector<int64_t> grad_key_dims(key_shape.dimensions().begin(),
+                                     key_shape.dimensions().end());
+  grad_key_dims[rank - 2] = padded_rows;
+  std::vector<int64_t> grad_value_dims(value_shape.dimensions().begin(),
+                                       value_shape.dimensions().end());
+  grad_value_dims[rank - 2] = padded_rows;
+
+  // The loop values are the query, key, value, output gradient, log-sum-exp
+  // and delta, and the query, key and value gradients. Every block writes its
+  // own rows of the key and value gradients.
+  auto body_fn = [&](xla::XlaOp i, absl::Span<const xla::XlaOp> values,
+                     xla::XlaBuilder* body_builder)
+      -> absl::StatusOr<std::vector<xla::XlaOp>> {
+    xla::XlaOp start = i * xla::ConstantR0<int32_t>(body_builder, block_size);
+    AttentionBlock block =
+        GetAttentionBlock(values[0], values[1], values[2], start, block_size,
+                          key_rows, scale, causal);
+    absl::Span<const int64_t> scores_dims =
+        ShapeHelper::ShapeOfXlaOp(block.scores).dimensions();
+    xla::XlaOp probs = xla::Select(
+        block.valid,
+        xla::Exp(block.scores - BroadcastAttentionRows(values[4], scores_dims)),
+        xla::Broadcast(xla::Zero(body_builder, xla::PrimitiveType::F32),
+                       scores_dims));
+    xla::XlaOp block_grad_value = BuildAttentionDot(
+        xla::ConvertElementType(probs, grad_type), 0, values[3], 0);
+    xla::XlaOp grad_probs = BuildAttentionDot(values[3], 1, block.value, 1);
+    xla::XlaOp grad_scores =
+        probs *
+        (grad_probs - BroadcastAttentionRows(values[5], scores_dims)) *
+        XlaHelpers::ScalarValue<float>(scale, xla::PrimitiveType::F32,
+                                       body_builder);
+    xla::XlaOp grad_query =
+        values[6] +
+        BuildAttentionDot(
+            xla::ConvertElementType(grad_scores, key_shape.element_type()), 1,
+            block.key, 0);
+    xla::XlaOp block_grad_key = BuildAttentionDot(
+        xla::ConvertElementType(grad_scores, query_shape.element_type()), 0,
+        values[0], 0);
+    xla::XlaOp zero_index = xla::Zero(body_builder, xla::PrimitiveType::S32);
+    return std::vector<xla::XlaOp>{
+        values[0],
+        values[1],
+        values[2],
+        values[3],
+        values[4],
+        values[5],
+        grad_query,
+        xla::DynamicUpdateSliceInMinorDims(values[7], block_grad_key,
+                                           {start, zero_index}),
+        xla::DynamicUpdateSliceInMinorDims(values[8], block_grad_value,
+                                           {start, zero_index})};
+  };
+  std::vector<xla::XlaOp> results = ConsumeValue(xla::ForEachIndex(
+      num_blocks, xla::PrimitiveType::S32, body_fn,
+      {query, PadAttentionRows(key, padded_rows),
+       PadAttentionRows(value, padded_rows), grad_output, logsumexp, delta,
+       xla::Broadcast(zero, query_shape.dimensions()),
+       xla::Broadcast(zero, grad_key_dims),
+       xla::Broadcast(zero, grad_value_dims)},
+      "FlashAttentionBackward", builder));
+  return {xla::ConvertElementType(results[6], query_shape.element_type()),
+          xla::ConvertElementType(
+              xla::SliceInDim(results[7], 0, key_rows, 1, rank - 2),
+              key_shape.element_type()),
+          xla::ConvertElementType(
+              xla::SliceInDim(results[8], 0, key_rows, 1, rank - 2),
+              value_shape.element_type())};
+}
+
+namespace {
+
+// The rows of a row tile which belong to a group, see VisitGroupTiles().
+struct GroupTile {
+  // The S32 first row of the tile.
+  xla::XlaOp tile_start;
+  // The S32 group.
+  xla::XlaOp group;
+  // The PRED [tile_rows] rows of the tile within the group.
+  xla::XlaOp rows;
+};
+
+using GroupTileVisitor = std::function<std::vector<xla::XlaOp>(
+    const GroupTile&, absl::Span<const xla::XlaOp>, xla::XlaBuilder*)>;
+
+// Visits within a loop the (row tile, group) pairs of the rows sorted by
+// group, in order, with the loop `values` updated by `visit`. The tiles
+// holding the rows of several groups are visited once per group. The empty
+// groups are visited once, with no rows, and the rows beyond the sum of the
+// `group_sizes` are not visited. So the loop runs at most num_tiles +
+// num_groups iterations, rather than num_tiles * num_groups.
+std::vector<xla::XlaOp> VisitGroupTiles(xla::XlaOp group_sizes,
+                                        int64_t num_tiles, int64_t tile_rows,
+                                        std::vector<xla::XlaOp> values,
+                                        const GroupTileVisitor& visit,
+                                        absl::string_view name) {
+  xla::XlaBuilder* builder = group_sizes.builder();
+  int64_t num_groups = ShapeHelper::ShapeOfXlaOp(group_sizes).dimensions(0);
+  // The loop values start with the tile, the group, its first row and the
+  // group sizes.
+  xla::XlaOp zero = xla::Zero(builder, xla::PrimitiveType::S32);
+  std::vector<xla::XlaOp> init_values = {
+      zero, zero, zero,
+      xla::ConvertElementType(group_sizes, xla::PrimitiveType::S32)};
+  init_values.insert(init_values.end(), values.begin(), values.end());
+  auto cond_fn = [&](absl::Span<const xla::XlaOp> loop_values,
+                     xla::XlaBuilder* cond_builder)
+      -> absl::StatusOr<xla::XlaOp> {
+    return xla::And(
+        xla::Lt(loop_values[0],
+                xla::ConstantR0<int32_t>(cond_builder, num_tiles)),
+        xla::Lt(loop_values[1],
+                xla::ConstantR0<int32_t>(cond_builder, num_groups)));
+  };
+  auto body_fn = [&](absl::Span<const xla::XlaOp> loop_values,
+                     xla::XlaBuilder* body_builder)
+      -> absl::StatusOr<std::vector<xla::XlaOp>> {
+    xla::XlaOp tile = loop_values[0];
+    xla::XlaOp group = loop_values[1];
+    xla::XlaOp group_start = loop_values[2];
+    xla::XlaOp group_end =
+        group_start +
+        xla::Reshape(xla::DynamicSlice(loop_values[3], {group}, {1}), {});
+    xla::XlaOp tile_start =
+        tile * xla::ConstantR0<int32_t>(body_builder, tile_rows);
+    xla::XlaOp tile_end =
+        tile_start + xla::ConstantR0<int32_t>(body_builder, tile_rows);
+    xla::XlaOp rows =
+        xla::Iota(body_builder, xla::PrimitiveType::S32, tile_rows) +
+        tile_start;
+    GroupTile group_tile{
+        tile_start, group,
+        xla::And(xla::Ge(rows, group_start), xla::Lt(rows, group_end))};
+    std::vector<xla::XlaOp> new_values =
+        visit(group_tile, loop_values.subspan(4), body_builder);
+    // The group is done if it ends within the tile, and the tile if the group
+    // ends at or after its end.
+    xla::XlaOp one = xla::One(body_builder, xla::PrimitiveType::S32);
+    xla::XlaOp group_done = xla::Le(group_end, tile_end);
+    xla::XlaOp tile_done = xla::Ge(group_end, tile_end);
+    std::vector<xla::XlaOp> results = {
+        xla::Select(tile_done, tile + one, tile),
+        xla::Select(group_done, group + one, group),
+        xla::Select(group_done, group_end, group_start), loop_values[3]};
+    results.insert(results.end(), new_values.begin(), new_values.end());
+    return results;
+  };
+  std::vector<xla::XlaOp> results = ConsumeValue(
+      xla::WhileLoopHelper(cond_fn, body_fn, init_values, name, builder));
+  return std::vector<xla::XlaOp>(results.begin() + 4, results.end());
+}
+
+// Pads the rows of the [rows, columns] `input` with zeros to `rows`.
+xla::XlaOp PadGroupRows(xla::XlaOp input, int64_t rows) {
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
+  return xla::PadInDim(input, xla::Zero(input.builder(), shape.element_type()),
+                       0, /*pad_lo=*/0,
+                       /*pad_hi=*/rows - shape.dimensions(0));
+}
+
+// The [rows, columns] matrix of a [groups, rows, columns] `input`.
+xla::XlaOp GroupMatrix(xla::XlaOp input, xla::XlaOp group) {
+  const xla::Shape& shape = ShapeHelper::ShapeOfXlaOp(input);
+  xla::XlaOp zero = xla::Zero(input.builder(), xla::PrimitiveType::S32);
+  return xla::Reshape(
+      xla::DynamicSlice(input, {group, zero, zero},
+                        {1, shape.dimensions(1), shape.dimensions(2)}),
+      {shape.dimensions(1), shape.dimensions(2)});
+}
+
+xla::XlaOp GroupDot(xla::XlaOp lhs, int64_t lhs_contracting, xla::XlaOp rhs,
+                    int64_t rhs_contracting,
+                    std::optional<xla::PrimitiveType> preferred_type) {
+  xla::DotDimensionNumbers dims;
+  dims.add_lhs_contracting_dimensions(lhs_contracting);
+  dims.add_rhs_contracting_dimensions(rhs_contracting);
+  xla::PrecisionConfig precision_config =
+      XlaHelpers::BuildPrecisionConfig(XlaHelpers::mat_mul_precision());
+  return xla::DotGeneral(lhs, rhs, dims, &precision_config, preferred_type);
+}
+
+}  // namespace
+
+xla::XlaOp BuildGroupedMatmul(xla::XlaOp lhs, xla::XlaOp rhs,
+                              xla::XlaOp group_sizes, bool transpose_rhs,
+                              int64_t tile_rows) {
+  const xla::Shape& lhs_shape = ShapeHelper::ShapeOfXlaOp(lhs);
+  const xla::Shape& rhs_shape = ShapeHelper::ShapeOfXlaOp(rhs);
+  XLA_CHECK_EQ(lhs_shape.rank(), 2) << "The lhs must be [m, k]";
+  XLA_CHECK_EQ(rhs_shape.rank(), 3) << "The rhs must be [groups, k, n]";
+  int64_t rows = lhs_shape.dimensions(0);
+  int64_t columns = rhs_shape.dimensions(transpose_rhs ? 1 : 2);
+  XLA_CHECK_EQ(lhs_shape.dimensions(1),
+               rhs_shape.dimensions(transpose_rhs ? 2 : 1));
+  xla::PrimitiveType type = lhs_shape.element_type();
+  if (rows == 0) {
+    return xla::Broadcast(xla::Zero(lhs.builder(), type), {rows, columns});
+  }
+  tile_rows = std::max<int64_t>(std::min(tile_rows, rows), 1);
+  int64_t num_tiles = xla::CeilOfRatio(rows, tile_rows);
+  xla::XlaOp output = xla::Broadcast(xla::Zero(lhs.builder(), type),
+                                     {num_tiles * tile_rows, columns});
+  // Each row of the output is computed by the dot of its group only, and is
+  // selected from it.
+  auto visit = [&](const GroupTile& group_tile,
+                   absl::Span<const xla::XlaOp> values,
+                   xla::XlaBuilder* builder) {
+    xla::XlaOp zero = xla::Zero(builder, xla::PrimitiveType::S32);
+    xla::XlaOp lhs_tile =
+        xla::DynamicSlice(values[0], {group_tile.tile_start, zero},
+                          {tile_rows, lhs_shape.dimensions(1)});
+    xla::XlaOp product =
+        GroupDot(lhs_tile, 1, GroupMatrix(values[1], group_tile.group),
+                 transpose_rhs ? 1 : 0, type);
+    xla::XlaOp output_tile = xla::DynamicSlice(
+        values[2], {group_tile.tile_start, zero}, {tile_rows, columns});
+    output_tile = xla::Select(
+        xla::BroadcastInDim(group_tile.rows, {tile_rows, columns}, {0}),
+        product, output_tile);
+    return std::vector<xla::XlaOp>{
+        values[0], values[1],
+        xla::DynamicUpdateSlice(values[2], output_tile,
+                                {group_tile.tile_start, zero})};
+  };
+  std::vector<xla::XlaOp> results = VisitGroupTiles(
+      group_sizes, num_tiles, tile_rows,
+      {PadGroupRows(lhs, num_tiles * tile_rows), rhs, output}, visit,
+      "GroupedMatmul");
+  return xla::SliceInDim(results[2], 0, rows, 1, 0);
+}
+
+xla::XlaOp BuildTransposedGroupedMatmul(xla::XlaOp lhs, xla::XlaOp rhs,
+                                        xla::XlaOp group_sizes,
+                                        int64_t tile_rows) {
+  const xla::Shape& lhs_shape = ShapeHelper::ShapeOfXlaOp(lhs);
+  const xla::Shape& rhs_shape = ShapeHelper::ShapeOfXlaOp(rhs);
+  XLA_CHECK(lhs_shape.rank() == 2 && rhs_shape.rank() == 2 &&
+            lhs_shape.dimensions(0) == rhs_shape.dimensions(0))
+      << "The lhs and rhs must be [m, k] and [m, n]";
+  int64_t rows = lhs_shape.dimensions(0);
+  int64_t num_groups = ShapeHelper::ShapeOfXlaOp(group_sizes).dimensions(0);
+  std::vector<int64_t> output_dims = {num_groups, lhs_shape.dimensions(1),
+                                      rhs_shape.dimensions(1)};
+  if (rows == 0) {
+    return xla::Broadcast(xla::Zero(lhs.builder(), lhs_shape.element_type()),
+                          output_dims);
+  }
+  tile_rows = std::max<int64_t>(std::min(tile_rows, rows), 1);
+  int64_t num_tiles = xla::CeilOfRatio(rows, tile_rows);
+  xla::XlaOp zero_output = xla::Broadcast(
+      xla::Zero(lhs.builder(), xla::PrimitiveType::F32), output_dims);
+  // The tiles of a group accumulate their products in F32.
+  auto visit = [&](const GroupTile& group_tile,
+                   absl::Span<const xla::XlaOp> values,
+                   xla::XlaBuilder* builder) {
+    xla::XlaOp zero = xla::Zero(builder, xla::PrimitiveType::S32);
+    xla::XlaOp lhs_tile =
+        xla::DynamicSlice(values[0], {group_tile.tile_start, zero},
+                          {tile_rows, output_dims[1]});
+    lhs_tile = xla::Select(
+        xla::BroadcastInDim(group_tile.rows, {tile_rows, output_dims[1]}, {0}),
+        lhs_tile,
+        xla::Broadcast(xla::Zero(builder, lhs_shape.element_type()),
+                       {tile_rows, output_dims[1]}));
+    xla::XlaOp rhs_tile =
+        xla::DynamicSlice(values[1], {group_tile.tile_start, zero},
+                          {tile_rows, output_dims[2]});
+    xla::XlaOp product =
+        GroupDot(lhs_tile, 0, rhs_tile, 0, xla::PrimitiveType::F32);
+    xla::XlaOp group_output =
+        GroupMatrix(values[2], group_tile.group) + product;
+    return std::vector<xla::XlaOp>{
+        values[0], values[1],
+        xla::DynamicUpdateSlice(
+            values[2],
+            xla::Reshape(group_output, {1, output_dims[1], output_dims[2]}),
+            {group_tile.group, zero, zero})};
+  };
+  std::vector<xla::XlaOp> results = VisitGroupTiles(
+      group_sizes, num_tiles, tile_rows,
+      {PadGroupRows(lhs, num_tiles * tile_rows),
+       PadGroupRows(rhs, num_tiles * tile_rows), zero_output},
+      visit, "TransposedGroupedMatmul");
+  return xla::ConvertElementType(results[2], lhs_shape.element_type());
+}
+
 xla::XlaOp BuildXLogY(xla::XlaOp input, xla::XlaOp other) {
   // input and xla::Log(other) can have different types, need to promote
   // the multiply.
@@ -1136,25 +2367,16 @@ xla::XlaOp BuildAddcmul(xla::XlaOp input, xla::XlaOp t1, xla::XlaOp t2,
       input, XlaHelpers::PromotedMul(XlaHelpers::PromotedMul(t1, t2), val));
 }
 
-xla::XlaOp BuildCdistForward(xla::XlaOp x1, xla::XlaOp x2, xla::XlaOp p,
-                             bool use_hamming, bool use_chebyshev) {
+namespace {
+
+// The sum over the features of the terms of the p-norm distances between the
+// rows of x1 and x2, or their maximum for the Chebyshev distance, with a
+// [..., P, R, M] intermediate.
+xla::XlaOp BuildCdistTerms(xla::XlaOp x1, xla::XlaOp x2, xla::XlaOp p,
+                           bool use_hamming, bool use_chebyshev) {
   const xla::Shape& x1_shape = ShapeHelper::ShapeOfXlaOp(x1);
   const xla::Shape& x2_shape = ShapeHelper::ShapeOfXlaOp(x2);
-  p = MaybeConvertTo(p, x1_shape.element_type());
-
-  XLA_CHECK(x1_shape.rank() == x2_shape.rank() && x1_shape.rank() >= 2)
-      << "x1 and x2 must have the same rank with >= 2 dimensions";
-
   int64_t rank = x1_shape.rank();
-
-  XLA_CHECK(x1_shape.dimensions(rank - 1) == x2_shape.dimensions(rank - 1))
-      << "The last dimension of x1 and x2 must match";
-
-  for (int dim = 0; dim < rank - 2; dim++) {
-    XLA_CHECK(x1_shape.dimensions(dim) == x2_shape.dimensions(dim))
-        << absl::StrCat("The ", dim, "th dimension of x1 and x2 must match");
-  }
-
   std::vector<int64_t> bcast_shape(x1_shape.dimensions().begin(),
                                    x1_shape.dimensions().end());
   bcast_shape.insert(bcast_shape.begin() + rank - 1,
@@ -1171,27 +2393,146 @@ xla::XlaOp BuildCdistForward(xla::XlaOp x1, xla::XlaOp x2, xla::XlaOp p,
     // handle p == 0
     xla::XlaOp diff = xla::ConvertElementType(xla::Ne(x1_bcast, x2_bcast),
                                               x1_shape.element_type());
-    xla::XlaOp reduced = xla::Reduce(
+    return xla::Reduce(
         diff, init_value,
         XlaHelpers::CreateAddComputation(x1_shape.element_type()), {rank});
-    return reduced;
   } else if (use_chebyshev) {
     // handle p == +inf
     xla::XlaOp diff = xla::Abs(x1_bcast - x2_bcast);
-    xla::XlaOp reduced = xla::Reduce(
+    return xla::Reduce(
         diff, init_value,
         XlaHelpers::CreateMaxComputation(x1_shape.element_type()), {rank});
-    return reduced;
+  }
+  // handle general case
+  xla::XlaOp diff = xla::Pow(xla::Abs(x1_bcast - x2_bcast), p);
+  return xla::Reduce(diff, init_value,
+                     XlaHelpers::CreateAddComputation(x1_shape.element_type()),
+                     {rank});
+}
+
+// The Euclidean distances as sqrt(|x1|^2 + |x2|^2 - 2 x1 x2^T), with the
+// products of the rows computed by a matmul rather than by a [..., P, R, M]
+// difference.
+xla::XlaOp BuildEuclideanCdist(xla::XlaOp x1, xla::XlaOp x2) {
+  const xla::Shape& x1_shape = ShapeHelper::ShapeOfXlaOp(x1);
+  int64_t rank = x1_shape.rank();
+  xla::PrimitiveType type = x1_shape.element_type();
+  xla::XlaBuilder* builder = x1.builder();
+  xla::XlaComputation add = XlaHelpers::CreateAddComputation(type);
+  xla::XlaOp zero = xla::Zero(builder, type);
+  xla::XlaOp x1_norm = xla::Reduce(x1 * x1, zero, add, {rank - 1});
+  xla::XlaOp x2_norm = xla::Reduce(x2 * x2, zero, add, {rank - 1});
+
+  xla::DotDimensionNumbers dims;
+  for (int64_t i = 0; i < rank - 2; ++i) {
+    dims.add_lhs_batch_dimensions(i);
+    dims.add_rhs_batch_dimensions(i);
+  }
+  dims.add_lhs_contracting_dimensions(rank - 1);
+  dims.add_rhs_contracting_dimensions(rank - 1);
+  xla::PrecisionConfig precision_config =
+      XlaHelpers::BuildPrecisionConfig(XlaHelpers::mat_mul_precision());
+  xla::XlaOp products = xla::DotGeneral(x1, x2, dims, &precision_config);
+
+  absl::Span<const int64_t> output_dims =
+      ShapeHelper::ShapeOfXlaOp(products).dimensions();
+  std::vector<int64_t> x2_norm_dims = torch::lazy::Iota<int64_t>(rank - 2);
+  x2_norm_dims.push_back(rank - 1);
+  xla::XlaOp squared =
+      xla::BroadcastInDim(x1_norm, output_dims,
+                          torch::lazy::Iota<int64_t>(rank - 1)) +
+      xla::BroadcastInDim(x2_norm, output_dims, x2_norm_dims) -
+      XlaHelpers::ScalarValue<float>(2.0, type, builder) * products;
+  // The cancellation of the nearby rows can leave small negative values.
+  return xla::Sqrt(xla::Max(squared, zero));
+}
+
+}  // namespace
+
+xla::XlaOp BuildCdistForward(xla::XlaOp x1, xla::XlaOp x2, xla::XlaOp p,
+                             bool use_hamming, bool use_chebyshev,
+                             bool use_euclidean) {
+  const xla::Shape& x1_shape = ShapeHelper::ShapeOfXlaOp(x1);
+  const xla::Shape& x2_shape = ShapeHelper::ShapeOfXlaOp(x2);
+  p = MaybeConvertTo(p, x1_shape.element_type());
+
+  XLA_CHECK(x1_shape.rank() == x2_shape.rank() && x1_shape.rank() >= 2)
+      << "x1 and x2 must have the same rank with >= 2 dimensions";
+
+  int64_t rank = x1_shape.rank();
+
+  XLA_CHECK(x1_shape.dimensions(rank - 1) == x2_shape.dimensions(rank - 1))
+      << "The last dimension of x1 and x2 must match";
+
+  for (int dim = 0; dim < rank - 2; dim++) {
+    XLA_CHECK(x1_shape.dimensions(dim) == x2_shape.dimensions(dim))
+        << absl::StrCat("The ", dim, "th dimension of x1 and x2 must match");
+  }
+
+  if (use_euclidean) {
+    return BuildEuclideanCdist(x1, x2);
+  }
+
+  // The features are reduced in chunks once the [..., P, R, M] difference
+  // would exceed XLA_CDIST_CHUNK_ELEMENTS, so that the memory stays
+  // proportional to the [..., P, R] output.
+  static const int64_t chunk_elements =
+      runtime::sys_util::GetEnvInt("XLA_CDIST_CHUNK_ELEMENTS", 1 << 28);
+  int64_t features = x1_shape.dimensions(rank - 1);
+  std::vector<int64_t> output_dims(x1_shape.dimensions().begin(),
+                                   x1_shape.dimensions().end() - 1);
+  output_dims.push_back(x2_shape.dimensions(rank - 2));
+  int64_t pairs = std::max<int64_t>(
+      std::accumulate(output_dims.begin(), output_dims.end(), int64_t{1},
+                      std::multiplies<int64_t>()),
+      1);
+  int64_t chunk = std::max<int64_t>(chunk_elements / pairs, 1);
+  xla::XlaOp terms;
+  if (chunk >= features) {
+    terms = BuildCdistTerms(x1, x2, p, use_hamming, use_chebyshev);
   } else {
-    // handle general case
-    xla::XlaOp diff = xla::Pow(xla::Abs(x1_bcast - x2_bcast), p);
-    xla::XlaOp reduced = xla::Reduce(
-        diff, init_value,
-        XlaHelpers::CreateAddComputation(x1_shape.element_type()), {rank});
-    xla::XlaOp one = xla::One(x1.builder(), x1_shape.element_type());
-    xla::XlaOp p_norm = xla::Pow(reduced, xla::Div(one, p));
-    return p_norm;
+    TORCH_LAZY_COUNTER("CdistChunkedFeatures", 1);
+    xla::XlaBuilder* builder = x1.builder();
+    int64_t num_chunks = xla::CeilOfRatio(features, chunk);
+    // The zero padding adds no term to the distances.
+    auto pad_features = [&](xla::XlaOp input) {
+      return xla::PadInDim(input, xla::Zero(builder, x1_shape.element_type()),
+                           rank - 1, /*pad_lo=*/0,
+                           /*pad_hi=*/num_chunks * chunk - features);
+    };
+    auto body_fn = [&](xla::XlaOp i, absl::Span<const xla::XlaOp> values,
+                       xla::XlaBuilder* body_builder)
+        -> absl::StatusOr<std::vector<xla::XlaOp>> {
+      std::vector<xla::XlaOp> starts(
+          rank, xla::Zero(body_builder, xla::PrimitiveType::S32));
+      starts.back() = i * xla::ConstantR0<int32_t>(body_builder, chunk);
+      auto slice_features = [&](xla::XlaOp input) {
+        std::vector<int64_t> sizes = XlaHelpers::SizesOfXlaOp(input);
+        sizes.back() = chunk;
+        return xla::DynamicSlice(input, starts, sizes);
+      };
+      xla::XlaOp chunk_terms =
+          BuildCdistTerms(slice_features(values[0]), slice_features(values[1]),
+                          values[2], use_hamming, use_chebyshev);
+      xla::XlaOp accumulator = use_chebyshev
+                                   ? xla::Max(values[3], chunk_terms)
+                                   : values[3] + chunk_terms;
+      return std::vector<xla::XlaOp>{values[0], values[1], values[2],
+                                     accumulator};
+    };
+    std::vector<xla::XlaOp> results = ConsumeValue(xla::ForEachIndex(
+        num_chunks, xla::PrimitiveType::S32, body_fn,
+        {pad_features(x1), pad_features(x2), p,
+         xla::Broadcast(xla::Zero(builder, x1_shape.element_type()),
+                        output_dims)},
+        "CdistChunks", builder));
+    terms = results[3];
   }
+  if (use_hamming || use_chebyshev) {
+    return terms;
+  }
+  xla::XlaOp one = xla::One(x1.builder(), x1_shape.element_type());
+  return xla::Pow(terms, xla::Div(one, p));
 }
 
 xla::XlaOp BuildPixelShuffle(xla::XlaOp input, int64_t upscale_factor) {
@@ -1583,4 +2924,300 @@ xla::XlaOp BuildNms(xla::XlaOp boxes, xla::XlaOp scores,
   return xla::SetDimensionSize(included_indices_first, included_boxes, 0);
 }
 
+std::vector<xla::XlaOp> BuildBatchedNms(xla::XlaOp boxes, xla::XlaOp scores,
+                                        double iou_threshold,
+                                        double score_threshold,
+                                        int64_t max_output_size) {
+  const xla::PrimitiveType kIndexType = xla::PrimitiveType::S64;
+  const int64_t kCoordinates = 4;
+  xla::XlaBuilder* builder = boxes.builder();
+  const xla::Shape& boxes_shape = ShapeHelper::ShapeOfXlaOp(boxes);
+  const xla::Shape& scores_shape = ShapeHelper::ShapeOfXlaOp(scores);
+  int64_t rank = scores_shape.rank();
+  XLA_CHECK_GE(rank, 1);
+  XLA_CHECK_EQ(boxes_shape.rank(), rank + 1);
+  XLA_CHECK_EQ(boxes_shape.dimensions(rank), kCoordinates);
+  for (int64_t dim = 0; dim < rank; ++dim) {
+    XLA_CHECK_EQ(boxes_shape.dimensions(dim), scores_shape.dimensions(dim));
+  }
+  std::vector<int64_t> batch_dims(scores_shape.dimensions().begin(),
+                                  scores_shape.dimensions().end() - 1);
+  int64_t num_sets = runtime::util::Multiply<int64_t>(batch_dims);
+  int64_t num_boxes = scores_shape.dimensions(rank - 1);
+
+  // 1. Order the boxes of every set by decreasing score, with the indices and
+  //    every coordinate as their own operands.
+  xla::XlaOp set_boxes =
+      xla::Reshape(boxes, {num_sets, num_boxes, kCoordinates});
+  std::vector<xla::XlaOp> to_sort = {
+      xla::Reshape(scores, {num_sets, num_boxes}),
+      xla::Iota(builder, xla::ShapeUtil::MakeShape(kIndexType,
+                                                   {num_sets, num_boxes}),
+                1)};
+  std::vector<xla::PrimitiveType> types_to_sort = {scores_shape.element_type(),
+                                                   kIndexType};
+  for (int64_t i = 0; i < kCoordinates; ++i) {
+    to_sort.push_back(xla::Reshape(xla::SliceInDim(set_boxes, i, i + 1, 1, 2),
+                                   {num_sets, num_boxes}));
+    types_to_sort.push_back(boxes_shape.element_type());
+  }
+  xla::XlaOp sorted = xla::Sort(
+      to_sort, xla::CreateScalarGtComputation(types_to_sort, builder),
+      /*dimension=*/1, /*is_stable=*/true);
+  xla::XlaOp sorted_scores = xla::GetTupleElement(sorted, 0);
+  xla::XlaOp sorted_indices = xla::GetTupleElement(sorted, 1);
+  //    Shape: [num_sets, num_boxes, 1]
+  std::vector<xla::XlaOp> coordinates;
+  for (int64_t i = 0; i < kCoordinates; ++i) {
+    coordinates.push_back(xla::Reshape(xla::GetTupleElement(sorted, i + 2),
+                                       {num_sets, num_boxes, 1}));
+  }
+  xla::XlaOp x0 = coordinates[0];
+  xla::XlaOp y0 = coordinates[1];
+  xla::XlaOp x1 = coordinates[2];
+  xla::XlaOp y1 = coordinates[3];
+
+  // 2. The IoU ratio of every pair of boxes of a set, as in BuildNms().
+  //    Shape: [num_sets, num_boxes, num_boxes]
+  auto transpose = [](xla::XlaOp op) { return xla::Transpose(op, {0, 2, 1}); };
+  xla::XlaOp area = (x1 - x0) * (y1 - y0);
+  xla::XlaOp left = xla::Max(x0, transpose(x0));
+  xla::XlaOp bottom = xla::Max(y0, transpose(y0));
+  xla::XlaOp right = xla::Min(x1, transpose(x1));
+  xla::XlaOp top = xla::Min(y1, transpose(y1));
+  xla::XlaOp zeros = xla::ZerosLike(left);
+  xla::XlaOp intersection_area =
+      xla::Max(right - left, zeros) * xla::Max(top - bottom, zeros);
+  xla::XlaOp iou =
+      intersection_area / (area + transpose(area) - intersection_area);
+
+  // 2.1. Box j can only be suppressed by a box i of higher score, i < j.
+  xla::Shape pair_shape = xla::ShapeUtil::MakeShape(
+      xla::PrimitiveType::S32, {num_sets, num_boxes, num_boxes});
+  xla::XlaOp suppression_mask = xla::And(
+      xla::Gt(iou, XlaHelpers::ScalarValue<double>(
+                       iou_threshold, boxes_shape.element_type(), builder)),
+      xla::Gt(xla::Iota(builder, pair_shape, 2),
+              xla::Iota(builder, pair_shape, 1)));
+
+  // 3. Visit the boxes by decreasing score, every kept box suppressing the
+  //    boxes after it which overlap it, in all the sets at once.
+  xla::XlaOp initial_state =
+      xla::Gt(sorted_scores,
+              XlaHelpers::ScalarValue<double>(
+                  score_threshold, scores_shape.element_type(), builder));
+  auto body_fn = [&](xla::XlaOp i, absl::Span<const xla::XlaOp> values,
+                     xla::XlaBuilder* body_builder)
+      -> absl::StatusOr<std::vector<xla::XlaOp>> {
+    xla::XlaOp zero = xla::Zero(body_builder, xla::PrimitiveType::S32);
+    xla::XlaOp state = values[0];
+    xla::XlaOp box_mask = xla::Reshape(
+        xla::DynamicSlice(values[1], {zero, i, zero}, {num_sets, 1, num_boxes}),
+        {num_sets, num_boxes});
+    xla::XlaOp kept = xla::BroadcastInDim(
+        xla::Reshape(xla::DynamicSlice(state, {zero, i}, {num_sets, 1}),
+                     {num_sets}),
+        {num_sets, num_boxes}, {0});
+    return std::vector<xla::XlaOp>{
+        xla::And(state, xla::Not(xla::And(box_mask, kept))), values[1]};
+  };
+  xla::XlaOp included_mask =
+      ConsumeValue(xla::ForEachIndex(num_boxes, xla::PrimitiveType::S32,
+                                     body_fn, {initial_state, suppression_mask},
+                                     "BatchedBoxSelectionLoop", builder))[0];
+
+  // 4. Move the indices of the kept boxes first, keeping their order, and pad
+  //    the others with -1.
+  xla::XlaOp one_if_included =
+      xla::ConvertElementType(included_mask, kIndexType);
+  xla::XlaOp included_indices_first = xla::GetTupleElement(
+      xla::Sort({one_if_included, sorted_indices},
+                xla::CreateScalarGtComputation({kIndexType, kIndexType},
+                                               builder),
+                /*dimension=*/1, /*is_stable=*/true),
+      1);
+  int64_t num_outputs = std::min(max_output_size, num_boxes);
+  xla::XlaOp num_included = xla::Min(
+      xla::Reduce(one_if_included, xla::Zero(builder, kIndexType),
+                  XlaHelpers::CreateAddComputation(kIndexType), {1}),
+      XlaHelpers::ScalarValue<int64_t>(num_outputs, kIndexType, builder));
+  xla::Shape output_shape =
+      xla::ShapeUtil::MakeShape(kIndexType, {num_sets, num_outputs});
+  xla::XlaOp minus_one =
+      XlaHelpers::ScalarValue<int64_t>(-1, kIndexType, builder);
+  xla::XlaOp valid = xla::Lt(
+      xla::Iota(builder, output_shape, 1),
+      xla::BroadcastInDim(num_included, output_shape.dimensions(), {0}));
+  xla::XlaOp indices = xla::Select(
+      valid,
+      xla::SliceInDim(included_indices_first, 0, num_outputs, 1, 1),
+      xla::Broadcast(minus_one, output_shape.dimensions()));
+  indices = xla::PadInDim(indices, minus_one, 1, /*pad_lo=*/0,
+                          /*pad_hi=*/max_output_size - num_outputs);
+  std::vector<int64_t> indices_dims(batch_dims);
+  indices_dims.push_back(max_output_size);
+  return {xla::Reshape(indices, indices_dims),
+          xla::Reshape(num_included, batch_dims)};
+}
+
+xla::XlaOp BuildWeightOnlyQuantizedMatmul(xla::XlaOp input, xla::XlaOp weight,
+                                          xla::XlaOp scale, int64_t block_size,
+                                          bool int4_weight) {
+  xla::XlaBuilder* builder = input.builder();
+  const xla::Shape& input_shape = ShapeHelper::ShapeOfXlaOp(input);
+  xla::PrimitiveType type = input_shape.element_type();
+  int64_t rank = input_shape.rank();
+  int64_t in_channels = input_shape.dimensions(rank - 1);
+  int64_t out_channels = ShapeHelper::ShapeOfXlaOp(weight).dimensions(0);
+  if (int4_weight) {
+    // Sign extends both nibbles, then interleaves them along the in channels.
+    // The out channels stay the major dimension throughout, so the sharding
+    // of the weight along them propagates to the dot.
+    xla::XlaOp four = xla::ConstantR0<int8_t>(builder, 4);
+    xla::XlaOp low =
+        xla::ShiftRightArithmetic(xla::ShiftLeft(weight, four), four);
+    xla::XlaOp high = xla::ShiftRightArithmetic(weight, four);
+    std::vector<int64_t> nibble_dims = {out_channels, in_channels / 2, 1};
+    weight = xla::Reshape(
+        xla::ConcatInDim(builder,
+                         {xla::Reshape(low, nibble_dims),
+                          xla::Reshape(high, nibble_dims)},
+                         2),
+        {out_channels, in_channels});
+  }
+  scale = xla::ConvertElementType(scale, type);
+  if (block_size > 0) {
+    std::vector<int64_t> block_dims = {out_channels, in_channels / block_size,
+                                       block_size};
+    weight = xla::Reshape(
+        xla::Reshape(xla::ConvertElementType(weight, type), block_dims) *
+            xla::BroadcastInDim(scale, block_dims, {0, 1}),
+        {out_channels, in_channels});
+  }
+  // An S8 weight is fed to the dot as is, its conversion left to the
+  // compiler.
+  xla::DotDimensionNumbers dims;
+  dims.add_lhs_contracting_dimensions(rank - 1);
+  dims.add_rhs_contracting_dimensions(1);
+  xla::PrecisionConfig precision_config =
+      XlaHelpers::BuildPrecisionConfig(XlaHelpers::mat_mul_precision());
+  xla::XlaOp output =
+      xla::DotGeneral(input, weight, dims, &precision_config, type);
+  if (block_size <= 0) {
+    // The per channel scales are applied to the output columns instead, which
+    // are fewer than the weight elements.
+    std::vector<int64_t> output_dims = XlaHelpers::SizesOfXlaOp(output);
+    output = output * xla::BroadcastInDim(scale, output_dims, {rank - 1});
+  }
+  return output;
+}
+
+std::vector<xla::XlaOp> BuildFp8ScaledMatmul(xla::XlaOp a, xla::XlaOp b,
+                                             xla::XlaOp a_scale,
+                                             xla::XlaOp b_scale,
+                                             xla::PrimitiveType a_type,
+                                             xla::PrimitiveType b_type) {
+  xla::XlaBuilder* builder = a.builder();
+  xla::PrimitiveType type = ShapeHelper::ShapeOfXlaOp(a).element_type();
+  a_scale = xla::ConvertElementType(a_scale, xla::PrimitiveType::F32);
+  b_scale = xla::ConvertElementType(b_scale, xla::PrimitiveType::F32);
+  auto quantize = [&](xla::XlaOp input, xla::XlaOp scale,
+                      xla::PrimitiveType fp8_type) {
+    float fp8_max =
+        fp8_type == xla::PrimitiveType::F8E4M3FN ? 448.0f : 57344.0f;
+    xla::XlaOp limit = xla::ConstantR0<float>(builder, fp8_max);
+    xla::XlaOp scaled =
+        xla::ConvertElementType(input, xla::PrimitiveType::F32) * scale;
+    return xla::ConvertElementType(xla::Clamp(-limit, scaled, limit),
+                                   fp8_type);
+  };
+  auto amax = [&](xla::XlaOp input) {
+    return xla::ReduceAll(
+        xla::Abs(xla::ConvertElementType(input, xla::PrimitiveType::F32)),
+        xla::Zero(builder, xla::PrimitiveType::F32),
+        XlaHelpers::CreateMaxComputation(xla::PrimitiveType::F32));
+  };
+  xla::DotDimensionNumbers dims;
+  dims.add_lhs_contracting_dimensions(1);
+  dims.add_rhs_contracting_dimensions(0);
+  xla::XlaOp product = xla::DotGeneral(
+      quantize(a, a_scale, a_type), quantize(b, b_scale, b_type), dims,
+      /*precision_config=*/nullptr, xla::PrimitiveType::F32);
+  xla::XlaOp output =
+      xla::ConvertElementType(product / (a_scale * b_scale), type);
+  return {output, amax(a), amax(b)};
+}
+
+xla::XlaOp BuildSampleTokens(xla::XlaOp logits, xla::XlaOp temperature,
+                             xla::XlaOp seed, int64_t top_k,
+                             const absl::optional<xla::XlaOp>& top_p) {
+  const xla::Shape& logits_shape = ShapeHelper::ShapeOfXlaOp(logits);
+  XLA_CHECK_GE(logits_shape.rank(), 1) << logits_shape;
+  xla::XlaBuilder* builder = logits.builder();
+  int64_t dim = logits_shape.rank() - 1;
+  int64_t vocab_size = logits_shape.dimensions(dim);
+  // Broadcasts a scalar or batch shaped parameter to `shape`.
+  auto broadcast_rows = [&](xla::XlaOp param, const xla::Shape& shape) {
+    int64_t rank = ShapeHelper::ShapeOfXlaOp(param).rank();
+    return xla::BroadcastInDim(xla::ConvertElementType(param, xla::F32),
+                               shape.dimensions(),
+                               torch::lazy::Iota<int64_t>(rank, dim - rank));
+  };
+  xla::XlaOp scores = xla::ConvertElementType(logits, xla::F32);
+  absl::optional<xla::XlaOp> candidates;
+  if ((top_k > 0 && top_k < vocab_size) || top_p) {
+    // The candidates, the top_k logits or all of them with top_p, sorted.
+    int64_t k = top_k > 0 ? std::min(top_k, vocab_size) : vocab_size;
+    std::vector<xla::XlaOp> top =
+        CreateApproxTopK(scores, k, dim, /*largest=*/true,
+                         /*recall_target=*/1.0);
+    scores = top[0];
+    candidates = top[1];
+  }
+  xla::Shape scores_shape = ShapeHelper::ShapeOfXlaOp(scores);
+  auto fill = [&](xla::XlaOp value) {
+    return xla::Broadcast(value, scores_shape.dimensions());
+  };
+  xla::XlaOp zero = xla::Zero(builder, xla::F32);
+  xla::XlaOp one = xla::One(builder, xla::F32);
+  xla::XlaOp row_temperature = broadcast_rows(temperature, scores_shape);
+  xla::XlaOp sampled = xla::Gt(row_temperature, zero);
+  scores = xla::Div(scores, xla::Select(sampled, row_temperature, fill(one)));
+  if (top_p) {
+    // Keeps the candidates whose preceding ones sum to less than top_p, which
+    // always includes the most likely one.
+    xla::XlaOp probs = BuildSoftmax(scores, dim);
+    xla::XlaOp cumprobs = BuildCumulativeComputation(
+        probs, dim, XlaHelpers::CreateAddComputation(xla::F32), zero);
+    xla::XlaOp keep = xla::Lt(xla::Sub(cumprobs, probs),
+                              broadcast_rows(*top_p, scores_shape));
+    scores = xla::Select(keep, scores, fill(xla::MinValue(builder, xla::F32)));
+  }
+  // Gumbel-max: the argmax of the scores plus -log(-log(u)) noise is a sample
+  // of their softmax. The greedy rows get no noise.
+  xla::XlaOp uniform =
+      RngUniform(seed, scores_shape,
+                 xla::ConstantR0<float>(builder,
+                                        std::numeric_limits<float>::min()),
+                 one);
+  xla::XlaOp gumbel = xla::Neg(xla::Log(xla::Neg(xla::Log(uniform))));
+  scores = xla::Add(scores, xla::Select(sampled, gumbel, fill(zero)));
+  xla::XlaOp choice = BuildArgMax(scores, dim, /*keepdim=*/false);
+  if (!candidates) {
+    return choice;
+  }
+  // The vocabulary index of the chosen candidate.
+  const xla::Shape& candidates_shape = ShapeHelper::ShapeOfXlaOp(*candidates);
+  xla::XlaOp positions = xla::Iota(builder, candidates_shape, dim);
+  xla::XlaOp chosen = xla::Eq(
+      positions,
+      xla::BroadcastInDim(choice, candidates_shape.dimensions(),
+                          torch::lazy::Iota<int64_t>(dim)));
+  xla::PrimitiveType index_type = candidates_shape.element_type();
+  return xla::Reduce(
+      xla::Select(chosen, *candidates, xla::ZerosLike(*candidates)),
+      xla::Zero(builder, index_type),
+      XlaHelpers::CreateAddComputation(index_type), {dim});
+}
+
 }  // namespace torch_xla
@@ -20,6 +20,16 @@ std::vector<xla::XlaOp> CreateKthValue(xla::XlaOp input, int64_t k, int64_t dim,
 std::vector<xla::XlaOp> CreateTopK(xla::XlaOp input, int64_t k, int64_t dim,
                                    bool largest, bool stable);
 
+// The top-k for a small k over a large dimension. With a recall_target below
+// 1, it is the XLA approximate top-k, whose expected recall is at least
+// recall_target on TPU and is exact on the other devices. Otherwise it is
+// exact, as the top-k of the top-k of chunks of the dimension, which sorts
+// small chunks rather than the whole dimension. The ties are broken by the
+// lower index, as the stable top-k does.
+std::vector<xla::XlaOp> CreateApproxTopK(xla::XlaOp input, int64_t k,
+                                         int64_t dim, bool largest,
+                                         float recall_target);
+
 xla::XlaOp CreateMatMul(xla::XlaOp lhs, xla::XlaOp rhs);
 
 xla::XlaOp BuildMatMul(xla::XlaOp lhs, xla::XlaOp rhs, xla::XlaOp bias);
@@ -48,6 +58,22 @@ std::vector<xla::XlaOp> BuildNativeDropout(xla::XlaOp input, xla::XlaOp seed,
                                            float probability,
                                            c10::optional<bool> train);
 
+// The layer norm over the last dimension of dropout(input) + residual, with
+// the dropout mask drawn from `seed`. The outputs are the layer norm, the sum
+// it normalizes, and the F32 mean and reciprocal standard deviation of the
+// rows of the sum. With `return_mask` the scaled dropout mask follows.
+std::vector<xla::XlaOp> BuildDropoutAddLayerNorm(
+    xla::XlaOp input, xla::XlaOp residual, xla::XlaOp weight, xla::XlaOp bias,
+    xla::XlaOp seed, float probability, double eps, bool return_mask);
+
+// The input, residual, weight and bias gradients of BuildDropoutAddLayerNorm(),
+// given the gradients of its layer norm and sum outputs. Without a `mask`,
+// the dropout mask is drawn again from the forward `seed`.
+std::vector<xla::XlaOp> BuildDropoutAddLayerNormBackward(
+    xla::XlaOp grad_output, xla::XlaOp grad_sum, xla::XlaOp sum,
+    xla::XlaOp weight, xla::XlaOp mean, xla::XlaOp rstd, xla::XlaOp seed,
+    const absl::optional<xla::XlaOp>& mask, float probability);
+
 xla::XlaOp BuildSigmoidBackward(xla::XlaOp grad_output, xla::XlaOp output,
                                 xla::XlaOp scalar_1);
 
@@ -82,6 +108,20 @@ XlaOpCombiner NumericMinCombiner();
 
 XlaOpCombiner NumericMaxCombiner();
 
+// Returns the [num_indices] bags of the indices of an embedding_bag, delimited
+// by the [num_offsets] `offsets`: the number of offsets past the first one at
+// or before each index. The indices past the last offset of an
+// include_last_offset input are in the out of bounds bag num_offsets - 1.
+xla::XlaOp BuildBagSegmentIds(xla::XlaOp offsets, int64_t num_indices);
+
+// Reduces the [num_values, ...] `values` (or a scalar, for all of them) into
+// [num_segments, ...] segments by their [num_values] `segment_ids`, combining
+// the values of a segment from `init`. The values with out of bounds segment
+// ids are dropped.
+xla::XlaOp BuildSegmentReduce(xla::XlaOp values, xla::XlaOp segment_ids,
+                              int64_t num_segments, xla::XlaOp init,
+                              const XlaOpCombiner& combiner);
+
 struct ScatterOptions {
   explicit ScatterOptions(XlaOpCombiner combiner)
       : combiner(std::move(combiner)) {}
@@ -105,6 +145,20 @@ std::vector<xla::XlaOp> BuildNonZero(xla::XlaOp input);
 
 std::vector<xla::XlaOp> BuildMaskedSelect(xla::XlaOp input, xla::XlaOp mask);
 
+// Static shape variants of BuildNonZero() and BuildMaskedSelect(). The first
+// `size` results are compacted with a cumulative sum of the condition, in
+// place of a sort, into a [size, ...] result padded with `fill_value`, a
+// scalar of the input type for BuildMaskedSelectStatic(). The second output is
+// the S64 number of all the true elements, above `size` when results were
+// dropped.
+std::vector<xla::XlaOp> BuildNonZeroStatic(xla::XlaOp input, int64_t size,
+                                           int64_t fill_value);
+
+std::vector<xla::XlaOp> BuildMaskedSelectStatic(xla::XlaOp input,
+                                                xla::XlaOp mask,
+                                                xla::XlaOp fill_value,
+                                                int64_t size);
+
 xla::XlaOp BuildMaskedScatter(xla::XlaOp input, xla::XlaOp mask,
                               xla::XlaOp source);
 
@@ -134,6 +188,134 @@ std::vector<xla::XlaOp> BuildAdamOptimizerStep(
     const xla::XlaOp& weight_decay, const xla::XlaOp& eps,
     bool use_weight_decay, bool use_amsgrad, bool use_adamw);
 
+// The multi-tensor variant of BuildSgdOptimizerStep(): the params, with their
+// own steps, momentum buffers and gradients, are flattened into a single
+// buffer, updated at once and split back. The scalars must be rank 0. The
+// gradients are multiplied by `grad_scale` within the update, which folds the
+// AMP unscale and the gradient clipping into it. Returns the new steps,
+// followed by the new params, followed by the new buffers.
+std::vector<xla::XlaOp> BuildForeachSgdOptimizerStep(
+    const xla::XlaOp& found_inf, const xla::XlaOp& grad_scale,
+    absl::Span<const xla::XlaOp> steps, absl::Span<const xla::XlaOp> params,
+    absl::Span<const xla::XlaOp> bufs, absl::Span<const xla::XlaOp> d_ps,
+    const xla::XlaOp& weight_decay, const xla::XlaOp& momentum,
+    const xla::XlaOp& lr, const xla::XlaOp& dampening, bool use_weight_decay,
+    bool use_momentum, bool use_nesterov);
+
+// The multi-tensor variant of BuildAdamOptimizerStep(), as for
+// BuildForeachSgdOptimizerStep(). The `max_exp_avg_sqs` are only used with
+// `use_amsgrad`. Returns the new steps, params, exp_avgs, exp_avg_sqs and, with
+// `use_amsgrad`, max_exp_avg_sqs, one after the other.
+std::vector<xla::XlaOp> BuildForeachAdamOptimizerStep(
+    const xla::XlaOp& found_inf, const xla::XlaOp& grad_scale,
+    absl::Span<const xla::XlaOp> steps, absl::Span<const xla::XlaOp> params,
+    absl::Span<const xla::XlaOp> grads, absl::Span<const xla::XlaOp> exp_avgs,
+    absl::Span<const xla::XlaOp> exp_avg_sqs,
+    absl::Span<const xla::XlaOp> max_exp_avg_sqs, const xla::XlaOp& beta1,
+    const xla::XlaOp& beta2, const xla::XlaOp& lr,
+    const xla::XlaOp& weight_decay, const xla::XlaOp& eps,
+    bool use_weight_decay, bool use_amsgrad, bool use_adamw);
+
+// Returns the `found_inf` flag, set if any of the `grads` is not finite, and
+// the F32 global L2 norm of the `grads` multiplied by the rank 0 `inv_scale`.
+// The grads can have different types, and are only read.
+std::vector<xla::XlaOp> BuildForeachGradNorm(
+    const xla::XlaOp& found_inf, const xla::XlaOp& inv_scale,
+    absl::Span<const xla::XlaOp> grads);
+
+// A row-sparse gradient of a [num_rows, ...] tensor: the [K] rows and their
+// [K, ...] values. The rows out of [0, num_rows) are ignored.
+struct SparseRows {
+  xla::XlaOp rows;
+  xla::XlaOp values;
+};
+
+// Sums the values of the duplicate rows of `grad`. The K coalesced rows are
+// sorted and padded with the out of bounds row num_rows.
+SparseRows BuildCoalescedRows(const SparseRows& grad, int64_t num_rows);
+
+// Like BuildSgdOptimizerStep(), with a row-sparse `d_p`: only the rows of the
+// param and momentum buffer in `d_p` are gathered, updated and scattered back.
+// The scalars must be rank 0.
+std::vector<xla::XlaOp> BuildSparseSgdOptimizerStep(
+    const xla::XlaOp& found_inf, const xla::XlaOp& step,
+    const xla::XlaOp& param, const xla::XlaOp& buf, const SparseRows& d_p,
+    const xla::XlaOp& weight_decay, const xla::XlaOp& momentum,
+    const xla::XlaOp& lr, const xla::XlaOp& dampening, bool use_weight_decay,
+    bool use_momentum, bool use_nesterov);
+
+// Like BuildAdamOptimizerStep(), with a row-sparse `grad`: only the rows of
+// the param and moments in `grad` are gathered, updated and scattered back.
+// The scalars must be rank 0.
+std::vector<xla::XlaOp> BuildSparseAdamOptimizerStep(
+    const xla::XlaOp& found_inf, const xla::XlaOp& step,
+    const xla::XlaOp& param, const SparseRows& grad, const xla::XlaOp& exp_avg,
+    const xla::XlaOp& exp_avg_sq, const xla::XlaOp& max_exp_avg_sq,
+    const xla::XlaOp& beta1, const xla::XlaOp& beta2, const xla::XlaOp& lr,
+    const xla::XlaOp& weight_decay, const xla::XlaOp& eps,
+    bool use_weight_decay, bool use_amsgrad, bool use_adamw);
+
+// Multiplies the [..., rows, columns] `lhs` and `rhs` over their
+// `lhs_contracting` and `rhs_contracting` (0 for the rows, 1 for the columns)
+// dimensions, accumulating and returning in F32.
+xla::XlaOp BuildAttentionDot(xla::XlaOp lhs, int64_t lhs_contracting,
+                             xla::XlaOp rhs, int64_t rhs_contracting);
+
+// Broadcasts the [..., rows] values of `rows` along the last dimension of
+// `dims`.
+xla::XlaOp BroadcastAttentionRows(xla::XlaOp rows,
+                                  absl::Span<const int64_t> dims);
+
+// Reduces the last dimension of the F32 `input` by `computation`.
+xla::XlaOp ReduceAttentionRows(xla::XlaOp input, xla::XlaOp init_value,
+                               const xla::XlaComputation& computation);
+
+struct FlashAttentionResult {
+  xla::XlaOp output;
+  // The F32 [..., query rows] log-sum-exp of the scores, for the backward.
+  xla::XlaOp logsumexp;
+};
+
+struct FlashAttentionBackwardResult {
+  xla::XlaOp grad_query;
+  xla::XlaOp grad_key;
+  xla::XlaOp grad_value;
+};
+
+// The softmax(query keyT * scale) value attention of the [..., query rows,
+// head] `query` over the [..., key rows, head] `key` and [..., key rows,
+// value head] `value`. The keys and values are visited in blocks of
+// `block_size` rows within a loop, accumulating the softmax online, so only
+// the [..., query rows, block_size] scores of one block are live at a time.
+// With `causal`, the i-th query only attends to the keys up to the i-th.
+FlashAttentionResult BuildFlashAttention(xla::XlaOp query, xla::XlaOp key,
+                                         xla::XlaOp value, double scale,
+                                         bool causal, int64_t block_size);
+
+// The gradients of BuildFlashAttention(), given its `output` and `logsumexp`.
+// The probabilities of every block are recomputed from the log-sum-exp.
+FlashAttentionBackwardResult BuildFlashAttentionBackward(
+    xla::XlaOp query, xla::XlaOp key, xla::XlaOp value, xla::XlaOp output,
+    xla::XlaOp logsumexp, xla::XlaOp grad_output, double scale, bool causal,
+    int64_t block_size);
+
+// The [m, n] products of the rows of the [m, k] `lhs`, sorted by group, with
+// the [k, n] matrices of their groups in the [groups, k, n] `rhs` ([groups, n,
+// k] with `transpose_rhs`). The [groups] `group_sizes` are the number of rows
+// of each group, and the rows beyond their sum are zeros. The rows are visited
+// in tiles of `tile_rows` within a loop, each tile multiplying the matrices of
+// the groups of its rows only, so no FLOP is spent on padding the groups.
+xla::XlaOp BuildGroupedMatmul(xla::XlaOp lhs, xla::XlaOp rhs,
+                              xla::XlaOp group_sizes, bool transpose_rhs,
+                              int64_t tile_rows);
+
+// The [groups, k, n] products lhs[rows]^T rhs[rows] of the rows of each group
+// of the [m, k] `lhs` and [m, n] `rhs`, sorted by group as in
+// BuildGroupedMatmul(), of which it computes the rhs gradient.
+xla::XlaOp BuildTransposedGroupedMatmul(xla::XlaOp lhs, xla::XlaOp rhs,
+                                        xla::XlaOp group_sizes,
+                                        int64_t tile_rows);
+
 xla::XlaOp BuildXLogY(xla::XlaOp input, xla::XlaOp other);
 
 xla::XlaOp BuildRoll(xla::XlaOp input, absl::Span<const int64_t> shifts,
@@ -145,8 +327,11 @@ xla::XlaOp BuildAddcdiv(xla::XlaOp input, xla::XlaOp t1, xla::XlaOp t2,
 xla::XlaOp BuildAddcmul(xla::XlaOp input, xla::XlaOp t1, xla::XlaOp t2,
                         xla::XlaOp val);
 
+// The p-norm distances between the rows of x1 and x2. With `use_euclidean`
+// (p == 2), they are computed from the matmul of x1 and x2 and their norms.
 xla::XlaOp BuildCdistForward(xla::XlaOp x1, xla::XlaOp x2, xla::XlaOp p,
-                             bool use_hamming, bool use_chebyshev);
+                             bool use_hamming, bool use_chebyshev,
+                             bool use_euclidean);
 
 xla::XlaOp BuildPixelShuffle(xla::XlaOp input, int64_t upscale_factor);
 
@@ -162,10 +347,55 @@ std::vector<xla::XlaOp> BuildTpuCustomCall(
 xla::XlaOp BuildNms(xla::XlaOp boxes, xla::XlaOp scores,
                     xla::XlaOp iou_threshold);
 
+// The NMS of every set of the [..., num_boxes, 4] `boxes` with [..., num_boxes]
+// `scores`, the sets being suppressed together in one loop over the boxes of
+// decreasing score. The boxes below `score_threshold` are discarded first.
+// The outputs are the S64 [..., max_output_size] indices of the kept boxes of
+// every set by decreasing score, padded with -1, and their S64 [...] number.
+std::vector<xla::XlaOp> BuildBatchedNms(xla::XlaOp boxes, xla::XlaOp scores,
+                                        double iou_threshold,
+                                        double score_threshold,
+                                        int64_t max_output_size);
+
 std::vector<xla::XlaOp> BuildGpuCustomCall(
     const std::vector<xla::XlaOp>& inputs, const xla::Shape& output_shape,
     const std::string& payload);
 
+// Multiplies the [..., in_channels] `input` by the transposed S8
+// [out_channels, in_channels] `weight`, dequantized within the computation so
+// that the compiler can fuse it into the dot. With `int4_weight` the weight is
+// [out_channels, in_channels / 2], every byte packing the in channels 2j in
+// its low nibble and 2j + 1 in its high one. With a positive `block_size` the
+// `scale` is [out_channels, in_channels / block_size], one per block of
+// in channels, otherwise it is the per channel [out_channels] scale.
+xla::XlaOp BuildWeightOnlyQuantizedMatmul(xla::XlaOp input, xla::XlaOp weight,
+                                          xla::XlaOp scale, int64_t block_size,
+                                          bool int4_weight);
+
+// Multiplies the [M, K] `a` by the [K, N] `b` with a dot of FP8 operands, `a`
+// and `b` being multiplied by their scalar F32 scales and saturated to the
+// range of their `a_type` and `b_type` FP8 types before the conversion. The
+// F32 accumulation is divided by the scales back. The outputs are the [M, N]
+// matmul of the `a` type, and the F32 absolute maxima of `a` and `b`, for the
+// delayed scaling of the next steps.
+std::vector<xla::XlaOp> BuildFp8ScaledMatmul(xla::XlaOp a, xla::XlaOp b,
+                                             xla::XlaOp a_scale,
+                                             xla::XlaOp b_scale,
+                                             xla::PrimitiveType a_type,
+                                             xla::PrimitiveType b_type);
+
+// Samples a token id for each row of the [..., V] `logits`, from the softmax
+// of logits / temperature restricted to the top_k largest logits if top_k > 0
+// and, with a `top_p`, to the fewest of the largest logits whose probability
+// sums to top_p. The `temperature` and `top_p` are F32 scalars or of the
+// batch shape [...], a zero temperature sampling greedily. The sample is the
+// argmax of the logits perturbed by Gumbel noise, so that no cumulative
+// distribution over the vocabulary is built; only top_p without top_k sorts
+// the vocabulary. Returns the S64 [...] token ids.
+xla::XlaOp BuildSampleTokens(xla::XlaOp logits, xla::XlaOp temperature,
+                             xla::XlaOp seed, int64_t top_k,
+                             const absl::optional<xla::XlaOp>& top_p);
+
 }  // namespace torch_xla
 
 #endif  // XLA_TORCH_XLA_CSRC_XLA_LOWER_UTIL_H_
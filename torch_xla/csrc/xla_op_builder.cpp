@@ -1,5 +1,6 @@
 #include "torch_xla/csrc/xla_op_builder.h"
 
+#include <iterator>
 #include <map>
 
 #include "absl/types/optional.h"
@@ -835,6 +836,19 @@ const XlaOpFunctionMap* GetXlaOpFunctionMap() {
   return fn_map;
 }
 
+// The op functions interned by op code, the position of their name in the
+// function map, so that the ops can be created without name lookups.
+const std::vector<XlaOpFunction>& GetXlaOpFunctions() {
+  static const std::vector<XlaOpFunction>* functions = []() {
+    auto* functions = new std::vector<XlaOpFunction>();
+    for (const auto& name_fn : *GetXlaOpFunctionMap()) {
+      functions->push_back(name_fn.second);
+    }
+    return functions;
+  }();
+  return *functions;
+}
+
 }  // namespace
 
 py::object ShapeToPyShape(const xla::Shape& shape) {
@@ -878,16 +892,60 @@ xla::Shape PyShapeToShape(py::object shape) {
   return xla::ShapeUtil::MakeShape(xla_type, dimensions);
 }
 
-OpPtr CreateOp(BuilderPtr builder, const std::string& opname,
-               const std::vector<OpPtr>& operands, py::dict args) {
+std::map<std::string, int64_t> GetOpCodes() {
+  std::map<std::string, int64_t> codes;
+  for (const auto& name_fn : *GetXlaOpFunctionMap()) {
+    codes.emplace(name_fn.first, codes.size());
+  }
+  return codes;
+}
+
+int64_t GetOpCode(const std::string& opname) {
   const XlaOpFunctionMap* fn_map = GetXlaOpFunctionMap();
   auto it = fn_map->find(opname);
   if (it == fn_map->end()) {
     XLA_ERROR() << "Unknown XLA op name: " << opname;
   }
-  xla::XlaOp result = (*it->second)(builder, operands, args);
+  return std::distance(fn_map->begin(), it);
+}
+
+OpPtr CreateOp(BuilderPtr builder, const std::string& opname,
+               const std::vector<OpPtr>& operands, py::dict args) {
+  return CreateOp(std::move(builder), GetOpCode(opname), operands, args);
+}
+
+OpPtr CreateOp(BuilderPtr builder, int64_t opcode,
+               const std::vector<OpPtr>& operands, py::dict args) {
+  const std::vector<XlaOpFunction>& functions = GetXlaOpFunctions();
+  XLA_CHECK(opcode >= 0 && static_cast<size_t>(opcode) < functions.size())
+      << "Unknown XLA op code: " << opcode;
+  xla::XlaOp result = (*functions[opcode])(builder, operands, args);
   return std::make_shared<Op>(std::move(builder), std::move(result));
 }
 
+std::vector<OpPtr> CreateOps(BuilderPtr builder,
+                             const std::vector<OpPtr>& inputs,
+                             py::list descriptors) {
+  std::vector<OpPtr> ops(inputs.begin(), inputs.end());
+  ops.reserve(inputs.size() + descriptors.size());
+  std::vector<OpPtr> operands;
+  for (const auto& descriptor : descriptors) {
+    py::tuple fields = descriptor.cast<py::tuple>();
+    XLA_CHECK_EQ(fields.size(), 3)
+        << "An op descriptor is (opcode, operands, args)";
+    operands.clear();
+    for (const auto& ref : fields[1].cast<py::tuple>()) {
+      int64_t index = ref.cast<int64_t>();
+      XLA_CHECK(index >= 0 && static_cast<size_t>(index) < ops.size())
+          << "Op " << ops.size() << " refers to op " << index
+          << " which is not created yet";
+      operands.push_back(ops[index]);
+    }
+    ops.push_back(CreateOp(builder, fields[0].cast<int64_t>(), operands,
+                           fields[2].cast<py::dict>()));
+  }
+  return std::vector<OpPtr>(ops.begin() + inputs.size(), ops.end());
+}
+
 }  // namespace op_builder
 }  // namespace torch_xla
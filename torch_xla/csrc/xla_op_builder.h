@@ -3,6 +3,7 @@
 
 #include <torch/csrc/jit/python/pybind.h>
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -28,9 +29,25 @@ py::object ShapeToPyShape(const xla::Shape& shape);
 
 xla::Shape PyShapeToShape(py::object shape);
 
+// The interned codes of the op names, which create the ops without looking up
+// their names.
+std::map<std::string, int64_t> GetOpCodes();
+
+int64_t GetOpCode(const std::string& opname);
+
 OpPtr CreateOp(BuilderPtr builder, const std::string& opname,
                const std::vector<OpPtr>& operands, py::dict args);
 
+OpPtr CreateOp(BuilderPtr builder, int64_t opcode,
+               const std::vector<OpPtr>& operands, py::dict args);
+
+// Creates in order the ops of the (opcode, operands, args) `descriptors`, with
+// a single call from Python. The operands are the indices of the ops among the
+// `inputs` followed by the ops created before. Returns the created ops.
+std::vector<OpPtr> CreateOps(BuilderPtr builder,
+                             const std::vector<OpPtr>& inputs,
+                             py::list descriptors);
+
 }  // namespace op_builder
 }  // namespace torch_xla
 
@@ -2,16 +2,20 @@
 
 #include <ATen/TensorIndexing.h>
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 #include <unordered_map>
+#include <unordered_set>
+#include <variant>
 
-#include "absl/synchronization/blocking_counter.h"
 #include "torch/csrc/lazy/core/ir_util.h"
 #include "torch_xla/csrc/aten_autograd_ops.h"
 #include "torch_xla/csrc/aten_xla_bridge.h"
 #include "torch_xla/csrc/device.h"
 #include "torch_xla/csrc/dtype.h"
 #include "torch_xla/csrc/helpers.h"
+#include "torch_xla/csrc/layout_manager.h"
 #include "torch_xla/csrc/ops/device_data.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
 #include "torch_xla/csrc/runtime/runtime.h"
@@ -29,6 +33,7 @@
 #include "xla/service/hlo_verifier.h"
 #include "xla/service/sharding_propagation.h"
 #include "xla/service/spmd/spmd_partitioner.h"
+#include "xla/shape_util.h"
 #include "xla/xla.pb.h"
 #include "xla_sharding_util.h"
 
@@ -181,6 +186,25 @@ std::vector<int64_t> ParseStringToIntVector(const std::string& str) {
   return result;
 }
 
+// The shardings of the parameters of a partitioned module, one per
+// parameter even if the module takes them as a tuple.
+std::vector<xla::OpSharding> GetModuleParameterShardings(
+    const xla::HloModuleProto& module) {
+  std::vector<xla::OpSharding> shardings;
+  if (module.spmd_parameters_shardings().size() == 1 &&
+      module.spmd_parameters_shardings()[0].type() == xla::OpSharding::TUPLE) {
+    auto tuple_shardings =
+        module.spmd_parameters_shardings()[0].tuple_shardings();
+    shardings = std::vector<xla::OpSharding>(tuple_shardings.begin(),
+                                             tuple_shardings.end());
+  } else {
+    for (auto sharding : module.spmd_parameters_shardings()) {
+      shardings.push_back(sharding);
+    }
+  }
+  return shardings;
+}
+
 }  // namespace
 
 bool ShardingUtil::SetHloSharding(LoweringContext* lowering_ctx) {
@@ -310,12 +334,12 @@ std::vector<int64_t> ShardingUtil::GetShardShape(
     return globalShape;
   } else if (sharding.type() == xla::OpSharding::OTHER) {
     auto tile_shape = sharding.tile_assignment_dimensions();
+    XLA_CHECK_GE(tile_shape.size(), global_shape.size());
     // `shard_shape[j]` is the size of dimension `j` in the resulting shard.
+    // The tile dimensions past the tensor rank are the replicated ones (the
+    // last tile dimension or the `last_tile_dims`).
     std::vector<int64_t> shard_shape;
-    for (int j = 0; j < tile_shape.size(); j++) {
-      if (sharding.replicate_on_last_tile_dim() && j == tile_shape.size() - 1) {
-        continue;
-      }
+    for (int j = 0; j < global_shape.size(); j++) {
       shard_shape.push_back(global_shape[j] / tile_shape[j] +
                             (global_shape[j] % tile_shape[j] != 0));
     }
@@ -348,6 +372,75 @@ ShardingUtil::GetShardIndicesForMinibatchTensor(
   return shard_indices;
 }
 
+std::vector<ShardingUtil::ShardRegion> ShardingUtil::GetShardRegionsForDevices(
+    const std::vector<int64_t>& shard_shape,
+    const std::vector<int64_t>& tensor_shape, const xla::OpSharding& sharding,
+    const std::vector<std::string>& devices) {
+  XLA_CHECK(sharding.type() == xla::OpSharding::OTHER)
+      << "Unsupported OpSharding type " << sharding.type();
+  std::vector<int64_t> tile_shape(sharding.tile_assignment_dimensions().begin(),
+                                  sharding.tile_assignment_dimensions().end());
+  size_t rank = tensor_shape.size();
+  size_t replicated_dims = (sharding.replicate_on_last_tile_dim() ? 1 : 0) +
+                           sharding.last_tile_dims_size();
+  XLA_CHECK_EQ(tile_shape.size(), rank + replicated_dims)
+      << "The tile assignment rank does not match the tensor rank " << rank;
+  XLA_CHECK_EQ(shard_shape.size(), rank);
+
+  std::vector<ShardRegion> regions(devices.size());
+  std::unordered_map<int, int> device_index = build_index_map(devices);
+  auto add_region = [&](int64_t core, absl::Span<const int64_t> coords) {
+    auto it = device_index.find(core);
+    if (it == device_index.end()) {
+      // Skip any shards whose device is not part of the `devices` list.
+      return;
+    }
+    ShardRegion& region = regions[it->second];
+    region.starts.resize(rank);
+    region.sizes.resize(rank);
+    for (size_t j = 0; j < rank; ++j) {
+      // Clamp the bounds to the tensor shape to accurately reflect the shard
+      // size without padding.
+      int64_t start = std::min(coords[j] * shard_shape[j], tensor_shape[j]);
+      int64_t end = std::min(start + shard_shape[j], tensor_shape[j]);
+      region.starts[j] = start;
+      region.sizes[j] = end - start;
+    }
+    // The shards only differing in the replicated tile dimensions hold the
+    // same data, their replica id is their index within the replication group.
+    region.replica_id = 0;
+    for (size_t j = rank; j < tile_shape.size(); ++j) {
+      region.replica_id = region.replica_id * tile_shape[j] + coords[j];
+    }
+  };
+
+  // The tile assignment is walked in row-major order, maintaining the tile
+  // coordinates of the current device rather than solving for them.
+  absl::InlinedVector<int64_t, 6> coords(tile_shape.size(), 0);
+  auto next_coords = [&]() {
+    for (int64_t j = static_cast<int64_t>(coords.size()) - 1; j >= 0; --j) {
+      if (++coords[j] < tile_shape[j]) {
+        return;
+      }
+      coords[j] = 0;
+    }
+  };
+  if (!sharding.iota_reshape_dims().empty()) {
+    xla::TileAssignment tile_assignment(sharding.tile_assignment_dimensions(),
+                                        sharding.iota_reshape_dims(),
+                                        sharding.iota_transpose_perm());
+    tile_assignment.Each([&](absl::Span<const int64_t> index, int64_t core) {
+      add_region(core, index);
+    });
+  } else {
+    for (int64_t core : sharding.tile_assignment_devices()) {
+      add_region(core, coords);
+      next_coords();
+    }
+  }
+  return regions;
+}
+
 std::vector<std::pair<int, std::vector<at::indexing::TensorIndex>>>
 ShardingUtil::GetShardReplicaAndIndicesForDevices(
     const std::vector<int64_t>& shard_shape,
@@ -362,7 +455,6 @@ ShardingUtil::GetShardReplicaAndIndicesForDevices(
   // dimensions.
   std::vector<std::pair<int, std::vector<TensorIndex>>> shard_indices(
       devices.size());
-  auto tile_shape = sharding.tile_assignment_dimensions();
   if (sharding.type() == xla::OpSharding::REPLICATED ||
       sharding.type() == xla::OpSharding::UNKNOWN) {
     // Use Ellipsis to indicate all dimensions are replicated
@@ -373,59 +465,16 @@ ShardingUtil::GetShardReplicaAndIndicesForDevices(
       shard_indices[i] = std::make_pair(global_ordinal, indices);
     }
   } else if (sharding.type() == xla::OpSharding::OTHER) {
-    auto device_index = build_index_map(devices);
-    std::vector<int64_t> tile_assignment_devices(
-        sharding.tile_assignment_devices().begin(),
-        sharding.tile_assignment_devices().end());
-    if (!sharding.iota_reshape_dims().empty()) {
-      auto tileAssignment = xla::TileAssignment(
-          sharding.tile_assignment_dimensions(), sharding.iota_reshape_dims(),
-          sharding.iota_transpose_perm());
-      tile_assignment_devices = std::vector<int64_t>(
-          tileAssignment.array().begin(), tileAssignment.array().end());
-    }
-    for (size_t i = 0; i < tile_assignment_devices.size(); i++) {
-      int64_t core = tile_assignment_devices[i];
-      if (device_index.find(core) == device_index.end()) {
-        // Skip any shards whose device is not part of the `devices` list.
-        continue;
-      }
-
-      // The replica id for this shard. This value is only updated from 0 if
-      // the sharding is partially replicated.
-      int replica_id = 0;
-
-      // Given the shard's row-major index `i`, we need to calculate shard's
-      // coordinates (n_0, ..., n_d) in the tiling to generate the index
-      // slices. Using `N_j = tile_shape[j]` and `0 <= n_j < N_j`, the
-      // following equation needs to be solved for all n_j:
-      //            `i = n_d + N_d * (n_{d-1} + N_{d-1} * (... + (N_1 *
-      //            n_0)))`
-      // Let `offset_j = n_j + N_j * (n_{j-1} + N_{j-1} * (... + (N_1 *
-      // n_0)))`. Then `offset_d = i`, `n_j = offset_j % N_j`, and
-      // `offset_{j-1} = offset_j / N_j`.
-      int offset = i;
+    std::vector<ShardRegion> regions =
+        GetShardRegionsForDevices(shard_shape, tensor_shape, sharding, devices);
+    for (size_t i = 0; i < regions.size(); ++i) {
       std::vector<TensorIndex> indices;
-      for (int j = tile_shape.size() - 1; j >= 0; j--) {
-        int64_t n_j = offset % tile_shape[j];
-        if (sharding.replicate_on_last_tile_dim() &&
-            j == tile_shape.size() - 1) {
-          // the last tile assignment dimension is replicated, which implies
-          // that the consecutive `tile_shape[j]` devices hold the replicated.
-          replica_id = n_j;
-          offset /= tile_shape[j];
-          continue;
-        }
-        // Clamp the slice bounds to the tensor shape to accurately reflect
-        // the shard size without padding.
-        int start = std::min(n_j * shard_shape[j], tensor_shape[j]);
-        int end = std::min((n_j + 1) * shard_shape[j], tensor_shape[j]);
-        auto slice = Slice(start, end);
-        indices.push_back(TensorIndex(slice));
-        offset /= tile_shape[j];
+      indices.reserve(regions[i].starts.size());
+      for (size_t j = 0; j < regions[i].starts.size(); ++j) {
+        indices.push_back(TensorIndex(Slice(
+            regions[i].starts[j], regions[i].starts[j] + regions[i].sizes[j])));
       }
-      std::reverse(indices.begin(), indices.end());
-      shard_indices[device_index[core]] = std::make_pair(replica_id, indices);
+      shard_indices[i] = std::make_pair(regions[i].replica_id, indices);
     }
   } else {
     XLA_CHECK(false) << "Unsupported OpSharding type " << sharding.type();
@@ -433,6 +482,58 @@ ShardingUtil::GetShardReplicaAndIndicesForDevices(
   return shard_indices;
 }
 
+namespace {
+
+bool IsReplicatedSharding(const XLATensor::ShardingSpecPtr& shardings) {
+  return shardings == nullptr ||
+         shardings->sharding.type() == xla::OpSharding::REPLICATED ||
+         shardings->sharding.type() == xla::OpSharding::UNKNOWN;
+}
+
+// Returns the regions of the shards of the tensor which belong on `devices`,
+// for a tiled sharding.
+std::vector<ShardingUtil::ShardRegion> GetShardRegions(
+    const at::Tensor& tensor, const XLATensor::ShardingSpecPtr& shardings,
+    const std::vector<int64_t>& shard_shape,
+    const std::vector<std::string>& devices) {
+  std::vector<int64_t> tensor_shape = tensor.sizes().vec();
+  if (!shardings->minibatch) {
+    return ShardingUtil::GetShardRegionsForDevices(
+        shard_shape, tensor_shape, shardings->sharding, devices);
+  }
+  // The local tensor is the concatenation of the batches of `devices`, along
+  // its first dimension.
+  XLA_CHECK_EQ(shard_shape.size(), tensor_shape.size());
+  std::vector<ShardingUtil::ShardRegion> regions(devices.size());
+  for (size_t i = 0; i < devices.size(); ++i) {
+    ShardingUtil::ShardRegion& region = regions[i];
+    for (size_t j = 0; j < tensor_shape.size(); ++j) {
+      int64_t start =
+          j == 0 ? std::min(static_cast<int64_t>(i) * shard_shape[0],
+                            tensor_shape[0])
+                 : 0;
+      region.starts.push_back(start);
+      region.sizes.push_back(
+          std::min(start + shard_shape[j], tensor_shape[j]) - start);
+    }
+  }
+  return regions;
+}
+
+// Returns the view of the tensor covering the region.
+at::Tensor ShardRegionView(const at::Tensor& tensor,
+                           const ShardingUtil::ShardRegion& region) {
+  int64_t storage_offset = tensor.storage_offset();
+  for (size_t j = 0; j < region.starts.size(); ++j) {
+    storage_offset += region.starts[j] * tensor.stride(j);
+  }
+  return tensor.as_strided(
+      c10::IntArrayRef(region.sizes.data(), region.sizes.size()),
+      tensor.strides(), storage_offset);
+}
+
+}  // namespace
+
 std::vector<at::Tensor> ShardingUtil::ShardTensor(
     const at::Tensor& tensor, const XLATensor::ShardingSpecPtr shardings,
     const std::vector<std::string>& devices, bool padded) {
@@ -444,33 +545,17 @@ std::vector<at::Tensor> ShardingUtil::ShardTensor(
   }
   TF_VLOG(5) << "ShardTensor with sharding type(" << sharding.type()
              << ")... and minibatch = " << minibatch << std::endl;
-  auto device_index = build_index_map(devices);
   std::vector<at::Tensor> shards(devices.size());
-  if (shardings == nullptr || sharding.type() == xla::OpSharding::REPLICATED ||
-      sharding.type() == xla::OpSharding::UNKNOWN) {
+  if (IsReplicatedSharding(shardings)) {
     std::fill_n(shards.begin(), shards.size(), tensor);
   } else if (sharding.type() == xla::OpSharding::OTHER) {
-    XLA_CHECK(sharding.tile_shape().dimensions_size() <= 2);
-    XLA_CHECK(tensor.sizes().size() >= sharding.tile_shape().dimensions_size());
-
     auto shard_shape = GetShardShape(shardings);
+    std::vector<ShardRegion> regions =
+        GetShardRegions(tensor, shardings, shard_shape, devices);
 
-    std::vector<std::vector<at::indexing::TensorIndex>> shard_indices;
-    if (minibatch) {
-      shard_indices = GetShardIndicesForMinibatchTensor(shard_shape, devices);
-    } else {
-      auto replica_and_indices = GetShardReplicaAndIndicesForDevices(
-          shard_shape, tensor.sizes().vec(), sharding, devices);
-      // Extract only the indices, the replica_id is unnecessary for sharding.
-      std::transform(replica_and_indices.begin(), replica_and_indices.end(),
-                     std::back_inserter(shard_indices),
-                     [](auto& pair) { return pair.second; });
-    }
-
-    for (size_t i = 0; i < shard_indices.size(); i++) {
-      at::Tensor shard = tensor.index(
-          c10::ArrayRef<at::indexing::TensorIndex>(shard_indices[i]));
-      shards[i] = shard.contiguous(at::MemoryFormat::Contiguous);
+    for (size_t i = 0; i < regions.size(); i++) {
+      shards[i] = ShardRegionView(tensor, regions[i])
+                      .contiguous(at::MemoryFormat::Contiguous);
     }
     // Zero-pad to the right to ensure the sizes are even
     if (shards.size() > 0 && padded) {
@@ -493,6 +578,88 @@ std::vector<at::Tensor> ShardingUtil::ShardTensor(
   return shards;
 }
 
+std::vector<std::shared_ptr<const runtime::TensorSource>>
+ShardingUtil::ShardTensorToSources(const at::Tensor& tensor,
+                                   const XLATensor::ShardingSpecPtr& shardings,
+                                   const std::vector<std::string>& devices) {
+  tsl::profiler::TraceMe activity("ShardingUtil::ShardTensorToSources",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  TORCH_LAZY_TIMED("ShardTensorToSources");
+  std::vector<std::shared_ptr<const runtime::TensorSource>> sources;
+  if (devices.empty()) {
+    return sources;
+  }
+  torch::lazy::BackendDevice first_device = ParseDeviceString(devices[0]);
+  xla::PrimitiveType element_type =
+      MakeXlaPrimitiveType(tensor.scalar_type(), &first_device);
+  runtime::HostBufferPool* staging_pool =
+      runtime::GetComputationClient()->GetHostBufferPool();
+  if (!tensor.device().is_cpu() ||
+      TorchTypeFromXlaType(element_type) != tensor.scalar_type()) {
+    // The shards have to be converted, which the sharded copies do.
+    TORCH_LAZY_COUNTER("ShardTensorConverted", 1);
+    if (IsReplicatedSharding(shardings)) {
+      // The tensor is only converted once, for all the devices.
+      auto source = std::make_shared<runtime::AtenSource>(
+          tensor, CreateComputationShapeFromTensor(tensor, &first_device),
+          devices[0], staging_pool);
+      sources.push_back(source);
+      for (size_t i = 1; i < devices.size(); ++i) {
+        sources.push_back(
+            std::make_shared<runtime::AtenSource>(*source, devices[i]));
+      }
+      return sources;
+    }
+    std::vector<at::Tensor> shards =
+        ShardTensor(tensor, shardings, devices, /*padded=*/true);
+    for (size_t i = 0; i < shards.size(); ++i) {
+      torch::lazy::BackendDevice device = ParseDeviceString(devices[i]);
+      sources.push_back(std::make_shared<runtime::AtenSource>(
+          shards[i], CreateComputationShapeFromTensor(shards[i], &device),
+          devices[i], staging_pool));
+    }
+    return sources;
+  }
+
+  XlaDeviceType hw_type = static_cast<XlaDeviceType>(first_device.type());
+  if (IsReplicatedSharding(shardings)) {
+    // All the devices share the data of a single source.
+    auto source = std::make_shared<runtime::StridedSource>(
+        tensor,
+        MakeArrayShapeFromDimensions(XlaHelpers::I64List(tensor.sizes()),
+                                     /*dynamic_dimensions=*/{}, element_type,
+                                     hw_type),
+        devices[0], staging_pool);
+    sources.push_back(source);
+    for (size_t i = 1; i < devices.size(); ++i) {
+      sources.push_back(
+          std::make_shared<runtime::StridedSource>(*source, devices[i]));
+    }
+    return sources;
+  }
+
+  std::vector<int64_t> shard_shape = GetShardShape(shardings);
+  std::vector<ShardRegion> regions =
+      GetShardRegions(tensor, shardings, shard_shape, devices);
+  xla::Shape shape = MakeArrayShapeFromDimensions(
+      shard_shape, /*dynamic_dimensions=*/{}, element_type, hw_type);
+  // The shards are views of the tensor, which only the padded shards (or all
+  // of them without XLA_ZERO_COPY_HOST_TO_DEVICE) copy. The copies of the
+  // devices run in parallel.
+  sources.resize(regions.size());
+  auto shard_fn = [&](size_t i) {
+    sources[i] = std::make_shared<runtime::StridedSource>(
+        ShardRegionView(tensor, regions[i]), shape, devices[i], staging_pool);
+  };
+  thread::ParallelFor(regions.size(), /*grain=*/1,
+                      [&](int64_t begin, int64_t end) {
+                        for (int64_t i = begin; i < end; ++i) {
+                          shard_fn(i);
+                        }
+                      });
+  return sources;
+}
+
 std::vector<XLATensor::ShardingSpecPtr> ShardingUtil::GetOutputSharding(
     const std::vector<xla::Shape>& output_shapes,
     runtime::ComputationClient::ComputationPtr computation) {
@@ -551,24 +718,32 @@ void ShardingUtil::PrepareOutputShardingPropagation(
     runtime::ComputationClient::ComputationPtr computation,
     std::vector<torch::lazy::BackendDataPtr>* data_placeholders,
     std::vector<XLATensor::ShardingSpecPtr>* sharding_specs) {
-  // Resizes the containers to `indices.size()`.
-  data_placeholders->resize(indices.size());
-  sharding_specs->resize(indices.size());
-
   std::vector<xla::Shape> output_shapes;
   output_shapes.reserve(indices.size());
   for (int i = 0; i < indices.size(); ++i) {
     auto xtensor = (*tensors)[indices[i]];
     output_shapes.push_back(xtensor->shape().get());
   }
-  auto new_sharding_specs = GetOutputSharding(output_shapes, computation);
-  XLA_CHECK(indices.size() == new_sharding_specs.size())
+  PrepareOutputShardingPropagation(
+      tensors, indices, GetOutputSharding(output_shapes, computation),
+      data_placeholders, sharding_specs);
+}
+
+void ShardingUtil::PrepareOutputShardingPropagation(
+    std::vector<XLATensorPtr>* tensors, absl::Span<const size_t> indices,
+    const std::vector<XLATensor::ShardingSpecPtr>& output_sharding_specs,
+    std::vector<torch::lazy::BackendDataPtr>* data_placeholders,
+    std::vector<XLATensor::ShardingSpecPtr>* sharding_specs) {
+  XLA_CHECK(indices.size() == output_sharding_specs.size())
       << "Expected size: " << indices.size()
-      << ", actual size: " << new_sharding_specs.size();
+      << ", actual size: " << output_sharding_specs.size();
+  // Resizes the containers to `indices.size()`.
+  data_placeholders->resize(indices.size());
+  sharding_specs->resize(indices.size());
 
   for (int i = 0; i < indices.size(); ++i) {
     auto xtensor = (*tensors)[indices[i]];
-    (*sharding_specs)[i] = new_sharding_specs[i];
+    (*sharding_specs)[i] = output_sharding_specs[i];
     // Allow overwriting the sharding specs, since output sharding propagation
     // happens after any resharding that might have already taken place during
     // auto-sharding pass.
@@ -599,6 +774,23 @@ runtime::ComputationClient::DataPtr ShardingUtil::CreateShardedData(
   XLA_CHECK(local_shards.size() == devices.size())
       << "A device must be speficied for each shard";
   std::vector<std::shared_ptr<const runtime::TensorSource>> source_tensors;
+  runtime::HostBufferPool* staging_pool =
+      runtime::GetComputationClient()->GetHostBufferPool();
+  for (int64_t j = 0; j < devices.size(); ++j) {
+    auto shard_device = ParseDeviceString(devices[j]);
+    auto shard_shape =
+        CreateComputationShapeFromTensor(local_shards[j], &shard_device);
+    source_tensors.push_back(std::make_shared<runtime::AtenSource>(
+        local_shards[j], shard_shape, devices[j], staging_pool));
+  }
+  return CreateShardedData(source_tensors, sharding_spec);
+}
+
+runtime::ComputationClient::DataPtr ShardingUtil::CreateShardedData(
+    const std::vector<std::shared_ptr<const runtime::TensorSource>>&
+        source_tensors,
+    const XLATensor::ShardingSpecPtr& sharding_spec) {
+  XLA_CHECK(!source_tensors.empty()) << "No shard to transfer";
   xla::Shape global_shape;
   xla::OpSharding sharding;
   if (sharding_spec == nullptr) {
@@ -610,30 +802,70 @@ runtime::ComputationClient::DataPtr ShardingUtil::CreateShardedData(
                    ? xla::HloSharding::Unknown().ToProto()
                    : xla::HloSharding::Replicate().ToProto();
     // if replicated, global_shape is shape of the tensor.
-    auto first_device = ParseDeviceString(devices[0]);
-    global_shape =
-        CreateComputationShapeFromTensor(local_shards[0], &first_device);
+    global_shape = source_tensors[0]->shape();
   } else {
     global_shape = sharding_spec->shape;
     sharding = sharding_spec->sharding;
   }
-  for (int64_t j = 0; j < devices.size(); ++j) {
-    auto shard_device = ParseDeviceString(devices[j]);
-    auto shard_shape =
-        CreateComputationShapeFromTensor(local_shards[j], &shard_device);
-    source_tensors.push_back(std::make_shared<runtime::AtenSource>(
-        local_shards[j], shard_shape, devices[j]));
-  }
   return runtime::GetComputationClient()->TransferShardsToDevice(
       source_tensors, GetVirtualDevice().toString(), global_shape, sharding);
 }
 
+namespace {
+
+// The slice index of every device, by global ordinal, all 0 on a single slice.
+const std::vector<int64_t>& GetDeviceSliceIndices() {
+  static const std::vector<int64_t> slice_indices = []() {
+    runtime::ComputationClient* client = runtime::GetComputationClient();
+    std::vector<std::string> devices = client->GetAllDevices();
+    std::vector<int64_t> slices(devices.size(), 0);
+    for (const std::string& device : devices) {
+      int64_t ordinal = ParseDeviceString(device).ordinal();
+      const auto& attributes = client->GetDeviceAttributes(device);
+      auto it = attributes.find("slice_index");
+      if (it == attributes.end() || ordinal >= slices.size()) {
+        continue;
+      }
+      if (const int64_t* slice = std::get_if<int64_t>(&it->second)) {
+        slices[ordinal] = *slice;
+      }
+    }
+    return slices;
+  }();
+  return slice_indices;
+}
+
+}  // namespace
+
+int64_t ShardingUtil::GetNumSlices() {
+  const std::vector<int64_t>& slices = GetDeviceSliceIndices();
+  return std::max<int64_t>(
+      std::unordered_set<int64_t>(slices.begin(), slices.end()).size(), 1);
+}
+
+std::vector<int64_t> ShardingUtil::GetSliceMajorDeviceIds() {
+  const std::vector<int64_t>& slices = GetDeviceSliceIndices();
+  std::vector<int64_t> device_ids(slices.size());
+  std::iota(device_ids.begin(), device_ids.end(), 0);
+  std::stable_sort(device_ids.begin(), device_ids.end(),
+                   [&](int64_t a, int64_t b) { return slices[a] < slices[b]; });
+  return device_ids;
+}
+
 std::vector<int64_t> ShardingUtil::GetAutoShardingMesh() {
   // Auto-sharding uses mesh_shape = {n_devices, 1} if XLA_AUTO_SPMD_MESH
-  // is not set. XLA_AUTO_SPMD_MESH takes a form of string, "2,2" which
-  // corresponds to a 2-by-2 mesh.
+  // is not set, or {n_slices, n_devices / n_slices} over several slices, so
+  // that only the outer axis goes over DCN. XLA_AUTO_SPMD_MESH takes a form of
+  // string, "2,2" which corresponds to a 2-by-2 mesh.
   std::vector<int64_t> mesh_shape = ParseStringToIntVector(
       runtime::sys_util::GetEnvString("XLA_AUTO_SPMD_MESH", ""));
+  int64_t num_slices = GetNumSlices();
+  if (mesh_shape.empty() && num_slices > 1 &&
+      !runtime::sys_util::GetEnvBool("XLA_AUTO_SPMD_MESH_EXPLORE", false)) {
+    int64_t num_devices =
+        runtime::GetComputationClient()->GetAllDevices().size();
+    mesh_shape = {num_slices, num_devices / num_slices};
+  }
   if (!mesh_shape.empty()) {
     int64_t total_devices = 1;
     for (auto i : mesh_shape) {
@@ -647,6 +879,37 @@ std::vector<int64_t> ShardingUtil::GetAutoShardingMesh() {
   return mesh_shape;
 }
 
+std::vector<std::vector<int64_t>>
+ShardingUtil::GetAutoShardingMeshCandidates() {
+  std::vector<std::vector<int64_t>> candidates;
+  if (!runtime::sys_util::GetEnvBool("XLA_AUTO_SPMD_MESH_EXPLORE", false) ||
+      !GetAutoShardingMesh().empty()) {
+    return candidates;
+  }
+  int64_t num_devices = runtime::GetComputationClient()->GetAllDevices().size();
+  int64_t num_slices = GetNumSlices();
+  if (num_slices > 1) {
+    // The inner axis stays within the slices, over ICI, and the outer one
+    // spans them, so the meshes are no longer equivalent when transposed.
+    int64_t slice_devices = num_devices / num_slices;
+    for (int64_t k = 1; k <= slice_devices; ++k) {
+      if (slice_devices % k == 0) {
+        candidates.push_back({num_devices / k, k});
+      }
+    }
+  } else {
+    for (int64_t k = 1; k * k <= num_devices; ++k) {
+      if (num_devices % k == 0) {
+        candidates.push_back({num_devices / k, k});
+      }
+    }
+  }
+  if (candidates.size() < 2) {
+    candidates.clear();
+  }
+  return candidates;
+}
+
 std::vector<int64_t> ShardingUtil::GetAutoShardingMeshIds(
     const xla::HloModuleProto& module) {
   // Return the first non-default (iota) mesh ids arrangement, as we expect
@@ -677,8 +940,48 @@ std::vector<int64_t> ShardingUtil::GetAutoShardingMeshIds(
       }
     }
   }
-  // return the default (iota) device assignments.
-  return device_mesh_ids;
+  // return the default device assignments, iota on a single slice and slice
+  // major otherwise.
+  return GetNumSlices() > 1 ? GetSliceMajorDeviceIds() : device_mesh_ids;
+}
+
+size_t ShardingUtil::CountPartitionedAliases(
+    const xla::HloModuleProto& module) {
+  std::vector<xla::OpSharding> parameter_shardings =
+      GetModuleParameterShardings(module);
+  const xla::OpSharding& output_sharding = module.spmd_output_sharding();
+  xla::ProgramShape program_shape(module.host_program_shape());
+  size_t count = 0;
+  for (const auto& entry : module.input_output_alias().entries()) {
+    int64_t parameter = entry.parameter_number();
+    xla::ShapeIndex output_index(entry.output_shape_index().begin(),
+                                 entry.output_shape_index().end());
+    xla::ShapeIndex parameter_index(entry.parameter_shape_index().begin(),
+                                    entry.parameter_shape_index().end());
+    if (parameter >= program_shape.parameters_size() ||
+        !xla::ShapeUtil::IndexIsValid(program_shape.result(), output_index) ||
+        !xla::ShapeUtil::IndexIsValid(program_shape.parameters(parameter),
+                                      parameter_index)) {
+      continue;
+    }
+    if (!xla::ShapeUtil::Equal(
+            xla::ShapeUtil::GetSubshape(program_shape.parameters(parameter),
+                                        parameter_index),
+            xla::ShapeUtil::GetSubshape(program_shape.result(),
+                                        output_index))) {
+      continue;
+    }
+    if (parameter < parameter_shardings.size() && output_index.size() == 1 &&
+        output_sharding.type() == xla::OpSharding::TUPLE &&
+        output_index[0] < output_sharding.tuple_shardings_size() &&
+        !xla::protobuf_util::ProtobufEquals(
+            parameter_shardings[parameter],
+            output_sharding.tuple_shardings(output_index[0]))) {
+      continue;
+    }
+    ++count;
+  }
+  return count;
 }
 
 void ShardingUtil::ReshardParameters(
@@ -686,18 +989,8 @@ void ShardingUtil::ReshardParameters(
     std::vector<torch::lazy::BackendDataPtr>* parameters,
     std::vector<const torch::lazy::Node*>* nodes) {
   // Extract input shardings generated from auto-sharding pass.
-  std::vector<xla::OpSharding> input_shardings;
-  if (module.spmd_parameters_shardings().size() == 1 &&
-      module.spmd_parameters_shardings()[0].type() == xla::OpSharding::TUPLE) {
-    auto tuple_shardings =
-        module.spmd_parameters_shardings()[0].tuple_shardings();
-    input_shardings = std::vector<xla::OpSharding>(tuple_shardings.begin(),
-                                                   tuple_shardings.end());
-  } else {
-    for (auto sharding : module.spmd_parameters_shardings()) {
-      input_shardings.push_back(sharding);
-    }
-  }
+  std::vector<xla::OpSharding> input_shardings =
+      GetModuleParameterShardings(module);
   if (input_shardings.size() == 0) {
     TF_VLOG(3) << "ReshardParamters... skip with empty input_shardings.";
     return;
@@ -5,6 +5,7 @@
 
 #include <tuple>
 
+#include "absl/container/inlined_vector.h"
 #include "torch_xla/csrc/ir.h"
 #include "torch_xla/csrc/lowering_context.h"
 #include "torch_xla/csrc/runtime/computation_client.h"
@@ -58,6 +59,25 @@ class ShardingUtil {
   static std::vector<int64_t> GetShardShape(
       const XLATensor::ShardingSpecPtr shardings);
 
+  // The region of a tensor held by a shard, as the start offset and the size
+  // of each dimension. The sizes are clamped to the tensor shape, so they do
+  // not include the padding of the uneven shards.
+  struct ShardRegion {
+    // The index of the shard among the shards holding the same data.
+    int64_t replica_id = 0;
+    absl::InlinedVector<int64_t, 6> starts;
+    absl::InlinedVector<int64_t, 6> sizes;
+  };
+
+  // Returns the regions of the shards which belong on `devices`, in the order
+  // of `devices`, for an `OTHER` (tiled) sharding of any rank. The sharding
+  // can be partially replicated on its last tile dimension or over its
+  // `last_tile_dims`.
+  static std::vector<ShardRegion> GetShardRegionsForDevices(
+      const std::vector<int64_t>& shard_shape,
+      const std::vector<int64_t>& tensor_shape, const xla::OpSharding& sharding,
+      const std::vector<std::string>& devices);
+
   // Uses the provided `sharding` spec and expected shard shape to determine the
   // index slices for the shards which belong on `devices`. Only supports
   // `REPLICATED` and `OTHER` sharding types.
@@ -90,6 +110,16 @@ class ShardingUtil {
       const at::Tensor& tensor, const XLATensor::ShardingSpecPtr shardings,
       const std::vector<std::string>& devices, bool padded = true);
 
+  // Shards a tensor into padded shards as ShardTensor does, and returns the
+  // sources to transfer them to `devices`. The shards of a CPU tensor which
+  // needs no type conversion are regions of its storage (see
+  // runtime::StridedSource), prepared in parallel, and the replicas of a
+  // replicated tensor share the same data.
+  static std::vector<std::shared_ptr<const runtime::TensorSource>>
+  ShardTensorToSources(const at::Tensor& tensor,
+                       const XLATensor::ShardingSpecPtr& shardings,
+                       const std::vector<std::string>& devices);
+
   // Retrieve output sharding of a given XLA computation. ShardingSpec::shape
   // is always on virtual SPMD device.
   static std::vector<XLATensor::ShardingSpecPtr> GetOutputSharding(
@@ -113,6 +143,14 @@ class ShardingUtil {
       std::vector<torch::lazy::BackendDataPtr>* data_placeholders,
       std::vector<XLATensor::ShardingSpecPtr>* sharding_specs);
 
+  // Same as above, from the `output_sharding_specs` GetOutputSharding returned
+  // for the computation, eg. on its first execution.
+  static void PrepareOutputShardingPropagation(
+      std::vector<XLATensorPtr>* tensors, absl::Span<const size_t> indices,
+      const std::vector<XLATensor::ShardingSpecPtr>& output_sharding_specs,
+      std::vector<torch::lazy::BackendDataPtr>* data_placeholders,
+      std::vector<XLATensor::ShardingSpecPtr>* sharding_specs);
+
   // Transfers the individual shards to the devices and returns a DataPtr for
   // the PjRtShardedData wrapping the shards.
   static runtime::ComputationClient::DataPtr CreateShardedData(
@@ -120,14 +158,34 @@ class ShardingUtil {
       const std::vector<std::string>& devices,
       const XLATensor::ShardingSpecPtr& sharding_spec);
 
+  // Same as above, for shards already given as sources of their devices.
+  static runtime::ComputationClient::DataPtr CreateShardedData(
+      const std::vector<std::shared_ptr<const runtime::TensorSource>>&
+          source_tensors,
+      const XLATensor::ShardingSpecPtr& sharding_spec);
+
   static void XlaMarkSharding(const at::Tensor& input,
                               xla::OpSharding sharding);
 
   //////////////////////////// Auto-Sharding ////////////////////////////
 
+  // The number of slices of the devices, from their slice_index attribute.
+  // The slices are connected to each other over the data center network
+  // (DCN), much slower than the inter-chip interconnect (ICI) within them.
+  static int64_t GetNumSlices();
+  // The global device ordinals ordered by slice, then by ordinal.
+  static std::vector<int64_t> GetSliceMajorDeviceIds();
+
   // Construct a device mesh for auto-sharding pass. Returns a tuple of mesh
   // shape and device ids vectors.
   static std::vector<int64_t> GetAutoShardingMesh();
+  // The meshes to explore for the auto-sharding pass when
+  // XLA_AUTO_SPMD_MESH_EXPLORE is set and XLA_AUTO_SPMD_MESH is not: the 2D
+  // factorizations {n/k, k} of the device count n, with k <= n/k since
+  // transposed meshes are equivalent to the pass. Over several slices, k
+  // divides the devices of a slice instead, so that the inner axis stays
+  // within the slices. Empty otherwise, or if there is only one such mesh.
+  static std::vector<std::vector<int64_t>> GetAutoShardingMeshCandidates();
   static std::vector<int64_t> GetAutoShardingMeshIds(
       const xla::HloModuleProto& module);
 
@@ -142,6 +200,12 @@ class ShardingUtil {
       std::vector<torch::lazy::BackendDataPtr>* parameters,
       std::vector<const torch::lazy::Node*>* nodes);
 
+  // The number of parameters of the partitioned module which alias an output
+  // of the same per-shard shape and sharding, ie. whose buffer donation takes
+  // effect. The donors are only paired with outputs after partitioning, the
+  // unpartitioned shapes can match while the shards do not.
+  static size_t CountPartitionedAliases(const xla::HloModuleProto& module);
+
   static void SetAutoSharding();
   static bool GetAutoSharding();
 
@@ -0,0 +1,116 @@
+"""Reader of the binary graph dumps written with XLA_SAVE_TENSORS_FMT=binary.
+
+The layout is documented in torch_xla/csrc/ir_binary_dump.h. The file is mapped
+in memory and only the records being iterated are decoded, so large dumps can
+be scanned without loading them whole.
+"""
+
+import collections
+import mmap
+import struct
+
+_FILE_MAGIC = b'PTXLAIR\0'
+_VERSION = 1
+_RECORD_MAGIC = 0x52495850
+_GRAPH = 1
+_GRAPH_HASH = 2
+
+_FILE_HEADER = struct.Struct('<8sII')
+_RECORD_HEADER = struct.Struct('<IIQ')
+_GRAPH_HEADER = struct.Struct('<IIQQQQ')
+_NODE = struct.Struct('<QQIIIIIIII')
+_OPERAND = struct.Struct('<II')
+_HASH = struct.Struct('<QQ')
+
+Node = collections.namedtuple(
+    'Node', ['hash', 'op', 'shape', 'text', 'location', 'operands',
+             'num_outputs'])
+Node.__doc__ = """An IR node. The operands are (node index, output index)."""
+
+Graph = collections.namedtuple('Graph',
+                               ['name', 'frames', 'nodes', 'roots', 'hash'])
+Graph.__doc__ = """A graph, with the nodes in post order and the roots as node
+indices. The hash is None if the graph was not lowered after being dumped."""
+
+
+def _padded(size):
+  return (size + 7) & ~7
+
+
+def _hash(low, high):
+  return (high << 64) | low
+
+
+def _parse_graph(buf, offset):
+  name, frames, num_nodes, num_operands, num_roots, num_strings = (
+      _GRAPH_HEADER.unpack_from(buf, offset))
+  nodes_offset = offset + _GRAPH_HEADER.size
+  operands_offset = nodes_offset + num_nodes * _NODE.size
+  roots_offset = operands_offset + num_operands * _OPERAND.size
+  offsets_offset = roots_offset + _padded(num_roots * 4)
+  strings_offset = offsets_offset + (num_strings + 1) * 8
+
+  offsets = struct.unpack_from(f'<{num_strings + 1}Q', buf, offsets_offset)
+  strings = [
+      bytes(buf[strings_offset + offsets[i]:strings_offset +
+                offsets[i + 1]]).decode('utf-8', 'replace')
+      for i in range(num_strings)
+  ]
+  operands = list(_OPERAND.iter_unpack(buf[operands_offset:roots_offset]))
+  nodes = []
+  for i in range(num_nodes):
+    (low, high, op, shape, text, location, begin, count, num_outputs,
+     _) = _NODE.unpack_from(buf, nodes_offset + i * _NODE.size)
+    nodes.append(
+        Node(
+            hash=_hash(low, high),
+            op=strings[op],
+            shape=strings[shape],
+            text=strings[text],
+            location=strings[location],
+            operands=operands[begin:begin + count],
+            num_outputs=num_outputs))
+  roots = list(struct.unpack_from(f'<{num_roots}I', buf, roots_offset))
+  return Graph(
+      name=strings[name],
+      frames=strings[frames],
+      nodes=nodes,
+      roots=roots,
+      hash=None)
+
+
+def _records(buf):
+  magic, version, _ = _FILE_HEADER.unpack_from(buf, 0)
+  if magic != _FILE_MAGIC or version != _VERSION:
+    raise ValueError(f'Not a version {_VERSION} binary graph dump')
+  offset = _FILE_HEADER.size
+  while len(buf) - offset >= _RECORD_HEADER.size:
+    magic, kind, size = _RECORD_HEADER.unpack_from(buf, offset)
+    payload = offset + _RECORD_HEADER.size
+    # A truncated record is a dump still being written.
+    if magic != _RECORD_MAGIC or size > len(buf) - payload:
+      return
+    yield kind, payload
+    offset = payload + size
+
+
+def read_graphs(path):
+  """Yields the graphs of the binary dump at `path`, in dump order.
+
+  Args:
+    path (string): The path of the XLA_SAVE_TENSORS_FILE dump, including the
+      ordinal suffix if any.
+  """
+  with open(path, 'rb') as fd:
+    with mmap.mmap(fd.fileno(), 0, access=mmap.ACCESS_READ) as buf:
+      graph = None
+      for kind, offset in _records(buf):
+        if kind == _GRAPH:
+          if graph is not None:
+            yield graph
+          graph = _parse_graph(buf, offset)
+        elif kind == _GRAPH_HASH and graph is not None:
+          yield graph._replace(hash=_hash(*_HASH.unpack_from(buf, offset)))
+          graph = None
+      if graph is not None:
+        yield graph
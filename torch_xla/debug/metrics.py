@@ -1,3 +1,5 @@
+import json
+
 import torch_xla
 
 
@@ -46,6 +48,50 @@ def metric_data(name):
   return torch_xla._XLAC._xla_metric_data(name)
 
 
+def metric_histogram(name):
+  """Returns the log-linear histogram of all the samples of a metric.
+
+  Only the XLA runtime metrics listed in XLA_METRICS_HISTOGRAMS, like
+  `ExecuteTime`, have one.
+
+  Args:
+    name (string): The name of the metric whose histogram needs to be
+      retrieved.
+
+  Returns:
+    The list of the counts of the histogram buckets, to be passed to
+    `metric_percentiles()`, or None if the metric has no histogram.
+  """
+  return torch_xla._XLAC._xla_metric_histogram(name)
+
+
+def metric_percentiles(name, percentiles=(0.5, 0.99, 0.999), since=None):
+  """Returns the percentiles of the samples of a metric from its histogram.
+
+  Unlike the percentiles of `metrics_report()`, which are computed over the
+  recent samples kept by the metric, these are over all of its samples, within
+  about 1.6% of their values.
+
+  Args:
+    name (string): The name of the metric, which must have a
+      `metric_histogram()`.
+    percentiles (list): The percentiles to compute, in [0, 1].
+    since (list, optional): The counts returned by a previous
+      `metric_histogram()` call, to compute the percentiles of the samples
+      posted after it only.
+
+  Returns:
+    The list of the values of the percentiles.
+  """
+  counts = metric_histogram(name)
+  if counts is None:
+    raise RuntimeError(f'Metric {name} has no histogram, see '
+                       'XLA_METRICS_HISTOGRAMS')
+  if since is not None:
+    counts = [count - base for count, base in zip(counts, since)]
+  return torch_xla._XLAC._xla_histogram_percentiles(counts, list(percentiles))
+
+
 def clear_metrics():
   """Clear the value of all metrics.
   """
@@ -81,6 +127,142 @@ def short_metrics_report(counter_names: list = None, metric_names: list = None):
   return torch_xla._XLAC._short_xla_metrics_report(counter_names, metric_names)
 
 
+def open_metrics_report():
+  """Retrieves the metrics and counters report in the OpenMetrics text format.
+
+  Counters are exported as counters. The metrics of the XLA runtime are
+  exported as histograms of all their samples, with power of two buckets, and
+  as `<name>_recent` summaries of the percentiles of their recent samples. The
+  other metrics are only exported as summaries. All the names are prefixed with
+  `ptxla_`, and time metrics are in nanoseconds.
+  """
+  return torch_xla._XLAC._xla_open_metrics_report()
+
+
+def start_server(port):
+  """Starts serving `open_metrics_report()` over HTTP, at the `/metrics` path.
+
+  This lets metric scrapers (like Prometheus) collect the metrics without any
+  polling from Python.
+
+  Args:
+    port (int): The port to serve the metrics on, on all the interfaces.
+
+  Returns:
+    A `MetricsServer` instance dictating the lifecycle of the server. If this
+    object is garbage collected, the server is shut down.
+
+  Raises:
+    RuntimeError: Raised if the port is invalid or busy already.
+  """
+  return torch_xla._XLAC._xla_start_metrics_server(port)
+
+
+def step_timeline():
+  """Retrieves the host time breakdown of the last tensors syncs.
+
+  Only recorded when XLA_STEP_TIMELINE_SIZE is set to the number of syncs to
+  keep.
+
+  Returns:
+    A list of dicts, oldest sync first, with the sync `id`, its `start_ns`,
+    the `host_ns` spent by the calling thread, the `num_tensors` synced, the
+    `graph_hash`, whether it was a `cache_hit`, and the nanoseconds spent in
+    each stage of the sync in `stages_ns`.
+  """
+  return json.loads(step_timeline_json())
+
+
+def step_timeline_json():
+  """Retrieves the `step_timeline()` records as a JSON string."""
+  return torch_xla._XLAC._xla_step_timeline_json()
+
+
+def clear_step_timeline():
+  """Drops all the `step_timeline()` records."""
+  return torch_xla._XLAC._clear_xla_step_timeline()
+
+
+def shape_recompile_histogram():
+  """Retrieves how many times each graph structure has been compiled.
+
+  Graphs share a structure when they run the same sequence of operations,
+  whatever the shapes of their inputs. A structure compiled several times
+  is usually fed with varying input shapes, which padding them to a few
+  buckets (see `torch_xla.experimental.shape_bucketing`) avoids.
+
+  Returns:
+    A dict from graph structure hash to the number of compilations, with only
+    the structures compiled more than once.
+  """
+  compiles = torch_xla._XLAC._xla_graph_structure_compiles()
+  return {
+      structure: count for structure, count in compiles.items() if count > 1
+  }
+
+
+def compiled_memory_stats():
+  """Retrieves the device memory needed by each compiled graph.
+
+  The stats are estimated by the compiler, and recorded for every graph
+  compiled by this process, on the runtimes which report them. The graph hash
+  of an execution is the `graph_hash` of its `xm.last_execution_future()`,
+  which lets an out of memory error be attributed to the graph triggering it.
+
+  Returns:
+    A dict from graph hash to a dict of byte counts: `argument_bytes`,
+    `output_bytes`, `alias_bytes` (the outputs reusing donated arguments),
+    `temp_bytes`, `generated_code_bytes`, and `execution_bytes`, the memory an
+    execution needs on top of its arguments.
+  """
+  return torch_xla._XLAC._xla_compiled_memory_stats()
+
+
+def graph_stats():
+  """Retrieves the compilation and execution statistics of each graph.
+
+  This tells which of the compiled graphs a change of the global metrics (like
+  `ExecuteTime`) comes from. The same table is written at exit to
+  XLA_GRAPH_STATS_FILE when set.
+
+  Returns:
+    A dict from graph hash to a dict with the number of `compiles` and their
+    total `compile_ns`, the number of `executions` (and `failed_executions`),
+    their total, average and maximum time from dispatch to outputs ready
+    (`execute_ns`, `avg_execute_ns` and `max_execute_ns`), the
+    `argument_bytes` and `output_bytes` of the graph, the bytes of the
+    results of its collectives and the bytes each device moves for them
+    (`collective_bytes` and `collective_bus_bytes`) and, on the runtimes
+    reporting them, the `temp_bytes`, `alias_bytes`, `generated_code_bytes`
+    and `execution_bytes` of `compiled_memory_stats()`. The graphs taking the
+    most execution time come first.
+  """
+  return json.loads(torch_xla._XLAC._xla_graph_stats_json())
+
+
+def clear_graph_stats():
+  """Clears the statistics returned by `graph_stats()`."""
+  torch_xla._XLAC._clear_xla_graph_stats()
+
+
+def recompile_reports():
+  """Retrieves the reports explaining the recent recompilations.
+
+  Requires XLA_ANALYZE_RECOMPILES=1. Each report compares an uncached graph
+  with the closest previously compiled one, and names the first node which
+  differs along with the Python frame which created it.
+
+  Returns:
+    A list of report strings, oldest first.
+  """
+  return torch_xla._XLAC._xla_recompile_reports()
+
+
+def clear_recompile_reports():
+  """Clears the reports returned by `recompile_reports`."""
+  torch_xla._XLAC._clear_xla_recompile_reports()
+
+
 def executed_fallback_ops():
   """Retrieves a list of operations that were run in fallback mode."""
   return torch_xla._XLAC._get_executed_fallback_ops()
@@ -1,6 +1,8 @@
+import collections
 import itertools
 import threading
 import torch
+import torch.utils._pytree as pytree
 import torch_xla
 import torch_xla.debug.profiler as xp
 import torch_xla.utils.keyd_queue as kq
@@ -52,6 +54,13 @@ class PerDeviceLoader(object):
     return item
 
 
+def _assemble_local_shards(batch):
+  import torch_xla.distributed.spmd as xs
+  return xu.for_each_instance_rewrite(batch,
+                                      lambda x: isinstance(x, xs.LocalShards),
+                                      lambda x: x.to_global_tensor())
+
+
 class ParallelLoader(object):
   """Wraps an existing PyTorch DataLoader with background data upload.
 
@@ -75,8 +84,16 @@ class ParallelLoader(object):
       work in parallel to transfer data from loader queue to device queue.
       Default: 1
     input_sharding (ShardingSpec, optional): Sharding spec to apply to
-      compatible input tensors after loading.
+      compatible input tensors after loading. The `LocalShards` of the
+      samples are assembled into their global tensors instead, on the worker
+      threads, which overlaps the assembly with the previous steps.
       Default: None
+    native_transfer (bool, optional): Whether the batches are converted,
+      sharded and transferred by a native loader on the runtime threads,
+      without holding the GIL, instead of by Python worker threads. Up to
+      `device_prefetch_size` batches are then in flight or ready per device,
+      and `host_to_device_transfer_threads` is ignored.
+      Default: False
   """
 
   def __init__(self,
@@ -87,7 +104,8 @@ class ParallelLoader(object):
                loader_prefetch_size=8,
                device_prefetch_size=4,
                host_to_device_transfer_threads=1,
-               input_sharding=None):
+               input_sharding=None,
+               native_transfer=False):
     self._loader = loader
     self._devices = [torch.device(x) for x in devices]
     self._batchdim = batchdim
@@ -95,6 +113,17 @@ class ParallelLoader(object):
     self._done = False
     self._queues = dict()
     self._input_sharding = input_sharding
+    self._native_loaders = None
+    if native_transfer:
+      self._native_loaders = {
+          device: _NativeDeviceLoader(device, device_prefetch_size,
+                                      input_sharding)
+          for device in self._devices
+      }
+      thread = threading.Thread(target=self._native_loader_worker)
+      thread.daemon = True
+      thread.start()
+      return
     for device in self._devices:
       self._queues[device] = PerDeviceQueue(device, loader_prefetch_size,
                                             device_prefetch_size)
@@ -130,11 +159,16 @@ class ParallelLoader(object):
     return len(self._loader) // len(self._devices)
 
   def next_item(self, device):
+    if self._native_loaders is not None:
+      return self._native_loaders[device].get()
     dqueue = self._queues[device]
     return dqueue.queue.get()
 
   def close(self):
     self._done = True
+    if self._native_loaders is not None:
+      for loader in self._native_loaders.values():
+        loader.close()
     for dqueue in self._queues.values():
       dqueue.queue.close()
       dqueue.loader_queue.close()
@@ -160,6 +194,17 @@ class ParallelLoader(object):
     for dqueue in queues:
       dqueue.loader_queue.close_write()
 
+  def _native_loader_worker(self):
+    loaders = list(self._native_loaders.values())
+    for i, data in enumerate(self._loader):
+      if self._done:
+        break
+      # Waits out of the GIL while the device has enough batches prefetched.
+      if not loaders[i % len(loaders)].put(data):
+        break
+    for loader in loaders:
+      loader.close_write()
+
   def _get_batch(self, dqueue):
     batch = []
     while dqueue.queue.max_size() > len(batch):
@@ -175,6 +220,7 @@ class ParallelLoader(object):
       batch = self._get_batch(dqueue)
       if not batch:
         break
+      batch = _assemble_local_shards(batch)
       batch = xm.send_cpu_data_to_device(batch, device, self._input_sharding)
       for data in batch:
         dqueue.queue.put(data)
@@ -183,6 +229,48 @@ class ParallelLoader(object):
       dqueue.queue.close_write()
 
 
+class _NativeDeviceLoader(object):
+  """Moves the batches of one device with a native `DeviceLoader`, keeping
+  their structures to rebuild them around the transferred tensors.
+  """
+
+  def __init__(self, device, prefetch_depth, input_sharding):
+    self._loader = torch_xla._XLAC.DeviceLoader(str(device), prefetch_depth)
+    self._input_sharding = input_sharding
+    # The structures of the batches put, in order, each with the indices of
+    # the leaves transferred.
+    self._structures = collections.deque()
+
+  def put(self, data):
+    data = _assemble_local_shards(data)
+    leaves, spec = pytree.tree_flatten(data)
+    indices = [
+        i for i, leaf in enumerate(leaves)
+        if type(leaf) == torch.Tensor and leaf.device.type == 'cpu'
+    ]
+    tensors = [leaves[i] for i in indices]
+    shardings = None
+    if self._input_sharding:
+      shardings = [self._input_sharding.xla_spec(t) for t in tensors]
+    self._structures.append((leaves, spec, indices))
+    return self._loader.put(tensors, shardings)
+
+  def get(self):
+    tensors = self._loader.get()
+    if tensors is None:
+      return None
+    leaves, spec, indices = self._structures.popleft()
+    for i, tensor in zip(indices, tensors):
+      leaves[i] = tensor
+    return pytree.tree_unflatten(leaves, spec)
+
+  def close_write(self):
+    self._loader.close_write()
+
+  def close(self):
+    self._loader.close()
+
+
 class MpDeviceLoader(object):
   """Wraps an existing PyTorch DataLoader with background data upload.
 
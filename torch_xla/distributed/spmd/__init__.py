@@ -4,7 +4,8 @@ from .xla_sharding import (Mesh, HybridMesh, ShardingType, ShardingSpec,
                            wrap_if_sharded, xla_patched_nn_linear_forward,
                            set_global_mesh, get_global_mesh,
                            _mark_manual_sharding, enable_manual_sharding,
-                           disable_manual_sharding)
+                           disable_manual_sharding, LocalShards,
+                           global_tensor_from_local_shards)
 from .api import xla_distribute_tensor, xla_distribute_module, auto_policy
 
 __all__ = [
@@ -29,4 +30,6 @@ __all__ = [
     "disable_manual_sharding",
     "enable_manual_sharding",
     "disable_manual_sharding",
+    "LocalShards",
+    "global_tensor_from_local_shards",
 ]
@@ -669,6 +669,55 @@ class ShardingSpec:
     mark_sharding(t, self.mesh, self.partition_spec)
 
 
+def global_tensor_from_local_shards(
+    shards: List[torch.Tensor],
+    mesh: Mesh,
+    partition_spec: Tuple[Union[Tuple, int, str, None]],
+    global_shape: Optional[Sequence[int]] = None) -> torch.Tensor:
+  """
+  Assembles a sharded global tensor from the CPU shards of the local devices,
+  without ever materializing the global tensor. Each process only provides its
+  own shards, eg. read from its own files.
+
+  Args:
+    shards (List[torch.Tensor]): The CPU shards, one per local device in the
+      order of `torch_xla.runtime.local_runtime_devices()`. The shards include
+      the padding of the uneven partitions.
+    mesh (Mesh): The device mesh the tensor is sharded over.
+    partition_spec (Tuple): The partition spec of the global tensor, as for
+      `mark_sharding`.
+    global_shape (Sequence[int], optional): The global tensor shape. Defaults
+      to the shard shape scaled by the tiling.
+
+  Returns:
+    The sharded global tensor on the XLA device.
+  """
+  op_sharding = mesh.get_op_sharding(tuple(partition_spec))
+  if global_shape is not None:
+    global_shape = list(global_shape)
+  return torch_xla._XLAC._global_tensor_from_cpu_shards(
+      list(shards), op_sharding, global_shape)
+
+
+@dataclass
+class LocalShards:
+  """
+  The local device shards of a global tensor, which `ParallelLoader` and
+  `MpDeviceLoader` assemble into the sharded global tensor on their background
+  threads, see `global_tensor_from_local_shards`. Data loaders of per-host
+  file shards yield these in place of the global batch tensors.
+  """
+  shards: List[torch.Tensor]
+  mesh: Mesh
+  partition_spec: Tuple[Union[Tuple, int, str, None]]
+  global_shape: Optional[Sequence[int]] = None
+
+  def to_global_tensor(self) -> torch.Tensor:
+    return global_tensor_from_local_shards(self.shards, self.mesh,
+                                           self.partition_spec,
+                                           self.global_shape)
+
+
 class XLAPatchedLinear(torch.autograd.Function):
   """
   A patched version of `torch.nn.functional.linear` that uses einsum instead
@@ -43,6 +43,16 @@ class ZeroRedundancyOptimizer(Optimizer):
         bucket_cap_mb:
           If non-zero, specifies the maximum number of megabytes to combine tensors
           before doing the all-gather/reduce-scatter operations.
+        flatten_parameters (bool, Optional): if ``True``, the shards of the
+          parameters of each group requiring gradients are laid out in a single
+          flat buffer, which the local optimizer steps as one parameter. The
+          gradients are then reduce-scattered and the parameters all-gathered
+          with one collective per group, and the optimizer state is made of a
+          few large device buffers instead of one per parameter, which keeps
+          the graphs of models with thousands of parameters small. The
+          parameters of a group must share their dtype, and those without
+          gradient at a step are stepped with zero gradients. The bucket caps
+          are ignored. Default: False
         **defaults: any trailing arguments, which are forwarded to the local
             optimizer.
 
@@ -65,6 +75,7 @@ class ZeroRedundancyOptimizer(Optimizer):
       lazy_init: bool = False,
       bucket_cap_mb_all_gather: int = 0,
       bucket_cap_mb_reduce_scatter: int = 0,
+      flatten_parameters: bool = False,
       **defaults: Any,
   ):
     super().__init__(params, defaults)
@@ -85,6 +96,7 @@ class ZeroRedundancyOptimizer(Optimizer):
     self.bucket_cap_mb_reduce_scatter = bucket_cap_mb_reduce_scatter
     self.coalesce_cc_all_gather = bucket_cap_mb_all_gather > 0
     self.coalesce_cc_reduce_scatter = bucket_cap_mb_reduce_scatter > 0
+    self.flatten_parameters = flatten_parameters
 
     self._grad_norm = None
 
@@ -186,6 +198,9 @@ class ZeroRedundancyOptimizer(Optimizer):
 
     xm.unlazy(all_params)
 
+    if self.flatten_parameters:
+      return self._shard_flat_parameters()
+
     sharded_params_groups = []
     for param_group in self.param_groups:
       sharded_params = []
@@ -275,6 +290,32 @@ class ZeroRedundancyOptimizer(Optimizer):
     # sync to base optimizer
     self._sync_param_groups(self.param_groups, self.base_optimizer.param_groups)
 
+    if self.flatten_parameters:
+      self._reduce_scatter_flat_grads()
+    else:
+      self._reduce_scatter_grads()
+
+    if self.grad_clipping:
+      # Update unscale/clip with sub partitions
+      self._clip_grad_norm(max_norm=self.max_norm)
+
+    # Step the wrapped optimizer
+    # Closure already executed, pass none here
+    self.base_optimizer.step(closure=None, **kwargs)
+    # Remove shards' grads
+    self.base_optimizer.zero_grad(set_to_none=True)
+
+    if self.flatten_parameters:
+      self._all_gather_flat_params()
+    else:
+      self._all_gather_params()
+
+    # sync back
+    self._sync_param_groups(self.base_optimizer.param_groups, self.param_groups)
+
+    return loss
+
+  def _reduce_scatter_grads(self):
     # Reduce full gradients across ranks
     # Assign gradient shards to the respective parameter shards
     padded_grads = []
@@ -324,16 +365,7 @@ class ZeroRedundancyOptimizer(Optimizer):
             shard.grad = grad_shard
             index += 1
 
-    if self.grad_clipping:
-      # Update unscale/clip with sub partitions
-      self._clip_grad_norm(max_norm=self.max_norm)
-
-    # Step the wrapped optimizer
-    # Closure already executed, pass none here
-    self.base_optimizer.step(closure=None, **kwargs)
-    # Remove shards' grads
-    self.base_optimizer.zero_grad(set_to_none=True)
-
+  def _all_gather_params(self):
     # All gather the new weights across the ranks and assign them to the full parameters
     sharded_data = []
     for param_group, sharded_param_group in zip(
@@ -373,10 +405,83 @@ class ZeroRedundancyOptimizer(Optimizer):
             param.data.copy_(padded_param.data[:param.size(0)])
             index += 1
 
-    # sync back
-    self._sync_param_groups(self.base_optimizer.param_groups, self.param_groups)
+  def _flat_params(self, param_group):
+    return [param for param in param_group['params'] if param.requires_grad]
 
-    return loss
+  def _shard_flat_parameters(self):
+    """
+    Shard the parameters of each group into a single flat parameter, the
+    concatenation of the flattened shards of the parameters.
+    """
+    sharded_params_groups = []
+    for param_group in self.param_groups:
+      params = self._flat_params(param_group)
+      assert len(set(param.dtype for param in params)) <= 1, \
+          "The flattened parameters of a group should share their dtype."
+      flat_params = []
+      if params:
+        shards = []
+        for param in params:
+          shard_data = self._shard_tensor(param.data.to(device="cpu"))
+          shards.append(shard_data.to(dtype=self.optimizer_dtype).reshape(-1))
+        flat_shard = torch.cat(shards).to(device=self.device)
+        flat_params.append(nn.Parameter(flat_shard, requires_grad=True))
+      sharded_params_group = copy.copy(param_group)
+      sharded_params_group['params'] = flat_params
+      sharded_params_groups.append(sharded_params_group)
+    return sharded_params_groups
+
+  def _reduce_scatter_flat_grads(self):
+    for param_group, sharded_param_group in zip(
+        self.param_groups, self.base_optimizer.param_groups):
+      if not sharded_param_group['params']:
+        continue
+      # Row r of the (world size, shard numel) view of a padded gradient is
+      # its r-th shard, so that the concatenation of the views along their
+      # columns is scattered in the flat shard of each rank.
+      columns = []
+      for param in self._flat_params(param_group):
+        grad = param.grad if param.grad is not None else torch.zeros_like(param)
+        padded_grad = self._pad_to_world_size(grad, self.local_world_size)
+        columns.append(padded_grad.reshape(self.local_world_size, -1))
+      flat_grad = torch.cat(columns, dim=1)
+      grad_shard = xm.reduce_scatter(
+          xm.REDUCE_SUM,
+          flat_grad,
+          scale=1.0 / self.local_world_size,
+          scatter_dim=0,
+          shard_count=self.local_world_size,
+          pin_layout=self.pin_layout,
+          groups=self.sharding_groups,
+      ).reshape(-1)
+      if grad_shard.dtype != self.optimizer_dtype:
+        grad_shard = grad_shard.to(dtype=self.optimizer_dtype)
+      sharded_param_group['params'][0].grad = grad_shard
+
+  def _all_gather_flat_params(self):
+    for param_group, sharded_param_group in zip(
+        self.param_groups, self.base_optimizer.param_groups):
+      if not sharded_param_group['params']:
+        continue
+      params = self._flat_params(param_group)
+      shard_data = sharded_param_group['params'][0].data
+      if params[0].dtype != self.optimizer_dtype:
+        shard_data = shard_data.to(dtype=params[0].dtype)
+      gathered = xm.all_gather(
+          shard_data,
+          dim=0,
+          pin_layout=self.pin_layout,
+          groups=self.sharding_groups,
+      ).reshape(self.local_world_size, -1)
+      offset = 0
+      for param in params:
+        padded_size = -(-param.size(0) // self.local_world_size) * \
+            self.local_world_size
+        shard_numel = padded_size * param[0].numel() // self.local_world_size
+        padded_param = gathered[:, offset:offset + shard_numel].reshape(
+            padded_size, *param.shape[1:])
+        param.data.copy_(padded_param[:param.size(0)])
+        offset += shard_numel
 
   def state_dict(self):
     state_dict = super().state_dict()
@@ -0,0 +1,48 @@
+import contextlib
+from typing import Dict, Union
+
+import torch_xla
+
+CompileOptionValue = Union[bool, int, str]
+
+
+def set_compile_options(options: Dict[str, CompileOptionValue]):
+  """Sets the XLA compile options of the graphs synced by the calling thread.
+
+  The options override, for these graphs only, the ones of the client and of
+  `XLA_FLAGS`, so that eg. the evaluation graphs can compile fast while the
+  training step uses the slower, more aggressive optimizations. They are part
+  of the graph hash, so the same graph compiled with other options is cached
+  separately.
+
+  Args:
+    options (dict): The option values by the name of their XLA debug option
+      or backend flag, like `{'xla_backend_optimization_level': 0}`. An empty
+      dict restores the defaults.
+  """
+  torch_xla._XLAC._xla_set_compile_options(options)
+
+
+def get_compile_options() -> Dict[str, CompileOptionValue]:
+  """Returns the compile options of the calling thread, see
+  `set_compile_options`."""
+  return torch_xla._XLAC._xla_get_compile_options()
+
+
+@contextlib.contextmanager
+def compile_options(**options: CompileOptionValue):
+  """Compiles the graphs synced within the block with the given options,
+  added to the ones of the enclosing blocks, see `set_compile_options`.
+
+  Example::
+
+    with compile_options.compile_options(xla_backend_optimization_level=0):
+      loss = model(eval_batch)
+      xm.mark_step()
+  """
+  previous = get_compile_options()
+  set_compile_options({**previous, **options})
+  try:
+    yield
+  finally:
+    set_compile_options(previous)
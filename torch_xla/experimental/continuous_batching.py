@@ -0,0 +1,186 @@
+from typing import Callable, Dict, Hashable, List, Optional
+
+import torch
+from torch.utils import _pytree as pytree
+
+import torch_xla
+import torch_xla.core.functions as xf
+from torch_xla.experimental.graph_replay import replayable
+
+
+class SlotBatch:
+  """A batch of a fixed number of request slots, for continuous batching.
+
+  The requests of a serving loop come and go at every step, which changes the
+  batch size, and so the graph of the decoding step, as they do. A slot batch
+  keeps the batch at `num_slots` rows instead: each request is assigned a free
+  slot when it is inserted and frees it when it is evicted, and the decoding
+  step runs over all the slots, with the `active` mask ([num_slots] int32, 1
+  for the slots holding a request) and the `positions` ([num_slots] int32, the
+  number of tokens of the request of each slot) as device tensors. The step is
+  `replayable`, so that it is traced once and then runs the cached graph
+  through the graph executor, whatever the number of active requests.
+
+  The state of the requests, like their KV caches or their last tokens, are
+  device tensors with the slot as their first dimension. Inserting a request
+  writes its state and position into its slot, and evicting it clears its
+  mask entry, with in-place dynamic update slices whose slot index is a device
+  scalar: the state buffers are donated rather than copied, and an insertion
+  or an eviction runs the same small graph whatever the slot.
+
+  Example::
+
+    def decode(state, active, positions):
+      logits = model(state['tokens'], state['k_cache'], state['v_cache'],
+                     positions)
+      tokens = torch.where(active.bool(), logits.argmax(-1), 0)
+      state['tokens'].copy_(tokens.unsqueeze(-1))
+      return tokens
+
+    batch = SlotBatch(decode, num_slots=8, state={
+        'tokens': torch.zeros(8, 1, dtype=torch.long, device=device),
+        'k_cache': torch.zeros(8, heads, max_len, head_dim, device=device),
+        'v_cache': torch.zeros(8, heads, max_len, head_dim, device=device),
+    })
+    batch.insert('request-0', position=prompt_len, tokens=first_token,
+                 k_cache=prompt_k, v_cache=prompt_v)
+    tokens = batch.step()
+  """
+
+  def __init__(self,
+               decode_fn: Callable,
+               num_slots: int,
+               state: Dict[str, torch.Tensor],
+               warmup_steps: int = 1):
+    """Creates a slot batch.
+
+    Args:
+      decode_fn: The decoding step, called as `decode_fn(state, active,
+        positions, *args)` and returning the outputs of the step. It updates
+        the `state` tensors in place, with the writes of all the slots, active
+        or not, and must only depend on its arguments (see `replayable`).
+      num_slots: The number of slots of the batch.
+      state: The state tensors of the requests by name, of shape
+        [num_slots, ...] on the XLA device.
+      warmup_steps: The number of steps traced before the step is captured.
+    """
+    assert num_slots > 0
+    for name, tensor in state.items():
+      assert tensor.dim() > 0 and tensor.size(0) == num_slots, (
+          f'The state {name} of shape {tuple(tensor.shape)} does not have '
+          f'{num_slots} slots')
+    self.num_slots = num_slots
+    self.state = state
+    device = next(iter(state.values())).device if state else None
+    self.active = torch.zeros(num_slots, dtype=torch.int32, device=device)
+    self.positions = torch.zeros(num_slots, dtype=torch.int32, device=device)
+    self._slot_indices = [
+        torch.tensor(slot, dtype=torch.int32, device=device)
+        for slot in range(num_slots)
+    ]
+    self._flags = [
+        torch.tensor([flag], dtype=torch.int32, device=device)
+        for flag in (0, 1)
+    ]
+    self._free_slots = list(reversed(range(num_slots)))
+    self._slots: Dict[Hashable, int] = {}
+    self._step = replayable(
+        self._run_step(decode_fn), warmup_steps=warmup_steps)
+    self._sync(self._device_tensors())
+
+  @staticmethod
+  def _run_step(decode_fn):
+
+    def step(state, active, positions, *args):
+      outputs = decode_fn(state, active, positions, *args)
+      positions.add_(active)
+      return outputs
+
+    return step
+
+  def _device_tensors(self) -> List[torch.Tensor]:
+    tensors = list(self.state.values()) + [self.active, self.positions]
+    return tensors + self._slot_indices + self._flags
+
+  @staticmethod
+  def _sync(tensors):
+    torch_xla._XLAC._xla_sync_multi(tensors, devices=[], wait=False)
+
+  def slot_of(self, request_id: Hashable) -> Optional[int]:
+    """Returns the slot of the request, or None if it is not in the batch."""
+    return self._slots.get(request_id)
+
+  @property
+  def requests(self) -> Dict[Hashable, int]:
+    """The slots of the requests in the batch, by request id."""
+    return dict(self._slots)
+
+  @property
+  def num_free_slots(self) -> int:
+    return len(self._free_slots)
+
+  def insert(self, request_id: Hashable, position: int = 0,
+             **slot_state: torch.Tensor) -> int:
+    """Inserts a request into a free slot and returns the slot.
+
+    Args:
+      request_id: The id of the request, which must not be in the batch.
+      position: The number of tokens of the request, like its prompt length.
+      slot_state: The state of the request by name, of shape [...] or
+        [1, ...] for a state of shape [num_slots, ...], or of a prefix of the
+        shape along the second dimension, like the KV cache of a prompt. The
+        state of the slot not given keeps the values of the previous request.
+    Returns:
+      The slot of the request.
+    """
+    assert request_id not in self._slots, f'{request_id} is already inserted'
+    assert self._free_slots, f'All the {self.num_slots} slots are taken'
+    slot = self._free_slots.pop()
+    slot_index = self._slot_indices[slot]
+    updated = []
+    for name, value in slot_state.items():
+      tensor = self.state[name]
+      if value.dim() == tensor.dim() - 1:
+        value = value.unsqueeze(0)
+      value = value.to(device=tensor.device, dtype=tensor.dtype)
+      if value.dim() > 1 and value.size(1) < tensor.size(1):
+        # A write at a position which is a device scalar must not be clamped.
+        value = torch.cat(
+            [value, value.new_zeros((1, tensor.size(1) - value.size(1)) +
+                                    tuple(tensor.shape[2:]))],
+            dim=1)
+      xf.kv_cache_update_(tensor, value, slot_index, dim=0)
+      updated.append(tensor)
+    position = torch.tensor([position],
+                            dtype=torch.int32).to(self.positions.device)
+    xf.kv_cache_update_(self.positions, position, slot_index, dim=0)
+    xf.kv_cache_update_(self.active, self._flags[1], slot_index, dim=0)
+    self._sync(updated + [self.positions, self.active])
+    self._slots[request_id] = slot
+    torch_xla._XLAC._xla_increment_counter('SlotBatchInserts', 1)
+    return slot
+
+  def evict(self, request_id: Hashable) -> int:
+    """Evicts a request from the batch, freeing its slot, and returns it."""
+    slot = self._slots.pop(request_id)
+    xf.kv_cache_update_(
+        self.active, self._flags[0], self._slot_indices[slot], dim=0)
+    self._sync([self.active])
+    self._free_slots.append(slot)
+    torch_xla._XLAC._xla_increment_counter('SlotBatchEvictions', 1)
+    return slot
+
+  def step(self, *args):
+    """Runs the decoding step over all the slots and returns its outputs.
+
+    The positions of the active slots are advanced by one token. The state
+    and the outputs are synced, so that the next step, insertion or eviction
+    starts from device data.
+    """
+    outputs = self._step(self.state, self.active, self.positions, *args)
+    tensors = [
+        value for value in pytree.tree_leaves(outputs)
+        if isinstance(value, torch.Tensor)
+    ]
+    self._sync(list(self.state.values()) + [self.positions] + tensors)
+    return outputs
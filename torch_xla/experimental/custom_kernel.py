@@ -129,15 +129,63 @@ def trace_pallas(kernel: Callable,
   return payload, tensor_args
 
 
+def _kernel_cache_key(kernel, args, static_argnums, static_argnames, kwargs):
+  # The tensors only matter to the tracing by their shape and dtype.
+  key_args = tuple((tuple(arg.shape), arg.dtype) if torch.is_tensor(arg) else
+                   arg for arg in args)
+  key = (kernel, key_args,
+         tuple(static_argnums) if static_argnums is not None else None,
+         tuple(static_argnames) if static_argnames is not None else None,
+         tuple(sorted(kwargs.items())))
+  try:
+    hash(key)
+  except TypeError:
+    return None
+  return key
+
+
+# The ids of the kernels registered by trace_pallas_kernel, by cache key.
+_KERNEL_IDS = {}
+
+
+def trace_pallas_kernel(kernel: Callable,
+                        *args,
+                        static_argnums=None,
+                        static_argnames=None,
+                        **kwargs):
+  """Same as `trace_pallas`, but returns the id of the payload registered as a
+  custom kernel, to pass to the custom calls instead of the payload.
+
+  The kernels are traced once per kernel, argument shapes and dtypes and other
+  arguments, so that a kernel called many times per step is neither traced by
+  JAX nor interned again on each call. The arguments which cannot be hashed
+  disable the caching.
+  """
+  key = _kernel_cache_key(kernel, args, static_argnums, static_argnames,
+                          kwargs)
+  tensor_args = [arg for arg in args if torch.is_tensor(arg)]
+  kernel_id = _KERNEL_IDS.get(key) if key is not None else None
+  if kernel_id is None:
+    payload, tensor_args = trace_pallas(
+        kernel,
+        *args,
+        static_argnums=static_argnums,
+        static_argnames=static_argnames,
+        **kwargs)
+    kernel_id = torch_xla._XLAC._xla_register_custom_kernel(payload)
+    if key is not None:
+      _KERNEL_IDS[key] = kernel_id
+  return kernel_id, tensor_args
+
+
 def make_kernel_from_pallas(kernel: Callable, output_shape_dtype_fn: Callable):
-  # TODO: Maybe we can cache the payload for the same input.
   def wrapped_kernel(kernel: Callable,
                      output_shape_dtype_fn: Callable,
                      *args,
                      static_argnums=None,
                      static_argnames=None,
                      **kwargs) -> Callable:
-    payload, tensor_args = trace_pallas(
+    kernel_id, tensor_args = trace_pallas_kernel(
         kernel,
         *args,
         static_argnums=static_argnums,
@@ -148,7 +196,7 @@ def make_kernel_from_pallas(kernel: Callable, output_shape_dtype_fn: Callable):
                       list), "The output_shape_dtype_fn should return a list."
     output_shapes = [shape for shape, _ in output_shape_dtype]
     output_dtypes = [dtype for _, dtype in output_shape_dtype]
-    outputs = torch_xla._XLAC._xla_tpu_custom_call(tensor_args, payload,
+    outputs = torch_xla._XLAC._xla_tpu_custom_call(tensor_args, kernel_id,
                                                    output_shapes, output_dtypes)
 
     # Make the output easier to use.
@@ -249,7 +297,7 @@ class FlashAttention(torch.autograd.Function):
       # l and m that is needed for the backward. Then we lose all the shape checks.
       # TODO: replicate the shape checks on flash_attention.
       # Here we seperate the tracing and execution part just to support SegmentIds.
-      payload, _ = trace_pallas(
+      kernel_id, _ = trace_pallas_kernel(
           _flash_attention_impl,
           q,
           k,
@@ -269,7 +317,7 @@ class FlashAttention(torch.autograd.Function):
       args = [q, k, v]
       if segment_ids is not None:
         args += [q_segment_ids, kv_segment_ids]
-      o = torch_xla._XLAC._xla_tpu_custom_call(args, payload, shapes, dtypes)
+      o = torch_xla._XLAC._xla_tpu_custom_call(args, kernel_id, shapes, dtypes)
 
       if not save_residuals:
         o = o[0]
@@ -333,7 +381,7 @@ class FlashAttention(torch.autograd.Function):
           expanded_grad_i, partition_spec, mesh=mesh).global_tensor
 
     if ctx.needs_input_grad[0]:
-      payload, _ = trace_pallas(
+      kernel_id, _ = trace_pallas_kernel(
           _flash_attention_bwd_dq,
           q,
           k,
@@ -364,11 +412,11 @@ class FlashAttention(torch.autograd.Function):
       if segment_ids is not None:
         args += [q_segment_ids, kv_segment_ids]
       args += [expanded_l, expanded_m, grad_output, expanded_grad_i]
-      grad_q = torch_xla._XLAC._xla_tpu_custom_call(args, payload, [q.shape],
+      grad_q = torch_xla._XLAC._xla_tpu_custom_call(args, kernel_id, [q.shape],
                                                     [q.dtype])[0]
 
     if ctx.needs_input_grad[1] or ctx.needs_input_grad[2]:
-      payload, _ = trace_pallas(
+      kernel_id, _ = trace_pallas_kernel(
           _flash_attention_bwd_dkv,
           q,
           k,
@@ -402,7 +450,7 @@ class FlashAttention(torch.autograd.Function):
       if segment_ids is not None:
         args += [q_segment_ids, kv_segment_ids]
       args += [expanded_l, expanded_m, grad_output, expanded_grad_i]
-      grads = torch_xla._XLAC._xla_tpu_custom_call(args, payload,
+      grads = torch_xla._XLAC._xla_tpu_custom_call(args, kernel_id,
                                                    [k.shape, v.shape],
                                                    [k.dtype, v.dtype])
     if ctx.needs_input_grad[1]:
@@ -454,7 +502,7 @@ def paged_attention(q,
       "kv_head", "batch", None
   ], "megacore_mode must be one of ['kv_head', 'batch', None]."
 
-  payload, tensor_args = trace_pallas(
+  kernel_id, tensor_args = trace_pallas_kernel(
       paged_attention,
       q,
       k_pages,
@@ -488,7 +536,7 @@ def paged_attention(q,
           q.to(q_dtype_for_kernel_launch),
           k_pages,
           v_pages,
-      ], payload, [q.shape, output_shape, output_shape],
+      ], kernel_id, [q.shape, output_shape, output_shape],
       [q_dtype_for_kernel_launch, torch.float32, torch.float32])
 
   return output.reshape(batch_size, num_heads, head_dim).to(q.dtype)
@@ -742,7 +790,7 @@ def gmm(
   tm, tk, tn = min(tiling[0], m), min(tiling[1], k), min(tiling[2], n)
   preferred_element_type = lhs.dtype
 
-  payload, _ = trace_pallas(
+  kernel_id, _ = trace_pallas_kernel(
       gmm,
       lhs,
       rhs,
@@ -764,7 +812,7 @@ def gmm(
   return torch_xla._XLAC._xla_tpu_custom_call([
       num_tiles, group_offsets, group_ids, m_tile_ids, group_offset_torch, lhs,
       rhs
-  ], payload, [torch.Size([m, n])], [preferred_element_type])[0]
+  ], kernel_id, [torch.Size([m, n])], [preferred_element_type])[0]
 
 
 def tgmm(
@@ -794,7 +842,7 @@ def tgmm(
   tm, tk, tn = min(tiling[0], m), min(tiling[1], k), min(tiling[2], n)
   preferred_element_type = lhs.dtype
 
-  payload, _ = trace_pallas(
+  kernel_id, _ = trace_pallas_kernel(
       tgmm,
       lhs,
       rhs,
@@ -816,7 +864,7 @@ def tgmm(
   return torch_xla._XLAC._xla_tpu_custom_call([
       num_tiles, group_offsets, group_ids, m_tile_ids, group_offset_torch,
       lhs.t(), rhs
-  ], payload, [torch.Size([num_groups, k, n])], [preferred_element_type])[0]
+  ], kernel_id, [torch.Size([num_groups, k, n])], [preferred_element_type])[0]
 
 
 def gmm_backward(grad, lhs, rhs, group_sizes, tiling=(512, 512, 512)):
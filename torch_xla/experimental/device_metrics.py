@@ -0,0 +1,150 @@
+import math
+from typing import Dict, Optional, Union
+
+import torch
+
+import torch_xla
+import torch_xla.core.xla_model as xm
+
+# The reduction of each metric kind, see MetricReduction, and the initial value
+# of its accumulated value.
+_REDUCTIONS = {
+    'sum': (0, 0.0),
+    'mean': (0, 0.0),
+    'max': (1, -math.inf),
+    'min': (2, math.inf),
+}
+
+
+class _Metric:
+
+  def __init__(self, kind: str, device):
+    self.kind = kind
+    self.reduction, self.initial = _REDUCTIONS[kind]
+    self.device = device
+    self.reset()
+
+  def reset(self):
+    self.state = torch.tensor([self.initial, 0.0],
+                              dtype=torch.float32).to(self.device)
+
+  def value(self, state: torch.Tensor) -> Optional[float]:
+    total, count = state.tolist()
+    if count == 0:
+      return None
+    return total / count if self.kind == 'mean' else total
+
+
+class DeviceMetrics:
+  """Metrics accumulated on the device, read every `fetch_interval` steps.
+
+  Reading a loss or an accuracy with `.item()` at every step copies it to the
+  host, which waits for the execution of the step and drains the pipeline of
+  the asynchronous executions. The metrics of a `DeviceMetrics` are instead
+  accumulated into F32 [2] device tensors (the sum, maximum or minimum of the
+  values, and their count) updated in place by the step graph: like the
+  optimizer state, they are live tensors synced with the step, whose buffers
+  are donated to their updated values. Only every `fetch_interval` calls of
+  `step()` are they fetched, with `xm.fetch_async()`, which copies them in the
+  background, and reset.
+
+  Example::
+
+    metrics = DeviceMetrics(fetch_interval=100)
+    for step, (data, target) in enumerate(loader):
+      output, loss = train_step(data, target)
+      metrics.update('loss', loss)
+      metrics.update('accuracy', (output.argmax(-1) == target).float())
+      xm.mark_step()
+      metrics.step()
+      if step % 100 == 0:
+        print(step, metrics.values())
+  """
+
+  def __init__(self, fetch_interval: int = 1, device=None):
+    """Creates the metrics.
+
+    Args:
+      fetch_interval: The number of steps between two fetches of the metrics.
+      device: The device of the metrics, the current XLA device by default.
+    """
+    assert fetch_interval > 0
+    self.fetch_interval = fetch_interval
+    self.device = device if device is not None else xm.xla_device()
+    self._metrics: Dict[str, _Metric] = {}
+    self._steps = 0
+    self._pending = None
+    self._values: Dict[str, Optional[float]] = {}
+
+  def update(self,
+             name: str,
+             value: torch.Tensor,
+             weight: Optional[Union[torch.Tensor, float]] = None,
+             kind: str = 'mean'):
+    """Accumulates the elements of `value` into the metric `name`.
+
+    Args:
+      name: The name of the metric, created at its first update.
+      value: The values to accumulate, on the device of the metrics.
+      weight: The weight of the values of a sum or mean metric, a scalar or a
+        tensor of the shape of `value`. Each value counts as 1 by default.
+      kind: The kind of the metric, one of 'sum', 'mean', 'max' or 'min', fixed
+        at its first update.
+    """
+    metric = self._metrics.get(name)
+    if metric is None:
+      assert kind in _REDUCTIONS, f'Unknown metric kind: {kind}'
+      metric = self._metrics[name] = _Metric(kind, self.device)
+    assert metric.kind == kind, f'The metric {name} is a {metric.kind} metric'
+    if weight is not None and not isinstance(weight, torch.Tensor):
+      weight = torch.tensor(weight, dtype=torch.float32, device=self.device)
+    torch_xla._XLAC._xla_metric_accumulate_(metric.state, value, weight,
+                                            metric.reduction)
+
+  def step(self):
+    """Counts a step, fetching and resetting the metrics every
+    `fetch_interval` steps.
+
+    Called after `xm.mark_step()`, so that the metrics updated by the step are
+    device data rather than pending computations.
+    """
+    self._steps += 1
+    if self._steps % self.fetch_interval == 0:
+      self.fetch()
+
+  def fetch(self):
+    """Fetches the metrics in the background and resets them.
+
+    The values are returned by `values()` once copied.
+    """
+    self._collect(wait=True)
+    self._pending = {
+        name: (metric, xm.fetch_async(metric.state))
+        for name, metric in self._metrics.items()
+    }
+    for metric in self._metrics.values():
+      metric.reset()
+    torch_xla._XLAC._xla_increment_counter('DeviceMetricsFetches', 1)
+
+  def _collect(self, wait: bool):
+    if self._pending is None or (not wait and not all(
+        future.done() for _, future in self._pending.values())):
+      return
+    self._values = {
+        name: metric.value(future.result())
+        for name, (metric, future) in self._pending.items()
+    }
+    self._pending = None
+
+  def values(self, wait: bool = False) -> Dict[str, Optional[float]]:
+    """Returns the values of the metrics at their last fetch, by name.
+
+    A metric without values since its previous fetch is None, and the result is
+    empty until the first fetch completes.
+
+    Args:
+      wait: Whether to wait for the last fetch to complete, rather than to
+        return the values of the previous one while it is in flight.
+    """
+    self._collect(wait)
+    return dict(self._values)
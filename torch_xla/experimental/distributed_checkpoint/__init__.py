@@ -1,10 +1,13 @@
 from .manager import CheckpointManager
 from .planners import SPMDSavePlanner, SPMDLoadPlanner
 from .util import prime_optimizer
+from .local_shards import save_local_shards, load_local_shards
 
 __all__ = [
     "CheckpointManager",
     "SPMDSavePlanner",
     "SPMDLoadPlanner",
     "prime_optimizer",
+    "save_local_shards",
+    "load_local_shards",
 ]
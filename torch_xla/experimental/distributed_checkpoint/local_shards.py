@@ -0,0 +1,76 @@
+import os
+from typing import List, Tuple
+
+import torch
+import torch_xla
+import torch_xla.core.xla_model as xm
+
+from torch.distributed.checkpoint.metadata import STATE_DICT_TYPE
+from ._helpers import flatten_state_dict, _unwrap_xla_sharded_tensor
+
+# The default bound of the host memory holding the shards in flight.
+_DEFAULT_MAX_BUFFERED_BYTES = 1 << 30
+
+
+def _xla_tensors_and_prefixes(state_dict: STATE_DICT_TYPE,
+                              path: str) -> Tuple[List[torch.Tensor], List[str]]:
+  flat, _ = flatten_state_dict(state_dict)
+  tensors = []
+  prefixes = []
+  for fqn, value in flat.items():
+    value = _unwrap_xla_sharded_tensor(value)
+    if isinstance(value, torch.Tensor) and value.device.type == 'xla':
+      tensors.append(value)
+      prefixes.append(os.path.join(path, fqn))
+  return tensors, prefixes
+
+
+def save_local_shards(state_dict: STATE_DICT_TYPE,
+                      path: str,
+                      max_buffered_bytes: int = _DEFAULT_MAX_BUFFERED_BYTES):
+  """
+  Saves the XLA tensors of `state_dict` by streaming the local shards of each
+  process from the devices to one file per distinct shard, under `path`. The
+  device reads overlap with the file writes, and at most `max_buffered_bytes`
+  of shard data is held in host memory, so that the save time scales with the
+  storage bandwidth. The non XLA values of `state_dict` are not saved.
+
+  Unlike `torch.distributed.checkpoint`, the shards must be loaded back with
+  the same sharding and mesh shape by `load_local_shards`. Each distinct shard
+  is written once, by the process holding its first replica, so `path` must
+  be on storage shared by all the processes. Requires SPMD.
+
+  Args:
+    state_dict: The state_dict to save.
+    path: The directory to write the shard files to.
+    max_buffered_bytes: The bound of the host memory holding the shards which
+      are transferred or written.
+  """
+  os.makedirs(path, exist_ok=True)
+  tensors, prefixes = _xla_tensors_and_prefixes(state_dict, path)
+  # The shards are read from the device data, the pending updates come first.
+  xm.mark_step()
+  torch_xla._XLAC._save_local_shards_to_files(tensors, prefixes,
+                                              max_buffered_bytes)
+
+
+def load_local_shards(state_dict: STATE_DICT_TYPE,
+                      path: str,
+                      max_buffered_bytes: int = _DEFAULT_MAX_BUFFERED_BYTES):
+  """
+  Loads the XLA tensors of `state_dict` in place from the shard files written
+  by `save_local_shards`. Each process reads the files of its local shards and
+  transfers them to the devices, with at most `max_buffered_bytes` of shard
+  data held in host memory. The tensors must have the sharding they were
+  saved with.
+
+  Args:
+    state_dict: The state_dict to load into.
+    path: The directory holding the shard files.
+    max_buffered_bytes: The bound of the host memory holding the shards which
+      are read or transferred.
+  """
+  tensors, prefixes = _xla_tensors_and_prefixes(state_dict, path)
+  xm.mark_step()
+  torch_xla._XLAC._load_local_shards_from_files(tensors, prefixes,
+                                                max_buffered_bytes)
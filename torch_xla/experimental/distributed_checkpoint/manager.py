@@ -3,6 +3,7 @@ import logging
 import os
 import pickle
 import threading
+import torch
 import torch.distributed as dist
 import torch.distributed.checkpoint as dist_cp
 import torch_xla
@@ -19,7 +20,8 @@ from os.path import basename
 from concurrent.futures import ThreadPoolExecutor, wait
 from typing import Deque, List, Optional, Union
 from torch.distributed.checkpoint.metadata import STATE_DICT_TYPE
-from ._helpers import _sharded_cpu_state_dict
+from torch.utils._pytree import tree_flatten, tree_unflatten
+from ._helpers import _sharded_cpu_state_dict, _unwrap_xla_sharded_tensor
 
 # TODO(jonbolin): Import path will change
 from torch.distributed.checkpoint._fsspec_filesystem import FsspecReader, FsspecWriter
@@ -37,6 +39,10 @@ class _CheckpointMetadata:
   ts: datetime
 
 
+def _is_xla(x) -> bool:
+  return isinstance(x, torch.Tensor) and x.device.type == 'xla'
+
+
 class CheckpointManager:
   """
   The CheckpointManager class provides a higher-level wrapper around the
@@ -159,6 +165,11 @@ class CheckpointManager:
 
     self._tracked_chkpts = self._load_tracked_chkpts()
 
+    # Whether a state_dict was registered with `snapshot_on_preemption`, and
+    # whether its snapshot was written out.
+    self._snapshot_registered = False
+    self._snapshot_written = False
+
     if self.chkpt_on_preemption:
       # Initialize the distributed runtime for preemption detection
       torch_xla._XLAC._ensure_xla_coordinator_initialized(
@@ -246,7 +257,13 @@ class CheckpointManager:
        and a preemption has been detected.
     """
     preemption_detected = False
-    if self.chkpt_on_preemption and self.reached_preemption(step):
+    if self._snapshot_registered:
+      if self._snapshot_pending():
+        logging.warning("Preemption snapshot taken at step "
+                        f"{torch_xla._XLAC._xla_preemption_snapshot_step()}. "
+                        "Triggering a checkpoint.")
+        preemption_detected = True
+    elif self.chkpt_on_preemption and self.reached_preemption(step):
       logging.warning(
           f"Preemption sync point reached at step {step}. Triggering a checkpoint."
       )
@@ -269,6 +286,9 @@ class CheckpointManager:
       True if a checkpoint was taken and False otherwise.
     """
     if self.should_save(step) or force:
+      if self._snapshot_pending():
+        self._save(step, self._preemption_snapshot(state_dict))
+        return True
       self._wait_for_data()
       self._save(step, state_dict)
       return True
@@ -298,9 +318,12 @@ class CheckpointManager:
       True if a checkpoint was taken and False otherwise.
     """
     if self.should_save(step) or force:
-      self._wait_for_data()
-      # Move the state_dict to CPU
-      cpu_state_dict = _sharded_cpu_state_dict(state_dict)
+      if self._snapshot_pending():
+        cpu_state_dict = self._preemption_snapshot(state_dict)
+      else:
+        self._wait_for_data()
+        # Move the state_dict to CPU
+        cpu_state_dict = _sharded_cpu_state_dict(state_dict)
       self._async_sem.acquire()
       future = self._async_worker_pool.submit(self._save, step, cpu_state_dict)
       future.add_done_callback(lambda _: self._async_sem.release())
@@ -339,6 +362,48 @@ class CheckpointManager:
     """ Wait for any pending async checkpoints to complete. """
     wait(self._async_futures)
 
+  def snapshot_on_preemption(self, state_dict: STATE_DICT_TYPE) -> None:
+    """
+    Registers the XLA tensors of `state_dict` to be copied to host memory by
+    the `xm.mark_step` of the step found to be the preemption sync point, as
+    soon as that step is executed and without waiting for the training loop.
+    The next call to `save` or `save_async`, with the same state_dict, writes
+    the snapshot out instead of copying the tensors again.
+
+    The steps of the preemption detection are then counted by `xm.mark_step`,
+    so `reached_preemption` must not be called once a state_dict is
+    registered. Registering another state_dict replaces the previous one.
+    """
+    assert self.chkpt_on_preemption, (
+        "Preemption detection not enabled. Please set `chkpt_on_preemption` "
+        "when creating the CheckpointManager")
+    torch_xla._XLAC._xla_set_preemption_snapshot_tensors(
+        self._snapshot_tensors(state_dict))
+    self._snapshot_registered = True
+
+  def _snapshot_tensors(self,
+                        state_dict: STATE_DICT_TYPE) -> List[torch.Tensor]:
+    flat, _ = tree_flatten(state_dict)
+    return [x for x in map(_unwrap_xla_sharded_tensor, flat) if _is_xla(x)]
+
+  def _snapshot_pending(self) -> bool:
+    """ Whether a preemption snapshot was taken and not written out yet. """
+    if not self._snapshot_registered or self._snapshot_written:
+      return False
+    return torch_xla._XLAC._xla_preemption_snapshot_step() is not None
+
+  def _preemption_snapshot(self,
+                           state_dict: STATE_DICT_TYPE) -> STATE_DICT_TYPE:
+    """ Returns the host copy of `state_dict` taken by the snapshot. """
+    flat, tree_spec = tree_flatten(state_dict)
+    snapshot = iter(torch_xla._XLAC._xla_wait_preemption_snapshot())
+    flat = [
+        next(snapshot) if _is_xla(_unwrap_xla_sharded_tensor(x)) else x
+        for x in flat
+    ]
+    self._snapshot_written = True
+    return tree_unflatten(flat, tree_spec)
+
   def reached_preemption(self, step: int) -> bool:
     """ Returns True if a preemption has been detected at the given step. """
     assert self.chkpt_on_preemption, (
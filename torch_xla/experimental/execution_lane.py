@@ -0,0 +1,51 @@
+import contextlib
+
+import torch_xla
+
+DEFAULT = 'default'
+HIGH_PRIORITY = 'high_priority'
+
+
+def set_execution_lane(lane: str):
+  """Sets the dispatch lane of the graphs executed by the syncs of the calling
+  thread.
+
+  While high priority executions are pending on a device, the dispatch of the
+  default lane executions is held back (for at most
+  XLA_EXECUTION_LANE_MAX_HOLD_MS), so that latency sensitive graphs like online
+  evaluation or sampling do not queue behind the training steps.
+
+  Args:
+    lane (str): `'default'` or `'high_priority'`.
+  """
+  torch_xla._XLAC._xla_set_execution_lane(lane)
+
+
+def get_execution_lane() -> str:
+  """Returns the dispatch lane of the calling thread, see
+  `set_execution_lane`."""
+  return torch_xla._XLAC._xla_get_execution_lane()
+
+
+@contextlib.contextmanager
+def execution_lane(lane: str):
+  """Runs the syncs of the block in the given dispatch lane, see
+  `set_execution_lane`."""
+  previous = get_execution_lane()
+  set_execution_lane(lane)
+  try:
+    yield
+  finally:
+    set_execution_lane(previous)
+
+
+def high_priority():
+  """Runs the syncs of the block in the high priority dispatch lane.
+
+  Example::
+
+    with execution_lane.high_priority():
+      loss = model(eval_batch)
+      xm.mark_step()
+  """
+  return execution_lane(HIGH_PRIORITY)
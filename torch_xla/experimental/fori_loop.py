@@ -41,59 +41,51 @@ def while_loop(cond_fn, body_fn, *carried_inputs, additional_inputs=None):
       cond_fn, body_fn, *carried_inputs, additional_inputs=additional_inputs)
 
 
+def _fake_tensor(tensor):
+  # Distinct device data of the same shape, standing for the parameters of the
+  # cond and body computations while tracing them.
+  return torch.zeros(tensor.size(), dtype=tensor.dtype).to(tensor.device)
+
+
+def _build_computation(name, results, parameters):
+  ctx = torch_xla._XLAC.lowering.LoweringContext()
+  ctx.set_name_string(name)
+  ctx.build_with_parameters(results, parameters)
+  return ctx
+
+
 def _xla_while_loop(cond_fn, body_fn, *carried_inputs, additional_inputs):
   # untuple carried_inputs from while_loop
   carried_inputs = carried_inputs[0]
-  # fake carried_inputs to split formal code
-  fake_carried_inputs = []
-  for carried_input in carried_inputs:
-    device = carried_input.device
-    fake_carried_inputs.append(
-        torch.randint(10, carried_input.size(),
-                      dtype=carried_input.dtype).to(device))
-  fake_carried_inputs = tuple(fake_carried_inputs)
-
-  # trans fake_carried_inputs from list(tensor) to list(xla::op)
-  kwargs = {}
-  if type(fake_carried_inputs) is tuple:
-    shapes = xb.tensor_shape(fake_carried_inputs)
-  else:
-    shapes = xb.tensor_shape((fake_carried_inputs))
-  builder = xb.create_builder('test_while')
-  params = []
-  for shape in shapes:
-    p = xb.mkparam(builder, len(params), shape)
-    params.append(p)
-
-  # generate cond_fn xlacomputation
-  cond_result = cond_fn(*fake_carried_inputs)
-  cond_ctx = torch_xla._XLAC.lowering.LoweringContext()
-  cond_ctx.set_name_string("condctx")
-  cond_ctx.buildforiloop([cond_result], list(fake_carried_inputs[2:]))
-  cond_hlo = cond_ctx.hlo()
-  cond_computation = xb.computation_from_module_proto("condcomputation",
-                                                      cond_hlo)
-
-  # generate body_fn xlacomputation
-  body_result = body_fn(*fake_carried_inputs)
-  body_ctx = torch_xla._XLAC.lowering.LoweringContext()
-  body_ctx.set_name_string("bodyctx")
-  body_ctx.buildforiloop(list(body_result), [])
-  body_hlo = body_ctx.hlo()
-  body_computation = xb.computation_from_module_proto("bodycomputation",
-                                                      body_hlo)
-
-  # generate while xlacomputation
-  input_tuple = xb.Op.tuple(tuple(params))
-  w = xb.mkop(
-      'While', (input_tuple.op,),
-      condition_computation=cond_computation,
-      body_computation=body_computation)
-  name = 'fori_loop_ed_torch_func'
-  computation = w.build(name)
-
-  # gain final result with generated while xlacomputation
-  result = torch_xla._XLAC._xla_user_computation('xla::_op_test_while',
-                                                 (carried_inputs), computation)
-
-  return result
\ No newline at end of file
+  fake_carried_inputs = [_fake_tensor(t) for t in carried_inputs]
+  fake_additional_inputs = [_fake_tensor(t) for t in additional_inputs]
+  formals = fake_carried_inputs + fake_additional_inputs
+
+  cond_result = cond_fn(*formals)
+  body_result = list(body_fn(*formals))
+  assert len(body_result) == len(carried_inputs), (
+      'body_fn must return the carried values')
+
+  # The device data the functions capture, like the weights of a decoding
+  # loop, is passed as loop invariants instead of being carried.
+  captured = []
+  handles = set()
+  for results in ([cond_result], body_result):
+    ctx = _build_computation('while_loop', results, formals)
+    for tensor in ctx.captured_tensors():
+      handle = torch_xla._XLAC._get_tensors_handle([tensor])[0]
+      if handle not in handles:
+        handles.add(handle)
+        captured.append(tensor)
+
+  parameters = formals + captured
+  cond_ctx = _build_computation('cond', [cond_result], parameters)
+  cond_computation = xb.computation_from_module_proto('condcomputation',
+                                                      cond_ctx.hlo())
+  body_ctx = _build_computation('body', body_result, parameters)
+  body_computation = xb.computation_from_module_proto('bodycomputation',
+                                                      body_ctx.hlo())
+
+  return torch_xla._XLAC._xla_while_loop(
+      list(carried_inputs),
+      list(additional_inputs) + captured, cond_computation, body_computation)
@@ -0,0 +1,144 @@
+import functools
+from typing import Callable, Dict, Optional, Tuple
+
+import torch
+from torch.utils import _pytree as pytree
+
+import torch_xla
+import torch_xla.core.dynamo_bridge as dynamo_bridge
+import torch_xla.utils.utils as xu
+
+
+class _FlatStep:
+  """Adapts a step function to what `dynamo_bridge.extract_internal` expects
+  from a `torch.fx.GraphModule`: flat positional inputs and outputs."""
+
+  def __init__(self, fn: Callable, args_spec: pytree.TreeSpec, flat_args):
+    self.fn = fn
+    self.args_spec = args_spec
+    self.xla_args = flat_args
+    self.out_spec = None
+
+  def parameters(self):
+    return iter(())
+
+  def __call__(self, *flat_args):
+    args, kwargs = pytree.tree_unflatten(list(flat_args), self.args_spec)
+    out = self.fn(*args, **kwargs)
+    flat_out, self.out_spec = pytree.tree_flatten(out)
+    for value in flat_out:
+      assert value is None or isinstance(value, torch.Tensor), (
+          f'Replayable step outputs must be tensors, got {type(value)}')
+    return tuple(flat_out)
+
+
+def _guard_key(flat_args, args_spec: pytree.TreeSpec) -> Tuple:
+  key = [args_spec]
+  for arg in flat_args:
+    if isinstance(arg, torch.Tensor):
+      key.append((arg.device.type, arg.dtype, tuple(arg.shape)))
+    else:
+      key.append(arg)
+  return tuple(key)
+
+
+class _Capture:
+
+  def __init__(self, replay_fn: Callable, out_spec: pytree.TreeSpec):
+    self.replay_fn = replay_fn
+    self.out_spec = out_spec
+    self.graph_hash = replay_fn.get_graph_hash()
+    self.replays = 0
+
+
+class ReplayableStep:
+  """See `replayable`."""
+
+  def __init__(self, fn: Callable, warmup_steps: int, check_interval: int):
+    self.fn = fn
+    self.warmup_steps = warmup_steps
+    self.check_interval = check_interval
+    self._seen: Dict[Tuple, int] = {}
+    self._captures: Dict[Tuple, _Capture] = {}
+    functools.update_wrapper(self, fn)
+
+  def __call__(self, *args, **kwargs):
+    flat_args, args_spec = pytree.tree_flatten((args, kwargs))
+    try:
+      key = _guard_key(flat_args, args_spec)
+      hash(key)
+    except TypeError:
+      # Unhashable non tensor arguments can not be guarded on.
+      torch_xla._XLAC._xla_increment_counter('GraphReplayUnguardable', 1)
+      return self.fn(*args, **kwargs)
+
+    capture = self._captures.get(key)
+    if capture is not None and self.check_interval > 0 and (
+        capture.replays + 1) % self.check_interval == 0:
+      # Trace again once in a while, in case the step depends on state which
+      # the guards do not see.
+      new_capture = self._capture(flat_args, args_spec)
+      if new_capture.graph_hash != capture.graph_hash:
+        torch_xla._XLAC._xla_increment_counter('GraphReplayDivergence', 1)
+      new_capture.replays = capture.replays
+      self._captures[key] = capture = new_capture
+
+    if capture is None:
+      seen = self._seen.get(key, 0) + 1
+      self._seen[key] = seen
+      if seen <= self.warmup_steps:
+        return self.fn(*args, **kwargs)
+      capture = self._capture(flat_args, args_spec)
+      self._captures[key] = capture
+
+    torch_xla._XLAC._xla_increment_counter('GraphReplay', 1)
+    capture.replays += 1
+    flat_out = capture.replay_fn(*flat_args)
+    if not isinstance(flat_out, (tuple, list)):
+      flat_out = (flat_out,)
+    return pytree.tree_unflatten(list(flat_out), capture.out_spec)
+
+  def _capture(self, flat_args, args_spec):
+    torch_xla._XLAC._xla_increment_counter('GraphReplayCapture', 1)
+    step = _FlatStep(self.fn, args_spec, flat_args)
+    # Traces the step once, the replays then run the graph of that trace.
+    replay_fn = dynamo_bridge.extract_internal(step)
+    return _Capture(replay_fn, step.out_spec)
+
+  def reset(self):
+    """Drops all the captured graphs, the next calls trace the step again."""
+    self._seen.clear()
+    self._captures.clear()
+
+
+def replayable(fn: Optional[Callable] = None,
+               *,
+               warmup_steps: Optional[int] = None,
+               check_interval: Optional[int] = None):
+  """Lets repeated calls of a step function skip the lazy tracing.
+
+  The first `warmup_steps` calls with a given set of argument shapes, dtypes
+  and non tensor values run `fn` as usual. The next one traces it once more,
+  compiles the resulting graph and records which graph inputs come from which
+  arguments. From then on, calls with matching arguments run the compiled
+  graph on the new argument data without running `fn` at all, and update in
+  place the arguments `fn` modifies in place.
+
+  `fn` must only depend on its arguments: every tensor it reads or modifies
+  in place (model parameters, optimizer state...) has to be passed in,
+  possibly within nested lists, tuples or dicts. Tensors captured otherwise
+  are frozen at their value at capture time. Every `check_interval` replays
+  the step is traced again and the replay graph refreshed, as a safety net
+  for dependencies the guards cannot see (counter GraphReplayDivergence).
+
+  Can be used as `@replayable` or `@replayable(warmup_steps=...)`.
+  """
+  if warmup_steps is None:
+    warmup_steps = xu.getenv_as('XLA_GRAPH_REPLAY_WARMUP_STEPS', int, 1)
+  if check_interval is None:
+    check_interval = xu.getenv_as('XLA_GRAPH_REPLAY_CHECK_INTERVAL', int, 0)
+
+  def wrap(fn):
+    return ReplayableStep(fn, warmup_steps, check_interval)
+
+  return wrap(fn) if fn is not None else wrap
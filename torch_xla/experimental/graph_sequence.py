@@ -0,0 +1,50 @@
+import contextlib
+
+import torch_xla
+
+
+class GraphSequence:
+  """A sequence of cached Dynamo graph executions, replayed as one dispatch.
+
+  Captured by `capture`. The arguments of each graph are either the outputs of
+  an earlier graph of the sequence, or external inputs whose current data is
+  read at each replay, so that the inputs can be updated in place between the
+  replays. Each replay sets the data of the output tensors returned by the
+  graphs during the capture. The Python code run between the graphs, like the
+  in-place updates of the inputs done by the Dynamo bridge, is not replayed.
+  """
+
+  def __init__(self, sequence):
+    self._sequence = sequence
+
+  @property
+  def num_graphs(self) -> int:
+    return self._sequence.num_steps
+
+  def replay(self):
+    """Dispatches the graphs of the sequence as a single chained execution."""
+    self._sequence.replay()
+
+
+@contextlib.contextmanager
+def capture():
+  """Records the cached Dynamo graphs executed by the calling thread within
+  the block, which still run as usual.
+
+  Only single device (non SPMD) graphs can be captured.
+
+  Example::
+
+    compiled = torch.compile(model, backend='openxla')
+    compiled(x)  # traces and compiles
+    with graph_sequence.capture() as seq:
+      y = compiled(x)
+    x.copy_(next_batch)
+    seq.replay()  # y now holds model(next_batch)
+  """
+  torch_xla._XLAC._xla_begin_call_sequence_capture()
+  holder = GraphSequence(None)
+  try:
+    yield holder
+  finally:
+    holder._sequence = torch_xla._XLAC._xla_end_call_sequence_capture()
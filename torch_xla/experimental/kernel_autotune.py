@@ -0,0 +1,175 @@
+import functools
+import json
+import os
+import threading
+import time
+import warnings
+
+import torch
+import torch_xla
+
+_FILE_NAME = 'kernel_autotune.json'
+
+
+def _default_path():
+  path = os.environ.get('XLA_KERNEL_AUTOTUNE_FILE')
+  if path:
+    return path
+  # The choices are kept next to the persistent compilation cache, when it is
+  # on a local file system.
+  cache_path = os.environ.get('XLA_PERSISTENT_CACHE_PATH')
+  if cache_path and '://' not in cache_path:
+    return os.path.join(cache_path, _FILE_NAME)
+  return None
+
+
+def _read_only():
+  return os.environ.get('XLA_PERSISTENT_CACHE_READ_ONLY', '0') == '1'
+
+
+def shape_key(*args, **kwargs) -> str:
+  """The default autotuning key: the shapes and dtypes of the tensor arguments
+  and the values of the others."""
+
+  def key(arg):
+    if torch.is_tensor(arg):
+      return f'{arg.dtype}{list(arg.shape)}'
+    return repr(arg)
+
+  parts = [key(arg) for arg in args]
+  parts += [f'{name}={key(arg)}' for name, arg in sorted(kwargs.items())]
+  return ','.join(parts)
+
+
+class KernelAutotuner(object):
+  """Chooses the fastest configuration of a kernel for each input key, by
+  running every candidate on the device, and remembers the choice.
+
+  The choices are persisted as JSON to `path`, which defaults to
+  XLA_KERNEL_AUTOTUNE_FILE, or else to `kernel_autotune.json` in the directory
+  of the persistent compilation cache (see `runtime.initialize_cache`), so that
+  the later processes reuse them without benchmarking. Without a path the
+  choices only live in the process.
+  """
+
+  def __init__(self, path=None):
+    self._path = path if path is not None else _default_path()
+    self._lock = threading.Lock()
+    self._choices = {}
+    if self._path and os.path.exists(self._path):
+      try:
+        with open(self._path) as f:
+          self._choices = json.load(f)
+      except (OSError, ValueError) as e:
+        warnings.warn(f'Ignoring the kernel autotuning file {self._path}: {e}')
+
+  @property
+  def path(self):
+    return self._path
+
+  def get(self, name, key):
+    """The index of the configuration chosen for `key`, or None."""
+    with self._lock:
+      return self._choices.get(name, {}).get(key)
+
+  def tune(self, name, key, configs, run_fn, iterations=3):
+    """Returns the index of the fastest of `configs` for `key`, timing
+    `run_fn(config)` on the device for each candidate the first time.
+
+    `run_fn` returns the XLA tensors computed with a configuration. Each
+    candidate runs once to compile it, then `iterations` times timed, its
+    outputs only being synced, so that the pending computations of the caller
+    are left alone. The candidates which fail are skipped.
+    """
+    index = self.get(name, key)
+    if index is not None and index < len(configs):
+      return index
+    timings = []
+    for i, config in enumerate(configs):
+      try:
+        _run_synced(run_fn, config)
+        start = time.perf_counter()
+        for _ in range(iterations):
+          _run_synced(run_fn, config)
+        timings.append(((time.perf_counter() - start) / iterations, i))
+      except Exception as e:
+        warnings.warn(f'Kernel {name} config {config} failed: {e}')
+    if not timings:
+      raise RuntimeError(f'No configuration of kernel {name} ran for {key}')
+    index = min(timings)[1]
+    with self._lock:
+      self._choices.setdefault(name, {})[key] = index
+    self._save()
+    return index
+
+  def _save(self):
+    if not self._path or _read_only():
+      return
+    with self._lock:
+      choices = json.dumps(self._choices, indent=1, sort_keys=True)
+    directory = os.path.dirname(self._path)
+    if directory:
+      os.makedirs(directory, exist_ok=True)
+    temp_path = f'{self._path}.{os.getpid()}.tmp'
+    with open(temp_path, 'w') as f:
+      f.write(choices)
+    os.replace(temp_path, self._path)
+
+
+def _run_synced(run_fn, config):
+  outputs = run_fn(config)
+  if torch.is_tensor(outputs):
+    outputs = [outputs]
+  torch_xla._XLAC._xla_sync_multi(list(outputs), devices=[], wait=True)
+
+
+_autotuner = None
+_autotuner_lock = threading.Lock()
+
+
+def get_autotuner() -> KernelAutotuner:
+  """The autotuner of the process, created on first use."""
+  global _autotuner
+  with _autotuner_lock:
+    if _autotuner is None:
+      _autotuner = KernelAutotuner()
+    return _autotuner
+
+
+def autotune(name, configs, key_fn=shape_key, iterations=3):
+  """Decorates a kernel wrapper taking its configuration (like the block sizes
+  of a Pallas or Triton kernel) as the `config` keyword argument, so that it
+  runs with the fastest of `configs` for the key of its arguments.
+
+  Example::
+
+    @kernel_autotune.autotune('gmm', configs=[(128, 128, 128),
+                                              (512, 512, 512)])
+    def tuned_gmm(lhs, rhs, group_sizes, config):
+      return gmm(lhs, rhs, group_sizes, tiling=config)
+
+  Args:
+    name (str): The name of the kernel, keying its choices.
+    configs (list): The candidate configurations. The choices are stored as
+      indices in the list, which must thus keep its order.
+    key_fn (callable): Maps the arguments to the key of the choice, by default
+      the shapes and dtypes of the tensor arguments.
+    iterations (int): The timed runs of each candidate.
+  """
+
+  def decorator(fn):
+
+    @functools.wraps(fn)
+    def wrapper(*args, **kwargs):
+      key = key_fn(*args, **kwargs)
+      index = get_autotuner().tune(
+          name,
+          key,
+          configs,
+          lambda config: fn(*args, config=config, **kwargs),
+          iterations=iterations)
+      return fn(*args, config=configs[index], **kwargs)
+
+    return wrapper
+
+  return decorator
@@ -0,0 +1,89 @@
+"""Ops on tensors padded to a static bound along their first dimension.
+
+A data dependent size, like the number of nonzero elements, makes a dynamic
+dimension whose value is only known on the device. Reading it on the host, as
+the shape guards and `int()` do, syncs the graph at that point. The padded
+variants keep the tensor at its upper bound next to the number of valid rows
+as a scalar tensor, as returned by `xm.nonzero_static()` and
+`xm.masked_select_static()`, and mask the padding rows in the consumers. The
+graph stays static, so it neither syncs with the host nor recompiles with the
+number of valid rows.
+"""
+
+import torch
+
+
+def valid_mask(padded, count):
+  """Returns the `[padded.size(0)]` mask of the valid rows of `padded`.
+
+  Args:
+    padded (torch.Tensor): The tensor padded along its first dimension.
+    count (torch.Tensor): The number of valid rows, as a scalar tensor. A count
+      larger than the bound, for dropped rows, makes all the rows valid.
+  """
+  rows = torch.arange(padded.size(0), device=padded.device)
+  return rows < count.to(rows.dtype)
+
+
+def _row_mask(padded, count):
+  mask = valid_mask(padded, count)
+  return mask.view((-1,) + (1,) * (padded.dim() - 1))
+
+
+def mask_padding(padded, count, value=0):
+  """Returns `padded` with its padding rows set to `value`."""
+  return torch.where(
+      _row_mask(padded, count), padded,
+      torch.tensor(value, dtype=padded.dtype, device=padded.device))
+
+
+def _valid_count(padded, count):
+  return torch.clamp(count, max=padded.size(0)).to(padded.dtype)
+
+
+def masked_sum(padded, count):
+  """Returns the sum of the valid rows of `padded`."""
+  return mask_padding(padded, count).sum(dim=0)
+
+
+def masked_mean(padded, count):
+  """Returns the mean of the valid rows of `padded`, NaN if there are none."""
+  return masked_sum(padded, count) / _valid_count(padded, count)
+
+
+def masked_max(padded, count):
+  """Returns the max of the valid rows of `padded`, -inf if there are none."""
+  return mask_padding(padded, count, float('-inf')).amax(dim=0)
+
+
+def masked_softmax(padded, count):
+  """Returns the softmax over the valid rows of `padded`.
+
+  The padding rows are excluded from the normalization and are zero in the
+  result.
+  """
+  logits = mask_padding(padded, count, float('-inf'))
+  result = torch.softmax(logits, dim=0)
+  return mask_padding(torch.nan_to_num(result, nan=0.0), count)
+
+
+def padded_matmul(padded, count, other):
+  """Returns `padded @ other` with the padding rows of the result zeroed.
+
+  The padding rows of `padded` are zeroed first, so that a non finite padding
+  value does not leak in the valid rows of the later reductions.
+  """
+  return mask_padding(mask_padding(padded, count) @ other, count)
+
+
+def padded_index_select(input, padded_index, count):
+  """Returns the rows of `input` at the valid indices of `padded_index`.
+
+  The padding indices, like the -1 fill value of `xm.nonzero_static()`, are
+  clamped to a valid row and their rows of the result are zeroed. The result is
+  padded like `padded_index`, with the same `count`.
+  """
+  index = torch.clamp(padded_index, 0, input.size(0) - 1)
+  index = torch.where(valid_mask(padded_index, count), index,
+                      torch.zeros_like(index))
+  return mask_padding(torch.index_select(input, 0, index), count)
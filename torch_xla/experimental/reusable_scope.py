@@ -0,0 +1,51 @@
+from typing import Sequence, Union
+
+import torch
+import torch_xla
+
+
+TensorOrTensors = Union[torch.Tensor, Sequence[torch.Tensor]]
+
+
+def _as_list(tensors):
+  if isinstance(tensors, torch.Tensor):
+    return [tensors]
+  return list(tensors)
+
+
+def mark_reusable_scope(outputs: TensorOrTensors,
+                        inputs: TensorOrTensors = (),
+                        name: str = 'reusable_scope/'):
+  """Marks the pending computation of `outputs` as a reusable scope.
+
+  The scope holds the IR nodes computing `outputs` which are not marked yet,
+  up to the `inputs` and the device data. When the graph is lowered, each
+  scope becomes the call of a computation, shared by all the scopes of the
+  same structure, so that the repeated layers of a model are lowered once and
+  appear once in the HLO. The compiler can still inline the calls when it
+  optimizes the graph.
+
+  The scopes are only reused when they compute the same ops with the same
+  shapes from inputs of the same shapes, so the data of a layer (its weights,
+  its activations) should be device data or `inputs`, like a layer called from
+  a loop. The scopes are marked in trace order, each one right after its
+  layer, as the nodes marked by a scope are left out of the later ones.
+  The scopes are lowered node by node in SPMD mode, and in the graphs with
+  all-reduce buckets.
+
+  Example::
+
+    for layer in decoder.layers:
+      output = layer(hidden)
+      reusable_scope.mark_reusable_scope(
+          output, inputs=hidden, name='decoder_layer/')
+      hidden = output
+
+  Args:
+    outputs: the outputs of the scope.
+    inputs: the inputs of the scope, whose own pending computation is left out
+      of it.
+    name: the op name prefix of the nodes of the scope in the HLO metadata.
+  """
+  torch_xla._XLAC._xla_mark_reusable_scope(
+      _as_list(outputs), _as_list(inputs), name)
@@ -0,0 +1,77 @@
+import torch
+from torch.func import functional_call
+
+from torch_xla.experimental.fori_loop import _xla_while_loop
+
+
+def _layer_tensors(layer):
+  tensors = dict(layer.named_parameters())
+  tensors.update(layer.named_buffers())
+  return tensors
+
+
+def scan_layers(layers, input_data):
+  """Applies the identical `layers` in sequence to `input_data`, lowering the
+  layer body once as the body of a while loop over their stacked weights.
+
+  A deep stack of identical layers traced lazily emits one copy of the layer
+  computation per layer, so that the compile time and the size of the
+  executable grow with the depth. Here the weights of the layers are stacked
+  along a new leading dimension, and the loop body applies the first layer
+  with the weights of the current iteration, so that the HLO holds a single
+  copy of the layer whatever the depth.
+
+  The layers must be of the same type, with parameters and buffers of the same
+  names, shapes and dtypes, and take and return a single tensor of the same
+  shape. The loop has no backward, so this is meant for the inference of the
+  stacks, like the decoder of a serving model.
+
+  Args:
+    layers: The sequence of layers, e.g. an `nn.ModuleList`.
+    input_data (torch.Tensor): The input of the first layer.
+
+  Returns:
+    The output of the last layer.
+  """
+  layers = list(layers)
+  if not layers:
+    return input_data
+  first = layers[0]
+  names = list(_layer_tensors(first).keys())
+  stacked = []
+  for name in names:
+    tensors = []
+    for layer in layers:
+      if type(layer) is not type(first):
+        raise ValueError(
+            f'scan_layers needs layers of the same type, got {type(first)} '
+            f'and {type(layer)}')
+      tensor = _layer_tensors(layer).get(name)
+      reference = _layer_tensors(first)[name]
+      if (tensor is None or tensor.shape != reference.shape or
+          tensor.dtype != reference.dtype):
+        raise ValueError(f'Layer tensor {name} differs across the layers')
+      tensors.append(tensor.detach())
+    stacked.append(torch.stack(tensors))
+
+  num_layers = len(layers)
+  device = input_data.device
+
+  def cond_fn(index, data, *weights):
+    return index[0] < num_layers
+
+  def body_fn(index, data, *weights):
+    layer_tensors = {
+        name: torch.index_select(weight, 0, index).squeeze(0)
+        for name, weight in zip(names, weights)
+    }
+    output = functional_call(first, layer_tensors, (data,))
+    one = torch.ones(1, dtype=torch.int32, device=device)
+    return torch.add(index, one), output
+
+  index = torch.zeros(1, dtype=torch.int32, device=device)
+  _, output = _xla_while_loop(
+      cond_fn,
+      body_fn, (index, input_data),
+      additional_inputs=tuple(stacked))
+  return output
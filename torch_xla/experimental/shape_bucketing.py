@@ -0,0 +1,92 @@
+from typing import Optional, Sequence, Tuple, Union
+
+import torch
+
+import torch_xla
+import torch_xla.utils.utils as xu
+
+
+def _default_buckets() -> Optional[Sequence[int]]:
+  buckets = xu.getenv_as('XLA_SHAPE_BUCKETS', str, '')
+  if not buckets:
+    return None
+  return sorted(int(bucket) for bucket in buckets.split(','))
+
+
+def bucket_size(size: int, buckets: Optional[Sequence[int]] = None) -> int:
+  """Returns the smallest bucket which can hold `size` elements.
+
+  Args:
+    size (int): The size to round up.
+    buckets (list of int, optional): The bucket sizes. Defaults to the comma
+      separated list of XLA_SHAPE_BUCKETS, or to the powers of two if unset.
+      Sizes larger than the largest bucket are rounded up to the next power of
+      two (counter ShapeBucketOverflow).
+  """
+  if buckets is None:
+    buckets = _default_buckets()
+  if buckets:
+    for bucket in sorted(buckets):
+      if bucket >= size:
+        return bucket
+    torch_xla._XLAC._xla_increment_counter('ShapeBucketOverflow', 1)
+  bucket = 1
+  while bucket < size:
+    bucket <<= 1
+  return bucket
+
+
+def pad_to_bucket(
+    tensor: torch.Tensor,
+    dims: Union[int, Sequence[int]],
+    buckets: Optional[Sequence[int]] = None,
+    value=0,
+    device: Optional[torch.device] = None,
+) -> Tuple[torch.Tensor, torch.Tensor]:
+  """Pads the given dimensions of a tensor up to their bucket size.
+
+  Every distinct input shape makes for a distinct graph, which then has to be
+  compiled. Padding the dimensions whose size varies from step to step, like
+  the sequence length, bounds the number of graphs to the number of buckets.
+  The padding should happen on the host, before the tensor is uploaded, so
+  that no graph ever sees the unpadded shape.
+
+  Args:
+    tensor (torch.Tensor): The tensor to pad, usually a CPU tensor.
+    dims (int or list of int): The dimensions to pad, at their end.
+    buckets (list of int, optional): The bucket sizes, see `bucket_size`.
+    value (optional): The padding value. Default: 0
+    device (torch.device, optional): The device to move the results to.
+
+  Returns:
+    The padded tensor, and an int64 tensor with the valid extent of each of
+    the padded dimensions, which `length_mask` turns into a mask.
+  """
+  if isinstance(dims, int):
+    dims = [dims]
+  dims = [dim % tensor.dim() for dim in dims]
+  padded_shape = list(tensor.shape)
+  for dim in dims:
+    padded_shape[dim] = bucket_size(padded_shape[dim], buckets)
+  lengths = torch.tensor([tensor.shape[dim] for dim in dims], dtype=torch.int64)
+  if padded_shape != list(tensor.shape):
+    torch_xla._XLAC._xla_increment_counter('ShapeBucketPadded', 1)
+    padded = tensor.new_full(padded_shape, value)
+    padded[tuple(slice(0, size) for size in tensor.shape)] = tensor
+    tensor = padded
+  if device is not None:
+    tensor = tensor.to(device)
+    lengths = lengths.to(device)
+  return tensor, lengths
+
+
+def length_mask(length: torch.Tensor, size: int) -> torch.Tensor:
+  """Returns a boolean mask of `size` elements, true below `length`.
+
+  Args:
+    length (torch.Tensor): A scalar tensor with the valid extent of a padded
+      dimension, as returned by `pad_to_bucket`. Keeping it a tensor lets
+      the graphs using the mask be reused whatever the valid extent.
+    size (int): The padded size of the dimension.
+  """
+  return torch.arange(size, device=length.device) < length
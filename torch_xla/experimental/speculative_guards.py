@@ -0,0 +1,71 @@
+"""Speculative execution of the guards on the dynamic sizes.
+
+A Python condition on a dynamic size, like `if nonzero.shape[0] > 0`, needs the
+concrete value of the size, and executes the pending graph up to it. In a data
+dependent model this is a host sync per step. While speculating, a guard whose
+call site was evaluated before returns the value it had then, and tracing goes
+on. The guarded sizes are synced along with the outputs of the step, and the
+step is traced again only if a speculation turns out wrong.
+"""
+
+import contextlib
+
+import torch
+import torch_xla
+from torch.utils._pytree import tree_flatten
+
+
+@contextlib.contextmanager
+def speculating():
+  """Speculates the values of the size guards within the context.
+
+  The speculations are pending until taken by `run_step()`, which validates
+  them.
+  """
+  torch_xla._XLAC._xla_set_speculative_size_guards(True)
+  try:
+    yield
+  finally:
+    torch_xla._XLAC._xla_set_speculative_size_guards(False)
+
+
+def _xla_tensors(outputs):
+  return [
+      t for t in tree_flatten(outputs)[0]
+      if isinstance(t, torch.Tensor) and t.device.type == 'xla'
+  ]
+
+
+def run_step(fn, *args, **kwargs):
+  """Runs the step `fn(*args, **kwargs)` with its size guards speculated.
+
+  The outputs of `fn` are synced along with the sizes of the speculated guards.
+  On a misprediction the site records the actual value, and `fn` is traced and
+  executed again with its guards evaluated, the outputs of the first trace
+  being dropped. So `fn` must not update the tensors it reads in place, like an
+  optimizer step does: the state it changes has to be among its outputs,
+  applied by the caller.
+
+  Returns:
+    The outputs of `fn`, synced.
+  """
+  with speculating():
+    outputs = fn(*args, **kwargs)
+  guards = torch_xla._XLAC._xla_take_speculative_size_guards()
+  tensors = _xla_tensors(outputs)
+  sizes = torch.stack([size for _, _, size in guards]) if guards else None
+  torch_xla._XLAC._xla_sync_multi(
+      tensors + ([sizes] if guards else []), devices=[], wait=False)
+  if not guards:
+    return outputs
+  mispredicted = False
+  for (site, predicted, _), value in zip(guards, sizes.cpu().tolist()):
+    if value != predicted:
+      torch_xla._XLAC._xla_observe_size_guard(site, value)
+      mispredicted = True
+  if not mispredicted:
+    return outputs
+  outputs = fn(*args, **kwargs)
+  tensors = _xla_tensors(outputs)
+  torch_xla._XLAC._xla_sync_multi(tensors, devices=[], wait=False)
+  return outputs
@@ -5,85 +5,137 @@ from torch.library import impl
 from torch_xla.core.xla_model import XLA_LIB
 
 XLA_LIB.define(
-    "quantized_matmul(Tensor x, Tensor w, Tensor scale, int? blocksize=-1, bool? quantize_activation=False) -> Tensor"
+    "quantized_matmul(Tensor x, Tensor w, Tensor scale, int? blocksize=-1, bool? quantize_activation=False, bool? int4_weight=False) -> Tensor"
 )
 
 
-def _check_per_channel_quant_weight_dtype_shapes(input_dim, output_dim, w,
-                                                 w_scaler):
+def _check_weight_dtype_shapes(input_dim, output_dim, w, w_scaler, blocksize,
+                               int4_weight):
   assert w.dtype == torch.int8, f"Weight dtype is expected to be torch.int8, got {w.dtype}."
   assert w.dim(
   ) == 2, f"Weight tensor is expected to be 2D, got {w.dim()}D Tensor."
-  assert output_dim == w.shape[0] and input_dim == w.shape[
-      1], f"Weight shape is expected to be [output_dim, input_dim], output_dim: {output_dim}, input_dim: {input_dim}, but got {w.shape}."
-  assert w_scaler.dim() == 1 and w_scaler.shape[0] == w.shape[
-      0], f"weight scaler shape is expect to be [out_channel,], got {w_scaler.shape}, weight shape {w.shape}."
+  packed_input_dim = input_dim // 2 if int4_weight else input_dim
+  assert output_dim == w.shape[0] and packed_input_dim == w.shape[
+      1], f"Weight shape is expected to be [output_dim, {'input_dim / 2' if int4_weight else 'input_dim'}], output_dim: {output_dim}, input_dim: {input_dim}, but got {w.shape}."
+  if blocksize == -1:
+    assert w_scaler.dim() == 1 and w_scaler.shape[0] == w.shape[
+        0], f"weight scaler shape is expect to be [out_channel,], got {w_scaler.shape}, weight shape {w.shape}."
+  else:
+    assert blocksize > 0 and input_dim % blocksize == 0, f"input_dim {input_dim} is expected to be a multiple of the blocksize {blocksize}."
+    assert w_scaler.dim() == 2 and tuple(w_scaler.shape) == (
+        output_dim, input_dim // blocksize
+    ), f"weight scaler shape is expect to be [out_channel, in_channel / blocksize], got {w_scaler.shape}, weight shape {w.shape}."
+
+
+def pack_int4(w: torch.Tensor) -> torch.Tensor:
+  """Packs the int4 values in [-8, 7] of the int8 [out_channel, in_channel] `w`
+  into a torch.int8 [out_channel, in_channel / 2] tensor, the in channels 2j
+  in the low nibbles and 2j + 1 in the high ones.
+  """
+  assert w.shape[-1] % 2 == 0, "The in channels must be even to pack int4."
+  low = w[..., 0::2].to(torch.int16) & 0xF
+  high = w[..., 1::2].to(torch.int16) << 4
+  return (low | high).to(torch.int8)
+
+
+def _unpack_int4(w: torch.Tensor) -> torch.Tensor:
+  low = (w << 4) >> 4
+  high = w >> 4
+  return torch.stack([low, high], dim=-1).flatten(-2)
+
+
+def _dequantize_weight(w, scaler, blocksize, int4_weight, dtype):
+  if int4_weight:
+    w = _unpack_int4(w)
+  w = w.to(dtype)
+  if blocksize != -1:
+    w = (w.unflatten(-1, (-1, blocksize)) * scaler.unsqueeze(-1)).flatten(-2)
+  return w
 
 
 @impl(XLA_LIB, "quantized_matmul", "XLA")
 def quantized_matmul_xla(x: torch.Tensor,
                          w: torch.Tensor,
                          scaler: torch.Tensor,
-                         blocksize: int = -1):
-  """Quantized Matrix Multiply op on XLA devices.
+                         blocksize: int = -1,
+                         quantize_activation: bool = False,
+                         int4_weight: bool = False):
+  """Weight-only quantized Matrix Multiply op on XLA devices.
+
+  The weight is dequantized within the lowering of a single IR op, so that the
+  compiler fuses the dequantization into the dot and the weight is read from
+  HBM in its quantized form. When sharding, shard `w` and `scaler` alike along
+  the out channels.
 
   Args:
       x: torch.Tensor - Activation of Matmul [..., in_channel].
       w: torch.Tensor - Weight Tensor.
-         per-channel quant: torch.int8 x [out_channel, in_channel].
+         int8 quant: torch.int8 x [out_channel, in_channel].
+         int4 quant: torch.int8 x [out_channel, in_channel / 2], packed by
+           pack_int4().
       scaler: torch.Tensor - Weight scaler.
          per-channel quant: [out_channel,].
+         blockwise quant: [out_channel, in_channel / blocksize].
       blocksize: blocksize for blockwise quantization, -1 for per-channel quantization.
+      int4_weight: whether `w` packs two int4 values per byte.
   """
-  assert blocksize == -1, "blockwise quantization is not supported yet."
-  # Per-channel quant.
-  _check_per_channel_quant_weight_dtype_shapes(x.shape[-1], scaler.shape[0], w,
-                                               scaler)
-  return F.linear(x, w) * scaler
+  assert not quantize_activation, "Activation quantization is not supported yet."
+  _check_weight_dtype_shapes(x.shape[-1], w.shape[0], w, scaler, blocksize,
+                             int4_weight)
+  return torch_xla._XLAC._xla_quantized_matmul(x, w, scaler, blocksize,
+                                                int4_weight)
 
 
 @impl(XLA_LIB, "quantized_matmul", "CompositeExplicitAutograd")
 def quantized_matmul(x: torch.Tensor,
                      w: torch.Tensor,
                      scaler: torch.Tensor,
-                     blocksize: int = -1):
-  assert blocksize == -1, "blockwise quantization is not supported yet."
-  # Per-channel quant.
-  _check_per_channel_quant_weight_dtype_shapes(x.shape[-1], scaler.shape[0], w,
-                                               scaler)
-  w = w.to(x.dtype)
-  return torch.mul(F.linear(x, w), scaler)
+                     blocksize: int = -1,
+                     quantize_activation: bool = False,
+                     int4_weight: bool = False):
+  assert not quantize_activation, "Activation quantization is not supported yet."
+  _check_weight_dtype_shapes(x.shape[-1], w.shape[0], w, scaler, blocksize,
+                             int4_weight)
+  w = _dequantize_weight(w, scaler, blocksize, int4_weight, x.dtype)
+  if blocksize == -1:
+    return torch.mul(F.linear(x, w), scaler)
+  return F.linear(x, w)
 
 
 class XlaQuantizedLinear(torch.nn.Module):
 
-  def __init__(self, input_dim, output_dim, blocksize=-1):
+  def __init__(self, input_dim, output_dim, blocksize=-1, int4_weight=False):
     super().__init__()
-    assert blocksize == -1, "Only per-channel quantization is supported."
     self.input_dim = input_dim
     self.output_dim = output_dim
     self.blocksize = blocksize
-    self.register_buffer('weight',
-                         torch.zeros(output_dim, input_dim).to(torch.int8))
-    self.register_buffer('weight_scaler', torch.zeros(output_dim))
+    self.int4_weight = int4_weight
+    packed_input_dim = input_dim // 2 if int4_weight else input_dim
+    self.register_buffer(
+        'weight',
+        torch.zeros(output_dim, packed_input_dim).to(torch.int8))
+    if blocksize == -1:
+      self.register_buffer('weight_scaler', torch.zeros(output_dim))
+    else:
+      self.register_buffer('weight_scaler',
+                           torch.zeros(output_dim, input_dim // blocksize))
 
   def load_quantized_weight(self, weight, weight_scaler):
     '''
-    Weight shape: [output_channel, input_channel]
-    Weight scaler shape: [output_channel]
+    Weight shape: [output_channel, input_channel], or
+      [output_channel, input_channel / 2] packed by pack_int4() for int4.
+    Weight scaler shape: [output_channel] for per-channel quantization, or
+      [output_channel, input_channel / blocksize] for blockwise quantization.
     '''
-    if self.blocksize == -1:
-      # Per-channel quant.
-      _check_per_channel_quant_weight_dtype_shapes(self.input_dim,
-                                                   self.output_dim, weight,
-                                                   weight_scaler)
-      self.weight = weight
-      self.weight_scaler = weight_scaler
-    else:
-      assert False, "Only per-channel quantization is supported."
+    _check_weight_dtype_shapes(self.input_dim, self.output_dim, weight,
+                               weight_scaler, self.blocksize, self.int4_weight)
+    self.weight = weight
+    self.weight_scaler = weight_scaler
 
   def forward(self, x):
-    if self.blocksize == -1:
-      return torch.ops.xla.quantized_matmul(x, self.weight, self.weight_scaler)
-    else:
-      assert False, "Only per-channel quantization is supported."
+    return torch.ops.xla.quantized_matmul(
+        x,
+        self.weight,
+        self.weight_scaler,
+        blocksize=self.blocksize,
+        int4_weight=self.int4_weight)
@@ -1,3 +1,4 @@
+import contextlib
 import functools
 import logging
 import os
@@ -279,13 +280,25 @@ def get_master_ip() -> str:
 
 
 @requires_pjrt
-def initialize_cache(path: str, readonly: bool = False):
+def initialize_cache(path: str,
+                     readonly: bool = False,
+                     max_size_bytes: Optional[int] = None,
+                     async_writes: bool = False,
+                     prefetch: bool = False):
   """Initializes the persistent compilation cache. This API must be called
   before any computations have been performed.
 
   Args:
-    path: The path at which to store the persistent cache.
+    path: The path at which to store the persistent cache. Paths with a file
+      system scheme, like gs://bucket/dir, can be shared by all the hosts.
     readonly: Whether or not this worker should have write access to the cache.
+    max_size_bytes: If set, the least recently used executables are removed
+      from disk to keep the cache within this size.
+    async_writes: Whether executables are serialized and written to disk in
+      background, instead of on the step which compiled them. Pending writes
+      are flushed at exit.
+    prefetch: Whether the most recently used executables compiled in the same
+      environment are loaded when the cache is initialized.
   """
   assert not torch_xla._XLAC._xla_computation_cache_is_initialized(
   ), "Computation cache has already been initialized"
@@ -294,3 +307,75 @@ def initialize_cache(path: str, readonly: bool = False):
   # the cache.
   os.environ['XLA_PERSISTENT_CACHE_PATH'] = path
   os.environ['XLA_PERSISTENT_CACHE_READ_ONLY'] = '1' if readonly else '0'
+  os.environ['XLA_PERSISTENT_CACHE_MAX_BYTES'] = str(max_size_bytes or 0)
+  os.environ['XLA_PERSISTENT_CACHE_ASYNC_WRITE'] = '1' if async_writes else '0'
+  os.environ['XLA_PERSISTENT_CACHE_PREFETCH'] = '1' if prefetch else '0'
+
+
+@requires_pjrt
+def compilation_env_components() -> Dict[str, str]:
+  """Returns the values hashed into the compilation environment hash, which is
+  part of the keys of the persistent cache: the XLA flags and environment
+  variables changing the compilation, along with the topology or the platform
+  and devices. Comparing them across processes explains the cache misses due
+  to a different environment. The `hash` entry is the hash itself.
+  """
+  return torch_xla._XLAC._xla_compilation_env_components()
+
+
+@requires_pjrt
+def invalidate_compilation_env_hash():
+  """Has the compilation environment hash read the environment variables again
+  on its next use. The hash is computed once, so this must be called after
+  changing them in the process, for the graphs compiled after to not reuse the
+  executables of the previous environment.
+  """
+  torch_xla._XLAC._xla_invalidate_compilation_env_hash()
+
+
+@requires_pjrt
+@contextlib.contextmanager
+def tenant(name: str):
+  """Charges the device memory of the tensors transferred and computed by the
+  calling thread within the context to the tenant `name`, for the models
+  sharing the devices of a process to each stay within their budget. The
+  tensors stay charged until released, whichever thread releases them.
+  """
+  previous = torch_xla._XLAC._xla_get_tenant()
+  torch_xla._XLAC._xla_set_tenant(name)
+  try:
+    yield
+  finally:
+    torch_xla._XLAC._xla_set_tenant(previous)
+
+
+@requires_pjrt
+def set_tenant_memory_budget(name: str,
+                             bytes: Optional[int] = None,
+                             fraction: Optional[float] = None,
+                             device: Optional[torch.device] = None):
+  """Sets the device memory budget of the tenant `name`, see `tenant()`. The
+  transfers which would take the tenant over budget raise, as do its
+  executions once it is over budget, without affecting the other tenants.
+
+  Args:
+    name: The name of the tenant.
+    bytes: The budget in bytes, 0 or None for none.
+    fraction: If set instead of `bytes`, the budget as a fraction of the
+      memory limit of `device`.
+    device: The device of the limit `fraction` applies to, the current one by
+      default.
+  """
+  if fraction is not None:
+    assert bytes is None, 'Only one of bytes and fraction can be set'
+    device = device or torch_xla.device()
+    bytes = int(fraction * xm.get_memory_info(device)['bytes_limit'])
+  torch_xla._XLAC._xla_set_tenant_memory_budget(name, bytes or 0)
+
+
+@requires_pjrt
+def tenant_memory_usage() -> Dict[str, Dict[str, int]]:
+  """Returns the `bytes_used`, `peak_bytes_used` and `budget_bytes` of the
+  tenants with a budget or charged so far, by name.
+  """
+  return torch_xla._XLAC._xla_tenant_memory_usage()
@@ -352,6 +352,7 @@ def _exported_program_to_stablehlo_bundle(exported_model,
     gm_serializer = GraphModuleSerializer(exported_model.graph_signature,
                                           exported_model.module_call_graph)
     os.environ["XLA_HLO_DEBUG"] = "1"
+    torch_xla._XLAC._xla_invalidate_compilation_env_hash()
   else:
     gm_serializer = None
 
@@ -481,6 +482,8 @@ def _exported_program_to_stablehlo_bundle(exported_model,
   torch_xla._XLAC._set_xla_all_numbers_special_scalars(False)
   # Recover the global XLA_HLO_DEBUG flag
   os.environ["XLA_HLO_DEBUG"] = xla_hlo_debug_env
+  if options.export_node_metadata:
+    torch_xla._XLAC._xla_invalidate_compilation_env_hash()
 
   return bundle
 
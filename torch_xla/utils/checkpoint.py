@@ -279,3 +279,149 @@ def checkpoint(function, *args, use_reentrant: bool = True, **kwargs):
     return CheckpointFunction.apply(function, preserve, *args)
   else:
     raise ValueError("XLA currently does not support use_reentrant==False")
+
+
+# The autograd nodes whose saved outputs are expensive to recompute.
+_EXPENSIVE_GRAD_FNS = ('MmBackward', 'AddmmBackward', 'BmmBackward',
+                       'BaddbmmBackward', 'ConvolutionBackward',
+                       'ScaledDotProductFlashAttentionBackward',
+                       'ScaledDotProductEfficientAttentionBackward')
+
+
+def _tensor_bytes(tensor):
+  return tensor.numel() * tensor.element_size()
+
+
+def _is_expensive(tensor):
+  grad_fn = tensor.grad_fn
+  return grad_fn is not None and type(grad_fn).__name__.startswith(
+      _EXPENSIVE_GRAD_FNS)
+
+
+class CheckpointPlan(object):
+  """The modules chosen by `plan_checkpointing`, and the estimated tradeoff.
+
+  Attributes:
+    modules: The names of the modules to checkpoint.
+    activation_bytes: The bytes of activations saved for the backward per
+      module name, as traced.
+    expensive_bytes: The part of `activation_bytes` produced by matmuls,
+      convolutions and attentions, per module name.
+    budget_bytes: The device memory budget of the activations.
+    saved_bytes: The estimated activation bytes freed by the plan.
+    recompute_fraction: The estimated extra forward compute of the plan, as
+      the fraction of the expensive activations which are recomputed.
+  """
+
+  def __init__(self, modules, activation_bytes, expensive_bytes, budget_bytes,
+               saved_bytes, recompute_fraction):
+    self.modules = modules
+    self.activation_bytes = activation_bytes
+    self.expensive_bytes = expensive_bytes
+    self.budget_bytes = budget_bytes
+    self.saved_bytes = saved_bytes
+    self.recompute_fraction = recompute_fraction
+
+  def __repr__(self):
+    return (f'CheckpointPlan(modules={self.modules}, '
+            f'budget_bytes={self.budget_bytes}, '
+            f'saved_bytes={self.saved_bytes}, '
+            f'recompute_fraction={self.recompute_fraction:.3f})')
+
+
+def plan_checkpointing(model: torch.nn.Module,
+                       sample_inputs: Tuple,
+                       candidates: List[str],
+                       budget_bytes: int = None,
+                       budget_fraction: float = 0.8) -> CheckpointPlan:
+  """Chooses the modules to checkpoint so that the activations fit a budget.
+
+  The forward of `model` is traced once on `sample_inputs` (lazily, nothing is
+  executed), recording the activations saved for the backward by each of the
+  `candidates` submodules. The candidates whose activations the most come
+  from cheap ops, like the elementwise ones, rather than from matmuls and
+  convolutions are checkpointed first, until the remaining activations fit
+  the budget. The backward of a checkpointed module recomputes its forward
+  behind an optimization barrier, see `checkpoint`.
+
+  Args:
+    model: The model, on an XLA device.
+    sample_inputs: The inputs of a forward of the model.
+    candidates: The names of the submodules which may be checkpointed, as in
+      `model.named_modules()`, e.g. the layers of a transformer.
+    budget_bytes: The device memory budget of the activations. Defaults to
+      `budget_fraction` of the free memory of the device reported by
+      `xm.get_memory_info`.
+    budget_fraction: The fraction of the free device memory used as budget
+      when `budget_bytes` is not given.
+
+  Returns:
+    The `CheckpointPlan`, to pass to `apply_checkpoint_plan`.
+  """
+  modules = dict(model.named_modules())
+  activation_bytes = {name: 0 for name in candidates}
+  expensive_bytes = {name: 0 for name in candidates}
+  active = []
+
+  def pack(tensor):
+    if active:
+      activation_bytes[active[-1]] += _tensor_bytes(tensor)
+      if _is_expensive(tensor):
+        expensive_bytes[active[-1]] += _tensor_bytes(tensor)
+    return tensor
+
+  handles = []
+  for name in candidates:
+    module = modules[name]
+    handles.append(
+        module.register_forward_pre_hook(
+            lambda m, args, name=name: active.append(name)))
+    handles.append(
+        module.register_forward_hook(lambda m, args, output: active.pop()))
+  try:
+    with torch.autograd.graph.saved_tensors_hooks(pack, lambda t: t):
+      model(*sample_inputs)
+  finally:
+    for handle in handles:
+      handle.remove()
+
+  if budget_bytes is None:
+    device = next(model.parameters()).device
+    info = xm.get_memory_info(device)
+    free_bytes = max(info['bytes_limit'] - int(info['bytes_used']), 0)
+    budget_bytes = int(free_bytes * budget_fraction)
+
+  total_bytes = sum(activation_bytes.values())
+  total_expensive = sum(expensive_bytes.values())
+  chosen = []
+  saved_bytes = 0
+  recomputed = 0
+  ordered = sorted(
+      candidates, key=lambda n: (expensive_bytes[n] + 1) /
+      (activation_bytes[n] + 1))
+  for name in ordered:
+    if total_bytes - saved_bytes <= budget_bytes:
+      break
+    if activation_bytes[name] == 0:
+      continue
+    chosen.append(name)
+    saved_bytes += activation_bytes[name]
+    recomputed += expensive_bytes[name]
+  recompute_fraction = recomputed / total_expensive if total_expensive else 0.0
+  return CheckpointPlan(
+      modules=chosen,
+      activation_bytes=activation_bytes,
+      expensive_bytes=expensive_bytes,
+      budget_bytes=budget_bytes,
+      saved_bytes=saved_bytes,
+      recompute_fraction=recompute_fraction)
+
+
+def apply_checkpoint_plan(model: torch.nn.Module, plan: CheckpointPlan):
+  """Checkpoints the forward of the modules chosen by `plan_checkpointing`."""
+  modules = dict(model.named_modules())
+  for name in plan.modules:
+    module = modules[name]
+    forward = module.forward
+    module.forward = (
+        lambda *args, forward=forward: checkpoint(forward, *args))
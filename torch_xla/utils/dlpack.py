@@ -1,18 +1,50 @@
-from typing import Any
+from typing import Any, Optional
 import enum
 from torch.utils.dlpack import DLDeviceType
 import torch_xla
+import torch_xla.runtime as xr
 
 
-def to_dlpack(xla_tensor: Any):
-  return torch_xla._XLAC._to_dlpack(xla_tensor)
+def to_dlpack(xla_tensor: Any, stream: Optional[int] = None):
+  """Exports `xla_tensor` as a DLPack capsule.
+
+  Without `stream`, waits for the tensor to be ready on the host. With the
+  stream of the consumer, as in the DLPack stream protocol, the stream is made
+  to wait for the pending writes of the tensor instead, and -1 skips any
+  synchronization.
+  """
+  return torch_xla._XLAC._to_dlpack(xla_tensor, stream)
+
+
+class DLPackExporter:
+  """Wraps an XLA tensor into an object of the DLPack protocol.
+
+  The `from_dlpack` of other frameworks, like `cupy.from_dlpack`, passes their
+  stream to `__dlpack__`, so that they consume the tensor in stream order
+  without a host synchronization.
+  """
+
+  def __init__(self, xla_tensor: Any):
+    self._tensor = xla_tensor
+
+  def __dlpack__(self, stream: Optional[int] = None):
+    return to_dlpack(self._tensor, stream=stream)
+
+  def __dlpack_device__(self):
+    device_type = (
+        DLDeviceType.kDLGPU
+        if xr.device_type() == 'CUDA' else DLDeviceType.kDLCPU)
+    return (device_type, self._tensor.device.index)
 
 
 def from_dlpack(ext_tensor: Any):
+  stream = None
   if hasattr(ext_tensor, '__dlpack_device__') and hasattr(
       ext_tensor, '__dlpack__'):
     device_type, device_id = ext_tensor.__dlpack_device__()
     if device_type == DLDeviceType.kDLGPU:
+      # The producer orders its writes on the stream, which the computations
+      # using the tensor wait for.
       stream = torch_xla._XLAC._get_stream_for_cuda_device(device_id)
       dlpack = ext_tensor.__dlpack__(stream=stream)
     else:
@@ -20,4 +52,4 @@ def from_dlpack(ext_tensor: Any):
   else:
     dlpack = ext_tensor
 
-  return torch_xla._XLAC._from_dlpack(dlpack)
+  return torch_xla._XLAC._from_dlpack(dlpack, stream)